@@ -144,6 +144,9 @@ foreach(oneflow_single_file ${oneflow_all_src})
     if("${oneflow_single_file}" MATCHES "^${PROJECT_SOURCE_DIR}/oneflow/(core|user|xrt)/.*_test\\.cpp$")
       # test file
       list(APPEND of_all_test_cc ${oneflow_single_file})
+    elseif("${oneflow_single_file}" MATCHES "^${PROJECT_SOURCE_DIR}/oneflow/(core|user|xrt)/.*_bench\\.cpp$")
+      # benchmark file
+      list(APPEND of_all_bench_cc ${oneflow_single_file})
     elseif(APPLE AND "${oneflow_single_file}" MATCHES "^${PROJECT_SOURCE_DIR}/oneflow/core/comm_network/(epoll|ibverbs)/.*")
       # skip if macOS
     elseif(APPLE AND "${oneflow_single_file}" MATCHES "^${PROJECT_SOURCE_DIR}/oneflow/core/transport/.*")
@@ -333,6 +336,19 @@ if(BUILD_TESTING)
   endif()
 endif()
 
+# build benchmark
+# run with --benchmark_format=json (or --benchmark_out=<file> --benchmark_out_format=json)
+# to get machine-readable results for regression tracking
+if(BUILD_BENCHMARK)
+  if (of_all_bench_cc)
+    oneflow_add_executable(oneflow_bench ${of_all_bench_cc})
+    target_include_directories(oneflow_bench PRIVATE ${BENCHMARK_INCLUDE_DIR})
+    target_link_libraries(oneflow_bench ${of_libs} ${oneflow_third_party_libs} ${oneflow_exe_third_party_libs}
+                          ${BENCHMARK_LIBRARIES})
+    set_target_properties(oneflow_bench PROPERTIES RUNTIME_OUTPUT_DIRECTORY "${PROJECT_BINARY_DIR}/bin")
+  endif()
+endif()
+
 # build include
 set(ONEFLOW_INCLUDE_DIR "${ONEFLOW_PYTHON_DIR}/oneflow/include")
 add_custom_target(of_include_copy
@@ -34,6 +34,14 @@ if (WITH_TENSORRT)
   include(tensorrt)
 endif()
 
+if (WITH_ONEDNN)
+  include(onednn)
+endif()
+
+if (BUILD_BENCHMARK)
+  include(benchmark)
+endif()
+
 include(hwloc)
 
 option(CUDA_STATIC "" ON)
@@ -52,6 +60,10 @@ if (BUILD_CUDA)
   set(VENDOR_CUDA_LIBRARIES ${CUDA_LIBRARIES})
   if(OF_CUDA_LINK_DYNAMIC_LIBRARY)
     list(APPEND VENDOR_CUDA_LIBRARIES ${CUDA_CUBLAS_LIBRARIES})
+    if(CUDA_VERSION VERSION_GREATER_EQUAL "10.1")
+      find_cuda_helper_libs(cublasLt)
+      list(APPEND VENDOR_CUDA_LIBRARIES ${CUDA_cublasLt_LIBRARY})
+    endif()
     list(APPEND VENDOR_CUDA_LIBRARIES ${CUDA_curand_LIBRARY})
     if(CUDA_VERSION VERSION_GREATER_EQUAL "10.2")
       find_cuda_helper_libs(nvjpeg)
@@ -98,6 +110,8 @@ if (BUILD_CUDA)
       message(FATAL_ERROR "cuda lib not found: ${cublas_lib_dir}/libcublas_static.a or ${cuda_lib_dir}/libcublas_static.a")
     endif()
   endif()
+  # cuda driver api, e.g. the virtual memory management used by vm::CudaAllocator
+  list(APPEND VENDOR_CUDA_LIBRARIES ${CUDA_CUDA_LIBRARY})
   find_package(CUDNN REQUIRED)
 endif()
 
@@ -257,6 +271,10 @@ if(WITH_TENSORRT)
   list(APPEND oneflow_third_party_libs ${TENSORRT_LIBRARIES})
 endif()
 
+if(WITH_ONEDNN)
+  list(APPEND oneflow_third_party_libs ${ONEDNN_LIBRARIES})
+endif()
+
 message(STATUS "oneflow_third_party_libs: ${oneflow_third_party_libs}")
 
 add_definitions(-DHALF_ENABLE_CPP11_USER_LITERALS=0)
@@ -0,0 +1,23 @@
+include (ExternalProject)
+
+if (BUILD_BENCHMARK)
+
+find_path(BENCHMARK_INCLUDE_DIR benchmark/benchmark.h
+          PATHS ${BENCHMARK_ROOT} ${BENCHMARK_ROOT}/include
+          $ENV{BENCHMARK_ROOT} $ENV{BENCHMARK_ROOT}/include
+          ${THIRD_PARTY_DIR}/benchmark/include)
+
+find_library(BENCHMARK_LIBRARIES NAMES libbenchmark.a benchmark
+             PATHS ${BENCHMARK_ROOT} ${BENCHMARK_ROOT}/lib ${BENCHMARK_ROOT}/lib64
+             $ENV{BENCHMARK_ROOT} $ENV{BENCHMARK_ROOT}/lib $ENV{BENCHMARK_ROOT}/lib64
+             ${THIRD_PARTY_DIR}/benchmark/lib)
+
+if (BENCHMARK_INCLUDE_DIR AND BENCHMARK_LIBRARIES)
+else()
+  message(FATAL_ERROR "Google Benchmark was not found. You can set BENCHMARK_ROOT to specify the search path.")
+endif()
+
+message(STATUS "Google Benchmark Include: ${BENCHMARK_INCLUDE_DIR}")
+message(STATUS "Google Benchmark Lib: ${BENCHMARK_LIBRARIES}")
+
+endif(BUILD_BENCHMARK)
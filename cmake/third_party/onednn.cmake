@@ -0,0 +1,25 @@
+include (ExternalProject)
+
+if (WITH_ONEDNN)
+
+find_path(ONEDNN_INCLUDE_DIR dnnl.hpp
+          PATHS ${ONEDNN_ROOT} ${ONEDNN_ROOT}/include
+          $ENV{ONEDNN_ROOT} $ENV{ONEDNN_ROOT}/include
+          ${THIRD_PARTY_DIR}/onednn/include)
+
+find_library(ONEDNN_LIBRARIES NAMES libdnnl.so libdnnl.a
+             PATHS ${ONEDNN_ROOT} ${ONEDNN_ROOT}/lib ${ONEDNN_ROOT}/lib64
+             $ENV{ONEDNN_ROOT} $ENV{ONEDNN_ROOT}/lib $ENV{ONEDNN_ROOT}/lib64
+             ${THIRD_PARTY_DIR}/onednn/lib)
+
+if (ONEDNN_INCLUDE_DIR AND ONEDNN_LIBRARIES)
+else()
+  message(FATAL_ERROR "oneDNN was not found. You can set ONEDNN_ROOT to specify the search path.")
+endif()
+
+message(STATUS "oneDNN Include: ${ONEDNN_INCLUDE_DIR}")
+message(STATUS "oneDNN Lib: ${ONEDNN_LIBRARIES}")
+
+include_directories(${ONEDNN_INCLUDE_DIR})
+
+endif(WITH_ONEDNN)
@@ -0,0 +1,80 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <memory>
+#include <vector>
+#include <pybind11/pybind11.h>
+#include <pybind11/functional.h>
+#include "oneflow/api/python/of_api_registry.h"
+#include "oneflow/core/autograd/saved_tensor_hooks.h"
+#include "oneflow/core/framework/tensor.h"
+
+namespace py = pybind11;
+
+namespace oneflow {
+
+namespace one {
+
+namespace {
+
+using PyTensorHook = std::function<std::shared_ptr<Tensor>(const std::shared_ptr<Tensor>&)>;
+
+SavedTensorPackHook MakePySavedTensorPackHook(const PyTensorHook& pack_hook,
+                                              const PyTensorHook& unpack_hook) {
+  return [pack_hook, unpack_hook](const std::shared_ptr<Tensor>& tensor)
+             -> Maybe<SavedTensorUnpacker> {
+    std::shared_ptr<Tensor> packed = pack_hook(tensor);
+    CHECK_OR_RETURN(packed) << "the pack hook of saved tensors must return a tensor";
+    return SavedTensorUnpacker([packed, unpack_hook]() -> Maybe<Tensor> {
+      std::shared_ptr<Tensor> unpacked = unpack_hook(packed);
+      CHECK_OR_RETURN(unpacked) << "the unpack hook of saved tensors must return a tensor";
+      return unpacked;
+    });
+  };
+}
+
+// Installs its pack hook between `__enter__' and `__exit__' of python `with' statements.
+class SavedTensorHooks final {
+ public:
+  explicit SavedTensorHooks(const SavedTensorPackHook& pack_hook) : pack_hook_(pack_hook) {}
+  ~SavedTensorHooks() = default;
+
+  void Enter() { scopes_.emplace_back(new SavedTensorHooksScope(pack_hook_)); }
+  void Exit() { scopes_.pop_back(); }
+
+ private:
+  SavedTensorPackHook pack_hook_;
+  std::vector<std::unique_ptr<SavedTensorHooksScope>> scopes_;
+};
+
+}  // namespace
+
+ONEFLOW_API_PYBIND11_MODULE("autograd", m) {
+  py::class_<SavedTensorHooks, std::shared_ptr<SavedTensorHooks>>(m, "SavedTensorHooks")
+      .def(py::init([](const PyTensorHook& pack_hook, const PyTensorHook& unpack_hook) {
+        return std::make_shared<SavedTensorHooks>(
+            MakePySavedTensorPackHook(pack_hook, unpack_hook));
+      }))
+      .def("enter", &SavedTensorHooks::Enter)
+      .def("exit", &SavedTensorHooks::Exit);
+  m.def("save_on_cpu_hooks",
+        []() { return std::make_shared<SavedTensorHooks>(MakeSaveOnCpuPackHook()); });
+  m.def("save_in_half_hooks",
+        []() { return std::make_shared<SavedTensorHooks>(MakeSaveInHalfPackHook()); });
+}
+
+}  // namespace one
+
+}  // namespace oneflow
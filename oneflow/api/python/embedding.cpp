@@ -0,0 +1,50 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include "oneflow/api/python/of_api_registry.h"
+
+#ifdef WITH_CUDA
+#include "oneflow/core/embedding/embedding_store.h"
+#endif  // WITH_CUDA
+
+namespace py = pybind11;
+
+namespace oneflow {
+
+ONEFLOW_API_PYBIND11_MODULE("embedding", m) {
+#ifdef WITH_CUDA
+  m.def("Prefetch", [](const std::string& name, std::vector<int64_t> ids) {
+    embedding::GetEmbeddingStore(name).GetOrThrow()->host_store()->Prefetch(std::move(ids));
+  });
+
+  m.def(
+      "Save",
+      [](const std::string& name, const std::string& dir) {
+        embedding::GetEmbeddingStore(name).GetOrThrow()->Save(dir);
+      },
+      py::call_guard<py::gil_scoped_release>());
+
+  m.def(
+      "Load",
+      [](const std::string& name, const std::string& dir) {
+        embedding::GetEmbeddingStore(name).GetOrThrow()->Load(dir);
+      },
+      py::call_guard<py::gil_scoped_release>());
+#endif  // WITH_CUDA
+}
+
+}  // namespace oneflow
@@ -15,8 +15,10 @@ limitations under the License.
 */
 
 #include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
 #include "oneflow/api/python/of_api_registry.h"
 #include "oneflow/core/framework/instruction_replay.h"
+#include "oneflow/core/framework/tensor.h"
 
 namespace py = pybind11;
 
@@ -33,4 +35,18 @@ ONEFLOW_API_PYBIND11_MODULE("debug", m) {
 
 }  // namespace debug
 
+ONEFLOW_API_PYBIND11_MODULE("", m) {
+  py::class_<InstructionsCapture, std::shared_ptr<InstructionsCapture>>(m, "InstructionsCapture")
+      .def(py::init<const std::vector<std::shared_ptr<one::Tensor>>&>())
+      .def("begin_capture",
+           [](InstructionsCapture& capture) { return capture.BeginCapture().GetOrThrow(); })
+      .def("end_capture",
+           [](InstructionsCapture& capture) { return capture.EndCapture().GetOrThrow(); })
+      .def("try_replay",
+           [](InstructionsCapture& capture) { return capture.TryReplay().GetOrThrow(); })
+      .def("reset", &InstructionsCapture::Reset)
+      .def_property_readonly("is_captured", &InstructionsCapture::is_captured)
+      .def_property_readonly("instruction_size", &InstructionsCapture::instruction_size);
+}
+
 }  // namespace oneflow
@@ -248,6 +248,19 @@ void ApiRegisterTensorHook(const std::shared_ptr<Tensor>& self, const AutogradMe
   return RegisterTensorHook(self, hook).GetOrThrow();
 }
 
+Maybe<void> RegisterTensorPostAccGradHook(const std::shared_ptr<Tensor>& self,
+                                          const AutogradMeta::PostAccGradHook& hook) {
+  CHECK_OR_RETURN(self->is_leaf() && self->requires_grad())
+      << "post accumulate grad hooks can only be registered on leaf tensors requiring grad";
+  if (!self->grad_fn_node()) { JUST(AddAccumulateFunctionNode(self)); }
+  self->mut_autograd_meta()->add_post_acc_grad_hook(hook);
+  return Maybe<void>::Ok();
+}
+void ApiRegisterTensorPostAccGradHook(const std::shared_ptr<Tensor>& self,
+                                      const AutogradMeta::PostAccGradHook& hook) {
+  return RegisterTensorPostAccGradHook(self, hook).GetOrThrow();
+}
+
 Maybe<void> CheckConsistentTensorMeta(const one::Tensor& tensor, int64_t seconds) {
   const auto& ctx = JUST(LaunchTensorMetaConsistencyCheck(tensor));
   JUST(RpcUtil::WaitUntilDoneOrTimeout(*ctx, seconds));
@@ -408,6 +421,7 @@ ONEFLOW_API_PYBIND11_MODULE("", m) {
       .def_property_readonly("is_local", &Tensor::is_local)
       .def("zeros_", &ApiEagerMirroredTensorZeros)
       .def("register_hook", &ApiRegisterTensorHook)
+      .def("_register_post_grad_accumulation_hook", &ApiRegisterTensorPostAccGradHook)
       // local tensor only
       .def_property_readonly("_tensor_buffer_shapes_and_dtypes", &GetTensorBufferShapesAndDTypes)
       .def_property_readonly("device", &TensorGetDevice)
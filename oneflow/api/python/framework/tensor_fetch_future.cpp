@@ -0,0 +1,71 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+#include <cstring>
+
+#include "oneflow/api/python/of_api_registry.h"
+#include "oneflow/api/foreign_lock_helper.h"
+#include "oneflow/core/common/global.h"
+#include "oneflow/core/framework/tensor.h"
+#include "oneflow/core/framework/tensor_fetch_future.h"
+#include "oneflow/extension/python/numpy.h"
+
+namespace py = pybind11;
+
+namespace oneflow {
+
+namespace one {
+
+namespace {
+
+std::shared_ptr<TensorFetchFuture> ApiAsyncFetchTensor(const std::shared_ptr<Tensor>& tensor) {
+  return AsyncFetchMirroredTensor(tensor->AsMirroredTensor().GetPtrOrThrow()).GetPtrOrThrow();
+}
+
+void ApiWait(const TensorFetchFuture& future) {
+  Global<ForeignLockHelper>::Get()->WithScopedRelease([&future]() { future.Wait(); });
+}
+
+py::object ApiNumpy(const TensorFetchFuture& future) {
+  ApiWait(future);
+  // Executing any numpy c api before _import_array() results in segfault
+  if (PyArray_API == nullptr) { _import_array(); }
+  const int type_num = numpy::OFDataTypeToNumpyType(future.data_type()).GetOrThrow();
+  const Shape& shape = future.shape();
+  std::vector<npy_intp> dims(shape.dim_vec().begin(), shape.dim_vec().end());
+  PyObject* np_array = PyArray_SimpleNew(dims.size(), dims.data(), type_num);
+  CHECK_NOTNULL(np_array);
+  if (future.byte_size() > 0) {
+    std::memcpy(PyArray_DATA(reinterpret_cast<PyArrayObject*>(np_array)), future.data(),
+                future.byte_size());
+  }
+  return py::reinterpret_steal<py::object>(np_array);
+}
+
+}  // namespace
+
+ONEFLOW_API_PYBIND11_MODULE("", m) {
+  py::class_<TensorFetchFuture, std::shared_ptr<TensorFetchFuture>>(m, "TensorFetchFuture")
+      .def("done", &TensorFetchFuture::Poll)
+      .def("wait", &ApiWait)
+      .def("numpy", &ApiNumpy);
+  m.def("async_fetch_tensor", &ApiAsyncFetchTensor);
+}
+
+}  // namespace one
+
+}  // namespace oneflow
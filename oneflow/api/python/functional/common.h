@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef ONEFLOW_API_PYTHON_FUNCTIONAL_COMMON_H_
 #define ONEFLOW_API_PYTHON_FUNCTIONAL_COMMON_H_
 
+#include <limits>
 #include <string>
 #include <vector>
 #include <pybind11/pybind11.h>
@@ -86,6 +87,27 @@ inline Maybe<T> cast(py::handle obj) {
   return type_caster<T>::cast(obj);
 }
 
+// Reads python ints directly instead of going through the generic pybind11 caster, which is
+// the hot path of shapes and int lists.
+template<typename T>
+struct integer_type_caster {
+  static Maybe<T> cast(py::handle src) {
+    PyObject* obj = src.ptr();
+    if (!PyLong_Check(obj)) { return py::cast<T>(src); }
+    int overflow = 0;
+    long long value = PyLong_AsLongLongAndOverflow(obj, &overflow);
+    CHECK_OR_RETURN(overflow == 0 && value >= std::numeric_limits<T>::min()
+                    && value <= std::numeric_limits<T>::max())
+        << "The python int " << value << " is out of range";
+    return static_cast<T>(value);
+  }
+};
+
+template<>
+struct type_caster<int32_t> : public integer_type_caster<int32_t> {};
+template<>
+struct type_caster<int64_t> : public integer_type_caster<int64_t> {};
+
 template<typename T>
 struct type_caster<std::vector<T>> {
   static Maybe<std::vector<T>> cast(py::handle src);
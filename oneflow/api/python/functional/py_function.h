@@ -18,6 +18,7 @@ limitations under the License.
 #include "oneflow/api/python/functional/python_arg.h"
 #include "oneflow/api/python/functional/unpack_call.h"
 #include "oneflow/api/python/framework/throw.h"
+#include "oneflow/core/profiler/host_stage_timing.h"
 
 namespace py = pybind11;
 
@@ -27,6 +28,7 @@ namespace functional {
 
 template<typename SchemaT>
 inline py::object PyFunction(py::args args, py::kwargs kwargs) {
+  OF_HOST_STAGE_TIMING_GUARD(kHostStagePythonBinding);
   // TODO(): Support multiple function signatures.
   CHECK_LE_OR_THROW(args.size(), SchemaT::max_positionals)
       << "The maximum count of positional arguments is " << SchemaT::max_positionals;
@@ -49,7 +51,115 @@ inline py::object PyFunction(py::args args, py::kwargs kwargs) {
   }
   using FType = typename SchemaT::FType;
   using R = typename SchemaT::R;
-  return py::cast(detail::unpack_call<FType, R>::apply(*SchemaT::func, _args));
+  R result = [&]() {
+    OF_HOST_STAGE_TIMING_GUARD(kHostStageFunctor);
+    return detail::unpack_call<FType, R>::apply(*SchemaT::func, _args);
+  }();
+  return py::cast(std::move(result));
+}
+
+#if PY_VERSION_HEX >= 0x03070000
+
+namespace detail {
+
+// Sets the python error of the exception being handled with the translators registered to
+// pybind11, in the order the dispatcher of pybind11 functions tries them.
+inline void SetPyErrorFromCurrentException() {
+  auto& translators = py::detail::get_internals().registered_exception_translators;
+  std::exception_ptr last_exception = std::current_exception();
+  for (auto& translator : translators) {
+    try {
+      translator(last_exception);
+      return;
+    } catch (...) { last_exception = std::current_exception(); }
+  }
+  PyErr_SetString(PyExc_SystemError, "Exception escaped from default exception translator!");
+}
+
+template<typename SchemaT>
+const std::vector<PyObject*>& InternedArgNames() {
+  static const std::vector<PyObject*> names = [] {
+    std::vector<PyObject*> interned(SchemaT::max_args);
+    for (int i = 0; i < SchemaT::max_args; ++i) {
+      interned[i] = PyUnicode_InternFromString(SchemaT::argument_def.at(i).name.c_str());
+    }
+    return interned;
+  }();
+  return names;
+}
+
+// Returns the value of the keyword argument named name, or nullptr. The keywords of calls from
+// python are interned, so they almost always match by pointer.
+inline PyObject* FindKeywordArg(PyObject* const* kwargs, PyObject* kwnames, PyObject* name) {
+  const Py_ssize_t num_kwargs = PyTuple_GET_SIZE(kwnames);
+  for (Py_ssize_t i = 0; i < num_kwargs; ++i) {
+    if (PyTuple_GET_ITEM(kwnames, i) == name) { return kwargs[i]; }
+  }
+  for (Py_ssize_t i = 0; i < num_kwargs; ++i) {
+    if (PyUnicode_Compare(PyTuple_GET_ITEM(kwnames, i), name) == 0) { return kwargs[i]; }
+  }
+  return nullptr;
+}
+
+}  // namespace detail
+
+// The METH_FASTCALL entry of functional apis, which reads the arguments from the vector of the
+// caller instead of the tuple and dict pybind11 builds for PyFunction.
+template<typename SchemaT>
+PyObject* PyFastCallFunction(PyObject* self, PyObject* const* args, Py_ssize_t nargs,
+                             PyObject* kwnames) {
+  try {
+    OF_HOST_STAGE_TIMING_GUARD(kHostStagePythonBinding);
+    const Py_ssize_t num_kwargs = kwnames ? PyTuple_GET_SIZE(kwnames) : 0;
+    CHECK_LE_OR_THROW(nargs, SchemaT::max_positionals)
+        << "The maximum count of positional arguments is " << SchemaT::max_positionals;
+    CHECK_LE_OR_THROW(num_kwargs, SchemaT::max_keywords)
+        << "The maximum count of keyword arguments is " << SchemaT::max_keywords;
+    const auto& arg_names = detail::InternedArgNames<SchemaT>();
+    std::vector<PythonArg> _args(SchemaT::max_args);
+    for (int i = 0; i < nargs; ++i) {
+      _args[i] = PythonArg(py::reinterpret_borrow<py::object>(args[i]));
+    }
+    for (int i = nargs; i < SchemaT::max_args; ++i) {
+      PyObject* value =
+          num_kwargs > 0 ? detail::FindKeywordArg(args + nargs, kwnames, arg_names[i]) : nullptr;
+      if (value != nullptr) {
+        _args[i] = PythonArg(py::reinterpret_borrow<py::object>(value));
+      } else {
+        const auto& arg = SchemaT::argument_def.at(i);
+        CHECK_OR_THROW(arg.has_default_value)
+            << "Argument " << arg.name << " is required, and the function def is \""
+            << SchemaT::signature << "\".";
+        _args[i] = PythonArg(arg.default_value);
+      }
+    }
+    using FType = typename SchemaT::FType;
+    using R = typename SchemaT::R;
+    R result = [&]() {
+      OF_HOST_STAGE_TIMING_GUARD(kHostStageFunctor);
+      return detail::unpack_call<FType, R>::apply(*SchemaT::func, _args);
+    }();
+    return py::cast(std::move(result)).release().ptr();
+  } catch (...) {
+    detail::SetPyErrorFromCurrentException();
+    return nullptr;
+  }
+}
+
+#endif  // PY_VERSION_HEX >= 0x03070000
+
+template<typename SchemaT>
+void AddPyFunction(py::module& m, const char* name) {
+#if PY_VERSION_HEX >= 0x03070000
+  // lives as long as the module
+  PyMethodDef* def = new PyMethodDef{
+      name, reinterpret_cast<PyCFunction>(reinterpret_cast<void (*)()>(
+                &PyFastCallFunction<SchemaT>)),
+      METH_FASTCALL | METH_KEYWORDS, SchemaT::signature};
+  m.add_object(name, py::reinterpret_steal<py::object>(PyCFunction_NewEx(def, nullptr, m.ptr())));
+#else
+  m.def(name, &PyFunction<SchemaT>);
+#endif
 }
 
 }  // namespace functional
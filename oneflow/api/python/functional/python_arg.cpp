@@ -18,6 +18,7 @@ limitations under the License.
 
 #include "oneflow/api/python/functional/common.h"
 #include "oneflow/api/python/functional/indexing.h"
+#include "oneflow/core/common/data_type.h"
 #include "oneflow/core/common/data_type.cfg.h"
 #include "oneflow/core/framework/attr_map.h"
 #include "oneflow/core/framework/dtype.h"
@@ -53,7 +54,17 @@ OF_PP_FOR_EACH_TUPLE(INSTANCE_CAST_OBJECT_AS,
 template<>
 Maybe<Scalar> PythonArg::ObjectAs<Scalar>() const {
   py::object obj = Borrow();
-  if (detail::isinstance<int32_t>(obj)) {
+  if (PyLong_Check(obj.ptr())) {
+    int overflow = 0;
+    long long value = PyLong_AsLongLongAndOverflow(obj.ptr(), &overflow);
+    CHECK_EQ_OR_RETURN(overflow, 0) << "The python int is out of the range of int64";
+    if (value >= GetMinVal<int32_t>() && value <= GetMaxVal<int32_t>()) {
+      return Scalar(static_cast<int32_t>(value));
+    }
+    return Scalar(static_cast<int64_t>(value));
+  } else if (PyFloat_Check(obj.ptr())) {
+    return Scalar(static_cast<float>(PyFloat_AS_DOUBLE(obj.ptr())));
+  } else if (detail::isinstance<int32_t>(obj)) {
     return Scalar(JUST(detail::cast<int32_t>(obj)));
   } else if (detail::isinstance<int64_t>(obj)) {
     return Scalar(JUST(detail::cast<int64_t>(obj)));
@@ -19,6 +19,7 @@ limitations under the License.
 #include "oneflow/api/python/functional/python_arg.h"
 
 #include <tuple>
+#include <pybind11/pybind11.h>
 #include "oneflow/api/python/framework/throw.h"
 #include "oneflow/core/framework/tensor.h"
 #include "oneflow/core/framework/tensor_tuple.h"
@@ -45,6 +46,9 @@ template<typename F, typename R, int index>
 struct unpack_call_dispatcher<F, R, 0, index> {
   template<typename... Args>
   static R apply(const F& f, const std::vector<PythonArg>& args, Args&&... unpacked_args) {
+    // All the arguments have been converted to c++ values, so the interpretation and the
+    // instruction submission of the functor let other python threads run.
+    py::gil_scoped_release release;
     return f(std::forward<Args>(unpacked_args)...);
   }
 };
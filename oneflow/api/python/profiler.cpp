@@ -17,6 +17,9 @@ limitations under the License.
 #include "oneflow/api/python/of_api_registry.h"
 
 #include "oneflow/core/profiler/profiler.h"
+#include "oneflow/core/profiler/host_stage_timing.h"
+#include "oneflow/core/profiler/host_tracer.h"
+#include "oneflow/core/profiler/kernel_timing.h"
 
 namespace py = pybind11;
 
@@ -30,6 +33,63 @@ ONEFLOW_API_PYBIND11_MODULE("profiler", m) {
   m.def("ProfilerStart", []() { profiler::ProfilerStart(); });
 
   m.def("ProfilerStop", []() { profiler::ProfilerStop(); });
+
+  m.def("EnableHostTracing", []() { profiler::EnableHostTracing(); });
+
+  m.def("DisableHostTracing", []() { profiler::DisableHostTracing(); });
+
+  m.def("IsHostTracingEnabled", []() { return profiler::IsHostTracingEnabled(); });
+
+  m.def("DumpHostTrace", [](const std::string& path) { profiler::DumpHostTrace(path); });
+
+  m.def("ClearHostTrace", []() { profiler::ClearHostTrace(); });
+
+  m.def("EnableKernelTiming", []() { profiler::EnableKernelTiming(); });
+
+  m.def("DisableKernelTiming", []() { profiler::DisableKernelTiming(); });
+
+  m.def("IsKernelTimingEnabled", []() { return profiler::IsKernelTimingEnabled(); });
+
+  m.def("GetKernelTimingTable", []() {
+    py::list table;
+    for (const auto& row : profiler::GetKernelTimingTable()) {
+      py::dict item;
+      item["op_type_name"] = row.op_type_name;
+      item["op_name"] = row.op_name;
+      item["call_cnt"] = row.call_cnt;
+      item["total_ms"] = row.total_ms;
+      item["mean_ms"] = row.mean_ms;
+      item["p99_ms"] = row.p99_ms;
+      item["total_bytes"] = row.total_bytes;
+      item["total_flops"] = row.total_flops;
+      table.append(item);
+    }
+    return table;
+  });
+
+  m.def("ResetKernelTiming", []() { profiler::ResetKernelTiming(); });
+
+  m.def("EnableHostStageTiming", []() { profiler::EnableHostStageTiming(); });
+
+  m.def("DisableHostStageTiming", []() { profiler::DisableHostStageTiming(); });
+
+  m.def("IsHostStageTimingEnabled", []() { return profiler::IsHostStageTimingEnabled(); });
+
+  m.def("GetHostStageTimingTable", []() {
+    py::list table;
+    for (const auto& row : profiler::GetHostStageTimingTable()) {
+      py::dict item;
+      item["stage"] = row.stage;
+      item["call_cnt"] = row.call_cnt;
+      item["total_us"] = row.total_us;
+      item["self_us"] = row.self_us;
+      item["mean_us"] = row.mean_us;
+      table.append(item);
+    }
+    return table;
+  });
+
+  m.def("ResetHostStageTiming", []() { profiler::ResetHostStageTiming(); });
 }
 
 }  // namespace oneflow
@@ -0,0 +1,105 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifdef __linux__
+
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include <chrono>
+#include "oneflow/api/python/of_api_registry.h"
+#include "oneflow/core/common/blocking_counter.h"
+#include "oneflow/core/control/global_process_ctx.h"
+#include "oneflow/core/framework/rpc_token.h"
+#include "oneflow/core/transport/transport.h"
+
+namespace py = pybind11;
+
+namespace oneflow {
+
+namespace {
+
+Maybe<uint64_t> NewBenchmarkToken(int64_t src_rank, int64_t dst_rank) {
+  RpcToken token = RpcToken::NewDataRpcToken();
+  JUST(token.set_src_rank(src_rank));
+  JUST(token.set_dst_rank(dst_rank));
+  return static_cast<uint64_t>(token);
+}
+
+// One round trip of `size' bytes between rank 0 and rank 1.
+Maybe<void> PingPong(Transport* transport, std::vector<char>* buffer, std::size_t size) {
+  const int64_t rank = GlobalProcessCtx::Rank();
+  const int64_t peer = 1 - rank;
+  const uint64_t ping_token = JUST(NewBenchmarkToken(0, 1));
+  const uint64_t pong_token = JUST(NewBenchmarkToken(1, 0));
+  BlockingCounter counter(1);
+  if (rank == 0) {
+    transport->Send(ping_token, peer, buffer->data(), size, []() {});
+    transport->Receive(pong_token, peer, buffer->data(), size,
+                       [&counter]() { counter.Decrease(); });
+  } else {
+    BlockingCounter ping_counter(1);
+    transport->Receive(ping_token, peer, buffer->data(), size,
+                       [&ping_counter]() { ping_counter.Decrease(); });
+    ping_counter.WaitUntilCntEqualZero();
+    transport->Send(pong_token, peer, buffer->data(), size, [&counter]() { counter.Decrease(); });
+  }
+  counter.WaitUntilCntEqualZero();
+  return Maybe<void>::Ok();
+}
+
+// Ping-pongs buffers of min_size, 2 * min_size, ..., max_size bytes between rank 0 and rank 1, and
+// returns (size, one-way latency in us, bandwidth in GB/s) of each size. Ranks other than 0 and 1
+// only keep their data rpc tokens in step. All ranks must call it.
+Maybe<std::vector<std::tuple<int64_t, double, double>>> BenchmarkTransport(int64_t min_size,
+                                                                           int64_t max_size,
+                                                                           int64_t iters) {
+  CHECK_GE_OR_RETURN(GlobalProcessCtx::WorldSize(), 2);
+  CHECK_GT_OR_RETURN(min_size, 0);
+  CHECK_GT_OR_RETURN(iters, 0);
+  auto* transport = JUST(GlobalMaybe<Transport>());
+  const bool is_participant = GlobalProcessCtx::Rank() < 2;
+  std::vector<char> buffer(is_participant ? max_size : 0);
+  std::vector<std::tuple<int64_t, double, double>> results;
+  for (int64_t size = min_size; size <= max_size; size *= 2) {
+    if (!is_participant) {
+      FOR_RANGE(int64_t, i, 0, 2 * (iters + 1)) { JUST(NewBenchmarkToken(0, 1)); }
+      continue;
+    }
+    // warm up
+    JUST(PingPong(transport, &buffer, size));
+    const auto start = std::chrono::steady_clock::now();
+    FOR_RANGE(int64_t, i, 0, iters) { JUST(PingPong(transport, &buffer, size)); }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    const double one_way_seconds = elapsed.count() / iters / 2;
+    results.emplace_back(size, one_way_seconds * 1e6, size / one_way_seconds / 1e9);
+  }
+  return results;
+}
+
+}  // namespace
+
+ONEFLOW_API_PYBIND11_MODULE("", m) {
+  m.def(
+      "benchmark_transport",
+      [](int64_t min_size, int64_t max_size, int64_t iters) {
+        return BenchmarkTransport(min_size, max_size, iters).GetOrThrow();
+      },
+      py::arg("min_size") = 4 * 1024, py::arg("max_size") = 1024 * 1024 * 1024,
+      py::arg("iters") = 10, py::call_guard<py::gil_scoped_release>());
+}
+
+}  // namespace oneflow
+
+#endif  // __linux__
@@ -0,0 +1,61 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <pybind11/pybind11.h>
+#include "oneflow/api/python/of_api_registry.h"
+#include "oneflow/core/serving/inference_server.h"
+
+namespace py = pybind11;
+
+namespace oneflow {
+
+ONEFLOW_API_PYBIND11_MODULE("", m) {
+  m.def(
+      "StartInferenceServer",
+      [](const std::string& job_name, int64_t max_batch_size, int64_t batch_timeout_us) {
+        return InferenceServerMgr::Singleton()
+            ->AddServer(job_name, max_batch_size, batch_timeout_us)
+            .GetOrThrow();
+      },
+      py::call_guard<py::gil_scoped_release>());
+  m.def(
+      "StartInferenceGrpcServer",
+      [](const std::string& address) {
+        return InferenceServerMgr::Singleton()->StartGrpcServer(address).GetOrThrow();
+      },
+      py::call_guard<py::gil_scoped_release>());
+  m.def(
+      "InferenceServerInfer",
+      [](const std::string& serialized_request) -> py::bytes {
+        InferRequest request;
+        CHECK(request.ParseFromString(serialized_request));
+        std::string serialized_response;
+        {
+          py::gil_scoped_release release;
+          std::future<InferResponse> response;
+          InferenceServerMgr::Singleton()
+              ->GetServer(request.job_name())
+              .GetOrThrow()
+              ->Infer(request, &response)
+              .GetOrThrow();
+          serialized_response = response.get().SerializeAsString();
+        }
+        return py::bytes(serialized_response);
+      });
+  m.def("StopInferenceServers", []() { InferenceServerMgr::Singleton()->Clear(); },
+        py::call_guard<py::gil_scoped_release>());
+}
+
+}  // namespace oneflow
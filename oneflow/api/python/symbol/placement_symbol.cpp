@@ -25,6 +25,7 @@ limitations under the License.
 #include "oneflow/core/job/placement.cfg.h"
 #include "oneflow/core/job/global_for.h"
 #include "oneflow/core/job/resource_desc.h"
+#include "oneflow/core/job/eager_nccl_comm_manager.h"
 
 namespace py = pybind11;
 
@@ -244,6 +245,16 @@ ONEFLOW_API_PYBIND11_MODULE("", m) {
       .def(py::self == py::self)
       .def(py::hash(py::self));
   m.def("AllDevicePlacement", &PlacementSymbolExportUtil::AllDevicePlacement);
+  m.def(
+      "PrewarmNcclComms",
+      [](Symbol<ParallelDesc> placement) {
+#ifdef WITH_CUDA
+        if (placement->device_type() != DeviceType::kGPU) { return; }
+        Global<EagerNcclCommMgr>::Get()->CreateCommsForParallelDesc(
+            *placement, EagerNcclCommMgr::kDefaultStreamId);
+#endif  // WITH_CUDA
+      },
+      py::call_guard<py::gil_scoped_release>());
 }
 
 }  // namespace oneflow
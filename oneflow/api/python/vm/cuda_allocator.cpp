@@ -0,0 +1,58 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+#include "oneflow/api/python/of_api_registry.h"
+#include "oneflow/core/vm/cuda_allocator.h"
+
+namespace py = pybind11;
+
+namespace oneflow {
+namespace vm {
+
+ONEFLOW_API_PYBIND11_MODULE("vm", m) {
+  py::class_<CudaAllocatorStats>(m, "CudaAllocatorStats")
+      .def_readonly("reserved_bytes", &CudaAllocatorStats::reserved_bytes)
+      .def_readonly("allocated_bytes", &CudaAllocatorStats::allocated_bytes)
+      .def_readonly("peak_allocated_bytes", &CudaAllocatorStats::peak_allocated_bytes)
+      .def_readonly("largest_free_piece_bytes", &CudaAllocatorStats::largest_free_piece_bytes)
+      .def_readonly("block_num", &CudaAllocatorStats::block_num)
+      .def_readonly("allocate_num", &CudaAllocatorStats::allocate_num)
+      .def_readonly("deallocate_num", &CudaAllocatorStats::deallocate_num)
+      .def_readonly("extend_num", &CudaAllocatorStats::extend_num)
+      .def_readonly("extend_failure_num", &CudaAllocatorStats::extend_failure_num)
+      .def_readonly("gc_num", &CudaAllocatorStats::gc_num)
+      .def_readonly("gc_freed_bytes", &CudaAllocatorStats::gc_freed_bytes)
+      .def_readonly("bin_free_piece_num", &CudaAllocatorStats::bin_free_piece_num)
+      .def_readonly("allocation_size_histogram", &CudaAllocatorStats::allocation_size_histogram);
+
+  m.def("GetCudaAllocatorStats", [](int64_t device_id) {
+    CudaAllocatorStats stats;
+#ifdef WITH_CUDA
+    StreamBoundCudaAllocator::GetSharedCudaAllocatorStats(device_id, &stats);
+#endif  // WITH_CUDA
+    return stats;
+  });
+
+  m.def("ResetCudaAllocatorPeakStats", [](int64_t device_id) {
+#ifdef WITH_CUDA
+    StreamBoundCudaAllocator::ResetSharedCudaAllocatorPeakStats(device_id);
+#endif  // WITH_CUDA
+  });
+}
+
+}  // namespace vm
+}  // namespace oneflow
@@ -0,0 +1,217 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <json.hpp>
+#include "oneflow/core/actor/act_timeline.h"
+#include "oneflow/core/control/global_process_ctx.h"
+#include "oneflow/core/graph/chain_act_graph.h"
+#include "oneflow/core/job/improver.h"
+#include "oneflow/core/operator/operator.h"
+#include "oneflow/core/persistence/tee_persistent_log_stream.h"
+
+namespace oneflow {
+
+namespace {
+
+const double kNanosecondsPerMicrosecond = 1000;
+
+std::string ActorName4TaskProto(const TaskProto& task_proto) {
+  std::string name = TaskType_Name(task_proto.task_type());
+  if (task_proto.exec_sequence().exec_node_size() > 0) {
+    name += ":"
+            + task_proto.exec_sequence().exec_node(0).kernel_conf().op_attribute().op_conf().name();
+  }
+  return name;
+}
+
+std::string ChromeTrace4ActEvents(const HashMap<int64_t, const TaskProto*>& task_id2task_proto,
+                                  const std::list<std::unique_ptr<ActEvent>>& act_events) {
+  nlohmann::json trace_events = nlohmann::json::array();
+  for (const auto& act_event : act_events) {
+    const auto& task_proto_it = task_id2task_proto.find(act_event->actor_id());
+    if (task_proto_it == task_id2task_proto.end()) { continue; }
+    nlohmann::json read_regsts = nlohmann::json::array();
+    for (const auto& readable : act_event->readable_regst_infos()) {
+      read_regsts.push_back({{"regst_desc_id", readable.regst_desc_id()},
+                             {"act_id", readable.act_id()}});
+    }
+    nlohmann::json trace_event;
+    trace_event["name"] = ActorName4TaskProto(*task_proto_it->second);
+    trace_event["cat"] = "act";
+    trace_event["ph"] = "X";
+    trace_event["pid"] = GlobalProcessCtx::Rank();
+    trace_event["tid"] = act_event->work_stream_id();
+    trace_event["ts"] = act_event->start_time() / kNanosecondsPerMicrosecond;
+    trace_event["dur"] = Duration4ActEvent(*act_event) / kNanosecondsPerMicrosecond;
+    trace_event["args"] = {
+        {"actor_id", act_event->actor_id()},
+        {"act_id", act_event->act_id()},
+        {"ready_wait_us",
+         (act_event->start_time() - act_event->ready_time()) / kNanosecondsPerMicrosecond},
+        {"read_regsts", read_regsts}};
+    trace_events.push_back(trace_event);
+  }
+  nlohmann::json trace;
+  trace["traceEvents"] = trace_events;
+  trace["displayTimeUnit"] = "ms";
+  return trace.dump();
+}
+
+// Idle time of each work stream between the first and the last act of each sampled act id, summed
+// over the act ids. With one pipeline stage per device the compute stream idle time is the bubble
+// of the stage.
+std::string StreamIdle4ActEvents(const std::list<std::unique_ptr<ActEvent>>& act_events) {
+  HashMap<int64_t, HashMap<int64_t, std::vector<std::pair<double, double>>>>
+      stream_id2act_id2intervals;
+  for (const auto& act_event : act_events) {
+    stream_id2act_id2intervals[act_event->work_stream_id()][act_event->act_id()].emplace_back(
+        act_event->start_time(), act_event->stop_time());
+  }
+  std::string str;
+  for (auto& stream_pair : stream_id2act_id2intervals) {
+    double span = 0;
+    double busy_time = 0;
+    for (auto& act_pair : stream_pair.second) {
+      auto& intervals = act_pair.second;
+      std::sort(intervals.begin(), intervals.end());
+      double cur_begin = intervals.front().first;
+      double cur_end = intervals.front().second;
+      for (const auto& interval : intervals) {
+        if (interval.first > cur_end) {
+          busy_time += cur_end - cur_begin;
+          cur_begin = interval.first;
+        }
+        cur_end = std::max(cur_end, interval.second);
+      }
+      busy_time += cur_end - cur_begin;
+      span += cur_end - intervals.front().first;
+    }
+    str += "work_stream_id: " + std::to_string(stream_pair.first)
+           + " span_us: " + std::to_string(span / kNanosecondsPerMicrosecond)
+           + " idle_us: " + std::to_string((span - busy_time) / kNanosecondsPerMicrosecond)
+           + " idle_ratio: " + std::to_string(span > 0 ? (span - busy_time) / span : 0) + "\n";
+  }
+  return str;
+}
+
+bool IsBoxingTaskType(TaskType task_type) {
+  return task_type == TaskType::kCopyHd || task_type == TaskType::kCopyCommNet
+         || task_type == TaskType::kSliceBoxing || task_type == TaskType::kCollectiveBoxingGeneric
+         || task_type == TaskType::kCollectiveBoxingPack
+         || task_type == TaskType::kCollectiveBoxingUnpack
+         || task_type == TaskType::kBoxingIdentity || task_type == TaskType::kBoxingZeros;
+}
+
+// Time the boxing actors of each blob run per sampled act id, with the most expensive blobs first.
+// The blobs are the lbis of the boxing csv written in debug mode.
+std::string BoxingCost4ActEvents(const HashMap<int64_t, const TaskProto*>& task_id2task_proto,
+                                 const std::list<std::unique_ptr<ActEvent>>& act_events) {
+  HashMap<std::string, HashSet<int64_t>> lbn2actor_ids;
+  HashMap<std::string, HashSet<int64_t>> lbn2act_ids;
+  HashMap<std::string, double> lbn2total_time;
+  for (const auto& act_event : act_events) {
+    const TaskProto* task_proto = task_id2task_proto.at(act_event->actor_id());
+    if (!IsBoxingTaskType(task_proto->task_type())) { continue; }
+    if (task_proto->exec_sequence().exec_node_size() == 0) { continue; }
+    const auto& bn_in_op2lbi = task_proto->exec_sequence()
+                                   .exec_node(0)
+                                   .kernel_conf()
+                                   .op_attribute()
+                                   .arg_signature()
+                                   .bn_in_op2lbi();
+    if (bn_in_op2lbi.empty()) { continue; }
+    const std::string lbn = GenLogicalBlobName(bn_in_op2lbi.begin()->second);
+    lbn2actor_ids[lbn].insert(act_event->actor_id());
+    lbn2act_ids[lbn].insert(act_event->act_id());
+    lbn2total_time[lbn] += Duration4ActEvent(*act_event);
+  }
+  std::vector<std::pair<double, std::string>> cost2lbn;
+  for (const auto& pair : lbn2total_time) {
+    cost2lbn.emplace_back(pair.second / lbn2act_ids.at(pair.first).size(), pair.first);
+  }
+  std::sort(cost2lbn.rbegin(), cost2lbn.rend());
+  std::string str;
+  for (const auto& pair : cost2lbn) {
+    str += "lbi: " + pair.second
+           + " num_actors: " + std::to_string(lbn2actor_ids.at(pair.second).size())
+           + " time_per_act_us: " + std::to_string(pair.first / kNanosecondsPerMicrosecond) + "\n";
+  }
+  return str;
+}
+
+}  // namespace
+
+ActTimeline::ActTimeline()
+    : sample_interval_(ParseIntegerFromEnv("ONEFLOW_ACTOR_TIMELINE_SAMPLE_INTERVAL", 0)) {
+  CHECK_GT(sample_interval_, 0);
+}
+
+bool ActTimeline::IsEnabled() {
+  return ParseIntegerFromEnv("ONEFLOW_ACTOR_TIMELINE_SAMPLE_INTERVAL", 0) > 0;
+}
+
+void ActTimeline::AddActEvent(const ActEvent& act_event) {
+  std::unique_ptr<ActEvent> act_event_ptr(new ActEvent(act_event));
+  std::unique_lock<std::mutex> lock(mutex_);
+  act_events_.push_back(std::move(act_event_ptr));
+}
+
+void ActTimeline::DumpAndClear(const Plan& plan) {
+  std::list<std::unique_ptr<ActEvent>> act_events;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    act_events.swap(act_events_);
+  }
+  if (act_events.empty()) { return; }
+  HashMap<int64_t, const TaskProto*> task_id2task_proto;
+  for (const TaskProto& task_proto : plan.task()) {
+    task_id2task_proto.emplace(task_proto.task_id(), &task_proto);
+  }
+  // acts of the actors not in this plan are sampled by another runtime
+  act_events.remove_if([&](const std::unique_ptr<ActEvent>& act_event) {
+    return task_id2task_proto.find(act_event->actor_id()) == task_id2task_proto.end();
+  });
+  auto trace_stream = TeePersistentLogStream::Create("act_timeline.json");
+  trace_stream << ChromeTrace4ActEvents(task_id2task_proto, act_events);
+  auto idle_stream = TeePersistentLogStream::Create("act_stream_idle.txt");
+  idle_stream << StreamIdle4ActEvents(act_events);
+  auto boxing_stream = TeePersistentLogStream::Create("act_boxing_cost.txt");
+  boxing_stream << BoxingCost4ActEvents(task_id2task_proto, act_events);
+
+  ChainActGraph graph(plan, std::move(act_events));
+  auto log_stream = TeePersistentLogStream::Create("act_critical_path.txt");
+  graph.ForEachActIdCriticalPath(
+      [&](int64_t act_id, double duration, const std::vector<const ChainActNode*>& path) {
+        log_stream << "act_id: " << std::to_string(act_id) << " critical_path_duration_us: "
+                   << std::to_string(duration / kNanosecondsPerMicrosecond) << "\n";
+        for (const ChainActNode* node : path) {
+          log_stream << "  chain_id: " << std::to_string(node->chain_id()) << " duration_us: "
+                     << std::to_string(node->duration() / kNanosecondsPerMicrosecond) << "\n";
+          node->ForEachActEvent([&](const ActEvent* act_event) {
+            const TaskProto* task_proto = task_id2task_proto.at(act_event->actor_id());
+            log_stream << "    " << ActorName4TaskProto(*task_proto)
+                       << " actor_id: " << std::to_string(act_event->actor_id()) << "\n";
+          });
+        }
+      });
+  // only the master knows the available memory of all machines
+  if (Global<AvailableMemDesc>::Get() != nullptr) {
+    RegstNumHints hints;
+    CHECK_JUST(Improver().GenRegstNumHints(*Global<AvailableMemDesc>::Get(), plan, graph, &hints));
+    TeePersistentLogStream::Create("regst_num_hints.prototxt")->Write(hints);
+  }
+}
+
+}  // namespace oneflow
@@ -0,0 +1,58 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_ACTOR_ACT_TIMELINE_H_
+#define ONEFLOW_CORE_ACTOR_ACT_TIMELINE_H_
+
+#include "oneflow/core/common/util.h"
+#include "oneflow/core/actor/act_event.pb.h"
+#include "oneflow/core/job/plan.pb.h"
+
+namespace oneflow {
+
+// ActTimeline samples the acts whose act id is a multiple of the environment variable
+// ONEFLOW_ACTOR_TIMELINE_SAMPLE_INTERVAL (disabled if not positive). A sampled act records when
+// it got ready, when it started and stopped on its stream, and which regsts it read.
+class ActTimeline final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(ActTimeline);
+  ~ActTimeline() = default;
+
+  static bool IsEnabled();
+
+  bool IsSampledAct(int64_t act_id) const { return act_id % sample_interval_ == 0; }
+  // thread safe
+  void AddActEvent(const ActEvent& act_event);
+
+  // Writes the sampled acts to `act_timeline.json' in chrome trace format, the idle time of each
+  // work stream to `act_stream_idle.txt', the time of the boxing actors of each blob to
+  // `act_boxing_cost.txt' and the critical path through ChainActGraph of each sampled act id to
+  // `act_critical_path.txt', then drops them. On the master the register nums
+  // Improver finds for the critical paths go to `regst_num_hints.prototxt', which the next compile
+  // reads from the file named by ONEFLOW_REGST_NUM_HINTS_FILE.
+  void DumpAndClear(const Plan& plan);
+
+ private:
+  friend class Global<ActTimeline>;
+  ActTimeline();
+
+  const int64_t sample_interval_;
+  std::mutex mutex_;
+  std::list<std::unique_ptr<ActEvent>> act_events_;
+};
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_ACTOR_ACT_TIMELINE_H_
@@ -14,6 +14,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #include "oneflow/core/actor/actor.h"
+#include "oneflow/core/actor/act_timeline.h"
 #include "oneflow/core/control/global_process_ctx.h"
 #include "oneflow/core/thread/thread_manager.h"
 #include "oneflow/core/job/runtime_job_descs.h"
@@ -179,6 +180,9 @@ void Actor::InitBnInOp2BlobInfo(const TaskProto& task_proto) {
           && Global<RegstMgr>::Get()->HasRegstDescId(regst_desc_id_it->second)) {
         const int64_t regst_desc_id = regst_desc_id_it->second;
         blob_info.regst_desc_id = regst_desc_id;
+        blob_info.blob_index = ek.launch_blobs.size();
+        ek.launch_blobs.push_back(nullptr);
+        ek.is_launch_blob_resolved.push_back(false);
         const RtRegstDesc& regst_desc =
             Global<RegstMgr>::Get()->RegstDesc4RegstDescId(regst_desc_id);
         blob_info.ordinal = regst_desc.GetOrdinalForLbi(blob_info.lbi);
@@ -197,6 +201,7 @@ void Actor::InitBnInOp2BlobInfo(const TaskProto& task_proto) {
         blob_info.regst_desc_id = -1;
         blob_info.ordinal = -1;
         blob_info.rs = nullptr;
+        blob_info.blob_index = -1;
       }
       ek.bn_in_op2blob_info.emplace(bn, std::move(blob_info));
     }
@@ -384,8 +389,10 @@ int Actor::HandlerZombie(const ActorMsg& msg) {
 }
 
 void Actor::TryLogActEvent(const std::function<void()>& DoAct) const {
-  if (false) {
+  ActTimeline* act_timeline = Global<ActTimeline>::Get();
+  if (act_timeline != nullptr && act_timeline->IsSampledAct(act_id_)) {
     auto act_event = std::make_shared<ActEvent>();
+    act_event->set_is_experiment_phase(false);
     act_event->set_actor_id(actor_id());
     act_event->set_work_stream_id(GetGlobalWorkStreamId());
     act_event->set_act_id(act_id_);
@@ -403,12 +410,9 @@ void Actor::TryLogActEvent(const std::function<void()>& DoAct) const {
 
     DoAct();
 
-    device_ctx_->AddCallBack([act_event]() {
+    device_ctx_->AddCallBack([act_timeline, act_event]() {
       act_event->set_stop_time(GetCurTime());
-      // The stream poller thread is not allowed to perform blocking RPC call. Hence, the
-      // RPC call is forwarded to the thread pool and will be executed there.
-      Global<ThreadPool>::Get()->AddWork(
-          [act_event]() { Global<CtrlClient>::Get()->PushActEvent(*act_event); });
+      act_timeline->AddActEvent(*act_event);
     });
   } else {
     DoAct();
@@ -418,8 +422,7 @@ void Actor::TryLogActEvent(const std::function<void()>& DoAct) const {
 void Actor::ActUntilFail() {
   while (IsReadReady() && IsWriteReady()) {
     act_id_ += 1;
-    // TryLogActEvent([&] { Act(); }); NOTE(chengcheng): LogActEvent NOT ready now.
-    Act();
+    TryLogActEvent([&] { Act(); });
 
     AsyncSendCustomizedProducedRegstMsgToConsumer();
     AsyncSendNaiveProducedRegstMsgToConsumer();
@@ -538,24 +541,31 @@ bool Actor::IsWriteReady() const {
 
 void Actor::AsyncLaunchKernel(const KernelCtx& kernel_ctx,
                               std::function<Regst*(int64_t)> Regst4RegstDescId) {
-  for (const ExecKernel& ek : exec_kernel_vec_) {
+  for (ExecKernel& ek : exec_kernel_vec_) {
+    std::fill(ek.is_launch_blob_resolved.begin(), ek.is_launch_blob_resolved.end(), false);
     ek.kernel->Launch(kernel_ctx, [&](const std::string& bn_in_op) -> Blob* {
       const auto blob_info_it = ek.bn_in_op2blob_info.find(bn_in_op);
       if (blob_info_it == ek.bn_in_op2blob_info.cend()) { return nullptr; }
       const BlobInfo& info = blob_info_it->second;
       if (info.regst_desc_id == -1) { return nullptr; }
+      if (ek.is_launch_blob_resolved[info.blob_index]) { return ek.launch_blobs[info.blob_index]; }
       Regst* regst;
       if (info.rs != nullptr) {
         regst = info.rs->Front(info.regst_desc_id);
       } else {
         regst = Regst4RegstDescId(info.regst_desc_id);
       }
-      if (regst == nullptr) { return nullptr; }
-      if (info.ordinal >= 0) {
-        return regst->GetBlobByOrdinal(info.ordinal);
-      } else {
-        return regst->GetBlobByLbi(info.lbi);
+      Blob* blob = nullptr;
+      if (regst != nullptr) {
+        if (info.ordinal >= 0) {
+          blob = regst->GetBlobByOrdinal(info.ordinal);
+        } else {
+          blob = regst->GetBlobByLbi(info.lbi);
+        }
       }
+      ek.launch_blobs[info.blob_index] = blob;
+      ek.is_launch_blob_resolved[info.blob_index] = true;
+      return blob;
     });
   }
 }
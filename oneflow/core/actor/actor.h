@@ -54,10 +54,16 @@ class Actor {
     int64_t regst_desc_id;
     int64_t ordinal;
     RegstSlot* rs;
+    // index into the blobs of a launch, -1 if the bn has no regst
+    int64_t blob_index;
   };
   struct ExecKernel {
     std::unique_ptr<const Kernel> kernel;
     HashMap<std::string, BlobInfo> bn_in_op2blob_info;
+    // A kernel asks for its output blobs several times per launch, so the blob of each bn is
+    // resolved from its regst once per launch and kept here.
+    std::vector<Blob*> launch_blobs;
+    std::vector<bool> is_launch_blob_resolved;
   };
   using MsgHandler = int (Actor::*)(const ActorMsg&);
   enum class RegstNameType { kNaive = 0, kCustomized };
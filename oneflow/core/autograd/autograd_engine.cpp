@@ -16,6 +16,7 @@ limitations under the License.
 
 #include <stack>
 #include <queue>
+#include <condition_variable>
 #include "oneflow/core/autograd/autograd_engine.h"
 #include "oneflow/core/autograd/autograd_meta.h"
 #include "oneflow/core/framework/tensor.h"
@@ -23,6 +24,10 @@ limitations under the License.
 #include "oneflow/core/framework/tensor_tuple.h"
 #include "oneflow/core/autograd/autograd_mode.h"
 #include "oneflow/core/functional/functional.h"
+#include "oneflow/core/framework/device.h"
+#include "oneflow/core/framework/instruction_replay.h"
+#include "oneflow/core/thread/thread_pool.h"
+#include "oneflow/api/foreign_lock_helper.h"
 
 namespace oneflow {
 namespace one {
@@ -51,9 +56,38 @@ Maybe<void> CopyOrAccGrad(AutogradMeta* autograd_meta, bool autograd_mode) {
   } else {
     autograd_meta->set_acc_grad(current_grad);
   }
+  for (const auto& hook : autograd_meta->post_acc_grad_hooks()) { hook(autograd_meta->acc_grad()); }
   return Maybe<void>::Ok();
 }
 
+bool IsMultiThreadedBackwardEnabled() {
+  static const bool is_enabled =
+      ParseBooleanFromEnv("ONEFLOW_AUTOGRAD_ENABLE_MULTI_THREADED_BACKWARD", false);
+  return is_enabled;
+}
+
+// One single-threaded worker per device, so the backward dispatches of a device keep their order
+// while those of different devices overlap. The thread calling backward is the CPU worker.
+ThreadPool* BackwardWorker4Device(Symbol<Device> device) {
+  static std::mutex mutex;
+  static HashMap<Symbol<Device>, std::unique_ptr<ThreadPool>> device2worker;
+  std::unique_lock<std::mutex> lock(mutex);
+  auto& worker = device2worker[device];
+  if (!worker) { worker.reset(new ThreadPool(1)); }
+  return worker.get();
+}
+
+// Returns nullptr if `node' has to be applied by the thread calling backward
+ThreadPool* BackwardWorker4Node(const FunctionNode& node, bool save_grad_for_leaf) {
+  if (node.HasAccGradTensor(save_grad_for_leaf)) { return nullptr; }
+  if (node.output_tensor_infos().empty()) { return nullptr; }
+  const auto& device = node.output_tensor_infos().front().device();
+  if (!device.has_value()) { return nullptr; }
+  const Symbol<Device>& device_symbol = CHECK_JUST(device.value());
+  if (device_symbol->type() == "cpu") { return nullptr; }
+  return BackwardWorker4Device(device_symbol);
+}
+
 }  // namespace
 
 StackFunctionNode::StackFunctionNode(
@@ -101,6 +135,15 @@ Maybe<void> FunctionNode::AccGrad4LeafTensor(bool create_graph) {
   return Maybe<void>::Ok();
 }
 
+bool FunctionNode::HasAccGradTensor(bool save_grad_for_leaf) const {
+  return std::any_of(output_meta_datas_.begin(), output_meta_datas_.end(),
+                     [&](const std::shared_ptr<AutogradMeta>& meta_data) {
+                       return meta_data->retain_grad()
+                              || (save_grad_for_leaf && meta_data->is_leaf()
+                                  && meta_data->requires_grad());
+                     });
+}
+
 void FunctionNode::ReleaseOutTensorArgs() {
   for (const std::shared_ptr<AutogradMeta>& meta_data : output_meta_datas_) {
     meta_data->current_grad()->Release();
@@ -352,7 +395,26 @@ Maybe<void> GraphTask::ComputeDependenciesAndPruneNode(const TensorTuple& inputs
   return Maybe<void>::Ok();
 }
 
+Maybe<bool> GraphTask::ApplyNode(FunctionNode* node, bool save_grad_for_leaf) {
+  if (!need_execute_.empty() && need_execute_.find(node) == need_execute_.end()) {
+    node->ReleaseOutTensorArgs();
+    return false;
+  }
+  if (/*bool not_ready_to_apply=*/!(JUST(node->Apply(create_graph_)))) { return false; }
+  if (save_grad_for_leaf) { JUST(node->AccGrad4LeafTensor(create_graph_)); }
+  JUST(node->AccGrad4RetainGradTensor());
+  node->ReleaseOutTensorArgs();
+  if (!retain_graph_) { node->ReleaseData(); }
+  return true;
+}
+
 Maybe<void> GraphTask::Apply(bool save_grad_for_leaf) {
+  // Backward ops recorded for a higher order graph or an instructions capture have to be built on
+  // this thread.
+  if (IsMultiThreadedBackwardEnabled() && !create_graph_ && !InstructionsCapture::IsCapturing()
+      && !debug::RecordingInstructions()) {
+    return ApplyInParallel(save_grad_for_leaf);
+  }
   std::queue<FunctionNode*> queue;
   for (FunctionNode* node : roots_) {
     if (dependencies_[node] == 0) { queue.push(node); }
@@ -361,16 +423,7 @@ Maybe<void> GraphTask::Apply(bool save_grad_for_leaf) {
   while (!queue.empty()) {
     FunctionNode* node = queue.front();
     queue.pop();
-    if (!need_execute_.empty() && need_execute_.find(node) == need_execute_.end()) {
-      node->ReleaseOutTensorArgs();
-      continue;
-    }
-    if (/*bool not_ready_to_apply=*/!(JUST(node->Apply(create_graph_)))) { continue; }
-    if (save_grad_for_leaf) { JUST(node->AccGrad4LeafTensor(create_graph_)); }
-    JUST(node->AccGrad4RetainGradTensor());
-    node->ReleaseOutTensorArgs();
-    if (!retain_graph_) { node->ReleaseData(); }
-
+    if (!JUST(ApplyNode(node, save_grad_for_leaf))) { continue; }
     for (const auto& next_grad_fn : *(node->GetNextFunctions())) {
       FunctionNode* next_node = next_grad_fn.get();
       dependencies_[next_node] -= 1;
@@ -380,6 +433,71 @@ Maybe<void> GraphTask::Apply(bool save_grad_for_leaf) {
   return Maybe<void>::Ok();
 }
 
+// Ready nodes go to the worker of their device, or to this thread for cpu and consistent nodes and
+// for the nodes accumulating grads of leaf or retain_grad tensors. `dependencies_' and the queue
+// of this thread are guarded by `mutex'.
+Maybe<void> GraphTask::ApplyInParallel(bool save_grad_for_leaf) {
+  const bool grad_mode = autograd::GradMode::is_enabled();
+  std::mutex mutex;
+  std::condition_variable cond;
+  std::queue<FunctionNode*> queue;
+  int64_t unfinished_node_cnt = 0;
+  std::shared_ptr<cfg::ErrorProto> error;
+
+  std::function<void(FunctionNode*)> Schedule;
+  const auto Run = [&](FunctionNode* node) {
+    const Maybe<bool>& is_applied = ApplyNode(node, save_grad_for_leaf);
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!is_applied.IsOk()) {
+      if (!error) { error = is_applied.error(); }
+    } else if (CHECK_JUST(is_applied) && !error) {
+      for (const auto& next_grad_fn : *(node->GetNextFunctions())) {
+        FunctionNode* next_node = next_grad_fn.get();
+        dependencies_[next_node] -= 1;
+        if (dependencies_[next_node] == 0) { Schedule(next_node); }
+      }
+    }
+    unfinished_node_cnt -= 1;
+    cond.notify_all();
+  };
+  Schedule = [&](FunctionNode* node) {
+    unfinished_node_cnt += 1;
+    ThreadPool* worker = BackwardWorker4Node(*node, save_grad_for_leaf);
+    if (worker == nullptr) {
+      queue.push(node);
+    } else {
+      worker->AddWork([&, node]() {
+        autograd::AutoGradMode mode(grad_mode);
+        Run(node);
+      });
+    }
+  };
+
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (FunctionNode* node : roots_) {
+      if (dependencies_[node] == 0) { Schedule(node); }
+    }
+  }
+  // Hooks applied by the workers may need the foreign lock (e.g. the Python GIL)
+  Global<ForeignLockHelper>::Get()->WithScopedRelease([&]() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (unfinished_node_cnt > 0) {
+      if (queue.empty()) {
+        cond.wait(lock);
+        continue;
+      }
+      FunctionNode* node = queue.front();
+      queue.pop();
+      lock.unlock();
+      Run(node);
+      lock.lock();
+    }
+  });
+  if (error) { return Maybe<void>(error); }
+  return Maybe<void>::Ok();
+}
+
 Maybe<void> GraphAutogradEngine::RunBackwardAndSaveGrads4LeafTensor(const TensorTuple& outputs,
                                                                     const TensorTuple& out_grads,
                                                                     bool retain_graph,
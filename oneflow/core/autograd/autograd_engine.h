@@ -49,6 +49,10 @@ class FunctionNode {
     return next_functions_;
   }
   const std::string& GetOpTypeName() const { return op_name_; }
+  const std::vector<TensorInfo>& output_tensor_infos() const { return output_tensor_infos_; }
+  // Whether applying this node accumulates grads of leaf or retain_grad tensors, whose hooks may
+  // call back into Python
+  bool HasAccGradTensor(bool save_grad_for_leaf) const;
 
  protected:
   explicit FunctionNode(const std::string& op_type_name)
@@ -163,6 +167,10 @@ class GraphTask final {
   Maybe<void> Apply(bool save_grad_for_leaf);
 
  private:
+  // Returns whether the next functions of `node' may be released
+  Maybe<bool> ApplyNode(FunctionNode* node, bool save_grad_for_leaf);
+  Maybe<void> ApplyInParallel(bool save_grad_for_leaf);
+
   bool retain_graph_;
   bool create_graph_;
   std::vector<FunctionNode*> roots_;
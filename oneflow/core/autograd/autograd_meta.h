@@ -57,6 +57,9 @@ class AutogradMeta final {
   bool retain_grad() const { return retain_grad_; }
   using Hook = std::function<std::shared_ptr<Tensor>(const std::shared_ptr<const Tensor>&)>;
   const std::vector<Hook>& hooks() const { return hooks_; }
+  // Called with the accumulated grad once the grad of this tensor in a backward pass is ready.
+  using PostAccGradHook = std::function<void(const std::shared_ptr<Tensor>&)>;
+  const std::vector<PostAccGradHook>& post_acc_grad_hooks() const { return post_acc_grad_hooks_; }
 
   // Setters
   void set_acc_grad(const std::shared_ptr<Tensor>& grad) { acc_grad_ = grad; }
@@ -65,6 +68,9 @@ class AutogradMeta final {
   void set_retain_grad(bool retain_grad) { retain_grad_ = retain_grad; }
   void set_is_leaf(bool is_leaf) { is_leaf_ = is_leaf; }
   void add_hook(const Hook& hook) { hooks_.push_back(hook); }
+  void add_post_acc_grad_hook(const PostAccGradHook& hook) {
+    post_acc_grad_hooks_.push_back(hook);
+  }
 
  private:
   bool is_leaf_;
@@ -78,6 +84,7 @@ class AutogradMeta final {
   std::shared_ptr<Tensor> acc_grad_;
   std::shared_ptr<TensorArg> current_grad_;
   std::vector<Hook> hooks_;
+  std::vector<PostAccGradHook> post_acc_grad_hooks_;
 };
 
 inline std::shared_ptr<AutogradMeta> NewAutogradMeta(bool requires_grad, bool is_leaf) {
@@ -90,6 +97,7 @@ class TensorInfo final {
   explicit TensorInfo(const Tensor& tensor);
 
   Maybe<Tensor> zeros() const;
+  const Optional<Symbol<Device>>& device() const { return device_; }
 
  private:
   std::shared_ptr<const Shape> shape_;
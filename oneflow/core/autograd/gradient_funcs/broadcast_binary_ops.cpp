@@ -48,35 +48,79 @@ class ReduceSumLikeModule {
   }
 };
 
+// Same as `ReduceSumLikeModule' but only needs the shape of `like', so that the backward of
+// broadcast binary ops does not keep the forward inputs alive just for their shapes.
+class ReduceSumToShapeModule {
+ public:
+  ReduceSumToShapeModule() = default;
+  ~ReduceSumToShapeModule() = default;
+
+  Maybe<Tensor> operator()(const std::shared_ptr<Tensor>& input, const Shape& like_shape) const {
+    const auto& in_shape = *(input->shape());
+    if (in_shape == like_shape) { return JUST(functional::Identity(input)); }
+    const Shape& left_extended_shape =
+        CreateLeftExtendedShape(ShapeView(like_shape), in_shape.NumAxes());
+    if (in_shape == left_extended_shape) { return JUST(functional::Reshape(input, like_shape)); }
+    const AxisVector& broadcast_axis_vec = left_extended_shape.Axes4BroadcastTo(in_shape);
+    const auto& reduced = JUST(functional::ReduceSum(
+        input, std::vector<int32_t>{broadcast_axis_vec.begin(), broadcast_axis_vec.end()},
+        /*keepdims=*/true));
+    if (left_extended_shape == like_shape) { return reduced; }
+    return JUST(functional::Reshape(reduced, like_shape));
+  }
+};
+
 }  // namespace
 
-class BroadcastBinaryGrad : public OpExprGradFunction<OpExprInterpState> {
+struct BroadcastBinaryInterpState : public OpExprInterpState {
+  bool x_requires_grad;
+  bool y_requires_grad;
+  Shape x_shape;
+  Shape y_shape;
+  int x_index = -1;
+  int y_index = -1;
+  int z_index = -1;
+};
+
+// Derived classes only save the tensors their backward reads, forward inputs whose shapes are the
+// only thing needed are not kept alive.
+class BroadcastBinaryGrad : public OpExprGradFunction<BroadcastBinaryInterpState> {
  public:
   BroadcastBinaryGrad() = default;
   virtual ~BroadcastBinaryGrad() = default;
 
   virtual Maybe<void> Init(const OpExpr& op) { return Maybe<void>::Ok(); }
 
-  Maybe<void> Capture(OpExprInterpState* ctx, const TensorTuple& inputs, const TensorTuple& outputs,
-                      const AttrMap& attrs) const override {
+  Maybe<void> Capture(BroadcastBinaryInterpState* ctx, const TensorTuple& inputs,
+                      const TensorTuple& outputs, const AttrMap& attrs) const override {
     CHECK_EQ_OR_RETURN(inputs.size(), 2);
     CHECK_EQ_OR_RETURN(outputs.size(), 1);
-    ctx->SaveTensorForBackward(inputs.at(0));
-    ctx->SaveTensorForBackward(inputs.at(1));
-    ctx->SaveTensorForBackward(outputs.at(0));
+    ctx->x_requires_grad = inputs.at(0)->requires_grad();
+    ctx->y_requires_grad = inputs.at(1)->requires_grad();
+    ctx->x_shape = *(inputs.at(0)->shape());
+    ctx->y_shape = *(inputs.at(1)->shape());
+    return SaveTensorsForBackward(ctx, inputs, outputs);
+  }
+
+ protected:
+  virtual Maybe<void> SaveTensorsForBackward(BroadcastBinaryInterpState* ctx,
+                                             const TensorTuple& inputs,
+                                             const TensorTuple& outputs) const {
     return Maybe<void>::Ok();
   }
 };
 
 class BroadcastAdd : public BroadcastBinaryGrad {
  public:
-  Maybe<void> Apply(const OpExprInterpState* ctx, const TensorTuple& out_grads,
+  Maybe<void> Apply(const BroadcastBinaryInterpState* ctx, const TensorTuple& out_grads,
                     TensorTuple* in_grads) const override {
-    const auto& x = ctx->SavedTensors().at(0);
-    const auto& y = ctx->SavedTensors().at(1);
     in_grads->resize(2);
-    if (x->requires_grad()) { in_grads->at(0) = JUST(ReduceSumLikeModule()(out_grads.at(0), x)); }
-    if (y->requires_grad()) { in_grads->at(1) = JUST(ReduceSumLikeModule()(out_grads.at(0), y)); }
+    if (ctx->x_requires_grad) {
+      in_grads->at(0) = JUST(ReduceSumToShapeModule()(out_grads.at(0), ctx->x_shape));
+    }
+    if (ctx->y_requires_grad) {
+      in_grads->at(1) = JUST(ReduceSumToShapeModule()(out_grads.at(0), ctx->y_shape));
+    }
     return Maybe<void>::Ok();
   }
 };
@@ -85,15 +129,15 @@ REGISTER_OP_EXPR_GRAD_FUNCTION("broadcast_add", BroadcastAdd);
 
 class BroadcastSub : public BroadcastBinaryGrad {
  public:
-  Maybe<void> Apply(const OpExprInterpState* ctx, const TensorTuple& out_grads,
+  Maybe<void> Apply(const BroadcastBinaryInterpState* ctx, const TensorTuple& out_grads,
                     TensorTuple* in_grads) const override {
-    const auto& x = ctx->SavedTensors().at(0);
-    const auto& y = ctx->SavedTensors().at(1);
     in_grads->resize(2);
-    if (x->requires_grad()) { in_grads->at(0) = JUST(ReduceSumLikeModule()(out_grads.at(0), x)); }
-    if (y->requires_grad()) {
+    if (ctx->x_requires_grad) {
+      in_grads->at(0) = JUST(ReduceSumToShapeModule()(out_grads.at(0), ctx->x_shape));
+    }
+    if (ctx->y_requires_grad) {
       const auto& grad = JUST(functional::ScalarMul(out_grads.at(0), functional::Scalar(-1.f)));
-      in_grads->at(1) = JUST(ReduceSumLikeModule()(grad, y));
+      in_grads->at(1) = JUST(ReduceSumToShapeModule()(grad, ctx->y_shape));
     }
     return Maybe<void>::Ok();
   }
@@ -103,56 +147,71 @@ REGISTER_OP_EXPR_GRAD_FUNCTION("broadcast_sub", BroadcastSub);
 
 class BroadcastMul : public BroadcastBinaryGrad {
  public:
-  Maybe<void> Apply(const OpExprInterpState* ctx, const TensorTuple& out_grads,
+  Maybe<void> Apply(const BroadcastBinaryInterpState* ctx, const TensorTuple& out_grads,
                     TensorTuple* in_grads) const override {
-    const auto& x = ctx->SavedTensors().at(0);
-    const auto& y = ctx->SavedTensors().at(1);
     in_grads->resize(2);
-    if (x->requires_grad()) {
+    if (ctx->x_requires_grad) {
+      const auto& y = ctx->SavedTensors().at(ctx->y_index);
       const auto& x_grad = JUST(functional::BroadcastMul(out_grads.at(0), y));
-      in_grads->at(0) = JUST(ReduceSumLikeModule()(x_grad, x));
+      in_grads->at(0) = JUST(ReduceSumToShapeModule()(x_grad, ctx->x_shape));
     }
-    if (y->requires_grad()) {
+    if (ctx->y_requires_grad) {
+      const auto& x = ctx->SavedTensors().at(ctx->x_index);
       const auto& y_grad = JUST(functional::BroadcastMul(out_grads.at(0), x));
-      in_grads->at(1) = JUST(ReduceSumLikeModule()(y_grad, y));
+      in_grads->at(1) = JUST(ReduceSumToShapeModule()(y_grad, ctx->y_shape));
     }
     return Maybe<void>::Ok();
   }
+
+ protected:
+  Maybe<void> SaveTensorsForBackward(BroadcastBinaryInterpState* ctx, const TensorTuple& inputs,
+                                     const TensorTuple& outputs) const override {
+    if (ctx->x_requires_grad) { ctx->y_index = ctx->SaveTensorForBackward(inputs.at(1)); }
+    if (ctx->y_requires_grad) { ctx->x_index = ctx->SaveTensorForBackward(inputs.at(0)); }
+    return Maybe<void>::Ok();
+  }
 };
 
 REGISTER_OP_EXPR_GRAD_FUNCTION("broadcast_mul", BroadcastMul);
 
 class BroadcastDiv : public BroadcastBinaryGrad {
  public:
-  Maybe<void> Apply(const OpExprInterpState* ctx, const TensorTuple& out_grads,
+  Maybe<void> Apply(const BroadcastBinaryInterpState* ctx, const TensorTuple& out_grads,
                     TensorTuple* in_grads) const override {
-    const auto& x = ctx->SavedTensors().at(0);
-    const auto& y = ctx->SavedTensors().at(1);
-    const auto& z = ctx->SavedTensors().at(2);
     in_grads->resize(2);
-    if (x->requires_grad()) {
+    const auto& y = ctx->SavedTensors().at(ctx->y_index);
+    if (ctx->x_requires_grad) {
       const auto& x_grad = JUST(functional::BroadcastDiv(out_grads.at(0), y));
-      in_grads->at(0) = JUST(ReduceSumLikeModule()(x_grad, x));
+      in_grads->at(0) = JUST(ReduceSumToShapeModule()(x_grad, ctx->x_shape));
     }
-    if (y->requires_grad()) {
+    if (ctx->y_requires_grad) {
+      const auto& z = ctx->SavedTensors().at(ctx->z_index);
       in_grads->at(1) = JUST(functional::BroadcastDivGrad(out_grads.at(0), z, y));
     }
     return Maybe<void>::Ok();
   }
+
+ protected:
+  Maybe<void> SaveTensorsForBackward(BroadcastBinaryInterpState* ctx, const TensorTuple& inputs,
+                                     const TensorTuple& outputs) const override {
+    ctx->y_index = ctx->SaveTensorForBackward(inputs.at(1));
+    if (ctx->y_requires_grad) { ctx->z_index = ctx->SaveTensorForBackward(outputs.at(0)); }
+    return Maybe<void>::Ok();
+  }
 };
 
 REGISTER_OP_EXPR_GRAD_FUNCTION("broadcast_div", BroadcastDiv);
 
 class BroadcastMinMax : public BroadcastBinaryGrad {
  public:
-  Maybe<void> Apply(const OpExprInterpState* ctx, const TensorTuple& out_grads,
+  Maybe<void> Apply(const BroadcastBinaryInterpState* ctx, const TensorTuple& out_grads,
                     TensorTuple* in_grads) const override {
-    const auto& x = ctx->SavedTensors().at(0);
-    const auto& y = ctx->SavedTensors().at(1);
-    const auto& out = ctx->SavedTensors().at(2);
+    const auto& x = ctx->SavedTensors().at(ctx->x_index);
+    const auto& y = ctx->SavedTensors().at(ctx->y_index);
+    const auto& out = ctx->SavedTensors().at(ctx->z_index);
     const auto& out_shape = *(out->shape());
     in_grads->resize(2);
-    if (x->requires_grad() || y->requires_grad()) {
+    if (ctx->x_requires_grad || ctx->y_requires_grad) {
       const auto& x_shape = *(x->shape());
       const auto& y_shape = *(y->shape());
       auto broad_x_ = x;
@@ -175,10 +234,10 @@ class BroadcastMinMax : public BroadcastBinaryGrad {
       }
       const auto& broad_grads =
           JUST(elementwise_grad_functor_(out_grads.at(0), broad_x_, broad_y_));
-      if (x->requires_grad()) {
+      if (ctx->x_requires_grad) {
         in_grads->at(0) = JUST(ReduceSumLikeModule()(broad_grads->at(0), x));
       }
-      if (y->requires_grad()) {
+      if (ctx->y_requires_grad) {
         in_grads->at(1) = JUST(ReduceSumLikeModule()(broad_grads->at(1), y));
       }
     }
@@ -186,6 +245,14 @@ class BroadcastMinMax : public BroadcastBinaryGrad {
   }
 
  protected:
+  Maybe<void> SaveTensorsForBackward(BroadcastBinaryInterpState* ctx, const TensorTuple& inputs,
+                                     const TensorTuple& outputs) const override {
+    ctx->x_index = ctx->SaveTensorForBackward(inputs.at(0));
+    ctx->y_index = ctx->SaveTensorForBackward(inputs.at(1));
+    ctx->z_index = ctx->SaveTensorForBackward(outputs.at(0));
+    return Maybe<void>::Ok();
+  }
+
   std::function<Maybe<TensorTuple>(const std::shared_ptr<Tensor>&, const std::shared_ptr<Tensor>&,
                                    const std::shared_ptr<Tensor>&)>
       elementwise_grad_functor_;
@@ -0,0 +1,62 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/framework/op_expr_grad_function.h"
+#include "oneflow/core/functional/functional.h"
+
+namespace oneflow {
+namespace one {
+
+struct EmbeddingLookupInterpState : public OpExprInterpState {
+  bool requires_grad;
+};
+
+// out, unique_ids, inverse_indices = embedding_lookup(weight, ids). The rows of out grad are first
+// summed into one per unique id and then scattered into the grad of weight.
+class EmbeddingLookup : public OpExprGradFunction<EmbeddingLookupInterpState> {
+ public:
+  Maybe<void> Init(const OpExpr& op) override { return Maybe<void>::Ok(); }
+
+  Maybe<void> Capture(EmbeddingLookupInterpState* ctx, const TensorTuple& inputs,
+                      const TensorTuple& outputs, const AttrMap& attrs) const override {
+    CHECK_EQ_OR_RETURN(inputs.size(), 2);
+    CHECK_EQ_OR_RETURN(outputs.size(), 3);
+    ctx->requires_grad = inputs.at(0)->requires_grad();
+    if (!ctx->requires_grad) { return Maybe<void>::Ok(); }
+    ctx->SaveTensorForBackward(inputs.at(0));   // weight
+    ctx->SaveTensorForBackward(outputs.at(1));  // unique_ids
+    ctx->SaveTensorForBackward(outputs.at(2));  // inverse_indices
+    return Maybe<void>::Ok();
+  }
+
+  Maybe<void> Apply(const EmbeddingLookupInterpState* ctx, const TensorTuple& out_grads,
+                    TensorTuple* in_grads) const override {
+    in_grads->resize(2);
+    if (!ctx->requires_grad) { return Maybe<void>::Ok(); }
+    const auto& weight = ctx->SavedTensors().at(0);
+    const auto& unique_ids = ctx->SavedTensors().at(1);
+    const auto& inverse_indices = ctx->SavedTensors().at(2);
+    const auto& unique_diff =
+        JUST(functional::EmbeddingLookupGrad(out_grads.at(0), unique_ids, inverse_indices));
+    in_grads->at(0) =
+        JUST(functional::UnsortedSegmentSumLike(unique_diff, unique_ids, weight, /*axis=*/0));
+    return Maybe<void>::Ok();
+  }
+};
+
+REGISTER_OP_EXPR_GRAD_FUNCTION("embedding_lookup", EmbeddingLookup);
+
+}  // namespace one
+}  // namespace oneflow
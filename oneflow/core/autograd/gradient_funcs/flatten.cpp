@@ -17,6 +17,7 @@ limitations under the License.
 #include "oneflow/core/framework/device.h"
 #include "oneflow/core/framework/op_builder.h"
 #include "oneflow/core/framework/op_interpreter/op_interpreter_util.h"
+#include "oneflow/core/functional/functional.h"
 #include "oneflow/core/framework/op_expr.h"
 #include "oneflow/core/framework/op_expr_helper.h"
 
@@ -25,6 +26,7 @@ namespace one {
 
 struct FlattenInterpState : public OpExprInterpState {
   bool requires_grad;
+  Shape shape;
 };
 
 class Flatten : public OpExprGradFunction<FlattenInterpState> {
@@ -34,16 +36,11 @@ class Flatten : public OpExprGradFunction<FlattenInterpState> {
                       const TensorTuple& outputs, const AttrMap& attrs) const override;
   Maybe<void> Apply(const FlattenInterpState* ctx, const TensorTuple& out_grads,
                     TensorTuple* in_grads) const override;
-
- private:
-  std::shared_ptr<OpExpr> grad_op_;
 };
 
 Maybe<void> Flatten::Init(const OpExpr& op) {
   const UserOpExpr* fw_op_expr = dynamic_cast<const UserOpExpr*>(&op);
   CHECK_NOTNULL_OR_RETURN(fw_op_expr);
-  const std::string& op_name = fw_op_expr->op_name();
-  grad_op_ = JUST(op_expr_helper::ReshapeLikeOp(GradientOpName(op_name)));
   return Maybe<void>::Ok();
 }
 
@@ -51,7 +48,8 @@ Maybe<void> Flatten::Capture(FlattenInterpState* ctx, const TensorTuple& inputs,
                              const TensorTuple& outputs, const AttrMap& attrs) const {
   ctx->requires_grad = inputs.at(0)->requires_grad();
   if (!ctx->requires_grad) { return Maybe<void>::Ok(); }
-  ctx->SaveTensorForBackward(inputs.at(0));
+  // only the shape of the input is needed by backward
+  ctx->shape = *(inputs.at(0)->shape());
   return Maybe<void>::Ok();
 }
 
@@ -59,9 +57,8 @@ Maybe<void> Flatten::Apply(const FlattenInterpState* ctx, const TensorTuple& out
                            TensorTuple* in_grads) const {
   if (!ctx->requires_grad) { return Maybe<void>::Ok(); }
   CHECK_EQ_OR_RETURN(out_grads.size(), 1);
-  const std::shared_ptr<oneflow::one::Tensor>& like = ctx->SavedTensors().at(0);
   in_grads->resize(1);
-  in_grads->at(0) = JUST(OpInterpUtil::Dispatch<Tensor>(*grad_op_, {out_grads.at(0), like}));
+  in_grads->at(0) = JUST(functional::Reshape(out_grads.at(0), ctx->shape));
   return Maybe<void>::Ok();
 }
 
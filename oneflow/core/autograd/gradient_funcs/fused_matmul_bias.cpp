@@ -0,0 +1,103 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/framework/attr_map.h"
+#include "oneflow/core/framework/op_expr_grad_function.h"
+#include "oneflow/core/functional/functional.h"
+
+namespace oneflow {
+namespace one {
+
+struct FusedMatmulBiasInterpState : public OpExprInterpState {
+  bool a_requires_grad;
+  bool b_requires_grad;
+  bool bias_requires_grad;
+  bool transpose_b;
+  std::string activation;
+};
+
+// out, [aux] = fused_matmul_bias(a, b, bias). The grads of b and bias come from one
+// fused_matmul_bias_grad, which also gives the grad through the activation that the grad of a is
+// computed from.
+class FusedMatmulBias : public OpExprGradFunction<FusedMatmulBiasInterpState> {
+ public:
+  Maybe<void> Init(const OpExpr& op) override {
+    const auto* fw_op_expr = dynamic_cast<const UserOpExpr*>(&op);
+    CHECK_NOTNULL_OR_RETURN(fw_op_expr);
+    base_attrs_ = MakeAttrMapFromUserOpConf(fw_op_expr->proto());
+    return Maybe<void>::Ok();
+  }
+
+  Maybe<void> Capture(FusedMatmulBiasInterpState* ctx, const TensorTuple& inputs,
+                      const TensorTuple& outputs, const AttrMap& attrs) const override {
+    CHECK_EQ_OR_RETURN(inputs.size(), 3);
+    ctx->a_requires_grad = inputs.at(0)->requires_grad();
+    ctx->b_requires_grad = inputs.at(1)->requires_grad();
+    ctx->bias_requires_grad = inputs.at(2)->requires_grad();
+    if (!ctx->a_requires_grad && !ctx->b_requires_grad && !ctx->bias_requires_grad) {
+      return Maybe<void>::Ok();
+    }
+    ComposedAttrMap composed_attrs(attrs, base_attrs_);
+    ctx->transpose_b = JUST(composed_attrs.GetAttr<bool>("transpose_b"));
+    ctx->activation = JUST(composed_attrs.GetAttr<std::string>("activation"));
+    ctx->SaveTensorForBackward(inputs.at(0));  // a
+    ctx->SaveTensorForBackward(inputs.at(1));  // b
+    if (ctx->activation == "relu") { ctx->SaveTensorForBackward(outputs.at(0)); }
+    if (ctx->activation == "gelu") { ctx->SaveTensorForBackward(outputs.at(1)); }
+    return Maybe<void>::Ok();
+  }
+
+  Maybe<void> Apply(const FusedMatmulBiasInterpState* ctx, const TensorTuple& out_grads,
+                    TensorTuple* in_grads) const override {
+    in_grads->resize(3);
+    const auto& saved = ctx->SavedTensors();
+    if (saved.empty()) { return Maybe<void>::Ok(); }
+    const auto& a = saved.at(0);
+    const auto& b = saved.at(1);
+    const bool has_activation = ctx->activation != "none";
+    std::shared_ptr<Tensor> pre_grad = out_grads.at(0);
+    if (ctx->b_requires_grad || ctx->bias_requires_grad
+        || (has_activation && ctx->a_requires_grad)) {
+      Optional<one::Tensor> out;
+      Optional<one::Tensor> aux;
+      if (ctx->activation == "relu") { out = saved.at(2); }
+      if (ctx->activation == "gelu") { aux = saved.at(2); }
+      const auto grads = JUST(functional::FusedMatmulBiasGrad(
+          out_grads.at(0), a, ctx->transpose_b, ctx->activation, out, aux));
+      const int offset = has_activation ? 1 : 0;
+      if (has_activation) { pre_grad = grads->at(0); }
+      if (ctx->b_requires_grad) { in_grads->at(1) = grads->at(offset); }
+      if (ctx->bias_requires_grad) { in_grads->at(2) = grads->at(offset + 1); }
+    }
+    if (ctx->a_requires_grad) {
+      if (a->shape()->NumAxes() == 2) {
+        in_grads->at(0) = JUST(functional::MatMul(pre_grad, b, /*transpose_a=*/false,
+                                                  !ctx->transpose_b, /*alpha=*/1.0));
+      } else {
+        in_grads->at(0) = JUST(functional::BroadcastMatMul(pre_grad, b, /*transpose_a=*/false,
+                                                           !ctx->transpose_b, /*alpha=*/1.0));
+      }
+    }
+    return Maybe<void>::Ok();
+  }
+
+ private:
+  AttrMap base_attrs_;
+};
+
+REGISTER_OP_EXPR_GRAD_FUNCTION("fused_matmul_bias", FusedMatmulBias);
+
+}  // namespace one
+}  // namespace oneflow
@@ -0,0 +1,95 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/framework/attr_map.h"
+#include "oneflow/core/framework/op_expr_grad_function.h"
+#include "oneflow/core/functional/functional.h"
+
+namespace oneflow {
+namespace one {
+
+struct FusedMultiHeadAttentionInterpState : public OpExprInterpState {
+  bool requires_grad;
+  bool has_key_mask;
+  bool has_cu_seqlens;
+  bool causal;
+  float scale;
+  float dropout_rate;
+};
+
+// Saves softmax_lse and rng_state instead of the attention probabilities, the grad op recomputes
+// them tile by tile.
+class FusedMultiHeadAttention : public OpExprGradFunction<FusedMultiHeadAttentionInterpState> {
+ public:
+  Maybe<void> Init(const OpExpr& op) override {
+    const auto* fw_op_expr = dynamic_cast<const UserOpExpr*>(&op);
+    CHECK_NOTNULL_OR_RETURN(fw_op_expr);
+    base_attrs_ = MakeAttrMapFromUserOpConf(fw_op_expr->proto());
+    has_key_mask_ = fw_op_expr->proto().input().count("key_mask") > 0;
+    has_cu_seqlens_ = fw_op_expr->proto().input().count("cu_seqlens") > 0;
+    return Maybe<void>::Ok();
+  }
+
+  Maybe<void> Capture(FusedMultiHeadAttentionInterpState* ctx, const TensorTuple& inputs,
+                      const TensorTuple& outputs, const AttrMap& attrs) const override {
+    CHECK_EQ_OR_RETURN(inputs.size(), 3 + has_key_mask_ + has_cu_seqlens_);
+    CHECK_EQ_OR_RETURN(outputs.size(), 3);
+    ctx->requires_grad = inputs.at(0)->requires_grad() || inputs.at(1)->requires_grad()
+                         || inputs.at(2)->requires_grad();
+    if (!ctx->requires_grad) { return Maybe<void>::Ok(); }
+
+    ctx->has_key_mask = has_key_mask_;
+    ctx->has_cu_seqlens = has_cu_seqlens_;
+    for (const auto& input : inputs) { ctx->SaveTensorForBackward(input); }
+    ctx->SaveTensorForBackward(outputs.at(0));  // out
+    ctx->SaveTensorForBackward(outputs.at(1));  // softmax_lse
+    ctx->SaveTensorForBackward(outputs.at(2));  // rng_state
+
+    ComposedAttrMap composed_attrs(attrs, base_attrs_);
+    ctx->causal = JUST(composed_attrs.GetAttr<bool>("causal"));
+    ctx->scale = JUST(composed_attrs.GetAttr<float>("scale"));
+    ctx->dropout_rate = JUST(composed_attrs.GetAttr<float>("dropout_rate"));
+    return Maybe<void>::Ok();
+  }
+
+  Maybe<void> Apply(const FusedMultiHeadAttentionInterpState* ctx, const TensorTuple& out_grads,
+                    TensorTuple* in_grads) const override {
+    if (!ctx->requires_grad) { return Maybe<void>::Ok(); }
+    CHECK_EQ_OR_RETURN(out_grads.size(), 3);
+    const auto& saved = ctx->SavedTensors();
+    size_t out_index = 3;
+    Optional<one::Tensor> key_mask;
+    Optional<one::Tensor> cu_seqlens;
+    if (ctx->has_key_mask) { key_mask = saved.at(out_index++); }
+    if (ctx->has_cu_seqlens) { cu_seqlens = saved.at(out_index++); }
+    const auto& grads = JUST(functional::FusedMultiHeadAttentionGrad(
+        saved.at(0), saved.at(1), saved.at(2), saved.at(out_index), out_grads.at(0),
+        saved.at(out_index + 1), saved.at(out_index + 2), ctx->causal, ctx->scale,
+        ctx->dropout_rate, key_mask, cu_seqlens));
+    in_grads->resize(out_index);
+    for (int i = 0; i < 3; ++i) { in_grads->at(i) = grads->at(i); }
+    return Maybe<void>::Ok();
+  }
+
+ private:
+  AttrMap base_attrs_;
+  bool has_key_mask_;
+  bool has_cu_seqlens_;
+};
+
+REGISTER_OP_EXPR_GRAD_FUNCTION("fused_multi_head_attention", FusedMultiHeadAttention);
+
+}  // namespace one
+}  // namespace oneflow
@@ -0,0 +1,153 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/framework/op_expr_grad_function.h"
+#include "oneflow/core/functional/functional.h"
+
+namespace oneflow {
+namespace one {
+
+struct MoeGatingInterpState : public OpExprInterpState {
+  bool requires_grad;
+  int64_t num_experts;
+};
+
+// expert_ids, positions, gates = moe_gating(logits), only gates has a grad
+class MoeGating : public OpExprGradFunction<MoeGatingInterpState> {
+ public:
+  Maybe<void> Init(const OpExpr& op) override { return Maybe<void>::Ok(); }
+
+  Maybe<void> Capture(MoeGatingInterpState* ctx, const TensorTuple& inputs,
+                      const TensorTuple& outputs, const AttrMap& attrs) const override {
+    CHECK_EQ_OR_RETURN(inputs.size(), 1);
+    CHECK_EQ_OR_RETURN(outputs.size(), 3);
+    ctx->requires_grad = inputs.at(0)->requires_grad();
+    if (!ctx->requires_grad) { return Maybe<void>::Ok(); }
+    ctx->num_experts = inputs.at(0)->shape()->At(1);
+    ctx->SaveTensorForBackward(outputs.at(0));  // expert_ids
+    ctx->SaveTensorForBackward(outputs.at(2));  // gates
+    return Maybe<void>::Ok();
+  }
+
+  Maybe<void> Apply(const MoeGatingInterpState* ctx, const TensorTuple& out_grads,
+                    TensorTuple* in_grads) const override {
+    in_grads->resize(1);
+    if (!ctx->requires_grad) { return Maybe<void>::Ok(); }
+    const auto& expert_ids = ctx->SavedTensors().at(0);
+    const auto& gates = ctx->SavedTensors().at(1);
+    in_grads->at(0) =
+        JUST(functional::MoeGatingGrad(gates, expert_ids, out_grads.at(2), ctx->num_experts));
+    return Maybe<void>::Ok();
+  }
+};
+
+struct MoeRoutingInterpState : public OpExprInterpState {
+  bool x_requires_grad;
+  bool gates_requires_grad;
+  bool has_gates;
+  int64_t num_experts;
+  int64_t capacity;
+};
+
+// out = moe_dispatch(x, expert_ids, positions[, gates])
+class MoeDispatch : public OpExprGradFunction<MoeRoutingInterpState> {
+ public:
+  Maybe<void> Init(const OpExpr& op) override { return Maybe<void>::Ok(); }
+
+  Maybe<void> Capture(MoeRoutingInterpState* ctx, const TensorTuple& inputs,
+                      const TensorTuple& outputs, const AttrMap& attrs) const override {
+    CHECK_OR_RETURN(inputs.size() == 3 || inputs.size() == 4);
+    ctx->has_gates = inputs.size() == 4;
+    ctx->x_requires_grad = inputs.at(0)->requires_grad();
+    ctx->gates_requires_grad = ctx->has_gates && inputs.at(3)->requires_grad();
+    if (!ctx->x_requires_grad && !ctx->gates_requires_grad) { return Maybe<void>::Ok(); }
+    ctx->SaveTensorForBackward(inputs.at(1));  // expert_ids
+    ctx->SaveTensorForBackward(inputs.at(2));  // positions
+    if (ctx->has_gates) { ctx->SaveTensorForBackward(inputs.at(3)); }
+    if (ctx->gates_requires_grad) { ctx->SaveTensorForBackward(inputs.at(0)); }
+    return Maybe<void>::Ok();
+  }
+
+  Maybe<void> Apply(const MoeRoutingInterpState* ctx, const TensorTuple& out_grads,
+                    TensorTuple* in_grads) const override {
+    in_grads->resize(ctx->has_gates ? 4 : 3);
+    const auto& expert_ids = ctx->SavedTensors().at(0);
+    const auto& positions = ctx->SavedTensors().at(1);
+    if (ctx->x_requires_grad) {
+      if (ctx->has_gates) {
+        in_grads->at(0) = JUST(functional::MoeCombine(out_grads.at(0), expert_ids, positions,
+                                                      ctx->SavedTensors().at(2)));
+      } else {
+        in_grads->at(0) = JUST(functional::MoeDispatchGrad(out_grads.at(0), expert_ids, positions));
+      }
+    }
+    if (ctx->gates_requires_grad) {
+      in_grads->at(3) = JUST(functional::MoeGatesGrad(ctx->SavedTensors().at(3), out_grads.at(0),
+                                                      expert_ids, positions));
+    }
+    return Maybe<void>::Ok();
+  }
+};
+
+// out = moe_combine(expert_x, expert_ids, positions[, gates])
+class MoeCombine : public OpExprGradFunction<MoeRoutingInterpState> {
+ public:
+  Maybe<void> Init(const OpExpr& op) override { return Maybe<void>::Ok(); }
+
+  Maybe<void> Capture(MoeRoutingInterpState* ctx, const TensorTuple& inputs,
+                      const TensorTuple& outputs, const AttrMap& attrs) const override {
+    CHECK_OR_RETURN(inputs.size() == 3 || inputs.size() == 4);
+    ctx->has_gates = inputs.size() == 4;
+    ctx->x_requires_grad = inputs.at(0)->requires_grad();
+    ctx->gates_requires_grad = ctx->has_gates && inputs.at(3)->requires_grad();
+    if (!ctx->x_requires_grad && !ctx->gates_requires_grad) { return Maybe<void>::Ok(); }
+    ctx->num_experts = inputs.at(0)->shape()->At(0);
+    ctx->capacity = inputs.at(0)->shape()->At(1);
+    ctx->SaveTensorForBackward(inputs.at(1));  // expert_ids
+    ctx->SaveTensorForBackward(inputs.at(2));  // positions
+    if (ctx->has_gates) { ctx->SaveTensorForBackward(inputs.at(3)); }
+    if (ctx->gates_requires_grad) { ctx->SaveTensorForBackward(inputs.at(0)); }
+    return Maybe<void>::Ok();
+  }
+
+  Maybe<void> Apply(const MoeRoutingInterpState* ctx, const TensorTuple& out_grads,
+                    TensorTuple* in_grads) const override {
+    in_grads->resize(ctx->has_gates ? 4 : 3);
+    const auto& expert_ids = ctx->SavedTensors().at(0);
+    const auto& positions = ctx->SavedTensors().at(1);
+    if (ctx->x_requires_grad) {
+      if (ctx->has_gates) {
+        in_grads->at(0) = JUST(functional::MoeCombineGrad(out_grads.at(0), expert_ids, positions,
+                                                          ctx->SavedTensors().at(2),
+                                                          ctx->num_experts, ctx->capacity));
+      } else {
+        in_grads->at(0) = JUST(functional::MoeDispatch(out_grads.at(0), expert_ids, positions,
+                                                       ctx->num_experts, ctx->capacity));
+      }
+    }
+    if (ctx->gates_requires_grad) {
+      in_grads->at(3) = JUST(functional::MoeGatesGrad(out_grads.at(0), ctx->SavedTensors().at(3),
+                                                      expert_ids, positions));
+    }
+    return Maybe<void>::Ok();
+  }
+};
+
+REGISTER_OP_EXPR_GRAD_FUNCTION("moe_gating", MoeGating);
+REGISTER_OP_EXPR_GRAD_FUNCTION("moe_dispatch", MoeDispatch);
+REGISTER_OP_EXPR_GRAD_FUNCTION("moe_combine", MoeCombine);
+
+}  // namespace one
+}  // namespace oneflow
@@ -112,7 +112,7 @@ class NormalizationGrad : public OpExprGradFunction<NormalizationGradInterpState
     MutableAttrMap norm_grad_attr;
     JUST(norm_grad_attr.SetAttr<int32_t>("axis", ctx->axis));
     JUST(norm_grad_attr.SetAttr<float>("epsilon", ctx->epsilon));
-    const auto& results = JUST(OpInterpUtil::Dispatch<TensorTuple>(
+    std::shared_ptr<TensorTuple> results = JUST(OpInterpUtil::Dispatch<TensorTuple>(
         *normalization_grad_op_, {x, y_grad, gamma, mean, inv_variance}, norm_grad_attr));
     CHECK_EQ_OR_RETURN(results->size(), 3);
     // The normalization op has 5 inputs which are x, moving_mean, moving_variance, gamma and beta.
@@ -127,6 +127,8 @@ class NormalizationGrad : public OpExprGradFunction<NormalizationGradInterpState
       in_grads->at(0) = results->at(0);
       return Maybe<void>::Ok();
     }
+    // x_diff of the op is not used in inference mode
+    results.reset();
 
     DimVector dim_vec;
     for (int i = 0; i < x->shape()->NumAxes(); ++i) {
@@ -143,13 +145,20 @@ class NormalizationGrad : public OpExprGradFunction<NormalizationGradInterpState
     const auto& reshaped_inv_variance =
         JUST(OpInterpUtil::Dispatch<Tensor>(*reshape_variance_op_, {inv_variance}, shape_attr));
 
-    std::shared_ptr<Tensor> y_grad_fp32 = y_grad;
-    bool is_fp16 = y_grad->dtype() == DataType::kFloat16;
-    if (is_fp16) { y_grad_fp32 = JUST(OpInterpUtil::Dispatch<Tensor>(*h2f_cast_op_, {y_grad})); }
-    const auto& dy_mul_gamma =
-        JUST(OpInterpUtil::Dispatch<Tensor>(*broadcast_mul_op_, {reshaped_gamma, y_grad_fp32}));
-    const auto& dy_mul_inv_var = JUST(
-        OpInterpUtil::Dispatch<Tensor>(*broadcast_mul_op_, {dy_mul_gamma, reshaped_inv_variance}));
+    const bool is_fp16 = y_grad->dtype() == DataType::kFloat16;
+    std::shared_ptr<Tensor> dy_mul_inv_var;
+    {
+      // release the fp32 copy of dy and dy * gamma once their consumers are dispatched
+      std::shared_ptr<Tensor> y_grad_fp32 = y_grad;
+      if (is_fp16) {
+        y_grad_fp32 = JUST(OpInterpUtil::Dispatch<Tensor>(*h2f_cast_op_, {y_grad}));
+      }
+      std::shared_ptr<Tensor> dy_mul_gamma =
+          JUST(OpInterpUtil::Dispatch<Tensor>(*broadcast_mul_op_, {reshaped_gamma, y_grad_fp32}));
+      y_grad_fp32.reset();
+      dy_mul_inv_var = JUST(OpInterpUtil::Dispatch<Tensor>(
+          *broadcast_mul_op_, {dy_mul_gamma, reshaped_inv_variance}));
+    }
     if (is_fp16) {
       in_grads->at(0) = JUST(OpInterpUtil::Dispatch<Tensor>(*f2h_cast_op_, {dy_mul_inv_var}));
     } else {
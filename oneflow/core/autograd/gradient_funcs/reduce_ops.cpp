@@ -104,12 +104,20 @@ Maybe<void> ReduceMaxOrMinOp::Apply(const ReduceMaxOrMinOpInterpState* ctx,
   const auto& output = ctx->SavedTensors().at(1);
   const auto& dy = out_grads.at(0);
 
-  const auto& bcast_like = JUST(functional::BroadcastLike(output, input, ctx->axis));
-  const auto& bcast_eq = JUST(functional::BroadcastEqual(input, bcast_like));
-  const auto& cast_like = JUST(functional::CastLike(bcast_eq, input));
-  const auto& reduce_sum_ = JUST(functional::ReduceSum(cast_like, ctx->axis, ctx->keepdims));
-  const auto& bcast_div_ = JUST(functional::BroadcastDiv(dy, reduce_sum_));
-  const auto& bcast_like_div = JUST(functional::BroadcastLike(bcast_div_, input, ctx->axis));
+  // The temporaries as large as the input are scoped so that each is released right after its
+  // last consumer has been dispatched, and the VM can reuse its memory for the following ops.
+  std::shared_ptr<Tensor> cast_like;
+  {
+    const auto& bcast_like = JUST(functional::BroadcastLike(output, input, ctx->axis));
+    const auto& bcast_eq = JUST(functional::BroadcastEqual(input, bcast_like));
+    cast_like = JUST(functional::CastLike(bcast_eq, input));
+  }
+  std::shared_ptr<Tensor> bcast_like_div;
+  {
+    const auto& reduce_sum_ = JUST(functional::ReduceSum(cast_like, ctx->axis, ctx->keepdims));
+    const auto& bcast_div_ = JUST(functional::BroadcastDiv(dy, reduce_sum_));
+    bcast_like_div = JUST(functional::BroadcastLike(bcast_div_, input, ctx->axis));
+  }
 
   in_grads->resize(1);
   in_grads->at(0) = JUST(functional::Multiply(bcast_like_div, cast_like));
@@ -20,36 +20,32 @@ limitations under the License.
 #include "oneflow/core/framework/op_interpreter/op_interpreter_util.h"
 #include "oneflow/core/framework/op_expr.h"
 #include "oneflow/core/framework/op_expr_helper.h"
+#include "oneflow/core/functional/functional.h"
 
 namespace oneflow {
 namespace one {
 
-class ReshapeOpExprGrad : public OpExprGradFunction<OpExprInterpState> {
+struct ReshapeInterpState : public OpExprInterpState {
+  Shape shape;
+};
+
+class ReshapeOpExprGrad : public OpExprGradFunction<ReshapeInterpState> {
  public:
-  Maybe<void> Init(const OpExpr& op) override {
-    const auto* fw_op_expr = dynamic_cast<const UserOpExpr*>(&op);
-    CHECK_NOTNULL_OR_RETURN(fw_op_expr);
-    backward_op_ = JUST(op_expr_helper::ReshapeLikeOp(GradientOpName(fw_op_expr->op_name())));
-    return Maybe<void>::Ok();
-  }
+  Maybe<void> Init(const OpExpr& op) override { return Maybe<void>::Ok(); }
 
-  Maybe<void> Capture(OpExprInterpState* ctx, const TensorTuple& inputs, const TensorTuple& outputs,
-                      const AttrMap& attrs) const override {
-    ctx->SaveTensorForBackward(inputs.at(0));
+  Maybe<void> Capture(ReshapeInterpState* ctx, const TensorTuple& inputs,
+                      const TensorTuple& outputs, const AttrMap& attrs) const override {
+    // only the shape of the input is needed by backward
+    ctx->shape = *(inputs.at(0)->shape());
     return Maybe<void>::Ok();
   }
 
-  Maybe<void> Apply(const OpExprInterpState* ctx, const TensorTuple& out_grads,
+  Maybe<void> Apply(const ReshapeInterpState* ctx, const TensorTuple& out_grads,
                     TensorTuple* in_grads) const override {
-    const auto& saved_tensors = ctx->SavedTensors();
     in_grads->resize(1);
-    in_grads->at(0) =
-        JUST(OpInterpUtil::Dispatch<Tensor>(*backward_op_, {out_grads.at(0), saved_tensors.at(0)}));
+    in_grads->at(0) = JUST(functional::Reshape(out_grads.at(0), ctx->shape));
     return Maybe<void>::Ok();
   }
-
- private:
-  std::shared_ptr<OpExpr> backward_op_;
 };
 
 REGISTER_OP_EXPR_GRAD_FUNCTION("reshape", ReshapeOpExprGrad);
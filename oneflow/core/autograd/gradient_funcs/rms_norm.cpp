@@ -0,0 +1,92 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/framework/attr_map.h"
+#include "oneflow/core/framework/op_expr_grad_function.h"
+#include "oneflow/core/functional/functional.h"
+
+namespace oneflow {
+namespace one {
+
+struct RmsNormInterpState : public OpExprInterpState {
+  bool has_weight;
+  bool has_residual;
+  bool x_requires_grad;
+  bool weight_requires_grad;
+  int64_t begin_norm_axis;
+};
+
+// y, inv_rms, [add_out] = rms_norm(x, [weight], [residual]). With residual, add_out = x + residual
+// is the normalized tensor, and both x and residual get its grad.
+class RmsNorm : public OpExprGradFunction<RmsNormInterpState> {
+ public:
+  Maybe<void> Init(const OpExpr& op) override {
+    const auto* fw_op_expr = dynamic_cast<const UserOpExpr*>(&op);
+    CHECK_NOTNULL_OR_RETURN(fw_op_expr);
+    base_attrs_ = MakeAttrMapFromUserOpConf(fw_op_expr->proto());
+    return Maybe<void>::Ok();
+  }
+
+  Maybe<void> Capture(RmsNormInterpState* ctx, const TensorTuple& inputs,
+                      const TensorTuple& outputs, const AttrMap& attrs) const override {
+    ctx->has_residual = outputs.size() == 3;
+    ctx->has_weight = inputs.size() == 2 + ctx->has_residual;
+    CHECK_EQ_OR_RETURN(inputs.size(), 1 + ctx->has_weight + ctx->has_residual);
+    ctx->x_requires_grad = inputs.at(0)->requires_grad()
+                           || (ctx->has_residual && inputs.back()->requires_grad());
+    ctx->weight_requires_grad = ctx->has_weight && inputs.at(1)->requires_grad();
+    if (!ctx->x_requires_grad && !ctx->weight_requires_grad) { return Maybe<void>::Ok(); }
+
+    ComposedAttrMap composed_attrs(attrs, base_attrs_);
+    ctx->begin_norm_axis = JUST(composed_attrs.GetAttr<int64_t>("begin_norm_axis"));
+    ctx->SaveTensorForBackward(ctx->has_residual ? outputs.at(2) : inputs.at(0));
+    ctx->SaveTensorForBackward(outputs.at(1));  // inv_rms
+    if (ctx->has_weight) { ctx->SaveTensorForBackward(inputs.at(1)); }
+    return Maybe<void>::Ok();
+  }
+
+  Maybe<void> Apply(const RmsNormInterpState* ctx, const TensorTuple& out_grads,
+                    TensorTuple* in_grads) const override {
+    in_grads->resize(1 + ctx->has_weight + ctx->has_residual);
+    if (!ctx->x_requires_grad && !ctx->weight_requires_grad) { return Maybe<void>::Ok(); }
+    const auto& saved = ctx->SavedTensors();
+    const auto& x = saved.at(0);
+    const auto& inv_rms = saved.at(1);
+    const auto& dy = out_grads.at(0);
+    if (ctx->weight_requires_grad) {
+      in_grads->at(1) =
+          JUST(functional::RmsNormParamGrad(dy, x, inv_rms, ctx->begin_norm_axis));
+    }
+    if (ctx->x_requires_grad) {
+      Optional<one::Tensor> weight;
+      if (ctx->has_weight) { weight = saved.at(2); }
+      auto dx = JUST(functional::RmsNormGrad(dy, x, inv_rms, ctx->begin_norm_axis, weight));
+      if (ctx->has_residual) {
+        dx = JUST(functional::Add(dx, out_grads.at(2), /*inplace=*/false));
+        in_grads->back() = dx;
+      }
+      in_grads->at(0) = dx;
+    }
+    return Maybe<void>::Ok();
+  }
+
+ private:
+  AttrMap base_attrs_;
+};
+
+REGISTER_OP_EXPR_GRAD_FUNCTION("rms_norm", RmsNorm);
+
+}  // namespace one
+}  // namespace oneflow
@@ -0,0 +1,85 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/framework/op_expr_grad_function.h"
+#include "oneflow/core/functional/functional.h"
+
+namespace oneflow {
+namespace one {
+
+struct PackSequenceInterpState : public OpExprInterpState {
+  bool requires_grad;
+  int64_t max_seq_len;
+};
+
+class PackSequence : public OpExprGradFunction<PackSequenceInterpState> {
+ public:
+  Maybe<void> Init(const OpExpr& op) override { return Maybe<void>::Ok(); }
+
+  Maybe<void> Capture(PackSequenceInterpState* ctx, const TensorTuple& inputs,
+                      const TensorTuple& outputs, const AttrMap& attrs) const override {
+    CHECK_EQ_OR_RETURN(inputs.size(), 2);
+    CHECK_EQ_OR_RETURN(outputs.size(), 2);
+    ctx->requires_grad = inputs.at(0)->requires_grad();
+    if (!ctx->requires_grad) { return Maybe<void>::Ok(); }
+    ctx->max_seq_len = inputs.at(0)->shape()->At(1);
+    ctx->SaveTensorForBackward(outputs.at(1));  // cu_seqlens
+    return Maybe<void>::Ok();
+  }
+
+  Maybe<void> Apply(const PackSequenceInterpState* ctx, const TensorTuple& out_grads,
+                    TensorTuple* in_grads) const override {
+    if (!ctx->requires_grad) { return Maybe<void>::Ok(); }
+    CHECK_EQ_OR_RETURN(out_grads.size(), 2);
+    in_grads->resize(2);
+    in_grads->at(0) = JUST(
+        functional::UnpackSequence(out_grads.at(0), ctx->SavedTensors().at(0), ctx->max_seq_len));
+    return Maybe<void>::Ok();
+  }
+};
+
+struct UnpackSequenceInterpState : public OpExprInterpState {
+  bool requires_grad;
+};
+
+class UnpackSequence : public OpExprGradFunction<UnpackSequenceInterpState> {
+ public:
+  Maybe<void> Init(const OpExpr& op) override { return Maybe<void>::Ok(); }
+
+  Maybe<void> Capture(UnpackSequenceInterpState* ctx, const TensorTuple& inputs,
+                      const TensorTuple& outputs, const AttrMap& attrs) const override {
+    CHECK_EQ_OR_RETURN(inputs.size(), 2);
+    ctx->requires_grad = inputs.at(0)->requires_grad();
+    if (!ctx->requires_grad) { return Maybe<void>::Ok(); }
+    ctx->SaveTensorForBackward(inputs.at(1));  // cu_seqlens
+    return Maybe<void>::Ok();
+  }
+
+  Maybe<void> Apply(const UnpackSequenceInterpState* ctx, const TensorTuple& out_grads,
+                    TensorTuple* in_grads) const override {
+    if (!ctx->requires_grad) { return Maybe<void>::Ok(); }
+    CHECK_EQ_OR_RETURN(out_grads.size(), 1);
+    in_grads->resize(2);
+    in_grads->at(0) =
+        JUST(functional::UnpackSequenceGrad(out_grads.at(0), ctx->SavedTensors().at(0)));
+    return Maybe<void>::Ok();
+  }
+};
+
+REGISTER_OP_EXPR_GRAD_FUNCTION("pack_sequence", PackSequence);
+REGISTER_OP_EXPR_GRAD_FUNCTION("unpack_sequence", UnpackSequence);
+
+}  // namespace one
+}  // namespace oneflow
@@ -18,12 +18,14 @@ limitations under the License.
 #include "oneflow/core/framework/op_expr.h"
 #include "oneflow/core/framework/op_expr_helper.h"
 #include "oneflow/core/framework/op_interpreter/op_interpreter_util.h"
+#include "oneflow/core/functional/functional.h"
 
 namespace oneflow {
 namespace one {
 
 struct SqueezeInterpState : public OpExprInterpState {
   bool requires_grad;
+  Shape shape;
 };
 
 class Squeeze : public OpExprGradFunction<SqueezeInterpState> {
@@ -36,15 +38,12 @@ class Squeeze : public OpExprGradFunction<SqueezeInterpState> {
 
  private:
   AttrMap base_attrs_;
-  std::shared_ptr<OpExpr> grad_op_;
 };
 
 Maybe<void> Squeeze::Init(const OpExpr& op) {
   const UserOpExpr* fw_op_expr = dynamic_cast<const UserOpExpr*>(&op);
   CHECK_NOTNULL_OR_RETURN(fw_op_expr);
   base_attrs_ = MakeAttrMapFromUserOpConf(fw_op_expr->proto());
-  const std::string& op_name = fw_op_expr->op_name();
-  grad_op_ = JUST(op_expr_helper::ReshapeLikeOp(GradientOpName(op_name)));
   return Maybe<void>::Ok();
 }
 
@@ -53,7 +52,8 @@ Maybe<void> Squeeze::Capture(SqueezeInterpState* ctx, const TensorTuple& inputs,
   ctx->requires_grad = inputs.at(0)->requires_grad();
   if (!ctx->requires_grad) { return Maybe<void>::Ok(); }
 
-  ctx->SaveTensorForBackward(inputs.at(0));
+  // only the shape of the input is needed by backward
+  ctx->shape = *(inputs.at(0)->shape());
   return Maybe<void>::Ok();
 }
 
@@ -62,9 +62,8 @@ Maybe<void> Squeeze::Apply(const SqueezeInterpState* ctx, const TensorTuple& out
   if (!ctx->requires_grad) { return Maybe<void>::Ok(); }
   CHECK_EQ_OR_RETURN(out_grads.size(), 1);
 
-  const std::shared_ptr<oneflow::one::Tensor>& like = ctx->SavedTensors().at(0);
   in_grads->resize(1);
-  in_grads->at(0) = JUST(OpInterpUtil::Dispatch<Tensor>(*grad_op_, {out_grads.at(0), like}));
+  in_grads->at(0) = JUST(functional::Reshape(out_grads.at(0), ctx->shape));
   return Maybe<void>::Ok();
 }
 
@@ -0,0 +1,79 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <vector>
+#include "oneflow/core/autograd/saved_tensor_hooks.h"
+#include "oneflow/core/framework/device.h"
+#include "oneflow/core/framework/tensor.h"
+#include "oneflow/core/functional/functional.h"
+
+namespace oneflow {
+namespace one {
+
+namespace {
+
+std::vector<SavedTensorPackHook>* ThreadLocalPackHooks() {
+  static thread_local std::vector<SavedTensorPackHook> pack_hooks;
+  return &pack_hooks;
+}
+
+SavedTensorUnpacker MakeIdentityUnpacker(const std::shared_ptr<Tensor>& tensor) {
+  return [tensor]() -> Maybe<Tensor> { return tensor; };
+}
+
+}  // namespace
+
+const SavedTensorPackHook* CurrentSavedTensorPackHook() {
+  const auto* pack_hooks = ThreadLocalPackHooks();
+  if (pack_hooks->empty()) { return nullptr; }
+  return &pack_hooks->back();
+}
+
+SavedTensorHooksScope::SavedTensorHooksScope(const SavedTensorPackHook& pack_hook) {
+  ThreadLocalPackHooks()->push_back(pack_hook);
+}
+
+SavedTensorHooksScope::~SavedTensorHooksScope() { ThreadLocalPackHooks()->pop_back(); }
+
+SavedTensorPackHook MakeSaveOnCpuPackHook() {
+  return [](const std::shared_ptr<Tensor>& tensor) -> Maybe<SavedTensorUnpacker> {
+    if (tensor->is_consistent()) { return MakeIdentityUnpacker(tensor); }
+    Symbol<Device> device = JUST(tensor->device());
+    if (device->type() == "cpu") { return MakeIdentityUnpacker(tensor); }
+    const auto& packed = JUST(functional::Copy(tensor, "cpu", 0));
+    return SavedTensorUnpacker([packed, device]() -> Maybe<Tensor> {
+      return functional::Copy(packed, device->type(), device->device_id());
+    });
+  };
+}
+
+SavedTensorPackHook MakeSaveInHalfPackHook() {
+  return [](const std::shared_ptr<Tensor>& tensor) -> Maybe<SavedTensorUnpacker> {
+    DataType data_type = tensor->dtype();
+    if (data_type != DataType::kFloat && data_type != DataType::kDouble) {
+      return MakeIdentityUnpacker(tensor);
+    }
+    // float16 casting is only supported on cuda
+    if (tensor->is_local() && JUST(tensor->device())->type() == "cpu") {
+      return MakeIdentityUnpacker(tensor);
+    }
+    const auto& packed = JUST(functional::Cast(tensor, DataType::kFloat16));
+    return SavedTensorUnpacker(
+        [packed, data_type]() -> Maybe<Tensor> { return functional::Cast(packed, data_type); });
+  };
+}
+
+}  // namespace one
+}  // namespace oneflow
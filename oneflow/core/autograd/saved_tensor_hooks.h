@@ -0,0 +1,52 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_AUTOGRAD_SAVED_TENSOR_HOOKS_H_
+#define ONEFLOW_CORE_AUTOGRAD_SAVED_TENSOR_HOOKS_H_
+
+#include <functional>
+#include <memory>
+#include "oneflow/core/common/maybe.h"
+
+namespace oneflow {
+namespace one {
+
+class Tensor;
+
+// Restores a tensor packed by a `SavedTensorPackHook' when backward needs it.
+using SavedTensorUnpacker = std::function<Maybe<Tensor>()>;
+// Called on each tensor saved for backward, e.g. to offload it to host or to compress it.
+using SavedTensorPackHook =
+    std::function<Maybe<SavedTensorUnpacker>(const std::shared_ptr<Tensor>&)>;
+
+// The innermost pack hook of the current thread, nullptr if there is none.
+const SavedTensorPackHook* CurrentSavedTensorPackHook();
+
+// Installs `pack_hook' for tensors saved by the ops called on this thread within the scope.
+class SavedTensorHooksScope final {
+ public:
+  explicit SavedTensorHooksScope(const SavedTensorPackHook& pack_hook);
+  ~SavedTensorHooksScope();
+};
+
+// Keeps saved tensors of devices on host memory until backward.
+SavedTensorPackHook MakeSaveOnCpuPackHook();
+// Keeps saved float tensors of cuda in float16, which makes the grads approximate.
+SavedTensorPackHook MakeSaveInHalfPackHook();
+
+}  // namespace one
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_AUTOGRAD_SAVED_TENSOR_HOOKS_H_
@@ -18,6 +18,7 @@ limitations under the License.
 #include "oneflow/core/job/resource_desc.h"
 #include "oneflow/core/job/env_desc.h"
 #include "oneflow/core/job/global_for.h"
+#include "oneflow/core/thread/thread_affinity.h"
 
 namespace oneflow {
 
@@ -87,9 +88,14 @@ CommNet::CommNet() {
   for (int64_t i : Global<ResourceDesc, ForSession>::Get()->process_ranks()) {
     if (i == this_machine_id) { continue; }
     peer_machine_id_.insert(i);
+    peer2read_bytes_counter_.emplace(
+        i, profiler::GetCounter("oneflow_comm_net_read_bytes_total",
+                                "bytes read from a peer process by the comm net",
+                                {{"peer", std::to_string(i)}}));
   }
 
   ready_cb_poller_ = std::thread([this]() {
+    BindCurrentThreadToRoleCores(ThreadRole::kComm);
     std::function<void()> cb;
     while (ready_cbs_.Receive(&cb) == kChannelStatusSuccess) { cb(); }
   });
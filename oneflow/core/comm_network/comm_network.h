@@ -21,6 +21,7 @@ limitations under the License.
 #include "oneflow/core/actor/actor_message.h"
 #include "oneflow/core/common/platform.h"
 #include "oneflow/core/common/channel.h"
+#include "oneflow/core/profiler/metrics.h"
 
 namespace oneflow {
 
@@ -40,6 +41,9 @@ class CommNet {
   // we can use this token to use the "Read"
   virtual void* RegisterMemory(void* ptr, size_t byte_size) = 0;
   virtual void UnRegisterMemory(void* token) = 0;
+  // whether "RegisterMemory" accepts CUDA device memory, so that "Read" can move data between
+  // device-resident registers without bouncing through host memory
+  virtual bool IsDeviceMemorySupported() const { return false; }
 
   // Stream
   void* NewActorReadId();
@@ -55,6 +59,10 @@ class CommNet {
 
   virtual void DoRead(void* read_id, int64_t src_machine_id, void* src_token, void* dst_token) = 0;
   const HashSet<int64_t>& peer_machine_id() { return peer_machine_id_; }
+  // called by DoRead, exported as oneflow_comm_net_read_bytes_total per peer
+  void CountReadBytes(int64_t src_machine_id, int64_t byte_size) {
+    peer2read_bytes_counter_.at(src_machine_id)->Add(byte_size);
+  }
 
   Channel<std::function<void()>> ready_cbs_;
 
@@ -70,6 +78,7 @@ class CommNet {
     std::list<CommNetItem> waiting_list;
   };
   HashSet<int64_t> peer_machine_id_;
+  HashMap<int64_t, profiler::Counter*> peer2read_bytes_counter_;
   std::thread ready_cb_poller_;
 };
 
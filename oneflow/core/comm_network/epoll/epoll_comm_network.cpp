@@ -30,6 +30,12 @@ namespace {
 
 static const int32_t kInvlidPort = 0;
 
+// one read split into parts, see EpollCommNet::DoRead
+struct StripedReadCtx {
+  void* read_id;
+  std::atomic<int64_t> remaining_part_num;
+};
+
 sockaddr_in GetSockAddr(const std::string& addr, uint16_t port) {
   sockaddr_in sa;
   sa.sin_family = AF_INET;
@@ -39,7 +45,7 @@ sockaddr_in GetSockAddr(const std::string& addr, uint16_t port) {
   return sa;
 }
 
-int SockListen(int listen_sockfd, int32_t* listen_port, int32_t total_machine_num) {
+int SockListen(int listen_sockfd, int32_t* listen_port, int32_t backlog) {
   // System designated available port if listen_port == kInvlidPort, otherwise, the configured port
   // is used.
   sockaddr_in sa = GetSockAddr("0.0.0.0", *listen_port);
@@ -59,7 +65,7 @@ int SockListen(int listen_sockfd, int32_t* listen_port, int32_t total_machine_nu
     }
   }
   if (bind_result == 0) {
-    PCHECK(listen(listen_sockfd, total_machine_num) == 0);
+    PCHECK(listen(listen_sockfd, backlog) == 0);
     LOG(INFO) << "CommNet:Epoll listening on "
               << "0.0.0.0:" + std::to_string(*listen_port);
   } else {
@@ -99,7 +105,7 @@ void EpollCommNet::SendActorMsg(int64_t dst_machine_id, const ActorMsg& actor_ms
   if (actor_msg.IsDataRegstMsgToConsumer()) {
     msg.actor_msg.set_comm_net_token(actor_msg.regst()->comm_net_token());
   }
-  GetSocketHelper(dst_machine_id)->AsyncWrite(msg);
+  SendSocketMsg(dst_machine_id, msg);
 }
 
 void EpollCommNet::SendTransportMsg(int64_t dst_machine_id, const TransportMsg& transport_msg) {
@@ -110,7 +116,20 @@ void EpollCommNet::SendTransportMsg(int64_t dst_machine_id, const TransportMsg&
 }
 
 void EpollCommNet::SendSocketMsg(int64_t dst_machine_id, const SocketMsg& msg) {
-  GetSocketHelper(dst_machine_id)->AsyncWrite(msg);
+  SendSocketMsg(dst_machine_id, 0, msg);
+}
+
+void EpollCommNet::SendSocketMsg(int64_t dst_machine_id, int32_t stripe_id,
+                                 const SocketMsg& msg) {
+  GetSocketHelper(dst_machine_id, stripe_id)->AsyncWrite(msg);
+}
+
+void EpollCommNet::PartReadDone(void* read_ctx) {
+  auto* striped_read_ctx = static_cast<StripedReadCtx*>(read_ctx);
+  if (striped_read_ctx->remaining_part_num.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    ReadDone(striped_read_ctx->read_id);
+    delete striped_read_ctx;
+  }
 }
 
 SocketMemDesc* EpollCommNet::NewMemDesc(void* ptr, size_t byte_size) {
@@ -121,6 +140,12 @@ SocketMemDesc* EpollCommNet::NewMemDesc(void* ptr, size_t byte_size) {
 }
 
 EpollCommNet::EpollCommNet() : CommNetIf() {
+  stripe_num_ = ParseIntegerFromEnv("ONEFLOW_COMM_NET_EPOLL_STRIPE_NUM", 1);
+  CHECK_GT(stripe_num_, 0);
+  stripe_min_part_byte_size_ =
+      ParseIntegerFromEnv("ONEFLOW_COMM_NET_EPOLL_STRIPE_MIN_PART_BYTES", 1 << 20);
+  CHECK_GT(stripe_min_part_byte_size_, 0);
+  enable_zerocopy_ = ParseBooleanFromEnv("ONEFLOW_COMM_NET_EPOLL_ZEROCOPY", false);
   pollers_.resize(Global<ResourceDesc, ForSession>::Get()->CommNetWorkerNum(), nullptr);
   for (size_t i = 0; i < pollers_.size(); ++i) { pollers_[i] = new IOEventPoller; }
   InitSockets();
@@ -131,13 +156,13 @@ void EpollCommNet::InitSockets() {
   int64_t this_machine_id = GlobalProcessCtx::Rank();
   auto this_machine = Global<ResourceDesc, ForSession>::Get()->machine(this_machine_id);
   int64_t total_machine_num = Global<ResourceDesc, ForSession>::Get()->process_ranks().size();
-  machine_id2sockfd_.assign(total_machine_num, -1);
+  machine_id2sockfds_.assign(total_machine_num, std::vector<int>(stripe_num_, -1));
   sockfd2helper_.clear();
   size_t poller_idx = 0;
   auto NewSocketHelper = [&](int sockfd) {
     IOEventPoller* poller = pollers_[poller_idx];
     poller_idx = (poller_idx + 1) % pollers_.size();
-    return new SocketHelper(sockfd, poller);
+    return new SocketHelper(sockfd, poller, enable_zerocopy_);
   };
 
   // listen
@@ -150,7 +175,7 @@ void EpollCommNet::InitSockets() {
       this_listen_port = Global<EnvDesc>::Get()->data_port();
     }
   }
-  CHECK_EQ(SockListen(listen_sockfd, &this_listen_port, total_machine_num), 0);
+  CHECK_EQ(SockListen(listen_sockfd, &this_listen_port, total_machine_num * stripe_num_), 0);
   CHECK_NE(this_listen_port, 0);
   PushPort(this_machine_id, this_listen_port);
   int32_t src_machine_count = 0;
@@ -164,53 +189,82 @@ void EpollCommNet::InitSockets() {
     uint16_t peer_port = PullPort(peer_id);
     auto peer_machine = Global<ResourceDesc, ForSession>::Get()->machine(peer_id);
     sockaddr_in peer_sockaddr = GetSockAddr(peer_machine.addr(), peer_port);
-    int sockfd = socket(AF_INET, SOCK_STREAM, 0);
-    const int val = 1;
-    PCHECK(setsockopt(sockfd, IPPROTO_TCP, TCP_NODELAY, (char*)&val, sizeof(int)) == 0);
-    PCHECK(connect(sockfd, reinterpret_cast<sockaddr*>(&peer_sockaddr), sizeof(peer_sockaddr))
-           == 0);
-    ssize_t n = write(sockfd, &this_machine_id, sizeof(int64_t));
-    PCHECK(n == sizeof(int64_t));
-    CHECK(sockfd2helper_.emplace(sockfd, NewSocketHelper(sockfd)).second);
-    machine_id2sockfd_[peer_id] = sockfd;
+    FOR_RANGE(int32_t, stripe_id, 0, stripe_num_) {
+      int sockfd = socket(AF_INET, SOCK_STREAM, 0);
+      const int val = 1;
+      PCHECK(setsockopt(sockfd, IPPROTO_TCP, TCP_NODELAY, (char*)&val, sizeof(int)) == 0);
+      PCHECK(connect(sockfd, reinterpret_cast<sockaddr*>(&peer_sockaddr), sizeof(peer_sockaddr))
+             == 0);
+      const int64_t handshake[3] = {this_machine_id, stripe_id, stripe_num_};
+      ssize_t n = write(sockfd, handshake, sizeof(handshake));
+      PCHECK(n == sizeof(handshake));
+      CHECK(sockfd2helper_.emplace(sockfd, NewSocketHelper(sockfd)).second);
+      machine_id2sockfds_[peer_id][stripe_id] = sockfd;
+    }
   }
 
   // accept
-  HashSet<int64_t> processed_ranks;
-  FOR_RANGE(int32_t, idx, 0, src_machine_count) {
+  HashSet<std::pair<int64_t, int64_t>> processed_rank_and_stripes;
+  FOR_RANGE(int32_t, idx, 0, src_machine_count * stripe_num_) {
     sockaddr_in peer_sockaddr;
     socklen_t len = sizeof(peer_sockaddr);
     int sockfd = accept(listen_sockfd, reinterpret_cast<sockaddr*>(&peer_sockaddr), &len);
     PCHECK(sockfd != -1);
-    int64_t peer_rank;
-    ssize_t n = read(sockfd, &peer_rank, sizeof(int64_t));
-    PCHECK(n == sizeof(int64_t));
+    int64_t handshake[3];
+    ssize_t n = recv(sockfd, handshake, sizeof(handshake), MSG_WAITALL);
+    PCHECK(n == sizeof(handshake));
+    const int64_t peer_rank = handshake[0];
+    const int64_t stripe_id = handshake[1];
+    CHECK_EQ(handshake[2], stripe_num_)
+        << "ONEFLOW_COMM_NET_EPOLL_STRIPE_NUM differs between rank " << this_machine_id
+        << " and rank " << peer_rank;
+    const int val = 1;
+    PCHECK(setsockopt(sockfd, IPPROTO_TCP, TCP_NODELAY, (char*)&val, sizeof(int)) == 0);
     CHECK(sockfd2helper_.emplace(sockfd, NewSocketHelper(sockfd)).second);
-    CHECK(processed_ranks.emplace(peer_rank).second);
-    machine_id2sockfd_[peer_rank] = sockfd;
+    CHECK(processed_rank_and_stripes.emplace(peer_rank, stripe_id).second);
+    machine_id2sockfds_[peer_rank][stripe_id] = sockfd;
   }
   PCHECK(close(listen_sockfd) == 0);
   ClearPort(this_machine_id);
 
   // useful log
   FOR_RANGE(int64_t, machine_id, 0, total_machine_num) {
-    LOG(INFO) << "machine " << machine_id << " sockfd " << machine_id2sockfd_[machine_id];
+    for (int sockfd : machine_id2sockfds_[machine_id]) {
+      LOG(INFO) << "machine " << machine_id << " sockfd " << sockfd;
+    }
   }
 }
 
-SocketHelper* EpollCommNet::GetSocketHelper(int64_t machine_id) {
-  int sockfd = machine_id2sockfd_.at(machine_id);
+SocketHelper* EpollCommNet::GetSocketHelper(int64_t machine_id, int32_t stripe_id) {
+  int sockfd = machine_id2sockfds_.at(machine_id).at(stripe_id);
   return sockfd2helper_.at(sockfd);
 }
 
 void EpollCommNet::DoRead(void* read_id, int64_t src_machine_id, void* src_token, void* dst_token) {
-  SocketMsg msg;
-  msg.msg_type = SocketMsgType::kRequestWrite;
-  msg.request_write_msg.src_token = src_token;
-  msg.request_write_msg.dst_machine_id = GlobalProcessCtx::Rank();
-  msg.request_write_msg.dst_token = dst_token;
-  msg.request_write_msg.read_id = read_id;
-  GetSocketHelper(src_machine_id)->AsyncWrite(msg);
+  const int64_t byte_size = static_cast<const SocketMemDesc*>(dst_token)->byte_size;
+  CountReadBytes(src_machine_id, byte_size);
+  const int64_t part_num = std::max<int64_t>(
+      std::min<int64_t>(stripe_num_, byte_size / stripe_min_part_byte_size_), 1);
+  const int64_t part_byte_size =
+      std::max<int64_t>(GetCudaAlignedSize((byte_size + part_num - 1) / part_num), 1);
+  const int64_t aligned_part_num =
+      std::max<int64_t>((byte_size + part_byte_size - 1) / part_byte_size, 1);
+  auto* read_ctx = new StripedReadCtx;
+  read_ctx->read_id = read_id;
+  read_ctx->remaining_part_num = aligned_part_num;
+  FOR_RANGE(int64_t, part_id, 0, aligned_part_num) {
+    const int64_t offset = part_id * part_byte_size;
+    SocketMsg msg;
+    msg.msg_type = SocketMsgType::kRequestWrite;
+    msg.request_write_msg.src_token = src_token;
+    msg.request_write_msg.dst_machine_id = GlobalProcessCtx::Rank();
+    msg.request_write_msg.dst_token = dst_token;
+    msg.request_write_msg.read_ctx = read_ctx;
+    msg.request_write_msg.offset = offset;
+    msg.request_write_msg.byte_size = std::min(part_byte_size, byte_size - offset);
+    msg.request_write_msg.stripe_id = part_id;
+    SendSocketMsg(src_machine_id, part_id, msg);
+  }
 }
 
 }  // namespace oneflow
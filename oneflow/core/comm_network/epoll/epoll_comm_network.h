@@ -31,7 +31,10 @@ class EpollCommNet final : public CommNetIf<SocketMemDesc> {
 
   void SendActorMsg(int64_t dst_machine_id, const ActorMsg& msg) override;
   void SendSocketMsg(int64_t dst_machine_id, const SocketMsg& msg);
+  void SendSocketMsg(int64_t dst_machine_id, int32_t stripe_id, const SocketMsg& msg);
   void SendTransportMsg(int64_t dst_machine_id, const TransportMsg& msg);
+  // called once the body of every part of a read has been received
+  void PartReadDone(void* read_ctx);
 
  private:
   SocketMemDesc* NewMemDesc(void* ptr, size_t byte_size) override;
@@ -39,11 +42,17 @@ class EpollCommNet final : public CommNetIf<SocketMemDesc> {
   friend class Global<EpollCommNet>;
   EpollCommNet();
   void InitSockets();
-  SocketHelper* GetSocketHelper(int64_t machine_id);
+  SocketHelper* GetSocketHelper(int64_t machine_id, int32_t stripe_id);
   void DoRead(void* read_id, int64_t src_machine_id, void* src_token, void* dst_token) override;
 
+  // Every peer is connected by `stripe_num_' sockets which are spread over the pollers. Messages
+  // are sent on stripe 0 to keep their order, while a large read is split into parts of at least
+  // `stripe_min_part_byte_size_' bytes which are transferred on different stripes.
+  int32_t stripe_num_;
+  int64_t stripe_min_part_byte_size_;
+  bool enable_zerocopy_;
   std::vector<IOEventPoller*> pollers_;
-  std::vector<int> machine_id2sockfd_;
+  std::vector<std::vector<int>> machine_id2sockfds_;
   HashMap<int, SocketHelper*> sockfd2helper_;
 };
 
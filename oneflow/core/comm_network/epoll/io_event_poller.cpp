@@ -17,6 +17,7 @@ limitations under the License.
 
 #include "oneflow/core/comm_network/epoll/io_event_poller.h"
 #include <sys/eventfd.h>
+#include "oneflow/core/thread/thread_affinity.h"
 
 namespace oneflow {
 
@@ -42,11 +43,17 @@ IOEventPoller::~IOEventPoller() {
 
 void IOEventPoller::AddFd(int fd, std::function<void()> read_handler,
                           std::function<void()> write_handler) {
-  AddFd(fd, &read_handler, &write_handler);
+  AddFd(fd, &read_handler, &write_handler, nullptr);
+}
+
+void IOEventPoller::AddFd(int fd, std::function<void()> read_handler,
+                          std::function<void()> write_handler,
+                          std::function<void()> error_handler) {
+  AddFd(fd, &read_handler, &write_handler, &error_handler);
 }
 
 void IOEventPoller::AddFdWithOnlyReadHandler(int fd, std::function<void()> read_handler) {
-  AddFd(fd, &read_handler, nullptr);
+  AddFd(fd, &read_handler, nullptr, nullptr);
 }
 
 void IOEventPoller::Start() { thread_ = std::thread(&IOEventPoller::EpollLoop, this); }
@@ -58,7 +65,8 @@ void IOEventPoller::Stop() {
 }
 
 void IOEventPoller::AddFd(int fd, std::function<void()>* read_handler,
-                          std::function<void()>* write_handler) {
+                          std::function<void()>* write_handler,
+                          std::function<void()>* error_handler) {
   // Set Fd NONBLOCK
   int opt = fcntl(fd, F_GETFL);
   PCHECK(opt != -1);
@@ -71,6 +79,7 @@ void IOEventPoller::AddFd(int fd, std::function<void()>* read_handler,
   IOHandler* io_handler = new IOHandler;
   if (read_handler) { io_handler->read_handler = *read_handler; }
   if (write_handler) { io_handler->write_handler = *write_handler; }
+  if (error_handler) { io_handler->error_handler = *error_handler; }
   io_handler->fd = fd;
   io_handlers_.push_front(io_handler);
   // Add Fd to Epoll
@@ -83,6 +92,7 @@ void IOEventPoller::AddFd(int fd, std::function<void()>* read_handler,
 }
 
 void IOEventPoller::EpollLoop() {
+  BindCurrentThreadToRoleCores(ThreadRole::kComm);
   while (true) {
     int event_num = epoll_wait(epfd_, ep_events_, max_event_num_, -1);
     if (event_num == -1) {
@@ -92,7 +102,10 @@ void IOEventPoller::EpollLoop() {
     const epoll_event* cur_event = ep_events_;
     for (int event_idx = 0; event_idx < event_num; ++event_idx, ++cur_event) {
       auto io_handler = static_cast<IOHandler*>(cur_event->data.ptr);
-      PCHECK(!(cur_event->events & EPOLLERR)) << "fd: " << io_handler->fd;
+      if (cur_event->events & EPOLLERR) {
+        PCHECK(static_cast<bool>(io_handler->error_handler)) << "fd: " << io_handler->fd;
+        io_handler->error_handler();
+      }
       if (io_handler->fd == break_epoll_loop_fd_) { return; }
       if (cur_event->events & EPOLLIN) {
         if (cur_event->events & EPOLLRDHUP) {
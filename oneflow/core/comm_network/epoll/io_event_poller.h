@@ -30,6 +30,10 @@ class IOEventPoller final {
 
   void AddFd(int fd, std::function<void()> read_handler, std::function<void()> write_handler);
   void AddFdWithOnlyReadHandler(int fd, std::function<void()> read_handler);
+  // `error_handler' is called on EPOLLERR, e.g. to drain the MSG_ZEROCOPY completions from the
+  // socket error queue. Without an error handler EPOLLERR is fatal.
+  void AddFd(int fd, std::function<void()> read_handler, std::function<void()> write_handler,
+             std::function<void()> error_handler);
 
   void Start();
   void Stop();
@@ -43,10 +47,12 @@ class IOEventPoller final {
     }
     std::function<void()> read_handler;
     std::function<void()> write_handler;
+    std::function<void()> error_handler;
     int fd;
   };
 
-  void AddFd(int fd, std::function<void()>* read_handler, std::function<void()>* write_handler);
+  void AddFd(int fd, std::function<void()>* read_handler, std::function<void()>* write_handler,
+             std::function<void()>* error_handler);
 
   void EpollLoop();
   static const int max_event_num_;
@@ -19,12 +19,19 @@ limitations under the License.
 
 namespace oneflow {
 
-SocketHelper::SocketHelper(int sockfd, IOEventPoller* poller) {
+SocketHelper::SocketHelper(int sockfd, IOEventPoller* poller, bool enable_zerocopy) {
   read_helper_ = new SocketReadHelper(sockfd);
-  write_helper_ = new SocketWriteHelper(sockfd, poller);
-  poller->AddFd(
-      sockfd, [this]() { read_helper_->NotifyMeSocketReadable(); },
-      [this]() { write_helper_->NotifyMeSocketWriteable(); });
+  write_helper_ = new SocketWriteHelper(sockfd, poller, enable_zerocopy);
+  if (write_helper_->zerocopy_enabled()) {
+    poller->AddFd(
+        sockfd, [this]() { read_helper_->NotifyMeSocketReadable(); },
+        [this]() { write_helper_->NotifyMeSocketWriteable(); },
+        [this]() { write_helper_->NotifyMeSocketError(); });
+  } else {
+    poller->AddFd(
+        sockfd, [this]() { read_helper_->NotifyMeSocketReadable(); },
+        [this]() { write_helper_->NotifyMeSocketWriteable(); });
+  }
 }
 
 SocketHelper::~SocketHelper() {
@@ -30,7 +30,7 @@ class SocketHelper final {
   SocketHelper() = delete;
   ~SocketHelper();
 
-  SocketHelper(int sockfd, IOEventPoller* poller);
+  SocketHelper(int sockfd, IOEventPoller* poller, bool enable_zerocopy);
 
   void AsyncWrite(const SocketMsg& msg);
 
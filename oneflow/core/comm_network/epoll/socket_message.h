@@ -29,6 +29,7 @@ limitations under the License.
 #include <sys/epoll.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <unistd.h>
 #include "oneflow/core/actor/actor_message.h"
 #include "oneflow/core/transport/transport_message.h"
@@ -47,17 +48,24 @@ enum class SocketMsgType {
 #undef MAKE_ENTRY
 };
 
+// A read may be split into several parts, each of which is requested and transferred on its own
+// stripe. `offset' and `byte_size' describe the part inside both the src and the dst memory.
 struct RequestWriteMsg {
   void* src_token;
   int64_t dst_machine_id;
   void* dst_token;
-  void* read_id;
+  void* read_ctx;
+  int64_t offset;
+  int64_t byte_size;
+  int32_t stripe_id;
 };
 
 struct RequestReadMsg {
   void* src_token;
   void* dst_token;
-  void* read_id;
+  void* read_ctx;
+  int64_t offset;
+  int64_t byte_size;
 };
 
 struct SocketMsg {
@@ -83,7 +83,7 @@ void SocketReadHelper::SetStatusWhenMsgHeadDone() {
 
 void SocketReadHelper::SetStatusWhenMsgBodyDone() {
   if (cur_msg_.msg_type == SocketMsgType::kRequestRead) {
-    Global<EpollCommNet>::Get()->ReadDone(cur_msg_.request_read_msg.read_id);
+    Global<EpollCommNet>::Get()->PartReadDone(cur_msg_.request_read_msg.read_ctx);
   }
   SwitchToMsgHeadReadHandle();
 }
@@ -93,16 +93,20 @@ void SocketReadHelper::SetStatusWhenRequestWriteMsgHeadDone() {
   msg_to_send.msg_type = SocketMsgType::kRequestRead;
   msg_to_send.request_read_msg.src_token = cur_msg_.request_write_msg.src_token;
   msg_to_send.request_read_msg.dst_token = cur_msg_.request_write_msg.dst_token;
-  msg_to_send.request_read_msg.read_id = cur_msg_.request_write_msg.read_id;
+  msg_to_send.request_read_msg.read_ctx = cur_msg_.request_write_msg.read_ctx;
+  msg_to_send.request_read_msg.offset = cur_msg_.request_write_msg.offset;
+  msg_to_send.request_read_msg.byte_size = cur_msg_.request_write_msg.byte_size;
   Global<EpollCommNet>::Get()->SendSocketMsg(cur_msg_.request_write_msg.dst_machine_id,
-                                             msg_to_send);
+                                             cur_msg_.request_write_msg.stripe_id, msg_to_send);
   SwitchToMsgHeadReadHandle();
 }
 
 void SocketReadHelper::SetStatusWhenRequestReadMsgHeadDone() {
   auto mem_desc = static_cast<const SocketMemDesc*>(cur_msg_.request_read_msg.dst_token);
-  read_ptr_ = reinterpret_cast<char*>(mem_desc->mem_ptr);
-  read_size_ = mem_desc->byte_size;
+  CHECK_LE(cur_msg_.request_read_msg.offset + cur_msg_.request_read_msg.byte_size,
+           static_cast<int64_t>(mem_desc->byte_size));
+  read_ptr_ = reinterpret_cast<char*>(mem_desc->mem_ptr) + cur_msg_.request_read_msg.offset;
+  read_size_ = cur_msg_.request_read_msg.byte_size;
   cur_read_handle_ = &SocketReadHelper::MsgBodyReadHandle;
 }
 
@@ -18,10 +18,31 @@ limitations under the License.
 #include "oneflow/core/comm_network/epoll/socket_write_helper.h"
 #include "oneflow/core/comm_network/epoll/socket_memory_desc.h"
 
+#include <cstring>
 #include <sys/eventfd.h>
+#include <linux/errqueue.h>
 
 namespace oneflow {
 
+namespace {
+
+// MSG_ZEROCOPY pins the pages and notifies the completion through the socket error queue, which
+// only pays off for large buffers
+const size_t kZeroCopyMinByteSize = 64 * 1024;
+
+bool TryEnableZeroCopy(int sockfd) {
+#if defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY)
+  const int val = 1;
+  if (setsockopt(sockfd, SOL_SOCKET, SO_ZEROCOPY, &val, sizeof(val)) == 0) { return true; }
+  PLOG(WARNING) << "CommNet:Epoll failed to enable SO_ZEROCOPY on fd " << sockfd;
+#else
+  LOG(WARNING) << "CommNet:Epoll MSG_ZEROCOPY is not supported by this build";
+#endif
+  return false;
+}
+
+}  // namespace
+
 SocketWriteHelper::~SocketWriteHelper() {
   delete cur_msg_queue_;
   cur_msg_queue_ = nullptr;
@@ -32,17 +53,19 @@ SocketWriteHelper::~SocketWriteHelper() {
   }
 }
 
-SocketWriteHelper::SocketWriteHelper(int sockfd, IOEventPoller* poller) {
+SocketWriteHelper::SocketWriteHelper(int sockfd, IOEventPoller* poller, bool enable_zerocopy) {
   sockfd_ = sockfd;
   queue_not_empty_fd_ = eventfd(0, 0);
   PCHECK(queue_not_empty_fd_ != -1);
   poller->AddFdWithOnlyReadHandler(queue_not_empty_fd_,
                                    std::bind(&SocketWriteHelper::ProcessQueueNotEmptyEvent, this));
+  zerocopy_enabled_ = enable_zerocopy && TryEnableZeroCopy(sockfd);
   cur_msg_queue_ = new std::queue<SocketMsg>;
   pending_msg_queue_ = new std::queue<SocketMsg>;
   cur_write_handle_ = &SocketWriteHelper::InitMsgWriteHandle;
-  write_ptr_ = nullptr;
-  write_size_ = 0;
+  iov_idx_ = 0;
+  iov_num_ = 0;
+  body_byte_size_ = 0;
 }
 
 void SocketWriteHelper::AsyncWrite(const SocketMsg& msg) {
@@ -55,6 +78,31 @@ void SocketWriteHelper::AsyncWrite(const SocketMsg& msg) {
 
 void SocketWriteHelper::NotifyMeSocketWriteable() { WriteUntilMsgQueueEmptyOrSocketNotWriteable(); }
 
+void SocketWriteHelper::NotifyMeSocketError() {
+  // The bodies are owned by registers which are not reused before the peer has read them, so the
+  // zerocopy completions only need to be drained.
+  while (true) {
+    char control[128];
+    msghdr msg;
+    std::memset(&msg, 0, sizeof(msg));
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    if (recvmsg(sockfd_, &msg, MSG_ERRQUEUE) == -1) {
+      PCHECK(errno == EAGAIN || errno == EWOULDBLOCK);
+      break;
+    }
+    for (cmsghdr* cm = CMSG_FIRSTHDR(&msg); cm != nullptr; cm = CMSG_NXTHDR(&msg, cm)) {
+      const auto* err = reinterpret_cast<const sock_extended_err*>(CMSG_DATA(cm));
+      CHECK(err->ee_errno == 0 && err->ee_origin == SO_EE_ORIGIN_ZEROCOPY)
+          << "fd: " << sockfd_ << ", errno: " << err->ee_errno;
+    }
+  }
+  int so_error = 0;
+  socklen_t len = sizeof(so_error);
+  PCHECK(getsockopt(sockfd_, SOL_SOCKET, SO_ERROR, &so_error, &len) == 0);
+  CHECK_EQ(so_error, 0) << "fd: " << sockfd_ << ", " << strerror(so_error);
+}
+
 void SocketWriteHelper::SendQueueNotEmptyEvent() {
   uint64_t event_num = 1;
   PCHECK(write(queue_not_empty_fd_, &event_num, 8) == 8);
@@ -80,68 +128,88 @@ bool SocketWriteHelper::InitMsgWriteHandle() {
   }
   cur_msg_ = cur_msg_queue_->front();
   cur_msg_queue_->pop();
-  write_ptr_ = reinterpret_cast<const char*>(&cur_msg_);
-  write_size_ = sizeof(cur_msg_);
-  cur_write_handle_ = &SocketWriteHelper::MsgHeadWriteHandle;
-  return true;
-}
-
-bool SocketWriteHelper::MsgHeadWriteHandle() {
-  return DoCurWrite(&SocketWriteHelper::SetStatusWhenMsgHeadDone);
-}
-
-bool SocketWriteHelper::MsgBodyWriteHandle() {
-  return DoCurWrite(&SocketWriteHelper::SetStatusWhenMsgBodyDone);
-}
-
-bool SocketWriteHelper::DoCurWrite(void (SocketWriteHelper::*set_cur_write_done)()) {
-  ssize_t n = write(sockfd_, write_ptr_, write_size_);
-  if (n == write_size_) {
-    (this->*set_cur_write_done)();
-    return true;
-  } else if (n >= 0) {
-    write_ptr_ += n;
-    write_size_ -= n;
-    return true;
-  } else {
-    CHECK_EQ(n, -1);
-    PCHECK(errno == EAGAIN || errno == EWOULDBLOCK);
-    return false;
-  }
-}
-
-void SocketWriteHelper::SetStatusWhenMsgHeadDone() {
+  iov_[0].iov_base = &cur_msg_;
+  iov_[0].iov_len = sizeof(cur_msg_);
+  iov_idx_ = 0;
+  iov_num_ = 1;
+  body_byte_size_ = 0;
   switch (cur_msg_.msg_type) {
 #define MAKE_ENTRY(x, y) \
-  case SocketMsgType::k##x: return SetStatusWhen##x##MsgHeadDone();
+  case SocketMsgType::k##x: InitIOVecOf##x##Msg(); break;
     OF_PP_FOR_EACH_TUPLE(MAKE_ENTRY, SOCKET_MSG_TYPE_SEQ);
 #undef MAKE_ENTRY
     default: UNIMPLEMENTED();
   }
+  cur_write_handle_ = &SocketWriteHelper::MsgWriteHandle;
+  return true;
 }
 
-void SocketWriteHelper::SetStatusWhenMsgBodyDone() {
-  cur_write_handle_ = &SocketWriteHelper::InitMsgWriteHandle;
+bool SocketWriteHelper::MsgWriteHandle() {
+  msghdr msg;
+  std::memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = iov_ + iov_idx_;
+  msg.msg_iovlen = iov_num_ - iov_idx_;
+  int flags = 0;
+#ifdef MSG_ZEROCOPY
+  if (zerocopy_enabled_ && body_byte_size_ >= kZeroCopyMinByteSize) {
+    if (iov_idx_ == 0) {
+      // the head lives in cur_msg_, which is reused before the zerocopy completion, so copy it
+      msg.msg_iovlen = 1;
+    } else {
+      flags |= MSG_ZEROCOPY;
+    }
+  }
+#endif
+  ssize_t n = sendmsg(sockfd_, &msg, flags);
+  if (n == -1) {
+    if (errno == EAGAIN || errno == EWOULDBLOCK) { return false; }
+    // the optmem limit of the pinned pages is exhausted, copy this chunk instead
+    PCHECK(flags != 0 && errno == ENOBUFS);
+    n = sendmsg(sockfd_, &msg, 0);
+    if (n == -1) {
+      PCHECK(errno == EAGAIN || errno == EWOULDBLOCK);
+      return false;
+    }
+  }
+  size_t written = static_cast<size_t>(n);
+  while (iov_idx_ < iov_num_ && written >= iov_[iov_idx_].iov_len) {
+    written -= iov_[iov_idx_].iov_len;
+    if (iov_idx_ == 1) { body_byte_size_ = 0; }
+    ++iov_idx_;
+  }
+  if (iov_idx_ == iov_num_) {
+    cur_write_handle_ = &SocketWriteHelper::InitMsgWriteHandle;
+  } else {
+    iov_[iov_idx_].iov_base = static_cast<char*>(iov_[iov_idx_].iov_base) + written;
+    iov_[iov_idx_].iov_len -= written;
+    if (iov_idx_ == 1) { body_byte_size_ = iov_[iov_idx_].iov_len; }
+  }
+  return true;
 }
 
-void SocketWriteHelper::SetStatusWhenRequestWriteMsgHeadDone() {
-  cur_write_handle_ = &SocketWriteHelper::InitMsgWriteHandle;
+void SocketWriteHelper::InitIOVecOfRequestWriteMsg() {
+  // head only
 }
 
-void SocketWriteHelper::SetStatusWhenRequestReadMsgHeadDone() {
-  const void* src_token = cur_msg_.request_read_msg.src_token;
-  auto src_mem_desc = static_cast<const SocketMemDesc*>(src_token);
-  write_ptr_ = reinterpret_cast<const char*>(src_mem_desc->mem_ptr);
-  write_size_ = src_mem_desc->byte_size;
-  cur_write_handle_ = &SocketWriteHelper::MsgBodyWriteHandle;
+void SocketWriteHelper::InitIOVecOfRequestReadMsg() {
+  const RequestReadMsg& request_read_msg = cur_msg_.request_read_msg;
+  auto src_mem_desc = static_cast<const SocketMemDesc*>(request_read_msg.src_token);
+  CHECK_GE(request_read_msg.offset, 0);
+  CHECK_LE(request_read_msg.offset + request_read_msg.byte_size,
+           static_cast<int64_t>(src_mem_desc->byte_size));
+  if (request_read_msg.byte_size == 0) { return; }
+  iov_[1].iov_base = static_cast<char*>(src_mem_desc->mem_ptr) + request_read_msg.offset;
+  iov_[1].iov_len = request_read_msg.byte_size;
+  iov_num_ = 2;
+  body_byte_size_ = request_read_msg.byte_size;
 }
 
-void SocketWriteHelper::SetStatusWhenActorMsgHeadDone() {
-  cur_write_handle_ = &SocketWriteHelper::InitMsgWriteHandle;
+void SocketWriteHelper::InitIOVecOfActorMsg() {
+  // head only
 }
 
-void SocketWriteHelper::SetStatusWhenTransportMsgHeadDone() {
-  cur_write_handle_ = &SocketWriteHelper::InitMsgWriteHandle;
+void SocketWriteHelper::InitIOVecOfTransportMsg() {
+  // head only
 }
 
 }  // namespace oneflow
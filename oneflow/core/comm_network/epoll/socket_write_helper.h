@@ -23,17 +23,22 @@ limitations under the License.
 
 namespace oneflow {
 
+// Writes the queued messages to a nonblocking socket from the poller thread. A message head and
+// its body are gathered into one sendmsg, which uses MSG_ZEROCOPY for large bodies when enabled.
 class SocketWriteHelper final {
  public:
   OF_DISALLOW_COPY_AND_MOVE(SocketWriteHelper);
   SocketWriteHelper() = delete;
   ~SocketWriteHelper();
 
-  SocketWriteHelper(int sockfd, IOEventPoller* poller);
+  SocketWriteHelper(int sockfd, IOEventPoller* poller, bool enable_zerocopy);
 
   void AsyncWrite(const SocketMsg& msg);
 
   void NotifyMeSocketWriteable();
+  void NotifyMeSocketError();
+
+  bool zerocopy_enabled() const { return zerocopy_enabled_; }
 
  private:
   void SendQueueNotEmptyEvent();
@@ -41,19 +46,15 @@ class SocketWriteHelper final {
 
   void WriteUntilMsgQueueEmptyOrSocketNotWriteable();
   bool InitMsgWriteHandle();
-  bool MsgHeadWriteHandle();
-  bool MsgBodyWriteHandle();
-
-  bool DoCurWrite(void (SocketWriteHelper::*set_cur_write_done)());
-  void SetStatusWhenMsgHeadDone();
-  void SetStatusWhenMsgBodyDone();
+  bool MsgWriteHandle();
 
-#define MAKE_ENTRY(x, y) void SetStatusWhen##x##MsgHeadDone();
+#define MAKE_ENTRY(x, y) void InitIOVecOf##x##Msg();
   OF_PP_FOR_EACH_TUPLE(MAKE_ENTRY, SOCKET_MSG_TYPE_SEQ);
 #undef MAKE_ENTRY
 
   int sockfd_;
   int queue_not_empty_fd_;
+  bool zerocopy_enabled_;
 
   std::queue<SocketMsg>* cur_msg_queue_;
 
@@ -62,8 +63,11 @@ class SocketWriteHelper final {
 
   SocketMsg cur_msg_;
   bool (SocketWriteHelper::*cur_write_handle_)();
-  const char* write_ptr_;
-  size_t write_size_;
+  // msg head and body
+  iovec iov_[2];
+  int iov_idx_;
+  int iov_num_;
+  size_t body_byte_size_;
 };
 
 }  // namespace oneflow
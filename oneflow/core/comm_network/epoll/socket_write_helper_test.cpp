@@ -0,0 +1,162 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifdef __linux__
+
+#include "oneflow/core/comm_network/epoll/socket_write_helper.h"
+#include "oneflow/core/comm_network/epoll/socket_memory_desc.h"
+
+namespace oneflow {
+
+namespace test {
+
+namespace {
+
+void CreateLoopbackConnection(int* client_sockfd, int* server_sockfd) {
+  int listen_sockfd = socket(AF_INET, SOCK_STREAM, 0);
+  PCHECK(listen_sockfd != -1);
+  sockaddr_in sa;
+  std::memset(&sa, 0, sizeof(sa));
+  sa.sin_family = AF_INET;
+  sa.sin_port = 0;
+  sa.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  PCHECK(bind(listen_sockfd, reinterpret_cast<sockaddr*>(&sa), sizeof(sa)) == 0);
+  PCHECK(listen(listen_sockfd, 1) == 0);
+  socklen_t len = sizeof(sa);
+  PCHECK(getsockname(listen_sockfd, reinterpret_cast<sockaddr*>(&sa), &len) == 0);
+  *client_sockfd = socket(AF_INET, SOCK_STREAM, 0);
+  PCHECK(*client_sockfd != -1);
+  PCHECK(connect(*client_sockfd, reinterpret_cast<sockaddr*>(&sa), sizeof(sa)) == 0);
+  *server_sockfd = accept(listen_sockfd, nullptr, nullptr);
+  PCHECK(*server_sockfd != -1);
+  PCHECK(close(listen_sockfd) == 0);
+}
+
+void ReadFully(int sockfd, void* ptr, size_t size) {
+  char* cur = static_cast<char*>(ptr);
+  while (size > 0) {
+    ssize_t n = read(sockfd, cur, size);
+    PCHECK(n > 0);
+    cur += n;
+    size -= n;
+  }
+}
+
+// Receives `part_num' RequestRead messages with their bodies, as SocketReadHelper does.
+void ReadParts(int sockfd, int64_t part_num) {
+  FOR_RANGE(int64_t, i, 0, part_num) {
+    SocketMsg msg;
+    ReadFully(sockfd, &msg, sizeof(msg));
+    CHECK(msg.msg_type == SocketMsgType::kRequestRead);
+    const auto* dst_mem_desc = static_cast<const SocketMemDesc*>(msg.request_read_msg.dst_token);
+    ReadFully(sockfd, static_cast<char*>(dst_mem_desc->mem_ptr) + msg.request_read_msg.offset,
+              msg.request_read_msg.byte_size);
+  }
+}
+
+// Transfers `src' into `dst' in parts of `part_byte_size' striped over `stripe_num' connections
+// and returns the bandwidth in GB/s.
+double StripedTransfer(int32_t stripe_num, bool enable_zerocopy, int64_t part_byte_size,
+                       std::vector<char>* src, std::vector<char>* dst) {
+  SocketMemDesc src_mem_desc{src->data(), src->size()};
+  SocketMemDesc dst_mem_desc{dst->data(), dst->size()};
+  std::vector<int> server_sockfds(stripe_num);
+  std::vector<std::unique_ptr<IOEventPoller>> pollers;
+  std::vector<std::unique_ptr<SocketWriteHelper>> write_helpers;
+  FOR_RANGE(int32_t, stripe_id, 0, stripe_num) {
+    int client_sockfd = -1;
+    CreateLoopbackConnection(&client_sockfd, &server_sockfds.at(stripe_id));
+    pollers.emplace_back(new IOEventPoller());
+    write_helpers.emplace_back(
+        new SocketWriteHelper(client_sockfd, pollers.back().get(), enable_zerocopy));
+    SocketWriteHelper* write_helper = write_helpers.back().get();
+    if (write_helper->zerocopy_enabled()) {
+      pollers.back()->AddFd(
+          client_sockfd, []() {}, [write_helper]() { write_helper->NotifyMeSocketWriteable(); },
+          [write_helper]() { write_helper->NotifyMeSocketError(); });
+    } else {
+      pollers.back()->AddFd(
+          client_sockfd, []() {}, [write_helper]() { write_helper->NotifyMeSocketWriteable(); });
+    }
+    pollers.back()->Start();
+  }
+  const int64_t byte_size = src->size();
+  const int64_t part_num = (byte_size + part_byte_size - 1) / part_byte_size;
+  std::vector<std::thread> readers;
+  FOR_RANGE(int32_t, stripe_id, 0, stripe_num) {
+    const int64_t stripe_part_num = (part_num - stripe_id + stripe_num - 1) / stripe_num;
+    readers.emplace_back(ReadParts, server_sockfds.at(stripe_id), stripe_part_num);
+  }
+  const auto start = std::chrono::steady_clock::now();
+  FOR_RANGE(int64_t, part_id, 0, part_num) {
+    SocketMsg msg;
+    msg.msg_type = SocketMsgType::kRequestRead;
+    msg.request_read_msg.src_token = &src_mem_desc;
+    msg.request_read_msg.dst_token = &dst_mem_desc;
+    msg.request_read_msg.read_ctx = nullptr;
+    msg.request_read_msg.offset = part_id * part_byte_size;
+    msg.request_read_msg.byte_size = std::min(part_byte_size, byte_size - part_id * part_byte_size);
+    write_helpers.at(part_id % stripe_num)->AsyncWrite(msg);
+  }
+  for (std::thread& reader : readers) { reader.join(); }
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  for (auto& poller : pollers) { poller->Stop(); }
+  write_helpers.clear();
+  pollers.clear();
+  for (int sockfd : server_sockfds) { PCHECK(close(sockfd) == 0); }
+  return byte_size / elapsed.count() / 1e9;
+}
+
+void FillRandom(std::vector<char>* buffer) {
+  std::mt19937 gen(0);
+  std::uniform_int_distribution<int> dis(0, 255);
+  for (char& c : *buffer) { c = static_cast<char>(dis(gen)); }
+}
+
+}  // namespace
+
+TEST(SocketWriteHelper, striped_transfer) {
+  std::vector<char> src(3 * 1024 * 1024 + 123);
+  FillRandom(&src);
+  for (bool enable_zerocopy : {false, true}) {
+    for (int32_t stripe_num : {1, 3}) {
+      std::vector<char> dst(src.size(), 0);
+      StripedTransfer(stripe_num, enable_zerocopy, 256 * 1024 + 7, &src, &dst);
+      ASSERT_TRUE(src == dst);
+    }
+  }
+}
+
+TEST(SocketWriteHelper, striped_bandwidth_benchmark) {
+  std::vector<char> src(256 * 1024 * 1024);
+  FillRandom(&src);
+  std::vector<char> dst(src.size(), 0);
+  for (bool enable_zerocopy : {false, true}) {
+    for (int32_t stripe_num : {1, 2, 4, 8}) {
+      const double bandwidth =
+          StripedTransfer(stripe_num, enable_zerocopy, 1024 * 1024, &src, &dst);
+      LOG(INFO) << "loopback, stripe_num: " << stripe_num
+                << ", zerocopy: " << std::boolalpha << enable_zerocopy
+                << ", bandwidth: " << bandwidth << " GB/s";
+    }
+  }
+  ASSERT_TRUE(src == dst);
+}
+
+}  // namespace test
+
+}  // namespace oneflow
+
+#endif  // __linux__
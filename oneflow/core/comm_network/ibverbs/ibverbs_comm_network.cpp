@@ -20,6 +20,9 @@ limitations under the License.
 #include "oneflow/core/job/global_for.h"
 #include "oneflow/core/platform/include/ibv.h"
 #include "oneflow/core/actor/actor_message_bus.h"
+#include "oneflow/core/thread/thread_affinity.h"
+
+#include <unistd.h>
 
 #if defined(WITH_RDMA) && defined(OF_PLATFORM_POSIX)
 
@@ -27,6 +30,8 @@ namespace oneflow {
 
 namespace {
 
+constexpr uint32_t kDefaultSrqDepth = 8192;
+
 std::string GenTokensMsgKey(int64_t machine_id) {
   return "IBVerbsTokensMsg/" + std::to_string(machine_id);
 }
@@ -43,6 +48,12 @@ void IBVForkInit() {
   }
 }
 
+bool IsPeerMemoryClientLoaded() {
+  // nv_peer_mem exposes itself under memory_peers, nvidia_peermem is a plain kernel module
+  return access("/sys/kernel/mm/memory_peers/nv_mem/version", F_OK) == 0
+         || access("/sys/module/nvidia_peermem", F_OK) == 0;
+}
+
 void ParseUserDevicePort(std::string* device_name, int* port) {
   std::string user_device_port = GetStringFromEnv("ONEFLOW_COMM_NET_IB_HCA", "");
   if (user_device_port.empty()) {
@@ -71,6 +82,10 @@ IBVerbsCommNet::~IBVerbsCommNet() {
   for (IBVerbsQP* qp : qp_vec_) {
     if (qp) { delete qp; }
   }
+  if (srq_ != nullptr) {
+    srq_recv_queue_.reset();
+    CHECK_EQ(ibv::wrapper.ibv_destroy_srq(srq_), 0);
+  }
   CHECK_EQ(ibv::wrapper.ibv_destroy_cq(cq_), 0);
   CHECK_EQ(ibv::wrapper.ibv_dealloc_pd(pd_), 0);
   CHECK_EQ(ibv::wrapper.ibv_close_device(context_), 0);
@@ -135,6 +150,30 @@ IBVerbsCommNet::IBVerbsCommNet() : CommNetIf(), poll_exit_flag_(ATOMIC_FLAG_INIT
   CHECK_EQ(ibv::wrapper.ibv_query_device(context_, &device_attr), 0);
   cq_ = ibv::wrapper.ibv_create_cq(context_, device_attr.max_cqe, nullptr, nullptr, 0);
   CHECK(cq_);
+  srq_ = nullptr;
+  if (device_attr.max_srq > 0 && ParseBooleanFromEnv("ONEFLOW_COMM_NET_IB_ENABLE_SRQ", true)) {
+    const int64_t user_srq_depth =
+        ParseIntegerFromEnv("ONEFLOW_COMM_NET_IB_SRQ_DEPTH", kDefaultSrqDepth);
+    const uint32_t srq_depth = std::min<uint32_t>(device_attr.max_srq_wr, user_srq_depth);
+    ibv_srq_init_attr srq_init_attr{};
+    srq_init_attr.srq_context = nullptr;
+    srq_init_attr.attr.max_wr = srq_depth;
+    srq_init_attr.attr.max_sge = 1;
+    srq_ = ibv::wrapper.ibv_create_srq(pd_, &srq_init_attr);
+    CHECK(srq_);
+    srq_recv_queue_.reset(new ActorMsgRecvQueue(pd_, srq_, nullptr, srq_depth));
+    LOG(INFO) << "Using a shared receive queue of depth " << srq_depth;
+  }
+  gpu_direct_enabled_ = false;
+  if (ParseBooleanFromEnv("ONEFLOW_COMM_NET_IB_ENABLE_GPU_DIRECT", false)) {
+    if (IsPeerMemoryClientLoaded()) {
+      gpu_direct_enabled_ = true;
+      LOG(INFO) << "Using GPUDirect RDMA for device-resident registers";
+    } else {
+      LOG(WARNING) << "GPUDirect RDMA requested but no peer memory client is loaded, "
+                      "device-resident registers will be staged through host memory";
+    }
+  }
   ibv_port_attr port_attr{};
   const uint8_t port = user_port == 0 ? 1 : user_port;
   CHECK_EQ(ibv::wrapper.ibv_query_port_wrap(context_, port, &port_attr), 0);
@@ -146,7 +185,7 @@ IBVerbsCommNet::IBVerbsCommNet() : CommNetIf(), poll_exit_flag_(ATOMIC_FLAG_INIT
   int64_t this_machine_id = GlobalProcessCtx::Rank();
   qp_vec_.assign(Global<ResourceDesc, ForEnv>::Get()->process_ranks().size(), nullptr);
   for (int64_t peer_id : peer_machine_id()) {
-    IBVerbsQP* cur_qp = new IBVerbsQP(context_, pd_, port, cq_, cq_);
+    IBVerbsQP* cur_qp = new IBVerbsQP(context_, pd_, port, cq_, cq_, srq_);
     qp_vec_.at(peer_id) = cur_qp;
     IBVerbsConnectionInfo conn_info;
     conn_info.set_lid(port_attr.lid);
@@ -155,6 +194,7 @@ IBVerbsCommNet::IBVerbsCommNet() : CommNetIf(), poll_exit_flag_(ATOMIC_FLAG_INIT
     conn_info.set_interface_id(gid.global.interface_id);
     conn_info.set_port_num(port);
     conn_info.set_mtu(static_cast<int>(port_attr.active_mtu));
+    conn_info.set_gpu_direct_enabled(gpu_direct_enabled_);
     Global<CtrlClient>::Get()->PushKV(GenConnInfoKey(this_machine_id, peer_id), conn_info);
   }
   for (int64_t peer_id : peer_machine_id()) {
@@ -172,8 +212,14 @@ IBVerbsCommNet::IBVerbsCommNet() : CommNetIf(), poll_exit_flag_(ATOMIC_FLAG_INIT
     }
     qp_vec_.at(peer_id)->Connect(conn_info);
     LOG(INFO) << "Connected to peer " << peer_id;
+    // the plan may only skip the host bounce if every peer can register device memory
+    if (gpu_direct_enabled_ && !conn_info.gpu_direct_enabled()) {
+      LOG(WARNING) << "GPUDirect RDMA disabled since peer " << peer_id << " does not support it";
+      gpu_direct_enabled_ = false;
+    }
   }
   OF_ENV_BARRIER();
+  if (srq_recv_queue_) { srq_recv_queue_->PostAllRecvRequest(); }
   for (int64_t peer_id : peer_machine_id()) {
     qp_vec_.at(peer_id)->PostAllRecvRequest();
     Global<CtrlClient>::Get()->ClearKV(GenConnInfoKey(this_machine_id, peer_id));
@@ -185,12 +231,14 @@ IBVerbsCommNet::IBVerbsCommNet() : CommNetIf(), poll_exit_flag_(ATOMIC_FLAG_INIT
 
 void IBVerbsCommNet::DoRead(void* read_id, int64_t src_machine_id, void* src_token,
                             void* dst_token) {
+  CountReadBytes(src_machine_id, static_cast<const IBVerbsMemDesc*>(dst_token)->mem_size());
   qp_vec_.at(src_machine_id)
       ->PostReadRequest(*reinterpret_cast<IBVerbsCommNetRMADesc*>(src_token),
                         *static_cast<const IBVerbsMemDesc*>(dst_token), read_id);
 }
 
 void IBVerbsCommNet::PollCQ() {
+  BindCurrentThreadToRoleCores(ThreadRole::kComm);
   std::vector<ibv_wc> wc_vec(max_poll_wc_num_);
   while (poll_exit_flag_.test_and_set() == false) {
     poll_exit_flag_.clear();
@@ -200,18 +248,17 @@ void IBVerbsCommNet::PollCQ() {
       const ibv_wc& wc = wc_vec.at(i);
       CHECK_EQ(wc.status, IBV_WC_SUCCESS) << wc.opcode;
       WorkRequestId* wr_id = reinterpret_cast<WorkRequestId*>(wc.wr_id);
-      IBVerbsQP* qp = wr_id->qp;
       switch (wc.opcode) {
         case IBV_WC_RDMA_READ: {
-          qp->ReadDone(wr_id);
+          wr_id->qp->ReadDone(wr_id);
           break;
         }
         case IBV_WC_SEND: {
-          qp->SendDone(wr_id);
+          wr_id->qp->SendDone(wr_id);
           break;
         }
         case IBV_WC_RECV: {
-          qp->RecvDone(wr_id);
+          wr_id->recv_queue->RecvDone(wr_id);
           break;
         }
         default: UNIMPLEMENTED();
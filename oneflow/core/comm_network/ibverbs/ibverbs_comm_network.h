@@ -41,6 +41,7 @@ class IBVerbsCommNet final : public CommNetIf<IBVerbsMemDesc> {
 
   void SendActorMsg(int64_t dst_machine_id, const ActorMsg& msg) override;
   void RecvActorMsg(const ActorMsg& msg);
+  bool IsDeviceMemorySupported() const override { return gpu_direct_enabled_; }
 
  private:
   friend class Global<IBVerbsCommNet>;
@@ -58,6 +59,11 @@ class IBVerbsCommNet final : public CommNetIf<IBVerbsMemDesc> {
   ibv_context* context_;
   ibv_pd* pd_;
   ibv_cq* cq_;
+  // shared by all the QPs, nullptr if the device does not support it or it is disabled
+  ibv_srq* srq_;
+  std::unique_ptr<ActorMsgRecvQueue> srq_recv_queue_;
+  // device memory can be registered through a peer memory client (nv_peer_mem/nvidia_peermem)
+  bool gpu_direct_enabled_;
   std::vector<IBVerbsQP*> qp_vec_;
   std::atomic_flag poll_exit_flag_;
   std::thread poll_thread_;
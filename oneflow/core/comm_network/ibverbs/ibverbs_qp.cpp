@@ -29,11 +29,60 @@ namespace {
 
 constexpr uint32_t kDefaultQueueDepth = 1024;
 constexpr uint64_t kDefaultMemBlockSize = 8388608;  // 8M
+constexpr uint32_t kDefaultSendSignalInterval = 16;
 
 }  // namespace
 
+ActorMsgRecvQueue::ActorMsgRecvQueue(ibv_pd* pd, ibv_srq* srq, ibv_qp* qp, size_t msg_num)
+    : srq_(srq), qp_(qp), msgs_(msg_num), wr_ids_(msg_num) {
+  CHECK((srq_ == nullptr) != (qp_ == nullptr));
+  mem_desc_.reset(new IBVerbsMemDesc(pd, msgs_.data(), msgs_.size() * sizeof(ActorMsg)));
+  FOR_RANGE(size_t, i, 0, msg_num) {
+    WorkRequestId* wr_id = &wr_ids_.at(i);
+    wr_id->qp = nullptr;
+    wr_id->outstanding_sge_cnt = 0;
+    wr_id->read_id = nullptr;
+    wr_id->msg_mr = nullptr;
+    wr_id->unsignaled_send_wr_cnt = 0;
+    wr_id->recv_queue = this;
+    wr_id->recv_msg = &msgs_.at(i);
+  }
+}
+
+ActorMsgRecvQueue::~ActorMsgRecvQueue() { mem_desc_.reset(); }
+
+void ActorMsgRecvQueue::PostAllRecvRequest() {
+  for (WorkRequestId& wr_id : wr_ids_) { PostRecvRequest(&wr_id); }
+}
+
+void ActorMsgRecvQueue::RecvDone(WorkRequestId* wr_id) {
+  CHECK_EQ(wr_id->recv_queue, this);
+  auto* ibv_comm_net = dynamic_cast<IBVerbsCommNet*>(Global<CommNet>::Get());
+  CHECK(ibv_comm_net != nullptr);
+  ibv_comm_net->RecvActorMsg(*wr_id->recv_msg);
+  PostRecvRequest(wr_id);
+}
+
+void ActorMsgRecvQueue::PostRecvRequest(WorkRequestId* wr_id) {
+  ibv_recv_wr wr{};
+  ibv_sge sge{};
+  sge.addr = reinterpret_cast<uint64_t>(wr_id->recv_msg);
+  sge.length = sizeof(ActorMsg);
+  sge.lkey = mem_desc_->mr()->lkey;
+  wr.wr_id = reinterpret_cast<uint64_t>(wr_id);
+  wr.next = nullptr;
+  wr.sg_list = &sge;
+  wr.num_sge = 1;
+  ibv_recv_wr* bad_wr = nullptr;
+  if (srq_ != nullptr) {
+    CHECK_EQ(ibv_post_srq_recv(srq_, &wr, &bad_wr), 0);
+  } else {
+    CHECK_EQ(ibv_post_recv(qp_, &wr, &bad_wr), 0);
+  }
+}
+
 IBVerbsQP::IBVerbsQP(ibv_context* ctx, ibv_pd* pd, uint8_t port_num, ibv_cq* send_cq,
-                     ibv_cq* recv_cq) {
+                     ibv_cq* recv_cq, ibv_srq* srq) {
   // ctx_, pd_
   ctx_ = ctx;
   pd_ = pd;
@@ -48,23 +97,38 @@ IBVerbsQP::IBVerbsQP(ibv_context* ctx, ibv_pd* pd, uint8_t port_num, ibv_cq* sen
   qp_init_attr.qp_context = nullptr;
   qp_init_attr.send_cq = send_cq;
   qp_init_attr.recv_cq = recv_cq;
-  qp_init_attr.srq = nullptr;
+  qp_init_attr.srq = srq;
   qp_init_attr.cap.max_send_wr = queue_depth;
-  qp_init_attr.cap.max_recv_wr = queue_depth;
+  qp_init_attr.cap.max_recv_wr = srq == nullptr ? queue_depth : 0;
   qp_init_attr.cap.max_send_sge = 1;
-  qp_init_attr.cap.max_recv_sge = 1;
-  qp_init_attr.cap.max_inline_data = 0;
+  qp_init_attr.cap.max_recv_sge = srq == nullptr ? 1 : 0;
+  qp_init_attr.cap.max_inline_data =
+      ParseBooleanFromEnv("ONEFLOW_COMM_NET_IB_ENABLE_INLINE", true) ? sizeof(ActorMsg) : 0;
   qp_init_attr.qp_type = IBV_QPT_RC;
-  qp_init_attr.sq_sig_all = 1;
+  // completions of sends are requested by IBV_SEND_SIGNALED
+  qp_init_attr.sq_sig_all = 0;
   qp_ = ibv::wrapper.ibv_create_qp(pd, &qp_init_attr);
+  if (qp_ == nullptr && qp_init_attr.cap.max_inline_data > 0) {
+    LOG(WARNING) << "Failed to create a QP with " << qp_init_attr.cap.max_inline_data
+                 << " bytes of inline data, fall back to no inline data";
+    qp_init_attr.cap.max_inline_data = 0;
+    qp_ = ibv::wrapper.ibv_create_qp(pd, &qp_init_attr);
+  }
   CHECK(qp_);
-  // recv_msg_buf_
-  recv_msg_buf_.assign(queue_depth, nullptr);
-  FOR_RANGE(size_t, i, 0, recv_msg_buf_.size()) { recv_msg_buf_.at(i) = new ActorMsgMR(pd_); }
+  // ibv_create_qp returns the actual capabilities in qp_init_attr.cap
+  max_inline_data_ = qp_init_attr.cap.max_inline_data;
+  // recv_queue_
+  if (srq == nullptr) { recv_queue_.reset(new ActorMsgRecvQueue(pd_, nullptr, qp_, queue_depth)); }
   // send_msg_buf_
   CHECK(send_msg_buf_.empty());
   num_outstanding_send_wr_ = 0;
   max_outstanding_send_wr_ = queue_depth;
+  // at least one signaled wr has to be outstanding when the send queue is full
+  const int64_t user_send_signal_interval =
+      ParseIntegerFromEnv("ONEFLOW_COMM_NET_IB_SEND_SIGNAL_INTERVAL", kDefaultSendSignalInterval);
+  send_signal_interval_ = std::max<uint32_t>(
+      std::min<uint32_t>(user_send_signal_interval, max_outstanding_send_wr_ / 2), 1);
+  unclaimed_unsignaled_send_wr_cnt_ = 0;
 }
 
 IBVerbsQP::~IBVerbsQP() {
@@ -73,7 +137,8 @@ IBVerbsQP::~IBVerbsQP() {
     delete send_msg_buf_.front();
     send_msg_buf_.pop();
   }
-  for (ActorMsgMR* msg_mr : recv_msg_buf_) { delete msg_mr; }
+  for (ActorMsgMR* msg_mr : unsignaled_send_msg_mrs_) { delete msg_mr; }
+  recv_queue_.reset();
 }
 
 void IBVerbsQP::Connect(const IBVerbsConnectionInfo& peer_info) {
@@ -139,7 +204,7 @@ void IBVerbsQP::Connect(const IBVerbsConnectionInfo& peer_info) {
 }
 
 void IBVerbsQP::PostAllRecvRequest() {
-  for (ActorMsgMR* msg_mr : recv_msg_buf_) { PostRecvRequest(msg_mr); }
+  if (recv_queue_) { recv_queue_->PostAllRecvRequest(); }
 }
 
 void IBVerbsQP::PostReadRequest(const IBVerbsCommNetRMADesc& remote_mem,
@@ -195,8 +260,8 @@ void IBVerbsQP::EnqueuePostSendReadWR(ibv_send_wr wr, ibv_sge sge) {
   std::unique_lock<std::mutex> pending_send_wr_lock_(pending_send_wr_mutex_);
   if (num_outstanding_send_wr_ < max_outstanding_send_wr_) {
     num_outstanding_send_wr_++;
-    ibv_send_wr* bad_wr = nullptr;
-    CHECK_EQ(ibv_post_send(qp_, &wr, &bad_wr), 0);
+    std::vector<std::pair<ibv_send_wr, ibv_sge>> wr_sge_list{std::make_pair(wr, sge)};
+    PostSendWRList(&wr_sge_list);
   } else {
     std::pair<ibv_send_wr, ibv_sge> ibv_send_wr_sge = std::make_pair(wr, sge);
     pending_send_wr_queue_.push(ibv_send_wr_sge);
@@ -210,54 +275,78 @@ void IBVerbsQP::ReadDone(WorkRequestId* wr_id) {
     Global<CommNet>::Get()->ReadDone(wr_id->read_id);
     DeleteWorkRequestId(wr_id);
   }
-  PostPendingSendWR();
+  PostPendingSendWR(1);
 }
 
 void IBVerbsQP::SendDone(WorkRequestId* wr_id) {
+  const int32_t unsignaled_send_wr_cnt = wr_id->unsignaled_send_wr_cnt;
+  std::vector<ActorMsgMR*> done_msg_mrs;
   {
-    std::unique_lock<std::mutex> lck(send_msg_buf_mtx_);
-    send_msg_buf_.push(wr_id->msg_mr);
+    std::unique_lock<std::mutex> pending_send_wr_lock_(pending_send_wr_mutex_);
+    CHECK_GE(unsignaled_send_msg_mrs_.size(), static_cast<size_t>(unsignaled_send_wr_cnt));
+    FOR_RANGE(int32_t, i, 0, unsignaled_send_wr_cnt) {
+      done_msg_mrs.push_back(unsignaled_send_msg_mrs_.front());
+      unsignaled_send_msg_mrs_.pop_front();
+    }
+  }
+  done_msg_mrs.push_back(wr_id->msg_mr);
+  for (ActorMsgMR* msg_mr : done_msg_mrs) {
+    if (msg_mr != nullptr) { PutSendMsgMRToBuf(msg_mr); }
   }
   DeleteWorkRequestId(wr_id);
-  PostPendingSendWR();
-}
-
-void IBVerbsQP::RecvDone(WorkRequestId* wr_id) {
-  auto* ibv_comm_net = dynamic_cast<IBVerbsCommNet*>(Global<CommNet>::Get());
-  CHECK(ibv_comm_net != nullptr);
-  ibv_comm_net->RecvActorMsg(wr_id->msg_mr->msg());
-  PostRecvRequest(wr_id->msg_mr);
-  DeleteWorkRequestId(wr_id);
+  PostPendingSendWR(unsignaled_send_wr_cnt + 1);
 }
 
-void IBVerbsQP::PostPendingSendWR() {
+void IBVerbsQP::PostPendingSendWR(uint32_t done_wr_cnt) {
   std::unique_lock<std::mutex> pending_send_wr_lock_(pending_send_wr_mutex_);
-  if (pending_send_wr_queue_.empty() == false) {
-    std::pair<ibv_send_wr, ibv_sge> ibv_send_wr_sge = std::move(pending_send_wr_queue_.front());
-    ibv_send_wr wr = ibv_send_wr_sge.first;
-    wr.sg_list = &ibv_send_wr_sge.second;
+  CHECK_GE(num_outstanding_send_wr_, done_wr_cnt);
+  num_outstanding_send_wr_ -= done_wr_cnt;
+  // repost as many pending wrs as the completions allow with one ibv_post_send
+  std::vector<std::pair<ibv_send_wr, ibv_sge>> wr_sge_list;
+  while (!pending_send_wr_queue_.empty() && num_outstanding_send_wr_ < max_outstanding_send_wr_) {
+    wr_sge_list.push_back(pending_send_wr_queue_.front());
     pending_send_wr_queue_.pop();
-    ibv_send_wr* bad_wr = nullptr;
-    CHECK_EQ(ibv_post_send(qp_, &wr, &bad_wr), 0);
-  } else {
-    if (num_outstanding_send_wr_ > 0) { num_outstanding_send_wr_--; }
+    num_outstanding_send_wr_++;
   }
+  if (!wr_sge_list.empty()) { PostSendWRList(&wr_sge_list); }
 }
 
-void IBVerbsQP::PostRecvRequest(ActorMsgMR* msg_mr) {
-  WorkRequestId* wr_id = NewWorkRequestId();
-  wr_id->msg_mr = msg_mr;
-  ibv_recv_wr wr{};
-  ibv_sge sge{};
-  sge.addr = reinterpret_cast<uint64_t>(msg_mr->mem_desc().mem_ptr());
-  sge.length = msg_mr->mem_desc().mem_size();
-  sge.lkey = msg_mr->mem_desc().mr()->lkey;
-  wr.wr_id = reinterpret_cast<uint64_t>(wr_id);
-  wr.next = nullptr;
-  wr.sg_list = &sge;
-  wr.num_sge = 1;
-  ibv_recv_wr* bad_wr = nullptr;
-  CHECK_EQ(ibv_post_recv(qp_, &wr, &bad_wr), 0);
+void IBVerbsQP::PostSendWRList(std::vector<std::pair<ibv_send_wr, ibv_sge>>* wr_sge_list) {
+  // called with pending_send_wr_mutex_ held, in post order
+  for (size_t i = 0; i < wr_sge_list->size(); ++i) {
+    ibv_send_wr* wr = &wr_sge_list->at(i).first;
+    wr->sg_list = &wr_sge_list->at(i).second;
+    wr->next = i + 1 < wr_sge_list->size() ? &wr_sge_list->at(i + 1).first : nullptr;
+    if (wr->opcode != IBV_WR_SEND) {
+      wr->send_flags |= IBV_SEND_SIGNALED;
+      continue;
+    }
+    if (wr->sg_list->length <= max_inline_data_) { wr->send_flags |= IBV_SEND_INLINE; }
+    unclaimed_unsignaled_send_wr_cnt_ += 1;
+    if (unclaimed_unsignaled_send_wr_cnt_ >= send_signal_interval_) {
+      wr->send_flags |= IBV_SEND_SIGNALED;
+      reinterpret_cast<WorkRequestId*>(wr->wr_id)->unsignaled_send_wr_cnt =
+          unclaimed_unsignaled_send_wr_cnt_ - 1;
+      unclaimed_unsignaled_send_wr_cnt_ = 0;
+    }
+  }
+  ibv_send_wr* bad_wr = nullptr;
+  CHECK_EQ(ibv_post_send(qp_, &wr_sge_list->front().first, &bad_wr), 0);
+  for (auto& wr_sge : *wr_sge_list) {
+    const ibv_send_wr& wr = wr_sge.first;
+    if (wr.opcode != IBV_WR_SEND) { continue; }
+    auto* wr_id = reinterpret_cast<WorkRequestId*>(wr.wr_id);
+    if (wr.send_flags & IBV_SEND_INLINE) {
+      // the msg has been copied into the wr
+      PutSendMsgMRToBuf(wr_id->msg_mr);
+      wr_id->msg_mr = nullptr;
+    }
+    if (!(wr.send_flags & IBV_SEND_SIGNALED)) {
+      // no completion will refer to this wr, it is done along with the next signaled send
+      unsignaled_send_msg_mrs_.push_back(wr_id->msg_mr);
+      DeleteWorkRequestId(wr_id);
+    }
+  }
 }
 
 ActorMsgMR* IBVerbsQP::GetOneSendMsgMRFromBuf() {
@@ -268,12 +357,20 @@ ActorMsgMR* IBVerbsQP::GetOneSendMsgMRFromBuf() {
   return msg_mr;
 }
 
+void IBVerbsQP::PutSendMsgMRToBuf(ActorMsgMR* msg_mr) {
+  std::unique_lock<std::mutex> lck(send_msg_buf_mtx_);
+  send_msg_buf_.push(msg_mr);
+}
+
 WorkRequestId* IBVerbsQP::NewWorkRequestId() {
   WorkRequestId* wr_id = new WorkRequestId;
   wr_id->qp = this;
   wr_id->outstanding_sge_cnt = 0;
   wr_id->read_id = nullptr;
   wr_id->msg_mr = nullptr;
+  wr_id->unsignaled_send_wr_cnt = 0;
+  wr_id->recv_queue = nullptr;
+  wr_id->recv_msg = nullptr;
   return wr_id;
 }
 
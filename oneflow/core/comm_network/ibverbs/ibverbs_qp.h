@@ -40,12 +40,40 @@ class ActorMsgMR final {
 };
 
 class IBVerbsQP;
+class ActorMsgRecvQueue;
 
 struct WorkRequestId {
   IBVerbsQP* qp;
   int32_t outstanding_sge_cnt;
   void* read_id;
   ActorMsgMR* msg_mr;
+  // the unsignaled send wrs posted before this signaled one, which complete along with it
+  int32_t unsignaled_send_wr_cnt;
+  ActorMsgRecvQueue* recv_queue;
+  ActorMsg* recv_msg;
+};
+
+// Receive buffers of actor msgs registered as one memory region. They are posted either to a
+// shared receive queue used by all the QPs, or to the receive queue of a single QP when `srq' is
+// nullptr.
+class ActorMsgRecvQueue final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(ActorMsgRecvQueue);
+  ActorMsgRecvQueue() = delete;
+  ActorMsgRecvQueue(ibv_pd* pd, ibv_srq* srq, ibv_qp* qp, size_t msg_num);
+  ~ActorMsgRecvQueue();
+
+  void PostAllRecvRequest();
+  void RecvDone(WorkRequestId*);
+
+ private:
+  void PostRecvRequest(WorkRequestId*);
+
+  ibv_srq* srq_;
+  ibv_qp* qp_;
+  std::vector<ActorMsg> msgs_;
+  std::vector<WorkRequestId> wr_ids_;
+  std::unique_ptr<IBVerbsMemDesc> mem_desc_;
 };
 
 struct IBVerbsCommNetRMADesc;
@@ -54,7 +82,9 @@ class IBVerbsQP final {
  public:
   OF_DISALLOW_COPY_AND_MOVE(IBVerbsQP);
   IBVerbsQP() = delete;
-  IBVerbsQP(ibv_context*, ibv_pd*, uint8_t port_num, ibv_cq* send_cq, ibv_cq* recv_cq);
+  // receives from `srq' if it is not nullptr, otherwise from buffers owned by this QP
+  IBVerbsQP(ibv_context*, ibv_pd*, uint8_t port_num, ibv_cq* send_cq, ibv_cq* recv_cq,
+            ibv_srq* srq);
   ~IBVerbsQP();
 
   uint32_t qp_num() const { return qp_->qp_num; }
@@ -67,21 +97,21 @@ class IBVerbsQP final {
 
   void ReadDone(WorkRequestId*);
   void SendDone(WorkRequestId*);
-  void RecvDone(WorkRequestId*);
 
  private:
   void EnqueuePostSendReadWR(ibv_send_wr wr, ibv_sge sge);
-  void PostPendingSendWR();
+  void PostPendingSendWR(uint32_t done_wr_cnt);
+  void PostSendWRList(std::vector<std::pair<ibv_send_wr, ibv_sge>>* wr_sge_list);
   WorkRequestId* NewWorkRequestId();
   void DeleteWorkRequestId(WorkRequestId* wr_id);
   ActorMsgMR* GetOneSendMsgMRFromBuf();
-  void PostRecvRequest(ActorMsgMR*);
+  void PutSendMsgMRToBuf(ActorMsgMR* msg_mr);
 
   ibv_context* ctx_;
   ibv_pd* pd_;
   uint8_t port_num_;
   ibv_qp* qp_;
-  std::vector<ActorMsgMR*> recv_msg_buf_;
+  std::unique_ptr<ActorMsgRecvQueue> recv_queue_;
 
   std::mutex send_msg_buf_mtx_;
   std::queue<ActorMsgMR*> send_msg_buf_;
@@ -89,6 +119,13 @@ class IBVerbsQP final {
   uint32_t num_outstanding_send_wr_;
   uint32_t max_outstanding_send_wr_;
   std::queue<std::pair<ibv_send_wr, ibv_sge>> pending_send_wr_queue_;
+  // Sends of at most `max_inline_data_' bytes are copied into the wr, and only every
+  // `send_signal_interval_'-th send generates a completion.
+  uint32_t max_inline_data_;
+  uint32_t send_signal_interval_;
+  uint32_t unclaimed_unsignaled_send_wr_cnt_;
+  // the msg buffers of posted unsignaled sends in post order, nullptr for inline sends
+  std::deque<ActorMsgMR*> unsignaled_send_msg_mrs_;
 };
 
 }  // namespace oneflow
@@ -0,0 +1,54 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_COMMON_BFLOAT16_H_
+#define ONEFLOW_CORE_COMMON_BFLOAT16_H_
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+namespace oneflow {
+
+// Host side bfloat16: the upper 16 bits of an IEEE float, converted with round to nearest even
+struct alignas(2) bfloat16 {
+  uint16_t x;
+
+  bfloat16() = default;
+  explicit bfloat16(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    if ((bits & 0x7fffffff) > 0x7f800000) {
+      // keep NaN a quiet NaN
+      x = static_cast<uint16_t>((bits >> 16) | 0x0040);
+    } else {
+      const uint32_t rounding_bias = 0x7fff + ((bits >> 16) & 1);
+      x = static_cast<uint16_t>((bits + rounding_bias) >> 16);
+    }
+  }
+
+  operator float() const {
+    const uint32_t bits = static_cast<uint32_t>(x) << 16;
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
+};
+
+static_assert(sizeof(bfloat16) == 2, "sizeof(bfloat16) != 2");
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_COMMON_BFLOAT16_H_
@@ -0,0 +1,81 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <benchmark/benchmark.h>
+#include <thread>
+#include "oneflow/core/common/buffer.h"
+#include "oneflow/core/common/channel.h"
+
+namespace oneflow {
+
+namespace {
+
+void BM_ChannelSendReceive(benchmark::State& state) {
+  const int64_t num_items = state.range(0);
+  for (auto _ : state) {
+    Channel<int64_t> channel;
+    std::thread producer([&]() {
+      for (int64_t i = 0; i < num_items; ++i) { channel.Send(i); }
+      channel.Close();
+    });
+    int64_t item = 0;
+    while (channel.Receive(&item) == kChannelStatusSuccess) { benchmark::DoNotOptimize(item); }
+    producer.join();
+  }
+  state.SetItemsProcessed(state.iterations() * num_items);
+}
+BENCHMARK(BM_ChannelSendReceive)->Arg(1 << 16)->UseRealTime();
+
+void BM_ChannelReceiveMany(benchmark::State& state) {
+  const int64_t num_items = state.range(0);
+  for (auto _ : state) {
+    Channel<int64_t> channel;
+    std::thread producer([&]() {
+      for (int64_t i = 0; i < num_items; ++i) { channel.Send(i); }
+      channel.Close();
+    });
+    std::queue<int64_t> items;
+    while (channel.ReceiveMany(&items) == kChannelStatusSuccess) {
+      while (!items.empty()) {
+        benchmark::DoNotOptimize(items.front());
+        items.pop();
+      }
+    }
+    producer.join();
+  }
+  state.SetItemsProcessed(state.iterations() * num_items);
+}
+BENCHMARK(BM_ChannelReceiveMany)->Arg(1 << 16)->UseRealTime();
+
+void BM_BufferSendReceive(benchmark::State& state) {
+  const int64_t num_items = state.range(0);
+  const int64_t max_len = state.range(1);
+  for (auto _ : state) {
+    Buffer<int64_t> buffer(max_len);
+    std::thread producer([&]() {
+      for (int64_t i = 0; i < num_items; ++i) { buffer.Send(i); }
+      buffer.Close();
+    });
+    int64_t item = 0;
+    while (buffer.Receive(&item) == kBufferStatusSuccess) { benchmark::DoNotOptimize(item); }
+    producer.join();
+  }
+  state.SetItemsProcessed(state.iterations() * num_items);
+}
+BENCHMARK(BM_BufferSendReceive)->Args({1 << 16, 2})->Args({1 << 16, 1024})->UseRealTime();
+
+}  // namespace
+
+}  // namespace oneflow
@@ -18,9 +18,14 @@ limitations under the License.
 
 #include <type_traits>
 #if defined(WITH_CUDA)
+#include <cuda.h>
 #include <cuda_fp16.h>
+#if CUDA_VERSION >= 11000
+#include <cuda_bf16.h>
+#endif
 #endif
 #include "oneflow/core/common/fp16_data_type.h"
+#include "oneflow/core/common/bfloat16.h"
 #include "oneflow/core/common/data_type.pb.h"
 #include "oneflow/core/common/data_type_seq.h"
 #include "oneflow/core/record/record.pb.h"
@@ -71,7 +76,8 @@ struct GetDataType<void> : std::integral_constant<DataType, DataType::kChar> {};
   template<>                                                                      \
   struct GetDataType<type_cpp> : std::integral_constant<DataType, type_proto> {}; \
   inline type_cpp GetTypeByDataType(std::integral_constant<DataType, type_proto>) { return {}; }
-OF_PP_FOR_EACH_TUPLE(SPECIALIZE_GET_DATA_TYPE, ALL_DATA_TYPE_SEQ FLOAT16_DATA_TYPE_SEQ);
+OF_PP_FOR_EACH_TUPLE(SPECIALIZE_GET_DATA_TYPE,
+                     ALL_DATA_TYPE_SEQ FLOAT16_DATA_TYPE_SEQ BFLOAT16_DATA_TYPE_SEQ);
 #undef SPECIALIZE_GET_DATA_TYPE
 
 template<typename T>
@@ -204,6 +210,14 @@ struct DevDType<DeviceType::kGPU, float16> {
   static_assert(sizeof(float16) == sizeof(half), "sizeof(float16) != sizeof(half)");
   typedef half type;
 };
+
+#if CUDA_VERSION >= 11000
+template<>
+struct DevDType<DeviceType::kGPU, bfloat16> {
+  static_assert(sizeof(bfloat16) == sizeof(nv_bfloat16), "sizeof(bfloat16) != sizeof(nv_bfloat16)");
+  typedef nv_bfloat16 type;
+};
+#endif
 #endif
 
 // Func
@@ -0,0 +1,106 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_COMMON_LRU_CACHE_H_
+#define ONEFLOW_CORE_COMMON_LRU_CACHE_H_
+
+#include <list>
+#include <unordered_map>
+#include "glog/logging.h"
+#include "oneflow/core/common/hash_eq_trait_ptr.h"
+
+namespace oneflow {
+
+// Least recently used cache with O(1) lookup, insertion and eviction. The keys are stored once
+// in the entry list and indexed by HashEqTraitPtr, so a lookup neither copies nor rehashes a key
+// whose hash value is already known.
+template<typename K, typename V>
+class LruCache final {
+ public:
+  LruCache(const LruCache&) = delete;
+  LruCache(LruCache&&) = delete;
+  explicit LruCache(size_t capacity)
+      : capacity_(capacity), hit_count_(0), miss_count_(0), eviction_count_(0) {
+    CHECK_GT(capacity_, 0);
+  }
+  ~LruCache() = default;
+
+  size_t size() const { return key2entry_.size(); }
+  size_t capacity() const { return capacity_; }
+  int64_t hit_count() const { return hit_count_; }
+  int64_t miss_count() const { return miss_count_; }
+  int64_t eviction_count() const { return eviction_count_; }
+
+  // Returns nullptr on a miss. A hit makes the entry the most recently used one.
+  const V* Find(const K& key) { return Find(key, std::hash<K>()(key)); }
+  const V* Find(const K& key, size_t hash_value) {
+    const auto iter = key2entry_.find(HashEqTraitPtr<const K>(&key, hash_value));
+    if (iter == key2entry_.end()) {
+      ++miss_count_;
+      return nullptr;
+    }
+    ++hit_count_;
+    entries_.splice(entries_.begin(), entries_, iter->second);
+    return &iter->second->value;
+  }
+
+  // Inserts or overwrites the value of `key', evicting the least recently used entry when full.
+  const V* Insert(const K& key, const V& value) {
+    return Insert(key, std::hash<K>()(key), value);
+  }
+  const V* Insert(const K& key, size_t hash_value, const V& value) {
+    const auto iter = key2entry_.find(HashEqTraitPtr<const K>(&key, hash_value));
+    if (iter != key2entry_.end()) {
+      iter->second->value = value;
+      entries_.splice(entries_.begin(), entries_, iter->second);
+      return &iter->second->value;
+    }
+    if (key2entry_.size() >= capacity_) {
+      const Entry& lru_entry = entries_.back();
+      key2entry_.erase(HashEqTraitPtr<const K>(&lru_entry.key, lru_entry.hash_value));
+      entries_.pop_back();
+      ++eviction_count_;
+    }
+    entries_.push_front(Entry{key, hash_value, value});
+    const Entry& entry = entries_.front();
+    key2entry_.emplace(HashEqTraitPtr<const K>(&entry.key, hash_value), entries_.begin());
+    return &entries_.front().value;
+  }
+
+  void Clear() {
+    key2entry_.clear();
+    entries_.clear();
+  }
+
+ private:
+  struct Entry {
+    K key;
+    size_t hash_value;
+    V value;
+  };
+  using EntryList = std::list<Entry>;
+
+  size_t capacity_;
+  int64_t hit_count_;
+  int64_t miss_count_;
+  int64_t eviction_count_;
+  // the front is the most recently used entry
+  EntryList entries_;
+  std::unordered_map<HashEqTraitPtr<const K>, typename EntryList::iterator> key2entry_;
+};
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_COMMON_LRU_CACHE_H_
@@ -0,0 +1,63 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "gtest/gtest.h"
+#include "oneflow/core/common/lru_cache.h"
+
+namespace oneflow {
+namespace test {
+
+TEST(LruCache, find_and_insert) {
+  LruCache<int64_t, std::string> cache(2);
+  ASSERT_EQ(cache.Find(1), nullptr);
+  cache.Insert(1, "one");
+  ASSERT_EQ(*cache.Find(1), "one");
+  cache.Insert(1, "uno");
+  ASSERT_EQ(*cache.Find(1), "uno");
+  ASSERT_EQ(cache.size(), 1);
+  ASSERT_EQ(cache.hit_count(), 2);
+  ASSERT_EQ(cache.miss_count(), 1);
+  ASSERT_EQ(cache.eviction_count(), 0);
+}
+
+TEST(LruCache, evict_least_recently_used) {
+  LruCache<int64_t, std::string> cache(2);
+  cache.Insert(1, "one");
+  cache.Insert(2, "two");
+  ASSERT_NE(cache.Find(1), nullptr);
+  cache.Insert(3, "three");
+  ASSERT_EQ(cache.size(), 2);
+  ASSERT_EQ(cache.eviction_count(), 1);
+  ASSERT_EQ(cache.Find(2), nullptr);
+  ASSERT_EQ(*cache.Find(1), "one");
+  ASSERT_EQ(*cache.Find(3), "three");
+  cache.Insert(4, "four");
+  ASSERT_EQ(cache.Find(1), nullptr);
+  ASSERT_EQ(cache.eviction_count(), 2);
+}
+
+TEST(LruCache, clear) {
+  LruCache<std::string, int64_t> cache(4);
+  cache.Insert("a", 1);
+  cache.Insert("b", 2);
+  cache.Clear();
+  ASSERT_EQ(cache.size(), 0);
+  ASSERT_EQ(cache.Find("a"), nullptr);
+  cache.Insert("a", 3);
+  ASSERT_EQ(*cache.Find("a"), 3);
+}
+
+}  // namespace test
+}  // namespace oneflow
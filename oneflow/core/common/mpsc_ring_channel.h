@@ -0,0 +1,180 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_COMMON_MPSC_RING_CHANNEL_H_
+#define ONEFLOW_CORE_COMMON_MPSC_RING_CHANNEL_H_
+
+#include "oneflow/core/common/util.h"
+#include "oneflow/core/common/channel.h"
+
+namespace oneflow {
+
+// Bounded multi-producer single-consumer channel on a ring buffer of sequenced cells (Dmitry
+// Vyukov's bounded queue). Send takes no lock unless the consumer is parked. Receive spins for a
+// while before parking on a condition variable. Send blocks while the ring is full.
+template<typename T>
+class MpscRingChannel final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(MpscRingChannel);
+  MpscRingChannel() : MpscRingChannel(kDefaultCapacity) {}
+  explicit MpscRingChannel(size_t capacity);
+  ~MpscRingChannel() = default;
+
+  static const size_t kDefaultCapacity = 16384;
+  static const int32_t kSpinCntBeforePark = 1024;
+
+  // thread safe
+  ChannelStatus Send(const T& item);
+  // consumer only
+  ChannelStatus Receive(T* item);
+  // consumer only. Appends the readable items to `items', at most capacity() items at a time.
+  ChannelStatus ReceiveMany(std::vector<T>* items);
+  void Close();
+
+  size_t capacity() const { return mask_ + 1; }
+
+ private:
+  struct Cell {
+    std::atomic<size_t> sequence;
+    T item;
+  };
+
+  bool Readable() const;
+  bool TryReceive(T* item);
+  // Returns false if the channel is closed and empty
+  bool WaitUntilReadable();
+  void NotifyIfConsumerParked();
+
+  std::unique_ptr<Cell[]> cells_;
+  size_t mask_;
+  std::atomic<size_t> enqueue_pos_;
+  // consumer only
+  size_t dequeue_pos_;
+
+  std::atomic<bool> is_closed_;
+  std::atomic<bool> is_consumer_parked_;
+  std::mutex mutex_;
+  std::condition_variable cond_;
+};
+
+template<typename T>
+const size_t MpscRingChannel<T>::kDefaultCapacity;
+
+template<typename T>
+const int32_t MpscRingChannel<T>::kSpinCntBeforePark;
+
+template<typename T>
+MpscRingChannel<T>::MpscRingChannel(size_t capacity)
+    : enqueue_pos_(0), dequeue_pos_(0), is_closed_(false), is_consumer_parked_(false) {
+  size_t aligned_capacity = 2;
+  while (aligned_capacity < capacity) { aligned_capacity <<= 1; }
+  cells_.reset(new Cell[aligned_capacity]);
+  mask_ = aligned_capacity - 1;
+  FOR_RANGE(size_t, i, 0, aligned_capacity) {
+    cells_[i].sequence.store(i, std::memory_order_relaxed);
+  }
+}
+
+template<typename T>
+ChannelStatus MpscRingChannel<T>::Send(const T& item) {
+  if (is_closed_.load(std::memory_order_acquire)) { return kChannelStatusErrorClosed; }
+  size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+  Cell* cell = nullptr;
+  while (true) {
+    cell = &cells_[pos & mask_];
+    const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+    const intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+    if (diff == 0) {
+      if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) { break; }
+    } else {
+      // the ring is full if diff < 0
+      if (diff < 0) { std::this_thread::yield(); }
+      pos = enqueue_pos_.load(std::memory_order_relaxed);
+    }
+  }
+  cell->item = item;
+  cell->sequence.store(pos + 1, std::memory_order_release);
+  NotifyIfConsumerParked();
+  return kChannelStatusSuccess;
+}
+
+template<typename T>
+ChannelStatus MpscRingChannel<T>::Receive(T* item) {
+  if (!WaitUntilReadable()) { return kChannelStatusErrorClosed; }
+  CHECK(TryReceive(item));
+  return kChannelStatusSuccess;
+}
+
+template<typename T>
+ChannelStatus MpscRingChannel<T>::ReceiveMany(std::vector<T>* items) {
+  if (!WaitUntilReadable()) { return kChannelStatusErrorClosed; }
+  T item;
+  for (size_t i = 0; i < capacity() && TryReceive(&item); ++i) {
+    items->push_back(std::move(item));
+  }
+  return kChannelStatusSuccess;
+}
+
+template<typename T>
+void MpscRingChannel<T>::Close() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  is_closed_.store(true);
+  cond_.notify_all();
+}
+
+template<typename T>
+bool MpscRingChannel<T>::Readable() const {
+  const size_t sequence = cells_[dequeue_pos_ & mask_].sequence.load(std::memory_order_acquire);
+  return sequence == dequeue_pos_ + 1;
+}
+
+template<typename T>
+bool MpscRingChannel<T>::TryReceive(T* item) {
+  if (!Readable()) { return false; }
+  Cell* cell = &cells_[dequeue_pos_ & mask_];
+  *item = std::move(cell->item);
+  cell->sequence.store(dequeue_pos_ + mask_ + 1, std::memory_order_release);
+  ++dequeue_pos_;
+  return true;
+}
+
+template<typename T>
+bool MpscRingChannel<T>::WaitUntilReadable() {
+  FOR_RANGE(int32_t, i, 0, kSpinCntBeforePark) {
+    if (Readable()) { return true; }
+    if (i >= kSpinCntBeforePark / 2) { std::this_thread::yield(); }
+  }
+  std::unique_lock<std::mutex> lock(mutex_);
+  is_consumer_parked_.store(true);
+  // pairs with the fence in NotifyIfConsumerParked, so that either the consumer sees the new item
+  // or the producer sees the parked consumer
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  cond_.wait(lock, [this]() { return Readable() || is_closed_.load(); });
+  is_consumer_parked_.store(false, std::memory_order_relaxed);
+  return Readable();
+}
+
+template<typename T>
+void MpscRingChannel<T>::NotifyIfConsumerParked() {
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (is_consumer_parked_.load(std::memory_order_relaxed)) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cond_.notify_one();
+  }
+}
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_COMMON_MPSC_RING_CHANNEL_H_
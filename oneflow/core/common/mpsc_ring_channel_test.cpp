@@ -0,0 +1,124 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "gtest/gtest.h"
+#include <chrono>
+#include "oneflow/core/common/mpsc_ring_channel.h"
+
+namespace oneflow {
+
+namespace test {
+
+namespace {
+
+// about the size of ActorMsg
+struct FakeActorMsg {
+  int64_t src_actor_id;
+  int64_t dst_actor_id;
+  char payload[112];
+};
+
+template<typename ChannelT, typename ReceiveBufferT>
+double BenchmarkMsgsPerSecond(int32_t producer_num, int64_t msg_num_per_producer) {
+  ChannelT channel;
+  std::vector<std::thread> producers;
+  const auto start = std::chrono::steady_clock::now();
+  for (int32_t i = 0; i < producer_num; ++i) {
+    producers.emplace_back([&channel, i, msg_num_per_producer]() {
+      FakeActorMsg msg;
+      msg.src_actor_id = i;
+      for (int64_t j = 0; j < msg_num_per_producer; ++j) {
+        msg.dst_actor_id = j;
+        CHECK_EQ(channel.Send(msg), kChannelStatusSuccess);
+      }
+    });
+  }
+  int64_t received_num = 0;
+  ReceiveBufferT msgs;
+  while (received_num < producer_num * msg_num_per_producer) {
+    CHECK_EQ(channel.ReceiveMany(&msgs), kChannelStatusSuccess);
+    received_num += msgs.size();
+    msgs = ReceiveBufferT();
+  }
+  const auto end = std::chrono::steady_clock::now();
+  for (auto& producer : producers) { producer.join(); }
+  return received_num / std::chrono::duration<double>(end - start).count();
+}
+
+}  // namespace
+
+TEST(MpscRingChannel, fifo_per_producer) {
+  const int32_t producer_num = 8;
+  const int64_t msg_num = 20000;
+  // a small ring makes the producers block on full
+  MpscRingChannel<std::pair<int32_t, int64_t>> channel(64);
+  std::vector<std::thread> producers;
+  for (int32_t i = 0; i < producer_num; ++i) {
+    producers.emplace_back([&channel, i, msg_num]() {
+      for (int64_t j = 0; j < msg_num; ++j) {
+        ASSERT_EQ(channel.Send(std::make_pair(i, j)), kChannelStatusSuccess);
+      }
+    });
+  }
+  std::vector<int64_t> next(producer_num, 0);
+  std::vector<std::pair<int32_t, int64_t>> items;
+  int64_t received_num = 0;
+  while (received_num < producer_num * msg_num) {
+    ASSERT_EQ(channel.ReceiveMany(&items), kChannelStatusSuccess);
+    ASSERT_LE(items.size(), channel.capacity());
+    for (const auto& item : items) { ASSERT_EQ(next.at(item.first)++, item.second); }
+    received_num += items.size();
+    items.clear();
+  }
+  for (auto& producer : producers) { producer.join(); }
+  channel.Close();
+  std::pair<int32_t, int64_t> item;
+  ASSERT_EQ(channel.Receive(&item), kChannelStatusErrorClosed);
+  ASSERT_EQ(channel.Send(item), kChannelStatusErrorClosed);
+}
+
+TEST(MpscRingChannel, close_wakes_parked_consumer) {
+  MpscRingChannel<int> channel;
+  std::thread consumer([&channel]() {
+    int item = 0;
+    ASSERT_EQ(channel.Receive(&item), kChannelStatusSuccess);
+    ASSERT_EQ(item, 1);
+    ASSERT_EQ(channel.Receive(&item), kChannelStatusErrorClosed);
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  ASSERT_EQ(channel.Send(1), kChannelStatusSuccess);
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  channel.Close();
+  consumer.join();
+}
+
+TEST(MpscRingChannel, actor_msg_throughput_benchmark) {
+  const int64_t msg_num = 200000;
+  for (int32_t producer_num : {1, 4}) {
+    const double channel_msgs_per_second =
+        BenchmarkMsgsPerSecond<Channel<FakeActorMsg>, std::queue<FakeActorMsg>>(producer_num,
+                                                                                msg_num);
+    const double ring_channel_msgs_per_second =
+        BenchmarkMsgsPerSecond<MpscRingChannel<FakeActorMsg>, std::vector<FakeActorMsg>>(
+            producer_num, msg_num);
+    LOG(INFO) << producer_num << " sender thread(s) to 1 receiver thread, Channel: "
+              << channel_msgs_per_second << " msgs/s, MpscRingChannel: "
+              << ring_channel_msgs_per_second << " msgs/s";
+  }
+}
+
+}  // namespace test
+
+}  // namespace oneflow
@@ -21,6 +21,53 @@ limitations under the License.
 
 namespace oneflow {
 
+template<typename T>
+class IndexDivisor {
+ public:
+  OF_DEVICE_FUNC IndexDivisor() = default;
+  OF_DEVICE_FUNC void Init(T divisor) { divisor_ = divisor; }
+  OF_DEVICE_FUNC T Div(T dividend) const { return dividend / divisor_; }
+
+ private:
+  T divisor_;
+};
+
+// Divides by a multiply-high and a shift with a magic number precomputed for the divisor
+// (Granlund and Montgomery), since the integer division of GPUs is a long instruction sequence.
+// Exact for 0 <= dividend <= INT32_MAX and 1 <= divisor <= INT32_MAX, which holds for the
+// offsets and strides of a NdIndexOffsetHelper<int32_t, N>.
+template<>
+class IndexDivisor<int32_t> {
+ public:
+  OF_DEVICE_FUNC IndexDivisor() = default;
+  OF_DEVICE_FUNC void Init(int32_t divisor) {
+    // a zero stride comes from an empty dim, no offset is ever divided by it
+    if (divisor <= 0) {
+      multiplier_ = 0;
+      shift_ = 0;
+      return;
+    }
+    const uint32_t d = static_cast<uint32_t>(divisor);
+    shift_ = 0;
+    while (shift_ < 32 && (static_cast<uint64_t>(1) << shift_) < d) { ++shift_; }
+    const uint64_t one = 1;
+    multiplier_ = static_cast<uint32_t>(((one << 32) * ((one << shift_) - d)) / d + 1);
+  }
+  OF_DEVICE_FUNC int32_t Div(int32_t dividend) const {
+    const uint32_t n = static_cast<uint32_t>(dividend);
+#ifdef __CUDA_ARCH__
+    const uint32_t t = __umulhi(n, multiplier_);
+#else
+    const uint32_t t = static_cast<uint32_t>((static_cast<uint64_t>(n) * multiplier_) >> 32);
+#endif
+    return static_cast<int32_t>((t + n) >> shift_);
+  }
+
+ private:
+  uint32_t multiplier_;
+  uint32_t shift_;
+};
+
 template<typename T, int N>
 class NdIndexOffsetHelper {
  public:
@@ -82,7 +129,7 @@ class NdIndexOffsetHelper {
 #pragma unroll
 #endif
     for (int i = 0; i < N - 1; ++i) {
-      const T idx = remaining / stride_[i];
+      const T idx = stride_divisor_[i].Div(remaining);
       index[i] = idx;
       remaining = remaining - idx * stride_[i];
     }
@@ -96,7 +143,7 @@ class NdIndexOffsetHelper {
 #pragma unroll
 #endif
     for (int i = 0; i < n; ++i) {
-      const T idx = remaining / stride_[i];
+      const T idx = stride_divisor_[i].Div(remaining);
       index[i] = idx;
       remaining = remaining - idx * stride_[i];
     }
@@ -112,14 +159,14 @@ class NdIndexOffsetHelper {
 #pragma unroll
 #endif
     for (int i = 0; i < n - 1; ++i) {
-      const T idx = remaining / stride_[i];
+      const T idx = stride_divisor_[i].Div(remaining);
       *index[i] = idx;
       remaining = remaining - idx * stride_[i];
     }
     if (n == N) {
       *index[n - 1] = remaining;
     } else {
-      *index[n - 1] = remaining / stride_[n - 1];
+      *index[n - 1] = stride_divisor_[n - 1].Div(remaining);
     }
   }
 
@@ -129,9 +176,11 @@ class NdIndexOffsetHelper {
   OF_DEVICE_FUNC void InitStrides(const T* dims, const int n) {
     for (int i = n - 1; i < N; ++i) { stride_[i] = 1; }
     for (int i = n - 2; i >= 0; --i) { stride_[i] = dims[i + 1] * stride_[i + 1]; }
+    for (int i = 0; i < N; ++i) { stride_divisor_[i].Init(stride_[i]); }
   }
 
   T stride_[N];
+  IndexDivisor<T> stride_divisor_[N];
 };
 
 }  // namespace oneflow
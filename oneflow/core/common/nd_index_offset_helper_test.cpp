@@ -17,6 +17,7 @@ limitations under the License.
 // caused by the following trick
 // reference: https://gcc.gnu.org/bugzilla/show_bug.cgi?id=65899
 #include <sstream>
+#include <vector>
 #define private public
 #include "oneflow/core/common/nd_index_offset_helper.h"
 
@@ -141,6 +142,23 @@ TEST(NdIndexOffsetHelper, constructor) {
   test_constructor<int64_t>();
 }
 
+TEST(NdIndexOffsetHelper, int32_divisor) {
+  const std::vector<int32_t> divisors({1, 2, 3, 5, 7, 64, 100, 255, 1000, 65535, 65536, 1 << 20,
+                                       (1 << 30) + 1, 2147483647});
+  const std::vector<int32_t> dividends({0, 1, 2, 3, 63, 64, 65, 999, 1000, 65535, 65536, 1 << 20,
+                                        (1 << 30) - 1, 1 << 30, 2147483646, 2147483647});
+  for (const int32_t divisor : divisors) {
+    IndexDivisor<int32_t> fast_divisor;
+    fast_divisor.Init(divisor);
+    for (const int32_t dividend : dividends) {
+      ASSERT_EQ(fast_divisor.Div(dividend), dividend / divisor);
+    }
+    for (int32_t dividend = 0; dividend < 4096; ++dividend) {
+      ASSERT_EQ(fast_divisor.Div(dividend), dividend / divisor);
+    }
+  }
+}
+
 }  // namespace test
 
 }  // namespace oneflow
@@ -19,7 +19,7 @@ limitations under the License.
 #include "oneflow/core/common/shape.h"
 #include "oneflow/core/common/data_type.h"
 #include "oneflow/core/common/util.h"
-#include "oneflow/core/memory/memory_allocator.h"
+#include "oneflow/core/common/tensor_buffer_pool.h"
 
 namespace oneflow {
 
@@ -31,13 +31,17 @@ inline void CheckTensorBufferDataType(DataType val) {
 class TensorBuffer {
  public:
   struct Deleter {
-    void operator()(void* ptr) { MemoryAllocatorImpl::DeallocateUnPinnedHostMem(ptr); }
+    size_t num_bytes;
+    void operator()(void* ptr) { TensorBufferPool::Deallocate(ptr, num_bytes); }
   };
   typedef std::unique_ptr<void, Deleter> BufferType;
 
   OF_DISALLOW_COPY_AND_MOVE(TensorBuffer);
   TensorBuffer()
-      : data_(nullptr), num_bytes_(0), shape_(Shape()), data_type_(DataType::kInvalidDataType) {}
+      : data_(nullptr, Deleter{0}),
+        num_bytes_(0),
+        shape_(Shape()),
+        data_type_(DataType::kInvalidDataType) {}
   virtual ~TensorBuffer() = default;
 
   const Shape& shape() const { return shape_; }
@@ -79,7 +83,8 @@ class TensorBuffer {
   void reserve(size_t new_num_bytes) {
     if (new_num_bytes <= num_bytes_) { return; }
     data_.reset();
-    data_.reset(MemoryAllocatorImpl::AllocateUnPinnedHostMem(new_num_bytes));
+    new_num_bytes = TensorBufferPool::RoundUpToSizeClass(new_num_bytes);
+    data_ = BufferType(TensorBufferPool::Allocate(new_num_bytes), Deleter{new_num_bytes});
     num_bytes_ = new_num_bytes;
   }
 
@@ -105,7 +110,8 @@ class TensorBuffer {
       new_num_bytes =
           std::max(new_num_bytes, RoundUp(num_bytes_ * growth_factor_, kTensorBufferAlignedSize));
       reserve(new_num_bytes);
-    } else if (new_num_bytes < num_bytes_ * shrink_threshold_) {
+    } else if (TensorBufferPool::RoundUpToSizeClass(new_num_bytes)
+               < num_bytes_ * shrink_threshold_) {
       data_.reset();
       num_bytes_ = 0;
       reserve(new_num_bytes);
@@ -0,0 +1,197 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/common/tensor_buffer_pool.h"
+#include "oneflow/core/memory/memory_allocator.h"
+#include "oneflow/core/device/cuda_util.h"
+
+namespace oneflow {
+
+namespace {
+
+constexpr size_t kMinSizeClassBytes = 1024;
+constexpr int64_t kMinSizeClassShift = 10;
+// buffers larger than 64MB are not cached
+constexpr int64_t kMaxSizeClassShift = 26;
+constexpr int64_t kNumSizeClassesPerShift = 4;
+constexpr int64_t kNumSizeClasses =
+    (kMaxSizeClassShift - kMinSizeClassShift) * kNumSizeClassesPerShift + 1;
+constexpr size_t kMaxThreadCacheBytes = 16 * 1024 * 1024;
+
+bool IsPoolEnabled() {
+  static const bool enabled = ParseBooleanFromEnv("ONEFLOW_TENSOR_BUFFER_POOL", true);
+  return enabled;
+}
+
+bool IsPinned() {
+  static const bool pinned = ParseBooleanFromEnv("ONEFLOW_TENSOR_BUFFER_POOL_PINNED", false);
+  return pinned;
+}
+
+void* AllocateRaw(size_t num_bytes) {
+  if (IsPinned()) {
+#ifdef WITH_CUDA
+    void* ptr = nullptr;
+    OF_CUDA_CHECK(cudaMallocHost(&ptr, num_bytes));
+    return ptr;
+#else
+    UNIMPLEMENTED() << "ONEFLOW_TENSOR_BUFFER_POOL_PINNED requires CUDA";
+#endif  // WITH_CUDA
+  }
+  return MemoryAllocatorImpl::AllocateUnPinnedHostMem(num_bytes);
+}
+
+void DeallocateRaw(void* ptr) {
+  if (IsPinned()) {
+#ifdef WITH_CUDA
+    OF_CUDA_CHECK(cudaFreeHost(ptr));
+    return;
+#endif  // WITH_CUDA
+  }
+  MemoryAllocatorImpl::DeallocateUnPinnedHostMem(ptr);
+}
+
+// returns -1 for the sizes which are not cached
+int64_t SizeClass4Bytes(size_t num_bytes) {
+  if (num_bytes <= kMinSizeClassBytes) { return 0; }
+  int64_t shift = 63 - __builtin_clzll(num_bytes - 1);
+  if (shift >= kMaxSizeClassShift) { return -1; }
+  const size_t base = static_cast<size_t>(1) << shift;
+  const size_t step = base / kNumSizeClassesPerShift;
+  const int64_t sub = (num_bytes - base + step - 1) / step;
+  return (shift - kMinSizeClassShift) * kNumSizeClassesPerShift + sub;
+}
+
+size_t Bytes4SizeClass(int64_t size_class) {
+  const int64_t shift = kMinSizeClassShift + size_class / kNumSizeClassesPerShift;
+  const size_t base = static_cast<size_t>(1) << shift;
+  return base + (size_class % kNumSizeClassesPerShift) * (base / kNumSizeClassesPerShift);
+}
+
+class SharedCache final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(SharedCache);
+  SharedCache()
+      : max_cached_bytes_(
+          ParseIntegerFromEnv("ONEFLOW_TENSOR_BUFFER_POOL_MAX_CACHED_MB", 1024) * 1024 * 1024),
+        cached_bytes_(0),
+        size_class2mutex_(kNumSizeClasses),
+        size_class2buffers_(kNumSizeClasses) {}
+  ~SharedCache() = delete;
+
+  void* TryPop(int64_t size_class) {
+    std::unique_lock<std::mutex> lock(size_class2mutex_.at(size_class));
+    std::vector<void*>* buffers = &size_class2buffers_.at(size_class);
+    if (buffers->empty()) { return nullptr; }
+    void* ptr = buffers->back();
+    buffers->pop_back();
+    cached_bytes_ -= Bytes4SizeClass(size_class);
+    return ptr;
+  }
+
+  void PushOrFree(int64_t size_class, void* ptr) {
+    const size_t num_bytes = Bytes4SizeClass(size_class);
+    if (cached_bytes_.fetch_add(num_bytes) + num_bytes > max_cached_bytes_) {
+      cached_bytes_ -= num_bytes;
+      DeallocateRaw(ptr);
+      return;
+    }
+    std::unique_lock<std::mutex> lock(size_class2mutex_.at(size_class));
+    size_class2buffers_.at(size_class).push_back(ptr);
+  }
+
+ private:
+  const size_t max_cached_bytes_;
+  std::atomic<size_t> cached_bytes_;
+  std::vector<std::mutex> size_class2mutex_;
+  std::vector<std::vector<void*>> size_class2buffers_;
+};
+
+// never destructed, the thread caches of exiting threads flush into it
+SharedCache* GetSharedCache() {
+  static SharedCache* shared_cache = new SharedCache();
+  return shared_cache;
+}
+
+class ThreadCache final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(ThreadCache);
+  ThreadCache() : cached_bytes_(0), size_class2buffers_(kNumSizeClasses) {}
+  ~ThreadCache() {
+    FOR_RANGE(int64_t, size_class, 0, kNumSizeClasses) {
+      for (void* ptr : size_class2buffers_.at(size_class)) {
+        GetSharedCache()->PushOrFree(size_class, ptr);
+      }
+    }
+  }
+
+  void* Allocate(int64_t size_class) {
+    std::vector<void*>* buffers = &size_class2buffers_.at(size_class);
+    if (!buffers->empty()) {
+      void* ptr = buffers->back();
+      buffers->pop_back();
+      cached_bytes_ -= Bytes4SizeClass(size_class);
+      return ptr;
+    }
+    void* ptr = GetSharedCache()->TryPop(size_class);
+    if (ptr != nullptr) { return ptr; }
+    return AllocateRaw(Bytes4SizeClass(size_class));
+  }
+
+  void Deallocate(int64_t size_class, void* ptr) {
+    const size_t num_bytes = Bytes4SizeClass(size_class);
+    if (cached_bytes_ + num_bytes <= kMaxThreadCacheBytes) {
+      size_class2buffers_.at(size_class).push_back(ptr);
+      cached_bytes_ += num_bytes;
+    } else {
+      GetSharedCache()->PushOrFree(size_class, ptr);
+    }
+  }
+
+ private:
+  size_t cached_bytes_;
+  std::vector<std::vector<void*>> size_class2buffers_;
+};
+
+ThreadCache* GetThreadCache() {
+  static thread_local ThreadCache thread_cache;
+  return &thread_cache;
+}
+
+}  // namespace
+
+size_t TensorBufferPool::RoundUpToSizeClass(size_t num_bytes) {
+  if (!IsPoolEnabled()) { return num_bytes; }
+  const int64_t size_class = SizeClass4Bytes(num_bytes);
+  return size_class == -1 ? num_bytes : Bytes4SizeClass(size_class);
+}
+
+void* TensorBufferPool::Allocate(size_t num_bytes) {
+  if (!IsPoolEnabled()) { return AllocateRaw(num_bytes); }
+  const int64_t size_class = SizeClass4Bytes(num_bytes);
+  if (size_class == -1) { return AllocateRaw(num_bytes); }
+  CHECK_EQ(Bytes4SizeClass(size_class), num_bytes);
+  return GetThreadCache()->Allocate(size_class);
+}
+
+void TensorBufferPool::Deallocate(void* ptr, size_t num_bytes) {
+  if (ptr == nullptr) { return; }
+  if (!IsPoolEnabled()) { return DeallocateRaw(ptr); }
+  const int64_t size_class = SizeClass4Bytes(num_bytes);
+  if (size_class == -1) { return DeallocateRaw(ptr); }
+  GetThreadCache()->Deallocate(size_class, ptr);
+}
+
+}  // namespace oneflow
@@ -0,0 +1,44 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_COMMON_TENSOR_BUFFER_POOL_H_
+#define ONEFLOW_CORE_COMMON_TENSOR_BUFFER_POOL_H_
+
+#include "oneflow/core/common/util.h"
+
+namespace oneflow {
+
+// Host memory of TensorBuffers. Sizes are rounded up to size classes, four per power of two, and
+// freed buffers are kept in a small cache of the freeing thread and then in a shared cache per
+// size class, so decoding samples does not call malloc and free for every sample.
+//   ONEFLOW_TENSOR_BUFFER_POOL: enables the caches, true by default
+//   ONEFLOW_TENSOR_BUFFER_POOL_MAX_CACHED_MB: bound of the shared caches, 1024 by default
+//   ONEFLOW_TENSOR_BUFFER_POOL_PINNED: allocates page-locked memory, which makes the host to
+//     device copies of the data pipeline asynchronous, false by default
+class TensorBufferPool final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(TensorBufferPool);
+  ~TensorBufferPool() = delete;
+
+  // the capacity a buffer of num_bytes gets
+  static size_t RoundUpToSizeClass(size_t num_bytes);
+  // num_bytes must be a value returned by RoundUpToSizeClass
+  static void* Allocate(size_t num_bytes);
+  static void Deallocate(void* ptr, size_t num_bytes);
+};
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_COMMON_TENSOR_BUFFER_POOL_H_
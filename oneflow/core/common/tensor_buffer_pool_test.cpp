@@ -0,0 +1,55 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "gtest/gtest.h"
+#include "oneflow/core/common/tensor_buffer.h"
+
+namespace oneflow {
+
+namespace test {
+
+TEST(TensorBufferPool, round_up_to_size_class) {
+  ASSERT_EQ(TensorBufferPool::RoundUpToSizeClass(1), 1024);
+  ASSERT_EQ(TensorBufferPool::RoundUpToSizeClass(1024), 1024);
+  ASSERT_EQ(TensorBufferPool::RoundUpToSizeClass(1025), 1280);
+  ASSERT_EQ(TensorBufferPool::RoundUpToSizeClass(2048), 2048);
+  ASSERT_EQ(TensorBufferPool::RoundUpToSizeClass(3 * 1024 * 1024 + 1), 3584 * 1024);
+  // not cached
+  ASSERT_EQ(TensorBufferPool::RoundUpToSizeClass(100 * 1024 * 1024), 100 * 1024 * 1024);
+}
+
+TEST(TensorBufferPool, reuse_freed_buffer) {
+  const size_t num_bytes = TensorBufferPool::RoundUpToSizeClass(5000);
+  void* ptr = TensorBufferPool::Allocate(num_bytes);
+  TensorBufferPool::Deallocate(ptr, num_bytes);
+  ASSERT_EQ(TensorBufferPool::Allocate(num_bytes), ptr);
+  TensorBufferPool::Deallocate(ptr, num_bytes);
+}
+
+TEST(TensorBufferPool, tensor_buffer_resize) {
+  TensorBuffer buffer;
+  buffer.Resize(Shape({1000}), DataType::kFloat);
+  ASSERT_EQ(buffer.capacity(), TensorBufferPool::RoundUpToSizeClass(4096));
+  const void* data = buffer.data();
+  // sizes within the same size class keep the buffer
+  buffer.Resize(Shape({900}), DataType::kFloat);
+  ASSERT_EQ(buffer.data(), data);
+  buffer.Resize(Shape({100}), DataType::kFloat);
+  ASSERT_EQ(buffer.capacity(), 1024);
+}
+
+}  // namespace test
+
+}  // namespace oneflow
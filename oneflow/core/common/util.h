@@ -114,7 +114,7 @@ void SortAndRemoveDuplication(std::vector<T>* vec) {
 }
 
 inline std::string NewUniqueId() {
-  static int64_t id = 0;
+  static std::atomic<int64_t> id(0);
   return std::to_string(id++);
 }
 
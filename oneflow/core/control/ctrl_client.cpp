@@ -34,7 +34,11 @@ GrpcCtrlClient::GrpcCtrlClient(const ProcessCtx& process_ctx) : process_ctx_(pro
     rpc_client_.LoadServer(address.host(), rpc_client_.GetStubAt(i));
   }
   need_heartbeat_thread_stop_ = false;
-  heartbeat_thread_ = std::thread([this]() {
+  // a machine that hangs instead of closing its connection would block the heartbeat forever,
+  // so the job is aborted once a heartbeat takes this long and can be restarted on the survivors
+  const int64_t heartbeat_timeout_sec =
+      ParseIntegerFromEnv("ONEFLOW_CTRL_HEARTBEAT_TIMEOUT_SECONDS", 120);
+  heartbeat_thread_ = std::thread([this, heartbeat_timeout_sec]() {
     std::mt19937 gen(NewRandomSeed());
     std::uniform_int_distribution<int32_t> sleep_second_dis(7, 13);
     LoadServerRequest request;
@@ -49,6 +53,10 @@ GrpcCtrlClient::GrpcCtrlClient(const ProcessCtx& process_ctx) : process_ctx_(pro
       }
       for (size_t i = 0; i < rpc_client_.GetStubSize(); ++i) {
         grpc::ClientContext client_ctx;
+        if (heartbeat_timeout_sec > 0) {
+          client_ctx.set_deadline(std::chrono::system_clock::now()
+                                  + std::chrono::seconds(heartbeat_timeout_sec));
+        }
         request.set_addr(this->process_ctx().ctrl_addr(i).host());
         GRPC_CHECK(rpc_client_.GetStubAt(i)->CallMethod<CtrlMethod::kLoadServer>(
             &client_ctx, request, &response))
@@ -102,6 +110,23 @@ void GrpcCtrlClient::PullMasterKV(const std::string& k, PbMessage* msg) {
   rpc_client_.PullMasterKV(k, msg);
 }
 
+void GrpcCtrlClient::MultiPushKV(const std::vector<std::pair<std::string, std::string>>& kvs) {
+  rpc_client_.MultiPushKV(kvs);
+}
+
+void GrpcCtrlClient::MultiPullKV(const std::vector<std::string>& keys,
+                                 std::vector<std::string>* vals) {
+  rpc_client_.MultiPullKV(keys, vals);
+}
+
+void GrpcCtrlClient::PullImmutableKV(const std::string& k, std::string* v) {
+  rpc_client_.PullImmutableKV(k, v);
+}
+
+void GrpcCtrlClient::BroadcastKV(const std::string& k, int64_t root, std::string* v) {
+  rpc_client_.BroadcastKV(k, root, v);
+}
+
 void GrpcCtrlClient::Clear() { rpc_client_.Clear(); }
 
 void GrpcCtrlClient::PushActEvent(const ActEvent& act_event) {
@@ -79,6 +79,41 @@ TEST(CtrlServer, new_delete) {
   Global<CtrlServer>::Delete();
   Global<EnvDesc>::Delete();
 }
+
+TEST(CtrlServer, multi_kv) {
+  int port = CtrlUtil().FindAvailablePort();
+  if (port == -1) { return; }
+  EnvProto env_proto = GetEnvProto(port);
+  Global<EnvDesc>::New(env_proto);
+  Global<CtrlServer>::New();
+  Global<ProcessCtx>::New();
+  CHECK_JUST(HostListCtrlBootstrap(*Global<EnvDesc>::Get())
+                 .InitProcessCtx(Global<CtrlServer>::Get()->port(), Global<ProcessCtx>::Get()));
+  auto* client = new GrpcCtrlClient(*Global<ProcessCtx>::Get());
+  Global<CtrlClient>::SetAllocated(client);
+
+  // pulls issued before the pushes wait on the server until the last key arrives
+  std::vector<std::string> pulled;
+  std::thread puller([&]() { client->MultiPullKV({"b", "a", "c"}, &pulled); });
+  client->MultiPushKV({{"a", "1"}, {"b", "2"}});
+  client->PushKV("c", "3");
+  puller.join();
+  ASSERT_EQ(pulled, (std::vector<std::string>{"2", "1", "3"}));
+
+  std::string v;
+  client->PullImmutableKV("a", &v);
+  ASSERT_EQ(v, "1");
+  client->ClearKV("a");
+  client->PushKV("a", "4");
+  client->PullImmutableKV("a", &v);
+  ASSERT_EQ(v, "4");
+  client->Clear();
+
+  Global<CtrlClient>::Delete();
+  Global<ProcessCtx>::Delete();
+  Global<CtrlServer>::Delete();
+  Global<EnvDesc>::Delete();
+}
 #endif  // RPC_BACKEND_GRPC
 
 }  // namespace oneflow
@@ -16,6 +16,7 @@ limitations under the License.
 #include "oneflow/core/control/rpc_client.h"
 #include "oneflow/core/control/global_process_ctx.h"
 #include "oneflow/core/job/env_desc.h"
+#include "lz4.h"
 
 namespace oneflow {
 
@@ -45,6 +46,35 @@ class ClientCall final {
   CtrlResponse<ctrl_method> response_;
 };
 
+// A chunk is stored as a one byte tag followed by either the raw or the lz4 compressed bytes.
+const char kRawChunkTag = 0;
+const char kLz4ChunkTag = 1;
+
+void CompressChunk(const char* data, size_t size, std::string* chunk) {
+  const int bound = LZ4_compressBound(size);
+  chunk->resize(1 + bound);
+  const int compressed_size = LZ4_compress_default(data, &chunk->at(1), size, bound);
+  if (compressed_size > 0 && static_cast<size_t>(compressed_size) < size) {
+    chunk->at(0) = kLz4ChunkTag;
+    chunk->resize(1 + compressed_size);
+  } else {
+    chunk->at(0) = kRawChunkTag;
+    chunk->replace(1, std::string::npos, data, size);
+  }
+}
+
+void DecompressChunk(const std::string& chunk, char* data, size_t size) {
+  CHECK(!chunk.empty());
+  if (chunk.at(0) == kLz4ChunkTag) {
+    CHECK_EQ(LZ4_decompress_safe(chunk.data() + 1, data, chunk.size() - 1, size),
+             static_cast<int>(size));
+  } else {
+    CHECK_EQ(chunk.at(0), kRawChunkTag);
+    CHECK_EQ(chunk.size() - 1, size);
+    std::memcpy(data, chunk.data() + 1, size);
+  }
+}
+
 }  // namespace
 
 void RpcClient::Barrier(const std::string& barrier_name) {
@@ -52,12 +82,56 @@ void RpcClient::Barrier(const std::string& barrier_name) {
 }
 
 void RpcClient::Barrier(const std::string& barrier_name, int32_t barrier_num) {
+  static const int64_t fan_out = ParseIntegerFromEnv("ONEFLOW_CTRL_BARRIER_FAN_OUT", 8);
+  // the tree assumes the participants are rank 0 ~ barrier_num - 1
+  if (fan_out > 1 && barrier_num > fan_out && GlobalProcessCtx::Rank() < barrier_num
+      && barrier_num <= stubs_.size()) {
+    TreeBarrier(barrier_name, barrier_num, fan_out);
+  } else {
+    StarBarrier(barrier_name, barrier_num);
+  }
+}
+
+void RpcClient::StarBarrier(const std::string& barrier_name, int32_t barrier_num) {
   ClientCall<CtrlMethod::kBarrier> call;
   call.mut_request()->set_name(barrier_name);
   call.mut_request()->set_num(barrier_num);
   call(GetMasterStub());
 }
 
+// At level l, the ranks are divided into groups of fan_out^(l+1) consecutive ranks, and the group
+// leaders of level l-1 in a group meet at the server of their own leader. A rank climbs up while
+// it is a leader, waiting for the "arrive" barrier of each level, and then walks down through the
+// "depart" barriers, which releases the ranks that stopped climbing at that level. Every server
+// sees at most fan_out calls per barrier instead of barrier_num calls on the master.
+void RpcClient::TreeBarrier(const std::string& barrier_name, int32_t barrier_num,
+                            int64_t fan_out) {
+  const int64_t rank = GlobalProcessCtx::Rank();
+  struct Group {
+    int64_t level;
+    int64_t leader;
+    int32_t size;
+  };
+  std::vector<Group> groups;
+  for (int64_t level = 0, stride = 1; stride < barrier_num; ++level, stride *= fan_out) {
+    const int64_t group_span = stride * fan_out;
+    const int64_t leader = rank / group_span * group_span;
+    const int64_t end = std::min<int64_t>(leader + group_span, barrier_num);
+    const int32_t size = static_cast<int32_t>(RoundUp(end - leader, stride) / stride);
+    groups.push_back(Group{level, leader, size});
+    if (rank != leader) { break; }
+  }
+  const auto DoBarrier = [&](const Group& group, const std::string& phase) {
+    ClientCall<CtrlMethod::kBarrier> call;
+    call.mut_request()->set_name(barrier_name + "-tree_barrier_level:" + std::to_string(group.level)
+                                 + "-leader:" + std::to_string(group.leader) + "-" + phase);
+    call.mut_request()->set_num(group.size);
+    call(GetStubAt(group.leader));
+  };
+  for (const Group& group : groups) { DoBarrier(group, "arrive"); }
+  for (auto it = groups.rbegin(); it != groups.rend(); ++it) { DoBarrier(*it, "depart"); }
+}
+
 TryLockResult RpcClient::TryLock(const std::string& name) {
   {
     std::unique_lock<std::mutex> lck(done_names_mtx_);
@@ -112,6 +186,10 @@ void RpcClient::PushMasterKV(const std::string& k, const PbMessage& msg) {
 }
 
 void RpcClient::ClearKV(const std::string& k) {
+  {
+    std::unique_lock<std::mutex> lck(immutable_kv_cache_mtx_);
+    immutable_kv_cache_.erase(k);
+  }
   ClientCall<CtrlMethod::kClearKV> call;
   call.mut_request()->set_key(k);
   call(GetResponsibleStub(k));
@@ -150,6 +228,150 @@ void RpcClient::PullMasterKV(const std::string& k, PbMessage* msg) {
   PullMasterKV(k, [&](const std::string& i) { msg->ParseFromString(i); });
 }
 
+void RpcClient::MultiPushKV(const std::vector<std::pair<std::string, std::string>>& kvs) {
+  // keep each request well below GRPC_ARG_MAX_MESSAGE_LENGTH of CtrlService
+  const size_t kMaxRequestBytes = 32 * 1024 * 1024;
+  HashMap<CtrlService::Stub*, std::unique_ptr<ClientCall<CtrlMethod::kMultiPushKV>>> stub2call;
+  HashMap<CtrlService::Stub*, size_t> stub2request_bytes;
+  for (const auto& kv : kvs) {
+    CtrlService::Stub* stub = GetResponsibleStub(kv.first);
+    auto& call = stub2call[stub];
+    size_t& request_bytes = stub2request_bytes[stub];
+    const size_t kv_bytes = kv.first.size() + kv.second.size();
+    if (call && request_bytes + kv_bytes > kMaxRequestBytes) {
+      (*call)(stub);
+      call.reset();
+    }
+    if (!call) {
+      call.reset(new ClientCall<CtrlMethod::kMultiPushKV>());
+      request_bytes = 0;
+    }
+    PushKVRequest* request = call->mut_request()->add_kv();
+    request->set_key(kv.first);
+    request->set_val(kv.second);
+    request_bytes += kv_bytes;
+  }
+  for (auto& pair : stub2call) {
+    if (pair.second) { (*pair.second)(pair.first); }
+  }
+}
+
+void RpcClient::MultiPullKV(const std::vector<std::string>& keys, std::vector<std::string>* vals) {
+  HashMap<CtrlService::Stub*, std::unique_ptr<ClientCall<CtrlMethod::kMultiPullKV>>> stub2call;
+  // the index into `keys' of each key in the request of each stub
+  HashMap<CtrlService::Stub*, std::vector<size_t>> stub2key_indices;
+  for (size_t i = 0; i < keys.size(); ++i) {
+    CtrlService::Stub* stub = GetResponsibleStub(keys.at(i));
+    auto& call = stub2call[stub];
+    if (!call) { call.reset(new ClientCall<CtrlMethod::kMultiPullKV>()); }
+    call->mut_request()->add_key(keys.at(i));
+    stub2key_indices[stub].push_back(i);
+  }
+  vals->resize(keys.size());
+  for (auto& pair : stub2call) {
+    (*pair.second)(pair.first);
+    const auto& key_indices = stub2key_indices.at(pair.first);
+    CHECK_EQ(pair.second->response().val_size(), key_indices.size());
+    for (size_t i = 0; i < key_indices.size(); ++i) {
+      vals->at(key_indices.at(i)) = pair.second->response().val(i);
+    }
+  }
+}
+
+void RpcClient::PullImmutableKV(const std::string& k, std::string* v) {
+  {
+    std::unique_lock<std::mutex> lck(immutable_kv_cache_mtx_);
+    auto it = immutable_kv_cache_.find(k);
+    if (it != immutable_kv_cache_.end()) {
+      *v = it->second;
+      return;
+    }
+  }
+  PullKV(k, v);
+  std::unique_lock<std::mutex> lck(immutable_kv_cache_mtx_);
+  immutable_kv_cache_.emplace(k, *v);
+}
+
+void RpcClient::PushKVAt(CtrlService::Stub* stub, const std::string& k, const std::string& v) {
+  ClientCall<CtrlMethod::kPushKV> call;
+  call.mut_request()->set_key(k);
+  call.mut_request()->set_val(v);
+  call(stub);
+}
+
+void RpcClient::PullKVAt(CtrlService::Stub* stub, const std::string& k, std::string* v) {
+  ClientCall<CtrlMethod::kPullKV> call;
+  call.mut_request()->set_key(k);
+  call(stub);
+  *v = call.response().val();
+}
+
+void RpcClient::ClearKVAt(CtrlService::Stub* stub, const std::string& k) {
+  ClientCall<CtrlMethod::kClearKV> call;
+  call.mut_request()->set_key(k);
+  call(stub);
+}
+
+// The ranks form a fan_out-ary tree rooted at `root'. The root splits the value into chunks,
+// compresses them with lz4 and pushes them to its own server. Every other rank pulls the chunks one
+// by one from the server of its parent and, if it has children, pushes them to its own server
+// as soon as they arrive. Chunks are relayed without being decompressed, and the transfers of
+// different chunks overlap along the tree, so every server sends at most fan_out copies. A fan_out
+// of 1 gives a pipelined chain.
+void RpcClient::BroadcastKV(const std::string& k, int64_t root, std::string* v) {
+  static const int64_t fan_out = ParseIntegerFromEnv("ONEFLOW_CTRL_BROADCAST_FAN_OUT", 2);
+  static const int64_t chunk_size =
+      ParseIntegerFromEnv("ONEFLOW_CTRL_BROADCAST_CHUNK_SIZE", 4 * 1024 * 1024);
+  CHECK_GT(fan_out, 0);
+  CHECK_GT(chunk_size, 0);
+  const int64_t rank_num = stubs_.size();
+  if (rank_num == 1) { return; }
+  const int64_t rank = GlobalProcessCtx::Rank();
+  const int64_t relative_rank = (rank - root + rank_num) % rank_num;
+  const bool has_children = relative_rank * fan_out + 1 < rank_num;
+  const auto HeaderKey = [&]() { return k + "/broadcast_header"; };
+  const auto ChunkKey = [&](int64_t i) { return k + "/broadcast_chunk:" + std::to_string(i); };
+  CtrlService::Stub* self_stub = GetThisStub();
+  int64_t num_chunks = 0;
+  if (relative_rank == 0) {
+    const int64_t size = v->size();
+    num_chunks = RoundUp(size, chunk_size) / chunk_size;
+    // the header is "<size>:<chunk_size>", the chunk size of the root wins
+    PushKVAt(self_stub, HeaderKey(), std::to_string(size) + ":" + std::to_string(chunk_size));
+    std::string chunk;
+    FOR_RANGE(int64_t, i, 0, num_chunks) {
+      const int64_t offset = i * chunk_size;
+      CompressChunk(v->data() + offset, std::min(chunk_size, size - offset), &chunk);
+      PushKVAt(self_stub, ChunkKey(i), chunk);
+    }
+  } else {
+    const int64_t parent = ((relative_rank - 1) / fan_out + root) % rank_num;
+    CtrlService::Stub* parent_stub = GetStubAt(parent);
+    std::string header;
+    PullKVAt(parent_stub, HeaderKey(), &header);
+    if (has_children) { PushKVAt(self_stub, HeaderKey(), header); }
+    const size_t colon_pos = header.find(':');
+    CHECK_NE(colon_pos, std::string::npos);
+    const int64_t size = oneflow_cast<int64_t>(header.substr(0, colon_pos));
+    const int64_t root_chunk_size = oneflow_cast<int64_t>(header.substr(colon_pos + 1));
+    num_chunks = RoundUp(size, root_chunk_size) / root_chunk_size;
+    v->resize(size);
+    std::string chunk;
+    FOR_RANGE(int64_t, i, 0, num_chunks) {
+      PullKVAt(parent_stub, ChunkKey(i), &chunk);
+      if (has_children) { PushKVAt(self_stub, ChunkKey(i), chunk); }
+      const int64_t offset = i * root_chunk_size;
+      DecompressChunk(chunk, &v->at(offset), std::min(root_chunk_size, size - offset));
+    }
+  }
+  // all the children must have pulled the chunks before the relays clear them
+  Barrier(k + "/broadcast_done", rank_num);
+  if (has_children) {
+    ClearKVAt(self_stub, HeaderKey());
+    FOR_RANGE(int64_t, i, 0, num_chunks) { ClearKVAt(self_stub, ChunkKey(i)); }
+  }
+}
+
 void RpcClient::PushActEvent(const ActEvent& act_event) {
   ClientCall<CtrlMethod::kPushActEvent> call;
   *(call.mut_request()->mutable_act_event()) = act_event;
@@ -159,6 +381,10 @@ void RpcClient::PushActEvent(const ActEvent& act_event) {
 void RpcClient::Clear() {
   ClientCall<CtrlMethod::kClear> call;
   call(GetThisStub());
+  {
+    std::unique_lock<std::mutex> lck(immutable_kv_cache_mtx_);
+    immutable_kv_cache_.clear();
+  }
   std::unique_lock<std::mutex> lck(done_names_mtx_);
   done_names_.clear();
 }
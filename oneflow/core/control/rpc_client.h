@@ -52,6 +52,10 @@ class RpcClient {
   void PullKV(const std::string& k, std::string* v);
   void PullKV(const std::string& k, PbMessage* msg);
   void PullMasterKV(const std::string& k, PbMessage* msg);
+  void MultiPushKV(const std::vector<std::pair<std::string, std::string>>& kvs);
+  void MultiPullKV(const std::vector<std::string>& keys, std::vector<std::string>* vals);
+  void PullImmutableKV(const std::string& k, std::string* v);
+  void BroadcastKV(const std::string& k, int64_t root, std::string* v);
   template<typename T>
   typename std::enable_if<std::is_arithmetic<T>::value>::type PullKVT(const std::string& k, T* v) {
     std::string v_str;
@@ -80,6 +84,15 @@ class RpcClient {
   std::vector<std::unique_ptr<CtrlService::Stub>> stubs_;
   std::mutex done_names_mtx_;
   HashSet<std::string> done_names_;
+  std::mutex immutable_kv_cache_mtx_;
+  HashMap<std::string, std::string> immutable_kv_cache_;
+
+ private:
+  void PushKVAt(CtrlService::Stub* stub, const std::string& k, const std::string& v);
+  void PullKVAt(CtrlService::Stub* stub, const std::string& k, std::string* v);
+  void ClearKVAt(CtrlService::Stub* stub, const std::string& k);
+  void StarBarrier(const std::string& barrier_name, int32_t barrier_num);
+  void TreeBarrier(const std::string& barrier_name, int32_t barrier_num, int64_t fan_out);
 };
 
 }  // namespace oneflow
@@ -131,26 +131,22 @@ void RpcServer::Init() {
   });
 
   Add([this](CtrlCall<CtrlMethod::kPushKV>* call) {
-    const std::string& k = call->request().key();
-    const std::string& v = call->request().val();
-    CHECK(kv_.emplace(k, v).second);
-
-    auto pending_kv_calls_it = pending_kv_calls_.find(k);
-    if (pending_kv_calls_it != pending_kv_calls_.end()) {
-      for (auto pending_call : pending_kv_calls_it->second) {
-        pending_call->mut_response()->set_val(v);
-        pending_call->SendResponse();
-      }
-      pending_kv_calls_.erase(pending_kv_calls_it);
-    }
+    OnPushKV(call->request().key(), call->request().val());
     call->SendResponse();
     EnqueueRequest<CtrlMethod::kPushKV>();
   });
 
+  Add([this](CtrlCall<CtrlMethod::kMultiPushKV>* call) {
+    for (const auto& kv : call->request().kv()) { OnPushKV(kv.key(), kv.val()); }
+    call->SendResponse();
+    EnqueueRequest<CtrlMethod::kMultiPushKV>();
+  });
+
   Add([this](CtrlCall<CtrlMethod::kClearKV>* call) {
     const std::string& k = call->request().key();
     CHECK_EQ(kv_.erase(k), 1);
     CHECK(pending_kv_calls_.find(k) == pending_kv_calls_.end());
+    CHECK(pending_multi_kv_calls_.find(k) == pending_multi_kv_calls_.end());
     call->SendResponse();
     EnqueueRequest<CtrlMethod::kClearKV>();
   });
@@ -167,6 +163,22 @@ void RpcServer::Init() {
     EnqueueRequest<CtrlMethod::kPullKV>();
   });
 
+  Add([this](CtrlCall<CtrlMethod::kMultiPullKV>* call) {
+    int64_t missing_key_num = 0;
+    for (const std::string& k : call->request().key()) {
+      if (kv_.find(k) == kv_.end()) {
+        pending_multi_kv_calls_[k].push_back(call);
+        missing_key_num += 1;
+      }
+    }
+    if (missing_key_num == 0) {
+      SendMultiPullKVResponse(call);
+    } else {
+      CHECK(multi_kv_call2missing_key_num_.emplace(call, missing_key_num).second);
+    }
+    EnqueueRequest<CtrlMethod::kMultiPullKV>();
+  });
+
   Add([this](CtrlCall<CtrlMethod::kPushActEvent>* call) {
     ActEvent act_event = call->request().act_event();
     call->SendResponse();
@@ -179,6 +191,9 @@ void RpcServer::Init() {
     kv_.clear();
     CHECK(pending_kv_calls_.empty()) << "size(): " << pending_kv_calls_.size()
                                      << ", begin()->key: " << pending_kv_calls_.begin()->first;
+    CHECK(pending_multi_kv_calls_.empty())
+        << "size(): " << pending_multi_kv_calls_.size()
+        << ", begin()->key: " << pending_multi_kv_calls_.begin()->first;
     call->SendResponse();
     EnqueueRequest<CtrlMethod::kClear>();
   });
@@ -198,4 +213,38 @@ void RpcServer::Init() {
   });
 }
 
+void RpcServer::OnPushKV(const std::string& k, const std::string& v) {
+  CHECK(kv_.emplace(k, v).second);
+
+  auto pending_kv_calls_it = pending_kv_calls_.find(k);
+  if (pending_kv_calls_it != pending_kv_calls_.end()) {
+    for (auto pending_call : pending_kv_calls_it->second) {
+      pending_call->mut_response()->set_val(v);
+      pending_call->SendResponse();
+    }
+    pending_kv_calls_.erase(pending_kv_calls_it);
+  }
+
+  auto pending_multi_kv_calls_it = pending_multi_kv_calls_.find(k);
+  if (pending_multi_kv_calls_it != pending_multi_kv_calls_.end()) {
+    for (auto pending_call : pending_multi_kv_calls_it->second) {
+      auto missing_key_num_it = multi_kv_call2missing_key_num_.find(pending_call);
+      CHECK(missing_key_num_it != multi_kv_call2missing_key_num_.end());
+      missing_key_num_it->second -= 1;
+      if (missing_key_num_it->second == 0) {
+        multi_kv_call2missing_key_num_.erase(missing_key_num_it);
+        SendMultiPullKVResponse(pending_call);
+      }
+    }
+    pending_multi_kv_calls_.erase(pending_multi_kv_calls_it);
+  }
+}
+
+void RpcServer::SendMultiPullKVResponse(CtrlCall<CtrlMethod::kMultiPullKV>* call) {
+  for (const std::string& k : call->request().key()) {
+    *call->mut_response()->add_val() = kv_.at(k);
+  }
+  call->SendResponse();
+}
+
 }  // namespace oneflow
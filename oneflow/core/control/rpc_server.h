@@ -66,6 +66,8 @@ class RpcServer {
   }
 
   virtual void OnLoadServer(CtrlCall<CtrlMethod::kLoadServer>* call) = 0;
+  void OnPushKV(const std::string& k, const std::string& v);
+  void SendMultiPullKVResponse(CtrlCall<CtrlMethod::kMultiPullKV>* call);
 
   struct helper {
     helper(RpcServer* s) : s_(s) {}
@@ -91,6 +93,9 @@ class RpcServer {
   // PushKV, ClearKV, PullKV
   HashMap<std::string, std::string> kv_;
   HashMap<std::string, std::list<CtrlCall<CtrlMethod::kPullKV>*>> pending_kv_calls_;
+  // MultiPushKV, MultiPullKV
+  HashMap<std::string, std::list<CtrlCall<CtrlMethod::kMultiPullKV>*>> pending_multi_kv_calls_;
+  HashMap<CtrlCall<CtrlMethod::kMultiPullKV>*, int64_t> multi_kv_call2missing_key_num_;
   // IncreaseCount, EraseCount
   HashMap<std::string, int32_t> count_;
 };
@@ -105,8 +105,8 @@ __global__ void __launch_bounds__(kBlockSize)
                  const PackType<IN, pack_size>*... pack_in, int64_t n_tail, R* tail_r,
                  const IN*... tail_in) {
   auto functor = factory();
-  const int global_tid = blockIdx.x * kBlockSize + threadIdx.x;
-  for (int64_t i = global_tid; i < n_pack; i += blockDim.x * gridDim.x) {
+  const int64_t global_tid = blockIdx.x * kBlockSize + threadIdx.x;
+  for (int64_t i = global_tid; i < n_pack; i += static_cast<int64_t>(blockDim.x) * gridDim.x) {
     pack_r[i] = ApplyPack<pack_size, decltype(functor), R, IN...>(
         functor, (FetchPack<IN, pack_size>(pack_in + i).elem)...);
   }
@@ -122,11 +122,34 @@ struct SimpleFactory {
   FunctorT tpl;
 };
 
+template<int pack_size>
+bool IsAlignedForPack() {
+  return true;
+}
+
+template<int pack_size, typename T, typename... Args>
+bool IsAlignedForPack(const T* ptr, const Args*... others) {
+  return reinterpret_cast<uintptr_t>(ptr) % sizeof(Pack<T, pack_size>) == 0
+         && IsAlignedForPack<pack_size, Args...>(others...);
+}
+
+// Tensor views may start anywhere in their buffers, so pointers that are not aligned for the widest
+// pack fall back to loads of one element.
 template<typename FactoryT, typename R, typename... IN>
 struct GenericLauncher {
   static cudaError_t Launch(FactoryT factory, int64_t n, R* r, const IN*... in,
                             cudaStream_t stream) {
-    constexpr int pack_size = PackSize<R, IN...>();
+    constexpr int max_pack_size = PackSize<R, IN...>();
+    if (IsAlignedForPack<max_pack_size, R, IN...>(r, in...)) {
+      return LaunchKernel<max_pack_size>(factory, n, r, in..., stream);
+    } else {
+      return LaunchKernel<1>(factory, n, r, in..., stream);
+    }
+  }
+
+  template<int pack_size>
+  static cudaError_t LaunchKernel(FactoryT factory, int64_t n, R* r, const IN*... in,
+                                  cudaStream_t stream) {
     const int64_t n_pack = n / pack_size;
     const int64_t tail_offset = n_pack * pack_size;
     const int64_t n_tail = n - tail_offset;
@@ -180,6 +203,18 @@ inline cudaError_t Ternary(FunctorT functor, int64_t n, R* r, const A* a, const
   return TernaryWithFactory(SimpleFactory<FunctorT>(functor), n, r, a, b, c, stream);
 }
 
+template<typename FactoryT, typename R, typename... IN>
+inline cudaError_t NAryWithFactory(FactoryT factory, int64_t n, R* r, const IN*... in,
+                                   cudaStream_t stream) {
+  return GenericLauncher<FactoryT, R, IN...>::Launch(factory, n, r, in..., stream);
+}
+
+// r[i] = functor(in_0[i], in_1[i], ...) for any number of inputs.
+template<typename FunctorT, typename R, typename... IN>
+inline cudaError_t NAry(FunctorT functor, int64_t n, R* r, const IN*... in, cudaStream_t stream) {
+  return NAryWithFactory(SimpleFactory<FunctorT>(functor), n, r, in..., stream);
+}
+
 }  // namespace elementwise
 
 }  // namespace cuda
@@ -0,0 +1,643 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_CUDA_LAYER_NORM_H_
+#define ONEFLOW_CORE_CUDA_LAYER_NORM_H_
+
+#include "oneflow/core/cuda/softmax.cuh"
+
+namespace oneflow {
+
+namespace cuda {
+
+namespace layer_norm {
+
+// Row-wise normalization with the same LOAD/STORE extension points as cuda::softmax. LOAD
+// produces the row to be normalized and STORE consumes (x - mean) * inv_variance, so residual
+// adds, affine transforms and masks are fused into the single pass over the row. Rows of at most
+// 1024 columns are kept in registers of one warp, longer rows in shared memory of one block if
+// it fits, otherwise they are read from global memory twice. With rms set the mean is taken as 0,
+// which gives RMSNorm; mean is not written then.
+
+using softmax::BlockAllReduce;
+using softmax::DefaultComputeType;
+using softmax::DirectLoad;
+using softmax::DirectStore;
+using softmax::GetNumBlocks;
+using softmax::kWarpSize;
+using softmax::Pack;
+using softmax::PackType;
+using softmax::SumOp;
+using softmax::WarpAllReduce;
+
+template<typename T>
+__inline__ __device__ T Rsqrt(T x);
+
+template<>
+__inline__ __device__ float Rsqrt<float>(float x) {
+  return rsqrtf(x);
+}
+
+template<>
+__inline__ __device__ double Rsqrt<double>(double x) {
+  return rsqrt(x);
+}
+
+template<typename LOAD, typename STORE, typename ComputeType, int pack_size, int cols_per_thread,
+         int thread_group_width, bool padding, bool rms>
+__global__ void LayerNormWarpImpl(LOAD load, STORE store, const int64_t rows, const int64_t cols,
+                                  const double epsilon, ComputeType* mean,
+                                  ComputeType* inv_variance) {
+  static_assert(cols_per_thread % pack_size == 0, "");
+  static_assert(thread_group_width <= kWarpSize, "");
+  static_assert(kWarpSize % thread_group_width == 0, "");
+  constexpr int num_packs = cols_per_thread / pack_size;
+  assert(cols <= cols_per_thread * thread_group_width);
+  ComputeType buf[cols_per_thread];
+  const int64_t global_thread_group_id = blockIdx.x * blockDim.y + threadIdx.y;
+  const int64_t num_global_thread_group = gridDim.x * blockDim.y;
+  const int lane_id = threadIdx.x;
+  const ComputeType inv_cols = static_cast<ComputeType>(1) / static_cast<ComputeType>(cols);
+  for (int64_t row = global_thread_group_id; row < rows; row += num_global_thread_group) {
+    ComputeType thread_sum = 0;
+#pragma unroll
+    for (int pack_id = 0; pack_id < num_packs; ++pack_id) {
+      const int col = (pack_id * thread_group_width + lane_id) * pack_size;
+      ComputeType* pack = buf + pack_id * pack_size;
+      if (!padding || col < cols) {
+        load.template load<pack_size>(pack, row, col);
+#pragma unroll
+        for (int i = 0; i < pack_size; ++i) { thread_sum += pack[i]; }
+      } else {
+#pragma unroll
+        for (int i = 0; i < pack_size; ++i) { pack[i] = 0; }
+      }
+    }
+    const ComputeType row_mean =
+        rms ? 0 : WarpAllReduce<SumOp, ComputeType, thread_group_width>(thread_sum) * inv_cols;
+    ComputeType thread_square_sum = 0;
+#pragma unroll
+    for (int pack_id = 0; pack_id < num_packs; ++pack_id) {
+      const int col = (pack_id * thread_group_width + lane_id) * pack_size;
+      if (!padding || col < cols) {
+#pragma unroll
+        for (int i = 0; i < pack_size; ++i) {
+          const ComputeType diff = buf[pack_id * pack_size + i] - row_mean;
+          thread_square_sum += diff * diff;
+        }
+      }
+    }
+    const ComputeType row_variance =
+        WarpAllReduce<SumOp, ComputeType, thread_group_width>(thread_square_sum) * inv_cols;
+    const ComputeType row_inv_var = Rsqrt(row_variance + static_cast<ComputeType>(epsilon));
+    if (lane_id == 0) {
+      if (!rms) { mean[row] = row_mean; }
+      inv_variance[row] = row_inv_var;
+    }
+#pragma unroll
+    for (int pack_id = 0; pack_id < num_packs; ++pack_id) {
+      const int col = (pack_id * thread_group_width + lane_id) * pack_size;
+      if (!padding || col < cols) {
+        ComputeType* pack = buf + pack_id * pack_size;
+#pragma unroll
+        for (int i = 0; i < pack_size; ++i) { pack[i] = (pack[i] - row_mean) * row_inv_var; }
+        store.template store<pack_size>(pack, row, col);
+      }
+    }
+  }
+}
+
+template<typename LOAD, typename STORE, typename ComputeType, int pack_size, int cols_per_thread,
+         int thread_group_width, bool padding, bool rms>
+inline void LaunchLayerNormWarpImpl(cudaStream_t stream, LOAD load, STORE store,
+                                    const int64_t rows, const int64_t cols, const double epsilon,
+                                    ComputeType* mean, ComputeType* inv_variance) {
+  constexpr int block_size = 128;
+  constexpr int waves = 32;
+  static_assert(block_size % thread_group_width == 0, "");
+  constexpr int rows_per_block = block_size / thread_group_width;
+  dim3 block_dim(thread_group_width, rows_per_block);
+  const int64_t num_blocks = (rows + rows_per_block - 1) / rows_per_block;
+  const int grid_dim_x = GetNumBlocks(block_size, num_blocks, waves);
+  LayerNormWarpImpl<LOAD, STORE, ComputeType, pack_size, cols_per_thread, thread_group_width,
+                    padding, rms><<<grid_dim_x, block_dim, 0, stream>>>(load, store, rows, cols,
+                                                                        epsilon, mean,
+                                                                        inv_variance);
+}
+
+template<typename LOAD, typename STORE, typename ComputeType, int pack_size, int cols_per_thread,
+         int thread_group_width, bool rms>
+inline void DispatchLayerNormWarpImplPadding(cudaStream_t stream, LOAD load, STORE store,
+                                             const int64_t rows, const int64_t cols,
+                                             const double epsilon, ComputeType* mean,
+                                             ComputeType* inv_variance) {
+  if (cols == cols_per_thread * thread_group_width) {
+    LaunchLayerNormWarpImpl<LOAD, STORE, ComputeType, pack_size, cols_per_thread,
+                            thread_group_width, false, rms>(stream, load, store, rows, cols,
+                                                            epsilon, mean, inv_variance);
+  } else {
+    LaunchLayerNormWarpImpl<LOAD, STORE, ComputeType, pack_size, cols_per_thread,
+                            thread_group_width, true, rms>(stream, load, store, rows, cols,
+                                                           epsilon, mean, inv_variance);
+  }
+}
+
+template<typename LOAD, typename STORE, typename ComputeType, int pack_size, bool rms>
+inline void DispatchLayerNormWarpImplCols(cudaStream_t stream, LOAD load, STORE store,
+                                          const int64_t rows, const int64_t cols,
+                                          const double epsilon, ComputeType* mean,
+                                          ComputeType* inv_variance) {
+  if (cols <= 0) { UNIMPLEMENTED(); }
+#define DEFINE_ONE_ELIF(thread_group_width)                                                    \
+  else if (cols <= (thread_group_width)*pack_size) {                                           \
+    DispatchLayerNormWarpImplPadding<LOAD, STORE, ComputeType, pack_size, pack_size,           \
+                                     thread_group_width, rms>(stream, load, store, rows, cols, \
+                                                              epsilon, mean, inv_variance);    \
+  }
+  DEFINE_ONE_ELIF(1)
+  DEFINE_ONE_ELIF(2)
+  DEFINE_ONE_ELIF(4)
+  DEFINE_ONE_ELIF(8)
+  DEFINE_ONE_ELIF(16)
+  DEFINE_ONE_ELIF(32)
+#undef DEFINE_ONE_ELIF
+#define DEFINE_ONE_ELIF(col)                                                                  \
+  else if (cols <= (col)*kWarpSize) {                                                         \
+    DispatchLayerNormWarpImplPadding<LOAD, STORE, ComputeType, pack_size, col, kWarpSize, rms>( \
+        stream, load, store, rows, cols, epsilon, mean, inv_variance);                        \
+  }
+  DEFINE_ONE_ELIF(2)
+  DEFINE_ONE_ELIF(4)
+  DEFINE_ONE_ELIF(8)
+  DEFINE_ONE_ELIF(12)
+  DEFINE_ONE_ELIF(16)
+  DEFINE_ONE_ELIF(20)
+  DEFINE_ONE_ELIF(24)
+  DEFINE_ONE_ELIF(28)
+  DEFINE_ONE_ELIF(32)
+#undef DEFINE_ONE_ELIF
+  else {
+    UNIMPLEMENTED();
+  }
+}
+
+template<typename LOAD, typename STORE, typename ComputeType, bool rms>
+inline void DispatchLayerNormWarpImpl(cudaStream_t stream, LOAD load, STORE store,
+                                      const int64_t rows, const int64_t cols,
+                                      const double epsilon, ComputeType* mean,
+                                      ComputeType* inv_variance) {
+  if (cols % 2 == 0) {
+    DispatchLayerNormWarpImplCols<LOAD, STORE, ComputeType, 2, rms>(stream, load, store, rows,
+                                                                    cols, epsilon, mean,
+                                                                    inv_variance);
+  } else {
+    DispatchLayerNormWarpImplCols<LOAD, STORE, ComputeType, 1, rms>(stream, load, store, rows,
+                                                                    cols, epsilon, mean,
+                                                                    inv_variance);
+  }
+}
+
+template<typename LOAD, typename STORE, typename ComputeType, int pack_size, int block_size,
+         bool rms>
+__global__ void LayerNormBlockSMemImpl(LOAD load, STORE store, const int64_t rows,
+                                       const int64_t cols, const double epsilon,
+                                       ComputeType* mean, ComputeType* inv_variance) {
+  extern __shared__ __align__(sizeof(double)) unsigned char shared_buf[];
+  auto* buf = reinterpret_cast<ComputeType*>(shared_buf);
+  const int tid = threadIdx.x;
+  assert(cols % pack_size == 0);
+  const int num_packs = cols / pack_size;
+  const ComputeType inv_cols = static_cast<ComputeType>(1) / static_cast<ComputeType>(cols);
+  for (int64_t row = blockIdx.x; row < rows; row += gridDim.x) {
+    ComputeType thread_sum = 0;
+    for (int pack_id = tid; pack_id < num_packs; pack_id += block_size) {
+      ComputeType pack[pack_size];
+      load.template load<pack_size>(pack, row, pack_id * pack_size);
+#pragma unroll
+      for (int i = 0; i < pack_size; ++i) {
+        buf[i * num_packs + pack_id] = pack[i];
+        thread_sum += pack[i];
+      }
+    }
+    const ComputeType row_mean =
+        rms ? 0 : BlockAllReduce<SumOp, ComputeType, block_size>(thread_sum) * inv_cols;
+    // Every thread only revisits the packs it loaded, so no barrier is needed for buf.
+    ComputeType thread_square_sum = 0;
+    for (int pack_id = tid; pack_id < num_packs; pack_id += block_size) {
+#pragma unroll
+      for (int i = 0; i < pack_size; ++i) {
+        const ComputeType diff = buf[i * num_packs + pack_id] - row_mean;
+        thread_square_sum += diff * diff;
+      }
+    }
+    const ComputeType row_variance =
+        BlockAllReduce<SumOp, ComputeType, block_size>(thread_square_sum) * inv_cols;
+    const ComputeType row_inv_var = Rsqrt(row_variance + static_cast<ComputeType>(epsilon));
+    if (tid == 0) {
+      if (!rms) { mean[row] = row_mean; }
+      inv_variance[row] = row_inv_var;
+    }
+    for (int pack_id = tid; pack_id < num_packs; pack_id += block_size) {
+      ComputeType pack[pack_size];
+#pragma unroll
+      for (int i = 0; i < pack_size; ++i) {
+        pack[i] = (buf[i * num_packs + pack_id] - row_mean) * row_inv_var;
+      }
+      store.template store<pack_size>(pack, row, pack_id * pack_size);
+    }
+  }
+}
+
+template<typename LOAD, typename STORE, typename ComputeType, int pack_size, int block_size,
+         bool rms>
+inline void LaunchLayerNormBlockSMemImpl(cudaStream_t stream, LOAD load, STORE store, int smem,
+                                         const int64_t rows, const int64_t cols,
+                                         const double epsilon, ComputeType* mean,
+                                         ComputeType* inv_variance) {
+  constexpr int waves = 32;
+  const int grid_dim_x = GetNumBlocks(block_size, rows, waves);
+  LayerNormBlockSMemImpl<LOAD, STORE, ComputeType, pack_size, block_size, rms>
+      <<<grid_dim_x, block_size, smem, stream>>>(load, store, rows, cols, epsilon, mean,
+                                                 inv_variance);
+}
+
+template<typename LOAD, typename STORE, typename ComputeType, int pack_size, bool rms>
+inline bool TryDispatchLayerNormBlockSMemImplBlockSize(cudaStream_t stream, LOAD load,
+                                                       STORE store, const int64_t rows,
+                                                       const int64_t cols, const double epsilon,
+                                                       ComputeType* mean,
+                                                       ComputeType* inv_variance) {
+  constexpr int block_size_conf_1 = 128;
+  constexpr int block_size_conf_2 = 256;
+  constexpr int block_size_conf_3 = 512;
+  constexpr int block_size_conf_4 = 1024;
+  const size_t smem = cols * sizeof(ComputeType);
+  int max_active_blocks_conf_1;
+  OF_CUDA_CHECK(cudaOccupancyMaxActiveBlocksPerMultiprocessor(
+      &max_active_blocks_conf_1,
+      LayerNormBlockSMemImpl<LOAD, STORE, ComputeType, pack_size, block_size_conf_1, rms>,
+      block_size_conf_1, smem));
+  if (max_active_blocks_conf_1 <= 0) { return false; }
+#define TRY_ONE_BLOCK_SIZE(block_size_conf)                                                  \
+  {                                                                                          \
+    int max_active_blocks;                                                                   \
+    OF_CUDA_CHECK(cudaOccupancyMaxActiveBlocksPerMultiprocessor(                             \
+        &max_active_blocks,                                                                  \
+        LayerNormBlockSMemImpl<LOAD, STORE, ComputeType, pack_size, block_size_conf, rms>,   \
+        block_size_conf, smem));                                                             \
+    if (max_active_blocks == max_active_blocks_conf_1) {                                     \
+      LaunchLayerNormBlockSMemImpl<LOAD, STORE, ComputeType, pack_size, block_size_conf, rms>( \
+          stream, load, store, smem, rows, cols, epsilon, mean, inv_variance);               \
+      return true;                                                                           \
+    }                                                                                        \
+  }
+  TRY_ONE_BLOCK_SIZE(block_size_conf_4)
+  TRY_ONE_BLOCK_SIZE(block_size_conf_3)
+  TRY_ONE_BLOCK_SIZE(block_size_conf_2)
+#undef TRY_ONE_BLOCK_SIZE
+  LaunchLayerNormBlockSMemImpl<LOAD, STORE, ComputeType, pack_size, block_size_conf_1, rms>(
+      stream, load, store, smem, rows, cols, epsilon, mean, inv_variance);
+  return true;
+}
+
+template<typename LOAD, typename STORE, typename ComputeType, bool rms>
+inline bool TryDispatchLayerNormBlockSMemImpl(cudaStream_t stream, LOAD load, STORE store,
+                                              const int64_t rows, const int64_t cols,
+                                              const double epsilon, ComputeType* mean,
+                                              ComputeType* inv_variance) {
+  if (cols % 2 == 0) {
+    return TryDispatchLayerNormBlockSMemImplBlockSize<LOAD, STORE, ComputeType, 2, rms>(
+        stream, load, store, rows, cols, epsilon, mean, inv_variance);
+  } else {
+    return TryDispatchLayerNormBlockSMemImplBlockSize<LOAD, STORE, ComputeType, 1, rms>(
+        stream, load, store, rows, cols, epsilon, mean, inv_variance);
+  }
+}
+
+template<typename LOAD, typename STORE, typename ComputeType, int pack_size, int block_size,
+         bool rms>
+__global__ void LayerNormBlockUncachedImpl(LOAD load, STORE store, const int64_t rows,
+                                           const int64_t cols, const double epsilon,
+                                           ComputeType* mean, ComputeType* inv_variance) {
+  const int tid = threadIdx.x;
+  assert(cols % pack_size == 0);
+  const int num_packs = cols / pack_size;
+  const ComputeType inv_cols = static_cast<ComputeType>(1) / static_cast<ComputeType>(cols);
+  for (int64_t row = blockIdx.x; row < rows; row += gridDim.x) {
+    ComputeType thread_sum = 0;
+    ComputeType thread_square_sum = 0;
+    for (int pack_id = tid; pack_id < num_packs; pack_id += block_size) {
+      ComputeType pack[pack_size];
+      load.template load<pack_size>(pack, row, pack_id * pack_size);
+#pragma unroll
+      for (int i = 0; i < pack_size; ++i) {
+        thread_sum += pack[i];
+        thread_square_sum += pack[i] * pack[i];
+      }
+    }
+    const ComputeType row_mean =
+        rms ? 0 : BlockAllReduce<SumOp, ComputeType, block_size>(thread_sum) * inv_cols;
+    const ComputeType row_square_mean =
+        BlockAllReduce<SumOp, ComputeType, block_size>(thread_square_sum) * inv_cols;
+    const ComputeType row_variance =
+        max(row_square_mean - row_mean * row_mean, static_cast<ComputeType>(0));
+    const ComputeType row_inv_var = Rsqrt(row_variance + static_cast<ComputeType>(epsilon));
+    if (tid == 0) {
+      if (!rms) { mean[row] = row_mean; }
+      inv_variance[row] = row_inv_var;
+    }
+    for (int pack_id = tid; pack_id < num_packs; pack_id += block_size) {
+      ComputeType pack[pack_size];
+      load.template load<pack_size>(pack, row, pack_id * pack_size);
+#pragma unroll
+      for (int i = 0; i < pack_size; ++i) { pack[i] = (pack[i] - row_mean) * row_inv_var; }
+      store.template store<pack_size>(pack, row, pack_id * pack_size);
+    }
+  }
+}
+
+template<typename LOAD, typename STORE, typename ComputeType, bool rms>
+inline void DispatchLayerNormBlockUncachedImpl(cudaStream_t stream, LOAD load, STORE store,
+                                               const int64_t rows, const int64_t cols,
+                                               const double epsilon, ComputeType* mean,
+                                               ComputeType* inv_variance) {
+  constexpr int block_size = 1024;
+  constexpr int waves = 32;
+  const int grid_dim_x = GetNumBlocks(block_size, rows, waves);
+  if (cols % 2 == 0) {
+    LayerNormBlockUncachedImpl<LOAD, STORE, ComputeType, 2, block_size, rms>
+        <<<grid_dim_x, block_size, 0, stream>>>(load, store, rows, cols, epsilon, mean,
+                                                inv_variance);
+  } else {
+    LayerNormBlockUncachedImpl<LOAD, STORE, ComputeType, 1, block_size, rms>
+        <<<grid_dim_x, block_size, 0, stream>>>(load, store, rows, cols, epsilon, mean,
+                                                inv_variance);
+  }
+}
+
+template<typename LOAD, typename STORE, typename ComputeType, bool rms>
+inline void DispatchNorm(cudaStream_t stream, LOAD load, STORE store, const int64_t rows,
+                         const int64_t cols, const double epsilon, ComputeType* mean,
+                         ComputeType* inv_variance) {
+  if (cols <= 1024) {
+    DispatchLayerNormWarpImpl<LOAD, STORE, ComputeType, rms>(stream, load, store, rows, cols,
+                                                             epsilon, mean, inv_variance);
+  } else if (!TryDispatchLayerNormBlockSMemImpl<LOAD, STORE, ComputeType, rms>(
+                 stream, load, store, rows, cols, epsilon, mean, inv_variance)) {
+    DispatchLayerNormBlockUncachedImpl<LOAD, STORE, ComputeType, rms>(
+        stream, load, store, rows, cols, epsilon, mean, inv_variance);
+  }
+}
+
+template<typename LOAD, typename STORE, typename ComputeType>
+inline void DispatchLayerNorm(cudaStream_t stream, LOAD load, STORE store, const int64_t rows,
+                              const int64_t cols, const double epsilon, ComputeType* mean,
+                              ComputeType* inv_variance) {
+  DispatchNorm<LOAD, STORE, ComputeType, false>(stream, load, store, rows, cols, epsilon, mean,
+                                                inv_variance);
+}
+
+template<typename LOAD, typename STORE, typename ComputeType>
+inline void DispatchRmsNorm(cudaStream_t stream, LOAD load, STORE store, const int64_t rows,
+                            const int64_t cols, const double epsilon, ComputeType* inv_rms) {
+  DispatchNorm<LOAD, STORE, ComputeType, true>(stream, load, store, rows, cols, epsilon, nullptr,
+                                               inv_rms);
+}
+
+// dx = inv_variance * (dy - mean(dy) - x_hat * mean(dy * x_hat)), x_hat = (x - mean) *
+// inv_variance. LOAD_DY may fold gamma into dy. Without the mean term for rms.
+template<typename LOAD_X, typename LOAD_DY, typename STORE, typename ComputeType, int pack_size,
+         int cols_per_thread, int thread_group_width, bool padding, bool rms>
+__global__ void LayerNormGradWarpImpl(LOAD_X load_x, LOAD_DY load_dy, STORE store,
+                                      const ComputeType* mean, const ComputeType* inv_variance,
+                                      const int64_t rows, const int64_t cols) {
+  static_assert(cols_per_thread % pack_size == 0, "");
+  static_assert(thread_group_width <= kWarpSize, "");
+  static_assert(kWarpSize % thread_group_width == 0, "");
+  constexpr int num_packs = cols_per_thread / pack_size;
+  assert(cols <= cols_per_thread * thread_group_width);
+  ComputeType x_buf[cols_per_thread];
+  ComputeType dy_buf[cols_per_thread];
+  const int64_t global_thread_group_id = blockIdx.x * blockDim.y + threadIdx.y;
+  const int64_t num_global_thread_group = gridDim.x * blockDim.y;
+  const int lane_id = threadIdx.x;
+  const ComputeType inv_cols = static_cast<ComputeType>(1) / static_cast<ComputeType>(cols);
+  for (int64_t row = global_thread_group_id; row < rows; row += num_global_thread_group) {
+    const ComputeType row_mean = rms ? 0 : mean[row];
+    const ComputeType row_inv_var = inv_variance[row];
+    ComputeType thread_sum_dy = 0;
+    ComputeType thread_sum_dy_x_hat = 0;
+#pragma unroll
+    for (int pack_id = 0; pack_id < num_packs; ++pack_id) {
+      const int col = (pack_id * thread_group_width + lane_id) * pack_size;
+      ComputeType* x_pack = x_buf + pack_id * pack_size;
+      ComputeType* dy_pack = dy_buf + pack_id * pack_size;
+      if (!padding || col < cols) {
+        load_x.template load<pack_size>(x_pack, row, col);
+        load_dy.template load<pack_size>(dy_pack, row, col);
+#pragma unroll
+        for (int i = 0; i < pack_size; ++i) {
+          x_pack[i] = (x_pack[i] - row_mean) * row_inv_var;
+          thread_sum_dy += dy_pack[i];
+          thread_sum_dy_x_hat += dy_pack[i] * x_pack[i];
+        }
+      }
+    }
+    const ComputeType row_mean_dy =
+        rms ? 0 : WarpAllReduce<SumOp, ComputeType, thread_group_width>(thread_sum_dy) * inv_cols;
+    const ComputeType row_mean_dy_x_hat =
+        WarpAllReduce<SumOp, ComputeType, thread_group_width>(thread_sum_dy_x_hat) * inv_cols;
+#pragma unroll
+    for (int pack_id = 0; pack_id < num_packs; ++pack_id) {
+      const int col = (pack_id * thread_group_width + lane_id) * pack_size;
+      if (!padding || col < cols) {
+        ComputeType* x_pack = x_buf + pack_id * pack_size;
+        ComputeType* dy_pack = dy_buf + pack_id * pack_size;
+#pragma unroll
+        for (int i = 0; i < pack_size; ++i) {
+          dy_pack[i] =
+              row_inv_var * (dy_pack[i] - row_mean_dy - x_pack[i] * row_mean_dy_x_hat);
+        }
+        store.template store<pack_size>(dy_pack, row, col);
+      }
+    }
+  }
+}
+
+template<typename LOAD_X, typename LOAD_DY, typename STORE, typename ComputeType, int pack_size,
+         int cols_per_thread, int thread_group_width, bool rms>
+inline void DispatchLayerNormGradWarpImplPadding(cudaStream_t stream, LOAD_X load_x,
+                                                 LOAD_DY load_dy, STORE store,
+                                                 const ComputeType* mean,
+                                                 const ComputeType* inv_variance,
+                                                 const int64_t rows, const int64_t cols) {
+  constexpr int block_size = 128;
+  constexpr int waves = 32;
+  static_assert(block_size % thread_group_width == 0, "");
+  constexpr int rows_per_block = block_size / thread_group_width;
+  dim3 block_dim(thread_group_width, rows_per_block);
+  const int64_t num_blocks = (rows + rows_per_block - 1) / rows_per_block;
+  const int grid_dim_x = GetNumBlocks(block_size, num_blocks, waves);
+  if (cols == cols_per_thread * thread_group_width) {
+    LayerNormGradWarpImpl<LOAD_X, LOAD_DY, STORE, ComputeType, pack_size, cols_per_thread,
+                          thread_group_width, false, rms>
+        <<<grid_dim_x, block_dim, 0, stream>>>(load_x, load_dy, store, mean, inv_variance, rows,
+                                               cols);
+  } else {
+    LayerNormGradWarpImpl<LOAD_X, LOAD_DY, STORE, ComputeType, pack_size, cols_per_thread,
+                          thread_group_width, true, rms>
+        <<<grid_dim_x, block_dim, 0, stream>>>(load_x, load_dy, store, mean, inv_variance, rows,
+                                               cols);
+  }
+}
+
+template<typename LOAD_X, typename LOAD_DY, typename STORE, typename ComputeType, int pack_size,
+         bool rms>
+inline void DispatchLayerNormGradWarpImplCols(cudaStream_t stream, LOAD_X load_x, LOAD_DY load_dy,
+                                              STORE store, const ComputeType* mean,
+                                              const ComputeType* inv_variance, const int64_t rows,
+                                              const int64_t cols) {
+  if (cols <= 0) { UNIMPLEMENTED(); }
+#define DEFINE_ONE_ELIF(thread_group_width)                                                   \
+  else if (cols <= (thread_group_width)*pack_size) {                                          \
+    DispatchLayerNormGradWarpImplPadding<LOAD_X, LOAD_DY, STORE, ComputeType, pack_size,      \
+                                         pack_size, thread_group_width, rms>(                 \
+        stream, load_x, load_dy, store, mean, inv_variance, rows, cols);                      \
+  }
+  DEFINE_ONE_ELIF(1)
+  DEFINE_ONE_ELIF(2)
+  DEFINE_ONE_ELIF(4)
+  DEFINE_ONE_ELIF(8)
+  DEFINE_ONE_ELIF(16)
+  DEFINE_ONE_ELIF(32)
+#undef DEFINE_ONE_ELIF
+#define DEFINE_ONE_ELIF(col)                                                                  \
+  else if (cols <= (col)*kWarpSize) {                                                         \
+    DispatchLayerNormGradWarpImplPadding<LOAD_X, LOAD_DY, STORE, ComputeType, pack_size, col, \
+                                         kWarpSize, rms>(stream, load_x, load_dy, store,      \
+                                                         mean, inv_variance, rows, cols);     \
+  }
+  DEFINE_ONE_ELIF(2)
+  DEFINE_ONE_ELIF(4)
+  DEFINE_ONE_ELIF(8)
+  DEFINE_ONE_ELIF(12)
+  DEFINE_ONE_ELIF(16)
+  DEFINE_ONE_ELIF(20)
+  DEFINE_ONE_ELIF(24)
+  DEFINE_ONE_ELIF(28)
+  DEFINE_ONE_ELIF(32)
+#undef DEFINE_ONE_ELIF
+  else {
+    UNIMPLEMENTED();
+  }
+}
+
+template<typename LOAD_X, typename LOAD_DY, typename STORE, typename ComputeType, int pack_size,
+         int block_size, bool rms>
+__global__ void LayerNormGradBlockUncachedImpl(LOAD_X load_x, LOAD_DY load_dy, STORE store,
+                                               const ComputeType* mean,
+                                               const ComputeType* inv_variance,
+                                               const int64_t rows, const int64_t cols) {
+  const int tid = threadIdx.x;
+  assert(cols % pack_size == 0);
+  const int num_packs = cols / pack_size;
+  const ComputeType inv_cols = static_cast<ComputeType>(1) / static_cast<ComputeType>(cols);
+  for (int64_t row = blockIdx.x; row < rows; row += gridDim.x) {
+    const ComputeType row_mean = rms ? 0 : mean[row];
+    const ComputeType row_inv_var = inv_variance[row];
+    ComputeType thread_sum_dy = 0;
+    ComputeType thread_sum_dy_x_hat = 0;
+    for (int pack_id = tid; pack_id < num_packs; pack_id += block_size) {
+      ComputeType x_pack[pack_size];
+      ComputeType dy_pack[pack_size];
+      load_x.template load<pack_size>(x_pack, row, pack_id * pack_size);
+      load_dy.template load<pack_size>(dy_pack, row, pack_id * pack_size);
+#pragma unroll
+      for (int i = 0; i < pack_size; ++i) {
+        thread_sum_dy += dy_pack[i];
+        thread_sum_dy_x_hat += dy_pack[i] * (x_pack[i] - row_mean) * row_inv_var;
+      }
+    }
+    const ComputeType row_mean_dy =
+        rms ? 0 : BlockAllReduce<SumOp, ComputeType, block_size>(thread_sum_dy) * inv_cols;
+    const ComputeType row_mean_dy_x_hat =
+        BlockAllReduce<SumOp, ComputeType, block_size>(thread_sum_dy_x_hat) * inv_cols;
+    for (int pack_id = tid; pack_id < num_packs; pack_id += block_size) {
+      ComputeType x_pack[pack_size];
+      ComputeType dy_pack[pack_size];
+      load_x.template load<pack_size>(x_pack, row, pack_id * pack_size);
+      load_dy.template load<pack_size>(dy_pack, row, pack_id * pack_size);
+#pragma unroll
+      for (int i = 0; i < pack_size; ++i) {
+        const ComputeType x_hat = (x_pack[i] - row_mean) * row_inv_var;
+        dy_pack[i] = row_inv_var * (dy_pack[i] - row_mean_dy - x_hat * row_mean_dy_x_hat);
+      }
+      store.template store<pack_size>(dy_pack, row, pack_id * pack_size);
+    }
+  }
+}
+
+template<typename LOAD_X, typename LOAD_DY, typename STORE, typename ComputeType, bool rms>
+inline void DispatchNormGrad(cudaStream_t stream, LOAD_X load_x, LOAD_DY load_dy, STORE store,
+                             const ComputeType* mean, const ComputeType* inv_variance,
+                             const int64_t rows, const int64_t cols) {
+  if (cols <= 1024) {
+    if (cols % 2 == 0) {
+      DispatchLayerNormGradWarpImplCols<LOAD_X, LOAD_DY, STORE, ComputeType, 2, rms>(
+          stream, load_x, load_dy, store, mean, inv_variance, rows, cols);
+    } else {
+      DispatchLayerNormGradWarpImplCols<LOAD_X, LOAD_DY, STORE, ComputeType, 1, rms>(
+          stream, load_x, load_dy, store, mean, inv_variance, rows, cols);
+    }
+  } else {
+    constexpr int block_size = 1024;
+    constexpr int waves = 32;
+    const int grid_dim_x = GetNumBlocks(block_size, rows, waves);
+    if (cols % 2 == 0) {
+      LayerNormGradBlockUncachedImpl<LOAD_X, LOAD_DY, STORE, ComputeType, 2, block_size, rms>
+          <<<grid_dim_x, block_size, 0, stream>>>(load_x, load_dy, store, mean, inv_variance,
+                                                  rows, cols);
+    } else {
+      LayerNormGradBlockUncachedImpl<LOAD_X, LOAD_DY, STORE, ComputeType, 1, block_size, rms>
+          <<<grid_dim_x, block_size, 0, stream>>>(load_x, load_dy, store, mean, inv_variance,
+                                                  rows, cols);
+    }
+  }
+}
+
+template<typename LOAD_X, typename LOAD_DY, typename STORE, typename ComputeType>
+inline void DispatchLayerNormGrad(cudaStream_t stream, LOAD_X load_x, LOAD_DY load_dy,
+                                  STORE store, const ComputeType* mean,
+                                  const ComputeType* inv_variance, const int64_t rows,
+                                  const int64_t cols) {
+  DispatchNormGrad<LOAD_X, LOAD_DY, STORE, ComputeType, false>(stream, load_x, load_dy, store,
+                                                               mean, inv_variance, rows, cols);
+}
+
+template<typename LOAD_X, typename LOAD_DY, typename STORE, typename ComputeType>
+inline void DispatchRmsNormGrad(cudaStream_t stream, LOAD_X load_x, LOAD_DY load_dy, STORE store,
+                                const ComputeType* inv_rms, const int64_t rows,
+                                const int64_t cols) {
+  DispatchNormGrad<LOAD_X, LOAD_DY, STORE, ComputeType, true>(stream, load_x, load_dy, store,
+                                                              nullptr, inv_rms, rows, cols);
+}
+
+}  // namespace layer_norm
+
+}  // namespace cuda
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_CUDA_LAYER_NORM_H_
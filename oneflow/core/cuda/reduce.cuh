@@ -0,0 +1,275 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_CUDA_REDUCE_H_
+#define ONEFLOW_CORE_CUDA_REDUCE_H_
+
+#include <cub/cub.cuh>
+#include <cuda_runtime.h>
+#include <cstdint>
+#include <algorithm>
+#include <limits>
+
+namespace oneflow {
+
+namespace cuda {
+
+namespace reduce {
+
+// Reduces in(outer, reduce, inner) to out(outer, inner) in one pass over in:
+//   out[o][i] = post_op(reduce_op(pre_op(in[o][0][i]), ..., pre_op(in[o][reduce - 1][i])))
+// pre_op maps an input element to the accumulator type, e.g. square or abs, and post_op maps the
+// accumulator to the output, e.g. mean or sqrt. Rows (inner == 1) are reduced by a warp when they
+// are short and by a block otherwise, columns (inner > 1) by a tile of threads that walks the
+// reduce axis with coalesced loads. When that leaves too few blocks to fill the device, the
+// reduce axis is split into chunks whose partial results go to tmp and are reduced by a second
+// pass, the order of every reduction is fixed so the result is deterministic.
+
+constexpr int kWarpSize = 32;
+constexpr int kBlockSize = 256;
+constexpr int kColTileWidth = kWarpSize;
+constexpr int kColTileHeight = kBlockSize / kColTileWidth;
+constexpr int64_t kMaxWarpRowSize = 1024;
+constexpr int64_t kMinChunkSize = 1024;
+constexpr int64_t kMaxNumChunks = 1024;
+constexpr int kMaxGridDimY = 65535;
+
+template<typename T>
+struct IdentityOp {
+  __device__ __forceinline__ T operator()(const T& x) const { return x; }
+};
+
+template<typename T, typename Acc>
+struct SquareOp {
+  __device__ __forceinline__ Acc operator()(const T& x) const {
+    const Acc acc = static_cast<Acc>(x);
+    return acc * acc;
+  }
+};
+
+template<typename T, typename Acc>
+struct AbsOp {
+  __device__ __forceinline__ Acc operator()(const T& x) const {
+    const Acc acc = static_cast<Acc>(x);
+    return acc < static_cast<Acc>(0) ? -acc : acc;
+  }
+};
+
+template<typename T, typename Acc>
+struct NotFiniteOp {
+  __device__ __forceinline__ Acc operator()(const T& x) const {
+    return isfinite(x) ? static_cast<Acc>(0) : static_cast<Acc>(1);
+  }
+};
+
+template<typename Acc, typename U>
+struct MeanOp {
+  explicit MeanOp(int64_t count) : scale(static_cast<Acc>(1.0 / static_cast<double>(count))) {}
+  __device__ __forceinline__ U operator()(const Acc& acc) const {
+    return static_cast<U>(acc * scale);
+  }
+  Acc scale;
+};
+
+template<typename Acc, typename U>
+struct SqrtOp {
+  __device__ __forceinline__ U operator()(const Acc& acc) const {
+    return static_cast<U>(sqrt(acc));
+  }
+};
+
+template<typename T>
+struct SumOp {
+  __device__ __forceinline__ T operator()(const T& a, const T& b) const { return a + b; }
+};
+
+template<typename ReduceOp, typename T>
+__inline__ __device__ T WarpReduce(const ReduceOp& reduce_op, T val) {
+  for (int offset = kWarpSize / 2; offset > 0; offset /= 2) {
+    val = reduce_op(val, __shfl_down_sync(0xffffffff, val, offset));
+  }
+  return val;
+}
+
+template<typename T, typename Acc, typename U, typename PreOp, typename ReduceOp, typename PostOp>
+__global__ void RowReduceByWarp(int64_t outer, int64_t reduce, const T* in, U* out,
+                                PreOp pre_op, ReduceOp reduce_op, Acc unit, PostOp post_op) {
+  const int lane = threadIdx.x % kWarpSize;
+  const int64_t warps_per_grid = static_cast<int64_t>(gridDim.x) * (blockDim.x / kWarpSize);
+  for (int64_t row = (blockIdx.x * blockDim.x + threadIdx.x) / kWarpSize; row < outer;
+       row += warps_per_grid) {
+    const T* row_in = in + row * reduce;
+    Acc acc = unit;
+    for (int64_t j = lane; j < reduce; j += kWarpSize) {
+      acc = reduce_op(acc, pre_op(row_in[j]));
+    }
+    acc = WarpReduce(reduce_op, acc);
+    if (lane == 0) { out[row] = post_op(acc); }
+  }
+}
+
+// blockIdx.x is the chunk of the reduce axis and blockIdx.y strides over rows, partial results of
+// chunk c of row o go to out[o * num_chunks + c].
+template<typename T, typename Acc, typename U, typename PreOp, typename ReduceOp, typename PostOp>
+__global__ void RowReduceByBlock(int64_t outer, int64_t reduce, int64_t chunk_size, const T* in,
+                                 U* out, PreOp pre_op, ReduceOp reduce_op, Acc unit,
+                                 PostOp post_op) {
+  typedef cub::BlockReduce<Acc, kBlockSize> BlockReduce;
+  __shared__ typename BlockReduce::TempStorage temp_storage;
+  const int64_t begin = blockIdx.x * chunk_size;
+  const int64_t end = begin + chunk_size < reduce ? begin + chunk_size : reduce;
+  for (int64_t row = blockIdx.y; row < outer; row += gridDim.y) {
+    const T* row_in = in + row * reduce;
+    Acc acc = unit;
+    for (int64_t j = begin + threadIdx.x; j < end; j += kBlockSize) {
+      acc = reduce_op(acc, pre_op(row_in[j]));
+    }
+    acc = BlockReduce(temp_storage).Reduce(acc, reduce_op);
+    if (threadIdx.x == 0) { out[row * gridDim.x + blockIdx.x] = post_op(acc); }
+    __syncthreads();
+  }
+}
+
+// A (kColTileHeight, kColTileWidth) tile of threads reduces kColTileWidth columns, blockIdx.x is
+// the column tile, blockIdx.y strides over outer and blockIdx.z is the chunk of the reduce axis.
+// Partial results of chunk c go to out[(c * outer + o) * inner + i].
+template<typename T, typename Acc, typename U, typename PreOp, typename ReduceOp, typename PostOp>
+__global__ void ColReduce(int64_t outer, int64_t reduce, int64_t inner, int64_t chunk_size,
+                          const T* in, U* out, PreOp pre_op, ReduceOp reduce_op, Acc unit,
+                          PostOp post_op) {
+  __shared__ Acc partials[kColTileHeight][kColTileWidth + 1];
+  const int tx = threadIdx.x % kColTileWidth;
+  const int ty = threadIdx.x / kColTileWidth;
+  const int64_t col = static_cast<int64_t>(blockIdx.x) * kColTileWidth + tx;
+  const int64_t begin = blockIdx.z * chunk_size;
+  const int64_t end = begin + chunk_size < reduce ? begin + chunk_size : reduce;
+  for (int64_t o = blockIdx.y; o < outer; o += gridDim.y) {
+    Acc acc = unit;
+    if (col < inner) {
+      const T* o_in = in + o * reduce * inner + col;
+      for (int64_t j = begin + ty; j < end; j += kColTileHeight) {
+        acc = reduce_op(acc, pre_op(o_in[j * inner]));
+      }
+    }
+    partials[ty][tx] = acc;
+    __syncthreads();
+    if (ty == 0 && col < inner) {
+#pragma unroll
+      for (int k = 1; k < kColTileHeight; ++k) { acc = reduce_op(acc, partials[k][tx]); }
+      out[(blockIdx.z * outer + o) * inner + col] = post_op(acc);
+    }
+    __syncthreads();
+  }
+}
+
+inline cudaError_t GetNumSms(int* num_sms) {
+  int dev;
+  {
+    cudaError_t err = cudaGetDevice(&dev);
+    if (err != cudaSuccess) { return err; }
+  }
+  return cudaDeviceGetAttribute(num_sms, cudaDevAttrMultiProcessorCount, dev);
+}
+
+// Splits the reduce axis when num_blocks blocks cannot fill the device, bounded by the chunks
+// whose partial results fit into tmp_bytes.
+inline int64_t GetNumChunks(int64_t num_blocks, int64_t reduce, int num_sms, size_t tmp_bytes,
+                            size_t partial_bytes) {
+  const int64_t target_num_blocks = static_cast<int64_t>(num_sms) * 4;
+  if (num_blocks >= target_num_blocks) { return 1; }
+  int64_t num_chunks = (target_num_blocks + num_blocks - 1) / num_blocks;
+  num_chunks = std::min(num_chunks, reduce / kMinChunkSize);
+  num_chunks = std::min<int64_t>(num_chunks, kMaxNumChunks);
+  num_chunks = std::min<int64_t>(num_chunks, tmp_bytes / partial_bytes);
+  return std::max<int64_t>(num_chunks, 1);
+}
+
+// The tmp size that lets OuterReduceInner split the reduce axis as much as it wants to.
+template<typename Acc>
+size_t GetOuterReduceInnerTmpBytes(int64_t outer, int64_t reduce, int64_t inner) {
+  const int64_t num_chunks = std::min(reduce / kMinChunkSize, kMaxNumChunks);
+  if (num_chunks <= 1) { return 0; }
+  return num_chunks * outer * inner * sizeof(Acc);
+}
+
+template<typename T, typename Acc, typename U, typename PreOp, typename ReduceOp, typename PostOp>
+cudaError_t OuterReduceInner(cudaStream_t stream, int64_t outer, int64_t reduce, int64_t inner,
+                             const T* in, U* out, void* tmp, size_t tmp_bytes, PreOp pre_op,
+                             ReduceOp reduce_op, Acc unit, PostOp post_op) {
+  if (outer == 0 || inner == 0) { return cudaSuccess; }
+  int num_sms;
+  {
+    cudaError_t err = GetNumSms(&num_sms);
+    if (err != cudaSuccess) { return err; }
+  }
+  Acc* partials = reinterpret_cast<Acc*>(tmp);
+  if (inner == 1) {
+    if (reduce <= kMaxWarpRowSize) {
+      const int64_t warps_per_block = kBlockSize / kWarpSize;
+      const int num_blocks = std::min<int64_t>((outer + warps_per_block - 1) / warps_per_block,
+                                               static_cast<int64_t>(num_sms) * 32);
+      RowReduceByWarp<T, Acc, U, PreOp, ReduceOp, PostOp>
+          <<<num_blocks, kBlockSize, 0, stream>>>(outer, reduce, in, out, pre_op, reduce_op,
+                                                  unit, post_op);
+      return cudaPeekAtLastError();
+    }
+    const int grid_y = std::min<int64_t>(outer, kMaxGridDimY);
+    const int64_t num_chunks =
+        tmp == nullptr ? 1 : GetNumChunks(grid_y, reduce, num_sms, tmp_bytes, outer * sizeof(Acc));
+    if (num_chunks == 1) {
+      RowReduceByBlock<T, Acc, U, PreOp, ReduceOp, PostOp>
+          <<<dim3(1, grid_y), kBlockSize, 0, stream>>>(outer, reduce, reduce, in, out, pre_op,
+                                                       reduce_op, unit, post_op);
+      return cudaPeekAtLastError();
+    }
+    const int64_t chunk_size = (reduce + num_chunks - 1) / num_chunks;
+    RowReduceByBlock<T, Acc, Acc, PreOp, ReduceOp, IdentityOp<Acc>>
+        <<<dim3(num_chunks, grid_y), kBlockSize, 0, stream>>>(
+            outer, reduce, chunk_size, in, partials, pre_op, reduce_op, unit, IdentityOp<Acc>());
+    // partials is (outer, num_chunks), which is short rows again
+    return OuterReduceInner<Acc, Acc, U, IdentityOp<Acc>, ReduceOp, PostOp>(
+        stream, outer, num_chunks, 1, partials, out, nullptr, 0, IdentityOp<Acc>(), reduce_op,
+        unit, post_op);
+  }
+  const int64_t grid_x = (inner + kColTileWidth - 1) / kColTileWidth;
+  if (grid_x > std::numeric_limits<int32_t>::max()) { return cudaErrorInvalidValue; }
+  const int grid_y = std::min<int64_t>(outer, kMaxGridDimY);
+  const int64_t num_chunks =
+      tmp == nullptr ? 1
+                     : GetNumChunks(grid_x * grid_y, reduce, num_sms, tmp_bytes,
+                                    outer * inner * sizeof(Acc));
+  if (num_chunks == 1) {
+    ColReduce<T, Acc, U, PreOp, ReduceOp, PostOp><<<dim3(grid_x, grid_y), kBlockSize, 0, stream>>>(
+        outer, reduce, inner, reduce, in, out, pre_op, reduce_op, unit, post_op);
+    return cudaPeekAtLastError();
+  }
+  const int64_t chunk_size = (reduce + num_chunks - 1) / num_chunks;
+  ColReduce<T, Acc, Acc, PreOp, ReduceOp, IdentityOp<Acc>>
+      <<<dim3(grid_x, grid_y, num_chunks), kBlockSize, 0, stream>>>(
+          outer, reduce, inner, chunk_size, in, partials, pre_op, reduce_op, unit,
+          IdentityOp<Acc>());
+  // partials is (num_chunks, outer * inner), the column reduce of which has enough columns
+  return OuterReduceInner<Acc, Acc, U, IdentityOp<Acc>, ReduceOp, PostOp>(
+      stream, 1, num_chunks, outer * inner, partials, out, nullptr, 0, IdentityOp<Acc>(),
+      reduce_op, unit, post_op);
+}
+
+}  // namespace reduce
+
+}  // namespace cuda
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_CUDA_REDUCE_H_
@@ -17,6 +17,7 @@ limitations under the License.
 #define ONEFLOW_CORE_CUDA_UNIQUE_H_
 
 #include <cub/cub.cuh>
+#include <type_traits>
 #include <device_launch_parameters.h>
 #include "oneflow/core/common/permutation_iterator.h"
 #include "oneflow/core/common/not_equal_to_previous_adjacent_iterator.h"
@@ -32,6 +33,8 @@ static constexpr Flag kDefault = 0x0;
 static constexpr Flag kInputSorted = 0x1;
 static constexpr Flag kOutputInverseIndices = 0x1 << 1;
 static constexpr Flag kOutputCounts = 0x1 << 2;
+// The unique keys may be written in any order, which allows the hash table path for integral keys
+static constexpr Flag kOutputUnsorted = 0x1 << 3;
 
 namespace {
 
@@ -218,6 +221,141 @@ cudaError_t DispatchInputSorted(Flag flag, size_t n, const Key* in, Key* unique,
   }
 }
 
+// Beyond this the sort path is used, so that slot ids always fit into an int32_t Index
+constexpr size_t kMaxHashUniqueElemCnt = 1 << 28;
+
+template<typename Key>
+bool UseHashTable(Flag flag, size_t n) {
+  return std::is_integral<Key>::value && (flag & kOutputUnsorted) != 0
+         && (flag & kInputSorted) == 0 && n > 0 && n <= kMaxHashUniqueElemCnt;
+}
+
+__device__ __host__ __forceinline__ size_t HashTableCapacity(size_t n) {
+  // Keep the load factor at or below 0.5 so that linear probing stays short
+  size_t capacity = 1;
+  while (capacity < 2 * n) { capacity <<= 1; }
+  return capacity;
+}
+
+template<typename Key>
+__device__ __forceinline__ uint64_t HashKey(Key key) {
+  // fmix64 from MurmurHash3
+  uint64_t h = static_cast<uint64_t>(key);
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+__device__ __forceinline__ int32_t AtomicCAS(int32_t* address, int32_t compare, int32_t val) {
+  return atomicCAS(address, compare, val);
+}
+
+__device__ __forceinline__ int64_t AtomicCAS(int64_t* address, int64_t compare, int64_t val) {
+  return static_cast<int64_t>(atomicCAS(reinterpret_cast<unsigned long long int*>(address),
+                                        static_cast<unsigned long long int>(compare),
+                                        static_cast<unsigned long long int>(val)));
+}
+
+__device__ __forceinline__ int32_t AtomicAdd(int32_t* address, int32_t val) {
+  return atomicAdd(address, val);
+}
+
+__device__ __forceinline__ int64_t AtomicAdd(int64_t* address, int64_t val) {
+  return static_cast<int64_t>(atomicAdd(reinterpret_cast<unsigned long long int*>(address),
+                                        static_cast<unsigned long long int>(val)));
+}
+
+// Every slot of table holds 0 when empty, otherwise 1 + the position in `in` of the first
+// element that claimed it. Keys are compared through `in`, so no key value is reserved as the
+// empty marker.
+template<typename Key, typename Index>
+__global__ void HashUniqueInsertKernel(size_t n, const Key* in, size_t capacity, Index* table,
+                                       Index* slot_unique_ids, Index* slots, Key* unique,
+                                       Index* num_unique) {
+  for (size_t i = blockIdx.x * blockDim.x + threadIdx.x, step = blockDim.x * gridDim.x; i < n;
+       i += step) {
+    const Key key = in[i];
+    size_t slot = HashKey(key) & (capacity - 1);
+    while (true) {
+      const Index owner = AtomicCAS(table + slot, static_cast<Index>(0), static_cast<Index>(i + 1));
+      if (owner == 0) {
+        const Index unique_id = AtomicAdd(num_unique, static_cast<Index>(1));
+        slot_unique_ids[slot] = unique_id;
+        unique[unique_id] = key;
+        break;
+      }
+      if (in[owner - 1] == key) { break; }
+      slot = (slot + 1) & (capacity - 1);
+    }
+    slots[i] = static_cast<Index>(slot);
+  }
+}
+
+template<typename Index>
+__global__ void HashUniqueGatherKernel(size_t n, const Index* slots, const Index* slot_unique_ids,
+                                       Index* inverse_indices, Index* counts) {
+  for (size_t i = blockIdx.x * blockDim.x + threadIdx.x, step = blockDim.x * gridDim.x; i < n;
+       i += step) {
+    const Index unique_id = slot_unique_ids[slots[i]];
+    if (inverse_indices != nullptr) { inverse_indices[i] = unique_id; }
+    if (counts != nullptr) { AtomicAdd(counts + unique_id, static_cast<Index>(1)); }
+  }
+}
+
+template<typename Key, typename Index>
+cudaError_t DoHashUnique(Flag flag, size_t n, const Key* in, Key* unique, Index* num_unique,
+                         Index* inverse_indices, Index* counts, void* workspace,
+                         size_t* workspace_size, cudaStream_t stream) {
+  const size_t capacity = HashTableCapacity(n);
+  const size_t table_size = GetCudaAlignedSize(capacity * sizeof(Index));
+  const size_t slots_size = GetCudaAlignedSize(n * sizeof(Index));
+  const size_t hash_ws = 2 * table_size + slots_size;
+  if (*workspace_size == 0) {
+    *workspace_size = hash_ws;
+    return cudaSuccess;
+  }
+  if (*workspace_size < hash_ws) { return cudaErrorInvalidValue; }
+  Index* table = PtrOffset<Index>(workspace, 0);
+  Index* slot_unique_ids = PtrOffset<Index>(workspace, table_size);
+  Index* slots = PtrOffset<Index>(workspace, 2 * table_size);
+  {
+    cudaError_t err = cudaMemsetAsync(table, 0, capacity * sizeof(Index), stream);
+    if (err != cudaSuccess) { return err; }
+  }
+  {
+    cudaError_t err = cudaMemsetAsync(num_unique, 0, sizeof(Index), stream);
+    if (err != cudaSuccess) { return err; }
+  }
+  if ((flag & kOutputCounts) != 0) {
+    cudaError_t err = cudaMemsetAsync(counts, 0, n * sizeof(Index), stream);
+    if (err != cudaSuccess) { return err; }
+  }
+  const int block_size = 1024;
+  const int num_blocks = static_cast<int>((n + block_size - 1) / block_size);
+  HashUniqueInsertKernel<Key, Index><<<num_blocks, block_size, 0, stream>>>(
+      n, in, capacity, table, slot_unique_ids, slots, unique, num_unique);
+  HashUniqueGatherKernel<Index><<<num_blocks, block_size, 0, stream>>>(
+      n, slots, slot_unique_ids, (flag & kOutputInverseIndices) != 0 ? inverse_indices : nullptr,
+      (flag & kOutputCounts) != 0 ? counts : nullptr);
+  return cudaPeekAtLastError();
+}
+
+template<typename Key, typename Index>
+cudaError_t DispatchHashTable(Flag flag, size_t n, const Key* in, Key* unique, Index* num_unique,
+                              Index* inverse_indices, Index* counts, void* workspace,
+                              size_t* workspace_size, cudaStream_t stream) {
+  if (UseHashTable<Key>(flag, n)) {
+    return DoHashUnique<Key, Index>(flag, n, in, unique, num_unique, inverse_indices, counts,
+                                    workspace, workspace_size, stream);
+  } else {
+    return DispatchInputSorted<Key, Index>(flag, n, in, unique, num_unique, inverse_indices,
+                                           counts, workspace, workspace_size, stream);
+  }
+}
+
 }  // namespace
 
 template<typename Key, typename Index>
@@ -225,15 +363,15 @@ cudaError_t Launch(Flag flag, size_t n, const Key* in, Key* unique, Index* num_u
                    Index* inverse_indices, Index* counts, void* workspace, size_t workspace_size,
                    cudaStream_t stream) {
   if (workspace_size == 0) { return cudaErrorInvalidValue; }
-  return DispatchInputSorted<Key, Index>(flag, n, in, unique, num_unique, inverse_indices, counts,
-                                         workspace, &workspace_size, stream);
+  return DispatchHashTable<Key, Index>(flag, n, in, unique, num_unique, inverse_indices, counts,
+                                       workspace, &workspace_size, stream);
 }
 
 template<typename Key, typename Index>
 cudaError_t GetWorkspaceSize(Flag flag, size_t n, size_t* workspace_size) {
   *workspace_size = 0;
-  return DispatchInputSorted<Key, Index>(flag, n, nullptr, nullptr, nullptr, nullptr, nullptr,
-                                         nullptr, workspace_size, 0);
+  return DispatchHashTable<Key, Index>(flag, n, nullptr, nullptr, nullptr, nullptr, nullptr,
+                                       nullptr, workspace_size, 0);
 }
 
 }  // namespace unique
@@ -15,8 +15,36 @@ limitations under the License.
 */
 #include "oneflow/core/device/cpu_device_context.h"
 #include "oneflow/core/thread/thread_context.h"
+#include "oneflow/core/thread/thread_pool.h"
+#include "oneflow/core/job/resource_desc.h"
+#include "oneflow/core/job/global_for.h"
 
 namespace oneflow {
+
+CpuDeviceCtx::CpuDeviceCtx() {
+  const ResourceDesc* resource_desc = Global<ResourceDesc, ForSession>::Get();
+  intra_op_thread_num_ = resource_desc == nullptr ? 1 : resource_desc->cpu_intra_op_thread_num();
+}
+
+void CpuDeviceCtx::ParallelFor(
+    int64_t num, int64_t grain_size,
+    const std::function<void(int64_t begin, int64_t end)>& Callback) const {
+  if (num <= 0) { return; }
+  grain_size = std::max<int64_t>(grain_size, 1);
+  ThreadPool* thread_pool = Global<ThreadPool>::Get();
+  if (intra_op_thread_num_ <= 1 || thread_pool == nullptr || num <= grain_size) {
+    Callback(0, num);
+    return;
+  }
+  // the calling thread runs chunks too, and at most one chunk goes to each thread of the budget
+  const int64_t thread_num =
+      std::min<int64_t>(intra_op_thread_num_, thread_pool->thread_num() + 1);
+  const int64_t chunk_size = std::max<int64_t>(grain_size, (num + thread_num - 1) / thread_num);
+  thread_pool->ParallelFor(Range(0, num), chunk_size, [&Callback](const Range& range) {
+    Callback(range.begin(), range.end());
+  });
+}
+
 REGISTER_DEVICE_CONTEXT(DeviceType::kCPU, ([](const ThreadCtx& thread_ctx) -> DeviceCtx* {
                           return new CpuDeviceCtx();
                         }));
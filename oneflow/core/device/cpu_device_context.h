@@ -24,18 +24,25 @@ namespace oneflow {
 class CpuDeviceCtx final : public DeviceCtx {
  public:
   OF_DISALLOW_COPY_AND_MOVE(CpuDeviceCtx);
-  CpuDeviceCtx() = default;
+  CpuDeviceCtx();
+  explicit CpuDeviceCtx(int32_t intra_op_thread_num)
+      : intra_op_thread_num_(intra_op_thread_num) {}
   ~CpuDeviceCtx() = default;
 
-  std::unique_ptr<DeviceCtx> Copy() const { return std::unique_ptr<DeviceCtx>(new CpuDeviceCtx()); }
+  std::unique_ptr<DeviceCtx> Copy() const {
+    return std::unique_ptr<DeviceCtx>(new CpuDeviceCtx(intra_op_thread_num_));
+  }
 
   void SyncDevice() override {}
   void AddCallBack(std::function<void()> callback) const override { callback(); }
+  void ParallelFor(int64_t num, int64_t grain_size,
+                   const std::function<void(int64_t begin, int64_t end)>& Callback) const override;
 
   vm::Allocator* mut_allocator() override { return Global<vm::CpuAllocator>::Get(); }
 
  private:
-};  // namespace oneflow
+  int32_t intra_op_thread_num_;
+};
 
 }  // namespace oneflow
 
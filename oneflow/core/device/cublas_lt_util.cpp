@@ -0,0 +1,250 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/device/cublas_lt_util.h"
+
+#ifdef WITH_CUBLASLT_EPILOGUE
+
+#include "oneflow/core/device/device_context.h"
+#include "oneflow/core/job/resource_desc.h"
+#include "oneflow/core/job/global_for.h"
+#include <cstring>
+
+namespace oneflow {
+
+namespace {
+
+constexpr int kMaxHeuristicResults = 8;
+constexpr int kAutotuneRepeats = 3;
+
+cudaDataType_t GetCublasLtDataType(DataType data_type) {
+  switch (data_type) {
+    case DataType::kFloat: return CUDA_R_32F;
+    case DataType::kDouble: return CUDA_R_64F;
+    case DataType::kFloat16: return CUDA_R_16F;
+    case DataType::kBFloat16: return CUDA_R_16BF;
+    default: UNIMPLEMENTED(); return CUDA_R_32F;
+  }
+}
+
+cublasComputeType_t GetCublasLtComputeType(DataType data_type) {
+  if (data_type == DataType::kDouble) { return CUBLAS_COMPUTE_64F; }
+  if (data_type == DataType::kFloat
+      && Global<ResourceDesc, ForSession>::Get()->enable_tensor_float_32_compute()) {
+    return CUBLAS_COMPUTE_32F_FAST_TF32;
+  }
+  return CUBLAS_COMPUTE_32F;
+}
+
+class CublasLtMatmulDesc final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(CublasLtMatmulDesc);
+  CublasLtMatmulDesc(const CublasLtMatmulParams& params, const CublasLtMatmulPointers& ptrs) {
+    const auto compute_type = static_cast<cublasComputeType_t>(params.compute_type);
+    const auto data_type = static_cast<cudaDataType_t>(params.data_type);
+    const auto ab_data_type = static_cast<cudaDataType_t>(params.ab_data_type);
+    scale_type_ = compute_type == CUBLAS_COMPUTE_64F ? CUDA_R_64F : CUDA_R_32F;
+    OF_CUBLAS_CHECK(cublasLtMatmulDescCreate(&op_desc_, compute_type, scale_type_));
+    const auto trans_a = static_cast<cublasOperation_t>(params.trans_a);
+    const auto trans_b = static_cast<cublasOperation_t>(params.trans_b);
+    const auto epilogue = static_cast<cublasLtEpilogue_t>(params.epilogue);
+    SetAttr(CUBLASLT_MATMUL_DESC_TRANSA, trans_a);
+    SetAttr(CUBLASLT_MATMUL_DESC_TRANSB, trans_b);
+    SetAttr(CUBLASLT_MATMUL_DESC_EPILOGUE, epilogue);
+    if (epilogue != CUBLASLT_EPILOGUE_DEFAULT) {
+      SetAttr(CUBLASLT_MATMUL_DESC_BIAS_POINTER, ptrs.bias);
+    }
+    if (ptrs.aux != nullptr) {
+      SetAttr(CUBLASLT_MATMUL_DESC_EPILOGUE_AUX_POINTER, ptrs.aux);
+      SetAttr(CUBLASLT_MATMUL_DESC_EPILOGUE_AUX_LD, params.aux_ld);
+    }
+#ifdef WITH_CUBLASLT_FP8
+    if (ptrs.a_scale != nullptr) { SetAttr(CUBLASLT_MATMUL_DESC_A_SCALE_POINTER, ptrs.a_scale); }
+    if (ptrs.b_scale != nullptr) { SetAttr(CUBLASLT_MATMUL_DESC_B_SCALE_POINTER, ptrs.b_scale); }
+#endif  // WITH_CUBLASLT_FP8
+    // Layouts describe the stored matrices, which are transposed by op_a and op_b.
+    const bool no_trans_a = trans_a == CUBLAS_OP_N;
+    const bool no_trans_b = trans_b == CUBLAS_OP_N;
+    OF_CUBLAS_CHECK(cublasLtMatrixLayoutCreate(&a_desc_, ab_data_type,
+                                               no_trans_a ? params.m : params.k,
+                                               no_trans_a ? params.k : params.m, params.lda));
+    OF_CUBLAS_CHECK(cublasLtMatrixLayoutCreate(&b_desc_, ab_data_type,
+                                               no_trans_b ? params.k : params.n,
+                                               no_trans_b ? params.n : params.k, params.ldb));
+    OF_CUBLAS_CHECK(
+        cublasLtMatrixLayoutCreate(&d_desc_, data_type, params.m, params.n, params.ldd));
+  }
+  ~CublasLtMatmulDesc() {
+    OF_CUBLAS_CHECK(cublasLtMatrixLayoutDestroy(d_desc_));
+    OF_CUBLAS_CHECK(cublasLtMatrixLayoutDestroy(b_desc_));
+    OF_CUBLAS_CHECK(cublasLtMatrixLayoutDestroy(a_desc_));
+    OF_CUBLAS_CHECK(cublasLtMatmulDescDestroy(op_desc_));
+  }
+
+  void Run(cublasLtHandle_t handle, cudaStream_t stream, const CublasLtMatmulPointers& ptrs,
+           const cublasLtMatmulAlgo_t& algo) const {
+    const double alpha_f64 = 1.0;
+    const double beta_f64 = 0.0;
+    const float alpha_f32 = 1.0;
+    const float beta_f32 = 0.0;
+    const bool is_f64 = scale_type_ == CUDA_R_64F;
+    const void* alpha = is_f64 ? static_cast<const void*>(&alpha_f64) : &alpha_f32;
+    const void* beta = is_f64 ? static_cast<const void*>(&beta_f64) : &beta_f32;
+    OF_CUBLAS_CHECK(cublasLtMatmul(handle, op_desc_, alpha, ptrs.a, a_desc_, ptrs.b, b_desc_, beta,
+                                   ptrs.d, d_desc_, ptrs.d, d_desc_, &algo, ptrs.workspace,
+                                   kCublasLtMatmulWorkspaceSize, stream));
+  }
+
+  std::vector<cublasLtMatmulHeuristicResult_t> GetHeuristicResults(cublasLtHandle_t handle) const {
+    cublasLtMatmulPreference_t preference;
+    OF_CUBLAS_CHECK(cublasLtMatmulPreferenceCreate(&preference));
+    const uint64_t workspace_size = kCublasLtMatmulWorkspaceSize;
+    OF_CUBLAS_CHECK(cublasLtMatmulPreferenceSetAttribute(
+        preference, CUBLASLT_MATMUL_PREF_MAX_WORKSPACE_BYTES, &workspace_size,
+        sizeof(workspace_size)));
+    std::vector<cublasLtMatmulHeuristicResult_t> results(kMaxHeuristicResults);
+    int num_results = 0;
+    OF_CUBLAS_CHECK(cublasLtMatmulAlgoGetHeuristic(handle, op_desc_, a_desc_, b_desc_, d_desc_,
+                                                   d_desc_, preference, kMaxHeuristicResults,
+                                                   results.data(), &num_results));
+    OF_CUBLAS_CHECK(cublasLtMatmulPreferenceDestroy(preference));
+    results.resize(num_results);
+    return results;
+  }
+
+ private:
+  template<typename T>
+  void SetAttr(cublasLtMatmulDescAttributes_t attr, const T& value) {
+    OF_CUBLAS_CHECK(cublasLtMatmulDescSetAttribute(op_desc_, attr, &value, sizeof(value)));
+  }
+
+  cudaDataType_t scale_type_;
+  cublasLtMatmulDesc_t op_desc_;
+  cublasLtMatrixLayout_t a_desc_;
+  cublasLtMatrixLayout_t b_desc_;
+  cublasLtMatrixLayout_t d_desc_;
+};
+
+// Times every heuristic result on the real operands, D and the epilogue outputs are overwritten by
+// the launch that follows.
+cublasLtMatmulAlgo_t AutotuneAlgo(cublasLtHandle_t handle, cudaStream_t stream,
+                                  const CublasLtMatmulDesc& desc,
+                                  const std::vector<cublasLtMatmulHeuristicResult_t>& results,
+                                  const CublasLtMatmulPointers& ptrs) {
+  cudaEvent_t start;
+  cudaEvent_t stop;
+  OF_CUDA_CHECK(cudaEventCreate(&start));
+  OF_CUDA_CHECK(cudaEventCreate(&stop));
+  float best_time = std::numeric_limits<float>::max();
+  cublasLtMatmulAlgo_t best_algo = results.front().algo;
+  for (const auto& result : results) {
+    desc.Run(handle, stream, ptrs, result.algo);
+    OF_CUDA_CHECK(cudaEventRecord(start, stream));
+    for (int i = 0; i < kAutotuneRepeats; ++i) { desc.Run(handle, stream, ptrs, result.algo); }
+    OF_CUDA_CHECK(cudaEventRecord(stop, stream));
+    OF_CUDA_CHECK(cudaEventSynchronize(stop));
+    float time = 0;
+    OF_CUDA_CHECK(cudaEventElapsedTime(&time, start, stop));
+    if (time < best_time) {
+      best_time = time;
+      best_algo = result.algo;
+    }
+  }
+  OF_CUDA_CHECK(cudaEventDestroy(start));
+  OF_CUDA_CHECK(cudaEventDestroy(stop));
+  return best_algo;
+}
+
+}  // namespace
+
+bool operator==(const CublasLtMatmulParams& lhs, const CublasLtMatmulParams& rhs) {
+  return std::memcmp(&lhs, &rhs, sizeof(CublasLtMatmulParams)) == 0;
+}
+
+CublasLtMatmulParams MakeCublasLtMatmulParams(DataType data_type, bool trans_a, bool trans_b,
+                                              int64_t m, int64_t n, int64_t k, int64_t lda,
+                                              int64_t ldb, int64_t ldd,
+                                              cublasLtEpilogue_t epilogue, int64_t aux_ld) {
+  CublasLtMatmulParams params;
+  std::memset(&params, 0, sizeof(CublasLtMatmulParams));
+  params.m = m;
+  params.n = n;
+  params.k = k;
+  params.lda = lda;
+  params.ldb = ldb;
+  params.ldd = ldd;
+  params.aux_ld = aux_ld;
+  params.trans_a = trans_a ? CUBLAS_OP_T : CUBLAS_OP_N;
+  params.trans_b = trans_b ? CUBLAS_OP_T : CUBLAS_OP_N;
+  params.data_type = GetCublasLtDataType(data_type);
+  params.ab_data_type = params.data_type;
+  params.compute_type = GetCublasLtComputeType(data_type);
+  params.epilogue = epilogue;
+  int device_id = 0;
+  OF_CUDA_CHECK(cudaGetDevice(&device_id));
+  params.device_id = device_id;
+  return params;
+}
+
+#ifdef WITH_CUBLASLT_FP8
+CublasLtMatmulParams MakeCublasLtFp8MatmulParams(DataType d_data_type, int64_t m, int64_t n,
+                                                 int64_t k, int64_t lda, int64_t ldb,
+                                                 int64_t ldd) {
+  CublasLtMatmulParams params = MakeCublasLtMatmulParams(
+      d_data_type, true, false, m, n, k, lda, ldb, ldd, CUBLASLT_EPILOGUE_DEFAULT, 0);
+  params.ab_data_type = CUDA_R_8F_E4M3;
+  // TF32 is meaningless for FP8 operands, they always accumulate in float
+  params.compute_type = CUBLAS_COMPUTE_32F;
+  return params;
+}
+#endif  // WITH_CUBLASLT_FP8
+
+void CublasLtMatmul(DeviceCtx* device_ctx, const CublasLtMatmulParams& params,
+                    const CublasLtMatmulPointers& ptrs) {
+  // A cublas handle is a valid cublasLt handle, the stream is passed to every launch.
+  auto handle = reinterpret_cast<cublasLtHandle_t>(device_ctx->cublas_pmh_handle());
+  const cudaStream_t stream = device_ctx->cuda_stream();
+  const CublasLtMatmulDesc desc(params, ptrs);
+  const cublasLtMatmulAlgo_t algo = Global<CublasLtMatmulAlgoCache>::Get()->Remember(
+      params, [&](const CublasLtMatmulParams&) -> cublasLtMatmulAlgo_t {
+        const auto results = desc.GetHeuristicResults(handle);
+        CHECK(!results.empty()) << "no cublasLt matmul algorithm for m " << params.m << ", n "
+                                << params.n << ", k " << params.k << ", epilogue "
+                                << params.epilogue;
+        static const bool autotune = ParseBooleanFromEnv("ONEFLOW_CUBLASLT_MATMUL_AUTOTUNE", false);
+        if (autotune && results.size() > 1) {
+          return AutotuneAlgo(handle, stream, desc, results, ptrs);
+        }
+        return results.front().algo;
+      });
+  desc.Run(handle, stream, ptrs, algo);
+}
+
+cublasLtMatmulAlgo_t CublasLtMatmulAlgoCache::Remember(
+    const CublasLtMatmulParams& params,
+    const std::function<cublasLtMatmulAlgo_t(const CublasLtMatmulParams&)>& InferFn) {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    const auto it = store_.find(params);
+    if (it != store_.end()) { return it->second; }
+  }
+  const cublasLtMatmulAlgo_t algo = InferFn(params);
+  std::unique_lock<std::mutex> lock(mutex_);
+  return store_.emplace(params, algo).first->second;
+}
+
+}  // namespace oneflow
+
+#endif  // WITH_CUBLASLT_EPILOGUE
@@ -0,0 +1,163 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_DEVICE_CUBLAS_LT_UTIL_H_
+#define ONEFLOW_CORE_DEVICE_CUBLAS_LT_UTIL_H_
+
+#ifdef WITH_CUDA
+
+#include "oneflow/core/device/cuda_util.h"
+#include "oneflow/core/common/util.h"
+#include <mutex>
+
+// The bias grad epilogues this file relies on come with cuBLAS 11.4.
+#if CUDA_VERSION >= 11040
+#define WITH_CUBLASLT_EPILOGUE
+#include <cublasLt.h>
+#endif
+
+// FP8 operands and their scale pointers come with cuBLAS 11.8, the kernels need sm_89 or sm_90.
+#if CUDA_VERSION >= 11080
+#define WITH_CUBLASLT_FP8
+#endif
+
+namespace oneflow {
+
+inline bool IsCublasLtMatmulEpilogueSupported() {
+#ifdef WITH_CUBLASLT_EPILOGUE
+  return true;
+#else
+  return false;
+#endif
+}
+
+inline bool IsCublasLtFp8MatmulSupported() {
+#ifdef WITH_CUBLASLT_FP8
+  return true;
+#else
+  return false;
+#endif
+}
+
+#ifdef WITH_CUBLASLT_EPILOGUE
+
+class DeviceCtx;
+
+constexpr size_t kCublasLtMatmulWorkspaceSize = 4 * 1024 * 1024;
+
+// Column major D(m, n) = op_a(A)(m, k) * op_b(B)(k, n) with epilogue, all in cuBLASLt terms.
+// Every field is 64 bits wide so that the struct has no padding, it is hashed by its bytes.
+struct CublasLtMatmulParams {
+  int64_t m;
+  int64_t n;
+  int64_t k;
+  int64_t lda;
+  int64_t ldb;
+  int64_t ldd;
+  int64_t aux_ld;
+  int64_t trans_a;
+  int64_t trans_b;
+  int64_t data_type;
+  // the type of A and B, the same as data_type but for the FP8 matmul
+  int64_t ab_data_type;
+  int64_t compute_type;
+  int64_t epilogue;
+  int64_t device_id;
+};
+
+struct CublasLtMatmulPointers {
+  const void* a;
+  const void* b;
+  void* d;
+  // bias for the bias epilogues, bias grad for the bias grad epilogues
+  void* bias;
+  void* aux;
+  void* workspace;
+  // device scalars that A and B are multiplied by, they dequantize FP8 operands
+  const float* a_scale;
+  const float* b_scale;
+};
+
+bool operator==(const CublasLtMatmulParams& lhs, const CublasLtMatmulParams& rhs);
+
+CublasLtMatmulParams MakeCublasLtMatmulParams(DataType data_type, bool trans_a, bool trans_b,
+                                              int64_t m, int64_t n, int64_t k, int64_t lda,
+                                              int64_t ldb, int64_t ldd,
+                                              cublasLtEpilogue_t epilogue, int64_t aux_ld);
+
+#ifdef WITH_CUBLASLT_FP8
+// D(m, n) = A^T(m, k) * B(k, n) with E4M3 operands, the only layout the FP8 kernels support.
+// d_data_type is the type of D, the dequantizing scales go to a_scale and b_scale of the pointers.
+CublasLtMatmulParams MakeCublasLtFp8MatmulParams(DataType d_data_type, int64_t m, int64_t n,
+                                                 int64_t k, int64_t lda, int64_t ldb,
+                                                 int64_t ldd);
+#endif  // WITH_CUBLASLT_FP8
+
+// Runs D = op_a(A) * op_b(B) + epilogue on the stream of device_ctx. The algorithm picked for
+// params is cached; it is the first heuristic result, or the fastest of the heuristic results
+// when ONEFLOW_CUBLASLT_MATMUL_AUTOTUNE is set.
+void CublasLtMatmul(DeviceCtx* device_ctx, const CublasLtMatmulParams& params,
+                    const CublasLtMatmulPointers& ptrs);
+
+#endif  // WITH_CUBLASLT_EPILOGUE
+
+}  // namespace oneflow
+
+#ifdef WITH_CUBLASLT_EPILOGUE
+
+namespace std {
+
+template<>
+struct hash<oneflow::CublasLtMatmulParams> final {
+  static_assert(std::is_pod<oneflow::CublasLtMatmulParams>::value,
+                "CublasLtMatmulParams is not POD");
+
+  size_t operator()(const oneflow::CublasLtMatmulParams& params) const {
+    const auto* ptr = reinterpret_cast<const uint8_t*>(&params);
+    uint32_t value = 0x811C9DC5;
+    for (int i = 0; i < (int)sizeof(oneflow::CublasLtMatmulParams); ++i) {
+      value ^= ptr[i];
+      value *= 0x01000193;
+    }
+    return (size_t)value;
+  }
+};
+
+}  // namespace std
+
+namespace oneflow {
+
+class CublasLtMatmulAlgoCache final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(CublasLtMatmulAlgoCache);
+  CublasLtMatmulAlgoCache() = default;
+  ~CublasLtMatmulAlgoCache() = default;
+
+  cublasLtMatmulAlgo_t Remember(
+      const CublasLtMatmulParams& params,
+      const std::function<cublasLtMatmulAlgo_t(const CublasLtMatmulParams&)>& InferFn);
+
+ private:
+  HashMap<CublasLtMatmulParams, cublasLtMatmulAlgo_t> store_;
+  std::mutex mutex_;
+};
+
+}  // namespace oneflow
+
+#endif  // WITH_CUBLASLT_EPILOGUE
+
+#endif  // WITH_CUDA
+
+#endif  // ONEFLOW_CORE_DEVICE_CUBLAS_LT_UTIL_H_
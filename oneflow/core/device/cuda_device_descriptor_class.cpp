@@ -22,6 +22,7 @@ limitations under the License.
 #include "oneflow/core/persistence/tee_persistent_log_stream.h"
 #include "oneflow/core/common/str_util.h"
 #include <json.hpp>
+#include <thread>
 
 #ifdef WITH_CUDA
 
@@ -50,7 +51,12 @@ class CudaDeviceDescriptorClass : public DeviceDescriptorClass {
     }
     OF_CUDA_CHECK(err);
     std::vector<std::shared_ptr<const DeviceDescriptor>> devices(n_dev);
-    for (int dev = 0; dev < n_dev; ++dev) { devices.at(dev) = CudaDeviceDescriptor::Query(dev); }
+    std::vector<std::thread> threads;
+    for (int dev = 0; dev < n_dev; ++dev) {
+      threads.emplace_back(
+          [dev, &devices]() { devices.at(dev) = CudaDeviceDescriptor::Query(dev); });
+    }
+    for (auto& thread : threads) { thread.join(); }
     return std::make_shared<const BasicDeviceDescriptorList>(devices);
   }
 
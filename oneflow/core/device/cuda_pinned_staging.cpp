@@ -0,0 +1,177 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifdef WITH_CUDA
+
+#include "oneflow/core/device/cuda_pinned_staging.h"
+#include "oneflow/core/common/util.h"
+#include <cstring>
+#include <mutex>
+
+namespace oneflow {
+
+namespace {
+
+class PinnedStagingRing final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(PinnedStagingRing);
+  PinnedStagingRing(int32_t device_id, size_t chunk_size, int64_t num_chunks)
+      : chunk_size_(chunk_size), next_(0) {
+    chunks_.resize(num_chunks);
+    events_.resize(num_chunks);
+    event_recorded_.resize(num_chunks, false);
+    FOR_RANGE(int64_t, i, 0, num_chunks) {
+      NumaAwareCudaMallocHost(device_id, &chunks_.at(i), chunk_size_);
+      CHECK_NOTNULL(chunks_.at(i));
+      OF_CUDA_CHECK(cudaEventCreateWithFlags(&events_.at(i), cudaEventDisableTiming));
+    }
+  }
+  ~PinnedStagingRing() = default;
+
+  void Copy(cudaStream_t stream, char* dst, const char* src, size_t size) {
+    for (size_t offset = 0; offset < size; offset += chunk_size_) {
+      const size_t chunk_bytes = std::min(chunk_size_, size - offset);
+      char* chunk = chunks_.at(next_);
+      cudaEvent_t event = events_.at(next_);
+      // waits for the copy that last used this chunk, which may have been issued on another stream
+      if (event_recorded_.at(next_)) { OF_CUDA_CHECK(cudaEventSynchronize(event)); }
+      std::memcpy(chunk, src + offset, chunk_bytes);
+      OF_CUDA_CHECK(
+          cudaMemcpyAsync(dst + offset, chunk, chunk_bytes, cudaMemcpyHostToDevice, stream));
+      OF_CUDA_CHECK(cudaEventRecord(event, stream));
+      event_recorded_.at(next_) = true;
+      next_ = (next_ + 1) % chunks_.size();
+    }
+  }
+
+ private:
+  const size_t chunk_size_;
+  std::vector<char*> chunks_;
+  std::vector<cudaEvent_t> events_;
+  std::vector<bool> event_recorded_;
+  size_t next_;
+};
+
+// Rings are handed out to one copy at a time and created on demand, so concurrent copies from
+// several threads do not serialize. They are never destructed, the pinned memory is released
+// with the process.
+class PinnedStagingRingPool final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(PinnedStagingRingPool);
+  explicit PinnedStagingRingPool(int32_t device_id)
+      : device_id_(device_id),
+        chunk_size_(ParseIntegerFromEnv("ONEFLOW_CUDA_PAGEABLE_STAGING_CHUNK_BYTES", 4 << 20)),
+        num_chunks_(ParseIntegerFromEnv("ONEFLOW_CUDA_PAGEABLE_STAGING_CHUNKS", 4)) {
+    CHECK_GT(chunk_size_, 0);
+  }
+  ~PinnedStagingRingPool() = default;
+
+  PinnedStagingRing* Acquire() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!free_rings_.empty()) {
+        PinnedStagingRing* ring = free_rings_.back();
+        free_rings_.pop_back();
+        return ring;
+      }
+    }
+    return new PinnedStagingRing(device_id_, chunk_size_, num_chunks_);
+  }
+
+  void Release(PinnedStagingRing* ring) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    free_rings_.push_back(ring);
+  }
+
+  bool enabled() const { return num_chunks_ > 0; }
+
+ private:
+  const int32_t device_id_;
+  const size_t chunk_size_;
+  const int64_t num_chunks_;
+  std::mutex mutex_;
+  std::vector<PinnedStagingRing*> free_rings_;
+};
+
+PinnedStagingRingPool* GetPinnedStagingRingPool(int32_t device_id) {
+  static std::mutex mutex;
+  static std::vector<PinnedStagingRingPool*>* pools = new std::vector<PinnedStagingRingPool*>();
+  std::lock_guard<std::mutex> lock(mutex);
+  if (pools->size() <= static_cast<size_t>(device_id)) { pools->resize(device_id + 1, nullptr); }
+  PinnedStagingRingPool*& pool = pools->at(device_id);
+  if (pool == nullptr) { pool = new PinnedStagingRingPool(device_id); }
+  return pool;
+}
+
+bool GetPointerAttributes(const void* ptr, cudaPointerAttributes* attributes) {
+  const cudaError_t err = cudaPointerGetAttributes(attributes, ptr);
+  if (err == cudaErrorInvalidValue) {
+    // before cuda 11, pageable host memory is reported as an invalid value
+    cudaGetLastError();
+    return false;
+  }
+  OF_CUDA_CHECK(err);
+  return true;
+}
+
+}  // namespace
+
+bool IsCudaPageableHostPointer(const void* ptr) {
+  cudaPointerAttributes attributes;
+  if (!GetPointerAttributes(ptr, &attributes)) { return true; }
+  return attributes.type == cudaMemoryTypeUnregistered;
+}
+
+void CudaMemcpyAsyncStaged(cudaStream_t stream, void* dst, const void* src, size_t size) {
+  static const size_t min_staged_bytes =
+      ParseIntegerFromEnv("ONEFLOW_CUDA_PAGEABLE_STAGING_MIN_BYTES", 256 << 10);
+  if (size >= min_staged_bytes && IsCudaPageableHostPointer(src)) {
+    cudaPointerAttributes dst_attributes;
+    if (GetPointerAttributes(dst, &dst_attributes)
+        && dst_attributes.type == cudaMemoryTypeDevice) {
+      PinnedStagingRingPool* pool = GetPinnedStagingRingPool(dst_attributes.device);
+      if (pool->enabled()) {
+        CudaCurrentDeviceGuard guard(dst_attributes.device);
+        PinnedStagingRing* ring = pool->Acquire();
+        ring->Copy(stream, static_cast<char*>(dst), static_cast<const char*>(src), size);
+        pool->Release(ring);
+        return;
+      }
+    }
+  }
+  OF_CUDA_CHECK(cudaMemcpyAsync(dst, src, size, cudaMemcpyDefault, stream));
+}
+
+void CudaHostRegisterBuffer(void* ptr, size_t size) {
+  const cudaError_t err = cudaHostRegister(ptr, size, cudaHostRegisterDefault);
+  if (err == cudaErrorHostMemoryAlreadyRegistered) {
+    cudaGetLastError();
+    return;
+  }
+  OF_CUDA_CHECK(err);
+}
+
+void CudaHostUnregisterBuffer(void* ptr) {
+  const cudaError_t err = cudaHostUnregister(ptr);
+  if (err == cudaErrorHostMemoryNotRegistered) {
+    cudaGetLastError();
+    return;
+  }
+  OF_CUDA_CHECK(err);
+}
+
+}  // namespace oneflow
+
+#endif  // WITH_CUDA
@@ -0,0 +1,46 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_DEVICE_CUDA_PINNED_STAGING_H_
+#define ONEFLOW_CORE_DEVICE_CUDA_PINNED_STAGING_H_
+
+#ifdef WITH_CUDA
+
+#include "oneflow/core/device/cuda_util.h"
+
+namespace oneflow {
+
+// A copy from pageable host memory makes cudaMemcpyAsync block the calling thread until the
+// driver has pushed the data. CudaMemcpyAsyncStaged instead copies the source in chunks into a
+// pooled ring of pinned buffers and enqueues one async copy per chunk, so filling a chunk
+// overlaps the transfer of the previous one and the call returns as soon as the source has been
+// staged. Copies that are not from pageable memory to device memory, or are smaller than
+// ONEFLOW_CUDA_PAGEABLE_STAGING_MIN_BYTES, go straight to cudaMemcpyAsync. The ring is sized by
+// ONEFLOW_CUDA_PAGEABLE_STAGING_CHUNK_BYTES and ONEFLOW_CUDA_PAGEABLE_STAGING_CHUNKS, setting
+// the latter to 0 disables staging.
+void CudaMemcpyAsyncStaged(cudaStream_t stream, void* dst, const void* src, size_t size);
+
+bool IsCudaPageableHostPointer(const void* ptr);
+
+// Pins a long-lived host buffer so that copies from and to it skip staging altogether.
+// Registering an already registered buffer and unregistering an unregistered one are no-ops.
+void CudaHostRegisterBuffer(void* ptr, size_t size);
+void CudaHostUnregisterBuffer(void* ptr);
+
+}  // namespace oneflow
+
+#endif  // WITH_CUDA
+
+#endif  // ONEFLOW_CORE_DEVICE_CUDA_PINNED_STAGING_H_
@@ -17,6 +17,18 @@ limitations under the License.
 
 namespace oneflow {
 
+StreamIndexGenerator::stream_index_t CudaStreamIndexGenerator::GenerateInstanceComputeStreamIndex(
+    int64_t job_id) {
+  auto it = job_id2instance_compute_stream_index_.find(job_id);
+  if (it == job_id2instance_compute_stream_index_.end()) {
+    const stream_index_t idx =
+        kInstanceComputeBegin
+        + job_id2instance_compute_stream_index_.size() % GetInstanceComputeStreamCount();
+    it = job_id2instance_compute_stream_index_.emplace(job_id, idx).first;
+  }
+  return it->second;
+}
+
 REGISTER_STREAM_INDEX_GENERATOR(DeviceType::kGPU, CudaStreamIndexGenerator);
 
 }  // namespace oneflow
@@ -34,6 +34,21 @@ class CudaStreamIndexGenerator final : public StreamIndexGenerator {
     return idx;
   }
   uint32_t GetNcclComputeStreamCount() const { return kNcclComputeEnd - kNcclComputeBegin + 1; }
+  // compute stream of a job with enable_concurrent_execution, the concurrent jobs take the
+  // instance compute streams of the device in turn
+  stream_index_t GenerateInstanceComputeStreamIndex(int64_t job_id);
+  uint32_t GetInstanceComputeStreamCount() const {
+    return kInstanceComputeEnd - kInstanceComputeBegin + 1;
+  }
+  // extra compute streams of the independent branches of a job, see BranchComputeStreamPass
+  stream_index_t GenerateBranchComputeStreamIndex(const uint32_t id) {
+    stream_index_t idx = kBranchComputeBegin + id;
+    CHECK_LE(idx, kBranchComputeEnd);
+    return idx;
+  }
+  uint32_t GetBranchComputeStreamCount() const {
+    return kBranchComputeEnd - kBranchComputeBegin + 1;
+  }
 
  private:
   static const stream_index_t kCompute = 0;
@@ -44,6 +59,12 @@ class CudaStreamIndexGenerator final : public StreamIndexGenerator {
   static const stream_index_t kDecodeH2D = 5;
   static const stream_index_t kNcclComputeBegin = 10;
   static const stream_index_t kNcclComputeEnd = 17;
+  static const stream_index_t kInstanceComputeBegin = 20;
+  static const stream_index_t kInstanceComputeEnd = 27;
+  static const stream_index_t kBranchComputeBegin = 30;
+  static const stream_index_t kBranchComputeEnd = 37;
+
+  HashMap<int64_t, stream_index_t> job_id2instance_compute_stream_index_;
 };
 
 }  // namespace oneflow
@@ -61,6 +61,14 @@ const char* CurandGetErrorString(curandStatus_t error) {
   return "Unknown curand status";
 }
 
+const char* CuGetErrorString(CUresult error) {
+  const char* error_string = nullptr;
+  if (cuGetErrorString(error, &error_string) != CUDA_SUCCESS || error_string == nullptr) {
+    return "Unknown cu status";
+  }
+  return error_string;
+}
+
 #if CUDA_VERSION >= 10020
 
 const char* NvjpegGetErrorString(nvjpegStatus_t error) {
@@ -168,6 +176,56 @@ cudaDataType_t GetCudaDataType(DataType val) {
   UNIMPLEMENTED();
 }
 
+namespace {
+
+std::vector<std::vector<bool>> ProbeCudaPeerAccess() {
+  std::vector<std::vector<bool>> peer_access;
+  if (!ParseBooleanFromEnv("ONEFLOW_CUDA_ENABLE_P2P_COPY", true)) { return peer_access; }
+  int device_count = 0;
+  if (cudaGetDeviceCount(&device_count) != cudaSuccess) {
+    // no device on this host
+    cudaGetLastError();
+    return peer_access;
+  }
+  peer_access.resize(device_count, std::vector<bool>(device_count, false));
+  FOR_RANGE(int, dst_dev, 0, device_count) {
+    FOR_RANGE(int, src_dev, 0, device_count) {
+      if (src_dev == dst_dev) { continue; }
+      int can_access = 0;
+      OF_CUDA_CHECK(cudaDeviceCanAccessPeer(&can_access, dst_dev, src_dev));
+      peer_access.at(dst_dev).at(src_dev) = can_access != 0;
+    }
+  }
+  return peer_access;
+}
+
+}  // namespace
+
+bool IsCudaPeerAccessSupported(int32_t src_dev, int32_t dst_dev) {
+  static const std::vector<std::vector<bool>> peer_access = ProbeCudaPeerAccess();
+  const int32_t device_count = peer_access.size();
+  if (src_dev < 0 || src_dev >= device_count || dst_dev < 0 || dst_dev >= device_count) {
+    return false;
+  }
+  return peer_access.at(dst_dev).at(src_dev);
+}
+
+void EnableCudaPeerAccessFromCurrentDevice() {
+  int dst_dev = 0;
+  int device_count = 0;
+  OF_CUDA_CHECK(cudaGetDevice(&dst_dev));
+  OF_CUDA_CHECK(cudaGetDeviceCount(&device_count));
+  FOR_RANGE(int, src_dev, 0, device_count) {
+    if (!IsCudaPeerAccessSupported(src_dev, dst_dev)) { continue; }
+    const cudaError_t err = cudaDeviceEnablePeerAccess(src_dev, 0);
+    if (err == cudaErrorPeerAccessAlreadyEnabled) {
+      cudaGetLastError();
+    } else {
+      OF_CUDA_CHECK(err);
+    }
+  }
+}
+
 CudaCurrentDeviceGuard::CudaCurrentDeviceGuard(int32_t dev_id) {
   OF_CUDA_CHECK(cudaGetDevice(&saved_dev_id_));
   OF_CUDA_CHECK(cudaSetDevice(dev_id));
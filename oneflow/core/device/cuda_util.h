@@ -41,6 +41,8 @@ const char* CublasGetErrorString(cublasStatus_t error);
 
 const char* CurandGetErrorString(curandStatus_t error);
 
+const char* CuGetErrorString(CUresult error);
+
 #if CUDA_VERSION >= 10020
 
 const char* NvjpegGetErrorString(nvjpegStatus_t error);
@@ -52,6 +54,11 @@ const char* NvjpegGetErrorString(nvjpegStatus_t error);
   LOG(FATAL) << "Check failed: " #condition " : " << cudaGetErrorString(_of_cuda_check_status) \
              << " (" << _of_cuda_check_status << ") "
 
+#define OF_CU_CHECK(condition)                                                             \
+  for (CUresult _of_cu_check_status = (condition); _of_cu_check_status != CUDA_SUCCESS;)   \
+  LOG(FATAL) << "Check failed: " #condition " : " << CuGetErrorString(_of_cu_check_status) \
+             << " (" << _of_cu_check_status << ") "
+
 #define OF_CUDNN_CHECK(condition)                                                                \
   for (cudnnStatus_t _of_cudnn_check_status = (condition);                                       \
        _of_cudnn_check_status != CUDNN_STATUS_SUCCESS;)                                          \
@@ -114,6 +121,13 @@ inline int32_t BlocksNum4ThreadsNum(const int32_t n) {
   return std::min((n + kCudaThreadsNumPerBlock - 1) / kCudaThreadsNumPerBlock, kCudaMaxBlocksNum);
 }
 
+// For kernels that grid-stride over rows with one warp per row.
+inline int32_t BlocksNum4Warps(const int64_t n) {
+  CHECK_GT(n, 0);
+  const int64_t warps_per_block = kCudaThreadsNumPerBlock / kCudaWarpSize;
+  return std::min<int64_t>((n + warps_per_block - 1) / warps_per_block, kCudaMaxBlocksNum);
+}
+
 inline int32_t SMBlocksNum4ThreadsNum(const int32_t n) {
   CHECK_GT(n, 0);
   return std::min((n + kCudaThreadsNumPerBlock - 1) / kCudaThreadsNumPerBlock,
@@ -151,10 +165,25 @@ void NumaAwareCudaMallocHost(int32_t dev, T** ptr, size_t size) {
 // Set the CPU affinity to the closest processor(s) of a particular GPU.
 void CudaDeviceSetCpuAffinity(int32_t dev);
 
-#define CUDA_DATA_TYPE_SEQ                 \
-  OF_PP_MAKE_TUPLE_SEQ(float, CUDA_R_32F)  \
-  OF_PP_MAKE_TUPLE_SEQ(double, CUDA_R_64F) \
-  OF_PP_MAKE_TUPLE_SEQ(float16, CUDA_R_16F)
+// Whether dst_dev can access the memory of src_dev directly, over NVLink or PCIe peer to peer.
+// Probed once per process on the local devices and assumed for every node, so the
+// environment variable ONEFLOW_CUDA_ENABLE_P2P_COPY=0 turns it off for heterogeneous clusters.
+bool IsCudaPeerAccessSupported(int32_t src_dev, int32_t dst_dev);
+
+// Enables access from the current device to every peer IsCudaPeerAccessSupported allows
+void EnableCudaPeerAccessFromCurrentDevice();
+
+#if CUDA_VERSION >= 11000
+#define CUDA_BFLOAT16_DATA_TYPE_SEQ OF_PP_MAKE_TUPLE_SEQ(bfloat16, CUDA_R_16BF)
+#else
+#define CUDA_BFLOAT16_DATA_TYPE_SEQ
+#endif
+
+#define CUDA_DATA_TYPE_SEQ                  \
+  OF_PP_MAKE_TUPLE_SEQ(float, CUDA_R_32F)   \
+  OF_PP_MAKE_TUPLE_SEQ(double, CUDA_R_64F)  \
+  OF_PP_MAKE_TUPLE_SEQ(float16, CUDA_R_16F) \
+  CUDA_BFLOAT16_DATA_TYPE_SEQ
 
 cudaDataType_t GetCudaDataType(DataType);
 
@@ -20,8 +20,10 @@ limitations under the License.
 #include "oneflow/core/operator/operator_util.h"
 #include "oneflow/core/job/resource_desc.h"
 #include "oneflow/core/job/global_for.h"
-#include "oneflow/core/job/global_for.h"
 #include "oneflow/core/framework/op_kernel.h"
+#include "oneflow/core/device/cudnn_conv_algo_cache.pb.h"
+#include <fstream>
+#include <unistd.h>
 
 namespace oneflow {
 
@@ -184,6 +186,151 @@ cudnnConvolutionBwdFilterAlgoPerf_t CudnnConvAlgoCache::Remember(
       params, InferFn, &bwd_filter_algo_store_, &bwd_filter_algo_cache_mutex_);
 }
 
+namespace {
+
+template<typename perf_t>
+char PersistentKind();
+
+template<>
+char PersistentKind<cudnnConvolutionFwdAlgoPerf_t>() {
+  return 'f';
+}
+
+template<>
+char PersistentKind<cudnnConvolutionBwdDataAlgoPerf_t>() {
+  return 'd';
+}
+
+template<>
+char PersistentKind<cudnnConvolutionBwdFilterAlgoPerf_t>() {
+  return 'w';
+}
+
+template<typename perf_t>
+std::string MakePersistentKey(const CudnnConvParams& params, bool deterministic) {
+  std::string key;
+  key.push_back(PersistentKind<perf_t>());
+  key.push_back(deterministic ? 1 : 0);
+  key.append(reinterpret_cast<const char*>(&params), sizeof(CudnnConvParams));
+  return key;
+}
+
+bool ReadCudnnConvAlgoCacheFile(const std::string& path, CudnnConvAlgoCacheFile* file) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in.is_open()) { return false; }
+  if (!file->ParseFromIstream(&in)) {
+    LOG(WARNING) << "Ignore the unreadable cudnn conv algo cache file " << path;
+    file->Clear();
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+CudnnConvAlgoCache::CudnnConvAlgoCache()
+    : persistent_file_(GetStringFromEnv("ONEFLOW_CUDNN_CONV_ALGO_CACHE_FILE", "")),
+      persistent_store_updated_(false) {
+  if (!persistent_file_.empty()) { LoadPersistent(); }
+}
+
+CudnnConvAlgoCache::~CudnnConvAlgoCache() {
+  if (persistent_store_updated_) { SavePersistent(); }
+}
+
+void CudnnConvAlgoCache::LoadPersistent() {
+  CudnnConvAlgoCacheFile file;
+  if (!ReadCudnnConvAlgoCacheFile(persistent_file_, &file)) { return; }
+  const int64_t cudnn_version = cudnnGetVersion();
+  for (const auto& section : file.section()) {
+    if (section.cudnn_version() != cudnn_version) { continue; }
+    auto* store = &persistent_store_[section.gpu_model()];
+    for (const auto& entry : section.entry()) { (*store)[entry.key()] = entry.perf(); }
+  }
+}
+
+void CudnnConvAlgoCache::SavePersistent() {
+  // Other processes may have saved since this one loaded, so what is on disk now is merged in.
+  CudnnConvAlgoCacheFile file;
+  ReadCudnnConvAlgoCacheFile(persistent_file_, &file);
+  const int64_t cudnn_version = cudnnGetVersion();
+  HashMap<std::string, CudnnConvAlgoCacheSection*> gpu_model2section;
+  for (auto& section : *file.mutable_section()) {
+    if (section.cudnn_version() == cudnn_version) {
+      gpu_model2section[section.gpu_model()] = &section;
+    }
+  }
+  for (const auto& gpu_model7store : persistent_store_) {
+    CudnnConvAlgoCacheSection* section = nullptr;
+    const auto it = gpu_model2section.find(gpu_model7store.first);
+    if (it == gpu_model2section.end()) {
+      section = file.add_section();
+      section->set_gpu_model(gpu_model7store.first);
+      section->set_cudnn_version(cudnn_version);
+    } else {
+      section = it->second;
+    }
+    HashSet<std::string> saved_keys;
+    for (const auto& entry : section->entry()) { saved_keys.insert(entry.key()); }
+    for (const auto& key7perf : gpu_model7store.second) {
+      if (saved_keys.count(key7perf.first) > 0) { continue; }
+      auto* entry = section->add_entry();
+      entry->set_key(key7perf.first);
+      entry->set_perf(key7perf.second);
+    }
+  }
+  // Renaming a complete file keeps concurrent readers from seeing a partial one.
+  const std::string tmp_file = persistent_file_ + ".tmp." + std::to_string(getpid());
+  {
+    std::ofstream out(tmp_file, std::ios::binary | std::ios::trunc);
+    if (!out.is_open() || !file.SerializeToOstream(&out)) {
+      LOG(WARNING) << "Failed to write the cudnn conv algo cache file " << tmp_file;
+      return;
+    }
+  }
+  if (std::rename(tmp_file.c_str(), persistent_file_.c_str()) != 0) {
+    LOG(WARNING) << "Failed to rename " << tmp_file << " to " << persistent_file_;
+    std::remove(tmp_file.c_str());
+  }
+}
+
+const std::string& CudnnConvAlgoCache::CurrentGpuModel() {
+  int device_id = 0;
+  OF_CUDA_CHECK(cudaGetDevice(&device_id));
+  auto it = device_id2gpu_model_.find(device_id);
+  if (it == device_id2gpu_model_.end()) {
+    cudaDeviceProp prop;
+    OF_CUDA_CHECK(cudaGetDeviceProperties(&prop, device_id));
+    const std::string gpu_model =
+        std::string(prop.name) + " sm_" + std::to_string(prop.major) + std::to_string(prop.minor);
+    it = device_id2gpu_model_.emplace(device_id, gpu_model).first;
+  }
+  return it->second;
+}
+
+template<typename perf_t>
+bool CudnnConvAlgoCache::FindPersistent(const CudnnConvParams& params, bool deterministic,
+                                        perf_t* perf) {
+  if (persistent_file_.empty()) { return false; }
+  std::unique_lock<std::mutex> lock(persistent_store_mutex_);
+  const auto store_it = persistent_store_.find(CurrentGpuModel());
+  if (store_it == persistent_store_.end()) { return false; }
+  const auto it = store_it->second.find(MakePersistentKey<perf_t>(params, deterministic));
+  if (it == store_it->second.end() || it->second.size() != sizeof(perf_t)) { return false; }
+  std::memcpy(perf, it->second.data(), sizeof(perf_t));
+  return true;
+}
+
+template<typename perf_t>
+void CudnnConvAlgoCache::AddPersistent(const CudnnConvParams& params, bool deterministic,
+                                       const perf_t& perf) {
+  if (persistent_file_.empty()) { return; }
+  std::unique_lock<std::mutex> lock(persistent_store_mutex_);
+  persistent_store_[CurrentGpuModel()][MakePersistentKey<perf_t>(params, deterministic)] =
+      std::string(reinterpret_cast<const char*>(&perf), sizeof(perf_t));
+  persistent_store_updated_ = true;
+}
+
 CudnnConvDesc::~CudnnConvDesc() { OF_CUDNN_CHECK(cudnnDestroyConvolutionDescriptor(val_)); }
 
 CudnnConvDesc::CudnnConvDesc(const DataType compute_type, const DataType data_type,
@@ -514,10 +661,16 @@ perf_t FindCudnnConvAlgorithmWithResource(CudnnConvArgs* args, CudnnConvResource
     std::vector<perf_t> perf_vec;
     if (args->heuristic) {
       CudnnConvAlgorithmSearch<perf_t>::HeuristicSearch(*args, res, &perf_vec);
-    } else {
-      CudnnConvAlgorithmSearch<perf_t>::ExhaustiveSearch(*args, res, &perf_vec);
+      return GetBestAlgorithm<perf_t>(*args, res, perf_vec);
     }
-    return GetBestAlgorithm<perf_t>(*args, res, perf_vec);
+    // Only exhaustive searches are worth persisting, heuristic ones are cheap.
+    auto* cache = Global<CudnnConvAlgoCache>::Get();
+    perf_t perf;
+    if (cache->FindPersistent<perf_t>(params, args->deterministic, &perf)) { return perf; }
+    CudnnConvAlgorithmSearch<perf_t>::ExhaustiveSearch(*args, res, &perf_vec);
+    perf = GetBestAlgorithm<perf_t>(*args, res, perf_vec);
+    cache->AddPersistent<perf_t>(params, args->deterministic, perf);
+    return perf;
   };
   return Global<CudnnConvAlgoCache>::Get()->Remember<perf_t>(args->params, Infer);
 }
@@ -208,11 +208,14 @@ struct hash<oneflow::CudnnConvParams> final {
 
 namespace oneflow {
 
+// When ONEFLOW_CUDNN_CONV_ALGO_CACHE_FILE is set, the results of exhaustive searches are also
+// kept per GPU model and cuDNN version in that file, which is loaded on construction and merged
+// with the results of this process on destruction.
 class CudnnConvAlgoCache final {
  public:
   OF_DISALLOW_COPY_AND_MOVE(CudnnConvAlgoCache);
-  CudnnConvAlgoCache() = default;
-  ~CudnnConvAlgoCache() = default;
+  CudnnConvAlgoCache();
+  ~CudnnConvAlgoCache();
 
   template<typename perf_t>
   using WorkspaceSizeAndPerfT = std::pair<size_t, perf_t>;
@@ -223,13 +226,28 @@ class CudnnConvAlgoCache final {
   perf_t Remember(const CudnnConvParams& params,
                   const std::function<perf_t(const CudnnConvParams& param)>& InferFn);
 
+  template<typename perf_t>
+  bool FindPersistent(const CudnnConvParams& params, bool deterministic, perf_t* perf);
+  template<typename perf_t>
+  void AddPersistent(const CudnnConvParams& params, bool deterministic, const perf_t& perf);
+
  private:
+  void LoadPersistent();
+  void SavePersistent();
+  const std::string& CurrentGpuModel();
+
   Store<cudnnConvolutionFwdAlgoPerf_t> fwd_algo_store_;
   std::mutex fwd_algo_store_mutex_;
   Store<cudnnConvolutionBwdDataAlgoPerf_t> bwd_data_algo_store_;
   std::mutex bwd_data_algo_store_mutex_;
   Store<cudnnConvolutionBwdFilterAlgoPerf_t> bwd_filter_algo_store_;
   std::mutex bwd_filter_algo_cache_mutex_;
+  std::string persistent_file_;
+  // gpu model -> (key -> perf bytes), of the cuDNN version of this process
+  HashMap<std::string, HashMap<std::string, std::string>> persistent_store_;
+  HashMap<int, std::string> device_id2gpu_model_;
+  bool persistent_store_updated_;
+  std::mutex persistent_store_mutex_;
 };
 
 }  // namespace oneflow
@@ -25,12 +25,19 @@ limitations under the License.
 
 namespace oneflow {
 
+#if CUDNN_VERSION >= 8100
+#define CUDNN_BFLOAT16_DATA_TYPE_SEQ OF_PP_MAKE_TUPLE_SEQ(bfloat16, CUDNN_DATA_BFLOAT16)
+#else
+#define CUDNN_BFLOAT16_DATA_TYPE_SEQ
+#endif
+
 #define CUDNN_DATA_TYPE_SEQ                       \
   OF_PP_MAKE_TUPLE_SEQ(float, CUDNN_DATA_FLOAT)   \
   OF_PP_MAKE_TUPLE_SEQ(float16, CUDNN_DATA_HALF)  \
   OF_PP_MAKE_TUPLE_SEQ(double, CUDNN_DATA_DOUBLE) \
   OF_PP_MAKE_TUPLE_SEQ(int8_t, CUDNN_DATA_INT8)   \
-  OF_PP_MAKE_TUPLE_SEQ(int32_t, CUDNN_DATA_INT32)
+  OF_PP_MAKE_TUPLE_SEQ(int32_t, CUDNN_DATA_INT32) \
+  CUDNN_BFLOAT16_DATA_TYPE_SEQ
 
 cudnnDataType_t GetCudnnDataType(DataType);
 
@@ -24,6 +24,7 @@ namespace oneflow {
 namespace vm {
 
 class Allocator;
+class WorkspaceArena;
 
 }  // namespace vm
 
@@ -57,11 +58,20 @@ class DeviceCtx {
 
   virtual void SyncDevice() { UNIMPLEMENTED(); }
   virtual void AddCallBack(std::function<void()>) const { UNIMPLEMENTED(); }
+  // Splits [0, num) into chunks of at least `grain_size' elements and calls `Callback' on them,
+  // in parallel if the device runs host loops on several threads. Returns after all are done.
+  virtual void ParallelFor(int64_t num, int64_t grain_size,
+                           const std::function<void(int64_t begin, int64_t end)>& Callback) const {
+    if (num > 0) { Callback(0, num); }
+  }
 
   virtual vm::Allocator* mut_allocator() {
     UNIMPLEMENTED();
     return nullptr;
   }
+  // The arena the eager kernels of the stream take their tmp buffers from, nullptr if the stream
+  // allocates them from mut_allocator() on each launch.
+  virtual vm::WorkspaceArena* mut_workspace_arena() { return nullptr; }
 
  protected:
   DeviceCtx() = default;
@@ -69,6 +79,13 @@ class DeviceCtx {
  private:
 };
 
+// The grain size of DeviceCtx::ParallelFor for elements that cost about `cost_per_elem' simple
+// operations each, big enough for a chunk to amortize the dispatch to another thread
+inline int64_t ParallelForGrainSize(int64_t cost_per_elem) {
+  const int64_t kMinCostPerChunk = 32768;
+  return std::max<int64_t>(kMinCostPerChunk / std::max<int64_t>(cost_per_elem, 1), 1);
+}
+
 #define REGISTER_DEVICE_CONTEXT(device, creator) \
   REGISTER_CLASS_CREATOR(int, device, DeviceCtx, creator, const ThreadCtx&)
 
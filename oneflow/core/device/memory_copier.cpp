@@ -14,6 +14,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #include "oneflow/core/device/memory_copier.h"
+#include "oneflow/core/device/cuda_pinned_staging.h"
 #include "oneflow/core/common/auto_registration_factory.h"
 #include "oneflow/core/common/nd_index_offset_helper.h"
 
@@ -162,6 +163,14 @@ void MemoryCopier::Copy(DeviceCtx* ctx, void* dst, const void* src,
   }
 }
 
+void MemoryCopier::BatchCopy(DeviceCtx* ctx, const std::vector<void*>& dst,
+                             const std::vector<const void*>& src,
+                             const std::vector<const MemoryCopyNdDesc*>& desc) const {
+  CHECK_EQ(dst.size(), desc.size());
+  CHECK_EQ(src.size(), desc.size());
+  FOR_RANGE(size_t, i, 0, desc.size()) { Copy(ctx, dst.at(i), src.at(i), *desc.at(i)); }
+}
+
 template<typename T>
 void MemoryCopier::CopyElem(DeviceCtx* ctx, void* dst, const void* src,
                             const MemoryCopyNdDesc& desc) const {
@@ -230,7 +239,9 @@ bool CanCurDevAccessPointer(const void* ptr) {
   OF_CUDA_CHECK(cudaGetDevice(&device_id));
   cudaPointerAttributes attributes;
   OF_CUDA_CHECK(cudaPointerGetAttributes(&attributes, ptr));
-  return (attributes.type == cudaMemoryTypeDevice && attributes.device == device_id)
+  return (attributes.type == cudaMemoryTypeDevice
+          && (attributes.device == device_id
+              || IsCudaPeerAccessSupported(attributes.device, device_id)))
          || (attributes.type == cudaMemoryTypeHost);
 }
 
@@ -275,8 +286,35 @@ void CudaAsyncMemoryCopier::Copy(DeviceCtx* ctx, void* dst, const void* src,
   }
 }
 
+void CudaAsyncMemoryCopier::BatchCopy(DeviceCtx* ctx, const std::vector<void*>& dst,
+                                      const std::vector<const void*>& src,
+                                      const std::vector<const MemoryCopyNdDesc*>& desc) const {
+  CHECK_EQ(dst.size(), desc.size());
+  CHECK_EQ(src.size(), desc.size());
+  std::vector<void*> batch_dst;
+  std::vector<const void*> batch_src;
+  std::vector<const MemoryCopyNdDesc*> batch_desc;
+  FOR_RANGE(size_t, i, 0, desc.size()) {
+    const MemoryCopyNdDesc& desc_i = *desc.at(i);
+    CheckMemoryCopyNdDesc(desc_i);
+    if (MemoryCopyNdDescGetNumAxes(desc_i) > 0 && CanCurDevAccessPointer(dst.at(i))
+        && CanCurDevAccessPointer(src.at(i))) {
+      batch_dst.push_back(dst.at(i));
+      batch_src.push_back(src.at(i));
+      batch_desc.push_back(&desc_i);
+    } else {
+      Copy(ctx, dst.at(i), src.at(i), desc_i);
+    }
+  }
+  if (batch_desc.size() == 1) {
+    Copy(ctx, batch_dst.front(), batch_src.front(), *batch_desc.front());
+  } else if (batch_desc.size() > 1) {
+    BatchCopyNDGpuImpl(ctx, batch_dst, batch_src, batch_desc);
+  }
+}
+
 void CudaAsyncMemoryCopier::Copy1D(DeviceCtx* ctx, void* dst, const void* src, size_t count) const {
-  OF_CUDA_CHECK(cudaMemcpyAsync(dst, src, count, cudaMemcpyDefault, ctx->cuda_stream()));
+  CudaMemcpyAsyncStaged(ctx->cuda_stream(), dst, src, count);
 }
 
 void CudaAsyncMemoryCopier::Copy2D(DeviceCtx* ctx, void* dst, size_t dst_pitch, const void* src,
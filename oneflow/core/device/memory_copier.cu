@@ -67,6 +67,134 @@ size_t GetPackSize(const MemoryCopyNdDesc& desc, const void* dst, const void* sr
   }
 }
 
+constexpr int32_t kBatchCopyNDGpuMaxNumDims = 6;
+constexpr int32_t kBatchCopyNDGpuMaxBatchSize = 16;
+
+template<int32_t NDIMS, typename I>
+struct BatchCopyNDItem {
+  void* dst;
+  const void* src;
+  I copy_stride[NDIMS];
+  I dst_stride[NDIMS];
+  I src_stride[NDIMS];
+  I elem_cnt;
+};
+
+template<int32_t NDIMS, typename I>
+struct BatchCopyNDParams {
+  BatchCopyNDItem<NDIMS, I> items[kBatchCopyNDGpuMaxBatchSize];
+};
+
+template<int32_t NDIMS, typename P, typename I>
+__global__ void BatchCopyNDGpu(BatchCopyNDParams<NDIMS, I> params) {
+  const BatchCopyNDItem<NDIMS, I>& item = params.items[blockIdx.y];
+  P* dst = reinterpret_cast<P*>(item.dst);
+  const P* src = reinterpret_cast<const P*>(item.src);
+  CUDA_1D_KERNEL_LOOP_T(I, i, item.elem_cnt) {
+    I remaining = i;
+    I dst_offset = 0;
+    I src_offset = 0;
+#pragma unroll
+    for (int32_t j = 0; j < NDIMS - 1; ++j) {
+      const I idx = remaining / item.copy_stride[j];
+      remaining -= idx * item.copy_stride[j];
+      dst_offset += idx * item.dst_stride[j];
+      src_offset += idx * item.src_stride[j];
+    }
+    dst[dst_offset + remaining] = src[src_offset + remaining];
+  }
+}
+
+void FillStride(const int64_t num_axes, const int64_t* dim, const size_t pack_size,
+                int64_t* stride) {
+  stride[num_axes - 1] = 1;
+  for (int64_t i = num_axes - 2; i >= 0; --i) {
+    const int64_t next_dim = (i == num_axes - 2) ? dim[i + 1] / pack_size : dim[i + 1];
+    stride[i] = stride[i + 1] * next_dim;
+  }
+}
+
+template<int32_t NDIMS, typename P, typename I>
+void BatchCopyNDByPackByIndexTypeGpu(DeviceCtx* ctx, const std::vector<void*>& dst,
+                                     const std::vector<const void*>& src,
+                                     const std::vector<const MemoryCopyNdDesc*>& desc) {
+  constexpr size_t pack_size = sizeof(P);
+  for (size_t begin = 0; begin < desc.size(); begin += kBatchCopyNDGpuMaxBatchSize) {
+    const size_t end = std::min(begin + kBatchCopyNDGpuMaxBatchSize, desc.size());
+    BatchCopyNDParams<NDIMS, I> params{};
+    int64_t max_elem_cnt = 0;
+    FOR_RANGE(size_t, i, begin, end) {
+      const MemoryCopyNdDesc& d = *desc.at(i);
+      const int64_t num_axes = d.extent.NumAxes();
+      CHECK_LE(num_axes, NDIMS);
+      int64_t copy_stride[NDIMS];
+      int64_t dst_stride[NDIMS];
+      int64_t src_stride[NDIMS];
+      FillStride(num_axes, d.extent.dim_vec().data(), pack_size, copy_stride);
+      FillStride(num_axes, d.dst_shape.dim_vec().data(), pack_size, dst_stride);
+      FillStride(num_axes, d.src_shape.dim_vec().data(), pack_size, src_stride);
+      int64_t dst_offset = 0;
+      int64_t src_offset = 0;
+      FOR_RANGE(int64_t, j, 0, num_axes) {
+        const int64_t div = (j == num_axes - 1) ? pack_size : 1;
+        dst_offset += d.dst_pos.At(j) / div * dst_stride[j];
+        src_offset += d.src_pos.At(j) / div * src_stride[j];
+      }
+      const int64_t elem_cnt = d.extent.elem_cnt() / pack_size;
+      BatchCopyNDItem<NDIMS, I>& item = params.items[i - begin];
+      item.dst = reinterpret_cast<P*>(dst.at(i)) + dst_offset;
+      item.src = reinterpret_cast<const P*>(src.at(i)) + src_offset;
+      item.elem_cnt = elem_cnt;
+      // leading axes are padded with extent 1, so their index is always zero
+      FOR_RANGE(int64_t, j, 0, NDIMS) {
+        const int64_t k = j - (NDIMS - num_axes);
+        item.copy_stride[j] = k < 0 ? elem_cnt : copy_stride[k];
+        item.dst_stride[j] = k < 0 ? 0 : dst_stride[k];
+        item.src_stride[j] = k < 0 ? 0 : src_stride[k];
+      }
+      max_elem_cnt = std::max(max_elem_cnt, elem_cnt);
+    }
+    const dim3 grid_dim(BlocksNum4ThreadsNum(max_elem_cnt), end - begin);
+    BatchCopyNDGpu<NDIMS, P, I>
+        <<<grid_dim, kCudaThreadsNumPerBlock, 0, ctx->cuda_stream()>>>(params);
+  }
+}
+
+template<int32_t NDIMS, typename P>
+void BatchCopyNDByPackGpu(DeviceCtx* ctx, const std::vector<void*>& dst,
+                          const std::vector<const void*>& src,
+                          const std::vector<const MemoryCopyNdDesc*>& desc) {
+  int64_t max_elem_cnt = 0;
+  for (const MemoryCopyNdDesc* d : desc) {
+    max_elem_cnt = std::max({max_elem_cnt, d->dst_shape.elem_cnt(), d->src_shape.elem_cnt()});
+  }
+  if (max_elem_cnt > static_cast<int64_t>(GetMaxVal<int32_t>() / 2)) {
+    BatchCopyNDByPackByIndexTypeGpu<NDIMS, P, int64_t>(ctx, dst, src, desc);
+  } else {
+    BatchCopyNDByPackByIndexTypeGpu<NDIMS, P, int32_t>(ctx, dst, src, desc);
+  }
+}
+
+template<int32_t NDIMS>
+void BatchCopyNDGpuByNumDims(DeviceCtx* ctx, const std::vector<void*>& dst,
+                             const std::vector<const void*>& src,
+                             const std::vector<const MemoryCopyNdDesc*>& desc,
+                             const size_t pack_size) {
+  if (pack_size == 1) {
+    BatchCopyNDByPackGpu<NDIMS, uint8_t>(ctx, dst, src, desc);
+  } else if (pack_size == 2) {
+    BatchCopyNDByPackGpu<NDIMS, uint16_t>(ctx, dst, src, desc);
+  } else if (pack_size == 4) {
+    BatchCopyNDByPackGpu<NDIMS, uint32_t>(ctx, dst, src, desc);
+  } else if (pack_size == 8) {
+    BatchCopyNDByPackGpu<NDIMS, uint64_t>(ctx, dst, src, desc);
+  } else if (pack_size == 16) {
+    BatchCopyNDByPackGpu<NDIMS, uint4>(ctx, dst, src, desc);
+  } else {
+    UNIMPLEMENTED();
+  }
+}
+
 }  // namespace
 
 template<int32_t NDIMS, typename P, typename I>
@@ -137,6 +265,35 @@ void CopyNDGpuImpl(DeviceCtx* ctx, void* dst, const void* src, const MemoryCopyN
   }
 }
 
+void BatchCopyNDGpuImpl(DeviceCtx* ctx, const std::vector<void*>& dst,
+                        const std::vector<const void*>& src,
+                        const std::vector<const MemoryCopyNdDesc*>& desc) {
+  CHECK_EQ(dst.size(), desc.size());
+  CHECK_EQ(src.size(), desc.size());
+  if (desc.empty()) { return; }
+  int64_t max_num_axes = 0;
+  size_t pack_size = 16;
+  FOR_RANGE(size_t, i, 0, desc.size()) {
+    CHECK_GT(desc.at(i)->extent.NumAxes(), 0);
+    max_num_axes = std::max(max_num_axes, desc.at(i)->extent.NumAxes());
+    pack_size = std::min(pack_size, GetPackSize(*desc.at(i), dst.at(i), src.at(i)));
+  }
+  CHECK_LE(max_num_axes, kBatchCopyNDGpuMaxNumDims);
+  if (max_num_axes == 1) {
+    BatchCopyNDGpuByNumDims<1>(ctx, dst, src, desc, pack_size);
+  } else if (max_num_axes == 2) {
+    BatchCopyNDGpuByNumDims<2>(ctx, dst, src, desc, pack_size);
+  } else if (max_num_axes == 3) {
+    BatchCopyNDGpuByNumDims<3>(ctx, dst, src, desc, pack_size);
+  } else if (max_num_axes == 4) {
+    BatchCopyNDGpuByNumDims<4>(ctx, dst, src, desc, pack_size);
+  } else if (max_num_axes == 5) {
+    BatchCopyNDGpuByNumDims<5>(ctx, dst, src, desc, pack_size);
+  } else {
+    BatchCopyNDGpuByNumDims<6>(ctx, dst, src, desc, pack_size);
+  }
+}
+
 #define SPECIALIZE_COPY_ND_GPU_IMPL(NDIMS)                                        \
   template void CopyNDGpuImpl<NDIMS>(DeviceCtx * ctx, void* dst, const void* src, \
                                      const MemoryCopyNdDesc& desc);
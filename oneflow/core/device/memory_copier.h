@@ -39,6 +39,10 @@ void CopyNDCpuImpl(DeviceCtx* ctx, void* dst, const void* src, const MemoryCopyN
 #ifdef WITH_CUDA
 template<int32_t NDIMS>
 void CopyNDGpuImpl(DeviceCtx* ctx, void* dst, const void* src, const MemoryCopyNdDesc& desc);
+// One kernel launch per chunk of descs, all dst and src must be accessible from the current device
+void BatchCopyNDGpuImpl(DeviceCtx* ctx, const std::vector<void*>& dst,
+                        const std::vector<const void*>& src,
+                        const std::vector<const MemoryCopyNdDesc*>& desc);
 #endif
 
 class MemoryCopier {
@@ -48,6 +52,9 @@ class MemoryCopier {
   virtual ~MemoryCopier() = default;
 
   virtual void Copy(DeviceCtx* ctx, void* dst, const void* src, const MemoryCopyNdDesc& desc) const;
+  virtual void BatchCopy(DeviceCtx* ctx, const std::vector<void*>& dst,
+                         const std::vector<const void*>& src,
+                         const std::vector<const MemoryCopyNdDesc*>& desc) const;
 
   template<typename T>
   void CopyElem(DeviceCtx* ctx, void* dst, const void* src, const MemoryCopyNdDesc& desc) const;
@@ -85,6 +92,8 @@ class CudaAsyncMemoryCopier final : public MemoryCopier {
  private:
   void Copy(DeviceCtx* ctx, void* dst, const void* src,
             const MemoryCopyNdDesc& desc) const override;
+  void BatchCopy(DeviceCtx* ctx, const std::vector<void*>& dst, const std::vector<const void*>& src,
+                 const std::vector<const MemoryCopyNdDesc*>& desc) const override;
   void Copy1D(DeviceCtx* ctx, void* dst, const void* src, size_t count) const override;
   void Copy2D(DeviceCtx* ctx, void* dst, size_t dst_pitch, const void* src, size_t src_pitch,
               size_t width, size_t height) const override;
@@ -36,6 +36,9 @@ inline ncclDataType_t GetNcclDataType(const DataType& dt) {
     NCCL_DATA_TYPE_CASE(Int32);
     NCCL_DATA_TYPE_CASE(Int64);
     NCCL_DATA_TYPE_CASE(Float16);
+#if NCCL_VERSION_CODE >= 21000
+    case DataType::kBFloat16: return ncclDataType_t::ncclBfloat16;
+#endif
     default: UNIMPLEMENTED();
   }
 }
@@ -17,6 +17,7 @@ limitations under the License.
 #include "oneflow/core/device/device_descriptor_class.h"
 #include "oneflow/core/common/str_util.h"
 #include "oneflow/core/persistence/tee_persistent_log_stream.h"
+#include <future>
 #include <json.hpp>
 #ifdef WITH_HWLOC
 #include <hwloc.h>
@@ -320,15 +321,25 @@ void NodeDeviceDescriptor::DumpSummary(const std::string& path) const {
 
 std::shared_ptr<const NodeDeviceDescriptor> NodeDeviceDescriptor::Query() {
   auto* desc = new NodeDeviceDescriptor();
-  desc->impl_->host_memory_size_bytes = GetAvailableCpuMemSize();
+  // Loading the topology and querying each class of devices are independent and each may take
+  // hundreds of milliseconds, so they run concurrently.
+  std::future<std::shared_ptr<const TopologyDescriptor>> topology =
+      std::async(std::launch::async, QueryTopologyDescriptor);
   const size_t num_classes = DeviceDescriptorClass::GetRegisteredClassesCount();
+  std::vector<std::future<std::shared_ptr<const DeviceDescriptorList>>> descriptor_lists;
   for (size_t i = 0; i < num_classes; ++i) {
     std::shared_ptr<const DeviceDescriptorClass> descriptor_class =
         DeviceDescriptorClass::GetRegisteredClass(i);
-    desc->impl_->class_name2descriptor_list.emplace(descriptor_class->Name(),
-                                                    descriptor_class->QueryDeviceDescriptorList());
+    descriptor_lists.emplace_back(std::async(std::launch::async, [descriptor_class]() {
+      return descriptor_class->QueryDeviceDescriptorList();
+    }));
+  }
+  desc->impl_->host_memory_size_bytes = GetAvailableCpuMemSize();
+  for (size_t i = 0; i < num_classes; ++i) {
+    desc->impl_->class_name2descriptor_list.emplace(
+        DeviceDescriptorClass::GetRegisteredClass(i)->Name(), descriptor_lists.at(i).get());
   }
-  desc->impl_->topology = QueryTopologyDescriptor();
+  desc->impl_->topology = topology.get();
   return std::shared_ptr<const NodeDeviceDescriptor>(desc);
 }
 
@@ -45,12 +45,17 @@ NodeDeviceDescriptorManager::NodeDeviceDescriptorManager() {
     local->Serialize(&serialized_local_node);
     Global<CtrlClient>::Get()->PushKV(MakeNodeDeviceDescriptorRpcKey(impl_->rank),
                                       serialized_local_node);
+    std::vector<int64_t> peers;
+    std::vector<std::string> keys;
     for (int64_t i = 0; i < impl_->nodes.size(); ++i) {
       if (i == impl_->rank) { continue; }
-      Global<CtrlClient>::Get()->PullKV(
-          MakeNodeDeviceDescriptorRpcKey(i), [&](const std::string& serialized) {
-            impl_->nodes.at(i) = NodeDeviceDescriptor::Deserialize(serialized);
-          });
+      peers.push_back(i);
+      keys.push_back(MakeNodeDeviceDescriptorRpcKey(i));
+    }
+    std::vector<std::string> serialized_nodes;
+    Global<CtrlClient>::Get()->MultiPullKV(keys, &serialized_nodes);
+    for (size_t i = 0; i < peers.size(); ++i) {
+      impl_->nodes.at(peers.at(i)) = NodeDeviceDescriptor::Deserialize(serialized_nodes.at(i));
     }
   }
 }
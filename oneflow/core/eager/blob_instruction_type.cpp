@@ -24,6 +24,7 @@ limitations under the License.
 #include "oneflow/core/vm/control_stream_type.h"
 #include "oneflow/core/vm/device_helper_stream_type.h"
 #include "oneflow/core/device/cuda_util.h"
+#include "oneflow/core/device/cuda_pinned_staging.h"
 #include "oneflow/core/register/register_manager.h"
 #include "oneflow/core/eager/lazy_ref_blob_object.h"
 #include "oneflow/core/operator/operator.h"
@@ -63,13 +64,7 @@ class CudaHostRegisterBlobInstructionType final : public vm::InstructionType {
     if (blob->mem_case().host_mem().has_cuda_pinned_mem()) { return; }
     void* dptr = blob->mut_dptr();
     CHECK_NOTNULL(dptr);
-    size_t size = blob->AlignedByteSizeOfBlobBody();
-    cudaError_t cuda_error = cudaHostRegister(dptr, size, cudaHostRegisterDefault);
-    if (cuda_error == cudaErrorHostMemoryAlreadyRegistered) {
-      cudaGetLastError();
-      return;
-    }
-    OF_CUDA_CHECK(cuda_error);
+    CudaHostRegisterBuffer(dptr, blob->AlignedByteSizeOfBlobBody());
   }
 };
 COMMAND(vm::RegisterInstructionType<CudaHostRegisterBlobInstructionType>("CudaHostRegisterBlob"));
@@ -92,12 +87,7 @@ class CudaHostUnregisterBlobInstructionType final : public vm::InstructionType {
     if (blob->mem_case().host_mem().has_cuda_pinned_mem()) { return; }
     void* dptr = blob->mut_dptr();
     CHECK_NOTNULL(dptr);
-    cudaError_t cuda_error = cudaHostUnregister(dptr);
-    if (cuda_error == cudaErrorHostMemoryNotRegistered) {
-      cudaGetLastError();
-      return;
-    }
-    OF_CUDA_CHECK(cuda_error);
+    CudaHostUnregisterBuffer(dptr);
   }
 };
 COMMAND(
@@ -17,6 +17,7 @@ limitations under the License.
 #include "oneflow/core/eager/blob_instruction_type.h"
 #include "oneflow/core/vm/cuda_stream_type.h"
 #include "oneflow/core/vm/async_cuda_stream_type.h"
+#include "oneflow/core/vm/cuda_copy_d2h_stream_type.h"
 
 namespace oneflow {
 namespace vm {
@@ -38,6 +39,16 @@ class GpuAccessBlobByCallbackInstructionType final : public AccessBlobByCallback
 COMMAND(vm::RegisterInstructionType<GpuAccessBlobByCallbackInstructionType>(
     "gpu.AccessBlobByCallback"));
 
+class CudaD2HAccessBlobByCallbackInstructionType final
+    : public AccessBlobByCallbackInstructionType {
+ public:
+  CudaD2HAccessBlobByCallbackInstructionType() = default;
+  ~CudaD2HAccessBlobByCallbackInstructionType() override = default;
+  using stream_type = vm::CudaCopyD2HStreamType;
+};
+COMMAND(vm::RegisterInstructionType<CudaD2HAccessBlobByCallbackInstructionType>(
+    "cuda_d2h.AccessBlobByCallback"));
+
 class GpuSoftSyncStreamInstructionType : public SoftSyncStreamInstructionType {
  public:
   GpuSoftSyncStreamInstructionType() = default;
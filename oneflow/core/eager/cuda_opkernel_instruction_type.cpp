@@ -27,6 +27,7 @@ limitations under the License.
 #include "oneflow/core/vm/async_cuda_stream_type.h"
 #include "oneflow/core/vm/cuda_copy_h2d_stream_type.h"
 #include "oneflow/core/vm/cuda_copy_d2h_stream_type.h"
+#include "oneflow/core/vm/cuda_comm_stream_type.h"
 #include "oneflow/core/vm/instruction.msg.h"
 #include "oneflow/core/vm/object.h"
 
@@ -71,6 +72,19 @@ class CudaD2HLocalCallOpKernelInstructionType final : public LocalCallOpKernelIn
 COMMAND(vm::RegisterInstructionType<CudaD2HLocalCallOpKernelInstructionType>(
     "cuda_d2h.LocalCallOpKernel"));
 
+class CudaCommLocalCallOpKernelInstructionType final : public LocalCallOpKernelInstructionType {
+ public:
+  CudaCommLocalCallOpKernelInstructionType() = default;
+  ~CudaCommLocalCallOpKernelInstructionType() override = default;
+
+  using stream_type = vm::CudaCommStreamType;
+
+ private:
+  const char* device_tag() const override { return stream_type().device_tag(); }
+};
+COMMAND(vm::RegisterInstructionType<CudaCommLocalCallOpKernelInstructionType>(
+    "cuda_comm.LocalCallOpKernel"));
+
 class CudaCallOpKernelInstructionType final : public CallOpKernelInstructionType {
  public:
   CudaCallOpKernelInstructionType() = default;
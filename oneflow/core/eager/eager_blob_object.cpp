@@ -40,12 +40,37 @@ EagerBlobObject::EagerBlobObject(const std::shared_ptr<MemoryCase>& mem_case,
       tensor_buffer_(tensor_buffer),
       blob_body_bytes_(0),
       is_shape_synced_(true),
-      compute_local_dep_object_(GetVmLocalDepObject(parallel_desc)) {
+      is_released_(false),
+      allocator_(nullptr),
+      compute_local_dep_object_(GetVmLocalDepObject(parallel_desc)),
+      is_view_(false),
+      view_offset_(0) {
   CHECK(static_cast<bool>(shape));
   CHECK(static_cast<bool>(tensor_buffer));
   non_pod_initer_ = std::make_unique<MemoryAllocator>();
 }
 
+EagerBlobObject::EagerBlobObject(const std::shared_ptr<Shape>& shape, EagerBlobObject* base,
+                                 int64_t offset)
+    : BlobObject(base->mem_case_, shape, base->blob_desc().data_type()),
+      tensor_buffer_(base->tensor_buffer()),
+      blob_body_bytes_(0),
+      is_shape_synced_(true),
+      is_released_(false),
+      allocator_(nullptr),
+      compute_local_dep_object_(base->compute_local_dep_object_),
+      is_view_(true),
+      view_offset_(base->view_offset_ + offset) {
+  CHECK(static_cast<bool>(shape));
+  non_pod_initer_ = std::make_unique<MemoryAllocator>();
+  CHECK_JUST(InitBlob());
+}
+
+void EagerBlobObject::SyncViewDptr() const {
+  char* base_dptr = tensor_buffer_->blob_dptr();
+  blob_->reset_dptr(base_dptr == nullptr ? nullptr : base_dptr + view_offset_);
+}
+
 Maybe<void> EagerBlobObject::TryInitBlob() {
   if (!blob_) { JUST(InitBlob()); }
   return Maybe<void>::Ok();
@@ -61,6 +86,8 @@ Maybe<void> EagerBlobObject::InitBlob() {
 }
 
 Maybe<void> EagerBlobObject::TryAllocateBlobBodyMemory(DeviceCtx* device_ctx) {
+  // the memory of a view belongs to its base
+  if (is_view_) { return Maybe<void>::Ok(); }
   vm::Allocator* allocator = device_ctx->mut_allocator();
   CHECK_NOTNULL_OR_RETURN(allocator);
   Blob* blob = mut_blob();
@@ -87,8 +114,33 @@ Maybe<void> EagerBlobObject::TryAllocateBlobBodyMemory(DeviceCtx* device_ctx) {
     InitNonPODTypeBlobIfNeed(non_pod_initer_.get(), blob_.get());
   }
   blob_body_bytes_ = required_body_bytes;
+  allocator_ = allocator;
   return Maybe<void>::Ok();
 }
 
+Maybe<bool> EagerBlobObject::TryTakeBlobBodyMemoryFrom(EagerBlobObject* donor,
+                                                       DeviceCtx* device_ctx) {
+  if (is_view_ || donor->is_view_ || !donor->is_released_) { return false; }
+  // views or other tensors may still read the memory through a shared buffer
+  if (donor->tensor_buffer_.use_count() != 1) { return false; }
+  if (donor->allocator_ != device_ctx->mut_allocator()) { return false; }
+  if (!IsPODDataType(blob_desc_.data_type())) { return false; }
+  Blob* blob = mut_blob();
+  CHECK_NOTNULL_OR_RETURN(blob);
+  if (blob->dptr() != nullptr || tensor_buffer_->blob_dptr() != nullptr) { return false; }
+  const std::size_t required_body_bytes = blob->AlignedByteSizeOfBlobBody();
+  if (required_body_bytes == 0 || required_body_bytes != donor->blob_body_bytes_) { return false; }
+  char* dptr = donor->tensor_buffer_->blob_dptr();
+  if (dptr == nullptr) { return false; }
+  // the deleter of the donated buffer frees `required_body_bytes' to the same allocator
+  tensor_buffer_->swap(donor->tensor_buffer_.get());
+  blob->reset_dptr(dptr);
+  blob_body_bytes_ = required_body_bytes;
+  allocator_ = donor->allocator_;
+  // the blob of `donor' keeps pointing to the memory, which this instruction still reads as input
+  donor->blob_body_bytes_ = 0;
+  return true;
+}
+
 }  // namespace vm
 }  // namespace oneflow
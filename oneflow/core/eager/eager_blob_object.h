@@ -25,6 +25,8 @@ namespace oneflow {
 
 namespace vm {
 
+class Allocator;
+
 class TensorBuffer {
  public:
   char* blob_dptr() { return blob_dptr_.get(); }
@@ -34,6 +36,8 @@ class TensorBuffer {
 
   void reset() { blob_dptr_.reset(); }
 
+  void swap(TensorBuffer* other) { blob_dptr_.swap(other->blob_dptr_); }
+
  private:
   std::unique_ptr<char, std::function<void(char*)>> blob_dptr_;
 };
@@ -48,6 +52,9 @@ class EagerBlobObject final : public BlobObject {
   EagerBlobObject(const std::shared_ptr<MemoryCase>& mem_case, const std::shared_ptr<Shape>& shape,
                   DataType data_type, const std::shared_ptr<TensorBuffer>& tensor_buffer,
                   const std::shared_ptr<const ParallelDesc>& parallel_desc);
+  // A view over the memory of `base' starting `offset' bytes into it. The view shares the
+  // dependences of `base', so the VM orders the accesses of the two as those of one blob.
+  EagerBlobObject(const std::shared_ptr<Shape>& shape, EagerBlobObject* base, int64_t offset);
   ~EagerBlobObject() override {
     non_pod_initer_.reset();
     tensor_buffer_.reset();
@@ -56,13 +63,24 @@ class EagerBlobObject final : public BlobObject {
 
   BlobDesc* mut_blob_desc() override { return &blob_desc_; }
 
-  const Blob& blob() const override { return *blob_; }
-  Blob* mut_blob() override { return blob_.get(); }
+  const Blob& blob() const override {
+    if (is_view_) { SyncViewDptr(); }
+    return *blob_;
+  }
+  Blob* mut_blob() override {
+    if (is_view_) { SyncViewDptr(); }
+    return blob_.get();
+  }
   Maybe<void> TryInitBlob() override;
   Maybe<void> InitBlob();
 
   Maybe<void> TryAllocateBlobBodyMemory(DeviceCtx* device_ctx) override;
+  // Takes over the body memory of `donor' instead of allocating, which is only allowed once the
+  // tensor of `donor' has been released and nothing else shares its buffer. Returns false and
+  // leaves both objects untouched if the memory could not be taken.
+  Maybe<bool> TryTakeBlobBodyMemoryFrom(EagerBlobObject* donor, DeviceCtx* device_ctx);
   Maybe<void> DeallocateBlobDataPtr() override {
+    if (is_view_) { return Maybe<void>::Ok(); }
     non_pod_initer_.reset();
     tensor_buffer_->reset();
     return Maybe<void>::Ok();
@@ -76,13 +94,27 @@ class EagerBlobObject final : public BlobObject {
 
   void set_is_shape_synced(bool val) { is_shape_synced_ = val; }
 
+  bool is_view() const { return is_view_; }
+
+  bool is_released() const { return is_released_; }
+  void set_is_released(bool val) { is_released_ = val; }
+
  private:
+  // The memory of the base is allocated by its producer instruction, which the VM runs before any
+  // instruction accessing the view.
+  void SyncViewDptr() const;
+
   std::unique_ptr<Blob> blob_;
   std::shared_ptr<TensorBuffer> tensor_buffer_;
   std::size_t blob_body_bytes_;
   std::unique_ptr<MemoryAllocator> non_pod_initer_;
   std::atomic<bool> is_shape_synced_;
+  std::atomic<bool> is_released_;
+  // the allocator the body memory came from, nullptr if it was never allocated
+  vm::Allocator* allocator_;
   Maybe<VmLocalDepObject> compute_local_dep_object_;
+  bool is_view_;
+  int64_t view_offset_;
 };
 
 }  // namespace vm
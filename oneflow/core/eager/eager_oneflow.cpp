@@ -64,6 +64,27 @@ Maybe<void> StorageAdd(const EagerSymbol& symbol) {
   return Maybe<void>::Ok();
 }
 
+// Symbols created by this process through InstructionsBuilder were already added to the storages
+// when they were created, so their cfg to proto conversion can be skipped.
+Maybe<bool> StorageHas(const cfg::EagerSymbol& symbol) {
+  int64_t symbol_id = symbol.symbol_id();
+  if (symbol.has_string_symbol()) {
+    return Global<symbol::Storage<StringSymbol>>::Get()->Has(symbol_id);
+  } else if (symbol.has_scope_symbol()) {
+    return Global<symbol::Storage<Scope>>::Get()->Has(symbol_id);
+  } else if (symbol.has_job_conf_symbol()) {
+    return Global<symbol::Storage<JobDesc>>::Get()->Has(symbol_id);
+  } else if (symbol.has_parallel_conf_symbol()) {
+    return Global<symbol::Storage<ParallelDesc>>::Get()->Has(symbol_id);
+  } else if (symbol.has_op_conf_symbol()) {
+    return Global<symbol::Storage<OperatorConfSymbol>>::Get()->Has(symbol_id);
+  } else if (symbol.has_op_node_signature_symbol()) {
+    return Global<symbol::Storage<OpNodeSignatureDesc>>::Get()->Has(symbol_id);
+  } else {
+    OF_UNIMPLEMENTED();
+  }
+}
+
 }  // namespace
 
 Maybe<void> EagerOneflow::RunPhysicalInstruction(
@@ -79,9 +100,14 @@ Maybe<void> EagerOneflow::RunPhysicalInstruction(
 Maybe<void> EagerOneflow::RunPhysicalInstruction(
     vm::InstructionMsgList* instruction_list,
     const vm::cfg::EagerSymbolList& cfg_eager_symbol_list) {
-  vm::EagerSymbolList eager_symbol_list;
-  cfg_eager_symbol_list.ToProto(&eager_symbol_list);
-  return RunPhysicalInstruction(instruction_list, eager_symbol_list);
+  for (size_t i = 0; i < cfg_eager_symbol_list.eager_symbol_size(); ++i) {
+    const auto& cfg_eager_symbol = cfg_eager_symbol_list.eager_symbol(i);
+    if (JUST(StorageHas(cfg_eager_symbol))) { continue; }
+    EagerSymbol eager_symbol;
+    cfg_eager_symbol.ToProto(&eager_symbol);
+    JUST(StorageAdd(eager_symbol));
+  }
+  return vm::Run(instruction_list);
 }
 
 Maybe<void> EagerOneflow::RunPhysicalInstruction(vm::InstructionMsgList* instruction_list,
@@ -82,12 +82,17 @@ class LocalCallOpKernelPhyInstrOperand final : public vm::PhyInstrOperand {
 
   void set_user_opkernel(const user_op::OpKernel* user_opkernel) { user_opkernel_ = user_opkernel; }
 
+  // only inferred while kernel timing is enabled
+  int64_t flops() const { return flops_; }
+  void set_flops(int64_t flops) { flops_ = flops; }
+
  private:
   std::shared_ptr<one::StatefulLocalOpKernel> opkernel_;
   one::EagerBlobObjectListPtr inputs_;
   one::EagerBlobObjectListPtr outputs_;
   const one::OpExprInterpContext op_interp_ctx_;
   const user_op::OpKernel* user_opkernel_;
+  int64_t flops_ = 0;
 };
 
 }  // namespace vm
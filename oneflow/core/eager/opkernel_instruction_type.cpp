@@ -32,6 +32,7 @@ limitations under the License.
 #include "oneflow/core/vm/instruction.msg.h"
 #include "oneflow/core/vm/instruction_type.h"
 #include "oneflow/core/vm/object.h"
+#include "oneflow/core/vm/workspace_arena.h"
 #include "oneflow/core/framework/user_op_registry_manager.h"
 #include "oneflow/core/job/foreign_callback.h"
 #include "oneflow/core/job/parallel_signature.cfg.h"
@@ -39,6 +40,7 @@ limitations under the License.
 #include "oneflow/core/vm/symbol_storage.h"
 #include "oneflow/core/operator/op_node_signature_desc.h"
 #include "oneflow/core/operator/op_conf_symbol.h"
+#include "oneflow/core/profiler/kernel_timing.h"
 #include "oneflow/user/kernels/stateful_local_opkernel.h"
 
 namespace oneflow {
@@ -450,6 +452,7 @@ struct LocalCallOpKernelUtil final {
     JUST(InitOutputBlobs(operand));
     JUST(InferTempStorageBlobDesc(operand));
     JUST(ResetTempStorageBlob(operand));
+    if (profiler::IsKernelTimingEnabled()) { InferFlops(operand); }
     return Maybe<void>::Ok();
   }
 
@@ -532,6 +535,17 @@ struct LocalCallOpKernelUtil final {
     return Maybe<void>::Ok();
   }
 
+  // The op infer ctx belongs to the scheduler thread, so the flops are inferred here and read by
+  // the kernel timing of the compute.
+  static inline void InferFlops(LocalCallOpKernelPhyInstrOperand* operand) {
+    const auto& InferFlopsFn = operand->opkernel().GetInferFlopsFn(operand->user_opkernel());
+    one::LocalUserOpInferContext* op_infer_ctx =
+        operand->opkernel().op_infer_ctx_for_scheduler_thread();
+    op_infer_ctx->Update(operand->inputs(), operand->outputs());
+    operand->set_flops(InferFlopsFn(op_infer_ctx));
+    op_infer_ctx->Update(nullptr, nullptr);
+  }
+
   static inline Maybe<void> ResetTempStorageBlob(LocalCallOpKernelPhyInstrOperand* operand) {
     JUST(operand->mut_opkernel()->mut_temp_blob_object()->InitBlob());
     return Maybe<void>::Ok();
@@ -558,8 +572,51 @@ struct LocalCallOpKernelUtil final {
                                                   operand->inputs(), operand->outputs(), state);
   }
 
+  static inline bool IsInplaceDonationEnabled() {
+    static const bool is_enabled =
+        ParseBooleanFromEnv("ONEFLOW_EAGER_ENABLE_INPLACE_DONATION", false);
+    return is_enabled;
+  }
+
+  // Lets the outputs the kernel proposes to run in-place reuse the memory of their inputs when
+  // this instruction is the last use of those inputs.
+  static inline Maybe<void> TryDonateInputBlobsMemory(LocalCallOpKernelPhyInstrOperand* operand,
+                                                      DeviceCtx* device_ctx) {
+    const auto& InplaceProposalFn =
+        operand->opkernel().GetInplaceProposalFn(operand->user_opkernel());
+    if (!InplaceProposalFn) { return Maybe<void>::Ok(); }
+    const auto& opkernel = operand->opkernel();
+    const auto& inputs = *operand->inputs();
+    const auto& outputs = *operand->outputs();
+    std::vector<std::pair<int64_t, int64_t>> out_in_indexes;
+    one::LocalUserOpInferContext* op_infer_ctx = opkernel.op_infer_ctx_for_scheduler_thread();
+    op_infer_ctx->Update(operand->inputs(), operand->outputs());
+    const auto& AddInplaceArgPair =
+        [&](const std::string& out_arg_name, int32_t out_arg_index, const std::string& in_arg_name,
+            int32_t in_arg_index, bool is_mutable) -> Maybe<void> {
+      const int64_t out_index = opkernel.output_arg_tuple_->TensorTupleIndex4ArgNameAndIndex(
+          out_arg_name, out_arg_index);
+      const int64_t in_index =
+          opkernel.input_arg_tuple_->TensorTupleIndex4ArgNameAndIndex(in_arg_name, in_arg_index);
+      if (out_index >= 0 && in_index >= 0) { out_in_indexes.emplace_back(out_index, in_index); }
+      return Maybe<void>::Ok();
+    };
+    const auto& proposal_status = InplaceProposalFn(*op_infer_ctx, AddInplaceArgPair);
+    op_infer_ctx->Update(nullptr, nullptr);
+    JUST(proposal_status);
+    for (const auto& pair : out_in_indexes) {
+      const auto& donor = inputs.at(pair.second);
+      // besides this instruction, only the pending release instruction may refer to the donor
+      const int64_t use_count_in_operand = std::count(inputs.begin(), inputs.end(), donor);
+      if (donor.use_count() > use_count_in_operand + 1) { continue; }
+      JUST(outputs.at(pair.first)->TryTakeBlobBodyMemoryFrom(donor.get(), device_ctx));
+    }
+    return Maybe<void>::Ok();
+  }
+
   static inline Maybe<void> AllocateOutputBlobsMemory(LocalCallOpKernelPhyInstrOperand* operand,
                                                       DeviceCtx* device_ctx) {
+    if (IsInplaceDonationEnabled()) { JUST(TryDonateInputBlobsMemory(operand, device_ctx)); }
     JUST(operand->ForEachOutputTensor([&](vm::EagerBlobObject* blob_object) -> Maybe<void> {
       JUST(blob_object->TryAllocateBlobBodyMemory(device_ctx));
       return Maybe<void>::Ok();
@@ -567,17 +624,53 @@ struct LocalCallOpKernelUtil final {
     return Maybe<void>::Ok();
   }
 
+  static inline vm::WorkspaceArena* GetWorkspaceArena(DeviceCtx* device_ctx) {
+    static const bool is_enabled = ParseBooleanFromEnv("ONEFLOW_VM_ENABLE_WORKSPACE_ARENA", true);
+    return is_enabled ? device_ctx->mut_workspace_arena() : nullptr;
+  }
+
+  // The tmp buffer is taken from the workspace arena of the stream if it has one, the buffer is
+  // only used by this kernel, so the next kernel on the stream can reuse the memory.
   static inline Maybe<void> TryAllocateTempStorageBlobMemory(
       LocalCallOpKernelPhyInstrOperand* operand, DeviceCtx* device_ctx) {
-    JUST(operand->mut_opkernel()->mut_temp_blob_object()->TryAllocateBlobBodyMemory(device_ctx));
+    vm::EagerBlobObject* temp_blob_object = operand->mut_opkernel()->mut_temp_blob_object();
+    vm::WorkspaceArena* workspace_arena = GetWorkspaceArena(device_ctx);
+    if (workspace_arena == nullptr) {
+      JUST(temp_blob_object->TryAllocateBlobBodyMemory(device_ctx));
+      return Maybe<void>::Ok();
+    }
+    Blob* blob = temp_blob_object->mut_blob();
+    CHECK_NOTNULL_OR_RETURN(blob);
+    CHECK_ISNULL_OR_RETURN(blob->dptr());
+    const size_t required_body_bytes = blob->AlignedByteSizeOfBlobBody();
+    if (required_body_bytes > 0) {
+      blob->reset_dptr(workspace_arena->Acquire(required_body_bytes));
+    }
     return Maybe<void>::Ok();
   }
 
   static inline Maybe<void> OpKernelCompute(LocalCallOpKernelPhyInstrOperand* operand,
                                             DeviceCtx* device_ctx, user_op::OpKernelState* state) {
+    const auto BytesTouched = [&]() {
+      int64_t bytes = 0;
+      for (const auto& input : *operand->inputs()) { bytes += input->blob().ByteSizeOfBlobBody(); }
+      for (const auto& output : *operand->outputs()) {
+        bytes += output->blob().ByteSizeOfBlobBody();
+      }
+      return bytes;
+    };
+    profiler::KernelTimingGuard timing_guard(*operand->opkernel().op_conf_, device_ctx,
+                                             BytesTouched, [&]() { return operand->flops(); });
+    CudaGraphKernelLauncher* cuda_graph_launcher =
+        operand->mut_opkernel()->mut_cuda_graph_launcher(operand->user_opkernel());
     JUST(WithComputeContext(operand, device_ctx,
                             [&](user_op::KernelComputeContext* compute_ctx) -> Maybe<void> {
-                              operand->user_opkernel()->Compute(compute_ctx, state);
+                              if (cuda_graph_launcher != nullptr) {
+                                cuda_graph_launcher->Compute(operand->user_opkernel(), compute_ctx,
+                                                             state);
+                              } else {
+                                operand->user_opkernel()->Compute(compute_ctx, state);
+                              }
                               return Maybe<void>::Ok();
                             }));
     return Maybe<void>::Ok();
@@ -585,7 +678,17 @@ struct LocalCallOpKernelUtil final {
 
   static inline Maybe<void> DeallocateTempStorageBlobMemory(
       LocalCallOpKernelPhyInstrOperand* operand, DeviceCtx* device_ctx) {
-    JUST(operand->mut_opkernel()->mut_temp_blob_object()->DeallocateBlobDataPtr());
+    vm::EagerBlobObject* temp_blob_object = operand->mut_opkernel()->mut_temp_blob_object();
+    vm::WorkspaceArena* workspace_arena = GetWorkspaceArena(device_ctx);
+    if (workspace_arena != nullptr) {
+      Blob* blob = temp_blob_object->mut_blob();
+      if (blob->dptr() != nullptr) {
+        blob->reset_dptr(nullptr);
+        workspace_arena->Release();
+      }
+      return Maybe<void>::Ok();
+    }
+    JUST(temp_blob_object->DeallocateBlobDataPtr());
     return Maybe<void>::Ok();
   }
 };
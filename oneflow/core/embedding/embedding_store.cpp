@@ -0,0 +1,199 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifdef WITH_CUDA
+
+#include "oneflow/core/embedding/embedding_store.h"
+#include "oneflow/core/device/cuda_util.h"
+
+namespace oneflow {
+
+namespace embedding {
+
+EmbeddingStore::EmbeddingStore(const EmbeddingOptions& options, int64_t device_id)
+    : options_(options),
+      device_id_(device_id),
+      host_store_(LocalFS(), options.path, options.embedding_size, options.host_cache_capacity,
+                  options.initializer_scale, options.seed),
+      device_rows_(nullptr),
+      pinned_buffer_(nullptr),
+      pinned_buffer_size_(0),
+      num_batches_(0) {
+  const int64_t capacity = options_.device_cache_capacity;
+  CHECK_GT(capacity, 0);
+  CHECK_LE(capacity, GetMaxVal<int32_t>());
+  CudaCurrentDeviceGuard guard(device_id_);
+  OF_CUDA_CHECK(cudaMalloc(&device_rows_, capacity * options_.embedding_size * sizeof(float)));
+  slot_ids_.assign(capacity, -1);
+  slot_dirty_.assign(capacity, false);
+  slot_batch_.assign(capacity, 0);
+  slot2lru_it_.resize(capacity);
+  for (int32_t slot = 0; slot < capacity; ++slot) {
+    slot2lru_it_[slot] = lru_slots_.insert(lru_slots_.end(), slot);
+  }
+}
+
+EmbeddingStore::~EmbeddingStore() {
+  // the stores live until exit, when the cuda runtime may be gone already
+  CudaCurrentDeviceGuard guard(device_id_);
+  cudaFree(device_rows_);
+  if (pinned_buffer_ != nullptr) { cudaFreeHost(pinned_buffer_); }
+}
+
+void* EmbeddingStore::PinnedBuffer(size_t size) {
+  if (size > pinned_buffer_size_) {
+    CudaCurrentDeviceGuard guard(device_id_);
+    if (pinned_buffer_ != nullptr) { OF_CUDA_CHECK(cudaFreeHost(pinned_buffer_)); }
+    OF_CUDA_CHECK(cudaMallocHost(&pinned_buffer_, size));
+    pinned_buffer_size_ = size;
+  }
+  return pinned_buffer_;
+}
+
+Maybe<void> EmbeddingStore::AssignSlots(const int64_t* ids, int64_t num_ids,
+                                        DeviceSlotPlan* plan) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  num_batches_ += 1;
+  plan->slots.resize(num_ids);
+  plan->evict_slots.clear();
+  plan->evict_ids.clear();
+  plan->load_slots.clear();
+  plan->load_ids.clear();
+  for (int64_t i = 0; i < num_ids; ++i) {
+    const int64_t id = ids[i];
+    int32_t slot = 0;
+    const auto it = id2slot_.find(id);
+    if (it != id2slot_.end()) {
+      slot = it->second;
+    } else {
+      slot = lru_slots_.back();
+      CHECK_NE_OR_RETURN(slot_batch_.at(slot), num_batches_)
+          << "the device cache of embedding " << options_.name << " has "
+          << options_.device_cache_capacity << " rows, less than the distinct ids of a batch";
+      const int64_t evicted_id = slot_ids_.at(slot);
+      if (evicted_id != -1) {
+        if (slot_dirty_.at(slot)) {
+          plan->evict_slots.push_back(slot);
+          plan->evict_ids.push_back(evicted_id);
+        }
+        id2slot_.erase(evicted_id);
+      }
+      slot_ids_.at(slot) = id;
+      slot_dirty_.at(slot) = false;
+      id2slot_.emplace(id, slot);
+      plan->load_slots.push_back(slot);
+      plan->load_ids.push_back(id);
+    }
+    slot_batch_.at(slot) = num_batches_;
+    lru_slots_.splice(lru_slots_.begin(), lru_slots_, slot2lru_it_.at(slot));
+    plan->slots[i] = slot;
+  }
+  return Maybe<void>::Ok();
+}
+
+void EmbeddingStore::MarkDirty(const int32_t* slots, int64_t num_slots) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (int64_t i = 0; i < num_slots; ++i) {
+    CHECK_NE(slot_ids_.at(slots[i]), -1);
+    slot_dirty_.at(slots[i]) = true;
+  }
+}
+
+void EmbeddingStore::FlushDevice() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  std::vector<int64_t> dirty_ids;
+  std::vector<int32_t> dirty_slots;
+  for (int32_t slot = 0; slot < slot_ids_.size(); ++slot) {
+    if (!slot_dirty_.at(slot)) { continue; }
+    dirty_ids.push_back(slot_ids_.at(slot));
+    dirty_slots.push_back(slot);
+  }
+  if (dirty_ids.empty()) { return; }
+  const int64_t embedding_size = options_.embedding_size;
+  std::vector<float> device_rows(slot_ids_.size() * embedding_size);
+  {
+    CudaCurrentDeviceGuard guard(device_id_);
+    OF_CUDA_CHECK(cudaMemcpy(device_rows.data(), device_rows_, device_rows.size() * sizeof(float),
+                             cudaMemcpyDeviceToHost));
+  }
+  std::vector<float> dirty_rows(dirty_ids.size() * embedding_size);
+  for (int64_t i = 0; i < dirty_slots.size(); ++i) {
+    std::copy_n(device_rows.data() + dirty_slots.at(i) * embedding_size, embedding_size,
+                dirty_rows.data() + i * embedding_size);
+    slot_dirty_.at(dirty_slots.at(i)) = false;
+  }
+  host_store_.Put(dirty_ids.data(), dirty_ids.size(), dirty_rows.data());
+}
+
+void EmbeddingStore::Save(const std::string& dir) {
+  FlushDevice();
+  host_store_.Save(SnapshotFS(), dir);
+}
+
+void EmbeddingStore::Load(const std::string& dir) {
+  FlushDevice();
+  host_store_.Load(SnapshotFS(), dir);
+  std::unique_lock<std::mutex> lock(mutex_);
+  id2slot_.clear();
+  std::fill(slot_ids_.begin(), slot_ids_.end(), -1);
+  std::fill(slot_batch_.begin(), slot_batch_.end(), 0);
+}
+
+namespace {
+
+struct EmbeddingStoreRegistry {
+  std::mutex mutex;
+  HashMap<std::string, std::unique_ptr<EmbeddingStore>> name2store;
+};
+
+EmbeddingStoreRegistry* GetEmbeddingStoreRegistry() {
+  static EmbeddingStoreRegistry registry;
+  return &registry;
+}
+
+}  // namespace
+
+Maybe<EmbeddingStore*> GetOrCreateEmbeddingStore(const EmbeddingOptions& options,
+                                                 int64_t device_id) {
+  auto* registry = GetEmbeddingStoreRegistry();
+  std::unique_lock<std::mutex> lock(registry->mutex);
+  auto it = registry->name2store.find(options.name);
+  if (it == registry->name2store.end()) {
+    it = registry->name2store
+             .emplace(options.name, std::make_unique<EmbeddingStore>(options, device_id))
+             .first;
+  }
+  EmbeddingStore* store = it->second.get();
+  CHECK_EQ_OR_RETURN(store->device_id(), device_id)
+      << "embedding " << options.name << " is already cached on another device";
+  CHECK_EQ_OR_RETURN(store->options().path, options.path);
+  CHECK_EQ_OR_RETURN(store->options().embedding_size, options.embedding_size);
+  return store;
+}
+
+Maybe<EmbeddingStore*> GetEmbeddingStore(const std::string& name) {
+  auto* registry = GetEmbeddingStoreRegistry();
+  std::unique_lock<std::mutex> lock(registry->mutex);
+  const auto it = registry->name2store.find(name);
+  CHECK_OR_RETURN(it != registry->name2store.end())
+      << "embedding " << name << " has not been looked up yet";
+  return it->second.get();
+}
+
+}  // namespace embedding
+
+}  // namespace oneflow
+
+#endif  // WITH_CUDA
@@ -0,0 +1,111 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_EMBEDDING_EMBEDDING_STORE_H_
+#define ONEFLOW_CORE_EMBEDDING_EMBEDDING_STORE_H_
+
+#ifdef WITH_CUDA
+
+#include "oneflow/core/common/maybe.h"
+#include "oneflow/core/embedding/host_row_store.h"
+
+namespace oneflow {
+
+namespace embedding {
+
+struct EmbeddingOptions {
+  std::string name;
+  // the directory of the file with all the rows
+  std::string path;
+  int64_t embedding_size;
+  int64_t device_cache_capacity;
+  int64_t host_cache_capacity;
+  float initializer_scale;
+  int64_t seed;
+};
+
+// Which rows of the device cache a batch of ids reads and which rows have to be moved between the
+// device and host tiers before it does.
+struct DeviceSlotPlan {
+  // the slot of every id
+  std::vector<int32_t> slots;
+  // the dirty rows to copy back to the host tier before their slots are reused
+  std::vector<int32_t> evict_slots;
+  std::vector<int64_t> evict_ids;
+  // the rows to copy from the host tier into the device cache
+  std::vector<int32_t> load_slots;
+  std::vector<int64_t> load_ids;
+};
+
+// An embedding table that does not need to fit in device memory. Its hot rows are cached in
+// `device_cache_capacity` slots on one GPU, the index of the slots stays on host. The rows that
+// miss are read from a HostRowStore, an LRU in host memory in front of the file with all the rows.
+// The rows are trained in the device cache and only written back once they are evicted.
+class EmbeddingStore final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(EmbeddingStore);
+  EmbeddingStore(const EmbeddingOptions& options, int64_t device_id);
+  ~EmbeddingStore();
+
+  const EmbeddingOptions& options() const { return options_; }
+  int64_t device_id() const { return device_id_; }
+  HostRowStore* host_store() { return &host_store_; }
+  // device_cache_capacity rows of embedding_size floats
+  float* device_rows() { return device_rows_; }
+  // Page-locked host memory for the copies of the kernels, valid until the next call.
+  void* PinnedBuffer(size_t size);
+
+  // Assigns a slot of the device cache to each of the ids. The slots of the least recently used
+  // ids are reused for the missing ones, so the cache has to hold the distinct ids of a batch.
+  Maybe<void> AssignSlots(const int64_t* ids, int64_t num_ids, DeviceSlotPlan* plan);
+  // The rows of the slots have been updated and are written back once evicted.
+  void MarkDirty(const int32_t* slots, int64_t num_slots);
+
+  // Writes the dirty rows of the device cache back to the host tier.
+  void FlushDevice();
+  void Save(const std::string& dir);
+  void Load(const std::string& dir);
+
+ private:
+  const EmbeddingOptions options_;
+  const int64_t device_id_;
+  HostRowStore host_store_;
+  float* device_rows_;
+  void* pinned_buffer_;
+  size_t pinned_buffer_size_;
+  std::mutex mutex_;
+  // the id of every slot, -1 if free
+  std::vector<int64_t> slot_ids_;
+  std::vector<bool> slot_dirty_;
+  // the batch that last read every slot
+  std::vector<int64_t> slot_batch_;
+  std::list<int32_t> lru_slots_;
+  std::vector<std::list<int32_t>::iterator> slot2lru_it_;
+  HashMap<int64_t, int32_t> id2slot_;
+  int64_t num_batches_;
+};
+
+// Returns the store of options.name and creates it on the first call.
+Maybe<EmbeddingStore*> GetOrCreateEmbeddingStore(const EmbeddingOptions& options,
+                                                 int64_t device_id);
+Maybe<EmbeddingStore*> GetEmbeddingStore(const std::string& name);
+
+}  // namespace embedding
+
+}  // namespace oneflow
+
+#endif  // WITH_CUDA
+
+#endif  // ONEFLOW_CORE_EMBEDDING_EMBEDDING_STORE_H_
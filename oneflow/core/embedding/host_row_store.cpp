@@ -0,0 +1,141 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/embedding/host_row_store.h"
+#include "oneflow/core/common/str_util.h"
+
+namespace oneflow {
+
+namespace embedding {
+
+HostRowStore::HostRowStore(fs::FileSystem* fs, const std::string& dir, int64_t embedding_size,
+                           int64_t capacity, float initializer_scale, int64_t seed)
+    : embedding_size_(embedding_size),
+      capacity_(capacity),
+      initializer_scale_(initializer_scale),
+      seed_(seed),
+      table_(fs, dir, embedding_size * sizeof(float)) {
+  CHECK_GT(embedding_size_, 0);
+  CHECK_GT(capacity_, 0);
+  prefetch_thread_ = std::thread(&HostRowStore::PrefetchLoop, this);
+}
+
+HostRowStore::~HostRowStore() {
+  prefetch_channel_.Close();
+  prefetch_thread_.join();
+  Flush();
+}
+
+void HostRowStore::InitializeRow(int64_t id, float* row) const {
+  std::mt19937_64 generator(static_cast<uint64_t>(seed_)
+                            ^ (static_cast<uint64_t>(id) * 0x9E3779B97F4A7C15ULL));
+  std::uniform_real_distribution<float> distribution(-initializer_scale_, initializer_scale_);
+  for (int64_t i = 0; i < embedding_size_; ++i) { row[i] = distribution(generator); }
+}
+
+HostRowStore::CachedRow* HostRowStore::Touch(int64_t id) {
+  const auto it = id2row_.find(id);
+  if (it != id2row_.end()) {
+    lru_rows_.splice(lru_rows_.begin(), lru_rows_, it->second);
+    return &*it->second;
+  }
+  if (lru_rows_.size() >= capacity_) {
+    CachedRow& victim = lru_rows_.back();
+    if (victim.dirty) { table_.Put(victim.id, reinterpret_cast<const char*>(victim.data.data())); }
+    id2row_.erase(victim.id);
+    // reuse the buffer of the victim
+    lru_rows_.splice(lru_rows_.begin(), lru_rows_, std::prev(lru_rows_.end()));
+  } else {
+    lru_rows_.emplace_front();
+    lru_rows_.front().data.resize(embedding_size_);
+  }
+  CachedRow* row = &lru_rows_.front();
+  row->id = id;
+  row->dirty = false;
+  if (!table_.Get(id, reinterpret_cast<char*>(row->data.data()))) {
+    InitializeRow(id, row->data.data());
+  }
+  id2row_[id] = lru_rows_.begin();
+  return row;
+}
+
+void HostRowStore::Get(const int64_t* ids, int64_t num_ids, float* rows) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (int64_t i = 0; i < num_ids; ++i) {
+    const CachedRow* row = Touch(ids[i]);
+    std::copy(row->data.begin(), row->data.end(), rows + i * embedding_size_);
+  }
+}
+
+void HostRowStore::Put(const int64_t* ids, int64_t num_ids, const float* rows) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  for (int64_t i = 0; i < num_ids; ++i) {
+    CachedRow* row = Touch(ids[i]);
+    std::copy(rows + i * embedding_size_, rows + (i + 1) * embedding_size_, row->data.begin());
+    row->dirty = true;
+  }
+}
+
+void HostRowStore::Prefetch(std::vector<int64_t> ids) {
+  CHECK_EQ(prefetch_channel_.Send(std::move(ids)), kChannelStatusSuccess);
+}
+
+void HostRowStore::PrefetchLoop() {
+  std::vector<int64_t> ids;
+  while (prefetch_channel_.Receive(&ids) == kChannelStatusSuccess) {
+    // a batch larger than the cache would only evict its own rows
+    const int64_t num_ids = std::min<int64_t>(ids.size(), capacity_);
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (int64_t i = 0; i < num_ids; ++i) { Touch(ids[i]); }
+  }
+}
+
+void HostRowStore::FlushLocked() {
+  for (CachedRow& row : lru_rows_) {
+    if (!row.dirty) { continue; }
+    table_.Put(row.id, reinterpret_cast<const char*>(row.data.data()));
+    row.dirty = false;
+  }
+}
+
+void HostRowStore::Flush() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  FlushLocked();
+}
+
+void HostRowStore::Save(fs::FileSystem* fs, const std::string& dir) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  FlushLocked();
+  table_.Compact();
+  const std::string snapshot_path = JoinPath(dir, "rows");
+  if (fs->FileExists(snapshot_path)) { fs->DelFile(snapshot_path); }
+  RowFileTable snapshot(fs, dir, table_.row_size());
+  table_.ForEachRow([&](int64_t id, const char* row) { snapshot.Put(id, row); });
+}
+
+void HostRowStore::Load(fs::FileSystem* fs, const std::string& dir) {
+  CHECK(fs->FileExists(JoinPath(dir, "rows"))) << "no embedding rows under " << dir;
+  std::unique_lock<std::mutex> lock(mutex_);
+  FlushLocked();
+  lru_rows_.clear();
+  id2row_.clear();
+  RowFileTable snapshot(fs, dir, table_.row_size());
+  snapshot.ForEachRow([&](int64_t id, const char* row) { table_.Put(id, row); });
+  table_.Compact();
+}
+
+}  // namespace embedding
+
+}  // namespace oneflow
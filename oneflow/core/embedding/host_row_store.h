@@ -0,0 +1,82 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_EMBEDDING_HOST_ROW_STORE_H_
+#define ONEFLOW_CORE_EMBEDDING_HOST_ROW_STORE_H_
+
+#include "oneflow/core/common/channel.h"
+#include "oneflow/core/embedding/row_file_table.h"
+
+namespace oneflow {
+
+namespace embedding {
+
+// The float rows of an embedding: an LRU cache of `capacity` rows in host memory in front of the
+// RowFileTable with all the rows. Evicted rows are written back to the file only if they have
+// been put since they were read. A row that has never been put is initialized from its id, the
+// same id always gets the same row.
+//
+// Thread safe, Prefetch reads the file on a thread of its own.
+class HostRowStore final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(HostRowStore);
+  HostRowStore(fs::FileSystem* fs, const std::string& dir, int64_t embedding_size,
+               int64_t capacity, float initializer_scale, int64_t seed);
+  ~HostRowStore();
+
+  int64_t embedding_size() const { return embedding_size_; }
+
+  void Get(const int64_t* ids, int64_t num_ids, float* rows);
+  void Put(const int64_t* ids, int64_t num_ids, const float* rows);
+  // Reads the rows of the ids from the file into the cache in the background.
+  void Prefetch(std::vector<int64_t> ids);
+  // Writes the dirty rows in the cache to the file.
+  void Flush();
+  // Saves all the rows as a compacted RowFileTable under `dir` of `fs`.
+  void Save(fs::FileSystem* fs, const std::string& dir);
+  // Replaces the rows of the ids saved under `dir`, the other ids keep theirs.
+  void Load(fs::FileSystem* fs, const std::string& dir);
+
+ private:
+  struct CachedRow {
+    int64_t id;
+    bool dirty;
+    std::vector<float> data;
+  };
+
+  // Returns the cached row of the id, a missing one is read from the file or initialized once
+  // the least recently used row makes room for it.
+  CachedRow* Touch(int64_t id);
+  void InitializeRow(int64_t id, float* row) const;
+  void FlushLocked();
+  void PrefetchLoop();
+
+  const int64_t embedding_size_;
+  const int64_t capacity_;
+  const float initializer_scale_;
+  const int64_t seed_;
+  RowFileTable table_;
+  std::list<CachedRow> lru_rows_;
+  HashMap<int64_t, std::list<CachedRow>::iterator> id2row_;
+  std::mutex mutex_;
+  Channel<std::vector<int64_t>> prefetch_channel_;
+  std::thread prefetch_thread_;
+};
+
+}  // namespace embedding
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_EMBEDDING_HOST_ROW_STORE_H_
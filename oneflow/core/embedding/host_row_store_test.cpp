@@ -0,0 +1,103 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <gtest/gtest.h>
+#include "oneflow/core/common/process_state.h"
+#include "oneflow/core/common/str_util.h"
+#include "oneflow/core/embedding/host_row_store.h"
+
+namespace oneflow {
+
+namespace embedding {
+
+namespace {
+
+constexpr int64_t kEmbeddingSize = 4;
+
+std::string TestDir(const std::string& name) {
+  std::string current_dir = GetCwd();
+  StringReplace(&current_dir, '\\', '/');
+  const std::string dir = JoinPath(current_dir, "/tmp_test_embedding_" + name);
+  if (LocalFS()->IsDirectory(dir)) { LocalFS()->RecursivelyDeleteDir(dir); }
+  return dir;
+}
+
+std::vector<float> MakeRow(int64_t id) {
+  std::vector<float> row(kEmbeddingSize);
+  for (int64_t i = 0; i < kEmbeddingSize; ++i) { row[i] = id * 10 + i; }
+  return row;
+}
+
+}  // namespace
+
+TEST(RowFileTable, put_get_compact) {
+  const std::string dir = TestDir("table");
+  const size_t row_size = kEmbeddingSize * sizeof(float);
+  {
+    RowFileTable table(LocalFS(), dir, row_size);
+    for (int64_t id : {3, 1, 3, 7, 1}) {
+      table.Put(id, reinterpret_cast<const char*>(MakeRow(id).data()));
+    }
+    ASSERT_EQ(table.num_rows(), 3);
+    std::vector<float> row(kEmbeddingSize);
+    ASSERT_FALSE(table.Get(2, reinterpret_cast<char*>(row.data())));
+    ASSERT_TRUE(table.Get(7, reinterpret_cast<char*>(row.data())));
+    ASSERT_EQ(row, MakeRow(7));
+    table.Compact();
+    ASSERT_EQ(table.log_size(), 3 * (sizeof(int64_t) + row_size));
+  }
+  // a reopened table rebuilds its index from the log
+  RowFileTable table(LocalFS(), dir, row_size);
+  ASSERT_EQ(table.num_rows(), 3);
+  std::vector<float> row(kEmbeddingSize);
+  ASSERT_TRUE(table.Get(3, reinterpret_cast<char*>(row.data())));
+  ASSERT_EQ(row, MakeRow(3));
+  LocalFS()->RecursivelyDeleteDir(dir);
+}
+
+TEST(HostRowStore, evict_and_reload) {
+  const std::string dir = TestDir("store");
+  const std::string snapshot_dir = TestDir("snapshot");
+  {
+    HostRowStore store(LocalFS(), dir, kEmbeddingSize, /*capacity=*/2,
+                       /*initializer_scale=*/1, /*seed=*/7);
+    std::vector<float> initial(kEmbeddingSize);
+    std::vector<float> row(kEmbeddingSize);
+    const int64_t id_5 = 5;
+    store.Get(&id_5, 1, initial.data());
+    store.Get(&id_5, 1, row.data());
+    ASSERT_EQ(row, initial);
+    // put more rows than the cache holds, the evicted ones are read back from the file
+    for (int64_t id = 0; id < 5; ++id) { store.Put(&id, 1, MakeRow(id).data()); }
+    for (int64_t id = 0; id < 5; ++id) {
+      store.Get(&id, 1, row.data());
+      ASSERT_EQ(row, MakeRow(id));
+    }
+    store.Save(LocalFS(), snapshot_dir);
+    const int64_t id_0 = 0;
+    store.Put(&id_0, 1, MakeRow(100).data());
+    store.Load(LocalFS(), snapshot_dir);
+    store.Get(&id_0, 1, row.data());
+    ASSERT_EQ(row, MakeRow(0));
+    store.Get(&id_5, 1, row.data());
+    ASSERT_EQ(row, initial);
+  }
+  LocalFS()->RecursivelyDeleteDir(dir);
+  LocalFS()->RecursivelyDeleteDir(snapshot_dir);
+}
+
+}  // namespace embedding
+
+}  // namespace oneflow
@@ -0,0 +1,120 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/embedding/row_file_table.h"
+#include "oneflow/core/common/str_util.h"
+
+namespace oneflow {
+
+namespace embedding {
+
+namespace {
+
+constexpr int64_t kNumRecordsPerScan = 4096;
+
+}  // namespace
+
+RowFileTable::RowFileTable(fs::FileSystem* fs, const std::string& dir, size_t row_size)
+    : fs_(fs), log_path_(JoinPath(dir, "rows")), row_size_(row_size), log_size_(0),
+      unflushed_(false) {
+  CHECK_GT(row_size_, 0);
+  fs_->RecursivelyCreateDirIfNotExist(dir);
+  if (fs_->FileExists(log_path_)) { ScanLog(); }
+  OpenWriter();
+}
+
+RowFileTable::~RowFileTable() {
+  reader_.reset();
+  if (writer_) { writer_->Close(); }
+}
+
+void RowFileTable::ScanLog() {
+  log_size_ = fs_->GetFileSize(log_path_);
+  CHECK_EQ(log_size_ % record_size(), 0) << log_path_ << " is not a log of rows of " << row_size_
+                                         << " bytes";
+  id2offset_.clear();
+  fs_->NewRandomAccessFile(log_path_, &reader_);
+  std::vector<char> buffer(kNumRecordsPerScan * record_size());
+  for (uint64_t offset = 0; offset < log_size_; offset += buffer.size()) {
+    const size_t size = std::min<uint64_t>(buffer.size(), log_size_ - offset);
+    reader_->Read(offset, size, buffer.data());
+    for (size_t pos = 0; pos < size; pos += record_size()) {
+      int64_t id = 0;
+      std::memcpy(&id, buffer.data() + pos, sizeof(int64_t));
+      id2offset_[id] = offset + pos + sizeof(int64_t);
+    }
+  }
+}
+
+void RowFileTable::OpenWriter() {
+  fs_->NewAppendableFile(log_path_, &writer_);
+  CHECK(writer_) << "failed to open " << log_path_;
+}
+
+void RowFileTable::FlushIfNeeded() {
+  if (!unflushed_) { return; }
+  writer_->Flush();
+  unflushed_ = false;
+  // the reader is opened once the log exists, pread sees what is appended after that
+  if (!reader_) { fs_->NewRandomAccessFile(log_path_, &reader_); }
+}
+
+bool RowFileTable::Get(int64_t id, char* row) {
+  const auto it = id2offset_.find(id);
+  if (it == id2offset_.end()) { return false; }
+  FlushIfNeeded();
+  reader_->Read(it->second, row_size_, row);
+  return true;
+}
+
+void RowFileTable::Put(int64_t id, const char* row) {
+  writer_->Append(reinterpret_cast<const char*>(&id), sizeof(int64_t));
+  writer_->Append(row, row_size_);
+  id2offset_[id] = log_size_ + sizeof(int64_t);
+  log_size_ += record_size();
+  unflushed_ = true;
+}
+
+void RowFileTable::ForEachRow(const std::function<void(int64_t id, const char* row)>& Handler) {
+  FlushIfNeeded();
+  std::vector<char> row(row_size_);
+  for (const auto& pair : id2offset_) {
+    reader_->Read(pair.second, row_size_, row.data());
+    Handler(pair.first, row.data());
+  }
+}
+
+void RowFileTable::Compact() {
+  if (log_size_ == num_rows() * record_size()) { return; }
+  const std::string tmp_path = log_path_ + ".compact";
+  {
+    std::unique_ptr<fs::WritableFile> tmp_writer;
+    fs_->NewWritableFile(tmp_path, &tmp_writer);
+    ForEachRow([&](int64_t id, const char* row) {
+      tmp_writer->Append(reinterpret_cast<const char*>(&id), sizeof(int64_t));
+      tmp_writer->Append(row, row_size_);
+    });
+    tmp_writer->Close();
+  }
+  reader_.reset();
+  writer_->Close();
+  fs_->RenameFile(tmp_path, log_path_);
+  ScanLog();
+  OpenWriter();
+}
+
+}  // namespace embedding
+
+}  // namespace oneflow
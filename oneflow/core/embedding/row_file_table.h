@@ -0,0 +1,66 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_EMBEDDING_ROW_FILE_TABLE_H_
+#define ONEFLOW_CORE_EMBEDDING_ROW_FILE_TABLE_H_
+
+#include "oneflow/core/common/util.h"
+#include "oneflow/core/persistence/file_system.h"
+
+namespace oneflow {
+
+namespace embedding {
+
+// The rows of an embedding in a log of (id, row) records in the file `rows` under a directory.
+// A Put appends a record and the index in memory points the id to its latest record, so the file
+// is only written sequentially and read at random, which is all fs::FileSystem offers. Compact
+// drops the records that have been overwritten.
+class RowFileTable final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(RowFileTable);
+  RowFileTable(fs::FileSystem* fs, const std::string& dir, size_t row_size);
+  ~RowFileTable();
+
+  size_t row_size() const { return row_size_; }
+  int64_t num_rows() const { return id2offset_.size(); }
+  uint64_t log_size() const { return log_size_; }
+
+  // Returns false if the id has never been put.
+  bool Get(int64_t id, char* row);
+  void Put(int64_t id, const char* row);
+  void ForEachRow(const std::function<void(int64_t id, const char* row)>& Handler);
+  void Compact();
+
+ private:
+  size_t record_size() const { return sizeof(int64_t) + row_size_; }
+  void ScanLog();
+  void OpenWriter();
+  void FlushIfNeeded();
+
+  fs::FileSystem* fs_;
+  std::string log_path_;
+  size_t row_size_;
+  HashMap<int64_t, uint64_t> id2offset_;
+  std::unique_ptr<fs::WritableFile> writer_;
+  std::unique_ptr<fs::RandomAccessFile> reader_;
+  uint64_t log_size_;
+  bool unflushed_;
+};
+
+}  // namespace embedding
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_EMBEDDING_ROW_FILE_TABLE_H_
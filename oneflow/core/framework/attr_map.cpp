@@ -49,6 +49,8 @@ AttrName2AttrValWrapper::AttrName2AttrValWrapper(
 }
 
 bool AttrName2AttrValWrapper::operator==(const AttrName2AttrValWrapper& other) const {
+  if (attrs_ == other.attrs_) { return true; }
+  if (hash_value_ != other.hash_value_) { return false; }
   if (this->size() != other.size()) { return false; }
   for (const_iterator this_iter = this->begin(), that_iter = other.begin();
        this_iter != this->end(); ++this_iter, ++that_iter) {
@@ -71,10 +73,52 @@ AttrName2AttrValWrapper MakeAttrName2AttrValWrapper(
   return AttrName2AttrValWrapper(attrs);
 }
 
+size_t HashMutableAttrMap(const MutableAttrMap& attrs) {
+  size_t hash_value = 0;
+  for (const auto& pair : attrs) {
+    hash_value ^= std::hash<std::string>()(pair.first);
+    hash_value ^= pair.second->hash_value();
+  }
+  return hash_value;
+}
+
+bool IsEqualToMutableAttrMap(const AttrName2AttrValWrapper& lhs, const MutableAttrMap& rhs) {
+  if (lhs.size() != rhs.size()) { return false; }
+  auto rhs_iter = rhs.begin();
+  for (const auto& pair : lhs) {
+    if (pair.first != rhs_iter->first) { return false; }
+    if (pair.second != rhs_iter->second && *pair.second != *rhs_iter->second) { return false; }
+    ++rhs_iter;
+  }
+  return true;
+}
+
+constexpr size_t kMaxInternedAttrMapsPerThread = 4096;
+
+// Eager ops convert a MutableAttrMap built per call into an AttrMap, mostly with the values of
+// an earlier call. The immutable maps are interned per thread, so that a repeated conversion
+// allocates nothing and the caches keyed by the AttrMap compare it by pointer. The table is
+// dropped when full, e.g. by the ever changing operands of scalar ops.
 AttrName2AttrValWrapper MakeAttrName2AttrValWrapper(const MutableAttrMap& other) {
+  thread_local HashMap<size_t, std::vector<AttrName2AttrValWrapper>> hash2interned;
+  thread_local size_t interned_cnt = 0;
+  const size_t hash_value = HashMutableAttrMap(other);
+  const auto& it = hash2interned.find(hash_value);
+  if (it != hash2interned.end()) {
+    for (const auto& interned : it->second) {
+      if (IsEqualToMutableAttrMap(interned, other)) { return interned; }
+    }
+  }
+  if (interned_cnt >= kMaxInternedAttrMapsPerThread) {
+    hash2interned.clear();
+    interned_cnt = 0;
+  }
   const auto& attrs = std::make_shared<AttrName2AttrVal>();
   for (const auto& pair : other) { attrs->emplace(pair.first, pair.second); }
-  return AttrName2AttrValWrapper(attrs);
+  AttrName2AttrValWrapper wrapper(attrs);
+  hash2interned[hash_value].push_back(wrapper);
+  ++interned_cnt;
+  return wrapper;
 }
 
 AttrName2AttrValWrapper MakeAttrName2AttrValWrapper(const MutableCfgAttrMap& other) {
@@ -32,6 +32,12 @@ bool OptionalEqual(const Optional<Symbol<cfg::ParallelDistribution>>& lhs,
   return CHECK_JUST(lhs.value()) == CHECK_JUST(rhs.value());
 }
 
+size_t ConsistentTensorInferCacheMaxSize() {
+  static const size_t max_size =
+      ParseIntegerFromEnv("ONEFLOW_CONSISTENT_TENSOR_INFER_CACHE_MAX_SIZE", 4096);
+  return max_size;
+}
+
 }  // namespace
 
 size_t InputConsistentTensorMeta::hash_value() const {
@@ -56,7 +62,7 @@ void InputConsistentTensorMeta::assign(
   consumer_parallel_distribution_constraint_ = consumer_parallel_distribution_constraint;
 }
 
-size_t ConsistentTensorMetaInferArgs::hash_value() const {
+size_t ConsistentTensorMetaInferArgs::CalcHashValue() const {
   size_t hash_value = std::hash<AttrMap>()(attrs_);
   const auto& tensor_meta_hash_functor = std::hash<InputConsistentTensorMeta>();
   for (const auto& tensor_meta : input_consistent_tensor_metas_) {
@@ -65,7 +71,7 @@ size_t ConsistentTensorMetaInferArgs::hash_value() const {
   return hash_value;
 }
 
-size_t SrcOpConsistentTensorMetaInferArgs::hash_value() const {
+size_t SrcOpConsistentTensorMetaInferArgs::CalcHashValue() const {
   size_t hash_value = std::hash<AttrMap>()(attrs_);
   hash_value ^= std::hash<Symbol<ParallelDesc>>()(parallel_desc_);
   hash_value ^= std::hash<Symbol<cfg::ParallelDistribution>>()(parallel_distribution_);
@@ -73,13 +79,14 @@ size_t SrcOpConsistentTensorMetaInferArgs::hash_value() const {
 }
 
 bool ConsistentTensorMetaInferArgs::operator==(const ConsistentTensorMetaInferArgs& other) const {
-  return this->attrs_ == other.attrs_
+  return this->hash_value_ == other.hash_value_ && this->attrs_ == other.attrs_
          && this->input_consistent_tensor_metas_ == other.input_consistent_tensor_metas_;
 }
 
 bool SrcOpConsistentTensorMetaInferArgs::operator==(
     const SrcOpConsistentTensorMetaInferArgs& other) const {
-  return this->attrs_ == other.attrs_ && this->parallel_desc_ == other.parallel_desc_
+  return this->hash_value_ == other.hash_value_ && this->attrs_ == other.attrs_
+         && this->parallel_desc_ == other.parallel_desc_
          && this->parallel_distribution_ == other.parallel_distribution_;
 }
 
@@ -133,6 +140,7 @@ Maybe<ConsistentTensorMetaInferArgs> ConsistentTensorMetaInferArgs::New(
   infer_args->attrs_ = attrs;
   infer_args->input_consistent_tensor_metas_.resize(input_tensors.size());
   JUST(infer_args->InitInputConsistentTensorMetas(input_tensors));
+  infer_args->hash_value_ = infer_args->CalcHashValue();
   return infer_args;
 }
 
@@ -144,6 +152,7 @@ Maybe<SrcOpConsistentTensorMetaInferArgs> SrcOpConsistentTensorMetaInferArgs::Ne
   infer_args->attrs_ = attrs;
   infer_args->parallel_desc_ = parallel_desc;
   infer_args->parallel_distribution_ = parallel_distribution;
+  infer_args->hash_value_ = infer_args->CalcHashValue();
   return infer_args;
 }
 
@@ -274,28 +283,48 @@ Maybe<void> CheckIsDeviceSupportedByOp(const ParallelDesc& parallel_desc,
   return std::shared_ptr<const ConsistentTensorInferResult>(result);
 }
 
+ConsistentTensorInferCache::ConsistentTensorInferCache(
+    const std::shared_ptr<const UserOpExpr>& user_op_expr)
+    : user_op_expr_(user_op_expr),
+      op_name_(user_op_expr->op_name()),
+      cache_(ConsistentTensorInferCacheMaxSize()),
+      src_op_cache_(ConsistentTensorInferCacheMaxSize()) {}
+
+ConsistentTensorInferCache::~ConsistentTensorInferCache() {
+  VLOG(1) << "ConsistentTensorInferCache of op " << op_name_ << ": hit " << hit_count()
+          << ", miss " << miss_count() << ", eviction " << eviction_count();
+}
+
 Maybe<const ConsistentTensorInferResult> ConsistentTensorInferCache::GetOrInfer(
     const ConsistentTensorMetaInferArgs& infer_args) {
-  auto iter = cache_.find(infer_args);
-  if (iter == cache_.end()) {
-    const auto& user_op_expr = user_op_expr_.lock();
-    CHECK_OR_RETURN(static_cast<bool>(user_op_expr));
-    const auto& output_tensor_metas = JUST(Infer(*user_op_expr, infer_args));
-    iter = cache_.emplace(infer_args, output_tensor_metas).first;
+  const size_t hash_value = std::hash<ConsistentTensorMetaInferArgs>()(infer_args);
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    const auto* result = cache_.Find(infer_args, hash_value);
+    if (result != nullptr) { return *result; }
   }
-  return iter->second;
+  const auto& user_op_expr = user_op_expr_.lock();
+  CHECK_OR_RETURN(static_cast<bool>(user_op_expr));
+  const auto& output_tensor_metas = JUST(Infer(*user_op_expr, infer_args));
+  std::unique_lock<std::mutex> lock(mutex_);
+  cache_.Insert(infer_args, hash_value, output_tensor_metas);
+  return output_tensor_metas;
 }
 
 Maybe<const ConsistentTensorInferResult> ConsistentTensorInferCache::GetOrInfer(
     const SrcOpConsistentTensorMetaInferArgs& infer_args) {
-  auto iter = src_op_cache_.find(infer_args);
-  if (iter == src_op_cache_.end()) {
-    const auto& user_op_expr = user_op_expr_.lock();
-    CHECK_OR_RETURN(static_cast<bool>(user_op_expr));
-    const auto& output_tensor_metas = JUST(Infer(*user_op_expr, infer_args));
-    iter = src_op_cache_.emplace(infer_args, output_tensor_metas).first;
+  const size_t hash_value = std::hash<SrcOpConsistentTensorMetaInferArgs>()(infer_args);
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    const auto* result = src_op_cache_.Find(infer_args, hash_value);
+    if (result != nullptr) { return *result; }
   }
-  return iter->second;
+  const auto& user_op_expr = user_op_expr_.lock();
+  CHECK_OR_RETURN(static_cast<bool>(user_op_expr));
+  const auto& output_tensor_metas = JUST(Infer(*user_op_expr, infer_args));
+  std::unique_lock<std::mutex> lock(mutex_);
+  src_op_cache_.Insert(infer_args, hash_value, output_tensor_metas);
+  return output_tensor_metas;
 }
 
 }  // namespace one
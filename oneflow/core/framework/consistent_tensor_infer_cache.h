@@ -16,9 +16,12 @@ limitations under the License.
 #ifndef ONEFLOW_CORE_FRAMEWORK_CONSISTENT_TENSOR_INFER_CACHE_H_
 #define ONEFLOW_CORE_FRAMEWORK_CONSISTENT_TENSOR_INFER_CACHE_H_
 
+#include <mutex>
+
 #include "oneflow/core/common/symbol.h"
 #include "oneflow/core/common/maybe.h"
 #include "oneflow/core/common/optional.h"
+#include "oneflow/core/common/lru_cache.h"
 #include "oneflow/core/framework/attr_map.h"
 #include "oneflow/core/framework/tensor_meta.h"
 #include "oneflow/core/register/blob_desc.h"
@@ -80,7 +83,7 @@ class ConsistentTensorMetaInferArgs final {
   }
   const AttrMap& attrs() const { return attrs_; }
 
-  size_t hash_value() const;
+  size_t hash_value() const { return hash_value_; }
 
   bool operator==(const ConsistentTensorMetaInferArgs& other) const;
 
@@ -101,9 +104,12 @@ class ConsistentTensorMetaInferArgs final {
  private:
   ConsistentTensorMetaInferArgs() = default;
   Maybe<void> InitInputConsistentTensorMetas(const TensorTuple& input_tensors);
+  size_t CalcHashValue() const;
 
   AttrMap attrs_;
   std::vector<InputConsistentTensorMeta> input_consistent_tensor_metas_;
+  // computed once by New, the args are looked up and then inserted by the infer cache
+  size_t hash_value_;
 };
 
 class SrcOpConsistentTensorMetaInferArgs final {
@@ -116,7 +122,7 @@ class SrcOpConsistentTensorMetaInferArgs final {
   Symbol<cfg::ParallelDistribution> parallel_distribution() const { return parallel_distribution_; }
   const AttrMap& attrs() const { return attrs_; }
 
-  size_t hash_value() const;
+  size_t hash_value() const { return hash_value_; }
 
   bool operator==(const SrcOpConsistentTensorMetaInferArgs& other) const;
 
@@ -126,10 +132,12 @@ class SrcOpConsistentTensorMetaInferArgs final {
 
  private:
   SrcOpConsistentTensorMetaInferArgs() = default;
+  size_t CalcHashValue() const;
 
   AttrMap attrs_;
   Symbol<ParallelDesc> parallel_desc_;
   Symbol<cfg::ParallelDistribution> parallel_distribution_;
+  size_t hash_value_;
 };
 
 class OpArgMutConsistentTensorMeta final {
@@ -209,8 +217,8 @@ class ConsistentTensorInferResult final {
 
 class ConsistentTensorInferCache final {
  public:
-  ConsistentTensorInferCache(const std::shared_ptr<const UserOpExpr>& user_op_expr)
-      : user_op_expr_(user_op_expr) {}
+  explicit ConsistentTensorInferCache(const std::shared_ptr<const UserOpExpr>& user_op_expr);
+  ~ConsistentTensorInferCache();
 
   Maybe<const ConsistentTensorInferResult> GetOrInfer(
       const ConsistentTensorMetaInferArgs& infer_args);
@@ -224,11 +232,21 @@ class ConsistentTensorInferCache final {
   static Maybe<const ConsistentTensorInferResult> Infer(
       const UserOpExpr& user_op_expr, const SrcOpConsistentTensorMetaInferArgs& infer_args);
 
+  int64_t hit_count() const { return cache_.hit_count() + src_op_cache_.hit_count(); }
+  int64_t miss_count() const { return cache_.miss_count() + src_op_cache_.miss_count(); }
+  int64_t eviction_count() const {
+    return cache_.eviction_count() + src_op_cache_.eviction_count();
+  }
+
  private:
   std::weak_ptr<const UserOpExpr> user_op_expr_;
-  HashMap<ConsistentTensorMetaInferArgs, std::shared_ptr<const ConsistentTensorInferResult>> cache_;
-  HashMap<SrcOpConsistentTensorMetaInferArgs, std::shared_ptr<const ConsistentTensorInferResult>>
+  std::string op_name_;
+  LruCache<ConsistentTensorMetaInferArgs, std::shared_ptr<const ConsistentTensorInferResult>>
+      cache_;
+  LruCache<SrcOpConsistentTensorMetaInferArgs, std::shared_ptr<const ConsistentTensorInferResult>>
       src_op_cache_;
+  // Guards both caches, the inference itself runs unlocked
+  std::mutex mutex_;
 };
 
 }  // namespace one
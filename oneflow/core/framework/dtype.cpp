@@ -33,7 +33,8 @@ std::size_t GetDataTypeBytes() {
 
 #define MAKE_DATA_TYPE_BYTES_SWITCH_ENTRY(func_name, T) func_name<T>
 DEFINE_STATIC_SWITCH_FUNC(std::size_t, GetDataTypeBytes, MAKE_DATA_TYPE_BYTES_SWITCH_ENTRY,
-                          MAKE_DATA_TYPE_CTRV_SEQ(POD_DATA_TYPE_SEQ FLOAT16_DATA_TYPE_SEQ));
+                          MAKE_DATA_TYPE_CTRV_SEQ(POD_DATA_TYPE_SEQ FLOAT16_DATA_TYPE_SEQ
+                                                  BFLOAT16_DATA_TYPE_SEQ));
 
 class DTypeMeta final {
  public:
@@ -63,6 +64,7 @@ Maybe<const DTypeMeta&> DTypeMeta4DataType(DataType data_type) {
       {DataType::kInvalidDataType, DTypeMeta("oneflow.invalid_data_type", false, false, false)},
       {DataType::kChar, DTypeMeta("oneflow.char", false, false, false)},
       {DataType::kFloat16, DTypeMeta("oneflow.float16", true, true, false)},
+      {DataType::kBFloat16, DTypeMeta("oneflow.bfloat16", true, true, false)},
       {DataType::kFloat, DTypeMeta("oneflow.float32", true, true, false)},
       {DataType::kDouble, DTypeMeta("oneflow.float64", true, true, false)},
       {DataType::kInt8, DTypeMeta("oneflow.int8", true, false, false)},
@@ -82,6 +82,24 @@ Maybe<void> CheckAttrFnUtil::NoCheck(const UserOpDefWrapper&, const UserOpConfWr
 
 size_t TmpSizeInferFnUtil::ZeroTmpSize(InferContext*) { return 0; }
 
+int64_t FlopsInferFnUtil::Unknown(InferContext*) { return 0; }
+
+int64_t FlopsInferFnUtil::OutputElemCnt(InferContext* ctx) {
+  int64_t flops = 0;
+  for (const auto& output : ctx->outputs()) {
+    flops += ctx->Shape4ArgNameAndIndex(output.first, output.second)->elem_cnt();
+  }
+  return flops;
+}
+
+int64_t FlopsInferFnUtil::InputElemCnt(InferContext* ctx) {
+  int64_t flops = 0;
+  for (const auto& input : ctx->inputs()) {
+    flops += ctx->InputShape(input.first, input.second).elem_cnt();
+  }
+  return flops;
+}
+
 }  // namespace user_op
 
 }  // namespace oneflow
@@ -126,6 +126,14 @@ struct TmpSizeInferFnUtil {
   static size_t ZeroTmpSize(InferContext*);
 };
 
+struct FlopsInferFnUtil {
+  static int64_t Unknown(InferContext*);
+  // one operation per element of the outputs, for the elementwise kernels
+  static int64_t OutputElemCnt(InferContext*);
+  // one operation per element of the inputs, for the reduction kernels
+  static int64_t InputElemCnt(InferContext*);
+};
+
 }  // namespace user_op
 
 }  // namespace oneflow
@@ -18,6 +18,9 @@ limitations under the License.
 #include "oneflow/core/framework/instruction_replay.h"
 #include "oneflow/core/vm/vm_util.h"
 #include "oneflow/core/vm/instruction.msg.h"
+#include "oneflow/core/eager/eager_blob_object.h"
+#include "oneflow/core/framework/device.h"
+#include "oneflow/core/framework/tensor.h"
 
 namespace oneflow {
 
@@ -33,6 +36,20 @@ std::list<ObjectMsgPtr<vm::InstructionMsg>>* RecordedInstructionList() {
   return &list;
 }
 
+InstructionsCapture** CurrentInstructionsCapture() {
+  static thread_local InstructionsCapture* capture = nullptr;
+  return &capture;
+}
+
+bool IsCallbackInstruction(const vm::InstructionMsg& instr_msg) {
+  static const std::string kCallbackSuffix = "Callback";
+  const std::string& name = instr_msg.instr_type_name();
+  return name.size() >= kCallbackSuffix.size()
+         && name.compare(name.size() - kCallbackSuffix.size(), kCallbackSuffix.size(),
+                         kCallbackSuffix)
+                == 0;
+}
+
 }  // namespace
 
 namespace debug {
@@ -59,4 +76,89 @@ void ReplayInstructions() {
 
 }  // namespace debug
 
+InstructionsCapture::InstructionsCapture(
+    const std::vector<std::shared_ptr<one::Tensor>>& static_tensors)
+    : static_tensors_(static_tensors), is_captured_(false) {}
+
+/* static */ Maybe<InstructionsCapture::StaticTensorMeta> InstructionsCapture::MakeStaticTensorMeta(
+    const std::shared_ptr<one::Tensor>& tensor) {
+  CHECK_OR_RETURN(tensor->is_local() && tensor->is_eager())
+      << "only eager local tensors can be static tensors of an instructions capture";
+  auto meta = std::make_shared<StaticTensorMeta>();
+  meta->shape = *tensor->shape();
+  meta->data_type = tensor->dtype();
+  meta->device = JUST(tensor->device());
+  meta->eager_blob_object = JUST(tensor->eager_blob_object());
+  return meta;
+}
+
+Maybe<bool> InstructionsCapture::IsStaticTensorsUnchanged() const {
+  CHECK_EQ_OR_RETURN(static_tensors_.size(), static_tensor_metas_.size());
+  for (int64_t i = 0; i < static_tensors_.size(); ++i) {
+    const auto& tensor = static_tensors_.at(i);
+    const auto& meta = static_tensor_metas_.at(i);
+    if (*tensor->shape() != meta.shape) { return false; }
+    if (tensor->dtype() != meta.data_type) { return false; }
+    if (JUST(tensor->device()) != meta.device) { return false; }
+    if (JUST(tensor->eager_blob_object()) != meta.eager_blob_object.lock()) { return false; }
+  }
+  return true;
+}
+
+Maybe<void> InstructionsCapture::BeginCapture() {
+  CHECK_OR_RETURN(!IsCapturing()) << "nested instructions capture is not supported";
+  Reset();
+  for (const auto& tensor : static_tensors_) {
+    static_tensor_metas_.push_back(*JUST(MakeStaticTensorMeta(tensor)));
+  }
+  *CurrentInstructionsCapture() = this;
+  return Maybe<void>::Ok();
+}
+
+Maybe<void> InstructionsCapture::EndCapture() {
+  CHECK_OR_RETURN(*CurrentInstructionsCapture() == this) << "instructions capture is not started";
+  *CurrentInstructionsCapture() = nullptr;
+  const bool is_unchanged = JUST(IsStaticTensorsUnchanged());
+  if (!is_unchanged) { Reset(); }
+  CHECK_OR_RETURN(is_unchanged) << "static tensors are changed while capturing instructions";
+  is_captured_ = true;
+  return Maybe<void>::Ok();
+}
+
+Maybe<bool> InstructionsCapture::TryReplay() {
+  CHECK_OR_RETURN(is_captured_) << "no instructions are captured";
+  CHECK_OR_RETURN(!IsCapturing()) << "instructions can not be replayed while capturing";
+  if (!JUST(IsStaticTensorsUnchanged())) { return false; }
+  vm::InstructionMsgList instr_msg_list;
+  for (const auto& instr_msg : instructions_) { instr_msg_list.EmplaceBack(instr_msg->Clone()); }
+  JUST(vm::Run(&instr_msg_list));
+  return true;
+}
+
+void InstructionsCapture::Reset() {
+  static_tensor_metas_.clear();
+  instructions_.clear();
+  is_captured_ = false;
+}
+
+/* static */ bool InstructionsCapture::IsCapturing() {
+  return *CurrentInstructionsCapture() != nullptr;
+}
+
+/* static */ Maybe<void> InstructionsCapture::RecordInstructions(
+    vm::InstructionMsgList* instr_msg_list) {
+  InstructionsCapture* capture = *CurrentInstructionsCapture();
+  CHECK_NOTNULL_OR_RETURN(capture);
+  OBJECT_MSG_LIST_FOR_EACH(instr_msg_list, instr_msg) {
+    // host callbacks, e.g. reading a tensor to numpy or a sync, can not be run twice
+    if (IsCallbackInstruction(*instr_msg)) {
+      *CurrentInstructionsCapture() = nullptr;
+      capture->Reset();
+      OF_UNIMPLEMENTED() << "capturing instruction " << instr_msg->instr_type_name();
+    }
+    capture->instructions_.push_back(instr_msg);
+  }
+  return Maybe<void>::Ok();
+}
+
 }  // namespace oneflow
@@ -17,10 +17,27 @@ limitations under the License.
 #ifndef ONEFLOW_CORE_FRAMEWORK_INSTRUCTION_REPLAY_H_
 #define ONEFLOW_CORE_FRAMEWORK_INSTRUCTION_REPLAY_H_
 
+#include "oneflow/core/common/maybe.h"
+#include "oneflow/core/common/shape.h"
+#include "oneflow/core/common/symbol.h"
 #include "oneflow/core/vm/instruction.msg.h"
 
 namespace oneflow {
 
+class Device;
+
+namespace vm {
+
+class EagerBlobObject;
+
+}  // namespace vm
+
+namespace one {
+
+class Tensor;
+
+}  // namespace one
+
 namespace debug {
 
 bool RecordingInstructions();
@@ -37,6 +54,50 @@ void ReplayInstructions();
 
 }  // namespace debug
 
+// Records the instructions built by one eager step on this thread, and replays them on later
+// steps straight into the virtual machine, bypassing Python and the op interpreters.
+//
+// The replayed instructions read and write the blobs of the captured step, so the caller feeds a
+// new step by writing into the static tensors in place. Before every replay the static tensors are
+// checked against their metas at capture time; if a shape, data type, device or blob changed,
+// nothing is run and the caller is expected to fall back to the normal dispatch.
+class InstructionsCapture final {
+ public:
+  InstructionsCapture(const InstructionsCapture&) = delete;
+  InstructionsCapture(InstructionsCapture&&) = delete;
+  explicit InstructionsCapture(const std::vector<std::shared_ptr<one::Tensor>>& static_tensors);
+  ~InstructionsCapture() = default;
+
+  Maybe<void> BeginCapture();
+  Maybe<void> EndCapture();
+  bool is_captured() const { return is_captured_; }
+  size_t instruction_size() const { return instructions_.size(); }
+
+  // Returns false without running anything if the static tensors no longer match the capture.
+  Maybe<bool> TryReplay();
+  void Reset();
+
+  // Called by PhysicalRun for every instruction list it sends to the virtual machine.
+  static bool IsCapturing();
+  static Maybe<void> RecordInstructions(vm::InstructionMsgList* instr_msg_list);
+
+ private:
+  struct StaticTensorMeta final {
+    Shape shape;
+    DataType data_type;
+    Symbol<Device> device;
+    std::weak_ptr<vm::EagerBlobObject> eager_blob_object;
+  };
+
+  static Maybe<StaticTensorMeta> MakeStaticTensorMeta(const std::shared_ptr<one::Tensor>& tensor);
+  Maybe<bool> IsStaticTensorsUnchanged() const;
+
+  std::vector<std::shared_ptr<one::Tensor>> static_tensors_;
+  std::vector<StaticTensorMeta> static_tensor_metas_;
+  std::vector<ObjectMsgPtr<vm::InstructionMsg>> instructions_;
+  bool is_captured_;
+};
+
 }  // namespace oneflow
 
 #endif  // ONEFLOW_CORE_FRAMEWORK_INSTRUCTION_REPLAY_H_
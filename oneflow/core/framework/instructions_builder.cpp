@@ -40,6 +40,7 @@ limitations under the License.
 #include "oneflow/core/framework/device.h"
 #include "oneflow/core/framework/instruction_replay.h"
 #include "oneflow/core/job/env_desc.h"
+#include "oneflow/core/profiler/host_stage_timing.h"
 
 namespace oneflow {
 
@@ -954,6 +955,25 @@ template Maybe<void> InstructionsBuilder::AccessBlobByCallback(
     const one::EagerMirroredTensorImpl* tensor, const std::function<void(uint64_t)>& callback,
     const std::string& modifier);
 
+Maybe<void> InstructionsBuilder::FetchBlobByCallback(
+    const std::shared_ptr<one::MirroredTensor>& tensor,
+    const std::function<void(uint64_t)>& callback) {
+  const auto& parallel_desc = GetParallelDesc(tensor);
+  std::string instr_name = parallel_desc->device_tag() + ".AccessBlobByCallback";
+  if (parallel_desc->device_type() == DeviceType::kGPU) {
+    instr_name = "cuda_d2h.AccessBlobByCallback";
+  }
+  ObjectMsgPtr<vm::InstructionMsg> instruction = ObjectMsgPtr<vm::InstructionMsg>::New(instr_name);
+  const std::shared_ptr<vm::EagerBlobObject>& eager_blob_object = JUST(tensor->eager_blob_object());
+  const std::shared_ptr<VmLocalDepObject>& compute_local_dep_object =
+      JUST(tensor->compute_local_dep_object());
+  *instruction->mutable_phy_instr_operand() = std::make_shared<vm::AccessBlobArgCbPhyInstrOperand>(
+      eager_blob_object, compute_local_dep_object, callback, "const");
+  *instruction->mut_parallel_desc() = parallel_desc;
+  instruction_list_->EmplaceBack(std::move(instruction));
+  return Maybe<void>::Ok();
+}
+
 Maybe<void> InstructionsBuilder::ComputeRankFrontSeqCallback(
     const std::function<void()>& callback) {
   ObjectMsgPtr<vm::InstructionMsg> instruction =
@@ -1598,6 +1618,7 @@ Maybe<void> LogicalRun(const std::function<Maybe<void>(InstructionsBuilder*)>& B
 }
 
 Maybe<void> PhysicalRun(const std::function<Maybe<void>(InstructionsBuilder*)>& Build) {
+  OF_HOST_STAGE_TIMING_GUARD(kHostStageInstructionsBuilder);
   vm::InstructionMsgList instruction_list;
   vm::cfg::EagerSymbolList eager_symbol_list;
   InstructionsBuilder instructions_builder(std::make_shared<vm::PhysicalIdGenerator>(),
@@ -1609,6 +1630,9 @@ Maybe<void> PhysicalRun(const std::function<Maybe<void>(InstructionsBuilder*)>&
       debug::RecordInstruction(instruction_msg);
     }
   }
+  if (InstructionsCapture::IsCapturing()) {
+    JUST(InstructionsCapture::RecordInstructions(instructions_builder.mut_instruction_list()));
+  }
   JUST(Global<vm::EagerOneflow>::Get()->RunPhysicalInstruction(
       instructions_builder.mut_instruction_list(), instructions_builder.eager_symbol_list()));
   return Maybe<void>::Ok();
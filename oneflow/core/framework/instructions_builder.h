@@ -137,6 +137,11 @@ class InstructionsBuilder : public std::enable_shared_from_this<InstructionsBuil
   Maybe<void> AccessBlobByCallback(const T tensor, const std::function<void(uint64_t)>& callback,
                                    const std::string& modifier);
 
+  // Like AccessBlobByCallback with a const modifier, but the callback of a cuda tensor runs on the
+  // copy_d2h stream, so it does not wait for kernels launched on the compute stream later.
+  Maybe<void> FetchBlobByCallback(const std::shared_ptr<one::MirroredTensor>& tensor,
+                                  const std::function<void(uint64_t)>& callback);
+
   Maybe<void> ComputeRankFrontSeqCallback(const std::function<void()>& callback);
 
   Maybe<void> ComputeGlobalFrontSeqBarrier();
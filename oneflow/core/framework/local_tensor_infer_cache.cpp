@@ -0,0 +1,96 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/framework/local_tensor_infer_cache.h"
+#include "oneflow/core/framework/tensor_tuple.h"
+#include "oneflow/core/framework/tensor.h"
+
+namespace oneflow {
+namespace one {
+
+namespace {
+
+int64_t GetLocalTensorInferCacheMaxSize() {
+  static const int64_t max_size =
+      ParseIntegerFromEnv("ONEFLOW_EAGER_LOCAL_TENSOR_INFER_CACHE_MAX_SIZE", 4096);
+  return max_size;
+}
+
+}  // namespace
+
+size_t InputLocalTensorMeta::hash_value() const {
+  size_t hash_value = std::hash<Symbol<Device>>()(device_);
+  HashCombine(&hash_value, std::hash<Shape>()(shape_));
+  HashCombine(&hash_value, std::hash<int>()(static_cast<int>(data_type_)));
+  return hash_value;
+}
+
+bool InputLocalTensorMeta::operator==(const InputLocalTensorMeta& other) const {
+  return this->device_ == other.device_ && this->shape_ == other.shape_
+         && this->data_type_ == other.data_type_;
+}
+
+size_t LocalTensorMetaInferArgs::hash_value() const {
+  size_t hash_value = std::hash<AttrMap>()(attrs_);
+  HashCombine(&hash_value, std::hash<Symbol<Device>>()(default_device_));
+  const auto& tensor_meta_hash_functor = std::hash<InputLocalTensorMeta>();
+  for (const auto& tensor_meta : input_local_tensor_metas_) {
+    HashCombine(&hash_value, tensor_meta_hash_functor(tensor_meta));
+  }
+  return hash_value;
+}
+
+bool LocalTensorMetaInferArgs::operator==(const LocalTensorMetaInferArgs& other) const {
+  return this->attrs_ == other.attrs_ && this->default_device_ == other.default_device_
+         && this->input_local_tensor_metas_ == other.input_local_tensor_metas_;
+}
+
+/* static */ Maybe<LocalTensorMetaInferArgs> LocalTensorMetaInferArgs::New(
+    const AttrMap& attrs, Symbol<Device> default_device, const TensorTuple& input_tensors) {
+  std::shared_ptr<LocalTensorMetaInferArgs> infer_args(new LocalTensorMetaInferArgs());
+  infer_args->attrs_ = attrs;
+  infer_args->default_device_ = default_device;
+  infer_args->input_local_tensor_metas_.reserve(input_tensors.size());
+  for (const auto& tensor : input_tensors) {
+    infer_args->input_local_tensor_metas_.emplace_back(JUST(tensor->device()), *tensor->shape(),
+                                                       tensor->dtype());
+  }
+  return infer_args;
+}
+
+/* static */ bool LocalTensorInferCache::IsEnabled() {
+  static const bool is_enabled =
+      ParseBooleanFromEnv("ONEFLOW_EAGER_ENABLE_LOCAL_TENSOR_INFER_CACHE", true);
+  return is_enabled;
+}
+
+LocalTensorInferCache::LocalTensorInferCache() : cache_(GetLocalTensorInferCacheMaxSize()) {}
+
+std::shared_ptr<const LocalTensorInferResult> LocalTensorInferCache::Find(
+    const LocalTensorMetaInferArgs& infer_args) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  const auto* result = cache_.Find(infer_args);
+  if (result == nullptr) { return std::shared_ptr<const LocalTensorInferResult>(); }
+  return *result;
+}
+
+void LocalTensorInferCache::Insert(const LocalTensorMetaInferArgs& infer_args,
+                                   const std::shared_ptr<const LocalTensorInferResult>& result) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  cache_.Insert(infer_args, result);
+}
+
+}  // namespace one
+}  // namespace oneflow
@@ -0,0 +1,159 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_FRAMEWORK_LOCAL_TENSOR_INFER_CACHE_H_
+#define ONEFLOW_CORE_FRAMEWORK_LOCAL_TENSOR_INFER_CACHE_H_
+
+#include <mutex>
+
+#include "oneflow/core/common/symbol.h"
+#include "oneflow/core/common/maybe.h"
+#include "oneflow/core/common/shape.h"
+#include "oneflow/core/common/lru_cache.h"
+#include "oneflow/core/framework/attr_map.h"
+#include "oneflow/core/framework/device.h"
+
+namespace oneflow {
+namespace one {
+
+class TensorTuple;
+
+class InputLocalTensorMeta final {
+ public:
+  InputLocalTensorMeta(Symbol<Device> device, const Shape& shape, DataType data_type)
+      : device_(device), shape_(shape), data_type_(data_type) {}
+  InputLocalTensorMeta(const InputLocalTensorMeta&) = default;
+  InputLocalTensorMeta(InputLocalTensorMeta&&) = default;
+  ~InputLocalTensorMeta() = default;
+
+  size_t hash_value() const;
+  bool operator==(const InputLocalTensorMeta& other) const;
+
+ private:
+  Symbol<Device> device_;
+  Shape shape_;
+  DataType data_type_;
+};
+
+class LocalTensorMetaInferArgs final {
+ public:
+  LocalTensorMetaInferArgs(const LocalTensorMetaInferArgs&) = default;
+  LocalTensorMetaInferArgs(LocalTensorMetaInferArgs&&) = default;
+  ~LocalTensorMetaInferArgs() = default;
+
+  size_t hash_value() const;
+  bool operator==(const LocalTensorMetaInferArgs& other) const;
+
+  static Maybe<LocalTensorMetaInferArgs> New(const AttrMap& attrs, Symbol<Device> default_device,
+                                             const TensorTuple& input_tensors);
+
+ private:
+  LocalTensorMetaInferArgs() = default;
+
+  AttrMap attrs_;
+  Symbol<Device> default_device_;
+  std::vector<InputLocalTensorMeta> input_local_tensor_metas_;
+};
+
+}  // namespace one
+}  // namespace oneflow
+
+namespace std {
+
+template<>
+struct hash<oneflow::one::InputLocalTensorMeta> final {
+  size_t operator()(const oneflow::one::InputLocalTensorMeta& val) const {
+    return val.hash_value();
+  }
+};
+
+template<>
+struct hash<oneflow::one::LocalTensorMetaInferArgs> final {
+  size_t operator()(const oneflow::one::LocalTensorMetaInferArgs& val) const {
+    return val.hash_value();
+  }
+};
+
+}  // namespace std
+
+namespace oneflow {
+namespace one {
+
+// Everything NaiveInterpret infers for an eager local op call before building the instruction.
+class LocalTensorInferResult final {
+ public:
+  explicit LocalTensorInferResult(size_t output_size)
+      : output_devices_(output_size),
+        output_shapes_(output_size),
+        output_data_types_(output_size),
+        output_is_dynamics_(output_size) {}
+  LocalTensorInferResult(const LocalTensorInferResult&) = delete;
+  LocalTensorInferResult(LocalTensorInferResult&&) = delete;
+  ~LocalTensorInferResult() = default;
+
+  Symbol<Device> op_device() const { return op_device_; }
+  bool need_check_mem_case() const { return need_check_mem_case_; }
+  bool need_event_record() const { return need_event_record_; }
+  const std::vector<Symbol<Device>>& output_devices() const { return output_devices_; }
+  const std::vector<std::shared_ptr<const Shape>>& output_shapes() const { return output_shapes_; }
+  const std::vector<DataType>& output_data_types() const { return output_data_types_; }
+  const std::vector<bool>& output_is_dynamics() const { return output_is_dynamics_; }
+
+  void set_op_device(Symbol<Device> val) { op_device_ = val; }
+  void set_need_check_mem_case(bool val) { need_check_mem_case_ = val; }
+  void set_need_event_record(bool val) { need_event_record_ = val; }
+  std::vector<Symbol<Device>>* mut_output_devices() { return &output_devices_; }
+  std::vector<std::shared_ptr<const Shape>>* mut_output_shapes() { return &output_shapes_; }
+  std::vector<DataType>* mut_output_data_types() { return &output_data_types_; }
+  std::vector<bool>* mut_output_is_dynamics() { return &output_is_dynamics_; }
+
+ private:
+  Symbol<Device> op_device_;
+  bool need_check_mem_case_;
+  bool need_event_record_;
+  std::vector<Symbol<Device>> output_devices_;
+  std::vector<std::shared_ptr<const Shape>> output_shapes_;
+  std::vector<DataType> output_data_types_;
+  std::vector<bool> output_is_dynamics_;
+};
+
+// Caches the device, shape and data type inference of eager local op calls per UserOpExpr. Both
+// the device infer function and the shape and data type infer functions only depend on the attrs
+// and the input metas, which are the cache key. Safe to use from several threads.
+class LocalTensorInferCache final {
+ public:
+  LocalTensorInferCache();
+  ~LocalTensorInferCache() = default;
+
+  static bool IsEnabled();
+
+  std::shared_ptr<const LocalTensorInferResult> Find(
+      const LocalTensorMetaInferArgs& infer_args);
+  void Insert(const LocalTensorMetaInferArgs& infer_args,
+              const std::shared_ptr<const LocalTensorInferResult>& result);
+
+  int64_t hit_count() const { return cache_.hit_count(); }
+  int64_t miss_count() const { return cache_.miss_count(); }
+  int64_t eviction_count() const { return cache_.eviction_count(); }
+
+ private:
+  LruCache<LocalTensorMetaInferArgs, std::shared_ptr<const LocalTensorInferResult>> cache_;
+  std::mutex mutex_;
+};
+
+}  // namespace one
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_FRAMEWORK_LOCAL_TENSOR_INFER_CACHE_H_
@@ -14,6 +14,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #include "oneflow/core/framework/nn_graph.h"
+#include "oneflow/core/common/blocking_counter.h"
 #include "oneflow/core/common/buffer_manager.h"
 #include "oneflow/core/control/ctrl_client.h"
 #include "oneflow/core/control/global_process_ctx.h"
@@ -26,9 +27,36 @@ limitations under the License.
 #include "oneflow/core/job/plan_util.h"
 #include "oneflow/core/job/runtime.h"
 #include "oneflow/core/persistence/tee_persistent_log_stream.h"
+#include "oneflow/core/register/ofblob.h"
 
 namespace oneflow {
 
+namespace {
+
+// Enqueues a read of each variable behind its pending initialization or loading instructions, so
+// the vm keeps filling the variables while the plan is compiled. The counter reaches zero once
+// every variable blob is allocated and its value is ready on device.
+Maybe<void> AsyncWaitVariablesReady(
+    const std::vector<std::shared_ptr<one::MirroredTensor>>& variable_tensors,
+    const std::shared_ptr<BlockingCounter>& counter) {
+  if (variable_tensors.empty()) { return Maybe<void>::Ok(); }
+  JUST(PhysicalRun([&](InstructionsBuilder* builder) -> Maybe<void> {
+    for (const auto& var : variable_tensors) {
+      JUST(builder->AccessBlobByCallback(
+          var,
+          [counter](uint64_t of_blob_ptr) {
+            reinterpret_cast<OfBlob*>(of_blob_ptr)->mut_device_ctx()->SyncDevice();
+            counter->Decrease();
+          },
+          "const"));
+    }
+    return Maybe<void>::Ok();
+  }));
+  return Maybe<void>::Ok();
+}
+
+}  // namespace
+
 NNGraph::~NNGraph() {
   CloseRuntimeBuffers();
   runtime_.reset();
@@ -58,18 +86,19 @@ Maybe<void> NNGraph::RegisterVariableOpNamesAndTensors(
   for (int32_t i = 0; i < variable_op_names.size(); ++i) {
     const std::shared_ptr<one::Tensor>& var = variable_tensors.at(i);
     CHECK_OR_RETURN(var->is_eager());
-    Blob* var_blob = nullptr;
+    std::shared_ptr<one::MirroredTensor> local_var;
     if (var->is_consistent()) {
       // TODO(chengcheng): handle for consistent variable which has NO phy tensor in cur rank.
-      const std::shared_ptr<one::MirroredTensor> local_var = JUST(var->cur_rank_phy_tensor());
-      var_blob = JUST(local_var->eager_blob_object())->mut_blob();
+      local_var = JUST(var->cur_rank_phy_tensor());
     } else {
-      var_blob = JUST(var->eager_blob_object())->mut_blob();
+      local_var = JUST(var->AsMirroredTensor());
     }
+    Blob* var_blob = JUST(local_var->eager_blob_object())->mut_blob();
     const std::string& var_name = variable_op_names.at(i);
     CHECK_OR_RETURN(!var_name.empty());
     CHECK_OR_RETURN(variable_op_name2eager_blob_.emplace(var_name, var_blob).second);
     CHECK_OR_RETURN(variable_op_names_.insert(var_name).second);
+    variable_tensors_.push_back(local_var);
   }
   return Maybe<void>::Ok();
 }
@@ -83,6 +112,11 @@ Maybe<void> NNGraph::CompileAndInitRuntime() {
   // NOTE(chengcheng): Global<JobDesc> need be clear before GlobalJobDescScope construct.
   if (Global<JobDesc>::Get() != nullptr) { Global<JobDesc>::Delete(); }
 
+  // NOTE: variables are initialized or loaded by the vm concurrently with the compilation below,
+  // and are only waited for before the runtime binds their blobs.
+  const auto variables_ready_counter = std::make_shared<BlockingCounter>(variable_tensors_.size());
+  JUST(AsyncWaitVariablesReady(variable_tensors_, variables_ready_counter));
+
   auto scope = std::make_unique<GlobalJobDescScope>(job_.job_conf(), job_ctx->job_id());
   if (GlobalProcessCtx::IsThisProcessMaster()) {
     double start = GetCurTime();
@@ -101,19 +135,16 @@ Maybe<void> NNGraph::CompileAndInitRuntime() {
     PlanUtil::DumpCtrlRegstInfoToPlan(&plan_);
   }
   if (GlobalProcessCtx::WorldSize() > 1) {
-    Global<CtrlClient>::Get()->ClearKV("plan");
-    if (GlobalProcessCtx::IsThisProcessMaster()) {
-      // TODO(chengcheng): split plan for each rank.
-      Global<CtrlClient>::Get()->PushKV("plan", plan_);
-    } else {
-      Global<CtrlClient>::Get()->PullKV("plan", &plan_);
-    }
+    // TODO(chengcheng): split plan for each rank.
+    Global<CtrlClient>::Get()->BroadcastKV("plan", 0, &plan_);
     OF_SESSION_BARRIER();
   }
   // NOTE(chengcheng): recovery op_attr
-  PlanUtil::PopulateOpAttibute(&plan_, plan_.job_id2op_attribute_ref_table());
+  PlanUtil::PopulateOpAttibute(&plan_, plan_.mutable_job_id2op_attribute_ref_table());
+  plan_.clear_job_id2op_attribute_ref_table();
 
   NewRuntimeBuffers();
+  variables_ready_counter->WaitUntilCntEqualZero();
   runtime_.reset(new Runtime(plan_, variable_op_name2eager_blob_));
   runtime_inited_ = true;
   return Maybe<void>::Ok();
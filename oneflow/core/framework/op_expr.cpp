@@ -21,6 +21,7 @@ limitations under the License.
 #include "oneflow/core/framework/op_expr_grad_function.h"
 #include "oneflow/core/framework/user_op_registry_manager.h"
 #include "oneflow/core/framework/consistent_tensor_infer_cache.h"
+#include "oneflow/core/framework/local_tensor_infer_cache.h"
 #include "oneflow/core/operator/op_conf.pb.h"
 #include "oneflow/user/kernels/stateful_local_opkernel.h"
 
@@ -362,6 +363,7 @@ Maybe<void> UserOpExpr::Init(const std::shared_ptr<const UserOpExpr>& self) {
   CHECK_OR_RETURN(static_cast<bool>(dtype_infer_fn_));
   if (registry->device_infer_fn) { device_infer_fn_ = registry->device_infer_fn; }
   consistent_tensor_infer_cache_.reset(new ConsistentTensorInferCache(self));
+  local_tensor_infer_cache_.reset(new LocalTensorInferCache());
   return Maybe<void>::Ok();
 }
 
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef ONEFLOW_CORE_FRAMEWORK_OP_EXPR_H_
 #define ONEFLOW_CORE_FRAMEWORK_OP_EXPR_H_
 
+#include <mutex>
 #include "oneflow/core/common/util.h"
 #include "oneflow/core/common/symbol.h"
 #include "oneflow/core/operator/op_conf.pb.h"
@@ -117,6 +118,7 @@ class BuiltinOpExprImpl : public BuiltinOpExpr {
 
 class StatefulLocalOpKernel;
 class ConsistentTensorInferCache;
+class LocalTensorInferCache;
 
 class UserOpExpr final : public BuiltinOpExprImpl<UserOpConf> {
  public:
@@ -141,6 +143,11 @@ class UserOpExpr final : public BuiltinOpExprImpl<UserOpConf> {
   ConsistentTensorInferCache* mut_consistent_tensor_infer_cache() const {
     return consistent_tensor_infer_cache_.get();
   }
+  LocalTensorInferCache* mut_local_tensor_infer_cache() const {
+    return local_tensor_infer_cache_.get();
+  }
+  // Guards the kernels of devices when this op is interpreted by several threads
+  std::mutex* mut_interpret_mutex() const { return &interpret_mutex_; }
 
  private:
   UserOpExpr(const std::string& op_name, UserOpConf&& proto, const AttrMap& base_attrs,
@@ -153,6 +160,8 @@ class UserOpExpr final : public BuiltinOpExprImpl<UserOpConf> {
   user_op::DeviceInferFn device_infer_fn_;
   mutable HashMap<Device, std::shared_ptr<StatefulLocalOpKernel>> device2kernel_;
   std::shared_ptr<ConsistentTensorInferCache> consistent_tensor_infer_cache_;
+  std::shared_ptr<LocalTensorInferCache> local_tensor_infer_cache_;
+  mutable std::mutex interpret_mutex_;
 };
 
 class CastConsistentOpExpr : public OpExpr {
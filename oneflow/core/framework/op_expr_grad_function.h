@@ -103,11 +103,15 @@ class OpExprGradClosure {
 
   Maybe<void> Capture(const TensorTuple& inputs, const TensorTuple& outputs,
                       const OpExprInterpContext& interp_ctx) const {
-    return impl_->CaptureIf(state_.get(), inputs, outputs, interp_ctx);
+    JUST(impl_->CaptureIf(state_.get(), inputs, outputs, interp_ctx));
+    return state_->PackSavedTensors();
   }
 
   Maybe<void> Apply(const TensorTuple& out_grads, TensorTuple* in_grads) const {
-    return impl_->ApplyIf(state_.get(), out_grads, in_grads);
+    JUST(state_->UnpackSavedTensors());
+    const auto& ret = impl_->ApplyIf(state_.get(), out_grads, in_grads);
+    state_->ReleaseUnpackedSavedTensors();
+    return ret;
   }
 
  private:
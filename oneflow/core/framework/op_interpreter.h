@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef ONEFLOW_CORE_FRAMEWORK_OP_INTERPRETER_H_
 #define ONEFLOW_CORE_FRAMEWORK_OP_INTERPRETER_H_
 
+#include "oneflow/core/autograd/saved_tensor_hooks.h"
 #include "oneflow/core/framework/attr_map.h"
 #include "oneflow/core/framework/op_expr.h"
 #include "oneflow/core/framework/tensor.h"
@@ -46,8 +47,15 @@ class OpExprInterpState {
     return offset;
   }
 
+  // Packs the saved tensors with the current saved tensor pack hook if there is one.
+  Maybe<void> PackSavedTensors();
+  // Restores the packed tensors before backward, and drops them again after it.
+  Maybe<void> UnpackSavedTensors();
+  void ReleaseUnpackedSavedTensors();
+
  private:
   TensorTuple saved_tensors_;
+  std::vector<SavedTensorUnpacker> unpackers_;
 };
 
 struct OpExprInterpContext {
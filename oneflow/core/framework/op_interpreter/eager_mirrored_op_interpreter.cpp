@@ -17,6 +17,7 @@ limitations under the License.
 #include "oneflow/core/framework/device.h"
 #include "oneflow/core/framework/op_interpreter.h"
 #include "oneflow/core/framework/op_interpreter/op_interpreter_util.h"
+#include "oneflow/core/framework/local_tensor_infer_cache.h"
 #include "oneflow/core/framework/instructions_builder.h"
 #include "oneflow/core/framework/op_arg_util.h"
 #include "oneflow/core/framework/scope_util.h"
@@ -36,6 +37,8 @@ limitations under the License.
 #include "oneflow/core/framework/tensor_rpc_util.h"
 #include "oneflow/core/framework/op_builder.h"
 #include "oneflow/core/framework/id_util.h"
+#include "oneflow/user/kernels/slice_util.h"
+#include "oneflow/core/profiler/host_stage_timing.h"
 
 namespace oneflow {
 namespace one {
@@ -52,6 +55,73 @@ Maybe<EagerMirroredTensorImpl*> TensorImpl4Tensor(const std::shared_ptr<Tensor>&
   return tensor->mut_eager_mirrored_tensor_impl();
 }
 
+bool IsEagerTensorViewEnabled() {
+  // views alias the memory of their inputs, so inplace ops on either side are visible to both
+  static const bool is_enabled = ParseBooleanFromEnv("ONEFLOW_EAGER_ENABLE_TENSOR_VIEW", false);
+  return is_enabled;
+}
+
+// Returns true and the element offset of the slice into its input if the slice is contiguous, i.e.
+// the axes before the first non-trivial one are of extent 1 and all those after it are full.
+Maybe<bool> GetContiguousSliceOffset(const Shape& in_shape, const Shape& out_shape,
+                                     const ComposedAttrMap& attrs, int64_t* offset) {
+  const auto& start = JUST(attrs.GetAttr<std::vector<int64_t>>("start"));
+  const auto& step = JUST(attrs.GetAttr<std::vector<int64_t>>("step"));
+  const int64_t ndim = in_shape.NumAxes();
+  CHECK_EQ_OR_RETURN(start.size(), ndim);
+  CHECK_EQ_OR_RETURN(step.size(), ndim);
+  CHECK_EQ_OR_RETURN(out_shape.NumAxes(), ndim);
+  bool is_inner = false;
+  *offset = 0;
+  for (int64_t i = 0; i < ndim; ++i) {
+    if (is_inner && (out_shape.At(i) != in_shape.At(i) || step.at(i) != 1)) {
+      return false;
+    }
+    *offset += RegulateSliceStart(start.at(i), in_shape.At(i)) * in_shape.Count(i + 1);
+    if (!is_inner && out_shape.At(i) > 1) {
+      if (step.at(i) != 1) { return false; }
+      is_inner = true;
+    }
+  }
+  return true;
+}
+
+// Binds the output of a reshaping or contiguous slicing op to the memory of its input instead of
+// launching the kernel. Returns false if the op can not be run as a view.
+Maybe<bool> TryInterpretAsView(const UserOpExpr& user_op_expr, const TensorTuple& inputs,
+                               TensorTuple* outputs, const OpExprInterpContext& ctx) {
+  if (!IsEagerTensorViewEnabled()) { return false; }
+  static const HashSet<std::string> kReshapeOpTypeNames{"reshape", "reshape_like", "flatten",
+                                                        "squeeze", "expand_dims"};
+  const std::string& op_type_name = user_op_expr.op_type_name();
+  const bool is_slice = (op_type_name == "slice");
+  if (!is_slice && kReshapeOpTypeNames.count(op_type_name) == 0) { return false; }
+  if (user_op_expr.has_device_infer_fn() || inputs.empty() || outputs->size() != 1) {
+    return false;
+  }
+  auto* in_impl = JUST(TensorImpl4Tensor(inputs.at(0)));
+  auto* out_impl = JUST(TensorImpl4Tensor(outputs->at(0)));
+  if (JUST(out_impl->has_eager_blob_object())) { return false; }
+  const auto* in_meta = in_impl->tensor_meta().get();
+  const auto* out_meta = out_impl->mut_tensor_meta();
+  if (in_meta->is_dynamic() || out_meta->is_dynamic()) { return false; }
+  if (in_meta->dtype() != out_meta->dtype() || !IsPODDataType(out_meta->dtype())) {
+    return false;
+  }
+  if (out_meta->shape().elem_cnt() == 0) { return false; }
+  int64_t offset = 0;
+  if (is_slice) {
+    const ComposedAttrMap attrs(ctx.attrs, user_op_expr.base_attrs());
+    if (!JUST(GetContiguousSliceOffset(in_meta->shape(), out_meta->shape(), attrs, &offset))) {
+      return false;
+    }
+  } else {
+    CHECK_EQ_OR_RETURN(in_meta->shape().elem_cnt(), out_meta->shape().elem_cnt());
+  }
+  JUST(out_impl->InitEagerBlobObjectAsViewOf(in_impl, offset));
+  return true;
+}
+
 }  // namespace
 
 Maybe<void> NaiveInterpret(const UserOpExpr& user_op_expr, const TensorTuple& inputs,
@@ -67,12 +137,16 @@ Maybe<void> NaiveInterpret(const UserOpExpr& user_op_expr, const TensorTuple& in
     }
     input_eager_blob_objects->at(i) = JUST(inputs.at(i)->eager_blob_object());
   }
+  // Inplace outputs keep their own metas, so only the calls creating all outputs are cached.
+  bool is_infer_cacheable = LocalTensorInferCache::IsEnabled();
   std::shared_ptr<EagerBlobObjectList> output_eager_blob_objects =
       std::make_shared<EagerBlobObjectList>(outputs->size());
   for (int i = 0; i < outputs->size(); i++) {
     if (!outputs->at(i)) {
       outputs->at(i) =
           std::make_shared<MirroredTensor>(std::make_shared<EagerMirroredTensorImpl>());
+    } else {
+      is_infer_cacheable = false;
     }
     if (JUST(outputs->at(i)->has_eager_blob_object())) {
       output_eager_blob_objects->at(i) = JUST(outputs->at(i)->eager_blob_object());
@@ -83,34 +157,73 @@ Maybe<void> NaiveInterpret(const UserOpExpr& user_op_expr, const TensorTuple& in
   bool need_check_mem_case = true;
   bool need_event_record = false;
 
-  // Infer devices
-  if (!user_op_expr.has_device_infer_fn()) {
-    op_device = default_device;
-    op_parallel_desc = op_device->parallel_desc_ptr();
+  profiler::HostStageTimingGuard infer_guard(profiler::kHostStageInfer);
+  std::shared_ptr<const LocalTensorMetaInferArgs> infer_args;
+  std::shared_ptr<const LocalTensorInferResult> infer_result;
+  if (is_infer_cacheable) {
+    infer_args = JUST(LocalTensorMetaInferArgs::New(attrs, default_device, inputs));
+    infer_result = user_op_expr.mut_local_tensor_infer_cache()->Find(*infer_args);
+  }
+  if (infer_result) {
+    // Reuse the inferred devices, shapes and data types of an identical previous call
+    op_device = infer_result->op_device();
+    need_check_mem_case = infer_result->need_check_mem_case();
+    need_event_record = infer_result->need_event_record();
     for (int i = 0; i < outputs->size(); i++) {
       auto* tensor_impl = JUST(TensorImpl4Tensor(outputs->at(i)));
-      *JUST(tensor_impl->mut_device()) = default_device;
+      *JUST(tensor_impl->mut_device()) = infer_result->output_devices().at(i);
+      auto* tensor_meta = tensor_impl->mut_tensor_meta();
+      tensor_meta->set_shape(std::make_shared<const Shape>(*infer_result->output_shapes().at(i)));
+      tensor_meta->set_dtype(infer_result->output_data_types().at(i));
+      tensor_meta->set_is_dynamic(infer_result->output_is_dynamics().at(i));
     }
   } else {
-    need_check_mem_case = false;
-    op_device = JUST(user_op_expr.InferDevices(attrs, inputs, outputs));
-    for (const auto& input_tensor : inputs) {
-      const auto& input_device = JUST(input_tensor->device());
-      need_event_record = need_event_record || !(*op_device == *input_device);
+    // Infer devices
+    if (!user_op_expr.has_device_infer_fn()) {
+      op_device = default_device;
+      for (int i = 0; i < outputs->size(); i++) {
+        auto* tensor_impl = JUST(TensorImpl4Tensor(outputs->at(i)));
+        *JUST(tensor_impl->mut_device()) = default_device;
+      }
+    } else {
+      need_check_mem_case = false;
+      op_device = JUST(user_op_expr.InferDevices(attrs, inputs, outputs));
+      for (const auto& input_tensor : inputs) {
+        const auto& input_device = JUST(input_tensor->device());
+        need_event_record = need_event_record || !(*op_device == *input_device);
+      }
+    }
+
+    // Infer shapes and dtypes
+    const auto& device_tag = JUST(op_device->of_type());
+    JUST(user_op_expr.InferLogicalShapeAndDType(
+        attrs, device_tag,
+        [&](int32_t i) -> const TensorMeta* {
+          return CHECK_JUST(TensorImpl4Tensor(inputs.at(i)))->mut_tensor_meta();
+        },
+        [&](int32_t i) -> TensorMeta* {
+          return CHECK_JUST(TensorImpl4Tensor(outputs->at(i)))->mut_tensor_meta();
+        }));
+
+    if (is_infer_cacheable) {
+      auto result = std::make_shared<LocalTensorInferResult>(outputs->size());
+      result->set_op_device(op_device);
+      result->set_need_check_mem_case(need_check_mem_case);
+      result->set_need_event_record(need_event_record);
+      for (int i = 0; i < outputs->size(); i++) {
+        const auto* tensor_meta = JUST(TensorImpl4Tensor(outputs->at(i)))->mut_tensor_meta();
+        result->mut_output_devices()->at(i) = JUST(outputs->at(i)->device());
+        result->mut_output_shapes()->at(i) = std::make_shared<const Shape>(tensor_meta->shape());
+        result->mut_output_data_types()->at(i) = tensor_meta->dtype();
+        result->mut_output_is_dynamics()->at(i) = tensor_meta->is_dynamic();
+      }
+      user_op_expr.mut_local_tensor_infer_cache()->Insert(*infer_args, result);
     }
-    op_parallel_desc = op_device->parallel_desc_ptr();
   }
+  op_parallel_desc = op_device->parallel_desc_ptr();
+  infer_guard.Stop();
 
-  // Infer shapes and dtypes
-  const auto& device_tag = JUST(op_device->of_type());
-  JUST(user_op_expr.InferLogicalShapeAndDType(
-      attrs, device_tag,
-      [&](int32_t i) -> const TensorMeta* {
-        return CHECK_JUST(TensorImpl4Tensor(inputs.at(i)))->mut_tensor_meta();
-      },
-      [&](int32_t i) -> TensorMeta* {
-        return CHECK_JUST(TensorImpl4Tensor(outputs->at(i)))->mut_tensor_meta();
-      }));
+  if (JUST(TryInterpretAsView(user_op_expr, inputs, outputs, ctx))) { return Maybe<void>::Ok(); }
 
   for (int i = 0; i < output_eager_blob_objects->size(); i++) {
     if (!output_eager_blob_objects->at(i)) {
@@ -120,8 +233,12 @@ Maybe<void> NaiveInterpret(const UserOpExpr& user_op_expr, const TensorTuple& in
     }
   }
 
-  const auto& kernel = JUST(user_op_expr.MutKernel4Device(*op_device));
-  kernel->set_need_check_mem_case(need_check_mem_case);
+  std::shared_ptr<StatefulLocalOpKernel> kernel;
+  {
+    std::unique_lock<std::mutex> lock(*user_op_expr.mut_interpret_mutex());
+    kernel = JUST(user_op_expr.MutKernel4Device(*op_device));
+    kernel->set_need_check_mem_case(need_check_mem_case);
+  }
 
   for (int64_t index : kernel->output_tuple_indexes4mut2_obns()) {
     output_eager_blob_objects->at(index)->set_is_shape_synced(false);
@@ -262,15 +379,23 @@ Maybe<void> EagerMirroredInterpreter::ApplyImpl(const CastToConsistentOpExpr& op
     const auto& rpc_token = JUST(RpcToken::NewMetaRpcToken());
     JUST(consistent_tensor_impl->set_rpc_token(rpc_token));
     consistent_tensor = std::make_shared<ConsistentTensor>(consistent_tensor_impl);
-    const auto& ctx = JUST(LaunchTensorMetaConsistencyCheck(*consistent_tensor));
+    // callers whose local tensors already agree across broadcast ranks pass sync_data=false
+    bool sync_data = true;
+    if (ctx.attrs.find("sync_data") != ctx.attrs.end()) {
+      sync_data = JUST(ctx.attrs.GetAttr<bool>("sync_data"));
+    }
+    const auto& check_ctx = JUST(LaunchTensorMetaConsistencyCheck(*consistent_tensor));
     if (parallel_id.has_value()) {
-      const auto& synced_tensor = JUST(
-          GetSyncedTensorIfBroadcast(input_mirrored_tensor, parallel_desc, parallel_distribution));
+      std::shared_ptr<Tensor> synced_tensor = input_mirrored_tensor;
+      if (sync_data) {
+        synced_tensor = JUST(GetSyncedTensorIfBroadcast(input_mirrored_tensor, parallel_desc,
+                                                        parallel_distribution));
+      }
       consistent_tensor_impl->reset_cur_rank_phy_tensor(
           std::dynamic_pointer_cast<MirroredTensor>(synced_tensor));
     }
-    JUST(RpcUtil::WaitUntilDoneOrTimeout(*ctx, RpcUtil::TimeoutSeconds()));
-    JUST(ctx->Check());
+    JUST(RpcUtil::WaitUntilDoneOrTimeout(*check_ctx, RpcUtil::TimeoutSeconds()));
+    JUST(check_ctx->Check());
   }
   outputs->at(0) = consistent_tensor;
   return Maybe<void>::Ok();
@@ -27,6 +27,33 @@ limitations under the License.
 namespace oneflow {
 namespace one {
 
+Maybe<void> OpExprInterpState::PackSavedTensors() {
+  const SavedTensorPackHook* pack_hook = CurrentSavedTensorPackHook();
+  if (pack_hook == nullptr) { return Maybe<void>::Ok(); }
+  autograd::AutoGradMode mode(false);
+  unpackers_.resize(saved_tensors_.size());
+  for (int i = 0; i < saved_tensors_.size(); ++i) {
+    if (!saved_tensors_.at(i) || unpackers_.at(i)) { continue; }
+    unpackers_.at(i) = JUST((*pack_hook)(saved_tensors_.at(i)));
+    saved_tensors_.at(i).reset();
+  }
+  return Maybe<void>::Ok();
+}
+
+Maybe<void> OpExprInterpState::UnpackSavedTensors() {
+  autograd::AutoGradMode mode(false);
+  for (int i = 0; i < unpackers_.size(); ++i) {
+    if (unpackers_.at(i)) { saved_tensors_.at(i) = JUST(unpackers_.at(i)()); }
+  }
+  return Maybe<void>::Ok();
+}
+
+void OpExprInterpState::ReleaseUnpackedSavedTensors() {
+  for (int i = 0; i < unpackers_.size(); ++i) {
+    if (unpackers_.at(i)) { saved_tensors_.at(i).reset(); }
+  }
+}
+
 Maybe<void> LazyInterpreter::Apply(const OpExpr& op_expr, const TensorTuple& inputs,
                                    TensorTuple* outputs, const OpExprInterpContext& ctx) const {
 #define APPLY_IF(op_type)                                              \
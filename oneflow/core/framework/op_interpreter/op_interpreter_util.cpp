@@ -24,6 +24,7 @@ limitations under the License.
 #include "oneflow/core/job/lazy_mode.h"
 #include "oneflow/core/job/job_build_and_infer_ctx_mgr.h"
 #include "oneflow/core/operator/operator.h"
+#include "oneflow/core/profiler/host_stage_timing.h"
 
 namespace oneflow {
 namespace one {
@@ -112,6 +113,7 @@ template<>
 /* static */ Maybe<void> OpInterpUtil::Dispatch(const OpExpr& op_expr, const TensorTuple& inputs,
                                                 TensorTuple* outputs,
                                                 const OpExprInterpContext& ctx) {
+  OF_HOST_STAGE_TIMING_GUARD(kHostStageDispatch);
   return JUST(GetInterpreter(inputs, ctx))->Apply(op_expr, inputs, outputs, ctx);
 }
 
@@ -21,26 +21,35 @@ namespace oneflow {
 
 namespace user_op {
 
-OpKernelInferCache::OpKernelInferCache(const KernelConf& kernel_conf, const JobDesc& job_desc) {
+namespace {
+
+size_t OpKernelInferCacheMaxSize() {
+  static const size_t max_size = ParseIntegerFromEnv("ONEFLOW_KERNEL_INFER_CACHE_MAX_SIZE", 4096);
+  return max_size;
+}
+
+}  // namespace
+
+OpKernelInferCache::OpKernelInferCache(const KernelConf& kernel_conf, const JobDesc& job_desc)
+    : cache_key_hash_value_(0), cache_(OpKernelInferCacheMaxSize()) {
   const OperatorConf& op_conf = kernel_conf.op_attribute().op_conf();
   std::shared_ptr<Operator> op = CHECK_JUST(ConstructOp(op_conf));
+  op_name_ = op_conf.name();
   cache_key_.job_desc = &job_desc;
   cache_key_.op_conf_sym = op->GetOpConfWithoutOpNameAndLbn();
   cache_key_.ibn_idx2shape_sym.resize(op->input_bns().size());
   cache_key_.dtype_signature_sym = SymbolOf(kernel_conf.dtype_signature());
 }
 
-bool OpKernelInferCache::IsCacheHit() const {
-  size_t hash_value = std::hash<KeyType>()(cache_key_);
-  HashEqTraitPtr<const KeyType> ptr_wrapper(&cache_key_, hash_value);
-  return cached_key2value_.find(ptr_wrapper) != cached_key2value_.end();
+OpKernelInferCache::~OpKernelInferCache() {
+  VLOG(1) << "OpKernelInferCache of op " << op_name_ << ": hit " << hit_count() << ", miss "
+          << miss_count() << ", eviction " << eviction_count() << ", size " << cache_.size();
 }
 
-OpKernelInferCache::ValueType OpKernelInferCache::GetCacheValue() const {
-  size_t hash_value = std::hash<KeyType>()(cache_key_);
-  HashEqTraitPtr<const KeyType> ptr_wrapper(&cache_key_, hash_value);
-  CHECK(cached_key2value_.find(ptr_wrapper) != cached_key2value_.end());
-  return cached_key2value_.at(ptr_wrapper);
+OpKernelInferCache::ValueType OpKernelInferCache::GetCacheValue() {
+  const ValueType* value = cache_.Find(cache_key_, cache_key_hash_value_);
+  if (value == nullptr) { return ValueType(); }
+  return *value;
 }
 
 void OpKernelInferCache::UpdateCacheKey(KernelInferContext* ctx) {
@@ -54,10 +63,10 @@ void OpKernelInferCache::UpdateCacheKey(KernelInferContext* ctx) {
     const auto& arg_pair = inputs.at(i);
     cache_key_.ibn_idx2shape_sym.at(i) = GetSymbolOfShape(arg_pair.first, arg_pair.second);
   }
+  cache_key_hash_value_ = std::hash<KeyType>()(cache_key_);
 }
 
 void OpKernelInferCache::UpdateCacheValue(KernelInferContext* ctx) {
-  if (cached_key2value_.size() >= max_size_) { Reset(); }
   auto* cache_value = new OpInferCacheValue();
   cache_value->obn_idx2shape_sym.resize(ctx->outputs().size());
   FOR_RANGE(int, i, 0, ctx->outputs().size()) {
@@ -68,30 +77,7 @@ void OpKernelInferCache::UpdateCacheValue(KernelInferContext* ctx) {
     out_shape_view.ToShape(&out_shape);
     cache_value->obn_idx2shape_sym.at(i).reset(out_shape);
   }
-  KeyType* new_key = new KeyType(cache_key_);
-  key_storage_.emplace_back(new_key);
-  size_t hash_value = std::hash<KeyType>()(cache_key_);
-  HashEqTraitPtr<const KeyType> ptr_wrapper(new_key, hash_value);
-  CHECK(cached_key2value_.emplace(ptr_wrapper, ValueType(cache_value)).second);
-}
-
-void OpKernelInferCache::Reset() {
-  CHECK_EQ(cached_key2value_.size(), key_storage_.size());
-  HashMap to_release_key2values;
-  KeyStorage to_release_key_storage;
-  std::swap(cached_key2value_, to_release_key2values);
-  std::swap(key_storage_, to_release_key_storage);
-  if (to_release_key2values.size() <= kReleaseInIndependentThreadThreshold) {
-    to_release_key2values.clear();
-    to_release_key_storage.clear();
-  } else {
-    std::thread(
-        [](HashMap&& cache, KeyStorage&& key_storage) {
-          cache.clear();
-          key_storage.clear();
-        },
-        std::move(to_release_key2values), std::move(to_release_key_storage));
-  }
+  cache_.Insert(cache_key_, cache_key_hash_value_, ValueType(cache_value));
 }
 
 }  // namespace user_op
@@ -17,7 +17,7 @@ limitations under the License.
 #define ONEFLOW_CORE_FRAMEWORK_OP_KERNEL_INFER_CACHE_H_
 
 #include "oneflow/core/operator/op_infer_cache.h"
-#include "oneflow/core/common/hash_eq_trait_ptr.h"
+#include "oneflow/core/common/lru_cache.h"
 #include "oneflow/core/kernel/kernel.pb.h"
 
 namespace oneflow {
@@ -30,24 +30,24 @@ class OpKernelInferCache final {
  public:
   using KeyType = OpInferCacheKey;
   using ValueType = std::shared_ptr<const OpInferCacheValue>;
-  using HashMap = std::unordered_map<HashEqTraitPtr<const KeyType>, ValueType>;
-  using KeyStorage = std::list<std::unique_ptr<KeyType>>;
-  static constexpr size_t kReleaseInIndependentThreadThreshold = 4096;
 
   OpKernelInferCache(const KernelConf& kernel_conf, const JobDesc& job_desc);
-  ~OpKernelInferCache() = default;
+  ~OpKernelInferCache();
 
-  bool IsCacheHit() const;
-  ValueType GetCacheValue() const;
+  // returns nullptr if the current cache key misses
+  ValueType GetCacheValue();
   void UpdateCacheKey(KernelInferContext* ctx);
   void UpdateCacheValue(KernelInferContext* ctx);
-  void Reset();
+
+  int64_t hit_count() const { return cache_.hit_count(); }
+  int64_t miss_count() const { return cache_.miss_count(); }
+  int64_t eviction_count() const { return cache_.eviction_count(); }
 
  private:
+  std::string op_name_;
   KeyType cache_key_;
-  HashMap cached_key2value_;
-  KeyStorage key_storage_;
-  size_t max_size_;
+  size_t cache_key_hash_value_;
+  LruCache<KeyType, ValueType> cache_;
 };
 
 }  // namespace user_op
@@ -15,6 +15,7 @@ limitations under the License.
 */
 
 #include "oneflow/core/framework/random_generator_impl.h"
+#include "oneflow/core/common/util.h"
 
 #ifdef WITH_CUDA
 #include "oneflow/core/device/cuda_util.h"
@@ -49,21 +50,27 @@ int GetThreadNum(const cudaDeviceProp& prop) {
 }  // namespace
 
 CUDAGeneratorImpl::CUDAGeneratorImpl(uint64_t seed, int device_index)
-    : DeviceGeneratorImpl(seed, detail::DeviceKey{DeviceType::kGPU, device_index}) {
+    : DeviceGeneratorImpl(seed, detail::DeviceKey{DeviceType::kGPU, device_index}),
+      philox_offset_(0) {
   cudaDeviceProp prop;
   OF_CUDA_CHECK(cudaGetDeviceProperties(&prop, 0));
   max_block_num_ = prop.multiProcessorCount;
   max_thread_num_ = GetThreadNum(prop);
-  OF_CUDA_CHECK(
-      cudaMalloc(&curand_states_, max_block_num_ * max_thread_num_ * sizeof(curandState)));
-  detail::InitCurandStates(seed, max_block_num_, max_thread_num_, curand_states_);
 }
 
-CUDAGeneratorImpl::~CUDAGeneratorImpl() { OF_CUDA_CHECK(cudaFree(curand_states_)); }
+PhiloxCudaState CUDAGeneratorImpl::NextPhiloxState(uint64_t increment) {
+  // curand_uniform4 consumes four values at a time
+  increment = RoundUp(increment, 4);
+  std::lock_guard<std::mutex> lock(mutex_);
+  PhiloxCudaState state{seed_, philox_offset_};
+  philox_offset_ += increment;
+  return state;
+}
 
 void CUDAGeneratorImpl::set_current_seed(uint64_t seed) {
+  std::lock_guard<std::mutex> lock(mutex_);
   seed_ = seed;
-  detail::InitCurandStates(seed_, max_block_num_, max_thread_num_, curand_states_);
+  philox_offset_ = 0;
 }
 #endif  // WITH_CUDA
 
@@ -100,30 +100,40 @@ class CPUGeneratorImpl : public DeviceGeneratorImpl {
 };
 
 #ifdef WITH_CUDA
+// Seed and starting offset of a counter-based Philox4x32-10 stream. A kernel thread initializes
+// curandStatePhilox4_32_10_t with (seed, global thread id as subsequence, offset) and may draw at
+// most the number of 32-bit values it reserved through CUDAGeneratorImpl::NextPhiloxState.
+struct PhiloxCudaState {
+  uint64_t seed;
+  uint64_t offset;
+};
+
 class CUDAGeneratorImpl : public DeviceGeneratorImpl {
  public:
   explicit CUDAGeneratorImpl(uint64_t seed, int device_index);
-  virtual ~CUDAGeneratorImpl();
+  virtual ~CUDAGeneratorImpl() = default;
 
   int32_t max_block_num() const { return max_block_num_; }
   int32_t max_thread_num() const { return max_thread_num_; }
 
-  curandState* curand_states() const { return curand_states_; }
+  // Reserves `increment' 32-bit values for every thread of the next kernel. The offset only
+  // advances on the host, so no device state is read or written and a replayed launch sequence
+  // draws the same numbers.
+  PhiloxCudaState NextPhiloxState(uint64_t increment);
 
   void set_current_seed(uint64_t seed) override;
 
  private:
   int32_t max_block_num_;
   int32_t max_thread_num_;
-  curandState* curand_states_;
+  std::mutex mutex_;
+  uint64_t philox_offset_;
 };
 
 namespace detail {
 
 int GetCudaDeviceCount();
 
-void InitCurandStates(uint64_t seed, int32_t block_num, int32_t thread_num, curandState* states);
-
 }  // namespace detail
 #endif  // WITH_CUDA
 
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include <mutex>
 #include <functional>
+#include <unordered_map>
 #include "oneflow/core/common/maybe.h"
 #include "oneflow/core/job/job_conf.cfg.h"
 #include "oneflow/core/job/placement.cfg.h"
@@ -70,7 +71,8 @@ class IdCache final {
 
  private:
   mutable std::mutex mutex_;
-  std::map<T, int64_t> symbol_data2id_;
+  // hashed once per lookup, an ordered map compared the whole message at every level
+  std::unordered_map<T, int64_t> symbol_data2id_;
 };
 
 }  // namespace symbol
@@ -14,6 +14,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #include "oneflow/core/framework/synced_symbol_map.h"
+#include "oneflow/core/common/util.h"
 
 namespace oneflow {
 
@@ -22,4 +23,15 @@ uint64_t GetAutoIncrementalSymbolId() {
   return id++;
 }
 
+bool IsTrustedSpmdMode() {
+  static const bool is_trusted = ParseBooleanFromEnv("ONEFLOW_EAGER_TRUSTED_SPMD", false);
+  return is_trusted;
+}
+
+bool IsTrustedSpmdCheckSampled(uint64_t seq) {
+  static const int64_t interval =
+      ParseIntegerFromEnv("ONEFLOW_EAGER_TRUSTED_SPMD_CHECK_INTERVAL", 0);
+  return interval > 0 && seq % interval == 0;
+}
+
 }  // namespace oneflow
@@ -27,6 +27,14 @@ namespace oneflow {
 
 uint64_t GetAutoIncrementalSymbolId();
 
+// In trusted SPMD mode every rank is assumed to issue the same sequence of consistent ops, so the
+// symbol ids assigned by the thread local counter already agree and no rpc is needed to sync them.
+bool IsTrustedSpmdMode();
+
+// Whether the seq-th check is still run in trusted SPMD mode, which is controlled by
+// ONEFLOW_EAGER_TRUSTED_SPMD_CHECK_INTERVAL (0 disables all checks).
+bool IsTrustedSpmdCheckSampled(uint64_t seq);
+
 template<typename T>
 struct SyncedSymbolMap final {
   template<typename SyncT>
@@ -35,7 +43,9 @@ struct SyncedSymbolMap final {
     const auto& iter = map->find(symbol);
     if (iter != map->end()) { return iter->second; }
     uint64_t symbol_id = GetAutoIncrementalSymbolId();
-    JUST(Sync(symbol_id, symbol));
+    if (!IsTrustedSpmdMode() || IsTrustedSpmdCheckSampled(symbol_id)) {
+      JUST(Sync(symbol_id, symbol));
+    }
     JUST(Emplace(symbol_id, symbol));
     return symbol_id;
   }
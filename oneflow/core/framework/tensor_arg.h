@@ -18,6 +18,7 @@ limitations under the License.
 #define ONEFLOW_CORE_FRAMEWORK_TENSOR_ARG_H_
 
 #include <memory>
+#include <mutex>
 #include <vector>
 #include "oneflow/core/common/util.h"
 
@@ -42,6 +43,8 @@ class TensorArg final {
 
  private:
   std::shared_ptr<Tensor> acc_tensor_;
+  // partial tensors may be pushed by the backward workers of different devices
+  std::mutex mutex_;
 };
 
 }  // namespace one
@@ -0,0 +1,115 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <cstring>
+#include "oneflow/core/framework/tensor_fetch_future.h"
+#include "oneflow/core/framework/instructions_builder.h"
+#include "oneflow/core/framework/tensor.h"
+#include "oneflow/core/register/ofblob.h"
+#include "oneflow/core/register/blob.h"
+#ifdef WITH_CUDA
+#include "oneflow/core/vm/cuda_host_allocator.h"
+#endif  // WITH_CUDA
+
+namespace oneflow {
+namespace one {
+
+TensorFetchFuture::TensorFetchFuture()
+    : launched_(false),
+      data_type_(DataType::kInvalidDataType),
+      buffer_(nullptr),
+      byte_size_(0),
+      is_pinned_(false) {}
+
+TensorFetchFuture::~TensorFetchFuture() {
+  if (!launched_) { return; }
+  if (is_pinned_) {
+#ifdef WITH_CUDA
+    OF_CUDA_CHECK(cudaEventSynchronize(event_));
+    OF_CUDA_CHECK(cudaEventDestroy(event_));
+    vm::CudaHostAllocator().Deallocate(buffer_, byte_size_);
+#else
+    UNIMPLEMENTED();
+#endif  // WITH_CUDA
+  } else {
+    delete[] buffer_;
+  }
+}
+
+bool TensorFetchFuture::Poll() const {
+  if (!launched_.load(std::memory_order_acquire)) { return false; }
+  if (!is_pinned_) { return true; }
+#ifdef WITH_CUDA
+  cudaError_t err = cudaEventQuery(event_);
+  if (err == cudaErrorNotReady) { return false; }
+  OF_CUDA_CHECK(err);
+  return true;
+#else
+  UNIMPLEMENTED();
+  return false;
+#endif  // WITH_CUDA
+}
+
+void TensorFetchFuture::Wait() const {
+  while (!launched_.load(std::memory_order_acquire)) {}
+  if (!is_pinned_) { return; }
+#ifdef WITH_CUDA
+  OF_CUDA_CHECK(cudaEventSynchronize(event_));
+#else
+  UNIMPLEMENTED();
+#endif  // WITH_CUDA
+}
+
+void TensorFetchFuture::Launch(OfBlob* of_blob) {
+  CHECK(!launched_);
+  const Blob& blob = of_blob->blob();
+  blob.shape().ToShape(&shape_);
+  data_type_ = blob.data_type();
+  byte_size_ = blob.shape().elem_cnt() * GetSizeOfDataType(data_type_);
+  if (blob.mem_case().has_host_mem()) {
+    buffer_ = new char[byte_size_];
+    if (byte_size_ > 0) { std::memcpy(buffer_, blob.dptr(), byte_size_); }
+  } else {
+#ifdef WITH_CUDA
+    is_pinned_ = true;
+    vm::CudaHostAllocator().Allocate(&buffer_, byte_size_);
+    const cudaStream_t& cuda_stream = of_blob->mut_device_ctx()->cuda_stream();
+    if (byte_size_ > 0) {
+      OF_CUDA_CHECK(cudaMemcpyAsync(buffer_, blob.dptr(), byte_size_, cudaMemcpyDeviceToHost,
+                                    cuda_stream));
+    }
+    OF_CUDA_CHECK(cudaEventCreateWithFlags(&event_, cudaEventDisableTiming));
+    OF_CUDA_CHECK(cudaEventRecord(event_, cuda_stream));
+#else
+    UNIMPLEMENTED();
+#endif  // WITH_CUDA
+  }
+  launched_.store(true, std::memory_order_release);
+}
+
+Maybe<TensorFetchFuture> AsyncFetchMirroredTensor(const std::shared_ptr<MirroredTensor>& tensor) {
+  CHECK_OR_RETURN(tensor->is_eager()) << "eager tensors supported only";
+  const auto& future = std::make_shared<TensorFetchFuture>();
+  JUST(PhysicalRun([&](InstructionsBuilder* builder) -> Maybe<void> {
+    JUST(builder->FetchBlobByCallback(tensor, [future](uint64_t of_blob_ptr) {
+      future->Launch(reinterpret_cast<OfBlob*>(of_blob_ptr));
+    }));
+    return Maybe<void>::Ok();
+  }));
+  return future;
+}
+
+}  // namespace one
+}  // namespace oneflow
@@ -0,0 +1,72 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_FRAMEWORK_TENSOR_FETCH_FUTURE_H_
+#define ONEFLOW_CORE_FRAMEWORK_TENSOR_FETCH_FUTURE_H_
+
+#include <atomic>
+#include "oneflow/core/common/maybe.h"
+#include "oneflow/core/common/shape.h"
+#include "oneflow/core/common/data_type.pb.h"
+#include "oneflow/core/device/cuda_util.h"
+
+namespace oneflow {
+
+class OfBlob;
+
+namespace one {
+
+class MirroredTensor;
+
+// Host copy of an eager tensor that becomes available asynchronously. Cuda tensors are copied
+// into pooled pinned memory on the copy_d2h stream, cpu tensors into pageable memory.
+class TensorFetchFuture final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(TensorFetchFuture);
+  TensorFetchFuture();
+  ~TensorFetchFuture();
+
+  // Returns true if the host copy is complete. Never blocks.
+  bool Poll() const;
+  // Blocks the calling thread until the host copy is complete.
+  void Wait() const;
+
+  // Valid only after Poll() returned true or Wait() returned.
+  const Shape& shape() const { return shape_; }
+  DataType data_type() const { return data_type_; }
+  const char* data() const { return buffer_; }
+  size_t byte_size() const { return byte_size_; }
+
+  // Starts the host copy. Runs on the worker thread of the stream that fetches the blob.
+  void Launch(OfBlob* of_blob);
+
+ private:
+  std::atomic<bool> launched_;
+  Shape shape_;
+  DataType data_type_;
+  char* buffer_;
+  size_t byte_size_;
+  bool is_pinned_;
+#ifdef WITH_CUDA
+  cudaEvent_t event_;
+#endif  // WITH_CUDA
+};
+
+Maybe<TensorFetchFuture> AsyncFetchMirroredTensor(const std::shared_ptr<MirroredTensor>& tensor);
+
+}  // namespace one
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_FRAMEWORK_TENSOR_FETCH_FUTURE_H_
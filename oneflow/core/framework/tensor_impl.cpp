@@ -85,6 +85,7 @@ Maybe<void> EagerMirroredTensorImpl::UpdateTensorStorage() {
   const auto& parallel_desc = this->device()->parallel_desc_ptr();
   tensor_storage_->set_releaser_hook(
       [eager_blob_object, parallel_desc](const std::shared_ptr<vm::TensorBuffer>&) {
+        eager_blob_object->set_is_released(true);
         CHECK_JUST(PhysicalRun([&](InstructionsBuilder* builder) -> Maybe<void> {
           JUST(builder->ReleaseTensor(eager_blob_object, parallel_desc));
           return Maybe<void>::Ok();
@@ -118,6 +119,21 @@ Maybe<void> EagerMirroredTensorImpl::InitEagerBlobObjectAndTensorStorage(
   return Maybe<void>::Ok();
 }
 
+Maybe<void> EagerMirroredTensorImpl::InitEagerBlobObjectAsViewOf(EagerMirroredTensorImpl* base,
+                                                                  int64_t offset) {
+  const auto& base_blob_object = JUST(base->eager_blob_object());
+  CHECK_OR_RETURN(dtype() == base->dtype());
+  const auto& mut_shape = std::const_pointer_cast<Shape>(tensor_meta()->shape_ptr());
+  const int64_t offset_bytes = offset * GetSizeOfDataType(dtype());
+  eager_blob_object_ =
+      std::make_shared<vm::EagerBlobObject>(mut_shape, base_blob_object.get(), offset_bytes);
+  // share the storage so that the memory is released after the base and all its views
+  tensor_storage_ = JUST(base->tensor_storage());
+  mut_tensor_meta()->set_stride(std::make_shared<const Stride>(*mut_shape));
+  mut_tensor_meta()->set_storage_offset(base->tensor_meta()->storage_offset() + offset);
+  return Maybe<void>::Ok();
+}
+
 Maybe<void> EagerMirroredTensorImpl::set_eager_blob_object(
     std::shared_ptr<vm::EagerBlobObject> eager_blob_object) {
   eager_blob_object_ = eager_blob_object;
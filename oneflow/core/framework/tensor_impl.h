@@ -235,6 +235,8 @@ class EagerMirroredTensorImpl final : public MirroredTensorImpl {
   Maybe<void> InitEagerBlobObjectAndTensorStorage(
       const std::shared_ptr<vm::EagerBlobObject>& eager_blob_object,
       const std::shared_ptr<TensorStorage>& tensor_storage);
+  // Makes this tensor a contiguous view over the storage of `base', `offset' elements into it.
+  Maybe<void> InitEagerBlobObjectAsViewOf(EagerMirroredTensorImpl* base, int64_t offset);
   Maybe<EagerMirroredTensorImpl*> mut_eager_mirrored_tensor_impl() override { return this; }
 
  private:
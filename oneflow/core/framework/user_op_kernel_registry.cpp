@@ -39,6 +39,11 @@ OpKernelRegistry& OpKernelRegistry::SetInferTmpSizeFn(InferTmpSizeFn fn) {
   return *this;
 }
 
+OpKernelRegistry& OpKernelRegistry::SetInferFlopsFn(InferFlopsFn fn) {
+  result_.infer_flops_fn = std::move(fn);
+  return *this;
+}
+
 OpKernelRegistry& OpKernelRegistry::SetInplaceProposalFn(InplaceProposalFn fn) {
   result_.inplace_proposal_fn = std::move(fn);
   return *this;
@@ -50,6 +55,7 @@ Maybe<OpKernelRegistry&> OpKernelRegistry::Finish() {
   if (result_.infer_tmp_size_fn == nullptr) {
     result_.infer_tmp_size_fn = TmpSizeInferFnUtil::ZeroTmpSize;
   }
+  if (result_.infer_flops_fn == nullptr) { result_.infer_flops_fn = FlopsInferFnUtil::Unknown; }
   if (result_.inplace_proposal_fn == nullptr) {
     result_.inplace_proposal_fn = [](const InferContext&, AddInplaceArgPair) {
       return Maybe<void>::Ok();
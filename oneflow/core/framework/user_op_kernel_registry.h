@@ -60,6 +60,8 @@ class KernelRegContext {
 
 using OpKernelCreateFn = std::function<const OpKernel*(KernelCreateContext* ctx)>;
 using InferTmpSizeFn = std::function<size_t(InferContext*)>;
+// Floating point operations of a kernel computing the tensors of the context, 0 if unknown
+using InferFlopsFn = std::function<int64_t(InferContext*)>;
 using AddInplaceArgPair = std::function<Maybe<void>(
     const std::string& out_arg_name, int32_t out_arg_index, const std::string& in_arg_name,
     int32_t in_arg_index, bool is_mutable)>;
@@ -71,6 +73,7 @@ struct OpKernelRegistryResult {
 
   OpKernelCreateFn create_fn;
   InferTmpSizeFn infer_tmp_size_fn;
+  InferFlopsFn infer_flops_fn;
   InplaceProposalFn inplace_proposal_fn;
   IsMatchedHob is_matched_hob;
 };
@@ -91,6 +94,7 @@ class OpKernelRegistry final {
   }
   OpKernelRegistry& SetIsMatchedHob(IsMatchedHob hob);
   OpKernelRegistry& SetInferTmpSizeFn(InferTmpSizeFn fn);
+  OpKernelRegistry& SetInferFlopsFn(InferFlopsFn fn);
   OpKernelRegistry& SetInplaceProposalFn(InplaceProposalFn fn);
 
   Maybe<OpKernelRegistry&> Finish();
@@ -35,6 +35,7 @@ limitations under the License.
 #include "oneflow/core/common/flat_shape.h"
 #include "oneflow/core/common/container_util.h"
 #include "oneflow/core/common/balanced_splitter.h"
+#include "oneflow/core/common/shape.h"
 
 namespace oneflow {
 namespace one {
@@ -120,6 +121,122 @@ Maybe<Shape> GetConsistentShape(const Shape& physical_shape, Symbol<ParallelDesc
   }
 }
 
+// An eager boxing plan converts the local tensor of a consistent tensor with sbp `in_sbp` into
+// the local tensor of the same logical tensor with sbp `out_sbp`. Plans are cached by placement,
+// sbps, logical shape and data type, so a transition repeated in a training loop only pays for
+// launching its collectives.
+struct EagerBoxingPlanKey final {
+  Symbol<ParallelDesc> placement;
+  Symbol<cfg::ParallelDistribution> in_sbp;
+  Symbol<cfg::ParallelDistribution> out_sbp;
+  Shape shape;
+  DataType data_type;
+
+  bool operator==(const EagerBoxingPlanKey& other) const {
+    return placement == other.placement && in_sbp == other.in_sbp && out_sbp == other.out_sbp
+           && shape == other.shape && data_type == other.data_type;
+  }
+};
+
+struct EagerBoxingPlanKeyHash final {
+  size_t operator()(const EagerBoxingPlanKey& key) const {
+    size_t hash = std::hash<Symbol<ParallelDesc>>()(key.placement);
+    HashCombine(&hash, std::hash<Symbol<cfg::ParallelDistribution>>()(key.in_sbp));
+    HashCombine(&hash, std::hash<Symbol<cfg::ParallelDistribution>>()(key.out_sbp));
+    HashCombine(&hash, std::hash<Shape>()(key.shape));
+    HashCombine(&hash, std::hash<DataType>()(key.data_type));
+    return hash;
+  }
+};
+
+class EagerBoxingPlan final {
+ public:
+  using Step = std::function<Maybe<Tensor>(const std::shared_ptr<Tensor>&)>;
+
+  EagerBoxingPlan() = default;
+  ~EagerBoxingPlan() = default;
+
+  void AddStep(const Step& step) { steps_.push_back(step); }
+
+  Maybe<Tensor> operator()(const std::shared_ptr<Tensor>& local_tensor) const {
+    std::shared_ptr<Tensor> tensor = local_tensor;
+    for (const auto& step : steps_) { tensor = JUST(step(tensor)); }
+    return tensor;
+  }
+
+ private:
+  std::vector<Step> steps_;
+};
+
+Maybe<EagerBoxingPlan::Step> MakeAllReduceStep(Symbol<ParallelDesc> placement) {
+  CHECK_EQ_OR_RETURN(placement->device_tag(), "gpu")
+      << Error::Todo() << "eager boxing from partial_sum supports cuda only now.";
+  std::shared_ptr<OpExpr> op_expr = JUST(
+      one::OpBuilder("eager_nccl_all_reduce", *JUST(UniqueStr("eager_nccl_all_reduce")))
+          .Input("in")
+          .Output("out")
+          .Attr<std::string>("parallel_conf", PbMessage2TxtString(placement->parallel_conf()))
+          .Build());
+  return EagerBoxingPlan::Step([op_expr, placement](const std::shared_ptr<Tensor>& x)
+                                   -> Maybe<Tensor> {
+    return OpInterpUtil::Dispatch<Tensor>(*op_expr, {x}, OpExprInterpContext(AttrMap{}, placement));
+  });
+}
+
+Maybe<EagerBoxingPlan::Step> MakeSplitStep(const Shape& logical_shape, int64_t axis,
+                                           int64_t parallel_num, int64_t parallel_id) {
+  CHECK_GE_OR_RETURN(axis, 0);
+  CHECK_LT_OR_RETURN(axis, logical_shape.NumAxes());
+  const auto& range = BalancedSplitter(logical_shape.At(axis), parallel_num).At(parallel_id);
+  std::vector<int64_t> start(logical_shape.NumAxes(), 0);
+  std::vector<int64_t> stop(logical_shape.dim_vec().begin(), logical_shape.dim_vec().end());
+  std::vector<int64_t> step(logical_shape.NumAxes(), 1);
+  start.at(axis) = range.begin();
+  stop.at(axis) = range.end();
+  return EagerBoxingPlan::Step([start, stop, step](const std::shared_ptr<Tensor>& x) {
+    return functional::Slice(x, start, stop, step);
+  });
+}
+
+Maybe<EagerBoxingPlan> MakeEagerBoxingPlan(const EagerBoxingPlanKey& key) {
+  const auto& plan = std::make_shared<EagerBoxingPlan>();
+  if (key.in_sbp == key.out_sbp) { return plan; }
+  Optional<int64_t> opt_parallel_id;
+  JUST(GetDevice4CurrentProcessCtx(key.placement, &opt_parallel_id));
+  // ranks outside of the placement hold no data and take part in no collective
+  if (!opt_parallel_id.has_value()) { return plan; }
+  const int64_t parallel_id = JUST(opt_parallel_id.value());
+  CHECK_EQ_OR_RETURN(key.in_sbp->sbp_parallel_size(), 1)
+      << Error::Unimplemented() << "eager boxing supports 1d sbp only now.";
+  CHECK_EQ_OR_RETURN(key.out_sbp->sbp_parallel_size(), 1)
+      << Error::Unimplemented() << "eager boxing supports 1d sbp only now.";
+  const auto& in_sbp = key.in_sbp->sbp_parallel(0);
+  const auto& out_sbp = key.out_sbp->sbp_parallel(0);
+  CHECK_OR_RETURN(!in_sbp.has_split_parallel())
+      << Error::Unimplemented() << "eager boxing from split is not supported now.";
+  if (in_sbp.has_partial_sum_parallel()) { plan->AddStep(*JUST(MakeAllReduceStep(key.placement))); }
+  // the tensor is broadcast on all ranks from here
+  if (out_sbp.has_split_parallel()) {
+    plan->AddStep(*JUST(MakeSplitStep(key.shape, out_sbp.split_parallel().axis(),
+                                      key.placement->parallel_num(), parallel_id)));
+  } else if (out_sbp.has_partial_sum_parallel() && parallel_id != 0) {
+    plan->AddStep([](const std::shared_ptr<Tensor>& x) { return functional::ZerosLike(x); });
+  }
+  return plan;
+}
+
+Maybe<EagerBoxingPlan> FindOrCreateEagerBoxingPlan(const EagerBoxingPlanKey& key) {
+  static thread_local std::unordered_map<EagerBoxingPlanKey, std::shared_ptr<EagerBoxingPlan>,
+                                         EagerBoxingPlanKeyHash>
+      key2plan;
+  auto iter = key2plan.find(key);
+  if (iter == key2plan.end()) {
+    const auto& plan = JUST(MakeEagerBoxingPlan(key));
+    iter = key2plan.emplace(key, plan).first;
+  }
+  return iter->second;
+}
+
 }  //  namespace
 
 class LocalToConsistentFunctor {
@@ -133,7 +250,7 @@ class LocalToConsistentFunctor {
                            Symbol<ParallelDesc> parallel_desc,
                            const std::vector<Symbol<cfg::SbpParallel>>& sbp_parallels,
                            const Optional<Shape>& shape) const {
-    CHECK_OR_RETURN(x->is_local()) << Error::Unimplemented() << "local tensors supported only";
+    if (x->is_consistent()) { return ConsistentToConsistent(x, parallel_desc, sbp_parallels); }
     const auto& device = JUST(x->device());
     if (device->type() != "cpu") {
       CHECK_EQ_OR_RETURN(device->device_id(), GlobalProcessCtx::LocalRank())
@@ -154,6 +271,25 @@ class LocalToConsistentFunctor {
   }
 
  private:
+  Maybe<Tensor> ConsistentToConsistent(
+      const std::shared_ptr<one::Tensor>& x, Symbol<ParallelDesc> parallel_desc,
+      const std::vector<Symbol<cfg::SbpParallel>>& sbp_parallels) const {
+    const auto& in_parallel_desc = JUST(x->parallel_desc());
+    CHECK_OR_RETURN(in_parallel_desc == parallel_desc)
+        << Error::Unimplemented() << "eager boxing across placements is not supported now.";
+    EagerBoxingPlanKey key{parallel_desc, JUST(x->parallel_distribution()),
+                           JUST(GetNdSbp(sbp_parallels)), *x->shape(), x->dtype()};
+    const auto& plan = JUST(FindOrCreateEagerBoxingPlan(key));
+    const auto& local_tensor = JUST(functional::ConsistentToLocal(x));
+    const auto& boxed_tensor = JUST((*plan)(local_tensor));
+    MutableAttrMap attrs;
+    JUST(attrs.SetAttr<Shape>("shape", key.shape));
+    // the plan has already made the broadcast ranks agree, there is nothing left to sync
+    JUST(attrs.SetAttr<bool>("sync_data", false));
+    return OpInterpUtil::Dispatch<one::Tensor>(
+        *op_, {boxed_tensor}, OpExprInterpContext(attrs, parallel_desc, key.out_sbp));
+  }
+
   std::shared_ptr<OpExpr> op_;
 };
 
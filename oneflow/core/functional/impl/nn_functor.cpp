@@ -210,6 +210,76 @@ class LayerNormAffineFunctor {
   std::shared_ptr<OpExpr> op_;
 };
 
+class RmsNormFunctor {
+ public:
+  RmsNormFunctor() {
+    op_ = CHECK_JUST(
+        one::OpBuilder("rms_norm").Input("x").Output("y").Output("inv_rms").Build());
+    affine_op_ = CHECK_JUST(one::OpBuilder("rms_norm")
+                                .Input("x")
+                                .Input("weight")
+                                .Output("y")
+                                .Output("inv_rms")
+                                .Build());
+  }
+  Maybe<Tensor> operator()(const std::shared_ptr<one::Tensor>& x, const int64_t& begin_norm_axis,
+                           const double& epsilon, const Optional<one::Tensor>& weight) const {
+    MutableAttrMap attrs;
+    JUST(attrs.SetAttr<int64_t>("begin_norm_axis", begin_norm_axis));
+    JUST(attrs.SetAttr<double>("epsilon", epsilon));
+    if (weight) {
+      return OpInterpUtil::Dispatch<Tensor>(*affine_op_, {x, JUST(weight.value())}, attrs);
+    }
+    return OpInterpUtil::Dispatch<Tensor>(*op_, {x}, attrs);
+  }
+
+ private:
+  std::shared_ptr<OpExpr> op_;
+  std::shared_ptr<OpExpr> affine_op_;
+};
+
+// Returns (rms_norm(x + residual), x + residual).
+class FusedAddRmsNormFunctor {
+ public:
+  FusedAddRmsNormFunctor() {
+    op_ = CHECK_JUST(one::OpBuilder("rms_norm")
+                         .Input("x")
+                         .Input("residual")
+                         .Output("y")
+                         .Output("inv_rms")
+                         .Output("add_out")
+                         .Build());
+    affine_op_ = CHECK_JUST(one::OpBuilder("rms_norm")
+                                .Input("x")
+                                .Input("weight")
+                                .Input("residual")
+                                .Output("y")
+                                .Output("inv_rms")
+                                .Output("add_out")
+                                .Build());
+  }
+  Maybe<TensorTuple> operator()(const std::shared_ptr<one::Tensor>& x,
+                                const std::shared_ptr<one::Tensor>& residual,
+                                const int64_t& begin_norm_axis, const double& epsilon,
+                                const Optional<one::Tensor>& weight) const {
+    MutableAttrMap attrs;
+    JUST(attrs.SetAttr<int64_t>("begin_norm_axis", begin_norm_axis));
+    JUST(attrs.SetAttr<double>("epsilon", epsilon));
+    std::shared_ptr<TensorTuple> outputs;
+    if (weight) {
+      outputs = JUST(OpInterpUtil::Dispatch<TensorTuple>(
+          *affine_op_, {x, JUST(weight.value()), residual}, attrs));
+    } else {
+      outputs = JUST(OpInterpUtil::Dispatch<TensorTuple>(*op_, {x, residual}, attrs));
+    }
+    return std::make_shared<TensorTuple>(TensorTuple{outputs->at(0), outputs->at(2)});
+  }
+
+ private:
+  std::shared_ptr<OpExpr> op_;
+  std::shared_ptr<OpExpr> affine_op_;
+};
+
 class PoolNDFunctor {
  public:
   PoolNDFunctor() = default;
@@ -510,6 +580,387 @@ class DropoutFunctor {
   std::shared_ptr<OpExpr> dropout_op_;
 };
 
+class FusedMultiHeadAttentionFunctor {
+ public:
+  FusedMultiHeadAttentionFunctor() {
+    for (bool has_key_mask : {false, true}) {
+      for (bool has_cu_seqlens : {false, true}) {
+        one::OpBuilder builder("fused_multi_head_attention");
+        builder.Input("query").Input("key").Input("value");
+        if (has_key_mask) { builder.Input("key_mask"); }
+        if (has_cu_seqlens) { builder.Input("cu_seqlens"); }
+        ops_[has_key_mask][has_cu_seqlens] =
+            CHECK_JUST(builder.Output("out").Output("softmax_lse").Output("rng_state").Build());
+      }
+    }
+  }
+  Maybe<Tensor> operator()(const std::shared_ptr<one::Tensor>& query,
+                           const std::shared_ptr<one::Tensor>& key,
+                           const std::shared_ptr<one::Tensor>& value,
+                           const float& scale, const Optional<one::Tensor>& key_mask,
+                           const bool& causal, const float& dropout_rate,
+                           const Optional<one::Generator>& generator,
+                           const Optional<one::Tensor>& cu_seqlens) const {
+    MutableAttrMap attrs;
+    JUST(attrs.SetAttr<bool>("causal", causal));
+    JUST(attrs.SetAttr<float>("scale", scale));
+    JUST(attrs.SetAttr<float>("dropout_rate", dropout_rate));
+    std::shared_ptr<one::Generator> gen;
+    if (!generator) {
+      gen = JUST(one::DefaultAutoGenerator());
+    } else {
+      gen = JUST(generator.value());
+    }
+    JUST(attrs.SetAttr<int64_t>("seed", gen->current_seed()));
+    TensorTuple inputs{query, key, value};
+    if (key_mask) { inputs.emplace_back(JUST(key_mask.value())); }
+    if (cu_seqlens) { inputs.emplace_back(JUST(cu_seqlens.value())); }
+    const auto& outputs = JUST(OpInterpUtil::Dispatch<TensorTuple>(
+        *ops_[key_mask.has_value()][cu_seqlens.has_value()], inputs, attrs));
+    return outputs->at(0);
+  }
+
+ private:
+  // Indexed by whether key_mask and cu_seqlens are given.
+  std::shared_ptr<OpExpr> ops_[2][2];
+};
+
+class PackSequenceFunctor {
+ public:
+  PackSequenceFunctor() {
+    op_ = CHECK_JUST(one::OpBuilder("pack_sequence")
+                         .Input("in")
+                         .Input("seq_lens")
+                         .Output("out")
+                         .Output("cu_seqlens")
+                         .Build());
+  }
+  Maybe<TensorTuple> operator()(const std::shared_ptr<one::Tensor>& x,
+                                const std::shared_ptr<one::Tensor>& seq_lens) const {
+    return OpInterpUtil::Dispatch<TensorTuple>(*op_, {x, seq_lens});
+  }
+
+ private:
+  std::shared_ptr<OpExpr> op_;
+};
+
+class UnpackSequenceFunctor {
+ public:
+  UnpackSequenceFunctor() {
+    op_ = CHECK_JUST(
+        one::OpBuilder("unpack_sequence").Input("in").Input("cu_seqlens").Output("out").Build());
+  }
+  Maybe<Tensor> operator()(const std::shared_ptr<one::Tensor>& x,
+                           const std::shared_ptr<one::Tensor>& cu_seqlens,
+                           const int64_t& max_seq_len) const {
+    MutableAttrMap attrs;
+    JUST(attrs.SetAttr<int64_t>("max_seq_len", max_seq_len));
+    return OpInterpUtil::Dispatch<Tensor>(*op_, {x, cu_seqlens}, attrs);
+  }
+
+ private:
+  std::shared_ptr<OpExpr> op_;
+};
+
+// activation(a * b + bias) by one cuBLASLt matmul, a gelu activation also outputs a * b + bias
+// for the backward.
+class FusedMatmulBiasFunctor {
+ public:
+  FusedMatmulBiasFunctor() {
+    op_ = CHECK_JUST(one::OpBuilder("fused_matmul_bias")
+                         .Input("a")
+                         .Input("b")
+                         .Input("bias")
+                         .Output("out")
+                         .Build());
+    aux_op_ = CHECK_JUST(one::OpBuilder("fused_matmul_bias")
+                             .Input("a")
+                             .Input("b")
+                             .Input("bias")
+                             .Output("out")
+                             .Output("aux")
+                             .Build());
+  }
+  Maybe<Tensor> operator()(const std::shared_ptr<one::Tensor>& a,
+                           const std::shared_ptr<one::Tensor>& b,
+                           const std::shared_ptr<one::Tensor>& bias, const bool& transpose_b,
+                           const std::string& activation) const {
+    MutableAttrMap attrs;
+    JUST(attrs.SetAttr<bool>("transpose_b", transpose_b));
+    JUST(attrs.SetAttr<std::string>("activation", activation));
+    if (activation == "gelu") {
+      return OpInterpUtil::Dispatch<Tensor>(*aux_op_, {a, b, bias}, attrs);
+    }
+    return OpInterpUtil::Dispatch<Tensor>(*op_, {a, b, bias}, attrs);
+  }
+
+ private:
+  std::shared_ptr<OpExpr> op_;
+  std::shared_ptr<OpExpr> aux_op_;
+};
+
+// weight[ids] by a lookup that also deduplicates the ids, the grad of weight is then only summed
+// and applied on the rows of the distinct ids.
+class EmbeddingLookupFunctor {
+ public:
+  EmbeddingLookupFunctor() {
+    op_ = CHECK_JUST(one::OpBuilder("embedding_lookup")
+                         .Input("weight")
+                         .Input("ids")
+                         .Output("out")
+                         .Output("unique_ids")
+                         .Output("inverse_indices")
+                         .Build());
+  }
+  Maybe<Tensor> operator()(const std::shared_ptr<one::Tensor>& weight,
+                           const std::shared_ptr<one::Tensor>& ids) const {
+    return OpInterpUtil::Dispatch<Tensor>(*op_, {weight, ids});
+  }
+
+ private:
+  std::shared_ptr<OpExpr> op_;
+};
+
+// Returns (out, slots), the rows of the ids in a table that lives in a device cache, a host cache
+// and a file, and the slots of the device cache they were read from.
+class CachedEmbeddingLookupFunctor {
+ public:
+  CachedEmbeddingLookupFunctor() {
+    op_ = CHECK_JUST(one::OpBuilder("cached_embedding_lookup")
+                         .Input("ids")
+                         .Output("out")
+                         .Output("slots")
+                         .Build());
+  }
+  Maybe<TensorTuple> operator()(const std::shared_ptr<one::Tensor>& ids, const std::string& name,
+                                const std::string& path, const int64_t& embedding_size,
+                                const int64_t& device_cache_capacity,
+                                const int64_t& host_cache_capacity,
+                                const float& initializer_scale, const int64_t& seed) const {
+    MutableAttrMap attrs;
+    JUST(attrs.SetAttr<std::string>("embedding_name", name));
+    JUST(attrs.SetAttr<std::string>("path", path));
+    JUST(attrs.SetAttr<int64_t>("embedding_size", embedding_size));
+    JUST(attrs.SetAttr<int64_t>("device_cache_capacity", device_cache_capacity));
+    JUST(attrs.SetAttr<int64_t>("host_cache_capacity", host_cache_capacity));
+    JUST(attrs.SetAttr<float>("initializer_scale", initializer_scale));
+    JUST(attrs.SetAttr<int64_t>("seed", seed));
+    return OpInterpUtil::Dispatch<TensorTuple>(*op_, {ids}, attrs);
+  }
+
+ private:
+  std::shared_ptr<OpExpr> op_;
+};
+
+class CachedEmbeddingUpdateFunctor {
+ public:
+  CachedEmbeddingUpdateFunctor() {
+    op_ = CHECK_JUST(
+        one::OpBuilder("cached_embedding_update").Input("slots").Input("embedding_diff").Build());
+  }
+  Maybe<void> operator()(const std::shared_ptr<one::Tensor>& slots,
+                         const std::shared_ptr<one::Tensor>& embedding_diff,
+                         const std::string& name, const float& learning_rate) const {
+    MutableAttrMap attrs;
+    JUST(attrs.SetAttr<std::string>("embedding_name", name));
+    JUST(attrs.SetAttr<float>("learning_rate", learning_rate));
+    JUST(OpInterpUtil::Dispatch<TensorTuple>(*op_, {slots, embedding_diff}, attrs));
+    return Maybe<void>::Ok();
+  }
+
+ private:
+  std::shared_ptr<OpExpr> op_;
+};
+
+// Top-k gating of a mixture of experts layer, see moe_ops.cpp for the routing.
+class MoeGatingFunctor {
+ public:
+  MoeGatingFunctor() {
+    op_ = CHECK_JUST(one::OpBuilder("moe_gating")
+                         .Input("logits")
+                         .Output("expert_ids")
+                         .Output("positions")
+                         .Output("gates")
+                         .Build());
+  }
+  Maybe<TensorTuple> operator()(const std::shared_ptr<one::Tensor>& logits,
+                                const int32_t& k) const {
+    MutableAttrMap attrs;
+    JUST(attrs.SetAttr<int32_t>("k", k));
+    return OpInterpUtil::Dispatch<TensorTuple>(*op_, {logits}, attrs);
+  }
+
+ private:
+  std::shared_ptr<OpExpr> op_;
+};
+
+class MoeDispatchFunctor {
+ public:
+  MoeDispatchFunctor() {
+    op_ = CHECK_JUST(one::OpBuilder("moe_dispatch")
+                         .Input("x")
+                         .Input("expert_ids")
+                         .Input("positions")
+                         .Output("out")
+                         .Build());
+  }
+  Maybe<Tensor> operator()(const std::shared_ptr<one::Tensor>& x,
+                           const std::shared_ptr<one::Tensor>& expert_ids,
+                           const std::shared_ptr<one::Tensor>& positions,
+                           const int64_t& num_experts, const int64_t& capacity) const {
+    MutableAttrMap attrs;
+    JUST(attrs.SetAttr<int64_t>("num_experts", num_experts));
+    JUST(attrs.SetAttr<int64_t>("capacity", capacity));
+    return OpInterpUtil::Dispatch<Tensor>(*op_, {x, expert_ids, positions}, attrs);
+  }
+
+ private:
+  std::shared_ptr<OpExpr> op_;
+};
+
+class MoeCombineFunctor {
+ public:
+  MoeCombineFunctor() {
+    op_ = CHECK_JUST(one::OpBuilder("moe_combine")
+                         .Input("expert_x")
+                         .Input("expert_ids")
+                         .Input("positions")
+                         .Input("gates")
+                         .Output("out")
+                         .Build());
+  }
+  Maybe<Tensor> operator()(const std::shared_ptr<one::Tensor>& expert_x,
+                           const std::shared_ptr<one::Tensor>& expert_ids,
+                           const std::shared_ptr<one::Tensor>& positions,
+                           const std::shared_ptr<one::Tensor>& gates) const {
+    return OpInterpUtil::Dispatch<Tensor>(*op_, {expert_x, expert_ids, positions, gates});
+  }
+
+ private:
+  std::shared_ptr<OpExpr> op_;
+};
+
+// Updates the tensors of `lists` with one op launch per kMaxInputCount tensors that share the
+// device and the data types of model and model diff. lists[0] are the models and lists[1] the
+// model diffs.
+class MultiTensorUpdateFunctor {
+ protected:
+  MultiTensorUpdateFunctor(const std::string& op_type_name,
+                           const std::vector<std::string>& arg_names) {
+    ops_.resize(kMaxInputCount);
+    for (int n = 0; n < ops_.size(); ++n) {
+      one::OpBuilder builder(op_type_name);
+      for (const auto& arg_name : arg_names) { builder.Input(arg_name, n + 1); }
+      ops_[n] = CHECK_JUST(builder.Build());
+    }
+  }
+
+  Maybe<void> Dispatch(const std::vector<const TensorTuple*>& lists,
+                       const MutableAttrMap& attrs) const {
+    const TensorTuple& model = *lists.at(0);
+    const TensorTuple& model_diff = *lists.at(1);
+    for (const auto* list : lists) { CHECK_EQ_OR_RETURN(list->size(), model.size()); }
+    struct Group {
+      Symbol<Device> device;
+      DataType data_type;
+      DataType diff_data_type;
+      std::vector<int64_t> indices;
+    };
+    std::vector<Group> groups;
+    for (int64_t i = 0; i < model.size(); ++i) {
+      CHECK_OR_RETURN(model.at(i)->is_local()) << "multi tensor update only supports local tensors";
+      const auto& device = JUST(model.at(i)->device());
+      const DataType data_type = model.at(i)->dtype();
+      const DataType diff_data_type = model_diff.at(i)->dtype();
+      auto it = std::find_if(groups.begin(), groups.end(), [&](const Group& group) {
+        return group.device == device && group.data_type == data_type
+               && group.diff_data_type == diff_data_type;
+      });
+      if (it == groups.end()) {
+        groups.push_back(Group{device, data_type, diff_data_type, {}});
+        it = groups.end() - 1;
+      }
+      it->indices.push_back(i);
+    }
+    for (const auto& group : groups) {
+      for (int64_t begin = 0; begin < group.indices.size(); begin += kMaxInputCount) {
+        const int64_t size = std::min<int64_t>(kMaxInputCount, group.indices.size() - begin);
+        TensorTuple inputs;
+        inputs.reserve(size * lists.size());
+        for (const auto* list : lists) {
+          for (int64_t j = begin; j < begin + size; ++j) {
+            inputs.push_back(list->at(group.indices.at(j)));
+          }
+        }
+        JUST(OpInterpUtil::Dispatch<TensorTuple>(*ops_.at(size - 1), inputs, attrs));
+      }
+    }
+    return Maybe<void>::Ok();
+  }
+
+ private:
+  std::vector<std::shared_ptr<OpExpr>> ops_;
+};
+
+class MultiTensorSgdUpdateFunctor : public MultiTensorUpdateFunctor {
+ public:
+  MultiTensorSgdUpdateFunctor()
+      : MultiTensorUpdateFunctor("multi_tensor_sgd_update", {"model", "model_diff"}) {}
+  Maybe<void> operator()(const TensorTuple& model, const TensorTuple& model_diff,
+                         const float& learning_rate, const double& scale, const float& l1,
+                         const float& l2, const float& weight_decay) const {
+    MutableAttrMap attrs;
+    JUST(attrs.SetAttr<float>("learning_rate_val", learning_rate));
+    JUST(attrs.SetAttr<double>("scale", scale));
+    JUST(attrs.SetAttr<float>("l1", l1));
+    JUST(attrs.SetAttr<float>("l2", l2));
+    JUST(attrs.SetAttr<float>("weight_decay", weight_decay));
+    return Dispatch({&model, &model_diff}, attrs);
+  }
+};
+
+class MultiTensorMomentumUpdateFunctor : public MultiTensorUpdateFunctor {
+ public:
+  MultiTensorMomentumUpdateFunctor()
+      : MultiTensorUpdateFunctor("multi_tensor_momentum_update",
+                                 {"model", "model_diff", "momentum"}) {}
+  Maybe<void> operator()(const TensorTuple& model, const TensorTuple& model_diff,
+                         const TensorTuple& momentum, const float& learning_rate,
+                         const float& beta, const double& scale, const float& l1, const float& l2,
+                         const float& weight_decay) const {
+    MutableAttrMap attrs;
+    JUST(attrs.SetAttr<float>("learning_rate_val", learning_rate));
+    JUST(attrs.SetAttr<float>("beta", beta));
+    JUST(attrs.SetAttr<double>("scale", scale));
+    JUST(attrs.SetAttr<float>("l1", l1));
+    JUST(attrs.SetAttr<float>("l2", l2));
+    JUST(attrs.SetAttr<float>("weight_decay", weight_decay));
+    return Dispatch({&model, &model_diff, &momentum}, attrs);
+  }
+};
+
+class MultiTensorAdamUpdateFunctor : public MultiTensorUpdateFunctor {
+ public:
+  MultiTensorAdamUpdateFunctor()
+      : MultiTensorUpdateFunctor("multi_tensor_adam_update", {"model", "model_diff", "m", "v"}) {}
+  Maybe<void> operator()(const TensorTuple& model, const TensorTuple& model_diff,
+                         const TensorTuple& m, const TensorTuple& v, const float& learning_rate,
+                         const float& beta1, const float& beta2, const float& epsilon,
+                         const double& scale, const float& l1, const float& l2,
+                         const float& weight_decay) const {
+    MutableAttrMap attrs;
+    JUST(attrs.SetAttr<float>("learning_rate_val", learning_rate));
+    JUST(attrs.SetAttr<float>("beta1", beta1));
+    JUST(attrs.SetAttr<float>("beta2", beta2));
+    JUST(attrs.SetAttr<float>("epsilon", epsilon));
+    JUST(attrs.SetAttr<double>("scale", scale));
+    JUST(attrs.SetAttr<float>("l1", l1));
+    JUST(attrs.SetAttr<float>("l2", l2));
+    JUST(attrs.SetAttr<float>("weight_decay", weight_decay));
+    return Dispatch({&model, &model_diff, &m, &v}, attrs);
+  }
+};
+
 }  // namespace impl
 
 ONEFLOW_FUNCTION_LIBRARY(m) {
@@ -522,6 +973,8 @@ ONEFLOW_FUNCTION_LIBRARY(m) {
   m.add_functor<impl::BroadcastMatMulFunctor>("BroadcastMatMul");
   m.add_functor<impl::LayerNormFunctor>("LayerNorm");
   m.add_functor<impl::LayerNormAffineFunctor>("LayerNormAffine");
+  m.add_functor<impl::RmsNormFunctor>("RmsNorm");
+  m.add_functor<impl::FusedAddRmsNormFunctor>("FusedAddRmsNorm");
   m.add_functor<impl::AvgPool2DFunctor>("AvgPool2D");
   m.add_functor<impl::Maxpool1DFunctor>("Maxpool1D");
   m.add_functor<impl::Maxpool2DFunctor>("Maxpool2D");
@@ -535,6 +988,19 @@ ONEFLOW_FUNCTION_LIBRARY(m) {
   m.add_functor<impl::NormalizationFunctor>("Normalization");
   m.add_functor<impl::PadFunctor>("Pad");
   m.add_functor<impl::DropoutFunctor>("Dropout");
+  m.add_functor<impl::FusedMultiHeadAttentionFunctor>("FusedMultiHeadAttention");
+  m.add_functor<impl::PackSequenceFunctor>("PackSequence");
+  m.add_functor<impl::UnpackSequenceFunctor>("UnpackSequence");
+  m.add_functor<impl::FusedMatmulBiasFunctor>("FusedMatmulBias");
+  m.add_functor<impl::EmbeddingLookupFunctor>("EmbeddingLookup");
+  m.add_functor<impl::CachedEmbeddingLookupFunctor>("CachedEmbeddingLookup");
+  m.add_functor<impl::CachedEmbeddingUpdateFunctor>("CachedEmbeddingUpdate");
+  m.add_functor<impl::MoeGatingFunctor>("MoeGating");
+  m.add_functor<impl::MoeDispatchFunctor>("MoeDispatch");
+  m.add_functor<impl::MoeCombineFunctor>("MoeCombine");
+  m.add_functor<impl::MultiTensorSgdUpdateFunctor>("MultiTensorSgdUpdate");
+  m.add_functor<impl::MultiTensorMomentumUpdateFunctor>("MultiTensorMomentumUpdate");
+  m.add_functor<impl::MultiTensorAdamUpdateFunctor>("MultiTensorAdamUpdate");
 };
 
 }  // namespace functional
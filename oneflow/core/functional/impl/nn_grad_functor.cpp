@@ -14,6 +14,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 
+#include "oneflow/core/common/optional.h"
 #include "oneflow/core/framework/attr_map.h"
 #include "oneflow/core/framework/op_builder.h"
 #include "oneflow/core/framework/op_expr.h"
@@ -307,6 +308,298 @@ class PadGradFunctor {
   std::shared_ptr<OpExpr> constant_pad_3d_grad_;
 };
 
+class RmsNormGradFunctor {
+ public:
+  RmsNormGradFunctor() {
+    op_ = CHECK_JUST(one::OpBuilder("rms_norm_grad")
+                         .Input("dy")
+                         .Input("x")
+                         .Input("inv_rms")
+                         .Output("dx")
+                         .Build());
+    affine_op_ = CHECK_JUST(one::OpBuilder("rms_norm_grad")
+                                .Input("dy")
+                                .Input("x")
+                                .Input("inv_rms")
+                                .Input("weight")
+                                .Output("dx")
+                                .Build());
+  }
+  Maybe<Tensor> operator()(const std::shared_ptr<one::Tensor>& dy,
+                           const std::shared_ptr<one::Tensor>& x,
+                           const std::shared_ptr<one::Tensor>& inv_rms,
+                           const int64_t& begin_norm_axis,
+                           const Optional<one::Tensor>& weight) const {
+    MutableAttrMap attrs;
+    JUST(attrs.SetAttr<int64_t>("begin_norm_axis", begin_norm_axis));
+    if (weight) {
+      return OpInterpUtil::Dispatch<Tensor>(*affine_op_, {dy, x, inv_rms, JUST(weight.value())},
+                                            attrs);
+    }
+    return OpInterpUtil::Dispatch<Tensor>(*op_, {dy, x, inv_rms}, attrs);
+  }
+
+ private:
+  std::shared_ptr<OpExpr> op_;
+  std::shared_ptr<OpExpr> affine_op_;
+};
+
+class RmsNormParamGradFunctor {
+ public:
+  RmsNormParamGradFunctor() {
+    op_ = CHECK_JUST(one::OpBuilder("rms_norm_param_grad")
+                         .Input("dy")
+                         .Input("x")
+                         .Input("inv_rms")
+                         .Output("weight_grad")
+                         .Build());
+  }
+  Maybe<Tensor> operator()(const std::shared_ptr<one::Tensor>& dy,
+                           const std::shared_ptr<one::Tensor>& x,
+                           const std::shared_ptr<one::Tensor>& inv_rms,
+                           const int64_t& begin_norm_axis) const {
+    MutableAttrMap attrs;
+    JUST(attrs.SetAttr<int64_t>("begin_norm_axis", begin_norm_axis));
+    return OpInterpUtil::Dispatch<Tensor>(*op_, {dy, x, inv_rms}, attrs);
+  }
+
+ private:
+  std::shared_ptr<OpExpr> op_;
+};
+
+// Returns ([pre_grad], b_grad, bias_grad) of fused_matmul_bias, pre_grad is there when there is an
+// activation. relu needs out and gelu needs aux.
+class FusedMatmulBiasGradFunctor {
+ public:
+  FusedMatmulBiasGradFunctor() {
+    op_ = CHECK_JUST(one::OpBuilder("fused_matmul_bias_grad")
+                         .Input("dy")
+                         .Input("a")
+                         .Output("b_grad")
+                         .Output("bias_grad")
+                         .Build());
+    relu_op_ = CHECK_JUST(one::OpBuilder("fused_matmul_bias_grad")
+                              .Input("dy")
+                              .Input("a")
+                              .Input("out")
+                              .Output("pre_grad")
+                              .Output("b_grad")
+                              .Output("bias_grad")
+                              .Build());
+    gelu_op_ = CHECK_JUST(one::OpBuilder("fused_matmul_bias_grad")
+                              .Input("dy")
+                              .Input("a")
+                              .Input("aux")
+                              .Output("pre_grad")
+                              .Output("b_grad")
+                              .Output("bias_grad")
+                              .Build());
+  }
+  Maybe<TensorTuple> operator()(const std::shared_ptr<one::Tensor>& dy,
+                                const std::shared_ptr<one::Tensor>& a, const bool& transpose_b,
+                                const std::string& activation, const Optional<one::Tensor>& out,
+                                const Optional<one::Tensor>& aux) const {
+    MutableAttrMap attrs;
+    JUST(attrs.SetAttr<bool>("transpose_b", transpose_b));
+    JUST(attrs.SetAttr<std::string>("activation", activation));
+    if (activation == "relu") {
+      CHECK_OR_RETURN(out) << "the grad of relu needs out";
+      return OpInterpUtil::Dispatch<TensorTuple>(*relu_op_, {dy, a, JUST(out.value())}, attrs);
+    }
+    if (activation == "gelu") {
+      CHECK_OR_RETURN(aux) << "the grad of gelu needs aux";
+      return OpInterpUtil::Dispatch<TensorTuple>(*gelu_op_, {dy, a, JUST(aux.value())}, attrs);
+    }
+    return OpInterpUtil::Dispatch<TensorTuple>(*op_, {dy, a}, attrs);
+  }
+
+ private:
+  std::shared_ptr<OpExpr> op_;
+  std::shared_ptr<OpExpr> relu_op_;
+  std::shared_ptr<OpExpr> gelu_op_;
+};
+
+class EmbeddingLookupGradFunctor {
+ public:
+  EmbeddingLookupGradFunctor() {
+    op_ = CHECK_JUST(one::OpBuilder("embedding_lookup_grad")
+                         .Input("out_diff")
+                         .Input("unique_ids")
+                         .Input("inverse_indices")
+                         .Output("unique_diff")
+                         .Build());
+  }
+  Maybe<Tensor> operator()(const std::shared_ptr<one::Tensor>& out_diff,
+                           const std::shared_ptr<one::Tensor>& unique_ids,
+                           const std::shared_ptr<one::Tensor>& inverse_indices) const {
+    return OpInterpUtil::Dispatch<Tensor>(*op_, {out_diff, unique_ids, inverse_indices});
+  }
+
+ private:
+  std::shared_ptr<OpExpr> op_;
+};
+
+class MoeGatingGradFunctor {
+ public:
+  MoeGatingGradFunctor() {
+    op_ = CHECK_JUST(one::OpBuilder("moe_gating_grad")
+                         .Input("gates")
+                         .Input("expert_ids")
+                         .Input("gates_diff")
+                         .Output("logits_diff")
+                         .Build());
+  }
+  Maybe<Tensor> operator()(const std::shared_ptr<one::Tensor>& gates,
+                           const std::shared_ptr<one::Tensor>& expert_ids,
+                           const std::shared_ptr<one::Tensor>& gates_diff,
+                           const int64_t& num_experts) const {
+    MutableAttrMap attrs;
+    JUST(attrs.SetAttr<int64_t>("num_experts", num_experts));
+    return OpInterpUtil::Dispatch<Tensor>(*op_, {gates, expert_ids, gates_diff}, attrs);
+  }
+
+ private:
+  std::shared_ptr<OpExpr> op_;
+};
+
+// the grad of moe_dispatch without gates is moe_combine without gates
+class MoeDispatchGradFunctor {
+ public:
+  MoeDispatchGradFunctor() {
+    op_ = CHECK_JUST(one::OpBuilder("moe_combine")
+                         .Input("expert_x")
+                         .Input("expert_ids")
+                         .Input("positions")
+                         .Output("out")
+                         .Build());
+  }
+  Maybe<Tensor> operator()(const std::shared_ptr<one::Tensor>& dy,
+                           const std::shared_ptr<one::Tensor>& expert_ids,
+                           const std::shared_ptr<one::Tensor>& positions) const {
+    return OpInterpUtil::Dispatch<Tensor>(*op_, {dy, expert_ids, positions});
+  }
+
+ private:
+  std::shared_ptr<OpExpr> op_;
+};
+
+// the grad of moe_combine with gates is moe_dispatch with the same gates
+class MoeCombineGradFunctor {
+ public:
+  MoeCombineGradFunctor() {
+    op_ = CHECK_JUST(one::OpBuilder("moe_dispatch")
+                         .Input("x")
+                         .Input("expert_ids")
+                         .Input("positions")
+                         .Input("gates")
+                         .Output("out")
+                         .Build());
+  }
+  Maybe<Tensor> operator()(const std::shared_ptr<one::Tensor>& dy,
+                           const std::shared_ptr<one::Tensor>& expert_ids,
+                           const std::shared_ptr<one::Tensor>& positions,
+                           const std::shared_ptr<one::Tensor>& gates, const int64_t& num_experts,
+                           const int64_t& capacity) const {
+    MutableAttrMap attrs;
+    JUST(attrs.SetAttr<int64_t>("num_experts", num_experts));
+    JUST(attrs.SetAttr<int64_t>("capacity", capacity));
+    return OpInterpUtil::Dispatch<Tensor>(*op_, {dy, expert_ids, positions, gates}, attrs);
+  }
+
+ private:
+  std::shared_ptr<OpExpr> op_;
+};
+
+class MoeGatesGradFunctor {
+ public:
+  MoeGatesGradFunctor() {
+    op_ = CHECK_JUST(one::OpBuilder("moe_gates_grad")
+                         .Input("x")
+                         .Input("expert_x")
+                         .Input("expert_ids")
+                         .Input("positions")
+                         .Output("gates_diff")
+                         .Build());
+  }
+  Maybe<Tensor> operator()(const std::shared_ptr<one::Tensor>& x,
+                           const std::shared_ptr<one::Tensor>& expert_x,
+                           const std::shared_ptr<one::Tensor>& expert_ids,
+                           const std::shared_ptr<one::Tensor>& positions) const {
+    return OpInterpUtil::Dispatch<Tensor>(*op_, {x, expert_x, expert_ids, positions});
+  }
+
+ private:
+  std::shared_ptr<OpExpr> op_;
+};
+
+class FusedMultiHeadAttentionGradFunctor {
+ public:
+  FusedMultiHeadAttentionGradFunctor() {
+    for (bool has_key_mask : {false, true}) {
+      for (bool has_cu_seqlens : {false, true}) {
+        one::OpBuilder builder("fused_multi_head_attention_grad");
+        builder.Input("query").Input("key").Input("value");
+        if (has_key_mask) { builder.Input("key_mask"); }
+        if (has_cu_seqlens) { builder.Input("cu_seqlens"); }
+        ops_[has_key_mask][has_cu_seqlens] = CHECK_JUST(builder.Input("out")
+                                                            .Input("out_grad")
+                                                            .Input("softmax_lse")
+                                                            .Input("rng_state")
+                                                            .Output("query_grad")
+                                                            .Output("key_grad")
+                                                            .Output("value_grad")
+                                                            .Build());
+      }
+    }
+  }
+  Maybe<TensorTuple> operator()(const std::shared_ptr<one::Tensor>& query,
+                                const std::shared_ptr<one::Tensor>& key,
+                                const std::shared_ptr<one::Tensor>& value,
+                                const std::shared_ptr<one::Tensor>& out,
+                                const std::shared_ptr<one::Tensor>& out_grad,
+                                const std::shared_ptr<one::Tensor>& softmax_lse,
+                                const std::shared_ptr<one::Tensor>& rng_state,
+                                const bool& causal, const float& scale,
+                                const float& dropout_rate, const Optional<one::Tensor>& key_mask,
+                                const Optional<one::Tensor>& cu_seqlens) const {
+    MutableAttrMap attrs;
+    JUST(attrs.SetAttr<bool>("causal", causal));
+    JUST(attrs.SetAttr<float>("scale", scale));
+    JUST(attrs.SetAttr<float>("dropout_rate", dropout_rate));
+    TensorTuple inputs{query, key, value};
+    if (key_mask) { inputs.emplace_back(JUST(key_mask.value())); }
+    if (cu_seqlens) { inputs.emplace_back(JUST(cu_seqlens.value())); }
+    inputs.emplace_back(out);
+    inputs.emplace_back(out_grad);
+    inputs.emplace_back(softmax_lse);
+    inputs.emplace_back(rng_state);
+    return OpInterpUtil::Dispatch<TensorTuple>(
+        *ops_[key_mask.has_value()][cu_seqlens.has_value()], inputs, attrs);
+  }
+
+ private:
+  // Indexed by whether key_mask and cu_seqlens are given.
+  std::shared_ptr<OpExpr> ops_[2][2];
+};
+
+class UnpackSequenceGradFunctor {
+ public:
+  UnpackSequenceGradFunctor() {
+    op_ = CHECK_JUST(one::OpBuilder("unpack_sequence_grad")
+                         .Input("dy")
+                         .Input("cu_seqlens")
+                         .Output("dx")
+                         .Build());
+  }
+  Maybe<Tensor> operator()(const std::shared_ptr<one::Tensor>& dy,
+                           const std::shared_ptr<one::Tensor>& cu_seqlens) const {
+    return OpInterpUtil::Dispatch<Tensor>(*op_, {dy, cu_seqlens});
+  }
+
+ private:
+  std::shared_ptr<OpExpr> op_;
+};
+
 }  // namespace impl
 
 ONEFLOW_FUNCTION_LIBRARY(m) {
@@ -318,6 +611,16 @@ ONEFLOW_FUNCTION_LIBRARY(m) {
   m.add_functor<impl::SmoothL1LossGradFunctor>("SmoothL1LossGrad");
   m.add_functor<impl::PoolingNdGradFunctor>("PoolingNdGrad");
   m.add_functor<impl::PadGradFunctor>("PadGrad");
+  m.add_functor<impl::FusedMultiHeadAttentionGradFunctor>("FusedMultiHeadAttentionGrad");
+  m.add_functor<impl::UnpackSequenceGradFunctor>("UnpackSequenceGrad");
+  m.add_functor<impl::FusedMatmulBiasGradFunctor>("FusedMatmulBiasGrad");
+  m.add_functor<impl::EmbeddingLookupGradFunctor>("EmbeddingLookupGrad");
+  m.add_functor<impl::MoeGatingGradFunctor>("MoeGatingGrad");
+  m.add_functor<impl::MoeDispatchGradFunctor>("MoeDispatchGrad");
+  m.add_functor<impl::MoeCombineGradFunctor>("MoeCombineGrad");
+  m.add_functor<impl::MoeGatesGradFunctor>("MoeGatesGrad");
+  m.add_functor<impl::RmsNormGradFunctor>("RmsNormGrad");
+  m.add_functor<impl::RmsNormParamGradFunctor>("RmsNormParamGrad");
 };
 
 }  // namespace functional
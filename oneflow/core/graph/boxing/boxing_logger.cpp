@@ -20,10 +20,11 @@ namespace oneflow {
 
 namespace {
 
-#define OF_BOXING_LOGGER_CSV_COLNUM_NAME_FIELD                   \
-  "src_op_name,dst_op_name,src_parallel_desc,dst_parallel_desc," \
-  "src_parallel_distribution,"                                   \
-  "dst_parallel_distribution,lbi,dtype,shape,builder,comment\n"
+#define OF_BOXING_LOGGER_CSV_COLNUM_NAME_FIELD                                  \
+  "src_op_name,dst_op_name,src_parallel_desc,dst_parallel_desc,"                \
+  "src_parallel_distribution,"                                                  \
+  "dst_parallel_distribution,lbi,dtype,shape,logical_bytes,builder,slow_path," \
+  "num_task_nodes,num_copy_task_nodes,max_fan_in,max_fan_out,comment\n"
 
 std::string ShapeToString(const Shape& shape) {
   std::stringstream shape_ss;
@@ -56,26 +57,14 @@ std::string ParallelDescToString(const ParallelDesc& parallel_desc) {
   return serialized_parallel_desc;
 }
 
-std::string ParallelDistributionToString(const cfg::ParallelDistribution& parallel_distribution) {
-  std::string serialized_parallel_distribution;
-  const int64_t num_axes = parallel_distribution.sbp_parallel_size();
-  serialized_parallel_distribution += "[";
-  for (int64_t i = 0; i < num_axes - 1; ++i) {
-    serialized_parallel_distribution +=
-        SbpParallelToString(parallel_distribution.sbp_parallel(i)) + " ";
-  }
-  serialized_parallel_distribution +=
-      SbpParallelToString(parallel_distribution.sbp_parallel(num_axes - 1)) + "]";
-  return serialized_parallel_distribution;
-}
-
 std::string MakeBoxingLoggerCsvRow(const SubTskGphBuilderStatus& status,
                                    const std::string& src_op_name, const std::string& dst_op_name,
                                    const ParallelDesc& src_parallel_desc,
                                    const ParallelDesc& dst_parallel_desc,
                                    const cfg::ParallelDistribution& src_parallel_distribution,
                                    const cfg::ParallelDistribution& dst_parallel_distribution,
-                                   const LogicalBlobId& lbi, const BlobDesc& logical_blob_desc) {
+                                   const LogicalBlobId& lbi, const BlobDesc& logical_blob_desc,
+                                   const BoxingTaskNodeStat& stat) {
   std::string serialized_status;
   serialized_status += src_op_name + ",";
   serialized_status += dst_op_name + ",";
@@ -86,7 +75,13 @@ std::string MakeBoxingLoggerCsvRow(const SubTskGphBuilderStatus& status,
   serialized_status += GenLogicalBlobName(lbi) + ",";
   serialized_status += DataType_Name(logical_blob_desc.data_type()) + ",";
   serialized_status += ShapeToString(logical_blob_desc.shape()) + ",";
+  serialized_status += std::to_string(logical_blob_desc.ByteSizeOfBlobBody()) + ",";
   serialized_status += status.builder_name() + ",";
+  serialized_status += std::string(IsSlowBoxingBuilder(status.builder_name()) ? "1" : "0") + ",";
+  serialized_status += std::to_string(stat.num_task_nodes) + ",";
+  serialized_status += std::to_string(stat.num_copy_task_nodes) + ",";
+  serialized_status += std::to_string(stat.max_fan_in) + ",";
+  serialized_status += std::to_string(stat.max_fan_out) + ",";
   if (status.comment().empty()) {
     serialized_status += "-";
   } else {
@@ -98,6 +93,24 @@ std::string MakeBoxingLoggerCsvRow(const SubTskGphBuilderStatus& status,
 
 }  // namespace
 
+std::string ParallelDistributionToString(const cfg::ParallelDistribution& parallel_distribution) {
+  std::string serialized_parallel_distribution;
+  const int64_t num_axes = parallel_distribution.sbp_parallel_size();
+  serialized_parallel_distribution += "[";
+  for (int64_t i = 0; i < num_axes - 1; ++i) {
+    serialized_parallel_distribution +=
+        SbpParallelToString(parallel_distribution.sbp_parallel(i)) + " ";
+  }
+  serialized_parallel_distribution +=
+      SbpParallelToString(parallel_distribution.sbp_parallel(num_axes - 1)) + "]";
+  return serialized_parallel_distribution;
+}
+
+bool IsSlowBoxingBuilder(const std::string& builder_name) {
+  return builder_name.find("NaiveB2BSubTskGphBuilder") != std::string::npos
+         || builder_name.find("NaiveB2PSubTskGphBuilder") != std::string::npos;
+}
+
 CsvBoxingLogger::CsvBoxingLogger(std::string path) {
   log_stream_ = TeePersistentLogStream::Create(path);
   log_stream_ << OF_BOXING_LOGGER_CSV_COLNUM_NAME_FIELD;
@@ -110,10 +123,11 @@ void CsvBoxingLogger::Log(const SubTskGphBuilderStatus& status, const std::strin
                           const ParallelDesc& dst_parallel_desc,
                           const cfg::ParallelDistribution& src_parallel_distribution,
                           const cfg::ParallelDistribution& dst_parallel_distribution,
-                          const LogicalBlobId& lbi, const BlobDesc& logical_blob_desc) {
+                          const LogicalBlobId& lbi, const BlobDesc& logical_blob_desc,
+                          const BoxingTaskNodeStat& stat) {
   log_stream_ << MakeBoxingLoggerCsvRow(status, src_op_name, dst_op_name, src_parallel_desc,
                                         dst_parallel_desc, src_parallel_distribution,
-                                        dst_parallel_distribution, lbi, logical_blob_desc);
+                                        dst_parallel_distribution, lbi, logical_blob_desc, stat);
 }
 
 }  // namespace oneflow
@@ -21,6 +21,19 @@ limitations under the License.
 
 namespace oneflow {
 
+// the task nodes built for the boxing of one blob on one op edge
+struct BoxingTaskNodeStat {
+  int64_t num_task_nodes = 0;
+  int64_t num_copy_task_nodes = 0;
+  int64_t max_fan_in = 0;
+  int64_t max_fan_out = 0;
+};
+
+std::string ParallelDistributionToString(const cfg::ParallelDistribution& parallel_distribution);
+
+// the builders that send the whole blob to every consumer device or go through one device
+bool IsSlowBoxingBuilder(const std::string& builder_name);
+
 class BoxingLogger {
  public:
   OF_DISALLOW_COPY_AND_MOVE(BoxingLogger);
@@ -32,7 +45,8 @@ class BoxingLogger {
                    const ParallelDesc& dst_parallel_desc,
                    const cfg::ParallelDistribution& src_parallel_distribution,
                    const cfg::ParallelDistribution& dst_parallel_distribution,
-                   const LogicalBlobId& lbi, const BlobDesc& logical_blob_desc) = 0;
+                   const LogicalBlobId& lbi, const BlobDesc& logical_blob_desc,
+                   const BoxingTaskNodeStat& stat) = 0;
 };
 
 class NullBoxingLogger final : public BoxingLogger {
@@ -46,7 +60,7 @@ class NullBoxingLogger final : public BoxingLogger {
            const ParallelDesc& dst_parallel_desc,
            const cfg::ParallelDistribution& src_parallel_distribution,
            const cfg::ParallelDistribution& dst_parallel_distribution, const LogicalBlobId& lbi,
-           const BlobDesc& logical_blob_desc) override{};
+           const BlobDesc& logical_blob_desc, const BoxingTaskNodeStat& stat) override{};
 };
 
 class CsvBoxingLogger final : public BoxingLogger {
@@ -61,7 +75,7 @@ class CsvBoxingLogger final : public BoxingLogger {
            const ParallelDesc& dst_parallel_desc,
            const cfg::ParallelDistribution& src_parallel_distribution,
            const cfg::ParallelDistribution& dst_parallel_distribution, const LogicalBlobId& lbi,
-           const BlobDesc& logical_blob_desc) override;
+           const BlobDesc& logical_blob_desc, const BoxingTaskNodeStat& stat) override;
 
  private:
   std::unique_ptr<TeePersistentLogStream> log_stream_;
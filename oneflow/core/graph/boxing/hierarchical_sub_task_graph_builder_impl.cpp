@@ -385,6 +385,91 @@ class Dim0ParallelDistributionMismatchedSubTskGphBuilder final
   std::unique_ptr<InterGroupSubTskGphBuilder> inter_group_sub_tsk_gph_builder_;
 };
 
+// Boxes a 2D transition in which both axes change as an intra-group step on axis 1 and an
+// inter-group step on axis 0, in whichever order both steps support, so each step reuses the 1D
+// builders, e.g. NCCL all-to-all for S(i)->S(j).
+class BothDimsParallelDistributionMismatchedSubTskGphBuilder final
+    : public HierarchicalSubTskGphBuilder {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(BothDimsParallelDistributionMismatchedSubTskGphBuilder);
+  BothDimsParallelDistributionMismatchedSubTskGphBuilder() {
+    intra_group_sub_tsk_gph_builder_.reset(new IntraGroupSubTskGphBuilder());
+    dim0_parallel_distribution_mismatched_sub_tsk_gph_builder_.reset(
+        new Dim0ParallelDistributionMismatchedSubTskGphBuilder());
+  }
+  ~BothDimsParallelDistributionMismatchedSubTskGphBuilder() override = default;
+
+  Maybe<SubTskGphBuilderStatus> Build(SubTskGphBuilderCtx* ctx,
+                                      const std::vector<TaskNode*>& sorted_in_tasks,
+                                      std::vector<TaskNode*>* sorted_out_tasks,
+                                      std::vector<std::vector<TaskNode*>>* sorted_ctrl_tasks,
+                                      const ParallelDesc& in_parallel_desc,
+                                      const ParallelDesc& out_parallel_desc,
+                                      const LogicalBlobId& lbi, const BlobDesc& logical_blob_desc,
+                                      const cfg::ParallelDistribution& in_parallel_distribution,
+                                      const cfg::ParallelDistribution& out_parallel_distribution,
+                                      const Shape& time_shape) const override {
+    if (!(in_parallel_desc.hierarchy()->NumAxes() == 2
+          && (*in_parallel_desc.hierarchy() == *out_parallel_desc.hierarchy())
+          && in_parallel_distribution.sbp_parallel(0) != out_parallel_distribution.sbp_parallel(0)
+          && in_parallel_distribution.sbp_parallel(1)
+                 != out_parallel_distribution.sbp_parallel(1))) {
+      return Error::BoxingNotSupportedError();
+    }
+    // (in0, in1) -> (in0, out1) -> (out0, out1)
+    cfg::ParallelDistribution intra_first;
+    *intra_first.add_sbp_parallel() = in_parallel_distribution.sbp_parallel(0);
+    *intra_first.add_sbp_parallel() = out_parallel_distribution.sbp_parallel(1);
+    // (in0, in1) -> (out0, in1) -> (out0, out1)
+    cfg::ParallelDistribution inter_first;
+    *inter_first.add_sbp_parallel() = out_parallel_distribution.sbp_parallel(0);
+    *inter_first.add_sbp_parallel() = in_parallel_distribution.sbp_parallel(1);
+    std::vector<const HierarchicalSubTskGphBuilder*> steps;
+    std::vector<cfg::ParallelDistribution> parallel_distributions;
+    parallel_distributions.push_back(in_parallel_distribution);
+    // the inter-group step cannot box from or to an all-same-split distribution
+    if (!ParallelDistributionAllSameSplitParallel(intra_first)
+        && !ParallelDistributionAllSameSplitParallel(out_parallel_distribution)) {
+      steps.push_back(intra_group_sub_tsk_gph_builder_.get());
+      steps.push_back(dim0_parallel_distribution_mismatched_sub_tsk_gph_builder_.get());
+      parallel_distributions.push_back(intra_first);
+    } else if (!ParallelDistributionAllSameSplitParallel(in_parallel_distribution)
+               && !ParallelDistributionAllSameSplitParallel(inter_first)) {
+      steps.push_back(dim0_parallel_distribution_mismatched_sub_tsk_gph_builder_.get());
+      steps.push_back(intra_group_sub_tsk_gph_builder_.get());
+      parallel_distributions.push_back(inter_first);
+    } else {
+      return Error::BoxingNotSupportedError();
+    }
+    parallel_distributions.push_back(out_parallel_distribution);
+    std::vector<SubTskGphBuilderStatus> status;
+    std::vector<TaskNode*> in_tasks = sorted_in_tasks;
+    sorted_ctrl_tasks->resize(out_parallel_desc.parallel_num());
+    FOR_RANGE(int64_t, i, 0, steps.size()) {
+      std::vector<TaskNode*> out_tasks;
+      std::vector<std::vector<TaskNode*>> ctrl_tasks;
+      status.push_back(*JUST(steps.at(i)->Build(
+          ctx, in_tasks, &out_tasks, &ctrl_tasks, i == 0 ? in_parallel_desc : out_parallel_desc,
+          out_parallel_desc, lbi, logical_blob_desc, parallel_distributions.at(i),
+          parallel_distributions.at(i + 1), time_shape)));
+      CHECK_EQ_OR_RETURN(out_tasks.size(), out_parallel_desc.parallel_num());
+      FOR_RANGE(int64_t, j, 0, ctrl_tasks.size()) {
+        for (TaskNode* ctrl_node : ctrl_tasks.at(j)) {
+          sorted_ctrl_tasks->at(j).push_back(ctrl_node);
+        }
+      }
+      in_tasks.swap(out_tasks);
+    }
+    *sorted_out_tasks = in_tasks;
+    return MakeComposedSubTskGphBuilderStatus(status);
+  }
+
+ private:
+  std::unique_ptr<IntraGroupSubTskGphBuilder> intra_group_sub_tsk_gph_builder_;
+  std::unique_ptr<Dim0ParallelDistributionMismatchedSubTskGphBuilder>
+      dim0_parallel_distribution_mismatched_sub_tsk_gph_builder_;
+};
+
 class Same2DHierarchySubTskGphBuilder final : public HierarchicalSubTskGphBuilder {
  public:
   OF_DISALLOW_COPY_AND_MOVE(Same2DHierarchySubTskGphBuilder);
@@ -392,6 +477,8 @@ class Same2DHierarchySubTskGphBuilder final : public HierarchicalSubTskGphBuilde
     intra_group_sub_tsk_gph_builder_.reset(new IntraGroupSubTskGphBuilder());
     dim0_parallel_distribution_mismatched_sub_tsk_gph_builder_.reset(
         new Dim0ParallelDistributionMismatchedSubTskGphBuilder());
+    both_dims_parallel_distribution_mismatched_sub_tsk_gph_builder_.reset(
+        new BothDimsParallelDistributionMismatchedSubTskGphBuilder());
   }
   ~Same2DHierarchySubTskGphBuilder() override = default;
 
@@ -419,7 +506,10 @@ class Same2DHierarchySubTskGphBuilder final : public HierarchicalSubTskGphBuilde
             out_parallel_desc, lbi, logical_blob_desc, in_parallel_distribution,
             out_parallel_distribution, time_shape);
       } else {
-        return Error::BoxingNotSupportedError();
+        return both_dims_parallel_distribution_mismatched_sub_tsk_gph_builder_->Build(
+            ctx, sorted_in_tasks, sorted_out_tasks, sorted_ctrl_tasks, in_parallel_desc,
+            out_parallel_desc, lbi, logical_blob_desc, in_parallel_distribution,
+            out_parallel_distribution, time_shape);
       }
     } else {
       return Error::BoxingNotSupportedError();
@@ -430,6 +520,8 @@ class Same2DHierarchySubTskGphBuilder final : public HierarchicalSubTskGphBuilde
   std::unique_ptr<IntraGroupSubTskGphBuilder> intra_group_sub_tsk_gph_builder_;
   std::unique_ptr<Dim0ParallelDistributionMismatchedSubTskGphBuilder>
       dim0_parallel_distribution_mismatched_sub_tsk_gph_builder_;
+  std::unique_ptr<BothDimsParallelDistributionMismatchedSubTskGphBuilder>
+      both_dims_parallel_distribution_mismatched_sub_tsk_gph_builder_;
 };
 
 class ExpandToSame2DHierarchySubTskGphBuilder final : public HierarchicalSubTskGphBuilder {
@@ -487,9 +579,106 @@ class ExpandToSame2DHierarchySubTskGphBuilder final : public HierarchicalSubTskG
   std::unique_ptr<Same2DHierarchySubTskGphBuilder> same_2d_hierarchy_sub_tsk_gph_builder_;
 };
 
+// Splits a multi-node all-reduce into intra-node reduce-scatter, inter-node all-reduce on 1/N of
+// the data and intra-node all-gather, where N is the number of devices per node, by boxing over a
+// (num_nodes, num_devices_per_node) view of the 1D placement.
+class HierarchicalAllReduceSubTskGphBuilder final : public HierarchicalSubTskGphBuilder {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(HierarchicalAllReduceSubTskGphBuilder);
+  HierarchicalAllReduceSubTskGphBuilder() {
+    same_2d_hierarchy_sub_tsk_gph_builder_.reset(new Same2DHierarchySubTskGphBuilder());
+  }
+  ~HierarchicalAllReduceSubTskGphBuilder() override = default;
+
+  Maybe<SubTskGphBuilderStatus> Build(SubTskGphBuilderCtx* ctx,
+                                      const std::vector<TaskNode*>& sorted_in_tasks,
+                                      std::vector<TaskNode*>* sorted_out_tasks,
+                                      std::vector<std::vector<TaskNode*>>* sorted_ctrl_tasks,
+                                      const ParallelDesc& in_parallel_desc,
+                                      const ParallelDesc& out_parallel_desc,
+                                      const LogicalBlobId& lbi, const BlobDesc& logical_blob_desc,
+                                      const cfg::ParallelDistribution& in_parallel_distribution,
+                                      const cfg::ParallelDistribution& out_parallel_distribution,
+                                      const Shape& time_shape) const override {
+    const int64_t num_devices_per_node = NumDevicesPerNode(in_parallel_desc);
+    if (in_parallel_desc.hierarchy()->NumAxes() == 1 && out_parallel_desc.Equals(in_parallel_desc)
+        && in_parallel_desc.device_type() == DeviceType::kGPU
+        && Global<ResourceDesc, ForSession>::Get()
+               ->collective_boxing_conf()
+               .nccl_enable_hierarchical_all_reduce()
+        && !Global<ResourceDesc, ForSession>::Get()->nccl_use_compute_stream()
+        && GlobalJobDesc().Bool("__is_user_function__") && time_shape.elem_cnt() == 1
+        && num_devices_per_node > 1
+        && SubTskGphBuilderUtil::IsBoxingP2B(in_parallel_distribution.sbp_parallel(0),
+                                             out_parallel_distribution.sbp_parallel(0))
+        && !SubTskGphBuilderUtil::BlobHasDynamicShape(logical_blob_desc)
+        && logical_blob_desc.shape().NumAxes() > 0
+        && logical_blob_desc.shape().At(0) % num_devices_per_node == 0) {
+      ParallelConf parallel_conf = in_parallel_desc.parallel_conf();
+      Shape({in_parallel_desc.parallel_num() / num_devices_per_node, num_devices_per_node})
+          .ToProto(parallel_conf.mutable_hierarchy());
+      const ParallelDesc parallel_desc(parallel_conf);
+      cfg::SbpParallel partial_sum;
+      partial_sum.mutable_partial_sum_parallel();
+      cfg::SbpParallel broadcast;
+      broadcast.mutable_broadcast_parallel();
+      cfg::SbpParallel split;
+      split.mutable_split_parallel()->set_axis(0);
+      std::vector<cfg::ParallelDistribution> parallel_distributions(4);
+      // (P, P) -> (P, S(0)) -> (B, S(0)) -> (B, B)
+      *parallel_distributions.at(0).add_sbp_parallel() = partial_sum;
+      *parallel_distributions.at(0).add_sbp_parallel() = partial_sum;
+      *parallel_distributions.at(1).add_sbp_parallel() = partial_sum;
+      *parallel_distributions.at(1).add_sbp_parallel() = split;
+      *parallel_distributions.at(2).add_sbp_parallel() = broadcast;
+      *parallel_distributions.at(2).add_sbp_parallel() = split;
+      *parallel_distributions.at(3).add_sbp_parallel() = broadcast;
+      *parallel_distributions.at(3).add_sbp_parallel() = broadcast;
+      std::vector<SubTskGphBuilderStatus> status;
+      std::vector<TaskNode*> in_tasks = sorted_in_tasks;
+      sorted_ctrl_tasks->resize(out_parallel_desc.parallel_num());
+      FOR_RANGE(int64_t, i, 0, parallel_distributions.size() - 1) {
+        std::vector<TaskNode*> out_tasks;
+        std::vector<std::vector<TaskNode*>> ctrl_tasks;
+        status.push_back(*JUST(same_2d_hierarchy_sub_tsk_gph_builder_->Build(
+            ctx, in_tasks, &out_tasks, &ctrl_tasks, parallel_desc, parallel_desc, lbi,
+            logical_blob_desc, parallel_distributions.at(i), parallel_distributions.at(i + 1),
+            time_shape)));
+        CHECK_EQ_OR_RETURN(out_tasks.size(), out_parallel_desc.parallel_num());
+        FOR_RANGE(int64_t, j, 0, ctrl_tasks.size()) {
+          for (TaskNode* ctrl_node : ctrl_tasks.at(j)) {
+            sorted_ctrl_tasks->at(j).push_back(ctrl_node);
+          }
+        }
+        in_tasks.swap(out_tasks);
+      }
+      *sorted_out_tasks = in_tasks;
+      return MakeComposedSubTskGphBuilderStatus(status);
+    } else {
+      return Error::BoxingNotSupportedError();
+    }
+  }
+
+ private:
+  // the number of devices on each node if every node holds the same number of devices, else 0
+  static int64_t NumDevicesPerNode(const ParallelDesc& parallel_desc) {
+    const std::vector<int64_t>& machine_ids = parallel_desc.sorted_machine_ids();
+    if (machine_ids.size() <= 1) { return 0; }
+    const int64_t num_devices = parallel_desc.sorted_dev_phy_ids(machine_ids.front()).size();
+    for (const int64_t machine_id : machine_ids) {
+      if (parallel_desc.sorted_dev_phy_ids(machine_id).size() != num_devices) { return 0; }
+    }
+    return num_devices;
+  }
+
+  std::unique_ptr<Same2DHierarchySubTskGphBuilder> same_2d_hierarchy_sub_tsk_gph_builder_;
+};
+
 struct DispatchHierarchicalSubTskGphBuilder::Impl {
   Impl();
   std::unique_ptr<FlatSubTskGphBuilder> flat_sub_tsk_gph_builder_;
+  std::unique_ptr<HierarchicalAllReduceSubTskGphBuilder>
+      hierarchical_all_reduce_sub_tsk_gph_builder_;
   std::unique_ptr<Same2DHierarchySubTskGphBuilder> same_2d_hierarchy_sub_tsk_gph_builder_;
   std::unique_ptr<ExpandToSame2DHierarchySubTskGphBuilder>
       expand_to_same_2d_hierarchy_sub_tsk_gph_builder_;
@@ -497,6 +686,7 @@ struct DispatchHierarchicalSubTskGphBuilder::Impl {
 
 DispatchHierarchicalSubTskGphBuilder::Impl::Impl() {
   flat_sub_tsk_gph_builder_.reset(new FlatSubTskGphBuilder());
+  hierarchical_all_reduce_sub_tsk_gph_builder_.reset(new HierarchicalAllReduceSubTskGphBuilder());
   same_2d_hierarchy_sub_tsk_gph_builder_.reset(new Same2DHierarchySubTskGphBuilder());
   expand_to_same_2d_hierarchy_sub_tsk_gph_builder_.reset(
       new ExpandToSame2DHierarchySubTskGphBuilder());
@@ -527,6 +717,16 @@ Maybe<SubTskGphBuilderStatus> DispatchHierarchicalSubTskGphBuilder::Build(
   const auto& out_hierarchy = reduced_out_parallel_desc.hierarchy();
   if (in_hierarchy->NumAxes() <= 2 && out_hierarchy->NumAxes() <= 2) {
     if (in_hierarchy->NumAxes() == 1 && out_hierarchy->NumAxes() == 1) {
+      Maybe<SubTskGphBuilderStatus> hierarchical_all_reduce_status =
+          TRY(impl_->hierarchical_all_reduce_sub_tsk_gph_builder_->Build(
+              ctx, sorted_in_tasks, sorted_out_tasks, sorted_ctrl_tasks, reduced_in_parallel_desc,
+              reduced_out_parallel_desc, lbi, logical_blob_desc, reduced_in_parallel_distribution,
+              reduced_out_parallel_distribution, time_shape));
+      if (hierarchical_all_reduce_status.IsOk()
+          || !SubTskGphBuilderUtil::IsErrorBoxingNotSupported(
+              *hierarchical_all_reduce_status.error())) {
+        return hierarchical_all_reduce_status;
+      }
       return impl_->flat_sub_tsk_gph_builder_->Build(
           ctx, sorted_in_tasks, sorted_out_tasks, sorted_ctrl_tasks, reduced_in_parallel_desc,
           reduced_out_parallel_desc, lbi, logical_blob_desc, reduced_in_parallel_distribution,
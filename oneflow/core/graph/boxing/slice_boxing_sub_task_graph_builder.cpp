@@ -180,7 +180,8 @@ Maybe<SubTskGphBuilderStatus> SliceBoxingSubTskGphBuilder::Build(
           FOR_RANGE(int64_t, in_id, 0, in_pd.parallel_num()) {
             const TensorSliceView& in_slice = in_slices.at(in_id);
             TaskNode* in_node = in_nodes.at(in_id);
-            if (SubTskGphBuilderUtil::IsOnSameGPU(in_node, out_node)) {
+            if (SubTskGphBuilderUtil::IsOnSameGPU(in_node, out_node)
+                || SubTskGphBuilderUtil::IsOnPeerAccessibleGPUs(in_node, out_node)) {
               out_node->ConnectToSrcNodeWithSlice(in_node, NewEdge(), in_slice);
             } else {
               TaskNode* proxy_node = ctx->task_graph()->GetProxyNode(
@@ -320,7 +321,8 @@ Maybe<SubTskGphBuilderStatus> SliceBoxingSubTskGphBuilder::Build(
             if (out_node->machine_id() == in_machine_id) {
               for (const int64_t in_id : in_parallel_ids) {
                 TaskNode* in_node = in_nodes.at(in_id);
-                if (SubTskGphBuilderUtil::IsOnSameGPU(in_node, out_node)) {
+                if (SubTskGphBuilderUtil::IsOnSameGPU(in_node, out_node)
+                    || SubTskGphBuilderUtil::IsOnPeerAccessibleGPUs(in_node, out_node)) {
                   out_node->ConnectToSrcNodeWithSlice(in_node, NewEdge(), in_slice);
                 } else if (in_pd.device_type() == DeviceType::kGPU) {
                   SliceBoxingTaskNode* copy_to_host =
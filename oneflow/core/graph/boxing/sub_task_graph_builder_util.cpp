@@ -16,6 +16,7 @@ limitations under the License.
 #include "oneflow/core/graph/boxing/sub_task_graph_builder_util.h"
 #include "oneflow/core/common/balanced_splitter.h"
 #include "oneflow/core/common/nd_index_offset_helper.h"
+#include "oneflow/core/device/cuda_util.h"
 
 namespace oneflow {
 
@@ -39,6 +40,16 @@ bool SubTskGphBuilderUtil::IsOnSameGPU(const TaskNode* lhs, const TaskNode* rhs)
          && rhs->device_type() == DeviceType::kGPU && lhs->GpuPhyId() == rhs->GpuPhyId();
 }
 
+bool SubTskGphBuilderUtil::IsOnPeerAccessibleGPUs(const TaskNode* lhs, const TaskNode* rhs) {
+#ifdef WITH_CUDA
+  return lhs->machine_id() == rhs->machine_id() && lhs->device_type() == DeviceType::kGPU
+         && rhs->device_type() == DeviceType::kGPU && lhs->GpuPhyId() != rhs->GpuPhyId()
+         && IsCudaPeerAccessSupported(lhs->GpuPhyId(), rhs->GpuPhyId());
+#else
+  return false;
+#endif
+}
+
 bool SubTskGphBuilderUtil::IsBoxingS2S(const cfg::SbpParallel& src, const cfg::SbpParallel& dst) {
   return src.has_split_parallel() && dst.has_split_parallel();
 }
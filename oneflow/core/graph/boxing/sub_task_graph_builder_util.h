@@ -33,6 +33,8 @@ struct SubTskGphBuilderUtil {
   static bool HasEmptySliceIfSplit(int64_t parallel_num, const cfg::SbpParallel& sbp_parallel,
                                    const BlobDesc& blob_desc);
   static bool IsOnSameGPU(const TaskNode* lhs, const TaskNode* rhs);
+  // different GPUs of one node, rhs can read the memory of lhs directly
+  static bool IsOnPeerAccessibleGPUs(const TaskNode* lhs, const TaskNode* rhs);
   static bool IsBoxingS2S(const cfg::SbpParallel& src, const cfg::SbpParallel& dst);
   static bool IsBoxingS2B(const cfg::SbpParallel& src, const cfg::SbpParallel& dst);
   static bool IsBoxingP2S(const cfg::SbpParallel& src, const cfg::SbpParallel& dst);
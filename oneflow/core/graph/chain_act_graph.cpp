@@ -49,6 +49,11 @@ ChainActNode::ChainActNode(std::pair<int64_t, int64_t> chain_act_id_pair,
   }
 }
 
+double ChainActNode::duration() const {
+  // act events are rebased one after another in the constructor
+  return act_events_.empty() ? 0 : act_events_.back()->stop_time();
+}
+
 void ChainActNode::ForEachInEdge(const std::function<void(const ChainActEdge*)>& Handler) const {
   for (const ChainActEdge* in_edge : in_edges()) { Handler(in_edge); }
 }
@@ -109,6 +114,40 @@ void ChainActSubGraph::ForEachRegstActConsumerPathDuration(
   });
 }
 
+double ChainActSubGraph::CalcCriticalPath(std::vector<const ChainActNode*>* critical_path) const {
+  // the consumer chain may start once the producer chain has run for the edge duration
+  HashMap<const ChainActNode*, double> node2finish_time;
+  HashMap<const ChainActNode*, const ChainActNode*> node2critical_in_node;
+  const ChainActNode* last_node = nullptr;
+  double critical_path_duration = 0;
+  TopoForEachChainActNode([&](const ChainActNode* node) {
+    double start_time = 0;
+    const ChainActNode* critical_in_node = nullptr;
+    node->ForEachInEdge([&](const ChainActEdge* in_edge) {
+      const ChainActNode* in_node = in_edge->src_node();
+      double ready_time = node2finish_time.at(in_node) - in_node->duration() + in_edge->duration();
+      if (critical_in_node == nullptr || ready_time > start_time) {
+        start_time = ready_time;
+        critical_in_node = in_node;
+      }
+    });
+    double finish_time = start_time + node->duration();
+    node2finish_time[node] = finish_time;
+    node2critical_in_node[node] = critical_in_node;
+    if (last_node == nullptr || finish_time > critical_path_duration) {
+      critical_path_duration = finish_time;
+      last_node = node;
+    }
+  });
+  critical_path->clear();
+  for (const ChainActNode* node = last_node; node != nullptr;
+       node = node2critical_in_node.at(node)) {
+    critical_path->push_back(node);
+  }
+  std::reverse(critical_path->begin(), critical_path->end());
+  return critical_path_duration;
+}
+
 void ChainActSubGraph::CalcRegstActNodePathDuration(RegstActGroupCtx* regst_act_group_ctx,
                                                     const ChainActNode* node) const {
   double duration = 0;
@@ -322,6 +361,23 @@ void ChainActGraph::ForEachRegstDescConsumerPathMeanDuration(
   }
 }
 
+void ChainActGraph::ForEachActIdCriticalPath(
+    const std::function<void(int64_t, double, const std::vector<const ChainActNode*>&)>& Handler)
+    const {
+  std::map<int64_t, const ChainActSubGraph*> act_id2sub_graph;
+  ForEachChainActSubGraph([&](const ChainActSubGraph* sub_graph) {
+    // all the nodes of a sub graph share the same act id
+    int64_t act_id = -1;
+    sub_graph->ForEachNode([&](const ChainActNode* node) { act_id = node->act_id(); });
+    if (act_id >= 0) { CHECK(act_id2sub_graph.emplace(act_id, sub_graph).second); }
+  });
+  std::vector<const ChainActNode*> critical_path;
+  for (const auto& pair : act_id2sub_graph) {
+    double duration = pair.second->CalcCriticalPath(&critical_path);
+    Handler(pair.first, duration, critical_path);
+  }
+}
+
 double ChainActGraph::CalcBaseII() const {
   int64_t max_act_cnt = 0;
   HashMap<int64_t, int64_t> actor_id2outputed_act_cnt;
@@ -88,6 +88,7 @@ class ChainActNode final : public Node<ChainActNode, ChainActEdge> {
   // Getters
   int64_t act_id() const { return chain_act_id_pair_.second; }
   int64_t chain_id() const { return chain_act_id_pair_.first; }
+  double duration() const;
 
   // Adds
   void AddProducedRegstAct(std::unique_ptr<RegstAct>&& regst_act);
@@ -122,6 +123,10 @@ class ChainActSubGraph final : public Graph<const ChainActNode, const ChainActEd
   void ForEachRegstActConsumerPathDuration(
       const std::function<void(int64_t, int64_t, double)>& Handler) const;
 
+  // Returns the duration of the longest dependency path through the chain acts and puts the nodes
+  // on that path to `critical_path' in topological order
+  double CalcCriticalPath(std::vector<const ChainActNode*>* critical_path) const;
+
  private:
   std::function<int64_t(const ChainActNode*)> MakeGetterTopoOrderValue4Node() const;
   const ChainActNode* Node4ActEvent(const ActEvent* act_event) const;
@@ -161,6 +166,10 @@ class ChainActGraph final {
       const std::function<void(int64_t, int64_t, double)>& Handler) const;
   void ForEachRegstDescConsumerPathIIScale(
       const std::function<void(int64_t, int64_t, double)>& Handler) const;
+  // Handler(act_id, critical_path_duration, critical_path) for every act id, in act id order
+  void ForEachActIdCriticalPath(
+      const std::function<void(int64_t, double, const std::vector<const ChainActNode*>&)>& Handler)
+      const;
 
   double CalcBaseII() const;
 
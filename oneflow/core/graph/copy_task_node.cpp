@@ -50,7 +50,8 @@ void CopyHdTaskNode::Init(CopyHdOpConf::Type copy_type, int64_t machine_id, int6
   auto* stream_index_generator =
       Global<IDMgr>::Get()->GetStreamIndexGeneratorManager()->GetGenerator(device_id);
   StreamId::stream_index_t stream_index = 0;
-  if (copy_type == CopyHdOpConf::H2D) {
+  if (copy_type == CopyHdOpConf::H2D || copy_type == CopyHdOpConf::D2D) {
+    // a peer copy is pulled by the dst device, on its incoming copy stream
     stream_index = stream_index_generator->GenerateH2DStreamIndex();
   } else if (copy_type == CopyHdOpConf::D2H) {
     stream_index = stream_index_generator->GenerateD2HStreamIndex();
@@ -62,7 +63,7 @@ void CopyHdTaskNode::Init(CopyHdOpConf::Type copy_type, int64_t machine_id, int6
 }
 
 void CopyHdTaskNode::InitProducedRegstMemCase(MemoryCase* mem_case) {
-  if (copy_type_ == CopyHdOpConf::H2D) {
+  if (copy_type_ == CopyHdOpConf::H2D || copy_type_ == CopyHdOpConf::D2D) {
     TaskNode::InitProducedRegstMemCase(mem_case);
   } else if (copy_type_ == CopyHdOpConf::D2H) {
     mem_case->mutable_host_mem()->mutable_cuda_pinned_mem()->set_device_id(GpuPhyId());
@@ -95,6 +96,22 @@ void CopyCommNetTaskNode::Init(int64_t machine_id, const LogicalBlobId& lbi) {
   StreamId stream_id{device_id, generator->GenerateCommNetStreamIndex()};
   set_thrd_id(SerializeStreamIdToInt64(stream_id));
   set_lbi(lbi);
+  dst_mem_zone_id_ = GetNodeCPUMemZoneId(machine_id);
+}
+
+void CopyCommNetTaskNode::Init(const MemZoneId& dst_mem_zone_id, const LogicalBlobId& lbi) {
+  Init(dst_mem_zone_id.node_index(), lbi);
+  dst_mem_zone_id_ = dst_mem_zone_id;
+}
+
+void CopyCommNetTaskNode::InitProducedRegstMemCase(MemoryCase* mem_case) {
+  if (dst_mem_zone_id_.device_type() == DeviceType::kCPU) {
+    mem_case->mutable_host_mem();
+  } else if (dst_mem_zone_id_.device_type() == DeviceType::kGPU) {
+    mem_case->mutable_device_cuda_mem()->set_device_id(dst_mem_zone_id_.device_index());
+  } else {
+    UNIMPLEMENTED();
+  }
 }
 
 OperatorConf CopyCommNetTaskNode::NewCopyOpConf() {
@@ -49,7 +49,7 @@ class CopyHdTaskNode final : public CopyTaskNode {
 
   CopyHdOpConf::Type copy_type() const { return copy_type_; }
   MemZoneId MemZoneId121() const override {
-    if (copy_type_ == CopyHdOpConf::H2D) {
+    if (copy_type_ == CopyHdOpConf::H2D || copy_type_ == CopyHdOpConf::D2D) {
       return TaskNode::MemZoneId121();
     } else if (copy_type_ == CopyHdOpConf::D2H) {
       return GetNodeCPUMemZoneId(this->machine_id());
@@ -75,9 +75,17 @@ class CopyCommNetTaskNode final : public CopyTaskNode {
   TaskType GetTaskType() const override { return TaskType::kCopyCommNet; }
 
   void Init(int64_t machine_id, const LogicalBlobId& lbi);
+  // reads straight into the device memory of `dst_mem_zone_id', requires
+  // CommNet::IsDeviceMemorySupported
+  void Init(const MemZoneId& dst_mem_zone_id, const LogicalBlobId& lbi);
+
+  MemZoneId MemZoneId121() const override { return dst_mem_zone_id_; }
 
  private:
+  void InitProducedRegstMemCase(MemoryCase*) override;
   OperatorConf NewCopyOpConf() override;
+
+  MemZoneId dst_mem_zone_id_;
 };
 
 }  // namespace oneflow
@@ -21,6 +21,7 @@ limitations under the License.
 #include "oneflow/core/common/str_util.h"
 #include "oneflow/core/graph/node.h"
 #include "oneflow/core/persistence/tee_persistent_log_stream.h"
+#include "oneflow/core/thread/thread_pool.h"
 
 namespace oneflow {
 
@@ -38,6 +39,13 @@ class Graph {
   Maybe<void> TopoForEachNodeWithErrorCaptured(
       std::function<Maybe<void>(NodeType*)> NodeHandler) const;
   void ReverseTopoForEachNode(std::function<void(NodeType*)> NodeHandler) const;
+  // Handles nodes level by level in topological order. A level only depends on the former levels,
+  // so its nodes are handled concurrently on `thread_pool' and NodeHandler must be thread safe
+  // among them. Handles nodes sequentially if `thread_pool' is nullptr.
+  void LevelTopoForEachNode(ThreadPool* thread_pool,
+                            std::function<void(NodeType*)> NodeHandler) const;
+  Maybe<void> LevelTopoForEachNodeWithErrorCaptured(
+      ThreadPool* thread_pool, std::function<Maybe<void>(NodeType*)> NodeHandler) const;
   void ForEachEdge(std::function<void(EdgeType*)> EdgeHandler) const;
 
   void SortedTopoForEachNode(std::function<bool(const EdgeType* lhs, const EdgeType* rhs)> LessThan,
@@ -129,6 +137,7 @@ class Graph {
   void AddAllocatedNode(NodeType*);
   void AddAllocatedEdge(EdgeType*);
   void DeleteNode(NodeType*);
+  void DeleteEdge(EdgeType*);
 
   // ToDot
   template<typename StreamT>
@@ -240,6 +249,54 @@ void Graph<NodeType, EdgeType>::ReverseTopoForEachNode(
                   NodeHandler);
 }
 
+template<typename NodeType, typename EdgeType>
+void Graph<NodeType, EdgeType>::LevelTopoForEachNode(
+    ThreadPool* thread_pool, std::function<void(NodeType*)> NodeHandler) const {
+  CHECK_JUST(LevelTopoForEachNodeWithErrorCaptured(thread_pool, [&](NodeType* node) -> Maybe<void> {
+    NodeHandler(node);
+    return Maybe<void>::Ok();
+  }));
+}
+
+template<typename NodeType, typename EdgeType>
+Maybe<void> Graph<NodeType, EdgeType>::LevelTopoForEachNodeWithErrorCaptured(
+    ThreadPool* thread_pool, std::function<Maybe<void>(NodeType*)> NodeHandler) const {
+  HashMap<NodeType*, int64_t> node2unhandled_in_cnt;
+  std::vector<NodeType*> level;
+  ForEachNode([&](NodeType* node) {
+    int64_t in_cnt = 0;
+    node->ForEachNodeOnInEdge([&](NodeType*) { ++in_cnt; });
+    if (in_cnt == 0) {
+      level.push_back(node);
+    } else {
+      node2unhandled_in_cnt[node] = in_cnt;
+    }
+  });
+  int64_t handled_cnt = 0;
+  while (!level.empty()) {
+    if (thread_pool == nullptr || level.size() == 1) {
+      for (NodeType* node : level) { JUST(NodeHandler(node)); }
+    } else {
+      std::vector<Maybe<void>> rets(level.size(), Maybe<void>::Ok());
+      thread_pool->ParallelFor(Range(0, level.size()), 1, [&](const Range& range) {
+        FOR_RANGE(int64_t, i, range.begin(), range.end()) { rets.at(i) = NodeHandler(level.at(i)); }
+      });
+      // report the first error in node order, as the sequential traversal would
+      for (const auto& ret : rets) { JUST(ret); }
+    }
+    handled_cnt += level.size();
+    std::vector<NodeType*> next_level;
+    for (NodeType* node : level) {
+      node->ForEachNodeOnOutEdge([&](NodeType* out) {
+        if (--node2unhandled_in_cnt.at(out) == 0) { next_level.push_back(out); }
+      });
+    }
+    level.swap(next_level);
+  }
+  CHECK_EQ_OR_RETURN(handled_cnt, node_num()) << "graph is not a DAG";
+  return Maybe<void>::Ok();
+}
+
 template<typename NodeType, typename EdgeType>
 void Graph<NodeType, EdgeType>::ForEachEdge(std::function<void(EdgeType*)> EdgeHandler) const {
   for (auto& x : edges_) {
@@ -286,6 +343,12 @@ void Graph<NodeType, EdgeType>::DeleteNode(NodeType* node) {
       nodes_, [node](const std::unique_ptr<NodeType>& node_ptr) { return node_ptr.get() == node; });
 }
 
+template<typename NodeType, typename EdgeType>
+void Graph<NodeType, EdgeType>::DeleteEdge(EdgeType* edge) {
+  Erase<std::vector<std::unique_ptr<EdgeType>>>(
+      edges_, [edge](const std::unique_ptr<EdgeType>& edge_ptr) { return edge_ptr.get() == edge; });
+}
+
 template<typename NodeType, typename EdgeType>
 template<typename StreamT>
 void Graph<NodeType, EdgeType>::ToDotWithStream(StreamT& out_stream) const {
@@ -0,0 +1,107 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "gtest/gtest.h"
+#include "oneflow/core/graph/graph.h"
+
+namespace oneflow {
+
+namespace test {
+
+namespace {
+
+class TestEdge;
+
+class TestNode final : public Node<TestNode, TestEdge> {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(TestNode);
+  TestNode() : handled(false) {}
+  ~TestNode() override = default;
+
+  std::atomic<bool> handled;
+};
+
+class TestEdge final : public Edge<TestNode, TestEdge> {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(TestEdge);
+  TestEdge() = default;
+  ~TestEdge() override = default;
+};
+
+class TestGraph final : public Graph<TestNode, TestEdge> {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(TestGraph);
+  // `width' chains of `depth' nodes, each node also depends on the previous node of the next chain
+  TestGraph(int64_t width, int64_t depth) {
+    std::vector<std::vector<TestNode*>> chains(width);
+    for (auto& chain : chains) {
+      for (int64_t i = 0; i < depth; ++i) { chain.push_back(NewNode()); }
+    }
+    for (int64_t w = 0; w < width; ++w) {
+      for (int64_t i = 1; i < depth; ++i) {
+        Connect(chains.at(w).at(i - 1), NewEdge(), chains.at(w).at(i));
+        Connect(chains.at((w + 1) % width).at(i - 1), NewEdge(), chains.at(w).at(i));
+      }
+    }
+  }
+  ~TestGraph() override = default;
+};
+
+}  // namespace
+
+TEST(Graph, level_topo_for_each_node) {
+  TestGraph graph(16, 64);
+  ThreadPool thread_pool(4);
+  std::atomic<int64_t> handled_cnt(0);
+  graph.LevelTopoForEachNode(&thread_pool, [&](TestNode* node) {
+    node->ForEachNodeOnInEdge([&](TestNode* in) { ASSERT_TRUE(in->handled); });
+    ASSERT_FALSE(node->handled);
+    node->handled = true;
+    ++handled_cnt;
+  });
+  ASSERT_EQ(handled_cnt, graph.node_num());
+}
+
+TEST(Graph, level_topo_for_each_node_with_error_captured) {
+  TestGraph graph(8, 8);
+  ThreadPool thread_pool(4);
+  std::atomic<int64_t> handled_cnt(0);
+  const auto& maybe = graph.LevelTopoForEachNodeWithErrorCaptured(
+      &thread_pool, [&](TestNode* node) -> Maybe<void> {
+        int64_t in_cnt = 0;
+        node->ForEachNodeOnInEdge([&](TestNode*) { ++in_cnt; });
+        ++handled_cnt;
+        CHECK_EQ_OR_RETURN(in_cnt, 0);
+        return Maybe<void>::Ok();
+      });
+  ASSERT_FALSE(maybe.IsOk());
+  // the traversal stops after the first failed level
+  ASSERT_EQ(handled_cnt, 16);
+}
+
+TEST(Graph, level_topo_for_each_node_sequential) {
+  TestGraph graph(4, 4);
+  int64_t handled_cnt = 0;
+  graph.LevelTopoForEachNode(nullptr, [&](TestNode* node) {
+    node->ForEachNodeOnInEdge([&](TestNode* in) { ASSERT_TRUE(in->handled); });
+    node->handled = true;
+    ++handled_cnt;
+  });
+  ASSERT_EQ(handled_cnt, graph.node_num());
+}
+
+}  // namespace test
+
+}  // namespace oneflow
@@ -13,17 +13,19 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 */
+#include <atomic>
 #include "oneflow/core/graph/node.h"
 
 namespace oneflow {
 
+// nodes of different graphs may be created concurrently, e.g. exec graphs of task nodes
 int64_t NewNodeId() {
-  static int64_t node_id = 0;
+  static std::atomic<int64_t> node_id(0);
   return node_id++;
 }
 
 int64_t NewEdgeId() {
-  static int64_t edge_id = 0;
+  static std::atomic<int64_t> edge_id(0);
   return edge_id++;
 }
 
@@ -31,12 +31,19 @@ class NormalForwardCompTaskNode final : public CompTaskNode {
 
   TaskType GetTaskType() const override { return TaskType::kNormalForward; }
 
+  // chain merging: the ops of the fused nodes run ahead of op() in this task
+  bool IsFusible() const;
+  void FuseOpNodesOf(const NormalForwardCompTaskNode& src);
+  const std::vector<const OpNode*>& fused_op_nodes() const { return fused_op_nodes_; }
+
  private:
   void ProduceOutRegstByNameAndBlockNum(const std::string& name, size_t mem_block_num);
   void BuildExecGphAndRegst() override;
   void BuildExecGphStructAndBindInRegst();
   void BuildOutRegst();
   void BuildTmp7BufRegsts();
+
+  std::vector<const OpNode*> fused_op_nodes_;
 };
 
 }  // namespace oneflow
@@ -20,6 +20,12 @@ limitations under the License.
 
 namespace oneflow {
 
+ThreadPool* CompileThreadPool() {
+  static const bool enable_parallel = ParseBooleanFromEnv("ONEFLOW_COMPILE_PARALLEL", true);
+  if (!enable_parallel || Global<ThreadPool>::Get() == nullptr) { return nullptr; }
+  return Global<ThreadPool>::Get();
+}
+
 std::string OpEdge::VisualStr() const {
   std::string str;
   int32_t idx = 0;
@@ -286,7 +292,7 @@ void OpGraph::InferBlobLastUsed() const {
 }
 
 void OpGraph::InferTimeShape() const {
-  TopoForEachNode([&](OpNode* op_node) {
+  LevelTopoForEachNode(CompileThreadPool(), [&](OpNode* op_node) {
     auto GetInputBlobTimeShape = [&](int32_t index) -> Maybe<const Shape> {
       CHECK_LT_OR_RETURN(index, op_node->input_index2producer_and_output_index_.size());
       return op_node->input_index2producer_and_output_index_.at(index).first->op().GetOpTimeShape();
@@ -354,7 +360,8 @@ const OpNode* OpGraph::OpNode4OpName(const std::string& op_name) const {
 
 Maybe<void> OpGraph::InferLogicalBlobDesc(const Job& job) const {
   JobParallelViewConf job_parallel_view_conf(job.job_parallel_view_conf());
-  JUST(TopoForEachNodeWithErrorCaptured([&](OpNode* op_node) -> Maybe<void> {
+  ThreadPool* thread_pool = CompileThreadPool();
+  JUST(LevelTopoForEachNodeWithErrorCaptured(thread_pool, [&](OpNode* op_node) -> Maybe<void> {
     auto LogicalBlobDesc4InputIndex = [&](int32_t index) -> Maybe<const BlobDesc> {
       CHECK_LT_OR_RETURN(index, op_node->input_index2producer_and_output_index_.size());
       const auto& producer_info = op_node->input_index2producer_and_output_index_.at(index);
@@ -151,6 +151,10 @@ class OpGraph final : public Graph<OpNode, OpEdge> {
   HashMap<std::string, HashSet<std::string>> producer_op_name2ctrl_consumer_op_names_;
 };
 
+// Thread pool of the level parallel compilation passes, nullptr to run them sequentially, which is
+// the case when ONEFLOW_COMPILE_PARALLEL is false
+ThreadPool* CompileThreadPool();
+
 }  // namespace oneflow
 
 #endif  // ONEFLOW_CORE_GRAPH_OP_GRAPH_H_
@@ -29,11 +29,34 @@ limitations under the License.
 #include "oneflow/core/graph/boxing/sub_task_graph_builder_util.h"
 #include "oneflow/core/graph/boxing/hierarchical_sub_task_graph_builder_impl.h"
 #include "oneflow/core/graph/stream_index_getter_registry_manager.h"
+#include "oneflow/core/device/cuda_stream_index.h"
+#include "oneflow/core/job/id_manager.h"
+#include "oneflow/core/comm_network/comm_network.h"
+#include "oneflow/core/device/cuda_util.h"
 
 namespace oneflow {
 
 namespace {
 
+bool IsGpuDirectCommNetAvailable(const LogicalBlobId& lbi) {
+  if (Global<CommNet>::Get() == nullptr || !Global<CommNet>::Get()->IsDeviceMemorySupported()) {
+    return false;
+  }
+  // device-resident registers keep a separated header on the host which CommNet does not read,
+  // so only static headers can go over the wire
+  return !Global<OpGraph>::Get()->GetLogicalBlobDesc(lbi).is_dynamic();
+}
+
+bool IsCudaPeerAccessAvailable(const MemZoneId& src_mem_zone_id,
+                               const MemZoneId& dst_mem_zone_id) {
+#ifdef WITH_CUDA
+  return IsCudaPeerAccessSupported(src_mem_zone_id.device_index(),
+                                   dst_mem_zone_id.device_index());
+#else
+  return false;
+#endif
+}
+
 bool IsInterfaceTask(const TaskNode* node) {
   const auto* comp_task_node = dynamic_cast<const CompTaskNode*>(node);
   if (comp_task_node == nullptr) { return false; }
@@ -157,6 +180,24 @@ void TraverseConnectedSubGraphMergeInThisChain(TaskNode* this_node, const int64_
   }
 }
 
+bool CanBeMergedInActor(const TaskNode* node) {
+  const auto* fw_comp_node = dynamic_cast<const NormalForwardCompTaskNode*>(node);
+  if (fw_comp_node == nullptr) { return false; }
+  if (IsInterfaceTask(node) || IsConnectToTickOp(node)) { return false; }
+  if (IsSpecialOpNotConsiderMergeInChain(fw_comp_node->op().get())) { return false; }
+  return fw_comp_node->IsFusible();
+}
+
+// a comm task takes about as long as a few compute tasks, so the tasks feeding it are dispatched
+// ahead of the compute it can overlap with
+int64_t SchedulePriorityWeight4TaskNode(const TaskNode* node) {
+  const TaskType task_type = node->GetTaskType();
+  if (task_type == TaskType::kCopyCommNet || task_type == TaskType::kCollectiveBoxingGeneric) {
+    return 4;
+  }
+  return 1;
+}
+
 std::function<TaskNode*(const std::string&)> MakeGetterTaskNode4SoleOpName(
     const HashSet<TaskNode*>& task_nodes) {
   auto op_name2task_nodes = std::make_shared<HashMap<std::string, HashSet<TaskNode*>>>();
@@ -250,6 +291,32 @@ std::unique_ptr<BoxingLogger> CreateBoxingLogger() {
   }
 }
 
+// the task nodes between the src comp tasks and `out_nodes'
+BoxingTaskNodeStat MakeBoxingTaskNodeStat(const std::vector<TaskNode*>& out_nodes) {
+  BoxingTaskNodeStat stat;
+  HashSet<TaskNode*> visited_nodes;
+  std::queue<TaskNode*> queued_nodes;
+  for (TaskNode* out_node : out_nodes) {
+    if (visited_nodes.insert(out_node).second) { queued_nodes.push(out_node); }
+  }
+  while (!queued_nodes.empty()) {
+    TaskNode* cur_node = queued_nodes.front();
+    queued_nodes.pop();
+    if (dynamic_cast<CompTaskNode*>(cur_node) != nullptr) { continue; }
+    stat.num_task_nodes += 1;
+    const TaskType task_type = cur_node->GetTaskType();
+    if (task_type == TaskType::kCopyHd || task_type == TaskType::kCopyCommNet) {
+      stat.num_copy_task_nodes += 1;
+    }
+    stat.max_fan_in = std::max<int64_t>(stat.max_fan_in, cur_node->in_edges().size());
+    stat.max_fan_out = std::max<int64_t>(stat.max_fan_out, cur_node->out_edges().size());
+    cur_node->ForEachNodeOnInEdge([&](TaskNode* in_node) {
+      if (visited_nodes.insert(in_node).second) { queued_nodes.push(in_node); }
+    });
+  }
+  return stat;
+}
+
 Maybe<void> MakeGetterTaskNode4MachineId7ThrdId(
     const std::vector<CompTaskNode*>& task_nodes,
     std::function<Maybe<CompTaskNode*>(int64_t mchn_id, int64_t thrd_id)>* Getter) {
@@ -291,6 +358,15 @@ void GenSortedCompTaskNodes(const OpNode* op_node, std::vector<CompTaskNode*>* s
       } else {
         stream_index = StreamIndexGetterRegistryManager::Get().StreamIndex4DeviceIdAndTaskType(
             device_id, comp_task_node->GetTaskType());
+        if (parallel_desc.device_type() == DeviceType::kGPU
+            && GlobalJobDesc().job_conf().enable_concurrent_execution()) {
+          auto* generator = dynamic_cast<CudaStreamIndexGenerator*>(
+              Global<IDMgr>::Get()->GetStreamIndexGeneratorManager()->GetGenerator(device_id));
+          CHECK_NOTNULL(generator);
+          if (stream_index == generator->GenerateComputeStreamIndex()) {
+            stream_index = generator->GenerateInstanceComputeStreamIndex(GlobalJobDesc().job_id());
+          }
+        }
       }
       comp_task_node->set_thrd_id(SerializeStreamIdToInt64(StreamId{device_id, stream_index}));
       comp_task_node->set_op_node(op_node);
@@ -445,7 +521,11 @@ TaskGraph::TaskGraph() {
     }
   });
 
+  if (GlobalJobDesc().enable_actor_chain_merging()) { MergeLinearNormalForwardTaskNodes(); }
   SetOrderInGraphForEachNode();
+  if (Global<ResourceDesc, ForSession>::Get()->thread_enable_priority_dispatch()) {
+    SetSchedulePriorityForEachNode();
+  }
   if (Global<ResourceDesc, ForSession>::Get()->enable_debug_mode()) { ToDotWithAutoFilePath(); }
 }
 
@@ -498,6 +578,27 @@ TaskNode* TaskGraph::GetProxyNode(TaskNode* src_node, const LogicalBlobId& lbi,
         proxy2node[key] = copy_comm_net_task;
         return copy_comm_net_task;
       }
+    } else if (src_mem_zone_id.device_type() == DeviceType::kGPU
+               && src_mem_zone_id.node_index() != dst_mem_zone_id.node_index()
+               && IsGpuDirectCommNetAvailable(lbi)) {
+      CHECK_EQ(dst_mem_zone_id.device_type(), DeviceType::kGPU);
+      // read from the src device straight into the dst device
+      CopyCommNetTaskNode* copy_comm_net_task = NewNode<CopyCommNetTaskNode>();
+      copy_comm_net_task->Init(dst_mem_zone_id, lbi);
+      Connect<TaskNode>(src_node, NewTaskEdgeWithLbi(lbi), copy_comm_net_task);
+      proxy2node[key] = copy_comm_net_task;
+      return copy_comm_net_task;
+    } else if (src_mem_zone_id.device_type() == DeviceType::kGPU
+               && src_mem_zone_id.node_index() == dst_mem_zone_id.node_index()
+               && IsCudaPeerAccessAvailable(src_mem_zone_id, dst_mem_zone_id)) {
+      CHECK_EQ(dst_mem_zone_id.device_type(), DeviceType::kGPU);
+      // the dst device reads the src device directly, without a round trip through the host
+      CopyHdTaskNode* copy_task = NewNode<CopyHdTaskNode>();
+      copy_task->Init(CopyHdOpConf::D2D, dst_mem_zone_id.node_index(),
+                      dst_mem_zone_id.device_index(), lbi);
+      Connect<TaskNode>(src_node, NewTaskEdgeWithLbi(lbi), copy_task);
+      proxy2node[key] = copy_task;
+      return copy_task;
     } else {
       CHECK_EQ(dst_mem_zone_id.device_type(), DeviceType::kGPU);
       TaskNode* proxy_on_dst_host =
@@ -551,6 +652,36 @@ void TaskGraph::MergeChainAndAddOrderingCtrlEdgeInSameChain() {
   BuildCtrlRegstDescInSameChain();
 }
 
+void TaskGraph::MergeLinearNormalForwardTaskNodes() {
+  // a node feeding only the next node, which is fed by nothing else, runs in the actor of that one
+  std::vector<std::pair<NormalForwardCompTaskNode*, NormalForwardCompTaskNode*>> src7dst_nodes;
+  TopoForEachNode([&](TaskNode* node) {
+    if (node->out_edges().size() != 1 || !CanBeMergedInActor(node)) { return; }
+    TaskNode* next_node = node->SoleOutEdge()->dst_node();
+    if (next_node->in_edges().size() != 1 || !CanBeMergedInActor(next_node)) { return; }
+    if (node->GlobalWorkStreamId() != next_node->GlobalWorkStreamId()) { return; }
+    if (*GetTaskNodeTimeShape(node) != *GetTaskNodeTimeShape(next_node)) { return; }
+    src7dst_nodes.emplace_back(dynamic_cast<NormalForwardCompTaskNode*>(node),
+                               dynamic_cast<NormalForwardCompTaskNode*>(next_node));
+  });
+  for (const auto& pair : src7dst_nodes) {
+    NormalForwardCompTaskNode* src_node = pair.first;
+    NormalForwardCompTaskNode* dst_node = pair.second;
+    TaskEdge* edge = src_node->SoleOutEdge();
+    DisConnect(edge);
+    DeleteEdge(edge);
+    const std::vector<TaskEdge*> in_edges(src_node->in_edges().begin(),
+                                          src_node->in_edges().end());
+    for (TaskEdge* in_edge : in_edges) {
+      TaskNode* in_node = in_edge->src_node();
+      DisConnect(in_edge);
+      Connect<TaskNode>(in_node, in_edge, dst_node);
+    }
+    dst_node->FuseOpNodesOf(*src_node);
+    DeleteNode(src_node);
+  }
+}
+
 void TaskGraph::SetOrderInGraphForEachNode() {
   int64_t order_in_graph = 0;
   auto SetOrderInGraph = [&](TaskNode* task_node) {
@@ -561,6 +692,17 @@ void TaskGraph::SetOrderInGraphForEachNode() {
   TopoForEachNode(SetOrderInGraph);
 }
 
+void TaskGraph::SetSchedulePriorityForEachNode() {
+  // the weighted length of the longest path from a node to the end of the job
+  ReverseTopoForEachNode([&](TaskNode* task_node) {
+    int64_t max_out_priority = 0;
+    task_node->ForEachNodeOnOutEdge([&](TaskNode* out_node) {
+      max_out_priority = std::max(max_out_priority, out_node->schedule_priority());
+    });
+    task_node->set_schedule_priority(max_out_priority + SchedulePriorityWeight4TaskNode(task_node));
+  });
+}
+
 void TaskGraph::MergeChain() {
   int64_t chain_id = 0;
   for (auto* this_node : ordered_task_nodes_) {
@@ -728,7 +870,16 @@ DEFINE_BLD_SUB_TASK_GRAPH_METHOD(BldSubTskGphByBoxing) {
         *(CHECK_JUST(src_op_node->op().GetOpTimeShape()).get())));
     boxing_logger_->Log(*status, src_op_node->op().op_name(), dst_op_node->op().op_name(),
                         src_parallel_desc, dst_parallel_desc, src_parallel_distribution,
-                        dst_parallel_distribution, lbi, blob_desc);
+                        dst_parallel_distribution, lbi, blob_desc,
+                        MakeBoxingTaskNodeStat(out_nodes));
+    if (IsSlowBoxingBuilder(status->builder_name())) {
+      LOG(WARNING) << "boxing of " << GenLogicalBlobName(lbi) << " ("
+                   << blob_desc.ByteSizeOfBlobBody() << " bytes) from "
+                   << src_op_node->op().op_name() << " to " << dst_op_node->op().op_name()
+                   << " falls back to " << status->builder_name() << ", "
+                   << ParallelDistributionToString(src_parallel_distribution) << " -> "
+                   << ParallelDistributionToString(dst_parallel_distribution);
+    }
     CHECK_EQ(out_nodes.size(), sorted_dst_comp_tasks.size());
     FOR_RANGE(size_t, i, 0, out_nodes.size()) {
       ConnectWithLbi(out_nodes.at(i), sorted_dst_comp_tasks.at(i), lbi);
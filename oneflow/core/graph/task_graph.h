@@ -81,6 +81,8 @@ class TaskGraph final : public Graph<TaskNode, TaskEdge> {
                         const std::vector<CompTaskNode*>& dst_task_nodes);
 
   void SetOrderInGraphForEachNode();
+  void SetSchedulePriorityForEachNode();
+  void MergeLinearNormalForwardTaskNodes();
   void MergeChain();
   void BuildCtrlRegstDescInSameChain();
 
@@ -55,6 +55,7 @@ class TaskNode : public Node<TaskNode, TaskEdge> {
   int64_t task_id() const { return task_id_; }
   int64_t chain_id() const { return chain_id_; }
   int64_t order_in_graph() const { return order_in_graph_; }
+  int64_t schedule_priority() const { return schedule_priority_; }
   const ExecGraph& exec_gph() const { return exec_gph_; }
   std::shared_ptr<RegstDesc> GetProducedRegst(const std::string& name);
   const std::list<std::shared_ptr<RegstDesc>>& GetConsumedRegst(const std::string& name);
@@ -75,6 +76,7 @@ class TaskNode : public Node<TaskNode, TaskEdge> {
   void set_thrd_id(int64_t val);
   void set_chain_id(int64_t val);
   void set_order_in_graph(int64_t val);
+  void set_schedule_priority(int64_t val) { schedule_priority_ = val; }
 
   // Build
   virtual void ProduceAllRegstsAndBindEdges() = 0;
@@ -151,6 +153,7 @@ class TaskNode : public Node<TaskNode, TaskEdge> {
   int64_t task_id_;
   int64_t chain_id_;
   int64_t order_in_graph_;
+  int64_t schedule_priority_;
 
   ExecGraph exec_gph_;
   HashMap<std::string, std::shared_ptr<RegstDesc>> produced_regsts_;
@@ -36,6 +36,28 @@ std::string GetOutRegstNameByObn(const std::string& obn) { return "__" + obn; }
 
 }  // namespace
 
+bool NormalForwardCompTaskNode::IsFusible() const {
+  const OperatorConf& op_conf = op()->op_conf();
+  if (RegstNum4OpSameOutputBlob(op_conf.op_type_case()) != -1) { return false; }
+  // kernels not launch-synchronized must run alone in their actors
+  if (op_conf.has_sync_dynamic_resize_conf()) { return false; }
+  if (op_conf.has_user_conf()) {
+    const std::string& op_type_name = op_conf.user_conf().op_type_name();
+    const auto* op_reg_result = user_op::UserOpRegistryMgr::Get().GetOpRegistryResult(op_type_name);
+    CHECK(op_reg_result != nullptr) << "op_type_name " << op_type_name << " not register";
+    if (op_reg_result->same_output_regst_num > 0) { return false; }
+    if (op_type_name == "identity_buffer") { return false; }
+  }
+  return true;
+}
+
+void NormalForwardCompTaskNode::FuseOpNodesOf(const NormalForwardCompTaskNode& src) {
+  std::vector<const OpNode*> fused_op_nodes(src.fused_op_nodes());
+  fused_op_nodes.push_back(src.op_node());
+  fused_op_nodes.insert(fused_op_nodes.end(), fused_op_nodes_.begin(), fused_op_nodes_.end());
+  fused_op_nodes_.swap(fused_op_nodes);
+}
+
 void NormalForwardCompTaskNode::ProduceOutRegstByNameAndBlockNum(const std::string& name,
                                                                  size_t mem_block_num) {
   if (mem_block_num != -1) {
@@ -78,6 +100,8 @@ void NormalForwardCompTaskNode::ProduceAllRegstsAndBindEdges() {
     }
   });
   ProduceRegst("tmp", true);
+  // blobs passed between the fused ops never leave this task
+  if (!fused_op_nodes_.empty()) { ProduceRegst("fused", true, 1, 1); }
 }
 
 void NormalForwardCompTaskNode::ConsumeAllRegsts() {
@@ -94,16 +118,43 @@ void NormalForwardCompTaskNode::BuildExecGphAndRegst() {
 }
 
 void NormalForwardCompTaskNode::BuildExecGphStructAndBindInRegst() {
-  ExecNode* cur_node = mut_exec_gph().NewNode();
-  cur_node->mut_op() = op();
+  HashMap<LogicalBlobId, std::pair<ExecNode*, std::string>> lbi2producer;
   const std::list<std::shared_ptr<RegstDesc>>& in_regsts = GetConsumedRegst("in");
-  for (const std::string& ibn : cur_node->op()->input_bns()) {
-    cur_node->BindBnWithOneOfTheRegsts(ibn, in_regsts);
+  const auto NewExecNode = [&](std::shared_ptr<const Operator> cur_op) {
+    ExecNode* cur_node = mut_exec_gph().NewNode();
+    cur_node->mut_op() = cur_op;
+    for (const std::string& ibn : cur_op->input_bns()) {
+      const LogicalBlobId& lbi = cur_op->BnInOp2Lbi(ibn);
+      auto producer_it = lbi2producer.find(lbi);
+      if (producer_it == lbi2producer.end()) {
+        cur_node->BindBnWithOneOfTheRegsts(ibn, in_regsts);
+      } else {
+        ExecEdge* edge = mut_exec_gph().NewEdge();
+        edge->set_lbi(lbi);
+        edge->mut_src_bn() = producer_it->second.second;
+        edge->mut_dst_bn() = ibn;
+        Connect(producer_it->second.first, edge, cur_node);
+        cur_node->BindBnWithRegst(ibn, GetProducedRegst("fused"));
+      }
+    }
+    return cur_node;
+  };
+  for (const OpNode* fused_op_node : fused_op_nodes_) {
+    ExecNode* fused_node = NewExecNode(fused_op_node->shared_op());
+    fused_node->AddBnToRegstAndBindIt(&Operator::output_bns, GetProducedRegst("fused"));
+    for (const std::string& obn : fused_node->op()->output_bns()) {
+      lbi2producer[fused_node->op()->BnInOp2Lbi(obn)] = std::make_pair(fused_node, obn);
+    }
   }
+  NewExecNode(op());
 }
 
 void NormalForwardCompTaskNode::BuildOutRegst() {
-  ExecNode* exec_node = mut_exec_gph().SoleNode();
+  ExecNode* exec_node = nullptr;
+  mut_exec_gph().ForEachNode([&](ExecNode* node) {
+    if (node->op() == op()) { exec_node = node; }
+  });
+  CHECK_NOTNULL(exec_node);
   for (const std::string& obn : exec_node->op()->output_bns()) {
     std::string out_regst_name = GetOutRegstNameByObn(obn);
     std::shared_ptr<RegstDesc> out_regst = GetProducedRegst(out_regst_name);
@@ -23,6 +23,7 @@ limitations under the License.
 #include "oneflow/core/kernel/batch_memcpy_kernel_util.h"
 #include "oneflow/core/job/global_for.h"
 #include "oneflow/core/thread/thread_pool.h"
+#include "oneflow/core/profiler/metrics.h"
 #ifdef WITH_CUDA
 #include <nccl.h>
 #endif
@@ -54,6 +55,34 @@ bool IsDeviceOnThisMachine(const DeviceDesc& device_desc) {
   return device_desc.machine_id() == GlobalProcessCtx::Rank();
 }
 
+int64_t GetWallTimeUs() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+std::string GetArrivalListKey(int64_t job_id, int64_t round, int64_t machine_id) {
+  return "CollectiveBoxingArrival/" + std::to_string(job_id) + "/" + std::to_string(round) + "/"
+         + std::to_string(machine_id);
+}
+
+constexpr int64_t kNumLatenessBuckets = 5;
+constexpr int64_t kNumTopStragglers = 8;
+
+int64_t GetLatenessBucket(int64_t lateness_us) {
+  if (lateness_us < 100) {
+    return 0;
+  } else if (lateness_us < 1000) {
+    return 1;
+  } else if (lateness_us < 10000) {
+    return 2;
+  } else if (lateness_us < 100000) {
+    return 3;
+  } else {
+    return 4;
+  }
+}
+
 bool HasDeviceOnThisMachine(const DeviceSet& device_set) {
   return std::any_of(
       device_set.device().cbegin(), device_set.device().cend(),
@@ -128,13 +157,19 @@ class NcclCollectiveBoxingExecutorBackend : public CollectiveBoxingExecutorBacke
   bool shutdown_;
   std::mutex mutex_;
   std::shared_ptr<ThreadPool> callback_executor_pool_;
+  // from launching a group to observing its completion event, once per device of the group
+  profiler::Histogram* group_time_histogram_;
 
   int64_t current_stream_id_ = 0;
 };
 
 NcclCollectiveBoxingExecutorBackend::NcclCollectiveBoxingExecutorBackend()
     : collective_boxing_conf_(Global<ResourceDesc, ForSession>::Get()->collective_boxing_conf()),
-      shutdown_(false) {
+      shutdown_(false),
+      group_time_histogram_(profiler::GetHistogram(
+          "oneflow_collective_boxing_nccl_group_seconds",
+          "time from launching a nccl collective boxing group to its completion",
+          profiler::DefaultSecondsBuckets())) {
   OF_CUDA_CHECK(cudaGetDeviceCount(&num_devices_));
   callback_executor_pool_.reset(new ThreadPool(num_devices_));
   CHECK_GT(collective_boxing_conf_.nccl_num_streams(), 0);
@@ -204,8 +239,6 @@ NcclCollectiveBoxingExecutorBackend::~NcclCollectiveBoxingExecutorBackend() {
 void NcclCollectiveBoxingExecutorBackend::GroupRequests(
     const std::vector<const RequestDesc*>& requests,
     std::vector<std::vector<const RequestDesc*>>* groups) {
-  std::vector<const RequestDesc*> group;
-  int64_t group_size = 0;
   auto IsOpFusionEnabled = [&](const RequestDesc* request) -> bool {
     const OpType op_type = request->op_desc().op_type();
     if (op_type == OpType::kOpTypeAllReduce) {
@@ -254,22 +287,48 @@ void NcclCollectiveBoxingExecutorBackend::GroupRequests(
     }
   };
 
+  // Requests of the same dependency depth do not depend on each other, so each one is packed into
+  // the first open bucket it can fuse with instead of only into the last one. Interleaved requests
+  // of different data types, e.g. fp16 weight grads mixed with fp32 layernorm grads, then still
+  // end up in a few large buckets when fusing through the flat buffer.
+  struct Bucket {
+    std::vector<const RequestDesc*> requests;
+    int64_t size;
+  };
+  std::list<Bucket> open_buckets;
+  std::vector<Bucket> closed_buckets;
+  auto IsFull = [&](const Bucket& bucket) -> bool {
+    return bucket.size >= fusion_threshold_
+           || bucket.requests.size() >= collective_boxing_conf_.nccl_fusion_max_ops();
+  };
   for (const RequestDesc* request : requests) {
     const int64_t size = GetAlignedRequestSize(request);
-    if (group.empty() || !CanFuse(group.back(), request) || group_size + size > fusion_threshold_
-        || group.size() >= collective_boxing_conf_.nccl_fusion_max_ops()) {
-      if (!group.empty()) {
-        groups->emplace_back();
-        groups->back().swap(group);
-        group_size = 0;
-      }
+    auto it = std::find_if(open_buckets.begin(), open_buckets.end(), [&](const Bucket& bucket) {
+      return CanFuse(bucket.requests.back(), request) && bucket.size + size <= fusion_threshold_
+             && bucket.requests.size() < collective_boxing_conf_.nccl_fusion_max_ops();
+    });
+    if (it == open_buckets.end()) {
+      open_buckets.emplace_back(Bucket{std::vector<const RequestDesc*>(), 0});
+      it = std::prev(open_buckets.end());
+    }
+    it->requests.push_back(request);
+    it->size += size;
+    if (IsFull(*it)) {
+      closed_buckets.emplace_back(std::move(*it));
+      open_buckets.erase(it);
     }
-    group.push_back(request);
-    group_size += size;
   }
-  if (!group.empty()) {
+  for (auto& bucket : open_buckets) { closed_buckets.emplace_back(std::move(bucket)); }
+  // A bucket is launched once its last request is ready. Requests are sorted by plan order, which
+  // follows the backward pass for gradients, so launching buckets by their last request lets the
+  // early buckets overlap the remaining backward compute.
+  std::stable_sort(closed_buckets.begin(), closed_buckets.end(),
+                   [](const Bucket& lhs, const Bucket& rhs) {
+                     return lhs.requests.back()->order() < rhs.requests.back()->order();
+                   });
+  for (auto& bucket : closed_buckets) {
     groups->emplace_back();
-    groups->back().swap(group);
+    groups->back().swap(bucket.requests);
   }
 }
 
@@ -279,6 +338,7 @@ void NcclCollectiveBoxingExecutorBackend::ExecuteGroup(
   CHECK_EQ(group.size(), ranks.size());
   if (group.empty()) { return; }
   const int64_t group_size = group.size();
+  const double launch_time = GetCurTime();
   std::map<int64_t, std::vector<std::shared_ptr<const std::function<void(const Maybe<void>&)>>>>
       device_id2callbacks;
   const int64_t stream_id = current_stream_id_;
@@ -425,6 +485,8 @@ void NcclCollectiveBoxingExecutorBackend::ExecuteGroup(
     {
       std::unique_lock<std::mutex> event_list_lock(event_list_mutex_);
       event_list_.emplace_back(Event{device_id, event, [=](const Maybe<void>& status) {
+                                       group_time_histogram_->Observe(
+                                           (GetCurTime() - launch_time) / 1e9);
                                        for (const auto& callback : device_id7callbacks.second) {
                                          (*callback)(status);
                                        }
@@ -527,6 +589,26 @@ CollectiveBoxingExecutor::CollectiveBoxingExecutor(const Plan& plan)
 #endif
   Init();
   DumpSummary();
+  straggler_report_interval_ =
+      ParseIntegerFromEnv("ONEFLOW_COLLECTIVE_BOXING_STRAGGLER_REPORT_INTERVAL", 0);
+  if (straggler_report_interval_ > 0) {
+    arrival_report_thread_ = std::thread([this]() {
+      ArrivalReport report;
+      while (arrival_report_channel_.Receive(&report) == kChannelStatusSuccess) {
+        Global<CtrlClient>::Get()->PushKV(
+            GetArrivalListKey(report.job_id, report.round, GlobalProcessCtx::Rank()),
+            *report.arrival_list);
+        if (GlobalProcessCtx::IsThisProcessMaster()) {
+          ReportStragglers(report.job_id, report.round);
+        }
+      }
+    });
+  }
+}
+
+CollectiveBoxingExecutor::~CollectiveBoxingExecutor() {
+  arrival_report_channel_.Close();
+  if (arrival_report_thread_.joinable()) { arrival_report_thread_.join(); }
 }
 
 void CollectiveBoxingExecutor::Init() {
@@ -613,6 +695,7 @@ void CollectiveBoxingExecutor::Enqueue(const RankDesc& rank_desc,
       CHECK_EQ(current_job_id_, request_state.job_id);
     }
 
+    if (straggler_report_interval_ > 0) { RecordArrival(rank_desc, request_id); }
     request_state.AddReadyRank(rank_desc, request_info);
     if (request_state.IsReady()) {
       group_id2group_state_.at(request_state.group_id).AddReadyRequest(request_id);
@@ -627,9 +710,10 @@ void CollectiveBoxingExecutor::Enqueue(const RankDesc& rank_desc,
       std::vector<std::map<int64_t, RuntimeRequestInfo>> ranks;
       ranks.reserve(group_state.request_ids.size());
       for (const int64_t request_id : group_state.request_ids) {
-        auto& rank = request_id2request_state_.at(request_id).ready_ranks;
-        ranks.emplace_back(std::move(rank));
-        rank.clear();
+        auto& request_state = request_id2request_state_.at(request_id);
+        ranks.emplace_back(std::move(request_state.ready_ranks));
+        request_state.ready_ranks.clear();
+        request_state.occurrence += 1;
       }
       group_state.backend->ExecuteGroup(group_state.requests, ranks);
       group_state.ready_request_ids.clear();
@@ -640,11 +724,108 @@ void CollectiveBoxingExecutor::Enqueue(const RankDesc& rank_desc,
     }
   }
   if (current_group_idx_in_job_ == 0 && num_launched_groups > 0) {
+    if (straggler_report_interval_ > 0) { OnJobFinished(current_job_id_); }
     current_job_id_ = -1;
     current_group_idx_in_job_ = -1;
   }
 }
 
+void CollectiveBoxingExecutor::RecordArrival(const RankDesc& rank_desc, int64_t request_id) {
+  const RequestState& request_state = request_id2request_state_.at(request_id);
+  const DeviceDesc& device_desc = request_state.request_desc->device_set().device(rank_desc.rank());
+  const std::string& name = rank_desc.op_desc().name();
+  RequestArrival* arrival = job_id2arrival_list_[request_state.job_id].add_arrival();
+  arrival->set_name(name);
+  arrival->set_occurrence(request_state.occurrence);
+  arrival->set_machine_id(device_desc.machine_id());
+  arrival->set_device_id(device_desc.device_id());
+  arrival->set_arrival_us(GetWallTimeUs());
+  auto it = device_id2last_request_name_.find(device_desc.device_id());
+  if (it != device_id2last_request_name_.end()) { arrival->set_prev_name(it->second); }
+  device_id2last_request_name_[device_desc.device_id()] = name;
+}
+
+void CollectiveBoxingExecutor::OnJobFinished(int64_t job_id) {
+  const int64_t num_finished = ++job_id2num_finished_[job_id];
+  if (num_finished % straggler_report_interval_ != 0) { return; }
+  ArrivalReport report;
+  report.job_id = job_id;
+  report.round = num_finished / straggler_report_interval_ - 1;
+  report.arrival_list = std::make_shared<RequestArrivalList>();
+  report.arrival_list->Swap(&job_id2arrival_list_[job_id]);
+  CHECK_EQ(arrival_report_channel_.Send(report), kChannelStatusSuccess);
+}
+
+void CollectiveBoxingExecutor::ReportStragglers(int64_t job_id, int64_t round) const {
+  // NOTE: lateness is measured on the wall clock of each machine, so the clocks are expected to
+  // be synchronized (e.g. by NTP) well below the lateness of interest.
+  std::set<int64_t> machine_ids;
+  for (const auto& request : collective_boxing_plan_.job_id2request_set().at(job_id).request()) {
+    for (const auto& device_desc : request.device_set().device()) {
+      machine_ids.emplace(device_desc.machine_id());
+    }
+  }
+  std::vector<RequestArrivalList> arrival_lists(machine_ids.size());
+  std::map<std::pair<std::string, int64_t>, std::vector<const RequestArrival*>> key2arrivals;
+  int64_t idx = 0;
+  for (const int64_t machine_id : machine_ids) {
+    const std::string key = GetArrivalListKey(job_id, round, machine_id);
+    Global<CtrlClient>::Get()->PullKV(key, &arrival_lists.at(idx));
+    Global<CtrlClient>::Get()->ClearKV(key);
+    for (const auto& arrival : arrival_lists.at(idx).arrival()) {
+      key2arrivals[std::make_pair(arrival.name(), arrival.occurrence())].push_back(&arrival);
+    }
+    idx += 1;
+  }
+  std::map<std::pair<int64_t, int64_t>, std::array<int64_t, kNumLatenessBuckets>> device2histogram;
+  std::map<std::pair<int64_t, int64_t>, int64_t> device2total_lateness;
+  std::vector<std::pair<int64_t, const RequestArrival*>> stragglers;
+  for (const auto& pair : key2arrivals) {
+    int64_t first_arrival_us = std::numeric_limits<int64_t>::max();
+    for (const auto* arrival : pair.second) {
+      first_arrival_us = std::min(first_arrival_us, arrival->arrival_us());
+    }
+    for (const auto* arrival : pair.second) {
+      const int64_t lateness_us = arrival->arrival_us() - first_arrival_us;
+      const auto device = std::make_pair(arrival->machine_id(), arrival->device_id());
+      auto histogram_it = device2histogram.find(device);
+      if (histogram_it == device2histogram.end()) {
+        histogram_it = device2histogram.emplace(device, std::array<int64_t, kNumLatenessBuckets>{})
+                           .first;
+      }
+      histogram_it->second.at(GetLatenessBucket(lateness_us)) += 1;
+      device2total_lateness[device] += lateness_us;
+      if (lateness_us > 0) { stragglers.emplace_back(lateness_us, arrival); }
+    }
+  }
+  const int64_t num_top = std::min<int64_t>(kNumTopStragglers, stragglers.size());
+  std::partial_sort(stragglers.begin(), stragglers.begin() + num_top, stragglers.end(),
+                    [](const std::pair<int64_t, const RequestArrival*>& a,
+                       const std::pair<int64_t, const RequestArrival*>& b) {
+                      return a.first > b.first;
+                    });
+  LOG(INFO) << "collective boxing lateness of job " << job_id << " round " << round
+            << ", histogram buckets [<100us, <1ms, <10ms, <100ms, >=100ms]";
+  for (const auto& pair : device2histogram) {
+    int64_t count = 0;
+    std::string histogram_str;
+    for (const int64_t bucket_count : pair.second) {
+      count += bucket_count;
+      histogram_str += (histogram_str.empty() ? "" : ", ") + std::to_string(bucket_count);
+    }
+    LOG(INFO) << "  machine " << pair.first.first << " device " << pair.first.second
+              << ": mean lateness " << device2total_lateness.at(pair.first) / count
+              << "us, histogram [" << histogram_str << "]";
+  }
+  FOR_RANGE(int64_t, i, 0, num_top) {
+    const RequestArrival* arrival = stragglers.at(i).second;
+    LOG(INFO) << "  straggler " << i << ": machine " << arrival->machine_id() << " device "
+              << arrival->device_id() << " arrived " << stragglers.at(i).first << "us late at "
+              << arrival->name() << " (occurrence " << arrival->occurrence() << ")"
+              << (arrival->has_prev_name() ? ", actors since " + arrival->prev_name() : "");
+  }
+}
+
 void CollectiveBoxingExecutor::RequestState::AddReadyRank(const RankDesc& rank_desc,
                                                           const RuntimeRequestInfo& request_info) {
   CHECK(local_ranks.find(rank_desc.rank()) != local_ranks.end());
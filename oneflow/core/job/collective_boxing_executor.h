@@ -20,6 +20,7 @@ limitations under the License.
 #include "oneflow/core/job/plan.pb.h"
 #include "oneflow/core/common/maybe.h"
 #include "oneflow/core/device/device_context.h"
+#include "oneflow/core/common/channel.h"
 
 namespace oneflow {
 
@@ -49,7 +50,7 @@ class CollectiveBoxingExecutorBackend {
 class CollectiveBoxingExecutor final {
  public:
   OF_DISALLOW_COPY_AND_MOVE(CollectiveBoxingExecutor);
-  ~CollectiveBoxingExecutor() = default;
+  ~CollectiveBoxingExecutor();
 
   void Enqueue(const RankDesc& rank_desc, const RuntimeRequestInfo& request_info);
 
@@ -59,6 +60,9 @@ class CollectiveBoxingExecutor final {
 
   void Init();
   void DumpSummary() const;
+  void RecordArrival(const RankDesc& rank_desc, int64_t request_id);
+  void OnJobFinished(int64_t job_id);
+  void ReportStragglers(int64_t job_id, int64_t round) const;
 
   struct RequestState {
     RequestState(const RequestDesc* p_request_desc, int64_t p_job_id, int64_t p_group_id,
@@ -67,12 +71,14 @@ class CollectiveBoxingExecutor final {
           job_id(p_job_id),
           group_id(p_group_id),
           local_ranks(std::move(p_local_ranks)),
-          ready_ranks() {}
+          ready_ranks(),
+          occurrence(0) {}
     const RequestDesc* const request_desc;
     const int64_t job_id;
     const int64_t group_id;
     const std::set<int64_t> local_ranks;
     std::map<int64_t, RuntimeRequestInfo> ready_ranks;
+    int64_t occurrence;
 
     void AddReadyRank(const RankDesc& rank_desc, const RuntimeRequestInfo& request_info);
     bool IsReady() const;
@@ -105,6 +111,19 @@ class CollectiveBoxingExecutor final {
 
   int64_t current_job_id_ = -1;
   int64_t current_group_idx_in_job_ = -1;
+
+  // straggler detection, enabled by ONEFLOW_COLLECTIVE_BOXING_STRAGGLER_REPORT_INTERVAL
+  struct ArrivalReport {
+    int64_t job_id;
+    int64_t round;
+    std::shared_ptr<RequestArrivalList> arrival_list;
+  };
+  int64_t straggler_report_interval_;
+  HashMap<int64_t, RequestArrivalList> job_id2arrival_list_;
+  HashMap<int64_t, int64_t> job_id2num_finished_;
+  HashMap<int64_t, std::string> device_id2last_request_name_;
+  Channel<ArrivalReport> arrival_report_channel_;
+  std::thread arrival_report_thread_;
 };
 
 }  // namespace collective
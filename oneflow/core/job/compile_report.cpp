@@ -0,0 +1,261 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <json.hpp>
+#include "oneflow/core/job/compile_report.h"
+#include "oneflow/core/job/resource_desc.h"
+#include "oneflow/core/job/global_for.h"
+#include "oneflow/core/register/runtime_register_desc.h"
+#include "oneflow/core/persistence/tee_persistent_log_stream.h"
+
+namespace oneflow {
+
+namespace {
+
+constexpr int64_t kNumLargestBlobs = 20;
+
+struct CompileTimes {
+  std::vector<std::pair<std::string, double>> pass2seconds;
+  std::vector<std::pair<std::string, double>> phase2seconds;
+};
+
+std::mutex* CompileTimesMutex() {
+  static std::mutex mutex;
+  return &mutex;
+}
+
+HashMap<std::string, CompileTimes>* MutJobName2CompileTimes() {
+  static HashMap<std::string, CompileTimes> job_name2compile_times;
+  return &job_name2compile_times;
+}
+
+std::string DeviceName(int64_t machine_id, const MemoryCase& mem_case) {
+  std::string name = "machine " + std::to_string(machine_id) + " ";
+  if (mem_case.has_device_cuda_mem()) {
+    name += "cuda:" + std::to_string(mem_case.device_cuda_mem().device_id());
+  } else if (mem_case.host_mem().has_cuda_pinned_mem()) {
+    name += "cpu pinned";
+  } else {
+    name += "cpu";
+  }
+  return name;
+}
+
+bool IsBoxingTask(TaskType task_type) {
+  return task_type == kCopyHd || task_type == kCopyCommNet || task_type == kSliceBoxing
+         || task_type == kCollectiveBoxingGeneric || task_type == kBoxingIdentity
+         || task_type == kCollectiveBoxingPack || task_type == kCollectiveBoxingUnpack
+         || task_type == kBoxingZeros;
+}
+
+const OperatorConf* ProducerOpConf(const Plan& plan, const TaskProto& task) {
+  if (task.exec_sequence().exec_node_size() == 0) { return nullptr; }
+  const KernelConf& kernel_conf = task.exec_sequence().exec_node(0).kernel_conf();
+  if (kernel_conf.has_op_attribute()) { return &kernel_conf.op_attribute().op_conf(); }
+  if (!kernel_conf.has_op_attribute_ref()) { return nullptr; }
+  const auto& job_id2table = plan.job_id2op_attribute_ref_table();
+  const auto table_it = job_id2table.find(task.job_id());
+  if (table_it == job_id2table.end()) { return nullptr; }
+  const auto& op_name2op_attribute = table_it->second.op_name2op_attribute();
+  const auto it = op_name2op_attribute.find(kernel_conf.op_attribute_ref());
+  if (it == op_name2op_attribute.end()) { return nullptr; }
+  return &it->second.op_conf();
+}
+
+struct DeviceMemory {
+  int64_t variable_bytes = 0;
+  int64_t activation_bytes = 0;
+  int64_t tmp_bytes = 0;
+  int64_t boxing_bytes = 0;
+  // after memory sharing
+  int64_t planned_bytes = 0;
+};
+
+nlohmann::json MakeTimesJson(const std::vector<std::pair<std::string, double>>& name2seconds,
+                             const std::string& key) {
+  nlohmann::json times = nlohmann::json::array();
+  for (const auto& pair : name2seconds) {
+    nlohmann::json time;
+    time[key] = pair.first;
+    time["seconds"] = pair.second;
+    times.push_back(time);
+  }
+  return times;
+}
+
+std::string MakeHtmlTable(const nlohmann::json& rows, const std::vector<std::string>& columns) {
+  std::string html = "<table>\n<tr>";
+  for (const auto& column : columns) { html += "<th>" + column + "</th>"; }
+  html += "</tr>\n";
+  for (const auto& row : rows) {
+    html += "<tr>";
+    for (const auto& column : columns) {
+      const nlohmann::json& value = row[column];
+      html += "<td>" + (value.is_string() ? value.get<std::string>() : value.dump()) + "</td>";
+    }
+    html += "</tr>\n";
+  }
+  return html + "</table>\n";
+}
+
+std::string MakeHtmlReport(const nlohmann::json& report) {
+  std::string html = "<!DOCTYPE html>\n<html><head><meta charset=\"utf-8\"><title>compile report "
+                     + report["job_name"].get<std::string>()
+                     + "</title><style>table{border-collapse:collapse;margin-bottom:1em}"
+                       "td,th{border:1px solid #999;padding:2px 8px;text-align:left}</style>"
+                       "</head><body>\n";
+  html += "<h1>" + report["job_name"].get<std::string>() + "</h1>\n";
+  html += "<p>actors: " + report["num_actors"].dump() + ", regsts: " + report["num_regsts"].dump()
+          + "</p>\n";
+  const nlohmann::json& mem_sharing = report["mem_sharing"];
+  html += "<p>memory sharing: " + mem_sharing["reusable_regst_bytes"].dump()
+          + " reusable regst bytes in " + mem_sharing["chunk_bytes"].dump()
+          + " chunk bytes, saved ratio " + mem_sharing["saved_ratio"].dump() + "</p>\n";
+  html += "<h2>Memory per device</h2>\n";
+  html += MakeHtmlTable(report["devices"],
+                        {"device", "planned_bytes", "regst_bytes", "variable_bytes",
+                         "activation_bytes", "tmp_bytes", "boxing_bytes"});
+  html += "<h2>Largest blobs</h2>\n";
+  html += MakeHtmlTable(report["largest_blobs"],
+                        {"producer", "regst", "device", "register_num", "bytes"});
+  html += "<h2>Compile phases</h2>\n";
+  html += MakeHtmlTable(report["compile_phases"], {"phase", "seconds"});
+  html += "<h2>Job passes</h2>\n";
+  html += MakeHtmlTable(report["job_passes"], {"pass", "seconds"});
+  return html + "</body></html>\n";
+}
+
+}  // namespace
+
+bool IsCompileReportEnabled() {
+  static const bool env_enabled = ParseBooleanFromEnv("ONEFLOW_DUMP_COMPILE_REPORT", false);
+  if (env_enabled) { return true; }
+  const ResourceDesc* resource_desc = Global<ResourceDesc, ForSession>::Get();
+  return resource_desc != nullptr && resource_desc->enable_debug_mode();
+}
+
+void RecordJobPassTime(const std::string& job_name, const std::string& pass_name,
+                       double seconds) {
+  if (!IsCompileReportEnabled()) { return; }
+  std::unique_lock<std::mutex> lock(*CompileTimesMutex());
+  (*MutJobName2CompileTimes())[job_name].pass2seconds.emplace_back(pass_name, seconds);
+}
+
+void RecordCompilePhaseTime(const std::string& job_name, const std::string& phase,
+                            double seconds) {
+  if (!IsCompileReportEnabled()) { return; }
+  std::unique_lock<std::mutex> lock(*CompileTimesMutex());
+  (*MutJobName2CompileTimes())[job_name].phase2seconds.emplace_back(phase, seconds);
+}
+
+void DumpCompileReport(const std::string& job_name, int64_t job_id, const Plan& plan) {
+  if (!IsCompileReportEnabled()) { return; }
+  CompileTimes compile_times;
+  {
+    std::unique_lock<std::mutex> lock(*CompileTimesMutex());
+    auto it = MutJobName2CompileTimes()->find(job_name);
+    if (it != MutJobName2CompileTimes()->end()) {
+      compile_times = std::move(it->second);
+      MutJobName2CompileTimes()->erase(it);
+    }
+  }
+
+  std::map<std::string, DeviceMemory> device2memory;
+  std::vector<nlohmann::json> blobs;
+  int64_t num_regsts = 0;
+  int64_t reusable_regst_bytes = 0;
+  for (const TaskProto& task : plan.task()) {
+    const OperatorConf* op_conf = ProducerOpConf(plan, task);
+    for (const auto& pair : task.produced_regst_desc()) {
+      const RegstDescProto& regst_desc = pair.second;
+      num_regsts += 1;
+      if (!regst_desc.regst_desc_type().has_data_regst_desc()) { continue; }
+      const int64_t bytes = RtRegstDesc(regst_desc).TotalMainByteSize4AllRegst();
+      const std::string device = DeviceName(task.machine_id(), regst_desc.mem_case());
+      DeviceMemory* memory = &device2memory[device];
+      if (!regst_desc.variable_op_name().empty()
+          || (op_conf != nullptr && op_conf->has_variable_conf())) {
+        memory->variable_bytes += bytes;
+      } else if (IsBoxingTask(task.task_type())) {
+        memory->boxing_bytes += bytes;
+      } else if (pair.first == "tmp") {
+        memory->tmp_bytes += bytes;
+      } else {
+        memory->activation_bytes += bytes;
+      }
+      if (regst_desc.enable_reuse_mem()) { reusable_regst_bytes += bytes; }
+      nlohmann::json blob;
+      blob["producer"] =
+          op_conf != nullptr ? op_conf->name() : TaskType_Name(task.task_type());
+      blob["regst"] = pair.first;
+      blob["device"] = device;
+      blob["register_num"] = regst_desc.register_num();
+      blob["bytes"] = bytes;
+      blobs.push_back(blob);
+    }
+  }
+  int64_t chunk_bytes = 0;
+  for (const ChunkProto& chunk : plan.block_chunk_list().chunk()) {
+    device2memory[DeviceName(chunk.machine_id(), chunk.mem_case())].planned_bytes +=
+        chunk.mem_size();
+    chunk_bytes += chunk.mem_size();
+  }
+  for (const MemBlockProto& mem_block : plan.block_chunk_list().mem_block()) {
+    if (mem_block.chunk_id() != -1) { continue; }
+    device2memory[DeviceName(mem_block.machine_id(), mem_block.mem_case())].planned_bytes +=
+        mem_block.mem_size();
+  }
+  const int64_t num_largest_blobs = std::min<int64_t>(kNumLargestBlobs, blobs.size());
+  std::partial_sort(blobs.begin(), blobs.begin() + num_largest_blobs, blobs.end(),
+                    [](const nlohmann::json& a, const nlohmann::json& b) {
+                      return a["bytes"].get<int64_t>() > b["bytes"].get<int64_t>();
+                    });
+
+  nlohmann::json report;
+  report["job_name"] = job_name;
+  report["job_id"] = job_id;
+  report["job_passes"] = MakeTimesJson(compile_times.pass2seconds, "pass");
+  report["compile_phases"] = MakeTimesJson(compile_times.phase2seconds, "phase");
+  report["num_actors"] = plan.task_size();
+  report["num_regsts"] = num_regsts;
+  report["devices"] = nlohmann::json::array();
+  for (const auto& pair : device2memory) {
+    const DeviceMemory& memory = pair.second;
+    nlohmann::json device;
+    device["device"] = pair.first;
+    device["planned_bytes"] = memory.planned_bytes;
+    device["regst_bytes"] = memory.variable_bytes + memory.activation_bytes + memory.tmp_bytes
+                            + memory.boxing_bytes;
+    device["variable_bytes"] = memory.variable_bytes;
+    device["activation_bytes"] = memory.activation_bytes;
+    device["tmp_bytes"] = memory.tmp_bytes;
+    device["boxing_bytes"] = memory.boxing_bytes;
+    report["devices"].push_back(device);
+  }
+  report["largest_blobs"] = nlohmann::json::array();
+  FOR_RANGE(int64_t, i, 0, num_largest_blobs) { report["largest_blobs"].push_back(blobs.at(i)); }
+  // how much of the memory of the reusable regsts is saved by sharing it in chunks
+  report["mem_sharing"]["reusable_regst_bytes"] = reusable_regst_bytes;
+  report["mem_sharing"]["chunk_bytes"] = chunk_bytes;
+  report["mem_sharing"]["saved_ratio"] =
+      reusable_regst_bytes > 0 ? 1.0 - static_cast<double>(chunk_bytes) / reusable_regst_bytes
+                               : 0.0;
+
+  const std::string prefix = "compile_report_job_" + std::to_string(job_id);
+  TeePersistentLogStream::Create(prefix + ".json")->Write(report.dump(2));
+  TeePersistentLogStream::Create(prefix + ".html")->Write(MakeHtmlReport(report));
+}
+
+}  // namespace oneflow
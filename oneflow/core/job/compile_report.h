@@ -0,0 +1,54 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_JOB_COMPILE_REPORT_H_
+#define ONEFLOW_CORE_JOB_COMPILE_REPORT_H_
+
+#include "oneflow/core/common/util.h"
+#include "oneflow/core/job/plan.pb.h"
+
+namespace oneflow {
+
+// A performance oriented summary of compiling a lazy job: the time of its job passes and compile
+// phases, its actors and regsts, and the memory it plans per device. Dumped next to the plan as
+// compile_report_job_<job_id>.json and .html in debug mode or with ONEFLOW_DUMP_COMPILE_REPORT.
+
+bool IsCompileReportEnabled();
+
+void RecordJobPassTime(const std::string& job_name, const std::string& pass_name, double seconds);
+void RecordCompilePhaseTime(const std::string& job_name, const std::string& phase,
+                            double seconds);
+
+class CompilePhaseTimer final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(CompilePhaseTimer);
+  CompilePhaseTimer(const std::string& job_name, const std::string& phase)
+      : job_name_(job_name), phase_(phase), start_(GetCurTime()) {}
+  ~CompilePhaseTimer() {
+    RecordCompilePhaseTime(job_name_, phase_, (GetCurTime() - start_) / 1e9);
+  }
+
+ private:
+  std::string job_name_;
+  std::string phase_;
+  double start_;
+};
+
+// plan is the sub plan of the job, with its mem blocks and chunks generated
+void DumpCompileReport(const std::string& job_name, int64_t job_id, const Plan& plan);
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_JOB_COMPILE_REPORT_H_
@@ -20,8 +20,11 @@ limitations under the License.
 #include "oneflow/core/persistence/tee_persistent_log_stream.h"
 #include "oneflow/core/graph/op_graph.h"
 #include "oneflow/core/job_rewriter/job_completer.h"
+#include "oneflow/core/job/improver.h"
+#include "oneflow/core/graph/normal_forward_compute_task_node.h"
 #include "oneflow/core/thread/thread_pool.h"
 #include "oneflow/core/common/blocking_counter.h"
+#include "oneflow/core/job/compile_report.h"
 
 namespace oneflow {
 
@@ -45,9 +48,31 @@ void CreateOpAttributeRef(Plan* plan, int64_t job_id, TaskProto* task_proto) {
   kernel_conf->set_allocated_op_attribute(nullptr);
 }
 
+void ApplyRegstNumHints(const std::string& job_name, TaskGraph* task_gph) {
+  const std::string hints_file = GetStringFromEnv("ONEFLOW_REGST_NUM_HINTS_FILE", "");
+  if (hints_file.empty()) { return; }
+  RegstNumHints hints;
+  ParseProtoFromTextFile(hints_file, &hints);
+  const auto& regst_key2register_num = hints.regst_key2register_num();
+  task_gph->ForEachNode([&](TaskNode* task_node) {
+    const auto* comp_task_node = dynamic_cast<const NormalForwardCompTaskNode*>(task_node);
+    if (comp_task_node == nullptr) { return; }
+    for (const auto& pair : task_node->produced_regsts()) {
+      const auto& it = regst_key2register_num.find(RegstNumHintKey(
+          job_name, comp_task_node->op()->op_name(), pair.first, comp_task_node->parallel_id()));
+      if (it == regst_key2register_num.end()) { continue; }
+      pair.second->UpdtMinRegstNumIfNeed(std::min(it->second, pair.second->max_register_num()));
+    }
+  });
+}
+
 void Compiler::Compile(Job* job, Plan* plan, bool need_job_complete) const {
+  const std::string job_name = job->job_conf().job_name();
   // Step1: ensure job is completed.
-  if (need_job_complete) { CHECK_JUST(JobCompleter().Complete(job)); }
+  if (need_job_complete) {
+    CompilePhaseTimer timer(job_name, "JobCompleter");
+    CHECK_JUST(JobCompleter().Complete(job));
+  }
 
   // Step2: new Global<OpGraph> and set log configs.
   Global<OpGraph>::New(*job);
@@ -61,20 +86,26 @@ void Compiler::Compile(Job* job, Plan* plan, bool need_job_complete) const {
 
   // Step3: build task_gph.
   // TODO(levi): we can rewrite this part of code in visitor pattern.
+  auto build_task_graph_timer = std::make_unique<CompilePhaseTimer>(job_name, "BuildTaskGraph");
   auto task_gph = std::make_unique<TaskGraph>();
   using std::placeholders::_1;
   task_gph->ForEachNode(std::bind(&TaskNode::ProduceAllRegstsAndBindEdges, _1));
   task_gph->ForEachNode(std::bind(&TaskNode::ConsumeAllRegsts, _1));
   task_gph->ForEachNode(std::bind(&TaskNode::PinConsumedRegst, _1));
-  task_gph->TopoForEachNode(&TaskNode::Build);
+  // a task node only reads the regsts produced by its in-nodes when being built
+  task_gph->LevelTopoForEachNode(CompileThreadPool(), &TaskNode::Build);
   task_gph->RemoveEmptyRegsts();
+  // before merging chains, tasks with more registers stay out of the chains
+  ApplyRegstNumHints(job_desc.job_name(), task_gph.get());
   task_gph->MergeChainAndAddOrderingCtrlEdgeInSameChain();
   auto IsReachable = Global<OpGraph>::Get()->MakePredicatorIsOpNameDataOrCtrlReachable();
   if (job_desc.enable_inplace()) { task_gph->EnableInplaceMemSharing(IsReachable); }
-  task_gph->TopoForEachNode(&TaskNode::InferTimeShapeIfMeaningful);
+  task_gph->LevelTopoForEachNode(CompileThreadPool(), &TaskNode::InferTimeShapeIfMeaningful);
   task_gph->ForEachEdge([&](TaskEdge* task_edge) { task_edge->CheckRegstLbiValid(); });
+  build_task_graph_timer.reset();
 
   // Step4: put infomation from task_gph into plan.
+  auto to_plan_timer = std::make_unique<CompilePhaseTimer>(job_name, "TaskGraphToPlan");
   const int64_t node_num = task_gph->node_num();
   const int64_t cpu_num = std::thread::hardware_concurrency();
   const int64_t thread_pool_size = std::min(node_num, cpu_num);
@@ -88,8 +119,10 @@ void Compiler::Compile(Job* job, Plan* plan, bool need_job_complete) const {
         task_node->ToProto(&task_proto);
         {
           std::unique_lock<std::mutex> guard(mtx);
-          if (task_node->GetTaskType() == kNormalForward || task_node->GetTaskType() == kRepeat
-              || task_node->GetTaskType() == kAcc) {
+          // the tasks running a chain of ops keep their op attributes
+          if ((task_node->GetTaskType() == kNormalForward || task_node->GetTaskType() == kRepeat
+               || task_node->GetTaskType() == kAcc)
+              && task_proto.exec_sequence().exec_node_size() == 1) {
             CreateOpAttributeRef(plan, job_desc.job_id(), &task_proto);
           }
           plan->mutable_task()->Add(std::move(task_proto));
@@ -101,8 +134,10 @@ void Compiler::Compile(Job* job, Plan* plan, bool need_job_complete) const {
   counter.WaitUntilCntEqualZero();
   // NOTE(levi): release task_gph here to decrise memory peak.
   task_gph.reset();
+  to_plan_timer.reset();
 
   // Step5: post-process for plan and delete Global<OpGraph>.
+  CompilePhaseTimer infer_mem_block_timer(job_name, "InferMemBlockId");
   auto* job_id2job_conf = plan->mutable_job_confs()->mutable_job_id2job_conf();
   (*job_id2job_conf)[GlobalJobDesc().job_id()] = GlobalJobDesc().job_conf();
   // NOTE(chengcheng): infer mem blob id & set inplace & add ctrl
@@ -105,11 +105,15 @@ void CriticalSectionDesc::UpdateCriticalSectionIds2IntersectingIds() {
   CHECK_EQ(inited_, false);
   critical_section_id2intersecting_ids_.resize(critical_sections_.size());
   HashMap<int64_t, HashSet<int64_t>> mem_block_id2critical_section_ids;
+  HashMap<int64_t, HashSet<int64_t>> read_only_mem_block_id2critical_section_ids;
   HashMap<int64_t, HashSet<int64_t>> chunk_id2critical_section_ids;
   FOR_RANGE(int64_t, i, 0, critical_sections_.size()) {
     for (int64_t mem_block_id : critical_sections_.at(i)->mem_block_id()) {
       mem_block_id2critical_section_ids[mem_block_id].insert(i);
     }
+    for (int64_t mem_block_id : critical_sections_.at(i)->read_only_mem_block_id()) {
+      read_only_mem_block_id2critical_section_ids[mem_block_id].insert(i);
+    }
     for (int64_t chunk_id : critical_sections_.at(i)->chunk_id()) {
       chunk_id2critical_section_ids[chunk_id].insert(i);
     }
@@ -123,6 +127,19 @@ void CriticalSectionDesc::UpdateCriticalSectionIds2IntersectingIds() {
       }
     }
   }
+  // readers of a mem block only intersect with its writers
+  for (const auto& pair : read_only_mem_block_id2critical_section_ids) {
+    const auto& iter = mem_block_id2critical_section_ids.find(pair.first);
+    if (iter == mem_block_id2critical_section_ids.end()) { continue; }
+    for (int64_t reader_id : pair.second) {
+      for (int64_t writer_id : iter->second) {
+        if (reader_id != writer_id) {
+          critical_section_id2intersecting_ids_[reader_id].insert(writer_id);
+          critical_section_id2intersecting_ids_[writer_id].insert(reader_id);
+        }
+      }
+    }
+  }
   for (const auto& pair : chunk_id2critical_section_ids) {
     for (int64_t first_id : pair.second) {
       for (int64_t second_id : pair.second) {
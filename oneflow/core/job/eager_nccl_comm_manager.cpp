@@ -13,6 +13,7 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 */
+#include <thread>
 #include "oneflow/core/control/ctrl_client.h"
 #include "oneflow/core/control/global_process_ctx.h"
 #include "oneflow/core/job/eager_nccl_comm_manager.h"
@@ -25,10 +26,12 @@ namespace oneflow {
 
 namespace {
 
-std::string GetNcclUniqueIdRpcKey(const std::vector<std::pair<int64_t, int64_t>>& sorted_devices) {
+std::string GetNcclUniqueIdRpcKey(const std::vector<std::pair<int64_t, int64_t>>& sorted_devices,
+                                  const int32_t stream_id) {
   std::ostringstream oss;
   oss << "eager_nccl_unique_id_rpc_key";
   for (const auto& pair : sorted_devices) { oss << "," << pair.first << ":" << pair.second; }
+  if (stream_id != EagerNcclCommMgr::kDefaultStreamId) { oss << "-stream_id_hint:" << stream_id; }
   return oss.str();
 }
 
@@ -74,66 +77,136 @@ void CreateNcclComm(ncclComm_t* comm, const int dev, const std::string& key,
 
 }  // namespace
 
+const int32_t EagerNcclCommMgr::kDefaultStreamId;
+
 EagerNcclCommMgr::~EagerNcclCommMgr() {
-  for (auto& device_set7device_id2comm : device_set2device_id2comm_) {
+  for (auto& device_set7device_id2comm : device_set7stream2device_id2comm_) {
     for (auto& device_id7comm : device_set7device_id2comm.second) {
       OF_NCCL_CHECK(ncclCommDestroy(device_id7comm.second));
     }
   }
-  for (auto& pair : device7stream2device_id2comm_) {
-    for (auto& device_id7comm : pair.second) {
-      OF_NCCL_CHECK(ncclCommDestroy(device_id7comm.second));
-    }
-  }
 }
 
 ncclComm_t EagerNcclCommMgr::GetCommForDevice(
     const std::set<std::pair<int64_t, int64_t>>& device_set) {
+  return GetOrCreateComm(device_set, kDefaultStreamId);
+}
+
+ncclComm_t EagerNcclCommMgr::GetCommForDeviceAndStreamId(
+    const std::set<std::pair<int64_t, int64_t>>& device_set, const int32_t stream_id) {
+  CHECK_NE(stream_id, kDefaultStreamId);
+  return GetOrCreateComm(device_set, stream_id);
+}
+
+ncclComm_t EagerNcclCommMgr::GetOrCreateComm(const DeviceSet& device_set,
+                                             const int32_t stream_id) {
   int dev;
   OF_CUDA_CHECK(cudaGetDevice(&dev));
   {
     std::lock_guard<std::mutex> lock(mutex_);
-    auto it = device_set2device_id2comm_.find(device_set);
-    if (it != device_set2device_id2comm_.end()) { return it->second.at(dev); }
+    auto it = device_set7stream2device_id2comm_.find(std::make_pair(device_set, stream_id));
+    if (it != device_set7stream2device_id2comm_.end()) {
+      auto comm_it = it->second.find(dev);
+      if (comm_it != it->second.end()) { return comm_it->second; }
+    }
   }
   std::vector<std::pair<int64_t, int64_t>> device_vec(device_set.cbegin(), device_set.cend());
   std::sort(device_vec.begin(), device_vec.end(), CompareDeviceSetPair);
 
   ncclComm_t comm;
-  std::string nccl_unique_id_rpc_key = GetNcclUniqueIdRpcKey(device_vec);
-  CreateNcclComm(&comm, dev, nccl_unique_id_rpc_key, device_vec);
+  CreateNcclComm(&comm, dev, GetNcclUniqueIdRpcKey(device_vec, stream_id), device_vec);
 
   {
     std::lock_guard<std::mutex> lock(mutex_);
-    device_set2device_id2comm_[device_set][dev] = comm;
+    device_set7stream2device_id2comm_[std::make_pair(device_set, stream_id)][dev] = comm;
   }
   return comm;
 }
 
-ncclComm_t EagerNcclCommMgr::GetCommForDeviceAndStreamId(
-    const std::set<std::pair<int64_t, int64_t>>& device_set, const int32_t stream_id) {
-  int dev;
-  OF_CUDA_CHECK(cudaGetDevice(&dev));
-
-  std::vector<std::pair<int64_t, int64_t>> device_vec(device_set.cbegin(), device_set.cend());
-  std::sort(device_vec.begin(), device_vec.end(), CompareDeviceSetPair);
-  std::string key =
-      GetNcclUniqueIdRpcKey(device_vec) + "-stream_id_hint:" + std::to_string(stream_id);
-
+void EagerNcclCommMgr::CreateCommsForDeviceSets(
+    const std::vector<std::set<std::pair<int64_t, int64_t>>>& device_sets,
+    const int32_t stream_id) {
+  struct CommCreation {
+    const DeviceSet* device_set;
+    int64_t dev;
+    ncclComm_t comm;
+  };
+  const int64_t this_machine = GlobalProcessCtx::Rank();
+  std::vector<CommCreation> creations;
   {
     std::lock_guard<std::mutex> lock(mutex_);
-    auto it = device7stream2device_id2comm_.find(key);
-    if (it != device7stream2device_id2comm_.end()) { return it->second.at(dev); }
+    for (const auto& device_set : device_sets) {
+      const auto it = device_set7stream2device_id2comm_.find(std::make_pair(device_set, stream_id));
+      for (const auto& device : device_set) {
+        if (device.first != this_machine) { continue; }
+        if (it != device_set7stream2device_id2comm_.end() && it->second.count(device.second) > 0) {
+          continue;
+        }
+        creations.push_back(CommCreation{&device_set, device.second, nullptr});
+      }
+    }
   }
-
-  ncclComm_t comm;
-  CreateNcclComm(&comm, dev, key, device_vec);
-
+  if (creations.empty()) { return; }
+  // ncclCommInitRank blocks until all ranks join, so the comms are created on separate threads.
+  // This keeps the total latency at about one initialization and does not depend on all ranks
+  // listing the device sets in the same order.
+  std::vector<std::thread> threads;
+  threads.reserve(creations.size());
+  for (auto& creation : creations) {
+    threads.emplace_back([&creation, stream_id]() {
+      OF_CUDA_CHECK(cudaSetDevice(creation.dev));
+      std::vector<std::pair<int64_t, int64_t>> device_vec(creation.device_set->cbegin(),
+                                                          creation.device_set->cend());
+      std::sort(device_vec.begin(), device_vec.end(), CompareDeviceSetPair);
+      CreateNcclComm(&creation.comm, creation.dev, GetNcclUniqueIdRpcKey(device_vec, stream_id),
+                     device_vec);
+    });
+  }
+  for (auto& thread : threads) { thread.join(); }
   {
     std::lock_guard<std::mutex> lock(mutex_);
-    device7stream2device_id2comm_[key][dev] = comm;
+    for (const auto& creation : creations) {
+      device_set7stream2device_id2comm_[std::make_pair(*creation.device_set, stream_id)]
+                                       [creation.dev] = creation.comm;
+    }
   }
-  return comm;
+}
+
+void EagerNcclCommMgr::CreateCommsForParallelDesc(const ParallelDesc& parallel_desc,
+                                                  const int32_t stream_id) {
+  CHECK_EQ(parallel_desc.device_type(), DeviceType::kGPU);
+  const auto Device4ParallelId = [&](int64_t parallel_id) {
+    return std::make_pair(CHECK_JUST(parallel_desc.MachineId4ParallelId(parallel_id)),
+                          CHECK_JUST(parallel_desc.DeviceId4ParallelId(parallel_id)));
+  };
+  std::vector<DeviceSet> device_sets(1);
+  FOR_RANGE(int64_t, parallel_id, 0, parallel_desc.parallel_num()) {
+    device_sets.front().emplace(Device4ParallelId(parallel_id));
+  }
+  const Shape& hierarchy = *parallel_desc.hierarchy();
+  if (hierarchy.NumAxes() == 2) {
+    const int64_t num_groups = hierarchy.At(0);
+    const int64_t group_size = hierarchy.At(1);
+    FOR_RANGE(int64_t, group_id, 0, num_groups) {
+      device_sets.emplace_back();
+      FOR_RANGE(int64_t, id_in_group, 0, group_size) {
+        device_sets.back().emplace(Device4ParallelId(group_id * group_size + id_in_group));
+      }
+    }
+    FOR_RANGE(int64_t, id_in_group, 0, group_size) {
+      device_sets.emplace_back();
+      FOR_RANGE(int64_t, group_id, 0, num_groups) {
+        device_sets.back().emplace(Device4ParallelId(group_id * group_size + id_in_group));
+      }
+    }
+  }
+  // groups of a single device have no peers to talk to
+  device_sets.erase(std::remove_if(device_sets.begin(), device_sets.end(),
+                                   [](const DeviceSet& device_set) {
+                                     return device_set.size() <= 1;
+                                   }),
+                    device_sets.end());
+  CreateCommsForDeviceSets(device_sets, stream_id);
 }
 
 }  // namespace oneflow
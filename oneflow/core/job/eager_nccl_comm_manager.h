@@ -18,6 +18,7 @@ limitations under the License.
 
 #include "oneflow/core/common/util.h"
 #include "oneflow/core/job/plan.pb.h"
+#include "oneflow/core/job/parallel_desc.h"
 
 #ifdef WITH_CUDA
 
@@ -34,13 +35,29 @@ class EagerNcclCommMgr final {
   ncclComm_t GetCommForDeviceAndStreamId(const std::set<std::pair<int64_t, int64_t>>& device_set,
                                          const int32_t stream_id);
 
+  // Creates, concurrently, the communicators of every local device in `device_sets' that are not
+  // cached yet. All ranks of a device set must call this (or the Get methods) for it to return.
+  // stream_id == kDefaultStreamId warms up the communicators returned by GetCommForDevice.
+  void CreateCommsForDeviceSets(
+      const std::vector<std::set<std::pair<int64_t, int64_t>>>& device_sets,
+      const int32_t stream_id);
+  // Warms up the device set of the whole `parallel_desc' and, for a 2D hierarchy, the device sets
+  // of its groups along both axes, which are used by the nccl logical 2D boxing kernels.
+  void CreateCommsForParallelDesc(const ParallelDesc& parallel_desc, const int32_t stream_id);
+
+  static const int32_t kDefaultStreamId = -1;
+
  private:
   friend class Global<EagerNcclCommMgr>;
   EagerNcclCommMgr() = default;
 
-  std::map<std::set<std::pair<int64_t, int64_t>>, HashMap<int64_t, ncclComm_t>>
-      device_set2device_id2comm_;
-  std::map<std::string, HashMap<int64_t, ncclComm_t>> device7stream2device_id2comm_;
+  using DeviceSet = std::set<std::pair<int64_t, int64_t>>;
+
+  ncclComm_t GetOrCreateComm(const DeviceSet& device_set, const int32_t stream_id);
+
+  // stream_id kDefaultStreamId is shared by eager and lazy collectives without a stream hint
+  std::map<std::pair<DeviceSet, int32_t>, HashMap<int64_t, ncclComm_t>>
+      device_set7stream2device_id2comm_;
   std::mutex mutex_;
 };
 
@@ -16,6 +16,7 @@ limitations under the License.
 #ifdef WITH_CUDA
 #include <cuda.h>
 #endif  // WITH_CUDA
+#include <chrono>
 #include <thread>
 #include "oneflow/core/thread/thread_pool.h"
 #include "oneflow/core/job/env_global_objects_scope.h"
@@ -32,6 +33,7 @@ limitations under the License.
 #include "oneflow/core/job/job_build_and_infer_ctx_mgr.h"
 #include "oneflow/core/job/eager_nccl_comm_manager.h"
 #include "oneflow/core/device/cudnn_conv_util.h"
+#include "oneflow/core/device/cublas_lt_util.h"
 #include "oneflow/core/rpc/include/manager.h"
 #include "oneflow/core/transport/transport.h"
 #include "oneflow/core/device/node_device_descriptor_manager.h"
@@ -42,6 +44,7 @@ limitations under the License.
 #include "oneflow/core/comm_network/comm_network.h"
 #include "oneflow/core/comm_network/epoll/epoll_comm_network.h"
 #include "oneflow/core/comm_network/ibverbs/ibverbs_comm_network.h"
+#include "oneflow/core/profiler/metrics_exporter.h"
 #ifdef WITH_RDMA
 #include "oneflow/core/platform/include/ibv.h"
 #endif  // WITH_RDMA
@@ -109,6 +112,33 @@ void ClearAllSymbolAndIdCache() {
   Global<symbol::IdCache<cfg::OpNodeSignature>>::Get()->ClearAll();
 }
 
+// Logs how long each step of the env initialization takes when ONEFLOW_DEBUG_STARTUP_TIME is set.
+class StartupTimer final {
+ public:
+  StartupTimer()
+      : enabled_(ParseBooleanFromEnv("ONEFLOW_DEBUG_STARTUP_TIME", false)),
+        start_(std::chrono::steady_clock::now()),
+        last_(start_) {}
+  ~StartupTimer() = default;
+
+  void Step(const char* name) {
+    if (!enabled_) { return; }
+    const auto now = std::chrono::steady_clock::now();
+    LOG(INFO) << "env init: " << name << " took " << MilliSeconds(now - last_) << " ms, "
+              << MilliSeconds(now - start_) << " ms in total";
+    last_ = now;
+  }
+
+ private:
+  static double MilliSeconds(std::chrono::steady_clock::duration duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+  }
+
+  bool enabled_;
+  std::chrono::steady_clock::time_point start_;
+  std::chrono::steady_clock::time_point last_;
+};
+
 #if defined(__linux__) && defined(WITH_RDMA)
 
 bool CommNetIBEnabled() {
@@ -126,8 +156,10 @@ bool CommNetIBEnabled() {
 
 Maybe<void> EnvGlobalObjectsScope::Init(const EnvProto& env_proto) {
   InitLogging(env_proto.cpp_logging_conf());
+  StartupTimer timer;
 #ifdef WITH_CUDA
   InitGlobalCudaDeviceProp();
+  timer.Step("cuda runtime");
 #endif
   Global<EnvDesc>::New(env_proto);
   Global<ProcessCtx>::New();
@@ -161,6 +193,7 @@ Maybe<void> EnvGlobalObjectsScope::Init(const EnvProto& env_proto) {
   CHECK_JUST(Global<RpcManager>::Get()->CreateServer());
   CHECK_JUST(Global<RpcManager>::Get()->Bootstrap());
   CHECK_JUST(Global<RpcManager>::Get()->CreateClient());
+  timer.Step("rpc bootstrap");
   Global<ResourceDesc, ForEnv>::New(GetDefaultResource(env_proto),
                                     GlobalProcessCtx::NumOfProcessPerNode());
   Global<ResourceDesc, ForSession>::New(GetDefaultResource(env_proto),
@@ -170,13 +203,23 @@ Maybe<void> EnvGlobalObjectsScope::Init(const EnvProto& env_proto) {
   if (Global<ResourceDesc, ForEnv>::Get()->enable_debug_mode()) {
     Global<device::NodeDeviceDescriptorManager>::Get()->DumpSummary("devices");
   }
+  timer.Step("device descriptors");
   Global<ThreadPool>::New(Global<ResourceDesc, ForSession>::Get()->ComputeThreadPoolSize());
+  // processes on a node listen on consecutive ports starting from ONEFLOW_METRICS_EXPORTER_PORT
+  const int64_t metrics_exporter_port = ParseIntegerFromEnv("ONEFLOW_METRICS_EXPORTER_PORT", 0);
+  if (metrics_exporter_port > 0) {
+    Global<profiler::MetricsExporter>::New(metrics_exporter_port + GlobalProcessCtx::LocalRank());
+  }
 #ifdef WITH_CUDA
   Global<EagerNcclCommMgr>::New();
   Global<CudnnConvAlgoCache>::New();
+#ifdef WITH_CUBLASLT_EPILOGUE
+  Global<CublasLtMatmulAlgoCache>::New();
+#endif
 #endif
   Global<vm::VirtualMachineScope>::New(Global<ResourceDesc, ForSession>::Get()->resource());
   Global<EagerJobBuildAndInferCtxMgr>::New();
+  timer.Step("virtual machine");
   if (!Global<ResourceDesc, ForSession>::Get()->enable_dry_run()) {
 #ifdef __linux__
     Global<EpollCommNet>::New();
@@ -195,6 +238,7 @@ Maybe<void> EnvGlobalObjectsScope::Init(const EnvProto& env_proto) {
 #endif  // __linux__
     }
   }
+  timer.Step("comm net");
   return Maybe<void>::Ok();
 }
 
@@ -213,9 +257,13 @@ EnvGlobalObjectsScope::~EnvGlobalObjectsScope() {
   Global<EagerJobBuildAndInferCtxMgr>::Delete();
   Global<vm::VirtualMachineScope>::Delete();
 #ifdef WITH_CUDA
+#ifdef WITH_CUBLASLT_EPILOGUE
+  Global<CublasLtMatmulAlgoCache>::Delete();
+#endif
   Global<CudnnConvAlgoCache>::Delete();
   Global<EagerNcclCommMgr>::Delete();
 #endif
+  Global<profiler::MetricsExporter>::Delete();
   Global<ThreadPool>::Delete();
   if (Global<ResourceDesc, ForSession>::Get() != nullptr) {
     Global<ResourceDesc, ForSession>::Delete();
@@ -339,8 +339,22 @@ void GenMemBlockAndChunk4Plan(Plan* plan) {
   }
 }
 
+std::string OpName4TaskProto(const TaskProto& task_proto) {
+  // a task running a chain of ops is named after its last op, as CompTaskNode::op() is
+  const ExecSequence& exec_sequence = task_proto.exec_sequence();
+  const KernelConf& kernel_conf =
+      exec_sequence.exec_node(exec_sequence.exec_node_size() - 1).kernel_conf();
+  if (kernel_conf.has_op_attribute_ref()) { return kernel_conf.op_attribute_ref(); }
+  return kernel_conf.op_attribute().op_conf().name();
+}
+
 }  // namespace
 
+std::string RegstNumHintKey(const std::string& job_name, const std::string& op_name,
+                            const std::string& regst_name, int64_t parallel_id) {
+  return job_name + "/" + op_name + "/" + regst_name + "/" + std::to_string(parallel_id);
+}
+
 uint64_t Improver::AvailableMemSize(int64_t machine_id, int64_t memory_zone_id) const {
   uint64_t mem_size = amd_.machine_amd(machine_id).zone_size(memory_zone_id);
   const ResourceDesc* resource_desc = Global<ResourceDesc, ForSession>::Get();
@@ -477,6 +491,84 @@ Maybe<void> Improver::ForEachImprovedRegstNum(
   return Maybe<void>::Ok();
 }
 
+Maybe<void> Improver::GenRegstNumHints(const AvailableMemDesc& amd, const Plan& plan,
+                                       const ChainActGraph& graph, RegstNumHints* hints) {
+  amd_ = amd;
+  const double base_ii = graph.CalcBaseII();
+  if (base_ii <= 0) { return Maybe<void>::Ok(); }
+  auto PathDurations4RegstDescId = MakeGetterPathDurations4RegstDescId(graph);
+  auto PathIIScales4RegstDescId = MakeGetterPathIIScales4RegstDescId(graph);
+  HashSet<int64_t> critical_actor_ids;
+  graph.ForEachActIdCriticalPath(
+      [&](int64_t act_id, double duration, const std::vector<const ChainActNode*>& path) {
+        for (const ChainActNode* node : path) {
+          node->ForEachActEvent(
+              [&](const ActEvent* act_event) { critical_actor_ids.insert(act_event->actor_id()); });
+        }
+      });
+  std::vector<std::vector<int64_t>> mz2free_size(amd_.machine_amd_size());
+  FOR_RANGE(int64_t, machine_id, 0, amd_.machine_amd_size()) {
+    FOR_RANGE(int64_t, mem_zone_id, 0, amd_.machine_amd(machine_id).zone_size_size()) {
+      mz2free_size.at(machine_id).push_back(AvailableMemSize(machine_id, mem_zone_id));
+    }
+  }
+  for (const ChunkProto& chunk : plan.block_chunk_list().chunk()) {
+    mz2free_size.at(chunk.machine_id()).at(GetMemoryZoneId(chunk.mem_case())) -= chunk.mem_size();
+  }
+  for (const MemBlockProto& mem_block : plan.block_chunk_list().mem_block()) {
+    if (mem_block.has_chunk_id()) { continue; }
+    mz2free_size.at(mem_block.machine_id()).at(GetMemoryZoneId(mem_block.mem_case())) -=
+        mem_block.mem_size();
+  }
+
+  struct GrownRegst {
+    double path_duration;
+    const TaskProto* task;
+    const std::string* regst_name;
+    const RegstDescProto* regst_desc;
+    uint64_t regst_num;
+  };
+  std::vector<GrownRegst> grown_regsts;
+  for (const TaskProto& task : plan.task()) {
+    if (task.task_type() != TaskType::kNormalForward) { continue; }
+    if (critical_actor_ids.find(task.task_id()) == critical_actor_ids.end()) { continue; }
+    for (const auto& pair : task.produced_regst_desc()) {
+      const RegstDescProto& regst_desc = pair.second;
+      if (!regst_desc.regst_desc_type().has_data_regst_desc()) { continue; }
+      if (regst_desc.has_inplace_consumed_regst_desc_id()) { continue; }
+      const uint64_t regst_num =
+          CalcRegstNum(regst_desc, PathDurations4RegstDescId, base_ii, PathIIScales4RegstDescId);
+      if (regst_num <= regst_desc.register_num()) { continue; }
+      double path_duration = 0;
+      for (const auto& duration_pair : PathDurations4RegstDescId(regst_desc.regst_desc_id())) {
+        path_duration = std::max(path_duration, duration_pair.second);
+      }
+      grown_regsts.push_back({path_duration, &task, &pair.first, &regst_desc, regst_num});
+    }
+  }
+  std::sort(grown_regsts.begin(), grown_regsts.end(),
+            [](const GrownRegst& lhs, const GrownRegst& rhs) {
+              return lhs.path_duration > rhs.path_duration;
+            });
+  for (const GrownRegst& grown : grown_regsts) {
+    // a regst with more than one register leaves the shared memory blocks, count all of them
+    const int64_t size = RoundUp(
+        grown.regst_num * RtRegstDesc(*grown.regst_desc).MainByteSize4OneRegst(),
+        kCudaMemAllocAlignSize);
+    int64_t* free_size = &mz2free_size.at(grown.task->machine_id())
+                              .at(GetMemoryZoneId(grown.regst_desc->mem_case()));
+    if (size > *free_size) { continue; }
+    *free_size -= size;
+    const std::string& job_name =
+        plan.job_confs().job_id2job_conf().at(grown.task->job_id()).job_name();
+    const std::string key =
+        RegstNumHintKey(job_name, OpName4TaskProto(*grown.task), *grown.regst_name,
+                        grown.task->parallel_ctx().parallel_id());
+    (*hints->mutable_regst_key2register_num())[key] = grown.regst_num;
+  }
+  return Maybe<void>::Ok();
+}
+
 void Improver::Init(const AvailableMemDesc& amd, const Plan& naive_plan) {
   start_mem_block_id_ = Global<IDMgr>::Get()->NewMemBlockId();
   amd_ = amd;
@@ -20,16 +20,26 @@ limitations under the License.
 #include "oneflow/core/common/protobuf.h"
 #include "oneflow/core/memory/memory_case.pb.h"
 #include "oneflow/core/job/available_memory_desc.pb.h"
+#include "oneflow/core/job/regst_num_hints.pb.h"
 #include "oneflow/core/graph/chain_act_graph.h"
 
 namespace oneflow {
 
+std::string RegstNumHintKey(const std::string& job_name, const std::string& op_name,
+                            const std::string& regst_name, int64_t parallel_id);
+
 class Improver final {
  public:
   OF_DISALLOW_COPY_AND_MOVE(Improver);
   Improver() : start_mem_block_id_(-1) {}
   ~Improver() = default;
 
+  // Finds the regsts produced by the normal forward actors on the critical paths of `graph' that
+  // need more registers to keep up with the bottleneck work stream, and grows them, the ones with
+  // the longest consumer paths first, while the memory left by `plan' in their zones allows.
+  Maybe<void> GenRegstNumHints(const AvailableMemDesc& amd, const Plan& plan,
+                               const ChainActGraph& graph, RegstNumHints* hints);
+
  private:
   void Init(const AvailableMemDesc& amd, const Plan& naive_plan);
   Maybe<void> ForEachImprovedRegstNum(
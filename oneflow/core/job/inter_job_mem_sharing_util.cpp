@@ -70,11 +70,49 @@ HashMap<std::string, HashSet<int64_t>> GetInterfaceOpName2JobIds(
   return interface_op_name2job_ids;
 }
 
+bool IsConcurrentJob(const Job& job) {
+  if (!job.job_conf().enable_concurrent_execution()) { return false; }
+  CHECK(job.job_conf().has_predict_conf())
+      << "enable_concurrent_execution requires a predict job: " << job.job_conf().job_name();
+  return true;
+}
+
+HashMap<std::string, std::vector<int64_t>> GetMemSharingGroup2JobIds(
+    const std::vector<std::shared_ptr<Job>>& jobs) {
+  HashMap<std::string, std::vector<int64_t>> group2job_ids;
+  FOR_RANGE(int64_t, i, 0, jobs.size()) {
+    const std::string& group = jobs.at(i)->job_conf().mem_sharing_group();
+    if (!group.empty()) { group2job_ids[group].push_back(i); }
+  }
+  return group2job_ids;
+}
+
 std::vector<HashSet<int64_t>> InitJobId2MutualExclusionJobIds(
     const std::vector<std::shared_ptr<Job>>& jobs) {
   int64_t job_size = jobs.size();
   std::vector<HashSet<int64_t>> job_id2mutual_exclusion_ids(job_size);
+  HashSet<std::string> variable_op_names;
+  for (const auto& job : jobs) {
+    for (const auto& op : job->net().op()) {
+      if (op.has_variable_conf()) { variable_op_names.emplace(op.name()); }
+    }
+  }
   for (const auto& pair : GetInterfaceOpName2JobIds(jobs)) {
+    const bool is_variable = variable_op_names.find(pair.first) != variable_op_names.end();
+    for (int64_t first_id : pair.second) {
+      for (int64_t second_id : pair.second) {
+        if (first_id == second_id) { continue; }
+        // concurrent jobs only read the variables they share
+        if (is_variable && IsConcurrentJob(*jobs.at(first_id))
+            && IsConcurrentJob(*jobs.at(second_id))) {
+          continue;
+        }
+        job_id2mutual_exclusion_ids[first_id].emplace(second_id);
+      }
+    }
+  }
+  // jobs declared in one mem sharing group are mutually exclusive even if they are concurrent
+  for (const auto& pair : GetMemSharingGroup2JobIds(jobs)) {
     for (int64_t first_id : pair.second) {
       for (int64_t second_id : pair.second) {
         if (first_id != second_id) { job_id2mutual_exclusion_ids[first_id].emplace(second_id); }
@@ -121,6 +159,11 @@ std::vector<HashSet<int64_t>> GetMutualExclusionJobGroups(
       }
     }
   }
+  std::vector<int64_t> job_id2declared_peer_ids(job_size, -1);
+  for (const auto& pair : GetMemSharingGroup2JobIds(jobs)) {
+    const int64_t first_job_id = pair.second.front();
+    for (int64_t job_id : pair.second) { job_id2declared_peer_ids.at(job_id) = first_job_id; }
+  }
   int64_t mem_share_group_num = 0;
   std::vector<int64_t> job_id2mem_share_group_id(job_size, -1);
   FOR_RANGE(int64_t, this_job_id, 0, job_size) {
@@ -129,6 +172,15 @@ std::vector<HashSet<int64_t>> GetMutualExclusionJobGroups(
       int64_t group_id = job_id2mem_share_group_id[enable_parallel_job_id];
       if (group_id != -1) { mem_share_group_id_used.emplace(group_id); }
     }
+    // prefer the group of the first job declared in the same mem sharing group
+    const int64_t peer_id = job_id2declared_peer_ids.at(this_job_id);
+    if (peer_id != -1 && peer_id != this_job_id) {
+      const int64_t peer_group_id = job_id2mem_share_group_id.at(peer_id);
+      if (mem_share_group_id_used.find(peer_group_id) == mem_share_group_id_used.end()) {
+        job_id2mem_share_group_id[this_job_id] = peer_group_id;
+        continue;
+      }
+    }
     FOR_RANGE(int64_t, this_group_id, 0, mem_share_group_num) {
       if (mem_share_group_id_used.find(this_group_id) == mem_share_group_id_used.end()) {
         job_id2mem_share_group_id[this_job_id] = this_group_id;
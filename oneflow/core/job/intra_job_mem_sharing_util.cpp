@@ -13,6 +13,8 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 */
+#include <chrono>
+#include <numeric>
 #include "oneflow/core/job/intra_job_mem_sharing_util.h"
 #include "oneflow/core/common/blocking_counter.h"
 #include "oneflow/core/common/str_util.h"
@@ -29,6 +31,7 @@ enum MemAllocAlgoType {
   kMemSizeFirstAlgo = 0,
   kMutualExclusionFirstAlgo = 1,
   kTimeLineAlgo = 2,
+  kBestFitOffsetAlgo = 3,
 };
 
 }  // namespace oneflow
@@ -688,6 +691,233 @@ void MemReusedAlgorithm_TimeLineAlgo(
   result->mem_block_size = bfc_allocator.buffer_size();
 }
 
+struct RegstLifetime {
+  RegstDescProto* regst;
+  int64_t size;
+  int64_t alloc_index;
+  int64_t free_index;
+};
+
+std::vector<RegstLifetime> GenRegstLifetimes(
+    const std::vector<HashSet<RegstDescProto*>>& alloc_regsts_timeline,
+    const std::vector<HashSet<RegstDescProto*>>& free_regsts_timeline) {
+  CHECK_EQ(alloc_regsts_timeline.size(), free_regsts_timeline.size());
+  HashMap<RegstDescProto*, int64_t> regst2lifetime_id;
+  std::vector<RegstLifetime> lifetimes;
+  for (int64_t i = 0; i < alloc_regsts_timeline.size(); ++i) {
+    for (RegstDescProto* regst : alloc_regsts_timeline.at(i)) {
+      CHECK(regst2lifetime_id.emplace(regst, lifetimes.size()).second);
+      RegstLifetime lifetime;
+      lifetime.regst = regst;
+      lifetime.size = RtRegstDesc(*regst).TotalMainByteSize4AllRegst();
+      lifetime.alloc_index = i;
+      lifetime.free_index = -1;
+      lifetimes.push_back(lifetime);
+    }
+    for (RegstDescProto* regst : free_regsts_timeline.at(i)) {
+      lifetimes.at(regst2lifetime_id.at(regst)).free_index = i;
+    }
+  }
+  for (const auto& lifetime : lifetimes) { CHECK_GE(lifetime.free_index, lifetime.alloc_index); }
+  return lifetimes;
+}
+
+// No placement is smaller than the bytes alive at the same time
+int64_t MemBlockSizeLowerBound(const std::vector<RegstLifetime>& lifetimes, int64_t timeline_size) {
+  std::vector<int64_t> deltas(timeline_size + 1, 0);
+  for (const auto& lifetime : lifetimes) {
+    deltas.at(lifetime.alloc_index) += lifetime.size;
+    deltas.at(lifetime.free_index + 1) -= lifetime.size;
+  }
+  int64_t lower_bound = 0;
+  int64_t alive_size = 0;
+  for (int64_t delta : deltas) {
+    alive_size += delta;
+    lower_bound = std::max(lower_bound, alive_size);
+  }
+  return lower_bound;
+}
+
+// Offset assignment of regsts with fixed lifetimes, i.e. the dynamic storage allocation problem.
+// Regsts are placed one by one into the smallest gap left by the placed regsts alive at the same
+// time, and an optional time limited branch and bound searches the bottom-left placements.
+class BestFitOffsetPacker final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(BestFitOffsetPacker);
+  BestFitOffsetPacker(
+      std::vector<RegstLifetime>&& lifetimes,
+      const HashMap<RegstDescProto*, std::vector<RegstDescProto*>>& regst2mutual_exclusion_regsts);
+  ~BestFitOffsetPacker() = default;
+
+  // Returns the mem block size and the offset of each lifetime
+  int64_t PlaceByOrder(const std::vector<int64_t>& order, std::vector<int64_t>* offsets) const;
+  // Improves `offsets' until `time_limit_ms' runs out or `lower_bound' is reached
+  int64_t Search(int64_t lower_bound, int64_t time_limit_ms, int64_t block_size,
+                 std::vector<int64_t>* offsets) const;
+  const std::vector<RegstLifetime>& lifetimes() const { return lifetimes_; }
+
+ private:
+  bool SearchPlacement(const std::vector<int64_t>& order, int64_t depth, int64_t cur_size,
+                       int64_t lower_bound, std::chrono::steady_clock::time_point deadline,
+                       std::vector<int64_t>* cur_offsets, int64_t* best_size,
+                       std::vector<int64_t>* best_offsets) const;
+
+  std::vector<RegstLifetime> lifetimes_;
+  std::vector<std::vector<int64_t>> id2mutual_exclusion_ids_;
+};
+
+BestFitOffsetPacker::BestFitOffsetPacker(
+    std::vector<RegstLifetime>&& lifetimes,
+    const HashMap<RegstDescProto*, std::vector<RegstDescProto*>>& regst2mutual_exclusion_regsts)
+    : lifetimes_(std::move(lifetimes)) {
+  HashMap<RegstDescProto*, int64_t> regst2id;
+  for (int64_t i = 0; i < lifetimes_.size(); ++i) {
+    CHECK(regst2id.emplace(lifetimes_.at(i).regst, i).second);
+  }
+  id2mutual_exclusion_ids_.resize(lifetimes_.size());
+  for (int64_t i = 0; i < lifetimes_.size(); ++i) {
+    for (RegstDescProto* regst : regst2mutual_exclusion_regsts.at(lifetimes_.at(i).regst)) {
+      id2mutual_exclusion_ids_.at(i).push_back(regst2id.at(regst));
+    }
+  }
+}
+
+int64_t BestFitOffsetPacker::PlaceByOrder(const std::vector<int64_t>& order,
+                                          std::vector<int64_t>* offsets) const {
+  offsets->assign(lifetimes_.size(), -1);
+  int64_t block_size = 0;
+  std::vector<std::pair<int64_t, int64_t>> occupied;
+  for (int64_t id : order) {
+    const int64_t size = lifetimes_.at(id).size;
+    occupied.clear();
+    for (int64_t mutual_id : id2mutual_exclusion_ids_.at(id)) {
+      const int64_t offset = offsets->at(mutual_id);
+      if (offset != -1) { occupied.emplace_back(offset, offset + lifetimes_.at(mutual_id).size); }
+    }
+    std::sort(occupied.begin(), occupied.end());
+    int64_t best_offset = -1;
+    int64_t best_gap = std::numeric_limits<int64_t>::max();
+    int64_t gap_begin = 0;
+    for (const auto& pair : occupied) {
+      const int64_t gap = pair.first - gap_begin;
+      if (gap >= size && gap < best_gap) {
+        best_gap = gap;
+        best_offset = gap_begin;
+      }
+      gap_begin = std::max(gap_begin, pair.second);
+    }
+    if (best_offset == -1) { best_offset = gap_begin; }
+    offsets->at(id) = best_offset;
+    block_size = std::max(block_size, best_offset + size);
+  }
+  return block_size;
+}
+
+bool BestFitOffsetPacker::SearchPlacement(const std::vector<int64_t>& order, int64_t depth,
+                                          int64_t cur_size, int64_t lower_bound,
+                                          std::chrono::steady_clock::time_point deadline,
+                                          std::vector<int64_t>* cur_offsets, int64_t* best_size,
+                                          std::vector<int64_t>* best_offsets) const {
+  if (std::chrono::steady_clock::now() > deadline) { return false; }
+  if (depth == order.size()) {
+    *best_size = cur_size;
+    *best_offsets = *cur_offsets;
+    return *best_size > lower_bound;
+  }
+  const int64_t id = order.at(depth);
+  const int64_t size = lifetimes_.at(id).size;
+  std::vector<std::pair<int64_t, int64_t>> occupied;
+  std::vector<int64_t> candidate_offsets{0};
+  for (int64_t mutual_id : id2mutual_exclusion_ids_.at(id)) {
+    const int64_t offset = cur_offsets->at(mutual_id);
+    if (offset == -1) { continue; }
+    occupied.emplace_back(offset, offset + lifetimes_.at(mutual_id).size);
+    candidate_offsets.push_back(occupied.back().second);
+  }
+  std::sort(candidate_offsets.begin(), candidate_offsets.end());
+  candidate_offsets.erase(std::unique(candidate_offsets.begin(), candidate_offsets.end()),
+                          candidate_offsets.end());
+  for (int64_t offset : candidate_offsets) {
+    const int64_t new_size = std::max(cur_size, offset + size);
+    if (new_size >= *best_size) { break; }
+    const bool is_overlapped =
+        std::any_of(occupied.begin(), occupied.end(), [&](const std::pair<int64_t, int64_t>& p) {
+          return offset < p.second && p.first < offset + size;
+        });
+    if (is_overlapped) { continue; }
+    cur_offsets->at(id) = offset;
+    const bool go_on = SearchPlacement(order, depth + 1, new_size, lower_bound, deadline,
+                                       cur_offsets, best_size, best_offsets);
+    cur_offsets->at(id) = -1;
+    if (!go_on) { return false; }
+  }
+  return true;
+}
+
+int64_t BestFitOffsetPacker::Search(int64_t lower_bound, int64_t time_limit_ms,
+                                    int64_t block_size, std::vector<int64_t>* offsets) const {
+  if (time_limit_ms <= 0 || block_size <= lower_bound) { return block_size; }
+  std::vector<int64_t> order(lifetimes_.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&](int64_t lhs, int64_t rhs) {
+    return lifetimes_.at(lhs).size > lifetimes_.at(rhs).size;
+  });
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::milliseconds(time_limit_ms);
+  std::vector<int64_t> cur_offsets(lifetimes_.size(), -1);
+  int64_t best_size = block_size;
+  SearchPlacement(order, 0, 0, lower_bound, deadline, &cur_offsets, &best_size, offsets);
+  return best_size;
+}
+
+void MemReusedAlgorithm_BestFitOffsetAlgo(
+    const std::vector<HashSet<RegstDescProto*>>& alloc_regsts_timeline,
+    const std::vector<HashSet<RegstDescProto*>>& free_regsts_timeline,
+    const HashMap<RegstDescProto*, std::vector<RegstDescProto*>>& regst2mutual_exclusion_regsts,
+    MemBlockResultInfo* result) {
+  const BestFitOffsetPacker packer(
+      GenRegstLifetimes(alloc_regsts_timeline, free_regsts_timeline),
+      regst2mutual_exclusion_regsts);
+  const std::vector<RegstLifetime>& lifetimes = packer.lifetimes();
+  const int64_t lower_bound = MemBlockSizeLowerBound(lifetimes, alloc_regsts_timeline.size());
+  const auto Length = [&](int64_t id) {
+    return lifetimes.at(id).free_index - lifetimes.at(id).alloc_index;
+  };
+  std::vector<int64_t> size_first_order(lifetimes.size());
+  std::iota(size_first_order.begin(), size_first_order.end(), 0);
+  std::vector<int64_t> length_first_order = size_first_order;
+  std::sort(size_first_order.begin(), size_first_order.end(), [&](int64_t lhs, int64_t rhs) {
+    if (lifetimes.at(lhs).size != lifetimes.at(rhs).size) {
+      return lifetimes.at(lhs).size > lifetimes.at(rhs).size;
+    }
+    return Length(lhs) > Length(rhs);
+  });
+  std::sort(length_first_order.begin(), length_first_order.end(), [&](int64_t lhs, int64_t rhs) {
+    if (Length(lhs) != Length(rhs)) { return Length(lhs) > Length(rhs); }
+    return lifetimes.at(lhs).size > lifetimes.at(rhs).size;
+  });
+  std::vector<int64_t> offsets;
+  int64_t block_size = packer.PlaceByOrder(size_first_order, &offsets);
+  if (block_size > lower_bound) {
+    std::vector<int64_t> length_first_offsets;
+    const int64_t length_first_size =
+        packer.PlaceByOrder(length_first_order, &length_first_offsets);
+    if (length_first_size < block_size) {
+      block_size = length_first_size;
+      offsets.swap(length_first_offsets);
+    }
+  }
+  const int64_t time_limit_ms = GlobalJobDesc()
+                                    .job_conf()
+                                    .memory_allocation_algorithm_conf()
+                                    .best_fit_offset_algo_search_time_limit_ms();
+  block_size = packer.Search(lower_bound, time_limit_ms, block_size, &offsets);
+  for (int64_t i = 0; i < lifetimes.size(); ++i) {
+    CHECK(result->regst_desc2offset.emplace(lifetimes.at(i).regst, offsets.at(i)).second);
+  }
+  result->mem_block_size = std::max<int64_t>(block_size, 1);
+}
+
 void SelectAlgorithmGenMemBlockOffset4Regsts(
     MemAllocAlgoType algo_id, const std::vector<HashSet<RegstDescProto*>>& alloc_regsts_timeline,
     const std::vector<HashSet<RegstDescProto*>>& free_regsts_timeline,
@@ -705,6 +935,10 @@ void SelectAlgorithmGenMemBlockOffset4Regsts(
     case kTimeLineAlgo:
       MemReusedAlgorithm_TimeLineAlgo(alloc_regsts_timeline, free_regsts_timeline, result);
       break;
+    case kBestFitOffsetAlgo:
+      MemReusedAlgorithm_BestFitOffsetAlgo(alloc_regsts_timeline, free_regsts_timeline,
+                                           regst2mutual_exclusion_regsts, result);
+      break;
     default: UNIMPLEMENTED();
   }
   CHECK_GT(result->mem_block_size, 0);
@@ -718,6 +952,7 @@ int64_t CountMemAllocAlgoNum() {
   if (mem_alloc_algo_conf.use_mem_size_first_algo()) { ++ret; }
   if (mem_alloc_algo_conf.use_mutual_exclusion_first_algo()) { ++ret; }
   if (mem_alloc_algo_conf.use_time_line_algo()) { ++ret; }
+  if (mem_alloc_algo_conf.use_best_fit_offset_algo()) { ++ret; }
   CHECK_GE(ret, 0);
   return ret;
 }
@@ -735,6 +970,9 @@ void InitAlgo2Result(HashMap<MemAllocAlgoType, MemBlockResultInfo>* algo2result)
   if (mem_alloc_algo_conf.use_time_line_algo()) {
     CHECK(algo2result->emplace(kTimeLineAlgo, MemBlockResultInfo()).second);
   }
+  if (mem_alloc_algo_conf.use_best_fit_offset_algo()) {
+    CHECK(algo2result->emplace(kBestFitOffsetAlgo, MemBlockResultInfo()).second);
+  }
 }
 
 }  // namespace
@@ -798,12 +1036,20 @@ void IntraJobMemSharingUtil::InferMemBlockId4MemReusedRegst(
   // step 3: choose best one for each mem chain and set offset for inplace consumer regst
   for (const auto& pair : mem_chain2algo2result) {
     const MemBlockResultInfo* best_result = nullptr;
+    MemAllocAlgoType best_algo_id = kMemSizeFirstAlgo;
     for (const auto& algo_result_pair : pair.second) {
       if (!best_result || algo_result_pair.second.mem_block_size < best_result->mem_block_size) {
         best_result = &algo_result_pair.second;
+        best_algo_id = algo_result_pair.first;
       }
     }
     CHECK(best_result != nullptr);
+    const int64_t lower_bound = MemBlockSizeLowerBound(
+        GenRegstLifetimes(mem_chain2task2alloc_regsts.at(pair.first),
+                          mem_chain2task2free_regsts.at(pair.first)),
+        mem_chain2task2alloc_regsts.at(pair.first).size());
+    LOG(INFO) << "mem chain " << pair.first << " mem block size " << best_result->mem_block_size
+              << " bytes by algo " << best_algo_id << ", lower bound " << lower_bound << " bytes";
     int64_t mem_block_id = Global<IDMgr>::Get()->NewMemBlockId();
     CHECK_EQ(mem_chain2mem_reused_regsts.at(pair.first).size(),
              (best_result->regst_desc2offset.size()
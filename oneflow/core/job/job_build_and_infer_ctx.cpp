@@ -20,6 +20,7 @@ limitations under the License.
 #include "oneflow/core/framework/scope_util.h"
 #include "oneflow/core/job/foreign_callback.h"
 #include "oneflow/core/job/job_build_and_infer_ctx.h"
+#include "oneflow/core/job/compile_report.h"
 #include "oneflow/core/job/mirrored_sig_infer_hint.h"
 #include "oneflow/core/job/scope.h"
 #include "oneflow/core/job_rewriter/autograd.h"
@@ -976,7 +977,10 @@ Maybe<void> LazyJobBuildAndInferCtx::Complete() {
   auto scope = std::make_unique<GlobalJobDescScope>(mut_job()->job_conf(), job_id());
   JobPassCtx job_pass_ctx(GlobalJobDesc());
   auto DoPass = [&](const std::string& pass_name) -> Maybe<void> {
-    return JobPass4Name(pass_name)(mut_job(), &job_pass_ctx);
+    const double start = GetCurTime();
+    JUST(JobPass4Name(pass_name)(mut_job(), &job_pass_ctx));
+    RecordJobPassTime(job().job_conf().job_name(), pass_name, (GetCurTime() - start) / 1e9);
+    return Maybe<void>::Ok();
   };
   if (GlobalJobDesc().Bool("__is_user_function__")) {
     JUST(DoPass("ModelUpdateConfCompatiblePass"));
@@ -984,18 +988,26 @@ Maybe<void> LazyJobBuildAndInferCtx::Complete() {
     JUST(DoPass("AddInputOutputOpsPass"));
     JUST(DoPass("NormalizationExponentialAverageAutoTickPass"));
     JUST(DoPass("GradientAccumulationRewritePass"));
+    JUST(DoPass("ChannelsLastLayoutPass"));
+    JUST(DoPass("SequenceParallelPass"));
 #ifdef WITH_CUDA
     JUST(DoPass("AutoMixedPrecision"));
     JUST(DoPass("PruneAmpWhiteIdentityOpPass"));
+    JUST(DoPass("Fp8MatmulPass"));
 #endif
+    JUST(DoPass("FuseMatmulBiasAddActivationPass"));
+    JUST(DoPass("FuseConvBiasAddReluPass"));
     JUST(DoPass("OptimizerPlacementOptimizationPass"));
     JUST(DoPass("DynamicLossScaleSchedulePass"));
     JUST(DoPass("AutoTrainStep"));
     JUST(DoPass("AutoLearningRate"));
     JUST(DoPass("QuantAwareTraining"));
+    JUST(DoPass("Int8InferencePass"));
     JUST(DoPass("GenerateBackwardAndOptimizerOpConfs"));
     JUST(DoPass("AddSspVariableProxy"));
+    JUST(DoPass("ConstantFoldingPass"));
     JUST(DoPass("CheckpointingPass"));
+    JUST(DoPass("ActivationOffloadingPass"));
     JUST(DoPass("CudnnFusedNormalizationAddReluPass"));
     JUST(DoPass("PruneCastToStaticShapeOpsPass"));
     JUST(DoPass("FuseAddToOutputPass"));
@@ -1008,8 +1020,12 @@ Maybe<void> LazyJobBuildAndInferCtx::Complete() {
     JUST(DoPass("AddLbiDiffWatcherOpConfs"));
     JUST(DoPass("FuseCastScalePass"));
     JUST(DoPass("PruneParallelCastOpsPass"));
+    JUST(DoPass("FuseElementwiseOpsPass"));
     JUST(DoPass("FuseUpdateOpsPass"));
+    JUST(DoPass("AutoParallelPass"));
     JUST(DoPass("PipelineBufferPass"));
+    JUST(DoPass("DataPrefetchBufferPass"));
+    JUST(DoPass("BranchComputeStreamPass"));
     JUST(DoPass("DumpVariableInfoPass"));
   }
   JUST(DoPass("DumpBlobParallelConfPass"));
@@ -55,7 +55,11 @@ class JobDesc final {
   bool IsPredict() const { return job_conf_.has_predict_conf(); }
   bool enable_reuse_mem() const { return job_conf_.enable_reuse_mem(); }
   bool enable_inplace() const { return job_conf_.enable_inplace(); }
+  bool enable_actor_chain_merging() const { return job_conf_.enable_actor_chain_merging(); }
   bool enable_auto_mixed_precision() const { return job_conf_.enable_auto_mixed_precision(); }
+  DataType auto_mixed_precision_data_type() const {
+    return job_conf_.auto_mixed_precision_data_type();
+  }
   bool do_parallel_cast_before_widening_type_cast() const {
     return job_conf_.do_parallel_cast_before_widening_type_cast();
   };
@@ -63,6 +67,16 @@ class JobDesc final {
   bool prune_cast_to_static_shape_ops() const { return job_conf_.prune_cast_to_static_shape_ops(); }
   bool prune_amp_white_identity_ops() const { return job_conf_.prune_amp_white_identity_ops(); }
   int64_t cudnn_buf_limit_mbyte() const { return job_conf_.cudnn_buf_limit_mbyte(); }
+  int64_t auto_checkpointing_memory_budget_mbyte() const {
+    return job_conf_.auto_checkpointing_memory_budget_mbyte();
+  }
+
+  bool enable_auto_parallel() const { return job_conf_.enable_auto_parallel(); }
+  const AutoParallelConf& auto_parallel_conf() const { return job_conf_.auto_parallel_conf(); }
+  bool enable_activation_offloading() const { return job_conf_.enable_activation_offloading(); }
+  const ActivationOffloadingConf& activation_offloading_conf() const {
+    return job_conf_.activation_offloading_conf();
+  }
 
   bool has_xrt_config() const { return job_conf_.has_xrt_config(); }
   const XrtConfig& xrt_config() const { return job_conf_.xrt_config(); }
@@ -33,7 +33,9 @@ limitations under the License.
 #include "oneflow/core/job/model_io_v2_job.h"
 #include "oneflow/core/job/model_io_job.h"
 #include "oneflow/core/job/inter_job_mem_sharing_util.h"
+#include "oneflow/core/job/shape_bucket_util.h"
 #include "oneflow/core/job/plan_util.h"
+#include "oneflow/core/job/plan_cache.h"
 #include "oneflow/core/operator/interface_op_util.h"
 #include "oneflow/core/job/critical_section_desc.h"
 #include "oneflow/core/job/global_for.h"
@@ -42,6 +44,7 @@ limitations under the License.
 #include "oneflow/core/graph/boxing/collective_boxing_util.h"
 #include "oneflow/core/profiler/profiler.h"
 #include "oneflow/core/job/sbp_parallel.cfg.h"
+#include "oneflow/core/job/compile_report.h"
 
 namespace std {
 
@@ -142,6 +145,7 @@ void PushPlan(const std::string& plan_name, Plan&& plan) {
   *(cluster_thrd_ids.mutable_machine_id2thrd_ids()) = HashMap2PbMap(machine_id2thrd_ids);
   Global<CtrlClient>::Get()->PushKV(cluster_thrd_ids_key(plan_name), cluster_thrd_ids);
 
+  std::vector<std::pair<std::string, std::string>> sub_plan_kvs;
   for (std::pair<const std::pair<int64_t, int64_t>, std::list<oneflow::TaskProto>>& pair :
        mchn_thrd_id2task_protos) {
     SubPlan sub_plan;
@@ -150,9 +154,10 @@ void PushPlan(const std::string& plan_name, Plan&& plan) {
       sub_plan.mutable_task()->Add(std::move(pair.second.front()));
       pair.second.pop_front();
     }
-    Global<CtrlClient>::Get()->PushKV(sub_plan_key(plan_name, pair.first.first, pair.first.second),
-                                      sub_plan);
+    sub_plan_kvs.emplace_back(sub_plan_key(plan_name, pair.first.first, pair.first.second), "");
+    sub_plan.SerializeToString(&sub_plan_kvs.back().second);
   }
+  Global<CtrlClient>::Get()->MultiPushKV(sub_plan_kvs);
 
   for (const auto& mem_block : plan.block_chunk_list().mem_block()) {
     *machine_id2block7chunk[mem_block.machine_id()].add_mem_block() = mem_block;
@@ -160,15 +165,18 @@ void PushPlan(const std::string& plan_name, Plan&& plan) {
   for (const auto& chunk : plan.block_chunk_list().chunk()) {
     *machine_id2block7chunk[chunk.machine_id()].add_chunk() = chunk;
   }
+  std::vector<std::pair<std::string, std::string>> kvs;
+  const auto AddKV = [&](const std::string& key, const PbMessage& msg) {
+    kvs.emplace_back(key, "");
+    msg.SerializeToString(&kvs.back().second);
+  };
   for (const auto& pair : machine_id2block7chunk) {
-    Global<CtrlClient>::Get()->PushKV(block7chunk_key(plan_name, pair.first), pair.second);
+    AddKV(block7chunk_key(plan_name, pair.first), pair.second);
   }
-
-  Global<CtrlClient>::Get()->PushKV(ctrl_regst_desc_info_key(plan_name),
-                                    plan.ctrl_regst_desc_info());
-  Global<CtrlClient>::Get()->PushKV(job_id2job_conf(plan_name), plan.job_confs());
-  Global<CtrlClient>::Get()->PushKV(GetCollectiveBoxingPlanKey(plan_name),
-                                    plan.collective_boxing_plan());
+  AddKV(ctrl_regst_desc_info_key(plan_name), plan.ctrl_regst_desc_info());
+  AddKV(job_id2job_conf(plan_name), plan.job_confs());
+  AddKV(GetCollectiveBoxingPlanKey(plan_name), plan.collective_boxing_plan());
+  Global<CtrlClient>::Get()->MultiPushKV(kvs);
 }
 
 void PullPlan(const std::string& plan_name, Plan* plan) {
@@ -184,24 +192,24 @@ void PullPlan(const std::string& plan_name, Plan* plan) {
   for (auto thrd_id : thrd_id_vec) {
     SubPlan sub_plan;
     Global<CtrlClient>::Get()->PullKV(sub_plan_key(plan_name, machine_id, thrd_id), &sub_plan);
-    plan->mutable_task()->MergeFrom(sub_plan.task());
+    PbRpf<TaskProto>* tasks = plan->mutable_task();
+    tasks->Reserve(tasks->size() + sub_plan.task_size());
+    for (TaskProto& task : *sub_plan.mutable_task()) { *(tasks->Add()) = std::move(task); }
   }
-  CtrlRegstDescInfo ctrl_regst_desc_info;
-  Global<CtrlClient>::Get()->PullKV(ctrl_regst_desc_info_key(plan_name), &ctrl_regst_desc_info);
-  *(plan->mutable_ctrl_regst_desc_info()) = ctrl_regst_desc_info;
-  JobConfs job_confs;
-  Global<CtrlClient>::Get()->PullKV(job_id2job_conf(plan_name), &job_confs);
-  *(plan->mutable_job_confs()) = job_confs;
-  Global<CtrlClient>::Get()->PullKV(GetCollectiveBoxingPlanKey(plan_name),
-                                    plan->mutable_collective_boxing_plan());
-  MemBlockAndChunkList block7chunk;
-  Global<CtrlClient>::Get()->PullKV(block7chunk_key(plan_name, machine_id), &block7chunk);
-  plan->mutable_block_chunk_list()->CopyFrom(block7chunk);
+  std::vector<std::string> vals;
+  Global<CtrlClient>::Get()->MultiPullKV(
+      {ctrl_regst_desc_info_key(plan_name), job_id2job_conf(plan_name),
+       GetCollectiveBoxingPlanKey(plan_name), block7chunk_key(plan_name, machine_id)},
+      &vals);
+  CHECK(plan->mutable_ctrl_regst_desc_info()->ParseFromString(vals.at(0)));
+  CHECK(plan->mutable_job_confs()->ParseFromString(vals.at(1)));
+  CHECK(plan->mutable_collective_boxing_plan()->ParseFromString(vals.at(2)));
+  CHECK(plan->mutable_block_chunk_list()->ParseFromString(vals.at(3)));
   // pull op_attribute_info
   OpAttributeInfo op_attribute_info;
-  Global<CtrlClient>::Get()->PullKV("op_attribute_info", &op_attribute_info);
+  Global<CtrlClient>::Get()->PullImmutableKV("op_attribute_info", &op_attribute_info);
   // populate op_attribute_info
-  PlanUtil::PopulateOpAttibute(plan, op_attribute_info.job_id2op_attribute_ref_table());
+  PlanUtil::PopulateOpAttibute(plan, op_attribute_info.mutable_job_id2op_attribute_ref_table());
 }
 
 Maybe<void> CompileCurJobOnMaster(Job* job, Plan* plan, bool need_job_complete) {
@@ -209,7 +217,11 @@ Maybe<void> CompileCurJobOnMaster(Job* job, Plan* plan, bool need_job_complete)
   if (GlobalProcessCtx::IsThisProcessMaster()) {
     double start = GetCurTime();
     Compiler().Compile(job, plan, need_job_complete);
-    PlanUtil::GenMemBlockAndChunk4Plan(plan);
+    {
+      CompilePhaseTimer timer(job_desc.job_name(), "GenMemBlockAndChunk");
+      PlanUtil::GenMemBlockAndChunk4Plan(plan);
+    }
+    DumpCompileReport(job_desc.job_name(), job_desc.job_id(), *plan);
 
     LOG(INFO) << "\njob_id: " << job_desc.job_id() << " , job_name: " << job_desc.job_name()
               << " , compile time: " << (GetCurTime() - start) / 1000000000.0 << " seconds.\n";
@@ -759,11 +771,13 @@ void FinishGlobalCriticalSectionDesc(const Plan& plan, int64_t job_size) {
   std::vector<HashMap<std::string, HashSet<int64_t>>> job_id2sole_op_name2mem_block_ids(job_size);
   std::vector<HashSet<int64_t>> job_id2mem_block_ids(job_size);
   std::vector<HashSet<int64_t>> job_id2chunk_ids(job_size);
+  std::vector<HashSet<int64_t>> job_id2variable_mem_block_ids(job_size);
   for (const auto& task : plan.task()) {
     if (task.exec_sequence().exec_node_size() == 1) {
       const auto& kernel_conf = task.exec_sequence().exec_node(0).kernel_conf();
-      const std::string& op_name =
-          PlanUtil::GetOpAttribute(&plan, task.job_id(), kernel_conf).op_conf().name();
+      const OperatorConf& op_conf =
+          PlanUtil::GetOpAttribute(&plan, task.job_id(), kernel_conf).op_conf();
+      const std::string& op_name = op_conf.name();
       HashSet<int64_t>* mem_block_ids =
           &(job_id2sole_op_name2mem_block_ids.at(task.job_id())[op_name]);
       for (const auto& pair : task.produced_regst_desc()) {
@@ -775,6 +789,10 @@ void FinishGlobalCriticalSectionDesc(const Plan& plan, int64_t job_size) {
           mem_block_ids->emplace(pair.second.separated_header_mem_block_id());
         }
       }
+      if (op_conf.has_variable_conf()) {
+        job_id2variable_mem_block_ids.at(task.job_id())
+            .insert(mem_block_ids->begin(), mem_block_ids->end());
+      }
     }
   }
   for (const auto& mem_block : plan.block_chunk_list().mem_block()) {
@@ -828,6 +846,17 @@ void FinishGlobalCriticalSectionDesc(const Plan& plan, int64_t job_size) {
           }
         }
       }
+      const auto& job_conf = plan.job_confs().job_id2job_conf().at(job_id);
+      if (job_conf.enable_concurrent_execution()) {
+        CHECK(job_conf.has_predict_conf())
+            << "enable_concurrent_execution requires a predict job: " << job_conf.job_name();
+        // concurrent jobs sharing variables run together since none of them writes the variables
+        for (int64_t mem_block_id : job_id2variable_mem_block_ids.at(job_id)) {
+          if (mem_block_ids->erase(mem_block_id) > 0) {
+            critical_section->add_read_only_mem_block_id(mem_block_id);
+          }
+        }
+      }
       *critical_section->mutable_mem_block_id() = {mem_block_ids->begin(), mem_block_ids->end()};
       *critical_section->mutable_chunk_id() = {job_id2chunk_ids.at(job_id).begin(),
                                                job_id2chunk_ids.at(job_id).end()};
@@ -917,6 +946,14 @@ REGISTER_FUNCTION_CONFIG_DEF().Bool("__is_user_function__", true, "is user defin
 Maybe<void> CompileJobsAndMergePlans(const PbRpf<Job>& job_confs, Plan& plan) {
   std::vector<std::shared_ptr<Job>> jobs(job_confs.size());
   FOR_RANGE(int, i, 0, jobs.size()) { jobs.at(i).reset(new Job(job_confs.Get(i))); }
+  FOR_RANGE(int, i, 0, job_confs.size()) {
+    FOR_RANGE(int64_t, bucket_id, 0, job_confs.Get(i).job_conf().shape_bucket_size()) {
+      auto bucket_job = std::make_shared<Job>();
+      JUST(ShapeBucketUtil::MakeShapeBucketJob(job_confs.Get(i), bucket_id, jobs.size(),
+                                               bucket_job.get()));
+      jobs.emplace_back(bucket_job);
+    }
+  }
   if (jobs.size() > 1) { CheckNonDistributeOptimizerAvailable(jobs); }
   HashMap<std::string, ParallelBlobConf> var_op_name2parallel_blob_conf;
   FilterOpName2ParallelBlobConf({OperatorConf::kVariableConf}, jobs,
@@ -990,7 +1027,10 @@ Maybe<void> CompileJobsAndMergePlans(const PbRpf<Job>& job_confs, Plan& plan) {
 Maybe<void> CompileJobsAndPushMergedPlan(const PbRpf<Job>& job_confs) {
   if (GlobalProcessCtx::IsThisProcessMaster()) {
     Plan plan;
-    JUST(CompileJobsAndMergePlans(job_confs, plan));
+    if (!JUST(PlanCache::TryLoad(job_confs, &plan))) {
+      JUST(CompileJobsAndMergePlans(job_confs, plan));
+      JUST(PlanCache::Store(job_confs, plan));
+    }
     double start = GetCurTime();
     // push op_attribute_info
     OpAttributeInfo op_attribute_info;
@@ -0,0 +1,151 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <unistd.h>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+#include "oneflow/core/job/plan_cache.h"
+#include "oneflow/core/job/plan_cache.pb.h"
+#include "oneflow/core/job/job_desc.h"
+#include "oneflow/core/job/resource_desc.h"
+#include "oneflow/core/job/global_for.h"
+#include "oneflow/core/job/inter_user_job_info.pb.h"
+#include "oneflow/core/job/version.h"
+#include "oneflow/core/control/global_process_ctx.h"
+#include "oneflow/core/common/str_util.h"
+#include "oneflow/core/persistence/file_system.h"
+
+namespace oneflow {
+
+namespace {
+
+std::string PlanCacheDir() { return GetStringFromEnv("ONEFLOW_PLAN_CACHE_DIR", ""); }
+
+std::string SerializeDeterministically(const PbMessage& msg) {
+  std::string str;
+  {
+    google::protobuf::io::StringOutputStream string_stream(&str);
+    google::protobuf::io::CodedOutputStream coded_stream(&string_stream);
+    // job confs carry proto maps whose default serialization order is unspecified
+    coded_stream.SetSerializationDeterministic(true);
+    CHECK(msg.SerializeToCodedStream(&coded_stream));
+  }
+  return str;
+}
+
+void MakePlanCacheKey(const PbRpf<Job>& job_confs, PlanCacheKey* key) {
+  key->set_version(GetOneFlowGitVersion());
+  *key->mutable_job() = job_confs;
+  *key->mutable_resource() = Global<ResourceDesc, ForSession>::Get()->resource();
+  key->set_world_size(GlobalProcessCtx::WorldSize());
+  key->set_num_process_per_node(GlobalProcessCtx::NumOfProcessPerNode());
+}
+
+std::string PlanCacheFilePath(const std::string& serialized_key) {
+  std::ostringstream ss;
+  ss << std::hex << std::setw(16) << std::setfill('0')
+     << std::hash<std::string>()(serialized_key);
+  return JoinPath(PlanCacheDir(), "plan_" + ss.str() + ".pb");
+}
+
+Maybe<void> CheckPlanCacheEntry(const PlanCacheEntry& entry) {
+  const auto& job_id2job_conf = entry.plan().job_confs().job_id2job_conf();
+  CHECK_EQ_OR_RETURN(entry.job_name2job_id().size(), job_id2job_conf.size());
+  for (const auto& pair : entry.job_name2job_id()) {
+    const auto& it = job_id2job_conf.find(pair.second);
+    CHECK_OR_RETURN(it != job_id2job_conf.end());
+    CHECK_EQ_OR_RETURN(it->second.job_name(), pair.first);
+  }
+  for (const auto& task : entry.plan().task()) {
+    CHECK_OR_RETURN(job_id2job_conf.find(task.job_id()) != job_id2job_conf.end());
+  }
+  return Maybe<void>::Ok();
+}
+
+}  // namespace
+
+bool PlanCache::IsEnabled() { return !PlanCacheDir().empty(); }
+
+Maybe<bool> PlanCache::TryLoad(const PbRpf<Job>& job_confs, Plan* plan) {
+  if (!IsEnabled()) { return false; }
+  CHECK_OR_RETURN(GlobalProcessCtx::IsThisProcessMaster());
+  PlanCacheKey key;
+  MakePlanCacheKey(job_confs, &key);
+  const std::string serialized_key = SerializeDeterministically(key);
+  const std::string file_path = PlanCacheFilePath(serialized_key);
+  if (ParseBooleanFromEnv("ONEFLOW_PLAN_CACHE_INVALIDATE", false)) {
+    std::remove(file_path.c_str());
+    LOG(INFO) << "plan cache entry " << file_path << " invalidated";
+    return false;
+  }
+  PlanCacheEntry entry;
+  {
+    std::ifstream in_stream(file_path.c_str(), std::ifstream::in | std::ifstream::binary);
+    if (!in_stream.is_open()) { return false; }
+    if (!entry.ParseFromIstream(&in_stream)) {
+      LOG(WARNING) << "plan cache entry " << file_path << " is corrupted, recompiling";
+      return false;
+    }
+  }
+  // the file name is only a hash, hence the full key comparison
+  if (SerializeDeterministically(entry.key()) != serialized_key) {
+    LOG(WARNING) << "plan cache entry " << file_path << " does not match the jobs, recompiling";
+    return false;
+  }
+  const auto& maybe_valid = CheckPlanCacheEntry(entry);
+  if (!maybe_valid.IsOk()) {
+    LOG(WARNING) << "plan cache entry " << file_path << " is inconsistent, recompiling";
+    return false;
+  }
+  auto* job_name2job_id = Global<JobName2JobId>::Get();
+  CHECK_OR_RETURN(job_name2job_id->empty());
+  for (const auto& pair : entry.job_name2job_id()) {
+    job_name2job_id->emplace(pair.first, pair.second);
+  }
+  *Global<InterUserJobInfo>::Get() = entry.inter_user_job_info();
+  plan->Swap(entry.mutable_plan());
+  LOG(INFO) << "plan loaded from cache " << file_path;
+  return true;
+}
+
+Maybe<void> PlanCache::Store(const PbRpf<Job>& job_confs, const Plan& plan) {
+  if (!IsEnabled()) { return Maybe<void>::Ok(); }
+  CHECK_OR_RETURN(GlobalProcessCtx::IsThisProcessMaster());
+  PlanCacheEntry entry;
+  MakePlanCacheKey(job_confs, entry.mutable_key());
+  *entry.mutable_plan() = plan;
+  for (const auto& pair : *Global<JobName2JobId>::Get()) {
+    (*entry.mutable_job_name2job_id())[pair.first] = pair.second;
+  }
+  *entry.mutable_inter_user_job_info() = *Global<InterUserJobInfo>::Get();
+  const std::string file_path = PlanCacheFilePath(SerializeDeterministically(entry.key()));
+  fs::LocalFS()->RecursivelyCreateDirIfNotExist(PlanCacheDir());
+  // write aside and rename, so concurrent sessions never read a partially written entry
+  const std::string tmp_file_path = file_path + ".tmp." + std::to_string(getpid());
+  {
+    std::ofstream out_stream(tmp_file_path.c_str(),
+                             std::ofstream::out | std::ofstream::trunc | std::ofstream::binary);
+    CHECK_OR_RETURN(out_stream.is_open()) << "can not open " << tmp_file_path;
+    CHECK_OR_RETURN(entry.SerializeToOstream(&out_stream));
+  }
+  CHECK_EQ_OR_RETURN(std::rename(tmp_file_path.c_str(), file_path.c_str()), 0);
+  LOG(INFO) << "plan stored to cache " << file_path;
+  return Maybe<void>::Ok();
+}
+
+}  // namespace oneflow
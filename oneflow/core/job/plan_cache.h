@@ -0,0 +1,40 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_JOB_PLAN_CACHE_H_
+#define ONEFLOW_CORE_JOB_PLAN_CACHE_H_
+
+#include "oneflow/core/common/maybe.h"
+#include "oneflow/core/common/protobuf.h"
+#include "oneflow/core/job/job.pb.h"
+#include "oneflow/core/job/plan.pb.h"
+
+namespace oneflow {
+
+// Persistent on-disk cache of merged plans, only used on the master process.
+// The cache is enabled by setting ONEFLOW_PLAN_CACHE_DIR to a writable directory. An entry is
+// keyed by the job confs, the session resource, the world layout and the oneflow version, so a
+// change of any of them misses the cache. ONEFLOW_PLAN_CACHE_INVALIDATE=1 drops the entry of the
+// current jobs and recompiles.
+struct PlanCache {
+  static bool IsEnabled();
+  // On hit, restores Global<JobName2JobId> and Global<InterUserJobInfo> as the compilation does
+  static Maybe<bool> TryLoad(const PbRpf<Job>& job_confs, Plan* plan);
+  static Maybe<void> Store(const PbRpf<Job>& job_confs, const Plan& plan);
+};
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_JOB_PLAN_CACHE_H_
@@ -40,9 +40,10 @@ struct PlanUtil {
   static const oneflow::OpAttribute& GetOpAttribute(const Plan* plan, int64_t job_id,
                                                     const oneflow::KernelConf& kernel_conf);
   // NOTE(chengcheng): recovery op_attr
+  // Each op attribute is moved into the last task referring to it instead of being copied, which
+  // leaves the moved entries of the table empty.
   static void PopulateOpAttibute(
-      Plan* plan,
-      const PbMap<int64_t, ::oneflow::OpAttributeRefTable>& job_id2op_attribute_ref_table);
+      Plan* plan, PbMap<int64_t, ::oneflow::OpAttributeRefTable>* job_id2op_attribute_ref_table);
 };
 
 }  // namespace oneflow
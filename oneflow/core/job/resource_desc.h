@@ -46,9 +46,13 @@ class ResourceDesc final {
   bool thread_enable_local_message_queue() const {
     return resource_.thread_enable_local_message_queue();
   }
+  bool thread_enable_priority_dispatch() const {
+    return resource_.thread_enable_priority_dispatch();
+  }
   bool enable_thread_local_cache() const { return resource_.enable_thread_local_cache(); }
   size_t thread_local_cache_max_size() const { return resource_.thread_local_cache_max_size(); }
   int32_t ComputeThreadPoolSize() const;
+  int32_t cpu_intra_op_thread_num() const { return resource_.cpu_intra_op_thread_num(); }
   bool enable_debug_mode() const;
   bool enable_dry_run() const;
   CollectiveBoxingConf collective_boxing_conf() const;
@@ -57,6 +61,7 @@ class ResourceDesc final {
   void SetMachineNum(int32_t val) { resource_.set_machine_num(val); }
   void SetCpuDeviceNum(int32_t val) { resource_.set_cpu_device_num(val); }
   bool enable_tensor_float_32_compute() const { return resource_.enable_tensor_float_32_compute(); }
+  bool enable_deterministic_kernels() const { return resource_.enable_deterministic_kernels(); }
   const Resource& resource() const { return resource_; }
   void DumpCudnnConf(const JobConfigProto& job_conf);
 
@@ -24,6 +24,7 @@ limitations under the License.
 #include "oneflow/core/job/runtime_job_descs.h"
 #include "oneflow/core/thread/thread_manager.h"
 #include "oneflow/core/actor/act_event_logger.h"
+#include "oneflow/core/actor/act_timeline.h"
 #include "oneflow/core/graph/task_node.h"
 #include "oneflow/core/device/cuda_util.h"
 #include "oneflow/core/memory/memory_allocator.h"
@@ -60,7 +61,8 @@ bool HasNonCtrlConsumedRegstDescId(const TaskProto& task) {
 
 }  // namespace
 
-Runtime::Runtime(const Plan& plan, const HashMap<std::string, Blob*>& variable_op_name2eager_blob) {
+Runtime::Runtime(const Plan& plan, const HashMap<std::string, Blob*>& variable_op_name2eager_blob)
+    : plan_(&plan) {
   {
     // NOTE(chengcheng): All runtime Global objects AddPlan
     if (!CHECK_JUST(GlobalMultiClientEnv())) {
@@ -113,6 +115,7 @@ Runtime::~Runtime() {
     Global<RuntimeCtx>::Get()->WaitUntilCntEqualZero(GetRunningActorCountKeyByJobId(pair.first));
   }
   OF_SESSION_BARRIER();
+  if (Global<ActTimeline>::Get() != nullptr) { Global<ActTimeline>::Get()->DumpAndClear(*plan_); }
 
   // TODO(chengcheng): move to session delete
   if (!CHECK_JUST(GlobalMultiClientEnv())) {
@@ -32,6 +32,7 @@ class Runtime final {
   Runtime(const Plan& plan, const HashMap<std::string, Blob*>& variable_op_name2eager_blob);
 
  private:
+  const Plan* plan_;
   HashMap<int64_t, int64_t> job_id2actor_size_;
 };
 
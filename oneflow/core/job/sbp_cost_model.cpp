@@ -0,0 +1,168 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/job/sbp_cost_model.h"
+#include "oneflow/core/control/global_process_ctx.h"
+#include "oneflow/core/graph/boxing/hierarchical_sub_task_graph_builder_impl.h"
+
+namespace oneflow {
+
+namespace {
+
+int64_t NodeId4MachineId(int64_t machine_id) {
+  return machine_id / GlobalProcessCtx::NumOfProcessPerNode();
+}
+
+// Whether the device groups of `axis', e.g. the devices sharing all other indices, stay in a node
+bool IsAxisWithinNode(const ParallelDesc& parallel_desc, int64_t axis) {
+  const Shape& hierarchy = *parallel_desc.hierarchy();
+  int64_t stride = 1;
+  FOR_RANGE(int64_t, i, axis + 1, hierarchy.NumAxes()) { stride *= hierarchy.At(i); }
+  const int64_t node_id = NodeId4MachineId(CHECK_JUST(parallel_desc.MachineId4ParallelId(0)));
+  FOR_RANGE(int64_t, i, 1, hierarchy.At(axis)) {
+    const int64_t machine_id = CHECK_JUST(parallel_desc.MachineId4ParallelId(i * stride));
+    if (NodeId4MachineId(machine_id) != node_id) { return false; }
+  }
+  return true;
+}
+
+bool IsWithinNode(const ParallelDesc& src_parallel_desc, const ParallelDesc& dst_parallel_desc) {
+  const int64_t node_id = NodeId4MachineId(src_parallel_desc.sorted_machine_ids().front());
+  for (const auto* parallel_desc : {&src_parallel_desc, &dst_parallel_desc}) {
+    for (int64_t machine_id : parallel_desc->sorted_machine_ids()) {
+      if (NodeId4MachineId(machine_id) != node_id) { return false; }
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+double PhysicalBlobBytes(const Shape& hierarchy,
+                         const cfg::ParallelDistribution& parallel_distribution,
+                         double logical_bytes) {
+  CHECK_EQ(hierarchy.NumAxes(), parallel_distribution.sbp_parallel_size());
+  double bytes = logical_bytes;
+  FOR_RANGE(int64_t, i, 0, hierarchy.NumAxes()) {
+    if (parallel_distribution.sbp_parallel(i).has_split_parallel()) { bytes /= hierarchy.At(i); }
+  }
+  return bytes;
+}
+
+bool IsParallelDistributionValidForShape(const Shape& hierarchy,
+                                         const cfg::ParallelDistribution& parallel_distribution,
+                                         const Shape& logical_shape) {
+  if (hierarchy.NumAxes() != parallel_distribution.sbp_parallel_size()) { return false; }
+  std::vector<int64_t> axis2split_num(logical_shape.NumAxes(), 1);
+  FOR_RANGE(int64_t, i, 0, hierarchy.NumAxes()) {
+    const cfg::SbpParallel& sbp_parallel = parallel_distribution.sbp_parallel(i);
+    if (!sbp_parallel.has_split_parallel()) { continue; }
+    const int64_t axis = sbp_parallel.split_parallel().axis();
+    if (axis < 0 || axis >= logical_shape.NumAxes()) { return false; }
+    axis2split_num.at(axis) *= hierarchy.At(i);
+  }
+  FOR_RANGE(int64_t, axis, 0, logical_shape.NumAxes()) {
+    if (logical_shape.At(axis) < axis2split_num.at(axis)) { return false; }
+  }
+  return true;
+}
+
+double CollectiveBoxingBytes(const cfg::SbpParallel& src, const cfg::SbpParallel& dst,
+                             int64_t group_size, double piece_bytes) {
+  if (group_size <= 1 || src == dst) { return 0; }
+  const double ratio = static_cast<double>(group_size - 1) / group_size;
+  if (src.has_partial_sum_parallel()) {
+    // all-reduce or reduce-scatter
+    return dst.has_broadcast_parallel() ? 2 * ratio * piece_bytes : ratio * piece_bytes;
+  } else if (src.has_split_parallel()) {
+    if (dst.has_broadcast_parallel()) {
+      // all-gather
+      return ratio * piece_bytes;
+    } else if (dst.has_split_parallel()) {
+      // all2all
+      return ratio * piece_bytes / group_size;
+    } else {
+      // keeps the local slice and fills zeros
+      return 0;
+    }
+  } else {
+    // B->S slices and B->P fills zeros locally
+    return 0;
+  }
+}
+
+double SbpCostModel::TransferCost(double bytes, bool within_node) const {
+  const double bandwidth = within_node ? conf_.intra_node_bandwidth_gbyte_per_sec()
+                                       : conf_.inter_node_bandwidth_gbyte_per_sec();
+  return conf_.boxing_latency_us() * 1e-6 + bytes / (bandwidth * 1e9);
+}
+
+double SbpCostModel::ComputeCost(const ParallelDesc& parallel_desc,
+                                 const cfg::ParallelDistribution& parallel_distribution,
+                                 const BlobDesc& logical_blob_desc) const {
+  const double bytes = PhysicalBlobBytes(*parallel_desc.hierarchy(), parallel_distribution,
+                                         logical_blob_desc.ByteSizeOfBlobBody());
+  return bytes / (conf_.device_memory_bandwidth_gbyte_per_sec() * 1e9);
+}
+
+double SbpCostModel::BoxingCost(const ParallelDesc& src_parallel_desc,
+                                const ParallelDesc& dst_parallel_desc,
+                                const cfg::ParallelDistribution& src_parallel_distribution,
+                                const cfg::ParallelDistribution& dst_parallel_distribution,
+                                const BlobDesc& logical_blob_desc) const {
+  const double logical_bytes = logical_blob_desc.ByteSizeOfBlobBody();
+  if (src_parallel_desc == dst_parallel_desc) {
+    if (src_parallel_distribution == dst_parallel_distribution) { return 0; }
+    ParallelDesc reduced_src_parallel_desc = src_parallel_desc;
+    ParallelDesc reduced_dst_parallel_desc = dst_parallel_desc;
+    cfg::ParallelDistribution reduced_src_parallel_distribution;
+    cfg::ParallelDistribution reduced_dst_parallel_distribution;
+    InOutParallelDimReduce(src_parallel_desc, dst_parallel_desc, src_parallel_distribution,
+                           dst_parallel_distribution, &reduced_src_parallel_desc,
+                           &reduced_dst_parallel_desc, &reduced_src_parallel_distribution,
+                           &reduced_dst_parallel_distribution);
+    const Shape& hierarchy = *reduced_src_parallel_desc.hierarchy();
+    double cost = 0;
+    FOR_RANGE(int64_t, axis, 0, hierarchy.NumAxes()) {
+      const cfg::SbpParallel& src = reduced_src_parallel_distribution.sbp_parallel(axis);
+      const cfg::SbpParallel& dst = reduced_dst_parallel_distribution.sbp_parallel(axis);
+      if (src == dst) { continue; }
+      // a group of this axis works on the piece the source distribution leaves on other axes
+      double piece_bytes = logical_bytes;
+      FOR_RANGE(int64_t, i, 0, hierarchy.NumAxes()) {
+        if (i != axis && reduced_src_parallel_distribution.sbp_parallel(i).has_split_parallel()) {
+          piece_bytes /= hierarchy.At(i);
+        }
+      }
+      const double bytes = CollectiveBoxingBytes(src, dst, hierarchy.At(axis), piece_bytes);
+      if (bytes > 0) {
+        cost += TransferCost(bytes, IsAxisWithinNode(reduced_src_parallel_desc, axis));
+      }
+    }
+    return cost;
+  }
+  // between placements slices are copied point to point and partial sums are added on arrival
+  double received_bytes = PhysicalBlobBytes(*dst_parallel_desc.hierarchy(),
+                                            dst_parallel_distribution, logical_bytes);
+  const Shape& src_hierarchy = *src_parallel_desc.hierarchy();
+  FOR_RANGE(int64_t, i, 0, src_hierarchy.NumAxes()) {
+    if (src_parallel_distribution.sbp_parallel(i).has_partial_sum_parallel()) {
+      received_bytes *= src_hierarchy.At(i);
+    }
+  }
+  return TransferCost(received_bytes, IsWithinNode(src_parallel_desc, dst_parallel_desc));
+}
+
+}  // namespace oneflow
@@ -0,0 +1,69 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_JOB_SBP_COST_MODEL_H_
+#define ONEFLOW_CORE_JOB_SBP_COST_MODEL_H_
+
+#include "oneflow/core/common/shape.h"
+#include "oneflow/core/job/job_conf.pb.h"
+#include "oneflow/core/job/parallel_desc.h"
+#include "oneflow/core/job/sbp_parallel.h"
+#include "oneflow/core/register/blob_desc.h"
+
+namespace oneflow {
+
+// Bytes of a blob on one device under `parallel_distribution'
+double PhysicalBlobBytes(const Shape& hierarchy,
+                         const cfg::ParallelDistribution& parallel_distribution,
+                         double logical_bytes);
+
+// Whether each split axis is not shorter than the number of devices it is split among
+bool IsParallelDistributionValidForShape(const Shape& hierarchy,
+                                         const cfg::ParallelDistribution& parallel_distribution,
+                                         const Shape& logical_shape);
+
+// Bytes a device receives while a collective of `group_size' devices converts a piece of
+// `piece_bytes' from `src' to `dst', e.g. all-reduce for P->B and all-gather for S->B
+double CollectiveBoxingBytes(const cfg::SbpParallel& src, const cfg::SbpParallel& dst,
+                             int64_t group_size, double piece_bytes);
+
+// Estimates in seconds for choosing parallel distribution signatures. Boxing is accounted the way
+// the hierarchical sub task graph builders realize it: one collective per differing hierarchy axis
+// inside a placement and point to point slice copies between placements.
+class SbpCostModel final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(SbpCostModel);
+  explicit SbpCostModel(const AutoParallelConf& conf) : conf_(conf) {}
+  ~SbpCostModel() = default;
+
+  // Time for one device to read or write its part of a blob
+  double ComputeCost(const ParallelDesc& parallel_desc,
+                     const cfg::ParallelDistribution& parallel_distribution,
+                     const BlobDesc& logical_blob_desc) const;
+  // Zero if the consumer can use the produced blob as is
+  double BoxingCost(const ParallelDesc& src_parallel_desc, const ParallelDesc& dst_parallel_desc,
+                    const cfg::ParallelDistribution& src_parallel_distribution,
+                    const cfg::ParallelDistribution& dst_parallel_distribution,
+                    const BlobDesc& logical_blob_desc) const;
+
+ private:
+  double TransferCost(double bytes, bool within_node) const;
+
+  AutoParallelConf conf_;
+};
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_JOB_SBP_COST_MODEL_H_
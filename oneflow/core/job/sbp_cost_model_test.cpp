@@ -0,0 +1,69 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/common/util.h"
+#include "oneflow/core/job/sbp_cost_model.h"
+
+namespace oneflow {
+namespace test {
+
+namespace {
+
+cfg::SbpParallel Sbp(const std::string& sbp_str) {
+  cfg::SbpParallel sbp_parallel;
+  CHECK(ParseSbpParallelFromString(sbp_str, &sbp_parallel));
+  return sbp_parallel;
+}
+
+cfg::ParallelDistribution Distribution(const std::vector<std::string>& sbp_strs) {
+  cfg::ParallelDistribution parallel_distribution;
+  for (const auto& sbp_str : sbp_strs) { *parallel_distribution.add_sbp_parallel() = Sbp(sbp_str); }
+  return parallel_distribution;
+}
+
+}  // namespace
+
+TEST(SbpCostModel, collective_boxing_bytes) {
+  ASSERT_EQ(CollectiveBoxingBytes(Sbp("S(0)"), Sbp("S(0)"), 4, 1024), 0);
+  ASSERT_EQ(CollectiveBoxingBytes(Sbp("B"), Sbp("S(0)"), 4, 1024), 0);
+  ASSERT_EQ(CollectiveBoxingBytes(Sbp("S(0)"), Sbp("P"), 4, 1024), 0);
+  ASSERT_EQ(CollectiveBoxingBytes(Sbp("P"), Sbp("B"), 4, 1024), 1536);
+  ASSERT_EQ(CollectiveBoxingBytes(Sbp("P"), Sbp("S(0)"), 4, 1024), 768);
+  ASSERT_EQ(CollectiveBoxingBytes(Sbp("S(0)"), Sbp("B"), 4, 1024), 768);
+  ASSERT_EQ(CollectiveBoxingBytes(Sbp("S(0)"), Sbp("S(1)"), 4, 1024), 192);
+}
+
+TEST(SbpCostModel, physical_blob_bytes) {
+  const Shape hierarchy({2, 4});
+  ASSERT_EQ(PhysicalBlobBytes(hierarchy, Distribution({"B", "B"}), 1024), 1024);
+  ASSERT_EQ(PhysicalBlobBytes(hierarchy, Distribution({"S(0)", "B"}), 1024), 512);
+  ASSERT_EQ(PhysicalBlobBytes(hierarchy, Distribution({"S(0)", "S(1)"}), 1024), 128);
+  ASSERT_EQ(PhysicalBlobBytes(hierarchy, Distribution({"P", "S(1)"}), 1024), 256);
+}
+
+TEST(SbpCostModel, valid_for_shape) {
+  const Shape hierarchy({2, 4});
+  ASSERT_TRUE(
+      IsParallelDistributionValidForShape(hierarchy, Distribution({"S(0)", "S(0)"}), Shape({8})));
+  ASSERT_FALSE(
+      IsParallelDistributionValidForShape(hierarchy, Distribution({"S(0)", "S(0)"}), Shape({4})));
+  ASSERT_TRUE(IsParallelDistributionValidForShape(hierarchy, Distribution({"S(0)", "S(1)"}),
+                                                  Shape({2, 4})));
+  ASSERT_FALSE(IsParallelDistributionValidForShape(hierarchy, Distribution({"S(1)", "B"}),
+                                                   Shape({8})));
+}
+
+}  // namespace test
+}  // namespace oneflow
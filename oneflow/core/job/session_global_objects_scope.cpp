@@ -21,6 +21,7 @@ limitations under the License.
 #include "oneflow/core/job/available_memory_desc.pb.h"
 #include "oneflow/core/job/id_manager.h"
 #include "oneflow/core/job/profiler.h"
+#include "oneflow/core/actor/act_timeline.h"
 #include "oneflow/core/job/job_instance.h"
 #include "oneflow/core/job/inter_user_job_info.pb.h"
 #include "oneflow/core/job/job_desc.h"
@@ -132,6 +133,7 @@ Maybe<void> SessionGlobalObjectsScope::Init(const ConfigProto& config_proto) {
     Global<MemoryAllocator>::New();
     Global<RegstMgr>::New();
     Global<ActorMsgBus>::New();
+    if (ActTimeline::IsEnabled()) { Global<ActTimeline>::New(); }
     Global<ThreadMgr>::New();
     Global<RuntimeJobDescs>::New();
     Global<summary::EventsWriter>::New();
@@ -160,6 +162,7 @@ SessionGlobalObjectsScope::~SessionGlobalObjectsScope() {
     Global<summary::EventsWriter>::Delete();
     Global<RuntimeJobDescs>::Delete();
     Global<ThreadMgr>::Delete();
+    if (Global<ActTimeline>::Get() != nullptr) { Global<ActTimeline>::Delete(); }
     Global<ActorMsgBus>::Delete();
     Global<RegstMgr>::Delete();
     Global<MemoryAllocator>::Delete();
@@ -0,0 +1,140 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/job/shape_bucket_util.h"
+#include "oneflow/core/job/job_desc.h"
+#include "oneflow/core/graph/op_graph.h"
+#include "oneflow/core/operator/operator.h"
+
+namespace oneflow {
+
+namespace {
+
+template<typename T>
+void RenameKeys(const HashMap<std::string, std::string>& op_name2bucket_op_name,
+                PbMap<std::string, T>* op_name2val) {
+  for (const auto& pair : op_name2bucket_op_name) {
+    auto it = op_name2val->find(pair.first);
+    if (it == op_name2val->end()) { continue; }
+    T val = it->second;
+    op_name2val->erase(it);
+    (*op_name2val)[pair.second] = val;
+  }
+}
+
+void RenameLbi(const HashMap<std::string, std::string>& op_name2bucket_op_name,
+               LogicalBlobId* lbi) {
+  const auto& it = op_name2bucket_op_name.find(lbi->op_name());
+  if (it != op_name2bucket_op_name.end()) { lbi->set_op_name(it->second); }
+}
+
+}  // namespace
+
+std::string ShapeBucketUtil::ShapeBucketJobName(const std::string& job_name, int64_t bucket_id) {
+  return job_name + "-Bucket" + std::to_string(bucket_id);
+}
+
+std::string ShapeBucketUtil::ShapeBucketOpName(const std::string& op_name, int64_t bucket_id) {
+  return op_name + "-Bucket" + std::to_string(bucket_id);
+}
+
+Maybe<void> ShapeBucketUtil::MakeShapeBucketJob(const Job& job, int64_t bucket_id,
+                                                int64_t job_id, Job* bucket_job) {
+  const JobConfigProto& job_conf = job.job_conf();
+  CHECK_OR_RETURN(job_conf.has_predict_conf())
+      << "shape_bucket requires a predict job: " << job_conf.job_name();
+  CHECK_LT_OR_RETURN(bucket_id, job_conf.shape_bucket_size());
+  const ShapeBucketConf& bucket = job_conf.shape_bucket(bucket_id);
+  *bucket_job = job;
+  bucket_job->mutable_job_conf()->clear_shape_bucket();
+  bucket_job->mutable_job_conf()->set_job_name(
+      ShapeBucketJobName(job_conf.job_name(), bucket_id));
+
+  HashMap<std::string, std::string> op_name2bucket_op_name;
+  for (const auto& op_conf : job.net().op()) {
+    if (op_conf.has_input_conf() || op_conf.has_return_conf()) {
+      op_name2bucket_op_name.emplace(op_conf.name(), ShapeBucketOpName(op_conf.name(), bucket_id));
+    }
+  }
+  for (const auto& pair : bucket.input_op_name2shape()) {
+    CHECK_OR_RETURN(op_name2bucket_op_name.find(pair.first) != op_name2bucket_op_name.end())
+        << "no input op " << pair.first << " in job " << job_conf.job_name();
+  }
+
+  for (auto& op_conf : *bucket_job->mutable_net()->mutable_op()) {
+    const auto& op = JUST(ConstructOp(op_conf));
+    for (const auto& ibn : op->input_bns()) {
+      LogicalBlobId lbi = op->BnInOp2Lbi(ibn);
+      if (op_name2bucket_op_name.find(lbi.op_name()) == op_name2bucket_op_name.end()) {
+        continue;
+      }
+      RenameLbi(op_name2bucket_op_name, &lbi);
+      ReplaceInputLbnInOpCustomizedConf(&op_conf, ibn, GenLogicalBlobName(lbi));
+    }
+    const auto& it = op_name2bucket_op_name.find(op_conf.name());
+    if (it == op_name2bucket_op_name.end()) { continue; }
+    const auto& shape_it = bucket.input_op_name2shape().find(op_conf.name());
+    if (shape_it != bucket.input_op_name2shape().end()) {
+      auto* blob_conf = op_conf.mutable_input_conf()->mutable_blob_conf();
+      CHECK_EQ_OR_RETURN(shape_it->second.dim_size(), blob_conf->shape().dim_size())
+          << "input op " << op_conf.name();
+      *blob_conf->mutable_shape() = shape_it->second;
+      blob_conf->set_is_dynamic(false);
+    }
+    op_conf.set_name(it->second);
+  }
+
+  for (auto& group : *bucket_job->mutable_placement()->mutable_placement_group()) {
+    for (auto& op_name : *group.mutable_op_set()->mutable_op_name()) {
+      const auto& it = op_name2bucket_op_name.find(op_name);
+      if (it != op_name2bucket_op_name.end()) { op_name = it->second; }
+    }
+  }
+  for (auto& group : *bucket_job->mutable_placement()->mutable_blob_placement_group()) {
+    for (auto& lbi : *group.mutable_lbi()) { RenameLbi(op_name2bucket_op_name, &lbi); }
+  }
+  auto* signature = bucket_job->mutable_job_conf()->mutable_signature();
+  for (auto& pair : *signature->mutable_inputs()) {
+    const auto& shape_it = bucket.input_op_name2shape().find(pair.second.lbi().op_name());
+    if (shape_it != bucket.input_op_name2shape().end()) {
+      *pair.second.mutable_blob_conf()->mutable_shape() = shape_it->second;
+      pair.second.mutable_blob_conf()->set_is_dynamic(false);
+    }
+    RenameLbi(op_name2bucket_op_name, pair.second.mutable_lbi());
+  }
+  for (auto& pair : *signature->mutable_outputs()) {
+    RenameLbi(op_name2bucket_op_name, pair.second.mutable_lbi());
+  }
+  auto* parallel_view_conf = bucket_job->mutable_job_parallel_view_conf();
+  RenameKeys(op_name2bucket_op_name, parallel_view_conf->mutable_op_name2sbp_signature_conf());
+  RenameKeys(op_name2bucket_op_name,
+             parallel_view_conf->mutable_op_name2is_mirrored_parallel_view());
+  RenameKeys(op_name2bucket_op_name,
+             parallel_view_conf->mutable_op_name2parallel_distribution_signature_conf());
+
+  // blob descs of the helper are inferred again with the shapes of the bucket
+  bucket_job->mutable_helper()->clear_lbn2logical_blob_desc();
+  bucket_job->mutable_helper()->clear_op_name2arg_signature();
+  {
+    GlobalJobDescScope scope(bucket_job->job_conf(), job_id);
+    const OpGraph op_graph(*bucket_job);
+    op_graph.DumpLogicalBlobDesc(bucket_job);
+    op_graph.DumpArgSignature(bucket_job);
+    op_graph.DumpParallelDistributionSignature(bucket_job);
+  }
+  return Maybe<void>::Ok();
+}
+
+}  // namespace oneflow
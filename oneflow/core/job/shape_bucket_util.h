@@ -0,0 +1,39 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_JOB_SHAPE_BUCKET_UTIL_H_
+#define ONEFLOW_CORE_JOB_SHAPE_BUCKET_UTIL_H_
+
+#include "oneflow/core/common/maybe.h"
+#include "oneflow/core/job/job.pb.h"
+
+namespace oneflow {
+
+// A predict job with job_conf.shape_bucket is compiled once more per bucket, as a job whose
+// bucketed input ops have the static shapes of the bucket. The input and return ops of a bucket
+// job are renamed by ShapeBucketOpName, so that each bucket gets its own push and pull jobs, while
+// the variables keep their names and are shared with the other jobs. Callers pad a request to
+// the smallest bucket holding it and run the bucket job.
+struct ShapeBucketUtil {
+  static std::string ShapeBucketJobName(const std::string& job_name, int64_t bucket_id);
+  static std::string ShapeBucketOpName(const std::string& op_name, int64_t bucket_id);
+  // job_id is the id bucket_job will take
+  static Maybe<void> MakeShapeBucketJob(const Job& job, int64_t bucket_id, int64_t job_id,
+                                        Job* bucket_job);
+};
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_JOB_SHAPE_BUCKET_UTIL_H_
@@ -0,0 +1,201 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/job_rewriter/job_pass.h"
+#include "oneflow/core/job/job.pb.h"
+#include "oneflow/core/job/scope.h"
+#include "oneflow/core/job/sbp_cost_model.h"
+#include "oneflow/core/job_rewriter/calculation_pass.h"
+#include "oneflow/core/vm/symbol_storage.h"
+#include "oneflow/core/framework/framework.h"
+#include "oneflow/core/operator/operator.h"
+
+namespace oneflow {
+
+namespace {
+
+// ActivationOffloadingPass moves forward activations that wait long for their backward consumers
+// to host memory. A cpu identity op consumes the activation, so the compiler inserts a D2H copy
+// into pinned host memory right after the producer, and the backward consumers read the identity
+// output through a H2D copy. A ctrl edge from a backward op shortly before the first backward
+// consumer holds the identity, and the H2D copy behind it, back until then.
+class ActivationOffloadingPass final : public JobPass {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(ActivationOffloadingPass);
+  ActivationOffloadingPass() = default;
+  ~ActivationOffloadingPass() = default;
+
+  Maybe<void> Apply(Job* job, JobPassCtx* ctx) const override {
+    if (!IsEnabled(*ctx)) { return Maybe<void>::Ok(); }
+    const OpGraph op_graph(*job);
+    JobBuilder job_builder(job);
+    return Apply(op_graph, &job_builder, ctx->job_desc().activation_offloading_conf());
+  }
+
+  bool IsEnabled(const JobPassCtx& ctx) const {
+    return ctx.job_desc().IsTrain() && ctx.job_desc().enable_activation_offloading();
+  }
+
+  Maybe<void> Apply(const OpGraph& op_graph, JobBuilder* job_builder,
+                    const ActivationOffloadingConf& conf) const;
+};
+
+const std::string kOffloadOpNamePrefix = "System-Activation-Offload-Op_";
+
+const Scope& Scope4OpNode(const OpNode* op_node) {
+  const OperatorConf& op_conf = op_node->op().op_conf();
+  CHECK(op_conf.has_scope_symbol_id());
+  CHECK(Global<symbol::Storage<Scope>>::Get()->Has(op_conf.scope_symbol_id()));
+  return Global<symbol::Storage<Scope>>::Get()->Get(op_conf.scope_symbol_id());
+}
+
+bool OpNodeHasScope(const OpNode* node) { return node->op().op_conf().has_scope_symbol_id(); }
+
+bool IsForwardPass(const OpNode* node) {
+  return Scope4OpNode(node).scope_proto().calculation_pass_name() == kForwardPass;
+}
+
+bool IsBackwardPass(const OpNode* node) {
+  return Scope4OpNode(node).scope_proto().calculation_pass_name() == kBackwardPass;
+}
+
+Maybe<int64_t> TimeShapeElemCnt(const OpNode* node) {
+  return JUST(node->op().GetOpTimeShape())->elem_cnt();
+}
+
+struct OffloadCandidate {
+  LogicalBlobId lbi;
+  const OpNode* producer;
+  std::vector<const OpNode*> backward_consumers;
+  const OpNode* prefetch_node;
+  double bytes;
+};
+
+Maybe<void> ActivationOffloadingPass::Apply(const OpGraph& op_graph, JobBuilder* job_builder,
+                                            const ActivationOffloadingConf& conf) const {
+  std::vector<const OpNode*> sorted_nodes;
+  HashMap<const OpNode*, int64_t> op_node2order;
+  op_graph.TopoForEachNode([&](const OpNode* op_node) {
+    CHECK(op_node2order.emplace(op_node, sorted_nodes.size()).second);
+    sorted_nodes.push_back(op_node);
+  });
+
+  std::vector<OffloadCandidate> candidates;
+  for (const OpNode* producer : sorted_nodes) {
+    if (!OpNodeHasScope(producer) || !IsForwardPass(producer)) { continue; }
+    if (producer->parallel_desc().device_type() != DeviceType::kGPU) { continue; }
+    const Operator& op = producer->op();
+    if (op.op_conf().has_variable_conf()) { continue; }
+    for (const auto& obn : op.output_bns()) {
+      const LogicalBlobId& lbi = op.BnInOp2Lbi(obn);
+      OffloadCandidate candidate;
+      candidate.lbi = lbi;
+      candidate.producer = producer;
+      candidate.prefetch_node = nullptr;
+      candidate.bytes = PhysicalBlobBytes(*producer->parallel_desc().hierarchy(),
+                                          producer->ParallelDistribution4Lbi(lbi),
+                                          producer->LogicalBlobDesc4Lbi(lbi).ByteSizeOfBlobBody());
+      if (candidate.bytes < conf.min_blob_byte_size()) { continue; }
+      int64_t forward_end = op_node2order.at(producer);
+      int64_t backward_begin = std::numeric_limits<int64_t>::max();
+      bool is_offloadable = true;
+      for (const OpEdge* edge : producer->out_edges()) {
+        if (std::find(edge->lbis().begin(), edge->lbis().end(), lbi) == edge->lbis().end()) {
+          continue;
+        }
+        const OpNode* consumer = edge->dst_node();
+        // in-place writes of the consumers must be seen by the activation itself
+        for (const auto& ibn : edge->lbi2ibns().at(lbi)) {
+          if (consumer->op().InputBlobModifier4Ibn(ibn).is_mutable()) { is_offloadable = false; }
+        }
+        if (!OpNodeHasScope(consumer)) {
+          is_offloadable = false;
+        } else if (IsBackwardPass(consumer)) {
+          candidate.backward_consumers.push_back(consumer);
+          backward_begin = std::min(backward_begin, op_node2order.at(consumer));
+        } else {
+          forward_end = std::max(forward_end, op_node2order.at(consumer));
+        }
+      }
+      if (!is_offloadable || candidate.backward_consumers.empty()) { continue; }
+      if (backward_begin - forward_end < conf.min_lifetime_op_num()) { continue; }
+      // the latest backward op far enough before the first backward consumer to hide the copy
+      const int64_t time_shape_elem_cnt = JUST(TimeShapeElemCnt(producer));
+      for (int64_t order = backward_begin - conf.prefetch_op_num(); order > forward_end;
+           --order) {
+        const OpNode* node = sorted_nodes.at(order);
+        if (OpNodeHasScope(node) && IsBackwardPass(node)
+            && node->parallel_desc() == producer->parallel_desc()
+            && JUST(TimeShapeElemCnt(node)) == time_shape_elem_cnt) {
+          candidate.prefetch_node = node;
+          break;
+        }
+      }
+      if (candidate.prefetch_node == nullptr) { continue; }
+      candidates.push_back(candidate);
+    }
+  }
+  if (candidates.empty()) { return Maybe<void>::Ok(); }
+
+  HashMap<std::string, OperatorConf> mut_op_name2conf;
+  double offloaded_bytes = 0;
+  for (const auto& candidate : candidates) {
+    const std::string lbn = GenLogicalBlobName(candidate.lbi);
+    const std::string offload_op_name =
+        kOffloadOpNamePrefix + candidate.lbi.op_name() + "-" + candidate.lbi.blob_name();
+    OperatorConf offload_op_conf =
+        user_op::UserOpConfWrapperBuilder(offload_op_name)
+            .Op("identity")
+            .Input("in", lbn)
+            .Output("out")
+            .ScopeSymbolId(candidate.backward_consumers.front()->op().op_conf().scope_symbol_id())
+            .Build()
+            .op_conf();
+    offload_op_conf.set_device_tag("cpu");
+    offload_op_conf.add_ctrl_in_op_name(candidate.prefetch_node->op().op_name());
+    ParallelConf offload_parallel_conf = candidate.producer->parallel_desc().parallel_conf();
+    offload_parallel_conf.set_device_tag("cpu");
+    JUST(job_builder->AddOp(offload_parallel_conf, offload_op_conf));
+
+    const std::string offload_out = user_op::UserOpConfWrapper(offload_op_conf).output("out", 0);
+    for (const OpNode* consumer : candidate.backward_consumers) {
+      const std::string& consumer_op_name = consumer->op().op_name();
+      auto mut_op_it = mut_op_name2conf.find(consumer_op_name);
+      if (mut_op_it == mut_op_name2conf.end()) {
+        mut_op_it = mut_op_name2conf.emplace(consumer_op_name, consumer->op().op_conf()).first;
+      }
+      for (const auto& ibn : consumer->op().input_bns()) {
+        if (consumer->op().BnInOp2Lbi(ibn) != candidate.lbi) { continue; }
+        const std::string old_lbn =
+            ReplaceInputLbnInOpCustomizedConf(&(mut_op_it->second), ibn, offload_out);
+        CHECK_EQ(old_lbn, lbn);
+      }
+    }
+    offloaded_bytes += candidate.bytes;
+    LOG(INFO) << "offload activation " << lbn << " (" << candidate.bytes / 1024 / 1024
+              << "MB per device) to host, prefetch after "
+              << candidate.prefetch_node->op().op_name();
+  }
+  for (auto& pair : mut_op_name2conf) { JUST(job_builder->MutOpOnlyOnce(pair.second)); }
+  LOG(INFO) << "offload " << candidates.size() << " activations, "
+            << offloaded_bytes / 1024 / 1024 << "MB per device in total";
+  return Maybe<void>::Ok();
+}
+
+}  // namespace
+
+REGISTER_JOB_PASS("ActivationOffloadingPass", ActivationOffloadingPass);
+
+}  // namespace oneflow
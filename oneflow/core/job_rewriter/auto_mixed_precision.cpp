@@ -62,8 +62,29 @@ std::function<bool(OpNode*)> MakePredicatorIsAllowedToRunWithHalf(const OpGraph&
   return [allowed_set](OpNode* node) -> bool { return IsKeyFound(*allowed_set, node); };
 }
 
-void InsertCastOpImpl(bool f2h, const OpGraph& op_graph, const HashSet<OpNode*>& white_set,
-                      JobBuilder* job_builder) {
+// A float blob produced by casting a half blob can be fed to half consumers directly: casting
+// half to float and back is lossless, so the pair of casts is pure overhead.
+bool IsCastFromHalf(const OpNode* node, DataType half_data_type, std::string* half_lbn) {
+  const OperatorConf& op_conf = node->op().op_conf();
+  if (!op_conf.has_user_conf() || op_conf.user_conf().op_type_name() != "cast") { return false; }
+  const user_op::UserOpConfWrapper cast_conf(op_conf);
+  const std::string& in_lbn = cast_conf.input("in", 0);
+  if (node->LogicalBlobDesc4Lbi(GenLogicalBlobId(in_lbn)).data_type() != half_data_type) {
+    return false;
+  }
+  *half_lbn = in_lbn;
+  return true;
+}
+
+void InsertCastOpImpl(bool f2h, DataType half_data_type, const OpGraph& op_graph,
+                      const HashSet<OpNode*>& white_set, JobBuilder* job_builder) {
+  HashSet<std::string> ctrl_in_op_names;
+  op_graph.ForEachNode([&](const OpNode* node) {
+    for (const std::string& ctrl_in_op_name : node->op().op_conf().ctrl_in_op_name()) {
+      ctrl_in_op_names.insert(ctrl_in_op_name);
+    }
+  });
+
   HashSet<OpEdge*> white_set_edges;
   {
     std::function<const std::unordered_set<OpEdge*>&(OpNode*)> Node2Edges =
@@ -96,6 +117,7 @@ void InsertCastOpImpl(bool f2h, const OpGraph& op_graph, const HashSet<OpNode*>&
   }
 
   HashMap<std::string, OperatorConf> dst_op_name2dst_op_confs;
+  std::vector<std::string> folded_cast_op_names;
   for (auto& pair : edges_group_by_lbn) {
     const std::string& lbn = pair.first;
     OpNode* src_node = pair.second.front()->src_node();
@@ -104,7 +126,7 @@ void InsertCastOpImpl(bool f2h, const OpGraph& op_graph, const HashSet<OpNode*>&
     if (blob_desc.data_type() != DataType::kFloat) { continue; }
 
     std::string cast_suffix = f2h ? "-cast_f2h" : "-cast_h2f";
-    DataType cast_data_type = f2h ? DataType::kFloat16 : DataType::kFloat;
+    DataType cast_data_type = f2h ? half_data_type : DataType::kFloat;
     auto cast_op = user_op::UserOpConfWrapperBuilder(ReplaceSlashToDash4Lbn(lbn) + cast_suffix)
                        .Op("cast")
                        .Input("in", lbn)
@@ -112,8 +134,13 @@ void InsertCastOpImpl(bool f2h, const OpGraph& op_graph, const HashSet<OpNode*>&
                        .Attr<DataType>("dtype", cast_data_type)
                        .ScopeSymbolId(src_node->op().op_conf().scope_symbol_id())
                        .Build();
+    std::string new_lbn = cast_op.op_name() + "/out_0";
+    std::string half_lbn;
+    const bool fold_cast = f2h && IsCastFromHalf(src_node, half_data_type, &half_lbn);
+    if (fold_cast) { new_lbn = half_lbn; }
 
     bool cast_is_consumed = false;
+    bool all_edges_rewired = true;
     for (OpEdge* edge : pair.second) {
       CHECK(src_node == edge->src_node());
       OpNode* dst_node = edge->dst_node();
@@ -125,7 +152,10 @@ void InsertCastOpImpl(bool f2h, const OpGraph& op_graph, const HashSet<OpNode*>&
       if (dst_node->op().op_conf().has_user_conf()) {
         const std::string& op_type = dst_node->op().op_conf().user_conf().op_type_name();
         const auto& op_arg = GenUnRepeatedBn(dst_ibn);
-        if (FindInNoCastRegisry(op_type, op_arg)) { continue; }
+        if (FindInNoCastRegisry(op_type, op_arg)) {
+          all_edges_rewired = false;
+          continue;
+        }
       }
 
       cast_is_consumed = true;
@@ -136,11 +166,17 @@ void InsertCastOpImpl(bool f2h, const OpGraph& op_graph, const HashSet<OpNode*>&
             dst_op_name2dst_op_confs.insert(std::make_pair(dst_op_name, dst_node->op().op_conf())));
       }
       OperatorConf& dst_op_conf = dst_op_name2dst_op_confs.at(dst_op_name);
-      std::string new_lbn = cast_op.op_name() + "/out_0";
       CHECK_EQ(lbn, ReplaceInputLbnInOpCustomizedConf(&dst_op_conf, dst_ibn, new_lbn));
     }
 
-    if (cast_is_consumed) {
+    if (cast_is_consumed && fold_cast) {
+      LOG(INFO) << "Feed " << half_lbn << " to the consumers of " << lbn << " instead of casting";
+      if (all_edges_rewired && src_node->out_edges().size() == pair.second.size()
+          && src_node->op().op_conf().ctrl_in_op_name().empty()
+          && !IsKeyFound(ctrl_in_op_names, src_node->op().op_name())) {
+        folded_cast_op_names.push_back(src_node->op().op_name());
+      }
+    } else if (cast_is_consumed) {
       job_builder->AddOps(src_node->parallel_desc().parallel_conf(),
                           std::vector<OperatorConf>{cast_op.op_conf()});
       LOG(INFO) << "Insert CastOp: " << cast_op.op_name() << " between " << lbn;
@@ -151,6 +187,7 @@ void InsertCastOpImpl(bool f2h, const OpGraph& op_graph, const HashSet<OpNode*>&
   for (const auto& pair : dst_op_name2dst_op_confs) { dst_op_confs.push_back(pair.second); }
   // make sure an op_conf can only be udpated once, cuz later update will override before
   job_builder->MutOpsOnlyOnce(dst_op_confs);
+  job_builder->DelOps(folded_cast_op_names);
 }
 
 class AutoMixedPrecision final : public JobPass {
@@ -185,7 +222,7 @@ class AutoMixedPrecision final : public JobPass {
                                        const HashSet<OpNode*>& black_set,
                                        HashSet<OpNode*>* white_set) const;
   void InsertCastOp(const OpGraph& op_graph, const HashSet<OpNode*>& white_set,
-                    JobBuilder* job_builder) const;
+                    DataType half_data_type, JobBuilder* job_builder) const;
 
   const AMPList& white_list_;
   const AMPList& black_list_;
@@ -196,6 +233,17 @@ class AutoMixedPrecision final : public JobPass {
 Maybe<void> AutoMixedPrecision::Apply(const OpGraph& op_graph, JobBuilder* job_builder) const {
   CHECK_GE(CUDA_VERSION, 10000);
   CHECK(GlobalJobDesc().DefaultDataType() == DataType::kFloat);
+  const DataType half_data_type = GlobalJobDesc().auto_mixed_precision_data_type();
+  CHECK(half_data_type == DataType::kFloat16 || half_data_type == DataType::kBFloat16)
+      << "auto mixed precision does not support " << DataType_Name(half_data_type);
+  if (half_data_type == DataType::kBFloat16) {
+    CHECK_GE(CUDA_VERSION, 11000) << "bfloat16 requires CUDA 11 or later";
+    const auto& job_conf = GlobalJobDesc().job_conf();
+    if (job_conf.has_train_conf() && job_conf.train_conf().has_dynamic_loss_scale_policy()) {
+      LOG(WARNING) << "bfloat16 has the exponent range of float, dynamic loss scaling is not "
+                      "needed with it and can be removed";
+    }
+  }
 
   VerifyAMPList(white_list_);
   VerifyAMPList(black_list_);
@@ -220,7 +268,7 @@ Maybe<void> AutoMixedPrecision::Apply(const OpGraph& op_graph, JobBuilder* job_b
   VLOG(1) << "WhiteSet include: "
           << Container2Str<HashSet<OpNode*>, OpNode*>(white_set, OpName4Node);
 
-  InsertCastOp(op_graph, white_set, job_builder);
+  InsertCastOp(op_graph, white_set, half_data_type, job_builder);
   return Maybe<void>::Ok();
 }
 
@@ -303,9 +351,9 @@ void AutoMixedPrecision::PropagateWhiteThroughClearNodes(
 }
 
 void AutoMixedPrecision::InsertCastOp(const OpGraph& op_graph, const HashSet<OpNode*>& white_set,
-                                      JobBuilder* job_builder) const {
-  InsertCastOpImpl(true, op_graph, white_set, job_builder);
-  InsertCastOpImpl(false, op_graph, white_set, job_builder);
+                                      DataType half_data_type, JobBuilder* job_builder) const {
+  InsertCastOpImpl(true, half_data_type, op_graph, white_set, job_builder);
+  InsertCastOpImpl(false, half_data_type, op_graph, white_set, job_builder);
 }
 
 REGISTER_JOB_PASS("AutoMixedPrecision", AutoMixedPrecision);
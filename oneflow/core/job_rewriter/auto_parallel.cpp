@@ -0,0 +1,457 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/job_rewriter/job_pass.h"
+#include "oneflow/core/job/job_builder.h"
+#include "oneflow/core/job/global_for.h"
+#include "oneflow/core/job/sbp_parallel.h"
+#include "oneflow/core/job/sbp_cost_model.h"
+#include "oneflow/core/graph/op_graph.h"
+#include "oneflow/core/persistence/tee_persistent_log_stream.h"
+
+namespace oneflow {
+
+namespace {
+
+const double kInfCost = std::numeric_limits<double>::infinity();
+
+std::string ParallelDistributionToString(const cfg::ParallelDistribution& parallel_distribution) {
+  std::string str = "[";
+  FOR_RANGE(int64_t, i, 0, parallel_distribution.sbp_parallel_size()) {
+    if (i > 0) { str += " "; }
+    str += SbpParallelToString(parallel_distribution.sbp_parallel(i));
+  }
+  return str + "]";
+}
+
+std::vector<std::string> BnsInOp(const Operator& op) {
+  std::vector<std::string> bns(op.input_bns().begin(), op.input_bns().end());
+  bns.insert(bns.end(), op.output_bns().begin(), op.output_bns().end());
+  return bns;
+}
+
+std::string SignatureToString(const Operator& op,
+                              const cfg::ParallelDistributionSignature& signature) {
+  std::string str;
+  for (const auto& bn : BnsInOp(op)) {
+    const auto& parallel_distribution = signature.bn_in_op2parallel_distribution().at(bn);
+    str += bn + ":" + ParallelDistributionToString(parallel_distribution) + " ";
+  }
+  return str;
+}
+
+struct OpNodeState {
+  OpNode* op_node;
+  // candidates.at(0) is the signature the greedy inference picked
+  std::vector<cfg::ParallelDistributionSignature> candidates;
+  std::vector<double> compute_costs;
+  // distinct distributions of a bn among the candidates, and the index of each candidate's one
+  HashMap<std::string, std::vector<cfg::ParallelDistribution>> bn2distributions;
+  HashMap<std::string, std::vector<int64_t>> bn2candidate_distribution_ids;
+  std::vector<int64_t> in_edge_ids;
+  std::vector<int64_t> out_edge_ids;
+  int64_t chosen;
+};
+
+struct BlobEdge {
+  int64_t producer;
+  int64_t consumer;
+  std::string obn;
+  std::string ibn;
+  // boxing cost of producer distribution id x consumer distribution id
+  std::vector<std::vector<double>> costs;
+};
+
+// Chooses one candidate signature per op minimizing compute plus boxing cost. Maximal chains of
+// ops connected one to one are solved exactly by dynamic programming with their neighbors fixed,
+// and every op is refined against its neighbors afterwards, until nothing improves.
+class SbpSearcher final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(SbpSearcher);
+  SbpSearcher(const OpGraph& op_graph, const AutoParallelConf& conf)
+      : op_graph_(op_graph), conf_(conf), cost_model_(conf) {}
+  ~SbpSearcher() = default;
+
+  Maybe<void> Init();
+  void Search();
+  double TotalCost() const;
+  int64_t searchable_op_num() const { return searchable_op_num_; }
+  const std::vector<OpNodeState>& states() const { return states_; }
+
+ private:
+  Maybe<void> InitCandidates(OpNodeState* state) const;
+  Maybe<void> InitBlobEdge(int64_t consumer, const std::string& ibn);
+  void InitChains();
+  double EdgeCost(const BlobEdge& edge, int64_t producer_candidate,
+                  int64_t consumer_candidate) const;
+  double LocalCost(int64_t node_id, int64_t candidate) const;
+  bool SolveChain(const std::vector<int64_t>& chain);
+  bool RefineNodes();
+
+  const OpGraph& op_graph_;
+  const AutoParallelConf& conf_;
+  SbpCostModel cost_model_;
+  std::vector<OpNodeState> states_;
+  HashMap<const OpNode*, int64_t> op_node2id_;
+  std::vector<BlobEdge> edges_;
+  std::vector<std::vector<int64_t>> chains_;
+  int64_t searchable_op_num_ = 0;
+};
+
+Maybe<void> SbpSearcher::Init() {
+  op_graph_.TopoForEachNode([&](OpNode* op_node) {
+    op_node2id_.emplace(op_node, states_.size());
+    states_.emplace_back();
+    states_.back().op_node = op_node;
+    states_.back().chosen = 0;
+  });
+  for (auto& state : states_) {
+    JUST(InitCandidates(&state));
+    if (state.candidates.size() > 1) { ++searchable_op_num_; }
+  }
+  FOR_RANGE(int64_t, i, 0, states_.size()) {
+    for (const auto& ibn : states_.at(i).op_node->op().input_bns()) { JUST(InitBlobEdge(i, ibn)); }
+  }
+  InitChains();
+  return Maybe<void>::Ok();
+}
+
+Maybe<void> SbpSearcher::InitCandidates(OpNodeState* state) const {
+  const OpNode* op_node = state->op_node;
+  const Operator& op = op_node->op();
+  const ParallelDesc& parallel_desc = op_node->parallel_desc();
+  const std::vector<std::string> bns = BnsInOp(op);
+  state->candidates.push_back(op_node->parallel_distribution_signature());
+  bool is_searchable = parallel_desc.parallel_num() > 1 && !IsInterfaceOpConf(op.op_conf());
+  for (const auto& obn : op.output_bns()) {
+    if (JUST(op.OptMirroredParallel4BnInOp(obn))->has_mirrored_parallel()) {
+      is_searchable = false;
+    }
+  }
+  if (is_searchable) {
+    const auto LogicalBlobDesc4Ibn = [&](const std::string& ibn) -> Maybe<const BlobDesc&> {
+      return *JUST(op.GetLogicalBlobDesc4BnInOp(ibn));
+    };
+    cfg::SbpSignatureList sbp_sig_list;
+    JUST(op.GetSbpSignaturesIf(LogicalBlobDesc4Ibn, parallel_desc, &sbp_sig_list));
+    const Shape& hierarchy = *parallel_desc.hierarchy();
+    const int64_t num_axes = hierarchy.NumAxes();
+    const int64_t sig_num = sbp_sig_list.sbp_signature_size();
+    HashSet<std::string> visited;
+    visited.insert(SignatureToString(op, state->candidates.front()));
+    // enumerates one 1d signature per hierarchy axis like an odometer
+    std::vector<int64_t> sig_ids(num_axes, 0);
+    while (sig_num > 0
+           && static_cast<int64_t>(state->candidates.size()) < conf_.max_candidates_per_op()) {
+      cfg::ParallelDistributionSignature signature;
+      bool is_valid = true;
+      for (const auto& bn : bns) {
+        auto* distribution = &(*signature.mutable_bn_in_op2parallel_distribution())[bn];
+        for (int64_t sig_id : sig_ids) {
+          const auto& bn2sbp = sbp_sig_list.sbp_signature(sig_id).bn_in_op2sbp_parallel();
+          const auto& it = bn2sbp.find(bn);
+          if (it == bn2sbp.end()) {
+            is_valid = false;
+            break;
+          }
+          *distribution->add_sbp_parallel() = it->second;
+        }
+        if (!is_valid) { break; }
+        const Shape& shape = JUST(op.GetLogicalBlobDesc4BnInOp(bn))->shape();
+        if (!IsParallelDistributionValidForShape(hierarchy, *distribution, shape)) {
+          is_valid = false;
+          break;
+        }
+      }
+      if (is_valid && visited.insert(SignatureToString(op, signature)).second) {
+        state->candidates.push_back(signature);
+      }
+      int64_t axis = num_axes - 1;
+      while (axis >= 0 && ++sig_ids.at(axis) == sig_num) { sig_ids.at(axis--) = 0; }
+      if (axis < 0) { break; }
+    }
+  }
+  for (const auto& bn : bns) {
+    auto* distributions = &state->bn2distributions[bn];
+    auto* candidate_distribution_ids = &state->bn2candidate_distribution_ids[bn];
+    HashMap<std::string, int64_t> str2distribution_id;
+    for (const auto& candidate : state->candidates) {
+      const auto& distribution = candidate.bn_in_op2parallel_distribution().at(bn);
+      const auto& it =
+          str2distribution_id.emplace(ParallelDistributionToString(distribution),
+                                      distributions->size());
+      if (it.second) { distributions->push_back(distribution); }
+      candidate_distribution_ids->push_back(it.first->second);
+    }
+  }
+  for (const auto& candidate : state->candidates) {
+    double cost = 0;
+    for (const auto& bn : bns) {
+      cost += cost_model_.ComputeCost(parallel_desc,
+                                      candidate.bn_in_op2parallel_distribution().at(bn),
+                                      *JUST(op.GetLogicalBlobDesc4BnInOp(bn)));
+    }
+    state->compute_costs.push_back(cost);
+  }
+  return Maybe<void>::Ok();
+}
+
+Maybe<void> SbpSearcher::InitBlobEdge(int64_t consumer, const std::string& ibn) {
+  OpNodeState* consumer_state = &states_.at(consumer);
+  const OpNode* consumer_node = consumer_state->op_node;
+  const LogicalBlobId& lbi = consumer_node->op().BnInOp2Lbi(ibn);
+  const OpNode* producer_node = consumer_node->MutSrcNode4Ibn(ibn);
+  const int64_t producer = op_node2id_.at(producer_node);
+  OpNodeState* producer_state = &states_.at(producer);
+  BlobEdge edge;
+  edge.producer = producer;
+  edge.consumer = consumer;
+  edge.obn = *JUST(producer_node->op().obn4lbi(lbi));
+  edge.ibn = ibn;
+  const BlobDesc& logical_blob_desc = producer_node->LogicalBlobDesc4Lbi(lbi);
+  // a mutable input is written in place, so boxing it would lose the writes
+  const bool is_mutable = consumer_node->op().InputBlobModifier4Ibn(ibn).is_mutable();
+  const bool is_same_placement = producer_node->parallel_desc() == consumer_node->parallel_desc();
+  for (const auto& src : producer_state->bn2distributions.at(edge.obn)) {
+    edge.costs.emplace_back();
+    for (const auto& dst : consumer_state->bn2distributions.at(ibn)) {
+      if (is_mutable && (!is_same_placement || src != dst)) {
+        edge.costs.back().push_back(kInfCost);
+      } else {
+        edge.costs.back().push_back(cost_model_.BoxingCost(
+            producer_node->parallel_desc(), consumer_node->parallel_desc(), src, dst,
+            logical_blob_desc));
+      }
+    }
+  }
+  producer_state->out_edge_ids.push_back(edges_.size());
+  consumer_state->in_edge_ids.push_back(edges_.size());
+  edges_.push_back(std::move(edge));
+  return Maybe<void>::Ok();
+}
+
+void SbpSearcher::InitChains() {
+  const auto SoleNeighbor = [&](const std::vector<int64_t>& edge_ids, bool is_producer) {
+    int64_t neighbor = -1;
+    for (int64_t edge_id : edge_ids) {
+      const BlobEdge& edge = edges_.at(edge_id);
+      const int64_t cur = is_producer ? edge.producer : edge.consumer;
+      if (neighbor != -1 && neighbor != cur) { return static_cast<int64_t>(-1); }
+      neighbor = cur;
+    }
+    return neighbor;
+  };
+  std::vector<int64_t> next(states_.size(), -1);
+  std::vector<int64_t> prev(states_.size(), -1);
+  FOR_RANGE(int64_t, i, 0, states_.size()) {
+    const int64_t consumer = SoleNeighbor(states_.at(i).out_edge_ids, false);
+    if (consumer == -1) { continue; }
+    if (SoleNeighbor(states_.at(consumer).in_edge_ids, true) != i) { continue; }
+    next.at(i) = consumer;
+    prev.at(consumer) = i;
+  }
+  FOR_RANGE(int64_t, i, 0, states_.size()) {
+    if (prev.at(i) != -1 || next.at(i) == -1) { continue; }
+    std::vector<int64_t> chain;
+    bool is_searchable = false;
+    for (int64_t cur = i; cur != -1; cur = next.at(cur)) {
+      chain.push_back(cur);
+      is_searchable = is_searchable || states_.at(cur).candidates.size() > 1;
+    }
+    if (is_searchable) { chains_.push_back(std::move(chain)); }
+  }
+}
+
+double SbpSearcher::EdgeCost(const BlobEdge& edge, int64_t producer_candidate,
+                             int64_t consumer_candidate) const {
+  const int64_t src_id =
+      states_.at(edge.producer).bn2candidate_distribution_ids.at(edge.obn).at(producer_candidate);
+  const int64_t dst_id =
+      states_.at(edge.consumer).bn2candidate_distribution_ids.at(edge.ibn).at(consumer_candidate);
+  return edge.costs.at(src_id).at(dst_id);
+}
+
+double SbpSearcher::LocalCost(int64_t node_id, int64_t candidate) const {
+  const OpNodeState& state = states_.at(node_id);
+  double cost = state.compute_costs.at(candidate);
+  for (int64_t edge_id : state.in_edge_ids) {
+    const BlobEdge& edge = edges_.at(edge_id);
+    cost += EdgeCost(edge, states_.at(edge.producer).chosen, candidate);
+  }
+  for (int64_t edge_id : state.out_edge_ids) {
+    const BlobEdge& edge = edges_.at(edge_id);
+    cost += EdgeCost(edge, candidate, states_.at(edge.consumer).chosen);
+  }
+  return cost;
+}
+
+double SbpSearcher::TotalCost() const {
+  double cost = 0;
+  for (const auto& state : states_) { cost += state.compute_costs.at(state.chosen); }
+  for (const auto& edge : edges_) {
+    cost += EdgeCost(edge, states_.at(edge.producer).chosen, states_.at(edge.consumer).chosen);
+  }
+  return cost;
+}
+
+bool SbpSearcher::SolveChain(const std::vector<int64_t>& chain) {
+  // Inside a chain a node only consumes its predecessor, so the edges toward the rest of the
+  // graph are the in edges of the head and the out edges of the tail, which stay fixed.
+  const auto UnaryCost = [&](int64_t pos, int64_t candidate) {
+    const int64_t node_id = chain.at(pos);
+    const OpNodeState& state = states_.at(node_id);
+    double cost = state.compute_costs.at(candidate);
+    if (pos == 0) {
+      for (int64_t edge_id : state.in_edge_ids) {
+        const BlobEdge& edge = edges_.at(edge_id);
+        cost += EdgeCost(edge, states_.at(edge.producer).chosen, candidate);
+      }
+    }
+    if (pos == static_cast<int64_t>(chain.size()) - 1) {
+      for (int64_t edge_id : state.out_edge_ids) {
+        const BlobEdge& edge = edges_.at(edge_id);
+        cost += EdgeCost(edge, candidate, states_.at(edge.consumer).chosen);
+      }
+    }
+    return cost;
+  };
+  std::vector<std::vector<double>> pos2costs(chain.size());
+  std::vector<std::vector<int64_t>> pos2prev_candidates(chain.size());
+  FOR_RANGE(int64_t, k, 0, states_.at(chain.front()).candidates.size()) {
+    pos2costs.front().push_back(UnaryCost(0, k));
+  }
+  FOR_RANGE(int64_t, pos, 1, chain.size()) {
+    const OpNodeState& prev_state = states_.at(chain.at(pos - 1));
+    const OpNodeState& state = states_.at(chain.at(pos));
+    FOR_RANGE(int64_t, k, 0, state.candidates.size()) {
+      // ties keep the current choice to avoid needless changes
+      int64_t best_prev = prev_state.chosen;
+      double best_cost = kInfCost;
+      FOR_RANGE(int64_t, j, -1, static_cast<int64_t>(prev_state.candidates.size())) {
+        const int64_t prev = j == -1 ? prev_state.chosen : j;
+        double cost = pos2costs.at(pos - 1).at(prev);
+        for (int64_t edge_id : state.in_edge_ids) { cost += EdgeCost(edges_.at(edge_id), prev, k); }
+        if (cost < best_cost) {
+          best_cost = cost;
+          best_prev = prev;
+        }
+      }
+      pos2costs.at(pos).push_back(best_cost + UnaryCost(pos, k));
+      pos2prev_candidates.at(pos).push_back(best_prev);
+    }
+  }
+  const std::vector<double>& last_costs = pos2costs.back();
+  int64_t best = states_.at(chain.back()).chosen;
+  FOR_RANGE(int64_t, k, 0, last_costs.size()) {
+    if (last_costs.at(k) < last_costs.at(best)) { best = k; }
+  }
+  bool changed = false;
+  for (int64_t pos = chain.size() - 1; pos >= 0; --pos) {
+    OpNodeState* state = &states_.at(chain.at(pos));
+    if (state->chosen != best) {
+      state->chosen = best;
+      changed = true;
+    }
+    if (pos > 0) { best = pos2prev_candidates.at(pos).at(best); }
+  }
+  return changed;
+}
+
+bool SbpSearcher::RefineNodes() {
+  bool changed = false;
+  FOR_RANGE(int64_t, i, 0, states_.size()) {
+    OpNodeState* state = &states_.at(i);
+    if (state->candidates.size() <= 1) { continue; }
+    int64_t best = state->chosen;
+    double best_cost = LocalCost(i, best);
+    FOR_RANGE(int64_t, k, 0, state->candidates.size()) {
+      const double cost = LocalCost(i, k);
+      // relative margin against floating point noise
+      if (cost < best_cost * (1 - 1e-9)) {
+        best = k;
+        best_cost = cost;
+      }
+    }
+    if (best != state->chosen) {
+      state->chosen = best;
+      changed = true;
+    }
+  }
+  return changed;
+}
+
+void SbpSearcher::Search() {
+  FOR_RANGE(int64_t, i, 0, conf_.max_iterations()) {
+    double cost_before = TotalCost();
+    bool changed = false;
+    for (const auto& chain : chains_) { changed = SolveChain(chain) || changed; }
+    changed = RefineNodes() || changed;
+    if (!changed || TotalCost() >= cost_before) { break; }
+  }
+}
+
+class AutoParallelPass final : public JobPass {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(AutoParallelPass);
+  AutoParallelPass() = default;
+  ~AutoParallelPass() override = default;
+
+  bool IsEnabled(const JobPassCtx& ctx) const { return ctx.job_desc().enable_auto_parallel(); }
+  Maybe<void> Apply(const OpGraph& op_graph, JobBuilder* job_builder,
+                    const JobDesc& job_desc) const;
+
+  Maybe<void> Apply(Job* job, JobPassCtx* ctx) const override {
+    if (!IsEnabled(*ctx)) { return Maybe<void>::Ok(); }
+    const OpGraph op_graph(*job);
+    JobBuilder job_builder(job);
+    return Apply(op_graph, &job_builder, ctx->job_desc());
+  }
+};
+
+Maybe<void> AutoParallelPass::Apply(const OpGraph& op_graph, JobBuilder* job_builder,
+                                    const JobDesc& job_desc) const {
+  SbpSearcher searcher(op_graph, job_desc.auto_parallel_conf());
+  JUST(searcher.Init());
+  const double initial_cost = searcher.TotalCost();
+  searcher.Search();
+  const double final_cost = searcher.TotalCost();
+  int64_t changed_op_num = 0;
+  std::unique_ptr<TeePersistentLogStream> log_stream;
+  if (Global<ResourceDesc, ForSession>::Get()->enable_debug_mode()) {
+    log_stream = TeePersistentLogStream::Create("auto_parallel/" + job_desc.job_name() + ".csv");
+    log_stream->Write("op_name,greedy_signature,chosen_signature\n");
+  }
+  for (const auto& state : searcher.states()) {
+    if (state.chosen == 0) { continue; }
+    const Operator& op = state.op_node->op();
+    const auto& signature = state.candidates.at(state.chosen);
+    job_builder->AddParallelDistributionSignature4OpName(op.op_name(), signature);
+    if (log_stream) {
+      log_stream->Write(op.op_name() + "," + SignatureToString(op, state.candidates.front()) + ","
+                        + SignatureToString(op, signature) + "\n");
+    }
+    ++changed_op_num;
+  }
+  LOG(INFO) << "AutoParallelPass of job " << job_desc.job_name() << ": estimated cost "
+            << initial_cost << "s -> " << final_cost << "s, changed " << changed_op_num << " of "
+            << searcher.searchable_op_num() << " searchable ops";
+  return Maybe<void>::Ok();
+}
+
+}  // namespace
+
+REGISTER_JOB_PASS("AutoParallelPass", AutoParallelPass);
+
+}  // namespace oneflow
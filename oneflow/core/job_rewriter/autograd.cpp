@@ -663,34 +663,18 @@ void ClipGradientByGlobalNorm(const OpGraph& op_graph, JobBuilder* job_builder,
   const std::string square_sum_lbn =
       AddLbns(job_builder, square_sum_lbns_for_add, global_norm_parallel_conf, scope_symbol_id,
               "System-ClipGradient-GlobalNorm-Add-");
-  auto inv_global_norm_op = user_op::UserOpConfWrapperBuilder(
-                                "System-ClipGradient-GlobalNorm-InvGlobalNorm-" + NewUniqueId())
-                                .Op("rsqrt")
-                                .Input("x", square_sum_lbn)
-                                .Output("y")
-                                .ScopeSymbolId(scope_symbol_id)
-                                .Build();
-  job_builder->AddOps(global_norm_parallel_conf, {inv_global_norm_op.op_conf()});
-  OperatorConf inv_clip_norm_op_conf{};
-  inv_clip_norm_op_conf.set_name("System-ClipGradient-GlobalNorm-InvClipNorm-" + NewUniqueId());
-  ConstantLikeOpConf* inv_clip_norm_constant_like_conf =
-      inv_clip_norm_op_conf.mutable_constant_like_conf();
-  inv_clip_norm_constant_like_conf->set_like(inv_global_norm_op.output("y", 0));
-  inv_clip_norm_constant_like_conf->set_float_operand(1.0 / conf.clip_norm());
-  inv_clip_norm_constant_like_conf->set_out("out");
-  inv_clip_norm_op_conf.set_scope_symbol_id(scope_symbol_id);
-  job_builder->AddOps(global_norm_parallel_conf, {inv_clip_norm_op_conf});
-  auto minimum_op =
-      user_op::UserOpConfWrapperBuilder("System-ClipGradient-GlobalNorm-Minimum-" + NewUniqueId())
-          .Op("broadcast_minimum")
-          .Input("x", inv_global_norm_op.output("y", 0))
-          .Input("y", GenLogicalBlobName(inv_clip_norm_op_conf.name(),
-                                         inv_clip_norm_constant_like_conf->out()))
-          .Output("z")
-          .ScopeSymbolId(scope_symbol_id)
-          .Build();
-  job_builder->AddOps(global_norm_parallel_conf, {minimum_op.op_conf()});
-  const std::string gradient_scale_factor_lbn = minimum_op.output("z", 0);
+  auto clip_scale_op = user_op::UserOpConfWrapperBuilder(
+                           "System-ClipGradient-GlobalNorm-ClipScale-" + NewUniqueId())
+                           .Op("clip_by_global_norm_scale")
+                           .Input("square_sum", square_sum_lbn)
+                           .Output("scale")
+                           .Attr<float>("clip_norm", conf.clip_norm())
+                           .ScopeSymbolId(scope_symbol_id)
+                           .Build();
+  job_builder->AddOps(global_norm_parallel_conf, {clip_scale_op.op_conf()});
+  // the scalar_mul_by_tensor below is folded into the update op as scale_by_tensor by
+  // FuseUpdateOpsPass, so the update kernels read the scale from device memory
+  const std::string gradient_scale_factor_lbn = clip_scale_op.output("scale", 0);
   for (auto& pair : *lbi2diff_lbi) {
     const LogicalBlobId& lbi = pair.first;
     LogicalBlobId& diff_lbi = pair.second;
@@ -1042,6 +1026,135 @@ void ClipGradient(const OpGraph& op_graph, JobBuilder* job_builder,
   }
 }
 
+namespace {
+
+// g' = g + e, h = cast(g', half), e = g' - cast(h, float), where the error feedback e is a
+// per-rank residual kept in a partial sum variable
+void CompressGradientByCastToHalf(const OpNode* model_op_node,
+                                  const CastToHalfGradientCompressionConf& conf,
+                                  JobBuilder* job_builder, LogicalBlobId* diff_lbi) {
+  const VariableOpConf& model_conf = model_op_node->op().op_conf().variable_conf();
+  const int64_t scope_symbol_id = model_op_node->op().op_conf().scope_symbol_id();
+  const ParallelConf& parallel_conf = model_op_node->parallel_desc().parallel_conf();
+  const std::string prefix = "System-GradientCompression-CastToHalf-" + NewUniqueId();
+  std::vector<OperatorConf> op_confs;
+  std::string diff_lbn = GenLogicalBlobName(*diff_lbi);
+  std::string error_lbn;
+  if (conf.enable_error_feedback()) {
+    OperatorConf error_op_conf;
+    error_op_conf.set_name("System-GradientCompression-ErrorFeedback-"
+                           + model_op_node->op().op_name());
+    error_op_conf.set_scope_symbol_id(scope_symbol_id);
+    VariableOpConf* error_conf = error_op_conf.mutable_variable_conf();
+    error_conf->set_out("out");
+    *error_conf->mutable_shape() = model_conf.shape();
+    error_conf->set_data_type(model_conf.data_type());
+    error_conf->mutable_initializer()->mutable_constant_conf()->set_value(0);
+    error_conf->set_trainable(false);
+    FOR_RANGE(int64_t, i, 0, model_op_node->parallel_desc().hierarchy()->NumAxes()) {
+      error_conf->add_parallel_distribution("P");
+    }
+    error_lbn = GenLogicalBlobName(error_op_conf.name(), error_conf->out());
+    const auto add_op = user_op::UserOpConfWrapperBuilder(prefix + "-AddErrorFeedback")
+                            .Op("add_n")
+                            .Input("in", diff_lbn)
+                            .Input("in", error_lbn)
+                            .Output("out")
+                            .ScopeSymbolId(scope_symbol_id)
+                            .Build();
+    op_confs.push_back(error_op_conf);
+    op_confs.push_back(add_op.op_conf());
+    diff_lbn = add_op.output("out", 0);
+  }
+  const auto cast_to_half_op = user_op::UserOpConfWrapperBuilder(prefix + "-CastToHalf")
+                                   .Op("cast")
+                                   .Input("in", diff_lbn)
+                                   .Output("out")
+                                   .Attr<DataType>("dtype", DataType::kFloat16)
+                                   .ScopeSymbolId(scope_symbol_id)
+                                   .Build();
+  op_confs.push_back(cast_to_half_op.op_conf());
+  if (conf.enable_error_feedback()) {
+    const auto rounded_op = user_op::UserOpConfWrapperBuilder(prefix + "-Rounded")
+                                .Op("cast")
+                                .Input("in", cast_to_half_op.output("out", 0))
+                                .Output("out")
+                                .Attr<DataType>("dtype", model_conf.data_type())
+                                .ScopeSymbolId(scope_symbol_id)
+                                .Build();
+    const auto error_op = user_op::UserOpConfWrapperBuilder(prefix + "-RoundingError")
+                              .Op("broadcast_sub")
+                              .Input("x", diff_lbn)
+                              .Input("y", rounded_op.output("out", 0))
+                              .Output("z")
+                              .ScopeSymbolId(scope_symbol_id)
+                              .Build();
+    const auto assign_op = user_op::UserOpConfWrapperBuilder(prefix + "-UpdateErrorFeedback")
+                               .Op("assign")
+                               .Input("ref", error_lbn)
+                               .Input("value", error_op.output("z", 0))
+                               .ScopeSymbolId(scope_symbol_id)
+                               .Build();
+    op_confs.push_back(rounded_op.op_conf());
+    op_confs.push_back(error_op.op_conf());
+    op_confs.push_back(assign_op.op_conf());
+  }
+  std::vector<std::string> parallel_distribution;
+  for (const auto& sbp_parallel :
+       model_op_node->ParallelDistribution4BnInOp("out").sbp_parallel()) {
+    parallel_distribution.push_back(SbpParallelToString(sbp_parallel));
+  }
+  // the partial sum to broadcast boxing, i.e. the all-reduce, happens on the half precision blob
+  const auto parallel_cast_op =
+      user_op::UserOpConfWrapperBuilder(prefix + "-ParallelCast")
+          .Op("hierarchical_parallel_cast")
+          .Input("in", cast_to_half_op.output("out", 0))
+          .Output("out")
+          .Attr<std::vector<std::string>>("parallel_distribution", parallel_distribution)
+          .Attr<std::string>("grad_mode", "auto")
+          .Attr<std::vector<std::string>>("grad_parallel_distribution", std::vector<std::string>())
+          .ScopeSymbolId(scope_symbol_id)
+          .Build();
+  const auto cast_back_op = user_op::UserOpConfWrapperBuilder(prefix + "-CastBack")
+                                .Op("cast")
+                                .Input("in", parallel_cast_op.output("out", 0))
+                                .Output("out")
+                                .Attr<DataType>("dtype", model_conf.data_type())
+                                .ScopeSymbolId(scope_symbol_id)
+                                .Build();
+  op_confs.push_back(parallel_cast_op.op_conf());
+  op_confs.push_back(cast_back_op.op_conf());
+  job_builder->AddOps(parallel_conf, op_confs);
+  *diff_lbi = GenLogicalBlobId(cast_back_op.output("out", 0));
+}
+
+}  // namespace
+
+void CompressGradient(const OpGraph& op_graph, JobBuilder* job_builder,
+                      HashMap<LogicalBlobId, LogicalBlobId>* lbi2diff_lbi,
+                      const GradientCompressionConf& compression_conf) {
+  for (const std::string& variable : compression_conf.variable_op_names()) {
+    auto it = lbi2diff_lbi->find(GenLogicalBlobId(variable + "/out"));
+    if (it == lbi2diff_lbi->end()) { continue; }
+    const OpNode* model_op_node = op_graph.OpNode4OpName(variable);
+    // only data parallel gradients are all-reduced
+    if (!IsBroadcast(model_op_node->ParallelDistribution4BnInOp("out"),
+                     model_op_node->parallel_desc())
+        || model_op_node->parallel_desc().parallel_num() <= 1) {
+      continue;
+    }
+    if (model_op_node->op().op_conf().variable_conf().data_type() != DataType::kFloat) {
+      continue;
+    }
+    if (compression_conf.has_cast_to_half_conf()) {
+      CompressGradientByCastToHalf(model_op_node, compression_conf.cast_to_half_conf(),
+                                   job_builder, &it->second);
+    } else {
+      UNIMPLEMENTED();
+    }
+  }
+}
+
 void AddDiffParallelCast(const OpGraph& op_graph, JobBuilder* job_builder,
                          HashMap<LogicalBlobId, LogicalBlobId>* lbi2diff_lbi) {
   for (auto& pair : *lbi2diff_lbi) {
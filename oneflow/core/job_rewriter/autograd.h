@@ -44,6 +44,9 @@ void RegularizeGradient(const OpGraph& op_graph, JobBuilder* job_builder,
                         HashMap<LogicalBlobId, LogicalBlobId>* lbi2diff_lbi);
 void ClipGradient(const OpGraph& op_graph, JobBuilder* job_builder,
                   HashMap<LogicalBlobId, LogicalBlobId>* lbi2diff_lbi, const ClipConf& clip_conf);
+void CompressGradient(const OpGraph& op_graph, JobBuilder* job_builder,
+                      HashMap<LogicalBlobId, LogicalBlobId>* lbi2diff_lbi,
+                      const GradientCompressionConf& compression_conf);
 Maybe<void> GenerateBackwardOpConfIf(
     const Operator& op, std::vector<OperatorConf>* op_confs,
     const std::function<LogicalBlobId*(const std::string&)>& DiffLbi4BnInOp,
@@ -0,0 +1,117 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/job_rewriter/job_pass.h"
+#include "oneflow/core/framework/framework.h"
+#include "oneflow/core/device/cuda_stream_index.h"
+
+namespace oneflow {
+
+namespace {
+
+bool IsBranchableOpNode(const OpNode* node) {
+  if (node->parallel_desc().device_type() != DeviceType::kGPU) { return false; }
+  const OperatorConf& op_conf = node->op().op_conf();
+  if (!op_conf.has_user_conf() || op_conf.has_stream_index_hint()) { return false; }
+  const std::string& op_type_name = op_conf.user_conf().op_type_name();
+  return op_type_name != "identity_buffer" && op_type_name != "repeat" && op_type_name != "acc"
+         && op_type_name != "pack" && op_type_name != "unpack";
+}
+
+std::vector<const OpNode*> SortedBranchableOutNodes(const OpNode* node) {
+  std::vector<const OpNode*> out_nodes;
+  node->ForEachNodeOnOutEdge([&](const OpNode* out_node) {
+    if (IsBranchableOpNode(out_node)) { out_nodes.push_back(out_node); }
+  });
+  std::sort(out_nodes.begin(), out_nodes.end(), [](const OpNode* lhs, const OpNode* rhs) {
+    return lhs->op().op_name() < rhs->op().op_name();
+  });
+  return out_nodes;
+}
+
+// Colors the GPU user ops with branches, 0 for the compute stream of the device and 1 to
+// num_streams - 1 for its branch compute streams. An op continues the branch of the op it is the
+// first consumer of. At a fork, the consumers that no other consumer reaches start new branches,
+// which take the branch compute streams in turn. The joins need nothing more, the consumer on the
+// other stream is only notified when the regst it reads is ready, and the memory of ops on
+// different streams is shared only if their mem chains are in strict order.
+class BranchComputeStreamPass final : public JobPass {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(BranchComputeStreamPass);
+  BranchComputeStreamPass() = default;
+  ~BranchComputeStreamPass() override = default;
+
+  bool IsEnabled(const JobPassCtx& ctx) const {
+    return ctx.job_desc().job_conf().num_branch_compute_streams() > 1;
+  }
+
+  Maybe<void> Apply(Job* job, JobPassCtx* ctx) const override {
+    if (!IsEnabled(*ctx)) { return Maybe<void>::Ok(); }
+    const OpGraph op_graph(*job);
+    JobBuilder job_builder(job);
+    return Apply(op_graph, &job_builder, ctx->job_desc().job_conf().num_branch_compute_streams());
+  }
+
+  Maybe<void> Apply(const OpGraph& op_graph, JobBuilder* job_builder, int64_t num_streams) const;
+};
+
+Maybe<void> BranchComputeStreamPass::Apply(const OpGraph& op_graph, JobBuilder* job_builder,
+                                           int64_t num_streams) const {
+  CudaStreamIndexGenerator stream_idx_gen;
+  num_streams = std::min<int64_t>(num_streams, stream_idx_gen.GetBranchComputeStreamCount() + 1);
+  auto IsReachable = op_graph.MakePredicatorIsOpNameDataOrCtrlReachable();
+  HashMap<const OpNode*, int64_t> node2branch;
+  int64_t last_branch = 0;
+  op_graph.TopoForEachNode([&](const OpNode* node) {
+    if (!IsBranchableOpNode(node)) { return; }
+    const int64_t branch = node2branch.emplace(node, 0).first->second;
+    const std::vector<const OpNode*> out_nodes = SortedBranchableOutNodes(node);
+    bool is_first_branch = true;
+    for (const OpNode* out_node : out_nodes) {
+      if (node2branch.find(out_node) != node2branch.end()) { continue; }
+      const bool is_reached_by_sibling =
+          std::any_of(out_nodes.cbegin(), out_nodes.cend(), [&](const OpNode* sibling) {
+            return sibling != out_node
+                   && IsReachable(sibling->op().op_name(), out_node->op().op_name());
+          });
+      if (is_reached_by_sibling) { continue; }
+      if (is_first_branch) {
+        node2branch.emplace(out_node, branch);
+        is_first_branch = false;
+      } else {
+        last_branch = last_branch % (num_streams - 1) + 1;
+        node2branch.emplace(out_node, last_branch);
+      }
+    }
+  });
+  std::vector<OperatorConf> mut_op_confs;
+  for (const auto& pair : node2branch) {
+    if (pair.second == 0) { continue; }
+    OperatorConf op_conf = pair.first->op().op_conf();
+    op_conf.set_stream_index_hint(
+        static_cast<int32_t>(stream_idx_gen.GenerateBranchComputeStreamIndex(pair.second - 1)));
+    mut_op_confs.push_back(op_conf);
+  }
+  LOG(INFO) << "put " << mut_op_confs.size() << " ops of job "
+            << job_builder->job().job_conf().job_name() << " on branch compute streams";
+  job_builder->MutOpsOnlyOnce(mut_op_confs);
+  return Maybe<void>::Ok();
+}
+
+}  // namespace
+
+REGISTER_JOB_PASS("BranchComputeStreamPass", BranchComputeStreamPass);
+
+}  // namespace oneflow
@@ -0,0 +1,226 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/job_rewriter/job_pass.h"
+#include "oneflow/core/framework/framework.h"
+
+namespace oneflow {
+
+namespace {
+
+const std::string kChannelsLastOpNamePrefix = "System-ChannelsLast-";
+const std::vector<int32_t> kPermToNhwc = {0, 2, 3, 1};
+const std::vector<int32_t> kPermToNchw = {0, 3, 1, 2};
+
+// The args of an op with a layout attr that are channels-last once the attr is rewritten.
+struct LayoutArgs {
+  std::vector<std::string> inputs;
+  std::vector<std::string> outputs;
+};
+
+const HashMap<std::string, LayoutArgs>& LayoutOpType2Args() {
+  static const HashMap<std::string, LayoutArgs> op_type2args = {
+      {"conv2d", {{"in"}, {"out"}}},
+      {"avg_pool_2d", {{"x"}, {"y"}}},
+      {"max_pool_2d", {{"x"}, {"y"}}},
+      {"normalization", {{"x", "_add_to_output"}, {"y"}}},
+      {"normalization_add_relu", {{"x", "addend"}, {"y"}}},
+      {"bias_add", {{"a"}, {"out"}}},
+  };
+  return op_type2args;
+}
+
+// The ops that compute the same thing on any layout as long as all their inputs share it.
+bool IsLayoutAgnosticOpType(const std::string& op_type_name) {
+  static const HashSet<std::string> op_types = {"relu",     "add_n",      "cast",
+                                                "identity", "scalar_mul", "scalar_add"};
+  return op_types.find(op_type_name) != op_types.end();
+}
+
+bool IsChannelsFirst(const user_op::UserOpConfWrapper& conf) {
+  const std::string& op_type_name = conf.op_type_name();
+  if (op_type_name == "conv2d" || op_type_name == "avg_pool_2d" || op_type_name == "max_pool_2d") {
+    return conf.attr<std::string>("data_format") == "channels_first";
+  }
+  return conf.attr<int32_t>("axis") == 1;
+}
+
+void SetChannelsLast(OperatorConf* op_conf) {
+  const std::string& op_type_name = op_conf->user_conf().op_type_name();
+  auto* attr = op_conf->mutable_user_conf()->mutable_attr();
+  if (op_type_name == "conv2d" || op_type_name == "avg_pool_2d" || op_type_name == "max_pool_2d") {
+    (*attr)["data_format"].set_at_string("channels_last");
+  } else {
+    (*attr)["axis"].set_at_int32(3);
+  }
+}
+
+bool Is4D(const OpNode* op_node, const std::string& lbn) {
+  return op_node->LogicalBlobDesc4Lbi(GenLogicalBlobId(lbn)).shape().NumAxes() == 4;
+}
+
+// Runs the chains of conv2d, pooling, batch norm and the elementwise ops between them in NHWC.
+// These ops are rewritten to their channels-last form, a transpose is inserted where a tensor
+// enters such a chain and one back where it leaves, so that the rest of the job still sees NCHW.
+// The conv weights keep their NCHW variables and are transposed by the job itself. It runs before
+// the backward is generated, so the grads are channels-last as well.
+class ChannelsLastLayoutPass final : public JobPass {
+ public:
+  ChannelsLastLayoutPass() = default;
+  ~ChannelsLastLayoutPass() override = default;
+
+  bool IsEnabled(const JobPassCtx& ctx) const {
+    return ctx.job_desc().job_conf().enable_channels_last_layout();
+  }
+  Maybe<void> Apply(const OpGraph& op_graph, JobBuilder* job_builder) const;
+
+  Maybe<void> Apply(Job* job, JobPassCtx* ctx) const override {
+    if (!IsEnabled(*ctx)) { return Maybe<void>::Ok(); }
+    const OpGraph op_graph(*job);
+    JobBuilder job_builder(job);
+    return Apply(op_graph, &job_builder);
+  }
+};
+
+Maybe<void> ChannelsLastLayoutPass::Apply(const OpGraph& op_graph, JobBuilder* job_builder) const {
+  const auto& op_type2args = LayoutOpType2Args();
+  HashSet<std::string> nhwc_lbns;
+  HashSet<const OpNode*> layout_nodes;
+  std::vector<const OpNode*> region_nodes;
+  op_graph.TopoForEachNode([&](const OpNode* op_node) {
+    const OperatorConf& op_conf = op_node->op().op_conf();
+    if (!op_conf.has_user_conf()) { return; }
+    if (op_node->parallel_desc().device_type() != DeviceType::kGPU) { return; }
+    const user_op::UserOpConfWrapper conf(op_conf);
+    const auto args_it = op_type2args.find(conf.op_type_name());
+    if (args_it != op_type2args.end()) {
+      if (!IsChannelsFirst(conf)) { return; }
+      const auto& nhwc_inputs = args_it->second.inputs;
+      for (const auto& pair : op_conf.user_conf().input()) {
+        const bool is_nhwc_arg =
+            std::find(nhwc_inputs.begin(), nhwc_inputs.end(), pair.first) != nhwc_inputs.end();
+        for (const std::string& lbn : pair.second.s()) {
+          if (is_nhwc_arg && !Is4D(op_node, lbn)) { return; }
+          if (!is_nhwc_arg && nhwc_lbns.find(lbn) != nhwc_lbns.end()) { return; }
+        }
+      }
+      layout_nodes.insert(op_node);
+      for (const std::string& arg : args_it->second.outputs) {
+        for (int32_t i = 0; i < conf.output_size(arg); ++i) {
+          nhwc_lbns.insert(conf.output(arg, i));
+        }
+      }
+    } else if (IsLayoutAgnosticOpType(conf.op_type_name())) {
+      if (op_node->op().input_bns().empty()) { return; }
+      for (const std::string& ibn : op_node->op().input_bns()) {
+        const std::string lbn = GenLogicalBlobName(op_node->op().BnInOp2Lbi(ibn));
+        if (nhwc_lbns.find(lbn) == nhwc_lbns.end()) { return; }
+      }
+      for (const std::string& obn : op_node->op().output_bns()) {
+        nhwc_lbns.insert(GenLogicalBlobName(op_node->op().BnInOp2Lbi(obn)));
+      }
+    } else {
+      return;
+    }
+    region_nodes.push_back(op_node);
+  });
+  if (region_nodes.empty()) { return Maybe<void>::Ok(); }
+  const HashSet<const OpNode*> region_node_set(region_nodes.begin(), region_nodes.end());
+
+  HashMap<std::string, OperatorConf> op_name2new_conf;
+  auto MutOpConf = [&](const OpNode* op_node) -> OperatorConf* {
+    auto it = op_name2new_conf.find(op_node->op().op_name());
+    if (it == op_name2new_conf.end()) {
+      it = op_name2new_conf.emplace(op_node->op().op_name(), op_node->op().op_conf()).first;
+    }
+    return &it->second;
+  };
+  HashMap<std::string, std::string> lbn2nhwc_lbn;
+  HashMap<std::string, std::string> lbn2nchw_lbn;
+  // placement_node is the op whose placement and scope the transpose is built with
+  auto Transpose = [&](const std::string& lbn, bool to_nhwc,
+                       const OpNode* placement_node) -> Maybe<std::string> {
+    auto* lbn2transposed = to_nhwc ? &lbn2nhwc_lbn : &lbn2nchw_lbn;
+    const auto it = lbn2transposed->find(lbn);
+    if (it != lbn2transposed->end()) { return it->second; }
+    const LogicalBlobId lbi = GenLogicalBlobId(lbn);
+    const std::string op_name = kChannelsLastOpNamePrefix + (to_nhwc ? "ToNhwc-" : "ToNchw-")
+                                + lbi.op_name() + "-" + lbi.blob_name();
+    user_op::UserOpConfWrapperBuilder builder(op_name);
+    builder.Op("transpose")
+        .Input("input", lbn)
+        .Output("output")
+        .Attr<std::vector<int32_t>>("perm", to_nhwc ? kPermToNhwc : kPermToNchw);
+    const OperatorConf& placement_op_conf = placement_node->op().op_conf();
+    if (placement_op_conf.has_scope_symbol_id()) {
+      builder.ScopeSymbolId(placement_op_conf.scope_symbol_id());
+    }
+    const auto transpose_op = builder.Build();
+    JUST(job_builder->AddOp(placement_node->parallel_desc().parallel_conf(),
+                            transpose_op.op_conf()));
+    const std::string transposed_lbn = transpose_op.output("output", 0);
+    lbn2transposed->emplace(lbn, transposed_lbn);
+    return transposed_lbn;
+  };
+
+  for (const OpNode* op_node : region_nodes) {
+    if (layout_nodes.find(op_node) == layout_nodes.end()) { continue; }
+    const OperatorConf& op_conf = op_node->op().op_conf();
+    const std::string& op_type_name = op_conf.user_conf().op_type_name();
+    OperatorConf* new_op_conf = MutOpConf(op_node);
+    SetChannelsLast(new_op_conf);
+    for (const std::string& arg : op_type2args.at(op_type_name).inputs) {
+      const auto arg_it = op_conf.user_conf().input().find(arg);
+      if (arg_it == op_conf.user_conf().input().end()) { continue; }
+      for (int32_t i = 0; i < arg_it->second.s_size(); ++i) {
+        const std::string& lbn = arg_it->second.s(i);
+        if (nhwc_lbns.find(lbn) != nhwc_lbns.end()) { continue; }
+        ReplaceInputLbnInOpCustomizedConf(new_op_conf, GenRepeatedBn(arg, i),
+                                          *JUST(Transpose(lbn, true, op_node)));
+      }
+    }
+    if (op_type_name == "conv2d") {
+      const std::string& weight_lbn = op_conf.user_conf().input().at("weight").s(0);
+      ReplaceInputLbnInOpCustomizedConf(new_op_conf, GenRepeatedBn("weight", 0),
+                                        *JUST(Transpose(weight_lbn, true, op_node)));
+    }
+  }
+  JUST(op_graph.MaybeForEachNode([&](OpNode* op_node) -> Maybe<void> {
+    if (region_node_set.find(op_node) != region_node_set.end()) { return Maybe<void>::Ok(); }
+    for (const std::string& ibn : op_node->op().input_bns()) {
+      const LogicalBlobId& lbi = op_node->op().BnInOp2Lbi(ibn);
+      const std::string lbn = GenLogicalBlobName(lbi);
+      if (nhwc_lbns.find(lbn) == nhwc_lbns.end()) { continue; }
+      const OpNode* producer = op_graph.OpNode4OpName(lbi.op_name());
+      ReplaceInputLbnInOpCustomizedConf(MutOpConf(op_node), ibn,
+                                        *JUST(Transpose(lbn, false, producer)));
+    }
+    return Maybe<void>::Ok();
+  }));
+
+  std::vector<OperatorConf> new_op_confs;
+  new_op_confs.reserve(op_name2new_conf.size());
+  for (const auto& pair : op_name2new_conf) { new_op_confs.push_back(pair.second); }
+  job_builder->MutOpsOnlyOnce(new_op_confs);
+  LOG(INFO) << "run " << layout_nodes.size() << " layout ops and "
+            << region_nodes.size() - layout_nodes.size() << " elementwise ops in channels-last";
+  return Maybe<void>::Ok();
+}
+
+}  // namespace
+
+REGISTER_JOB_PASS("ChannelsLastLayoutPass", ChannelsLastLayoutPass);
+
+}  // namespace oneflow
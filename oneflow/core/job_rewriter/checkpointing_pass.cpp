@@ -21,6 +21,7 @@ limitations under the License.
 #include "oneflow/core/vm/symbol_storage.h"
 #include "oneflow/core/framework/framework.h"
 #include "oneflow/core/operator/operator.h"
+#include "oneflow/core/job/sbp_cost_model.h"
 
 namespace oneflow {
 
@@ -37,12 +38,13 @@ class CheckpointingPass final : public JobPass {
     if (!IsEnabled(*ctx)) { return Maybe<void>::Ok(); }
     const OpGraph op_graph(*job);
     JobBuilder job_builder(job);
-    return Apply(op_graph, &job_builder);
+    return Apply(op_graph, &job_builder, ctx->job_desc());
   }
 
   bool IsEnabled(const JobPassCtx& ctx) const { return ctx.job_desc().IsTrain(); }
 
-  Maybe<void> Apply(const OpGraph& op_graph, JobBuilder* job_builder) const;
+  Maybe<void> Apply(const OpGraph& op_graph, JobBuilder* job_builder,
+                    const JobDesc& job_desc) const;
 };
 
 const std::string kCheckpointingFakeOpNamePrefix = "OneFlow-System-Checkpointing-Fake-Fw-Op_";
@@ -62,22 +64,23 @@ bool IsForwardPass7CheckpointingScope(const Scope& scope) {
   return IsForwardPassScope(scope) && scope.Bool("checkpointing");
 }
 
-void CollectAllCheckpointingOpsInForwardPass(
-    const OpGraph& op_graph, HashMap<std::string, const OpNode*>* checkpointing_op_name2op_node) {
+bool IsIgnoredCheckpointingOpType(const std::string& op_type_name) {
   // NOTE(chengcheng):
   //   ignore batch_norm ops because of recompute bn will repeat the calculation of 'm' and 'v'.
   //   in the future, we need to support the recomputation version of batch_norm which do NOT
   //   update forward variables.
-  HashSet<std::string> ignore_op_type_names = {"normalization", "normalization_add_relu",
-                                               "cudnn_fused_normalization_add_relu", "repeat",
-                                               "unpack"};
+  static const HashSet<std::string> ignore_op_type_names = {
+      "normalization", "normalization_add_relu", "cudnn_fused_normalization_add_relu", "repeat",
+      "unpack"};
+  return ignore_op_type_names.find(op_type_name) != ignore_op_type_names.end();
+}
+
+void CollectAllCheckpointingOpsInForwardPass(
+    const OpGraph& op_graph, HashMap<std::string, const OpNode*>* checkpointing_op_name2op_node) {
   op_graph.ForEachNode([&](const OpNode* op_node) {
     const OperatorConf& op_conf = op_node->op().op_conf();
     if (!op_conf.has_user_conf()) { return; }
-    if (ignore_op_type_names.find(op_conf.user_conf().op_type_name())
-        != ignore_op_type_names.end()) {
-      return;
-    }
+    if (IsIgnoredCheckpointingOpType(op_conf.user_conf().op_type_name())) { return; }
     if (IsForwardPass7CheckpointingScope(Scope4OpNode(op_node))) {
       CHECK(checkpointing_op_name2op_node->emplace(op_conf.name(), op_node).second);
     }
@@ -121,15 +124,315 @@ void GenConnectedCheckpointingSubgraphs(
   }
 }
 
-Maybe<void> CheckpointingPass::Apply(const OpGraph& op_graph, JobBuilder* job_builder) const {
+bool IsRandomOpType(const std::string& op_type_name) {
+  // recomputation of these ops would not reproduce the forward outputs
+  static const HashSet<std::string> random_op_type_names = {
+      "random_mask_like", "bernoulli", "generate_random_batch_permutation_indices",
+      "distributed_partial_fc_sample", "distributed_partial_fc_sample_disable_boxing"};
+  return random_op_type_names.find(op_type_name) != random_op_type_names.end();
+}
+
+// Rough FLOPs of one forward computation, only used to rank recomputation candidates
+double EstimateFlops(const OpNode* op_node) {
+  const Operator& op = op_node->op();
+  const auto& user_conf = op.op_conf().user_conf();
+  const std::string& op_type_name = user_conf.op_type_name();
+  double out_elem_cnt = 0;
+  for (const auto& obn : op.output_bns()) {
+    out_elem_cnt += op_node->LogicalBlobDesc4Lbi(op.BnInOp2Lbi(obn)).shape().elem_cnt();
+  }
+  const auto LogicalShape4Ibn = [&](const std::string& ibn) -> const Shape& {
+    return op_node->LogicalBlobDesc4Lbi(op.BnInOp2Lbi(ibn)).shape();
+  };
+  if (op_type_name == "matmul" || op_type_name == "batch_matmul"
+      || op_type_name == "broadcast_matmul") {
+    const Shape& a_shape = LogicalShape4Ibn(GenRepeatedBn("a", 0));
+    const bool transpose_a = user_conf.attr().at("transpose_a").at_bool();
+    const int64_t k = a_shape.At(a_shape.NumAxes() - (transpose_a ? 2 : 1));
+    return 2 * out_elem_cnt * k;
+  } else if (op_type_name == "conv1d" || op_type_name == "conv2d" || op_type_name == "conv3d") {
+    const Shape& weight_shape = LogicalShape4Ibn(GenRepeatedBn("weight", 0));
+    return 2 * out_elem_cnt * weight_shape.elem_cnt() / weight_shape.At(0);
+  } else {
+    return out_elem_cnt;
+  }
+}
+
+// Peak device memory estimated on the topological order of the op graph. A blob is alive from
+// its producer to its last consumer. When an op is recomputed its outputs are freed after the
+// last forward consumer and come back right before the first backward consumer, while its
+// inputs have to be kept until then.
+class AutoCheckpointingPlanner final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(AutoCheckpointingPlanner);
+  explicit AutoCheckpointingPlanner(const OpGraph& op_graph);
+  ~AutoCheckpointingPlanner() = default;
+
+  double PeakBytes() const;
+  // Greedily adds the candidate with the best bytes saved at the peak per recomputed FLOP
+  void Plan(double budget_bytes, HashSet<const OpNode*>* recomputed_nodes) const;
+  double Flops4OpNode(const OpNode* op_node) const { return op_node2flops_.at(op_node); }
+
+ private:
+  struct BlobLifetime {
+    const OpNode* producer;
+    double bytes;
+    int32_t begin;
+    int32_t forward_end;
+    int32_t backward_begin;
+    int32_t backward_end;
+    std::vector<const OpNode*> forward_consumers;
+  };
+
+  bool IsCandidate(const OpNode* op_node) const;
+  int32_t RecomputeOrder(const OpNode* op_node) const;
+  void ForEachLiveInterval(const BlobLifetime& lifetime, const HashSet<const OpNode*>& recomputed,
+                           const std::function<void(int32_t, int32_t)>& Handler) const;
+  double LiveBytesAt(const std::vector<const BlobLifetime*>& lifetimes,
+                     const HashSet<const OpNode*>& recomputed, int32_t order) const;
+  int32_t PeakOrder(const HashSet<const OpNode*>& recomputed, double* peak_bytes) const;
+
+  HashMap<const OpNode*, int32_t> op_node2order_;
+  HashMap<const OpNode*, double> op_node2flops_;
+  HashMap<const OpNode*, std::vector<const BlobLifetime*>> op_node2out_lifetimes_;
+  HashMap<const OpNode*, std::vector<const BlobLifetime*>> op_node2in_lifetimes_;
+  std::vector<std::unique_ptr<BlobLifetime>> lifetimes_;
+  std::vector<const OpNode*> candidates_;
+  HashSet<const OpNode*> recomputed_by_scope_;
+};
+
+AutoCheckpointingPlanner::AutoCheckpointingPlanner(const OpGraph& op_graph) {
+  op_graph.TopoForEachNode([&](const OpNode* op_node) {
+    CHECK(op_node2order_.emplace(op_node, op_node2order_.size()).second);
+  });
+  op_graph.TopoForEachNode([&](const OpNode* op_node) {
+    const Operator& op = op_node->op();
+    // only device memory is budgeted
+    const bool is_device_blob = op_node->parallel_desc().device_type() == DeviceType::kGPU;
+    for (const auto& obn : op.output_bns()) {
+      const LogicalBlobId& lbi = op.BnInOp2Lbi(obn);
+      std::unique_ptr<BlobLifetime> lifetime(new BlobLifetime());
+      lifetime->producer = op_node;
+      lifetime->bytes =
+          is_device_blob
+              ? PhysicalBlobBytes(*op_node->parallel_desc().hierarchy(),
+                                  op_node->ParallelDistribution4Lbi(lbi),
+                                  op_node->LogicalBlobDesc4Lbi(lbi).ByteSizeOfBlobBody())
+              : 0;
+      lifetime->begin = op_node2order_.at(op_node);
+      lifetime->forward_end = lifetime->begin;
+      lifetime->backward_begin = -1;
+      lifetime->backward_end = -1;
+      for (const OpEdge* edge : op_node->out_edges()) {
+        if (std::find(edge->lbis().begin(), edge->lbis().end(), lbi) == edge->lbis().end()) {
+          continue;
+        }
+        const OpNode* consumer = edge->dst_node();
+        const int32_t order = op_node2order_.at(consumer);
+        op_node2in_lifetimes_[consumer].push_back(lifetime.get());
+        if (consumer->op().op_conf().has_scope_symbol_id()
+            && !IsForwardPassScope(Scope4OpNode(consumer))) {
+          if (lifetime->backward_begin == -1 || order < lifetime->backward_begin) {
+            lifetime->backward_begin = order;
+          }
+          lifetime->backward_end = std::max(lifetime->backward_end, order);
+        } else {
+          lifetime->forward_end = std::max(lifetime->forward_end, order);
+          lifetime->forward_consumers.push_back(consumer);
+        }
+      }
+      op_node2out_lifetimes_[op_node].push_back(lifetime.get());
+      lifetimes_.push_back(std::move(lifetime));
+    }
+  });
+  op_graph.TopoForEachNode([&](const OpNode* op_node) {
+    const OperatorConf& op_conf = op_node->op().op_conf();
+    if (op_conf.has_user_conf() && op_conf.has_scope_symbol_id()
+        && !IsIgnoredCheckpointingOpType(op_conf.user_conf().op_type_name())
+        && IsForwardPass7CheckpointingScope(Scope4OpNode(op_node))) {
+      recomputed_by_scope_.insert(op_node);
+    } else if (IsCandidate(op_node)) {
+      candidates_.push_back(op_node);
+      op_node2flops_.emplace(op_node, EstimateFlops(op_node));
+    }
+  });
+}
+
+bool AutoCheckpointingPlanner::IsCandidate(const OpNode* op_node) const {
+  const Operator& op = op_node->op();
+  const OperatorConf& op_conf = op.op_conf();
+  if (!op_conf.has_user_conf() || !op_conf.has_scope_symbol_id()) { return false; }
+  if (!IsForwardPassScope(Scope4OpNode(op_node))) { return false; }
+  if (op_node->parallel_desc().device_type() != DeviceType::kGPU) { return false; }
+  const std::string& op_type_name = op_conf.user_conf().op_type_name();
+  if (IsIgnoredCheckpointingOpType(op_type_name) || IsRandomOpType(op_type_name)) { return false; }
+  if (op.input_bns().empty()) { return false; }
+  for (const auto& ibn : op.input_bns()) {
+    if (op.InputBlobModifier4Ibn(ibn).is_mutable()) { return false; }
+  }
+  bool has_backward_consumer = false;
+  for (const OpEdge* edge : op_node->out_edges()) {
+    if (!edge->dst_node()->op().op_conf().has_scope_symbol_id()) { return false; }
+    if (!IsForwardPassScope(Scope4OpNode(edge->dst_node()))) { has_backward_consumer = true; }
+  }
+  return has_backward_consumer;
+}
+
+int32_t AutoCheckpointingPlanner::RecomputeOrder(const OpNode* op_node) const {
+  int32_t order = -1;
+  const auto& it = op_node2out_lifetimes_.find(op_node);
+  if (it == op_node2out_lifetimes_.end()) { return order; }
+  for (const BlobLifetime* lifetime : it->second) {
+    if (lifetime->backward_begin == -1) { continue; }
+    if (order == -1 || lifetime->backward_begin < order) { order = lifetime->backward_begin; }
+  }
+  return order;
+}
+
+void AutoCheckpointingPlanner::ForEachLiveInterval(
+    const BlobLifetime& lifetime, const HashSet<const OpNode*>& recomputed,
+    const std::function<void(int32_t, int32_t)>& Handler) const {
+  // recomputed consumers read the blob again when they are recomputed
+  int32_t recompute_end = -1;
+  for (const OpNode* consumer : lifetime.forward_consumers) {
+    if (recomputed.find(consumer) != recomputed.end()) {
+      recompute_end = std::max(recompute_end, RecomputeOrder(consumer));
+    }
+  }
+  if (recomputed.find(lifetime.producer) == recomputed.end()) {
+    Handler(lifetime.begin,
+            std::max({lifetime.forward_end, lifetime.backward_end, recompute_end}));
+  } else {
+    Handler(lifetime.begin, lifetime.forward_end);
+    const int32_t begin = RecomputeOrder(lifetime.producer);
+    const int32_t end = std::max(lifetime.backward_end, recompute_end);
+    if (begin != -1 && end >= begin) { Handler(begin, end); }
+  }
+}
+
+double AutoCheckpointingPlanner::LiveBytesAt(const std::vector<const BlobLifetime*>& lifetimes,
+                                             const HashSet<const OpNode*>& recomputed,
+                                             int32_t order) const {
+  double bytes = 0;
+  for (const BlobLifetime* lifetime : lifetimes) {
+    ForEachLiveInterval(*lifetime, recomputed, [&](int32_t begin, int32_t end) {
+      if (begin <= order && order <= end) { bytes += lifetime->bytes; }
+    });
+  }
+  return bytes;
+}
+
+int32_t AutoCheckpointingPlanner::PeakOrder(const HashSet<const OpNode*>& recomputed,
+                                             double* peak_bytes) const {
+  std::vector<double> deltas(op_node2order_.size() + 1, 0);
+  for (const auto& lifetime : lifetimes_) {
+    ForEachLiveInterval(*lifetime, recomputed, [&](int32_t begin, int32_t end) {
+      deltas.at(begin) += lifetime->bytes;
+      deltas.at(end + 1) -= lifetime->bytes;
+    });
+  }
+  int32_t peak_order = 0;
+  double live_bytes = 0;
+  *peak_bytes = 0;
+  FOR_RANGE(int32_t, order, 0, op_node2order_.size()) {
+    live_bytes += deltas.at(order);
+    if (live_bytes > *peak_bytes) {
+      *peak_bytes = live_bytes;
+      peak_order = order;
+    }
+  }
+  return peak_order;
+}
+
+double AutoCheckpointingPlanner::PeakBytes() const {
+  double peak_bytes = 0;
+  PeakOrder(recomputed_by_scope_, &peak_bytes);
+  return peak_bytes;
+}
+
+void AutoCheckpointingPlanner::Plan(double budget_bytes,
+                                    HashSet<const OpNode*>* recomputed_nodes) const {
+  HashSet<const OpNode*> recomputed = recomputed_by_scope_;
+  while (true) {
+    double peak_bytes = 0;
+    const int32_t peak_order = PeakOrder(recomputed, &peak_bytes);
+    if (peak_bytes <= budget_bytes) { break; }
+    const OpNode* best_node = nullptr;
+    double best_ratio = 0;
+    for (const OpNode* candidate : candidates_) {
+      if (recomputed.find(candidate) != recomputed.end()) { continue; }
+      // only the outputs of the candidate and of its producers change their lifetimes
+      std::vector<const BlobLifetime*> affected = op_node2out_lifetimes_.at(candidate);
+      const auto& in_it = op_node2in_lifetimes_.find(candidate);
+      if (in_it != op_node2in_lifetimes_.end()) {
+        affected.insert(affected.end(), in_it->second.begin(), in_it->second.end());
+      }
+      const double bytes_before = LiveBytesAt(affected, recomputed, peak_order);
+      recomputed.insert(candidate);
+      const double bytes_after = LiveBytesAt(affected, recomputed, peak_order);
+      recomputed.erase(candidate);
+      const double saved_bytes = bytes_before - bytes_after;
+      if (saved_bytes <= 0) { continue; }
+      const double ratio = saved_bytes / (op_node2flops_.at(candidate) + 1);
+      if (ratio > best_ratio) {
+        best_ratio = ratio;
+        best_node = candidate;
+      }
+    }
+    if (best_node == nullptr) {
+      LOG(WARNING) << "auto checkpointing can not reduce the estimated peak memory "
+                   << peak_bytes / 1024 / 1024 << "MB to the budget "
+                   << budget_bytes / 1024 / 1024 << "MB";
+      break;
+    }
+    recomputed.insert(best_node);
+    recomputed_nodes->insert(best_node);
+  }
+}
+
+void CollectAutoCheckpointingOps(
+    const OpGraph& op_graph, const JobDesc& job_desc,
+    HashMap<std::string, const OpNode*>* checkpointing_op_name2op_node) {
+  const double budget_bytes =
+      static_cast<double>(job_desc.auto_checkpointing_memory_budget_mbyte()) * 1024 * 1024;
+  const AutoCheckpointingPlanner planner(op_graph);
+  HashSet<const OpNode*> recomputed_nodes;
+  planner.Plan(budget_bytes, &recomputed_nodes);
+  double extra_flops = 0;
+  for (const OpNode* op_node : recomputed_nodes) {
+    CHECK(checkpointing_op_name2op_node->emplace(op_node->op().op_name(), op_node).second);
+    extra_flops += planner.Flops4OpNode(op_node);
+  }
+  LOG(INFO) << "auto checkpointing of job " << job_desc.job_name() << ": estimated peak memory "
+            << planner.PeakBytes() / 1024 / 1024 << "MB, budget " << budget_bytes / 1024 / 1024
+            << "MB, recompute " << recomputed_nodes.size() << " more ops with about "
+            << extra_flops << " extra FLOPs";
+}
+
+Maybe<void> CheckpointingPass::Apply(const OpGraph& op_graph, JobBuilder* job_builder,
+                                     const JobDesc& job_desc) const {
   // step 1. collect all checkpointing ops in forwardpass.
   HashMap<std::string, const OpNode*> checkpointing_op_name2op_node;
   CollectAllCheckpointingOpsInForwardPass(op_graph, &checkpointing_op_name2op_node);
+  const bool is_auto = job_desc.auto_checkpointing_memory_budget_mbyte() > 0;
+  if (is_auto) {
+    CollectAutoCheckpointingOps(op_graph, job_desc, &checkpointing_op_name2op_node);
+  }
   if (checkpointing_op_name2op_node.empty()) { return Maybe<void>::Ok(); }
 
   // step 2. get all connected subgraphs in checkpointing ops.
   std::vector<HashSet<const OpNode*>> checkpointing_subgraphs;
   GenConnectedCheckpointingSubgraphs(checkpointing_op_name2op_node, &checkpointing_subgraphs);
+  if (is_auto) {
+    FOR_RANGE(int64_t, i, 0, checkpointing_subgraphs.size()) {
+      std::string op_names;
+      for (const OpNode* node : checkpointing_subgraphs.at(i)) {
+        op_names += " " + node->op().op_name();
+      }
+      LOG(INFO) << "checkpointing segment " << i << " of job " << job_desc.job_name() << ":"
+                << op_names;
+    }
+  }
 
   HashMap<const OpNode*, int32_t> op_node2order;
   int32_t order = 0;
@@ -0,0 +1,287 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/job_rewriter/job_pass.h"
+#include "oneflow/core/framework/framework.h"
+#include "oneflow/core/common/protobuf.h"
+#include "oneflow/core/job/global_for.h"
+
+namespace oneflow {
+
+namespace {
+
+struct ConstantValue {
+  DataType data_type;
+  bool is_floating_value;
+  double floating_value;
+  int64_t integer_value;
+};
+
+ConstantValue MakeConstantValue(DataType data_type, double value) {
+  ConstantValue constant;
+  constant.data_type = data_type;
+  constant.is_floating_value = IsFloatingDataType(data_type);
+  constant.floating_value = constant.is_floating_value ? value : 0;
+  constant.integer_value = constant.is_floating_value ? 0 : static_cast<int64_t>(value);
+  return constant;
+}
+
+double Value4Constant(const ConstantValue& constant) {
+  return constant.is_floating_value ? constant.floating_value
+                                    : static_cast<double>(constant.integer_value);
+}
+
+double ScalarOperand4UserOpConf(const user_op::UserOpConfWrapper& user_op_conf) {
+  if (user_op_conf.attr<bool>("has_int_operand")) {
+    return static_cast<double>(user_op_conf.attr<int64_t>("int_operand"));
+  } else if (user_op_conf.attr<bool>("has_float_operand")) {
+    return user_op_conf.attr<double>("float_operand");
+  } else {
+    UNIMPLEMENTED();
+  }
+  return 0;
+}
+
+bool IsAllBroadcast(const cfg::ParallelDistribution& parallel_distribution) {
+  for (const auto& sbp_parallel : parallel_distribution.sbp_parallel()) {
+    if (!sbp_parallel.has_broadcast_parallel()) { return false; }
+  }
+  return true;
+}
+
+bool IsNondeterministicOpType(const std::string& op_type_name) {
+  static const HashSet<std::string> nondeterministic_op_type_names = {
+      "random_mask_like", "bernoulli", "generate_random_batch_permutation_indices",
+      "distributed_partial_fc_sample", "distributed_partial_fc_sample_disable_boxing"};
+  return nondeterministic_op_type_names.find(op_type_name) != nondeterministic_op_type_names.end();
+}
+
+HashSet<std::string> GetCtrlInOpNames(const OpGraph& op_graph) {
+  HashSet<std::string> ctrl_in_op_names;
+  op_graph.ForEachNode([&](const OpNode* op_node) {
+    for (const std::string& ctrl_in_op_name : op_node->op().op_conf().ctrl_in_op_name()) {
+      ctrl_in_op_names.insert(ctrl_in_op_name);
+    }
+  });
+  return ctrl_in_op_names;
+}
+
+// Replaces the ops whose single output is a compile time known constant with constant ops. The
+// value of a variable is not known before the model is loaded, so only the values filled by
+// constant, zero_like and ones_like and propagated by cast, identity, scalar_add and scalar_mul
+// are folded. The folded op keeps its name, so its output lbn and consumers stay untouched.
+Maybe<int64_t> FoldConstants(Job* job) {
+  const OpGraph op_graph(*job);
+  JobBuilder job_builder(job);
+  const bool is_multi_client = JUST(*Global<Maybe<bool>, MultiClient>::Get());
+  HashMap<std::string, ConstantValue> lbn2constant;
+  std::vector<OperatorConf> folded_op_confs;
+  op_graph.TopoForEachNode([&](const OpNode* op_node) {
+    const OperatorConf& op_conf = op_node->op().op_conf();
+    if (!op_conf.has_user_conf()) { return; }
+    const user_op::UserOpConfWrapper user_op_conf(op_conf);
+    const std::string& op_type_name = user_op_conf.op_type_name();
+    if (op_type_name == "constant") {
+      ConstantValue constant;
+      constant.data_type = user_op_conf.attr<DataType>("dtype");
+      constant.is_floating_value = user_op_conf.attr<bool>("is_floating_value");
+      constant.floating_value = user_op_conf.attr<double>("floating_value");
+      constant.integer_value = user_op_conf.attr<int64_t>("integer_value");
+      lbn2constant.emplace(user_op_conf.output("out", 0), constant);
+      return;
+    }
+    if (op_node->op().output_bns().size() != 1 || !user_op_conf.has_output("out", 0)) { return; }
+    const LogicalBlobId out_lbi = GenLogicalBlobId(user_op_conf.output("out", 0));
+    const BlobDesc& out_desc = op_node->LogicalBlobDesc4Lbi(out_lbi);
+    if (out_desc.is_dynamic()) { return; }
+    const DataType data_type = out_desc.data_type();
+    if (!IsFloatingDataType(data_type) && !IsIntegralDataType(data_type)) { return; }
+    ConstantValue constant;
+    if (op_type_name == "zero_like" || op_type_name == "ones_like") {
+      constant = MakeConstantValue(data_type, op_type_name == "ones_like" ? 1 : 0);
+    } else if (op_type_name == "cast" || op_type_name == "identity"
+               || op_type_name == "scalar_add" || op_type_name == "scalar_mul") {
+      const auto in_it = lbn2constant.find(user_op_conf.input("in", 0));
+      if (in_it == lbn2constant.end()) { return; }
+      double value = Value4Constant(in_it->second);
+      if (op_type_name == "scalar_add" || op_type_name == "scalar_mul") {
+        double operand = ScalarOperand4UserOpConf(user_op_conf);
+        // the kernels cast the operand to the data type of the input first
+        if (!IsFloatingDataType(data_type)) {
+          operand = static_cast<double>(static_cast<int64_t>(operand));
+        }
+        value = op_type_name == "scalar_add" ? value + operand : value * operand;
+      }
+      constant = MakeConstantValue(data_type, value);
+    } else {
+      return;
+    }
+    const cfg::ParallelDistribution& parallel_distribution =
+        op_node->ParallelDistribution4Lbi(out_lbi);
+    // single client constant ops are always broadcast
+    if (!is_multi_client && !IsAllBroadcast(parallel_distribution)) { return; }
+    ParallelDistribution parallel_distribution_pb;
+    parallel_distribution.ToProto(&parallel_distribution_pb);
+    const auto constant_op = user_op::UserOpConfWrapperBuilder(op_conf.name())
+                                 .Op("constant")
+                                 .Output("out")
+                                 .Attr<double>("floating_value", constant.floating_value)
+                                 .Attr<int64_t>("integer_value", constant.integer_value)
+                                 .Attr<bool>("is_floating_value", constant.is_floating_value)
+                                 .Attr<DataType>("dtype", data_type)
+                                 .Attr<Shape>("shape", out_desc.shape())
+                                 .Attr<std::string>("nd_sbp",
+                                                    PbMessage2TxtString(parallel_distribution_pb))
+                                 .Build();
+    OperatorConf folded_op_conf = op_conf;
+    *folded_op_conf.mutable_user_conf() = constant_op.op_conf().user_conf();
+    folded_op_confs.push_back(folded_op_conf);
+    cfg::ParallelDistributionSignature signature;
+    (*signature.mutable_bn_in_op2parallel_distribution())[GenRepeatedBn("out", 0)] =
+        parallel_distribution;
+    job_builder.AddParallelDistributionSignature4OpName(op_conf.name(), signature);
+    lbn2constant.emplace(GenLogicalBlobName(out_lbi), constant);
+  });
+  job_builder.MutOpsOnlyOnce(folded_op_confs);
+  return folded_op_confs.size();
+}
+
+// Merges the user ops that compute the same function of the same inputs on the same placement.
+Maybe<int64_t> EliminateCommonSubexpressions(Job* job) {
+  const OpGraph op_graph(*job);
+  JobBuilder job_builder(job);
+  const HashSet<std::string> ctrl_in_op_names = GetCtrlInOpNames(op_graph);
+  HashMap<std::string, std::string> lbn2representative_lbn;
+  const auto Representative4Lbn = [&](const std::string& lbn) -> std::string {
+    const auto it = lbn2representative_lbn.find(lbn);
+    return it == lbn2representative_lbn.end() ? lbn : it->second;
+  };
+  HashMap<std::string, const OpNode*> key2representative;
+  HashSet<std::string> eliminated_op_names;
+  op_graph.TopoForEachNode([&](const OpNode* op_node) {
+    const Operator& op = op_node->op();
+    const OperatorConf& op_conf = op.op_conf();
+    if (!op_conf.has_user_conf()) { return; }
+    const std::string& op_type_name = op_conf.user_conf().op_type_name();
+    if (IsNondeterministicOpType(op_type_name)) { return; }
+    if (op.output_bns().empty()) { return; }
+    // ops without inputs are sources such as data readers, only constants are pure
+    if (op.input_bns().empty() && op_type_name != "constant") { return; }
+    if (!op_conf.ctrl_in_op_name().empty()) { return; }
+    if (ctrl_in_op_names.find(op.op_name()) != ctrl_in_op_names.end()) { return; }
+    for (const auto& ibn : op.input_bns()) {
+      if (op.InputBlobModifier4Ibn(ibn).is_mutable()) { return; }
+    }
+    std::string key = op_type_name + "\n" + op_conf.device_tag() + "\n"
+                      + op_node->parallel_desc().parallel_conf().DebugString();
+    const std::map<std::string, UserOpConf::ListString> inputs(
+        op_conf.user_conf().input().begin(), op_conf.user_conf().input().end());
+    for (const auto& pair : inputs) {
+      key += "\n" + pair.first + ":";
+      for (const std::string& lbn : pair.second.s()) { key += Representative4Lbn(lbn) + ","; }
+    }
+    const std::map<std::string, AttrValue> attrs(op_conf.user_conf().attr().begin(),
+                                                 op_conf.user_conf().attr().end());
+    for (const auto& pair : attrs) { key += "\n" + pair.first + ":" + pair.second.DebugString(); }
+    for (const auto& obn : op.output_bns()) {
+      ParallelDistribution parallel_distribution;
+      op_node->ParallelDistribution4BnInOp(obn).ToProto(&parallel_distribution);
+      key += "\n" + obn + ":" + parallel_distribution.DebugString();
+    }
+    const auto it = key2representative.find(key);
+    if (it == key2representative.end()) {
+      key2representative.emplace(key, op_node);
+      return;
+    }
+    const OpNode* representative = it->second;
+    for (const auto& obn : op.output_bns()) {
+      lbn2representative_lbn.emplace(GenLogicalBlobName(op.BnInOp2Lbi(obn)),
+                                     GenLogicalBlobName(representative->op().BnInOp2Lbi(obn)));
+    }
+    eliminated_op_names.insert(op.op_name());
+  });
+  std::vector<OperatorConf> consumer_op_confs;
+  op_graph.ForEachNode([&](const OpNode* op_node) {
+    if (eliminated_op_names.find(op_node->op().op_name()) != eliminated_op_names.end()) { return; }
+    OperatorConf op_conf = op_node->op().op_conf();
+    bool is_modified = false;
+    for (const auto& ibn : op_node->op().input_bns()) {
+      const std::string lbn = GenLogicalBlobName(op_node->op().BnInOp2Lbi(ibn));
+      const std::string representative_lbn = Representative4Lbn(lbn);
+      if (representative_lbn == lbn) { continue; }
+      const std::string old_lbn = ReplaceInputLbnInOpCustomizedConf(&op_conf, ibn,
+                                                                    representative_lbn);
+      CHECK_EQ(old_lbn, lbn);
+      is_modified = true;
+    }
+    if (is_modified) { consumer_op_confs.push_back(op_conf); }
+  });
+  job_builder.MutOpsOnlyOnce(consumer_op_confs);
+  job_builder.DelOps(
+      std::vector<std::string>(eliminated_op_names.begin(), eliminated_op_names.end()));
+  return eliminated_op_names.size();
+}
+
+// Removes the user ops none of whose outputs is consumed, transitively. Ops without outputs are
+// the sinks of the job, such as the output and callback ops, and are always kept.
+Maybe<int64_t> EliminateDeadOps(Job* job) {
+  const OpGraph op_graph(*job);
+  JobBuilder job_builder(job);
+  const HashSet<std::string> ctrl_in_op_names = GetCtrlInOpNames(op_graph);
+  HashSet<const OpNode*> dead_op_nodes;
+  op_graph.ReverseTopoForEachNode([&](const OpNode* op_node) {
+    const Operator& op = op_node->op();
+    if (!op.op_conf().has_user_conf()) { return; }
+    if (op.output_bns().empty()) { return; }
+    if (ctrl_in_op_names.find(op.op_name()) != ctrl_in_op_names.end()) { return; }
+    for (const auto& ibn : op.input_bns()) {
+      if (op.InputBlobModifier4Ibn(ibn).is_mutable()) { return; }
+    }
+    for (const OpEdge* out_edge : op_node->out_edges()) {
+      if (dead_op_nodes.find(out_edge->dst_node()) == dead_op_nodes.end()) { return; }
+    }
+    dead_op_nodes.insert(op_node);
+  });
+  std::vector<std::string> dead_op_names;
+  for (const OpNode* op_node : dead_op_nodes) { dead_op_names.push_back(op_node->op().op_name()); }
+  job_builder.DelOps(dead_op_names);
+  return dead_op_names.size();
+}
+
+class ConstantFoldingPass final : public JobPass {
+ public:
+  ConstantFoldingPass() = default;
+  ~ConstantFoldingPass() override = default;
+
+  bool IsEnabled(const JobPassCtx& ctx) const {
+    return ctx.job_desc().IsPredict() && ctx.job_desc().job_conf().enable_constant_folding();
+  }
+
+  Maybe<void> Apply(Job* job, JobPassCtx* ctx) const override {
+    if (!IsEnabled(*ctx)) { return Maybe<void>::Ok(); }
+    const int64_t folded_op_num = JUST(FoldConstants(job));
+    const int64_t merged_op_num = JUST(EliminateCommonSubexpressions(job));
+    const int64_t dead_op_num = JUST(EliminateDeadOps(job));
+    LOG(INFO) << "ConstantFoldingPass folded " << folded_op_num << " ops, merged " << merged_op_num
+              << " common subexpressions and removed " << dead_op_num << " dead ops";
+    return Maybe<void>::Ok();
+  }
+};
+
+}  // namespace
+
+REGISTER_JOB_PASS("ConstantFoldingPass", ConstantFoldingPass);
+
+}  // namespace oneflow
@@ -0,0 +1,136 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/job_rewriter/job_pass.h"
+#include "oneflow/core/framework/framework.h"
+#include "oneflow/core/operator/operator.h"
+
+namespace oneflow {
+
+namespace {
+
+const std::string kDataPrefetchBufferOpNamePrefix = "System-DataPrefetch-Buffer-Op_";
+
+bool IsIdentityBufferOpNode(const OpNode* node) {
+  const OperatorConf& op_conf = node->op().op_conf();
+  return op_conf.has_user_conf() && op_conf.user_conf().op_type_name() == "identity_buffer";
+}
+
+// Host blobs produced by the data loading ops, i.e. the user ops on CPU without inputs (readers)
+// and the CPU ops that only consume what these produce (decoders and the like).
+HashSet<const OpNode*> FindHostDataNodes(const OpGraph& op_graph) {
+  HashSet<const OpNode*> data_nodes;
+  op_graph.TopoForEachNode([&](const OpNode* node) {
+    if (node->parallel_desc().device_type() != DeviceType::kCPU) { return; }
+    if (!node->op().op_conf().has_user_conf()) { return; }
+    if (node->op().input_bns().empty()) {
+      data_nodes.insert(node);
+      return;
+    }
+    for (const OpEdge* in_edge : node->in_edges()) {
+      if (data_nodes.count(in_edge->src_node()) == 0) { return; }
+    }
+    data_nodes.insert(node);
+  });
+  return data_nodes;
+}
+
+// Inserts an identity_buffer of job_conf.data_prefetch_buffer_size on the GPU placement of the
+// consumers of the host data. The H2D copy of batch k + 1 then runs on the copy stream while the
+// compute stream still works on batch k, which is held by the buffer. The host blobs feeding the
+// copy are already pinned, so the copies are asynchronous.
+class DataPrefetchBufferPass final : public JobPass {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(DataPrefetchBufferPass);
+  DataPrefetchBufferPass() = default;
+  ~DataPrefetchBufferPass() override = default;
+
+  bool IsEnabled(const JobPassCtx& ctx) const {
+    return ctx.job_desc().job_conf().data_prefetch_buffer_size() > 0;
+  }
+
+  Maybe<void> Apply(Job* job, JobPassCtx* ctx) const override {
+    if (!IsEnabled(*ctx)) { return Maybe<void>::Ok(); }
+    const OpGraph op_graph(*job);
+    JobBuilder job_builder(job);
+    return Apply(op_graph, &job_builder, ctx->job_desc().job_conf().data_prefetch_buffer_size());
+  }
+
+  Maybe<void> Apply(const OpGraph& op_graph, JobBuilder* job_builder, int64_t buffer_size) const;
+};
+
+Maybe<void> DataPrefetchBufferPass::Apply(const OpGraph& op_graph, JobBuilder* job_builder,
+                                          int64_t buffer_size) const {
+  const HashSet<const OpNode*> data_nodes = FindHostDataNodes(op_graph);
+  // one buffer for each blob and placement of its consumers
+  HashMap<std::string, OperatorConf> buffer_op_name2op_conf;
+  HashMap<std::string, ParallelConf> buffer_op_name2parallel_conf;
+  HashMap<std::string, OperatorConf> mut_op_name2conf;
+  op_graph.ForEachEdge([&](const OpEdge* edge) {
+    const OpNode* src_node = edge->src_node();
+    const OpNode* dst_node = edge->dst_node();
+    if (data_nodes.count(src_node) == 0) { return; }
+    if (dst_node->parallel_desc().device_type() != DeviceType::kGPU) { return; }
+    // e.g. inserted by the pipeline buffer pass
+    if (IsIdentityBufferOpNode(dst_node)) { return; }
+    const ParallelConf& dst_parallel_conf = dst_node->parallel_desc().parallel_conf();
+    for (const LogicalBlobId& lbi : edge->lbis()) {
+      const std::string lbn = GenLogicalBlobName(lbi);
+      const std::string buffer_op_name =
+          kDataPrefetchBufferOpNamePrefix + lbi.op_name() + "-" + lbi.blob_name() + "-"
+          + std::to_string(std::hash<ParallelConf>()(dst_parallel_conf));
+      auto it = buffer_op_name2op_conf.find(buffer_op_name);
+      if (it == buffer_op_name2op_conf.end()) {
+        it = buffer_op_name2op_conf
+                 .emplace(buffer_op_name,
+                          user_op::UserOpConfWrapperBuilder(buffer_op_name)
+                              .Op("identity_buffer")
+                              .Input("in", lbn)
+                              .Output("out")
+                              .Attr<int64_t>("buffer_size", buffer_size)
+                              .ScopeSymbolId(dst_node->op().op_conf().scope_symbol_id())
+                              .Build()
+                              .op_conf())
+                 .first;
+        buffer_op_name2parallel_conf.emplace(buffer_op_name, dst_parallel_conf);
+        LOG(INFO) << "insert data prefetch buffer op " << buffer_op_name
+                  << " (buffer_size: " << buffer_size << ") from " << src_node->op().op_name()
+                  << " to " << dst_node->op().op_name();
+      }
+      const std::string& dst_op_name = dst_node->op().op_name();
+      auto mut_op_it = mut_op_name2conf.find(dst_op_name);
+      if (mut_op_it == mut_op_name2conf.end()) {
+        mut_op_it = mut_op_name2conf.emplace(dst_op_name, dst_node->op().op_conf()).first;
+      }
+      const std::string buffer_out = user_op::UserOpConfWrapper(it->second).output("out", 0);
+      for (const std::string& ibn : edge->lbi2ibns().at(lbi)) {
+        const std::string old_lbn =
+            ReplaceInputLbnInOpCustomizedConf(&(mut_op_it->second), ibn, buffer_out);
+        CHECK_EQ(old_lbn, lbn);
+      }
+    }
+  });
+  for (const auto& pair : buffer_op_name2op_conf) {
+    JUST(job_builder->AddOp(buffer_op_name2parallel_conf.at(pair.first), pair.second));
+  }
+  for (const auto& pair : mut_op_name2conf) { JUST(job_builder->MutOpOnlyOnce(pair.second)); }
+  return Maybe<void>::Ok();
+}
+
+}  // namespace
+
+REGISTER_JOB_PASS("DataPrefetchBufferPass", DataPrefetchBufferPass);
+
+}  // namespace oneflow
@@ -0,0 +1,149 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/job_rewriter/job_pass.h"
+#include "oneflow/core/framework/framework.h"
+#include "oneflow/core/device/cublas_lt_util.h"
+
+namespace oneflow {
+
+namespace {
+
+bool IsFp8Matmul(const OpNode* op_node) {
+  const OperatorConf& op_conf = op_node->op().op_conf();
+  if (!op_conf.has_user_conf() || op_conf.user_conf().op_type_name() != "matmul") {
+    return false;
+  }
+  if (op_node->parallel_desc().device_type() != DeviceType::kGPU) { return false; }
+  const user_op::UserOpConfWrapper matmul_conf(op_conf);
+  if (matmul_conf.has_input("_add_to_output", 0)) { return false; }
+  // the FP8 kernels only take A^T * B in column major, which is a * b^T in row major
+  if (matmul_conf.attr<bool>("transpose_a") || !matmul_conf.attr<bool>("transpose_b")) {
+    return false;
+  }
+  if (matmul_conf.attr<double>("alpha") != 1.0) { return false; }
+  const BlobDesc& a_desc =
+      op_node->LogicalBlobDesc4Lbi(GenLogicalBlobId(matmul_conf.input("a", 0)));
+  const BlobDesc& b_desc =
+      op_node->LogicalBlobDesc4Lbi(GenLogicalBlobId(matmul_conf.input("b", 0)));
+  if (a_desc.shape().NumAxes() != 2 || b_desc.shape().NumAxes() != 2) { return false; }
+  // and leading dims that are multiples of 16
+  if (a_desc.shape().At(1) % 16 != 0 || b_desc.shape().At(0) % 16 != 0) { return false; }
+  return a_desc.data_type() == DataType::kFloat || a_desc.data_type() == DataType::kFloat16;
+}
+
+OperatorConf GenFp8StateVariableOpConf(const OpNode* matmul_node, const std::string& name,
+                                       int64_t elem_cnt, float initial_value) {
+  OperatorConf var_op_conf{};
+  var_op_conf.set_name(matmul_node->op().op_name() + "-" + name);
+  var_op_conf.set_scope_symbol_id(matmul_node->op().op_conf().scope_symbol_id());
+  VariableOpConf* variable_conf = var_op_conf.mutable_variable_conf();
+  variable_conf->set_out("out");
+  variable_conf->mutable_shape()->add_dim(elem_cnt);
+  variable_conf->set_data_type(DataType::kFloat);
+  variable_conf->set_trainable(false);
+  variable_conf->mutable_initializer()->mutable_constant_conf()->set_value(initial_value);
+  FOR_RANGE(int, i, 0, matmul_node->parallel_desc().hierarchy()->NumAxes()) {
+    *variable_conf->add_parallel_distribution() = "B";
+  }
+  return var_op_conf;
+}
+
+// Rewrites the matmuls the FP8 kernels support into fp8_matmul. Each operand gets a scale and an
+// amax history as variables, and an fp8_scale_update that sets the scale of the next step from
+// the amax of this one, the delayed scaling recipe. The backward stays in the original precision.
+class Fp8MatmulPass final : public JobPass {
+ public:
+  Fp8MatmulPass() = default;
+  ~Fp8MatmulPass() override = default;
+
+  bool IsEnabled(const JobPassCtx& ctx) const {
+    if (!ctx.job_desc().job_conf().enable_fp8_matmul()) { return false; }
+    CHECK(IsCublasLtFp8MatmulSupported())
+        << "enable_fp8_matmul needs cuBLASLt of CUDA 11.8 or later";
+    return true;
+  }
+  Maybe<void> Apply(const OpGraph& op_graph, JobBuilder* job_builder) const;
+
+  Maybe<void> Apply(Job* job, JobPassCtx* ctx) const override {
+    if (!IsEnabled(*ctx)) { return Maybe<void>::Ok(); }
+    const OpGraph op_graph(*job);
+    JobBuilder job_builder(job);
+    return Apply(op_graph, &job_builder);
+  }
+};
+
+Maybe<void> Fp8MatmulPass::Apply(const OpGraph& op_graph, JobBuilder* job_builder) const {
+  const JobConfigProto& job_conf = job_builder->job().job_conf();
+  const int64_t history_len = job_conf.fp8_amax_history_len();
+  CHECK_GT_OR_RETURN(history_len, 0);
+  std::vector<OperatorConf> fp8_matmul_op_confs;
+  op_graph.ForEachNode([&](const OpNode* op_node) {
+    if (!IsFp8Matmul(op_node)) { return; }
+    const user_op::UserOpConfWrapper matmul_conf(op_node->op().op_conf());
+    const int64_t scope_symbol_id = op_node->op().op_conf().scope_symbol_id();
+    std::vector<OperatorConf> new_op_confs;
+    std::vector<std::string> scale_lbns;
+    std::vector<std::string> history_lbns;
+    for (const std::string& operand : {"a", "b"}) {
+      new_op_confs.push_back(GenFp8StateVariableOpConf(op_node, "fp8_" + operand + "_scale", 1, 1));
+      scale_lbns.push_back(GenLogicalBlobName(new_op_confs.back().name(), "out"));
+      new_op_confs.push_back(
+          GenFp8StateVariableOpConf(op_node, "fp8_" + operand + "_amax_history", history_len, 0));
+      history_lbns.push_back(GenLogicalBlobName(new_op_confs.back().name(), "out"));
+    }
+
+    // fp8_matmul takes the name of the matmul, whose output is also "out"
+    const auto fp8_matmul_op = user_op::UserOpConfWrapperBuilder(op_node->op().op_name())
+                                   .Op("fp8_matmul")
+                                   .Input("a", matmul_conf.input("a", 0))
+                                   .Input("b", matmul_conf.input("b", 0))
+                                   .Input("a_scale", scale_lbns.at(0))
+                                   .Input("b_scale", scale_lbns.at(1))
+                                   .Output("out")
+                                   .Output("a_amax")
+                                   .Output("b_amax")
+                                   .ScopeSymbolId(scope_symbol_id)
+                                   .Build();
+    OperatorConf fp8_matmul_op_conf = op_node->op().op_conf();
+    *fp8_matmul_op_conf.mutable_user_conf() = fp8_matmul_op.op_conf().user_conf();
+    fp8_matmul_op_confs.push_back(fp8_matmul_op_conf);
+
+    const std::vector<std::string> amax_lbns{fp8_matmul_op.output("a_amax", 0),
+                                             fp8_matmul_op.output("b_amax", 0)};
+    FOR_RANGE(int, i, 0, 2) {
+      const auto scale_update_op =
+          user_op::UserOpConfWrapperBuilder(op_node->op().op_name() + "-fp8_scale_update_"
+                                            + std::to_string(i))
+              .Op("fp8_scale_update")
+              .Input("amax", amax_lbns.at(i))
+              .Input("amax_history", history_lbns.at(i))
+              .Input("scale", scale_lbns.at(i))
+              .Attr<int32_t>("margin", job_conf.fp8_scale_margin())
+              .ScopeSymbolId(scope_symbol_id)
+              .Build();
+      new_op_confs.push_back(scale_update_op.op_conf());
+    }
+    job_builder->AddOps(op_node->parallel_desc().parallel_conf(), new_op_confs);
+  });
+  job_builder->MutOpsOnlyOnce(fp8_matmul_op_confs);
+  return Maybe<void>::Ok();
+}
+
+}  // namespace
+
+REGISTER_JOB_PASS("Fp8MatmulPass", Fp8MatmulPass);
+
+}  // namespace oneflow
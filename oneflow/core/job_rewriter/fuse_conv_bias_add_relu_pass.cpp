@@ -0,0 +1,191 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/job_rewriter/job_pass.h"
+#include "oneflow/core/framework/framework.h"
+
+namespace oneflow {
+
+namespace {
+
+std::function<bool(const OpNode* op_node)> MakePredicatorIsSafeToDelete(const OpGraph& op_graph) {
+  HashSet<std::string> ctrl_in_op_names;
+  op_graph.ForEachNode([&](const OpNode* op_node) {
+    for (const std::string& ctrl_in_op_name : op_node->op().op_conf().ctrl_in_op_name()) {
+      ctrl_in_op_names.insert(ctrl_in_op_name);
+    }
+  });
+  return [=](const OpNode* op_node) {
+    if (op_node->out_edges().size() != 1) { return false; }
+    if (!op_node->op().op_conf().ctrl_in_op_name().empty()) { return false; }
+    if (ctrl_in_op_names.find(op_node->op().op_conf().name()) != ctrl_in_op_names.end()) {
+      return false;
+    }
+    return true;
+  };
+}
+
+bool IsUserOpWithTypeName(const OperatorConf& op_conf, const std::string& op_type_name) {
+  return op_conf.has_user_conf() && op_conf.user_conf().op_type_name() == op_type_name;
+};
+
+bool IsFusibleConv(const OpNode* op_node) {
+  const OperatorConf& op_conf = op_node->op().op_conf();
+  if (!IsUserOpWithTypeName(op_conf, "conv2d")) { return false; }
+  if (op_node->parallel_desc().device_type() != DeviceType::kGPU) { return false; }
+  const user_op::UserOpConfWrapper conv_conf(op_conf);
+  if (conv_conf.has_input("bias_multiplier", 0)) { return false; }
+  const int32_t groups = conv_conf.attr<int32_t>("groups");
+  // depthwise convs run on DepthwiseConv2dKernelUtil instead of cuDNN
+  if (groups > 1 && groups == conv_conf.attr<int32_t>("filters")) { return false; }
+  const DataType data_type =
+      op_node->LogicalBlobDesc4Lbi(GenLogicalBlobId(conv_conf.input("in", 0))).data_type();
+  if (data_type == DataType::kFloat) { return true; }
+  // cuDNN takes NHWC biases in float only
+  return data_type == DataType::kFloat16
+         && conv_conf.attr<std::string>("data_format") == "channels_first";
+}
+
+// Returns the input of the add, add_n of two inputs or same shaped broadcast_add op_node which
+// is not lbn, or an empty string if op_node is not such an add
+std::string GetAddendOfAdd(const OpNode* op_node, const std::string& lbn) {
+  const OperatorConf& op_conf = op_node->op().op_conf();
+  std::vector<std::string> inputs;
+  if (IsUserOpWithTypeName(op_conf, "add_n")) {
+    const user_op::UserOpConfWrapper add_conf(op_conf);
+    if (add_conf.input_size("in") != 2) { return ""; }
+    inputs = {add_conf.input("in", 0), add_conf.input("in", 1)};
+  } else if (IsUserOpWithTypeName(op_conf, "broadcast_add")) {
+    const user_op::UserOpConfWrapper add_conf(op_conf);
+    inputs = {add_conf.input("x", 0), add_conf.input("y", 0)};
+    if (op_node->LogicalBlobDesc4Lbi(GenLogicalBlobId(inputs.at(0))).shape()
+        != op_node->LogicalBlobDesc4Lbi(GenLogicalBlobId(inputs.at(1))).shape()) {
+      return "";
+    }
+  } else {
+    return "";
+  }
+  if (inputs.at(0) == lbn && inputs.at(1) != lbn) { return inputs.at(1); }
+  if (inputs.at(1) == lbn && inputs.at(0) != lbn) { return inputs.at(0); }
+  return "";
+}
+
+std::string GetOutputLbn(const OpNode* op_node) {
+  return GenLogicalBlobName(op_node->op().BnInOp2Lbi(op_node->op().SoleObn()));
+}
+
+// Fuses conv2d [-> bias_add] [-> add] -> relu into one fused_conv2d_bias_add_relu, so that cuDNN
+// adds the bias and the addend and applies relu in the epilogue of the conv instead of separate
+// passes over the output. Like FuseMatmulBiasAddActivationPass it runs before the backward is
+// generated.
+class FuseConvBiasAddReluPass final : public JobPass {
+ public:
+  FuseConvBiasAddReluPass() = default;
+  ~FuseConvBiasAddReluPass() override = default;
+
+  bool IsEnabled(const JobPassCtx& ctx) const {
+    return ctx.job_desc().job_conf().enable_fuse_conv_bias_add_relu();
+  }
+  Maybe<void> Apply(const OpGraph& op_graph, JobBuilder* job_builder) const;
+
+  Maybe<void> Apply(Job* job, JobPassCtx* ctx) const override {
+    if (!IsEnabled(*ctx)) { return Maybe<void>::Ok(); }
+    const OpGraph op_graph(*job);
+    JobBuilder job_builder(job);
+    return Apply(op_graph, &job_builder);
+  }
+};
+
+Maybe<void> FuseConvBiasAddReluPass::Apply(const OpGraph& op_graph,
+                                          JobBuilder* job_builder) const {
+  const auto IsSafeToDelete = MakePredicatorIsSafeToDelete(op_graph);
+  std::vector<OperatorConf> delete_ops;
+  // the add of two conv chains, as in the downsampling blocks of ResNet, is fused into one of them
+  HashSet<const OpNode*> fused_node_set;
+  op_graph.ForEachNode([&](const OpNode* op_node) {
+    if (!IsFusibleConv(op_node)) { return; }
+    if (!IsSafeToDelete(op_node)) { return; }
+    const user_op::UserOpConfWrapper conv_conf(op_node->op().op_conf());
+    const std::string& data_format = conv_conf.attr<std::string>("data_format");
+    const int32_t channel_axis = data_format == "channels_first" ? 1 : 3;
+    std::vector<const OpNode*> fused_nodes{op_node};
+    const OpNode* cur_node = op_node;
+    std::string bias;
+    if (conv_conf.has_input("bias", 0)) {
+      bias = conv_conf.input("bias", 0);
+    } else {
+      const OpNode* bias_add_node = cur_node->SoleOutEdge()->dst_node();
+      if (!IsUserOpWithTypeName(bias_add_node->op().op_conf(), "bias_add")) { return; }
+      const user_op::UserOpConfWrapper bias_add_conf(bias_add_node->op().op_conf());
+      if (bias_add_conf.input("a", 0) != conv_conf.output("out", 0)) { return; }
+      if (bias_add_conf.attr<int32_t>("axis") != channel_axis) { return; }
+      if (!IsSafeToDelete(bias_add_node)) { return; }
+      bias = bias_add_conf.input("b", 0);
+      fused_nodes.push_back(bias_add_node);
+      cur_node = bias_add_node;
+    }
+    std::string addend;
+    const OpNode* next_node = cur_node->SoleOutEdge()->dst_node();
+    const std::string addend_of_next = GetAddendOfAdd(next_node, GetOutputLbn(cur_node));
+    if (!addend_of_next.empty()) {
+      if (!IsSafeToDelete(next_node)) { return; }
+      addend = addend_of_next;
+      fused_nodes.push_back(next_node);
+      cur_node = next_node;
+      next_node = cur_node->SoleOutEdge()->dst_node();
+    }
+    if (!IsUserOpWithTypeName(next_node->op().op_conf(), "relu")) { return; }
+    fused_nodes.push_back(next_node);
+    for (const OpNode* fused_node : fused_nodes) {
+      if (fused_node_set.count(fused_node) > 0) { return; }
+    }
+    fused_node_set.insert(fused_nodes.begin(), fused_nodes.end());
+    fused_nodes.pop_back();
+    for (const OpNode* fused_node : fused_nodes) {
+      delete_ops.push_back(fused_node->op().op_conf());
+    }
+
+    // The fused op takes the name of the relu, whose output is also "out".
+    user_op::UserOpConfWrapperBuilder fused_op_builder(next_node->op().op_name());
+    fused_op_builder.OpTypeName("fused_conv2d_bias_add_relu")
+        .Input("in", conv_conf.input("in", 0))
+        .Input("weight", conv_conf.input("weight", 0))
+        .Input("bias", bias)
+        .Output("out")
+        .Attr<int32_t>("filters", conv_conf.attr<int32_t>("filters"))
+        .Attr<std::vector<int32_t>>("padding_before",
+                                    conv_conf.attr<std::vector<int32_t>>("padding_before"))
+        .Attr<std::string>("data_format", data_format)
+        .Attr<std::vector<int32_t>>("kernel_size",
+                                    conv_conf.attr<std::vector<int32_t>>("kernel_size"))
+        .Attr<std::vector<int32_t>>("strides", conv_conf.attr<std::vector<int32_t>>("strides"))
+        .Attr<std::vector<int32_t>>("dilation_rate",
+                                    conv_conf.attr<std::vector<int32_t>>("dilation_rate"))
+        .Attr<int32_t>("groups", conv_conf.attr<int32_t>("groups"));
+    if (!addend.empty()) { fused_op_builder.Input("addend", addend); }
+
+    OperatorConf new_op_conf = next_node->op().op_conf();
+    *new_op_conf.mutable_user_conf() = fused_op_builder.Build().op_conf().user_conf();
+    job_builder->MutOpsOnlyOnce({new_op_conf});
+  });
+  job_builder->DelOps(delete_ops);
+  return Maybe<void>::Ok();
+}
+
+}  // namespace
+
+REGISTER_JOB_PASS("FuseConvBiasAddReluPass", FuseConvBiasAddReluPass);
+
+}  // namespace oneflow
@@ -0,0 +1,283 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/job_rewriter/job_pass.h"
+#include "oneflow/core/framework/framework.h"
+#include "oneflow/user/kernels/fused_elementwise_kernel.h"
+#include "oneflow/user/ops/math_unary_elementwise_seq.h"
+
+namespace oneflow {
+
+namespace {
+
+const std::string kFusedElementwiseOpNamePrefix = "System-FusedElementwise-";
+
+struct ElementwiseOpArgs {
+  std::vector<std::string> ibns;
+  std::string obn;
+};
+
+const HashMap<std::string, ElementwiseOpArgs>& ElementwiseOpArgs4OpTypeName() {
+  static const HashMap<std::string, ElementwiseOpArgs> op_type_name2args = []() {
+    HashMap<std::string, ElementwiseOpArgs> op_type_name2args{
+        {"relu", {{"in_0"}, "out_0"}},
+        {"gelu", {{"in_0"}, "out_0"}},
+        {"sigmoid", {{"in_0"}, "out_0"}},
+        {"scalar_add", {{"in_0"}, "out_0"}},
+        {"scalar_mul", {{"in_0"}, "out_0"}},
+        {"add_n", {{"in_0", "in_1"}, "out_0"}},
+        {"multiply", {{"x_0", "y_0"}, "out_0"}},
+        {"broadcast_add", {{"x_0", "y_0"}, "z_0"}},
+        {"broadcast_sub", {{"x_0", "y_0"}, "z_0"}},
+        {"broadcast_mul", {{"x_0", "y_0"}, "z_0"}},
+        {"broadcast_div", {{"x_0", "y_0"}, "z_0"}},
+    };
+#define INSERT_MATH_UNARY_OP_ARGS(op_type_name, func_prefix) \
+  op_type_name2args.emplace(op_type_name, ElementwiseOpArgs{{"x_0"}, "y_0"});
+    OF_PP_FOR_EACH_TUPLE(INSERT_MATH_UNARY_OP_ARGS, MATH_UNARY_ELEMENTWISE_FUNC_SEQ)
+#undef INSERT_MATH_UNARY_OP_ARGS
+    return op_type_name2args;
+  }();
+  return op_type_name2args;
+}
+
+const ElementwiseOpArgs* FindElementwiseOpArgs(const OpNode* op_node) {
+  const OperatorConf& op_conf = op_node->op().op_conf();
+  if (!op_conf.has_user_conf()) { return nullptr; }
+  const auto& op_type_name2args = ElementwiseOpArgs4OpTypeName();
+  const auto it = op_type_name2args.find(op_conf.user_conf().op_type_name());
+  if (it == op_type_name2args.end()) { return nullptr; }
+  return &it->second;
+}
+
+float ScalarOperand4OpNode(const OpNode* op_node) {
+  const user_op::UserOpConfWrapper user_op_conf(op_node->op().op_conf());
+  const std::string& op_type_name = user_op_conf.op_type_name();
+  if (op_type_name != "scalar_add" && op_type_name != "scalar_mul") { return 0; }
+  if (user_op_conf.attr<bool>("has_int_operand")) {
+    return static_cast<float>(user_op_conf.attr<int64_t>("int_operand"));
+  } else if (user_op_conf.attr<bool>("has_float_operand")) {
+    return static_cast<float>(user_op_conf.attr<double>("float_operand"));
+  } else {
+    UNIMPLEMENTED();
+  }
+  return 0;
+}
+
+bool IsFusableDataType(DataType data_type) {
+  return data_type == DataType::kFloat || data_type == DataType::kDouble
+         || data_type == DataType::kFloat16;
+}
+
+// An op can be fused when all of its inputs and its output have the same logical shape, data type
+// and parallel distribution, so that every physical element of the output only depends on the
+// element at the same offset of each input.
+std::function<bool(const OpNode*)> MakePredicatorIsFusable(const OpGraph& op_graph) {
+  HashSet<std::string> ctrl_in_op_names;
+  op_graph.ForEachNode([&](const OpNode* op_node) {
+    for (const std::string& ctrl_in_op_name : op_node->op().op_conf().ctrl_in_op_name()) {
+      ctrl_in_op_names.insert(ctrl_in_op_name);
+    }
+  });
+  return [ctrl_in_op_names](const OpNode* op_node) {
+    const ElementwiseOpArgs* args = FindElementwiseOpArgs(op_node);
+    if (args == nullptr) { return false; }
+    if (op_node->parallel_desc().device_type() != DeviceType::kGPU) { return false; }
+    if (!op_node->op().op_conf().ctrl_in_op_name().empty()) { return false; }
+    if (ctrl_in_op_names.find(op_node->op().op_name()) != ctrl_in_op_names.end()) { return false; }
+    if (op_node->op().input_bns().size() != args->ibns.size()) { return false; }
+    if (op_node->op().output_bns().size() != 1) { return false; }
+    const BlobDesc& out_desc = op_node->LogicalBlobDesc4Lbi(op_node->op().BnInOp2Lbi(args->obn));
+    if (out_desc.is_dynamic() || !IsFusableDataType(out_desc.data_type())) { return false; }
+    const auto& out_parallel_distribution = op_node->ParallelDistribution4BnInOp(args->obn);
+    HashSet<LogicalBlobId> input_lbis;
+    for (const std::string& ibn : args->ibns) {
+      const LogicalBlobId& lbi = op_node->op().BnInOp2Lbi(ibn);
+      if (!input_lbis.insert(lbi).second) { return false; }
+      const BlobDesc& in_desc = op_node->LogicalBlobDesc4Lbi(lbi);
+      if (in_desc.shape() != out_desc.shape()) { return false; }
+      if (in_desc.data_type() != out_desc.data_type()) { return false; }
+      if (op_node->ParallelDistribution4BnInOp(ibn) != out_parallel_distribution) { return false; }
+    }
+    return true;
+  };
+}
+
+struct ElementwiseChain {
+  std::vector<const OpNode*> op_nodes;
+  std::vector<std::string> input_lbns;
+  std::vector<std::string> op_type_names;
+  std::vector<int32_t> operand_indices;
+  std::vector<int32_t> chain_operand_is_rhs;
+  std::vector<float> scalar_operands;
+};
+
+class FuseElementwiseOpsPass final : public JobPass {
+ public:
+  FuseElementwiseOpsPass() = default;
+  ~FuseElementwiseOpsPass() override = default;
+
+  bool IsEnabled(const JobPassCtx& ctx) const {
+    return ctx.job_desc().job_conf().enable_fuse_elementwise_ops();
+  }
+  Maybe<void> Apply(const OpGraph& op_graph, JobBuilder* job_builder) const;
+
+  Maybe<void> Apply(Job* job, JobPassCtx* ctx) const override {
+    if (!IsEnabled(*ctx)) { return Maybe<void>::Ok(); }
+    const OpGraph op_graph(*job);
+    JobBuilder job_builder(job);
+    return Apply(op_graph, &job_builder);
+  }
+};
+
+Maybe<void> FuseElementwiseOpsPass::Apply(const OpGraph& op_graph, JobBuilder* job_builder) const {
+  const auto IsFusable = MakePredicatorIsFusable(op_graph);
+  // the sole consumer an op can be fused into, together with the input it is consumed by
+  HashMap<const OpNode*, std::pair<const OpNode*, std::string>> op_node2next;
+  HashSet<const OpNode*> fusable_successors;
+  op_graph.ForEachNode([&](const OpNode* op_node) {
+    if (!IsFusable(op_node)) { return; }
+    if (op_node->out_edges().size() != 1) { return; }
+    const OpNode* next = op_node->SoleOutEdge()->dst_node();
+    if (!IsFusable(next)) { return; }
+    if (next->parallel_desc() != op_node->parallel_desc()) { return; }
+    const LogicalBlobId& lbi = op_node->op().BnInOp2Lbi(FindElementwiseOpArgs(op_node)->obn);
+    std::vector<std::string> consuming_ibns;
+    for (const std::string& ibn : next->op().input_bns()) {
+      if (next->op().BnInOp2Lbi(ibn) == lbi) { consuming_ibns.push_back(ibn); }
+    }
+    if (consuming_ibns.size() != 1) { return; }
+    if (next->ParallelDistribution4BnInOp(consuming_ibns.front())
+        != op_node->ParallelDistribution4Lbi(lbi)) {
+      return;
+    }
+    op_node2next.emplace(op_node, std::make_pair(next, consuming_ibns.front()));
+    fusable_successors.insert(next);
+  });
+
+  std::vector<ElementwiseChain> chains;
+  op_graph.TopoForEachNode([&](const OpNode* head) {
+    if (!IsFusable(head) || fusable_successors.count(head) > 0) { return; }
+    ElementwiseChain chain;
+    const OpNode* cur = head;
+    std::string chain_ibn = FindElementwiseOpArgs(head)->ibns.front();
+    while (cur != nullptr && chain.op_nodes.size() < kFusedElementwiseMaxStepNum) {
+      const ElementwiseOpArgs* args = FindElementwiseOpArgs(cur);
+      if (chain.op_nodes.empty()) {
+        chain.input_lbns.push_back(GenLogicalBlobName(cur->op().BnInOp2Lbi(chain_ibn)));
+      }
+      int32_t operand_index = -1;
+      for (const std::string& ibn : args->ibns) {
+        if (ibn == chain_ibn) { continue; }
+        const std::string lbn = GenLogicalBlobName(cur->op().BnInOp2Lbi(ibn));
+        const auto it = std::find(chain.input_lbns.begin(), chain.input_lbns.end(), lbn);
+        operand_index = it - chain.input_lbns.begin();
+      }
+      if (operand_index == static_cast<int32_t>(chain.input_lbns.size())) {
+        if (chain.input_lbns.size() == kFusedElementwiseMaxInputNum) { break; }
+        for (const std::string& ibn : args->ibns) {
+          if (ibn != chain_ibn) {
+            chain.input_lbns.push_back(GenLogicalBlobName(cur->op().BnInOp2Lbi(ibn)));
+          }
+        }
+      }
+      chain.op_nodes.push_back(cur);
+      chain.op_type_names.push_back(cur->op().op_conf().user_conf().op_type_name());
+      chain.operand_indices.push_back(operand_index);
+      chain.chain_operand_is_rhs.push_back(args->ibns.size() == 2 && chain_ibn == args->ibns.at(1));
+      chain.scalar_operands.push_back(ScalarOperand4OpNode(cur));
+      const auto next_it = op_node2next.find(cur);
+      if (next_it == op_node2next.end()) { break; }
+      cur = next_it->second.first;
+      chain_ibn = next_it->second.second;
+    }
+    if (chain.op_nodes.size() > 1) { chains.push_back(chain); }
+  });
+
+  HashMap<std::string, std::string> old_lbn2new_lbn;
+  HashSet<std::string> fused_op_names;
+  for (const ElementwiseChain& chain : chains) {
+    const OpNode* last = chain.op_nodes.back();
+    const std::string old_lbn =
+        GenLogicalBlobName(last->op().BnInOp2Lbi(FindElementwiseOpArgs(last)->obn));
+    old_lbn2new_lbn[old_lbn] = kFusedElementwiseOpNamePrefix + last->op().op_name() + "/out_0";
+    for (const OpNode* op_node : chain.op_nodes) { fused_op_names.insert(op_node->op().op_name()); }
+  }
+  const auto NewLbn4Lbn = [&](const std::string& lbn) -> std::string {
+    const auto it = old_lbn2new_lbn.find(lbn);
+    return it == old_lbn2new_lbn.end() ? lbn : it->second;
+  };
+
+  HashMap<std::string, OperatorConf> consumer_op_name2conf;
+  int64_t fused_op_num = 0;
+  for (const ElementwiseChain& chain : chains) {
+    const OpNode* last = chain.op_nodes.back();
+    const std::string& last_obn = FindElementwiseOpArgs(last)->obn;
+    const LogicalBlobId& out_lbi = last->op().BnInOp2Lbi(last_obn);
+    last->ForEachNodeOnOutEdge([&](const OpNode* consumer) {
+      if (fused_op_names.count(consumer->op().op_name()) > 0) { return; }
+      auto it = consumer_op_name2conf.find(consumer->op().op_name());
+      if (it == consumer_op_name2conf.end()) {
+        it = consumer_op_name2conf.emplace(consumer->op().op_name(), consumer->op().op_conf())
+                 .first;
+      }
+      for (const std::string& ibn : consumer->op().input_bns()) {
+        if (consumer->op().BnInOp2Lbi(ibn) != out_lbi) { continue; }
+        const std::string old_lbn = ReplaceInputLbnInOpCustomizedConf(
+            &it->second, ibn, NewLbn4Lbn(GenLogicalBlobName(out_lbi)));
+        CHECK_EQ(old_lbn, GenLogicalBlobName(out_lbi));
+      }
+    });
+    const std::string fused_op_name = kFusedElementwiseOpNamePrefix + last->op().op_name();
+    user_op::UserOpConfWrapperBuilder fused_op_builder(fused_op_name);
+    fused_op_builder.Op("fused_elementwise");
+    for (const std::string& lbn : chain.input_lbns) {
+      fused_op_builder.Input("in", NewLbn4Lbn(lbn));
+    }
+    const OperatorConf fused_op_conf =
+        fused_op_builder.Output("out")
+            .Attr<std::vector<std::string>>("op_type_names", chain.op_type_names)
+            .Attr<std::vector<int32_t>>("operand_indices", chain.operand_indices)
+            .Attr<std::vector<int32_t>>("chain_operand_is_rhs", chain.chain_operand_is_rhs)
+            .Attr<std::vector<float>>("scalar_operands", chain.scalar_operands)
+            .ScopeSymbolId(last->op().op_conf().scope_symbol_id())
+            .Build()
+            .op_conf();
+    cfg::ParallelDistributionSignature signature;
+    auto* bn2parallel_distribution = signature.mutable_bn_in_op2parallel_distribution();
+    const cfg::ParallelDistribution& parallel_distribution =
+        last->ParallelDistribution4BnInOp(last_obn);
+    FOR_RANGE(int32_t, i, 0, chain.input_lbns.size()) {
+      (*bn2parallel_distribution)[GenRepeatedBn("in", i)] = parallel_distribution;
+    }
+    (*bn2parallel_distribution)[GenRepeatedBn("out", 0)] = parallel_distribution;
+    JUST(job_builder->AddOp(last->parallel_desc().parallel_conf(), fused_op_conf));
+    job_builder->AddParallelDistributionSignature4OpName(fused_op_name, signature);
+    fused_op_num += chain.op_nodes.size();
+  }
+  std::vector<OperatorConf> consumer_op_confs;
+  for (const auto& pair : consumer_op_name2conf) { consumer_op_confs.push_back(pair.second); }
+  job_builder->MutOpsOnlyOnce(consumer_op_confs);
+  job_builder->DelOps(std::vector<std::string>(fused_op_names.begin(), fused_op_names.end()));
+  LOG(INFO) << "FuseElementwiseOpsPass fused " << fused_op_num << " ops into " << chains.size()
+            << " fused_elementwise ops";
+  return Maybe<void>::Ok();
+}
+
+}  // namespace
+
+REGISTER_JOB_PASS("FuseElementwiseOpsPass", FuseElementwiseOpsPass);
+
+}  // namespace oneflow
@@ -0,0 +1,142 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/job_rewriter/job_pass.h"
+#include "oneflow/core/framework/framework.h"
+#include "oneflow/core/device/cublas_lt_util.h"
+
+namespace oneflow {
+
+namespace {
+
+std::function<bool(const OpNode* op_node)> MakePredicatorIsSafeToDelete(const OpGraph& op_graph) {
+  HashSet<std::string> ctrl_in_op_names;
+  op_graph.ForEachNode([&](const OpNode* op_node) {
+    for (const std::string& ctrl_in_op_name : op_node->op().op_conf().ctrl_in_op_name()) {
+      ctrl_in_op_names.insert(ctrl_in_op_name);
+    }
+  });
+  return [=](const OpNode* op_node) {
+    if (op_node->out_edges().size() > 1) { return false; }
+    if (!op_node->op().op_conf().ctrl_in_op_name().empty()) { return false; }
+    if (ctrl_in_op_names.find(op_node->op().op_conf().name()) != ctrl_in_op_names.end()) {
+      return false;
+    }
+    return true;
+  };
+}
+
+bool IsUserOpWithTypeName(const OperatorConf& op_conf, const std::string& op_type_name) {
+  return op_conf.has_user_conf() && op_conf.user_conf().op_type_name() == op_type_name;
+};
+
+// Fuses matmul -> bias_add [-> relu | gelu] into one fused_matmul_bias, so that the bias and the
+// activation are applied by the cuBLASLt epilogue instead of separate passes over the output. It
+// runs before the backward is generated, which then comes from the grad of fused_matmul_bias.
+class FuseMatmulBiasAddActivationPass final : public JobPass {
+ public:
+  FuseMatmulBiasAddActivationPass() = default;
+  ~FuseMatmulBiasAddActivationPass() override = default;
+
+  bool IsEnabled(const JobPassCtx& ctx) const {
+    if (!ctx.job_desc().job_conf().enable_fuse_matmul_bias_add_activation()) { return false; }
+    CHECK(IsCublasLtMatmulEpilogueSupported())
+        << "enable_fuse_matmul_bias_add_activation needs cuBLASLt of CUDA 11.4 or later";
+    return true;
+  }
+  Maybe<void> Apply(const OpGraph& op_graph, JobBuilder* job_builder) const;
+
+  Maybe<void> Apply(Job* job, JobPassCtx* ctx) const override {
+    if (!IsEnabled(*ctx)) { return Maybe<void>::Ok(); }
+    const OpGraph op_graph(*job);
+    JobBuilder job_builder(job);
+    return Apply(op_graph, &job_builder);
+  }
+};
+
+bool IsFusibleMatmul(const OpNode* op_node) {
+  const OperatorConf& op_conf = op_node->op().op_conf();
+  const bool is_matmul = IsUserOpWithTypeName(op_conf, "matmul");
+  if (!is_matmul && !IsUserOpWithTypeName(op_conf, "broadcast_matmul")) { return false; }
+  if (op_node->parallel_desc().device_type() != DeviceType::kGPU) { return false; }
+  const user_op::UserOpConfWrapper matmul_conf(op_conf);
+  if (matmul_conf.has_input("_add_to_output", 0)) { return false; }
+  if (matmul_conf.attr<bool>("transpose_a")) { return false; }
+  if (matmul_conf.attr<double>("alpha") != 1.0) { return false; }
+  const BlobDesc& a_desc =
+      op_node->LogicalBlobDesc4Lbi(GenLogicalBlobId(matmul_conf.input("a", 0)));
+  const BlobDesc& b_desc =
+      op_node->LogicalBlobDesc4Lbi(GenLogicalBlobId(matmul_conf.input("b", 0)));
+  if (b_desc.shape().NumAxes() != 2) { return false; }
+  if (is_matmul && a_desc.shape().NumAxes() != 2) { return false; }
+  return a_desc.data_type() == DataType::kFloat || a_desc.data_type() == DataType::kFloat16;
+}
+
+Maybe<void> FuseMatmulBiasAddActivationPass::Apply(const OpGraph& op_graph,
+                                                  JobBuilder* job_builder) const {
+  const auto IsSafeToDelete = MakePredicatorIsSafeToDelete(op_graph);
+  std::vector<OperatorConf> delete_ops;
+  op_graph.ForEachNode([&](const OpNode* op_node) {
+    if (!IsFusibleMatmul(op_node)) { return; }
+    if (!IsSafeToDelete(op_node)) { return; }
+    if (op_node->out_edges().size() != 1) { return; }
+    const user_op::UserOpConfWrapper matmul_conf(op_node->op().op_conf());
+    const OpNode* bias_add_node = op_node->SoleOutEdge()->dst_node();
+    if (!IsUserOpWithTypeName(bias_add_node->op().op_conf(), "bias_add")) { return; }
+    const user_op::UserOpConfWrapper bias_add_conf(bias_add_node->op().op_conf());
+    if (bias_add_conf.input("a", 0) != matmul_conf.output("out", 0)) { return; }
+    const int64_t num_axes =
+        op_node->LogicalBlobDesc4Lbi(GenLogicalBlobId(matmul_conf.output("out", 0)))
+            .shape()
+            .NumAxes();
+    if (bias_add_conf.attr<int32_t>("axis") != num_axes - 1) { return; }
+
+    const OpNode* last_node = bias_add_node;
+    std::string activation = "none";
+    if (IsSafeToDelete(bias_add_node) && bias_add_node->out_edges().size() == 1) {
+      const OpNode* act_node = bias_add_node->SoleOutEdge()->dst_node();
+      const OperatorConf& act_conf = act_node->op().op_conf();
+      if (IsUserOpWithTypeName(act_conf, "relu") || IsUserOpWithTypeName(act_conf, "gelu")) {
+        activation = act_conf.user_conf().op_type_name();
+        last_node = act_node;
+      }
+    }
+    if (last_node != bias_add_node) { delete_ops.push_back(bias_add_node->op().op_conf()); }
+    delete_ops.push_back(op_node->op().op_conf());
+
+    // The fused op takes the name of the last op, whose output is also "out".
+    user_op::UserOpConfWrapperBuilder fused_op_builder(last_node->op().op_name());
+    fused_op_builder.OpTypeName("fused_matmul_bias")
+        .Input("a", matmul_conf.input("a", 0))
+        .Input("b", matmul_conf.input("b", 0))
+        .Input("bias", bias_add_conf.input("b", 0))
+        .Output("out")
+        .Attr<bool>("transpose_b", matmul_conf.attr<bool>("transpose_b"))
+        .Attr<std::string>("activation", activation);
+    if (activation == "gelu") { fused_op_builder.Output("aux"); }
+
+    OperatorConf new_op_conf = last_node->op().op_conf();
+    *new_op_conf.mutable_user_conf() = fused_op_builder.Build().op_conf().user_conf();
+    job_builder->MutOpsOnlyOnce({new_op_conf});
+  });
+  job_builder->DelOps(delete_ops);
+  return Maybe<void>::Ok();
+}
+
+}  // namespace
+
+REGISTER_JOB_PASS("FuseMatmulBiasAddActivationPass", FuseMatmulBiasAddActivationPass);
+
+}  // namespace oneflow
@@ -69,7 +69,8 @@ Maybe<void> FuseUpdateOpsPass::Apply(const OpGraph& op_graph, JobBuilder* job_bu
         && user_op_conf.op_type_name() != "momentum_update"
         && user_op_conf.op_type_name() != "adam_update"
         && user_op_conf.op_type_name() != "rmsprop_update"
-        && user_op_conf.op_type_name() != "lars_update") {
+        && user_op_conf.op_type_name() != "lars_update"
+        && user_op_conf.op_type_name() != "lamb_update") {
       return;
     }
     if (user_op_conf.attr<double>("scale") != 1.0 || user_op_conf.attr<float>("l1") != 0.0f
@@ -186,6 +187,14 @@ Maybe<void> FuseUpdateOpsPass::Apply(const OpGraph& op_graph, JobBuilder* job_bu
           .Attr<float>("momentum_beta", user_op_conf.attr<float>("momentum_beta"))
           .Attr<float>("epsilon", user_op_conf.attr<float>("epsilon"))
           .Attr<float>("lars_coefficient", user_op_conf.attr<float>("lars_coefficient"));
+    } else if (user_op_conf.op_type_name() == "lamb_update") {
+      fused_op_builder.Input("m", user_op_conf.input("m", 0))
+          .Input("v", user_op_conf.input("v", 0))
+          .Input("beta1_t", user_op_conf.input("beta1_t", 0))
+          .Input("beta2_t", user_op_conf.input("beta2_t", 0))
+          .Attr<float>("beta1", user_op_conf.attr<float>("beta1"))
+          .Attr<float>("beta2", user_op_conf.attr<float>("beta2"))
+          .Attr<float>("epsilon", user_op_conf.attr<float>("epsilon"));
     } else {
       UNIMPLEMENTED();
     }
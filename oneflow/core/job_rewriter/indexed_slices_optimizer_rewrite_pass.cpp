@@ -44,6 +44,8 @@ Maybe<void> IndexedSlicesOptimizerRewritePass::Apply(const OpGraph& op_graph,
       GlobalJobDesc().job_conf().indexed_slices_optimizer_conf().include_op_names().op_name();
   const std::set<std::string> include_op_name_set(
       {include_op_names.cbegin(), include_op_names.cend()});
+  const double max_density =
+      GlobalJobDesc().job_conf().indexed_slices_optimizer_conf().max_density();
   op_graph.ForEachNode([&](const OpNode* src_node) {
     const OperatorConf& src_op_conf = src_node->op().op_conf();
     if (src_node->out_edges().size() != 1) { return; }
@@ -102,6 +104,19 @@ Maybe<void> IndexedSlicesOptimizerRewritePass::Apply(const OpGraph& op_graph,
       return;
     }
     model_op_name = model_lbi.op_name();
+    const cfg::ParallelDistribution& model_parallel_distribution =
+        dst_node->ParallelDistribution4Lbi(model_lbi);
+    bool is_model_replicated = true;
+    for (const auto& sbp : model_parallel_distribution.sbp_parallel()) {
+      if (!sbp.has_broadcast_parallel()) { is_model_replicated = false; }
+    }
+    if (is_model_replicated && dst_node->parallel_desc().parallel_num() > 1) {
+      // every rank receives the indices of all ranks, the dense all-reduce moves the whole model
+      const int64_t num_rows = dst_node->LogicalBlobDesc4Lbi(model_lbi).shape().At(0);
+      const int64_t num_indices =
+          src_node->LogicalBlobDesc4Lbi(GenLogicalBlobId(indices_lbn)).shape().elem_cnt();
+      if (num_indices > max_density * num_rows) { return; }
+    }
     user_op::UserOpConfWrapperBuilder indexed_slices_op_builder("System-Optimizer-IndexedSlices-"
                                                                 + model_op_name);
     indexed_slices_op_builder.OpTypeName("indexed_slices_" + user_op_conf.op_type_name())
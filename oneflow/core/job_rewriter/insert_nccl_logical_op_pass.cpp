@@ -398,6 +398,39 @@ bool ReverseOrderInsertNcclLogicalOps() {
   return Global<ResourceDesc, ForSession>::Get()->resource().disable_group_boxing_by_dst_parallel();
 }
 
+// Turns the matmul producing a partial sum into _nccl_logical_matmul_all_reduce when the nccl op
+// would be an all-reduce of that sum, so the all-reduce runs chunk by chunk under the GEMM.
+bool TryFuseMatmulAllReduce(const OpNode* src_node, const OpEdge* op_edge,
+                            const OperatorConf& nccl_op, OperatorConf* src_op_conf) {
+  const int64_t chunk_num =
+      Global<ResourceDesc, ForSession>::Get()->resource().nccl_matmul_all_reduce_chunk_num();
+  if (chunk_num <= 0) { return false; }
+  if (nccl_op.user_conf().op_type_name() != "_nccl_logical_all_reduce") { return false; }
+  if (!src_op_conf->has_user_conf() || src_op_conf->user_conf().op_type_name() != "matmul") {
+    return false;
+  }
+  // other consumers of the matmul may still want the partial sum
+  if (src_node->out_edges().size() != 1 || op_edge->lbis().size() != 1) { return false; }
+  if (src_node->parallel_desc().hierarchy()->NumAxes() != 1) { return false; }
+  const user_op::UserOpConfWrapper matmul_conf(*src_op_conf);
+  if (matmul_conf.has_input("_add_to_output", 0)) { return false; }
+  if (matmul_conf.attr<bool>("transpose_a")) { return false; }
+  const LogicalBlobId a_lbi = GenLogicalBlobId(matmul_conf.input("a", 0));
+  if (src_node->LogicalBlobDesc4Lbi(a_lbi).shape().NumAxes() != 2) { return false; }
+  const auto fused_op = user_op::UserOpConfWrapperBuilder(src_op_conf->name())
+                            .Op("_nccl_logical_matmul_all_reduce")
+                            .Input("a", matmul_conf.input("a", 0))
+                            .Input("b", matmul_conf.input("b", 0))
+                            .Output("out")
+                            .Attr<bool>("transpose_b", matmul_conf.attr<bool>("transpose_b"))
+                            .Attr<double>("alpha", matmul_conf.attr<double>("alpha"))
+                            .Attr<int64_t>("chunk_num", chunk_num)
+                            .Build();
+  CHECK_EQ(fused_op.output("out", 0), matmul_conf.output("out", 0));
+  *src_op_conf->mutable_user_conf() = fused_op.op_conf().user_conf();
+  return true;
+}
+
 void InsertNcclLogicalOpsAsCloseAsPossibleToSrcNode(
     HashMap<std::string, OperatorConf>* subgraph_op_name2conf, HashSet<std::string>* mut_op_names,
     std::vector<OperatorConf>* nccl_op_confs, std::vector<ParallelConf>* nccl_op_parallel_confs,
@@ -416,6 +449,11 @@ void InsertNcclLogicalOpsAsCloseAsPossibleToSrcNode(
       for (const LogicalBlobId& lbi : op_edge->lbis()) {
         OperatorConf nccl_op;
         if (!TryBuildNcclLogicalOpConf(&nccl_op, src_node, dst_node, lbi)) { continue; }
+        if (TryFuseMatmulAllReduce(src_node, op_edge, nccl_op,
+                                   &subgraph_op_name2conf->at(src_op_name))) {
+          mut_op_names->insert(src_op_name);
+          continue;
+        }
         mut_op_names->insert(dst_op_name);
         // insert nccl op
         user_op::UserOpConfWrapper nccl_op_wrapper(nccl_op);
@@ -475,6 +513,11 @@ void InsertNcclLogicalOpsAsCloseAsPossibleToDstNode(
         OperatorConf nccl_op;
         // builde nccl op
         if (!TryBuildNcclLogicalOpConf(&nccl_op, src_node, dst_node, lbi)) { continue; }
+        if (TryFuseMatmulAllReduce(src_node, op_edge, nccl_op,
+                                   &subgraph_op_name2conf->at(src_op_name))) {
+          mut_op_names->insert(src_op_name);
+          continue;
+        }
         mut_op_names->insert(dst_op_name);
         // insert nccl op
         user_op::UserOpConfWrapper nccl_op_wrapper(nccl_op);
@@ -0,0 +1,194 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/job_rewriter/job_pass.h"
+#include "oneflow/core/framework/framework.h"
+
+namespace oneflow {
+
+namespace {
+
+std::function<bool(const OpNode* op_node)> MakePredicatorIsSafeToDelete(const OpGraph& op_graph) {
+  HashSet<std::string> ctrl_in_op_names;
+  op_graph.ForEachNode([&](const OpNode* op_node) {
+    for (const std::string& ctrl_in_op_name : op_node->op().op_conf().ctrl_in_op_name()) {
+      ctrl_in_op_names.insert(ctrl_in_op_name);
+    }
+  });
+  return [=](const OpNode* op_node) {
+    if (op_node->out_edges().size() > 1) { return false; }
+    if (!op_node->op().op_conf().ctrl_in_op_name().empty()) { return false; }
+    if (ctrl_in_op_names.find(op_node->op().op_conf().name()) != ctrl_in_op_names.end()) {
+      return false;
+    }
+    return true;
+  };
+}
+
+bool IsUserOpWithTypeName(const OperatorConf& op_conf, const std::string& op_type_name) {
+  return op_conf.has_user_conf() && op_conf.user_conf().op_type_name() == op_type_name;
+};
+
+// Only the 8 bit symmetric "google" fake quantization rounds to the int8 values quantize_int8
+// produces.
+bool IsInt8SymmetricFakeQuant(const OpNode* op_node) {
+  const OperatorConf& op_conf = op_node->op().op_conf();
+  if (!IsUserOpWithTypeName(op_conf, "fake_quantization")) { return false; }
+  const user_op::UserOpConfWrapper conf(op_conf);
+  return conf.attr<std::string>("quantization_scheme") == "symmetric"
+         && conf.attr<std::string>("quantization_formula") == "google"
+         && conf.attr<int32_t>("quantization_bit") == 8;
+}
+
+int64_t ElemCnt4Lbn(const OpNode* op_node, const std::string& lbn) {
+  return op_node->LogicalBlobDesc4Lbi(GenLogicalBlobId(lbn)).shape().elem_cnt();
+}
+
+// Replaces the fake quantized float matmuls of a predict job, as left by QuantAwareTraining, with
+// quantized_matmul on the int8 values of its inputs: fake_quantization(a) * fake_quantization(b)
+// [+ bias] becomes quantized_matmul(quantize_int8(a), quantize_int8(b)) with the scales of the
+// fake quantizations. The following bias_add is folded into the dequantizing epilogue. Run before
+// constant folding, the quantization of the weights is then computed once.
+class Int8InferencePass final : public JobPass {
+ public:
+  Int8InferencePass() = default;
+  ~Int8InferencePass() override = default;
+
+  bool IsEnabled(const JobPassCtx& ctx) const {
+    if (!ctx.job_desc().job_conf().enable_int8_inference()) { return false; }
+    CHECK(!ctx.job_desc().IsTrain()) << "enable_int8_inference is only for predict jobs";
+    return true;
+  }
+  Maybe<void> Apply(const OpGraph& op_graph, JobBuilder* job_builder) const;
+
+  Maybe<void> Apply(Job* job, JobPassCtx* ctx) const override {
+    if (!IsEnabled(*ctx)) { return Maybe<void>::Ok(); }
+    const OpGraph op_graph(*job);
+    JobBuilder job_builder(job);
+    return Apply(op_graph, &job_builder);
+  }
+};
+
+Maybe<void> Int8InferencePass::Apply(const OpGraph& op_graph, JobBuilder* job_builder) const {
+  const auto IsSafeToDelete = MakePredicatorIsSafeToDelete(op_graph);
+  HashSet<std::string> delete_op_names;
+  std::vector<OperatorConf> delete_ops;
+  auto DeleteIfSafe = [&](const OpNode* op_node) {
+    if (!IsSafeToDelete(op_node)) { return; }
+    if (delete_op_names.insert(op_node->op().op_name()).second) {
+      delete_ops.push_back(op_node->op().op_conf());
+    }
+  };
+  op_graph.ForEachNode([&](const OpNode* op_node) {
+    const OperatorConf& op_conf = op_node->op().op_conf();
+    if (!IsUserOpWithTypeName(op_conf, "matmul")) { return; }
+    const DeviceType device_type = op_node->parallel_desc().device_type();
+    if (device_type != DeviceType::kGPU && device_type != DeviceType::kCPU) { return; }
+    const user_op::UserOpConfWrapper matmul_conf(op_conf);
+    if (matmul_conf.has_input("_add_to_output", 0)) { return; }
+    if (matmul_conf.attr<bool>("transpose_a")) { return; }
+    const OpNode* a_node = &op_node->SrcNode4Ibn("a_0");
+    const OpNode* b_node = &op_node->SrcNode4Ibn("b_0");
+    if (!IsInt8SymmetricFakeQuant(a_node) || !IsInt8SymmetricFakeQuant(b_node)) { return; }
+    const user_op::UserOpConfWrapper a_fake_quant_conf(a_node->op().op_conf());
+    const user_op::UserOpConfWrapper b_fake_quant_conf(b_node->op().op_conf());
+    const std::string& b_scale = b_fake_quant_conf.input("scale", 0);
+    const bool transpose_b = matmul_conf.attr<bool>("transpose_b");
+    const Shape& b_shape =
+        op_node->LogicalBlobDesc4Lbi(GenLogicalBlobId(matmul_conf.input("b", 0))).shape();
+    if (b_shape.NumAxes() != 2) { return; }
+    const int64_t n = transpose_b ? b_shape.At(0) : b_shape.At(1);
+    const int64_t k = transpose_b ? b_shape.At(1) : b_shape.At(0);
+    // cublasGemmEx takes int8 matrices with leading dimensions of multiples of 4 only.
+    if (device_type == DeviceType::kGPU && (k % 4 != 0 || n % 4 != 0)) { return; }
+    if (ElemCnt4Lbn(op_node, a_fake_quant_conf.input("scale", 0)) != 1) { return; }
+    // Per channel scales of b are along its axis 0, that is along n only if b is transposed.
+    const int64_t b_scale_cnt = ElemCnt4Lbn(op_node, b_scale);
+    if (b_scale_cnt != 1 && !(transpose_b && b_scale_cnt == n)) { return; }
+
+    const OpNode* last_node = op_node;
+    std::string bias;
+    if (IsSafeToDelete(op_node) && op_node->out_edges().size() == 1) {
+      const OpNode* bias_add_node = op_node->SoleOutEdge()->dst_node();
+      if (IsUserOpWithTypeName(bias_add_node->op().op_conf(), "bias_add")) {
+        const user_op::UserOpConfWrapper bias_add_conf(bias_add_node->op().op_conf());
+        if (bias_add_conf.input("a", 0) == matmul_conf.output("out", 0)
+            && bias_add_conf.attr<int32_t>("axis") == 1) {
+          bias = bias_add_conf.input("b", 0);
+          last_node = bias_add_node;
+        }
+      }
+    }
+
+    const std::string& op_name = op_node->op().op_name();
+    const int64_t scope_symbol_id = op_conf.scope_symbol_id();
+    std::vector<OperatorConf> new_ops;
+    std::string b_in = b_fake_quant_conf.input("in", 0);
+    if (!transpose_b) {
+      const auto transpose_op = user_op::UserOpConfWrapperBuilder(op_name + "-int8-transpose_b")
+                                    .Op("transpose")
+                                    .Input("input", b_in)
+                                    .Output("output")
+                                    .Attr<std::vector<int32_t>>("perm", {1, 0})
+                                    .ScopeSymbolId(scope_symbol_id)
+                                    .Build();
+      new_ops.push_back(transpose_op.op_conf());
+      b_in = transpose_op.output("output", 0);
+    }
+    const auto a_quant_op = user_op::UserOpConfWrapperBuilder(op_name + "-int8-quantize_a")
+                                .Op("quantize_int8")
+                                .Input("in", a_fake_quant_conf.input("in", 0))
+                                .Input("scale", a_fake_quant_conf.input("scale", 0))
+                                .Output("out")
+                                .ScopeSymbolId(scope_symbol_id)
+                                .Build();
+    const auto b_quant_op = user_op::UserOpConfWrapperBuilder(op_name + "-int8-quantize_b")
+                                .Op("quantize_int8")
+                                .Input("in", b_in)
+                                .Input("scale", b_scale)
+                                .Output("out")
+                                .ScopeSymbolId(scope_symbol_id)
+                                .Build();
+    new_ops.push_back(a_quant_op.op_conf());
+    new_ops.push_back(b_quant_op.op_conf());
+    job_builder->AddOps(op_node->parallel_desc().parallel_conf(), new_ops);
+
+    // The quantized matmul takes the name of the last op, whose output is also "out".
+    user_op::UserOpConfWrapperBuilder quantized_matmul_builder(last_node->op().op_name());
+    quantized_matmul_builder.OpTypeName("quantized_matmul")
+        .Input("a", a_quant_op.output("out", 0))
+        .Input("b", b_quant_op.output("out", 0))
+        .Input("a_scale", a_fake_quant_conf.input("scale", 0))
+        .Input("b_scale", b_scale)
+        .Output("out")
+        .Attr<double>("alpha", matmul_conf.attr<double>("alpha"));
+    if (!bias.empty()) { quantized_matmul_builder.Input("bias", bias); }
+    OperatorConf new_op_conf = last_node->op().op_conf();
+    *new_op_conf.mutable_user_conf() = quantized_matmul_builder.Build().op_conf().user_conf();
+    job_builder->MutOpsOnlyOnce({new_op_conf});
+
+    if (last_node != op_node) { DeleteIfSafe(op_node); }
+    DeleteIfSafe(a_node);
+    DeleteIfSafe(b_node);
+  });
+  job_builder->DelOps(delete_ops);
+  return Maybe<void>::Ok();
+}
+
+}  // namespace
+
+REGISTER_JOB_PASS("Int8InferencePass", Int8InferencePass);
+
+}  // namespace oneflow
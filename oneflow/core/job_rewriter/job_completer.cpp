@@ -18,6 +18,7 @@ limitations under the License.
 #include "oneflow/core/job_rewriter/autograd.h"
 #include "oneflow/core/job_rewriter/autotick.h"
 #include "oneflow/core/job/job_desc.h"
+#include "oneflow/core/job/compile_report.h"
 #include "oneflow/core/job/global_for.h"
 #include "oneflow/core/job_rewriter/group_boxing_by_dst_parallel.h"
 #include "oneflow/core/framework/config_def.h"
@@ -60,18 +61,46 @@ Maybe<void> CheckOpGraph(const OpGraph& op_graph) {
   return Maybe<void>::Ok();
 }
 
-Maybe<void> WithOpGraphAndMutJob(Job* job,
+// Most completion steps leave the job untouched, so the OpGraph of the last seen version of the
+// job is kept and only rebuilt once a step has changed the job.
+class OpGraphCache final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(OpGraphCache);
+  OpGraphCache() = default;
+  ~OpGraphCache() = default;
+
+  Maybe<const OpGraph&> Get(const Job& job) {
+    std::string serialized_job = job.SerializeAsString();
+    if (!op_graph_ || serialized_job != serialized_job_) {
+      op_graph_ = JUST(OpGraph::New(job));
+      serialized_job_ = std::move(serialized_job);
+    }
+    return *op_graph_;
+  }
+
+ private:
+  std::string serialized_job_;
+  std::shared_ptr<OpGraph> op_graph_;
+};
+
+Maybe<void> WithOpGraphAndMutJob(OpGraphCache* op_graph_cache, const std::string& step_name,
+                                 Job* job,
                                  const std::function<Maybe<void>(const OpGraph&, Job*)>& Handler) {
-  OpGraph op_graph(*job);
-  JUST(Handler(op_graph, job));
+  const double start = GetCurTime();
+  JUST(Handler(JUST(op_graph_cache->Get(*job)), job));
+  RecordJobPassTime(job->job_conf().job_name(), step_name, (GetCurTime() - start) / 1e9);
   return Maybe<void>::Ok();
 }
 
 Maybe<void> WithOpGraphAndMutJobBuilder(
-    Job* job, const std::function<Maybe<void>(const OpGraph&, JobBuilder*)>& Handler) {
-  OpGraph op_graph(*job);
-  JobBuilder job_builder(job);
-  JUST(Handler(op_graph, &job_builder));
+    OpGraphCache* op_graph_cache, const std::string& step_name, Job* job,
+    const std::function<Maybe<void>(const OpGraph&, JobBuilder*)>& Handler) {
+  const double start = GetCurTime();
+  {
+    JobBuilder job_builder(job);
+    JUST(Handler(JUST(op_graph_cache->Get(*job)), &job_builder));
+  }
+  RecordJobPassTime(job->job_conf().job_name(), step_name, (GetCurTime() - start) / 1e9);
   return Maybe<void>::Ok();
 }
 
@@ -122,23 +151,38 @@ Maybe<void> SetCtrlInOpName4VariableOp(const OpGraph& op_graph, JobBuilder* job_
 
 Maybe<void> JobCompleter::Complete(Job* job) const {
   JobPassCtx job_pass_ctx(GlobalJobDesc());
-  JUST(JobPass4Name("DumpBlobParallelConfPass")(job, &job_pass_ctx));
+  OpGraphCache op_graph_cache;
+  auto DoPass = [&](const std::string& pass_name) -> Maybe<void> {
+    const double start = GetCurTime();
+    JUST(JobPass4Name(pass_name)(job, &job_pass_ctx));
+    RecordJobPassTime(job->job_conf().job_name(), pass_name, (GetCurTime() - start) / 1e9);
+    return Maybe<void>::Ok();
+  };
+  JUST(DoPass("DumpBlobParallelConfPass"));
   // NOTE(chengcheng): disable this pass for reduce boxing memory life cycle to memory cost.
   if (!Global<ResourceDesc, ForSession>::Get()->resource().disable_group_boxing_by_dst_parallel()) {
-    JUST(WithOpGraphAndMutJobBuilder(job, &GroupBoxingByDstParallel));
+    JUST(WithOpGraphAndMutJobBuilder(&op_graph_cache, "GroupBoxingByDstParallel", job,
+                                     &GroupBoxingByDstParallel));
   }
-  JUST(WithOpGraphAndMutJobBuilder(job, &SetCtrlInOpName4VariableOp));
+  JUST(WithOpGraphAndMutJobBuilder(&op_graph_cache, "SetCtrlInOpName4VariableOp", job,
+                                   &SetCtrlInOpName4VariableOp));
   // complete tick ops
-  JUST(WithOpGraphAndMutJobBuilder(job, &AutoPrependTick));
-  JUST(WithOpGraphAndMutJobBuilder(job, &AddTickForTimeShape));
-  JUST(WithOpGraphAndMutJobBuilder(job, &SingleClientAutoSourceAndSinkTick));
-  JUST(WithOpGraphAndMutJobBuilder(job, &SingleClientAddGlobalInputCriticalSections));
-  JUST(WithOpGraphAndMutJobBuilder(job, &SingleClientAddGlobalOutputCriticalSections));
-  JUST(WithOpGraphAndMutJob(job, &MultiClientAutoSourceAndSinkTick));
-  JUST(JobPass4Name("DumpBlobParallelConfPass")(job, &job_pass_ctx));
+  JUST(WithOpGraphAndMutJobBuilder(&op_graph_cache, "AutoPrependTick", job, &AutoPrependTick));
+  JUST(WithOpGraphAndMutJobBuilder(&op_graph_cache, "AddTickForTimeShape", job,
+                                   &AddTickForTimeShape));
+  JUST(WithOpGraphAndMutJobBuilder(&op_graph_cache, "SingleClientAutoSourceAndSinkTick", job,
+                                   &SingleClientAutoSourceAndSinkTick));
+  JUST(WithOpGraphAndMutJobBuilder(&op_graph_cache, "SingleClientAddGlobalInputCriticalSections",
+                                   job, &SingleClientAddGlobalInputCriticalSections));
+  JUST(WithOpGraphAndMutJobBuilder(&op_graph_cache, "SingleClientAddGlobalOutputCriticalSections",
+                                   job, &SingleClientAddGlobalOutputCriticalSections));
+  JUST(WithOpGraphAndMutJob(&op_graph_cache, "MultiClientAutoSourceAndSinkTick", job,
+                            &MultiClientAutoSourceAndSinkTick));
+  JUST(DoPass("DumpBlobParallelConfPass"));
   if (XrtCompilationEnabled(GlobalJobDesc())) {
 #ifdef OF_WITH_XRT
-    JUST(WithOpGraphAndMutJob(job, &RebuildXrtCompiledJob));
+    JUST(WithOpGraphAndMutJob(&op_graph_cache, "RebuildXrtCompiledJob", job,
+                              &RebuildXrtCompiledJob));
 #else
     LOG(WARNING) << "It will not use XLA or TensorRT since WITH_XLA or "
                     "WITH_TENSORRT was not enabled when compiling the project.";
@@ -147,12 +191,12 @@ Maybe<void> JobCompleter::Complete(Job* job) const {
 #ifdef WITH_CUDA
   if (Global<ResourceDesc, ForSession>::Get()->nccl_use_compute_stream()) {
     // NOTE(chengcheng): this pass need as last pass for insert correct op with nccl boxing.
-    JUST(JobPass4Name("InsertNcclLogicalOpPass")(job, &job_pass_ctx));
+    JUST(DoPass("InsertNcclLogicalOpPass"));
     // NOTE(chengcheng): Becasue insert new logical nccl op, MUST dump time shape, sbp again.
-    JUST(JobPass4Name("DumpBlobParallelConfPass")(job, &job_pass_ctx));
+    JUST(DoPass("DumpBlobParallelConfPass"));
   }
 #endif  // WITH_CUDA
-  JUST(CheckOpGraph(OpGraph(*job)));
+  JUST(CheckOpGraph(JUST(op_graph_cache.Get(*job))));
   return Maybe<void>::Ok();
 }
 
@@ -17,6 +17,8 @@ limitations under the License.
 #include "oneflow/core/job_rewriter/job_pass.h"
 #include "oneflow/core/graph/op_graph.h"
 #include "oneflow/core/job/job_desc.h"
+#include "oneflow/core/job/sbp_parallel.h"
+#include "oneflow/core/framework/framework.h"
 
 namespace oneflow {
 
@@ -307,6 +309,130 @@ Maybe<void> RewriteNonDistributed(const OpGraph& op_graph, JobBuilder* builder)
   return Maybe<void>::Ok();
 }
 
+const std::string kZeroAllGatherOpNamePrefix = "System-Zero-AllGather-Op_";
+
+// ZeRO stage 1/2: the variable, and so the optimizer states generated from its conf, keeps only a
+// 1/N shard on each of the N data parallel ranks. The gradient arrives partial sum and is reduce
+// scattered into the shard by boxing, and the updated shard is all gathered once per step by an
+// identity op that all forward consumers share. The all gathers are chained in the order of first
+// use so that gathering the next variable overlaps the forward compute of the current one.
+Maybe<void> RewriteZero(const OpGraph& op_graph, JobBuilder* builder) {
+  const int64_t threshold = builder->job().job_conf().optimizer_placement_optimization_threshold();
+  auto OpNode2Order = MakeGetterOpNode2TopoOrder(op_graph);
+  struct ZeroVariable {
+    const OpNode* var_node;
+    int64_t order;
+    OperatorConf all_gather_op_conf;
+  };
+  HashMap<ParallelDesc, std::vector<ZeroVariable>> parallel_desc2variables;
+  // a consumer may read several sharded variables
+  HashMap<std::string, OperatorConf> consumer_op_name2conf;
+  int64_t sharded_bytes = 0;
+  JUST(op_graph.TopoForEachNodeWithErrorCaptured([&](const OpNode* node) -> Maybe<void> {
+    const OperatorConf& op_conf = node->op().op_conf();
+    if (!op_conf.has_variable_conf()) { return Maybe<void>::Ok(); }
+    const ParallelDesc& pd = node->parallel_desc();
+    if (pd.device_type() != DeviceType::kGPU || pd.parallel_num() == 1) {
+      return Maybe<void>::Ok();
+    }
+    const LogicalBlobId& lbi = node->op().BnInOp2Lbi(node->op().SoleObn());
+    const cfg::ParallelDistribution& parallel_distribution = node->ParallelDistribution4Lbi(lbi);
+    const Shape& hierarchy = *pd.hierarchy();
+    const Shape shape(op_conf.variable_conf().shape());
+    // hierarchy axes the variable is broadcast on are data parallel
+    int64_t data_parallel_num = 1;
+    HashSet<int64_t> split_axes;
+    FOR_RANGE(int64_t, i, 0, hierarchy.NumAxes()) {
+      const cfg::SbpParallel& sbp_parallel = parallel_distribution.sbp_parallel(i);
+      if (sbp_parallel.has_broadcast_parallel()) {
+        data_parallel_num *= hierarchy.At(i);
+      } else if (sbp_parallel.has_split_parallel()) {
+        split_axes.insert(sbp_parallel.split_parallel().axis());
+      } else {
+        return Maybe<void>::Ok();
+      }
+    }
+    if (data_parallel_num == 1 || shape.elem_cnt() < threshold * data_parallel_num) {
+      return Maybe<void>::Ok();
+    }
+    int64_t zero_axis = -1;
+    FOR_RANGE(int64_t, axis, 0, shape.NumAxes()) {
+      if (split_axes.count(axis) == 0 && shape.At(axis) % data_parallel_num == 0) {
+        zero_axis = axis;
+        break;
+      }
+    }
+    if (zero_axis == -1) { return Maybe<void>::Ok(); }
+    bool has_mutable_consumer = false;
+    ForEachOutNodeConsumingLbi(node, lbi, [&](const OpNode* out_node, const std::string& ibn) {
+      if (out_node->op().InputBlobModifier4Ibn(ibn).is_mutable()) { has_mutable_consumer = true; }
+    });
+    if (has_mutable_consumer) { return Maybe<void>::Ok(); }
+
+    OperatorConf new_var_op_conf = op_conf;
+    new_var_op_conf.mutable_variable_conf()->clear_parallel_distribution();
+    FOR_RANGE(int64_t, i, 0, hierarchy.NumAxes()) {
+      const cfg::SbpParallel& sbp_parallel = parallel_distribution.sbp_parallel(i);
+      *new_var_op_conf.mutable_variable_conf()->add_parallel_distribution() =
+          sbp_parallel.has_broadcast_parallel() ? "S(" + std::to_string(zero_axis) + ")"
+                                                : SbpParallelToString(sbp_parallel);
+    }
+    builder->MutOpsOnlyOnce({new_var_op_conf});
+
+    const std::string all_gather_op_name = kZeroAllGatherOpNamePrefix + node->op().op_name();
+    OperatorConf all_gather_op_conf = user_op::UserOpConfWrapperBuilder(all_gather_op_name)
+                                          .Op("identity")
+                                          .Input("in", GenLogicalBlobName(lbi))
+                                          .Output("out")
+                                          .ScopeSymbolId(op_conf.scope_symbol_id())
+                                          .Build()
+                                          .op_conf();
+    cfg::ParallelDistributionSignature signature;
+    auto* bn2parallel_distribution = signature.mutable_bn_in_op2parallel_distribution();
+    (*bn2parallel_distribution)[GenRepeatedBn("in", 0)] = parallel_distribution;
+    (*bn2parallel_distribution)[GenRepeatedBn("out", 0)] = parallel_distribution;
+    builder->AddParallelDistributionSignature4OpName(all_gather_op_name, signature);
+    const std::string all_gather_out =
+        user_op::UserOpConfWrapper(all_gather_op_conf).output("out", 0);
+    ForEachOutNodeConsumingLbi(node, lbi, [&](const OpNode* out_node, const std::string& ibn) {
+      auto it = consumer_op_name2conf.find(out_node->op().op_name());
+      if (it == consumer_op_name2conf.end()) {
+        it = consumer_op_name2conf.emplace(out_node->op().op_name(), out_node->op().op_conf())
+                 .first;
+      }
+      ReplaceInputLbnInOpCustomizedConf(&it->second, ibn, all_gather_out);
+    });
+
+    ZeroVariable variable;
+    variable.var_node = node;
+    variable.order = GetMinConsumerOrder(op_graph, node, OpNode2Order);
+    variable.all_gather_op_conf = all_gather_op_conf;
+    parallel_desc2variables[pd].push_back(variable);
+    sharded_bytes += GetSoleOutBlobSize(node);
+    return Maybe<void>::Ok();
+  }));
+
+  for (auto& pair : parallel_desc2variables) {
+    auto& variables = pair.second;
+    std::sort(variables.begin(), variables.end(),
+              [](const ZeroVariable& lhs, const ZeroVariable& rhs) {
+                return lhs.order < rhs.order;
+              });
+    for (int64_t i = 0; i < variables.size(); ++i) {
+      OperatorConf* all_gather_op_conf = &variables.at(i).all_gather_op_conf;
+      if (i != 0) {
+        all_gather_op_conf->add_ctrl_in_op_name(variables.at(i - 1).all_gather_op_conf.name());
+      }
+      JUST(builder->AddOp(pair.first.parallel_conf(), *all_gather_op_conf));
+    }
+    LOG(INFO) << "zero shards " << variables.size() << " variables on placement "
+              << pair.first.parallel_conf().DebugString();
+  }
+  for (const auto& pair : consumer_op_name2conf) { builder->MutOpsOnlyOnce({pair.second}); }
+  LOG(INFO) << "zero shards " << sharded_bytes << " bytes of variables across data parallel ranks";
+  return Maybe<void>::Ok();
+}
+
 class OptimizerPlacementOptimizationPass final : public JobPass {
  public:
   OF_DISALLOW_COPY_AND_MOVE(OptimizerPlacementOptimizationPass);
@@ -325,6 +451,8 @@ class OptimizerPlacementOptimizationPass final : public JobPass {
       return RewriteNonDistributed(op_graph, &job_builder);
     } else if (mode == "distributed_split") {
       return RewriteDistributedSplit(op_graph, &job_builder);
+    } else if (mode == "zero") {
+      return RewriteZero(op_graph, &job_builder);
     } else {
       return Error::Unimplemented();
     }
@@ -219,6 +219,42 @@ void TryInsertOrUseBufferOpBothSrcDst(
   }
 }
 
+// Under 1F1B a stage starts the backward of a micro batch as soon as it has run the forward of as
+// many micro batches as there are stages after it. Bounding the activation buffers between the
+// forward and backward ops of a stage to that number makes actors alternate forward and backward
+// through the regst protocol. Virtual stages that share devices get their own bound, so their
+// micro batches interleave on the devices.
+int64_t InFlightMicroBatchNum4Stage(int64_t total_stage_num, int64_t stage_id) {
+  return std::max<int64_t>(total_stage_num - stage_id, 1);
+}
+
+void LogOneForwardOneBackwardSchedule(const OpGraph& op_graph, int64_t total_stage_num) {
+  HashMap<int64_t, HashSet<ParallelDesc>> stage_id2parallel_descs;
+  HashSet<ParallelDesc> device_parallel_descs;
+  op_graph.ForEachNode([&](const OpNode* node) {
+    if (!OpNodeHasScope(node) || node->parallel_desc().device_type() == DeviceType::kCPU) {
+      return;
+    }
+    stage_id2parallel_descs[GetStageIdHint(node)].insert(node->parallel_desc());
+    device_parallel_descs.insert(node->parallel_desc());
+  });
+  const int64_t micro_batch_num = GlobalJobDesc().job_conf().num_gradient_accumulation_steps();
+  const int64_t device_stage_num = std::max<int64_t>(device_parallel_descs.size(), 1);
+  const int64_t virtual_stage_num = std::max<int64_t>(total_stage_num / device_stage_num, 1);
+  // each device idles for (p - 1) stage slots of (v * m + p - 1) during one step
+  const double bubble_ratio = static_cast<double>(device_stage_num - 1)
+                              / (virtual_stage_num * micro_batch_num + device_stage_num - 1);
+  LOG(INFO) << "1f1b pipeline schedule: " << device_stage_num << " device stages, "
+            << virtual_stage_num << " virtual stages per device, " << micro_batch_num
+            << " micro batches, estimated idle ratio " << bubble_ratio;
+  FOR_RANGE(int64_t, stage_id, 0, total_stage_num) {
+    LOG(INFO) << "stage " << stage_id << " keeps at most "
+              << InFlightMicroBatchNum4Stage(total_stage_num, stage_id)
+              << " micro batches in flight on " << stage_id2parallel_descs[stage_id].size()
+              << " placements";
+  }
+}
+
 Maybe<void> PipelineBufferPass::Apply(const OpGraph& op_graph, JobBuilder* job_builder) const {
   if (GlobalJobDesc().job_conf().num_gradient_accumulation_steps() <= 1) {
     return Maybe<void>::Ok();
@@ -236,6 +272,11 @@ Maybe<void> PipelineBufferPass::Apply(const OpGraph& op_graph, JobBuilder* job_b
   if (max_stage_id == 0) { return Maybe<void>::Ok(); }
   const int64_t total_stage_num = max_stage_id + 1;
   LOG(INFO) << "total stage num = " << total_stage_num;
+  const std::string& schedule = GlobalJobDesc().job_conf().pipeline_schedule();
+  CHECK_OR_RETURN(schedule == "gpipe" || schedule == "1f1b")
+      << "unknown pipeline schedule " << schedule;
+  const bool is_1f1b = schedule == "1f1b";
+  if (is_1f1b) { LogOneForwardOneBackwardSchedule(op_graph, total_stage_num); }
 
   HashMap<std::string, OperatorConf> buffer_op_name2op_conf;
   HashMap<std::string, ParallelConf> buffer_op_name2parallel_conf;
@@ -260,7 +301,10 @@ Maybe<void> PipelineBufferPass::Apply(const OpGraph& op_graph, JobBuilder* job_b
                        << this_node->op().op_conf().DebugString()
                        << "](stage_id:" << std::to_string(dst_stage_id) << ")\n";
         }
-        const int64_t buffer_size = total_stage_num * 2; /* NOTE(chengcheng): max buffer size */
+        /* NOTE(chengcheng): max buffer size */
+        const int64_t buffer_size =
+            is_1f1b ? InFlightMicroBatchNum4Stage(total_stage_num, dst_stage_id)
+                    : total_stage_num * 2;
         TryInsertOrUseBufferOpToDstNode(in_edge, buffer_size, &buffer_op_name2op_conf,
                                         &buffer_op_name2parallel_conf, &mut_op_name2conf);
       }
@@ -0,0 +1,162 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/job_rewriter/job_pass.h"
+#include "oneflow/core/framework/framework.h"
+
+namespace oneflow {
+
+namespace {
+
+const std::string kSequenceParallelOpNamePrefix = "System-SequenceParallel-";
+
+// The input an op of a sequence parallel region is split by.
+const HashMap<std::string, std::string>& RegionOpType2Input() {
+  static const HashMap<std::string, std::string> op_type2input = {{"layer_norm", "x"},
+                                                                  {"dropout", "in"}};
+  return op_type2input;
+}
+
+bool IsBroadcast(const cfg::ParallelDistribution& parallel_distribution) {
+  for (const auto& sbp : parallel_distribution.sbp_parallel()) {
+    if (!sbp.has_broadcast_parallel()) { return false; }
+  }
+  return true;
+}
+
+bool CanSplitBySequence(const OpNode* op_node, const std::string& lbn, int64_t seq_axis) {
+  const Shape& shape = op_node->LogicalBlobDesc4Lbi(GenLogicalBlobId(lbn)).shape();
+  if (seq_axis >= shape.NumAxes()) { return false; }
+  if (shape.At(seq_axis) % op_node->parallel_desc().parallel_num() != 0) { return false; }
+  const user_op::UserOpConfWrapper conf(op_node->op().op_conf());
+  if (conf.op_type_name() == "layer_norm") {
+    // only the axes in front of the normalized ones can be split
+    for (const std::string& attr : {"begin_norm_axis", "begin_params_axis"}) {
+      int64_t axis = conf.attr<int64_t>(attr);
+      if (axis < 0) { axis += shape.NumAxes(); }
+      if (seq_axis >= axis) { return false; }
+    }
+  }
+  return true;
+}
+
+// Runs the layer_norm and dropout ops of a tensor parallel job on S(seq_axis) instead of B, so
+// that each rank keeps only its share of their activations. A parallel_cast pins the input of
+// such an op to the split; the boxing from the P output of a row parallel matmul then becomes a
+// reduce-scatter and the one to the B input of the next column parallel matmul an all-gather,
+// which together move as much data as the all-reduce they replace. It runs before the backward
+// is generated, so the grads of these ops are split as well.
+class SequenceParallelPass final : public JobPass {
+ public:
+  SequenceParallelPass() = default;
+  ~SequenceParallelPass() override = default;
+
+  bool IsEnabled(const JobPassCtx& ctx) const {
+    return ctx.job_desc().job_conf().enable_sequence_parallel();
+  }
+  Maybe<void> Apply(const OpGraph& op_graph, JobBuilder* job_builder) const;
+
+  Maybe<void> Apply(Job* job, JobPassCtx* ctx) const override {
+    if (!IsEnabled(*ctx)) { return Maybe<void>::Ok(); }
+    const OpGraph op_graph(*job);
+    JobBuilder job_builder(job);
+    return Apply(op_graph, &job_builder);
+  }
+};
+
+Maybe<void> SequenceParallelPass::Apply(const OpGraph& op_graph, JobBuilder* job_builder) const {
+  const int64_t seq_axis = GlobalJobDesc().job_conf().sequence_parallel_axis();
+  CHECK_GE_OR_RETURN(seq_axis, 0);
+  const std::string split_str = "S(" + std::to_string(seq_axis) + ")";
+  const auto& op_type2input = RegionOpType2Input();
+  HashMap<std::string, OperatorConf> op_name2new_conf;
+  auto MutOpConf = [&](const OpNode* op_node) -> OperatorConf* {
+    auto it = op_name2new_conf.find(op_node->op().op_name());
+    if (it == op_name2new_conf.end()) {
+      it = op_name2new_conf.emplace(op_node->op().op_name(), op_node->op().op_conf()).first;
+    }
+    return &it->second;
+  };
+  HashMap<std::string, std::string> lbn2split_lbn;
+  // placement_node is the op whose placement and scope the parallel_cast is built with
+  auto SplitBySequence = [&](const std::string& lbn,
+                             const OpNode* placement_node) -> Maybe<std::string> {
+    const auto it = lbn2split_lbn.find(lbn);
+    if (it != lbn2split_lbn.end()) { return it->second; }
+    const LogicalBlobId lbi = GenLogicalBlobId(lbn);
+    user_op::UserOpConfWrapperBuilder builder(kSequenceParallelOpNamePrefix + lbi.op_name() + "-"
+                                              + lbi.blob_name());
+    builder.Op("parallel_cast")
+        .Input("in", lbn)
+        .Output("out")
+        .Attr<std::string>("sbp_parallel", split_str);
+    const OperatorConf& placement_op_conf = placement_node->op().op_conf();
+    if (placement_op_conf.has_scope_symbol_id()) {
+      builder.ScopeSymbolId(placement_op_conf.scope_symbol_id());
+    }
+    const auto cast_op = builder.Build();
+    JUST(job_builder->AddOp(placement_node->parallel_desc().parallel_conf(), cast_op.op_conf()));
+    const std::string split_lbn = cast_op.output("out", 0);
+    lbn2split_lbn.emplace(lbn, split_lbn);
+    return split_lbn;
+  };
+
+  JUST(op_graph.MaybeForEachNode([&](OpNode* op_node) -> Maybe<void> {
+    const OperatorConf& op_conf = op_node->op().op_conf();
+    if (!op_conf.has_user_conf()) { return Maybe<void>::Ok(); }
+    const auto input_it = op_type2input.find(op_conf.user_conf().op_type_name());
+    if (input_it == op_type2input.end()) { return Maybe<void>::Ok(); }
+    const ParallelDesc& parallel_desc = op_node->parallel_desc();
+    if (parallel_desc.device_type() != DeviceType::kGPU || parallel_desc.parallel_num() <= 1
+        || parallel_desc.hierarchy()->NumAxes() != 1) {
+      return Maybe<void>::Ok();
+    }
+    const user_op::UserOpConfWrapper conf(op_conf);
+    const std::string& in_lbn = conf.input(input_it->second, 0);
+    // a job that is data parallel here already splits the activations
+    if (!IsBroadcast(op_node->ParallelDistribution4Lbi(GenLogicalBlobId(in_lbn)))) {
+      return Maybe<void>::Ok();
+    }
+    if (!CanSplitBySequence(op_node, in_lbn, seq_axis)) { return Maybe<void>::Ok(); }
+    const std::string split_lbn = *JUST(SplitBySequence(in_lbn, op_node));
+    ReplaceInputLbnInOpCustomizedConf(MutOpConf(op_node), GenRepeatedBn(input_it->second, 0),
+                                      split_lbn);
+    if (conf.op_type_name() == "dropout") {
+      // draw the mask of the local share only
+      const OpNode* mask_node =
+          op_graph.OpNode4OpName(GenLogicalBlobId(conf.input("mask", 0)).op_name());
+      const OperatorConf& mask_op_conf = mask_node->op().op_conf();
+      if (mask_op_conf.has_user_conf()
+          && mask_op_conf.user_conf().op_type_name() == "random_mask_like"
+          && user_op::UserOpConfWrapper(mask_op_conf).input("like", 0) == in_lbn
+          && mask_node->parallel_desc() == parallel_desc) {
+        ReplaceInputLbnInOpCustomizedConf(MutOpConf(mask_node), GenRepeatedBn("like", 0),
+                                          split_lbn);
+      }
+    }
+    return Maybe<void>::Ok();
+  }));
+
+  std::vector<OperatorConf> new_op_confs;
+  for (const auto& pair : op_name2new_conf) { new_op_confs.push_back(pair.second); }
+  job_builder->MutOpsOnlyOnce(new_op_confs);
+  return Maybe<void>::Ok();
+}
+
+}  // namespace
+
+REGISTER_JOB_PASS("SequenceParallelPass", SequenceParallelPass);
+
+}  // namespace oneflow
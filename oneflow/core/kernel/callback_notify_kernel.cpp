@@ -20,6 +20,13 @@ limitations under the License.
 
 namespace oneflow {
 
+template<typename T>
+void CallbackNotifyKernel<T>::VirtualKernelInit() {
+  iteration_histogram_ = profiler::GetHistogram(
+      "oneflow_job_iteration_seconds", "time between two iterations of a lazy job",
+      profiler::DefaultSecondsBuckets(), {{"job", this->job_desc().job_name()}});
+}
+
 template<typename T>
 void CallbackNotifyKernel<T>::ForwardDataContent(
     const KernelCtx& ctx, std::function<Blob*(const std::string&)> BnInOp2Blob) const {
@@ -35,6 +42,9 @@ void CallbackNotifyKernel<T>::ForwardDataContent(
   BufferStatus buffer_status = buffer_mgr->Get(buffer_name)->TryReceive(&foreign_job_instance);
   CHECK_NE(buffer_status, kBufferStatusEmpty);
   if (buffer_status == kBufferStatusSuccess) { foreign_job_instance->Finish(); }
+  const double now = GetCurTime();
+  if (last_notify_time_ > 0) { iteration_histogram_->Observe((now - last_notify_time_) / 1e9); }
+  last_notify_time_ = now;
 }
 
 ADD_CPU_DEFAULT_KERNEL_CREATOR(OperatorConf::kCallbackNotifyConf, CallbackNotifyKernel,
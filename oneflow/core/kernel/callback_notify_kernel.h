@@ -18,6 +18,7 @@ limitations under the License.
 
 #include "oneflow/core/kernel/kernel.h"
 #include "oneflow/core/common/buffer_manager.h"
+#include "oneflow/core/profiler/metrics.h"
 
 namespace oneflow {
 
@@ -25,13 +26,18 @@ template<typename T>
 class CallbackNotifyKernel final : public KernelIf<DeviceType::kCPU> {
  public:
   OF_DISALLOW_COPY_AND_MOVE(CallbackNotifyKernel);
-  CallbackNotifyKernel() = default;
+  CallbackNotifyKernel() : iteration_histogram_(nullptr), last_notify_time_(0) {}
   ~CallbackNotifyKernel() = default;
 
  private:
   bool IsStateless() const override { return false; }
+  void VirtualKernelInit() override;
   void ForwardDataContent(const KernelCtx& ctx,
                           std::function<Blob*(const std::string&)> BnInOp2Blob) const override;
+
+  // seconds between two notifications, i.e. the iteration time of the job
+  profiler::Histogram* iteration_histogram_;
+  mutable double last_notify_time_;
 };
 
 }  // namespace oneflow
@@ -0,0 +1,153 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/kernel/cuda_graph_support.h"
+#include "oneflow/core/framework/op_kernel.h"
+
+namespace oneflow {
+
+namespace {
+
+bool IsCudaGraphEnabled() {
+  static const bool is_enabled = ParseBooleanFromEnv("ONEFLOW_KERNEL_ENABLE_CUDA_GRAPH", false);
+  return is_enabled;
+}
+
+#ifdef WITH_CUDA_GRAPHS
+
+size_t CudaGraphCacheMaxSize() {
+  static const size_t max_size = ParseIntegerFromEnv("ONEFLOW_KERNEL_CUDA_GRAPH_CACHE_SIZE", 16);
+  return max_size;
+}
+
+void UpdateCudaGraphKey(user_op::KernelComputeContext* ctx, CudaGraphKey* key) {
+  key->dptrs.clear();
+  key->dims.clear();
+  const auto AppendTensor = [&](const user_op::Tensor* tensor) {
+    key->dptrs.push_back(tensor->raw_dptr());
+    const ShapeView& shape = tensor->shape();
+    key->dims.push_back(shape.NumAxes());
+    for (int64_t i = 0; i < shape.NumAxes(); ++i) { key->dims.push_back(shape.At(i)); }
+  };
+  for (const auto& pair : ctx->inputs()) {
+    AppendTensor(ctx->Tensor4ArgNameAndIndex(pair.first, pair.second));
+  }
+  for (const auto& pair : ctx->outputs()) {
+    AppendTensor(ctx->Tensor4ArgNameAndIndex(pair.first, pair.second));
+  }
+  const user_op::Tensor* tmp_buffer = ctx->Tensor4ArgNameAndIndex("tmp_buffer", 0);
+  if (tmp_buffer != nullptr) { AppendTensor(tmp_buffer); }
+}
+
+#endif  // WITH_CUDA_GRAPHS
+
+}  // namespace
+
+#ifdef WITH_CUDA_GRAPHS
+
+CudaGraphExecutable::CudaGraphExecutable() : graph_exec_(nullptr), dev_(-1) {}
+
+CudaGraphExecutable::~CudaGraphExecutable() { Reset(); }
+
+void CudaGraphExecutable::Update(cudaGraph_t graph) {
+  int dev = -1;
+  OF_CUDA_CHECK(cudaGetDevice(&dev));
+  if (dev != dev_) { Reset(); }
+  dev_ = dev;
+  if (graph_exec_ != nullptr) {
+#if CUDA_VERSION < 12000
+    cudaGraphExecUpdateResult update_result{};
+    cudaGraphNode_t error_node = nullptr;
+    OF_CUDA_CHECK(cudaGraphExecUpdate(graph_exec_, graph, &error_node, &update_result));
+    if (update_result == cudaGraphExecUpdateSuccess) { return; }
+#else
+    cudaGraphExecUpdateResultInfo update_result{};
+    OF_CUDA_CHECK(cudaGraphExecUpdate(graph_exec_, graph, &update_result));
+    if (update_result.result == cudaGraphExecUpdateSuccess) { return; }
+#endif  // CUDA_VERSION < 12000
+  }
+  Reset();
+#if CUDA_VERSION < 12000
+  OF_CUDA_CHECK(cudaGraphInstantiate(&graph_exec_, graph, nullptr, nullptr, 0));
+#else
+  OF_CUDA_CHECK(cudaGraphInstantiate(&graph_exec_, graph, 0));
+#endif  // CUDA_VERSION < 12000
+}
+
+void CudaGraphExecutable::Launch(cudaStream_t stream) const {
+  OF_CUDA_CHECK(cudaGraphLaunch(graph_exec_, stream));
+}
+
+void CudaGraphExecutable::Reset() {
+  if (graph_exec_ == nullptr) { return; }
+  CudaCurrentDeviceGuard guard(dev_);
+  OF_CUDA_CHECK(cudaGraphExecDestroy(graph_exec_));
+  graph_exec_ = nullptr;
+}
+
+CudaGraphKernelLauncher::CudaGraphKernelLauncher() : key2graph_exec_(CudaGraphCacheMaxSize()) {}
+
+/* static */ bool CudaGraphKernelLauncher::IsEnabled(const user_op::OpKernel* kernel) {
+  return IsCudaGraphEnabled() && dynamic_cast<const user_op::CudaGraphSupport*>(kernel) != nullptr;
+}
+
+void CudaGraphKernelLauncher::Compute(const user_op::OpKernel* kernel,
+                                      user_op::KernelComputeContext* ctx,
+                                      user_op::OpKernelState* state) {
+  const auto* cuda_graph_support = dynamic_cast<const user_op::CudaGraphSupport*>(kernel);
+  CHECK_NOTNULL(cuda_graph_support);
+  if (!cuda_graph_support->IsCudaGraphSupported(ctx, state)) {
+    kernel->Compute(ctx, state);
+    return;
+  }
+  UpdateCudaGraphKey(ctx, &key_);
+  const auto* graph_exec = key2graph_exec_.Find(key_);
+  if (graph_exec == nullptr) {
+    kernel->Compute(ctx, state);
+    key2graph_exec_.Insert(key_, std::shared_ptr<CudaGraphExecutable>());
+    return;
+  }
+  cudaStream_t cuda_stream = ctx->device_ctx()->cuda_stream();
+  if (!*graph_exec) {
+    OF_CUDA_CHECK(cudaStreamBeginCapture(cuda_stream, cudaStreamCaptureModeThreadLocal));
+    kernel->Compute(ctx, state);
+    cudaGraph_t graph = nullptr;
+    OF_CUDA_CHECK(cudaStreamEndCapture(cuda_stream, &graph));
+    auto new_graph_exec = std::make_shared<CudaGraphExecutable>();
+    new_graph_exec->Update(graph);
+    OF_CUDA_CHECK(cudaGraphDestroy(graph));
+    graph_exec = key2graph_exec_.Insert(key_, new_graph_exec);
+  }
+  (*graph_exec)->Launch(cuda_stream);
+}
+
+#else
+
+CudaGraphKernelLauncher::CudaGraphKernelLauncher() = default;
+
+/* static */ bool CudaGraphKernelLauncher::IsEnabled(const user_op::OpKernel* kernel) {
+  if (IsCudaGraphEnabled()) { LOG(WARNING) << "CUDA graphs require CUDA 10.2 or higher"; }
+  return false;
+}
+
+void CudaGraphKernelLauncher::Compute(const user_op::OpKernel* kernel,
+                                      user_op::KernelComputeContext* ctx,
+                                      user_op::OpKernelState* state) {
+  kernel->Compute(ctx, state);
+}
+
+#endif  // WITH_CUDA_GRAPHS
+
+}  // namespace oneflow
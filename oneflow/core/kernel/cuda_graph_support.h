@@ -0,0 +1,130 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_KERNEL_CUDA_GRAPH_SUPPORT_H_
+#define ONEFLOW_CORE_KERNEL_CUDA_GRAPH_SUPPORT_H_
+
+#include "oneflow/core/common/util.h"
+#include "oneflow/core/common/lru_cache.h"
+#include "oneflow/core/device/cuda_util.h"
+
+#if defined(WITH_CUDA) && CUDA_VERSION >= 10020
+#define WITH_CUDA_GRAPHS
+#endif
+
+namespace oneflow {
+
+namespace user_op {
+
+class OpKernel;
+class OpKernelState;
+class KernelComputeContext;
+
+// OpKernels inheriting CudaGraphSupport promise that Compute only enqueues device work on
+// ctx->device_ctx()->cuda_stream(): no host synchronization, no host reads of device memory and no
+// memory allocation. Such a Compute can be captured into a CUDA graph once and replayed as long
+// as the blob addresses and shapes stay the same.
+class CudaGraphSupport {
+ public:
+  CudaGraphSupport() = default;
+  virtual ~CudaGraphSupport() = default;
+
+  virtual bool IsCudaGraphSupported(KernelComputeContext* ctx, OpKernelState* state) const {
+    return true;
+  }
+};
+
+}  // namespace user_op
+
+#ifdef WITH_CUDA_GRAPHS
+
+class CudaGraphExecutable final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(CudaGraphExecutable);
+  CudaGraphExecutable();
+  ~CudaGraphExecutable();
+
+  void Update(cudaGraph_t graph);
+  void Launch(cudaStream_t stream) const;
+  bool IsInstantiated() const { return graph_exec_ != nullptr; }
+
+ private:
+  void Reset();
+
+  cudaGraphExec_t graph_exec_;
+  int dev_;
+};
+
+// The identity of one captured Compute: the addresses and shapes of all the blobs it touches.
+struct CudaGraphKey final {
+  std::vector<const void*> dptrs;
+  std::vector<int64_t> dims;
+
+  bool operator==(const CudaGraphKey& rhs) const {
+    return dptrs == rhs.dptrs && dims == rhs.dims;
+  }
+};
+
+#endif  // WITH_CUDA_GRAPHS
+
+}  // namespace oneflow
+
+#ifdef WITH_CUDA_GRAPHS
+
+namespace std {
+
+template<>
+struct hash<oneflow::CudaGraphKey> final {
+  size_t operator()(const oneflow::CudaGraphKey& key) const {
+    size_t hash_value = key.dptrs.size();
+    for (const void* dptr : key.dptrs) {
+      oneflow::HashCombine(&hash_value, std::hash<const void*>()(dptr));
+    }
+    for (int64_t dim : key.dims) { oneflow::HashCombine(&hash_value, std::hash<int64_t>()(dim)); }
+    return hash_value;
+  }
+};
+
+}  // namespace std
+
+#endif  // WITH_CUDA_GRAPHS
+
+namespace oneflow {
+
+// Launches the Compute of one CudaGraphSupport kernel through CUDA graphs. The first Compute of a
+// key runs normally so that lazy initializations inside Compute are not captured, the second one
+// is captured and every later one replays the captured graph.
+class CudaGraphKernelLauncher final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(CudaGraphKernelLauncher);
+  CudaGraphKernelLauncher();
+  ~CudaGraphKernelLauncher() = default;
+
+  // true if ONEFLOW_KERNEL_ENABLE_CUDA_GRAPH is set and `kernel' inherits CudaGraphSupport
+  static bool IsEnabled(const user_op::OpKernel* kernel);
+
+  void Compute(const user_op::OpKernel* kernel, user_op::KernelComputeContext* ctx,
+               user_op::OpKernelState* state);
+
+#ifdef WITH_CUDA_GRAPHS
+ private:
+  CudaGraphKey key_;
+  LruCache<CudaGraphKey, std::shared_ptr<CudaGraphExecutable>> key2graph_exec_;
+#endif  // WITH_CUDA_GRAPHS
+};
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_KERNEL_CUDA_GRAPH_SUPPORT_H_
@@ -34,7 +34,7 @@ void DynamicReshapeKernel<device_type>::ForwardDataContent(
     const KernelCtx& ctx, std::function<Blob*(const std::string&)> BnInOp2Blob) const {
   const Blob* in_blob = BnInOp2Blob("in");
   Blob* out_blob = BnInOp2Blob("out");
-  out_blob->CopyDataContentFrom(ctx.device_ctx, in_blob);
+  out_blob->CopyValidDataContentFrom(ctx.device_ctx, in_blob);
 }
 
 ADD_DEVICE_TYPE_KERNEL_CREATOR(OperatorConf::kDynamicReshapeConf, DynamicReshapeKernel);
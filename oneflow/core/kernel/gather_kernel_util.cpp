@@ -76,11 +76,15 @@ void GatherKernelUtilImpl<DeviceType::kCPU, T, K>::Forward(DeviceCtx* ctx, const
   const int64_t outer_dim_size = flat_in_shape.At(0);
   const int64_t gather_dim_size = flat_in_shape.At(1);
   const int64_t inner_dim_size = flat_in_shape.At(2);
-  FOR_RANGE(int64_t, outer_idx, 0, outer_dim_size) {
-    FOR_RANGE(int64_t, i, 0, num_indices) {
+  // each (outer_idx, i) pair copies one independent row of inner_dim_size elements
+  const int64_t num_rows = outer_dim_size * num_indices;
+  ctx->ParallelFor(num_rows, ParallelForGrainSize(inner_dim_size), [&](int64_t begin, int64_t end) {
+    FOR_RANGE(int64_t, row, begin, end) {
+      const int64_t outer_idx = row / num_indices;
+      const int64_t i = row % num_indices;
       CHECK_GE(indices[i], 0);
       const int64_t idx = indices[i] - offset;
-      T* to = out + outer_idx * num_indices * inner_dim_size + i * inner_dim_size;
+      T* to = out + row * inner_dim_size;
       if (idx >= 0 && idx < gather_dim_size) {
         const T* from = in + outer_idx * gather_dim_size * inner_dim_size + idx * inner_dim_size;
         std::copy(from, from + inner_dim_size, to);
@@ -88,7 +92,7 @@ void GatherKernelUtilImpl<DeviceType::kCPU, T, K>::Forward(DeviceCtx* ctx, const
         std::memset(to, 0, inner_dim_size * sizeof(K));
       }
     }
-  }
+  });
 }
 
 #define INITIATE_GATHER_KERNEL_UTIL_CPU_IMPL(in_type_pair, index_type_pair)              \
@@ -15,6 +15,7 @@ limitations under the License.
 */
 #include "oneflow/core/kernel/gather_kernel_util.h"
 #include "oneflow/core/kernel/kernel.h"
+#include "oneflow/core/cuda/elementwise.cuh"
 #include <assert.h>
 
 namespace oneflow {
@@ -44,6 +45,8 @@ __device__ IDX GetInOffset(const IDX out_offset, const K* indices, const IDX num
   }
 }
 
+// T is a pack of elements here and the inner dim is counted in packs, out of range indices give
+// zero-initialized packs.
 template<typename T, typename K, typename IDX>
 __global__ void GatherForwardGpu(const IDX elem_cnt, const K* indices, const IDX num_indices,
                                  const T* in, const IDX gather_dim_size, const IDX inner_dim_size,
@@ -52,13 +55,84 @@ __global__ void GatherForwardGpu(const IDX elem_cnt, const K* indices, const IDX
     const IDX in_offset =
         GetInOffset<K, IDX>(i, indices, num_indices, gather_dim_size, inner_dim_size, offset);
     if (in_offset < 0) {
-      out[i] = 0;
+      out[i] = T();
     } else {
       out[i] = in[in_offset];
     }
   }
 }
 
+// One warp per row of out, which reads its index once and copies the contiguous row.
+template<typename T, typename K, typename IDX>
+__global__ void GatherRowForwardGpu(const IDX num_rows, const K* indices, const IDX num_indices,
+                                    const T* in, const IDX gather_dim_size,
+                                    const IDX inner_dim_size, T* out, const IDX offset) {
+  const IDX global_warp_id = (blockIdx.x * blockDim.x + threadIdx.x) / kCudaWarpSize;
+  const IDX num_warps = gridDim.x * blockDim.x / kCudaWarpSize;
+  const IDX lane_id = threadIdx.x % kCudaWarpSize;
+  for (IDX row = global_warp_id; row < num_rows; row += num_warps) {
+    const IDX outer_idx = row / num_indices;
+    const IDX indices_idx = row - outer_idx * num_indices;
+    assert(indices[indices_idx] >= 0);
+    const IDX idx = indices[indices_idx] - offset;
+    T* out_row = out + row * inner_dim_size;
+    if (idx >= 0 && idx < gather_dim_size) {
+      const T* in_row = in + (outer_idx * gather_dim_size + idx) * inner_dim_size;
+      for (IDX i = lane_id; i < inner_dim_size; i += kCudaWarpSize) { out_row[i] = in_row[i]; }
+    } else {
+      for (IDX i = lane_id; i < inner_dim_size; i += kCudaWarpSize) { out_row[i] = T(); }
+    }
+  }
+}
+
+template<typename T, typename K, typename IDX, int pack_size>
+void LaunchGatherForward(DeviceCtx* ctx, const K* indices, int64_t num_indices, const T* in,
+                         const Shape& flat_in_shape, T* out, const int64_t offset) {
+  using P = cuda::elementwise::PackType<T, pack_size>;
+  const P* in_pack = reinterpret_cast<const P*>(in);
+  P* out_pack = reinterpret_cast<P*>(out);
+  const int64_t inner_dim_size = flat_in_shape.At(2) / pack_size;
+  const int64_t num_rows = flat_in_shape.At(0) * num_indices;
+  if (inner_dim_size >= kCudaWarpSize) {
+    GatherRowForwardGpu<P, K, IDX>
+        <<<BlocksNum4Warps(num_rows), kCudaThreadsNumPerBlock, 0, ctx->cuda_stream()>>>(
+            num_rows, indices, num_indices, in_pack, flat_in_shape.At(1), inner_dim_size,
+            out_pack, offset);
+  } else {
+    const int64_t out_elem_cnt = num_rows * inner_dim_size;
+    GatherForwardGpu<P, K, IDX>
+        <<<BlocksNum4ThreadsNum(out_elem_cnt), kCudaThreadsNumPerBlock, 0, ctx->cuda_stream()>>>(
+            out_elem_cnt, indices, num_indices, in_pack, flat_in_shape.At(1), inner_dim_size,
+            out_pack, offset);
+  }
+}
+
+// Uses the widest pack up to 16 bytes that divides the rows and matches the alignment of in and
+// out, so that wide rows such as embeddings are copied with vectorized loads and stores.
+template<typename T, typename K, typename IDX, int pack_size>
+struct GatherForwardPackDispatcher final {
+  static void Launch(DeviceCtx* ctx, const K* indices, int64_t num_indices, const T* in,
+                     const Shape& flat_in_shape, T* out, const int64_t offset) {
+    const size_t pack_bytes = pack_size * sizeof(T);
+    if (flat_in_shape.At(2) % pack_size == 0 && reinterpret_cast<uintptr_t>(in) % pack_bytes == 0
+        && reinterpret_cast<uintptr_t>(out) % pack_bytes == 0) {
+      LaunchGatherForward<T, K, IDX, pack_size>(ctx, indices, num_indices, in, flat_in_shape, out,
+                                                offset);
+    } else {
+      GatherForwardPackDispatcher<T, K, IDX, pack_size / 2>::Launch(ctx, indices, num_indices, in,
+                                                                    flat_in_shape, out, offset);
+    }
+  }
+};
+
+template<typename T, typename K, typename IDX>
+struct GatherForwardPackDispatcher<T, K, IDX, 1> final {
+  static void Launch(DeviceCtx* ctx, const K* indices, int64_t num_indices, const T* in,
+                     const Shape& flat_in_shape, T* out, const int64_t offset) {
+    LaunchGatherForward<T, K, IDX, 1>(ctx, indices, num_indices, in, flat_in_shape, out, offset);
+  }
+};
+
 bool IsSafeUseIndex32(const Shape& flat_in_shape, const int64_t num_indices) {
   const int64_t in_elem_cnt = flat_in_shape.elem_cnt();
   const int64_t out_elem_cnt = flat_in_shape.At(0) * num_indices * flat_in_shape.At(2);
@@ -71,17 +145,13 @@ template<typename T, typename K>
 struct GatherKernelUtilImpl<DeviceType::kGPU, T, K> final {
   static void Forward(DeviceCtx* ctx, const K* indices, int64_t num_indices, const T* in,
                       const Shape& flat_in_shape, T* out, const int64_t offset) {
-    const int64_t out_elem_cnt = flat_in_shape.At(0) * num_indices * flat_in_shape.At(2);
+    constexpr int max_pack_size = cuda::elementwise::PackSize<T>();
     if (IsSafeUseIndex32(flat_in_shape, num_indices)) {
-      GatherForwardGpu<T, K, int32_t>
-          <<<BlocksNum4ThreadsNum(out_elem_cnt), kCudaThreadsNumPerBlock, 0, ctx->cuda_stream()>>>(
-              out_elem_cnt, indices, num_indices, in, flat_in_shape.At(1), flat_in_shape.At(2), out,
-              offset);
+      GatherForwardPackDispatcher<T, K, int32_t, max_pack_size>::Launch(
+          ctx, indices, num_indices, in, flat_in_shape, out, offset);
     } else {
-      GatherForwardGpu<T, K, int64_t>
-          <<<BlocksNum4ThreadsNum(out_elem_cnt), kCudaThreadsNumPerBlock, 0, ctx->cuda_stream()>>>(
-              out_elem_cnt, indices, num_indices, in, flat_in_shape.At(1), flat_in_shape.At(2), out,
-              offset);
+      GatherForwardPackDispatcher<T, K, int64_t, max_pack_size>::Launch(
+          ctx, indices, num_indices, in, flat_in_shape, out, offset);
     }
   }
 };
@@ -18,6 +18,7 @@ limitations under the License.
 #include "oneflow/core/kernel/runtime_blob_shape_infer_helper.h"
 #include "oneflow/core/profiler/profiler.h"
 #include "oneflow/core/profiler/kernel.h"
+#include "oneflow/core/profiler/kernel_timing.h"
 
 namespace oneflow {
 
@@ -40,6 +41,20 @@ void Kernel::Init(const JobDesc* job_desc, const KernelConf& kernel_conf, Device
 
 void Kernel::Launch(const KernelCtx& ctx,
                     std::function<Blob*(const std::string&)> BnInOp2Blob) const {
+  const auto BytesTouched = [&]() {
+    int64_t bytes = 0;
+    for (const auto& bn : op_attribute().input_bns()) {
+      const Blob* blob = BnInOp2Blob(bn);
+      if (blob != nullptr) { bytes += blob->ByteSizeOfBlobBody(); }
+    }
+    for (const auto& bn : op_attribute().output_bns()) {
+      const Blob* blob = BnInOp2Blob(bn);
+      if (blob != nullptr) { bytes += blob->ByteSizeOfBlobBody(); }
+    }
+    return bytes;
+  };
+  profiler::KernelTimingGuard timing_guard(op_conf(), ctx.device_ctx, BytesTouched,
+                                           [this]() { return Flops(); });
   Forward(ctx, BnInOp2Blob);
 }
 
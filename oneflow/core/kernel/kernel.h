@@ -52,6 +52,8 @@ class Kernel {
    * 2) all asynchronous task has been queued (e.g. NCCL related kernel)
    */
   virtual bool IsKernelLaunchSynchronized() const { return true; }
+  // floating point operations of a launch reported to the kernel timing, 0 if unknown
+  virtual int64_t Flops() const { return 0; }
 
   void SystemForwardHeader(const KernelCtx& ctx,
                            std::function<Blob*(const std::string&)> BnInOp2Blob) const {
@@ -20,6 +20,7 @@ limitations under the License.
 #include "oneflow/core/kernel/kernel_util.h"
 #include "oneflow/core/kernel/new_kernel_util.h"
 #include "oneflow/core/kernel/kernel_util.cuh"
+#include "oneflow/core/cuda/elementwise.cuh"
 
 namespace oneflow {
 
@@ -626,32 +627,36 @@ KU_INTEGRAL_METHOD Mul(DeviceCtx* ctx, const int64_t n, const T* x, const T* y,
   template struct KernelUtil<DeviceType::kGPU, type_cpp>;
 OF_PP_FOR_EACH_TUPLE(INSTANTIATE_KERNEL_UTIL, ARITHMETIC_DATA_TYPE_SEQ);
 
+namespace {
+
 template<typename T, typename U>
-__global__ void CastOnGpu(const T* in, U* out, int64_t elem_num) {
-  CUDA_1D_KERNEL_LOOP(i, elem_num) { out[i] = static_cast<U>(in[i]); }
-}
+struct CastFunctor {
+  __device__ U operator()(T x) const { return static_cast<U>(x); }
+};
 
 template<>
-__global__ void CastOnGpu<float, half>(const float* in, half* out, int64_t elem_num) {
-  const int64_t elem_num_2 = elem_num / 2;
-  const auto* in_2 = reinterpret_cast<const float2*>(in);
-  auto* out_2 = reinterpret_cast<half2*>(out);
-  CUDA_1D_KERNEL_LOOP(i, elem_num_2) { out_2[i] = __float22half2_rn(in_2[i]); }
-  if (elem_num % 2 == 1 && blockIdx.x == 0 && threadIdx.x == 0) {
-    out[elem_num - 1] = __float2half(in[elem_num - 1]);
-  }
-}
+struct CastFunctor<float, half> {
+  __device__ half operator()(float x) const { return __float2half(x); }
+};
 
 template<>
-__global__ void CastOnGpu<half, float>(const half* in, float* out, int64_t elem_num) {
-  const int64_t elem_num_2 = elem_num / 2;
-  const auto* in_2 = reinterpret_cast<const half2*>(in);
-  auto* out_2 = reinterpret_cast<float2*>(out);
-  CUDA_1D_KERNEL_LOOP(i, elem_num_2) { out_2[i] = __half22float2(in_2[i]); }
-  if (elem_num % 2 == 1 && blockIdx.x == 0 && threadIdx.x == 0) {
-    out[elem_num - 1] = __half2float(in[elem_num - 1]);
-  }
-}
+struct CastFunctor<half, float> {
+  __device__ float operator()(half x) const { return __half2float(x); }
+};
+
+#if CUDA_VERSION >= 11000
+template<>
+struct CastFunctor<float, nv_bfloat16> {
+  __device__ nv_bfloat16 operator()(float x) const { return __float2bfloat16(x); }
+};
+
+template<>
+struct CastFunctor<nv_bfloat16, float> {
+  __device__ float operator()(nv_bfloat16 x) const { return __bfloat162float(x); }
+};
+#endif
+
+}  // namespace
 
 template<typename T, typename U>
 void CopyElemOnGpu(DeviceCtx* ctx, const T* in_dptr, U* out_dptr, int64_t elem_num) {
@@ -659,28 +664,53 @@ void CopyElemOnGpu(DeviceCtx* ctx, const T* in_dptr, U* out_dptr, int64_t elem_n
   if (std::is_same<T, U>::value) {
     Memcpy<DeviceType::kGPU>(ctx, out_dptr, in_dptr, elem_num * sizeof(T));
   } else {
-    CastOnGpu<T, U>
-        <<<BlocksNum4ThreadsNum(elem_num), kCudaThreadsNumPerBlock, 0, ctx->cuda_stream()>>>(
-            in_dptr, out_dptr, elem_num);
+    OF_CUDA_CHECK(cuda::elementwise::Unary(CastFunctor<T, U>(), elem_num, out_dptr, in_dptr,
+                                           ctx->cuda_stream()));
   }
 }
 
 template<>
 void CopyElemOnGpu<float, float16>(DeviceCtx* ctx, const float* in_dptr, float16* out_dptr,
                                    int64_t elem_num) {
-  if (RoundUp(elem_num, 2) == 0) { return; }
-  CastOnGpu<float, half>
-      <<<BlocksNum4ThreadsNum(RoundUp(elem_num, 2) / 2), kCudaThreadsNumPerBlock, 0,
-         ctx->cuda_stream()>>>(in_dptr, reinterpret_cast<half*>(out_dptr), elem_num);
+  if (elem_num == 0) { return; }
+  OF_CUDA_CHECK(cuda::elementwise::Unary(CastFunctor<float, half>(), elem_num,
+                                         reinterpret_cast<half*>(out_dptr), in_dptr,
+                                         ctx->cuda_stream()));
 }
 
 template<>
 void CopyElemOnGpu<float16, float>(DeviceCtx* ctx, const float16* in_dptr, float* out_dptr,
                                    int64_t elem_num) {
-  if (RoundUp(elem_num, 2) == 0) { return; }
-  CastOnGpu<half, float>
-      <<<BlocksNum4ThreadsNum(RoundUp(elem_num, 2) / 2), kCudaThreadsNumPerBlock, 0,
-         ctx->cuda_stream()>>>(reinterpret_cast<const half*>(in_dptr), out_dptr, elem_num);
+  if (elem_num == 0) { return; }
+  OF_CUDA_CHECK(cuda::elementwise::Unary(CastFunctor<half, float>(), elem_num, out_dptr,
+                                         reinterpret_cast<const half*>(in_dptr),
+                                         ctx->cuda_stream()));
+}
+
+template<>
+void CopyElemOnGpu<float, bfloat16>(DeviceCtx* ctx, const float* in_dptr, bfloat16* out_dptr,
+                                    int64_t elem_num) {
+#if CUDA_VERSION >= 11000
+  if (elem_num == 0) { return; }
+  OF_CUDA_CHECK(cuda::elementwise::Unary(CastFunctor<float, nv_bfloat16>(), elem_num,
+                                         reinterpret_cast<nv_bfloat16*>(out_dptr), in_dptr,
+                                         ctx->cuda_stream()));
+#else
+  UNIMPLEMENTED() << "bfloat16 requires CUDA 11 or later";
+#endif
+}
+
+template<>
+void CopyElemOnGpu<bfloat16, float>(DeviceCtx* ctx, const bfloat16* in_dptr, float* out_dptr,
+                                    int64_t elem_num) {
+#if CUDA_VERSION >= 11000
+  if (elem_num == 0) { return; }
+  OF_CUDA_CHECK(cuda::elementwise::Unary(CastFunctor<nv_bfloat16, float>(), elem_num, out_dptr,
+                                         reinterpret_cast<const nv_bfloat16*>(in_dptr),
+                                         ctx->cuda_stream()));
+#else
+  UNIMPLEMENTED() << "bfloat16 requires CUDA 11 or later";
+#endif
 }
 
 #define INSTANTIATE_COPY_ELEM_ON_GPU(T, U) \
@@ -19,6 +19,12 @@ limitations under the License.
 #include "oneflow/core/device/cpu_device_context.h"
 #include "oneflow/core/common/nd_index_offset_helper.h"
 #include "oneflow/core/job/parallel_distribution_util.h"
+#include "oneflow/core/persistence/async_snapshot_writer.h"
+#include "oneflow/core/thread/thread_pool.h"
+#include "oneflow/core/common/buffer.h"
+
+#define XXH_NAMESPACE LZ4_
+#include <xxhash.h>
 
 namespace oneflow {
 
@@ -98,6 +104,36 @@ void SyncCopyToHost<DeviceType::kGPU>(DeviceCtx* ctx, const void* src, void* dst
 }
 #endif
 
+template<DeviceType device_type>
+void CopyToHostWithoutSync(DeviceCtx* ctx, const void* src, void* dst, size_t size);
+
+template<>
+void CopyToHostWithoutSync<DeviceType::kCPU>(DeviceCtx* ctx, const void* src, void* dst,
+                                             size_t size) {
+  std::memcpy(dst, src, size);
+}
+
+#ifdef WITH_CUDA
+template<>
+void CopyToHostWithoutSync<DeviceType::kGPU>(DeviceCtx* ctx, const void* src, void* dst,
+                                             size_t size) {
+  OF_CUDA_CHECK(cudaMemcpyAsync(dst, src, size, cudaMemcpyDefault, ctx->cuda_stream()));
+}
+#endif
+
+template<DeviceType device_type>
+void SyncDevice(DeviceCtx* ctx);
+
+template<>
+void SyncDevice<DeviceType::kCPU>(DeviceCtx* ctx) {}
+
+#ifdef WITH_CUDA
+template<>
+void SyncDevice<DeviceType::kGPU>(DeviceCtx* ctx) {
+  OF_CUDA_CHECK(cudaStreamSynchronize(ctx->cuda_stream()));
+}
+#endif
+
 template<DeviceType device_type>
 void SyncCopyToDevice(DeviceCtx* ctx, const void* src, void* dst, size_t size);
 
@@ -134,6 +170,58 @@ std::string GetTmpPartKey(const std::string& base, const ParallelContext& parall
   return GetTmpPartKey(base, parallel_ctx.parallel_id(), parallel_ctx.parallel_num());
 }
 
+// Writes to a temporary file and renames it when `atomic', so readers never see a partial file.
+// Containers are atomic by themselves as their entries show up with the index.
+void WriteSnapshot(SnapshotWriter* writer, const std::string& snapshot_path,
+                   const std::string& key, const Blob* blob, bool atomic) {
+  if (!atomic || writer->IsContainerFormat()) {
+    writer->Write(key, blob);
+    return;
+  }
+  const std::string tmp_key = key + ".writing";
+  writer->WriteFile(tmp_key, blob);
+  SnapshotFS()->RenameFile(JoinPath(snapshot_path, tmp_key), JoinPath(snapshot_path, key));
+}
+
+void WriteSnapshot(SnapshotWriter* writer, const std::string& snapshot_path,
+                   const std::string& key, const std::string& data, bool atomic) {
+  if (!atomic || writer->IsContainerFormat()) {
+    writer->Write(key, data.data(), data.size());
+    return;
+  }
+  const std::string tmp_key = key + ".writing";
+  writer->WriteFile(tmp_key, data.data(), data.size());
+  SnapshotFS()->RenameFile(JoinPath(snapshot_path, tmp_key), JoinPath(snapshot_path, key));
+}
+
+// The rows of a variable changed since the snapshot at base_snapshot_path
+struct VariableDelta {
+  std::string base_snapshot_path;
+  std::vector<int64_t> rows;
+};
+
+// What the last saves of a variable wrote, for finding the rows changed since then
+struct VariableDeltaState {
+  std::vector<uint64_t> row_hashes;
+  std::string last_snapshot_path;
+  int64_t delta_cnt = 0;
+};
+
+void ComputeRowHashes(const char* data, int64_t row_cnt, int64_t row_size,
+                      std::vector<uint64_t>* row_hashes) {
+  row_hashes->resize(row_cnt);
+  const auto HashRows = [&](const Range& range) {
+    FOR_RANGE(int64_t, row, range.begin(), range.end()) {
+      row_hashes->at(row) = LZ4_XXH64(data + row * row_size, row_size, 0);
+    }
+  };
+  if (Global<ThreadPool>::Get() != nullptr) {
+    Global<ThreadPool>::Get()->ParallelFor(Range(0, row_cnt), 4096, HashRows);
+  } else {
+    HashRows(Range(0, row_cnt));
+  }
+}
+
 void HostSliceCopy(Blob* dst, const TensorSliceView& dst_slice, const Blob* src,
                    const TensorSliceView& src_slice) {
   CpuDeviceCtx cpu_device_ctx;
@@ -312,6 +400,11 @@ class ModelLoadV2Kernel final : public KernelIf<device_type> {
     const Blob* path = BnInOp2Blob("path");
     const std::string snapshot_path = SyncReadStringFromBlob<device_type>(ctx.device_ctx, path);
     SnapshotReader reader(snapshot_path);
+    const int64_t thread_num = ParseIntegerFromEnv("ONEFLOW_MODEL_LOAD_THREAD_NUM", 1);
+    if (thread_num > 1) {
+      ParallelLoad(ctx, BnInOp2Blob, reader, thread_num);
+      return;
+    }
     FOR_RANGE(int64_t, i, 0, conf.variable_op_name_size()) {
       Blob* ref = BnInOp2Blob(GenRepeatedBn("ref", i));
       const VariableOpConf& original_variable_conf = conf.original_variable_conf(i);
@@ -322,6 +415,90 @@ class ModelLoadV2Kernel final : public KernelIf<device_type> {
       reader.Read(var_lbn, logical_blob_shape, tensor_slice_views_.at(i), ref_accessor.host_blob());
     }
   }
+
+  // Reads the variables on `thread_num' threads. Slices larger than
+  // ONEFLOW_MODEL_LOAD_CHUNK_BYTES are split by rows into chunks read concurrently, and each
+  // variable is copied to the device as soon as all its chunks are read, while the reads of the
+  // others go on. ONEFLOW_MODEL_LOAD_MAX_PENDING_BYTES bounds the host memory of variables read
+  // but not yet copied.
+  void ParallelLoad(const KernelCtx& ctx, std::function<Blob*(const std::string&)> BnInOp2Blob,
+                    const SnapshotReader& reader, int64_t thread_num) const {
+    const ModelLoadV2OpConf& conf = this->op_conf().model_load_v2_conf();
+    const int64_t chunk_bytes = ParseIntegerFromEnv("ONEFLOW_MODEL_LOAD_CHUNK_BYTES", 64 << 20);
+    const int64_t max_pending_bytes =
+        ParseIntegerFromEnv("ONEFLOW_MODEL_LOAD_MAX_PENDING_BYTES", int64_t(4) << 30);
+    CHECK_GT(chunk_bytes, 0);
+    const int64_t num_var = conf.variable_op_name_size();
+    std::vector<std::unique_ptr<OnDemandHostBlob>> host_blobs(num_var);
+    std::vector<std::unique_ptr<std::atomic<int64_t>>> remaining_chunk_cnts(num_var);
+    Buffer<int64_t> loaded_var_ids(num_var);
+    ThreadPool thread_pool(thread_num);
+    const auto ScheduleVar = [&](int64_t i) {
+      Blob* ref = BnInOp2Blob(GenRepeatedBn("ref", i));
+      char* dst = nullptr;
+      if (device_type == DeviceType::kCPU) {
+        dst = ref->mut_dptr<char>();
+      } else {
+        host_blobs.at(i).reset(new OnDemandHostBlob(ref));
+        dst = host_blobs.at(i)->blob()->mut_dptr<char>();
+      }
+      const VariableOpConf& original_variable_conf = conf.original_variable_conf(i);
+      const Shape logical_blob_shape(original_variable_conf.shape());
+      const DataType data_type = original_variable_conf.data_type();
+      const std::string var_lbn =
+          GenLogicalBlobName(conf.variable_op_name(i), original_variable_conf.out());
+      const TensorSliceView& slice = tensor_slice_views_.at(i);
+      std::vector<TensorSliceView> chunks;
+      std::vector<int64_t> chunk_offsets;
+      if (slice.NumAxes() == 0 || slice.shape().elem_cnt() == 0) {
+        chunks.push_back(slice);
+        chunk_offsets.push_back(0);
+      } else {
+        const int64_t row_bytes = slice.shape().Count(1) * GetSizeOfDataType(data_type);
+        const int64_t rows_per_chunk = std::max<int64_t>(chunk_bytes / row_bytes, 1);
+        std::vector<Range> chunk_ranges = slice.range_vec();
+        for (int64_t row = slice.At(0).begin(); row < slice.At(0).end(); row += rows_per_chunk) {
+          chunk_ranges.at(0) = Range(row, std::min(row + rows_per_chunk, slice.At(0).end()));
+          chunks.emplace_back(chunk_ranges);
+          chunk_offsets.push_back((row - slice.At(0).begin()) * row_bytes);
+        }
+      }
+      remaining_chunk_cnts.at(i).reset(new std::atomic<int64_t>(chunks.size()));
+      FOR_RANGE(int64_t, j, 0, chunks.size()) {
+        const TensorSliceView chunk = chunks.at(j);
+        char* chunk_dst = dst + chunk_offsets.at(j);
+        std::atomic<int64_t>* remaining_chunk_cnt = remaining_chunk_cnts.at(i).get();
+        thread_pool.AddWork([&reader, &loaded_var_ids, var_lbn, logical_blob_shape, data_type,
+                             chunk, chunk_dst, remaining_chunk_cnt, i]() {
+          reader.Read(var_lbn, logical_blob_shape, data_type, chunk, chunk_dst);
+          if (remaining_chunk_cnt->fetch_sub(1) == 1) {
+            CHECK_EQ(loaded_var_ids.Send(i), kBufferStatusSuccess);
+          }
+        });
+      }
+    };
+    int64_t next_var_id = 0;
+    int64_t pending_bytes = 0;
+    FOR_RANGE(int64_t, loaded_cnt, 0, num_var) {
+      while (next_var_id < num_var) {
+        const int64_t var_bytes =
+            BnInOp2Blob(GenRepeatedBn("ref", next_var_id))->ByteSizeOfBlobBody();
+        if (pending_bytes > 0 && pending_bytes + var_bytes > max_pending_bytes) { break; }
+        pending_bytes += var_bytes;
+        ScheduleVar(next_var_id);
+        next_var_id += 1;
+      }
+      int64_t i = -1;
+      CHECK_EQ(loaded_var_ids.Receive(&i), kBufferStatusSuccess);
+      Blob* ref = BnInOp2Blob(GenRepeatedBn("ref", i));
+      if (device_type != DeviceType::kCPU) {
+        SyncCopyToDevice<device_type>(ctx.device_ctx, host_blobs.at(i)->blob()->dptr(),
+                                      ref->mut_dptr(), ref->ByteSizeOfBlobBody());
+        host_blobs.at(i).reset();
+      }
+      pending_bytes -= ref->ByteSizeOfBlobBody();
+    }
+  }
   std::vector<TensorSliceView> tensor_slice_views_;
 };
 
@@ -332,7 +509,10 @@ class ModelSaveV2Kernel final : public KernelIf<device_type> {
  public:
   OF_DISALLOW_COPY_AND_MOVE(ModelSaveV2Kernel);
   ModelSaveV2Kernel() = default;
-  ~ModelSaveV2Kernel() override = default;
+  ~ModelSaveV2Kernel() override {
+    // background works refer to this kernel and to the ctrl client
+    if (AsyncSnapshotWriter::IsEnabled()) { AsyncSnapshotWriter::Singleton()->WaitAll(); }
+  }
 
  private:
   void VirtualKernelInit() override {
@@ -359,8 +539,12 @@ class ModelSaveV2Kernel final : public KernelIf<device_type> {
     part_id2slice_views_.reserve(num_var);
     need_do_saves_.reserve(num_var);
     part_ids_.reserve(num_var);
+    delta_states_.reserve(num_var);
+    delta_full_interval_ = ParseIntegerFromEnv("ONEFLOW_MODEL_SAVE_DELTA_FULL_INTERVAL", 0);
+    delta_min_row_cnt_ = ParseIntegerFromEnv("ONEFLOW_MODEL_SAVE_DELTA_MIN_ROWS", 1 << 16);
     FOR_RANGE(int64_t, i, 0, num_var) {
       counters_.emplace_back(new int64_t(0));
+      delta_states_.emplace_back(new VariableDeltaState());
       const cfg::ParallelDistribution& parallel_distribution =
           GetParallelDistribution(this->kernel_conf(), GenRepeatedBn("in", i));
       const Shape logical_blob_shape(model_save_v2_conf.original_variable_conf(i).shape());
@@ -395,50 +579,137 @@ class ModelSaveV2Kernel final : public KernelIf<device_type> {
     const Blob* path_blob = BnInOp2Blob("path");
     const std::string snapshot_path =
         SyncReadStringFromBlob<device_type>(ctx.device_ctx, path_blob);
-    SnapshotWriter writer(snapshot_path);
-    SnapshotReader reader(snapshot_path);
+    // checks the root directory before any work goes to the background, and is shared by the
+    // works so that they fill one container
+    std::shared_ptr<SnapshotWriter> writer(new SnapshotWriter(snapshot_path));
+    const bool async_save = AsyncSnapshotWriter::IsEnabled();
+    std::vector<std::pair<int64_t, std::shared_ptr<OnDemandHostBlob>>> snapshots;
     FOR_RANGE(int64_t, i, 0, conf.variable_op_name_size()) {
       if (!need_do_saves_.at(i)) { continue; }
       *(counters_.at(i)) += 1;
-      const std::vector<TensorSliceView>& variable_part_id2slice_views = part_id2slice_views_.at(i);
       Blob* in_blob = BnInOp2Blob(GenRepeatedBn("in", i));
-      const VariableOpConf& original_variable_conf = conf.original_variable_conf(i);
-      const Shape logical_blob_shape(original_variable_conf.shape());
-      const DataType data_type = original_variable_conf.data_type();
-      AutoSyncBlobAccessor<device_type> in_accessor(ctx.device_ctx, in_blob, true, false);
-      const std::string var_lbn =
-          GenLogicalBlobName(conf.variable_op_name(i), original_variable_conf.out());
-      const bool is_broadcast = ShapeView(logical_blob_shape) == in_blob->shape();
-      if (is_broadcast) { CHECK_EQ(variable_part_id2slice_views.size(), 1); }
-      const std::string key = is_broadcast ? var_lbn
-                                           : GetTmpPartKey(var_lbn, part_ids_.at(i),
-                                                           variable_part_id2slice_views.size());
-      writer.Write(key, in_accessor.host_blob());
-      if (!is_broadcast) {
-        const std::string rpc_key =
-            snapshot_path + "-" + var_lbn + "-Counter-" + std::to_string(*(counters_.at(i)));
-        int32_t counter = Global<CtrlClient>::Get()->IncreaseCount(rpc_key);
-        if (counter < variable_part_id2slice_views.size()) { continue; }
-        TensorSliceView total_slice(logical_blob_shape);
-        OnDemandHostBlob total_blob(logical_blob_shape, data_type);
-        FOR_RANGE(int64_t, j, 0, variable_part_id2slice_views.size()) {
-          const TensorSliceView part_slice = variable_part_id2slice_views.at(j);
-          const std::string part_key =
-              GetTmpPartKey(var_lbn, j, variable_part_id2slice_views.size());
-          OnDemandHostBlob part_blob(part_slice.shape(), data_type);
-          reader.Read(part_key, part_blob.blob());
-          HostSliceCopy(total_blob.blob(), total_slice, part_blob.blob(), part_slice);
-          SnapshotFS()->RecursivelyDeleteDir(Dirname(JoinPath(snapshot_path, part_key)));
-        }
-        writer.Write(var_lbn, total_blob.blob());
-        Global<CtrlClient>::Get()->EraseCount(rpc_key);
+      if (async_save) {
+        std::shared_ptr<OnDemandHostBlob> host_blob(new OnDemandHostBlob(in_blob));
+        CopyToHostWithoutSync<device_type>(ctx.device_ctx, in_blob->dptr(),
+                                           host_blob->blob()->mut_dptr(),
+                                           in_blob->ByteSizeOfBlobBody());
+        snapshots.emplace_back(i, host_blob);
+      } else {
+        AutoSyncBlobAccessor<device_type> in_accessor(ctx.device_ctx, in_blob, true, false);
+        const std::shared_ptr<const VariableDelta> delta =
+            PlanDelta(snapshot_path, i, in_accessor.host_blob());
+        SaveVariable(writer.get(), snapshot_path, i, *(counters_.at(i)), in_accessor.host_blob(),
+                     delta, false);
+      }
+    }
+    if (!async_save) { return; }
+    // the variables may be updated once this kernel returns, so the copies must be done here
+    SyncDevice<device_type>(ctx.device_ctx);
+    for (const auto& pair : snapshots) {
+      const int64_t i = pair.first;
+      const std::shared_ptr<OnDemandHostBlob>& host_blob = pair.second;
+      const int64_t counter = *(counters_.at(i));
+      // planned here rather than in the works, which may run out of order
+      const std::shared_ptr<const VariableDelta> delta =
+          PlanDelta(snapshot_path, i, host_blob->blob());
+      AsyncSnapshotWriter::Singleton()->Schedule(
+          host_blob->blob()->ByteSizeOfBlobBody(),
+          [this, writer, snapshot_path, i, counter, host_blob, delta]() {
+            SaveVariable(writer.get(), snapshot_path, i, counter, host_blob->blob(), delta, true);
+          });
+    }
+  }
+
+  // Returns the rows to save if a delta of the variable is enough, or nullptr for a full save.
+  // Deltas are taken of the variables a rank saves as a whole when
+  // ONEFLOW_MODEL_SAVE_DELTA_FULL_INTERVAL is positive, which is the number of deltas between two
+  // full saves. A row is changed if its hash differs from the one of the last save.
+  std::shared_ptr<const VariableDelta> PlanDelta(const std::string& snapshot_path, int64_t i,
+                                                 const Blob* host_blob) const {
+    if (delta_full_interval_ <= 0) { return nullptr; }
+    const VariableOpConf& original_variable_conf =
+        this->op_conf().model_save_v2_conf().original_variable_conf(i);
+    const Shape logical_blob_shape(original_variable_conf.shape());
+    if (!(ShapeView(logical_blob_shape) == host_blob->shape()) || logical_blob_shape.NumAxes() == 0
+        || logical_blob_shape.At(0) < delta_min_row_cnt_) {
+      return nullptr;
+    }
+    const int64_t row_cnt = logical_blob_shape.At(0);
+    const int64_t row_size =
+        logical_blob_shape.Count(1) * GetSizeOfDataType(original_variable_conf.data_type());
+    VariableDeltaState* state = delta_states_.at(i).get();
+    std::vector<uint64_t> row_hashes;
+    ComputeRowHashes(host_blob->dptr<char>(), row_cnt, row_size, &row_hashes);
+    std::shared_ptr<VariableDelta> delta;
+    if (!state->row_hashes.empty() && state->delta_cnt < delta_full_interval_) {
+      delta.reset(new VariableDelta());
+      delta->base_snapshot_path = state->last_snapshot_path;
+      FOR_RANGE(int64_t, row, 0, row_cnt) {
+        if (row_hashes.at(row) != state->row_hashes.at(row)) { delta->rows.push_back(row); }
+      }
+      // a full save is cheaper to restore once most rows changed
+      if (delta->rows.size() * 2 > row_cnt) { delta.reset(); }
+    }
+    state->delta_cnt = delta ? state->delta_cnt + 1 : 0;
+    state->row_hashes.swap(row_hashes);
+    state->last_snapshot_path = snapshot_path;
+    return delta;
+  }
+
+  void SaveVariable(SnapshotWriter* writer, const std::string& snapshot_path, int64_t i,
+                    int64_t counter, const Blob* host_blob,
+                    const std::shared_ptr<const VariableDelta>& delta, bool atomic) const {
+    const ModelSaveV2OpConf& conf = this->op_conf().model_save_v2_conf();
+    const std::vector<TensorSliceView>& variable_part_id2slice_views = part_id2slice_views_.at(i);
+    const VariableOpConf& original_variable_conf = conf.original_variable_conf(i);
+    const Shape logical_blob_shape(original_variable_conf.shape());
+    const DataType data_type = original_variable_conf.data_type();
+    const std::string var_lbn =
+        GenLogicalBlobName(conf.variable_op_name(i), original_variable_conf.out());
+    const bool is_broadcast = ShapeView(logical_blob_shape) == host_blob->shape();
+    if (is_broadcast) { CHECK_EQ(variable_part_id2slice_views.size(), 1); }
+    const std::string key = is_broadcast ? var_lbn
+                                         : GetTmpPartKey(var_lbn, part_ids_.at(i),
+                                                         variable_part_id2slice_views.size());
+    if (is_broadcast) {
+      if (delta) {
+        std::string data;
+        SerializeSnapshotDelta(delta->base_snapshot_path, delta->rows, host_blob->dptr<char>(),
+                               logical_blob_shape.Count(1) * GetSizeOfDataType(data_type), &data);
+        WriteSnapshot(writer, snapshot_path, SnapshotDeltaKey(key), data, atomic);
+      } else {
+        WriteSnapshot(writer, snapshot_path, key, host_blob, atomic);
       }
+      return;
     }
+    // parts are read by the last rank as soon as they are counted, so they never go to containers
+    writer->WriteFile(key, host_blob);
+    const std::string rpc_key =
+        snapshot_path + "-" + var_lbn + "-Counter-" + std::to_string(counter);
+    int32_t part_cnt = Global<CtrlClient>::Get()->IncreaseCount(rpc_key);
+    if (part_cnt < variable_part_id2slice_views.size()) { return; }
+    SnapshotReader reader(snapshot_path);
+    TensorSliceView total_slice(logical_blob_shape);
+    OnDemandHostBlob total_blob(logical_blob_shape, data_type);
+    FOR_RANGE(int64_t, j, 0, variable_part_id2slice_views.size()) {
+      const TensorSliceView part_slice = variable_part_id2slice_views.at(j);
+      const std::string part_key = GetTmpPartKey(var_lbn, j, variable_part_id2slice_views.size());
+      OnDemandHostBlob part_blob(part_slice.shape(), data_type);
+      reader.Read(part_key, part_blob.blob());
+      HostSliceCopy(total_blob.blob(), total_slice, part_blob.blob(), part_slice);
+      SnapshotFS()->RecursivelyDeleteDir(Dirname(JoinPath(snapshot_path, part_key)));
+    }
+    WriteSnapshot(writer, snapshot_path, var_lbn, total_blob.blob(), atomic);
+    Global<CtrlClient>::Get()->EraseCount(rpc_key);
   }
+
   std::vector<std::unique_ptr<int64_t>> counters_;
   std::vector<std::vector<TensorSliceView>> part_id2slice_views_;
   std::vector<bool> need_do_saves_;
   std::vector<int64_t> part_ids_;
+  std::vector<std::unique_ptr<VariableDeltaState>> delta_states_;
+  int64_t delta_full_interval_;
+  int64_t delta_min_row_cnt_;
 };
 
 ADD_DEVICE_TYPE_KERNEL_CREATOR(OperatorConf::kModelSaveV2Conf, ModelSaveV2Kernel);
@@ -15,13 +15,14 @@ limitations under the License.
 */
 #include "oneflow/core/kernel/new_kernel_util.h"
 #include "oneflow/core/device/cuda_util.h"
+#include "oneflow/core/device/cuda_pinned_staging.h"
 
 namespace oneflow {
 
 template<>
 void Memcpy<DeviceType::kGPU>(DeviceCtx* ctx, void* dst, const void* src, size_t sz) {
   if (dst == src) { return; }
-  OF_CUDA_CHECK(cudaMemcpyAsync(dst, src, sz, cudaMemcpyDefault, ctx->cuda_stream()));
+  CudaMemcpyAsyncStaged(ctx->cuda_stream(), dst, src, sz);
 }
 
 template<>
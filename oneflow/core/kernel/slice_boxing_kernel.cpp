@@ -98,10 +98,16 @@ template<DeviceType device_type, typename T>
 void SliceBoxingCopyKernel<device_type, T>::ForwardDataContent(
     const KernelCtx& ctx, std::function<Blob*(const std::string&)> BnInOp2Blob) const {
   Blob* out = BnInOp2Blob("out");
-  FOR_RANGE(int64_t, i, 0, this->op_attribute().input_bns().size()) {
-    const Blob* in_i = BnInOp2Blob(GenRepeatedBn("in", i));
-    this->tensor_slice_copier_vec().at(i)->Copy(ctx.device_ctx, *this->memory_copier(), out, in_i);
+  const int64_t num_in = this->op_attribute().input_bns().size();
+  std::vector<const TensorSliceCopier*> slice_copiers(num_in);
+  std::vector<Blob*> dst_blobs(num_in, out);
+  std::vector<const Blob*> src_blobs(num_in);
+  FOR_RANGE(int64_t, i, 0, num_in) {
+    slice_copiers.at(i) = this->tensor_slice_copier_vec().at(i).get();
+    src_blobs.at(i) = BnInOp2Blob(GenRepeatedBn("in", i));
   }
+  TensorSliceCopier::BatchCopy(ctx.device_ctx, *this->memory_copier(), slice_copiers, dst_blobs,
+                               src_blobs);
 }
 
 template<DeviceType device_type, typename T>
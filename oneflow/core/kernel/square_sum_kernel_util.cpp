@@ -19,7 +19,7 @@ namespace oneflow {
 
 template<typename T>
 struct SquareSumKernelUtil<DeviceType::kCPU, T> {
-  static void SquareSum(DeviceCtx* ctx, int64_t n, const T* x, T* y) {
+  static void SquareSum(DeviceCtx* ctx, int64_t n, const T* x, T* y, T* tmp) {
     T sum = 0;
     FOR_RANGE(int64_t, i, 0, n) { sum += x[i] * x[i]; }
     *y = sum;
@@ -15,28 +15,13 @@ limitations under the License.
 */
 #include "oneflow/core/kernel/square_sum_kernel_util.h"
 #include "oneflow/core/cuda/atomic.cuh"
+#include "oneflow/core/cuda/reduce.cuh"
 #include <cub/cub.cuh>
 
 namespace oneflow {
 
 namespace {
 
-template<typename T, bool ONE_BLOCK>
-__global__ void SquareSumGpu(int64_t n, const T* x, T* y) {
-  T t_sum = 0;
-  CUDA_1D_KERNEL_LOOP(i, n) { t_sum += x[i] * x[i]; }
-  typedef cub::BlockReduce<T, kCudaThreadsNumPerBlock> BlockReduce;
-  __shared__ typename BlockReduce::TempStorage temp_storage;
-  T b_sum = BlockReduce(temp_storage).Sum(t_sum);
-  if (threadIdx.x == 0) {
-    if (ONE_BLOCK) {
-      *y = b_sum;
-    } else {
-      cuda::atomic::Add(y, b_sum);
-    }
-  }
-}
-
 constexpr int64_t kMultiSquareSumMaxSize = 64;
 
 template<typename T>
@@ -62,18 +47,11 @@ __global__ void MultiSquareSumGpu(const MultiSquareSumParams<T> params, T* y) {
 
 template<typename T>
 struct SquareSumKernelUtil<DeviceType::kGPU, T> {
-  static void SquareSum(DeviceCtx* ctx, int64_t n, const T* x, T* y) {
-    const int32_t num_blocks = BlocksNum4ThreadsNum(n);
-    CHECK_GE(num_blocks, 0);
-    if (num_blocks == 0) {
-      Memset<DeviceType::kGPU>(ctx, y, 0, sizeof(T));
-    } else if (num_blocks == 1) {
-      SquareSumGpu<T, true><<<1, kCudaThreadsNumPerBlock, 0, ctx->cuda_stream()>>>(n, x, y);
-    } else {
-      Memset<DeviceType::kGPU>(ctx, y, 0, sizeof(T));
-      SquareSumGpu<T, false>
-          <<<num_blocks, kCudaThreadsNumPerBlock, 0, ctx->cuda_stream()>>>(n, x, y);
-    }
+  static void SquareSum(DeviceCtx* ctx, int64_t n, const T* x, T* y, T* tmp) {
+    OF_CUDA_CHECK((cuda::reduce::OuterReduceInner<T, T, T>(
+        ctx->cuda_stream(), 1, n, 1, x, y, tmp, kSquareSumTmpElemCnt * sizeof(T),
+        cuda::reduce::SquareOp<T, T>(), cuda::reduce::SumOp<T>(), static_cast<T>(0),
+        cuda::reduce::IdentityOp<T>())));
   }
 
   static void MultiSquareSum(DeviceCtx* ctx, const std::vector<SquareSumParam<T>>& params, T* y) {
@@ -26,9 +26,12 @@ struct SquareSumParam {
   int64_t count;
 };
 
+// The elems of the tmp buffer of SquareSum, which holds the partial sums of large inputs.
+constexpr int64_t kSquareSumTmpElemCnt = 1024;
+
 template<DeviceType device_type, typename T>
 struct SquareSumKernelUtil {
-  static void SquareSum(DeviceCtx* ctx, int64_t n, const T* x, T* y);
+  static void SquareSum(DeviceCtx* ctx, int64_t n, const T* x, T* y, T* tmp);
   static void MultiSquareSum(DeviceCtx* ctx, const std::vector<SquareSumParam<T>>& params, T* y);
 };
 
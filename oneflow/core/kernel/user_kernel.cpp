@@ -583,6 +583,11 @@ void UserKernel::InitUserKernel(DeviceCtx* device_ctx) {
     CHECK_NOTNULL(kernel_reg_val);
     KernelCreateContext create_ctx(kernel_conf());
     kernel_.reset(kernel_reg_val->create_fn(&create_ctx));
+    flops_ = kernel_reg_val->infer_flops_fn(infer_ctx_->MutOpInferContext());
+  }
+  if (ctx_->device_type() == DeviceType::kGPU
+      && CudaGraphKernelLauncher::IsEnabled(kernel_.get())) {
+    cuda_graph_launcher_.reset(new CudaGraphKernelLauncher());
   }
 }
 
@@ -598,7 +603,11 @@ const std::shared_ptr<user_op::OpKernelState>& UserKernel::GetOpKernelState() co
 void UserKernel::ForwardUserKernel(std::function<Blob*(const std::string&)> BnInOp2Blob,
                                    user_op::OpKernelState* opkernel_state) const {
   ctx_->UpdateTensorWithCorrBlob(BnInOp2Blob);
-  kernel_->Compute(ctx_.get(), opkernel_state);
+  if (cuda_graph_launcher_) {
+    cuda_graph_launcher_->Compute(kernel_.get(), ctx_.get(), opkernel_state);
+  } else {
+    kernel_->Compute(ctx_.get(), opkernel_state);
+  }
 }
 
 void UserKernel::VirtualKernelInit(DeviceCtx* device_ctx) {
@@ -616,7 +625,8 @@ void UserKernel::ForwardShape(const KernelCtx& ctx,
                               std::function<Blob*(const std::string&)> BnInOp2Blob) const {
   infer_ctx_->UpdateArg2Tensor(BnInOp2Blob);
   infer_cache_->UpdateCacheKey(infer_ctx_.get());
-  if (!infer_cache_->IsCacheHit()) {
+  std::shared_ptr<const OpInferCacheValue> cache_value_ptr = infer_cache_->GetCacheValue();
+  if (!cache_value_ptr) {
     auto* op_infer_ctx = dynamic_cast<UserKernelOpInferContext*>(infer_ctx_->MutOpInferContext());
     CHECK_NOTNULL(op_infer_ctx);
     op_infer_ctx->UpdateArg2TensorDesc(BnInOp2Blob);
@@ -635,7 +645,6 @@ void UserKernel::ForwardShape(const KernelCtx& ctx,
     }
     infer_cache_->UpdateCacheValue(infer_ctx_.get());
   } else {
-    std::shared_ptr<const OpInferCacheValue> cache_value_ptr = infer_cache_->GetCacheValue();
     FOR_RANGE(int, i, 0, infer_ctx_->outputs().size()) {
       const auto& out_arg_pair = infer_ctx_->outputs().at(i);
       MutShapeView* mut_shape_view =
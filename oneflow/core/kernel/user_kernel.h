@@ -20,6 +20,7 @@ limitations under the License.
 #include "oneflow/core/framework/to_string.h"
 #include "oneflow/core/framework/user_op_conf.h"
 #include "oneflow/core/framework/user_op_registry_manager.h"
+#include "oneflow/core/kernel/cuda_graph_support.h"
 #include "oneflow/core/kernel/eager_kernel.h"
 #include "oneflow/core/kernel/kernel.h"
 
@@ -49,12 +50,16 @@ class UserKernel final : public Kernel {
                     std::function<Blob*(const std::string&)> BnInOp2Blob) const override;
 
   bool IsStateless() const override;
+  int64_t Flops() const override { return flops_; }
 
   std::shared_ptr<user_op::OpKernelState> opkernel_state_;
   std::unique_ptr<const user_op::OpKernel> kernel_;
   std::unique_ptr<UserKernelComputeContext> ctx_;
   std::unique_ptr<UserKernelInferContext> infer_ctx_;
   std::unique_ptr<user_op::OpKernelInferCache> infer_cache_;
+  std::unique_ptr<CudaGraphKernelLauncher> cuda_graph_launcher_;
+  // of the static shapes, the kernels of dynamic shapes are counted at their maximum
+  int64_t flops_ = 0;
 };
 
 }  // namespace oneflow
@@ -75,6 +75,53 @@ void LaunchTransposeGpu(DeviceCtx* ctx, const ShapeView& x_shape, const ShapeVie
           y_shape_struct, x_strides, elem_cnt, x, y);
 }
 
+constexpr int32_t kTransposeTileDim = 32;
+constexpr int32_t kTransposeBlockRows = 8;
+
+// Transposes each of the num_batches row-major [rows, cols] matrices of x into [cols, rows]
+// through a shared memory tile, so that both the loads and the stores are coalesced.
+template<typename T>
+__global__ void BatchTransposeGpu(const int32_t num_batches, const int32_t rows,
+                                  const int32_t cols, const int32_t num_tile_rows,
+                                  const int32_t num_tile_cols, const T* x, T* y) {
+  __shared__ T tile[kTransposeTileDim][kTransposeTileDim + 1];
+  const int32_t num_tiles_per_batch = num_tile_rows * num_tile_cols;
+  const int32_t num_tiles = num_batches * num_tiles_per_batch;
+  const int32_t matrix_size = rows * cols;
+  for (int32_t tile_idx = blockIdx.x; tile_idx < num_tiles; tile_idx += gridDim.x) {
+    const int32_t batch_idx = tile_idx / num_tiles_per_batch;
+    const int32_t tile_idx_in_batch = tile_idx - batch_idx * num_tiles_per_batch;
+    const int32_t tile_row = tile_idx_in_batch / num_tile_cols;
+    const int32_t tile_col = tile_idx_in_batch - tile_row * num_tile_cols;
+    const T* batch_x = x + batch_idx * matrix_size;
+    T* batch_y = y + batch_idx * matrix_size;
+    const int32_t x_col = tile_col * kTransposeTileDim + threadIdx.x;
+    for (int32_t i = threadIdx.y; i < kTransposeTileDim; i += kTransposeBlockRows) {
+      const int32_t x_row = tile_row * kTransposeTileDim + i;
+      if (x_row < rows && x_col < cols) { tile[i][threadIdx.x] = batch_x[x_row * cols + x_col]; }
+    }
+    __syncthreads();
+    const int32_t y_col = tile_row * kTransposeTileDim + threadIdx.x;
+    for (int32_t i = threadIdx.y; i < kTransposeTileDim; i += kTransposeBlockRows) {
+      const int32_t y_row = tile_col * kTransposeTileDim + i;
+      if (y_row < cols && y_col < rows) { batch_y[y_row * rows + y_col] = tile[threadIdx.x][i]; }
+    }
+    __syncthreads();
+  }
+}
+
+template<typename T>
+void LaunchBatchTransposeGpu(DeviceCtx* ctx, const int32_t num_batches, const int32_t rows,
+                             const int32_t cols, const T* x, T* y) {
+  const int32_t num_tile_rows = (rows + kTransposeTileDim - 1) / kTransposeTileDim;
+  const int32_t num_tile_cols = (cols + kTransposeTileDim - 1) / kTransposeTileDim;
+  const int64_t num_tiles = static_cast<int64_t>(num_batches) * num_tile_rows * num_tile_cols;
+  const int32_t num_blocks = std::min(num_tiles, static_cast<int64_t>(kCudaMaxBlocksNum));
+  const dim3 block_dim(kTransposeTileDim, kTransposeBlockRows);
+  BatchTransposeGpu<T><<<num_blocks, block_dim, 0, ctx->cuda_stream()>>>(
+      num_batches, rows, cols, num_tile_rows, num_tile_cols, x, y);
+}
+
 template<int32_t NDIMS, typename T>
 void TransposeImpl(DeviceCtx* ctx, const ShapeView& x_shape, const ShapeView& y_shape,
                    const std::vector<int32_t>& permutation, const int64_t elem_cnt, const T* x,
@@ -86,8 +133,10 @@ void TransposeImpl(DeviceCtx* ctx, const ShapeView& x_shape, const ShapeView& y_
   const size_t pack_size = sizeof(PackType) / sizeof(T);
   int64_t in_last_dim = x_shape.At(x_shape.NumAxes() - 1);
   int64_t out_last_dim = y_shape.At(y_shape.NumAxes() - 1);
+  const bool is_aligned = reinterpret_cast<uintptr_t>(x) % sizeof(PackType) == 0
+                          && reinterpret_cast<uintptr_t>(y) % sizeof(PackType) == 0;
   if (pack_size != 1 && permutation.back() == permutation.size() - 1
-      && in_last_dim % pack_size == 0) {
+      && in_last_dim % pack_size == 0 && is_aligned) {
     CHECK_EQ(in_last_dim, out_last_dim);
     DimVector packed_in_dim_vec;
     x_shape.ToDimVector(&packed_in_dim_vec);
@@ -114,6 +163,82 @@ struct TransposeUtil final {
                             MAKE_NDIM_CTRV_SEQ(DIM_SEQ));
 };
 
+// Drops the unit dims of x and merges the dims which stay adjacent and in order under the
+// permutation, e.g. (N, C, H, W) with perm (0, 2, 3, 1) becomes (N, C, H*W) with perm (0, 2, 1).
+void SimplifyPermutation(const ShapeView& x_shape, const std::vector<int32_t>& permutation,
+                         DimVector* simplified_x_dims, std::vector<int32_t>* simplified_perm) {
+  const int32_t num_axes = x_shape.NumAxes();
+  std::vector<int32_t> axis_map(num_axes, -1);
+  DimVector x_dims;
+  FOR_RANGE(int32_t, i, 0, num_axes) {
+    if (x_shape.At(i) == 1) { continue; }
+    axis_map[i] = x_dims.size();
+    x_dims.push_back(x_shape.At(i));
+  }
+  std::vector<int32_t> perm;
+  for (const int32_t axis : permutation) {
+    if (axis_map.at(axis) != -1) { perm.push_back(axis_map.at(axis)); }
+  }
+  simplified_x_dims->clear();
+  simplified_perm->clear();
+  if (perm.empty()) {
+    simplified_x_dims->push_back(1);
+    simplified_perm->push_back(0);
+    return;
+  }
+  // the first x axis of every group of merged axes, in output order
+  std::vector<int32_t> group_first_axis;
+  std::vector<int32_t> axis2group(perm.size(), -1);
+  FOR_RANGE(int32_t, i, 0, perm.size()) {
+    if (i == 0 || perm.at(i) != perm.at(i - 1) + 1) { group_first_axis.push_back(perm.at(i)); }
+    axis2group.at(perm.at(i)) = group_first_axis.size() - 1;
+  }
+  std::vector<int32_t> group2x_axis(group_first_axis.size(), -1);
+  FOR_RANGE(int32_t, axis, 0, x_dims.size()) {
+    const int32_t group = axis2group.at(axis);
+    if (group_first_axis.at(group) == axis) {
+      group2x_axis.at(group) = simplified_x_dims->size();
+      simplified_x_dims->push_back(x_dims.at(axis));
+    } else {
+      simplified_x_dims->back() *= x_dims.at(axis);
+    }
+  }
+  for (const int32_t x_axis : group2x_axis) { simplified_perm->push_back(x_axis); }
+}
+
+template<typename T>
+void SimplifyAndTranspose(DeviceCtx* ctx, const ShapeView& x_shape,
+                          const std::vector<int32_t>& permutation, const int64_t elem_cnt,
+                          const T* x, T* y) {
+  if (elem_cnt == 0) { return; }
+  DimVector x_dims;
+  std::vector<int32_t> perm;
+  SimplifyPermutation(x_shape, permutation, &x_dims, &perm);
+  const int32_t num_axes = x_dims.size();
+  if (num_axes == 1) {
+    OF_CUDA_CHECK(cudaMemcpyAsync(y, x, elem_cnt * sizeof(T), cudaMemcpyDefault,
+                                  ctx->cuda_stream()));
+    return;
+  }
+  const bool is_batch_transpose = (num_axes == 2 && perm.at(0) == 1)
+                                  || (num_axes == 3 && perm.at(0) == 0 && perm.at(1) == 2);
+  if (is_batch_transpose) {
+    const int32_t rows = x_dims.at(num_axes - 2);
+    const int32_t cols = x_dims.at(num_axes - 1);
+    if (std::min(rows, cols) >= kTransposeTileDim / 4) {
+      const int32_t num_batches = num_axes == 3 ? x_dims.at(0) : 1;
+      LaunchBatchTransposeGpu<T>(ctx, num_batches, rows, cols, x, y);
+      return;
+    }
+  }
+  DimVector y_dims(num_axes);
+  FOR_RANGE(int32_t, i, 0, num_axes) { y_dims.at(i) = x_dims.at(perm.at(i)); }
+  const Shape simplified_x_shape(x_dims);
+  const Shape simplified_y_shape(y_dims);
+  TransposeUtil<T>::SwitchTransposeImpl(SwitchCase(num_axes), ctx, ShapeView(simplified_x_shape),
+                                        ShapeView(simplified_y_shape), perm, elem_cnt, x, y);
+}
+
 }  // namespace
 
 #define TRANSPOSE_CHECK                               \
@@ -126,8 +251,7 @@ void ArithemeticIf<DeviceType::kGPU>::Transpose(DeviceCtx* ctx, const int32_t nu
                                                 const std::vector<int32_t>& permutation,
                                                 const int64_t elem_cnt, const float* x, float* y) {
   TRANSPOSE_CHECK;
-  TransposeUtil<float>::SwitchTransposeImpl(SwitchCase(num_axis), ctx, x_shape, y_shape,
-                                            permutation, elem_cnt, x, y);
+  SimplifyAndTranspose<float>(ctx, x_shape, permutation, elem_cnt, x, y);
 }
 
 void ArithemeticIf<DeviceType::kGPU>::Transpose(DeviceCtx* ctx, const int32_t num_axis,
@@ -136,8 +260,7 @@ void ArithemeticIf<DeviceType::kGPU>::Transpose(DeviceCtx* ctx, const int32_t nu
                                                 const int64_t elem_cnt, const double* x,
                                                 double* y) {
   TRANSPOSE_CHECK;
-  TransposeUtil<double>::SwitchTransposeImpl(SwitchCase(num_axis), ctx, x_shape, y_shape,
-                                             permutation, elem_cnt, x, y);
+  SimplifyAndTranspose<double>(ctx, x_shape, permutation, elem_cnt, x, y);
 }
 
 void ArithemeticIf<DeviceType::kGPU>::Transpose(DeviceCtx* ctx, const int32_t num_axis,
@@ -146,9 +269,8 @@ void ArithemeticIf<DeviceType::kGPU>::Transpose(DeviceCtx* ctx, const int32_t nu
                                                 const int64_t elem_cnt, const float16* x,
                                                 float16* y) {
   TRANSPOSE_CHECK;
-  TransposeUtil<half>::SwitchTransposeImpl(SwitchCase(num_axis), ctx, x_shape, y_shape, permutation,
-                                           elem_cnt, reinterpret_cast<const half*>(x),
-                                           reinterpret_cast<half*>(y));
+  SimplifyAndTranspose<half>(ctx, x_shape, permutation, elem_cnt,
+                             reinterpret_cast<const half*>(x), reinterpret_cast<half*>(y));
 }
 
 void ArithemeticIf<DeviceType::kGPU>::Transpose(DeviceCtx* ctx, const int32_t num_axis,
@@ -157,8 +279,7 @@ void ArithemeticIf<DeviceType::kGPU>::Transpose(DeviceCtx* ctx, const int32_t nu
                                                 const int64_t elem_cnt, const int8_t* x,
                                                 int8_t* y) {
   TRANSPOSE_CHECK;
-  TransposeUtil<int8_t>::SwitchTransposeImpl(SwitchCase(num_axis), ctx, x_shape, y_shape,
-                                             permutation, elem_cnt, x, y);
+  SimplifyAndTranspose<int8_t>(ctx, x_shape, permutation, elem_cnt, x, y);
 }
 
 void ArithemeticIf<DeviceType::kGPU>::Transpose(DeviceCtx* ctx, const int32_t num_axis,
@@ -167,8 +288,7 @@ void ArithemeticIf<DeviceType::kGPU>::Transpose(DeviceCtx* ctx, const int32_t nu
                                                 const int64_t elem_cnt, const int32_t* x,
                                                 int32_t* y) {
   TRANSPOSE_CHECK;
-  TransposeUtil<int32_t>::SwitchTransposeImpl(SwitchCase(num_axis), ctx, x_shape, y_shape,
-                                              permutation, elem_cnt, x, y);
+  SimplifyAndTranspose<int32_t>(ctx, x_shape, permutation, elem_cnt, x, y);
 }
 
 void ArithemeticIf<DeviceType::kGPU>::Transpose(DeviceCtx* ctx, const int32_t num_axis,
@@ -177,8 +297,7 @@ void ArithemeticIf<DeviceType::kGPU>::Transpose(DeviceCtx* ctx, const int32_t nu
                                                 const int64_t elem_cnt, const int64_t* x,
                                                 int64_t* y) {
   TRANSPOSE_CHECK;
-  TransposeUtil<int64_t>::SwitchTransposeImpl(SwitchCase(num_axis), ctx, x_shape, y_shape,
-                                              permutation, elem_cnt, x, y);
+  SimplifyAndTranspose<int64_t>(ctx, x_shape, permutation, elem_cnt, x, y);
 }
 
 #undef TRANSPOSE_CHECK
@@ -21,9 +21,57 @@ limitations under the License.
 #include "oneflow/core/register/blob.h"
 #include "oneflow/core/common/tensor_buffer.h"
 #include "oneflow/core/record/record.pb.h"
+#include "oneflow/core/profiler/metrics.h"
+#ifdef __linux__
+#include <sys/mman.h>
+#endif  // __linux__
 
 namespace oneflow {
 
+namespace {
+
+constexpr size_t kHugePageSize = 2 * 1024 * 1024;
+
+profiler::Gauge* GetAllocatedBytesGauge(const MemoryCase& mem_case) {
+  std::string device;
+  if (mem_case.has_device_cuda_mem()) {
+    device = "cuda:" + std::to_string(mem_case.device_cuda_mem().device_id());
+  } else if (mem_case.host_mem().has_cuda_pinned_mem()) {
+    device = "cpu_pinned";
+  } else {
+    device = "cpu";
+  }
+  return profiler::GetGauge("oneflow_memory_allocator_allocated_bytes",
+                            "memory allocated for the registers of lazy jobs",
+                            {{"device", device}});
+}
+
+bool IsHostMemTransparentHugePageEnabled() {
+  static const bool is_enabled =
+      ParseBooleanFromEnv("ONEFLOW_HOST_MEM_ENABLE_TRANSPARENT_HUGEPAGE", true);
+  return is_enabled;
+}
+
+void* AllocateHostMem(size_t size) {
+#ifdef __linux__
+  if (IsHostMemTransparentHugePageEnabled() && size >= kHugePageSize) {
+    // large chunks are aligned to and advised for huge pages, which saves the TLB misses of
+    // copying them to the devices or staging them for the comm net
+    const size_t aligned_size = RoundUp(size, kHugePageSize);
+    void* ptr = aligned_alloc(kHugePageSize, aligned_size);
+    CHECK_NOTNULL(ptr);
+    // only a hint, the kernel may have transparent huge pages disabled
+    madvise(ptr, aligned_size, MADV_HUGEPAGE);
+    return ptr;
+  }
+#endif  // __linux__
+  void* ptr = aligned_alloc(kHostAlignSize, size);
+  CHECK_NOTNULL(ptr);
+  return ptr;
+}
+
+}  // namespace
+
 void* MemoryAllocatorImpl::Allocate(MemoryCase mem_case, size_t size) {
   void* ptr = nullptr;
   if (mem_case.has_host_mem()) {
@@ -34,8 +82,7 @@ void* MemoryAllocatorImpl::Allocate(MemoryCase mem_case, size_t size) {
       UNIMPLEMENTED();
 #endif
     } else {
-      ptr = aligned_alloc(kHostAlignSize, size);
-      CHECK_NOTNULL(ptr);
+      ptr = AllocateHostMem(size);
     }
   } else if (mem_case.has_device_cuda_mem()) {
 #ifdef WITH_CUDA
@@ -73,11 +120,7 @@ void MemoryAllocatorImpl::Deallocate(void* ptr, MemoryCase mem_case) {
   }
 }
 
-void* MemoryAllocatorImpl::AllocateUnPinnedHostMem(size_t size) {
-  void* ptr = aligned_alloc(kHostAlignSize, size);
-  CHECK_NOTNULL(ptr);
-  return ptr;
-}
+void* MemoryAllocatorImpl::AllocateUnPinnedHostMem(size_t size) { return AllocateHostMem(size); }
 
 void MemoryAllocatorImpl::DeallocateUnPinnedHostMem(void* ptr) { free(ptr); }
 
@@ -100,7 +143,12 @@ char* MemoryAllocator::Allocate(MemoryCase mem_case, std::size_t size) {
   } else {
     UNIMPLEMENTED();
   }
-  deleters_.push_front(std::bind(&MemoryAllocator::Deallocate, this, dptr, mem_case));
+  profiler::Gauge* allocated_bytes_gauge = GetAllocatedBytesGauge(mem_case);
+  allocated_bytes_gauge->Add(size);
+  deleters_.push_front([this, dptr, mem_case, size, allocated_bytes_gauge]() {
+    Deallocate(dptr, mem_case);
+    allocated_bytes_gauge->Add(-static_cast<int64_t>(size));
+  });
   return dptr;
 }
 
@@ -15,22 +15,18 @@ limitations under the License.
 */
 #include "oneflow/core/ndarray/ndarray_apply_binary_core.h"
 #include "oneflow/core/ndarray/binary_func.h"
+#include "oneflow/core/cuda/elementwise.cuh"
 
 namespace oneflow {
 
 namespace {
 
 template<typename T, template<typename> class binary_func>
-__global__ void NdarrayApplyBinaryApplyGpu(size_t n,
-                                           typename BinaryFuncTrait<binary_func, T>::return_type* y,
-                                           const T* a, const T* b) {
-  NdarrayApplyBinaryCore<T, binary_func>::Apply(n, y, a, b);
-}
-
-template<typename T, template<typename> class binary_func>
-__global__ void NdarrayApplyBinaryInplaceApplyGpu(size_t n, T* y, const T* x) {
-  NdarrayApplyBinaryCore<T, binary_func>::InplaceApply(n, y, x);
-}
+struct ApplyBinaryFunctor {
+  __device__ typename BinaryFuncTrait<binary_func, T>::return_type operator()(T a, T b) const {
+    return binary_func<T>::Invoke(a, b);
+  }
+};
 
 }  // namespace
 
@@ -41,15 +37,15 @@ struct NdarrayApplyBinaryCoreWrapper<DeviceType::kGPU, T, binary_func> final {
                     const XpuVarNdarray<const T>& a, const XpuVarNdarray<const T>& b) {
     size_t n = y.host_shape().HostElemNum();
     if (n == 0) { return; }
-    RUN_CUDA_KERNEL((NdarrayApplyBinaryApplyGpu<T, binary_func>), ctx, n, n, y.host_ptr(),
-                    a.host_ptr(), b.host_ptr());
+    OF_CUDA_CHECK(cuda::elementwise::Binary(ApplyBinaryFunctor<T, binary_func>(), n, y.host_ptr(),
+                                            a.host_ptr(), b.host_ptr(), ctx->cuda_stream()));
   }
   static void InplaceApply(DeviceCtx* ctx, const XpuVarNdarray<T>& y,
                            const XpuVarNdarray<const T>& x) {
     size_t n = y.host_shape().HostElemNum();
     if (n == 0) { return; }
-    RUN_CUDA_KERNEL((NdarrayApplyBinaryInplaceApplyGpu<T, binary_func>), ctx, n, n, y.host_ptr(),
-                    x.host_ptr());
+    OF_CUDA_CHECK(cuda::elementwise::Binary(ApplyBinaryFunctor<T, binary_func>(), n, y.host_ptr(),
+                                            y.host_ptr(), x.host_ptr(), ctx->cuda_stream()));
   }
 };
 
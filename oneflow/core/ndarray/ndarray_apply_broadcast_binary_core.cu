@@ -14,6 +14,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #include "oneflow/core/ndarray/ndarray_apply_broadcast_binary_core.h"
+#include "oneflow/core/cuda/elementwise.cuh"
 
 namespace oneflow {
 
@@ -63,10 +64,53 @@ struct XYZ2YFunctor final {
   Index dim_z_;
 };
 
-template<typename T, typename K, template<typename> class binary_func, typename OffsetFunctor>
-__global__ void PartialBroadcastGpu(K n, typename BinaryFuncTrait<binary_func, T>::return_type* y,
-                                    const T* a, const T* b, OffsetFunctor offset_functor) {
-  CUDA_1D_KERNEL_LOOP_T(K, i, n) { y[i] = binary_func<T>::Invoke(a[i], b[offset_functor(i)]); }
+template<typename Index>
+struct Scalar2ScalarFunctor final {
+  __host__ __device__ Index operator()(Index idx) const { return 0; }
+};
+
+// One operand has the shape of y and is loaded in packs, the other one is broadcast and its
+// offset comes from offset_functor. broadcast_a tells which side of binary_func it is on.
+template<typename T, typename K, template<typename> class binary_func, typename OffsetFunctor,
+         bool broadcast_a, int pack_size>
+__global__ void PartialBroadcastGpu(K n_pack,
+                                    typename BinaryFuncTrait<binary_func, T>::return_type* y,
+                                    const T* full, const T* broadcast,
+                                    OffsetFunctor offset_functor) {
+  using RetT = typename BinaryFuncTrait<binary_func, T>::return_type;
+  const auto* full_pack = reinterpret_cast<const cuda::elementwise::PackType<T, pack_size>*>(full);
+  auto* y_pack = reinterpret_cast<cuda::elementwise::PackType<RetT, pack_size>*>(y);
+  CUDA_1D_KERNEL_LOOP_T(K, i, n_pack) {
+    const cuda::elementwise::Pack<T, pack_size> full_vals =
+        cuda::elementwise::FetchPack<T, pack_size>(full_pack + i);
+    cuda::elementwise::Pack<RetT, pack_size> y_vals;
+#pragma unroll
+    for (int j = 0; j < pack_size; ++j) {
+      const T broadcast_val = broadcast[offset_functor(i * pack_size + j)];
+      y_vals.elem[j] = broadcast_a ? binary_func<T>::Invoke(broadcast_val, full_vals.elem[j])
+                                   : binary_func<T>::Invoke(full_vals.elem[j], broadcast_val);
+    }
+    y_pack[i] = y_vals.storage;
+  }
+}
+
+template<typename T, typename K, template<typename> class binary_func, typename OffsetFunctor,
+         bool broadcast_a>
+void LaunchPartialBroadcast(DeviceCtx* ctx, K n,
+                            typename BinaryFuncTrait<binary_func, T>::return_type* y,
+                            const T* full, const T* broadcast, OffsetFunctor offset_functor) {
+  using RetT = typename BinaryFuncTrait<binary_func, T>::return_type;
+  constexpr int max_pack_size = cuda::elementwise::PackSize<T, RetT>();
+  if (n % max_pack_size == 0
+      && cuda::elementwise::IsAlignedForPack<max_pack_size, RetT, T>(y, full)) {
+    const K n_pack = n / max_pack_size;
+    RUN_CUDA_KERNEL((PartialBroadcastGpu<T, K, binary_func, OffsetFunctor, broadcast_a,
+                                         max_pack_size>),
+                    ctx, n_pack, n_pack, y, full, broadcast, offset_functor);
+  } else {
+    RUN_CUDA_KERNEL((PartialBroadcastGpu<T, K, binary_func, OffsetFunctor, broadcast_a, 1>), ctx,
+                    n, n, y, full, broadcast, offset_functor);
+  }
 }
 
 template<typename T, int NDIMS, template<typename> class binary_func>
@@ -99,45 +143,60 @@ struct NdarrayApplyBroadcastBinaryCoreWrapper<DeviceType::kGPU, T, NDIMS, binary
   static bool PartialBroadcast(
       DeviceCtx* ctx, const XpuVarNdarray<typename BinaryFuncTrait<binary_func, T>::return_type>& y,
       const XpuVarNdarray<const T>& a, const XpuVarNdarray<const T>& b) {
-    size_t n = y.host_shape().HostElemNum();
     if (y.host_shape() == a.host_shape()) {
-      if (y.host_shape().NumAxes() == 2) {
-        const K y_dim0 = y.host_shape().At(0);
-        const K y_dim1 = y.host_shape().At(1);
-        const K b_dim0 = b.host_shape().At(0);
-        const K b_dim1 = b.host_shape().At(1);
-        if (b_dim0 == y_dim0 && b_dim1 == 1) {
-          XY2XFunctor<K> xy2x(y_dim1);
-          RUN_CUDA_KERNEL((PartialBroadcastGpu<T, K, binary_func, XY2XFunctor<K>>), ctx, n, n,
-                          y.host_ptr(), a.host_ptr(), b.host_ptr(), xy2x);
-          return true;
-        }
-        if (b_dim0 == 1 && b_dim1 == y_dim1) {
-          XY2YFunctor<K> xy2y(y_dim1);
-          RUN_CUDA_KERNEL((PartialBroadcastGpu<T, K, binary_func, XY2YFunctor<K>>), ctx, n, n,
-                          y.host_ptr(), a.host_ptr(), b.host_ptr(), xy2y);
-          return true;
-        }
+      return TryPartialBroadcast<K, false>(ctx, y, a.host_ptr(), b.host_shape(), b.host_ptr());
+    }
+    if (y.host_shape() == b.host_shape()) {
+      return TryPartialBroadcast<K, true>(ctx, y, b.host_ptr(), a.host_shape(), a.host_ptr());
+    }
+    return false;
+  }
+
+  // Matches the simplified shape of the broadcast operand against a scalar, a column or a row of
+  // a matrix, or the middle axis of 3 axes, which covers bias-like broadcasts.
+  template<typename K, bool broadcast_a>
+  static bool TryPartialBroadcast(
+      DeviceCtx* ctx, const XpuVarNdarray<typename BinaryFuncTrait<binary_func, T>::return_type>& y,
+      const T* full, const XpuShape& broadcast_shape, const T* broadcast) {
+    const K n = y.host_shape().HostElemNum();
+    auto* y_ptr = y.host_ptr();
+    if (broadcast_shape.HostElemNum() == 1) {
+      LaunchPartialBroadcast<T, K, binary_func, Scalar2ScalarFunctor<K>, broadcast_a>(
+          ctx, n, y_ptr, full, broadcast, Scalar2ScalarFunctor<K>());
+      return true;
+    }
+    if (y.host_shape().NumAxes() == 2) {
+      const K y_dim0 = y.host_shape().At(0);
+      const K y_dim1 = y.host_shape().At(1);
+      const K b_dim0 = broadcast_shape.At(0);
+      const K b_dim1 = broadcast_shape.At(1);
+      if (b_dim0 == y_dim0 && b_dim1 == 1) {
+        LaunchPartialBroadcast<T, K, binary_func, XY2XFunctor<K>, broadcast_a>(
+            ctx, n, y_ptr, full, broadcast, XY2XFunctor<K>(y_dim1));
+        return true;
+      }
+      if (b_dim0 == 1 && b_dim1 == y_dim1) {
+        LaunchPartialBroadcast<T, K, binary_func, XY2YFunctor<K>, broadcast_a>(
+            ctx, n, y_ptr, full, broadcast, XY2YFunctor<K>(y_dim1));
+        return true;
+      }
+    }
+    if (y.host_shape().NumAxes() == 3) {
+      const K y_dim0 = y.host_shape().At(0);
+      const K y_dim1 = y.host_shape().At(1);
+      const K y_dim2 = y.host_shape().At(2);
+      const K b_dim0 = broadcast_shape.At(0);
+      const K b_dim1 = broadcast_shape.At(1);
+      const K b_dim2 = broadcast_shape.At(2);
+      if (b_dim0 == y_dim0 && b_dim1 == 1 && b_dim2 == y_dim2) {
+        LaunchPartialBroadcast<T, K, binary_func, XYZ2XZFunctor<K>, broadcast_a>(
+            ctx, n, y_ptr, full, broadcast, XYZ2XZFunctor<K>(y_dim1, y_dim2));
+        return true;
       }
-      if (y.host_shape().NumAxes() == 3) {
-        const K y_dim0 = y.host_shape().At(0);
-        const K y_dim1 = y.host_shape().At(1);
-        const K y_dim2 = y.host_shape().At(2);
-        const K b_dim0 = b.host_shape().At(0);
-        const K b_dim1 = b.host_shape().At(1);
-        const K b_dim2 = b.host_shape().At(2);
-        if (b_dim0 == y_dim0 && b_dim1 == 1 && b_dim2 == y_dim2) {
-          XYZ2XZFunctor<K> xyz2xz(y_dim1, y_dim2);
-          RUN_CUDA_KERNEL((PartialBroadcastGpu<T, K, binary_func, XYZ2XZFunctor<K>>), ctx, n, n,
-                          y.host_ptr(), a.host_ptr(), b.host_ptr(), xyz2xz);
-          return true;
-        }
-        if (b_dim0 == 1 && b_dim1 == y_dim1 && b_dim2 == 1) {
-          XYZ2YFunctor<K> xyz2y(y_dim1, y_dim2);
-          RUN_CUDA_KERNEL((PartialBroadcastGpu<T, K, binary_func, XYZ2YFunctor<K>>), ctx, n, n,
-                          y.host_ptr(), a.host_ptr(), b.host_ptr(), xyz2y);
-          return true;
-        }
+      if (b_dim0 == 1 && b_dim1 == y_dim1 && b_dim2 == 1) {
+        LaunchPartialBroadcast<T, K, binary_func, XYZ2YFunctor<K>, broadcast_a>(
+            ctx, n, y_ptr, full, broadcast, XYZ2YFunctor<K>(y_dim1, y_dim2));
+        return true;
       }
     }
     return false;
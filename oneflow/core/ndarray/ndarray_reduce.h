@@ -53,6 +53,8 @@ struct NdarrayReduce<
       NdarrayXYZCubeYReduce<device_type, T, binary_func>::Reduce(ctx, y, x, tmp_storage);
     } else if (NdarrayXYZCubeXZReduce<device_type, T, binary_func>::Matched(y, x)) {
       NdarrayXYZCubeXZReduce<device_type, T, binary_func>::Reduce(ctx, y, x, tmp_storage);
+    } else if (NdarrayMultiAxisReduce<device_type, T, binary_func>::Matched(y, x)) {
+      NdarrayMultiAxisReduce<device_type, T, binary_func>::Reduce(ctx, y, x, tmp_storage);
     } else {
       NdarrayDefaultReduce<device_type, T, binary_func>::Reduce(ctx, y, x, tmp_storage);
     }
@@ -0,0 +1,74 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_NDARRAY_NDARRAY_REDUCE_BINARY_H_
+#define ONEFLOW_CORE_NDARRAY_NDARRAY_REDUCE_BINARY_H_
+
+#include "oneflow/core/ndarray/ndarray_reduce_binary_core.h"
+
+namespace oneflow {
+
+// y = reduce_func(binary_func(a, b)) over the axes where y has dim 1, with a and b broadcast
+// to their common shape. The broadcast result is never materialized, each element of y is
+// reduced straight from a and b in a single pass.
+template<DeviceType device_type, typename T, template<typename> class binary_func,
+         template<typename> class reduce_func>
+struct NdarrayReduceBinary final {
+  static void Reduce(DeviceCtx* ctx, const XpuVarNdarray<T>& y, const XpuVarNdarray<const T>& a,
+                     const XpuVarNdarray<const T>& b) {
+    const int num_axes = y.shape().NumAxes();
+    CHECK_EQ(a.shape().NumAxes(), num_axes);
+    CHECK_EQ(b.shape().NumAxes(), num_axes);
+    if (y.shape().ElemNum() == 0) { return; }
+    NdarrayReduceBinaryParams params{};
+    int64_t a_stride = 1;
+    int64_t b_stride = 1;
+    for (int i = num_axes - 1; i >= 0; --i) {
+      const int64_t a_dim = a.shape().At(i);
+      const int64_t b_dim = b.shape().At(i);
+      const int64_t dim = std::max(a_dim, b_dim);
+      CHECK(a_dim == dim || a_dim == 1);
+      CHECK(b_dim == dim || b_dim == 1);
+      CHECK(y.shape().At(i) == dim || y.shape().At(i) == 1);
+      CHECK_GT(dim, 0);
+      if (dim != 1) {
+        const bool reduced = y.shape().At(i) == 1;
+        int* cnt = reduced ? &params.num_reduced_axes : &params.num_kept_axes;
+        CHECK_LT(*cnt, kMaxReduceBinaryDims);
+        (reduced ? params.reduced_dims : params.kept_dims)[*cnt] = dim;
+        (reduced ? params.reduced_a_strides : params.kept_a_strides)[*cnt] =
+            a_dim == 1 ? 0 : a_stride;
+        (reduced ? params.reduced_b_strides : params.kept_b_strides)[*cnt] =
+            b_dim == 1 ? 0 : b_stride;
+        *cnt += 1;
+      }
+      a_stride *= a_dim;
+      b_stride *= b_dim;
+    }
+    // the axes were collected from the last one, the core walks them from the first one
+    std::reverse(params.kept_dims, params.kept_dims + params.num_kept_axes);
+    std::reverse(params.kept_a_strides, params.kept_a_strides + params.num_kept_axes);
+    std::reverse(params.kept_b_strides, params.kept_b_strides + params.num_kept_axes);
+    std::reverse(params.reduced_dims, params.reduced_dims + params.num_reduced_axes);
+    std::reverse(params.reduced_a_strides, params.reduced_a_strides + params.num_reduced_axes);
+    std::reverse(params.reduced_b_strides, params.reduced_b_strides + params.num_reduced_axes);
+    NdarrayReduceBinaryCoreWrapper<device_type, T, binary_func, reduce_func>::Reduce(ctx, y, a, b,
+                                                                                     params);
+  }
+};
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_NDARRAY_NDARRAY_REDUCE_BINARY_H_
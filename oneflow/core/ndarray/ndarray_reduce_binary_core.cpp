@@ -0,0 +1,52 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/ndarray/ndarray_reduce_binary_core.h"
+#include "oneflow/core/device/device_context.h"
+
+namespace oneflow {
+
+template<typename T, template<typename> class binary_func, template<typename> class reduce_func>
+struct NdarrayReduceBinaryCoreWrapper<DeviceType::kCPU, T, binary_func, reduce_func> final {
+  static void Reduce(DeviceCtx* ctx, const XpuVarNdarray<T>& y, const XpuVarNdarray<const T>& a,
+                     const XpuVarNdarray<const T>& b, const NdarrayReduceBinaryParams& params) {
+    using Core = NdarrayReduceBinaryCore<T, binary_func, reduce_func>;
+    const int64_t y_elem_cnt = y.shape().ElemNum();
+    int64_t reduce_cnt = 1;
+    FOR_RANGE(int, i, 0, params.num_reduced_axes) { reduce_cnt *= params.reduced_dims[i]; }
+    T* y_ptr = y.ptr();
+    const T* a_ptr = a.ptr();
+    const T* b_ptr = b.ptr();
+    ctx->ParallelFor(y_elem_cnt, ParallelForGrainSize(reduce_cnt), [&](int64_t begin, int64_t end) {
+      FOR_RANGE(int64_t, i, begin, end) {
+        int64_t a_offset = 0;
+        int64_t b_offset = 0;
+        Core::Offsets(i, params.num_kept_axes, params.kept_dims, params.kept_a_strides,
+                      params.kept_b_strides, &a_offset, &b_offset);
+        y_ptr[i] = Core::ReduceRange(params, a_ptr + a_offset, b_ptr + b_offset, 0, reduce_cnt, 1,
+                                     UnitOfBinaryFunc<T, reduce_func>::Val());
+      }
+    });
+  }
+};
+
+#define INSTANTIATE_NDARRAY_REDUCE_BINARY_CORE_WRAPPER(dtype_pair, binary_func)                  \
+  template struct NdarrayReduceBinaryCoreWrapper<DeviceType::kCPU, OF_PP_PAIR_FIRST(dtype_pair), \
+                                                 binary_func, BinaryFuncSum>;
+OF_PP_SEQ_PRODUCT_FOR_EACH_TUPLE(INSTANTIATE_NDARRAY_REDUCE_BINARY_CORE_WRAPPER,
+                                 ARITHMETIC_DATA_TYPE_SEQ FLOAT16_DATA_TYPE_SEQ,
+                                 REDUCE_BROADCAST_BINARY_FUNC_SEQ);
+
+}  // namespace oneflow
@@ -0,0 +1,103 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/ndarray/ndarray_reduce_binary_core.h"
+#include "oneflow/core/cuda/reduce.cuh"
+#include <cub/cub.cuh>
+
+namespace oneflow {
+
+namespace {
+
+constexpr int kReduceBinaryBlockSize = 256;
+
+template<typename T, template<typename> class reduce_func>
+struct ReduceBinaryReduceOp {
+  __device__ __forceinline__ T operator()(const T& a, const T& b) const {
+    return reduce_func<T>::Invoke(a, b);
+  }
+};
+
+// One warp per element of y, for short reductions over many elements of y.
+template<typename T, template<typename> class binary_func, template<typename> class reduce_func>
+__global__ void ReduceBinaryWarpGpu(int64_t y_elem_cnt, int64_t reduce_cnt,
+                                    NdarrayReduceBinaryParams params, const T* a, const T* b,
+                                    T* y) {
+  using Core = NdarrayReduceBinaryCore<T, binary_func, reduce_func>;
+  const int lane = threadIdx.x % kCudaWarpSize;
+  const int64_t num_warps = static_cast<int64_t>(gridDim.x) * (blockDim.x / kCudaWarpSize);
+  for (int64_t i = (blockIdx.x * blockDim.x + threadIdx.x) / kCudaWarpSize; i < y_elem_cnt;
+       i += num_warps) {
+    int64_t a_offset = 0;
+    int64_t b_offset = 0;
+    Core::Offsets(i, params.num_kept_axes, params.kept_dims, params.kept_a_strides,
+                  params.kept_b_strides, &a_offset, &b_offset);
+    T acc = Core::ReduceRange(params, a + a_offset, b + b_offset, lane, reduce_cnt, kCudaWarpSize,
+                              UnitOfBinaryFunc<T, reduce_func>::Val());
+    acc = cuda::reduce::WarpReduce(ReduceBinaryReduceOp<T, reduce_func>(), acc);
+    if (lane == 0) { y[i] = acc; }
+  }
+}
+
+// One block per element of y, for long reductions over few elements of y.
+template<typename T, template<typename> class binary_func, template<typename> class reduce_func>
+__global__ void ReduceBinaryBlockGpu(int64_t y_elem_cnt, int64_t reduce_cnt,
+                                     NdarrayReduceBinaryParams params, const T* a, const T* b,
+                                     T* y) {
+  using Core = NdarrayReduceBinaryCore<T, binary_func, reduce_func>;
+  using BlockReduce = cub::BlockReduce<T, kReduceBinaryBlockSize>;
+  __shared__ typename BlockReduce::TempStorage temp_storage;
+  for (int64_t i = blockIdx.x; i < y_elem_cnt; i += gridDim.x) {
+    int64_t a_offset = 0;
+    int64_t b_offset = 0;
+    Core::Offsets(i, params.num_kept_axes, params.kept_dims, params.kept_a_strides,
+                  params.kept_b_strides, &a_offset, &b_offset);
+    T acc = Core::ReduceRange(params, a + a_offset, b + b_offset, threadIdx.x, reduce_cnt,
+                              kReduceBinaryBlockSize, UnitOfBinaryFunc<T, reduce_func>::Val());
+    acc = BlockReduce(temp_storage).Reduce(acc, ReduceBinaryReduceOp<T, reduce_func>());
+    if (threadIdx.x == 0) { y[i] = acc; }
+    __syncthreads();
+  }
+}
+
+}  // namespace
+
+template<typename T, template<typename> class binary_func, template<typename> class reduce_func>
+struct NdarrayReduceBinaryCoreWrapper<DeviceType::kGPU, T, binary_func, reduce_func> final {
+  static void Reduce(DeviceCtx* ctx, const XpuVarNdarray<T>& y, const XpuVarNdarray<const T>& a,
+                     const XpuVarNdarray<const T>& b, const NdarrayReduceBinaryParams& params) {
+    const int64_t y_elem_cnt = y.host_shape().HostElemNum();
+    int64_t reduce_cnt = 1;
+    FOR_RANGE(int, i, 0, params.num_reduced_axes) { reduce_cnt *= params.reduced_dims[i]; }
+    if (reduce_cnt >= kReduceBinaryBlockSize * 4 && y_elem_cnt < kCudaMaxBlocksNum) {
+      ReduceBinaryBlockGpu<T, binary_func, reduce_func>
+          <<<y_elem_cnt, kReduceBinaryBlockSize, 0, ctx->cuda_stream()>>>(
+              y_elem_cnt, reduce_cnt, params, a.host_ptr(), b.host_ptr(), y.host_ptr());
+    } else {
+      RUN_CUDA_KERNEL((ReduceBinaryWarpGpu<T, binary_func, reduce_func>), ctx,
+                      y_elem_cnt * kCudaWarpSize, y_elem_cnt, reduce_cnt, params, a.host_ptr(),
+                      b.host_ptr(), y.host_ptr());
+    }
+  }
+};
+
+#define INSTANTIATE_NDARRAY_REDUCE_BINARY_CORE_WRAPPER(dtype_pair, binary_func)                  \
+  template struct NdarrayReduceBinaryCoreWrapper<DeviceType::kGPU, OF_PP_PAIR_FIRST(dtype_pair), \
+                                                 binary_func, BinaryFuncSum>;
+OF_PP_SEQ_PRODUCT_FOR_EACH_TUPLE(INSTANTIATE_NDARRAY_REDUCE_BINARY_CORE_WRAPPER,
+                                 ARITHMETIC_DATA_TYPE_SEQ HALF_DATA_TYPE_SEQ,
+                                 REDUCE_BROADCAST_BINARY_FUNC_SEQ);
+
+}  // namespace oneflow
@@ -0,0 +1,83 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_NDARRAY_NDARRAY_REDUCE_BINARY_CORE_H_
+#define ONEFLOW_CORE_NDARRAY_NDARRAY_REDUCE_BINARY_CORE_H_
+
+#include "oneflow/core/ndarray/xpu_util.h"
+#include "oneflow/core/ndarray/xpu_var_ndarray.h"
+#include "oneflow/core/ndarray/binary_func.h"
+#include "oneflow/core/kernel/kernel_util.h"
+
+namespace oneflow {
+
+#define REDUCE_BROADCAST_BINARY_FUNC_NAME_SEQ (Add)(Sub)(Mul)(Div)
+#define REDUCE_BROADCAST_BINARY_FUNC_SEQ \
+  OF_PP_SEQ_MAP(PREPEND_PREFIX_BINARY_FUNC, REDUCE_BROADCAST_BINARY_FUNC_NAME_SEQ)
+
+constexpr int kMaxReduceBinaryDims = 8;
+
+// Axes of the broadcast shape of a and b, split into the axes kept in y and the reduced ones.
+// A stride is 0 on the axes an operand is broadcast along.
+struct NdarrayReduceBinaryParams {
+  int num_kept_axes;
+  int num_reduced_axes;
+  int64_t kept_dims[kMaxReduceBinaryDims];
+  int64_t kept_a_strides[kMaxReduceBinaryDims];
+  int64_t kept_b_strides[kMaxReduceBinaryDims];
+  int64_t reduced_dims[kMaxReduceBinaryDims];
+  int64_t reduced_a_strides[kMaxReduceBinaryDims];
+  int64_t reduced_b_strides[kMaxReduceBinaryDims];
+};
+
+template<DeviceType device_type, typename T, template<typename> class binary_func,
+         template<typename> class reduce_func>
+struct NdarrayReduceBinaryCoreWrapper final {
+  static void Reduce(DeviceCtx* ctx, const XpuVarNdarray<T>& y, const XpuVarNdarray<const T>& a,
+                     const XpuVarNdarray<const T>& b, const NdarrayReduceBinaryParams& params);
+};
+
+template<typename T, template<typename> class binary_func, template<typename> class reduce_func>
+struct NdarrayReduceBinaryCore final {
+  OF_DEVICE_FUNC static void Offsets(int64_t idx, int num_axes, const int64_t* dims,
+                                     const int64_t* a_strides, const int64_t* b_strides,
+                                     int64_t* a_offset, int64_t* b_offset) {
+    *a_offset = 0;
+    *b_offset = 0;
+    for (int i = num_axes - 1; i >= 0; --i) {
+      const int64_t coord = idx % dims[i];
+      *a_offset += coord * a_strides[i];
+      *b_offset += coord * b_strides[i];
+      idx /= dims[i];
+    }
+  }
+
+  // Folds binary_func(a, b) of the reduced elements [begin, end) with step into acc.
+  OF_DEVICE_FUNC static T ReduceRange(const NdarrayReduceBinaryParams& params, const T* a,
+                                      const T* b, int64_t begin, int64_t end, int64_t step, T acc) {
+    for (int64_t j = begin; j < end; j += step) {
+      int64_t a_offset = 0;
+      int64_t b_offset = 0;
+      Offsets(j, params.num_reduced_axes, params.reduced_dims, params.reduced_a_strides,
+              params.reduced_b_strides, &a_offset, &b_offset);
+      acc = reduce_func<T>::Invoke(acc, binary_func<T>::Invoke(a[a_offset], b[b_offset]));
+    }
+    return acc;
+  }
+};
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_NDARRAY_NDARRAY_REDUCE_BINARY_CORE_H_
@@ -17,6 +17,7 @@ limitations under the License.
 #include "oneflow/core/common/preprocessor.h"
 #include "oneflow/core/ndarray/ndarray_reduce_impl.h"
 #include "oneflow/core/ndarray/binary_func.h"
+#include "oneflow/core/device/device_context.h"
 
 namespace oneflow {
 
@@ -36,6 +37,7 @@ SPECIALIZE_CPU_NDARRAY_REDUCE_IMPL(NdarrayMatrixRowReduce);
 SPECIALIZE_CPU_NDARRAY_REDUCE_IMPL(NdarrayMatrixColReduce);
 SPECIALIZE_CPU_NDARRAY_REDUCE_IMPL(NdarrayXYZCubeYReduce);
 SPECIALIZE_CPU_NDARRAY_REDUCE_IMPL(NdarrayXYZCubeXZReduce);
+SPECIALIZE_CPU_NDARRAY_REDUCE_IMPL(NdarrayMultiAxisReduce);
 #undef SPECIALIZE_CPU_NDARRAY_REDUCE_IMPL
 
 #define INSTANTIATE_NDARRAY_REDUCE_IMPL(dtype, binary_func)                                       \
@@ -43,7 +45,8 @@ SPECIALIZE_CPU_NDARRAY_REDUCE_IMPL(NdarrayXYZCubeXZReduce);
   template struct NdarrayMatrixRowReduce<DeviceType::kCPU, OF_PP_PAIR_FIRST(dtype), binary_func>; \
   template struct NdarrayMatrixColReduce<DeviceType::kCPU, OF_PP_PAIR_FIRST(dtype), binary_func>; \
   template struct NdarrayXYZCubeYReduce<DeviceType::kCPU, OF_PP_PAIR_FIRST(dtype), binary_func>;  \
-  template struct NdarrayXYZCubeXZReduce<DeviceType::kCPU, OF_PP_PAIR_FIRST(dtype), binary_func>;
+  template struct NdarrayXYZCubeXZReduce<DeviceType::kCPU, OF_PP_PAIR_FIRST(dtype), binary_func>; \
+  template struct NdarrayMultiAxisReduce<DeviceType::kCPU, OF_PP_PAIR_FIRST(dtype), binary_func>;
 OF_PP_SEQ_PRODUCT_FOR_EACH_TUPLE(INSTANTIATE_NDARRAY_REDUCE_IMPL,
                                  ARITHMETIC_DATA_TYPE_SEQ FLOAT16_DATA_TYPE_SEQ,
                                  REDUCE_BINARY_FUNC_SEQ);
@@ -52,7 +55,13 @@ template<typename T, int NDIMS, template<typename> class binary_func>
 struct NdarrayReduceCoreWrapper<DeviceType::kCPU, T, NDIMS, binary_func> final {
   static void ReduceAxis(DeviceCtx* ctx, const XpuReducedNdarray<T, NDIMS>& dst_reduced,
                          const XpuReducedNdarray<T, NDIMS>& x, int axis) {
-    NdarrayReduceCore<T, NDIMS, binary_func>::ReduceAxis(dst_reduced, x, axis);
+    const int64_t n = dst_reduced.shape().ElemNum();
+    const int64_t cost_per_elem = x.shape().At(axis) / dst_reduced.shape().At(axis);
+    ctx->ParallelFor(n, ParallelForGrainSize(cost_per_elem), [&](int64_t begin, int64_t end) {
+      FOR_RANGE(int64_t, i, begin, end) {
+        NdarrayReduceCore<T, NDIMS, binary_func>::ReduceElem(dst_reduced, x, axis, i);
+      }
+    });
   }
 };
 
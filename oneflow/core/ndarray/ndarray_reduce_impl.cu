@@ -19,6 +19,7 @@ limitations under the License.
 #include "oneflow/core/common/preprocessor.h"
 #include "oneflow/core/common/shape.h"
 #include "oneflow/core/common/permutation_iterator.h"
+#include "oneflow/core/cuda/reduce.cuh"
 
 namespace cub {
 struct Prod {
@@ -45,96 +46,64 @@ namespace oneflow {
 
 namespace {
 
-template<template<typename> class R, typename T, typename K>
-__global__ void MatrixColReduceBy1ThreadPerColumn(K num_elems, K num_cols, const T* in, T* out) {
-  CUDA_1D_KERNEL_LOOP_T(K, j, num_cols) {
-    K index = j;
-    T sum = in[index];
-    for (index += num_cols; index < num_elems; index += num_cols) {
-      sum = R<T>::Invoke(sum, in[index]);
-    }
-    out[j] = sum;
+template<typename T, template<typename> class binary_func>
+struct ReduceOp4BinaryFunc {
+  __device__ __forceinline__ T operator()(const T& a, const T& b) const {
+    return binary_func<T>::Invoke(a, b);
   }
-}
-
-template<typename T>
-struct WithAlign2 {
-  union {
-    T value;
-    int32_t padding;
-  };
 };
 
-template<template<typename> class R, typename T, typename K>
-__global__ void MatrixColReduceByWarpBlock(K num_elems, K num_cols, const T* in, T* out) {
-  const K thread_col = threadIdx.x % kCudaWarpSize;
-  const K thread_row = threadIdx.x / kCudaWarpSize;
-  const K thread_dim_row = blockDim.x / kCudaWarpSize;
-  const K num_valid_threads = thread_dim_row * num_cols;  // ASSERT: always <= num_elems
-  const K col = blockIdx.x * kCudaWarpSize + thread_col;
-  __shared__ WithAlign2<T> partial_values[kCudaWarpSize * kCudaWarpSize];
-  if (col < num_cols) {
-    K index = thread_row * num_cols + col;
-    T val = in[index];
-    for (index += num_valid_threads; index < num_elems; index += num_valid_threads) {
-      val = R<T>::Invoke(val, in[index]);
-    }
-    partial_values[threadIdx.x].value = val;
-  }
-  __syncthreads();
-  if (col < num_cols && thread_row == 0) {
-    int index = thread_col;
-    T val = partial_values[index].value;
-    for (index += kCudaWarpSize; index < blockDim.x; index += kCudaWarpSize) {
-      val = R<T>::Invoke(val, partial_values[index].value);
-    }
-    out[col] = val;
-  }
+template<typename T, template<typename> class binary_func>
+void OuterReduceInner(DeviceCtx* ctx, int64_t outer, int64_t reduce, int64_t inner, const T* x,
+                      T* y, const XpuVarNdarray<T>& tmp_storage) {
+  OF_CUDA_CHECK((cuda::reduce::OuterReduceInner<T, T, T>(
+      ctx->cuda_stream(), outer, reduce, inner, x, y, tmp_storage.host_ptr(),
+      tmp_storage.host_shape().HostElemNum() * sizeof(T), cuda::reduce::IdentityOp<T>(),
+      ReduceOp4BinaryFunc<T, binary_func>(), UnitOfBinaryFunc<T, binary_func>::Val(),
+      cuda::reduce::IdentityOp<T>())));
 }
 
-template<template<typename> class R, typename T, typename K>
-void MatrixColReduceBy1BlockLayer(DeviceCtx* ctx, K num_elems, K num_cols, const T* in, T* out) {
-  CHECK_LE(num_cols, kCudaMaxBlocksNum * kCudaWarpSize);
-  const K num_rows = num_elems / num_cols;
-  CHECK_GT(num_rows, 0);
-  if (num_rows < kCudaWarpSize) {
-    RUN_CUDA_KERNEL((MatrixColReduceBy1ThreadPerColumn<R, T, K>), ctx, num_cols, num_elems,
-                    num_cols, in, out);
-  } else {
-    const int num_blocks = (num_cols + kCudaWarpSize - 1) / kCudaWarpSize;
-    const int num_threads = kCudaWarpSize * kCudaWarpSize;
-    auto Reduce = &MatrixColReduceByWarpBlock<R, T, K>;
-    Reduce<<<num_blocks, num_threads, 0, ctx->cuda_stream()>>>(num_elems, num_cols, in, out);
-  }
-}
+constexpr int kMaxMultiAxisReduceDims = 6;
 
-const static int32_t kNumRows4OneBlockLayer = kCudaWarpSize * kCudaWarpSize;
-const static int32_t kNumCols4OneBlockLayer = kCudaMaxBlocksNum * kCudaWarpSize / 2;
-
-template<template<typename> class R, typename T, typename K>
-void MatrixColReduceK(DeviceCtx* ctx, K num_rows, K num_cols, const T* in, T* out, T* tmp) {
-  K num_elems = num_rows * num_cols;
-  if (num_rows < kNumRows4OneBlockLayer || num_cols > kNumCols4OneBlockLayer) {
-    MatrixColReduceBy1BlockLayer<R, T, K>(ctx, num_elems, num_cols, in, out);
-  } else {
-    int scale_shift = 1;
-    for (; true; ++scale_shift) {
-      if ((num_rows >> scale_shift) < kNumRows4OneBlockLayer) { break; }
-      if ((num_cols << scale_shift) > kNumCols4OneBlockLayer) { break; }
-    }
-    MatrixColReduceBy1BlockLayer<R, T, K>(ctx, num_elems, (num_cols << scale_shift), in, tmp);
-    // recursively calls MatrixColReduceK(...) log32(num_rows) times at most
-    MatrixColReduceK<R, T, K>(ctx, (1 << scale_shift), num_cols, tmp, out, tmp);
+// Offsets of the kept axes and the reduced axes of x, the kept axes are also the axes of y.
+struct MultiAxisReduceParams {
+  int num_kept_axes;
+  int num_reduced_axes;
+  int64_t kept_dims[kMaxMultiAxisReduceDims];
+  int64_t kept_strides[kMaxMultiAxisReduceDims];
+  int64_t reduced_dims[kMaxMultiAxisReduceDims];
+  int64_t reduced_strides[kMaxMultiAxisReduceDims];
+};
+
+__device__ __forceinline__ int64_t MultiAxisOffset(int64_t idx, int num_axes, const int64_t* dims,
+                                                   const int64_t* strides) {
+  int64_t offset = 0;
+  for (int i = num_axes - 1; i >= 0; --i) {
+    offset += (idx % dims[i]) * strides[i];
+    idx /= dims[i];
   }
+  return offset;
 }
 
-template<template<typename> class R, typename T>
-void MatrixColReduce(DeviceCtx* ctx, int64_t num_rows, int64_t num_cols, const T* in, T* out,
-                     T* tmp) {
-  if (IsKernelSafeInt32(num_rows * num_cols)) {
-    return MatrixColReduceK<R, T, int32_t>(ctx, num_rows, num_cols, in, out, tmp);
-  } else {
-    return MatrixColReduceK<R, T, int64_t>(ctx, num_rows, num_cols, in, out, tmp);
+// One warp per element of y reduces all the reduced axes at once, so reducing several
+// non-adjacent axes takes one pass instead of one pass per axis.
+template<typename T, template<typename> class binary_func>
+__global__ void MultiAxisReduceGpu(int64_t y_elem_cnt, int64_t reduce_cnt,
+                                   MultiAxisReduceParams params, const T* x, T* y) {
+  const ReduceOp4BinaryFunc<T, binary_func> reduce_op;
+  const int lane = threadIdx.x % kCudaWarpSize;
+  const int64_t num_warps = static_cast<int64_t>(gridDim.x) * (blockDim.x / kCudaWarpSize);
+  for (int64_t i = (blockIdx.x * blockDim.x + threadIdx.x) / kCudaWarpSize; i < y_elem_cnt;
+       i += num_warps) {
+    const T* x_i =
+        x + MultiAxisOffset(i, params.num_kept_axes, params.kept_dims, params.kept_strides);
+    T acc = UnitOfBinaryFunc<T, binary_func>::Val();
+    for (int64_t j = lane; j < reduce_cnt; j += kCudaWarpSize) {
+      acc = reduce_op(acc, x_i[MultiAxisOffset(j, params.num_reduced_axes, params.reduced_dims,
+                                               params.reduced_strides)]);
+    }
+    acc = cuda::reduce::WarpReduce(reduce_op, acc);
+    if (lane == 0) { y[i] = acc; }
   }
 }
 
@@ -193,23 +162,8 @@ struct NdarrayMatrixRowReduce<DeviceType::kGPU, T, binary_func> final {
   static void Reduce(DeviceCtx* ctx, const XpuVarNdarray<T>& y, const XpuVarNdarray<const T>& x,
                      const XpuVarNdarray<T>& tmp_storage) {
     CHECK(Matched(y, x));
-    int32_t num_rows = y.shape().ElemNum();
-    int32_t num_cols = x.shape().ElemNum() / y.shape().ElemNum();
-    RowOffsetFunctor get_row_offset(num_cols);
-    cub::CountingInputIterator<int32_t> counting_intput_it(0);
-    cub::TransformInputIterator<int32_t, RowOffsetFunctor, cub::CountingInputIterator<int32_t>>
-        transform_input_iter(counting_intput_it, get_row_offset);
-    size_t tmp_storage_bytes = 0;
-    auto DoReduce = [&](T* tmp_storage_ptr) {
-      int retcode = cub::DeviceSegmentedReduce::Reduce(
-          tmp_storage_ptr, tmp_storage_bytes, x.ptr(), y.ptr(), num_rows, transform_input_iter,
-          transform_input_iter + 1, typename CubFunctor4BianryFunc<T, binary_func>::type(),
-          UnitOfBinaryFunc<T, binary_func>::Val(), ctx->cuda_stream());
-      CHECK_EQ(retcode, 0) << "cub::DeviceSegmentedReduce::Reduce error";
-    };
-    DoReduce(nullptr);
-    CHECK_GE(tmp_storage.shape().ElemNum() * sizeof(T), tmp_storage_bytes);
-    DoReduce(tmp_storage.ptr());
+    OuterReduceInner<T, binary_func>(ctx, x.shape().At(0), x.shape().At(1), 1, x.host_ptr(),
+                                     y.host_ptr(), tmp_storage);
   }
 };
 
@@ -222,57 +176,17 @@ struct NdarrayMatrixColReduce<DeviceType::kGPU, T, binary_func> final {
     return y.shape().At(0) == 1 && x.shape().At(1) == y.shape().At(1);
   }
 
-  struct XY2YXFunctor final {
-    __host__ __device__ XY2YXFunctor(int32_t dim_x, int32_t dim_y) : dim_x_(dim_x), dim_y_(dim_y) {}
-
-    __host__ __device__ int32_t operator()(const int32_t& idx) const {
-      const int32_t y = idx / dim_x_;
-      const int32_t x = idx % dim_x_;
-      return x * dim_y_ + y;
-    }
-
-    int32_t dim_x_;
-    int32_t dim_y_;
-  };
-
   static void Reduce(DeviceCtx* ctx, const XpuVarNdarray<T>& y, const XpuVarNdarray<const T>& x,
                      const XpuVarNdarray<T>& tmp_storage) {
     CHECK(Matched(y, x));
-    int64_t num_rows = x.shape().At(0);
-    int64_t num_cols = x.shape().At(1);
-    if (num_cols < kNumCols4OneBlockLayer) {
-      return MatrixColReduce<binary_func, T>(ctx, num_rows, num_cols, x.host_ptr(), y.host_ptr(),
-                                             tmp_storage.host_ptr());
-    }
-    RowOffsetFunctor get_row_offset(num_rows);
-    cub::CountingInputIterator<int32_t> counting_intput_it(0);
-    cub::TransformInputIterator<int32_t, RowOffsetFunctor, cub::CountingInputIterator<int32_t>>
-        transform_input_iter(counting_intput_it, get_row_offset);
-
-    XY2YXFunctor xy2yx(x.shape().At(0), x.shape().At(1));
-    using XY2YxIndexIter =
-        cub::TransformInputIterator<int32_t, XY2YXFunctor, cub::CountingInputIterator<int32_t>>;
-    XY2YxIndexIter xy2yx_iter(counting_intput_it, xy2yx);
-    PermutationIterator<const T, const T*, XY2YxIndexIter> x_iter(x.ptr(), xy2yx_iter);
-    size_t tmp_storage_bytes = 0;
-    auto DoReduce = [&](T* tmp_storage_ptr) {
-      int retcode = cub::DeviceSegmentedReduce::Reduce(
-          tmp_storage_ptr, tmp_storage_bytes, x_iter, y.ptr(), num_cols, transform_input_iter,
-          transform_input_iter + 1, typename CubFunctor4BianryFunc<T, binary_func>::type(),
-          UnitOfBinaryFunc<T, binary_func>::Val(), ctx->cuda_stream());
-      CHECK_EQ(retcode, 0) << "cub::DeviceSegmentedReduce::Reduce error";
-    };
-    DoReduce(nullptr);
-    CHECK_GE(tmp_storage.shape().ElemNum() * sizeof(T), tmp_storage_bytes);
-    DoReduce(tmp_storage.ptr());
+    OuterReduceInner<T, binary_func>(ctx, 1, x.shape().At(0), x.shape().At(1), x.host_ptr(),
+                                     y.host_ptr(), tmp_storage);
   }
 };
 
 template<typename T, template<typename> class binary_func>
 struct NdarrayXYZCubeYReduce<DeviceType::kGPU, T, binary_func> final {
   static bool Matched(const XpuVarNdarray<T>& y, const XpuVarNdarray<const T>& x) {
-    return false;
-    if (y.shape().ElemNum() > GetMaxVal<int32_t>()) { return false; }
     if (x.shape().NumAxes() != 3) { return false; }
     if (y.shape().NumAxes() != 3) { return false; }
     return x.shape().At(0) == y.shape().At(0) && y.shape().At(1) == 1
@@ -282,7 +196,8 @@ struct NdarrayXYZCubeYReduce<DeviceType::kGPU, T, binary_func> final {
   static void Reduce(DeviceCtx* ctx, const XpuVarNdarray<T>& y, const XpuVarNdarray<const T>& x,
                      const XpuVarNdarray<T>& tmp_storage) {
     CHECK(Matched(y, x));
-    UNIMPLEMENTED();
+    OuterReduceInner<T, binary_func>(ctx, x.shape().At(0), x.shape().At(1), x.shape().At(2),
+                                     x.host_ptr(), y.host_ptr(), tmp_storage);
   }
 };
 
@@ -342,6 +257,43 @@ struct NdarrayXYZCubeXZReduce<DeviceType::kGPU, T, binary_func> final {
   }
 };
 
+template<typename T, template<typename> class binary_func>
+struct NdarrayMultiAxisReduce<DeviceType::kGPU, T, binary_func> final {
+  static bool Matched(const XpuVarNdarray<T>& y, const XpuVarNdarray<const T>& x) {
+    return x.shape().NumAxes() <= kMaxMultiAxisReduceDims;
+  }
+
+  static void Reduce(DeviceCtx* ctx, const XpuVarNdarray<T>& y, const XpuVarNdarray<const T>& x,
+                     const XpuVarNdarray<T>& tmp_storage) {
+    CHECK(Matched(y, x));
+    MultiAxisReduceParams params{};
+    int64_t stride = 1;
+    for (int i = x.shape().NumAxes() - 1; i >= 0; --i) {
+      const int64_t dim = x.shape().At(i);
+      if (y.shape().At(i) == 1 && dim != 1) {
+        params.reduced_dims[params.num_reduced_axes] = dim;
+        params.reduced_strides[params.num_reduced_axes] = stride;
+        params.num_reduced_axes += 1;
+      } else {
+        params.kept_dims[params.num_kept_axes] = dim;
+        params.kept_strides[params.num_kept_axes] = stride;
+        params.num_kept_axes += 1;
+      }
+      stride *= dim;
+    }
+    // the axes were collected from the last one, MultiAxisOffset wants them from the first one
+    std::reverse(params.kept_dims, params.kept_dims + params.num_kept_axes);
+    std::reverse(params.kept_strides, params.kept_strides + params.num_kept_axes);
+    std::reverse(params.reduced_dims, params.reduced_dims + params.num_reduced_axes);
+    std::reverse(params.reduced_strides, params.reduced_strides + params.num_reduced_axes);
+    const int64_t y_elem_cnt = y.shape().ElemNum();
+    const int64_t reduce_cnt = x.shape().ElemNum() / y_elem_cnt;
+    const int64_t num_threads = y_elem_cnt * kCudaWarpSize;
+    RUN_CUDA_KERNEL((MultiAxisReduceGpu<T, binary_func>), ctx, num_threads, y_elem_cnt, reduce_cnt,
+                    params, x.host_ptr(), y.host_ptr());
+  }
+};
+
 namespace {
 
 template<typename T, int NDIMS, template<typename> class binary_func>
@@ -367,7 +319,8 @@ struct NdarrayReduceCoreWrapper<DeviceType::kGPU, T, NDIMS, binary_func> final {
   template struct NdarrayMatrixRowReduce<DeviceType::kGPU, OF_PP_PAIR_FIRST(dtype), binary_func>; \
   template struct NdarrayMatrixColReduce<DeviceType::kGPU, OF_PP_PAIR_FIRST(dtype), binary_func>; \
   template struct NdarrayXYZCubeYReduce<DeviceType::kGPU, OF_PP_PAIR_FIRST(dtype), binary_func>;  \
-  template struct NdarrayXYZCubeXZReduce<DeviceType::kGPU, OF_PP_PAIR_FIRST(dtype), binary_func>;
+  template struct NdarrayXYZCubeXZReduce<DeviceType::kGPU, OF_PP_PAIR_FIRST(dtype), binary_func>; \
+  template struct NdarrayMultiAxisReduce<DeviceType::kGPU, OF_PP_PAIR_FIRST(dtype), binary_func>;
 OF_PP_SEQ_PRODUCT_FOR_EACH_TUPLE(INSTANTIATE_NDARRAY_REDUCE_IMPL,
                                  ARITHMETIC_DATA_TYPE_SEQ HALF_DATA_TYPE_SEQ,
                                  REDUCE_BINARY_FUNC_SEQ);
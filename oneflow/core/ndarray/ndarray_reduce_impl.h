@@ -36,6 +36,7 @@ DECLARE_NDARRAY_REDUCE_IMPL(NdarrayMatrixRowReduce);
 DECLARE_NDARRAY_REDUCE_IMPL(NdarrayMatrixColReduce);
 DECLARE_NDARRAY_REDUCE_IMPL(NdarrayXYZCubeYReduce);
 DECLARE_NDARRAY_REDUCE_IMPL(NdarrayXYZCubeXZReduce);
+DECLARE_NDARRAY_REDUCE_IMPL(NdarrayMultiAxisReduce);
 #undef DECLARE_NDARRAY_REDUCE_IMPL
 
 template<DeviceType device_type, typename T, template<typename> class binary_func>
@@ -106,18 +107,23 @@ struct NdarrayReduceCore final {
   OF_DEVICE_FUNC static void ReduceAxis(const XpuReducedNdarray<T, NDIMS>& dst_reduced, const X& x,
                                         int axis) {
     size_t n = dst_reduced.shape().ElemNum();
+    XPU_1D_KERNEL_LOOP(i, n) { ReduceElem(dst_reduced, x, axis, i); }
+  }
+
+  // reduces the i-th element of dst_reduced, which is independent of the other elements
+  template<typename X>
+  OF_DEVICE_FUNC static void ReduceElem(const XpuReducedNdarray<T, NDIMS>& dst_reduced, const X& x,
+                                        int axis, int64_t i) {
     int64_t dst_dim_val = dst_reduced.shape().At(axis);
-    XPU_1D_KERNEL_LOOP(i, n) {
-      T* dst_reduced_ptr = dst_reduced.template Mut(i);
-      int64_t coord[NDIMS];
-      dst_reduced.shape().template Offset2Coordinate<NDIMS>(i, coord);
-      T reduced = UnitOfBinaryFunc<T, binary_func>::Val();
-      while (coord[axis] < x.shape().At(axis)) {
-        reduced = binary_func<T>::Invoke(reduced, x.template Get<NDIMS>(coord));
-        coord[axis] += dst_dim_val;
-      }
-      *dst_reduced_ptr = reduced;
+    T* dst_reduced_ptr = dst_reduced.template Mut(i);
+    int64_t coord[NDIMS];
+    dst_reduced.shape().template Offset2Coordinate<NDIMS>(i, coord);
+    T reduced = UnitOfBinaryFunc<T, binary_func>::Val();
+    while (coord[axis] < x.shape().At(axis)) {
+      reduced = binary_func<T>::Invoke(reduced, x.template Get<NDIMS>(coord));
+      coord[axis] += dst_dim_val;
     }
+    *dst_reduced_ptr = reduced;
   }
 };
 
@@ -20,6 +20,7 @@ limitations under the License.
 #include "oneflow/core/ndarray/xpu_var_ndarray.h"
 #include "oneflow/core/ndarray/xpu_var_ndarray_builder.h"
 #include "oneflow/core/ndarray/ndarray_reduce.h"
+#include "oneflow/core/ndarray/ndarray_reduce_binary.h"
 #include "oneflow/core/ndarray/ndarray_apply_unary.h"
 #include "oneflow/core/ndarray/ndarray_apply_binary.h"
 #include "oneflow/core/ndarray/ndarray_apply_broadcast_unary.h"
@@ -139,6 +140,17 @@ struct NdarrayUtil final {
   OF_PP_FOR_EACH_ATOMIC(DEFINE_REDUCE_FUNC, REDUCE_BINARY_FUNC_NAME_SEQ)
 #undef DEFINE_REDUCE_FUNC
 
+#define DEFINE_REDUCE_SUM_BROADCAST_BINARY_FUNC(func_name)                                    \
+  static void ReduceSumBroadcast##func_name(DeviceCtx* ctx, const XpuVarNdarray<T>& y,        \
+                                            const XpuVarNdarray<const T>& a,                  \
+                                            const XpuVarNdarray<const T>& b) {                \
+    return NdarrayReduceBinary<device_type, T, BinaryFunc##func_name, BinaryFuncSum>::Reduce( \
+        ctx, y, a, b);                                                                        \
+  }
+  OF_PP_FOR_EACH_ATOMIC(DEFINE_REDUCE_SUM_BROADCAST_BINARY_FUNC,
+                        REDUCE_BROADCAST_BINARY_FUNC_NAME_SEQ)
+#undef DEFINE_REDUCE_SUM_BROADCAST_BINARY_FUNC
+
  private:
   template<template<typename> class unary_func>
   static void BroadcastApplyUnary(
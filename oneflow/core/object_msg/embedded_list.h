@@ -54,6 +54,10 @@ struct EmbeddedListLink {
     next_ = nullptr;
   }
 
+  // accessors for lock-free intrusive containers, e.g. ObjectMsgMpscList
+  EmbeddedListLink* AtomicNext() const { return __atomic_load_n(&next_, __ATOMIC_ACQUIRE); }
+  void AtomicSetNext(EmbeddedListLink* next) { __atomic_store_n(&next_, next, __ATOMIC_RELEASE); }
+
  private:
   void set_prev(EmbeddedListLink* prev) { prev_ = prev; }
   void set_next(EmbeddedListLink* next) { next_ = next; }
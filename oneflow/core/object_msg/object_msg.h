@@ -22,6 +22,8 @@ limitations under the License.
 #include "oneflow/core/object_msg/object_msg_flat.h"
 #include "oneflow/core/object_msg/object_msg_list.h"
 #include "oneflow/core/object_msg/object_msg_mutexed_list.h"
+#include "oneflow/core/object_msg/object_msg_mpsc_list.h"
+#include "oneflow/core/object_msg/object_msg_spsc_ring.h"
 #include "oneflow/core/object_msg/object_msg_condition_list.h"
 #include "oneflow/core/object_msg/object_msg_map.h"
 
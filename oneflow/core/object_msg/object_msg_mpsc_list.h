@@ -0,0 +1,249 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_OBJECT_MSG_MPSC_LIST_H_
+#define ONEFLOW_CORE_OBJECT_MSG_MPSC_LIST_H_
+
+#include <atomic>
+#include <limits>
+#include <thread>
+#include "oneflow/core/object_msg/object_msg_list.h"
+
+namespace oneflow {
+
+// Lock-free multi-producer single-consumer list built on EmbeddedListLink.
+// Producers may call EmplaceBack/MoveFrom concurrently, while only one consumer thread is allowed
+// to call MoveTo.
+#define OBJECT_MSG_DEFINE_MPSC_LIST_HEAD(elem_type, elem_field_name, field_name)                \
+  static_assert(__is_object_message_type__, "this struct is not a object message");             \
+  static_assert(!std::is_same<self_type, elem_type>::value, "self loop link is not supported"); \
+  OF_PRIVATE INCREASE_STATIC_COUNTER(field_counter);                                            \
+  _OBJECT_MSG_DEFINE_MPSC_LIST_HEAD(STATIC_COUNTER(field_counter), elem_type, elem_field_name,  \
+                                    field_name);
+
+#define OBJECT_MSG_MPSC_LIST(obj_msg_type, obj_msg_field)                              \
+  ObjectMsgMpscList<StructField<OBJECT_MSG_TYPE_CHECK(obj_msg_type), EmbeddedListLink, \
+                                OBJECT_MSG_TYPE_CHECK(obj_msg_type)::OF_PP_CAT(        \
+                                    obj_msg_field, _kDssFieldOffset)>>
+
+// details
+
+#define _OBJECT_MSG_DEFINE_MPSC_LIST_HEAD(field_counter, elem_type, elem_field_name, field_name) \
+  _OBJECT_MSG_DEFINE_MPSC_LIST_HEAD_FIELD(elem_type, elem_field_name, field_name)               \
+  OBJECT_MSG_DEFINE_MPSC_LIST_ELEM_STRUCT(field_counter, elem_type, elem_field_name,            \
+                                          field_name);                                          \
+  OBJECT_MSG_DEFINE_MPSC_LIST_LINK_EDGES(field_counter, elem_type, elem_field_name, field_name); \
+  OBJECT_MSG_OVERLOAD_INIT(field_counter, ObjectMsgEmbeddedMpscListHeadInit);                   \
+  OBJECT_MSG_OVERLOAD_DELETE(field_counter, ObjectMsgEmbeddedMpscListHeadDelete);               \
+  DSS_DEFINE_FIELD(field_counter, "object message", OF_PP_CAT(field_name, _ObjectMsgListType),  \
+                   OF_PP_CAT(field_name, _));
+
+#define _OBJECT_MSG_DEFINE_MPSC_LIST_HEAD_FIELD(elem_type, elem_field_name, field_name)        \
+ public:                                                                                       \
+  using OF_PP_CAT(field_name, _ObjectMsgListType) =                                            \
+      TrivialObjectMsgMpscList<StructField<OBJECT_MSG_TYPE_CHECK(elem_type), EmbeddedListLink, \
+                                           OBJECT_MSG_TYPE_CHECK(elem_type)::OF_PP_CAT(        \
+                                               elem_field_name, _kDssFieldOffset)>>;           \
+  const OF_PP_CAT(field_name, _ObjectMsgListType) & field_name() const {                       \
+    return OF_PP_CAT(field_name, _);                                                           \
+  }                                                                                            \
+  OF_PP_CAT(field_name, _ObjectMsgListType) * OF_PP_CAT(mut_, field_name)() {                  \
+    return &OF_PP_CAT(field_name, _);                                                          \
+  }                                                                                            \
+  OF_PP_CAT(field_name, _ObjectMsgListType) * OF_PP_CAT(mutable_, field_name)() {              \
+    return &OF_PP_CAT(field_name, _);                                                          \
+  }                                                                                            \
+                                                                                               \
+ private:                                                                                      \
+  OF_PP_CAT(field_name, _ObjectMsgListType) OF_PP_CAT(field_name, _);
+
+#define OBJECT_MSG_DEFINE_MPSC_LIST_ELEM_STRUCT(field_counter, elem_type, elem_field_name, \
+                                                field_name)                                \
+ public:                                                                                   \
+  template<typename Enabled>                                                               \
+  struct ContainerElemStruct<field_counter, Enabled> final {                               \
+    using type = elem_type;                                                                \
+  };
+
+#define OBJECT_MSG_DEFINE_MPSC_LIST_LINK_EDGES(field_counter, elem_type, elem_field_name, \
+                                               field_name)                                \
+ public:                                                                                  \
+  template<typename Enable>                                                               \
+  struct LinkEdgesGetter<field_counter, Enable> final {                                   \
+    static void Call(std::set<ObjectMsgContainerLinkEdge>* edges) {                       \
+      ObjectMsgContainerLinkEdge edge;                                                    \
+      edge.container_type_name = typeid(self_type).name();                                \
+      edge.container_field_name = OF_PP_STRINGIZE(field_name) "_";                        \
+      edge.elem_type_name = typeid(elem_type).name();                                     \
+      edge.elem_link_name = OF_PP_STRINGIZE(elem_field_name) "_";                         \
+      edges->insert(edge);                                                                \
+    }                                                                                     \
+  };
+
+template<typename WalkCtxType, typename PtrFieldType>
+struct ObjectMsgEmbeddedMpscListHeadInit {
+  static void Call(WalkCtxType* ctx, PtrFieldType* field) { field->__Init__(); }
+};
+
+template<typename WalkCtxType, typename PtrFieldType>
+struct ObjectMsgEmbeddedMpscListHeadDelete {
+  static void Call(WalkCtxType* ctx, PtrFieldType* field) { field->Clear(); }
+};
+
+// An intrusive variant of Dmitry Vyukov's MPSC queue. The `next_' pointer of the element link is
+// used as the queue link while the element is inside this container, so a single atomic exchange
+// on `tail_' pushes a whole batch of elements.
+template<typename LinkField>
+class TrivialObjectMsgMpscList {
+ public:
+  using value_type = typename LinkField::struct_type;
+  using SrcListType = TrivialObjectMsgList<kDisableSelfLoopLink, LinkField>;
+
+  static const int64_t kDefaultCapacity = 65536;
+
+  // approximate while producers are running
+  std::size_t size() const { return size_.load(std::memory_order_acquire); }
+  bool empty() const { return size() == 0; }
+
+  int64_t capacity() const { return capacity_; }
+  void set_capacity(int64_t capacity) { capacity_ = capacity; }
+
+  void __Init__() {
+    new (&this->size_) std::atomic<int64_t>(0);
+    stub_.NullptrClear();
+    head_ = &stub_;
+    new (&this->tail_) std::atomic<EmbeddedListLink*>(&stub_);
+    capacity_ = kDefaultCapacity;
+  }
+
+  // thread safe for producers
+  void EmplaceBack(ObjectMsgPtr<value_type>&& ptr) {
+    value_type* raw_ptr = nullptr;
+    ptr.__UnsafeMoveTo__(&raw_ptr);
+    EmbeddedListLink* link = LinkField::FieldPtr4StructPtr(raw_ptr);
+    link->NullptrClear();
+    WaitAndAcquireCapacity(1);
+    PushChain(link, link);
+  }
+
+  // thread safe for producers
+  void MoveFrom(SrcListType* src) {
+    const int64_t size = src->size();
+    if (size == 0) { return; }
+    EmbeddedListLink* first = nullptr;
+    EmbeddedListLink* last = nullptr;
+    while (!src->empty()) {
+      value_type* raw_ptr = nullptr;
+      src->PopFront().__UnsafeMoveTo__(&raw_ptr);
+      EmbeddedListLink* link = LinkField::FieldPtr4StructPtr(raw_ptr);
+      link->NullptrClear();
+      if (last == nullptr) {
+        first = link;
+      } else {
+        last->AtomicSetNext(link);
+      }
+      last = link;
+    }
+    WaitAndAcquireCapacity(size);
+    PushChain(first, last);
+  }
+
+  // consumer only. Moves all completely pushed elements to `dst' in FIFO order.
+  void MoveTo(SrcListType* dst) { MoveTo(dst, std::numeric_limits<int64_t>::max()); }
+
+  // consumer only. Moves at most `max_size' elements to `dst' in FIFO order.
+  void MoveTo(SrcListType* dst, int64_t max_size) {
+    int64_t moved_size = 0;
+    for (; moved_size < max_size; ++moved_size) {
+      EmbeddedListLink* link = TryPop();
+      if (link == nullptr) { break; }
+      link->Clear();
+      dst->EmplaceBack(ObjectMsgPtr<value_type>::__UnsafeMove__(LinkField::StructPtr4FieldPtr(link)));
+    }
+    if (moved_size > 0) { size_.fetch_sub(moved_size, std::memory_order_release); }
+  }
+
+  void Clear() {
+    SrcListType list;
+    list.__Init__();
+    MoveTo(&list);
+    list.Clear();
+  }
+
+ private:
+  void WaitAndAcquireCapacity(int64_t size) {
+    // an empty list always accepts a batch, so one oversized batch can not block forever
+    int64_t cur_size = size_.load(std::memory_order_acquire);
+    while (true) {
+      if (cur_size > 0 && cur_size + size > capacity_) {
+        std::this_thread::yield();
+        cur_size = size_.load(std::memory_order_acquire);
+      } else if (size_.compare_exchange_weak(cur_size, cur_size + size,
+                                             std::memory_order_acq_rel)) {
+        break;
+      }
+    }
+  }
+
+  void PushChain(EmbeddedListLink* first, EmbeddedListLink* last) {
+    EmbeddedListLink* prev = tail_.exchange(last, std::memory_order_acq_rel);
+    prev->AtomicSetNext(first);
+  }
+
+  EmbeddedListLink* TryPop() {
+    EmbeddedListLink* head = head_;
+    EmbeddedListLink* next = head->AtomicNext();
+    if (head == &stub_) {
+      if (next == nullptr) { return nullptr; }
+      head_ = next;
+      head = next;
+      next = next->AtomicNext();
+    }
+    if (next != nullptr) {
+      head_ = next;
+      return head;
+    }
+    // a producer has exchanged `tail_' but not linked its batch yet
+    if (head != tail_.load(std::memory_order_acquire)) { return nullptr; }
+    stub_.NullptrClear();
+    PushChain(&stub_, &stub_);
+    next = head->AtomicNext();
+    if (next != nullptr) {
+      head_ = next;
+      return head;
+    }
+    return nullptr;
+  }
+
+  std::atomic<int64_t> size_;
+  int64_t capacity_;
+  // consumer side
+  EmbeddedListLink* head_;
+  EmbeddedListLink stub_;
+  // producer side
+  std::atomic<EmbeddedListLink*> tail_;
+};
+
+template<typename LinkField>
+class ObjectMsgMpscList : public TrivialObjectMsgMpscList<LinkField> {
+ public:
+  ObjectMsgMpscList(const ObjectMsgMpscList&) = delete;
+  ObjectMsgMpscList(ObjectMsgMpscList&&) = delete;
+  ObjectMsgMpscList() { this->__Init__(); }
+  ~ObjectMsgMpscList() { this->Clear(); }
+};
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_OBJECT_MSG_MPSC_LIST_H_
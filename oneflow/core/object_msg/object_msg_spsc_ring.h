@@ -0,0 +1,179 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_OBJECT_MSG_SPSC_RING_H_
+#define ONEFLOW_CORE_OBJECT_MSG_SPSC_RING_H_
+
+#include <array>
+#include <atomic>
+#include <thread>
+#include "oneflow/core/object_msg/object_msg_core.h"
+
+namespace oneflow {
+
+// Bounded lock-free single-producer single-consumer ring of object message pointers.
+// Exactly one thread may call the producer methods (TryEmplaceBack/EmplaceBack) and exactly one
+// thread may call the consumer methods (TryPopFront/MoveTo) at the same time.
+#define OBJECT_MSG_DEFINE_SPSC_RING_HEAD(elem_type, capacity, field_name)                       \
+  static_assert(__is_object_message_type__, "this struct is not a object message");             \
+  static_assert(!std::is_same<self_type, elem_type>::value, "self loop ring is not supported"); \
+  OF_PRIVATE INCREASE_STATIC_COUNTER(field_counter);                                            \
+  _OBJECT_MSG_DEFINE_SPSC_RING_HEAD(STATIC_COUNTER(field_counter), elem_type, capacity,         \
+                                    field_name);
+
+#define OBJECT_MSG_SPSC_RING(obj_msg_type, capacity) \
+  ObjectMsgSpscRing<OBJECT_MSG_TYPE_CHECK(obj_msg_type), capacity>
+
+// details
+
+#define _OBJECT_MSG_DEFINE_SPSC_RING_HEAD(field_counter, elem_type, capacity, field_name)      \
+  _OBJECT_MSG_DEFINE_SPSC_RING_HEAD_FIELD(elem_type, capacity, field_name)                     \
+  OBJECT_MSG_DEFINE_SPSC_RING_ELEM_STRUCT(field_counter, elem_type, field_name);               \
+  OBJECT_MSG_OVERLOAD_INIT(field_counter, ObjectMsgEmbeddedSpscRingHeadInit);                  \
+  OBJECT_MSG_OVERLOAD_DELETE(field_counter, ObjectMsgEmbeddedSpscRingHeadDelete);              \
+  DSS_DEFINE_FIELD(field_counter, "object message", OF_PP_CAT(field_name, _ObjectMsgRingType), \
+                   OF_PP_CAT(field_name, _));
+
+#define _OBJECT_MSG_DEFINE_SPSC_RING_HEAD_FIELD(elem_type, capacity, field_name)  \
+ public:                                                                          \
+  using OF_PP_CAT(field_name, _ObjectMsgRingType) =                               \
+      TrivialObjectMsgSpscRing<OBJECT_MSG_TYPE_CHECK(elem_type), capacity>;       \
+  const OF_PP_CAT(field_name, _ObjectMsgRingType) & field_name() const {          \
+    return OF_PP_CAT(field_name, _);                                              \
+  }                                                                               \
+  OF_PP_CAT(field_name, _ObjectMsgRingType) * OF_PP_CAT(mut_, field_name)() {     \
+    return &OF_PP_CAT(field_name, _);                                             \
+  }                                                                               \
+  OF_PP_CAT(field_name, _ObjectMsgRingType) * OF_PP_CAT(mutable_, field_name)() { \
+    return &OF_PP_CAT(field_name, _);                                             \
+  }                                                                               \
+                                                                                  \
+ private:                                                                         \
+  OF_PP_CAT(field_name, _ObjectMsgRingType) OF_PP_CAT(field_name, _);
+
+#define OBJECT_MSG_DEFINE_SPSC_RING_ELEM_STRUCT(field_counter, elem_type, field_name) \
+ public:                                                                              \
+  template<typename Enabled>                                                          \
+  struct ContainerElemStruct<field_counter, Enabled> final {                          \
+    using type = elem_type;                                                           \
+  };
+
+template<typename WalkCtxType, typename PtrFieldType>
+struct ObjectMsgEmbeddedSpscRingHeadInit {
+  static void Call(WalkCtxType* ctx, PtrFieldType* field) { field->__Init__(); }
+};
+
+template<typename WalkCtxType, typename PtrFieldType>
+struct ObjectMsgEmbeddedSpscRingHeadDelete {
+  static void Call(WalkCtxType* ctx, PtrFieldType* field) { field->Clear(); }
+};
+
+// Lamport's ring with cached peer indices. The producer only writes `tail_' and the consumer only
+// writes `head_', each on its own cache line, so neither side issues a read-modify-write.
+// The ring owns one reference of every element it holds.
+template<typename T, int64_t capacity>
+class TrivialObjectMsgSpscRing {
+ public:
+  static_assert(capacity > 0 && (capacity & (capacity - 1)) == 0,
+                "capacity should be a power of 2");
+  using value_type = T;
+
+  static const int kCacheLineSize = 64;
+
+  // approximate while the other side is running
+  std::size_t size() const {
+    return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+  }
+  bool empty() const { return size() == 0; }
+  static constexpr int64_t max_size() { return capacity; }
+
+  void __Init__() {
+    new (&this->head_) std::atomic<uint64_t>(0);
+    new (&this->tail_) std::atomic<uint64_t>(0);
+    cached_tail_ = 0;
+    cached_head_ = 0;
+  }
+
+  // producer only. Returns false and leaves `ptr' untouched when the ring is full.
+  bool TryEmplaceBack(ObjectMsgPtr<value_type>* ptr) {
+    const uint64_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - cached_head_ == capacity) {
+      cached_head_ = head_.load(std::memory_order_acquire);
+      if (tail - cached_head_ == capacity) { return false; }
+    }
+    value_type* raw_ptr = nullptr;
+    ptr->__UnsafeMoveTo__(&raw_ptr);
+    slots_[tail & (capacity - 1)] = raw_ptr;
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // producer only. Spins while the ring is full.
+  void EmplaceBack(ObjectMsgPtr<value_type>&& ptr) {
+    while (!TryEmplaceBack(&ptr)) { std::this_thread::yield(); }
+  }
+
+  // consumer only. Returns an empty pointer when the ring is empty.
+  ObjectMsgPtr<value_type> TryPopFront() {
+    const uint64_t head = head_.load(std::memory_order_relaxed);
+    if (head == cached_tail_) {
+      cached_tail_ = tail_.load(std::memory_order_acquire);
+      if (head == cached_tail_) { return ObjectMsgPtr<value_type>(); }
+    }
+    value_type* raw_ptr = slots_[head & (capacity - 1)];
+    head_.store(head + 1, std::memory_order_release);
+    return ObjectMsgPtr<value_type>::__UnsafeMove__(raw_ptr);
+  }
+
+  // consumer only. Moves all published elements to the back of `dst' in FIFO order.
+  template<typename ListT>
+  void MoveTo(ListT* dst) {
+    const uint64_t tail = tail_.load(std::memory_order_acquire);
+    uint64_t head = head_.load(std::memory_order_relaxed);
+    for (; head != tail; ++head) {
+      dst->EmplaceBack(ObjectMsgPtr<value_type>::__UnsafeMove__(slots_[head & (capacity - 1)]));
+    }
+    cached_tail_ = tail;
+    head_.store(tail, std::memory_order_release);
+  }
+
+  // not thread safe
+  void Clear() {
+    while (TryPopFront()) {}
+  }
+
+ private:
+  // consumer side
+  std::atomic<uint64_t> head_;
+  uint64_t cached_tail_;
+  char head_padding_[kCacheLineSize - sizeof(std::atomic<uint64_t>) - sizeof(uint64_t)];
+  // producer side
+  std::atomic<uint64_t> tail_;
+  uint64_t cached_head_;
+  char tail_padding_[kCacheLineSize - sizeof(std::atomic<uint64_t>) - sizeof(uint64_t)];
+  std::array<value_type*, capacity> slots_;
+};
+
+template<typename T, int64_t capacity>
+class ObjectMsgSpscRing : public TrivialObjectMsgSpscRing<T, capacity> {
+ public:
+  ObjectMsgSpscRing(const ObjectMsgSpscRing&) = delete;
+  ObjectMsgSpscRing(ObjectMsgSpscRing&&) = delete;
+  ObjectMsgSpscRing() { this->__Init__(); }
+  ~ObjectMsgSpscRing() { this->Clear(); }
+};
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_OBJECT_MSG_SPSC_RING_H_
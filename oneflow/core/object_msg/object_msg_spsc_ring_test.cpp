@@ -0,0 +1,126 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <thread>
+#include "oneflow/core/common/util.h"
+#include "oneflow/core/object_msg/object_msg.h"
+
+namespace oneflow {
+
+namespace test {
+
+namespace {
+
+// clang-format off
+OBJECT_MSG_BEGIN(TestSpscRingItem)
+  OBJECT_MSG_DEFINE_LIST_LINK(foo_list);
+  OBJECT_MSG_DEFINE_OPTIONAL(int64_t, value);
+OBJECT_MSG_END(TestSpscRingItem)
+// clang-format on
+
+// clang-format off
+OBJECT_MSG_BEGIN(TestSpscRingHead)
+  OBJECT_MSG_DEFINE_SPSC_RING_HEAD(TestSpscRingItem, 4, foo_ring);
+OBJECT_MSG_END(TestSpscRingHead)
+// clang-format on
+
+TEST(ObjectMsgSpscRing, empty) {
+  OBJECT_MSG_SPSC_RING(TestSpscRingItem, 4) ring;
+  ASSERT_TRUE(ring.empty());
+  ASSERT_EQ(ring.size(), 0);
+  ASSERT_TRUE(!ring.TryPopFront());
+}
+
+TEST(ObjectMsgSpscRing, full) {
+  OBJECT_MSG_SPSC_RING(TestSpscRingItem, 4) ring;
+  for (int i = 0; i < 4; ++i) {
+    auto item = ObjectMsgPtr<TestSpscRingItem>::New();
+    ASSERT_TRUE(ring.TryEmplaceBack(&item));
+    ASSERT_TRUE(!item);
+  }
+  auto item = ObjectMsgPtr<TestSpscRingItem>::New();
+  ASSERT_TRUE(!ring.TryEmplaceBack(&item));
+  ASSERT_TRUE(item);
+  ASSERT_EQ(item->ref_cnt(), 1);
+  ASSERT_EQ(ring.size(), 4);
+  ASSERT_TRUE(ring.TryPopFront());
+  ASSERT_TRUE(ring.TryEmplaceBack(&item));
+  ASSERT_EQ(ring.size(), 4);
+}
+
+TEST(ObjectMsgSpscRing, fifo) {
+  OBJECT_MSG_SPSC_RING(TestSpscRingItem, 4) ring;
+  for (int64_t i = 0; i < 10; ++i) {
+    auto item = ObjectMsgPtr<TestSpscRingItem>::New();
+    item->set_value(i);
+    ring.EmplaceBack(std::move(item));
+    auto popped = ring.TryPopFront();
+    ASSERT_TRUE(popped);
+    ASSERT_EQ(popped->value(), i);
+    ASSERT_EQ(popped->ref_cnt(), 1);
+  }
+  ASSERT_TRUE(ring.empty());
+}
+
+TEST(ObjectMsgSpscRing, MoveTo) {
+  OBJECT_MSG_SPSC_RING(TestSpscRingItem, 4) ring;
+  for (int64_t i = 0; i < 3; ++i) {
+    auto item = ObjectMsgPtr<TestSpscRingItem>::New();
+    item->set_value(i);
+    ring.EmplaceBack(std::move(item));
+  }
+  OBJECT_MSG_LIST(TestSpscRingItem, foo_list) list;
+  ring.MoveTo(&list);
+  ASSERT_TRUE(ring.empty());
+  ASSERT_EQ(list.size(), 3);
+  int64_t expected = 0;
+  OBJECT_MSG_LIST_FOR_EACH_PTR(&list, item) {
+    ASSERT_EQ(item->value(), expected++);
+    ASSERT_EQ(item->ref_cnt(), 1);
+  }
+}
+
+TEST(ObjectMsgSpscRing, field) {
+  auto head = ObjectMsgPtr<TestSpscRingHead>::New();
+  auto item = ObjectMsgPtr<TestSpscRingItem>::New();
+  head->mut_foo_ring()->EmplaceBack(std::move(item));
+  ASSERT_EQ(head->foo_ring().size(), 1);
+}
+
+TEST(ObjectMsgSpscRing, stress) {
+  constexpr int64_t kNum = 1 << 18;
+  OBJECT_MSG_SPSC_RING(TestSpscRingItem, 4) ring;
+  std::thread producer([&]() {
+    for (int64_t i = 0; i < kNum; ++i) {
+      auto item = ObjectMsgPtr<TestSpscRingItem>::New();
+      item->set_value(i);
+      ring.EmplaceBack(std::move(item));
+    }
+  });
+  int64_t expected = 0;
+  while (expected < kNum) {
+    OBJECT_MSG_LIST(TestSpscRingItem, foo_list) list;
+    ring.MoveTo(&list);
+    OBJECT_MSG_LIST_FOR_EACH_PTR(&list, item) { ASSERT_EQ(item->value(), expected++); }
+  }
+  producer.join();
+  ASSERT_TRUE(ring.empty());
+}
+
+}  // namespace
+
+}  // namespace test
+
+}  // namespace oneflow
@@ -0,0 +1,71 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/persistence/async_snapshot_writer.h"
+
+namespace oneflow {
+
+AsyncSnapshotWriter::AsyncSnapshotWriter()
+    : max_pending_bytes_(ParseIntegerFromEnv("ONEFLOW_MODEL_SAVE_ASYNC_MAX_PENDING_BYTES",
+                                             int64_t(4) << 30)),
+      pending_bytes_(0),
+      pending_work_cnt_(0) {
+  const int64_t thread_num = ParseIntegerFromEnv("ONEFLOW_MODEL_SAVE_ASYNC_THREAD_NUM", 4);
+  CHECK_GT(thread_num, 0);
+  thread_pool_.reset(new ThreadPool(thread_num));
+}
+
+AsyncSnapshotWriter::~AsyncSnapshotWriter() {
+  WaitAll();
+  thread_pool_.reset();
+}
+
+bool AsyncSnapshotWriter::IsEnabled() {
+  static const bool enabled = ParseBooleanFromEnv("ONEFLOW_MODEL_SAVE_ASYNC", false);
+  return enabled;
+}
+
+AsyncSnapshotWriter* AsyncSnapshotWriter::Singleton() {
+  static AsyncSnapshotWriter writer;
+  return &writer;
+}
+
+void AsyncSnapshotWriter::Schedule(size_t bytes, const std::function<void()>& work) {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    // a work larger than the whole budget is still accepted once nothing else is pending
+    cond_.wait(lock, [&]() {
+      return pending_work_cnt_ == 0 || pending_bytes_ + bytes <= max_pending_bytes_;
+    });
+    pending_bytes_ += bytes;
+    pending_work_cnt_ += 1;
+  }
+  thread_pool_->AddWork([this, bytes, work]() mutable {
+    work();
+    // release the host memory held by the work before returning its bytes to the budget
+    work = nullptr;
+    std::unique_lock<std::mutex> lock(mutex_);
+    pending_bytes_ -= bytes;
+    pending_work_cnt_ -= 1;
+    cond_.notify_all();
+  });
+}
+
+void AsyncSnapshotWriter::WaitAll() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  cond_.wait(lock, [&]() { return pending_work_cnt_ == 0; });
+}
+
+}  // namespace oneflow
@@ -0,0 +1,52 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_PERSISTENCE_ASYNC_SNAPSHOT_WRITER_H_
+#define ONEFLOW_CORE_PERSISTENCE_ASYNC_SNAPSHOT_WRITER_H_
+
+#include "oneflow/core/common/util.h"
+#include "oneflow/core/thread/thread_pool.h"
+
+namespace oneflow {
+
+// Runs snapshot writing works on background threads. Each work declares the bytes of host memory
+// it holds, Schedule blocks while the held bytes of unfinished works would exceed the budget set
+// by ONEFLOW_MODEL_SAVE_ASYNC_MAX_PENDING_BYTES, so saving never buffers more than that.
+class AsyncSnapshotWriter final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(AsyncSnapshotWriter);
+  ~AsyncSnapshotWriter();
+
+  static bool IsEnabled();
+  static AsyncSnapshotWriter* Singleton();
+
+  void Schedule(size_t bytes, const std::function<void()>& work);
+  // Returns after all scheduled works are done
+  void WaitAll();
+
+ private:
+  AsyncSnapshotWriter();
+
+  size_t max_pending_bytes_;
+  size_t pending_bytes_;
+  int64_t pending_work_cnt_;
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  std::unique_ptr<ThreadPool> thread_pool_;
+};
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_PERSISTENCE_ASYNC_SNAPSHOT_WRITER_H_
@@ -15,23 +15,105 @@ limitations under the License.
 */
 #include "oneflow/core/persistence/binary_in_stream_without_local_copy.h"
 #include "oneflow/core/job/job_desc.h"
+#include "oneflow/core/common/blocking_counter.h"
+#include "oneflow/core/thread/thread_pool.h"
 #include <cstring>
 
 namespace oneflow {
 
+namespace {
+
+constexpr size_t kReadAheadAlignment = 4096;
+constexpr size_t kDefaultReadAheadChunkSize = 1024 * 1024;  // 1MB
+
+ThreadPool* ReadAheadThreadPool() {
+  static ThreadPool thread_pool(
+      ParseIntegerFromEnv("ONEFLOW_PERSISTENT_IN_STREAM_READ_AHEAD_THREAD_NUM", 4));
+  return &thread_pool;
+}
+
+}  // namespace
+
+struct BinaryInStreamWithoutLocalCopy::ReadAheadChunk {
+  ReadAheadChunk(uint64_t offset, size_t size)
+      : offset(offset), size(size), storage(new char[size + kReadAheadAlignment]), done(1) {
+    // aligned for the O_DIRECT reads of the file system
+    data = reinterpret_cast<char*>(
+        RoundUp(reinterpret_cast<uintptr_t>(storage.get()), kReadAheadAlignment));
+  }
+
+  uint64_t offset;
+  size_t size;
+  std::unique_ptr<char[]> storage;
+  char* data;
+  BlockingCounter done;
+};
+
 int32_t BinaryInStreamWithoutLocalCopy::Read(char* s, size_t n) {
   if (IsEof()) return -1;
   CHECK_LE(cur_file_pos_ + n, file_size_);
-  file_->Read(cur_file_pos_, n, s);
+  if (read_ahead_chunk_num_ > 0) {
+    ReadWithReadAhead(s, n);
+  } else {
+    file_->Read(cur_file_pos_, n, s);
+  }
   cur_file_pos_ += n;
   return 0;
 }
 
 BinaryInStreamWithoutLocalCopy::BinaryInStreamWithoutLocalCopy(fs::FileSystem* fs,
                                                                const std::string& file_path)
-    : cur_file_pos_(0) {
+    : cur_file_pos_(0), next_chunk_offset_(0) {
   fs->NewRandomAccessFile(file_path, &file_);
   file_size_ = fs->GetFileSize(file_path);
+  read_ahead_chunk_num_ = ParseIntegerFromEnv("ONEFLOW_PERSISTENT_IN_STREAM_READ_AHEAD_CHUNKS", 0);
+  read_ahead_chunk_size_ =
+      RoundUp(ParseIntegerFromEnv("ONEFLOW_PERSISTENT_IN_STREAM_READ_AHEAD_CHUNK_SIZE_BYTES",
+                                  kDefaultReadAheadChunkSize),
+              kReadAheadAlignment);
+  CHECK_GE(read_ahead_chunk_num_, 0);
+  CHECK_GT(read_ahead_chunk_size_, 0);
+}
+
+BinaryInStreamWithoutLocalCopy::~BinaryInStreamWithoutLocalCopy() { ResetReadAhead(0); }
+
+void BinaryInStreamWithoutLocalCopy::ReadWithReadAhead(char* s, size_t n) {
+  uint64_t pos = cur_file_pos_;
+  while (n > 0) {
+    while (!chunks_.empty() && chunks_.front()->offset + chunks_.front()->size <= pos) {
+      chunks_.front()->done.WaitUntilCntEqualZero();
+      chunks_.pop_front();
+    }
+    if (chunks_.empty() || chunks_.front()->offset > pos) { ResetReadAhead(pos); }
+    SubmitReadAheadChunks();
+    const std::shared_ptr<ReadAheadChunk>& chunk = chunks_.front();
+    chunk->done.WaitUntilCntEqualZero();
+    const size_t copy_size = std::min<uint64_t>(n, chunk->offset + chunk->size - pos);
+    std::memcpy(s, chunk->data + (pos - chunk->offset), copy_size);
+    s += copy_size;
+    pos += copy_size;
+    n -= copy_size;
+  }
+}
+
+void BinaryInStreamWithoutLocalCopy::ResetReadAhead(uint64_t pos) {
+  for (const auto& chunk : chunks_) { chunk->done.WaitUntilCntEqualZero(); }
+  chunks_.clear();
+  next_chunk_offset_ = pos / read_ahead_chunk_size_ * read_ahead_chunk_size_;
+}
+
+void BinaryInStreamWithoutLocalCopy::SubmitReadAheadChunks() {
+  while (chunks_.size() < read_ahead_chunk_num_ && next_chunk_offset_ < file_size_) {
+    const size_t size = std::min<uint64_t>(read_ahead_chunk_size_, file_size_ - next_chunk_offset_);
+    std::shared_ptr<ReadAheadChunk> chunk(new ReadAheadChunk(next_chunk_offset_, size));
+    fs::RandomAccessFile* file = file_.get();
+    ReadAheadThreadPool()->AddWork([file, chunk]() {
+      file->Read(chunk->offset, chunk->size, chunk->data);
+      chunk->done.Decrease();
+    });
+    chunks_.push_back(chunk);
+    next_chunk_offset_ += size;
+  }
 }
 
 }  // namespace oneflow
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include "oneflow/core/persistence/file_system.h"
 #include "oneflow/core/persistence/binary_in_stream.h"
+#include <deque>
 
 namespace oneflow {
 
@@ -25,7 +26,7 @@ class BinaryInStreamWithoutLocalCopy final : public BinaryInStream {
  public:
   OF_DISALLOW_COPY_AND_MOVE(BinaryInStreamWithoutLocalCopy);
   BinaryInStreamWithoutLocalCopy() = delete;
-  virtual ~BinaryInStreamWithoutLocalCopy() = default;
+  ~BinaryInStreamWithoutLocalCopy() override;
 
   BinaryInStreamWithoutLocalCopy(fs::FileSystem*, const std::string& file_path);
   int32_t Read(char* s, size_t n) override;
@@ -36,9 +37,21 @@ class BinaryInStreamWithoutLocalCopy final : public BinaryInStream {
   bool IsEof() const override { return cur_file_pos_ == file_size_; }
 
  private:
+  struct ReadAheadChunk;
+
+  void ReadWithReadAhead(char* s, size_t n);
+  void ResetReadAhead(uint64_t pos);
+  void SubmitReadAheadChunks();
+
   std::unique_ptr<fs::RandomAccessFile> file_;
   uint64_t file_size_;
   uint64_t cur_file_pos_;
+  // With read-ahead, up to read_ahead_chunk_num_ aligned chunks following the current position are
+  // read in the background, they cover [chunks_.front()->offset, next_chunk_offset_)
+  int64_t read_ahead_chunk_num_;
+  size_t read_ahead_chunk_size_;
+  std::deque<std::shared_ptr<ReadAheadChunk>> chunks_;
+  uint64_t next_chunk_offset_;
 };
 
 }  // namespace oneflow
@@ -0,0 +1,64 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <gtest/gtest.h>
+#include "oneflow/core/common/process_state.h"
+#include "oneflow/core/common/str_util.h"
+#include "oneflow/core/persistence/binary_in_stream_without_local_copy.h"
+
+namespace oneflow {
+
+TEST(BinaryInStreamWithoutLocalCopy, read_ahead) {
+  std::string current_dir = GetCwd();
+  StringReplace(&current_dir, '\\', '/');
+  const std::string file_name = JoinPath(current_dir, "/tmp_test_read_ahead_file");
+  std::string content(5 * 4096 + 123, '\0');
+  FOR_RANGE(size_t, i, 0, content.size()) { content[i] = static_cast<char>(i * 7 % 251); }
+  {
+    std::unique_ptr<fs::WritableFile> file;
+    LocalFS()->NewWritableFile(file_name, &file);
+    file->Append(content.data(), content.size());
+    file->Close();
+  }
+  setenv("ONEFLOW_PERSISTENT_IN_STREAM_READ_AHEAD_CHUNKS", "2", 1);
+  setenv("ONEFLOW_PERSISTENT_IN_STREAM_READ_AHEAD_CHUNK_SIZE_BYTES", "4096", 1);
+  {
+    BinaryInStreamWithoutLocalCopy stream(LocalFS(), file_name);
+    std::string read_content;
+    // reads that straddle the chunks
+    for (size_t n : {1000, 4096, 5000, 7000}) {
+      std::vector<char> buffer(n);
+      ASSERT_EQ(stream.Read(buffer.data(), n), 0);
+      read_content.append(buffer.data(), n);
+    }
+    ASSERT_EQ(read_content, content.substr(0, read_content.size()));
+    // skip forward past the chunks in flight, then seek back
+    for (uint64_t pos : std::vector<uint64_t>{content.size() - 200, 10}) {
+      stream.set_cur_file_pos(pos);
+      std::vector<char> buffer(150);
+      ASSERT_EQ(stream.Read(buffer.data(), buffer.size()), 0);
+      ASSERT_EQ(std::string(buffer.data(), buffer.size()), content.substr(pos, buffer.size()));
+    }
+    stream.set_cur_file_pos(content.size() - 50);
+    std::vector<char> buffer(50);
+    ASSERT_EQ(stream.Read(buffer.data(), buffer.size()), 0);
+    ASSERT_TRUE(stream.IsEof());
+  }
+  unsetenv("ONEFLOW_PERSISTENT_IN_STREAM_READ_AHEAD_CHUNKS");
+  unsetenv("ONEFLOW_PERSISTENT_IN_STREAM_READ_AHEAD_CHUNK_SIZE_BYTES");
+  LocalFS()->DelFile(file_name);
+}
+
+}  // namespace oneflow
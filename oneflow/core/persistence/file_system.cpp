@@ -20,6 +20,7 @@ limitations under the License.
 #include "oneflow/core/job/job_set.pb.h"
 #include "oneflow/core/persistence/hadoop/hadoop_file_system.h"
 #include "oneflow/core/persistence/posix/posix_file_system.h"
+#include "oneflow/core/persistence/s3/s3_file_system.h"
 #include "oneflow/core/job/job_set.pb.h"
 
 namespace oneflow {
@@ -136,6 +137,10 @@ void CreateHadoopFS(std::unique_ptr<fs::FileSystem>& fs, const std::string& name
   fs.reset(new fs::HadoopFileSystem(namenode));
 }
 
+void CreateS3FS(std::unique_ptr<fs::FileSystem>& fs, const std::string& env_prefix) {
+  fs.reset(new fs::S3FileSystem(env_prefix));
+}
+
 void CreateFileSystemFromEnv(std::unique_ptr<fs::FileSystem>& fs, const std::string& env_prefix) {
   CHECK(!fs);
 
@@ -159,6 +164,8 @@ void CreateFileSystemFromEnv(std::unique_ptr<fs::FileSystem>& fs, const std::str
                  << " be set to hdfs";
     }
     CreateHadoopFS(fs, hdfs_namenode);
+  } else if (fs_type_str == "s3") {
+    CreateS3FS(fs, env_prefix);
   } else {
     LOG(FATAL) << "invalid value " << fs_type << " of env " << fs_type_env;
   }
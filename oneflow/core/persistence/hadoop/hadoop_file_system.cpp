@@ -75,6 +75,7 @@ void LibHDFS::LoadAndBind() {
     BIND_HDFS_FUNC(hdfsBuilderConnect);
     BIND_HDFS_FUNC(hdfsNewBuilder);
     BIND_HDFS_FUNC(hdfsBuilderSetNameNode);
+    BIND_HDFS_FUNC(hdfsBuilderConfSetStr);
     BIND_HDFS_FUNC(hdfsConfGetStr);
     BIND_HDFS_FUNC(hdfsBuilderSetKerbTicketCachePath);
     BIND_HDFS_FUNC(hdfsCloseFile);
@@ -117,6 +118,14 @@ HadoopFileSystem::HadoopFileSystem(const std::string& namenode)
 
 bool HadoopFileSystem::Connect(hdfsFS* fs) {
   FS_RETURN_FALSE_IF_FALSE(hdfs_->status());
+  static std::mutex mutex;
+  static HashMap<std::string, hdfsFS> namenode2fs;
+  std::unique_lock<std::mutex> lock(mutex);
+  auto it = namenode2fs.find(namenode_);
+  if (it != namenode2fs.end()) {
+    *fs = it->second;
+    return true;
+  }
   hdfsBuilder* builder = hdfs_->hdfsNewBuilder();
   hdfs_->hdfsBuilderSetNameNode(builder, namenode_.c_str());
   // KERB_TICKET_CACHE_PATH will be deleted in the future, Because KRB5CCNAME
@@ -126,11 +135,19 @@ bool HadoopFileSystem::Connect(hdfsFS* fs) {
   if (ticket_cache_path != nullptr) {
     hdfs_->hdfsBuilderSetKerbTicketCachePath(builder, ticket_cache_path);
   }
+  // Blocks of the datanode on this host are read from the local disk through the domain socket
+  // instead of the datanode.
+  char* domain_socket_path = getenv("ONEFLOW_HDFS_DOMAIN_SOCKET_PATH");
+  if (domain_socket_path != nullptr) {
+    hdfs_->hdfsBuilderConfSetStr(builder, "dfs.client.read.shortcircuit", "true");
+    hdfs_->hdfsBuilderConfSetStr(builder, "dfs.domain.socket.path", domain_socket_path);
+  }
   *fs = hdfs_->hdfsBuilderConnect(builder);
   if (*fs == nullptr) {
     PLOG(WARNING) << " HDFS connect failed. NOT FOUND";
     return false;
   }
+  namenode2fs.emplace(namenode_, *fs);
   return true;
 }
 
@@ -138,24 +155,21 @@ class HDFSRandomAccessFile : public RandomAccessFile {
  public:
   HDFSRandomAccessFile(const std::string& filename, const std::string& hdfs_filename, LibHDFS* hdfs,
                        hdfsFS fs, hdfsFile file)
-      : filename_(filename), hdfs_filename_(hdfs_filename), hdfs_(hdfs), fs_(fs), file_(file) {}
-
-  ~HDFSRandomAccessFile() override {
-    if (file_ != nullptr) {
-      std::unique_lock<std::mutex> lock(mu_);
-      hdfs_->hdfsCloseFile(fs_, file_);
-    }
+      : filename_(filename), hdfs_filename_(hdfs_filename), hdfs_(hdfs), fs_(fs) {
+    file_ = MakeSharedFile(file);
   }
 
+  ~HDFSRandomAccessFile() override = default;
+
   void Read(uint64_t offset, size_t n, char* result) const override {
     char* dst = result;
     bool eof_retried = false;
+    // The positional reads of threads run concurrently on the same handle, which is only swapped
+    // under the lock and closed after its last reader.
+    std::shared_ptr<hdfsFile_internal> file = CurrentFile();
     while (n > 0) {
-      // We lock inside the loop rather than outside so we don't block other
-      // concurrent readers.
-      std::unique_lock<std::mutex> lock(mu_);
-      tSize r =
-          hdfs_->hdfsPread(fs_, file_, static_cast<tOffset>(offset), dst, static_cast<tSize>(n));
+      tSize r = hdfs_->hdfsPread(fs_, file.get(), static_cast<tOffset>(offset), dst,
+                                 static_cast<tSize>(n));
       if (r > 0) {
         dst += r;
         n -= r;
@@ -165,9 +179,13 @@ class HDFSRandomAccessFile : public RandomAccessFile {
         // If writers are streaming contents while others are concurrently
         // reading, HDFS requires that we reopen the file to see updated
         // contents.
-        PCHECK(file_ == nullptr || hdfs_->hdfsCloseFile(fs_, file_) == 0) << filename_;
-        file_ = hdfs_->hdfsOpenFile(fs_, hdfs_filename_.c_str(), O_RDONLY, 0, 0, 0);
-        PCHECK(file_ != nullptr) << filename_;
+        hdfsFile reopened = hdfs_->hdfsOpenFile(fs_, hdfs_filename_.c_str(), O_RDONLY, 0, 0, 0);
+        PCHECK(reopened != nullptr) << filename_;
+        file = MakeSharedFile(reopened);
+        {
+          std::unique_lock<std::mutex> lock(mu_);
+          file_ = file;
+        }
         eof_retried = true;
       } else if (eof_retried && r == 0) {
         PLOG(FATAL) << "Read less bytes than requested";
@@ -182,13 +200,27 @@ class HDFSRandomAccessFile : public RandomAccessFile {
   }
 
  private:
+  std::shared_ptr<hdfsFile_internal> MakeSharedFile(hdfsFile file) const {
+    LibHDFS* hdfs = hdfs_;
+    hdfsFS fs = fs_;
+    std::string filename = filename_;
+    return std::shared_ptr<hdfsFile_internal>(file, [hdfs, fs, filename](hdfsFile file) {
+      PCHECK(hdfs->hdfsCloseFile(fs, file) == 0) << filename;
+    });
+  }
+
+  std::shared_ptr<hdfsFile_internal> CurrentFile() const {
+    std::unique_lock<std::mutex> lock(mu_);
+    return file_;
+  }
+
   std::string filename_;
   std::string hdfs_filename_;
   LibHDFS* hdfs_;
   hdfsFS fs_;
 
   mutable std::mutex mu_;
-  mutable hdfsFile file_;
+  mutable std::shared_ptr<hdfsFile_internal> file_;
 };
 
 void HadoopFileSystem::NewRandomAccessFile(const std::string& fname,
@@ -49,6 +49,7 @@ class LibHDFS {
   std::function<hdfsFS(hdfsBuilder*)> hdfsBuilderConnect;
   std::function<hdfsBuilder*()> hdfsNewBuilder;
   std::function<void(hdfsBuilder*, const char*)> hdfsBuilderSetNameNode;
+  std::function<int(hdfsBuilder*, const char*, const char*)> hdfsBuilderConfSetStr;
   std::function<int(const char*, char**)> hdfsConfGetStr;
   std::function<void(hdfsBuilder*, const char* kerbTicketCachePath)>
       hdfsBuilderSetKerbTicketCachePath;
@@ -106,6 +107,8 @@ class HadoopFileSystem final : public FileSystem {
   bool IsDirectory(const std::string& fname) override;
 
  private:
+  // The connections are shared by the file systems of the same namenode and never closed, as
+  // libhdfs caches the underlying java file system per namenode as well.
   bool Connect(hdfsFS* fs);
   std::string namenode_;
   LibHDFS* hdfs_;
@@ -32,33 +32,72 @@ namespace oneflow {
 
 namespace fs {
 
+namespace {
+
+constexpr size_t kDirectIOAlignment = 4096;
+
+bool UseDirectIO() {
+  static const bool use_direct_io =
+      ParseBooleanFromEnv("ONEFLOW_POSIX_FILE_SYSTEM_USE_O_DIRECT", false);
+  return use_direct_io;
+}
+
+// Reads `n` bytes from `offset` into `dst` and returns the number of bytes read. Hitting the end
+// of the file is only allowed after `min_n` bytes, which covers the O_DIRECT reads of the whole
+// blocks at the end of the file.
+size_t PRead(const std::string& fname, int fd, uint64_t offset, size_t n, size_t min_n,
+             char* dst) {
+  size_t read_n = 0;
+  while (read_n < n) {
+    ssize_t r = pread(fd, dst + read_n, n - read_n, static_cast<off_t>(offset + read_n));
+    if (r > 0) {
+      read_n += r;
+    } else if (r == 0) {
+      if (read_n >= min_n) { break; }
+      PLOG(FATAL) << "Read EOF";
+      return read_n;
+    } else if (errno == EINTR || errno == EAGAIN) {
+      // Retry
+    } else {
+      PLOG(FATAL) << "Fail to read file " << fname;
+      return read_n;
+    }
+  }
+  return read_n;
+}
+
+}  // namespace
+
 class PosixRandomAccessFile : public RandomAccessFile {
  private:
   std::string fname_;
   int fd_;
+  bool direct_io_;
 
  public:
-  PosixRandomAccessFile(const std::string& fname, int fd) : fname_(fname), fd_(fd) {}
+  PosixRandomAccessFile(const std::string& fname, int fd, bool direct_io)
+      : fname_(fname), fd_(fd), direct_io_(direct_io) {}
   ~PosixRandomAccessFile() override { close(fd_); }
 
   void Read(uint64_t offset, size_t n, char* result) const override {
-    char* dst = result;
-    while (n > 0) {
-      ssize_t r = pread(fd_, dst, n, static_cast<off_t>(offset));
-      if (r > 0) {
-        dst += r;
-        n -= r;
-        offset += r;
-      } else if (r == 0) {
-        PLOG(FATAL) << "Read EOF";
-        return;
-      } else if (errno == EINTR || errno == EAGAIN) {
-        // Retry
-      } else {
-        PLOG(FATAL) << "Fail to read file " << fname_;
-        return;
-      }
+    if (!direct_io_) {
+      PRead(fname_, fd_, offset, n, n, result);
+      return;
     }
+    // O_DIRECT reads whole aligned blocks into aligned memory, others go through a bounce buffer
+    const uint64_t aligned_offset = offset / kDirectIOAlignment * kDirectIOAlignment;
+    const size_t aligned_n = RoundUp(offset + n - aligned_offset, kDirectIOAlignment);
+    if (aligned_offset == offset && aligned_n == n
+        && reinterpret_cast<uintptr_t>(result) % kDirectIOAlignment == 0) {
+      PRead(fname_, fd_, offset, n, n, result);
+      return;
+    }
+    void* buffer = nullptr;
+    PCHECK(posix_memalign(&buffer, kDirectIOAlignment, aligned_n) == 0);
+    PRead(fname_, fd_, aligned_offset, aligned_n, offset + n - aligned_offset,
+          static_cast<char*>(buffer));
+    memcpy(result, static_cast<char*>(buffer) + (offset - aligned_offset), n);
+    free(buffer);
   }
 };
 
@@ -93,9 +132,18 @@ class PosixWritableFile : public WritableFile {
 void PosixFileSystem::NewRandomAccessFile(const std::string& fname,
                                           std::unique_ptr<RandomAccessFile>* result) {
   std::string translated_fname = TranslateName(fname);
-  int fd = open(translated_fname.c_str(), O_RDONLY);
+  int fd = -1;
+  bool direct_io = false;
+#ifdef O_DIRECT
+  if (UseDirectIO()) {
+    // file systems without O_DIRECT support fail the open with EINVAL, they read buffered
+    fd = open(translated_fname.c_str(), O_RDONLY | O_DIRECT);
+    direct_io = fd >= 0;
+  }
+#endif  // O_DIRECT
+  if (fd < 0) { fd = open(translated_fname.c_str(), O_RDONLY); }
   PCHECK(fd >= 0) << "Fail to open file " << fname << ", errno is " << errno;
-  result->reset(new PosixRandomAccessFile(fname, fd));
+  result->reset(new PosixRandomAccessFile(fname, fd, direct_io));
   CHECK_NOTNULL(result->get());
 }
 
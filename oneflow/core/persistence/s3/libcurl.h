@@ -0,0 +1,69 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_PERSISTENCE_S3_LIBCURL_H_
+#define ONEFLOW_CORE_PERSISTENCE_S3_LIBCURL_H_
+
+#include <stddef.h>
+
+// The subset of the libcurl 7 ABI used by the S3 file system. libcurl is loaded at runtime, like
+// libhdfs, so the declarations are kept here instead of depending on the curl headers.
+extern "C" {
+
+typedef void CURL;
+
+struct curl_slist {
+  char* data;
+  struct curl_slist* next;
+};
+
+typedef int CURLcode;
+typedef int CURLoption;
+typedef int CURLINFO;
+typedef long long curl_off_t;
+
+#define CURLE_OK 0
+#define CURL_GLOBAL_ALL 3
+
+#define CURLOPTTYPE_LONG 0
+#define CURLOPTTYPE_OBJECTPOINT 10000
+#define CURLOPTTYPE_FUNCTIONPOINT 20000
+#define CURLOPTTYPE_OFF_T 30000
+
+#define CURLOPT_WRITEDATA (CURLOPTTYPE_OBJECTPOINT + 1)
+#define CURLOPT_URL (CURLOPTTYPE_OBJECTPOINT + 2)
+#define CURLOPT_READDATA (CURLOPTTYPE_OBJECTPOINT + 9)
+#define CURLOPT_HTTPHEADER (CURLOPTTYPE_OBJECTPOINT + 23)
+#define CURLOPT_HEADERDATA (CURLOPTTYPE_OBJECTPOINT + 29)
+#define CURLOPT_CUSTOMREQUEST (CURLOPTTYPE_OBJECTPOINT + 36)
+#define CURLOPT_WRITEFUNCTION (CURLOPTTYPE_FUNCTIONPOINT + 11)
+#define CURLOPT_READFUNCTION (CURLOPTTYPE_FUNCTIONPOINT + 12)
+#define CURLOPT_HEADERFUNCTION (CURLOPTTYPE_FUNCTIONPOINT + 79)
+#define CURLOPT_NOBODY (CURLOPTTYPE_LONG + 44)
+#define CURLOPT_UPLOAD (CURLOPTTYPE_LONG + 46)
+#define CURLOPT_CONNECTTIMEOUT (CURLOPTTYPE_LONG + 78)
+#define CURLOPT_NOSIGNAL (CURLOPTTYPE_LONG + 99)
+#define CURLOPT_TCP_KEEPALIVE (CURLOPTTYPE_LONG + 213)
+#define CURLOPT_INFILESIZE_LARGE (CURLOPTTYPE_OFF_T + 115)
+
+#define CURLINFO_LONG 0x200000
+#define CURLINFO_RESPONSE_CODE (CURLINFO_LONG + 2)
+
+typedef size_t (*curl_write_callback)(char* buffer, size_t size, size_t nitems, void* userdata);
+typedef size_t (*curl_read_callback)(char* buffer, size_t size, size_t nitems, void* userdata);
+
+}  // extern "C"
+
+#endif  // ONEFLOW_CORE_PERSISTENCE_S3_LIBCURL_H_
@@ -0,0 +1,988 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/persistence/s3/s3_file_system.h"
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+#include "oneflow/core/common/blocking_counter.h"
+#include "oneflow/core/common/str_util.h"
+#include "oneflow/core/thread/thread_pool.h"
+
+#ifdef OF_PLATFORM_POSIX
+
+#include <dlfcn.h>
+
+#endif  // OF_PLATFORM_POSIX
+
+namespace oneflow {
+
+namespace fs {
+
+namespace {
+
+constexpr uint64_t kDefaultBlockSize = 8 * 1024 * 1024;         // 8MB
+constexpr uint64_t kDefaultUploadPartSize = 64 * 1024 * 1024;   // 64MB
+constexpr uint64_t kMinUploadPartSize = 5 * 1024 * 1024;        // 5MB, the limit of S3
+constexpr char kEmptyPayloadHash[] =
+    "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855";
+
+// SHA-256 of FIPS 180-4, for the request signatures only
+class Sha256 final {
+ public:
+  Sha256() : state_{0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                    0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19},
+             buffer_size_(0),
+             total_size_(0) {}
+
+  void Update(const char* data, size_t n) {
+    total_size_ += n;
+    while (n > 0) {
+      const size_t copy_size = std::min(n, sizeof(buffer_) - buffer_size_);
+      std::memcpy(buffer_ + buffer_size_, data, copy_size);
+      buffer_size_ += copy_size;
+      data += copy_size;
+      n -= copy_size;
+      if (buffer_size_ == sizeof(buffer_)) {
+        Transform(buffer_);
+        buffer_size_ = 0;
+      }
+    }
+  }
+
+  std::string Final() {
+    const uint64_t bit_size = total_size_ * 8;
+    const char pad = static_cast<char>(0x80);
+    Update(&pad, 1);
+    const char zero = 0;
+    while (buffer_size_ != 56) { Update(&zero, 1); }
+    char size_bytes[8];
+    for (int i = 0; i < 8; ++i) { size_bytes[i] = static_cast<char>(bit_size >> (56 - 8 * i)); }
+    Update(size_bytes, 8);
+    std::string digest(32, '\0');
+    for (int i = 0; i < 32; ++i) {
+      digest[i] = static_cast<char>(state_[i / 4] >> (24 - 8 * (i % 4)));
+    }
+    return digest;
+  }
+
+ private:
+  static uint32_t Rotr(uint32_t x, int n) { return (x >> n) | (x << (32 - n)); }
+
+  void Transform(const unsigned char* block) {
+    static const uint32_t k[64] = {
+        0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4,
+        0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe,
+        0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f,
+        0x4a7484aa, 0x5cb0a9dc, 0x76f988da, 0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+        0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc,
+        0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+        0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070, 0x19a4c116,
+        0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+        0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7,
+        0xc67178f2};
+    uint32_t w[64];
+    for (int i = 0; i < 16; ++i) {
+      w[i] = (static_cast<uint32_t>(block[4 * i]) << 24)
+             | (static_cast<uint32_t>(block[4 * i + 1]) << 16)
+             | (static_cast<uint32_t>(block[4 * i + 2]) << 8) | block[4 * i + 3];
+    }
+    for (int i = 16; i < 64; ++i) {
+      const uint32_t s0 = Rotr(w[i - 15], 7) ^ Rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+      const uint32_t s1 = Rotr(w[i - 2], 17) ^ Rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+      w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+    uint32_t a = state_[0], b = state_[1], c = state_[2], d = state_[3];
+    uint32_t e = state_[4], f = state_[5], g = state_[6], h = state_[7];
+    for (int i = 0; i < 64; ++i) {
+      const uint32_t t1 =
+          h + (Rotr(e, 6) ^ Rotr(e, 11) ^ Rotr(e, 25)) + ((e & f) ^ (~e & g)) + k[i] + w[i];
+      const uint32_t t2 = (Rotr(a, 2) ^ Rotr(a, 13) ^ Rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+      h = g;
+      g = f;
+      f = e;
+      e = d + t1;
+      d = c;
+      c = b;
+      b = a;
+      a = t1 + t2;
+    }
+    state_[0] += a;
+    state_[1] += b;
+    state_[2] += c;
+    state_[3] += d;
+    state_[4] += e;
+    state_[5] += f;
+    state_[6] += g;
+    state_[7] += h;
+  }
+
+  void Transform(const char* block) { Transform(reinterpret_cast<const unsigned char*>(block)); }
+
+  uint32_t state_[8];
+  char buffer_[64];
+  size_t buffer_size_;
+  uint64_t total_size_;
+};
+
+std::string Sha256Digest(const std::string& data) {
+  Sha256 sha256;
+  sha256.Update(data.data(), data.size());
+  return sha256.Final();
+}
+
+std::string HmacSha256(const std::string& key, const std::string& data) {
+  std::string block_key = key.size() > 64 ? Sha256Digest(key) : key;
+  block_key.resize(64, '\0');
+  std::string inner_pad(64, '\0');
+  std::string outer_pad(64, '\0');
+  for (int i = 0; i < 64; ++i) {
+    inner_pad[i] = static_cast<char>(block_key[i] ^ 0x36);
+    outer_pad[i] = static_cast<char>(block_key[i] ^ 0x5c);
+  }
+  return Sha256Digest(outer_pad + Sha256Digest(inner_pad + data));
+}
+
+std::string HexEncode(const std::string& data) {
+  static const char kHexDigits[] = "0123456789abcdef";
+  std::string hex;
+  hex.reserve(data.size() * 2);
+  for (unsigned char c : data) {
+    hex.push_back(kHexDigits[c >> 4]);
+    hex.push_back(kHexDigits[c & 0xf]);
+  }
+  return hex;
+}
+
+std::string Trim(const std::string& str) {
+  const size_t begin = str.find_first_not_of(" \t\r\n");
+  if (begin == std::string::npos) { return ""; }
+  const size_t end = str.find_last_not_of(" \t\r\n");
+  return str.substr(begin, end - begin + 1);
+}
+
+std::string XmlUnescape(const std::string& str) {
+  static const std::vector<std::pair<std::string, char>> kEntities = {
+      {"&amp;", '&'}, {"&lt;", '<'}, {"&gt;", '>'}, {"&quot;", '"'}, {"&apos;", '\''}};
+  std::string result;
+  result.reserve(str.size());
+  for (size_t i = 0; i < str.size();) {
+    bool replaced = false;
+    if (str[i] == '&') {
+      for (const auto& entity : kEntities) {
+        if (str.compare(i, entity.first.size(), entity.first) == 0) {
+          result.push_back(entity.second);
+          i += entity.first.size();
+          replaced = true;
+          break;
+        }
+      }
+    }
+    if (!replaced) { result.push_back(str[i++]); }
+  }
+  return result;
+}
+
+// Finds the next <tag>...</tag> from `*pos` and moves `*pos` behind it. Returns false if not found.
+bool NextXmlElement(const std::string& xml, const std::string& tag, size_t* pos,
+                    std::string* text) {
+  const std::string open_tag = "<" + tag + ">";
+  const std::string close_tag = "</" + tag + ">";
+  const size_t begin = xml.find(open_tag, *pos);
+  if (begin == std::string::npos) { return false; }
+  const size_t end = xml.find(close_tag, begin + open_tag.size());
+  if (end == std::string::npos) { return false; }
+  *text = xml.substr(begin + open_tag.size(), end - begin - open_tag.size());
+  *pos = end + close_tag.size();
+  return true;
+}
+
+std::string AmzDate() {
+  time_t now = time(nullptr);
+  struct tm tm;
+  gmtime_r(&now, &tm);
+  char buf[32];
+  strftime(buf, sizeof(buf), "%Y%m%dT%H%M%SZ", &tm);
+  return buf;
+}
+
+bool IsOk(const S3Client::Response& response) {
+  return response.status >= 200 && response.status < 300
+         && response.body.find("<Error>") == std::string::npos;
+}
+
+std::string DirPrefix(const std::string& key) { return key.empty() ? key : key + "/"; }
+
+void* LoadLibCurl() {
+#ifdef OF_PLATFORM_POSIX
+  for (const char* name : {"libcurl.so.4", "libcurl.so", "libcurl-gnutls.so.4"}) {
+    void* handle = dlopen(name, RTLD_NOW | RTLD_LOCAL);
+    if (handle != nullptr) { return handle; }
+  }
+  LOG(WARNING) << dlerror();
+#endif  // OF_PLATFORM_POSIX
+  return nullptr;
+}
+
+template<typename T>
+bool BindCurlFunc(void* handle, const char* name, T* func) {
+#ifdef OF_PLATFORM_POSIX
+  void* symbol = dlsym(handle, name);
+  if (symbol == nullptr) {
+    LOG(WARNING) << dlerror();
+    return false;
+  }
+  *func = reinterpret_cast<T>(symbol);
+  return true;
+#else
+  return false;
+#endif  // OF_PLATFORM_POSIX
+}
+
+}  // namespace
+
+void LibCurl::LoadAndBind() {
+  handle_ = LoadLibCurl();
+  if (handle_ == nullptr) { return; }
+#define BIND_CURL_FUNC(function) \
+  if (!BindCurlFunc(handle_, #function, &function)) { return; }
+
+  BIND_CURL_FUNC(curl_global_init);
+  BIND_CURL_FUNC(curl_easy_init);
+  BIND_CURL_FUNC(curl_easy_setopt);
+  BIND_CURL_FUNC(curl_easy_perform);
+  BIND_CURL_FUNC(curl_easy_getinfo);
+  BIND_CURL_FUNC(curl_easy_reset);
+  BIND_CURL_FUNC(curl_easy_cleanup);
+  BIND_CURL_FUNC(curl_easy_strerror);
+  BIND_CURL_FUNC(curl_slist_append);
+  BIND_CURL_FUNC(curl_slist_free_all);
+#undef BIND_CURL_FUNC
+  status_ = curl_global_init(CURL_GLOBAL_ALL) == CURLE_OK;
+}
+
+std::string S3UriEncode(const std::string& str, bool encode_slash) {
+  static const char kHexDigits[] = "0123456789ABCDEF";
+  std::string encoded;
+  encoded.reserve(str.size());
+  for (unsigned char c : str) {
+    if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '-'
+        || c == '_' || c == '.' || c == '~' || (c == '/' && !encode_slash)) {
+      encoded.push_back(c);
+    } else {
+      encoded.push_back('%');
+      encoded.push_back(kHexDigits[c >> 4]);
+      encoded.push_back(kHexDigits[c & 0xf]);
+    }
+  }
+  return encoded;
+}
+
+std::string S3SignV4(const S3Credentials& credentials, const std::string& region,
+                     const std::string& method, const std::string& canonical_uri,
+                     const std::string& canonical_query,
+                     const std::map<std::string, std::string>& headers,
+                     const std::string& payload_hash) {
+  std::string canonical_headers;
+  std::string signed_headers;
+  for (const auto& pair : headers) {
+    canonical_headers += pair.first + ":" + Trim(pair.second) + "\n";
+    if (!signed_headers.empty()) { signed_headers += ";"; }
+    signed_headers += pair.first;
+  }
+  const std::string canonical_request = method + "\n" + canonical_uri + "\n" + canonical_query
+                                        + "\n" + canonical_headers + "\n" + signed_headers + "\n"
+                                        + payload_hash;
+  const std::string& amz_date = headers.at("x-amz-date");
+  const std::string date = amz_date.substr(0, 8);
+  const std::string scope = date + "/" + region + "/s3/aws4_request";
+  const std::string string_to_sign = "AWS4-HMAC-SHA256\n" + amz_date + "\n" + scope + "\n"
+                                     + HexEncode(Sha256Digest(canonical_request));
+  std::string signing_key = HmacSha256("AWS4" + credentials.secret_access_key, date);
+  signing_key = HmacSha256(signing_key, region);
+  signing_key = HmacSha256(signing_key, "s3");
+  signing_key = HmacSha256(signing_key, "aws4_request");
+  return "AWS4-HMAC-SHA256 Credential=" + credentials.access_key_id + "/" + scope
+         + ", SignedHeaders=" + signed_headers
+         + ", Signature=" + HexEncode(HmacSha256(signing_key, string_to_sign));
+}
+
+void ParseS3Path(const std::string& path, std::string* bucket, std::string* key) {
+  size_t begin = 0;
+  if (path.compare(0, 5, "s3://") == 0) { begin = 5; }
+  while (begin < path.size() && path[begin] == '/') { ++begin; }
+  const size_t slash = path.find('/', begin);
+  if (slash == std::string::npos) {
+    *bucket = path.substr(begin);
+    key->clear();
+  } else {
+    *bucket = path.substr(begin, slash - begin);
+    *key = path.substr(slash + 1);
+  }
+  while (!key->empty() && key->back() == '/') { key->pop_back(); }
+  CHECK(!bucket->empty()) << "no bucket in path " << path;
+}
+
+void ParseS3ListObjectsResult(const std::string& xml, std::vector<std::string>* keys,
+                              std::vector<std::string>* common_prefixes,
+                              std::string* next_continuation_token) {
+  std::string element;
+  std::string text;
+  size_t pos = 0;
+  while (NextXmlElement(xml, "Contents", &pos, &element)) {
+    size_t element_pos = 0;
+    if (NextXmlElement(element, "Key", &element_pos, &text)) {
+      keys->push_back(XmlUnescape(text));
+    }
+  }
+  pos = 0;
+  while (NextXmlElement(xml, "CommonPrefixes", &pos, &element)) {
+    size_t element_pos = 0;
+    if (NextXmlElement(element, "Prefix", &element_pos, &text)) {
+      common_prefixes->push_back(XmlUnescape(text));
+    }
+  }
+  pos = 0;
+  if (NextXmlElement(xml, "NextContinuationToken", &pos, &text)) {
+    *next_continuation_token = XmlUnescape(text);
+  } else {
+    next_continuation_token->clear();
+  }
+}
+
+namespace {
+
+struct TransferState {
+  S3Client::Response* response;
+  char* out;
+  size_t out_size;
+  const std::string* upload;
+  size_t upload_pos;
+};
+
+size_t WriteCallback(char* buffer, size_t size, size_t nitems, void* userdata) {
+  TransferState* state = static_cast<TransferState*>(userdata);
+  const size_t n = size * nitems;
+  if (state->out != nullptr && state->response->out_size < state->out_size) {
+    const size_t copy_size = std::min(n, state->out_size - state->response->out_size);
+    std::memcpy(state->out + state->response->out_size, buffer, copy_size);
+    state->response->out_size += copy_size;
+    state->response->body.append(buffer + copy_size, n - copy_size);
+  } else {
+    state->response->body.append(buffer, n);
+  }
+  return n;
+}
+
+size_t ReadCallback(char* buffer, size_t size, size_t nitems, void* userdata) {
+  TransferState* state = static_cast<TransferState*>(userdata);
+  const size_t n = std::min(size * nitems, state->upload->size() - state->upload_pos);
+  std::memcpy(buffer, state->upload->data() + state->upload_pos, n);
+  state->upload_pos += n;
+  return n;
+}
+
+size_t HeaderCallback(char* buffer, size_t size, size_t nitems, void* userdata) {
+  TransferState* state = static_cast<TransferState*>(userdata);
+  const size_t n = size * nitems;
+  const std::string line(buffer, n);
+  if (line.compare(0, 5, "HTTP/") == 0) {
+    // a new response, e.g. the one after "100 Continue"
+    state->response->headers.clear();
+    return n;
+  }
+  const size_t colon = line.find(':');
+  if (colon != std::string::npos) {
+    state->response->headers[ToLower(Trim(line.substr(0, colon)))] = Trim(line.substr(colon + 1));
+  }
+  return n;
+}
+
+}  // namespace
+
+S3Client::S3Client(const std::string& endpoint, const std::string& region,
+                   S3Credentials credentials, int64_t max_connections, int64_t max_retries)
+    : curl_(LibCurl::Load()),
+      endpoint_(endpoint),
+      region_(region),
+      credentials_(std::move(credentials)),
+      max_connections_(max_connections),
+      max_retries_(max_retries) {
+  CHECK(curl_->status()) << "libcurl is required by the S3 file system";
+  CHECK_GT(max_connections_, 0);
+  CHECK_GE(max_retries_, 0);
+  while (!endpoint_.empty() && endpoint_.back() == '/') { endpoint_.pop_back(); }
+  const size_t scheme_end = endpoint_.find("://");
+  host_ = scheme_end == std::string::npos ? endpoint_ : endpoint_.substr(scheme_end + 3);
+  host_ = host_.substr(0, host_.find('/'));
+}
+
+S3Client::~S3Client() {
+  for (CURL* curl : idle_connections_) { curl_->curl_easy_cleanup(curl); }
+}
+
+CURL* S3Client::AcquireConnection() {
+  {
+    std::unique_lock<std::mutex> lock(connections_mutex_);
+    if (!idle_connections_.empty()) {
+      CURL* curl = idle_connections_.back();
+      idle_connections_.pop_back();
+      return curl;
+    }
+  }
+  CURL* curl = curl_->curl_easy_init();
+  CHECK(curl != nullptr);
+  return curl;
+}
+
+void S3Client::ReleaseConnection(CURL* curl) {
+  // the reset keeps the live connection and the DNS cache of the handle
+  curl_->curl_easy_reset(curl);
+  {
+    std::unique_lock<std::mutex> lock(connections_mutex_);
+    if (idle_connections_.size() < max_connections_) {
+      idle_connections_.push_back(curl);
+      return;
+    }
+  }
+  curl_->curl_easy_cleanup(curl);
+}
+
+S3Client::Response S3Client::Send(const std::string& method, const std::string& bucket,
+                                  const std::string& key,
+                                  const std::vector<std::pair<std::string, std::string>>& query,
+                                  const std::map<std::string, std::string>& headers,
+                                  const std::string* upload, char* out, size_t out_size) {
+  const std::string canonical_uri = "/" + bucket + "/" + S3UriEncode(key, false);
+  std::vector<std::string> encoded_query;
+  for (const auto& pair : query) {
+    encoded_query.push_back(S3UriEncode(pair.first, true) + "=" + S3UriEncode(pair.second, true));
+  }
+  std::sort(encoded_query.begin(), encoded_query.end());
+  std::string canonical_query;
+  for (const std::string& param : encoded_query) {
+    if (!canonical_query.empty()) { canonical_query += "&"; }
+    canonical_query += param;
+  }
+  const std::string url =
+      endpoint_ + canonical_uri + (canonical_query.empty() ? "" : "?" + canonical_query);
+  const std::string payload_hash =
+      upload == nullptr || upload->empty() ? kEmptyPayloadHash : HexEncode(Sha256Digest(*upload));
+
+  Response response;
+  for (int64_t attempt = 0;; ++attempt) {
+    std::map<std::string, std::string> signed_headers = headers;
+    signed_headers["host"] = host_;
+    signed_headers["x-amz-date"] = AmzDate();
+    signed_headers["x-amz-content-sha256"] = payload_hash;
+    if (!credentials_.session_token.empty()) {
+      signed_headers["x-amz-security-token"] = credentials_.session_token;
+    }
+    curl_slist* header_list = nullptr;
+    for (const auto& pair : signed_headers) {
+      // curl sends its own Host header, which is the signed one
+      if (pair.first == "host") { continue; }
+      header_list = curl_->curl_slist_append(header_list, (pair.first + ": " + pair.second).c_str());
+    }
+    if (!credentials_.access_key_id.empty()) {
+      const std::string authorization = S3SignV4(credentials_, region_, method, canonical_uri,
+                                                 canonical_query, signed_headers, payload_hash);
+      header_list =
+          curl_->curl_slist_append(header_list, ("Authorization: " + authorization).c_str());
+    }
+    header_list = curl_->curl_slist_append(header_list, "Expect:");
+
+    response = Response();
+    TransferState state{&response, out, out_size, upload, 0};
+    CURL* curl = AcquireConnection();
+    curl_->curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_->curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+    curl_->curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_->curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, 30L);
+    curl_->curl_easy_setopt(curl, CURLOPT_HTTPHEADER, header_list);
+    curl_->curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, &WriteCallback);
+    curl_->curl_easy_setopt(curl, CURLOPT_WRITEDATA, &state);
+    curl_->curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, &HeaderCallback);
+    curl_->curl_easy_setopt(curl, CURLOPT_HEADERDATA, &state);
+    if (method == "HEAD") {
+      curl_->curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
+    } else if (method != "GET") {
+      curl_->curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, method.c_str());
+    }
+    if (upload != nullptr) {
+      curl_->curl_easy_setopt(curl, CURLOPT_UPLOAD, 1L);
+      curl_->curl_easy_setopt(curl, CURLOPT_READFUNCTION, &ReadCallback);
+      curl_->curl_easy_setopt(curl, CURLOPT_READDATA, &state);
+      curl_->curl_easy_setopt(curl, CURLOPT_INFILESIZE_LARGE,
+                              static_cast<curl_off_t>(upload->size()));
+    }
+    const CURLcode code = curl_->curl_easy_perform(curl);
+    if (code == CURLE_OK) { curl_->curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response.status); }
+    ReleaseConnection(curl);
+    curl_->curl_slist_free_all(header_list);
+
+    const bool retryable =
+        code != CURLE_OK || response.status >= 500 || response.status == 429;
+    if (!retryable) { return response; }
+    if (attempt >= max_retries_) {
+      CHECK_EQ(code, CURLE_OK) << method << " " << url << ": " << curl_->curl_easy_strerror(code);
+      return response;
+    }
+    LOG(WARNING) << method << " " << url << " failed with "
+                 << (code != CURLE_OK ? std::string(curl_->curl_easy_strerror(code))
+                                      : "status " + std::to_string(response.status))
+                 << ", retrying";
+    usleep(std::min<int64_t>(100000LL << std::min<int64_t>(attempt, 6), 5000000));
+  }
+}
+
+// Blocks of objects on the local disk, named by a hash of the object, its ETag and the block.
+class S3BlockCache final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(S3BlockCache);
+  explicit S3BlockCache(const std::string& dir) : dir_(dir) {
+    LocalFS()->RecursivelyCreateDirIfNotExist(dir_);
+  }
+  ~S3BlockCache() = default;
+
+  bool Lookup(const std::string& block_id, size_t size, char* data) const {
+    const std::string path = JoinPath(dir_, block_id);
+    if (!LocalFS()->FileExists(path) || LocalFS()->GetFileSize(path) != size) { return false; }
+    std::unique_ptr<RandomAccessFile> file;
+    LocalFS()->NewRandomAccessFile(path, &file);
+    file->Read(0, size, data);
+    return true;
+  }
+
+  void Insert(const std::string& block_id, const char* data, size_t size) {
+    // written aside and renamed, so other readers never see a partial block
+    static std::atomic<int64_t> tmp_cnt(0);
+    const std::string path = JoinPath(dir_, block_id);
+    const std::string tmp_path =
+        path + ".tmp." + std::to_string(getpid()) + "." + std::to_string(tmp_cnt++);
+    std::unique_ptr<WritableFile> file;
+    LocalFS()->NewWritableFile(tmp_path, &file);
+    file->Append(data, size);
+    file->Close();
+    LocalFS()->RenameFile(tmp_path, path);
+  }
+
+ private:
+  std::string dir_;
+};
+
+namespace {
+
+struct S3Block {
+  explicit S3Block(size_t size) : data(size), done(1) {}
+
+  std::vector<char> data;
+  BlockingCounter done;
+};
+
+class S3RandomAccessFile : public RandomAccessFile {
+ public:
+  S3RandomAccessFile(S3Client* client, ThreadPool* thread_pool, S3BlockCache* block_cache,
+                     const std::string& bucket, const std::string& key, uint64_t size,
+                     const std::string& etag, uint64_t block_size, int64_t read_ahead_blocks)
+      : client_(client),
+        thread_pool_(thread_pool),
+        block_cache_(block_cache),
+        bucket_(bucket),
+        key_(key),
+        size_(size),
+        etag_(etag),
+        block_size_(block_size),
+        read_ahead_blocks_(read_ahead_blocks),
+        next_sequential_offset_(0) {}
+  ~S3RandomAccessFile() override = default;
+
+  void Read(uint64_t offset, size_t n, char* result) const override {
+    if (n == 0) { return; }
+    CHECK_LE(offset + n, size_) << "s3://" << bucket_ << "/" << key_;
+    const int64_t first = offset / block_size_;
+    const int64_t last = (offset + n - 1) / block_size_;
+    std::vector<std::shared_ptr<S3Block>> blocks;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      int64_t fetch_last = last;
+      if (offset == next_sequential_offset_) {
+        const int64_t block_num = (size_ + block_size_ - 1) / block_size_;
+        fetch_last = std::min(last + read_ahead_blocks_, block_num - 1);
+      }
+      next_sequential_offset_ = offset + n;
+      for (int64_t i = first; i <= fetch_last; ++i) {
+        std::shared_ptr<S3Block> block = GetOrFetchBlock(i);
+        if (i <= last) { blocks.push_back(block); }
+      }
+      EvictBlocks(first, fetch_last);
+    }
+    for (int64_t i = first; i <= last; ++i) {
+      const std::shared_ptr<S3Block>& block = blocks.at(i - first);
+      block->done.WaitUntilCntEqualZero();
+      const uint64_t block_offset = i * block_size_;
+      const uint64_t begin = std::max<uint64_t>(offset, block_offset);
+      const uint64_t end = std::min<uint64_t>(offset + n, block_offset + block->data.size());
+      std::memcpy(result + (begin - offset), block->data.data() + (begin - block_offset),
+                  end - begin);
+    }
+  }
+
+ private:
+  std::shared_ptr<S3Block> GetOrFetchBlock(int64_t index) const {
+    auto it = blocks_.find(index);
+    if (it != blocks_.end()) { return it->second; }
+    const uint64_t block_offset = index * block_size_;
+    std::shared_ptr<S3Block> block(
+        new S3Block(std::min<uint64_t>(block_size_, size_ - block_offset)));
+    blocks_.emplace(index, block);
+    const std::string block_id = HexEncode(Sha256Digest(bucket_ + "/" + key_ + "\n" + etag_ + "\n"
+                                                        + std::to_string(block_size_) + "\n"
+                                                        + std::to_string(index)));
+    // the work owns what it uses, the file may be closed before the read-ahead is done
+    S3Client* client = client_;
+    S3BlockCache* block_cache = block_cache_;
+    const std::string bucket = bucket_;
+    const std::string key = key_;
+    thread_pool_->AddWork([client, block_cache, bucket, key, block_id, block_offset, block]() {
+      const size_t size = block->data.size();
+      if (block_cache == nullptr || !block_cache->Lookup(block_id, size, block->data.data())) {
+        const std::string range =
+            "bytes=" + std::to_string(block_offset) + "-" + std::to_string(block_offset + size - 1);
+        S3Client::Response response =
+            client->Send("GET", bucket, key, {}, {{"range", range}}, nullptr, block->data.data(),
+                         size);
+        CHECK(IsOk(response)) << "GET s3://" << bucket << "/" << key << " " << range
+                              << " failed with status " << response.status << ": "
+                              << response.body;
+        CHECK_EQ(response.out_size, size) << "s3://" << bucket << "/" << key << " " << range;
+        if (block_cache != nullptr) { block_cache->Insert(block_id, block->data.data(), size); }
+      }
+      block->done.Decrease();
+    });
+    return block;
+  }
+
+  // Keeps the blocks of the current read and its read-ahead, plus a block in either direction
+  // for the records that straddle blocks. The farthest blocks go first.
+  void EvictBlocks(int64_t first, int64_t fetch_last) const {
+    const size_t capacity = fetch_last - first + 3;
+    while (blocks_.size() > capacity) {
+      auto farthest = blocks_.begin();
+      if (first - blocks_.begin()->first < blocks_.rbegin()->first - fetch_last) {
+        farthest = std::prev(blocks_.end());
+      }
+      blocks_.erase(farthest);
+    }
+  }
+
+  S3Client* client_;
+  ThreadPool* thread_pool_;
+  S3BlockCache* block_cache_;
+  std::string bucket_;
+  std::string key_;
+  uint64_t size_;
+  std::string etag_;
+  uint64_t block_size_;
+  int64_t read_ahead_blocks_;
+
+  mutable std::mutex mutex_;
+  mutable std::map<int64_t, std::shared_ptr<S3Block>> blocks_;
+  mutable uint64_t next_sequential_offset_;
+};
+
+class S3WritableFile : public WritableFile {
+ public:
+  S3WritableFile(S3Client* client, const std::string& bucket, const std::string& key,
+                 uint64_t upload_part_size, std::string content)
+      : client_(client),
+        bucket_(bucket),
+        key_(key),
+        upload_part_size_(upload_part_size),
+        buffer_(std::move(content)),
+        closed_(false) {}
+
+  ~S3WritableFile() override {
+    if (!closed_) { Close(); }
+  }
+
+  void Append(const char* data, size_t n) override {
+    CHECK(!closed_) << Path();
+    buffer_.append(data, n);
+    if (buffer_.size() >= upload_part_size_) { UploadPart(); }
+  }
+
+  void Close() override {
+    closed_ = true;
+    if (upload_id_.empty()) {
+      S3Client::Response response = client_->Send("PUT", bucket_, key_, {}, {}, &buffer_);
+      CHECK(IsOk(response)) << "PUT " << Path() << " failed with status " << response.status
+                            << ": " << response.body;
+    } else {
+      if (!buffer_.empty()) { UploadPart(); }
+      std::string xml = "<CompleteMultipartUpload>";
+      for (size_t i = 0; i < part_etags_.size(); ++i) {
+        xml += "<Part><PartNumber>" + std::to_string(i + 1) + "</PartNumber><ETag>"
+               + part_etags_.at(i) + "</ETag></Part>";
+      }
+      xml += "</CompleteMultipartUpload>";
+      S3Client::Response response =
+          client_->Send("POST", bucket_, key_, {{"uploadId", upload_id_}}, {}, &xml);
+      CHECK(IsOk(response)) << "completing the upload of " << Path() << " failed with status "
+                            << response.status << ": " << response.body;
+    }
+    std::string().swap(buffer_);
+  }
+
+  // Objects are immutable, the data is uploaded by parts and on Close
+  void Flush() override {}
+
+ private:
+  std::string Path() const { return "s3://" + bucket_ + "/" + key_; }
+
+  void UploadPart() {
+    if (upload_id_.empty()) {
+      const std::string empty;
+      S3Client::Response response =
+          client_->Send("POST", bucket_, key_, {{"uploads", ""}}, {}, &empty);
+      CHECK(IsOk(response)) << "starting the upload of " << Path() << " failed with status "
+                            << response.status << ": " << response.body;
+      size_t pos = 0;
+      CHECK(NextXmlElement(response.body, "UploadId", &pos, &upload_id_)) << response.body;
+    }
+    const std::string part_number = std::to_string(part_etags_.size() + 1);
+    S3Client::Response response = client_->Send(
+        "PUT", bucket_, key_, {{"partNumber", part_number}, {"uploadId", upload_id_}}, {},
+        &buffer_);
+    CHECK(IsOk(response)) << "uploading part " << part_number << " of " << Path()
+                          << " failed with status " << response.status << ": " << response.body;
+    part_etags_.push_back(response.headers["etag"]);
+    buffer_.clear();
+  }
+
+  S3Client* client_;
+  std::string bucket_;
+  std::string key_;
+  uint64_t upload_part_size_;
+  std::string buffer_;
+  bool closed_;
+  std::string upload_id_;
+  std::vector<std::string> part_etags_;
+};
+
+}  // namespace
+
+S3FileSystem::S3FileSystem(const std::string& env_prefix) {
+  const std::string region =
+      GetStringFromEnv(env_prefix + "_S3_REGION", GetStringFromEnv("AWS_REGION", "us-east-1"));
+  const std::string endpoint = GetStringFromEnv(env_prefix + "_S3_ENDPOINT",
+                                                "https://s3." + region + ".amazonaws.com");
+  S3Credentials credentials;
+  credentials.access_key_id = GetStringFromEnv(env_prefix + "_S3_ACCESS_KEY_ID",
+                                               GetStringFromEnv("AWS_ACCESS_KEY_ID", ""));
+  credentials.secret_access_key = GetStringFromEnv(
+      env_prefix + "_S3_SECRET_ACCESS_KEY", GetStringFromEnv("AWS_SECRET_ACCESS_KEY", ""));
+  credentials.session_token = GetStringFromEnv(env_prefix + "_S3_SESSION_TOKEN",
+                                               GetStringFromEnv("AWS_SESSION_TOKEN", ""));
+  const int64_t max_connections = ParseIntegerFromEnv(env_prefix + "_S3_MAX_CONNECTIONS", 16);
+  client_.reset(new S3Client(endpoint, region, std::move(credentials), max_connections,
+                             ParseIntegerFromEnv(env_prefix + "_S3_MAX_RETRIES", 5)));
+  thread_pool_.reset(new ThreadPool(max_connections));
+  const std::string cache_dir = GetStringFromEnv(env_prefix + "_S3_CACHE_DIR", "");
+  if (!cache_dir.empty()) { block_cache_.reset(new S3BlockCache(cache_dir)); }
+  block_size_ = ParseIntegerFromEnv(env_prefix + "_S3_BLOCK_SIZE_BYTES", kDefaultBlockSize);
+  read_ahead_blocks_ = ParseIntegerFromEnv(env_prefix + "_S3_READ_AHEAD_BLOCKS", 4);
+  upload_part_size_ =
+      ParseIntegerFromEnv(env_prefix + "_S3_UPLOAD_PART_SIZE_BYTES", kDefaultUploadPartSize);
+  CHECK_GT(block_size_, 0);
+  CHECK_GE(read_ahead_blocks_, 0);
+  CHECK_GE(upload_part_size_, kMinUploadPartSize);
+}
+
+// the pool goes first, its works use the client and the cache
+S3FileSystem::~S3FileSystem() { thread_pool_.reset(); }
+
+bool S3FileSystem::HeadObject(const std::string& bucket, const std::string& key, uint64_t* size,
+                              std::string* etag) {
+  S3Client::Response response = client_->Send("HEAD", bucket, key, {}, {}, nullptr);
+  if (response.status == 404) { return false; }
+  CHECK(IsOk(response)) << "HEAD s3://" << bucket << "/" << key << " failed with status "
+                        << response.status;
+  if (size != nullptr) { *size = std::stoull(response.headers["content-length"]); }
+  if (etag != nullptr) { *etag = response.headers["etag"]; }
+  return true;
+}
+
+void S3FileSystem::ListObjects(const std::string& bucket, const std::string& prefix,
+                               int64_t max_keys, std::vector<std::string>* keys,
+                               std::vector<std::string>* common_prefixes) {
+  std::string continuation_token;
+  do {
+    std::vector<std::pair<std::string, std::string>> query = {
+        {"list-type", "2"}, {"prefix", prefix}, {"delimiter", "/"}};
+    if (max_keys > 0) { query.emplace_back("max-keys", std::to_string(max_keys)); }
+    if (!continuation_token.empty()) {
+      query.emplace_back("continuation-token", continuation_token);
+    }
+    S3Client::Response response = client_->Send("GET", bucket, "", query, {}, nullptr);
+    CHECK(IsOk(response)) << "listing s3://" << bucket << "/" << prefix << " failed with status "
+                          << response.status << ": " << response.body;
+    ParseS3ListObjectsResult(response.body, keys, common_prefixes, &continuation_token);
+  } while (!continuation_token.empty()
+           && (max_keys <= 0 || keys->size() + common_prefixes->size() < max_keys));
+}
+
+void S3FileSystem::NewRandomAccessFile(const std::string& fname,
+                                       std::unique_ptr<RandomAccessFile>* result) {
+  std::string bucket;
+  std::string key;
+  ParseS3Path(fname, &bucket, &key);
+  uint64_t size = 0;
+  std::string etag;
+  CHECK(HeadObject(bucket, key, &size, &etag)) << "file not found, path: " << fname;
+  result->reset(new S3RandomAccessFile(client_.get(), thread_pool_.get(), block_cache_.get(),
+                                       bucket, key, size, etag, block_size_,
+                                       read_ahead_blocks_));
+}
+
+void S3FileSystem::NewWritableFile(const std::string& fname,
+                                   std::unique_ptr<WritableFile>* result) {
+  std::string bucket;
+  std::string key;
+  ParseS3Path(fname, &bucket, &key);
+  result->reset(new S3WritableFile(client_.get(), bucket, key, upload_part_size_, ""));
+}
+
+void S3FileSystem::NewAppendableFile(const std::string& fname,
+                                     std::unique_ptr<WritableFile>* result) {
+  std::string bucket;
+  std::string key;
+  ParseS3Path(fname, &bucket, &key);
+  // objects can not be appended, the existing content is uploaded again with the new one
+  std::string content;
+  uint64_t size = 0;
+  if (HeadObject(bucket, key, &size, nullptr) && size > 0) {
+    content.resize(size);
+    S3Client::Response response =
+        client_->Send("GET", bucket, key, {}, {}, nullptr, &content[0], size);
+    CHECK(IsOk(response)) << "GET " << fname << " failed with status " << response.status;
+    CHECK_EQ(response.out_size, size) << fname;
+  }
+  result->reset(
+      new S3WritableFile(client_.get(), bucket, key, upload_part_size_, std::move(content)));
+}
+
+bool S3FileSystem::FileExists(const std::string& fname) {
+  std::string bucket;
+  std::string key;
+  ParseS3Path(fname, &bucket, &key);
+  if (key.empty()) { return true; }
+  return HeadObject(bucket, key, nullptr, nullptr) || IsDirectory(fname);
+}
+
+std::vector<std::string> S3FileSystem::ListDir(const std::string& dir) {
+  std::string bucket;
+  std::string key;
+  ParseS3Path(dir, &bucket, &key);
+  CHECK(IsDirectory(dir)) << "directory not found, path: " << dir;
+  const std::string prefix = DirPrefix(key);
+  std::vector<std::string> keys;
+  std::vector<std::string> common_prefixes;
+  ListObjects(bucket, prefix, 0, &keys, &common_prefixes);
+  std::vector<std::string> result;
+  for (const std::string& child : keys) {
+    // the object of CreateDir
+    if (child.size() == prefix.size()) { continue; }
+    result.push_back(child.substr(prefix.size()));
+  }
+  for (const std::string& child : common_prefixes) {
+    result.push_back(child.substr(prefix.size(), child.size() - prefix.size() - 1));
+  }
+  return result;
+}
+
+void S3FileSystem::DelFile(const std::string& fname) {
+  std::string bucket;
+  std::string key;
+  ParseS3Path(fname, &bucket, &key);
+  S3Client::Response response = client_->Send("DELETE", bucket, key, {}, {}, nullptr);
+  CHECK(IsOk(response)) << "DELETE " << fname << " failed with status " << response.status << ": "
+                        << response.body;
+}
+
+void S3FileSystem::CreateDir(const std::string& dirname) {
+  std::string bucket;
+  std::string key;
+  ParseS3Path(dirname, &bucket, &key);
+  if (key.empty()) { return; }
+  const std::string empty;
+  S3Client::Response response = client_->Send("PUT", bucket, DirPrefix(key), {}, {}, &empty);
+  CHECK(IsOk(response)) << "creating " << dirname << " failed with status " << response.status
+                        << ": " << response.body;
+}
+
+void S3FileSystem::DeleteDir(const std::string& dirname) {
+  std::string bucket;
+  std::string key;
+  ParseS3Path(dirname, &bucket, &key);
+  CHECK(IsDirectory(dirname)) << "directory not found, path: " << dirname;
+  CHECK(IsDirEmpty(dirname)) << dirname << " Cannot delete a non-empty directory.";
+  if (key.empty()) { return; }
+  S3Client::Response response = client_->Send("DELETE", bucket, DirPrefix(key), {}, {}, nullptr);
+  CHECK(IsOk(response)) << "deleting " << dirname << " failed with status " << response.status
+                        << ": " << response.body;
+}
+
+uint64_t S3FileSystem::GetFileSize(const std::string& fname) {
+  std::string bucket;
+  std::string key;
+  ParseS3Path(fname, &bucket, &key);
+  uint64_t size = 0;
+  CHECK(HeadObject(bucket, key, &size, nullptr)) << "file not found, path: " << fname;
+  return size;
+}
+
+void S3FileSystem::RenameFile(const std::string& old_name, const std::string& new_name) {
+  std::string old_bucket;
+  std::string old_key;
+  ParseS3Path(old_name, &old_bucket, &old_key);
+  std::string new_bucket;
+  std::string new_key;
+  ParseS3Path(new_name, &new_bucket, &new_key);
+  // a server side copy, which S3 limits to objects of up to 5GB
+  const std::string empty;
+  S3Client::Response response = client_->Send(
+      "PUT", new_bucket, new_key, {},
+      {{"x-amz-copy-source", "/" + old_bucket + "/" + S3UriEncode(old_key, false)}}, &empty);
+  CHECK(IsOk(response)) << "copying " << old_name << " to " << new_name << " failed with status "
+                        << response.status << ": " << response.body;
+  DelFile(old_name);
+}
+
+bool S3FileSystem::IsDirectory(const std::string& fname) {
+  std::string bucket;
+  std::string key;
+  ParseS3Path(fname, &bucket, &key);
+  if (key.empty()) { return true; }
+  std::vector<std::string> keys;
+  std::vector<std::string> common_prefixes;
+  ListObjects(bucket, DirPrefix(key), 1, &keys, &common_prefixes);
+  return !keys.empty() || !common_prefixes.empty();
+}
+
+}  // namespace fs
+
+}  // namespace oneflow
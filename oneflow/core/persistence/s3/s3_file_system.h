@@ -0,0 +1,189 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_PERSISTENCE_S3_S3_FILE_SYSTEM_H_
+#define ONEFLOW_CORE_PERSISTENCE_S3_S3_FILE_SYSTEM_H_
+
+#include <map>
+#include <mutex>
+#include "oneflow/core/persistence/file_system.h"
+#include "oneflow/core/persistence/s3/libcurl.h"
+
+namespace oneflow {
+
+class ThreadPool;
+
+namespace fs {
+
+class LibCurl {
+ public:
+  static LibCurl* Load() {
+    static LibCurl* lib = []() -> LibCurl* {
+      LibCurl* lib = new LibCurl;
+      lib->LoadAndBind();
+      return lib;
+    }();
+    return lib;
+  }
+
+  // true when libcurl is loaded
+  bool status() { return status_; }
+
+  // curl_easy_setopt and curl_easy_getinfo are variadic, so the functions are kept as pointers
+  CURLcode (*curl_global_init)(long flags) = nullptr;
+  CURL* (*curl_easy_init)() = nullptr;
+  CURLcode (*curl_easy_setopt)(CURL*, CURLoption, ...) = nullptr;
+  CURLcode (*curl_easy_perform)(CURL*) = nullptr;
+  CURLcode (*curl_easy_getinfo)(CURL*, CURLINFO, ...) = nullptr;
+  void (*curl_easy_reset)(CURL*) = nullptr;
+  void (*curl_easy_cleanup)(CURL*) = nullptr;
+  const char* (*curl_easy_strerror)(CURLcode) = nullptr;
+  curl_slist* (*curl_slist_append)(curl_slist*, const char*) = nullptr;
+  void (*curl_slist_free_all)(curl_slist*) = nullptr;
+
+ private:
+  void LoadAndBind();
+  bool status_ = false;
+  void* handle_ = nullptr;
+};
+
+struct S3Credentials {
+  std::string access_key_id;
+  std::string secret_access_key;
+  std::string session_token;
+};
+
+// Percent-encodes `str` as AWS signature version 4 expects, keeping '/' unless `encode_slash`
+std::string S3UriEncode(const std::string& str, bool encode_slash);
+
+// Returns the Authorization header of a request signed with AWS signature version 4. `headers`
+// maps the lowercase names of the signed headers to their values, and must hold host, x-amz-date
+// and x-amz-content-sha256.
+std::string S3SignV4(const S3Credentials& credentials, const std::string& region,
+                     const std::string& method, const std::string& canonical_uri,
+                     const std::string& canonical_query,
+                     const std::map<std::string, std::string>& headers,
+                     const std::string& payload_hash);
+
+// Splits "s3://bucket/key", "/bucket/key" or "bucket/key" into the bucket and the key
+void ParseS3Path(const std::string& path, std::string* bucket, std::string* key);
+
+// Reads the keys, common prefixes and continuation token of a ListObjectsV2 response
+void ParseS3ListObjectsResult(const std::string& xml, std::vector<std::string>* keys,
+                              std::vector<std::string>* common_prefixes,
+                              std::string* next_continuation_token);
+
+// Sends signed requests to an S3 compatible endpoint, in path style, on a pool of reused
+// connections. Failed connections, throttling and server errors are retried with backoff.
+class S3Client final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(S3Client);
+  S3Client(const std::string& endpoint, const std::string& region, S3Credentials credentials,
+           int64_t max_connections, int64_t max_retries);
+  ~S3Client();
+
+  struct Response {
+    long status = 0;
+    // the lowercase names of the response headers, mapped to their values
+    std::map<std::string, std::string> headers;
+    std::string body;
+    // the size of the body written to `out`
+    size_t out_size = 0;
+  };
+
+  // The response body goes to `out` with room for `out_size` bytes when `out` is not nullptr, and
+  // to Response::body otherwise. `upload` is sent as the request body when it is not nullptr.
+  Response Send(const std::string& method, const std::string& bucket, const std::string& key,
+                const std::vector<std::pair<std::string, std::string>>& query,
+                const std::map<std::string, std::string>& headers, const std::string* upload,
+                char* out = nullptr, size_t out_size = 0);
+
+  int64_t max_connections() const { return max_connections_; }
+
+ private:
+  CURL* AcquireConnection();
+  void ReleaseConnection(CURL* curl);
+
+  LibCurl* curl_;
+  std::string endpoint_;
+  std::string host_;
+  std::string region_;
+  S3Credentials credentials_;
+  int64_t max_connections_;
+  int64_t max_retries_;
+  std::mutex connections_mutex_;
+  std::vector<CURL*> idle_connections_;
+};
+
+class S3BlockCache;
+
+// Objects in S3 compatible storage, as files. Reads go through blocks of
+// {prefix}_S3_BLOCK_SIZE_BYTES that are fetched by parallel ranged GETs, a sequential read also
+// fetches the next {prefix}_S3_READ_AHEAD_BLOCKS blocks. With {prefix}_S3_CACHE_DIR the blocks are
+// also kept in that local directory, e.g. on an NVMe disk, keyed by the ETag of the object. The
+// cache is never evicted by OneFlow. Writes are uploaded on Close, in parts
+// of {prefix}_S3_UPLOAD_PART_SIZE_BYTES when they are larger. Directories are the prefixes of
+// the keys, with an empty "<dir>/" object for the directories created by CreateDir.
+class S3FileSystem final : public FileSystem {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(S3FileSystem);
+  S3FileSystem() = delete;
+  ~S3FileSystem() override;
+
+  explicit S3FileSystem(const std::string& env_prefix);
+
+  void NewRandomAccessFile(const std::string& fname,
+                           std::unique_ptr<RandomAccessFile>* result) override;
+
+  void NewWritableFile(const std::string& fname, std::unique_ptr<WritableFile>* result) override;
+
+  void NewAppendableFile(const std::string& fname, std::unique_ptr<WritableFile>* result) override;
+
+  bool FileExists(const std::string& fname) override;
+
+  std::vector<std::string> ListDir(const std::string& dir) override;
+
+  void DelFile(const std::string& fname) override;
+
+  void CreateDir(const std::string& dirname) override;
+
+  void DeleteDir(const std::string& dirname) override;
+
+  uint64_t GetFileSize(const std::string& fname) override;
+
+  void RenameFile(const std::string& old_name, const std::string& new_name) override;
+
+  bool IsDirectory(const std::string& fname) override;
+
+ private:
+  bool HeadObject(const std::string& bucket, const std::string& key, uint64_t* size,
+                  std::string* etag);
+  void ListObjects(const std::string& bucket, const std::string& prefix, int64_t max_keys,
+                   std::vector<std::string>* keys, std::vector<std::string>* common_prefixes);
+
+  std::unique_ptr<S3Client> client_;
+  // fetches the blocks of the reads, one connection per thread
+  std::unique_ptr<ThreadPool> thread_pool_;
+  std::unique_ptr<S3BlockCache> block_cache_;
+  uint64_t block_size_;
+  int64_t read_ahead_blocks_;
+  uint64_t upload_part_size_;
+};
+
+}  // namespace fs
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_PERSISTENCE_S3_S3_FILE_SYSTEM_H_
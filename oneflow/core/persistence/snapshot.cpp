@@ -15,6 +15,8 @@ limitations under the License.
 */
 #include "oneflow/core/persistence/snapshot.h"
 #include "oneflow/core/common/str_util.h"
+#include "oneflow/core/control/global_process_ctx.h"
+#include "oneflow/core/persistence/snapshot_container.h"
 #include "oneflow/core/persistence/persistent_in_stream.h"
 #include "oneflow/core/persistence/persistent_out_stream.h"
 #include "oneflow/core/register/tensor_slice_copier.h"
@@ -28,16 +30,118 @@ std::string GenDataFilePath(const std::string& root, const std::string& key) {
   return JoinPath(root, key);
 }
 
+const char kDeltaMagic[] = "OFSNPDLT";
+const size_t kDeltaMagicSize = sizeof(kDeltaMagic) - 1;
+
+template<typename T>
+void AppendPod(const T& value, std::string* out) {
+  out->append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<typename T>
+T ReadPod(const std::string& in, size_t* pos) {
+  CHECK_LE(*pos + sizeof(T), in.size()) << "truncated model snapshot delta";
+  T value;
+  std::memcpy(&value, in.data() + *pos, sizeof(T));
+  *pos += sizeof(T);
+  return value;
+}
+
 }  // namespace
 
+std::string SnapshotDeltaKey(const std::string& key) { return key + "-delta"; }
+
+void SerializeSnapshotDelta(const std::string& base_snapshot_path, const std::vector<int64_t>& rows,
+                            const char* data, int64_t row_size, std::string* delta) {
+  delta->assign(kDeltaMagic, kDeltaMagicSize);
+  AppendPod<uint64_t>(base_snapshot_path.size(), delta);
+  delta->append(base_snapshot_path);
+  AppendPod<int64_t>(row_size, delta);
+  AppendPod<uint64_t>(rows.size(), delta);
+  delta->reserve(delta->size() + rows.size() * (sizeof(int64_t) + row_size));
+  delta->append(reinterpret_cast<const char*>(rows.data()), rows.size() * sizeof(int64_t));
+  for (int64_t row : rows) { delta->append(data + row * row_size, row_size); }
+}
+
 SnapshotReader::SnapshotReader(const std::string& snapshot_root_path)
     : root_path_(snapshot_root_path) {}
 
-bool SnapshotReader::HasKey(const std::string& key) const {
+SnapshotReader::~SnapshotReader() = default;
+
+const SnapshotContainerReader* SnapshotReader::container_reader() const {
+  std::call_once(container_reader_once_flag_, [&]() {
+    container_reader_.reset(new SnapshotContainerReader(SnapshotFS(), root_path_));
+  });
+  return container_reader_.get();
+}
+
+bool SnapshotReader::HasEntry(const std::string& key) const {
+  if (container_reader()->Find(key) != nullptr) { return true; }
   const std::string path = GenDataFilePath(root_path_, key);
   return SnapshotFS()->FileExists(path);
 }
 
+void SnapshotReader::ReadEntry(const std::string& key, std::string* content) const {
+  const SnapshotContainerEntry* entry = container_reader()->Find(key);
+  if (entry != nullptr) {
+    content->resize(entry->size);
+    if (entry->size > 0) { container_reader()->ReadFully(*entry, &content->at(0)); }
+  } else {
+    const std::string path = GenDataFilePath(root_path_, key);
+    content->resize(SnapshotFS()->GetFileSize(path));
+    if (content->empty()) { return; }
+    PersistentInStream in_stream(SnapshotFS(), path);
+    in_stream.ReadFully(&content->at(0), content->size());
+  }
+}
+
+bool SnapshotReader::HasKey(const std::string& key) const {
+  return HasEntry(key) || HasEntry(SnapshotDeltaKey(key));
+}
+
+void SnapshotReader::ReadDelta(const std::string& key, const Shape& logical_blob_shape,
+                               DataType data_type, const TensorSliceView& slice,
+                               char* dst) const {
+  std::string delta;
+  ReadEntry(SnapshotDeltaKey(key), &delta);
+  CHECK_EQ(delta.compare(0, kDeltaMagicSize, kDeltaMagic, kDeltaMagicSize), 0)
+      << "not a model snapshot delta, key: " << key;
+  size_t pos = kDeltaMagicSize;
+  const uint64_t base_path_size = ReadPod<uint64_t>(delta, &pos);
+  CHECK_LE(pos + base_path_size, delta.size()) << "truncated model snapshot delta";
+  const std::string base_snapshot_path = delta.substr(pos, base_path_size);
+  pos += base_path_size;
+  const int64_t row_size = ReadPod<int64_t>(delta, &pos);
+  const uint64_t row_cnt = ReadPod<uint64_t>(delta, &pos);
+  CHECK_GT(logical_blob_shape.NumAxes(), 0);
+  CHECK_EQ(row_size, logical_blob_shape.Count(1) * GetSizeOfDataType(data_type))
+      << "unexpected model snapshot delta row size, key: " << key;
+  CHECK_EQ(delta.size(), pos + row_cnt * (sizeof(int64_t) + row_size))
+      << "unexpected model snapshot delta size, key: " << key;
+  const int64_t* rows = reinterpret_cast<const int64_t*>(delta.data() + pos);
+  const char* row_data = delta.data() + pos + row_cnt * sizeof(int64_t);
+  SnapshotReader(base_snapshot_path).Read(key, logical_blob_shape, data_type, slice, dst);
+  const int64_t slice_row_size = slice.shape().Count(1) * GetSizeOfDataType(data_type);
+  const bool full_rows = slice.shape().Count(1) == logical_blob_shape.Count(1);
+  const TensorSliceView logical_blob_slice(logical_blob_shape);
+  CpuDeviceCtx device_ctx;
+  std::unique_ptr<MemoryCopier> host_memory_copier(NewDefaultMemoryCopier(DeviceType::kCPU));
+  FOR_RANGE(uint64_t, k, 0, row_cnt) {
+    int64_t row = 0;
+    std::memcpy(&row, rows + k, sizeof(int64_t));
+    if (row < slice.At(0).begin() || row >= slice.At(0).end()) { continue; }
+    const char* src = row_data + k * row_size;
+    if (full_rows) {
+      std::memcpy(dst + (row - slice.At(0).begin()) * slice_row_size, src, row_size);
+    } else {
+      std::vector<Range> row_ranges = logical_blob_slice.range_vec();
+      row_ranges.at(0) = Range(row, row + 1);
+      TensorSliceCopier copier(slice, TensorSliceView(row_ranges), data_type);
+      copier.Copy(&device_ctx, *host_memory_copier, dst, src);
+    }
+  }
+}
+
 void SnapshotReader::Read(const std::string& key, Blob* blob) const {
   Shape shape;
   blob->shape().ToShape(&shape);
@@ -48,20 +152,53 @@ void SnapshotReader::Read(const std::string& key, const Shape& logical_blob_shap
                           DataType data_type, const TensorSliceView& slice, char* dst) const {
   const TensorSliceView logical_blob_slice(logical_blob_shape);
   CHECK(logical_blob_slice.Contains(slice));
-  const std::string path = GenDataFilePath(root_path_, key);
   const int64_t logical_blob_size = logical_blob_shape.elem_cnt() * GetSizeOfDataType(data_type);
-  CHECK_EQ(SnapshotFS()->GetFileSize(path), logical_blob_size)
-      << "unexpected model snapshot size, path: " << path;
+  if (!HasEntry(key) && HasEntry(SnapshotDeltaKey(key))) {
+    ReadDelta(key, logical_blob_shape, data_type, slice, dst);
+    return;
+  }
+  // reads [offset, offset + size) of the logical blob
+  std::function<void(int64_t, int64_t, char*)> ReadRange;
+  std::vector<char> decoded;
+  const SnapshotContainerEntry* entry = container_reader()->Find(key);
+  if (entry != nullptr) {
+    CHECK_EQ(entry->size, logical_blob_size) << "unexpected model snapshot size, key: " << key;
+    if (slice == logical_blob_slice) {
+      container_reader()->ReadFully(*entry, dst);
+      return;
+    } else if (entry->compression != kSnapshotContainerNoCompression) {
+      decoded.resize(logical_blob_size);
+      container_reader()->ReadFully(*entry, decoded.data());
+      ReadRange = [&](int64_t offset, int64_t size, char* range_dst) {
+        std::memcpy(range_dst, decoded.data() + offset, size);
+      };
+    } else {
+      ReadRange = [&](int64_t offset, int64_t size, char* range_dst) {
+        container_reader()->ReadRange(*entry, offset, size, range_dst);
+      };
+    }
+  } else {
+    const std::string path = GenDataFilePath(root_path_, key);
+    CHECK_EQ(SnapshotFS()->GetFileSize(path), logical_blob_size)
+        << "unexpected model snapshot size, path: " << path;
+    ReadRange = [&](int64_t offset, int64_t size, char* range_dst) {
+      PersistentInStream in_stream(SnapshotFS(), path, offset);
+      in_stream.ReadFully(range_dst, size);
+    };
+  }
   if (slice.shape().Count(1) == logical_blob_shape.Count(1)) {
-    PersistentInStream in_stream(
-        SnapshotFS(), path,
-        slice.At(0).begin() * slice.shape().Count(1) * GetSizeOfDataType(data_type));
-    in_stream.ReadFully(dst, slice.shape().elem_cnt() * GetSizeOfDataType(data_type));
+    ReadRange(slice.At(0).begin() * slice.shape().Count(1) * GetSizeOfDataType(data_type),
+              slice.shape().elem_cnt() * GetSizeOfDataType(data_type), dst);
   } else {
-    std::vector<char> buffer(logical_blob_size);
-    PersistentInStream in_stream(SnapshotFS(), path);
-    in_stream.ReadFully(buffer.data(), logical_blob_size);
-    TensorSliceCopier copier(slice, logical_blob_slice, data_type);
+    // reads only the rows covering the slice in one request instead of the whole blob
+    std::vector<Range> row_ranges = logical_blob_slice.range_vec();
+    row_ranges.at(0) = slice.At(0);
+    const TensorSliceView row_slice(row_ranges);
+    const int64_t row_size = logical_blob_shape.Count(1) * GetSizeOfDataType(data_type);
+    const int64_t row_slice_size = row_slice.shape().elem_cnt() * GetSizeOfDataType(data_type);
+    std::vector<char> buffer(row_slice_size);
+    ReadRange(slice.At(0).begin() * row_size, row_slice_size, buffer.data());
+    TensorSliceCopier copier(slice, row_slice, data_type);
     CpuDeviceCtx device_ctx;
     std::unique_ptr<MemoryCopier> host_memory_copier(NewDefaultMemoryCopier(DeviceType::kCPU));
     copier.Copy(&device_ctx, *host_memory_copier, dst, buffer.data());
@@ -88,9 +225,45 @@ SnapshotWriter::SnapshotWriter(const std::string& snapshot_root_path)
       SnapshotFS()->CreateDir(snapshot_root_path);
     }
   });
+  if (ParseBooleanFromEnv("ONEFLOW_SNAPSHOT_CONTAINER_FORMAT", false)) {
+    static std::atomic<int64_t> container_cnt(0);
+    const std::string name = "container-" + std::to_string(GlobalProcessCtx::Rank()) + "-"
+                             + std::to_string(container_cnt++);
+    const int64_t chunk_size =
+        ParseIntegerFromEnv("ONEFLOW_SNAPSHOT_CONTAINER_CHUNK_BYTES", int64_t(1) << 30);
+    const std::string compression =
+        GetStringFromEnv("ONEFLOW_SNAPSHOT_CONTAINER_COMPRESSION", "none");
+    CHECK(compression == "none" || compression == "lz4")
+        << "unsupported snapshot container compression: " << compression;
+    container_writer_.reset(new SnapshotContainerWriter(
+        SnapshotFS(), root_path_, name, chunk_size,
+        compression == "lz4" ? kSnapshotContainerLz4Compression
+                             : kSnapshotContainerNoCompression));
+  }
 }
 
+SnapshotWriter::~SnapshotWriter() = default;
+
 void SnapshotWriter::Write(const std::string& key, const char* data, size_t size) {
+  if (container_writer_) {
+    container_writer_->Write(key, data, size, DataType::kInvalidDataType, Shape());
+  } else {
+    WriteFile(key, data, size);
+  }
+}
+
+void SnapshotWriter::Write(const std::string& key, const Blob* blob) {
+  if (container_writer_) {
+    Shape shape;
+    blob->shape().ToShape(&shape);
+    container_writer_->Write(key, blob->dptr<char>(), blob->ByteSizeOfBlobBody(),
+                             blob->data_type(), shape);
+  } else {
+    WriteFile(key, blob);
+  }
+}
+
+void SnapshotWriter::WriteFile(const std::string& key, const char* data, size_t size) {
   const std::string path = GenDataFilePath(root_path_, key);
   const std::string dir_path = Dirname(path);
   SnapshotFS()->CreateDirIfNotExist(dir_path);
@@ -99,11 +272,16 @@ void SnapshotWriter::Write(const std::string& key, const char* data, size_t size
   out_stream.Write(data, size);
 }
 
-void SnapshotWriter::Write(const std::string& key, const Blob* blob) {
-  Write(key, blob->dptr<char>(), blob->ByteSizeOfBlobBody());
+void SnapshotWriter::WriteFile(const std::string& key, const Blob* blob) {
+  WriteFile(key, blob->dptr<char>(), blob->ByteSizeOfBlobBody());
+}
+
+void SnapshotWriter::Flush() {
+  if (container_writer_) { container_writer_->Flush(); }
 }
 
 void SnapshotWriter::Close() {
+  Flush();
   PersistentOutStream out_stream(SnapshotFS(), JoinPath(root_path_, "snapshot_done"));
 }
 
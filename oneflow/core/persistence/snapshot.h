@@ -23,13 +23,23 @@ limitations under the License.
 namespace oneflow {
 
 class Blob;
+class SnapshotContainerReader;
+class SnapshotContainerWriter;
+
+// A delta of a variable, stored under SnapshotDeltaKey(key) in place of the key itself, holds the
+// rows that changed since the snapshot at base_snapshot_path, which holds the key or another delta
+// of it. SnapshotReader resolves the chain transparently.
+std::string SnapshotDeltaKey(const std::string& key);
+// `data' is the whole variable, of which `rows' are taken
+void SerializeSnapshotDelta(const std::string& base_snapshot_path, const std::vector<int64_t>& rows,
+                            const char* data, int64_t row_size, std::string* delta);
 
 class SnapshotReader final {
  public:
   OF_DISALLOW_COPY_AND_MOVE(SnapshotReader);
   SnapshotReader() = delete;
   explicit SnapshotReader(const std::string& snapshot_root_path);
-  ~SnapshotReader() = default;
+  ~SnapshotReader();
 
   void Read(const std::string& key, const Shape& logical_blob_shape, DataType data_type,
             const TensorSliceView& slice, char* dst) const;
@@ -40,7 +50,16 @@ class SnapshotReader final {
   void Close();
 
  private:
+  // loads the container indexes on first use
+  const SnapshotContainerReader* container_reader() const;
+  bool HasEntry(const std::string& key) const;
+  void ReadEntry(const std::string& key, std::string* content) const;
+  void ReadDelta(const std::string& key, const Shape& logical_blob_shape, DataType data_type,
+                 const TensorSliceView& slice, char* dst) const;
+
   const std::string root_path_;
+  mutable std::once_flag container_reader_once_flag_;
+  mutable std::unique_ptr<SnapshotContainerReader> container_reader_;
 };
 
 class SnapshotWriter final {
@@ -48,14 +67,22 @@ class SnapshotWriter final {
   OF_DISALLOW_COPY_AND_MOVE(SnapshotWriter);
   SnapshotWriter() = delete;
   explicit SnapshotWriter(const std::string& snapshot_root_path);
-  ~SnapshotWriter() = default;
+  ~SnapshotWriter();
 
+  // Goes to a snapshot container if ONEFLOW_SNAPSHOT_CONTAINER_FORMAT is set, the entries of a
+  // container become visible after Flush or Close or the destruction of the writer. Thread safe.
   void Write(const std::string& key, const char* data, size_t size);
   void Write(const std::string& key, const Blob* blob);
+  // Always writes a file of its own, which is visible once the call returns
+  void WriteFile(const std::string& key, const char* data, size_t size);
+  void WriteFile(const std::string& key, const Blob* blob);
+  bool IsContainerFormat() const { return container_writer_ != nullptr; }
+  void Flush();
   void Close();
 
  private:
   const std::string root_path_;
+  std::unique_ptr<SnapshotContainerWriter> container_writer_;
 };
 
 }  // namespace oneflow
@@ -0,0 +1,284 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/persistence/snapshot_container.h"
+#include <array>
+#include "oneflow/core/common/str_util.h"
+#include "lz4.h"
+
+namespace oneflow {
+
+namespace {
+
+const char kIndexMagic[] = "OFSNPIDX";
+const size_t kIndexMagicSize = sizeof(kIndexMagic) - 1;
+const std::string kIndexFileSuffix = ".index";
+
+std::array<uint32_t, 256> MakeCrc32cTable() {
+  std::array<uint32_t, 256> table;
+  FOR_RANGE(uint32_t, i, 0, 256) {
+    uint32_t crc = i;
+    FOR_RANGE(int32_t, j, 0, 8) { crc = (crc & 1) ? (crc >> 1) ^ 0x82f63b78u : (crc >> 1); }
+    table[i] = crc;
+  }
+  return table;
+}
+
+void AppendUInt64(uint64_t value, std::string* out) {
+  FOR_RANGE(int32_t, i, 0, 8) { out->push_back(static_cast<char>((value >> (8 * i)) & 0xff)); }
+}
+
+void AppendString(const std::string& value, std::string* out) {
+  AppendUInt64(value.size(), out);
+  out->append(value);
+}
+
+class IndexParser final {
+ public:
+  explicit IndexParser(const std::string& index) : index_(index), pos_(0) {}
+
+  uint64_t ReadUInt64() {
+    CHECK_LE(pos_ + 8, index_.size()) << "truncated snapshot container index";
+    uint64_t value = 0;
+    FOR_RANGE(int32_t, i, 0, 8) {
+      value |= static_cast<uint64_t>(static_cast<uint8_t>(index_.at(pos_ + i))) << (8 * i);
+    }
+    pos_ += 8;
+    return value;
+  }
+
+  std::string ReadString() {
+    const uint64_t size = ReadUInt64();
+    CHECK_LE(pos_ + size, index_.size()) << "truncated snapshot container index";
+    std::string value = index_.substr(pos_, size);
+    pos_ += size;
+    return value;
+  }
+
+  std::string ReadBytes(size_t size) {
+    CHECK_LE(pos_ + size, index_.size()) << "truncated snapshot container index";
+    std::string value = index_.substr(pos_, size);
+    pos_ += size;
+    return value;
+  }
+
+  bool Done() const { return pos_ == index_.size(); }
+
+ private:
+  const std::string& index_;
+  size_t pos_;
+};
+
+void ReadFile(fs::FileSystem* fs, const std::string& path, std::string* content) {
+  const uint64_t size = fs->GetFileSize(path);
+  content->resize(size);
+  if (size == 0) { return; }
+  std::unique_ptr<fs::RandomAccessFile> file;
+  fs->NewRandomAccessFile(path, &file);
+  file->Read(0, size, &content->at(0));
+}
+
+}  // namespace
+
+uint32_t Crc32c(const char* data, size_t size) {
+  static const std::array<uint32_t, 256> table = MakeCrc32cTable();
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+  uint32_t crc = 0xffffffffu;
+  FOR_RANGE(size_t, i, 0, size) { crc = table[(crc ^ bytes[i]) & 0xff] ^ (crc >> 8); }
+  return crc ^ 0xffffffffu;
+}
+
+std::string SnapshotContainerIndexFileName(const std::string& name) {
+  return name + kIndexFileSuffix;
+}
+
+bool IsSnapshotContainerIndexFileName(const std::string& file_name) {
+  return file_name.size() > kIndexFileSuffix.size()
+         && file_name.compare(file_name.size() - kIndexFileSuffix.size(), kIndexFileSuffix.size(),
+                              kIndexFileSuffix)
+                == 0;
+}
+
+void SerializeSnapshotContainerIndex(const std::vector<SnapshotContainerEntry>& entries,
+                                     std::string* index) {
+  index->assign(kIndexMagic, kIndexMagicSize);
+  AppendUInt64(entries.size(), index);
+  for (const SnapshotContainerEntry& entry : entries) {
+    AppendString(entry.key, index);
+    AppendString(entry.chunk_name, index);
+    AppendUInt64(entry.offset, index);
+    AppendUInt64(entry.stored_size, index);
+    AppendUInt64(entry.size, index);
+    AppendUInt64(static_cast<uint64_t>(entry.data_type), index);
+    AppendUInt64(entry.shape.size(), index);
+    for (int64_t dim : entry.shape) { AppendUInt64(static_cast<uint64_t>(dim), index); }
+    AppendUInt64(entry.crc32c, index);
+    AppendUInt64(entry.compression, index);
+  }
+}
+
+void ParseSnapshotContainerIndex(const std::string& index,
+                                 std::vector<SnapshotContainerEntry>* entries) {
+  IndexParser parser(index);
+  CHECK_EQ(parser.ReadBytes(kIndexMagicSize), std::string(kIndexMagic, kIndexMagicSize))
+      << "not a snapshot container index";
+  const uint64_t entry_cnt = parser.ReadUInt64();
+  entries->resize(entry_cnt);
+  for (SnapshotContainerEntry& entry : *entries) {
+    entry.key = parser.ReadString();
+    entry.chunk_name = parser.ReadString();
+    entry.offset = parser.ReadUInt64();
+    entry.stored_size = parser.ReadUInt64();
+    entry.size = parser.ReadUInt64();
+    entry.data_type = static_cast<DataType>(parser.ReadUInt64());
+    entry.shape.resize(parser.ReadUInt64());
+    for (int64_t& dim : entry.shape) { dim = static_cast<int64_t>(parser.ReadUInt64()); }
+    entry.crc32c = static_cast<uint32_t>(parser.ReadUInt64());
+    entry.compression = static_cast<SnapshotContainerCompression>(parser.ReadUInt64());
+  }
+  CHECK(parser.Done()) << "trailing bytes in snapshot container index";
+}
+
+SnapshotContainerWriter::SnapshotContainerWriter(fs::FileSystem* fs, const std::string& root_path,
+                                                 const std::string& name, uint64_t chunk_size,
+                                                 SnapshotContainerCompression compression)
+    : fs_(fs),
+      root_path_(root_path),
+      name_(name),
+      chunk_size_(chunk_size),
+      compression_(compression),
+      chunk_offset_(0),
+      chunk_cnt_(0),
+      flushed_(true) {}
+
+SnapshotContainerWriter::~SnapshotContainerWriter() { Flush(); }
+
+void SnapshotContainerWriter::Write(const std::string& key, const char* data, size_t size,
+                                    DataType data_type, const Shape& shape) {
+  SnapshotContainerEntry entry;
+  entry.key = key;
+  entry.size = size;
+  entry.data_type = data_type;
+  entry.shape.assign(shape.dim_vec().begin(), shape.dim_vec().end());
+  entry.crc32c = Crc32c(data, size);
+  entry.compression = kSnapshotContainerNoCompression;
+  // compresses outside the lock so that concurrent writers overlap
+  std::vector<char> compressed;
+  if (compression_ == kSnapshotContainerLz4Compression && size > 0 && size <= LZ4_MAX_INPUT_SIZE) {
+    const int bound = LZ4_compressBound(size);
+    compressed.resize(bound);
+    const int compressed_size = LZ4_compress_default(data, compressed.data(), size, bound);
+    if (compressed_size > 0 && static_cast<size_t>(compressed_size) < size) {
+      compressed.resize(compressed_size);
+      entry.compression = kSnapshotContainerLz4Compression;
+    }
+  }
+  const char* stored_data =
+      entry.compression == kSnapshotContainerNoCompression ? data : compressed.data();
+  entry.stored_size =
+      entry.compression == kSnapshotContainerNoCompression ? size : compressed.size();
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (chunk_file_ && chunk_offset_ > 0 && chunk_offset_ + entry.stored_size > chunk_size_) {
+    chunk_file_->Close();
+    chunk_file_.reset();
+  }
+  if (!chunk_file_) {
+    chunk_name_ = name_ + "-" + std::to_string(chunk_cnt_) + ".chunk";
+    chunk_cnt_ += 1;
+    chunk_offset_ = 0;
+    fs_->NewWritableFile(JoinPath(root_path_, chunk_name_), &chunk_file_);
+  }
+  entry.chunk_name = chunk_name_;
+  entry.offset = chunk_offset_;
+  chunk_file_->Append(stored_data, entry.stored_size);
+  chunk_offset_ += entry.stored_size;
+  entries_.push_back(entry);
+  flushed_ = false;
+}
+
+void SnapshotContainerWriter::Flush() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (flushed_) { return; }
+  if (chunk_file_) {
+    chunk_file_->Close();
+    chunk_file_.reset();
+  }
+  std::string index;
+  SerializeSnapshotContainerIndex(entries_, &index);
+  const std::string index_path = JoinPath(root_path_, SnapshotContainerIndexFileName(name_));
+  const std::string tmp_index_path = index_path + ".writing";
+  {
+    std::unique_ptr<fs::WritableFile> index_file;
+    fs_->NewWritableFile(tmp_index_path, &index_file);
+    index_file->Append(index.data(), index.size());
+    index_file->Close();
+  }
+  if (fs_->FileExists(index_path)) { fs_->DelFile(index_path); }
+  fs_->RenameFile(tmp_index_path, index_path);
+  flushed_ = true;
+}
+
+SnapshotContainerReader::SnapshotContainerReader(fs::FileSystem* fs, const std::string& root_path)
+    : fs_(fs), root_path_(root_path) {
+  if (!fs_->IsDirectory(root_path_)) { return; }
+  for (const std::string& file_name : fs_->ListDir(root_path_)) {
+    if (!IsSnapshotContainerIndexFileName(file_name)) { continue; }
+    std::string index;
+    ReadFile(fs_, JoinPath(root_path_, file_name), &index);
+    std::vector<SnapshotContainerEntry> entries;
+    ParseSnapshotContainerIndex(index, &entries);
+    for (SnapshotContainerEntry& entry : entries) {
+      const std::string key = entry.key;
+      CHECK(key2entry_.emplace(key, std::move(entry)).second)
+          << "duplicated key in snapshot containers, key: " << key;
+    }
+  }
+}
+
+const SnapshotContainerEntry* SnapshotContainerReader::Find(const std::string& key) const {
+  const auto it = key2entry_.find(key);
+  if (it == key2entry_.end()) { return nullptr; }
+  return &it->second;
+}
+
+void SnapshotContainerReader::ReadFully(const SnapshotContainerEntry& entry, char* dst) const {
+  std::unique_ptr<fs::RandomAccessFile> file;
+  fs_->NewRandomAccessFile(JoinPath(root_path_, entry.chunk_name), &file);
+  if (entry.compression == kSnapshotContainerNoCompression) {
+    CHECK_EQ(entry.stored_size, entry.size);
+    if (entry.size > 0) { file->Read(entry.offset, entry.size, dst); }
+  } else {
+    CHECK_EQ(entry.compression, kSnapshotContainerLz4Compression);
+    std::vector<char> compressed(entry.stored_size);
+    file->Read(entry.offset, entry.stored_size, compressed.data());
+    CHECK_EQ(LZ4_decompress_safe(compressed.data(), dst, entry.stored_size, entry.size),
+             static_cast<int>(entry.size))
+        << "corrupted snapshot container entry, key: " << entry.key;
+  }
+  CHECK_EQ(Crc32c(dst, entry.size), entry.crc32c)
+      << "checksum mismatch of snapshot container entry, key: " << entry.key;
+}
+
+void SnapshotContainerReader::ReadRange(const SnapshotContainerEntry& entry, uint64_t offset,
+                                        size_t size, char* dst) const {
+  CHECK_EQ(entry.compression, kSnapshotContainerNoCompression);
+  CHECK_LE(offset + size, entry.size);
+  if (size == 0) { return; }
+  std::unique_ptr<fs::RandomAccessFile> file;
+  fs_->NewRandomAccessFile(JoinPath(root_path_, entry.chunk_name), &file);
+  file->Read(entry.offset + offset, size, dst);
+}
+
+}  // namespace oneflow
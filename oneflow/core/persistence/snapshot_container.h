@@ -0,0 +1,110 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_PERSISTENCE_SNAPSHOT_CONTAINER_H_
+#define ONEFLOW_CORE_PERSISTENCE_SNAPSHOT_CONTAINER_H_
+
+#include "oneflow/core/common/util.h"
+#include "oneflow/core/common/shape.h"
+#include "oneflow/core/persistence/file_system.h"
+
+namespace oneflow {
+
+// A snapshot container packs the entries written by one writer into large chunk files named
+// "{name}-{seq}.chunk", and lists them in the index file "{name}.index":
+//   magic "OFSNPIDX", uint64 entry count, then for each entry
+//   key, chunk file name, offset, stored size, size, data type, shape, crc32c and compression.
+// Strings are a uint64 length followed by the bytes, numbers are little endian. The crc32c is
+// computed on the uncompressed bytes.
+
+enum SnapshotContainerCompression : uint8_t {
+  kSnapshotContainerNoCompression = 0,
+  kSnapshotContainerLz4Compression = 1,
+};
+
+struct SnapshotContainerEntry {
+  std::string key;
+  std::string chunk_name;
+  uint64_t offset;
+  uint64_t stored_size;
+  uint64_t size;
+  DataType data_type;
+  std::vector<int64_t> shape;
+  uint32_t crc32c;
+  SnapshotContainerCompression compression;
+};
+
+uint32_t Crc32c(const char* data, size_t size);
+
+std::string SnapshotContainerIndexFileName(const std::string& name);
+bool IsSnapshotContainerIndexFileName(const std::string& file_name);
+void SerializeSnapshotContainerIndex(const std::vector<SnapshotContainerEntry>& entries,
+                                     std::string* index);
+void ParseSnapshotContainerIndex(const std::string& index,
+                                 std::vector<SnapshotContainerEntry>* entries);
+
+class SnapshotContainerWriter final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(SnapshotContainerWriter);
+  SnapshotContainerWriter(fs::FileSystem* fs, const std::string& root_path, const std::string& name,
+                          uint64_t chunk_size, SnapshotContainerCompression compression);
+  ~SnapshotContainerWriter();
+
+  // Thread safe
+  void Write(const std::string& key, const char* data, size_t size, DataType data_type,
+             const Shape& shape);
+  // Closes the current chunk file and rewrites the index, after which all the entries written
+  // are visible to readers. The index is replaced atomically.
+  void Flush();
+
+ private:
+  fs::FileSystem* fs_;
+  std::string root_path_;
+  std::string name_;
+  uint64_t chunk_size_;
+  SnapshotContainerCompression compression_;
+  std::mutex mutex_;
+  std::unique_ptr<fs::WritableFile> chunk_file_;
+  std::string chunk_name_;
+  uint64_t chunk_offset_;
+  int64_t chunk_cnt_;
+  std::vector<SnapshotContainerEntry> entries_;
+  bool flushed_;
+};
+
+class SnapshotContainerReader final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(SnapshotContainerReader);
+  // Loads all the container indexes under root_path
+  SnapshotContainerReader(fs::FileSystem* fs, const std::string& root_path);
+  ~SnapshotContainerReader() = default;
+
+  // Returns nullptr if the key is not in any container
+  const SnapshotContainerEntry* Find(const std::string& key) const;
+  // Reads and decompresses the whole entry and checks its crc32c
+  void ReadFully(const SnapshotContainerEntry& entry, char* dst) const;
+  // Reads [offset, offset + size) of an uncompressed entry without checking the crc32c
+  void ReadRange(const SnapshotContainerEntry& entry, uint64_t offset, size_t size,
+                 char* dst) const;
+
+ private:
+  fs::FileSystem* fs_;
+  std::string root_path_;
+  HashMap<std::string, SnapshotContainerEntry> key2entry_;
+};
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_PERSISTENCE_SNAPSHOT_CONTAINER_H_
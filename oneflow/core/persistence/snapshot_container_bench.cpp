@@ -0,0 +1,69 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <benchmark/benchmark.h>
+#include "oneflow/core/common/process_state.h"
+#include "oneflow/core/common/str_util.h"
+#include "oneflow/core/persistence/snapshot_container.h"
+
+namespace oneflow {
+
+namespace {
+
+// reads back `num_entries' entries of `entry_size' bytes that were written once before timing
+void BM_SnapshotContainerRead(benchmark::State& state) {
+  const int64_t entry_size = state.range(0);
+  const int64_t num_entries = state.range(1);
+  const auto compression = static_cast<SnapshotContainerCompression>(state.range(2));
+  fs::FileSystem* file_system = LocalFS();
+  std::string current_dir = GetCwd();
+  StringReplace(&current_dir, '\\', '/');
+  const std::string root_path = JoinPath(current_dir, "/tmp_bench_snapshot_container_dir");
+  if (file_system->IsDirectory(root_path)) { file_system->RecursivelyDeleteDir(root_path); }
+  file_system->CreateDir(root_path);
+  std::string content(entry_size, 0);
+  uint32_t seed = 1;
+  for (char& c : content) {
+    seed = seed * 1103515245u + 12345u;
+    c = static_cast<char>(seed >> 28);
+  }
+  {
+    SnapshotContainerWriter writer(file_system, root_path, "bench", 64 << 20, compression);
+    for (int64_t i = 0; i < num_entries; ++i) {
+      writer.Write("var_" + std::to_string(i) + "/out", content.data(), content.size(),
+                   DataType::kInt8, Shape({entry_size}));
+    }
+  }
+  std::string buffer(entry_size, 0);
+  for (auto _ : state) {
+    SnapshotContainerReader reader(file_system, root_path);
+    for (int64_t i = 0; i < num_entries; ++i) {
+      const SnapshotContainerEntry* entry = reader.Find("var_" + std::to_string(i) + "/out");
+      reader.ReadFully(*entry, &buffer.at(0));
+    }
+    benchmark::DoNotOptimize(buffer.data());
+  }
+  state.SetBytesProcessed(state.iterations() * entry_size * num_entries);
+  file_system->RecursivelyDeleteDir(root_path);
+}
+BENCHMARK(BM_SnapshotContainerRead)
+    ->Args({4 << 10, 1024, kSnapshotContainerNoCompression})
+    ->Args({4 << 20, 16, kSnapshotContainerNoCompression})
+    ->Args({4 << 20, 16, kSnapshotContainerLz4Compression})
+    ->UseRealTime();
+
+}  // namespace
+
+}  // namespace oneflow
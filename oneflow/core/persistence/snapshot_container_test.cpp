@@ -0,0 +1,116 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <gtest/gtest.h>
+#include "oneflow/core/common/process_state.h"
+#include "oneflow/core/common/str_util.h"
+#include "oneflow/core/persistence/snapshot_container.h"
+
+namespace oneflow {
+
+namespace {
+
+void TestWriteAndRead(SnapshotContainerCompression compression) {
+  fs::FileSystem* file_system = LocalFS();
+  std::string current_dir = GetCwd();
+  StringReplace(&current_dir, '\\', '/');
+  const std::string root_path = JoinPath(current_dir, "/tmp_test_snapshot_container_dir");
+  if (file_system->IsDirectory(root_path)) { file_system->RecursivelyDeleteDir(root_path); }
+  file_system->CreateDir(root_path);
+  const std::string compressible(4096, 'a');
+  std::string incompressible(1000, 0);
+  uint32_t state = 1;
+  for (char& c : incompressible) {
+    state = state * 1103515245u + 12345u;
+    c = static_cast<char>(state >> 24);
+  }
+  {
+    SnapshotContainerWriter writer(file_system, root_path, "test", 1 << 20, compression);
+    writer.Write("a/out", compressible.data(), compressible.size(), DataType::kFloat,
+                 Shape({32, 32}));
+    // the entries after a flush go to a new chunk
+    writer.Flush();
+    writer.Write("b/out", incompressible.data(), incompressible.size(), DataType::kInt8,
+                 Shape({1000}));
+    writer.Write("c/out", "", 0, DataType::kFloat, Shape({0}));
+  }
+  SnapshotContainerReader reader(file_system, root_path);
+  ASSERT_TRUE(reader.Find("d/out") == nullptr);
+  const SnapshotContainerEntry* a = reader.Find("a/out");
+  const SnapshotContainerEntry* b = reader.Find("b/out");
+  ASSERT_TRUE(a != nullptr);
+  ASSERT_TRUE(b != nullptr);
+  ASSERT_TRUE(reader.Find("c/out") != nullptr);
+  ASSERT_EQ(a->data_type, DataType::kFloat);
+  ASSERT_EQ(a->shape, std::vector<int64_t>({32, 32}));
+  ASSERT_NE(a->chunk_name, b->chunk_name);
+  ASSERT_EQ(b->compression, kSnapshotContainerNoCompression);
+  std::string a_content(a->size, 0);
+  reader.ReadFully(*a, &a_content.at(0));
+  ASSERT_EQ(a_content, compressible);
+  if (compression == kSnapshotContainerLz4Compression) {
+    ASSERT_EQ(a->compression, kSnapshotContainerLz4Compression);
+    ASSERT_LT(a->stored_size, a->size);
+  }
+  std::string b_range(100, 0);
+  reader.ReadRange(*b, 300, 100, &b_range.at(0));
+  ASSERT_EQ(b_range, incompressible.substr(300, 100));
+  file_system->RecursivelyDeleteDir(root_path);
+}
+
+}  // namespace
+
+TEST(SnapshotContainer, crc32c) {
+  // the check value of CRC-32C
+  ASSERT_EQ(Crc32c("123456789", 9), 0xe3069283u);
+  ASSERT_EQ(Crc32c("", 0), 0u);
+}
+
+TEST(SnapshotContainer, index) {
+  SnapshotContainerEntry entry;
+  entry.key = "var/out";
+  entry.chunk_name = "container-0-0-0.chunk";
+  entry.offset = 1024;
+  entry.stored_size = 100;
+  entry.size = 400;
+  entry.data_type = DataType::kFloat;
+  entry.shape = {10, 10};
+  entry.crc32c = 0xdeadbeefu;
+  entry.compression = kSnapshotContainerLz4Compression;
+  std::string index;
+  SerializeSnapshotContainerIndex({entry}, &index);
+  std::vector<SnapshotContainerEntry> entries;
+  ParseSnapshotContainerIndex(index, &entries);
+  ASSERT_EQ(entries.size(), 1);
+  ASSERT_EQ(entries.at(0).key, entry.key);
+  ASSERT_EQ(entries.at(0).chunk_name, entry.chunk_name);
+  ASSERT_EQ(entries.at(0).offset, entry.offset);
+  ASSERT_EQ(entries.at(0).stored_size, entry.stored_size);
+  ASSERT_EQ(entries.at(0).size, entry.size);
+  ASSERT_EQ(entries.at(0).data_type, entry.data_type);
+  ASSERT_EQ(entries.at(0).shape, entry.shape);
+  ASSERT_EQ(entries.at(0).crc32c, entry.crc32c);
+  ASSERT_EQ(entries.at(0).compression, entry.compression);
+  ASSERT_TRUE(IsSnapshotContainerIndexFileName("container-0-0.index"));
+  ASSERT_FALSE(IsSnapshotContainerIndexFileName("container-0-0.index.writing"));
+}
+
+TEST(SnapshotContainer, write_and_read) { TestWriteAndRead(kSnapshotContainerNoCompression); }
+
+TEST(SnapshotContainer, write_and_read_lz4) {
+  TestWriteAndRead(kSnapshotContainerLz4Compression);
+}
+
+}  // namespace oneflow
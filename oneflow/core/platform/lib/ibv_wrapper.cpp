@@ -117,6 +117,14 @@ int ibv_query_device(struct ibv_context* context, struct ibv_device_attr* device
   return LoadSymbol(__func__, &wrapper.ibv_query_device)(context, device_attr);
 }
 
+struct ibv_srq* ibv_create_srq(struct ibv_pd* pd, struct ibv_srq_init_attr* srq_init_attr) {
+  return LoadSymbol(__func__, &wrapper.ibv_create_srq)(pd, srq_init_attr);
+}
+
+int ibv_destroy_srq(struct ibv_srq* srq) {
+  return LoadSymbol(__func__, &wrapper.ibv_destroy_srq)(srq);
+}
+
 }  // namespace _stubs
 
 IBV wrapper = {
@@ -0,0 +1,178 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <array>
+#include <chrono>
+#include <mutex>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "oneflow/core/profiler/host_stage_timing.h"
+
+namespace oneflow {
+
+namespace profiler {
+
+namespace detail {
+
+std::atomic<bool> host_stage_timing_enabled(
+    ParseBooleanFromEnv("ONEFLOW_PROFILER_HOST_STAGE_TIMING", false));
+
+}  // namespace detail
+
+namespace {
+
+inline uint64_t ReadCycles() {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+}
+
+uint64_t NowNanoseconds() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// written by the owner thread only, read by GetHostStageTimingTable
+struct ThreadStageCounters final {
+  std::array<std::atomic<uint64_t>, kHostStageNum> call_cnt;
+  std::array<std::atomic<uint64_t>, kHostStageNum> total_cycles;
+  std::array<std::atomic<uint64_t>, kHostStageNum> self_cycles;
+
+  ThreadStageCounters() { Reset(); }
+
+  void Reset() {
+    for (int i = 0; i < kHostStageNum; ++i) {
+      call_cnt.at(i).store(0, std::memory_order_relaxed);
+      total_cycles.at(i).store(0, std::memory_order_relaxed);
+      self_cycles.at(i).store(0, std::memory_order_relaxed);
+    }
+  }
+};
+
+inline void Accumulate(std::atomic<uint64_t>* counter, uint64_t val) {
+  counter->store(counter->load(std::memory_order_relaxed) + val, std::memory_order_relaxed);
+}
+
+struct HostStageTimingCollector final {
+  std::mutex mutex;
+  // counters outlive their threads, so the calls of finished threads are reported too
+  std::vector<std::shared_ptr<ThreadStageCounters>> thread_counters;
+  // cycle counter and wall clock at the last reset, used to convert cycles to time
+  uint64_t reset_cycles = ReadCycles();
+  uint64_t reset_ns = NowNanoseconds();
+};
+
+HostStageTimingCollector* MutHostStageTimingCollector() {
+  static HostStageTimingCollector* collector = new HostStageTimingCollector();
+  return collector;
+}
+
+ThreadStageCounters* ThisThreadStageCounters() {
+  thread_local std::shared_ptr<ThreadStageCounters> counters = []() {
+    auto ptr = std::make_shared<ThreadStageCounters>();
+    HostStageTimingCollector* collector = MutHostStageTimingCollector();
+    std::unique_lock<std::mutex> lock(collector->mutex);
+    collector->thread_counters.push_back(ptr);
+    return ptr;
+  }();
+  return counters.get();
+}
+
+thread_local HostStageTimingGuard* current_guard = nullptr;
+
+const char* HostStageName(int stage) {
+  switch (stage) {
+    case kHostStagePythonBinding: return "python_binding";
+    case kHostStageFunctor: return "functor";
+    case kHostStageDispatch: return "dispatch";
+    case kHostStageInfer: return "infer";
+    case kHostStageInstructionsBuilder: return "instructions_builder";
+    case kHostStageVmSchedule: return "vm_schedule";
+    default: return "unknown";
+  }
+}
+
+}  // namespace
+
+void EnableHostStageTiming() { detail::host_stage_timing_enabled.store(true); }
+
+void DisableHostStageTiming() { detail::host_stage_timing_enabled.store(false); }
+
+std::vector<HostStageTimingRow> GetHostStageTimingTable() {
+  std::array<uint64_t, kHostStageNum> call_cnt{};
+  std::array<uint64_t, kHostStageNum> total_cycles{};
+  std::array<uint64_t, kHostStageNum> self_cycles{};
+  double cycles_per_us = 0;
+  {
+    HostStageTimingCollector* collector = MutHostStageTimingCollector();
+    std::unique_lock<std::mutex> lock(collector->mutex);
+    for (const auto& counters : collector->thread_counters) {
+      for (int i = 0; i < kHostStageNum; ++i) {
+        call_cnt.at(i) += counters->call_cnt.at(i).load(std::memory_order_relaxed);
+        total_cycles.at(i) += counters->total_cycles.at(i).load(std::memory_order_relaxed);
+        self_cycles.at(i) += counters->self_cycles.at(i).load(std::memory_order_relaxed);
+      }
+    }
+    const uint64_t elapsed_ns = NowNanoseconds() - collector->reset_ns;
+    const uint64_t elapsed_cycles = ReadCycles() - collector->reset_cycles;
+    cycles_per_us = elapsed_ns > 0 ? elapsed_cycles * 1e3 / elapsed_ns : 1e3;
+  }
+  std::vector<HostStageTimingRow> table;
+  for (int i = 0; i < kHostStageNum; ++i) {
+    HostStageTimingRow row;
+    row.stage = HostStageName(i);
+    row.call_cnt = call_cnt.at(i);
+    row.total_us = total_cycles.at(i) / cycles_per_us;
+    row.self_us = self_cycles.at(i) / cycles_per_us;
+    row.mean_us = row.call_cnt > 0 ? row.total_us / row.call_cnt : 0;
+    table.push_back(row);
+  }
+  return table;
+}
+
+void ResetHostStageTiming() {
+  HostStageTimingCollector* collector = MutHostStageTimingCollector();
+  std::unique_lock<std::mutex> lock(collector->mutex);
+  for (const auto& counters : collector->thread_counters) { counters->Reset(); }
+  collector->reset_cycles = ReadCycles();
+  collector->reset_ns = NowNanoseconds();
+}
+
+void HostStageTimingGuard::Start() {
+  active_ = true;
+  nested_cycles_ = 0;
+  parent_ = current_guard;
+  current_guard = this;
+  start_cycles_ = ReadCycles();
+}
+
+void HostStageTimingGuard::Finish() {
+  const uint64_t elapsed = ReadCycles() - start_cycles_;
+  active_ = false;
+  current_guard = parent_;
+  if (parent_ != nullptr) { parent_->nested_cycles_ += elapsed; }
+  ThreadStageCounters* counters = ThisThreadStageCounters();
+  Accumulate(&counters->call_cnt.at(stage_), 1);
+  Accumulate(&counters->total_cycles.at(stage_), elapsed);
+  Accumulate(&counters->self_cycles.at(stage_), elapsed - std::min(elapsed, nested_cycles_));
+}
+
+}  // namespace profiler
+
+}  // namespace oneflow
@@ -0,0 +1,100 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_PROFILER_HOST_STAGE_TIMING_H_
+#define ONEFLOW_CORE_PROFILER_HOST_STAGE_TIMING_H_
+
+#include <atomic>
+#include "oneflow/core/common/util.h"
+
+namespace oneflow {
+
+namespace profiler {
+
+// Optional breakdown of the host time spent per eager op. Enabled by EnableHostStageTiming or the
+// environment variable ONEFLOW_PROFILER_HOST_STAGE_TIMING. Each thread accumulates cycle counts
+// of the stages below into its own counters, so an enabled guard costs two cycle counter reads
+// and a disabled one a relaxed load.
+enum HostStage {
+  kHostStagePythonBinding = 0,  // argument parsing and result conversion in api/python/functional
+  kHostStageFunctor,            // functional functors
+  kHostStageDispatch,           // OpInterpUtil::Dispatch, autograd and interpreters
+  kHostStageInfer,              // device, shape and dtype inference, including infer caches
+  kHostStageInstructionsBuilder,  // building and submitting vm instructions
+  kHostStageVmSchedule,           // VirtualMachine::Schedule calls that had work to do
+  kHostStageNum,
+};
+
+struct HostStageTimingRow {
+  std::string stage;
+  int64_t call_cnt;
+  // including the nested stages
+  double total_us;
+  // excluding the nested stages
+  double self_us;
+  double mean_us;
+};
+
+void EnableHostStageTiming();
+void DisableHostStageTiming();
+
+namespace detail {
+
+extern std::atomic<bool> host_stage_timing_enabled;
+
+}  // namespace detail
+
+inline bool IsHostStageTimingEnabled() {
+  return detail::host_stage_timing_enabled.load(std::memory_order_relaxed);
+}
+
+// Sums the counters of all threads since the last reset, in HostStage order.
+std::vector<HostStageTimingRow> GetHostStageTimingTable();
+void ResetHostStageTiming();
+
+class HostStageTimingGuard final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(HostStageTimingGuard);
+  explicit HostStageTimingGuard(HostStage stage) : HostStageTimingGuard(stage, true) {}
+  HostStageTimingGuard(HostStage stage, bool cond) : stage_(stage), active_(false) {
+    if (cond && IsHostStageTimingEnabled()) { Start(); }
+  }
+  ~HostStageTimingGuard() { Stop(); }
+
+  // ends the stage before the end of the scope
+  void Stop() {
+    if (active_) { Finish(); }
+  }
+
+ private:
+  void Start();
+  void Finish();
+
+  HostStage stage_;
+  bool active_;
+  uint64_t start_cycles_;
+  uint64_t nested_cycles_;
+  HostStageTimingGuard* parent_;
+};
+
+}  // namespace profiler
+
+}  // namespace oneflow
+
+#define OF_HOST_STAGE_TIMING_GUARD(stage)                                 \
+  ::oneflow::profiler::HostStageTimingGuard OF_PP_CAT(host_stage_guard_, \
+                                                      __LINE__)(::oneflow::profiler::stage)
+
+#endif  // ONEFLOW_CORE_PROFILER_HOST_STAGE_TIMING_H_
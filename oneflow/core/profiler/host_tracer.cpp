@@ -0,0 +1,204 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/profiler/host_tracer.h"
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <fstream>
+#include <json.hpp>
+
+namespace oneflow {
+
+namespace profiler {
+
+namespace {
+
+struct TraceRecord {
+  int32_t name_id;
+  int64_t begin_ns;
+  int64_t end_ns;
+};
+
+// Written by the owner thread only. Readers check `write_cnt' again after copying the records,
+// and drop the ones that may have been overwritten meanwhile.
+struct ThreadTraceBuffer final {
+  ThreadTraceBuffer(int64_t capacity, int64_t thread_id)
+      : records(capacity), write_cnt(0), cleared_cnt(0), tid(thread_id) {}
+
+  std::vector<TraceRecord> records;
+  std::atomic<int64_t> write_cnt;
+  // records before it are cleared
+  std::atomic<int64_t> cleared_cnt;
+  const int64_t tid;
+  std::string thread_name;
+  // owner only, (name id, begin ns) of the ranges not popped yet
+  std::vector<std::pair<int32_t, int64_t>> open_ranges;
+};
+
+struct HostTraceRegistry final {
+  std::mutex mutex;
+  std::vector<std::shared_ptr<ThreadTraceBuffer>> thread_trace_buffers;
+  HashMap<std::string, int32_t> name2id;
+  std::vector<std::string> names;
+};
+
+std::atomic<bool> host_tracing_enabled(false);
+
+thread_local std::shared_ptr<ThreadTraceBuffer> thread_trace_buffer;
+
+HostTraceRegistry* MutHostTraceRegistry() {
+  // never destructed, threads may exit after the static objects are destructed
+  static HostTraceRegistry* registry = new HostTraceRegistry();
+  return registry;
+}
+
+ThreadTraceBuffer* MutThreadTraceBuffer() {
+  if (!thread_trace_buffer) {
+    static const int64_t capacity =
+        std::max<int64_t>(ParseIntegerFromEnv("ONEFLOW_PROFILER_HOST_TRACE_BUFFER_SIZE", 65536), 1);
+    thread_trace_buffer.reset(new ThreadTraceBuffer(capacity, syscall(SYS_gettid)));
+    HostTraceRegistry* registry = MutHostTraceRegistry();
+    std::unique_lock<std::mutex> lock(registry->mutex);
+    registry->thread_trace_buffers.push_back(thread_trace_buffer);
+  }
+  return thread_trace_buffer.get();
+}
+
+int32_t InternName(const std::string& name) {
+  static thread_local HashMap<std::string, int32_t> name2id_cache;
+  const auto& cache_it = name2id_cache.find(name);
+  if (cache_it != name2id_cache.end()) { return cache_it->second; }
+  HostTraceRegistry* registry = MutHostTraceRegistry();
+  int32_t name_id = -1;
+  {
+    std::unique_lock<std::mutex> lock(registry->mutex);
+    const auto& it = registry->name2id.find(name);
+    if (it != registry->name2id.end()) {
+      name_id = it->second;
+    } else {
+      name_id = registry->names.size();
+      registry->names.push_back(name);
+      registry->name2id.emplace(name, name_id);
+    }
+  }
+  name2id_cache.emplace(name, name_id);
+  return name_id;
+}
+
+int64_t NowNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void CopyRecords(ThreadTraceBuffer* buffer, std::vector<TraceRecord>* records) {
+  const int64_t capacity = buffer->records.size();
+  const int64_t end = buffer->write_cnt.load(std::memory_order_acquire);
+  int64_t begin = std::max(end - capacity, buffer->cleared_cnt.load());
+  std::vector<TraceRecord> copied;
+  for (int64_t i = begin; i < end; ++i) { copied.push_back(buffer->records.at(i % capacity)); }
+  // the owner thread may have overwritten the oldest records while copying them
+  const int64_t valid_begin = buffer->write_cnt.load(std::memory_order_acquire) - capacity;
+  for (int64_t i = std::max(begin, valid_begin); i < end; ++i) {
+    records->push_back(copied.at(i - begin));
+  }
+}
+
+}  // namespace
+
+void EnableHostTracing() { host_tracing_enabled.store(true); }
+
+void DisableHostTracing() { host_tracing_enabled.store(false); }
+
+bool IsHostTracingEnabled() { return host_tracing_enabled.load(std::memory_order_relaxed); }
+
+void HostTracingRangePush(const std::string& name) {
+  if (!IsHostTracingEnabled()) { return; }
+  MutThreadTraceBuffer()->open_ranges.emplace_back(InternName(name), NowNs());
+}
+
+void HostTracingRangePop() {
+  // ranges pushed before tracing was disabled are still popped
+  ThreadTraceBuffer* buffer = thread_trace_buffer.get();
+  if (buffer == nullptr || buffer->open_ranges.empty()) { return; }
+  const auto& open_range = buffer->open_ranges.back();
+  const int64_t write_cnt = buffer->write_cnt.load(std::memory_order_relaxed);
+  TraceRecord* record = &buffer->records.at(write_cnt % buffer->records.size());
+  record->name_id = open_range.first;
+  record->begin_ns = open_range.second;
+  record->end_ns = NowNs();
+  buffer->open_ranges.pop_back();
+  buffer->write_cnt.store(write_cnt + 1, std::memory_order_release);
+}
+
+void HostTracingNameThisThread(const std::string& name) {
+  ThreadTraceBuffer* buffer = MutThreadTraceBuffer();
+  std::unique_lock<std::mutex> lock(MutHostTraceRegistry()->mutex);
+  buffer->thread_name = name;
+}
+
+void DumpHostTrace(const std::string& path) {
+  HostTraceRegistry* registry = MutHostTraceRegistry();
+  std::vector<std::shared_ptr<ThreadTraceBuffer>> buffers;
+  std::vector<std::string> names;
+  {
+    std::unique_lock<std::mutex> lock(registry->mutex);
+    buffers = registry->thread_trace_buffers;
+    names = registry->names;
+  }
+  const int64_t pid = getpid();
+  nlohmann::json trace_events = nlohmann::json::array();
+  std::vector<TraceRecord> records;
+  for (const auto& buffer : buffers) {
+    {
+      std::unique_lock<std::mutex> lock(registry->mutex);
+      if (!buffer->thread_name.empty()) {
+        trace_events.push_back({{"name", "thread_name"},
+                                {"ph", "M"},
+                                {"pid", pid},
+                                {"tid", buffer->tid},
+                                {"args", {{"name", buffer->thread_name}}}});
+      }
+    }
+    records.clear();
+    CopyRecords(buffer.get(), &records);
+    for (const TraceRecord& record : records) {
+      trace_events.push_back({{"name", names.at(record.name_id)},
+                              {"ph", "X"},
+                              {"pid", pid},
+                              {"tid", buffer->tid},
+                              {"ts", record.begin_ns / 1000.0},
+                              {"dur", (record.end_ns - record.begin_ns) / 1000.0}});
+    }
+  }
+  nlohmann::json trace;
+  trace["traceEvents"] = trace_events;
+  trace["displayTimeUnit"] = "ms";
+  std::ofstream ofs(path);
+  CHECK(ofs.is_open()) << "can not open " << path;
+  ofs << trace.dump();
+}
+
+void ClearHostTrace() {
+  HostTraceRegistry* registry = MutHostTraceRegistry();
+  std::unique_lock<std::mutex> lock(registry->mutex);
+  for (const auto& buffer : registry->thread_trace_buffers) {
+    buffer->cleared_cnt.store(buffer->write_cnt.load(std::memory_order_acquire));
+  }
+}
+
+}  // namespace profiler
+
+}  // namespace oneflow
@@ -0,0 +1,46 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_PROFILER_HOST_TRACER_H_
+#define ONEFLOW_CORE_PROFILER_HOST_TRACER_H_
+
+#include "oneflow/core/common/util.h"
+
+namespace oneflow {
+
+namespace profiler {
+
+// Built-in host tracing backend of RangePush/RangePop/RangeGuard, toggleable at runtime.
+// Each thread records (name id, begin ns, end ns) of its ranges into its own ring buffer without
+// locking. The ring buffer keeps the latest ONEFLOW_PROFILER_HOST_TRACE_BUFFER_SIZE records.
+
+void EnableHostTracing();
+void DisableHostTracing();
+bool IsHostTracingEnabled();
+
+void HostTracingRangePush(const std::string& name);
+void HostTracingRangePop();
+void HostTracingNameThisThread(const std::string& name);
+
+// Writes the records of all threads to `path' as chrome trace json, which Perfetto UI loads too.
+// Call it after DisableHostTracing, or the records being written meanwhile may be dropped.
+void DumpHostTrace(const std::string& path);
+void ClearHostTrace();
+
+}  // namespace profiler
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_PROFILER_HOST_TRACER_H_
@@ -0,0 +1,73 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "gtest/gtest.h"
+#include <fstream>
+#include <json.hpp>
+#include "oneflow/core/profiler/host_tracer.h"
+
+namespace oneflow {
+
+namespace profiler {
+
+namespace test {
+
+TEST(HostTracer, dump_chrome_trace) {
+  ClearHostTrace();
+  HostTracingRangePush("disabled");
+  HostTracingRangePop();
+  EnableHostTracing();
+  std::vector<std::thread> threads;
+  for (int32_t i = 0; i < 4; ++i) {
+    threads.emplace_back([i]() {
+      HostTracingNameThisThread("host_tracer_test_" + std::to_string(i));
+      for (int32_t j = 0; j < 100; ++j) {
+        HostTracingRangePush("outer");
+        HostTracingRangePush("inner");
+        HostTracingRangePop();
+        HostTracingRangePop();
+      }
+    });
+  }
+  for (auto& thread : threads) { thread.join(); }
+  DisableHostTracing();
+  // popping more than pushed is ignored
+  HostTracingRangePop();
+
+  const std::string path = "host_tracer_test_trace.json";
+  DumpHostTrace(path);
+  std::ifstream ifs(path);
+  nlohmann::json trace = nlohmann::json::parse(ifs);
+  int64_t outer_cnt = 0;
+  int64_t inner_cnt = 0;
+  int64_t thread_name_cnt = 0;
+  for (const auto& event : trace["traceEvents"]) {
+    const std::string name = event["name"];
+    if (name == "outer") { ++outer_cnt; }
+    if (name == "inner") { ++inner_cnt; }
+    if (name == "thread_name") { ++thread_name_cnt; }
+    ASSERT_NE(name, "disabled");
+  }
+  ASSERT_EQ(outer_cnt, 400);
+  ASSERT_EQ(inner_cnt, 400);
+  ASSERT_GE(thread_name_cnt, 4);
+  std::remove(path.c_str());
+}
+
+}  // namespace test
+
+}  // namespace profiler
+
+}  // namespace oneflow
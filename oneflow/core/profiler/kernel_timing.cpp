@@ -0,0 +1,200 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include "oneflow/core/profiler/kernel_timing.h"
+#include "oneflow/core/operator/op_conf.pb.h"
+#include "oneflow/core/device/cuda_device_context.h"
+#include "oneflow/core/vm/cuda_stream_handle_device_context.h"
+
+namespace oneflow {
+
+namespace profiler {
+
+namespace {
+
+std::atomic<bool>* MutKernelTimingEnabled() {
+  static std::atomic<bool> enabled(ParseBooleanFromEnv("ONEFLOW_PROFILER_KERNEL_TIMING", false));
+  return &enabled;
+}
+
+std::string OpTypeName4OpConf(const OperatorConf& op_conf) {
+  if (op_conf.has_user_conf()) { return op_conf.user_conf().op_type_name(); }
+  const auto* field = OperatorConf::descriptor()->FindFieldByNumber(op_conf.op_type_case());
+  return field == nullptr ? "unknown" : field->name();
+}
+
+struct KernelTimingStat {
+  std::vector<float> elapsed_ms;
+  int64_t total_bytes = 0;
+  int64_t total_flops = 0;
+};
+
+struct KernelTimingCollector final {
+  std::mutex mutex;
+  // (op_type_name, op_name) -> stat
+  std::map<std::pair<std::string, std::string>, KernelTimingStat> key2stat;
+};
+
+KernelTimingCollector* MutKernelTimingCollector() {
+  static KernelTimingCollector* collector = new KernelTimingCollector();
+  return collector;
+}
+
+#ifdef WITH_CUDA
+
+class CudaEventPool final {
+ public:
+  cudaEvent_t Get(int64_t device_id) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      auto* events = &device_id2events_[device_id];
+      if (!events->empty()) {
+        cudaEvent_t event = events->back();
+        events->pop_back();
+        return event;
+      }
+    }
+    cudaEvent_t event;
+    OF_CUDA_CHECK(cudaEventCreate(&event));
+    return event;
+  }
+
+  void Put(int64_t device_id, cudaEvent_t event) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    device_id2events_[device_id].push_back(event);
+  }
+
+ private:
+  std::mutex mutex_;
+  HashMap<int64_t, std::vector<cudaEvent_t>> device_id2events_;
+};
+
+CudaEventPool* MutCudaEventPool() {
+  // never destructed, the events are released with the cuda context
+  static CudaEventPool* pool = new CudaEventPool();
+  return pool;
+}
+
+bool IsCudaDeviceCtx(DeviceCtx* device_ctx) {
+  return dynamic_cast<CudaDeviceCtx*>(device_ctx) != nullptr
+         || dynamic_cast<vm::CudaStreamHandleDeviceCtx*>(device_ctx) != nullptr;
+}
+
+#endif  // WITH_CUDA
+
+}  // namespace
+
+class KernelTimingCtx final {
+ public:
+  KernelTimingCtx(const OperatorConf& op_conf, DeviceCtx* ctx, int64_t bytes, int64_t flops)
+      : op_type_name(OpTypeName4OpConf(op_conf)),
+        op_name(op_conf.name()),
+        device_ctx(ctx),
+        bytes_touched(bytes),
+        flops(flops) {}
+
+  const std::string op_type_name;
+  const std::string op_name;
+  DeviceCtx* device_ctx;
+  const int64_t bytes_touched;
+  const int64_t flops;
+#ifdef WITH_CUDA
+  int device_id;
+  cudaEvent_t start_event;
+  cudaEvent_t end_event;
+#endif  // WITH_CUDA
+};
+
+void EnableKernelTiming() { MutKernelTimingEnabled()->store(true); }
+
+void DisableKernelTiming() { MutKernelTimingEnabled()->store(false); }
+
+bool IsKernelTimingEnabled() { return MutKernelTimingEnabled()->load(std::memory_order_relaxed); }
+
+std::vector<KernelTimingRow> GetKernelTimingTable() {
+  std::vector<KernelTimingRow> table;
+  KernelTimingCollector* collector = MutKernelTimingCollector();
+  {
+    std::unique_lock<std::mutex> lock(collector->mutex);
+    for (auto& pair : collector->key2stat) {
+      std::vector<float>* elapsed_ms = &pair.second.elapsed_ms;
+      if (elapsed_ms->empty()) { continue; }
+      KernelTimingRow row;
+      row.op_type_name = pair.first.first;
+      row.op_name = pair.first.second;
+      row.call_cnt = elapsed_ms->size();
+      row.total_ms = std::accumulate(elapsed_ms->begin(), elapsed_ms->end(), 0.0);
+      row.mean_ms = row.total_ms / row.call_cnt;
+      const int64_t p99_index = std::max<int64_t>((row.call_cnt * 99 + 99) / 100 - 1, 0);
+      std::nth_element(elapsed_ms->begin(), elapsed_ms->begin() + p99_index, elapsed_ms->end());
+      row.p99_ms = elapsed_ms->at(p99_index);
+      row.total_bytes = pair.second.total_bytes;
+      row.total_flops = pair.second.total_flops;
+      table.push_back(row);
+    }
+  }
+  std::sort(table.begin(), table.end(), [](const KernelTimingRow& lhs, const KernelTimingRow& rhs) {
+    return lhs.total_ms > rhs.total_ms;
+  });
+  return table;
+}
+
+void ResetKernelTiming() {
+  KernelTimingCollector* collector = MutKernelTimingCollector();
+  std::unique_lock<std::mutex> lock(collector->mutex);
+  collector->key2stat.clear();
+}
+
+KernelTimingGuard::KernelTimingGuard(const OperatorConf& op_conf, DeviceCtx* device_ctx,
+                                     const std::function<int64_t()>& BytesTouched,
+                                     const std::function<int64_t()>& Flops) {
+#ifdef WITH_CUDA
+  if (!IsKernelTimingEnabled() || !IsCudaDeviceCtx(device_ctx)) { return; }
+  ctx_.reset(new KernelTimingCtx(op_conf, device_ctx, BytesTouched(), Flops()));
+  OF_CUDA_CHECK(cudaGetDevice(&ctx_->device_id));
+  ctx_->start_event = MutCudaEventPool()->Get(ctx_->device_id);
+  ctx_->end_event = MutCudaEventPool()->Get(ctx_->device_id);
+  OF_CUDA_CHECK(cudaEventRecord(ctx_->start_event, device_ctx->cuda_stream()));
+#endif  // WITH_CUDA
+}
+
+KernelTimingGuard::~KernelTimingGuard() {
+#ifdef WITH_CUDA
+  if (!ctx_) { return; }
+  OF_CUDA_CHECK(cudaEventRecord(ctx_->end_event, ctx_->device_ctx->cuda_stream()));
+  std::shared_ptr<KernelTimingCtx> ctx(ctx_.release());
+  ctx->device_ctx->AddCallBack([ctx]() {
+    float elapsed_ms = 0;
+    OF_CUDA_CHECK(cudaEventElapsedTime(&elapsed_ms, ctx->start_event, ctx->end_event));
+    MutCudaEventPool()->Put(ctx->device_id, ctx->start_event);
+    MutCudaEventPool()->Put(ctx->device_id, ctx->end_event);
+    KernelTimingCollector* collector = MutKernelTimingCollector();
+    std::unique_lock<std::mutex> lock(collector->mutex);
+    KernelTimingStat* stat = &collector->key2stat[std::make_pair(ctx->op_type_name, ctx->op_name)];
+    stat->elapsed_ms.push_back(elapsed_ms);
+    stat->total_bytes += ctx->bytes_touched;
+    stat->total_flops += ctx->flops;
+  });
+#endif  // WITH_CUDA
+}
+
+}  // namespace profiler
+
+}  // namespace oneflow
@@ -0,0 +1,75 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_PROFILER_KERNEL_TIMING_H_
+#define ONEFLOW_CORE_PROFILER_KERNEL_TIMING_H_
+
+#include "oneflow/core/common/util.h"
+
+namespace oneflow {
+
+class DeviceCtx;
+class OperatorConf;
+
+namespace profiler {
+
+// Optional per-kernel GPU timing, keyed by op name. Enabled by EnableKernelTiming or the
+// environment variable ONEFLOW_PROFILER_KERNEL_TIMING.
+
+struct KernelTimingRow {
+  std::string op_type_name;
+  std::string op_name;
+  int64_t call_cnt;
+  double total_ms;
+  double mean_ms;
+  double p99_ms;
+  // bytes of the input and output blob bodies, summed over calls
+  int64_t total_bytes;
+  // floating point operations declared by the kernel registry, summed over calls, 0 if unknown
+  int64_t total_flops;
+};
+
+void EnableKernelTiming();
+void DisableKernelTiming();
+bool IsKernelTimingEnabled();
+
+// Reduces the timings collected since the last reset, sorted by total time in descending order.
+// Only kernels whose end events have been reached by their streams are counted.
+std::vector<KernelTimingRow> GetKernelTimingTable();
+void ResetKernelTiming();
+
+class KernelTimingCtx;
+
+// Records pooled cuda events around the kernels launched in its scope on a cuda device ctx and
+// reports the elapsed time from the device ctx callback. Does nothing if kernel timing is
+// disabled or `device_ctx' is not a cuda device ctx, in which case `BytesTouched' and `Flops'
+// are not called either.
+class KernelTimingGuard final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(KernelTimingGuard);
+  KernelTimingGuard(const OperatorConf& op_conf, DeviceCtx* device_ctx,
+                    const std::function<int64_t()>& BytesTouched,
+                    const std::function<int64_t()>& Flops);
+  ~KernelTimingGuard();
+
+ private:
+  std::unique_ptr<KernelTimingCtx> ctx_;
+};
+
+}  // namespace profiler
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_PROFILER_KERNEL_TIMING_H_
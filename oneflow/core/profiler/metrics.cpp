@@ -0,0 +1,216 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/profiler/metrics.h"
+#include <sstream>
+
+namespace oneflow {
+
+namespace profiler {
+
+namespace {
+
+enum MetricType { kMetricTypeCounter = 0, kMetricTypeGauge, kMetricTypeHistogram };
+
+const char* MetricTypeName(MetricType type) {
+  if (type == kMetricTypeCounter) {
+    return "counter";
+  } else if (type == kMetricTypeGauge) {
+    return "gauge";
+  } else {
+    return "histogram";
+  }
+}
+
+std::string EscapeLabelValue(const std::string& value) {
+  std::string escaped;
+  escaped.reserve(value.size());
+  for (const char c : value) {
+    if (c == '\\' || c == '"') {
+      escaped.push_back('\\');
+      escaped.push_back(c);
+    } else if (c == '\n') {
+      escaped += "\\n";
+    } else {
+      escaped.push_back(c);
+    }
+  }
+  return escaped;
+}
+
+std::string LabelsToString(const MetricLabels& labels) {
+  std::string str;
+  for (const auto& label : labels) {
+    if (!str.empty()) { str.push_back(','); }
+    str += label.first + "=\"" + EscapeLabelValue(label.second) + "\"";
+  }
+  return str;
+}
+
+std::string WithLabels(const std::string& labels_str, const std::string& extra) {
+  if (labels_str.empty() && extra.empty()) { return ""; }
+  if (labels_str.empty()) { return "{" + extra + "}"; }
+  if (extra.empty()) { return "{" + labels_str + "}"; }
+  return "{" + labels_str + "," + extra + "}";
+}
+
+struct MetricFamily {
+  MetricType type;
+  std::string help;
+  // labels string to metric
+  std::map<std::string, std::unique_ptr<Counter>> counters;
+  std::map<std::string, std::unique_ptr<Gauge>> gauges;
+  std::map<std::string, std::unique_ptr<Histogram>> histograms;
+};
+
+class MetricsRegistry final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(MetricsRegistry);
+  MetricsRegistry() = default;
+  ~MetricsRegistry() = default;
+
+  MetricFamily* FindOrCreateFamily(const std::string& name, MetricType type,
+                                   const std::string& help) {
+    auto it = name2family_.find(name);
+    if (it == name2family_.end()) {
+      it = name2family_.emplace(name, std::make_unique<MetricFamily>()).first;
+      it->second->type = type;
+      it->second->help = help;
+    }
+    CHECK_EQ(it->second->type, type) << "metric " << name << " is registered as "
+                                     << MetricTypeName(it->second->type);
+    return it->second.get();
+  }
+
+  std::mutex* mutex() { return &mutex_; }
+  const std::map<std::string, std::unique_ptr<MetricFamily>>& name2family() const {
+    return name2family_;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::map<std::string, std::unique_ptr<MetricFamily>> name2family_;
+};
+
+// never destructed, metrics may be updated by threads outliving static destruction
+MetricsRegistry* GetMetricsRegistry() {
+  static MetricsRegistry* registry = new MetricsRegistry();
+  return registry;
+}
+
+template<typename T>
+T* FindOrCreateMetric(std::map<std::string, std::unique_ptr<T>>* labels2metric,
+                      const std::string& labels_str, const std::function<T*()>& Create) {
+  auto it = labels2metric->find(labels_str);
+  if (it == labels2metric->end()) {
+    it = labels2metric->emplace(labels_str, std::unique_ptr<T>(Create())).first;
+  }
+  return it->second.get();
+}
+
+}  // namespace
+
+Histogram::Histogram(std::vector<double> bounds)
+    : bounds_(std::move(bounds)),
+      bucket_counts_(new std::atomic<int64_t>[bounds_.size() + 1]),
+      count_(0),
+      sum_(0) {
+  CHECK(std::is_sorted(bounds_.begin(), bounds_.end()));
+  FOR_RANGE(size_t, i, 0, bounds_.size() + 1) { bucket_counts_[i].store(0); }
+}
+
+void Histogram::Observe(double value) {
+  const size_t bucket = std::lower_bound(bounds_.begin(), bounds_.end(), value) - bounds_.begin();
+  bucket_counts_[bucket].fetch_add(1, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+  double sum = sum_.load(std::memory_order_relaxed);
+  while (!sum_.compare_exchange_weak(sum, sum + value, std::memory_order_relaxed)) {}
+}
+
+const std::vector<double>& DefaultSecondsBuckets() {
+  static const std::vector<double> buckets{0.0001, 0.0005, 0.001, 0.005, 0.01, 0.05,
+                                           0.1,    0.5,    1,     5,     10,   100};
+  return buckets;
+}
+
+Counter* GetCounter(const std::string& name, const std::string& help,
+                    const MetricLabels& labels) {
+  MetricsRegistry* registry = GetMetricsRegistry();
+  std::unique_lock<std::mutex> lock(*registry->mutex());
+  MetricFamily* family = registry->FindOrCreateFamily(name, kMetricTypeCounter, help);
+  return FindOrCreateMetric<Counter>(&family->counters, LabelsToString(labels),
+                                     []() { return new Counter(); });
+}
+
+Gauge* GetGauge(const std::string& name, const std::string& help, const MetricLabels& labels) {
+  MetricsRegistry* registry = GetMetricsRegistry();
+  std::unique_lock<std::mutex> lock(*registry->mutex());
+  MetricFamily* family = registry->FindOrCreateFamily(name, kMetricTypeGauge, help);
+  return FindOrCreateMetric<Gauge>(&family->gauges, LabelsToString(labels),
+                                   []() { return new Gauge(); });
+}
+
+Histogram* GetHistogram(const std::string& name, const std::string& help,
+                        const std::vector<double>& bounds, const MetricLabels& labels) {
+  MetricsRegistry* registry = GetMetricsRegistry();
+  std::unique_lock<std::mutex> lock(*registry->mutex());
+  MetricFamily* family = registry->FindOrCreateFamily(name, kMetricTypeHistogram, help);
+  Histogram* histogram = FindOrCreateMetric<Histogram>(
+      &family->histograms, LabelsToString(labels), [&]() { return new Histogram(bounds); });
+  CHECK(histogram->bounds() == bounds) << "metric " << name << " is registered with other buckets";
+  return histogram;
+}
+
+std::string DumpMetricsInPrometheusFormat() {
+  MetricsRegistry* registry = GetMetricsRegistry();
+  std::unique_lock<std::mutex> lock(*registry->mutex());
+  std::ostringstream ss;
+  for (const auto& pair : registry->name2family()) {
+    const std::string& name = pair.first;
+    const MetricFamily& family = *pair.second;
+    ss << "# HELP " << name << " " << family.help << "\n";
+    ss << "# TYPE " << name << " " << MetricTypeName(family.type) << "\n";
+    for (const auto& labels7counter : family.counters) {
+      ss << name << WithLabels(labels7counter.first, "") << " " << labels7counter.second->Get()
+         << "\n";
+    }
+    for (const auto& labels7gauge : family.gauges) {
+      ss << name << WithLabels(labels7gauge.first, "") << " " << labels7gauge.second->Get()
+         << "\n";
+    }
+    for (const auto& labels7histogram : family.histograms) {
+      const std::string& labels_str = labels7histogram.first;
+      const Histogram& histogram = *labels7histogram.second;
+      int64_t cumulative_count = 0;
+      FOR_RANGE(size_t, i, 0, histogram.bounds().size()) {
+        cumulative_count += histogram.BucketCount(i);
+        std::ostringstream le;
+        le << "le=\"" << histogram.bounds().at(i) << "\"";
+        ss << name << "_bucket" << WithLabels(labels_str, le.str()) << " " << cumulative_count
+           << "\n";
+      }
+      cumulative_count += histogram.BucketCount(histogram.bounds().size());
+      ss << name << "_bucket" << WithLabels(labels_str, "le=\"+Inf\"") << " " << cumulative_count
+         << "\n";
+      ss << name << "_sum" << WithLabels(labels_str, "") << " " << histogram.Sum() << "\n";
+      ss << name << "_count" << WithLabels(labels_str, "") << " " << histogram.Count() << "\n";
+    }
+  }
+  return ss.str();
+}
+
+}  // namespace profiler
+
+}  // namespace oneflow
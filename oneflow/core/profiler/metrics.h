@@ -0,0 +1,99 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_PROFILER_METRICS_H_
+#define ONEFLOW_CORE_PROFILER_METRICS_H_
+
+#include <atomic>
+#include "oneflow/core/common/util.h"
+
+namespace oneflow {
+
+namespace profiler {
+
+// Process wide runtime metrics, exported in the Prometheus text format by MetricsExporter.
+// A metric is created once under a lock by the Get* functions below and lives until the process
+// exits; updating it is a relaxed atomic operation, so hot paths should keep the returned pointer.
+
+using MetricLabels = std::vector<std::pair<std::string, std::string>>;
+
+class Counter final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(Counter);
+  Counter() : value_(0) {}
+  ~Counter() = default;
+
+  void Add(int64_t delta) { value_.fetch_add(delta, std::memory_order_relaxed); }
+  int64_t Get() const { return value_.load(std::memory_order_relaxed); }
+
+ private:
+  std::atomic<int64_t> value_;
+};
+
+class Gauge final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(Gauge);
+  Gauge() : value_(0) {}
+  ~Gauge() = default;
+
+  void Set(int64_t value) { value_.store(value, std::memory_order_relaxed); }
+  void Add(int64_t delta) { value_.fetch_add(delta, std::memory_order_relaxed); }
+  int64_t Get() const { return value_.load(std::memory_order_relaxed); }
+
+ private:
+  std::atomic<int64_t> value_;
+};
+
+class Histogram final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(Histogram);
+  // upper bounds of the buckets in ascending order, the +Inf bucket is implicit
+  explicit Histogram(std::vector<double> bounds);
+  ~Histogram() = default;
+
+  void Observe(double value);
+
+  const std::vector<double>& bounds() const { return bounds_; }
+  // not cumulative, the last one is the +Inf bucket
+  int64_t BucketCount(size_t bucket) const {
+    return bucket_counts_[bucket].load(std::memory_order_relaxed);
+  }
+  int64_t Count() const { return count_.load(std::memory_order_relaxed); }
+  double Sum() const { return sum_.load(std::memory_order_relaxed); }
+
+ private:
+  const std::vector<double> bounds_;
+  std::unique_ptr<std::atomic<int64_t>[]> bucket_counts_;
+  std::atomic<int64_t> count_;
+  std::atomic<double> sum_;
+};
+
+// 100us to 100s, for durations in seconds
+const std::vector<double>& DefaultSecondsBuckets();
+
+Counter* GetCounter(const std::string& name, const std::string& help,
+                    const MetricLabels& labels = {});
+Gauge* GetGauge(const std::string& name, const std::string& help,
+                const MetricLabels& labels = {});
+Histogram* GetHistogram(const std::string& name, const std::string& help,
+                        const std::vector<double>& bounds, const MetricLabels& labels = {});
+
+std::string DumpMetricsInPrometheusFormat();
+
+}  // namespace profiler
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_PROFILER_METRICS_H_
@@ -0,0 +1,96 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/profiler/metrics_exporter.h"
+#include "oneflow/core/profiler/metrics.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace oneflow {
+
+namespace profiler {
+
+namespace {
+
+constexpr int kPollTimeoutMs = 200;
+constexpr size_t kMaxRequestHeaderSize = 8192;
+
+void SendAll(int fd, const std::string& data) {
+  size_t sent = 0;
+  while (sent < data.size()) {
+    const ssize_t ret = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+    if (ret <= 0) { return; }
+    sent += ret;
+  }
+}
+
+void HandleConnection(int fd) {
+  // the request is not interpreted, reading up to the end of the header is enough
+  std::string request;
+  char buf[1024];
+  while (request.find("\r\n\r\n") == std::string::npos && request.size() < kMaxRequestHeaderSize) {
+    pollfd pfd{fd, POLLIN, 0};
+    if (poll(&pfd, 1, kPollTimeoutMs) <= 0) { return; }
+    const ssize_t ret = recv(fd, buf, sizeof(buf), 0);
+    if (ret <= 0) { return; }
+    request.append(buf, ret);
+  }
+  const std::string body = DumpMetricsInPrometheusFormat();
+  SendAll(fd,
+          "HTTP/1.1 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: "
+              + std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body);
+}
+
+}  // namespace
+
+MetricsExporter::MetricsExporter(int32_t port) : shutdown_(false) {
+  listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+  PCHECK(listen_fd_ >= 0);
+  int reuse = 1;
+  PCHECK(setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) == 0);
+  sockaddr_in sa{};
+  sa.sin_family = AF_INET;
+  sa.sin_port = htons(port);
+  sa.sin_addr.s_addr = htonl(INADDR_ANY);
+  PCHECK(bind(listen_fd_, reinterpret_cast<sockaddr*>(&sa), sizeof(sa)) == 0)
+      << "metrics exporter port: " << port;
+  PCHECK(listen(listen_fd_, SOMAXCONN) == 0);
+  LOG(INFO) << "metrics exporter listening on port " << port;
+  serve_thread_ = std::thread(&MetricsExporter::Serve, this);
+}
+
+MetricsExporter::~MetricsExporter() {
+  shutdown_.store(true);
+  serve_thread_.join();
+  close(listen_fd_);
+}
+
+void MetricsExporter::Serve() {
+  while (!shutdown_.load()) {
+    pollfd pfd{listen_fd_, POLLIN, 0};
+    if (poll(&pfd, 1, kPollTimeoutMs) <= 0) { continue; }
+    const int fd = accept(listen_fd_, nullptr, nullptr);
+    if (fd < 0) { continue; }
+    HandleConnection(fd);
+    close(fd);
+  }
+}
+
+}  // namespace profiler
+
+}  // namespace oneflow
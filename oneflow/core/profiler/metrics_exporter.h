@@ -0,0 +1,46 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_PROFILER_METRICS_EXPORTER_H_
+#define ONEFLOW_CORE_PROFILER_METRICS_EXPORTER_H_
+
+#include <atomic>
+#include "oneflow/core/common/util.h"
+
+namespace oneflow {
+
+namespace profiler {
+
+// Serves DumpMetricsInPrometheusFormat() over HTTP on the given port. Every request is answered
+// with the metrics regardless of its path, one connection at a time.
+class MetricsExporter final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(MetricsExporter);
+  explicit MetricsExporter(int32_t port);
+  ~MetricsExporter();
+
+ private:
+  void Serve();
+
+  int listen_fd_;
+  std::atomic<bool> shutdown_;
+  std::thread serve_thread_;
+};
+
+}  // namespace profiler
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_PROFILER_METRICS_EXPORTER_H_
@@ -0,0 +1,61 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "gtest/gtest.h"
+#include "oneflow/core/profiler/metrics.h"
+
+namespace oneflow {
+
+namespace profiler {
+
+namespace test {
+
+TEST(Metrics, dump_prometheus_format) {
+  Counter* counter = GetCounter("metrics_test_total", "test counter", {{"peer", "1"}});
+  ASSERT_EQ(counter, GetCounter("metrics_test_total", "test counter", {{"peer", "1"}}));
+  std::vector<std::thread> threads;
+  for (int32_t i = 0; i < 4; ++i) {
+    threads.emplace_back([counter]() {
+      for (int32_t j = 0; j < 1000; ++j) { counter->Add(2); }
+    });
+  }
+  for (auto& thread : threads) { thread.join(); }
+  ASSERT_EQ(counter->Get(), 8000);
+
+  Gauge* gauge = GetGauge("metrics_test_gauge", "test gauge");
+  gauge->Set(5);
+  gauge->Add(-2);
+
+  Histogram* histogram = GetHistogram("metrics_test_seconds", "test histogram", {0.1, 1});
+  histogram->Observe(0.05);
+  histogram->Observe(0.1);
+  histogram->Observe(0.5);
+  histogram->Observe(2);
+
+  const std::string dump = DumpMetricsInPrometheusFormat();
+  ASSERT_NE(dump.find("# TYPE metrics_test_total counter\n"), std::string::npos);
+  ASSERT_NE(dump.find("metrics_test_total{peer=\"1\"} 8000\n"), std::string::npos);
+  ASSERT_NE(dump.find("metrics_test_gauge 3\n"), std::string::npos);
+  ASSERT_NE(dump.find("metrics_test_seconds_bucket{le=\"0.1\"} 2\n"), std::string::npos);
+  ASSERT_NE(dump.find("metrics_test_seconds_bucket{le=\"1\"} 3\n"), std::string::npos);
+  ASSERT_NE(dump.find("metrics_test_seconds_bucket{le=\"+Inf\"} 4\n"), std::string::npos);
+  ASSERT_NE(dump.find("metrics_test_seconds_count 4\n"), std::string::npos);
+}
+
+}  // namespace test
+
+}  // namespace profiler
+
+}  // namespace oneflow
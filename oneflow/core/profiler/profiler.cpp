@@ -15,6 +15,7 @@ limitations under the License.
 */
 
 #include "oneflow/core/profiler/profiler.h"
+#include "oneflow/core/profiler/host_tracer.h"
 #ifdef OF_ENABLE_PROFILER
 #include <nvtx3/nvToolsExt.h>
 #include <sys/syscall.h>
@@ -28,18 +29,21 @@ namespace oneflow {
 namespace profiler {
 
 void NameThisHostThread(const std::string& name) {
+  HostTracingNameThisThread(name);
 #ifdef OF_ENABLE_PROFILER
   nvtxNameOsThreadA(syscall(SYS_gettid), name.c_str());
 #endif  // OF_ENABLE_PROFILER
 }
 
 void RangePush(const std::string& name) {
+  HostTracingRangePush(name);
 #ifdef OF_ENABLE_PROFILER
   nvtxRangePushA(name.c_str());
 #endif  // OF_ENABLE_PROFILER
 }
 
 void RangePop() {
+  HostTracingRangePop();
 #ifdef OF_ENABLE_PROFILER
   nvtxRangePop();
 #endif  // OF_ENABLE_PROFILER
@@ -63,6 +67,7 @@ class RangeGuardCtx {};
 #endif  // OF_ENABLE_PROFILER
 
 RangeGuard::RangeGuard(const std::string& name) {
+  HostTracingRangePush(name);
 #ifdef OF_ENABLE_PROFILER
   nvtxRangeId_t range_id = nvtxRangeStartA(name.c_str());
   ctx_.reset(new RangeGuardCtx(range_id));
@@ -70,6 +75,7 @@ RangeGuard::RangeGuard(const std::string& name) {
 }
 
 RangeGuard::~RangeGuard() {
+  HostTracingRangePop();
 #ifdef OF_ENABLE_PROFILER
   nvtxRangeEnd(ctx_->range_id());
 #endif  // OF_ENABLE_PROFILER
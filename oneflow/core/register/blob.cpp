@@ -52,9 +52,11 @@ void Blob::CopyDataContentFrom(DeviceCtx* device_ctx, const Blob* rhs) {
 void Blob::CopyValidDataContentFrom(DeviceCtx* device_ctx, const Blob* rhs) {
   if (this == rhs) { return; }
   this->blob_access_checker()->CheckBodyMutable();
-  const size_t body_byte_size = ByteSizeOfBlobBody();
-  CHECK_EQ(rhs->ByteSizeOfBlobBody(), body_byte_size);
-  AutoMemcpy(device_ctx, mut_dptr(), rhs->dptr(), body_byte_size, mem_case(), rhs->mem_case());
+  CHECK_EQ(rhs->data_type(), data_type());
+  // only the elements in the shape of rhs, a dynamic blob may be far below its capacity
+  const size_t valid_byte_size = rhs->ByteSizeOfValidDataContent();
+  CHECK_LE(valid_byte_size, ByteSizeOfBlobBody());
+  AutoMemcpy(device_ctx, mut_dptr(), rhs->dptr(), valid_byte_size, mem_case(), rhs->mem_case());
 }
 
 void Blob::CopyHeaderFrom(DeviceCtx* device_ctx, const Blob* rhs) {
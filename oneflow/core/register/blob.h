@@ -97,6 +97,10 @@ class Blob final {
 
   size_t ByteSizeOfBlobBody() const { return blob_desc_->ByteSizeOfBlobBody(); }
   size_t AlignedByteSizeOfBlobBody() const { return blob_desc_->AlignedByteSizeOfBlobBody(); }
+  // byte size of the elements in shape(), below ByteSizeOfBlobBody when a dynamic blob is not full
+  size_t ByteSizeOfValidDataContent() const {
+    return shape().elem_cnt() * GetSizeOfDataType(data_type());
+  }
 
   void set_blob_access_checker(const BlobAccessChecker* blob_access_checker) {
     this->blob_access_checker_ = blob_access_checker;
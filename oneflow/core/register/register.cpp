@@ -77,7 +77,11 @@ void* Regst::comm_net_token() {
     token = comm_net_token_;
     if (token != nullptr) { return token; }
     CHECK(main_mem_ptr() != nullptr);
-    CHECK(separated_header_mem_ptr() == nullptr);
+    // device-resident registers keep their header on the host, only the body goes over the wire,
+    // which requires the header to be static (see TaskGraph::GetProxyNode)
+    CHECK(separated_header_mem_ptr() == nullptr
+          || (regst_desc()->mem_case().has_device_cuda_mem()
+              && Global<CommNet>::Get()->IsDeviceMemorySupported()));
     token = Global<CommNet>::Get()->RegisterMemory(main_mem_ptr(),
                                                    this->regst_desc()->MainByteSize4OneRegst());
     comm_net_token_ = token;
@@ -65,11 +65,34 @@ void TensorSliceCopier::Copy(DeviceCtx* ctx, const MemoryCopier& copier, void* d
 
 void TensorSliceCopier::Copy(DeviceCtx* ctx, const MemoryCopier& copier, Blob* dst_blob,
                              const Blob* src_blob) const {
+  CheckBlobs(dst_blob, src_blob);
+  Copy(ctx, copier, dst_blob->mut_dptr(), src_blob->dptr());
+}
+
+void TensorSliceCopier::BatchCopy(DeviceCtx* ctx, const MemoryCopier& copier,
+                                  const std::vector<const TensorSliceCopier*>& slice_copiers,
+                                  const std::vector<Blob*>& dst_blobs,
+                                  const std::vector<const Blob*>& src_blobs) {
+  CHECK_EQ(dst_blobs.size(), slice_copiers.size());
+  CHECK_EQ(src_blobs.size(), slice_copiers.size());
+  std::vector<void*> dst(slice_copiers.size());
+  std::vector<const void*> src(slice_copiers.size());
+  std::vector<const MemoryCopyNdDesc*> desc(slice_copiers.size());
+  FOR_RANGE(size_t, i, 0, slice_copiers.size()) {
+    const TensorSliceCopier* slice_copier = slice_copiers.at(i);
+    slice_copier->CheckBlobs(dst_blobs.at(i), src_blobs.at(i));
+    dst.at(i) = dst_blobs.at(i)->mut_dptr();
+    src.at(i) = src_blobs.at(i)->dptr();
+    desc.at(i) = &slice_copier->memory_copy_nd_desc_;
+  }
+  copier.BatchCopy(ctx, dst, src, desc);
+}
+
+void TensorSliceCopier::CheckBlobs(const Blob* dst_blob, const Blob* src_blob) const {
   CHECK_EQ(dst_blob->data_type(), data_type_);
   CHECK_EQ(src_blob->data_type(), data_type_);
   CHECK_EQ(dst_view_.shape().elem_cnt(), dst_blob->shape().elem_cnt());
   CHECK_EQ(src_view_.shape().elem_cnt(), src_blob->shape().elem_cnt());
-  Copy(ctx, copier, dst_blob->mut_dptr(), src_blob->dptr());
 }
 
 }  // namespace oneflow
@@ -34,8 +34,14 @@ class TensorSliceCopier final {
 
   void Copy(DeviceCtx* ctx, const MemoryCopier& copier, void* dst, const void* src) const;
   void Copy(DeviceCtx* ctx, const MemoryCopier& copier, Blob* dst_blob, const Blob* src_blob) const;
+  static void BatchCopy(DeviceCtx* ctx, const MemoryCopier& copier,
+                        const std::vector<const TensorSliceCopier*>& slice_copiers,
+                        const std::vector<Blob*>& dst_blobs,
+                        const std::vector<const Blob*>& src_blobs);
 
  private:
+  void CheckBlobs(const Blob* dst_blob, const Blob* src_blob) const;
+
   MemoryCopyNdDesc memory_copy_nd_desc_;
   const TensorSliceView dst_view_;
   const TensorSliceView src_view_;
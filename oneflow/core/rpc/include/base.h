@@ -21,6 +21,7 @@ limitations under the License.
 #include "oneflow/core/common/util.h"
 #include "oneflow/core/control/control.pb.h"
 #include "oneflow/core/control/ctrl_bootstrap.pb.h"
+#include "oneflow/core/rpc/include/global_process_ctx.h"
 
 namespace oneflow {
 
@@ -36,7 +37,9 @@ namespace oneflow {
   OF_PP_MAKE_TUPLE_SEQ(PushActEvent)  \
   OF_PP_MAKE_TUPLE_SEQ(Clear)         \
   OF_PP_MAKE_TUPLE_SEQ(IncreaseCount) \
-  OF_PP_MAKE_TUPLE_SEQ(EraseCount)
+  OF_PP_MAKE_TUPLE_SEQ(EraseCount)    \
+  OF_PP_MAKE_TUPLE_SEQ(MultiPushKV)   \
+  OF_PP_MAKE_TUPLE_SEQ(MultiPullKV)
 
 #define CatRequest(method) method##Request,
 #define CatReqponse(method) method##Response,
@@ -94,12 +97,33 @@ class CtrlClient {
   virtual void PullKV(const std::string& k, std::string* v) = 0;
   virtual void PullKV(const std::string& k, PbMessage* msg) = 0;
   virtual void PullMasterKV(const std::string& k, PbMessage* msg) = 0;
+  // Pushes or pulls many keys with about one rpc per responsible server. The values pulled from
+  // one server by a MultiPullKV must fit in a single rpc message.
+  virtual void MultiPushKV(const std::vector<std::pair<std::string, std::string>>& kvs) {
+    for (const auto& kv : kvs) { PushKV(kv.first, kv.second); }
+  }
+  virtual void MultiPullKV(const std::vector<std::string>& keys, std::vector<std::string>* vals) {
+    vals->resize(keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) { PullKV(keys.at(i), &vals->at(i)); }
+  }
+  // For keys which are pushed once and never cleared, the value may be served from a client side
+  // cache on later pulls.
+  virtual void PullImmutableKV(const std::string& k, std::string* v) { PullKV(k, v); }
+  void PullImmutableKV(const std::string& k, PbMessage* msg) {
+    std::string v;
+    PullImmutableKV(k, &v);
+    msg->ParseFromString(v);
+  }
   template<typename T>
   typename std::enable_if<std::is_arithmetic<T>::value>::type PullKVT(const std::string& k, T* v) {
     std::string v_str;
     PullKV(k, &v_str);
     *v = oneflow_cast<T>(v_str);
   }
+  // Broadcasts `*v' of rank `root' to all the other ranks, which all must call it with the same `k'.
+  // The key is free again when it returns.
+  virtual void BroadcastKV(const std::string& k, int64_t root, std::string* v) = 0;
+  void BroadcastKV(const std::string& k, int64_t root, PbMessage* msg);
 
   virtual void PushActEvent(const ActEvent&) = 0;
   virtual void Clear() = 0;
@@ -108,6 +132,14 @@ class CtrlClient {
   virtual void EraseCount(const std::string& k) = 0;
 };
 
+inline void CtrlClient::BroadcastKV(const std::string& k, int64_t root, PbMessage* msg) {
+  const bool is_root = GlobalProcessCtx::Rank() == root;
+  std::string v;
+  if (is_root) { msg->SerializeToString(&v); }
+  BroadcastKV(k, root, &v);
+  if (!is_root) { CHECK(msg->ParseFromString(v)); }
+}
+
 #define FILE_LINE_STR __FILE__ ":" OF_PP_STRINGIZE(__LINE__)
 #define OF_ENV_BARRIER() Global<CtrlClient>::Get()->Barrier(FILE_LINE_STR)
 #define OF_SESSION_BARRIER()          \
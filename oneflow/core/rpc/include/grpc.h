@@ -47,6 +47,10 @@ class GrpcCtrlClient final : public CtrlClient {
   void PullKV(const std::string& k, std::string* v) override;
   void PullKV(const std::string& k, PbMessage* msg) override;
   void PullMasterKV(const std::string& k, PbMessage* msg) override;
+  void MultiPushKV(const std::vector<std::pair<std::string, std::string>>& kvs) override;
+  void MultiPullKV(const std::vector<std::string>& keys, std::vector<std::string>* vals) override;
+  void PullImmutableKV(const std::string& k, std::string* v) override;
+  void BroadcastKV(const std::string& k, int64_t root, std::string* v) override;
   void PushActEvent(const ActEvent&) override;
   void Clear() override;
   int32_t IncreaseCount(const std::string& k, int32_t v) override;
@@ -50,6 +50,8 @@ class LocalCtrlClient : public CtrlClient {
   void PullKV(const std::string& k, std::string* v) override;
   void PullKV(const std::string& k, PbMessage* msg) override;
   void PullMasterKV(const std::string& k, PbMessage* msg) override;
+  // there is only one rank
+  void BroadcastKV(const std::string& k, int64_t root, std::string* v) override {}
   void PushActEvent(const ActEvent&) override {}
   void Clear() override;
   int32_t IncreaseCount(const std::string& k, int32_t v) override;
@@ -211,6 +211,9 @@ class DryRunCtrlClient : public CtrlClient {
   void PullMasterKV(const std::string& k, PbMessage* msg) override {
     local_ctrl_client_->PullMasterKV(k, msg);
   }
+  void BroadcastKV(const std::string& k, int64_t root, std::string* v) override {
+    local_ctrl_client_->BroadcastKV(k, root, v);
+  }
   void PushActEvent(const ActEvent& ev) override { local_ctrl_client_->PushActEvent(ev); }
   void Clear() override { local_ctrl_client_->Clear(); }
   int32_t IncreaseCount(const std::string& k, int32_t v) override {
@@ -0,0 +1,372 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <grpc++/grpc++.h>
+#include <grpcpp/impl/codegen/method_handler_impl.h>
+#include "oneflow/core/serving/inference_server.h"
+#include "oneflow/core/common/blocking_counter.h"
+#include "oneflow/core/common/buffer_manager.h"
+#include "oneflow/core/common/global.h"
+#include "oneflow/core/control/global_process_ctx.h"
+#include "oneflow/core/job/job_build_and_infer_ctx_mgr.h"
+#include "oneflow/core/job/job_desc.h"
+#include "oneflow/core/job/job_instance.h"
+#include "oneflow/core/job/inter_user_job_info.pb.h"
+#include "oneflow/core/job/oneflow.h"
+#include "oneflow/core/kernel/kernel_util.h"
+#include "oneflow/core/memory/memory_case.pb.h"
+
+namespace oneflow {
+
+namespace {
+
+class ServingJobInstance final : public JobInstance {
+ public:
+  ServingJobInstance(const ServingJobInstance&) = delete;
+  ServingJobInstance(ServingJobInstance&&) = delete;
+  ~ServingJobInstance() override = default;
+  ServingJobInstance(const std::string& job_name, const std::function<void(OfBlob*)>& push_cb,
+                     const std::function<void(OfBlob*)>& pull_cb,
+                     const std::function<void()>& finish_cb)
+      : job_name_(job_name), push_cb_(push_cb), pull_cb_(pull_cb), finish_cb_(finish_cb) {}
+
+  std::string job_name() const override { return job_name_; }
+  void PushBlob(uint64_t ofblob_ptr) const override {
+    CHECK(push_cb_);
+    push_cb_(reinterpret_cast<OfBlob*>(ofblob_ptr));
+  }
+  void PullBlob(uint64_t ofblob_ptr) const override {
+    CHECK(pull_cb_);
+    pull_cb_(reinterpret_cast<OfBlob*>(ofblob_ptr));
+  }
+  void Finish() const override { finish_cb_(); }
+
+ private:
+  const std::string job_name_;
+  const std::function<void(OfBlob*)> push_cb_;
+  const std::function<void(OfBlob*)> pull_cb_;
+  const std::function<void()> finish_cb_;
+};
+
+// Same as LaunchJob of the python api
+void LaunchServingJob(const std::shared_ptr<JobInstance>& job_instance) {
+  const auto& job_name = job_instance->job_name();
+  const auto& inter_user_job_info = *Global<InterUserJobInfo>::Get();
+  auto* buffer_mgr = Global<BufferMgr<std::shared_ptr<JobInstance>>>::Get();
+  if (IsPullJob(job_name, inter_user_job_info)) {
+    buffer_mgr->Get(GetForeignOutputBufferName(job_name))->Send(job_instance);
+  }
+  if (IsPushJob(job_name, inter_user_job_info)) {
+    buffer_mgr->Get(GetForeignInputBufferName(job_name))->Send(job_instance);
+  }
+  buffer_mgr->Get(GetCallbackNotifierBufferName(job_name))->Send(job_instance);
+  Global<BufferMgr<int64_t>>::Get()
+      ->Get(kBufferNameGlobalWaitJobId)
+      ->Send(Global<JobName2JobId>::Get()->at(job_name));
+}
+
+MemoryCase HostMemCase() {
+  MemoryCase mem_case;
+  mem_case.mutable_host_mem();
+  return mem_case;
+}
+
+void CopyToOfBlob(OfBlob* of_blob, const char* src, const DimVector& dim_vec) {
+  of_blob->CopyShapeFrom(dim_vec.data(), dim_vec.size());
+  Blob* blob = of_blob->mut_blob();
+  blob->blob_access_checker()->CheckBodyMutable();
+  SyncAutoMemcpy(of_blob->mut_device_ctx(), blob->mut_dptr(), src,
+                 blob->shape().elem_cnt() * GetSizeOfDataType(blob->data_type()), blob->mem_case(),
+                 HostMemCase());
+}
+
+void CopyFromOfBlob(OfBlob* of_blob, ServingTensor* tensor) {
+  const Blob& blob = of_blob->blob();
+  tensor->set_data_type(blob.data_type());
+  FOR_RANGE(int64_t, i, 0, blob.shape().NumAxes()) { tensor->add_dim(blob.shape().At(i)); }
+  std::string* data = tensor->mutable_data();
+  data->resize(blob.shape().elem_cnt() * GetSizeOfDataType(blob.data_type()));
+  if (data->empty()) { return; }
+  SyncAutoMemcpy(of_blob->mut_device_ctx(), &data->at(0), blob.dptr(), data->size(), HostMemCase(),
+                 blob.mem_case());
+}
+
+class InferenceGrpcService final : public grpc::Service {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(InferenceGrpcService);
+  InferenceGrpcService() {
+    AddMethod(new grpc::internal::RpcServiceMethod(
+        "/oneflow.InferenceService/Infer", grpc::internal::RpcMethod::NORMAL_RPC,
+        new grpc::internal::RpcMethodHandler<InferenceGrpcService, InferRequest, InferResponse>(
+            [](InferenceGrpcService* service, grpc::ServerContext* ctx,
+               const InferRequest* request, InferResponse* response) {
+              return service->Infer(ctx, request, response);
+            },
+            this)));
+  }
+  ~InferenceGrpcService() override = default;
+
+ private:
+  grpc::Status Infer(grpc::ServerContext* ctx, const InferRequest* request,
+                     InferResponse* response) {
+    std::future<InferResponse> future;
+    const auto& maybe_ok = TRY([&]() -> Maybe<void> {
+      auto* server = JUST(InferenceServerMgr::Singleton()->GetServer(request->job_name()));
+      return server->Infer(*request, &future);
+    }());
+    if (!maybe_ok.IsOk()) {
+      return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT,
+                          maybe_ok.error()->DebugString());
+    }
+    *response = future.get();
+    return grpc::Status::OK;
+  }
+};
+
+struct GrpcServerHolder {
+  std::unique_ptr<InferenceGrpcService> service;
+  std::unique_ptr<grpc::Server> server;
+  ~GrpcServerHolder() {
+    if (server) { server->Shutdown(); }
+  }
+};
+
+}  // namespace
+
+InferenceServer::InferenceServer(const std::string& job_name, int64_t max_batch_size,
+                                 int64_t batch_timeout_us)
+    : job_name_(job_name),
+      max_batch_size_(max_batch_size),
+      batch_timeout_us_(batch_timeout_us),
+      job_batch_size_(-1),
+      queued_batch_size_(0),
+      closed_(false) {
+  CHECK(GlobalProcessCtx::IsThisProcessMaster());
+  CHECK_NOTNULL(Global<Oneflow>::Get());
+  CHECK_GT(max_batch_size_, 0);
+  CHECK_GE(batch_timeout_us_, 0);
+  auto* job_ctx = CHECK_JUST(GetJobBuildAndInferCtx(job_name_));
+  const auto& inter_user_job_info = *Global<InterUserJobInfo>::Get();
+  for (const auto& pair : inter_user_job_info.input_or_var_op_name2push_job_name()) {
+    const std::string lbn = pair.first + "/out";
+    InputDesc* desc = &input_name2desc_[pair.first];
+    desc->static_shape = *CHECK_JUST(job_ctx->GetStaticShape(lbn));
+    desc->data_type = CHECK_JUST(job_ctx->GetDataType(lbn));
+    desc->is_dynamic = CHECK_JUST(job_ctx->IsDynamic(lbn));
+    desc->push_job_name = pair.second;
+    CHECK_GT(desc->static_shape.NumAxes(), 0) << "input " << pair.first << " has no batch axis";
+    if (job_batch_size_ == -1) { job_batch_size_ = desc->static_shape.At(0); }
+    CHECK_EQ(desc->static_shape.At(0), job_batch_size_) << "input " << pair.first;
+    desc->buffer.resize(desc->static_shape.elem_cnt() * GetSizeOfDataType(desc->data_type));
+  }
+  for (const auto& pair : inter_user_job_info.output_or_var_op_name2pull_job_name()) {
+    output_name2pull_job_name_.emplace(pair.first, pair.second);
+  }
+  CHECK_GT(job_batch_size_, 0) << "job " << job_name_ << " has no input";
+  // a batch never exceeds the static batch of the job
+  max_batch_size_ = std::min(max_batch_size_, job_batch_size_);
+  batch_thread_ = std::thread(&InferenceServer::BatchLoop, this);
+}
+
+InferenceServer::~InferenceServer() {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    closed_ = true;
+  }
+  cond_.notify_all();
+  batch_thread_.join();
+}
+
+Maybe<void> InferenceServer::Infer(const InferRequest& request,
+                                   std::future<InferResponse>* response) {
+  std::unique_ptr<Request> req(new Request());
+  req->request = request;
+  req->batch_size = -1;
+  for (const auto& input : req->request.input()) {
+    const auto& it = input_name2desc_.find(input.name());
+    CHECK_OR_RETURN(it != input_name2desc_.end()) << "unknown input " << input.name();
+    CHECK_OR_RETURN(req->name2input.emplace(input.name(), &input).second)
+        << "duplicated input " << input.name();
+    const InputDesc& desc = it->second;
+    CHECK_EQ_OR_RETURN(input.data_type(), desc.data_type) << "input " << input.name();
+    CHECK_EQ_OR_RETURN(input.dim_size(), desc.static_shape.NumAxes()) << "input " << input.name();
+    int64_t elem_cnt = 1;
+    FOR_RANGE(int64_t, i, 0, input.dim_size()) {
+      if (i > 0) {
+        CHECK_EQ_OR_RETURN(input.dim(i), desc.static_shape.At(i)) << "input " << input.name();
+      }
+      elem_cnt *= input.dim(i);
+    }
+    CHECK_EQ_OR_RETURN(input.data().size(), elem_cnt * GetSizeOfDataType(desc.data_type))
+        << "input " << input.name();
+    if (req->batch_size == -1) { req->batch_size = input.dim(0); }
+    CHECK_EQ_OR_RETURN(input.dim(0), req->batch_size) << "inconsistent batch of inputs";
+  }
+  CHECK_EQ_OR_RETURN(req->name2input.size(), input_name2desc_.size()) << "absent inputs";
+  CHECK_GT_OR_RETURN(req->batch_size, 0);
+  CHECK_LE_OR_RETURN(req->batch_size, max_batch_size_);
+  *response = req->response.get_future();
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    CHECK_OR_RETURN(!closed_);
+    req->enqueue_time = std::chrono::steady_clock::now();
+    queued_batch_size_ += req->batch_size;
+    requests_.emplace_back(std::move(req));
+  }
+  cond_.notify_one();
+  return Maybe<void>::Ok();
+}
+
+void InferenceServer::BatchLoop() {
+  while (true) {
+    std::vector<std::unique_ptr<Request>> batch;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cond_.wait(lock, [this]() { return closed_ || !requests_.empty(); });
+      if (requests_.empty()) { return; }
+      const auto deadline =
+          requests_.front()->enqueue_time + std::chrono::microseconds(batch_timeout_us_);
+      cond_.wait_until(lock, deadline,
+                       [this]() { return closed_ || queued_batch_size_ >= max_batch_size_; });
+      int64_t batch_size = 0;
+      while (!requests_.empty()
+             && batch_size + requests_.front()->batch_size <= max_batch_size_) {
+        batch_size += requests_.front()->batch_size;
+        queued_batch_size_ -= requests_.front()->batch_size;
+        batch.emplace_back(std::move(requests_.front()));
+        requests_.pop_front();
+      }
+    }
+    RunBatch(batch);
+  }
+}
+
+void InferenceServer::RunBatch(const std::vector<std::unique_ptr<Request>>& batch) {
+  int64_t batch_size = 0;
+  for (const auto& req : batch) { batch_size += req->batch_size; }
+  std::vector<InferResponse> responses(batch.size());
+  // the pull jobs run concurrently
+  std::mutex responses_mutex;
+  BlockingCounter counter(input_name2desc_.size() + 1 + output_name2pull_job_name_.size());
+  const auto& finish_cb = [&counter]() { counter.Decrease(); };
+  for (auto& pair : input_name2desc_) {
+    const std::string& input_name = pair.first;
+    InputDesc* desc = &pair.second;
+    size_t offset = 0;
+    for (const auto& req : batch) {
+      const std::string& data = req->name2input.at(input_name)->data();
+      std::memcpy(&desc->buffer[0] + offset, data.data(), data.size());
+      offset += data.size();
+    }
+    DimVector dim_vec = desc->static_shape.dim_vec();
+    if (desc->is_dynamic) {
+      dim_vec.at(0) = batch_size;
+    } else {
+      std::memset(&desc->buffer[0] + offset, 0, desc->buffer.size() - offset);
+    }
+    const auto& push_cb = [desc, dim_vec](OfBlob* of_blob) {
+      CopyToOfBlob(of_blob, desc->buffer.data(), dim_vec);
+    };
+    LaunchServingJob(std::make_shared<ServingJobInstance>(desc->push_job_name, push_cb, nullptr,
+                                                          finish_cb));
+  }
+  LaunchServingJob(std::make_shared<ServingJobInstance>(job_name_, nullptr, nullptr, finish_cb));
+  for (const auto& pair : output_name2pull_job_name_) {
+    const std::string& output_name = pair.first;
+    const auto& pull_cb = [&](OfBlob* of_blob) {
+      ServingTensor whole;
+      whole.set_name(output_name);
+      CopyFromOfBlob(of_blob, &whole);
+      const int64_t dim0 = whole.dim_size() > 0 ? whole.dim(0) : -1;
+      std::unique_lock<std::mutex> lock(responses_mutex);
+      if (dim0 != batch_size && dim0 != job_batch_size_) {
+        // not batched, every request gets the whole output
+        for (auto& response : responses) { *response.add_output() = whole; }
+        return;
+      }
+      const size_t row_bytes = whole.data().size() / dim0;
+      size_t offset = 0;
+      FOR_RANGE(int64_t, i, 0, batch.size()) {
+        ServingTensor* output = responses.at(i).add_output();
+        output->set_name(output_name);
+        output->set_data_type(whole.data_type());
+        output->add_dim(batch.at(i)->batch_size);
+        FOR_RANGE(int64_t, j, 1, whole.dim_size()) { output->add_dim(whole.dim(j)); }
+        const size_t size = row_bytes * batch.at(i)->batch_size;
+        output->set_data(whole.data().data() + offset, size);
+        offset += size;
+      }
+    };
+    LaunchServingJob(
+        std::make_shared<ServingJobInstance>(pair.second, nullptr, pull_cb, finish_cb));
+  }
+  counter.WaitUntilCntEqualZero();
+  FOR_RANGE(int64_t, i, 0, batch.size()) {
+    batch.at(i)->response.set_value(std::move(responses.at(i)));
+  }
+}
+
+InferenceServerMgr* InferenceServerMgr::Singleton() {
+  static InferenceServerMgr mgr;
+  return &mgr;
+}
+
+Maybe<void> InferenceServerMgr::AddServer(const std::string& job_name, int64_t max_batch_size,
+                                          int64_t batch_timeout_us) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  CHECK_OR_RETURN(job_name2server_.find(job_name) == job_name2server_.end())
+      << "job " << job_name << " is being served";
+  job_name2server_.emplace(job_name,
+                           std::unique_ptr<InferenceServer>(new InferenceServer(
+                               job_name, max_batch_size, batch_timeout_us)));
+  return Maybe<void>::Ok();
+}
+
+Maybe<InferenceServer*> InferenceServerMgr::GetServer(const std::string& job_name) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  const auto& it = job_name2server_.find(job_name);
+  CHECK_OR_RETURN(it != job_name2server_.end()) << "job " << job_name << " is not served";
+  return it->second.get();
+}
+
+Maybe<void> InferenceServerMgr::StartGrpcServer(const std::string& address) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  CHECK_OR_RETURN(!grpc_server_) << "grpc server started";
+  std::shared_ptr<GrpcServerHolder> holder(new GrpcServerHolder());
+  holder->service.reset(new InferenceGrpcService());
+  grpc::ServerBuilder server_builder;
+  server_builder.SetMaxMessageSize(INT_MAX);
+  server_builder.AddListeningPort(address, grpc::InsecureServerCredentials());
+  server_builder.RegisterService(holder->service.get());
+  holder->server = server_builder.BuildAndStart();
+  CHECK_OR_RETURN(holder->server) << "failed to listen on " << address;
+  grpc_server_ = holder;
+  return Maybe<void>::Ok();
+}
+
+void InferenceServerMgr::Clear() {
+  std::shared_ptr<void> grpc_server;
+  HashMap<std::string, std::unique_ptr<InferenceServer>> job_name2server;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    grpc_server.swap(grpc_server_);
+    job_name2server.swap(job_name2server_);
+  }
+  // the grpc server stops first since its handlers call the servers
+  grpc_server.reset();
+  job_name2server.clear();
+}
+
+}  // namespace oneflow
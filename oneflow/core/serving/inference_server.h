@@ -0,0 +1,108 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_SERVING_INFERENCE_SERVER_H_
+#define ONEFLOW_CORE_SERVING_INFERENCE_SERVER_H_
+
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+#include "oneflow/core/common/util.h"
+#include "oneflow/core/common/maybe.h"
+#include "oneflow/core/common/shape.h"
+#include "oneflow/core/serving/serving_service.pb.h"
+
+namespace oneflow {
+
+// Serves an inference job of the running lazy session, for example one of a SavedModel loaded by
+// the python InferenceSession. Concurrent requests are batched on axis 0 up to max_batch_size
+// rows, or for at most batch_timeout_us after the first request of a batch arrives, and each batch
+// runs the push jobs, the job and the pull jobs once. The other axes of an input must match the
+// job. Inputs with a static batch are padded, and outputs with the batch of the job are split
+// back to the requests, the other outputs are returned to every request as a whole.
+class InferenceServer final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(InferenceServer);
+  InferenceServer(const std::string& job_name, int64_t max_batch_size, int64_t batch_timeout_us);
+  ~InferenceServer();
+
+  const std::string& job_name() const { return job_name_; }
+  // Thread safe
+  Maybe<void> Infer(const InferRequest& request, std::future<InferResponse>* response);
+
+ private:
+  struct InputDesc {
+    Shape static_shape;
+    DataType data_type;
+    bool is_dynamic;
+    std::string push_job_name;
+    // reused by the batches
+    std::string buffer;
+  };
+  struct Request {
+    HashMap<std::string, const ServingTensor*> name2input;
+    InferRequest request;
+    int64_t batch_size;
+    std::promise<InferResponse> response;
+    std::chrono::steady_clock::time_point enqueue_time;
+  };
+
+  void BatchLoop();
+  void RunBatch(const std::vector<std::unique_ptr<Request>>& batch);
+
+  const std::string job_name_;
+  int64_t max_batch_size_;
+  // static size of axis 0 of the inputs
+  int64_t job_batch_size_;
+  const int64_t batch_timeout_us_;
+  std::map<std::string, InputDesc> input_name2desc_;
+  std::map<std::string, std::string> output_name2pull_job_name_;
+
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  std::deque<std::unique_ptr<Request>> requests_;
+  int64_t queued_batch_size_;
+  bool closed_;
+  std::thread batch_thread_;
+};
+
+// Process wide registry of the servers, looked up by job name by the gRPC service
+class InferenceServerMgr final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(InferenceServerMgr);
+  InferenceServerMgr() = default;
+  ~InferenceServerMgr() = default;
+
+  static InferenceServerMgr* Singleton();
+
+  Maybe<void> AddServer(const std::string& job_name, int64_t max_batch_size,
+                        int64_t batch_timeout_us);
+  Maybe<InferenceServer*> GetServer(const std::string& job_name);
+  // Serves InferRequest through gRPC on `address', e.g. "0.0.0.0:8500"
+  Maybe<void> StartGrpcServer(const std::string& address);
+  // Stops the gRPC server and destroys the servers
+  void Clear();
+
+ private:
+  std::mutex mutex_;
+  HashMap<std::string, std::unique_ptr<InferenceServer>> job_name2server_;
+  std::shared_ptr<void> grpc_server_;
+};
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_SERVING_INFERENCE_SERVER_H_
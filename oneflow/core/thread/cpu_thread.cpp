@@ -15,6 +15,7 @@ limitations under the License.
 */
 #include "oneflow/core/thread/cpu_thread.h"
 #include "oneflow/core/thread/thread_manager.h"
+#include "oneflow/core/thread/thread_affinity.h"
 #include "oneflow/core/profiler/profiler.h"
 #include "oneflow/core/graph/id_serialization.h"
 
@@ -23,6 +24,7 @@ namespace oneflow {
 CpuThread::CpuThread(int64_t thrd_id) {
   set_thrd_id(thrd_id);
   mut_actor_thread() = std::thread([this, thrd_id]() {
+    BindCurrentThreadToRoleCores(ThreadRole::kActor);
     OF_PROFILER_NAME_THIS_HOST_THREAD("CPU Actor : (" + std::to_string(thrd_id) + ")");
     ThreadCtx ctx;
 #ifdef WITH_CUDA
@@ -18,6 +18,7 @@ limitations under the License.
 #include "oneflow/core/device/cuda_stream_handle.h"
 #include "oneflow/core/profiler/profiler.h"
 #include "oneflow/core/graph/id_serialization.h"
+#include "oneflow/core/thread/thread_affinity.h"
 #include "oneflow/core/device/node_device_descriptor_manager.h"
 #include "oneflow/core/device/cuda_device_descriptor.h"
 
@@ -28,12 +29,16 @@ namespace oneflow {
 namespace {
 
 void SetAffinityByDevice(int64_t dev_id) {
+  // the cores configured for actor threads take precedence over the cores near the device
+  BindCurrentThreadToRoleCores(ThreadRole::kActor);
   auto node_device_desc =
       Global<device::NodeDeviceDescriptorManager>::Get()->GetLocalNodeDeviceDescriptor();
   auto cuda_device = std::dynamic_pointer_cast<const device::CudaDeviceDescriptor>(
       node_device_desc->GetDevice(device::kCudaDeviceDescriptorClassName, dev_id));
   if (!cuda_device) { return; }
-  node_device_desc->Topology()->SetCPUAffinityByPCIBusID(cuda_device->PCIBusID());
+  if (!RoleCoresConfigured(ThreadRole::kActor)) {
+    node_device_desc->Topology()->SetCPUAffinityByPCIBusID(cuda_device->PCIBusID());
+  }
   node_device_desc->Topology()->SetMemoryAffinityByPCIBusID(cuda_device->PCIBusID());
 }
 
@@ -46,6 +51,7 @@ GpuThread::GpuThread(int64_t thrd_id, int64_t dev_id) {
     OF_PROFILER_NAME_THIS_HOST_THREAD("GPU " + std::to_string(dev_id) + " Actor : ("
                                       + std::to_string(thrd_id) + ")");
     OF_CUDA_CHECK(cudaSetDevice(dev_id));
+    EnableCudaPeerAccessFromCurrentDevice();
     ThreadCtx ctx;
     ctx.g_cuda_stream.reset(new CudaStreamHandle(&cb_event_chan_));
     ctx.cb_event_chan = &cb_event_chan_;
@@ -21,12 +21,26 @@ limitations under the License.
 
 namespace oneflow {
 
+Thread::Thread()
+    : enable_priority_dispatch_(
+        Global<ResourceDesc, ForSession>::Get()->thread_enable_priority_dispatch()),
+      msg_seq_(0),
+      queue_depth_gauge_(nullptr) {}
+
 Thread::~Thread() {
   actor_thread_.join();
   CHECK(id2task_.empty());
   msg_channel_.Close();
 }
 
+void Thread::set_thrd_id(int64_t val) {
+  thrd_id_ = val;
+  queue_depth_gauge_ =
+      profiler::GetGauge("oneflow_actor_thread_queue_depth",
+                         "actor messages waiting to be processed by an actor thread",
+                         {{"thread", std::to_string(val)}});
+}
+
 void Thread::AddTask(const TaskProto& task) {
   std::unique_lock<std::mutex> lck(id2task_mtx_);
   CHECK(id2task_.emplace(task.task_id(), task).second);
@@ -35,7 +49,7 @@ void Thread::AddTask(const TaskProto& task) {
 void Thread::EnqueueActorMsg(const ActorMsg& msg) {
   if (Global<ResourceDesc, ForSession>::Get()->thread_enable_local_message_queue()
       && std::this_thread::get_id() == actor_thread_.get_id()) {
-    local_msg_queue_.push(msg);
+    PushLocalMsg(msg);
   } else {
     msg_channel_.Send(msg);
   }
@@ -43,11 +57,13 @@ void Thread::EnqueueActorMsg(const ActorMsg& msg) {
 
 void Thread::PollMsgChannel(const ThreadCtx& thread_ctx) {
   while (true) {
-    if (local_msg_queue_.empty()) {
-      CHECK_EQ(msg_channel_.ReceiveMany(&local_msg_queue_), kChannelStatusSuccess);
+    if (IsLocalMsgQueueEmpty()) {
+      CHECK_EQ(msg_channel_.ReceiveMany(&received_msgs_), kChannelStatusSuccess);
+      for (ActorMsg& received_msg : received_msgs_) { PushLocalMsg(received_msg); }
+      received_msgs_.clear();
     }
-    ActorMsg msg = std::move(local_msg_queue_.front());
-    local_msg_queue_.pop();
+    ActorMsg msg = PopLocalMsg();
+    queue_depth_gauge_->Set(LocalMsgQueueSize());
     if (msg.msg_type() == ActorMsgType::kCmdMsg) {
       if (msg.actor_cmd() == ActorCmd::kStopThread) {
         CHECK(id2actor_ptr_.empty());
@@ -67,6 +83,7 @@ void Thread::PollMsgChannel(const ThreadCtx& thread_ctx) {
       LOG(INFO) << "thread " << thrd_id_ << " deconstruct actor " << actor_id;
       int64_t job_id = actor_it->second->job_id();
       id2actor_ptr_.erase(actor_it);
+      actor_id2schedule_priority_.erase(actor_id);
       Global<RuntimeCtx>::Get()->DecreaseCounter(GetRunningActorCountKeyByJobId(job_id));
     } else {
       CHECK_EQ(process_msg_ret, 0);
@@ -79,8 +96,40 @@ void Thread::ConstructActor(int64_t actor_id, const ThreadCtx& thread_ctx) {
   std::unique_lock<std::mutex> lck(id2task_mtx_);
   auto task_it = id2task_.find(actor_id);
   CHECK(id2actor_ptr_.emplace(actor_id, NewActor(task_it->second, thread_ctx)).second);
+  actor_id2schedule_priority_[actor_id] = task_it->second.schedule_priority();
   id2task_.erase(task_it);
   Global<RuntimeCtx>::Get()->DecreaseCounter("constructing_actor_cnt");
 }
 
+void Thread::PushLocalMsg(const ActorMsg& msg) {
+  if (!enable_priority_dispatch_) {
+    local_msg_queue_.push(msg);
+    return;
+  }
+  // the commands to the actors not constructed yet go first
+  int64_t priority = std::numeric_limits<int64_t>::max();
+  auto priority_it = actor_id2schedule_priority_.find(msg.dst_actor_id());
+  if (priority_it != actor_id2schedule_priority_.end()) { priority = priority_it->second; }
+  prioritized_msg_queue_.push({priority, msg_seq_++, msg});
+}
+
+ActorMsg Thread::PopLocalMsg() {
+  if (!enable_priority_dispatch_) {
+    ActorMsg msg = std::move(local_msg_queue_.front());
+    local_msg_queue_.pop();
+    return msg;
+  }
+  ActorMsg msg = prioritized_msg_queue_.top().msg;
+  prioritized_msg_queue_.pop();
+  return msg;
+}
+
+bool Thread::IsLocalMsgQueueEmpty() const {
+  return enable_priority_dispatch_ ? prioritized_msg_queue_.empty() : local_msg_queue_.empty();
+}
+
+size_t Thread::LocalMsgQueueSize() const {
+  return enable_priority_dispatch_ ? prioritized_msg_queue_.size() : local_msg_queue_.size();
+}
+
 }  // namespace oneflow
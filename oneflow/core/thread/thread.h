@@ -18,10 +18,12 @@ limitations under the License.
 
 #include "oneflow/core/actor/actor_message_bus.h"
 #include "oneflow/core/common/channel.h"
+#include "oneflow/core/common/mpsc_ring_channel.h"
 #include "oneflow/core/common/util.h"
 #include "oneflow/core/job/task.pb.h"
 #include "oneflow/core/thread/thread_context.h"
 #include "oneflow/core/actor/actor.h"
+#include "oneflow/core/profiler/metrics.h"
 
 namespace oneflow {
 
@@ -32,29 +34,51 @@ class Thread {
 
   void AddTask(const TaskProto&);
 
-  Channel<ActorMsg>* GetMsgChannelPtr() { return &msg_channel_; }
+  MpscRingChannel<ActorMsg>* GetMsgChannelPtr() { return &msg_channel_; }
   void EnqueueActorMsg(const ActorMsg& msg);
 
   void JoinAllActor() { actor_thread_.join(); }
 
  protected:
-  Thread() = default;
+  Thread();
   std::thread& mut_actor_thread() { return actor_thread_; }
   void PollMsgChannel(const ThreadCtx& thread_ctx);
-  void set_thrd_id(int64_t val) { thrd_id_ = val; }
+  void set_thrd_id(int64_t val);
 
  private:
   void ConstructActor(int64_t actor_id, const ThreadCtx& thread_ctx);
+  void PushLocalMsg(const ActorMsg& msg);
+  ActorMsg PopLocalMsg();
+  bool IsLocalMsgQueueEmpty() const;
+  size_t LocalMsgQueueSize() const;
+
+  // with priority dispatch the messages to the actors of higher schedule priorities go first, and
+  // the messages to one actor keep their order
+  struct PrioritizedActorMsg {
+    int64_t priority;
+    int64_t seq;
+    ActorMsg msg;
+    bool operator<(const PrioritizedActorMsg& rhs) const {
+      return priority < rhs.priority || (priority == rhs.priority && seq > rhs.seq);
+    }
+  };
 
   HashMap<int64_t, TaskProto> id2task_;
   std::mutex id2task_mtx_;
 
   std::thread actor_thread_;
-  Channel<ActorMsg> msg_channel_;
+  MpscRingChannel<ActorMsg> msg_channel_;
   HashMap<int64_t, std::unique_ptr<Actor>> id2actor_ptr_;
   std::queue<ActorMsg> local_msg_queue_;
+  std::vector<ActorMsg> received_msgs_;
+  const bool enable_priority_dispatch_;
+  HashMap<int64_t, int64_t> actor_id2schedule_priority_;
+  std::priority_queue<PrioritizedActorMsg> prioritized_msg_queue_;
+  int64_t msg_seq_;
 
   int64_t thrd_id_;
+  // messages taken from msg_channel_ but not processed yet
+  profiler::Gauge* queue_depth_gauge_;
 };
 
 }  // namespace oneflow
@@ -0,0 +1,98 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/thread/thread_affinity.h"
+#include "oneflow/core/common/util.h"
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif  // __linux__
+
+namespace oneflow {
+
+namespace {
+
+constexpr int kThreadRoleNum = 5;
+
+const char* RoleName(ThreadRole role) {
+  static const char* names[kThreadRoleNum] = {"ACTOR", "VM", "COMM", "DATA", "INTRA_OP"};
+  return names[static_cast<int>(role)];
+}
+
+std::vector<int> ParseCoreList(const std::string& core_list) {
+  std::vector<int> cores;
+  std::stringstream ss(core_list);
+  std::string item;
+  while (std::getline(ss, item, ',')) {
+    if (item.empty()) { continue; }
+    const size_t dash = item.find('-');
+    const int first = std::stoi(item.substr(0, dash));
+    const int last = dash == std::string::npos ? first : std::stoi(item.substr(dash + 1));
+    CHECK_LE(first, last) << "invalid core list " << core_list;
+    for (int core = first; core <= last; ++core) { cores.push_back(core); }
+  }
+  return cores;
+}
+
+const std::vector<int>& RoleCores(ThreadRole role) {
+  static const std::vector<std::vector<int>> role2cores = [] {
+    std::vector<std::vector<int>> ret(kThreadRoleNum);
+    FOR_RANGE(int, i, 0, kThreadRoleNum) {
+      const char* env = std::getenv(
+          (std::string("ONEFLOW_CPU_CORES_") + RoleName(static_cast<ThreadRole>(i))).c_str());
+      if (env != nullptr) { ret.at(i) = ParseCoreList(env); }
+    }
+    return ret;
+  }();
+  return role2cores.at(static_cast<int>(role));
+}
+
+}  // namespace
+
+bool RoleCoresConfigured(ThreadRole role) { return !RoleCores(role).empty(); }
+
+void BindCurrentThreadToRoleCores(ThreadRole role) {
+  const std::vector<int>& cores = RoleCores(role);
+  if (cores.empty()) { return; }
+#ifdef __linux__
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  for (int core : cores) { CPU_SET(core, &cpu_set); }
+  const int err = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpu_set);
+  if (err != 0) { LOG(WARNING) << "failed to bind " << RoleName(role) << " thread, " << err; }
+#endif  // __linux__
+}
+
+void LogThreadRoleCores() {
+  HashMap<int, std::string> core2role;
+  FOR_RANGE(int, i, 0, kThreadRoleNum) {
+    const auto role = static_cast<ThreadRole>(i);
+    const std::vector<int>& cores = RoleCores(role);
+    if (cores.empty()) { continue; }
+    std::string cores_str;
+    for (int core : cores) {
+      if (!cores_str.empty()) { cores_str += ","; }
+      cores_str += std::to_string(core);
+      const auto& pair = core2role.emplace(core, RoleName(role));
+      if (!pair.second) {
+        LOG(WARNING) << "core " << core << " is shared by " << pair.first->second << " and "
+                     << RoleName(role) << " threads";
+      }
+    }
+    LOG(INFO) << RoleName(role) << " threads are bound to cores " << cores_str;
+  }
+}
+
+}  // namespace oneflow
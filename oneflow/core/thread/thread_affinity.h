@@ -0,0 +1,35 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_THREAD_THREAD_AFFINITY_H_
+#define ONEFLOW_CORE_THREAD_THREAD_AFFINITY_H_
+
+namespace oneflow {
+
+enum class ThreadRole { kActor = 0, kVm, kComm, kData, kIntraOp };
+
+// The cores of each role are read from ONEFLOW_CPU_CORES_ACTOR, ONEFLOW_CPU_CORES_VM,
+// ONEFLOW_CPU_CORES_COMM, ONEFLOW_CPU_CORES_DATA and ONEFLOW_CPU_CORES_INTRA_OP, as core lists
+// like "0-3,8". A thread whose role has no cores configured keeps its affinity.
+void BindCurrentThreadToRoleCores(ThreadRole role);
+
+bool RoleCoresConfigured(ThreadRole role);
+
+// Logs the core partition, and warns about roles sharing cores.
+void LogThreadRoleCores();
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_THREAD_THREAD_AFFINITY_H_
@@ -29,7 +29,7 @@ class Plan;
 class ThreadMgr final {
  public:
   OF_DISALLOW_COPY_AND_MOVE(ThreadMgr);
-  ThreadMgr() = default;
+  ThreadMgr();
   ~ThreadMgr();
 
   void AddPlan(const Plan& plan);
@@ -14,31 +14,173 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #include "oneflow/core/thread/thread_pool.h"
+#include "oneflow/core/thread/thread_affinity.h"
+#include "oneflow/core/common/balanced_splitter.h"
+#include "oneflow/core/common/blocking_counter.h"
 
 namespace oneflow {
 
+namespace {
+
+const int32_t kSpinCntBeforePark = 64;
+const int64_t kChunkNumPerThread = 4;
+
+struct WorkerContext final {
+  const ThreadPool* pool;
+  int32_t worker_id;
+  uint32_t random_state;
+};
+
+WorkerContext* MutWorkerContext() {
+  static thread_local WorkerContext ctx = {nullptr, -1, 0};
+  return &ctx;
+}
+
+uint32_t NextRandom(uint32_t* state) {
+  // xorshift32
+  uint32_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  *state = x;
+  return x;
+}
+
+}  // namespace
+
 ThreadPool::ThreadPool(int32_t thread_num)
-    : work_chans_(thread_num), threads_(thread_num), work_cnt_(0) {
+    : pending_work_cnt_(0), parked_worker_cnt_(0), is_closed_(false), threads_(thread_num) {
+  FOR_RANGE(int32_t, i, 0, thread_num) {
+    worker_deques_.emplace_back(new WorkStealingDeque<Work>());
+  }
   FOR_RANGE(int32_t, i, 0, thread_num) {
-    Channel<std::function<void()>>* chan = &(work_chans_.at(i));
-    threads_[i] = std::thread([chan]() {
-      std::function<void()> work;
-      while (chan->Receive(&work) == kChannelStatusSuccess) { work(); }
+    threads_[i] = std::thread([this, i]() {
+      BindCurrentThreadToRoleCores(ThreadRole::kIntraOp);
+      WorkerLoop(i);
     });
   }
 }
 
 ThreadPool::~ThreadPool() {
-  FOR_RANGE(int32_t, i, 0, work_chans_.size()) {
-    work_chans_.at(i).Close();
-    threads_.at(i).join();
+  {
+    std::unique_lock<std::mutex> lock(park_mutex_);
+    is_closed_ = true;
+    park_cond_.notify_all();
   }
+  for (auto& thread : threads_) { thread.join(); }
+  for (Work* work : injection_queue_) { delete work; }
 }
 
 void ThreadPool::AddWork(const std::function<void()>& work) {
-  const size_t cur_chan_idx =
-      work_cnt_.fetch_add(1, std::memory_order_relaxed) % work_chans_.size();
-  work_chans_.at(cur_chan_idx).Send(work);
+  Work* new_work = new Work(work);
+  WorkerContext* ctx = MutWorkerContext();
+  if (ctx->pool == this) {
+    worker_deques_.at(ctx->worker_id)->Push(new_work);
+  } else {
+    std::unique_lock<std::mutex> lock(injection_mutex_);
+    injection_queue_.push_back(new_work);
+  }
+  // pairs with the seq_cst increment of parked_worker_cnt_ in WorkerLoop, so that either the
+  // worker sees the new work or this thread sees the parked worker
+  pending_work_cnt_.fetch_add(1);
+  if (parked_worker_cnt_.load() > 0) {
+    std::unique_lock<std::mutex> lock(park_mutex_);
+    park_cond_.notify_one();
+  }
+}
+
+void ThreadPool::WorkerLoop(int32_t worker_id) {
+  WorkerContext* ctx = MutWorkerContext();
+  ctx->pool = this;
+  ctx->worker_id = worker_id;
+  ctx->random_state = 2654435761U * (worker_id + 1);
+  while (true) {
+    Work* work = TryGetWork(worker_id);
+    for (int32_t i = 0; work == nullptr && i < kSpinCntBeforePark; ++i) {
+      std::this_thread::yield();
+      work = TryGetWork(worker_id);
+    }
+    if (work != nullptr) {
+      pending_work_cnt_.fetch_sub(1);
+      (*work)();
+      delete work;
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(park_mutex_);
+    parked_worker_cnt_.fetch_add(1);
+    park_cond_.wait(lock, [this]() { return pending_work_cnt_.load() > 0 || is_closed_; });
+    parked_worker_cnt_.fetch_sub(1);
+    // remaining works are done before the pool is destructed
+    if (is_closed_ && pending_work_cnt_.load() <= 0) { break; }
+  }
+}
+
+ThreadPool::Work* ThreadPool::TryGetWork(int32_t worker_id) {
+  Work* work = worker_deques_.at(worker_id)->Pop();
+  if (work != nullptr) { return work; }
+  {
+    std::unique_lock<std::mutex> lock(injection_mutex_);
+    if (!injection_queue_.empty()) {
+      work = injection_queue_.front();
+      injection_queue_.pop_front();
+      return work;
+    }
+  }
+  return TryStealWork(worker_id);
+}
+
+ThreadPool::Work* ThreadPool::TryStealWork(int32_t worker_id) {
+  const int32_t deque_num = worker_deques_.size();
+  if (deque_num <= 1) { return nullptr; }
+  const int32_t offset = NextRandom(&MutWorkerContext()->random_state) % deque_num;
+  FOR_RANGE(int32_t, i, 0, deque_num) {
+    const int32_t victim = (offset + i) % deque_num;
+    if (victim == worker_id) { continue; }
+    Work* work = worker_deques_.at(victim)->Steal();
+    if (work != nullptr) { return work; }
+  }
+  return nullptr;
+}
+
+void ThreadPool::ParallelFor(const Range& range, int64_t grain_size,
+                             const std::function<void(const Range&)>& Callback) {
+  if (range.size() <= 0) { return; }
+  grain_size = std::max<int64_t>(grain_size, 1);
+  const int64_t chunk_num = std::min<int64_t>((range.size() + grain_size - 1) / grain_size,
+                                              thread_num() * kChunkNumPerThread);
+  if (chunk_num <= 1) {
+    Callback(range);
+    return;
+  }
+  struct ParallelForContext final {
+    ParallelForContext(const Range& r, int64_t n, const std::function<void(const Range&)>* cb)
+        : range(r), chunk_num(n), splitter(r.size(), n), Callback(cb), next_chunk(0), bc(n) {}
+
+    // Callback is only called on unfinished chunks, so it is alive while being used
+    void RunChunks() {
+      while (true) {
+        const int64_t chunk_id = next_chunk.fetch_add(1);
+        if (chunk_id >= chunk_num) { break; }
+        const Range chunk = splitter.At(chunk_id);
+        (*Callback)(Range(range.begin() + chunk.begin(), range.begin() + chunk.end()));
+        bc.Decrease();
+      }
+    }
+
+    const Range range;
+    const int64_t chunk_num;
+    const BalancedSplitter splitter;
+    const std::function<void(const Range&)>* Callback;
+    std::atomic<int64_t> next_chunk;
+    BlockingCounter bc;
+  };
+  std::shared_ptr<ParallelForContext> ctx(new ParallelForContext(range, chunk_num, &Callback));
+  const int64_t helper_num = std::min<int64_t>(chunk_num - 1, thread_num());
+  FOR_RANGE(int64_t, i, 0, helper_num) {
+    AddWork([ctx]() { ctx->RunChunks(); });
+  }
+  ctx->RunChunks();
+  ctx->bc.WaitUntilCntEqualZero();
 }
 
 }  // namespace oneflow
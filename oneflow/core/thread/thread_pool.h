@@ -17,10 +17,14 @@ limitations under the License.
 #define ONEFLOW_CORE_THREAD_THREAD_POOL_H_
 
 #include "oneflow/core/common/util.h"
-#include "oneflow/core/common/channel.h"
+#include "oneflow/core/common/range.h"
+#include "oneflow/core/thread/work_stealing_deque.h"
 
 namespace oneflow {
 
+// Work stealing thread pool. Works added by a worker of this pool go to the deque of that worker,
+// works added by other threads go to a shared injection queue. Idle workers steal from the
+// deques of the others, spin for a while and then park on a condition variable.
 class ThreadPool final {
  public:
   OF_DISALLOW_COPY_AND_MOVE(ThreadPool);
@@ -31,11 +35,32 @@ class ThreadPool final {
   int32_t thread_num() const { return threads_.size(); }
   void AddWork(const std::function<void()>& work);
 
+  // Splits `range' into chunks of at least `grain_size' elements and calls `Callback' on the
+  // chunks in parallel. The calling thread runs chunks too, so ParallelFor may be called inside a
+  // work of this pool. Returns after all chunks are done.
+  void ParallelFor(const Range& range, int64_t grain_size,
+                   const std::function<void(const Range&)>& Callback);
+
  private:
-  std::vector<Channel<std::function<void()>>> work_chans_;
-  std::vector<std::thread> threads_;
+  using Work = std::function<void()>;
+
+  void WorkerLoop(int32_t worker_id);
+  // Returns nullptr if no work is found
+  Work* TryGetWork(int32_t worker_id);
+  Work* TryStealWork(int32_t worker_id);
 
-  std::atomic<size_t> work_cnt_;
+  std::vector<std::unique_ptr<WorkStealingDeque<Work>>> worker_deques_;
+  std::mutex injection_mutex_;
+  std::deque<Work*> injection_queue_;
+  // number of works in the injection queue and the worker deques
+  std::atomic<int64_t> pending_work_cnt_;
+
+  std::mutex park_mutex_;
+  std::condition_variable park_cond_;
+  std::atomic<int32_t> parked_worker_cnt_;
+  std::atomic<bool> is_closed_;
+
+  std::vector<std::thread> threads_;
 };
 
 }  // namespace oneflow
@@ -0,0 +1,107 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "gtest/gtest.h"
+#include "oneflow/core/thread/thread_pool.h"
+#include "oneflow/core/common/blocking_counter.h"
+
+namespace oneflow {
+
+namespace test {
+
+TEST(WorkStealingDeque, push_pop_steal) {
+  WorkStealingDeque<int> deque(2);
+  std::vector<int> values(1000);
+  for (int& value : values) { deque.Push(&value); }
+  ASSERT_EQ(deque.Steal(), &values.front());
+  ASSERT_EQ(deque.Pop(), &values.back());
+  int64_t cnt = 2;
+  while (deque.Pop() != nullptr) { ++cnt; }
+  ASSERT_EQ(cnt, values.size());
+  ASSERT_TRUE(deque.empty());
+  ASSERT_EQ(deque.Steal(), nullptr);
+}
+
+TEST(WorkStealingDeque, concurrent_steal) {
+  const int64_t elem_num = 100000;
+  const int32_t thief_num = 4;
+  WorkStealingDeque<int64_t> deque;
+  std::vector<int64_t> values(elem_num);
+  std::vector<std::atomic<int32_t>> visits(elem_num);
+  for (auto& visit : visits) { visit = 0; }
+  std::atomic<bool> done(false);
+  std::vector<std::thread> thieves;
+  for (int32_t i = 0; i < thief_num; ++i) {
+    thieves.emplace_back([&]() {
+      while (!done) {
+        int64_t* value = deque.Steal();
+        if (value != nullptr) { ++visits.at(value - values.data()); }
+      }
+    });
+  }
+  for (int64_t i = 0; i < elem_num; ++i) {
+    deque.Push(&values.at(i));
+    if (i % 3 == 0) {
+      int64_t* value = deque.Pop();
+      if (value != nullptr) { ++visits.at(value - values.data()); }
+    }
+  }
+  while (true) {
+    int64_t* value = deque.Pop();
+    if (value == nullptr) { break; }
+    ++visits.at(value - values.data());
+  }
+  done = true;
+  for (auto& thief : thieves) { thief.join(); }
+  for (auto& visit : visits) { ASSERT_EQ(visit, 1); }
+}
+
+TEST(ThreadPool, nested_add_work) {
+  ThreadPool pool(4);
+  const int32_t work_num = 64;
+  std::atomic<int32_t> sum(0);
+  BlockingCounter bc(work_num * work_num);
+  for (int32_t i = 0; i < work_num; ++i) {
+    pool.AddWork([&]() {
+      for (int32_t j = 0; j < work_num; ++j) {
+        pool.AddWork([&]() {
+          ++sum;
+          bc.Decrease();
+        });
+      }
+    });
+  }
+  bc.WaitUntilCntEqualZero();
+  ASSERT_EQ(sum, work_num * work_num);
+}
+
+TEST(ThreadPool, parallel_for) {
+  ThreadPool pool(4);
+  const int64_t num = 10007;
+  std::vector<std::atomic<int32_t>> visits(num);
+  for (auto& visit : visits) { visit = 0; }
+  pool.ParallelFor(Range(0, num), 16, [&](const Range& range) {
+    ASSERT_GT(range.size(), 0);
+    // nested ParallelFor runs on the calling worker if all workers are busy
+    pool.ParallelFor(range, 1, [&](const Range& sub_range) {
+      for (int64_t i = sub_range.begin(); i < sub_range.end(); ++i) { ++visits.at(i); }
+    });
+  });
+  for (auto& visit : visits) { ASSERT_EQ(visit, 1); }
+}
+
+}  // namespace test
+
+}  // namespace oneflow
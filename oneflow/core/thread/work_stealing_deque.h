@@ -0,0 +1,130 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_THREAD_WORK_STEALING_DEQUE_H_
+#define ONEFLOW_CORE_THREAD_WORK_STEALING_DEQUE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace oneflow {
+
+// Chase-Lev work stealing deque of raw pointers, with the memory orders of "Correct and Efficient
+// Work-Stealing for Weak Memory Models" (Le et al., PPoPP 2013).
+// Only the owner thread may call Push/Pop, while any thread may call Steal. The ring array grows
+// on demand, retired arrays are kept until the deque is destructed since a thief may still read
+// them.
+template<typename T>
+class WorkStealingDeque final {
+ public:
+  WorkStealingDeque(const WorkStealingDeque&) = delete;
+  WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+  explicit WorkStealingDeque(int64_t capacity = 256) : top_(0), bottom_(0) {
+    int64_t aligned_capacity = 1;
+    while (aligned_capacity < capacity) { aligned_capacity <<= 1; }
+    arrays_.emplace_back(new Array(aligned_capacity));
+    array_.store(arrays_.back().get(), std::memory_order_relaxed);
+  }
+  ~WorkStealingDeque() = default;
+
+  // approximate if other threads are running
+  bool empty() const {
+    const int64_t bottom = bottom_.load(std::memory_order_relaxed);
+    const int64_t top = top_.load(std::memory_order_relaxed);
+    return bottom <= top;
+  }
+
+  // owner only
+  void Push(T* elem) {
+    const int64_t bottom = bottom_.load(std::memory_order_relaxed);
+    const int64_t top = top_.load(std::memory_order_acquire);
+    Array* array = array_.load(std::memory_order_relaxed);
+    if (bottom - top > array->capacity - 1) {
+      arrays_.emplace_back(array->Grow(bottom, top));
+      array = arrays_.back().get();
+      array_.store(array, std::memory_order_release);
+    }
+    array->Put(bottom, elem);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom_.store(bottom + 1, std::memory_order_relaxed);
+  }
+
+  // owner only. Returns nullptr if the deque is empty.
+  T* Pop() {
+    const int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+    Array* array = array_.load(std::memory_order_relaxed);
+    bottom_.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t top = top_.load(std::memory_order_relaxed);
+    if (top > bottom) {
+      bottom_.store(bottom + 1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    T* elem = array->Get(bottom);
+    if (top == bottom) {
+      // the last element, race against thieves
+      if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                        std::memory_order_relaxed)) {
+        elem = nullptr;
+      }
+      bottom_.store(bottom + 1, std::memory_order_relaxed);
+    }
+    return elem;
+  }
+
+  // thread safe. Returns nullptr if the deque is empty or another thread wins the race.
+  T* Steal() {
+    int64_t top = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const int64_t bottom = bottom_.load(std::memory_order_acquire);
+    if (top >= bottom) { return nullptr; }
+    Array* array = array_.load(std::memory_order_acquire);
+    T* elem = array->Get(top);
+    if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                      std::memory_order_relaxed)) {
+      return nullptr;
+    }
+    return elem;
+  }
+
+ private:
+  struct Array final {
+    explicit Array(int64_t cap) : capacity(cap), mask(cap - 1), buffer(new std::atomic<T*>[cap]) {}
+
+    T* Get(int64_t i) const { return buffer[i & mask].load(std::memory_order_relaxed); }
+    void Put(int64_t i, T* elem) { buffer[i & mask].store(elem, std::memory_order_relaxed); }
+    Array* Grow(int64_t bottom, int64_t top) const {
+      Array* array = new Array(capacity * 2);
+      for (int64_t i = top; i < bottom; ++i) { array->Put(i, Get(i)); }
+      return array;
+    }
+
+    const int64_t capacity;
+    const int64_t mask;
+    std::unique_ptr<std::atomic<T*>[]> buffer;
+  };
+
+  std::atomic<int64_t> top_;
+  std::atomic<int64_t> bottom_;
+  std::atomic<Array*> array_;
+  // owner only
+  std::vector<std::unique_ptr<Array>> arrays_;
+};
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_THREAD_WORK_STEALING_DEQUE_H_
@@ -24,8 +24,13 @@ Transport::Transport() {
   comm_net_ = Global<EpollCommNet>::Get();
   this_machine_id_ = GlobalProcessCtx::Rank();
   CHECK(comm_net_ != nullptr);
+  chunk_size_ = ParseIntegerFromEnv("ONEFLOW_TRANSPORT_CHUNK_SIZE", 4 * 1024 * 1024);
+  max_in_flight_chunk_num_ = ParseIntegerFromEnv("ONEFLOW_TRANSPORT_MAX_IN_FLIGHT_CHUNKS", 4);
+  CHECK_GT(max_in_flight_chunk_num_, 0);
   // maybe need new read id for each dst machine id, maybe need 2 * machine num read ids
-  read_id_ = comm_net_->NewActorReadId();
+  FOR_RANGE(int64_t, i, 0, max_in_flight_chunk_num_) {
+    read_ids_.push_back(comm_net_->NewActorReadId());
+  }
   msg_poller_ = std::thread([this]() { PollMsgChannel(); });
 }
 
@@ -33,7 +38,7 @@ Transport::~Transport() {
   msg_channel_.Close();
   msg_poller_.join();
   CHECK(token2status_.empty());
-  comm_net_->DeleteActorReadId(read_id_);
+  for (void* read_id : read_ids_) { comm_net_->DeleteActorReadId(read_id); }
 }
 
 void Transport::EnqueueTransportMsg(const TransportMsg& msg) {
@@ -63,9 +68,8 @@ void Transport::PollMsgChannel() {
 }
 
 void Transport::HandlerAchievedTransportSendMsgFromSrcMachine(const TransportMsg& msg) {
-  // This machine is dst machine, and receive Send msg from source machine
-  // Maybe we need create TransportStatus,
-  // or we need update TransportStatus and DoRead().
+  // This machine is dst machine, and receive the Send msg of one chunk from source machine.
+  // Maybe we need create TransportStatus, then queue the chunk and try to read it.
   CHECK_EQ(msg.type, TransportMsgType::kSend);
   CHECK(msg.src_mem_token != nullptr);
   CHECK(msg.dst_mem_token == nullptr);
@@ -73,62 +77,38 @@ void Transport::HandlerAchievedTransportSendMsgFromSrcMachine(const TransportMsg
   CHECK(token != -1);
 
   // There are two ways to trigger the creation of TransportStatus:
-  //   1. The time (T_A) when the dst machine receives SendMsg from src machine
+  //   1. The time (T_A) when the dst machine receives the first chunk msg from src machine
   //   2. The time (T_B) when method Receive() called by the dst machine.
   // Because of T_ A and t_ B are both protected by the lock(status_mutex_), so the creation of
   // TransportStatus will NOT trigger at the same time.
   //
-  // T_ A maybe earlier than t_ B, maybe later.
-  //
-  // In either case, the earlier one is responsible for creating the TransportStatus, and the later
-  // one is responsible for checking the TransportStatus and then calling the DoRead() operation.
-
-  // prepare transport status for this token.
-  // store callback.
-  TransportStatus* stat = nullptr;
-
-  // if recv_before_send is true, it means the Receive() method has been called before this handler
-  bool recv_before_send = false;
+  // Chunks arriving before Receive() are queued, and TryReadChunks() starts reading them as soon
+  // as both sides are ready.
   {
     std::unique_lock<std::mutex> lock(status_mutex_);
     auto it = token2status_.find(token);
     if (it == token2status_.end()) {
-      token2status_.emplace(token, TransportStatus(token));
-      stat = &(token2status_.at(token));
-
-      // init stat
-      // These three members must be initialized in the block protected by lock
-      //  to prevent multi-threaded access bugs
-      stat->size = msg.size;
-      stat->src_machine_id = msg.src_machine_id;
-      stat->dst_machine_id = msg.dst_machine_id;
-    } else {
-      recv_before_send = true;
-      stat = &(it->second);
-      CHECK_GE(stat->size, msg.size);  // NOTE(chengcheng): Recv size may larger than Send size.
-      stat->size = msg.size;           // NOTE(chengcheng): msg.size always is smaller one.
+      it = token2status_.emplace(token, TransportStatus(token)).first;
+      it->second.src_machine_id = msg.src_machine_id;
+      it->second.dst_machine_id = msg.dst_machine_id;
     }
-
-    stat->is_send_ready = true;
-    CHECK(stat->src_mem_token == nullptr);
-    // src_mem_token MUST init in the block protected by lock
-    stat->src_mem_token = msg.src_mem_token;
-  }
-
-  if (recv_before_send) {
-    // it means the local machine has call Transport::Receive() before this handler
-    // check status
+    TransportStatus* stat = &(it->second);
     CHECK_EQ(stat->src_machine_id, msg.src_machine_id);
     CHECK_EQ(stat->dst_machine_id, msg.dst_machine_id);
-
-    // the recv is ready, and the send is ready too, so call DoRead();
-    DoRead(token);
+    if (stat->num_chunks == -1) {
+      stat->num_chunks = msg.num_chunks;
+    } else {
+      CHECK_EQ(stat->num_chunks, msg.num_chunks);
+    }
+    stat->pending_chunk_msgs.push_back(msg);
   }
+  TryReadChunks(token);
 }
 
 void Transport::HandlerAchievedTransportAckMsgFromDstMachine(const TransportMsg& msg) {
-  // This machine is src machine, and receive Ack msg from dst machine. The Send/Receive pair of
-  // this token is all done. So we can call callback function and erase TransportStatus.
+  // This machine is src machine, and receive the Ack msg of one chunk from dst machine. When all
+  // the chunks are acked, the Send/Receive pair of this token is all done. So we can call callback
+  // function and erase TransportStatus.
   CHECK_EQ(msg.type, TransportMsgType::kAck);
   CHECK(msg.src_mem_token != nullptr);
   CHECK(msg.dst_mem_token != nullptr);
@@ -144,23 +124,25 @@ void Transport::HandlerAchievedTransportAckMsgFromDstMachine(const TransportMsg&
     TransportStatus* stat = &(it->second);
 
     // check msg == stat
-    CHECK_EQ(stat->src_mem_token, msg.src_mem_token);
-    CHECK_EQ(stat->size, msg.size);
+    CHECK_EQ(stat->num_chunks, msg.num_chunks);
+    CHECK_EQ(stat->src_mem_tokens.at(msg.chunk_id), msg.src_mem_token);
     CHECK_EQ(stat->src_machine_id, msg.src_machine_id);
     CHECK_EQ(stat->dst_machine_id, msg.dst_machine_id);
     CHECK(stat->callback != nullptr);
 
-    callback = stat->callback;
-
-    // Recovery status
-    token2status_.erase(it);
+    stat->finished_chunk_num += 1;
+    if (stat->finished_chunk_num == stat->num_chunks) {
+      callback = std::move(stat->callback);
+      // Recovery status
+      token2status_.erase(it);
+    }
   }
 
   // UnRegisterMemory
   comm_net_->UnRegisterMemory(msg.src_mem_token);
 
   // Do Send callback
-  callback();
+  if (callback) { callback(); }
 }
 
 void Transport::Send(uint64_t token, int64_t dst_machine_id, const void* ptr, std::size_t size,
@@ -173,135 +155,153 @@ void Transport::Send(uint64_t token, int64_t dst_machine_id, const void* ptr, st
     return;
   }
 
+  // split into chunks, an empty buffer is still sent as one empty chunk
+  const std::size_t chunk_size = chunk_size_ > 0 ? chunk_size_ : std::max<std::size_t>(size, 1);
+  const int64_t num_chunks = std::max<int64_t>(RoundUp(size, chunk_size) / chunk_size, 1);
+  std::vector<TransportMsg> chunk_msgs(num_chunks);
+  FOR_RANGE(int64_t, i, 0, num_chunks) {
+    TransportMsg* msg = &chunk_msgs.at(i);
+    msg->token = token;
+    msg->src_machine_id = this_machine_id_;
+    msg->dst_machine_id = dst_machine_id;
+    msg->offset = i * chunk_size;
+    msg->size = std::min(chunk_size, size - msg->offset);
+    msg->chunk_id = i;
+    msg->num_chunks = num_chunks;
+    msg->src_mem_token = comm_net_->RegisterMemory(static_cast<char*>(mut_ptr) + msg->offset,
+                                                   msg->size);
+    msg->dst_mem_token = nullptr;
+    msg->type = TransportMsgType::kSend;
+  }
+
   // prepare transport status for this token.
   // store callback.
-  TransportStatus* stat = nullptr;
   {
     std::unique_lock<std::mutex> lock(status_mutex_);
     CHECK(token2status_.find(token)
           == token2status_.end());  // this token must be first add to status
-    token2status_.emplace(token, TransportStatus(token));
-    stat = &(token2status_.at(token));
+    TransportStatus* stat = &(token2status_.emplace(token, TransportStatus(token)).first->second);
+    stat->callback = callback;
+    stat->src_machine_id = this_machine_id_;
+    stat->dst_machine_id = dst_machine_id;
+    stat->num_chunks = num_chunks;
+    for (const auto& msg : chunk_msgs) { stat->src_mem_tokens.push_back(msg.src_mem_token); }
   }
-  stat->callback = callback;
-  stat->is_send_ready = true;
-  stat->is_recv_ready = false;
-  stat->src_mem_token = comm_net_->RegisterMemory(mut_ptr, size);
-  stat->dst_mem_token = nullptr;
-  stat->size = size;
-  stat->src_machine_id = this_machine_id_;
-  stat->dst_machine_id = dst_machine_id;
-
-  // Send msg to dst machine
-  TransportMsg msg;
-  msg.token = token;
-  msg.src_machine_id = stat->src_machine_id;
-  msg.dst_machine_id = stat->dst_machine_id;
-  msg.size = size;
-  msg.src_mem_token = stat->src_mem_token;
-  msg.dst_mem_token = stat->dst_mem_token;
-  msg.type = TransportMsgType::kSend;
-  comm_net_->SendTransportMsg(msg.dst_machine_id, msg);
+
+  // Send chunk msgs to dst machine
+  for (const auto& msg : chunk_msgs) { comm_net_->SendTransportMsg(msg.dst_machine_id, msg); }
 }
 
 void Transport::Receive(uint64_t token, int64_t src_machine_id, void* ptr, std::size_t max_size,
                         std::function<void()> callback) {
+  Receive(token, src_machine_id, ptr, max_size, nullptr, std::move(callback));
+}
+
+void Transport::Receive(uint64_t token, int64_t src_machine_id, void* ptr, std::size_t max_size,
+                        std::function<void(std::size_t, std::size_t)> chunk_callback,
+                        std::function<void()> callback) {
   // handler for receive from local machine
   if (src_machine_id == this_machine_id_) {
-    RecvFromLocalMachine(token, ptr, max_size, callback);
+    RecvFromLocalMachine(token, ptr, max_size, std::move(chunk_callback), std::move(callback));
     return;
   }
 
   // prepare transport status for this token.
   // store callback.
-  TransportStatus* stat = nullptr;
-
-  // if recv_before_send is true, it means the SendMsg has been handled before this Receive called.
-  bool send_before_recv = false;
   {
     std::unique_lock<std::mutex> lock(status_mutex_);
     auto it = token2status_.find(token);
     if (it == token2status_.end()) {
-      token2status_.emplace(token, TransportStatus(token));
-      stat = &(token2status_.at(token));
-
-      // init stat
-      // These three members must be initialized in the block protected by lock
-      //  to prevent multi-threaded access bugs
-      stat->size = max_size;
-      stat->src_machine_id = src_machine_id;
-      stat->dst_machine_id = this_machine_id_;
-    } else {
-      send_before_recv = true;
-      stat = &(it->second);
+      it = token2status_.emplace(token, TransportStatus(token)).first;
+      it->second.src_machine_id = src_machine_id;
+      it->second.dst_machine_id = this_machine_id_;
     }
-
-    stat->callback = callback;
-    stat->is_recv_ready = true;
-    // NOTE(chengcheng): Store dst_ptr so that we can create dst_mem_token in DoRead()
-    stat->dst_ptr = ptr;
-  }
-
-  if (send_before_recv) {
-    // it means the source machine has send message to this machine
-    // check status
-    CHECK_LE(stat->size,
-             max_size);  // NOTE(chengcheng): Receive max_size may larger than Send size.
+    TransportStatus* stat = &(it->second);
     CHECK_EQ(stat->src_machine_id, src_machine_id);
     CHECK_EQ(stat->dst_machine_id, this_machine_id_);
+    CHECK(!stat->is_recv_ready);
 
-    // the recv is ready, and the send is ready too, so call DoRead();
-    DoRead(token);
+    stat->callback = std::move(callback);
+    stat->chunk_callback = std::move(chunk_callback);
+    stat->is_recv_ready = true;
+    // NOTE(chengcheng): Store dst_ptr so that we can create dst_mem_token in TryReadChunks()
+    stat->dst_ptr = ptr;
+    stat->max_size = max_size;
   }
+  TryReadChunks(token);
 }
 
-void Transport::DoRead(uint64_t token) {
-  TransportStatus* stat = nullptr;
+void Transport::TryReadChunks(uint64_t token) {
+  std::vector<TransportMsg> chunk_msgs;
   {
     std::unique_lock<std::mutex> lock(status_mutex_);
     auto it = token2status_.find(token);
-    CHECK(it != token2status_.end());
-    stat = &(it->second);
-
-    // dst_mem_token MUST init in the block protected by lock
-    CHECK(stat->dst_mem_token == nullptr);
-    // NOTE(chengcheng): ONLY at this time, the stat->size is the real size assigned by Send
-    stat->dst_mem_token = comm_net_->RegisterMemory(stat->dst_ptr, stat->size);
+    // the chunks may have been read to the end by a concurrent caller
+    if (it == token2status_.end()) { return; }
+    TransportStatus* stat = &(it->second);
+    if (!stat->is_recv_ready) { return; }
+    CHECK(stat->callback);
+    while (stat->in_flight_chunk_num < max_in_flight_chunk_num_
+           && !stat->pending_chunk_msgs.empty()) {
+      TransportMsg msg = stat->pending_chunk_msgs.front();
+      stat->pending_chunk_msgs.pop_front();
+      // NOTE(chengcheng): Receive max_size may larger than Send size.
+      CHECK_LE(msg.offset + msg.size, stat->max_size);
+      // dst_mem_token MUST init in the block protected by lock
+      msg.dst_mem_token =
+          comm_net_->RegisterMemory(static_cast<char*>(stat->dst_ptr) + msg.offset, msg.size);
+      stat->in_flight_chunk_num += 1;
+      chunk_msgs.push_back(msg);
+    }
   }
-  CHECK(stat->is_send_ready && stat->is_recv_ready);
-  CHECK(stat->src_mem_token != nullptr);
-  CHECK(stat->dst_mem_token != nullptr);
-  CHECK(stat->src_machine_id != -1);
-  CHECK(stat->dst_machine_id != -1);
-  CHECK(stat->size != -1);
-  CHECK(stat->callback);
-  comm_net_->Read(read_id_, stat->src_machine_id, stat->src_mem_token, stat->dst_mem_token);
-  comm_net_->AddReadCallBack(read_id_, [stat, this]() {
-    // Send ack message to source machine
-    TransportMsg msg;
-    msg.token = stat->token;
-    msg.src_machine_id = stat->src_machine_id;
-    msg.dst_machine_id = stat->dst_machine_id;
-    msg.size = stat->size;
-    msg.src_mem_token = stat->src_mem_token;
-    msg.dst_mem_token = stat->dst_mem_token;
-    msg.type = TransportMsgType::kAck;
-    comm_net_->SendTransportMsg(msg.src_machine_id, msg);
-
-    // UnRegisterMemory
-    comm_net_->UnRegisterMemory(msg.dst_mem_token);
+  for (const auto& msg : chunk_msgs) { ReadChunk(msg); }
+}
 
-    // Do Receive callback
-    stat->callback();
+void Transport::ReadChunk(const TransportMsg& chunk_msg) {
+  CHECK(chunk_msg.src_mem_token != nullptr);
+  CHECK(chunk_msg.dst_mem_token != nullptr);
+  CHECK(chunk_msg.src_machine_id != -1);
+  CHECK(chunk_msg.dst_machine_id != -1);
+  void* read_id = read_ids_.at(chunk_msg.chunk_id % read_ids_.size());
+  std::unique_lock<std::mutex> lock(read_mutex_);
+  comm_net_->Read(read_id, chunk_msg.src_machine_id, chunk_msg.src_mem_token,
+                  chunk_msg.dst_mem_token);
+  comm_net_->AddReadCallBack(read_id, [chunk_msg, this]() { OnChunkRead(chunk_msg); });
+}
+
+void Transport::OnChunkRead(const TransportMsg& chunk_msg) {
+  // Send ack message to source machine
+  TransportMsg msg = chunk_msg;
+  msg.type = TransportMsgType::kAck;
+  comm_net_->SendTransportMsg(msg.src_machine_id, msg);
+
+  // UnRegisterMemory
+  comm_net_->UnRegisterMemory(msg.dst_mem_token);
 
-    // Recovery status
-    {
-      std::unique_lock<std::mutex> lock(status_mutex_);
-      auto it = token2status_.find(stat->token);
-      CHECK(it != token2status_.end());
+  std::function<void(std::size_t, std::size_t)> chunk_callback;
+  std::function<void()> callback;
+  {
+    std::unique_lock<std::mutex> lock(status_mutex_);
+    auto it = token2status_.find(msg.token);
+    CHECK(it != token2status_.end());
+    TransportStatus* stat = &(it->second);
+    chunk_callback = stat->chunk_callback;
+    stat->in_flight_chunk_num -= 1;
+    stat->finished_chunk_num += 1;
+    if (stat->finished_chunk_num == stat->num_chunks) {
+      callback = std::move(stat->callback);
+      // Recovery status
       token2status_.erase(it);
     }
-  });
+  }
+
+  if (chunk_callback) { chunk_callback(msg.offset, msg.size); }
+  if (callback) {
+    // Do Receive callback
+    callback();
+  } else {
+    TryReadChunks(msg.token);
+  }
 }
 
 void Transport::SendToLocalMachine(uint64_t token, void* ptr, std::size_t size,
@@ -309,6 +309,7 @@ void Transport::SendToLocalMachine(uint64_t token, void* ptr, std::size_t size,
   bool need_do_copy = false;
   bool need_do_callback = false;
   std::function<void()> receive_callback;
+  std::function<void(std::size_t, std::size_t)> receive_chunk_callback;
   void* dst_ptr = nullptr;
   {
     std::unique_lock<std::mutex> lock(local_copy_lock_);
@@ -319,6 +320,7 @@ void Transport::SendToLocalMachine(uint64_t token, void* ptr, std::size_t size,
     } else {
       need_do_callback = true;
       receive_callback = std::move(it->second.callback);
+      receive_chunk_callback = std::move(it->second.chunk_callback);
 
       dst_ptr = it->second.ptr;
       CHECK(size <= it->second.size);  // NOTE(chengcheng): Recv size may larger than Send size.
@@ -334,11 +336,13 @@ void Transport::SendToLocalMachine(uint64_t token, void* ptr, std::size_t size,
 
   if (need_do_callback) {
     callback();
+    if (receive_chunk_callback) { receive_chunk_callback(0, size); }
     receive_callback();
   }
 }
 
 void Transport::RecvFromLocalMachine(uint64_t token, void* ptr, std::size_t max_size,
+                                     std::function<void(std::size_t, std::size_t)> chunk_callback,
                                      std::function<void()> callback) {
   bool need_do_copy = false;
   bool need_do_callback = false;
@@ -350,8 +354,10 @@ void Transport::RecvFromLocalMachine(uint64_t token, void* ptr, std::size_t max_
     auto it = token2local_copy_status_.find(token);
     if (it == token2local_copy_status_.end()) {
       // init local copy status
-      token2local_copy_status_.emplace(token,
-                                       CopyStatusOnLocalMachine(token, ptr, max_size, callback));
+      auto* status = &token2local_copy_status_
+                          .emplace(token, CopyStatusOnLocalMachine(token, ptr, max_size, callback))
+                          .first->second;
+      status->chunk_callback = std::move(chunk_callback);
     } else {
       need_do_callback = true;
       send_callback = std::move(it->second.callback);
@@ -370,6 +376,7 @@ void Transport::RecvFromLocalMachine(uint64_t token, void* ptr, std::size_t max_
   if (need_do_copy) { memcpy(ptr, src_ptr, size); }
 
   if (need_do_callback) {
+    if (chunk_callback) { chunk_callback(0, size); }
     callback();
     send_callback();
   }
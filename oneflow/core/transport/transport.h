@@ -44,6 +44,12 @@ namespace oneflow {
 //
 // Transport supports send and receive data on local machine.
 //
+// Large buffers are streamed in chunks of ONEFLOW_TRANSPORT_CHUNK_SIZE bytes (chosen by the sender,
+// 0 disables chunking), and at most ONEFLOW_TRANSPORT_MAX_IN_FLIGHT_CHUNKS chunks of a receiver
+// are read at the same time. The receiver may pass a chunk_callback(offset, size), which is called
+// once a chunk has arrived, so that it can consume the chunk while the later ones are in flight.
+// The chunk callbacks are called on the CommNet callback thread and should not block.
+//
 class Transport {
  public:
   OF_DISALLOW_COPY_AND_MOVE(Transport);
@@ -53,16 +59,22 @@ class Transport {
             std::function<void()> callback);
   void Receive(uint64_t token, int64_t src_machine_id, void* ptr, std::size_t max_size,
                std::function<void()> callback);
+  void Receive(uint64_t token, int64_t src_machine_id, void* ptr, std::size_t max_size,
+               std::function<void(std::size_t offset, std::size_t size)> chunk_callback,
+               std::function<void()> callback);
   void EnqueueTransportMsg(const TransportMsg& msg);
 
  private:
   void PollMsgChannel();
   void HandlerAchievedTransportSendMsgFromSrcMachine(const TransportMsg& msg);
   void HandlerAchievedTransportAckMsgFromDstMachine(const TransportMsg& msg);
-  void DoRead(uint64_t token);
+  void TryReadChunks(uint64_t token);
+  void ReadChunk(const TransportMsg& chunk_msg);
+  void OnChunkRead(const TransportMsg& chunk_msg);
   void SendToLocalMachine(uint64_t token, void* ptr, std::size_t size,
                           std::function<void()> callback);
   void RecvFromLocalMachine(uint64_t token, void* ptr, std::size_t max_size,
+                            std::function<void(std::size_t, std::size_t)> chunk_callback,
                             std::function<void()> callback);
 
   // TODO(chengcheng)
@@ -80,25 +92,35 @@ class Transport {
   struct TransportStatus {
     const uint64_t token;
     std::function<void()> callback;
-    bool is_send_ready;
+    // only used at the receiver
+    std::function<void(std::size_t, std::size_t)> chunk_callback;
     bool is_recv_ready;
-    void* src_mem_token;
-    void* dst_mem_token;
     // NOTE(chengcheng): must store dst_ptr in status when Receive max_size > Send size
     void* dst_ptr;
-    std::size_t size;
+    std::size_t max_size;
     int64_t src_machine_id;
     int64_t dst_machine_id;
+    // -1 at the receiver until the first chunk msg arrives
+    int64_t num_chunks;
+    int64_t finished_chunk_num;
+    int64_t in_flight_chunk_num;
+    // sender: the src_mem_token of each chunk, which is unregistered when the chunk is acked
+    std::vector<void*> src_mem_tokens;
+    // receiver: chunks announced by the sender but not read yet
+    std::deque<TransportMsg> pending_chunk_msgs;
+
     TransportStatus(uint64_t tk)
         : token(tk),
           callback(nullptr),
-          is_send_ready(false),
+          chunk_callback(nullptr),
           is_recv_ready(false),
-          src_mem_token(nullptr),
-          dst_mem_token(nullptr),
-          size(-1),
+          dst_ptr(nullptr),
+          max_size(0),
           src_machine_id(-1),
-          dst_machine_id(-1) {}
+          dst_machine_id(-1),
+          num_chunks(-1),
+          finished_chunk_num(0),
+          in_flight_chunk_num(0) {}
   };
 
   // CopyStatusOnLocalMachine is a stored state to support local data transfer.
@@ -115,6 +137,8 @@ class Transport {
     void* ptr;
     std::size_t size;
     std::function<void()> callback;
+    // only set when Receive() is called first
+    std::function<void(std::size_t, std::size_t)> chunk_callback;
     CopyStatusOnLocalMachine(uint64_t tk, void* p, std::size_t s, std::function<void()> cb)
         : token(tk), ptr(p), size(s), callback(std::move(cb)) {}
   };
@@ -129,7 +153,12 @@ class Transport {
   HashMap<uint64_t, CopyStatusOnLocalMachine> token2local_copy_status_;
 
   int64_t this_machine_id_;
-  void* read_id_;
+  std::size_t chunk_size_;
+  int64_t max_in_flight_chunk_num_;
+  // chunks on the same read id are read one by one, so there is one read id per in-flight chunk.
+  // read_mutex_ keeps each Read() and its AddReadCallBack() adjacent on a read id.
+  std::vector<void*> read_ids_;
+  std::mutex read_mutex_;
   EpollCommNet* comm_net_;
 
   Channel<TransportMsg> msg_channel_;
@@ -25,8 +25,8 @@ namespace oneflow {
 
 enum class TransportMsgType {
   kInvalid = 0,
-  kSend = 1,  // send msg from local to remote transport
-  kAck = 2,   // this token transmission task is down
+  kSend = 1,  // send msg of one chunk from local to remote transport
+  kAck = 2,   // the transmission of this chunk is done
 };
 
 struct TransportMsg {
@@ -34,6 +34,10 @@ struct TransportMsg {
   void* src_mem_token;
   void* dst_mem_token;
   std::size_t size;
+  // a Send is split into num_chunks chunks, which are read and acked independently
+  std::size_t offset;
+  int64_t chunk_id;
+  int64_t num_chunks;
   int64_t src_machine_id;
   int64_t dst_machine_id;
   TransportMsgType type;
@@ -20,11 +20,33 @@ limitations under the License.
 namespace oneflow {
 namespace vm {
 
+namespace {
+
+class AlignedCpuAllocator final : public Allocator {
+ public:
+  AlignedCpuAllocator() = default;
+  ~AlignedCpuAllocator() override = default;
+
+  void Allocate(char** mem_ptr, std::size_t size) override {
+    *mem_ptr = reinterpret_cast<char*>(aligned_alloc(kHostAlignSize, size));
+  }
+  void Deallocate(char* mem_ptr, std::size_t size) override { std::free(mem_ptr); }
+};
+
+}  // namespace
+
+CpuAllocator::CpuAllocator()
+    : caching_allocator_(new SizeClassCachingAllocator(
+        std::unique_ptr<Allocator>(new AlignedCpuAllocator()),
+        ParseIntegerFromEnv("ONEFLOW_VM_CPU_ALLOCATOR_MAX_CACHED_BYTES", 512 * 1024 * 1024))) {}
+
 void CpuAllocator::Allocate(char** mem_ptr, std::size_t size) {
-  *mem_ptr = reinterpret_cast<char*>(aligned_alloc(kHostAlignSize, size));
+  caching_allocator_->Allocate(mem_ptr, size);
 }
 
-void CpuAllocator::Deallocate(char* mem_ptr, std::size_t size) { std::free(mem_ptr); }
+void CpuAllocator::Deallocate(char* mem_ptr, std::size_t size) {
+  caching_allocator_->Deallocate(mem_ptr, size);
+}
 
 COMMAND(Global<CpuAllocator>::SetAllocated(new CpuAllocator()));
 
@@ -17,18 +17,29 @@ limitations under the License.
 #define ONEFLOW_CORE_VM_CPU_ALLOCATOR_H_
 
 #include <cstdint>
+#include <memory>
 #include "oneflow/core/vm/allocator.h"
+#include "oneflow/core/vm/size_class_caching_allocator.h"
 
 namespace oneflow {
 namespace vm {
 
+// CpuAllocator caches freed host memory by size class. The retention limit is configured by the
+// environment variable ONEFLOW_VM_CPU_ALLOCATOR_MAX_CACHED_BYTES.
 class CpuAllocator final : public Allocator {
  public:
-  explicit CpuAllocator() = default;
+  explicit CpuAllocator();
   ~CpuAllocator() override = default;
 
   void Allocate(char** mem_ptr, std::size_t size) override;
   void Deallocate(char* mem_ptr, std::size_t size) override;
+
+  // Returns the cached memory to the system
+  void Trim() { caching_allocator_->Trim(); }
+  size_t cached_bytes() const { return caching_allocator_->cached_bytes(); }
+
+ private:
+  std::unique_ptr<SizeClassCachingAllocator> caching_allocator_;
 };
 
 }  // namespace vm
@@ -35,14 +35,53 @@ constexpr size_t kMinBlockSize = 20 << 20;  // 20MiB
 constexpr size_t kMinAlloc =
     10 << 20;  // allocations less than 10MiB should be packed in kMinBlockSize bytes.
 
+const size_t kRemainBytes = 50 * 1048576;  // remain at least 50MiB memory
+
+#if CUDA_VERSION >= 10020
+
+static_assert(sizeof(CUmemGenericAllocationHandle) == sizeof(uint64_t), "");
+
+CUmemAllocationProp MakeSegmentAllocationProp(int64_t device_id) {
+  CUmemAllocationProp prop = {};
+  prop.type = CU_MEM_ALLOCATION_TYPE_PINNED;
+  prop.location.type = CU_MEM_LOCATION_TYPE_DEVICE;
+  prop.location.id = device_id;
+  return prop;
+}
+
+#endif  // CUDA_VERSION >= 10020
+
 }  // namespace
 
 CudaAllocator::CudaAllocator(int64_t device_id)
-    : Allocator(), device_id_(device_id), total_memory_bytes_(0), recycle_piece_list_(nullptr) {
-  bins_.resize(kBinNumSize);
+    : CudaAllocator(device_id,
+                    ParseBooleanFromEnv("ONEFLOW_VM_CUDA_ALLOCATOR_EXPANDABLE_SEGMENT", false)) {}
+
+CudaAllocator::CudaAllocator(int64_t device_id, bool use_expandable_segment)
+    : Allocator(),
+      device_id_(device_id),
+      total_memory_bytes_(0),
+      recycle_piece_list_(nullptr),
+      use_expandable_segment_(use_expandable_segment),
+      segment_ptr_(nullptr),
+      segment_reserved_bytes_(0),
+      segment_granularity_(0),
+      reserved_bytes_gauge_(profiler::GetGauge("oneflow_vm_cuda_allocator_reserved_bytes",
+                                               "device memory held by the vm cuda allocators",
+                                               {{"device", std::to_string(device_id)}})),
+      allocated_bytes_gauge_(profiler::GetGauge("oneflow_vm_cuda_allocator_allocated_bytes",
+                                                "device memory in use from the vm cuda allocators",
+                                                {{"device", std::to_string(device_id)}})) {
+#if CUDA_VERSION < 10020
+  if (use_expandable_segment_) {
+    LOG(WARNING) << "CudaAllocator expandable segment requires CUDA 10.2 or higher.";
+    use_expandable_segment_ = false;
+  }
+#endif  // CUDA_VERSION < 10020
+  stats_.bin_free_piece_num.resize(kBinNumSize, 0);
+  stats_.allocation_size_histogram.resize(kBinNumSize, 0);
   for (int i = 0; i < kBinNumSize; ++i) {
     size_t bin_size = BinSize4BinNum(i);
-    bins_.at(i).size = bin_size;
     CHECK_EQ(BinNum4BinSize(bin_size), i);
     CHECK_EQ(BinNum4BinSize(bin_size + kCudaMemAllocAlignSize - 1), i);
     CHECK_EQ(BinNum4BinSize(bin_size * 2 - 1), i);
@@ -51,28 +90,70 @@ CudaAllocator::CudaAllocator(int64_t device_id)
 }
 
 CudaAllocator::~CudaAllocator() {
-  if (total_memory_bytes_ == 0) {
+  reserved_bytes_gauge_->Add(-static_cast<int64_t>(total_memory_bytes_));
+  allocated_bytes_gauge_->Add(-static_cast<int64_t>(stats_.allocated_bytes));
+  if (total_memory_bytes_ == 0 && recycle_events_.empty() && segment_ptr_ == nullptr) {
     CHECK_EQ(mem_ptr2block_.size(), 0);
     return;
   }
   cudaSetDevice(device_id_);
-  for (auto& pair : mem_ptr2block_) { OF_CUDA_CHECK(cudaFree(pair.first)); }
+  for (const auto& piece : pieces_) {
+    if (piece->event != nullptr) { OF_CUDA_CHECK(cudaEventDestroy(piece->event)); }
+  }
+  for (cudaEvent_t event : recycle_events_) { OF_CUDA_CHECK(cudaEventDestroy(event)); }
+  if (use_expandable_segment_) {
+    ReleaseExpandableSegment();
+  } else {
+    for (auto& pair : mem_ptr2block_) { OF_CUDA_CHECK(cudaFree(pair.first)); }
+  }
+}
+
+std::vector<CudaAllocator::Bin>* CudaAllocator::MutBins4Stream(cudaStream_t stream) {
+  auto it = stream2bins_.find(stream);
+  if (it != stream2bins_.end()) { return &it->second; }
+  std::vector<Bin>* bins = &stream2bins_[stream];
+  bins->resize(kBinNumSize);
+  for (int i = 0; i < kBinNumSize; ++i) { bins->at(i).size = BinSize4BinNum(i); }
+  return bins;
 }
 
 void CudaAllocator::InsertPiece2Bin(Piece* piece) {
   CHECK(piece->is_free && piece->bin_num == kInvalidBinNum);
   int32_t bin_num = BinNum4BinSize(piece->size);
   piece->bin_num = bin_num;
-  CHECK(bins_.at(bin_num).pieces.insert(piece).second);
+  CHECK(MutBins4Stream(piece->stream)->at(bin_num).pieces.insert(piece).second);
 }
 
 void CudaAllocator::RemovePieceFromBin(Piece* piece) {
   CHECK(piece->is_free);
   CHECK_NE(piece->bin_num, kInvalidBinNum);
-  CHECK_GT(bins_.at(piece->bin_num).pieces.erase(piece), 0);
+  CHECK_GT(MutBins4Stream(piece->stream)->at(piece->bin_num).pieces.erase(piece), 0);
   piece->bin_num = kInvalidBinNum;
 }
 
+bool CudaAllocator::IsMergeable(const Piece* piece, const Piece* neighbour) const {
+  return neighbour != nullptr && neighbour->is_free && neighbour->stream == piece->stream;
+}
+
+cudaEvent_t CudaAllocator::AllocateEvent() {
+  if (!recycle_events_.empty()) {
+    cudaEvent_t event = recycle_events_.back();
+    recycle_events_.pop_back();
+    return event;
+  }
+  cudaEvent_t event;
+  OF_CUDA_CHECK(cudaEventCreateWithFlags(&event, cudaEventDisableTiming));
+  return event;
+}
+
+void CudaAllocator::DeallocateEvent(cudaEvent_t event) { recycle_events_.push_back(event); }
+
+void CudaAllocator::ReleasePieceEvent(Piece* piece) {
+  if (piece->event == nullptr) { return; }
+  DeallocateEvent(piece->event);
+  piece->event = nullptr;
+}
+
 CudaAllocator::Piece* CudaAllocator::AllocatePiece() {
   if (recycle_piece_list_) {
     Piece* ret = recycle_piece_list_;
@@ -85,11 +166,13 @@ CudaAllocator::Piece* CudaAllocator::AllocatePiece() {
 }
 
 void CudaAllocator::DeallocatePiece(Piece* piece) {
+  ReleasePieceEvent(piece);
   piece->ptr = nullptr;
   piece->size = 0;
   piece->bin_num = kInvalidBinNum;
   piece->is_free = true;
   piece->prev = nullptr;
+  piece->stream = nullptr;
   piece->next = recycle_piece_list_;
   recycle_piece_list_ = piece;
 }
@@ -105,52 +188,83 @@ void CudaAllocator::UnMarkPiece(Piece* piece) {
   ptr2piece_.erase(it);
 }
 
-CudaAllocator::Piece* CudaAllocator::FindPiece(size_t aligned_size) {
+CudaAllocator::Piece* CudaAllocator::FindPieceInBins(size_t aligned_size, std::vector<Bin>* bins,
+                                                     bool check_event) {
   CHECK(IsAlignedSize(aligned_size));
   for (int32_t bin_num = BinNum4BinSize(aligned_size); bin_num < kBinNumSize; ++bin_num) {
-    Bin* bin = &bins_.at(bin_num);
+    Bin* bin = &bins->at(bin_num);
     for (auto it = bin->pieces.begin(); it != bin->pieces.end(); ++it) {
       Piece* piece = *it;
       CHECK(piece->is_free);
       CHECK_NOTNULL(piece->ptr);
       CHECK_EQ(piece->bin_num, bin_num);
       CHECK(IsAlignedSize(piece->size));
-      if (piece->size >= aligned_size) {
-        bin->pieces.erase(it);
-        piece->bin_num = kInvalidBinNum;
-        piece->is_free = false;
-        if (piece->size >= aligned_size * 2 || piece->size - aligned_size >= kPieceSplitThreshold) {
-          Piece* new_piece = AllocatePiece();
-          new_piece->ptr = piece->ptr + aligned_size;
-          new_piece->size = piece->size - aligned_size;
-          piece->size = aligned_size;
-
-          Piece* next_p = piece->next;
-          piece->next = new_piece;
-          new_piece->prev = piece;
-          new_piece->next = next_p;
-          if (next_p != nullptr) { next_p->prev = new_piece; }
-
-          new_piece->is_free = true;
-          new_piece->bin_num = kInvalidBinNum;
-          CHECK(IsAlignedSize(piece->size));
-          CHECK(IsAlignedSize(new_piece->size));
-          InsertPiece2Bin(new_piece);
-          MarkPiece(new_piece);
-        }
-        return piece;
+      if (piece->size < aligned_size) { continue; }
+      // pieces without event have never been used by any stream
+      if (check_event && piece->event != nullptr) {
+        cudaError_t err = cudaEventQuery(piece->event);
+        if (err == cudaErrorNotReady) { continue; }
+        OF_CUDA_CHECK(err);
       }
+      return piece;
     }
   }
   return nullptr;
 }
 
+CudaAllocator::Piece* CudaAllocator::FindPiece(size_t aligned_size, cudaStream_t stream) {
+  Piece* piece = FindPieceInBins(aligned_size, MutBins4Stream(stream), false);
+  if (piece == nullptr) {
+    for (auto& pair : stream2bins_) {
+      if (pair.first == stream) { continue; }
+      piece = FindPieceInBins(aligned_size, &pair.second, true);
+      if (piece != nullptr) { break; }
+    }
+  }
+  if (piece != nullptr) { UsePiece(piece, aligned_size, stream); }
+  return piece;
+}
+
+void CudaAllocator::UsePiece(Piece* piece, size_t aligned_size, cudaStream_t stream) {
+  RemovePieceFromBin(piece);
+  piece->is_free = false;
+  // either `stream' is the last-use stream or the last-use event has completed
+  piece->stream = stream;
+  cudaEvent_t event = piece->event;
+  piece->event = nullptr;
+  if (piece->size >= aligned_size * 2 || piece->size - aligned_size >= kPieceSplitThreshold) {
+    Piece* new_piece = AllocatePiece();
+    new_piece->ptr = piece->ptr + aligned_size;
+    new_piece->size = piece->size - aligned_size;
+    piece->size = aligned_size;
+
+    Piece* next_p = piece->next;
+    piece->next = new_piece;
+    new_piece->prev = piece;
+    new_piece->next = next_p;
+    if (next_p != nullptr) { next_p->prev = new_piece; }
+
+    new_piece->is_free = true;
+    new_piece->bin_num = kInvalidBinNum;
+    new_piece->stream = stream;
+    // the tail inherits the last-use event of the whole piece
+    new_piece->event = event;
+    CHECK(IsAlignedSize(piece->size));
+    CHECK(IsAlignedSize(new_piece->size));
+    InsertPiece2Bin(new_piece);
+    MarkPiece(new_piece);
+  } else if (event != nullptr) {
+    DeallocateEvent(event);
+  }
+}
+
 void CudaAllocator::MergeNeighbourFreePiece(Piece* lhs, Piece* rhs) {
   CHECK(lhs->is_free);
   CHECK(rhs->is_free);
   CHECK(lhs->next == rhs);
   CHECK(lhs == rhs->prev);
   CHECK(lhs->ptr + lhs->size == rhs->ptr);
+  CHECK(lhs->stream == rhs->stream);
 
   lhs->size += rhs->size;
   lhs->next = rhs->next;
@@ -159,8 +273,9 @@ void CudaAllocator::MergeNeighbourFreePiece(Piece* lhs, Piece* rhs) {
   DeallocatePiece(rhs);
 }
 
-bool CudaAllocator::AllocateBlockToExtendTotalMem(size_t aligned_size) {
+bool CudaAllocator::AllocateBlockToExtendTotalMem(size_t aligned_size, cudaStream_t stream) {
   CHECK(IsAlignedSize(aligned_size));
+  if (use_expandable_segment_) { return ExtendExpandableSegment(aligned_size, stream); }
 
   size_t allocate_bytes = 1048576;  // 1MiB base size
   allocate_bytes = std::max(allocate_bytes, aligned_size);
@@ -169,8 +284,7 @@ bool CudaAllocator::AllocateBlockToExtendTotalMem(size_t aligned_size) {
   size_t free_bytes = -1;
   size_t total_bytes = -1;
   OF_CUDA_CHECK(cudaMemGetInfo(&free_bytes, &total_bytes));
-  const size_t remain_bytes = 50 * 1048576;
-  const size_t available_bytes = free_bytes - remain_bytes;  // remain at least 50MiB memory
+  const size_t available_bytes = free_bytes - kRemainBytes;
 
   // growth double total memory bytes if could
   // if (total_memory_bytes_ > 0) {
@@ -179,15 +293,21 @@ bool CudaAllocator::AllocateBlockToExtendTotalMem(size_t aligned_size) {
   if (allocate_bytes < kMinAlloc) { allocate_bytes = kMinBlockSize; }
   const size_t final_allocate_bytes = CudaMemAlignedBytes(allocate_bytes);
 
-  if (final_allocate_bytes > available_bytes) { return false; }
-
-  if (final_allocate_bytes < aligned_size) { return false; }
+  if (final_allocate_bytes > available_bytes || final_allocate_bytes < aligned_size) {
+    ++stats_.extend_failure_num;
+    return false;
+  }
 
   char* mem_ptr = nullptr;
-  if (cudaMalloc(&mem_ptr, final_allocate_bytes) != cudaSuccess) { return false; }
+  if (cudaMalloc(&mem_ptr, final_allocate_bytes) != cudaSuccess) {
+    ++stats_.extend_failure_num;
+    return false;
+  }
 
   // extend sucess
   total_memory_bytes_ += final_allocate_bytes;
+  reserved_bytes_gauge_->Add(final_allocate_bytes);
+  ++stats_.extend_num;
 
   Piece* piece = AllocatePiece();
   piece->size = final_allocate_bytes;
@@ -196,6 +316,7 @@ bool CudaAllocator::AllocateBlockToExtendTotalMem(size_t aligned_size) {
   piece->next = nullptr;
   piece->is_free = true;
   piece->bin_num = kInvalidBinNum;
+  piece->stream = stream;
   InsertPiece2Bin(piece);
   MarkPiece(piece);
 
@@ -205,6 +326,7 @@ bool CudaAllocator::AllocateBlockToExtendTotalMem(size_t aligned_size) {
 }
 
 bool CudaAllocator::DeallocateFreeBlockForGarbageCollection() {
+  if (use_expandable_segment_) { return ShrinkExpandableSegment(); }
   size_t total_free_bytes = 0;
   HashSet<char*> free_block_ptrs;
   for (const auto& pair : mem_ptr2block_) {
@@ -226,8 +348,11 @@ bool CudaAllocator::DeallocateFreeBlockForGarbageCollection() {
   }
 
   total_memory_bytes_ -= total_free_bytes;
+  reserved_bytes_gauge_->Add(-static_cast<int64_t>(total_free_bytes));
 
   if (total_free_bytes > 0) {
+    ++stats_.gc_num;
+    stats_.gc_freed_bytes += total_free_bytes;
     LOG(WARNING) << "CudaAllocator try deallocate free block for garbage collection. "
                  << " deallocate free bytes : " << total_free_bytes;
     cudaSetDevice(device_id_);
@@ -260,20 +385,27 @@ bool CudaAllocator::DeallocateFreeBlockForGarbageCollection() {
 }
 
 void CudaAllocator::Allocate(char** mem_ptr, std::size_t size) {
+  Allocate(mem_ptr, size, nullptr);
+}
+
+void CudaAllocator::Allocate(char** mem_ptr, std::size_t size, cudaStream_t stream) {
   if (size == 0) {
     *mem_ptr = nullptr;
     return;
   }
   size_t aligned_size = CudaMemAlignedBytes(size);
 
-  Piece* piece = FindPiece(aligned_size);
+  Piece* piece = FindPiece(aligned_size, stream);
   if (piece == nullptr) {
-    if (AllocateBlockToExtendTotalMem(aligned_size)) { piece = FindPiece(aligned_size); }
+    if (AllocateBlockToExtendTotalMem(aligned_size, stream)) {
+      piece = FindPiece(aligned_size, stream);
+    }
   }
 
   if (piece == nullptr) {
-    if (DeallocateFreeBlockForGarbageCollection() && AllocateBlockToExtendTotalMem(aligned_size)) {
-      piece = FindPiece(aligned_size);
+    if (DeallocateFreeBlockForGarbageCollection()
+        && AllocateBlockToExtendTotalMem(aligned_size, stream)) {
+      piece = FindPiece(aligned_size, stream);
     }
   }
 
@@ -281,6 +413,11 @@ void CudaAllocator::Allocate(char** mem_ptr, std::size_t size) {
   CHECK_NOTNULL(piece->ptr);
   CHECK(ptr2piece_.find(piece->ptr) != ptr2piece_.end());
   *mem_ptr = piece->ptr;
+  ++stats_.allocate_num;
+  ++stats_.allocation_size_histogram.at(BinNum4BinSize(aligned_size));
+  stats_.allocated_bytes += piece->size;
+  allocated_bytes_gauge_->Add(piece->size);
+  stats_.peak_allocated_bytes = std::max(stats_.peak_allocated_bytes, stats_.allocated_bytes);
 }
 
 void CudaAllocator::Deallocate(char* mem_ptr, std::size_t size) {
@@ -295,26 +432,268 @@ void CudaAllocator::Deallocate(char* mem_ptr, std::size_t size) {
   CHECK(!piece->is_free);
 
   piece->is_free = true;
+  ++stats_.deallocate_num;
+  stats_.allocated_bytes -= piece->size;
+  allocated_bytes_gauge_->Add(-static_cast<int64_t>(piece->size));
+  // Work submitted to piece->stream before this event may still use the memory.
+  cudaSetDevice(device_id_);
+  CHECK(piece->event == nullptr);
+  piece->event = AllocateEvent();
+  OF_CUDA_CHECK(cudaEventRecord(piece->event, piece->stream));
 
   Piece* last_piece_insert_to_bin = piece;
   Piece* next_p = piece->next;
   Piece* prev_p = piece->prev;
 
-  if (next_p != nullptr && next_p->is_free) {
+  if (IsMergeable(piece, next_p)) {
     CHECK_EQ(next_p->ptr, piece->ptr + piece->size);
     RemovePieceFromBin(next_p);
     MergeNeighbourFreePiece(piece, next_p);
   }
 
-  if (prev_p != nullptr && prev_p->is_free) {
+  if (IsMergeable(piece, prev_p)) {
     CHECK_EQ(piece->ptr, prev_p->ptr + prev_p->size);
     RemovePieceFromBin(prev_p);
+    // events are recorded in stream order, the latest one covers the earlier ones.
+    std::swap(prev_p->event, piece->event);
     MergeNeighbourFreePiece(prev_p, piece);
     last_piece_insert_to_bin = prev_p;
   }
   InsertPiece2Bin(last_piece_insert_to_bin);
 }
 
+CudaAllocator::Piece* CudaAllocator::LastPieceOfExpandableSegment() {
+  auto it = mem_ptr2block_.find(segment_ptr_);
+  if (it == mem_ptr2block_.end()) { return nullptr; }
+  Piece* piece = it->second.start_piece;
+  while (piece->next != nullptr) { piece = piece->next; }
+  return piece;
+}
+
+#if CUDA_VERSION >= 10020
+
+bool CudaAllocator::ExtendExpandableSegment(size_t aligned_size, cudaStream_t stream) {
+  cudaSetDevice(device_id_);
+  size_t free_bytes = -1;
+  size_t total_bytes = -1;
+  OF_CUDA_CHECK(cudaMemGetInfo(&free_bytes, &total_bytes));
+  const CUmemAllocationProp prop = MakeSegmentAllocationProp(device_id_);
+  if (segment_ptr_ == nullptr) {
+    OF_CU_CHECK(cuMemGetAllocationGranularity(&segment_granularity_, &prop,
+                                              CU_MEM_ALLOC_GRANULARITY_MINIMUM));
+    // the whole device memory could be mapped into the segment
+    segment_reserved_bytes_ = RoundUp(total_bytes, segment_granularity_);
+    CUdeviceptr dptr = 0;
+    OF_CU_CHECK(cuMemAddressReserve(&dptr, segment_reserved_bytes_, 0, 0, 0));
+    segment_ptr_ = reinterpret_cast<char*>(dptr);
+  }
+  Piece* last_piece = LastPieceOfExpandableSegment();
+  const bool merge_last_piece =
+      last_piece != nullptr && last_piece->is_free && last_piece->stream == stream;
+  const size_t required_bytes = aligned_size - (merge_last_piece ? last_piece->size : 0);
+  const size_t map_bytes = RoundUp(std::max(required_bytes, kMinBlockSize), segment_granularity_);
+  const size_t mapped_bytes = total_memory_bytes_;
+  if (mapped_bytes + map_bytes > segment_reserved_bytes_) { return false; }
+  if (free_bytes < kRemainBytes || map_bytes > free_bytes - kRemainBytes) {
+    ++stats_.extend_failure_num;
+    return false;
+  }
+
+  CUmemGenericAllocationHandle handle;
+  if (cuMemCreate(&handle, map_bytes, &prop, 0) != CUDA_SUCCESS) {
+    ++stats_.extend_failure_num;
+    return false;
+  }
+  const CUdeviceptr chunk_dptr = reinterpret_cast<CUdeviceptr>(segment_ptr_ + mapped_bytes);
+  OF_CU_CHECK(cuMemMap(chunk_dptr, map_bytes, 0, handle, 0));
+  CUmemAccessDesc access_desc = {};
+  access_desc.location = prop.location;
+  access_desc.flags = CU_MEM_ACCESS_FLAGS_PROT_READWRITE;
+  OF_CU_CHECK(cuMemSetAccess(chunk_dptr, map_bytes, &access_desc, 1));
+  segment_chunks_.push_back(SegmentChunk{mapped_bytes, map_bytes, handle});
+
+  // extend sucess
+  total_memory_bytes_ += map_bytes;
+  reserved_bytes_gauge_->Add(map_bytes);
+  ++stats_.extend_num;
+
+  Piece* piece = AllocatePiece();
+  piece->size = map_bytes;
+  piece->ptr = segment_ptr_ + mapped_bytes;
+  piece->prev = last_piece;
+  piece->next = nullptr;
+  piece->is_free = true;
+  piece->bin_num = kInvalidBinNum;
+  piece->stream = stream;
+  MarkPiece(piece);
+  if (last_piece == nullptr) {
+    CHECK(mem_ptr2block_.emplace(segment_ptr_, Block(piece)).second);
+  } else {
+    last_piece->next = piece;
+    mem_ptr2block_.at(segment_ptr_).size += map_bytes;
+  }
+  if (merge_last_piece) {
+    RemovePieceFromBin(last_piece);
+    MergeNeighbourFreePiece(last_piece, piece);
+    InsertPiece2Bin(last_piece);
+  } else {
+    InsertPiece2Bin(piece);
+  }
+  return true;
+}
+
+bool CudaAllocator::ShrinkExpandableSegment() {
+  Piece* last_piece = LastPieceOfExpandableSegment();
+  if (last_piece == nullptr || !last_piece->is_free) { return false; }
+  cudaSetDevice(device_id_);
+  if (last_piece->event != nullptr) { OF_CUDA_CHECK(cudaEventSynchronize(last_piece->event)); }
+  size_t unmapped_bytes = 0;
+  while (!segment_chunks_.empty()) {
+    const SegmentChunk& chunk = segment_chunks_.back();
+    char* chunk_ptr = segment_ptr_ + chunk.offset;
+    if (chunk_ptr < last_piece->ptr) { break; }
+    OF_CU_CHECK(cuMemUnmap(reinterpret_cast<CUdeviceptr>(chunk_ptr), chunk.size));
+    OF_CU_CHECK(cuMemRelease(chunk.handle));
+    unmapped_bytes += chunk.size;
+    segment_chunks_.pop_back();
+  }
+  if (unmapped_bytes == 0) { return false; }
+  ++stats_.gc_num;
+  stats_.gc_freed_bytes += unmapped_bytes;
+  total_memory_bytes_ -= unmapped_bytes;
+  reserved_bytes_gauge_->Add(-static_cast<int64_t>(unmapped_bytes));
+  RemovePieceFromBin(last_piece);
+  last_piece->size -= unmapped_bytes;
+  if (last_piece->size > 0) {
+    mem_ptr2block_.at(segment_ptr_).size -= unmapped_bytes;
+    InsertPiece2Bin(last_piece);
+  } else {
+    if (last_piece->prev == nullptr) {
+      mem_ptr2block_.erase(segment_ptr_);
+    } else {
+      last_piece->prev->next = nullptr;
+      mem_ptr2block_.at(segment_ptr_).size -= unmapped_bytes;
+    }
+    UnMarkPiece(last_piece);
+    DeallocatePiece(last_piece);
+  }
+  return true;
+}
+
+void CudaAllocator::ReleaseExpandableSegment() {
+  if (segment_ptr_ == nullptr) { return; }
+  for (const SegmentChunk& chunk : segment_chunks_) {
+    OF_CU_CHECK(cuMemUnmap(reinterpret_cast<CUdeviceptr>(segment_ptr_ + chunk.offset), chunk.size));
+    OF_CU_CHECK(cuMemRelease(chunk.handle));
+  }
+  segment_chunks_.clear();
+  OF_CU_CHECK(
+      cuMemAddressFree(reinterpret_cast<CUdeviceptr>(segment_ptr_), segment_reserved_bytes_));
+  segment_ptr_ = nullptr;
+}
+
+#else
+
+bool CudaAllocator::ExtendExpandableSegment(size_t aligned_size, cudaStream_t stream) {
+  UNIMPLEMENTED();
+  return false;
+}
+
+bool CudaAllocator::ShrinkExpandableSegment() {
+  UNIMPLEMENTED();
+  return false;
+}
+
+void CudaAllocator::ReleaseExpandableSegment() { CHECK(segment_ptr_ == nullptr); }
+
+#endif  // CUDA_VERSION >= 10020
+
+CudaAllocatorStats CudaAllocator::GetStats() const {
+  CudaAllocatorStats stats = stats_;
+  stats.reserved_bytes = total_memory_bytes_;
+  stats.block_num = mem_ptr2block_.size();
+  for (const auto& pair : stream2bins_) {
+    for (int32_t bin_num = 0; bin_num < kBinNumSize; ++bin_num) {
+      const Bin& bin = pair.second.at(bin_num);
+      stats.bin_free_piece_num.at(bin_num) += bin.pieces.size();
+      if (!bin.pieces.empty()) {
+        // pieces are ordered by size
+        stats.largest_free_piece_bytes =
+            std::max(stats.largest_free_piece_bytes, (*bin.pieces.rbegin())->size);
+      }
+    }
+  }
+  return stats;
+}
+
+void CudaAllocator::ResetPeakStats() { stats_.peak_allocated_bytes = stats_.allocated_bytes; }
+
+std::mutex* StreamBoundCudaAllocator::SharedCudaAllocatorMutex() {
+  static std::mutex mutex;
+  return &mutex;
+}
+
+HashMap<int64_t, std::weak_ptr<StreamBoundCudaAllocator::SharedCudaAllocator>>*
+StreamBoundCudaAllocator::MutDeviceId2SharedCudaAllocator() {
+  static HashMap<int64_t, std::weak_ptr<SharedCudaAllocator>> device_id2shared_allocator;
+  return &device_id2shared_allocator;
+}
+
+std::shared_ptr<StreamBoundCudaAllocator::SharedCudaAllocator>
+StreamBoundCudaAllocator::GetOrCreateSharedCudaAllocator(int64_t device_id) {
+  std::unique_lock<std::mutex> lock(*SharedCudaAllocatorMutex());
+  auto* device_id2shared_allocator = MutDeviceId2SharedCudaAllocator();
+  std::shared_ptr<SharedCudaAllocator> shared_allocator =
+      (*device_id2shared_allocator)[device_id].lock();
+  if (!shared_allocator) {
+    shared_allocator.reset(new SharedCudaAllocator(device_id));
+    (*device_id2shared_allocator)[device_id] = shared_allocator;
+  }
+  return shared_allocator;
+}
+
+std::shared_ptr<StreamBoundCudaAllocator::SharedCudaAllocator>
+StreamBoundCudaAllocator::FindSharedCudaAllocator(int64_t device_id) {
+  std::unique_lock<std::mutex> lock(*SharedCudaAllocatorMutex());
+  auto* device_id2shared_allocator = MutDeviceId2SharedCudaAllocator();
+  auto it = device_id2shared_allocator->find(device_id);
+  if (it == device_id2shared_allocator->end()) { return nullptr; }
+  return it->second.lock();
+}
+
+bool StreamBoundCudaAllocator::GetSharedCudaAllocatorStats(int64_t device_id,
+                                                           CudaAllocatorStats* stats) {
+  std::shared_ptr<SharedCudaAllocator> shared_allocator = FindSharedCudaAllocator(device_id);
+  if (!shared_allocator) { return false; }
+  std::unique_lock<std::mutex> lock(shared_allocator->mutex);
+  *stats = shared_allocator->allocator.GetStats();
+  return true;
+}
+
+void StreamBoundCudaAllocator::ResetSharedCudaAllocatorPeakStats(int64_t device_id) {
+  std::shared_ptr<SharedCudaAllocator> shared_allocator = FindSharedCudaAllocator(device_id);
+  if (!shared_allocator) { return; }
+  std::unique_lock<std::mutex> lock(shared_allocator->mutex);
+  shared_allocator->allocator.ResetPeakStats();
+}
+
+StreamBoundCudaAllocator::StreamBoundCudaAllocator(
+    int64_t device_id, const std::function<cudaStream_t()>& get_cuda_stream)
+    : Allocator(),
+      shared_allocator_(GetOrCreateSharedCudaAllocator(device_id)),
+      get_cuda_stream_(get_cuda_stream) {}
+
+void StreamBoundCudaAllocator::Allocate(char** mem_ptr, std::size_t size) {
+  cudaStream_t stream = get_cuda_stream_();
+  std::unique_lock<std::mutex> lock(shared_allocator_->mutex);
+  shared_allocator_->allocator.Allocate(mem_ptr, size, stream);
+}
+
+void StreamBoundCudaAllocator::Deallocate(char* mem_ptr, std::size_t size) {
+  std::unique_lock<std::mutex> lock(shared_allocator_->mutex);
+  shared_allocator_->allocator.Deallocate(mem_ptr, size);
+}
+
 }  // namespace vm
 }  // namespace oneflow
 
@@ -17,20 +17,66 @@ limitations under the License.
 #define ONEFLOW_CORE_VM_CUDA_ALLOCATOR_H_
 
 #include <cstdint>
+#include <mutex>
 #include "oneflow/core/vm/allocator.h"
 #include "oneflow/core/common/util.h"
+#include "oneflow/core/device/cuda_util.h"
+#include "oneflow/core/profiler/metrics.h"
 
 namespace oneflow {
 namespace vm {
 
+// A snapshot of the counters of a CudaAllocator
+struct CudaAllocatorStats {
+  // bytes held by cudaMalloc-ed Blocks
+  size_t reserved_bytes = 0;
+  // bytes of Pieces in use
+  size_t allocated_bytes = 0;
+  // max allocated_bytes since creation or the last ResetPeakStats()
+  size_t peak_allocated_bytes = 0;
+  size_t largest_free_piece_bytes = 0;
+  int64_t block_num = 0;
+  int64_t allocate_num = 0;
+  int64_t deallocate_num = 0;
+  // successful and failed AllocateBlockToExtendTotalMem calls
+  int64_t extend_num = 0;
+  int64_t extend_failure_num = 0;
+  // garbage collections which freed at least one Block
+  int64_t gc_num = 0;
+  size_t gc_freed_bytes = 0;
+  // free Piece number of each Bin, summed over all streams
+  std::vector<int64_t> bin_free_piece_num;
+  // allocation number of each Bin size class, e.g. [512, 1024) for Bin0
+  std::vector<int64_t> allocation_size_histogram;
+};
+
+#ifdef WITH_CUDA
+
+// CudaAllocator is stream-ordered. Every cuda stream owns its own Bins, so a Piece freed on one
+// stream is reused by the same stream without any synchronization. A Piece from another stream's
+// Bins is only reused after the cuda event recorded on its last-use stream has completed.
+//
+// With `use_expandable_segment', CudaAllocator reserves one virtual address range and maps
+// physical memory to its end on demand, so all Pieces live in one contiguous growable Block and
+// free Pieces are able to merge across extensions. It is enabled by the environment variable
+// ONEFLOW_VM_CUDA_ALLOCATOR_EXPANDABLE_SEGMENT and requires CUDA 10.2 or higher.
 class CudaAllocator final : public Allocator {
  public:
   explicit CudaAllocator(int64_t device_id);
+  CudaAllocator(int64_t device_id, bool use_expandable_segment);
   ~CudaAllocator() override;
 
+  // Allocate on the legacy default stream
   void Allocate(char** mem_ptr, std::size_t size) override;
+  void Allocate(char** mem_ptr, std::size_t size, cudaStream_t stream);
+  // The memory is considered in use by the stream it was allocated on until all the work
+  // already submitted to that stream finishes.
   void Deallocate(char* mem_ptr, std::size_t size) override;
 
+  CudaAllocatorStats GetStats() const;
+  // Restart peak tracking from the current allocated bytes, e.g. at the beginning of an iteration
+  void ResetPeakStats();
+
  private:
   static constexpr int32_t kInvalidBinNum = -1;
   static constexpr int32_t kBinNumSize = 20;
@@ -40,6 +86,8 @@ class CudaAllocator final : public Allocator {
   // If the Piece is_free = true, the pointer to the piece will be stored in the Bin structure of
   // the corresponding BinSize. Pieces are stored in a linked list. The Piece's prev and next are
   // continuous with the current Piece in physical memory.
+  // `stream' is the stream which last used the Piece. `event' is recorded on `stream' when the
+  // Piece is freed and is used to decide if other streams could reuse it.
   struct Piece {
     size_t size = 0;
     char* ptr = nullptr;
@@ -47,6 +95,8 @@ class CudaAllocator final : public Allocator {
     Piece* prev = nullptr;
     Piece* next = nullptr;
     int32_t bin_num = kInvalidBinNum;
+    cudaStream_t stream = nullptr;
+    cudaEvent_t event = nullptr;
   };
 
   // Bin is a structure that stores a set of pieces which is free and has similar size, and
@@ -81,16 +131,23 @@ class CudaAllocator final : public Allocator {
     Block(Piece* p) : size(p->size), ptr(p->ptr), start_piece(p) {}
   };
 
-  size_t BinSize4BinNum(int32_t bin_num) { return kCudaMemAllocAlignSize << bin_num; }
+  size_t BinSize4BinNum(int32_t bin_num) const { return kCudaMemAllocAlignSize << bin_num; }
 
-  int32_t BinNum4BinSize(size_t size) {
+  int32_t BinNum4BinSize(size_t size) const {
     uint64_t value = std::max(size, kCudaMemAllocAlignSize) >> 9;
     return std::min(kBinNumSize - 1, static_cast<int32_t>(63 ^ __builtin_clzll(value)));
   }
 
-  // Try find free Piece which size is larger than aligned_size in Bins.
+  // Bins of the stream, created on first use
+  std::vector<Bin>* MutBins4Stream(cudaStream_t stream);
+
+  // Try find free Piece which size is larger than aligned_size in Bins of `stream', and then in
+  // Bins of other streams whose last-use events have completed.
   // Return nullptr when find failure
-  Piece* FindPiece(size_t aligned_size);
+  Piece* FindPiece(size_t aligned_size, cudaStream_t stream);
+  Piece* FindPieceInBins(size_t aligned_size, std::vector<Bin>* bins, bool check_event);
+  // Take a free Piece out of its Bin for `stream', and split the tail if it is much larger
+  void UsePiece(Piece* piece, size_t aligned_size, cudaStream_t stream);
 
   // Insert the free Piece to the appropriate Bin which bin size is smaller than piece
   void InsertPiece2Bin(Piece* piece);
@@ -109,20 +166,84 @@ class CudaAllocator final : public Allocator {
 
   void MergeNeighbourFreePiece(Piece* lhs, Piece* rhs);
   void RemovePieceFromBin(Piece* piece);
+  // Neighbour free pieces are merged only if they belong to the same stream
+  bool IsMergeable(const Piece* piece, const Piece* neighbour) const;
+
+  cudaEvent_t AllocateEvent();
+  void DeallocateEvent(cudaEvent_t event);
+  void ReleasePieceEvent(Piece* piece);
 
-  bool AllocateBlockToExtendTotalMem(size_t aligned_size);
+  bool AllocateBlockToExtendTotalMem(size_t aligned_size, cudaStream_t stream);
   bool DeallocateFreeBlockForGarbageCollection();
 
+  // Physical memory mapped to [offset, offset + size) of the expandable segment
+  struct SegmentChunk {
+    size_t offset;
+    size_t size;
+    uint64_t handle;
+  };
+  // Map physical memory to the end of the segment and merge it with the last free Piece
+  bool ExtendExpandableSegment(size_t aligned_size, cudaStream_t stream);
+  // Unmap the chunks covered by the last free Piece
+  bool ShrinkExpandableSegment();
+  void ReleaseExpandableSegment();
+  Piece* LastPieceOfExpandableSegment();
+
   int64_t device_id_;
   size_t total_memory_bytes_;
   HashMap<char*, Block> mem_ptr2block_;
 
-  std::vector<Bin> bins_;
+  HashMap<cudaStream_t, std::vector<Bin>> stream2bins_;
+  std::vector<cudaEvent_t> recycle_events_;
+
+  bool use_expandable_segment_;
+  char* segment_ptr_;
+  size_t segment_reserved_bytes_;
+  size_t segment_granularity_;
+  std::vector<SegmentChunk> segment_chunks_;
   std::vector<std::unique_ptr<Piece>> pieces_;
   HashMap<char*, Piece*> ptr2piece_;
   Piece* recycle_piece_list_;
+
+  // counters only, the derived fields are computed in GetStats()
+  CudaAllocatorStats stats_;
+  // summed over the CudaAllocators of the device
+  profiler::Gauge* reserved_bytes_gauge_;
+  profiler::Gauge* allocated_bytes_gauge_;
+};
+
+// StreamBoundCudaAllocator allocates memory for one cuda stream from the CudaAllocator shared by
+// all StreamBoundCudaAllocators on the same device.
+class StreamBoundCudaAllocator final : public Allocator {
+ public:
+  StreamBoundCudaAllocator(int64_t device_id,
+                           const std::function<cudaStream_t()>& get_cuda_stream);
+  ~StreamBoundCudaAllocator() override = default;
+
+  void Allocate(char** mem_ptr, std::size_t size) override;
+  void Deallocate(char* mem_ptr, std::size_t size) override;
+
+  // Returns false if no stream on `device_id' has created the shared CudaAllocator
+  static bool GetSharedCudaAllocatorStats(int64_t device_id, CudaAllocatorStats* stats);
+  static void ResetSharedCudaAllocatorPeakStats(int64_t device_id);
+
+ private:
+  struct SharedCudaAllocator {
+    explicit SharedCudaAllocator(int64_t device_id) : allocator(device_id) {}
+    std::mutex mutex;
+    CudaAllocator allocator;
+  };
+  static std::shared_ptr<SharedCudaAllocator> GetOrCreateSharedCudaAllocator(int64_t device_id);
+  static std::shared_ptr<SharedCudaAllocator> FindSharedCudaAllocator(int64_t device_id);
+  static std::mutex* SharedCudaAllocatorMutex();
+  static HashMap<int64_t, std::weak_ptr<SharedCudaAllocator>>* MutDeviceId2SharedCudaAllocator();
+
+  std::shared_ptr<SharedCudaAllocator> shared_allocator_;
+  std::function<cudaStream_t()> get_cuda_stream_;
 };
 
+#endif  // WITH_CUDA
+
 }  // namespace vm
 }  // namespace oneflow
 
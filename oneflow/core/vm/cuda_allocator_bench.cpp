@@ -0,0 +1,80 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifdef WITH_CUDA
+#include <benchmark/benchmark.h>
+#include <random>
+#include "oneflow/core/vm/cuda_allocator.h"
+#include "oneflow/core/device/cuda_util.h"
+
+namespace oneflow {
+namespace vm {
+
+namespace {
+
+bool HasCudaDevice(benchmark::State& state) {
+  int gpu_num = 0;
+  if (cudaGetDeviceCount(&gpu_num) != cudaSuccess || gpu_num <= 0) {
+    state.SkipWithError("no GPU device");
+    return false;
+  }
+  OF_CUDA_CHECK(cudaSetDevice(0));
+  return true;
+}
+
+// steady-state cost of a cached allocation, the first iteration warms up the bins
+void BM_CudaAllocatorAllocateDeallocate(benchmark::State& state) {
+  if (!HasCudaDevice(state)) { return; }
+  const size_t size = state.range(0);
+  CudaAllocator allocator(0);
+  for (auto _ : state) {
+    char* ptr = nullptr;
+    allocator.Allocate(&ptr, size);
+    benchmark::DoNotOptimize(ptr);
+    allocator.Deallocate(ptr, size);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CudaAllocatorAllocateDeallocate)->RangeMultiplier(64)->Range(512, 512 << 18);
+
+// interleaved allocations of mixed sizes, which exercises splitting and merging of pieces
+void BM_CudaAllocatorMixedSizes(benchmark::State& state) {
+  if (!HasCudaDevice(state)) { return; }
+  const int64_t live_cnt = state.range(0);
+  CudaAllocator allocator(0);
+  std::mt19937 engine(0);
+  std::uniform_int_distribution<size_t> dist(1, 4 << 20);
+  std::vector<std::pair<char*, size_t>> live(live_cnt, std::make_pair(nullptr, 0));
+  int64_t cursor = 0;
+  for (auto _ : state) {
+    auto* slot = &live.at(cursor);
+    if (slot->first != nullptr) { allocator.Deallocate(slot->first, slot->second); }
+    slot->second = dist(engine);
+    allocator.Allocate(&slot->first, slot->second);
+    cursor = (cursor + 1) % live_cnt;
+  }
+  for (const auto& pair : live) {
+    if (pair.first != nullptr) { allocator.Deallocate(pair.first, pair.second); }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CudaAllocatorMixedSizes)->Arg(16)->Arg(256);
+
+}  // namespace
+
+}  // namespace vm
+}  // namespace oneflow
+
+#endif  // WITH_CUDA
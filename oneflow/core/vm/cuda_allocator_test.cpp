@@ -17,6 +17,7 @@ limitations under the License.
 #include "oneflow/core/vm/cuda_allocator.h"
 #include "oneflow/core/vm/thread_safe_allocator.h"
 #include "oneflow/core/device/cuda_util.h"
+#include <random>
 
 namespace oneflow {
 namespace vm {
@@ -89,6 +90,90 @@ TEST(CudaAllocator, cuda_allocator) {
   a->Deallocate(data_ptr_1, 2048 * sizeof(float));
 }
 
+TEST(CudaAllocator, stream_ordered_reuse) {
+  int gpu_num = -1;
+  cudaGetDeviceCount(&gpu_num);
+  if (gpu_num <= 0) {
+    LOG(INFO) << "CudaAllocator Test: Skip because of non GPU device.";
+    return;
+  }
+  ASSERT_TRUE(cudaSuccess == cudaSetDevice(0));
+  cudaStream_t stream0;
+  cudaStream_t stream1;
+  ASSERT_TRUE(cudaSuccess == cudaStreamCreate(&stream0));
+  ASSERT_TRUE(cudaSuccess == cudaStreamCreate(&stream1));
+  {
+    CudaAllocator a(0);
+    char* ptr0 = nullptr;
+    a.Allocate(&ptr0, 4096, stream0);
+    ASSERT_TRUE(ptr0 != nullptr);
+    a.Deallocate(ptr0, 4096);
+    // reused by the same stream without waiting
+    char* ptr1 = nullptr;
+    a.Allocate(&ptr1, 4096, stream0);
+    ASSERT_EQ(ptr0, ptr1);
+    a.Deallocate(ptr1, 4096);
+    // reused by another stream after the last-use event completed
+    ASSERT_TRUE(cudaSuccess == cudaStreamSynchronize(stream0));
+    char* ptr2 = nullptr;
+    a.Allocate(&ptr2, 4096, stream1);
+    ASSERT_EQ(ptr0, ptr2);
+    a.Deallocate(ptr2, 4096);
+  }
+  ASSERT_TRUE(cudaSuccess == cudaStreamDestroy(stream0));
+  ASSERT_TRUE(cudaSuccess == cudaStreamDestroy(stream1));
+}
+
+#if CUDA_VERSION >= 10020
+
+// Pieces of different extensions only merge in the expandable segment, so freeing many mid-sized
+// allocations leaves enough contiguous memory for one allocation of their total size.
+TEST(CudaAllocator, expandable_segment_fragmentation) {
+  int gpu_num = -1;
+  cudaGetDeviceCount(&gpu_num);
+  if (gpu_num <= 0) {
+    LOG(INFO) << "CudaAllocator Test: Skip because of non GPU device.";
+    return;
+  }
+  ASSERT_TRUE(cudaSuccess == cudaSetDevice(0));
+  const size_t kPieceBytes = 24 * 1048576;
+  const int kPieceNum = 16;
+  size_t free_bytes = -1;
+  size_t total_bytes = -1;
+  ASSERT_TRUE(cudaSuccess == cudaMemGetInfo(&free_bytes, &total_bytes));
+  if (free_bytes < 4 * kPieceBytes * kPieceNum) {
+    LOG(INFO) << "CudaAllocator Test: Skip because of not enough memory in GPU 0";
+    return;
+  }
+  CudaAllocator a(0, /*use_expandable_segment=*/true);
+  std::mt19937 gen(0);
+  std::uniform_int_distribution<size_t> dist(1, kPieceBytes);
+  for (int iter = 0; iter < 8; ++iter) {
+    std::vector<std::pair<char*, size_t>> ptrs;
+    for (int i = 0; i < kPieceNum; ++i) {
+      const size_t size = iter == 0 ? kPieceBytes : dist(gen);
+      char* ptr = nullptr;
+      a.Allocate(&ptr, size);
+      ASSERT_TRUE(ptr != nullptr);
+      ptrs.emplace_back(ptr, size);
+    }
+    std::shuffle(ptrs.begin(), ptrs.end(), gen);
+    for (const auto& pair : ptrs) { a.Deallocate(pair.first, pair.second); }
+  }
+  ASSERT_TRUE(cudaSuccess == cudaDeviceSynchronize());
+  const CudaAllocatorStats stats_before = a.GetStats();
+  ASSERT_EQ(stats_before.allocated_bytes, 0);
+  ASSERT_EQ(stats_before.block_num, 1);
+  ASSERT_EQ(stats_before.largest_free_piece_bytes, stats_before.reserved_bytes);
+  char* ptr = nullptr;
+  a.Allocate(&ptr, kPieceBytes * kPieceNum);
+  ASSERT_TRUE(ptr != nullptr);
+  ASSERT_EQ(a.GetStats().reserved_bytes, stats_before.reserved_bytes);
+  a.Deallocate(ptr, kPieceBytes * kPieceNum);
+}
+
+#endif  // CUDA_VERSION >= 10020
+
 }  // namespace vm
 }  // namespace oneflow
 
@@ -0,0 +1,59 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_VM_CUDA_COMM_STREAM_TYPE_H_
+#define ONEFLOW_CORE_VM_CUDA_COMM_STREAM_TYPE_H_
+
+#include "oneflow/core/object_msg/flat_msg_view.h"
+#include "oneflow/core/vm/stream_type.h"
+#include "oneflow/core/vm/instruction_type.h"
+#include "oneflow/core/vm/instruction.msg.h"
+#include "oneflow/core/vm/stream.msg.h"
+#include "oneflow/core/vm/thread_ctx.msg.h"
+#include "oneflow/core/vm/cuda_instruction_status_querier.h"
+#include "oneflow/core/vm/cuda_stream_handle_device_context.h"
+#include "oneflow/core/device/cuda_util.h"
+#include "oneflow/core/common/util.h"
+#include "oneflow/core/kernel/kernel_util.h"
+
+namespace oneflow {
+namespace vm {
+
+// Collective kernels run on this stream so that eager all-reduce overlaps with compute kernels.
+class CudaCommStreamType final : public StreamType {
+ public:
+  CudaCommStreamType() = default;
+  ~CudaCommStreamType() = default;
+
+  const char* device_tag() const override { return "gpu"; }
+
+  void InitDeviceCtx(std::unique_ptr<DeviceCtx>* device_ctx, Stream* stream) const override;
+
+  void InitInstructionStatus(const Stream& stream,
+                             InstructionStatusBuffer* status_buffer) const override;
+  void DeleteInstructionStatus(const Stream& stream,
+                               InstructionStatusBuffer* status_buffer) const override;
+  bool QueryInstructionStatusDone(const Stream& stream,
+                                  const InstructionStatusBuffer& status_buffer) const override;
+  void Compute(Instruction* instruction) const override;
+  ObjectMsgPtr<StreamDesc> MakeStreamDesc(const Resource& resource,
+                                          int64_t this_machine_id) const override;
+  bool SharingVirtualMachineThread() const override { return true; }
+};
+
+}  // namespace vm
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_VM_CUDA_COMM_STREAM_TYPE_H_
@@ -34,7 +34,8 @@ void CudaCopyH2DStreamType::InitInstructionStatus(const Stream& stream,
 
 void CudaCopyH2DStreamType::DeleteInstructionStatus(const Stream& stream,
                                                     InstructionStatusBuffer* status_buffer) const {
-  // do nothing
+  auto* querier = CudaInstrStatusQuerier::MutCast(status_buffer->mut_buffer()->mut_data());
+  querier->~CudaInstrStatusQuerier();
 }
 
 bool CudaCopyH2DStreamType::QueryInstructionStatusDone(
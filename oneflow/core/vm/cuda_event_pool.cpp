@@ -0,0 +1,52 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifdef WITH_CUDA
+
+#include "oneflow/core/vm/cuda_event_pool.h"
+
+namespace oneflow {
+namespace vm {
+
+/* static */ CudaEventPool* CudaEventPool::Singleton() {
+  // Never destroyed, the cuda runtime may have been unloaded when the static objects are.
+  static CudaEventPool* pool = new CudaEventPool();
+  return pool;
+}
+
+cudaEvent_t CudaEventPool::Acquire(int64_t device_id) {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto& free_events = device_id2free_events_[device_id];
+    if (!free_events.empty()) {
+      cudaEvent_t event = free_events.back();
+      free_events.pop_back();
+      return event;
+    }
+  }
+  cudaEvent_t event;
+  OF_CUDA_CHECK(cudaEventCreateWithFlags(&event, cudaEventBlockingSync | cudaEventDisableTiming));
+  return event;
+}
+
+void CudaEventPool::Release(int64_t device_id, cudaEvent_t event) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  device_id2free_events_[device_id].push_back(event);
+}
+
+}  // namespace vm
+}  // namespace oneflow
+
+#endif
@@ -0,0 +1,52 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_VM_CUDA_EVENT_POOL_H_
+#define ONEFLOW_CORE_VM_CUDA_EVENT_POOL_H_
+
+#include "oneflow/core/common/util.h"
+#include "oneflow/core/device/cuda_util.h"
+
+namespace oneflow {
+namespace vm {
+
+#ifdef WITH_CUDA
+
+// Recycles the events that the cuda streams record for their instructions, creating and
+// destroying an event costs much more than recording it.
+class CudaEventPool final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(CudaEventPool);
+  ~CudaEventPool() = default;
+
+  static CudaEventPool* Singleton();
+
+  // Returns an event created on the current device, which must be `device_id`.
+  cudaEvent_t Acquire(int64_t device_id);
+  void Release(int64_t device_id, cudaEvent_t event);
+
+ private:
+  CudaEventPool() = default;
+
+  std::mutex mutex_;
+  HashMap<int64_t, std::vector<cudaEvent_t>> device_id2free_events_;
+};
+
+#endif
+
+}  // namespace vm
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_VM_CUDA_EVENT_POOL_H_
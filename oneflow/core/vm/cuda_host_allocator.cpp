@@ -16,19 +16,52 @@ limitations under the License.
 #ifdef WITH_CUDA
 
 #include "oneflow/core/vm/cuda_host_allocator.h"
+#include "oneflow/core/vm/size_class_caching_allocator.h"
 #include "oneflow/core/device/cuda_util.h"
+#include "oneflow/core/common/util.h"
 
 namespace oneflow {
 namespace vm {
 
+namespace {
+
+class PinnedHostAllocator final : public Allocator {
+ public:
+  PinnedHostAllocator() = default;
+  ~PinnedHostAllocator() override = default;
+
+  void Allocate(char** mem_ptr, std::size_t size) override {
+    OF_CUDA_CHECK(cudaMallocHost(mem_ptr, size));
+  }
+  void Deallocate(char* mem_ptr, std::size_t size) override {
+    // thread local magazines may be flushed after the cuda runtime has been unloaded
+    cudaError_t err = cudaFreeHost(mem_ptr);
+    if (err != cudaErrorCudartUnloading) { OF_CUDA_CHECK(err); }
+  }
+};
+
+}  // namespace
+
+SizeClassCachingAllocator* CudaHostAllocator::MutCachingAllocator() {
+  // never destructed, cached pinned memory is released with the process
+  static SizeClassCachingAllocator* caching_allocator = new SizeClassCachingAllocator(
+      std::unique_ptr<Allocator>(new PinnedHostAllocator()),
+      ParseIntegerFromEnv("ONEFLOW_VM_CUDA_HOST_ALLOCATOR_MAX_CACHED_BYTES", 512 * 1024 * 1024));
+  return caching_allocator;
+}
+
 void CudaHostAllocator::Allocate(char** mem_ptr, std::size_t size) {
-  OF_CUDA_CHECK(cudaMallocHost(mem_ptr, size));
+  MutCachingAllocator()->Allocate(mem_ptr, size);
 }
 
 void CudaHostAllocator::Deallocate(char* mem_ptr, std::size_t size) {
-  OF_CUDA_CHECK(cudaFreeHost(mem_ptr));
+  MutCachingAllocator()->Deallocate(mem_ptr, size);
 }
 
+void CudaHostAllocator::Trim() { MutCachingAllocator()->Trim(); }
+
+size_t CudaHostAllocator::cached_bytes() { return MutCachingAllocator()->cached_bytes(); }
+
 }  // namespace vm
 }  // namespace oneflow
 
@@ -22,6 +22,11 @@ limitations under the License.
 namespace oneflow {
 namespace vm {
 
+class SizeClassCachingAllocator;
+
+// All CudaHostAllocators share one size class cache of pinned memory, because cudaMallocHost and
+// cudaFreeHost synchronize the device. The retention limit is configured by the environment
+// variable ONEFLOW_VM_CUDA_HOST_ALLOCATOR_MAX_CACHED_BYTES.
 class CudaHostAllocator final : public Allocator {
  public:
   explicit CudaHostAllocator() : Allocator() {}
@@ -29,6 +34,13 @@ class CudaHostAllocator final : public Allocator {
 
   void Allocate(char** mem_ptr, std::size_t size) override;
   void Deallocate(char* mem_ptr, std::size_t size) override;
+
+  // Returns the cached pinned memory to the cuda driver
+  static void Trim();
+  static size_t cached_bytes();
+
+ private:
+  static SizeClassCachingAllocator* MutCachingAllocator();
 };
 
 }  // namespace vm
@@ -17,18 +17,25 @@ limitations under the License.
 
 #include "oneflow/core/vm/cuda_instruction_status_querier.h"
 #include "oneflow/core/device/device_context.h"
+#include "oneflow/core/vm/cuda_event_pool.h"
 
 namespace oneflow {
 namespace vm {
 
+CudaInstrStatusQuerier::~CudaInstrStatusQuerier() {
+  if (has_event_) { CudaEventPool::Singleton()->Release(device_id_, event_); }
+}
+
 bool CudaInstrStatusQuerier::event_completed() const {
-  cudaSetDevice(device_id_);
-  return cudaEventQuery(event_) == cudaSuccess;
+  // Querying an event does not depend on the current device.
+  if (!event_completed_) { event_completed_ = (cudaEventQuery(event_) == cudaSuccess); }
+  return event_completed_;
 }
 
 void CudaInstrStatusQuerier::SetLaunched(DeviceCtx* device_ctx) {
   cudaSetDevice(device_id_);
-  OF_CUDA_CHECK(cudaEventCreateWithFlags(&event_, cudaEventBlockingSync | cudaEventDisableTiming));
+  event_ = CudaEventPool::Singleton()->Acquire(device_id_);
+  has_event_ = true;
   OF_CUDA_CHECK(cudaEventRecord(event_, device_ctx->cuda_stream()));
   launched_ = true;
 }
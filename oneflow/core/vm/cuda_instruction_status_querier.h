@@ -27,7 +27,7 @@ namespace vm {
 #ifdef WITH_CUDA
 class CudaInstrStatusQuerier {
  public:
-  ~CudaInstrStatusQuerier() = default;
+  ~CudaInstrStatusQuerier();
 
   bool done() const { return launched_ && event_completed(); }
   void SetLaunched(DeviceCtx* device_ctx);
@@ -48,6 +48,9 @@ class CudaInstrStatusQuerier {
 
   volatile bool launched_;
   int64_t device_id_;
+  // Set once the event is seen completed, so that the done instructions are not queried again.
+  mutable bool event_completed_ = false;
+  bool has_event_ = false;
   cudaEvent_t event_;
 };
 
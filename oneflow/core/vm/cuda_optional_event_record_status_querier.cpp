@@ -17,20 +17,25 @@ limitations under the License.
 
 #include "oneflow/core/vm/cuda_optional_event_record_status_querier.h"
 #include "oneflow/core/device/device_context.h"
+#include "oneflow/core/vm/cuda_event_pool.h"
 
 namespace oneflow {
 namespace vm {
 
+CudaOptionalEventRecordStatusQuerier::~CudaOptionalEventRecordStatusQuerier() {
+  if (has_event_) { CudaEventPool::Singleton()->Release(device_id_, event_); }
+}
+
 bool CudaOptionalEventRecordStatusQuerier::event_completed() const {
-  cudaSetDevice(device_id_);
-  return cudaEventQuery(event_) == cudaSuccess;
+  if (!event_completed_) { event_completed_ = (cudaEventQuery(event_) == cudaSuccess); }
+  return event_completed_;
 }
 
 void CudaOptionalEventRecordStatusQuerier::SetLaunched(DeviceCtx* device_ctx) {
   if (has_event_record_) {
     cudaSetDevice(device_id_);
-    OF_CUDA_CHECK(
-        cudaEventCreateWithFlags(&event_, cudaEventBlockingSync | cudaEventDisableTiming));
+    event_ = CudaEventPool::Singleton()->Acquire(device_id_);
+    has_event_ = true;
     OF_CUDA_CHECK(cudaEventRecord(event_, device_ctx->cuda_stream()));
   }
   launched_ = true;
@@ -28,7 +28,7 @@ namespace vm {
 #ifdef WITH_CUDA
 class CudaOptionalEventRecordStatusQuerier {
  public:
-  ~CudaOptionalEventRecordStatusQuerier() = default;
+  ~CudaOptionalEventRecordStatusQuerier();
 
   bool done() const { return launched_ && (!has_event_record_ || event_completed()); }
   void set_has_event_record(bool val) { has_event_record_ = val; }
@@ -52,6 +52,8 @@ class CudaOptionalEventRecordStatusQuerier {
   std::atomic<bool> launched_;
   std::atomic<bool> has_event_record_;
   int64_t device_id_;
+  mutable bool event_completed_ = false;
+  bool has_event_ = false;
   cudaEvent_t event_;
 };
 
@@ -21,7 +21,7 @@ limitations under the License.
 #include "oneflow/core/device/cuda_stream_handle.h"
 #include "oneflow/core/common/callback.msg.h"
 #include "oneflow/core/vm/cuda_allocator.h"
-#include "oneflow/core/vm/thread_safe_allocator.h"
+#include "oneflow/core/vm/workspace_arena.h"
 
 namespace oneflow {
 namespace vm {
@@ -37,8 +37,9 @@ class CudaStreamHandleDeviceCtx : public DeviceCtx {
   CudaStreamHandleDeviceCtx(CallbackMsgListPtr callback_msg_list, int64_t device_id)
       : cuda_handler_(new CudaStreamHandle(nullptr)),
         callback_msg_list_(callback_msg_list),
-        cuda_allocator_(
-            new ThreadSafeAllocator(std::unique_ptr<Allocator>(new CudaAllocator(device_id)))) {}
+        cuda_allocator_(new StreamBoundCudaAllocator(
+            device_id, [this]() -> cudaStream_t { return *(cuda_handler_->cuda_stream()); })),
+        workspace_arena_(new WorkspaceArena(cuda_allocator_.get(), kWorkspaceTrimInterval)) {}
 
   const cudaStream_t& cuda_stream() const override { return *(cuda_handler_->cuda_stream()); }
   const cublasHandle_t& cublas_pmh_handle() const override {
@@ -59,11 +60,15 @@ class CudaStreamHandleDeviceCtx : public DeviceCtx {
   }
 
   vm::Allocator* mut_allocator() override { return cuda_allocator_.get(); }
+  vm::WorkspaceArena* mut_workspace_arena() override { return workspace_arena_.get(); }
 
  protected:
+  static const size_t kWorkspaceTrimInterval = 1024;
+
   std::unique_ptr<CudaStreamHandle> cuda_handler_;
   CallbackMsgListPtr callback_msg_list_;
   std::unique_ptr<Allocator> cuda_allocator_;
+  std::unique_ptr<WorkspaceArena> workspace_arena_;
 };
 
 #endif  // WITH_CUDA
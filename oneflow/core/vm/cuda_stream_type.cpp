@@ -41,7 +41,9 @@ void CudaStreamType::InitInstructionStatus(const Stream& stream,
 
 void CudaStreamType::DeleteInstructionStatus(const Stream& stream,
                                              InstructionStatusBuffer* status_buffer) const {
-  // do nothing
+  auto* querier =
+      CudaOptionalEventRecordStatusQuerier::MutCast(status_buffer->mut_buffer()->mut_data());
+  querier->~CudaOptionalEventRecordStatusQuerier();
 }
 
 bool CudaStreamType::QueryInstructionStatusDone(
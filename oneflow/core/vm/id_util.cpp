@@ -13,6 +13,7 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 */
+#include <atomic>
 #include <climits>
 #include <glog/logging.h>
 #include "oneflow/core/vm/id_util.h"
@@ -29,8 +30,8 @@ static const int64_t kErrorCodeLimit = 4096;
 static_assert(kMachineNumberLimit >= kErrorCodeLimit, "");
 
 int64_t ObjectIdCounter() {
-  static int64_t counter = 0;
-  return (counter += kMachineNumberLimit);
+  static std::atomic<int64_t> counter(0);
+  return counter.fetch_add(kMachineNumberLimit) + kMachineNumberLimit;
 }
 
 int64_t NewLogicalObjectIdFromCounter() { return ObjectIdCounter() + kMachineNumberLimit - 1; }
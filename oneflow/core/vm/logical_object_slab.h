@@ -0,0 +1,72 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_VM_LOGICAL_OBJECT_SLAB_H_
+#define ONEFLOW_CORE_VM_LOGICAL_OBJECT_SLAB_H_
+
+#include <vector>
+#include "oneflow/core/vm/id_util.h"
+
+namespace oneflow {
+namespace vm {
+
+class LogicalObject;
+
+// Direct-mapped table in front of VirtualMachine::id2logical_object.
+// A slot remembers the id it was filled for, so colliding ids only evict each other and fall
+// back to the map. Slots are cleared before their logical object is erased, so a stale pointer
+// is never returned.
+class LogicalObjectSlab final {
+ public:
+  LogicalObjectSlab(const LogicalObjectSlab&) = delete;
+  LogicalObjectSlab(LogicalObjectSlab&&) = delete;
+  LogicalObjectSlab() : slots_(1 << kLog2Capacity) {}
+  ~LogicalObjectSlab() = default;
+
+  LogicalObject* Find(ObjectId id) const {
+    const Slot& slot = slots_[SlotIndex(id)];
+    return slot.id == id ? slot.logical_object : nullptr;
+  }
+  void Put(ObjectId id, LogicalObject* logical_object) {
+    Slot* slot = &slots_[SlotIndex(id)];
+    slot->id = id;
+    slot->logical_object = logical_object;
+  }
+  void Erase(ObjectId id) {
+    Slot* slot = &slots_[SlotIndex(id)];
+    if (slot->id == id) { *slot = Slot(); }
+  }
+
+ private:
+  static const int kLog2Capacity = 16;
+
+  struct Slot {
+    // 0 is an error id and never names a logical object
+    ObjectId id = 0;
+    LogicalObject* logical_object = nullptr;
+  };
+
+  static size_t SlotIndex(ObjectId id) {
+    // fibonacci hashing, ids are strided by the machine number limit
+    return (static_cast<uint64_t>(id) * 0x9E3779B97F4A7C15ULL) >> (64 - kLog2Capacity);
+  }
+
+  std::vector<Slot> slots_;
+};
+
+}  // namespace vm
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_VM_LOGICAL_OBJECT_SLAB_H_
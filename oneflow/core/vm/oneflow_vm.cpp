@@ -14,12 +14,14 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #include "oneflow/core/vm/oneflow_vm.h"
+#include <chrono>
 #include "oneflow/core/vm/instruction.msg.h"
 #include "oneflow/core/vm/no_arg_cb_phy_instr_operand.h"
 #include "oneflow/core/vm/vm_util.h"
 #include "oneflow/core/common/blocking_counter.h"
 #include "oneflow/core/control/global_process_ctx.h"
 #include "oneflow/core/job/global_for.h"
+#include "oneflow/core/thread/thread_affinity.h"
 
 namespace oneflow {
 
@@ -31,7 +33,10 @@ OneflowVM::OneflowVM(const Resource& resource, int64_t this_machine_id)
   }
   exiting_ = false;
   scheduler_exited_ = false;
-  schedule_thread_ = std::thread(&OneflowVM::Loop, this);
+  schedule_thread_ = std::thread([this]() {
+    BindCurrentThreadToRoleCores(ThreadRole::kVm);
+    Loop();
+  });
 }
 
 namespace {
@@ -58,6 +63,7 @@ void ControlSync(vm::VirtualMachine* vm) {
 OneflowVM::~OneflowVM() {
   ControlSync(mut_vm());
   exiting_ = true;
+  mut_vm()->mut_scheduler_notifier()->Notify();
   OBJECT_MSG_LIST_UNSAFE_FOR_EACH_PTR(vm_->mut_thread_ctx_list(), thread_ctx) {
     thread_ctx->mut_pending_instruction_list()->Close();
   }
@@ -69,7 +75,31 @@ OneflowVM::~OneflowVM() {
 
 void OneflowVM::Loop() {
   auto* vm = mut_vm();
-  while (!exiting_) { vm->Schedule(); }
+  // An idle scheduler keeps polling for a while, the next instructions of a busy process
+  // usually arrive soon, and then parks until any is received.
+  static const int64_t kIdleSpinMicroseconds =
+      ParseIntegerFromEnv("ONEFLOW_VM_SCHEDULER_IDLE_SPIN_US", 200);
+  auto idle_start = std::chrono::steady_clock::now();
+  bool idle = false;
+  while (!exiting_) {
+    vm->Schedule();
+    if (!vm->Empty()) {
+      idle = false;
+      continue;
+    }
+    const auto now = std::chrono::steady_clock::now();
+    if (!idle) {
+      idle = true;
+      idle_start = now;
+    }
+    if (std::chrono::duration_cast<std::chrono::microseconds>(now - idle_start).count()
+        < kIdleSpinMicroseconds) {
+      continue;
+    }
+    vm->mut_scheduler_notifier()->Park(
+        [&]() { return exiting_ || !vm->pending_msg_list().empty(); });
+    idle = false;
+  }
   scheduler_exited_ = true;
 }
 
@@ -0,0 +1,61 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_VM_SCHEDULER_NOTIFIER_H_
+#define ONEFLOW_CORE_VM_SCHEDULER_NOTIFIER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+namespace oneflow {
+namespace vm {
+
+// Wakes the scheduler thread parked while the virtual machine is idle. Notifying a running
+// scheduler costs an atomic load.
+class SchedulerNotifier final {
+ public:
+  SchedulerNotifier() : parked_(false) {}
+  ~SchedulerNotifier() = default;
+
+  // Called after the work that `Park` waits for is published.
+  void Notify() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!parked_.load(std::memory_order_seq_cst)) { return; }
+    std::unique_lock<std::mutex> lock(mutex_);
+    cond_.notify_one();
+  }
+
+  // Blocks the scheduler thread until `Ready` returns true, which is checked again after every
+  // notification.
+  template<typename ReadyT>
+  void Park(const ReadyT& Ready) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    parked_.store(true, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    cond_.wait(lock, Ready);
+    parked_.store(false, std::memory_order_relaxed);
+  }
+
+ private:
+  std::atomic<bool> parked_;
+  std::mutex mutex_;
+  std::condition_variable cond_;
+};
+
+}  // namespace vm
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_VM_SCHEDULER_NOTIFIER_H_
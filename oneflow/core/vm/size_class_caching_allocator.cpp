@@ -0,0 +1,257 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <atomic>
+#include <unordered_map>
+#include "oneflow/core/vm/size_class_caching_allocator.h"
+#include "oneflow/core/common/util.h"
+
+namespace oneflow {
+namespace vm {
+
+namespace {
+
+const int32_t kMinSizeClassShift = 6;  // 64B
+
+}  // namespace
+
+const int32_t SizeClassCachingAllocator::kInvalidSizeClass;
+const int32_t SizeClassCachingAllocator::kSizeClassNum;
+const int32_t SizeClassCachingAllocator::kMaxMagazineSizeClass;
+const size_t SizeClassCachingAllocator::kMagazineCapacity;
+
+struct SizeClassCachingAllocator::Pool final {
+  Pool(std::unique_ptr<Allocator>&& backend, size_t max_cached)
+      : id(NewId()),
+        backend_allocator(std::move(backend)),
+        size_class2ptrs(kSizeClassNum),
+        cached_bytes(0),
+        max_cached_bytes(max_cached) {}
+
+  static uint64_t NewId() {
+    static std::atomic<uint64_t> id_counter(0);
+    return ++id_counter;
+  }
+
+  // ids are never reused, so a magazine can not be mistaken for the one of a destructed pool
+  const uint64_t id;
+  std::unique_ptr<Allocator> backend_allocator;
+  std::mutex mutex;
+  std::vector<std::vector<char*>> size_class2ptrs;
+  size_t cached_bytes;
+  size_t max_cached_bytes;
+};
+
+namespace {
+
+using Pool = SizeClassCachingAllocator::Pool;
+
+struct Magazine final {
+  std::weak_ptr<Pool> pool;
+  std::vector<std::vector<char*>> size_class2ptrs;
+};
+
+void ReleaseToBackend(Pool* pool, int32_t size_class, std::vector<char*>* ptrs) {
+  for (char* ptr : *ptrs) {
+    pool->backend_allocator->Deallocate(ptr, SizeClassCachingAllocator::SizeClassBytes(size_class));
+  }
+  ptrs->clear();
+}
+
+// Moves the ptrs of `magazine' to its pool. Ptrs beyond the pool capacity are released.
+void FlushMagazine(Magazine* magazine) {
+  std::shared_ptr<Pool> pool = magazine->pool.lock();
+  if (!pool) { return; }
+  std::vector<char*> released;
+  for (int32_t i = 0; i < magazine->size_class2ptrs.size(); ++i) {
+    auto* ptrs = &magazine->size_class2ptrs.at(i);
+    if (ptrs->empty()) { continue; }
+    const size_t bytes = SizeClassCachingAllocator::SizeClassBytes(i);
+    {
+      std::unique_lock<std::mutex> lock(pool->mutex);
+      for (char* ptr : *ptrs) {
+        if (pool->cached_bytes + bytes <= pool->max_cached_bytes) {
+          pool->size_class2ptrs.at(i).push_back(ptr);
+          pool->cached_bytes += bytes;
+        } else {
+          released.push_back(ptr);
+        }
+      }
+    }
+    ptrs->clear();
+    ReleaseToBackend(pool.get(), i, &released);
+  }
+}
+
+struct ThreadLocalMagazines final {
+  ~ThreadLocalMagazines() {
+    for (auto& pair : pool_id2magazine) { FlushMagazine(&pair.second); }
+  }
+
+  std::unordered_map<uint64_t, Magazine> pool_id2magazine;
+};
+
+Magazine* MutThreadLocalMagazine(const std::shared_ptr<Pool>& pool) {
+  static thread_local ThreadLocalMagazines magazines;
+  auto iter = magazines.pool_id2magazine.find(pool->id);
+  if (iter != magazines.pool_id2magazine.end()) { return &iter->second; }
+  // drop the magazines of destructed pools
+  for (auto it = magazines.pool_id2magazine.begin(); it != magazines.pool_id2magazine.end();) {
+    if (it->second.pool.expired()) {
+      it = magazines.pool_id2magazine.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  Magazine* magazine = &magazines.pool_id2magazine[pool->id];
+  magazine->pool = pool;
+  magazine->size_class2ptrs.resize(SizeClassCachingAllocator::kMaxMagazineSizeClass + 1);
+  for (auto& ptrs : magazine->size_class2ptrs) {
+    ptrs.reserve(SizeClassCachingAllocator::kMagazineCapacity);
+  }
+  return magazine;
+}
+
+}  // namespace
+
+SizeClassCachingAllocator::SizeClassCachingAllocator(
+    std::unique_ptr<Allocator>&& backend_allocator, size_t max_cached_bytes)
+    : pool_(new Pool(std::move(backend_allocator), max_cached_bytes)) {}
+
+SizeClassCachingAllocator::~SizeClassCachingAllocator() { Trim(); }
+
+int32_t SizeClassCachingAllocator::SizeClass4Size(size_t size) {
+  if (size == 0) { return kInvalidSizeClass; }
+  int32_t size_class = 0;
+  size_t class_bytes = size_t(1) << kMinSizeClassShift;
+  while (class_bytes < size) {
+    ++size_class;
+    if (size_class == kSizeClassNum) { return kInvalidSizeClass; }
+    class_bytes <<= 1;
+  }
+  return size_class;
+}
+
+size_t SizeClassCachingAllocator::SizeClassBytes(int32_t size_class) {
+  return size_t(1) << (size_class + kMinSizeClassShift);
+}
+
+void SizeClassCachingAllocator::Allocate(char** mem_ptr, std::size_t size) {
+  const int32_t size_class = SizeClass4Size(size);
+  if (size_class == kInvalidSizeClass) {
+    pool_->backend_allocator->Allocate(mem_ptr, size);
+    return;
+  }
+  if (size_class <= kMaxMagazineSizeClass) {
+    auto* ptrs = &MutThreadLocalMagazine(pool_)->size_class2ptrs.at(size_class);
+    if (!ptrs->empty()) {
+      *mem_ptr = ptrs->back();
+      ptrs->pop_back();
+      return;
+    }
+  }
+  if (AllocateFromPool(size_class, mem_ptr)) { return; }
+  pool_->backend_allocator->Allocate(mem_ptr, SizeClassBytes(size_class));
+}
+
+void SizeClassCachingAllocator::Deallocate(char* mem_ptr, std::size_t size) {
+  if (mem_ptr == nullptr) { return; }
+  const int32_t size_class = SizeClass4Size(size);
+  if (size_class == kInvalidSizeClass) {
+    pool_->backend_allocator->Deallocate(mem_ptr, size);
+    return;
+  }
+  if (size_class <= kMaxMagazineSizeClass) {
+    auto* ptrs = &MutThreadLocalMagazine(pool_)->size_class2ptrs.at(size_class);
+    if (ptrs->size() < kMagazineCapacity) {
+      ptrs->push_back(mem_ptr);
+      return;
+    }
+  }
+  if (DeallocateToPool(size_class, mem_ptr)) { return; }
+  pool_->backend_allocator->Deallocate(mem_ptr, SizeClassBytes(size_class));
+}
+
+bool SizeClassCachingAllocator::AllocateFromPool(int32_t size_class, char** mem_ptr) {
+  const size_t bytes = SizeClassBytes(size_class);
+  std::unique_lock<std::mutex> lock(pool_->mutex);
+  auto* pool_ptrs = &pool_->size_class2ptrs.at(size_class);
+  if (pool_ptrs->empty()) { return false; }
+  *mem_ptr = pool_ptrs->back();
+  pool_ptrs->pop_back();
+  pool_->cached_bytes -= bytes;
+  if (size_class <= kMaxMagazineSizeClass) {
+    auto* ptrs = &MutThreadLocalMagazine(pool_)->size_class2ptrs.at(size_class);
+    while (!pool_ptrs->empty() && ptrs->size() < kMagazineCapacity / 2) {
+      ptrs->push_back(pool_ptrs->back());
+      pool_ptrs->pop_back();
+      pool_->cached_bytes -= bytes;
+    }
+  }
+  return true;
+}
+
+bool SizeClassCachingAllocator::DeallocateToPool(int32_t size_class, char* mem_ptr) {
+  const size_t bytes = SizeClassBytes(size_class);
+  std::unique_lock<std::mutex> lock(pool_->mutex);
+  if (pool_->cached_bytes + bytes > pool_->max_cached_bytes) { return false; }
+  pool_->size_class2ptrs.at(size_class).push_back(mem_ptr);
+  pool_->cached_bytes += bytes;
+  if (size_class <= kMaxMagazineSizeClass) {
+    // a full magazine hands half of its ptrs over, so that the next deallocations are lock free
+    auto* ptrs = &MutThreadLocalMagazine(pool_)->size_class2ptrs.at(size_class);
+    while (ptrs->size() > kMagazineCapacity / 2
+           && pool_->cached_bytes + bytes <= pool_->max_cached_bytes) {
+      pool_->size_class2ptrs.at(size_class).push_back(ptrs->back());
+      ptrs->pop_back();
+      pool_->cached_bytes += bytes;
+    }
+  }
+  return true;
+}
+
+void SizeClassCachingAllocator::Trim() {
+  Magazine* magazine = MutThreadLocalMagazine(pool_);
+  for (int32_t i = 0; i < magazine->size_class2ptrs.size(); ++i) {
+    ReleaseToBackend(pool_.get(), i, &magazine->size_class2ptrs.at(i));
+  }
+  std::vector<std::vector<char*>> size_class2ptrs(kSizeClassNum);
+  {
+    std::unique_lock<std::mutex> lock(pool_->mutex);
+    pool_->size_class2ptrs.swap(size_class2ptrs);
+    pool_->cached_bytes = 0;
+  }
+  for (int32_t i = 0; i < size_class2ptrs.size(); ++i) {
+    ReleaseToBackend(pool_.get(), i, &size_class2ptrs.at(i));
+  }
+}
+
+size_t SizeClassCachingAllocator::cached_bytes() const {
+  std::unique_lock<std::mutex> lock(pool_->mutex);
+  return pool_->cached_bytes;
+}
+
+size_t SizeClassCachingAllocator::max_cached_bytes() const {
+  std::unique_lock<std::mutex> lock(pool_->mutex);
+  return pool_->max_cached_bytes;
+}
+
+void SizeClassCachingAllocator::set_max_cached_bytes(size_t max_cached_bytes) {
+  std::unique_lock<std::mutex> lock(pool_->mutex);
+  pool_->max_cached_bytes = max_cached_bytes;
+}
+
+}  // namespace vm
+}  // namespace oneflow
@@ -0,0 +1,77 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_VM_SIZE_CLASS_CACHING_ALLOCATOR_H_
+#define ONEFLOW_CORE_VM_SIZE_CLASS_CACHING_ALLOCATOR_H_
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "oneflow/core/vm/allocator.h"
+
+namespace oneflow {
+
+namespace vm {
+
+// SizeClassCachingAllocator rounds the allocation size up to a power of two size class and caches
+// the freed memory of each size class instead of returning it to the backend allocator.
+//
+// Small size classes are cached in per-thread magazines first, so that most Allocate/Deallocate
+// calls take no lock. Magazines overflow into a shared pool guarded by a mutex. The shared pool
+// keeps at most `max_cached_bytes' bytes, the memory beyond it is returned to the backend
+// allocator. Allocations larger than the largest size class bypass the cache.
+class SizeClassCachingAllocator final : public Allocator {
+ public:
+  SizeClassCachingAllocator(std::unique_ptr<Allocator>&& backend_allocator,
+                            size_t max_cached_bytes);
+  ~SizeClassCachingAllocator() override;
+
+  void Allocate(char** mem_ptr, std::size_t size) override;
+  void Deallocate(char* mem_ptr, std::size_t size) override;
+
+  // Returns the memory cached by the shared pool and by the magazine of the calling thread to the
+  // backend allocator. Magazines of other threads are flushed when those threads exit.
+  void Trim();
+
+  size_t cached_bytes() const;
+  size_t max_cached_bytes() const;
+  void set_max_cached_bytes(size_t max_cached_bytes);
+
+  static const int32_t kInvalidSizeClass = -1;
+  static const int32_t kSizeClassNum = 21;  // 64B, 128B, ..., 64MiB
+  static const int32_t kMaxMagazineSizeClass = 14;  // 1MiB
+  static const size_t kMagazineCapacity = 4;
+
+  static int32_t SizeClass4Size(size_t size);
+  static size_t SizeClassBytes(int32_t size_class);
+
+  struct Pool;
+
+ private:
+  // Move the cached ptr of `size_class' to `mem_ptr' from the pool, and refill the magazine with
+  // at most half of its capacity. Return false if the pool has no ptr of `size_class'.
+  bool AllocateFromPool(int32_t size_class, char** mem_ptr);
+  // Return false if the pool is full
+  bool DeallocateToPool(int32_t size_class, char* mem_ptr);
+
+  std::shared_ptr<Pool> pool_;
+};
+
+}  // namespace vm
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_VM_SIZE_CLASS_CACHING_ALLOCATOR_H_
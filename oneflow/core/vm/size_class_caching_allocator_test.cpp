@@ -0,0 +1,116 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "gtest/gtest.h"
+#include <thread>
+#include "oneflow/core/vm/size_class_caching_allocator.h"
+#include "oneflow/core/common/util.h"
+
+namespace oneflow {
+namespace vm {
+
+namespace {
+
+class CountingAllocator final : public Allocator {
+ public:
+  CountingAllocator(int64_t* allocated_num) : allocated_num_(allocated_num) {}
+  ~CountingAllocator() override = default;
+
+  void Allocate(char** mem_ptr, std::size_t size) override {
+    *mem_ptr = reinterpret_cast<char*>(aligned_alloc(kHostAlignSize, size));
+    ++*allocated_num_;
+  }
+  void Deallocate(char* mem_ptr, std::size_t size) override {
+    std::free(mem_ptr);
+    --*allocated_num_;
+  }
+
+ private:
+  int64_t* allocated_num_;
+};
+
+}  // namespace
+
+TEST(SizeClassCachingAllocator, size_class) {
+  ASSERT_EQ(SizeClassCachingAllocator::SizeClass4Size(0),
+            SizeClassCachingAllocator::kInvalidSizeClass);
+  ASSERT_EQ(SizeClassCachingAllocator::SizeClass4Size(1), 0);
+  ASSERT_EQ(SizeClassCachingAllocator::SizeClass4Size(64), 0);
+  ASSERT_EQ(SizeClassCachingAllocator::SizeClass4Size(65), 1);
+  ASSERT_EQ(SizeClassCachingAllocator::SizeClassBytes(1), 128);
+  ASSERT_EQ(SizeClassCachingAllocator::SizeClass4Size(64 * 1024 * 1024),
+            SizeClassCachingAllocator::kSizeClassNum - 1);
+  ASSERT_EQ(SizeClassCachingAllocator::SizeClass4Size(64 * 1024 * 1024 + 1),
+            SizeClassCachingAllocator::kInvalidSizeClass);
+}
+
+TEST(SizeClassCachingAllocator, reuse_and_trim) {
+  int64_t allocated_num = 0;
+  SizeClassCachingAllocator allocator(
+      std::unique_ptr<Allocator>(new CountingAllocator(&allocated_num)), 1024 * 1024 * 1024);
+  char* ptr = nullptr;
+  allocator.Allocate(&ptr, 1000);
+  allocator.Deallocate(ptr, 1000);
+  char* reused_ptr = nullptr;
+  allocator.Allocate(&reused_ptr, 1024);
+  ASSERT_EQ(reused_ptr, ptr);
+  ASSERT_EQ(allocated_num, 1);
+  allocator.Deallocate(reused_ptr, 1024);
+  std::vector<char*> ptrs(64);
+  for (char*& p : ptrs) { allocator.Allocate(&p, 4096); }
+  for (char* p : ptrs) { allocator.Deallocate(p, 4096); }
+  ASSERT_GT(allocator.cached_bytes(), 0);
+  allocator.Trim();
+  ASSERT_EQ(allocator.cached_bytes(), 0);
+  ASSERT_EQ(allocated_num, 0);
+}
+
+TEST(SizeClassCachingAllocator, retention_limit) {
+  int64_t allocated_num = 0;
+  const size_t max_cached_bytes = 16 * 1024 * 1024;
+  SizeClassCachingAllocator allocator(
+      std::unique_ptr<Allocator>(new CountingAllocator(&allocated_num)), max_cached_bytes);
+  std::vector<char*> ptrs(8);
+  for (char*& p : ptrs) { allocator.Allocate(&p, 4 * 1024 * 1024); }
+  for (char* p : ptrs) { allocator.Deallocate(p, 4 * 1024 * 1024); }
+  ASSERT_LE(allocator.cached_bytes(), max_cached_bytes);
+  ASSERT_EQ(allocated_num, max_cached_bytes / (4 * 1024 * 1024));
+  char* large_ptr = nullptr;
+  allocator.Allocate(&large_ptr, 128 * 1024 * 1024);
+  allocator.Deallocate(large_ptr, 128 * 1024 * 1024);
+  ASSERT_EQ(allocated_num, max_cached_bytes / (4 * 1024 * 1024));
+}
+
+TEST(SizeClassCachingAllocator, cross_thread) {
+  int64_t allocated_num = 0;
+  SizeClassCachingAllocator allocator(
+      std::unique_ptr<Allocator>(new CountingAllocator(&allocated_num)), 1024 * 1024 * 1024);
+  std::vector<char*> ptrs(256);
+  std::thread producer([&]() {
+    for (char*& p : ptrs) { allocator.Allocate(&p, 256); }
+  });
+  producer.join();
+  std::thread consumer([&]() {
+    for (char* p : ptrs) { allocator.Deallocate(p, 256); }
+  });
+  // the magazine of the consumer thread is flushed to the shared pool at thread exit
+  consumer.join();
+  ASSERT_EQ(allocator.cached_bytes(), ptrs.size() * 256);
+  allocator.Trim();
+  ASSERT_EQ(allocated_num, 0);
+}
+
+}  // namespace vm
+}  // namespace oneflow
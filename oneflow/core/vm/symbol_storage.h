@@ -151,6 +151,8 @@ class Storage final {
 
   Maybe<void> TryAdd(int64_t symbol_id, const typename ConstructArgType4Symbol<T>::type& data) {
     CHECK_GT_OR_RETURN(symbol_id, 0);
+    // Constructing a symbol may be expensive, so skip it for existing ones
+    if (Has(symbol_id)) { return Maybe<void>::Ok(); }
     const auto& ptr = JUST(detail::NewSymbol<T>(symbol_id, data));
     std::unique_lock<std::mutex> lock(mutex_);
     const auto& iter = symbol_id2symbol_.find(symbol_id);
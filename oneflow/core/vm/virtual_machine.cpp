@@ -22,6 +22,7 @@ limitations under the License.
 #include "oneflow/core/common/util.h"
 #include "oneflow/core/common/balanced_splitter.h"
 #include "oneflow/core/job/parallel_desc.h"
+#include "oneflow/core/profiler/host_stage_timing.h"
 
 namespace oneflow {
 namespace vm {
@@ -158,7 +159,7 @@ Maybe<const ParallelDesc> VirtualMachine::GetInstructionParallelDesc(
   if (instr_msg.parallel_desc()) { return instr_msg.parallel_desc(); }
   if (!instr_msg.has_parallel_desc_symbol_id()) { return empty_ptr; }
   int64_t symbol_id = instr_msg.parallel_desc_symbol_id();
-  auto* logical_object = mut_id2logical_object()->FindPtr(symbol_id);
+  auto* logical_object = FindLogicalObject(mut_id2logical_object(), symbol_id);
   CHECK_NOTNULL_OR_RETURN(logical_object) << "symbol_id: " << symbol_id;
   auto* map = logical_object->mut_global_device_id2mirrored_object();
   CHECK_EQ_OR_RETURN(map->size(), 1);
@@ -167,11 +168,21 @@ Maybe<const ParallelDesc> VirtualMachine::GetInstructionParallelDesc(
   return parallel_desc;
 }
 
+LogicalObject* VirtualMachine::FindLogicalObject(Id2LogicalObject* id2logical_object,
+                                                int64_t logical_object_id) {
+  auto* slab = mut_logical_object_slab();
+  LogicalObject* logical_object = slab->Find(logical_object_id);
+  if (logical_object != nullptr) { return logical_object; }
+  logical_object = id2logical_object->FindPtr(logical_object_id);
+  if (logical_object != nullptr) { slab->Put(logical_object_id, logical_object); }
+  return logical_object;
+}
+
 MirroredObject* VirtualMachine::MutMirroredObject(int64_t logical_object_id,
                                                   int64_t global_device_id) {
-  auto* logical_object = mut_id2logical_object()->FindPtr(logical_object_id);
+  auto* logical_object = FindLogicalObject(mut_id2logical_object(), logical_object_id);
   if (logical_object == nullptr) { return nullptr; }
-  return logical_object->mut_global_device_id2mirrored_object()->FindPtr(global_device_id);
+  return logical_object->FindMirroredObject(global_device_id);
 }
 
 const MirroredObject* VirtualMachine::GetMirroredObject(int64_t logical_object_id,
@@ -185,13 +196,14 @@ void VirtualMachine::ForEachMirroredObject(Id2LogicalObject* id2logical_object,
                                            const DoEachT& DoEach) {
   int64_t logical_object_id = operand.logical_object_id();
   logical_object_id = TransformLogicalObjectId(logical_object_id);
-  auto* logical_object = id2logical_object->FindPtr(logical_object_id);
+  auto* logical_object = FindLogicalObject(id2logical_object, logical_object_id);
   if (logical_object == nullptr) { return; }
-  auto* map = logical_object->mut_global_device_id2mirrored_object();
   if (operand.has_all_mirrored_object()) {
+    auto* map = logical_object->mut_global_device_id2mirrored_object();
     OBJECT_MSG_MAP_FOR_EACH_PTR(map, mirrored_object) { DoEach(mirrored_object); }
   } else {
-    auto* mirrored_object = map->FindPtr(operand.GetGlobalDeviceId(global_device_id));
+    auto* mirrored_object =
+        logical_object->FindMirroredObject(operand.GetGlobalDeviceId(global_device_id));
     if (mirrored_object != nullptr) { DoEach(mirrored_object); }
   }
 }
@@ -515,6 +527,16 @@ void VirtualMachine::DispatchAndPrescheduleInstructions(
   PrescheduledInstructionList prescheduled;
   auto* active_stream_list = mut_active_stream_list();
   auto* vm_stat_running_list = mut_vm_stat_running_instruction_list();
+  // consecutive instructions for the same worker thread are handed over in one batch, so the
+  // thread is locked and woken up once per group instead of once per instruction.
+  ThreadCtx* batch_thread_ctx = nullptr;
+  OBJECT_MSG_LIST(Instruction, pending_instruction_link) batch;
+  const auto& FlushBatch = [&]() {
+    if (batch_thread_ctx != nullptr && !batch.empty()) {
+      batch_thread_ctx->mut_pending_instruction_list()->MoveFrom(&batch);
+    }
+    batch_thread_ctx = nullptr;
+  };
   OBJECT_MSG_LIST_FOR_EACH_PTR(ready_instruction_list, instruction) {
     vm_stat_running_list->PushBack(instruction);
     auto* stream = instruction->mut_stream();
@@ -522,13 +544,19 @@ void VirtualMachine::DispatchAndPrescheduleInstructions(
     if (stream->is_active_stream_link_empty()) { active_stream_list->PushBack(stream); }
     const auto& stream_type = stream->stream_type();
     if (stream_type.SharingVirtualMachineThread()) {
+      FlushBatch();
       stream_type.Run(this, instruction);
     } else {
-      stream->mut_thread_ctx()->mut_pending_instruction_list()->PushBack(instruction);
+      if (batch_thread_ctx != stream->mut_thread_ctx()) {
+        FlushBatch();
+        batch_thread_ctx = stream->mut_thread_ctx();
+      }
+      batch.PushBack(instruction);
     }
     TryMoveWaitingToReady(instruction, &prescheduled,
                           [stream](Instruction* dst) { return &dst->stream() == stream; });
   }
+  FlushBatch();
   prescheduled.MoveTo(ready_instruction_list);
 }
 
@@ -590,6 +618,7 @@ void VirtualMachine::Receive(InstructionMsgList* compute_instr_msg_list) {
     });
   }
   mut_pending_msg_list()->MoveFrom(&new_instr_msg_list);
+  mut_scheduler_notifier()->Notify();
 }
 
 void VirtualMachine::Receive(ObjectMsgPtr<InstructionMsg>&& compute_instr_msg) {
@@ -635,6 +664,8 @@ void VirtualMachine::TryDeleteLogicalObjects() {
       // `mirrored_object' is deleted by erasing
       global_device_id2mirrored_object->Erase(mirrored_object);
     }
+    logical_object->ClearMirroredObjectCache();
+    mut_logical_object_slab()->Erase(logical_object->logical_object_id());
     mut_id2logical_object()->Erase(logical_object);
     CHECK_EQ(logical_object->ref_cnt(), 1);
     // `logical_object' is deleted by erasing
@@ -643,6 +674,9 @@ void VirtualMachine::TryDeleteLogicalObjects() {
 }
 
 void VirtualMachine::Schedule() {
+  // the scheduler thread polls, so only the calls with work to do are counted
+  profiler::HostStageTimingGuard timing_guard(profiler::kHostStageVmSchedule,
+                                              profiler::IsHostStageTimingEnabled() && !Empty());
   ReadyInstructionList* ready_instruction_list = mut_ready_instruction_list();
   auto* active_stream_list = mut_active_stream_list();
   OBJECT_MSG_LIST_FOR_EACH_PTR(active_stream_list, stream) {
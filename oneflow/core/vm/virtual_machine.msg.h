@@ -20,7 +20,9 @@ limitations under the License.
 #include "oneflow/core/common/maybe.h"
 #include "oneflow/core/vm/interpret_type.h"
 #include "oneflow/core/vm/instruction.msg.h"
+#include "oneflow/core/vm/logical_object_slab.h"
 #include "oneflow/core/vm/stream.msg.h"
+#include "oneflow/core/vm/scheduler_notifier.h"
 #include "oneflow/core/vm/stream_runtime_desc.msg.h"
 #include "oneflow/core/vm/thread_ctx.msg.h"
 #include "oneflow/core/vm/vm_object.msg.h"
@@ -57,6 +59,8 @@ OBJECT_MSG_BEGIN(VirtualMachine);
   OBJECT_MSG_DEFINE_STRUCT(Range, machine_id_range);
   OBJECT_MSG_DEFINE_STRUCT(std::atomic<int64_t>, flying_instruction_cnt);
   OBJECT_MSG_DEFINE_PTR(ObjectMsgAllocator, vm_thread_only_allocator);
+  OBJECT_MSG_DEFINE_STRUCT(LogicalObjectSlab, logical_object_slab);
+  OBJECT_MSG_DEFINE_STRUCT(SchedulerNotifier, scheduler_notifier);
 
   // heads
   OBJECT_MSG_DEFINE_LIST_HEAD(Stream, active_stream_link, active_stream_list);
@@ -65,7 +69,7 @@ OBJECT_MSG_BEGIN(VirtualMachine);
   OBJECT_MSG_DEFINE_MAP_HEAD(LogicalObject, logical_object_id, id2logical_object);
   OBJECT_MSG_DEFINE_LIST_HEAD(LogicalObject, delete_link, delete_logical_object_list);
 
-  OBJECT_MSG_DEFINE_MUTEXED_LIST_HEAD(InstructionMsg, instr_msg_link, pending_msg_list);
+  OBJECT_MSG_DEFINE_MPSC_LIST_HEAD(InstructionMsg, instr_msg_link, pending_msg_list);
   OBJECT_MSG_DEFINE_LIST_HEAD(Instruction, instruction_link, waiting_instruction_list);
   OBJECT_MSG_DEFINE_LIST_HEAD(Instruction, instruction_link, ready_instruction_list);
   OBJECT_MSG_DEFINE_LIST_HEAD(Instruction, vm_stat_running_instruction_link,
@@ -92,6 +96,7 @@ OBJECT_MSG_BEGIN(VirtualMachine);
           Stream* stream, /*out*/ ReadyInstructionList* ready_instruction_list);
   void FilterAndRunInstructionsInAdvance(TmpPendingInstrMsgList* instr_msg_list);
   void MakeInstructions(TmpPendingInstrMsgList*, /*out*/ NewInstructionList* ret_instruction_list);
+  LogicalObject* FindLogicalObject(Id2LogicalObject* id2logical_object, int64_t logical_object_id);
   template<int64_t (*TransformLogicalObjectId)(int64_t), typename DoEachT>
   void ForEachMirroredObject(Id2LogicalObject* id2logical_object,
                              const Operand& operand,
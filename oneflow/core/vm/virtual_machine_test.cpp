@@ -14,6 +14,8 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #include <iostream>
+#include <chrono>
+#include <thread>
 #include "oneflow/core/vm/virtual_machine.msg.h"
 #include "oneflow/core/vm/control_stream_type.h"
 #include "oneflow/core/vm/vm_desc.msg.h"
@@ -47,6 +49,44 @@ TEST(VirtualMachine, ToDot) {
   // std::cout << std::endl;
 }
 
+void BenchmarkPendingMsgListIntake(int64_t producer_num) {
+  TestResourceDescScope scope(1, 1);
+  auto vm_desc = ObjectMsgPtr<VmDesc>::New(TestUtil::NewVmResourceDesc().Get());
+  TestUtil::AddStreamDescByInstrNames(vm_desc.Mutable(), {"Nop"});
+  auto vm = ObjectMsgPtr<VirtualMachine>::New(vm_desc.Get());
+  const int64_t kInstrNumPerProducer = (1 << 18) / producer_num;
+  std::vector<std::vector<ObjectMsgPtr<InstructionMsg>>> producer_id2instr_msgs(producer_num);
+  for (auto& instr_msgs : producer_id2instr_msgs) {
+    for (int64_t i = 0; i < kInstrNumPerProducer; ++i) {
+      instr_msgs.push_back(NewInstruction("Nop"));
+    }
+  }
+  const int64_t total_instr_num = producer_num * kInstrNumPerProducer;
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> producers;
+  for (auto& instr_msgs : producer_id2instr_msgs) {
+    auto* pending_msg_list = vm->mut_pending_msg_list();
+    producers.emplace_back([pending_msg_list, &instr_msgs]() {
+      for (auto& instr_msg : instr_msgs) { pending_msg_list->EmplaceBack(std::move(instr_msg)); }
+    });
+  }
+  int64_t received_instr_num = 0;
+  while (received_instr_num < total_instr_num) {
+    InstructionMsgList instr_msg_list;
+    vm->mut_pending_msg_list()->MoveTo(&instr_msg_list);
+    received_instr_num += instr_msg_list.size();
+  }
+  for (auto& producer : producers) { producer.join(); }
+  auto duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start);
+  ASSERT_TRUE(vm->pending_msg_list().empty());
+  std::cout << "producers: " << producer_num
+            << ", instructions/s: " << total_instr_num / duration.count() << std::endl;
+}
+
+TEST(VirtualMachine, pending_msg_list_intake_benchmark) {
+  for (int64_t producer_num : {1, 4, 16}) { BenchmarkPendingMsgListIntake(producer_num); }
+}
+
 }  // namespace
 
 }  // namespace test
@@ -43,5 +43,25 @@ void MirroredObject::__Init__(LogicalObject* logical_object, int64_t global_devi
   mutable_rw_mutexed_object();
 }
 
+MirroredObject* LogicalObject::FindMirroredObject(int64_t global_device_id) {
+  static const int64_t kMaxDenseGlobalDeviceId = 4096;
+  auto* dense = mut_dense_mirrored_objects();
+  if (global_device_id >= 0 && static_cast<size_t>(global_device_id) < dense->size()) {
+    MirroredObject* mirrored_object = dense->at(global_device_id);
+    if (mirrored_object != nullptr) { return mirrored_object; }
+  }
+  MirroredObject* mirrored_object =
+      mut_global_device_id2mirrored_object()->FindPtr(global_device_id);
+  // mirrored objects are only erased together with their logical object, so hits are cacheable
+  if (mirrored_object != nullptr && global_device_id >= 0
+      && global_device_id < kMaxDenseGlobalDeviceId) {
+    if (static_cast<size_t>(global_device_id) >= dense->size()) {
+      dense->resize(global_device_id + 1, nullptr);
+    }
+    dense->at(global_device_id) = mirrored_object;
+  }
+  return mirrored_object;
+}
+
 }  // namespace vm
 }  // namespace oneflow
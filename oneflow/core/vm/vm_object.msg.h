@@ -125,9 +125,13 @@ OBJECT_MSG_BEGIN(LogicalObject);
     set_logical_object_id(logical_object_id);
     *mutable_parallel_desc() = parallel_desc;
   }
+  // same as global_device_id2mirrored_object().FindPtr() but served from a dense array once hit
+  OF_PUBLIC MirroredObject* FindMirroredObject(int64_t global_device_id);
+  OF_PUBLIC void ClearMirroredObjectCache() { mut_dense_mirrored_objects()->clear(); }
 
   // fields
   OBJECT_MSG_DEFINE_STRUCT(std::shared_ptr<const ParallelDesc>, parallel_desc);
+  OBJECT_MSG_DEFINE_STRUCT(std::vector<MirroredObject*>, dense_mirrored_objects);
 
   // links
   OBJECT_MSG_DEFINE_MAP_KEY(ObjectId, logical_object_id);
@@ -0,0 +1,81 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/vm/workspace_arena.h"
+
+namespace oneflow {
+
+namespace vm {
+
+WorkspaceArena::WorkspaceArena(Allocator* backend_allocator, size_t trim_interval)
+    : backend_allocator_(backend_allocator),
+      trim_interval_(trim_interval),
+      buffer_(nullptr),
+      capacity_(0),
+      high_water_mark_(0),
+      acquired_cnt_(0),
+      acquired_(false) {
+  CHECK_NOTNULL(backend_allocator_);
+  CHECK_GT(trim_interval_, 0);
+}
+
+WorkspaceArena::~WorkspaceArena() {
+  CHECK(!acquired_);
+  FreeBuffer();
+}
+
+char* WorkspaceArena::Acquire(size_t size) {
+  CHECK(!acquired_) << "the workspace arena is already acquired";
+  acquired_ = true;
+  high_water_mark_ = std::max(high_water_mark_, size);
+  size_t required_size = size;
+  acquired_cnt_ += 1;
+  if (acquired_cnt_ == trim_interval_) {
+    if (high_water_mark_ <= capacity_ / 2) {
+      FreeBuffer();
+      required_size = high_water_mark_;
+    }
+    acquired_cnt_ = 0;
+    high_water_mark_ = 0;
+  }
+  if (required_size > capacity_) {
+    FreeBuffer();
+    const size_t capacity = RoundUp(required_size, kGranularity);
+    backend_allocator_->Allocate(&buffer_, capacity);
+    capacity_ = capacity;
+  }
+  return buffer_;
+}
+
+void WorkspaceArena::Release() {
+  CHECK(acquired_) << "the workspace arena is not acquired";
+  acquired_ = false;
+}
+
+void WorkspaceArena::Trim() {
+  CHECK(!acquired_) << "can not trim the acquired workspace arena";
+  FreeBuffer();
+}
+
+void WorkspaceArena::FreeBuffer() {
+  if (buffer_ == nullptr) { return; }
+  backend_allocator_->Deallocate(buffer_, capacity_);
+  buffer_ = nullptr;
+  capacity_ = 0;
+}
+
+}  // namespace vm
+
+}  // namespace oneflow
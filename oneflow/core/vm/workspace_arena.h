@@ -0,0 +1,68 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_CORE_VM_WORKSPACE_ARENA_H_
+#define ONEFLOW_CORE_VM_WORKSPACE_ARENA_H_
+
+#include "oneflow/core/common/util.h"
+#include "oneflow/core/vm/allocator.h"
+
+namespace oneflow {
+
+namespace vm {
+
+// WorkspaceArena keeps one grow-only buffer for the tmp buffers of the kernels of a stream. The
+// kernels of a stream run one after another, so all of them reuse the buffer and the backend
+// allocator is only called when a kernel needs more than the capacity.
+//
+// The arena records the high-water mark of the acquired sizes. Every `trim_interval' acquisitions
+// the buffer is shrunk to the mark if the mark is at most half of the capacity, so that a few
+// large workspaces do not pin their memory for the rest of the run.
+class WorkspaceArena final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(WorkspaceArena);
+  WorkspaceArena(Allocator* backend_allocator, size_t trim_interval);
+  ~WorkspaceArena();
+
+  // Returns a buffer of at least `size' bytes, it is used until Release and can't be acquired
+  // again before that.
+  char* Acquire(size_t size);
+  void Release();
+  // Returns the buffer to the backend allocator
+  void Trim();
+
+  size_t capacity() const { return capacity_; }
+  // The largest size acquired since the last trim check
+  size_t high_water_mark() const { return high_water_mark_; }
+
+  static const size_t kGranularity = 1024 * 1024;
+
+ private:
+  void FreeBuffer();
+
+  Allocator* backend_allocator_;
+  size_t trim_interval_;
+  char* buffer_;
+  size_t capacity_;
+  size_t high_water_mark_;
+  size_t acquired_cnt_;
+  bool acquired_;
+};
+
+}  // namespace vm
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_CORE_VM_WORKSPACE_ARENA_H_
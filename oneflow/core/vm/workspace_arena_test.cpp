@@ -0,0 +1,97 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "gtest/gtest.h"
+#include "oneflow/core/vm/workspace_arena.h"
+
+namespace oneflow {
+namespace vm {
+
+namespace {
+
+class CountingAllocator final : public Allocator {
+ public:
+  CountingAllocator() : allocate_cnt_(0), allocated_num_(0) {}
+  ~CountingAllocator() override = default;
+
+  void Allocate(char** mem_ptr, std::size_t size) override {
+    *mem_ptr = reinterpret_cast<char*>(std::malloc(size));
+    ++allocate_cnt_;
+    ++allocated_num_;
+  }
+  void Deallocate(char* mem_ptr, std::size_t size) override {
+    std::free(mem_ptr);
+    --allocated_num_;
+  }
+
+  int64_t allocate_cnt() const { return allocate_cnt_; }
+  int64_t allocated_num() const { return allocated_num_; }
+
+ private:
+  int64_t allocate_cnt_;
+  int64_t allocated_num_;
+};
+
+}  // namespace
+
+TEST(WorkspaceArena, reuse_and_grow) {
+  CountingAllocator allocator;
+  {
+    WorkspaceArena arena(&allocator, 1024);
+    char* ptr = arena.Acquire(1000);
+    arena.Release();
+    for (int i = 0; i < 100; ++i) {
+      ASSERT_EQ(arena.Acquire(i % 2 == 0 ? 100 : 1000), ptr);
+      arena.Release();
+    }
+    ASSERT_EQ(allocator.allocate_cnt(), 1);
+    ASSERT_EQ(arena.capacity(), WorkspaceArena::kGranularity);
+    arena.Acquire(WorkspaceArena::kGranularity + 1);
+    arena.Release();
+    ASSERT_EQ(allocator.allocate_cnt(), 2);
+    ASSERT_EQ(allocator.allocated_num(), 1);
+    ASSERT_EQ(arena.capacity(), 2 * WorkspaceArena::kGranularity);
+    arena.Trim();
+    ASSERT_EQ(allocator.allocated_num(), 0);
+    ASSERT_EQ(arena.capacity(), 0);
+  }
+  ASSERT_EQ(allocator.allocated_num(), 0);
+}
+
+TEST(WorkspaceArena, shrink_to_high_water_mark) {
+  CountingAllocator allocator;
+  WorkspaceArena arena(&allocator, 4);
+  arena.Acquire(8 * WorkspaceArena::kGranularity);
+  arena.Release();
+  for (int i = 0; i < 2; ++i) {
+    arena.Acquire(WorkspaceArena::kGranularity);
+    arena.Release();
+  }
+  // the 4th acquisition checks the mark of the window, which includes the large one
+  ASSERT_EQ(arena.capacity(), 8 * WorkspaceArena::kGranularity);
+  arena.Acquire(WorkspaceArena::kGranularity);
+  arena.Release();
+  ASSERT_EQ(arena.capacity(), 8 * WorkspaceArena::kGranularity);
+  for (int i = 0; i < 4; ++i) {
+    arena.Acquire(WorkspaceArena::kGranularity);
+    arena.Release();
+  }
+  ASSERT_EQ(arena.capacity(), WorkspaceArena::kGranularity);
+  ASSERT_EQ(allocator.allocated_num(), 1);
+  arena.Trim();
+}
+
+}  // namespace vm
+}  // namespace oneflow
@@ -39,17 +39,18 @@ class BatchRandomShuffleDataset final : public Dataset<LoadTarget> {
 
     // fill buffer
     initial_buffer_fill_ = ctx->Attr<int32_t>("shuffle_buffer_size");
+    batch_buffer_.reserve(initial_buffer_fill_);
     for (int32_t i = 0; i < initial_buffer_fill_; ++i) {
       LoadTargetPtrList batch = loader_->Next();
       batch_buffer_.push_back(std::move(batch));
     }
+    dis_ = std::uniform_int_distribution<int32_t>(0, batch_buffer_.size() - 1);
   }
   ~BatchRandomShuffleDataset() = default;
 
   LoadTargetPtrList Next() override {
     LoadTargetPtrList ret = loader_->Next();
-    std::uniform_int_distribution<> dis(0, batch_buffer_.size() - 1);
-    const int offset = dis(rand_engine_);
+    const int offset = dis_(rand_engine_);
     std::swap(batch_buffer_.at(offset), ret);
     return ret;
   }
@@ -61,6 +62,7 @@ class BatchRandomShuffleDataset final : public Dataset<LoadTarget> {
   int32_t initial_buffer_fill_;
 
   std::default_random_engine rand_engine_;
+  std::uniform_int_distribution<int32_t> dis_;
   int64_t seed_;
 };
 
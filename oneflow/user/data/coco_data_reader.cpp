@@ -20,6 +20,12 @@ limitations under the License.
 #include "oneflow/user/data/batch_dataset.h"
 #include "oneflow/core/persistence/file_system.h"
 #include "oneflow/core/persistence/persistent_in_stream.h"
+#include "oneflow/core/persistence/posix/posix_file_system.h"
+#include <json.hpp>
+#include <fstream>
+#ifdef OF_PLATFORM_POSIX
+#include <unistd.h>
+#endif  // OF_PLATFORM_POSIX
 
 namespace oneflow {
 namespace data {
@@ -30,12 +36,12 @@ COCODataReader::COCODataReader(user_op::KernelInitContext* ctx) : DataReader<COC
       ctx->Attr<std::string>("image_dir"), ctx->Attr<bool>("remove_images_without_annotations")));
 
   std::unique_ptr<RandomAccessDataset<COCOImage>> coco_dataset_ptr(new COCODataset(ctx, meta));
+  size_t batch_size = ctx->TensorDesc4ArgNameAndIndex("image", 0)->shape().elem_cnt();
+  // the images of a batch worth of indices are read in parallel by COCODataset::BatchAt
   loader_.reset(new DistributedTrainingDataset<COCOImage>(
       ctx->parallel_ctx().parallel_num(), ctx->parallel_ctx().parallel_id(),
       ctx->Attr<bool>("stride_partition"), ctx->Attr<bool>("shuffle_after_epoch"),
-      ctx->Attr<int64_t>("random_seed"), std::move(coco_dataset_ptr)));
-
-  size_t batch_size = ctx->TensorDesc4ArgNameAndIndex("image", 0)->shape().elem_cnt();
+      ctx->Attr<int64_t>("random_seed"), std::move(coco_dataset_ptr), batch_size));
   if (ctx->Attr<bool>("group_by_ratio")) {
     auto GetGroupId = [](const std::shared_ptr<COCOImage>& sample) {
       return static_cast<int64_t>(sample->height / sample->width);
@@ -49,25 +55,110 @@ COCODataReader::COCODataReader(user_op::KernelInitContext* ctx) : DataReader<COC
   StartLoadThread();
 }
 
+namespace {
+
+constexpr char kCacheMagicCode[] = "OFCOCO\x00\x01";
+constexpr size_t kCacheMagicCodeLen = sizeof(kCacheMagicCode) - 1;
+constexpr int kMinKeypointsPerImage = 10;
+
+// The header of the cache is the magic code followed by these fields, then the arrays of COCOMeta
+// in the order of the fields counting them
+struct COCOMetaCacheHeader {
+  uint64_t annotation_file_size;
+  uint64_t remove_images_without_annotations;
+  uint64_t num_images;
+  uint64_t num_annos;
+  uint64_t num_polys;
+  uint64_t num_coords;
+  uint64_t file_names_size;
+};
+
+bool ImageHasValidAnnotations(const std::vector<const nlohmann::json*>& annos) {
+  if (annos.empty()) { return false; }
+
+  bool bbox_area_all_close_to_zero = true;
+  size_t visible_keypoints_count = 0;
+  for (const nlohmann::json* anno : annos) {
+    if ((*anno)["bbox"][2] > 1 && (*anno)["bbox"][3] > 1) { bbox_area_all_close_to_zero = false; }
+    if (anno->contains("keypoints")) {
+      const auto& keypoints = (*anno)["keypoints"];
+      CHECK_EQ(keypoints.size() % 3, 0);
+      FOR_RANGE(size_t, i, 0, keypoints.size() / 3) {
+        int32_t keypoints_label = keypoints[i * 3 + 2].get<int32_t>();
+        if (keypoints_label > 0) { visible_keypoints_count += 1; }
+      }
+    }
+  }
+  // check if all boxes are close to zero area
+  if (bbox_area_all_close_to_zero) { return false; }
+  // keypoints task have a slight different critera for considering
+  // if an annotation is valid
+  if (!annos.at(0)->contains("keypoints")) { return true; }
+  // for keypoint detection tasks, only consider valid images those
+  // containing at least min_keypoints_per_image
+  if (visible_keypoints_count >= kMinKeypointsPerImage) { return true; }
+  return false;
+}
+
+template<typename T>
+void WriteArray(std::ofstream* stream, const std::vector<T>& vec) {
+  stream->write(reinterpret_cast<const char*>(vec.data()), vec.size() * sizeof(T));
+}
+
+template<typename T>
+bool ReadArray(const std::string& data, size_t* offset, size_t num, std::vector<T>* vec) {
+  if (*offset + num * sizeof(T) > data.size()) { return false; }
+  vec->resize(num);
+  std::memcpy(vec->data(), data.data() + *offset, num * sizeof(T));
+  *offset += num * sizeof(T);
+  return true;
+}
+
+}  // namespace
+
 COCOMeta::COCOMeta(int64_t session_id, const std::string& annotation_file,
                    const std::string& image_dir, bool remove_images_without_annotations)
     : image_dir_(image_dir) {
+  const std::string cache_path = annotation_file + ".meta";
+  const uint64_t annotation_file_size = DataFS()->GetFileSize(annotation_file);
+  if (LoadCache(cache_path, annotation_file_size, remove_images_without_annotations)) { return; }
+  ParseAnnotationFile(session_id, annotation_file, remove_images_without_annotations);
+  SaveCache(cache_path, annotation_file_size, remove_images_without_annotations);
+}
+
+void COCOMeta::ParseAnnotationFile(int64_t session_id, const std::string& annotation_file,
+                                   bool remove_images_without_annotations) {
   // Read content of annotation file (json format) to json obj
   PersistentInStream in_stream(session_id, DataFS(), annotation_file);
   std::string json_str;
   std::string line;
   while (in_stream.ReadLine(&line) == 0) { json_str += line; }
   std::istringstream in_str_stream(json_str);
-  in_str_stream >> annotation_json_;
-  // initialize image_ids_, image_id2image_ and image_id2anno_ids_
-  for (const auto& image : annotation_json_["images"]) {
+  nlohmann::json annotation_json;
+  in_str_stream >> annotation_json;
+  // build categories map
+  HashMap<int32_t, int32_t> category_id2contiguous_id;
+  std::vector<int32_t> category_ids;
+  for (const auto& cat : annotation_json["categories"]) {
+    category_ids.emplace_back(cat["id"].get<int32_t>());
+  }
+  std::sort(category_ids.begin(), category_ids.end());
+  int32_t contiguous_id = 1;
+  for (int32_t category_id : category_ids) {
+    CHECK(category_id2contiguous_id.emplace(category_id, contiguous_id++).second);
+  }
+  // collect the images and the annotations of each image in the order of the file
+  std::vector<int64_t> image_ids;
+  HashMap<int64_t, const nlohmann::json*> image_id2image;
+  HashMap<int64_t, std::vector<const nlohmann::json*>> image_id2annos;
+  for (const auto& image : annotation_json["images"]) {
     int64_t id = image["id"].get<int64_t>();
-    image_ids_.push_back(id);
-    CHECK(image_id2image_.emplace(id, image).second);
-    CHECK(image_id2anno_ids_.emplace(id, std::vector<int64_t>()).second);
+    image_ids.push_back(id);
+    CHECK(image_id2image.emplace(id, &image).second);
+    CHECK(image_id2annos.emplace(id, std::vector<const nlohmann::json*>()).second);
   }
-  // build anno map
-  for (const auto& anno : annotation_json_["annotations"]) {
+  HashSet<int64_t> anno_ids;
+  for (const auto& anno : annotation_json["annotations"]) {
     int64_t id = anno["id"].get<int64_t>();
     int64_t image_id = anno["image_id"].get<int64_t>();
     // ignore crowd object for now
@@ -80,63 +171,132 @@ COCOMeta::COCOMeta(int64_t session_id, const std::string& annotation_file,
         CHECK_GT(poly.size(), 6);
       }
     }
-    CHECK(anno_id2anno_.emplace(id, anno).second);
-    image_id2anno_ids_.at(image_id).push_back(id);
+    CHECK(anno_ids.insert(id).second);
+    image_id2annos.at(image_id).push_back(&anno);
   }
   // remove images without annotations if necessary
   if (remove_images_without_annotations) {
-    HashSet<int64_t> to_remove_image_ids;
-    for (int64_t image_id : image_ids_) {
-      if (!ImageHasValidAnnotations(image_id)) { to_remove_image_ids.insert(image_id); }
-    }
-    image_ids_.erase(std::remove_if(image_ids_.begin(), image_ids_.end(),
-                                    [&to_remove_image_ids](int64_t image_id) {
-                                      return to_remove_image_ids.find(image_id)
-                                             != to_remove_image_ids.end();
-                                    }),
-                     image_ids_.end());
+    image_ids.erase(std::remove_if(image_ids.begin(), image_ids.end(),
+                                   [&image_id2annos](int64_t image_id) {
+                                     return !ImageHasValidAnnotations(image_id2annos.at(image_id));
+                                   }),
+                    image_ids.end());
   }
   // sort image ids for reproducible results
-  std::sort(image_ids_.begin(), image_ids_.end());
-  // build categories map
-  std::vector<int32_t> category_ids;
-  for (const auto& cat : annotation_json_["categories"]) {
-    category_ids.emplace_back(cat["id"].get<int32_t>());
-  }
-  std::sort(category_ids.begin(), category_ids.end());
-  int32_t contiguous_id = 1;
-  for (int32_t category_id : category_ids) {
-    CHECK(category_id2contiguous_id_.emplace(category_id, contiguous_id++).second);
+  std::sort(image_ids.begin(), image_ids.end());
+  // flatten the images and their annotations
+  image_ids_ = image_ids;
+  image_anno_offsets_.assign(1, 0);
+  file_name_offsets_.assign(1, 0);
+  anno_poly_offsets_.assign(1, 0);
+  poly_coord_offsets_.assign(1, 0);
+  for (int64_t image_id : image_ids_) {
+    const nlohmann::json& image = *image_id2image.at(image_id);
+    image_heights_.push_back(image["height"].get<int32_t>());
+    image_widths_.push_back(image["width"].get<int32_t>());
+    const std::string file_name = image["file_name"].get<std::string>();
+    file_names_.insert(file_names_.end(), file_name.begin(), file_name.end());
+    file_name_offsets_.push_back(file_names_.size());
+    for (const nlohmann::json* anno : image_id2annos.at(image_id)) {
+      const auto& bbox_json = (*anno)["bbox"];
+      CHECK(bbox_json.is_array());
+      CHECK_EQ(bbox_json.size(), 4);
+      for (const auto& elem : bbox_json) { anno_bboxes_.push_back(elem.get<double>()); }
+      anno_labels_.push_back(category_id2contiguous_id.at((*anno)["category_id"].get<int32_t>()));
+      const auto& segm_json = (*anno)["segmentation"];
+      if (segm_json.is_array()) {
+        for (const auto& poly_json : segm_json) {
+          CHECK(poly_json.is_array());
+          for (const auto& elem : poly_json) { poly_coords_.push_back(elem.get<double>()); }
+          poly_coord_offsets_.push_back(poly_coords_.size());
+        }
+      }
+      anno_poly_offsets_.push_back(poly_coord_offsets_.size() - 1);
+    }
+    image_anno_offsets_.push_back(anno_labels_.size());
   }
 }
 
-bool COCOMeta::ImageHasValidAnnotations(int64_t image_id) const {
-  const std::vector<int64_t>& anno_id_vec = image_id2anno_ids_.at(image_id);
-  if (anno_id_vec.empty()) { return false; }
+bool COCOMeta::LoadCache(const std::string& cache_path, uint64_t annotation_file_size,
+                         bool remove_images_without_annotations) {
+  fs::FileSystem* fs = DataFS();
+  if (!fs->FileExists(cache_path)) { return false; }
+  const uint64_t cache_size = fs->GetFileSize(cache_path);
+  if (cache_size < kCacheMagicCodeLen + sizeof(COCOMetaCacheHeader)) { return false; }
+  std::string data(cache_size, '\0');
+  {
+    std::unique_ptr<fs::RandomAccessFile> file;
+    fs->NewRandomAccessFile(cache_path, &file);
+    file->Read(0, cache_size, &data.at(0));
+  }
+  if (std::memcmp(data.data(), kCacheMagicCode, kCacheMagicCodeLen) != 0) { return false; }
+  COCOMetaCacheHeader header{};
+  std::memcpy(&header, data.data() + kCacheMagicCodeLen, sizeof(header));
+  if (header.annotation_file_size != annotation_file_size
+      || header.remove_images_without_annotations
+             != static_cast<uint64_t>(remove_images_without_annotations)) {
+    return false;
+  }
+  size_t offset = kCacheMagicCodeLen + sizeof(header);
+  const bool ok = ReadArray(data, &offset, header.num_images, &image_ids_)
+                  && ReadArray(data, &offset, header.num_images, &image_heights_)
+                  && ReadArray(data, &offset, header.num_images, &image_widths_)
+                  && ReadArray(data, &offset, header.num_images + 1, &image_anno_offsets_)
+                  && ReadArray(data, &offset, header.num_images + 1, &file_name_offsets_)
+                  && ReadArray(data, &offset, header.file_names_size, &file_names_)
+                  && ReadArray(data, &offset, header.num_annos * 4, &anno_bboxes_)
+                  && ReadArray(data, &offset, header.num_annos, &anno_labels_)
+                  && ReadArray(data, &offset, header.num_annos + 1, &anno_poly_offsets_)
+                  && ReadArray(data, &offset, header.num_polys + 1, &poly_coord_offsets_)
+                  && ReadArray(data, &offset, header.num_coords, &poly_coords_);
+  if (!ok || offset != data.size()) {
+    LOG(WARNING) << "ignore the corrupted COCO meta cache " << cache_path;
+    return false;
+  }
+  return true;
+}
 
-  bool bbox_area_all_close_to_zero = true;
-  size_t visible_keypoints_count = 0;
-  for (int64_t anno_id : anno_id_vec) {
-    const auto& anno = anno_id2anno_.at(anno_id);
-    if (anno["bbox"][2] > 1 && anno["bbox"][3] > 1) { bbox_area_all_close_to_zero = false; }
-    if (anno.contains("keypoints")) {
-      const auto& keypoints = anno["keypoints"];
-      CHECK_EQ(keypoints.size() % 3, 0);
-      FOR_RANGE(size_t, i, 0, keypoints.size() / 3) {
-        int32_t keypoints_label = keypoints[i * 3 + 2].get<int32_t>();
-        if (keypoints_label > 0) { visible_keypoints_count += 1; }
-      }
+void COCOMeta::SaveCache(const std::string& cache_path, uint64_t annotation_file_size,
+                         bool remove_images_without_annotations) const {
+#ifdef OF_PLATFORM_POSIX
+  // like the OFRecord index, the cache is only written next to annotation files on a local file
+  // system, which may be read only
+  fs::FileSystem* fs = DataFS();
+  if (dynamic_cast<fs::PosixFileSystem*>(fs) == nullptr) { return; }
+  const std::string path = fs->TranslateName(cache_path);
+  const std::string tmp_path = path + ".tmp." + std::to_string(getpid());
+  COCOMetaCacheHeader header{};
+  header.annotation_file_size = annotation_file_size;
+  header.remove_images_without_annotations = remove_images_without_annotations;
+  header.num_images = image_ids_.size();
+  header.num_annos = anno_labels_.size();
+  header.num_polys = poly_coord_offsets_.size() - 1;
+  header.num_coords = poly_coords_.size();
+  header.file_names_size = file_names_.size();
+  {
+    std::ofstream stream(tmp_path, std::ios::binary | std::ios::trunc);
+    if (!stream.is_open()) { return; }
+    stream.write(kCacheMagicCode, kCacheMagicCodeLen);
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    WriteArray(&stream, image_ids_);
+    WriteArray(&stream, image_heights_);
+    WriteArray(&stream, image_widths_);
+    WriteArray(&stream, image_anno_offsets_);
+    WriteArray(&stream, file_name_offsets_);
+    WriteArray(&stream, file_names_);
+    WriteArray(&stream, anno_bboxes_);
+    WriteArray(&stream, anno_labels_);
+    WriteArray(&stream, anno_poly_offsets_);
+    WriteArray(&stream, poly_coord_offsets_);
+    WriteArray(&stream, poly_coords_);
+    if (!stream.good()) {
+      stream.close();
+      std::remove(tmp_path.c_str());
+      return;
     }
   }
-  // check if all boxes are close to zero area
-  if (bbox_area_all_close_to_zero) { return false; }
-  // keypoints task have a slight different critera for considering
-  // if an annotation is valid
-  if (!anno_id2anno_.at(anno_id_vec.at(0)).contains("keypoints")) { return true; }
-  // for keypoint detection tasks, only consider valid images those
-  // containing at least min_keypoints_per_image
-  if (visible_keypoints_count >= kMinKeypointsPerImage) { return true; }
-  return false;
+  if (std::rename(tmp_path.c_str(), path.c_str()) != 0) { std::remove(tmp_path.c_str()); }
+#endif  // OF_PLATFORM_POSIX
 }
 
 }  // namespace data
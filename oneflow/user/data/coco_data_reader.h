@@ -19,7 +19,6 @@ limitations under the License.
 #include "oneflow/user/data/data_reader.h"
 #include "oneflow/user/data/coco_parser.h"
 #include "oneflow/core/common/str_util.h"
-#include <json.hpp>
 
 namespace oneflow {
 namespace data {
@@ -34,6 +33,9 @@ class COCODataReader final : public DataReader<COCOImage> {
   using DataReader<COCOImage>::parser_;
 };
 
+// The images and their annotations of a COCO annotation file, flattened into arrays. Parsing the
+// JSON takes long for large datasets, so the arrays are cached in "<annotation_file>.meta" and
+// loaded from it while the annotation file keeps its size.
 class COCOMeta final {
  public:
   COCOMeta(int64_t session_id, const std::string& annotation_file, const std::string& image_dir,
@@ -42,18 +44,12 @@ class COCOMeta final {
 
   int64_t Size() const { return image_ids_.size(); }
   int64_t GetImageId(int64_t index) const { return image_ids_.at(index); }
-  int32_t GetImageHeight(int64_t index) const {
-    int64_t image_id = image_ids_.at(index);
-    return image_id2image_.at(image_id)["height"].get<int32_t>();
-  }
-  int32_t GetImageWidth(int64_t index) const {
-    int64_t image_id = image_ids_.at(index);
-    return image_id2image_.at(image_id)["width"].get<int32_t>();
-  }
+  int32_t GetImageHeight(int64_t index) const { return image_heights_.at(index); }
+  int32_t GetImageWidth(int64_t index) const { return image_widths_.at(index); }
   std::string GetImageFilePath(int64_t index) const {
-    int64_t image_id = image_ids_.at(index);
-    const auto& image_json = image_id2image_.at(image_id);
-    return JoinPath(image_dir_, image_json["file_name"].get<std::string>());
+    const int64_t begin = file_name_offsets_.at(index);
+    const int64_t end = file_name_offsets_.at(index + 1);
+    return JoinPath(image_dir_, std::string(file_names_.data() + begin, end - begin));
   }
   template<typename T>
   std::vector<T> GetBboxVec(int64_t index) const;
@@ -64,35 +60,46 @@ class COCOMeta final {
                                        TensorBuffer* segm_offset_mat) const;
 
  private:
-  bool ImageHasValidAnnotations(int64_t image_id) const;
+  void ParseAnnotationFile(int64_t session_id, const std::string& annotation_file,
+                           bool remove_images_without_annotations);
+  bool LoadCache(const std::string& cache_path, uint64_t annotation_file_size,
+                 bool remove_images_without_annotations);
+  void SaveCache(const std::string& cache_path, uint64_t annotation_file_size,
+                 bool remove_images_without_annotations) const;
 
-  static constexpr int kMinKeypointsPerImage = 10;
-  nlohmann::json annotation_json_;
   std::string image_dir_;
+  // the images sorted by id, the annotations of image i are [image_anno_offsets_[i],
+  // image_anno_offsets_[i + 1]) and its file name is [file_name_offsets_[i],
+  // file_name_offsets_[i + 1]) of file_names_
   std::vector<int64_t> image_ids_;
-  HashMap<int64_t, const nlohmann::json&> image_id2image_;
-  HashMap<int64_t, const nlohmann::json&> anno_id2anno_;
-  HashMap<int64_t, std::vector<int64_t>> image_id2anno_ids_;
-  HashMap<int32_t, int32_t> category_id2contiguous_id_;
+  std::vector<int32_t> image_heights_;
+  std::vector<int32_t> image_widths_;
+  std::vector<int64_t> image_anno_offsets_;
+  std::vector<int64_t> file_name_offsets_;
+  std::vector<char> file_names_;
+  // the bbox of each annotation as [left, top, width, height], its contiguous category id and its
+  // polygons [anno_poly_offsets_[j], anno_poly_offsets_[j + 1])
+  std::vector<double> anno_bboxes_;
+  std::vector<int32_t> anno_labels_;
+  std::vector<int64_t> anno_poly_offsets_;
+  // the coordinates of polygon k are [poly_coord_offsets_[k], poly_coord_offsets_[k + 1])
+  std::vector<int64_t> poly_coord_offsets_;
+  std::vector<double> poly_coords_;
 };
 
 template<typename T>
 std::vector<T> COCOMeta::GetBboxVec(int64_t index) const {
   std::vector<T> bbox_vec;
-  int64_t image_id = image_ids_.at(index);
-  const auto& anno_ids = image_id2anno_ids_.at(image_id);
-  for (int64_t anno_id : anno_ids) {
-    const auto& bbox_json = anno_id2anno_.at(anno_id)["bbox"];
-    CHECK(bbox_json.is_array());
-    CHECK_EQ(bbox_json.size(), 4);
+  FOR_RANGE(int64_t, anno_idx, image_anno_offsets_.at(index), image_anno_offsets_.at(index + 1)) {
+    const double* bbox = anno_bboxes_.data() + anno_idx * 4;
     // COCO bounding box format is [left, top, width, height]
     // we need format xyxy
     const T alginment = static_cast<T>(1);
     const T min_size = static_cast<T>(0);
-    T left = bbox_json[0].get<T>();
-    T top = bbox_json[1].get<T>();
-    T width = bbox_json[2].get<T>();
-    T height = bbox_json[3].get<T>();
+    T left = static_cast<T>(bbox[0]);
+    T top = static_cast<T>(bbox[1]);
+    T width = static_cast<T>(bbox[2]);
+    T height = static_cast<T>(bbox[3]);
     T right = left + std::max(width - alginment, min_size);
     T bottom = top + std::max(height - alginment, min_size);
     // clip to image
@@ -113,11 +120,8 @@ std::vector<T> COCOMeta::GetBboxVec(int64_t index) const {
 template<typename T>
 std::vector<T> COCOMeta::GetLabelVec(int64_t index) const {
   std::vector<T> label_vec;
-  int64_t image_id = image_ids_.at(index);
-  const auto& anno_ids = image_id2anno_ids_.at(image_id);
-  for (int64_t anno_id : anno_ids) {
-    int32_t category_id = anno_id2anno_.at(anno_id)["category_id"].get<int32_t>();
-    label_vec.push_back(category_id2contiguous_id_.at(category_id));
+  FOR_RANGE(int64_t, anno_idx, image_anno_offsets_.at(index), image_anno_offsets_.at(index + 1)) {
+    label_vec.push_back(anno_labels_.at(anno_idx));
   }
   return label_vec;
 }
@@ -126,36 +130,28 @@ template<typename T>
 void COCOMeta::ReadSegmentationsToTensorBuffer(int64_t index, TensorBuffer* segm,
                                                TensorBuffer* segm_index) const {
   if (segm == nullptr || segm_index == nullptr) { return; }
-  int64_t image_id = image_ids_.at(index);
-  const auto& anno_ids = image_id2anno_ids_.at(image_id);
-  std::vector<T> segm_vec;
-  for (int64_t anno_id : anno_ids) {
-    const auto& segm_json = anno_id2anno_.at(anno_id)["segmentation"];
-    if (!segm_json.is_array()) { continue; }
-    for (const auto& poly_json : segm_json) {
-      CHECK(poly_json.is_array());
-      for (const auto& elem : poly_json) { segm_vec.push_back(elem.get<T>()); }
-    }
-  }
-  CHECK_EQ(segm_vec.size() % 2, 0);
-  int64_t num_pts = segm_vec.size() / 2;
+  const int64_t anno_begin = image_anno_offsets_.at(index);
+  const int64_t anno_end = image_anno_offsets_.at(index + 1);
+  const int64_t coord_begin = poly_coord_offsets_.at(anno_poly_offsets_.at(anno_begin));
+  const int64_t coord_end = poly_coord_offsets_.at(anno_poly_offsets_.at(anno_end));
+  CHECK_EQ((coord_end - coord_begin) % 2, 0);
+  int64_t num_pts = (coord_end - coord_begin) / 2;
   segm->Resize(Shape({num_pts, 2}), GetDataType<T>::value);
-  std::copy(segm_vec.begin(), segm_vec.end(), segm->mut_data<T>());
+  std::transform(poly_coords_.data() + coord_begin, poly_coords_.data() + coord_end,
+                 segm->mut_data<T>(), [](double coord) { return static_cast<T>(coord); });
 
   segm_index->Resize(Shape({num_pts, 3}), DataType::kInt32);
   int32_t* index_ptr = segm_index->mut_data<int32_t>();
   int i = 0;
   int32_t segm_idx = 0;
-  for (int64_t anno_id : anno_ids) {
-    const auto& segm_json = anno_id2anno_.at(anno_id)["segmentation"];
-    CHECK(segm_json.is_array());
-    FOR_RANGE(int32_t, poly_idx, 0, segm_json.size()) {
-      const auto& poly_json = segm_json[poly_idx];
-      CHECK(poly_json.is_array());
-      CHECK_EQ(poly_json.size() % 2, 0);
-      FOR_RANGE(int32_t, pt_idx, 0, poly_json.size() / 2) {
+  FOR_RANGE(int64_t, anno_idx, anno_begin, anno_end) {
+    const int64_t poly_begin = anno_poly_offsets_.at(anno_idx);
+    FOR_RANGE(int64_t, poly, poly_begin, anno_poly_offsets_.at(anno_idx + 1)) {
+      const int64_t poly_size = poly_coord_offsets_.at(poly + 1) - poly_coord_offsets_.at(poly);
+      CHECK_EQ(poly_size % 2, 0);
+      FOR_RANGE(int32_t, pt_idx, 0, poly_size / 2) {
         index_ptr[i * 3 + 0] = pt_idx;
-        index_ptr[i * 3 + 1] = poly_idx;
+        index_ptr[i * 3 + 1] = poly - poly_begin;
         index_ptr[i * 3 + 2] = segm_idx;
         i += 1;
       }
@@ -17,6 +17,7 @@ limitations under the License.
 #include "oneflow/user/data/coco_data_reader.h"
 #include "oneflow/core/persistence/file_system.h"
 #include "oneflow/core/persistence/persistent_in_stream.h"
+#include "oneflow/core/thread/thread_manager.h"
 
 namespace oneflow {
 namespace data {
@@ -37,6 +38,16 @@ COCODataset::LoadTargetShdPtrVec COCODataset::At(int64_t index) const {
   return ret;
 }
 
+COCODataset::LoadTargetShdPtrVec COCODataset::BatchAt(const std::vector<int64_t>& indices) const {
+  LoadTargetShdPtrVec ret(indices.size());
+  MultiThreadLoop(indices.size(), [&](size_t i) {
+    LoadTargetShdPtrVec samples = At(indices.at(i));
+    CHECK_EQ(samples.size(), 1);
+    ret.at(i) = std::move(samples.front());
+  });
+  return ret;
+}
+
 size_t COCODataset::Size() const { return meta_->Size(); }
 
 }  // namespace data
@@ -42,6 +42,7 @@ class COCODataset final : public RandomAccessDataset<COCOImage> {
   ~COCODataset() = default;
 
   LoadTargetShdPtrVec At(int64_t index) const override;
+  LoadTargetShdPtrVec BatchAt(const std::vector<int64_t>& indices) const override;
   size_t Size() const override;
 
  private:
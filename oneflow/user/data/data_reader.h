@@ -16,73 +16,133 @@ limitations under the License.
 #ifndef ONEFLOW_USER_DATA_DATA_READER_H_
 #define ONEFLOW_USER_DATA_DATA_READER_H_
 
-#include "oneflow/core/common/buffer.h"
+#include <condition_variable>
+#include "oneflow/core/common/util.h"
 #include "oneflow/core/framework/op_kernel.h"
 #include "oneflow/user/data/dataset.h"
 #include "oneflow/user/data/parser.h"
+#include "oneflow/core/thread/thread_affinity.h"
+#include "oneflow/core/profiler/metrics.h"
 
 namespace oneflow {
 namespace data {
 
 static const int32_t kDataReaderBatchBufferSize = 4;
 
+// The loader is shared by the workers and called by one of them at a time, each worker prepares
+// the whole batches it loaded. The batches are handed to Read in the order they were loaded, so
+// the results do not depend on which worker finishes first.
 template<typename LoadTarget>
 class DataReader {
  public:
   using LoadTargetPtr = std::shared_ptr<LoadTarget>;
   using LoadTargetPtrList = std::vector<LoadTargetPtr>;
   DataReader(user_op::KernelInitContext* ctx)
-      : is_closed_(false), batch_buffer_(kDataReaderBatchBufferSize) {}
+      : is_closed_(false),
+        num_workers_(ParseIntegerFromEnv("ONEFLOW_DATA_READER_NUM_WORKERS", 1)),
+        batch_buffer_size_(ParseIntegerFromEnv("ONEFLOW_DATA_READER_BATCH_BUFFER_SIZE",
+                                               kDataReaderBatchBufferSize)),
+        next_load_seq_(0),
+        next_read_seq_(0),
+        buffered_batches_gauge_(
+            profiler::GetGauge("oneflow_data_reader_buffered_batches",
+                               "batches loaded by a data reader and waiting to be read",
+                               {{"op", ctx->op_name()}})) {
+    CHECK_GT(num_workers_, 0);
+    CHECK_GT(batch_buffer_size_, 0);
+  }
   virtual ~DataReader() {
     Close();
-    if (load_thrd_.joinable()) { load_thrd_.join(); }
+    for (auto& worker : workers_) {
+      if (worker.joinable()) { worker.join(); }
+    }
   }
 
   void Read(user_op::KernelComputeContext* ctx) {
-    CHECK(load_thrd_.joinable()) << "You should call StartLoadThread before read data";
-    auto batch_data = FetchBatchData();
-    parser_->Parse(batch_data, ctx);
+    CHECK(!workers_.empty()) << "You should call StartLoadThread before read data";
+    auto batch = FetchBatch();
+    parser_->ParsePrepared(batch->data, batch->prepared, ctx);
   }
 
   void Close() {
-    is_closed_.store(true);
-    bool buffer_drained = false;
-    while (!buffer_drained) {
-      std::shared_ptr<LoadTargetPtrList> abandoned_batch_data(nullptr);
-      auto status = batch_buffer_.TryReceive(&abandoned_batch_data);
-      CHECK_NE(status, BufferStatus::kBufferStatusErrorClosed);
-      buffer_drained = (status == BufferStatus::kBufferStatusEmpty);
+    {
+      std::unique_lock<std::mutex> lock(batch_mutex_);
+      is_closed_.store(true);
+      loaded_batches_.clear();
     }
-    batch_buffer_.Close();
+    batch_cond_.notify_all();
   }
 
  protected:
   void StartLoadThread() {
-    if (load_thrd_.joinable()) { return; }
-    load_thrd_ = std::thread([this] {
-      while (!is_closed_.load() && LoadBatch()) {}
-    });
+    if (!workers_.empty()) { return; }
+    FOR_RANGE(int64_t, i, 0, num_workers_) {
+      workers_.emplace_back([this] {
+        BindCurrentThreadToRoleCores(ThreadRole::kData);
+        while (!is_closed_.load() && LoadBatch()) {}
+      });
+    }
   }
 
   std::unique_ptr<Dataset<LoadTarget>> loader_;
   std::unique_ptr<Parser<LoadTarget>> parser_;
 
  private:
-  std::shared_ptr<LoadTargetPtrList> FetchBatchData() {
-    std::shared_ptr<LoadTargetPtrList> batch_data(nullptr);
-    CHECK_EQ(batch_buffer_.Receive(&batch_data), BufferStatus::kBufferStatusSuccess);
-    return batch_data;
+  struct Batch {
+    std::shared_ptr<LoadTargetPtrList> data;
+    std::shared_ptr<void> prepared;
+  };
+
+  std::shared_ptr<Batch> FetchBatch() {
+    std::unique_lock<std::mutex> lock(batch_mutex_);
+    batch_cond_.wait(lock, [this] {
+      return is_closed_.load() || loaded_batches_.find(next_read_seq_) != loaded_batches_.end();
+    });
+    CHECK(!is_closed_.load()) << "The data reader is closed";
+    auto it = loaded_batches_.find(next_read_seq_);
+    std::shared_ptr<Batch> batch = it->second;
+    loaded_batches_.erase(it);
+    buffered_batches_gauge_->Set(loaded_batches_.size());
+    next_read_seq_ += 1;
+    lock.unlock();
+    batch_cond_.notify_all();
+    return batch;
   }
 
   bool LoadBatch() {
-    std::shared_ptr<LoadTargetPtrList> batch_data =
-        std::make_shared<LoadTargetPtrList>(std::move(loader_->Next()));
-    return batch_buffer_.Send(batch_data) == BufferStatus::kBufferStatusSuccess;
+    auto batch = std::make_shared<Batch>();
+    int64_t seq = 0;
+    {
+      std::unique_lock<std::mutex> lock(load_mutex_);
+      if (is_closed_.load()) { return false; }
+      seq = next_load_seq_++;
+      batch->data = std::make_shared<LoadTargetPtrList>(std::move(loader_->Next()));
+    }
+    parser_->Prepare(*batch->data, &batch->prepared);
+    std::unique_lock<std::mutex> lock(batch_mutex_);
+    // at most batch_buffer_size_ batches wait for Read, the batch Read waits for is always let in
+    batch_cond_.wait(lock, [this, seq] {
+      return is_closed_.load() || seq < next_read_seq_ + batch_buffer_size_;
+    });
+    if (is_closed_.load()) { return false; }
+    loaded_batches_.emplace(seq, batch);
+    buffered_batches_gauge_->Set(loaded_batches_.size());
+    lock.unlock();
+    batch_cond_.notify_all();
+    return true;
   }
 
   std::atomic<bool> is_closed_;
-  Buffer<std::shared_ptr<LoadTargetPtrList>> batch_buffer_;
-  std::thread load_thrd_;
+  const int64_t num_workers_;
+  const int64_t batch_buffer_size_;
+  std::mutex load_mutex_;
+  int64_t next_load_seq_;
+  std::mutex batch_mutex_;
+  std::condition_variable batch_cond_;
+  int64_t next_read_seq_;
+  HashMap<int64_t, std::shared_ptr<Batch>> loaded_batches_;
+  profiler::Gauge* buffered_batches_gauge_;
+  std::vector<std::thread> workers_;
 };
 
 }  // namespace data
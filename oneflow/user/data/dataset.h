@@ -47,6 +47,16 @@ class RandomAccessDataset : public Dataset<LoadTarget> {
   virtual LoadTargetShdPtrVec At(int64_t index) const = 0;
   virtual size_t Size() const = 0;
 
+  // Reads the samples at `indices` in their order, the datasets that can coalesce the reads of
+  // nearby samples override it
+  virtual LoadTargetShdPtrVec BatchAt(const std::vector<int64_t>& indices) const {
+    LoadTargetShdPtrVec ret;
+    for (int64_t index : indices) {
+      for (auto& sample : this->At(index)) { ret.push_back(std::move(sample)); }
+    }
+    return ret;
+  }
+
   LoadTargetShdPtrVec Next() final {
     LoadTargetShdPtrVec ret = this->At(cur_idx_);
     cur_idx_ += 1;
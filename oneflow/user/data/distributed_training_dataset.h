@@ -30,7 +30,8 @@ class DistributedTrainingDataset final : public Dataset<LoadTarget> {
   using LoadTargetShdPtrVec = std::vector<LoadTargetShdPtr>;
 
   DistributedTrainingDataset(int64_t parallel_num, int64_t parallel_id, bool stride_partition,
-                             bool shuffle, int64_t random_seed, BaseDatasetUnqPtr&& dataset)
+                             bool shuffle, int64_t random_seed, BaseDatasetUnqPtr&& dataset,
+                             int64_t read_batch_size = 1)
       : base_dataset_(std::move(dataset)),
         shuffle_(shuffle),
         stride_partition_(stride_partition),
@@ -38,7 +39,9 @@ class DistributedTrainingDataset final : public Dataset<LoadTarget> {
         num_shards_(parallel_num),
         pos_(0),
         pos_in_shard_(0),
-        epoch_cnt_(0) {
+        epoch_cnt_(0),
+        read_batch_size_(read_batch_size),
+        read_pos_(0) {
     shard_size_ = std::ceil(static_cast<float>(base_dataset_->Size()) / num_shards_);
     if (stride_partition) {
       pos_ = parallel_id;
@@ -51,7 +54,23 @@ class DistributedTrainingDataset final : public Dataset<LoadTarget> {
   }
   virtual ~DistributedTrainingDataset() = default;
 
+  // With a read_batch_size above 1, the samples of the next read_batch_size indices are read
+  // together by BatchAt, and returned one by one in the order of the index sequence
   virtual LoadTargetShdPtrVec Next() override {
+    if (read_batch_size_ <= 1) { return base_dataset_->At(NextIndex()); }
+    if (read_pos_ == read_buffer_.size()) {
+      std::vector<int64_t> indices(read_batch_size_);
+      for (int64_t& index : indices) { index = NextIndex(); }
+      read_buffer_ = base_dataset_->BatchAt(indices);
+      read_pos_ = 0;
+    }
+    LoadTargetShdPtrVec ret{std::move(read_buffer_.at(read_pos_))};
+    read_pos_ += 1;
+    return ret;
+  }
+
+ private:
+  int64_t NextIndex() {
     // There are 2 partition strategies
     // assume epoch size is 10, index seq don't shuffle and there are 4 parts
     // stride partition strategy (when stride_partition is true):
@@ -62,7 +81,7 @@ class DistributedTrainingDataset final : public Dataset<LoadTarget> {
     //       |  part1   |  part2   |  part3   |  part4   |
     // iter0 | 0, 1, 2, | 3, 4, 5, | 6, 7, 8, | 9, 0, 1, |
     // iter1 | 2, 3, 4, | 5, 6, 7, | 8, 9, 0, | 1, 2, 3, |
-    LoadTargetShdPtrVec ret = base_dataset_->At(index_seq_.at(pos_));
+    const int64_t index = index_seq_.at(pos_);
     if (stride_partition_) {
       pos_ += num_shards_;
     } else {
@@ -74,10 +93,9 @@ class DistributedTrainingDataset final : public Dataset<LoadTarget> {
       }
     }
     CheckRanOutOfSize();
-    return ret;
+    return index;
   }
 
- private:
   void CheckRanOutOfSize() {
     if (pos_ >= index_seq_.size()) {
       GenNewIndexSequence();
@@ -103,6 +121,9 @@ class DistributedTrainingDataset final : public Dataset<LoadTarget> {
   int64_t pos_in_shard_;
   int64_t epoch_cnt_;
   std::vector<int64_t> index_seq_;
+  int64_t read_batch_size_;
+  LoadTargetShdPtrVec read_buffer_;
+  size_t read_pos_;
 };
 
 }  // namespace data
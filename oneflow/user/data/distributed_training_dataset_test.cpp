@@ -0,0 +1,81 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <gtest/gtest.h>
+#include "oneflow/user/data/distributed_training_dataset.h"
+
+namespace oneflow {
+
+namespace data {
+
+namespace {
+
+class RangeDataset final : public RandomAccessDataset<int64_t> {
+ public:
+  explicit RangeDataset(size_t size, std::vector<size_t>* batch_sizes)
+      : size_(size), batch_sizes_(batch_sizes) {}
+
+  LoadTargetShdPtrVec At(int64_t index) const override {
+    return LoadTargetShdPtrVec{std::make_shared<int64_t>(index)};
+  }
+  LoadTargetShdPtrVec BatchAt(const std::vector<int64_t>& indices) const override {
+    batch_sizes_->push_back(indices.size());
+    return RandomAccessDataset<int64_t>::BatchAt(indices);
+  }
+  size_t Size() const override { return size_; }
+
+ private:
+  size_t size_;
+  std::vector<size_t>* batch_sizes_;
+};
+
+std::vector<int64_t> ReadShard(int64_t parallel_num, int64_t parallel_id, int64_t read_batch_size,
+                               size_t num_samples, std::vector<size_t>* batch_sizes) {
+  DistributedTrainingDataset<int64_t> dataset(
+      parallel_num, parallel_id, /*stride_partition=*/true, /*shuffle=*/true, /*random_seed=*/7,
+      std::make_unique<RangeDataset>(10, batch_sizes), read_batch_size);
+  std::vector<int64_t> ret;
+  for (size_t i = 0; i < num_samples; ++i) {
+    auto samples = dataset.Next();
+    EXPECT_EQ(samples.size(), 1);
+    ret.push_back(*samples.at(0));
+  }
+  return ret;
+}
+
+}  // namespace
+
+TEST(DistributedTrainingDataset, batch_read_keeps_the_index_sequence) {
+  std::vector<size_t> batch_sizes;
+  const std::vector<int64_t> expected = ReadShard(2, 1, 1, 12, &batch_sizes);
+  ASSERT_TRUE(batch_sizes.empty());
+  ASSERT_EQ(ReadShard(2, 1, 4, 12, &batch_sizes), expected);
+  ASSERT_EQ(batch_sizes, std::vector<size_t>({4, 4, 4}));
+}
+
+TEST(DistributedTrainingDataset, shards_are_disjoint) {
+  std::vector<size_t> batch_sizes;
+  std::vector<int64_t> samples = ReadShard(2, 0, 5, 5, &batch_sizes);
+  const std::vector<int64_t> other = ReadShard(2, 1, 5, 5, &batch_sizes);
+  samples.insert(samples.end(), other.begin(), other.end());
+  std::sort(samples.begin(), samples.end());
+  std::vector<int64_t> all(10);
+  std::iota(all.begin(), all.end(), 0);
+  ASSERT_EQ(samples, all);
+}
+
+}  // namespace data
+
+}  // namespace oneflow
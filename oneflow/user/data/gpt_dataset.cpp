@@ -14,6 +14,8 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #include "oneflow/user/data/gpt_dataset.h"
+#include "oneflow/core/common/str_util.h"
+#include "oneflow/core/thread/thread_pool.h"
 
 #ifdef __linux__
 #include <fcntl.h>
@@ -21,6 +23,7 @@ limitations under the License.
 #include <errno.h>
 #include <sys/stat.h>
 #include <sys/mman.h>
+#include <unistd.h>
 #endif
 
 namespace oneflow {
@@ -74,6 +77,35 @@ size_t GetNumCompleteEpochs(size_t num_samples, size_t seq_length, size_t tokens
   return separate_last_epoch ? (num_epochs - 1) : num_epochs;
 }
 
+constexpr char kIndexCacheMagicCode[] = "OFGPTIDX";
+constexpr size_t kIndexCacheMagicCodeLen = sizeof(kIndexCacheMagicCode) - 1;
+constexpr int64_t kParallelGrainSize = 1 << 16;
+
+// Calls Handler on chunks of [0, n) on the thread pool of the process when there is one
+void ParallelForChunks(size_t n, const std::function<void(size_t begin, size_t end)>& Handler) {
+  ThreadPool* thread_pool = Global<ThreadPool>::Get();
+  if (thread_pool == nullptr || n <= kParallelGrainSize) {
+    Handler(0, n);
+    return;
+  }
+  thread_pool->ParallelFor(Range(0, n), kParallelGrainSize,
+                           [&](const Range& range) { Handler(range.begin(), range.end()); });
+}
+
+std::string IndexCacheFileName(const std::string& data_file_prefix, size_t seq_len,
+                               size_t label_len, size_t num_samples,
+                               const std::vector<int64_t>& split_sizes, size_t split_index,
+                               bool shuffle, uint32_t seed) {
+  std::string split;
+  for (int64_t split_size : split_sizes) {
+    split += (split.empty() ? "" : "-") + std::to_string(split_size);
+  }
+  return Basename(data_file_prefix) + "_" + std::to_string(num_samples) + "ns_"
+         + std::to_string(seq_len) + "sl_" + std::to_string(label_len) + "ll_"
+         + std::to_string(seed) + "s_" + std::to_string(split_index) + "of" + split + "_"
+         + (shuffle ? "shuffled" : "ordered") + ".gpt_index";
+}
+
 }  // namespace
 
 constexpr char MegatronGPTIndex::kMagicCode[];
@@ -161,11 +193,21 @@ MegatronGPTMMapDataset::MegatronGPTMMapDataset(const std::string& data_file_pref
   tokens_per_epoch_ = GetEpochNumTokens(epoch_doc_indices);
   num_epochs_ = GetNumEpochs(num_samples_, seq_len_, tokens_per_epoch_);
   num_complete_epochs_ = GetNumCompleteEpochs(num_samples_, seq_len_, tokens_per_epoch_);
-  InitDocIndices(epoch_doc_indices, num_epochs_, num_complete_epochs_);
-  size_t total_num_samples = static_cast<size_t>(
-      std::floor(static_cast<double>(num_epochs_ * tokens_per_epoch_ - 1) / seq_len_));
-  InitSampleIndices(total_num_samples);
-  InitShuffleIndices(sample_indices_.size());
+  std::string index_cache_path;
+  if (ParseBooleanFromEnv("ONEFLOW_GPT_DATASET_USE_INDEX_CACHE", true)) {
+    index_cache_path = JoinPath(
+        GetStringFromEnv("ONEFLOW_GPT_DATASET_INDEX_CACHE_DIR", Dirname(data_file_prefix)),
+        IndexCacheFileName(data_file_prefix, seq_len, label_len, num_samples, split_sizes,
+                           split_index, shuffle, seed));
+  }
+  if (index_cache_path.empty() || !TryLoadIndexCache(index_cache_path)) {
+    InitDocIndices(epoch_doc_indices, num_epochs_, num_complete_epochs_);
+    size_t total_num_samples = static_cast<size_t>(
+        std::floor(static_cast<double>(num_epochs_ * tokens_per_epoch_ - 1) / seq_len_));
+    InitSampleIndices(total_num_samples);
+    InitShuffleIndices(sample_indices_.size());
+    if (!index_cache_path.empty()) { SaveIndexCache(index_cache_path); }
+  }
   std::chrono::duration<double, std::milli> elapse = std::chrono::system_clock::now() - start;
   LOG(INFO) << "Create GPT Dataset successed, sequence length: " << seq_len_
             << ", number of samples: " << num_samples_
@@ -177,6 +219,28 @@ MegatronGPTMMapDataset::MegatronGPTMMapDataset(const std::string& data_file_pref
             << ", elapsed time: " << elapse.count() << " ms";
 }
 
+void MegatronGPTMMapDataset::GetSampleDocOffsets(size_t index, int32_t* offsets,
+                                                 size_t num_offsets) const {
+  CHECK_LT(index, shuffle_indices_.size());
+  const size_t sample_index = shuffle_indices_[index];
+  CHECK_LT(sample_index, sample_indices_.size());
+  CHECK_GE(num_offsets, 2);
+  size_t doc_indices_idx = sample_indices_[sample_index].first;
+  size_t doc_offset = sample_indices_[sample_index].second;
+  size_t num_docs = 0;
+  size_t pos = 0;
+  while (pos < seq_len_) {
+    CHECK_LT(doc_indices_idx, doc_indices_.size());
+    CHECK_LT(num_docs + 1, num_offsets);
+    offsets[num_docs++] = pos;
+    const size_t doc_index = doc_indices_[doc_indices_idx];
+    pos += index_->doc_length(doc_index) - doc_offset;
+    doc_indices_idx += 1;
+    doc_offset = 0;
+  }
+  std::fill(offsets + num_docs, offsets + num_offsets, static_cast<int32_t>(seq_len_));
+}
+
 size_t MegatronGPTMMapDataset::GetEpochNumTokens(const std::vector<size_t>& doc_indices) const {
   size_t num_tokens = 0;
   for (auto doc_index : doc_indices) { num_tokens += index_->doc_length(doc_index); }
@@ -202,31 +266,49 @@ void MegatronGPTMMapDataset::InitDocIndices(const std::vector<size_t>& epoch_doc
   if (shuffle_) { std::shuffle(doc_indices_.begin() + start, doc_indices_.end(), gen_); }
 }
 
+// A sample starts at token i * seq_len of the docs in doc_indices_ order, so it is found by a
+// binary search in the token offsets of the docs, and the samples are independent of each other.
 void MegatronGPTMMapDataset::InitSampleIndices(size_t total_num_samples) {
-  sample_indices_.reserve(total_num_samples);
-  size_t doc_indices_idx = 0;
-  size_t doc_offset = 0;
-  FOR_RANGE(size_t, i, 0, total_num_samples) {
-    if (doc_indices_idx >= doc_indices_.size()) { break; }
-    sample_indices_.emplace_back(doc_indices_idx, doc_offset);
-    int remaining_tokens = seq_len_;
-    while (remaining_tokens > 0) {
-      CHECK_LT(doc_indices_idx, doc_indices_.size());
-      size_t doc_len = index_->doc_length(doc_indices_[doc_indices_idx]);
-      CHECK_LT(doc_offset, doc_len);
-      doc_len -= doc_offset;
-      if (remaining_tokens < doc_len) {
-        // move offset inside doc
-        doc_offset += remaining_tokens;
-      } else {
-        // move to next doc
-        doc_indices_idx += 1;
-        doc_offset = 0;
+  const size_t num_docs = doc_indices_.size();
+  // doc_token_offsets[i] is the number of tokens before doc i, computed by a chunked scan
+  std::vector<size_t> doc_token_offsets(num_docs + 1, 0);
+  const size_t num_chunks = (num_docs + kParallelGrainSize - 1) / kParallelGrainSize;
+  std::vector<size_t> chunk_offsets(num_chunks + 1, 0);
+  ParallelForChunks(num_chunks, [&](size_t begin, size_t end) {
+    FOR_RANGE(size_t, chunk, begin, end) {
+      const size_t doc_end = std::min(num_docs, (chunk + 1) * kParallelGrainSize);
+      size_t num_tokens = 0;
+      FOR_RANGE(size_t, i, chunk * kParallelGrainSize, doc_end) {
+        num_tokens += index_->doc_length(doc_indices_[i]);
       }
-      remaining_tokens -= doc_len;
+      chunk_offsets[chunk + 1] = num_tokens;
     }
-  }
-  CHECK_EQ(sample_indices_.size(), total_num_samples);
+  });
+  std::partial_sum(chunk_offsets.begin(), chunk_offsets.end(), chunk_offsets.begin());
+  ParallelForChunks(num_chunks, [&](size_t begin, size_t end) {
+    FOR_RANGE(size_t, chunk, begin, end) {
+      const size_t doc_end = std::min(num_docs, (chunk + 1) * kParallelGrainSize);
+      size_t offset = chunk_offsets[chunk];
+      FOR_RANGE(size_t, i, chunk * kParallelGrainSize, doc_end) {
+        offset += index_->doc_length(doc_indices_[i]);
+        doc_token_offsets[i + 1] = offset;
+      }
+    }
+  });
+
+  sample_indices_.resize(total_num_samples);
+  ParallelForChunks(total_num_samples, [&](size_t begin, size_t end) {
+    FOR_RANGE(size_t, i, begin, end) {
+      const size_t token_offset = i * seq_len_;
+      // the first doc that ends after the start of the sample
+      const size_t doc_indices_idx =
+          std::upper_bound(doc_token_offsets.cbegin() + 1, doc_token_offsets.cend(), token_offset)
+          - (doc_token_offsets.cbegin() + 1);
+      CHECK_LT(doc_indices_idx, num_docs);
+      sample_indices_[i] =
+          std::make_pair(doc_indices_idx, token_offset - doc_token_offsets[doc_indices_idx]);
+    }
+  });
   CHECK_GE(sample_indices_.size(), num_samples_);
 }
 
@@ -244,6 +326,84 @@ void MegatronGPTMMapDataset::InitShuffleIndices(size_t total_num_samples) {
   }
 }
 
+std::vector<uint64_t> MegatronGPTMMapDataset::IndexCacheKey() const {
+  return {index_->num_docs(), tokens_per_epoch_, seq_len_, sample_len_, num_samples_,
+          num_epochs_,        num_complete_epochs_, shuffle_, seed_};
+}
+
+bool MegatronGPTMMapDataset::TryLoadIndexCache(const std::string& path) {
+  std::ifstream stream(path, std::ios::binary);
+  if (!stream.is_open()) { return false; }
+  auto start = std::chrono::system_clock::now();
+  char magic_code[kIndexCacheMagicCodeLen];
+  stream.read(magic_code, kIndexCacheMagicCodeLen);
+  if (!stream || std::memcmp(magic_code, kIndexCacheMagicCode, kIndexCacheMagicCodeLen) != 0) {
+    return false;
+  }
+  std::vector<uint64_t> key(IndexCacheKey().size());
+  stream.read(reinterpret_cast<char*>(key.data()), key.size() * sizeof(uint64_t));
+  if (!stream || key != IndexCacheKey()) {
+    LOG(WARNING) << "GPT Dataset index cache " << path << " does not match the dataset, rebuilding";
+    return false;
+  }
+  uint64_t sizes[3];
+  stream.read(reinterpret_cast<char*>(sizes), sizeof(sizes));
+  if (!stream) { return false; }
+  doc_indices_.resize(sizes[0]);
+  sample_indices_.resize(sizes[1]);
+  shuffle_indices_.resize(sizes[2]);
+  stream.read(reinterpret_cast<char*>(doc_indices_.data()),
+              sizeof(decltype(doc_indices_)::value_type) * doc_indices_.size());
+  stream.read(reinterpret_cast<char*>(sample_indices_.data()),
+              sizeof(decltype(sample_indices_)::value_type) * sample_indices_.size());
+  stream.read(reinterpret_cast<char*>(shuffle_indices_.data()),
+              sizeof(decltype(shuffle_indices_)::value_type) * shuffle_indices_.size());
+  if (!stream || stream.peek() != std::char_traits<char>::eof()) {
+    LOG(WARNING) << "GPT Dataset index cache " << path << " is truncated, rebuilding";
+    doc_indices_.clear();
+    sample_indices_.clear();
+    shuffle_indices_.clear();
+    return false;
+  }
+  std::chrono::duration<double, std::milli> elapse = std::chrono::system_clock::now() - start;
+  LOG(INFO) << "Load GPT Dataset index cache successed, file_path: " << path
+            << ", elapsed time: " << elapse.count() << " ms";
+  return true;
+}
+
+void MegatronGPTMMapDataset::SaveIndexCache(const std::string& path) const {
+  // written aside and renamed, so that the ranks building the same cache never see a partial one
+  const std::string tmp_path = path + ".tmp." + std::to_string(getpid());
+  {
+    std::ofstream stream(tmp_path, std::ios::binary | std::ios::trunc);
+    if (!stream.is_open()) {
+      LOG(WARNING) << "can't write GPT Dataset index cache " << path;
+      return;
+    }
+    const std::vector<uint64_t> key = IndexCacheKey();
+    const uint64_t sizes[3] = {doc_indices_.size(), sample_indices_.size(),
+                               shuffle_indices_.size()};
+    stream.write(kIndexCacheMagicCode, kIndexCacheMagicCodeLen);
+    stream.write(reinterpret_cast<const char*>(key.data()), key.size() * sizeof(uint64_t));
+    stream.write(reinterpret_cast<const char*>(sizes), sizeof(sizes));
+    stream.write(reinterpret_cast<const char*>(doc_indices_.data()),
+                 sizeof(decltype(doc_indices_)::value_type) * doc_indices_.size());
+    stream.write(reinterpret_cast<const char*>(sample_indices_.data()),
+                 sizeof(decltype(sample_indices_)::value_type) * sample_indices_.size());
+    stream.write(reinterpret_cast<const char*>(shuffle_indices_.data()),
+                 sizeof(decltype(shuffle_indices_)::value_type) * shuffle_indices_.size());
+    if (!stream) {
+      LOG(WARNING) << "can't write GPT Dataset index cache " << path;
+      std::remove(tmp_path.c_str());
+      return;
+    }
+  }
+  if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+    LOG(WARNING) << "can't write GPT Dataset index cache " << path << ": " << strerror(errno);
+    std::remove(tmp_path.c_str());
+  }
+}
+
 const HashMap<char, size_t> MegatronGPTMMapDataset::kDTypeCode2Size = {
     {1, 1},  // DataType::kUInt8
     {2, 1},  // DataType::kInt8
@@ -68,6 +68,9 @@ class MegatronGPTMMapDataset final {
 
   template<typename T>
   void GetSample(size_t index, T* data) const;
+  // Writes the start offsets of the documents packed in the first seq_len input tokens of the
+  // sample, followed by seq_len up to num_offsets entries, i.e. the cu_seqlens of the sample.
+  void GetSampleDocOffsets(size_t index, int32_t* offsets, size_t num_offsets) const;
 
  private:
   static const HashMap<char, size_t> kDTypeCode2Size;
@@ -78,6 +81,11 @@ class MegatronGPTMMapDataset final {
   void InitDocIndices(const std::vector<size_t>& doc_indices, size_t num_epochs);
   void InitSampleIndices(size_t total_num_samples);
   void InitShuffleIndices(size_t total_num_samples);
+  // The doc, sample and shuffle indices are cached in a file keyed by the arguments, which is
+  // reused while it matches the dataset
+  std::vector<uint64_t> IndexCacheKey() const;
+  bool TryLoadIndexCache(const std::string& path);
+  void SaveIndexCache(const std::string& path) const;
   template<typename T>
   void ReadTokens(const void* src, size_t offset, T* dst, size_t size) const;
 
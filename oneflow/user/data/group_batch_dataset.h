@@ -32,21 +32,21 @@ class GroupBatchDataset final : public Dataset<LoadTarget> {
   GroupBatchDataset(size_t batch_size,
                     const std::function<int64_t(const LoadTargetShdPtr&)>& GroupId4Sample,
                     BaseDatasetUnqPtr&& dataset)
-      : base_(std::move(dataset)),
-        batch_size_(batch_size),
-        group_fn_(GroupId4Sample),
-        order_count_(0) {}
+      : base_(std::move(dataset)), batch_size_(batch_size), group_fn_(GroupId4Sample) {}
   ~GroupBatchDataset() = default;
 
   LoadTargetShdPtrVec Next() override {
     LoadTargetShdPtrVec ret;
-    int64_t group_id = FindEarliestBatchGroupId();
-    auto group_it = group_id2buffered_samples_.find(group_id);
-    if (group_it != group_id2buffered_samples_.end()) {
-      auto& batch_sample_list = group_it->second;
-      if (!batch_sample_list.empty()) {
-        std::swap(ret, batch_sample_list.front().data);
-        batch_sample_list.pop_front();
+    ret.reserve(batch_size_);
+    int64_t group_id = -1;
+    if (!batch_group_ids_.empty()) {
+      // The batch started the earliest is completed first.
+      group_id = batch_group_ids_.front();
+      batch_group_ids_.pop_front();
+      auto& buffered_samples = group_id2buffered_samples_.at(group_id);
+      while (ret.size() < batch_size_ && !buffered_samples.empty()) {
+        ret.push_back(std::move(buffered_samples.front()));
+        buffered_samples.pop_front();
       }
     }
     while (ret.size() < batch_size_) {
@@ -57,51 +57,24 @@ class GroupBatchDataset final : public Dataset<LoadTarget> {
       if (group_id == next_group_id) {
         ret.push_back(std::move(next_sample_vec[0]));
       } else {
-        auto group_it = group_id2buffered_samples_.find(next_group_id);
-        if (group_it == group_id2buffered_samples_.end()) {
-          group_it =
-              group_id2buffered_samples_.emplace(next_group_id, std::list<BatchSample>()).first;
-        }
-        auto& batch_sample_list = group_it->second;
-        if (batch_sample_list.empty() || batch_sample_list.back().data.size() == batch_size_) {
-          BatchSample batch_sample;
-          std::swap(batch_sample.data, next_sample_vec);
-          batch_sample.data.reserve(batch_size_);
-          batch_sample.order = order_count_++;
-          batch_sample_list.push_back(std::move(batch_sample));
-        } else {
-          batch_sample_list.back().data.push_back(std::move(next_sample_vec[0]));
+        auto& buffered_samples = group_id2buffered_samples_[next_group_id];
+        if (buffered_samples.size() % batch_size_ == 0) {
+          batch_group_ids_.push_back(next_group_id);
         }
+        buffered_samples.push_back(std::move(next_sample_vec[0]));
       }
     }
     return ret;
   }
 
  private:
-  int64_t FindEarliestBatchGroupId() const {
-    int64_t group_id = -1;
-    int64_t min_order = -1;
-    for (const auto& pair : group_id2buffered_samples_) {
-      if (pair.second.size() > 0) {
-        if (min_order == -1 || pair.second.front().order < min_order) {
-          min_order = pair.second.front().order;
-          group_id = pair.first;
-        }
-      }
-    }
-    return group_id;
-  }
-
-  struct BatchSample {
-    LoadTargetShdPtrVec data;
-    int64_t order;
-  };
-
   BaseDatasetUnqPtr base_;
   size_t batch_size_;
   std::function<int64_t(const LoadTargetShdPtr&)> group_fn_;
-  std::map<int64_t, std::list<BatchSample>> group_id2buffered_samples_;
-  int64_t order_count_;
+  // The buffered samples of a group are the consecutive batches of it, and the group of every
+  // buffered batch is queued in the order that its first sample arrived.
+  HashMap<int64_t, std::deque<LoadTargetShdPtr>> group_id2buffered_samples_;
+  std::deque<int64_t> batch_group_ids_;
 };
 
 }  // namespace data
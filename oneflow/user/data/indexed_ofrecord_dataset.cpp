@@ -0,0 +1,147 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/user/data/indexed_ofrecord_dataset.h"
+#include "oneflow/user/data/ofrecord_index.h"
+#include "oneflow/core/common/str_util.h"
+#include "oneflow/core/thread/thread_manager.h"
+
+namespace oneflow {
+
+namespace data {
+
+namespace {
+
+constexpr int64_t kDefaultCoalesceGapBytes = 64 * 1024;
+// bounds the scratch buffer of a coalesced read
+constexpr uint64_t kMaxCoalescedReadBytes = 16 * 1024 * 1024;
+
+}  // namespace
+
+IndexedOFRecordDataset::IndexedOFRecordDataset(user_op::KernelInitContext* ctx)
+    : num_records_(0) {
+  coalesce_gap_bytes_ =
+      ParseIntegerFromEnv("ONEFLOW_OFRECORD_READER_COALESCE_GAP_BYTES", kDefaultCoalesceGapBytes);
+  const int32_t data_part_num = ctx->Attr<int32_t>("data_part_num");
+  const std::string& data_dir = ctx->Attr<std::string>("data_dir");
+  const std::string& part_name_prefix = ctx->Attr<std::string>("part_name_prefix");
+  const int32_t part_name_suffix_length = ctx->Attr<int32_t>("part_name_suffix_length");
+  parts_.resize(data_part_num);
+  MultiThreadLoop(data_part_num, [&](size_t i) {
+    std::string num = std::to_string(i);
+    int32_t zero_count = std::max(part_name_suffix_length - static_cast<int32_t>(num.length()), 0);
+    const std::string path =
+        JoinPath(data_dir, part_name_prefix + std::string(zero_count, '0') + num);
+    Part* part = &parts_.at(i);
+    part->size = DataFS()->GetFileSize(path);
+    DataFS()->NewRandomAccessFile(path, &part->file);
+    LoadOrBuildOFRecordIndex(
+        DataFS(), path, part->size,
+        [&](uint64_t offset) {
+          int64_t size = -1;
+          part->file->Read(offset, sizeof(int64_t), reinterpret_cast<char*>(&size));
+          return size;
+        },
+        &part->offsets);
+  });
+  part_record_offsets_.push_back(0);
+  for (const Part& part : parts_) {
+    num_records_ += part.offsets.size();
+    part_record_offsets_.push_back(num_records_);
+  }
+  CHECK_GT(num_records_, 0);
+}
+
+IndexedOFRecordDataset::RecordLocation IndexedOFRecordDataset::Locate(int64_t index) const {
+  CHECK_GE(index, 0);
+  CHECK_LT(index, num_records_);
+  const auto it =
+      std::upper_bound(part_record_offsets_.cbegin(), part_record_offsets_.cend(), index);
+  const size_t part_index = std::distance(part_record_offsets_.cbegin(), it) - 1;
+  const Part& part = parts_.at(part_index);
+  const size_t record_index = index - part_record_offsets_.at(part_index);
+  RecordLocation location;
+  location.part = part_index;
+  location.begin = part.offsets.at(record_index) + sizeof(int64_t);
+  location.end =
+      record_index + 1 < part.offsets.size() ? part.offsets.at(record_index + 1) : part.size;
+  CHECK_GT(location.end, location.begin);
+  return location;
+}
+
+IndexedOFRecordDataset::LoadTargetShdPtrVec IndexedOFRecordDataset::At(int64_t index) const {
+  const RecordLocation location = Locate(index);
+  const int64_t size = location.end - location.begin;
+  LoadTargetShdPtrVec ret;
+  ret.emplace_back(new TensorBuffer());
+  ret.back()->Resize(Shape({size}), DataType::kChar);
+  parts_.at(location.part).file->Read(location.begin, size, ret.back()->mut_data<char>());
+  return ret;
+}
+
+IndexedOFRecordDataset::LoadTargetShdPtrVec IndexedOFRecordDataset::BatchAt(
+    const std::vector<int64_t>& indices) const {
+  std::vector<RecordLocation> locations(indices.size());
+  std::vector<size_t> order(indices.size());
+  LoadTargetShdPtrVec ret(indices.size());
+  FOR_RANGE(size_t, i, 0, indices.size()) {
+    locations.at(i) = Locate(indices.at(i));
+    order.at(i) = i;
+    const int64_t size = locations.at(i).end - locations.at(i).begin;
+    ret.at(i).reset(new TensorBuffer());
+    ret.at(i)->Resize(Shape({size}), DataType::kChar);
+  }
+  std::sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+    const RecordLocation& l = locations.at(lhs);
+    const RecordLocation& r = locations.at(rhs);
+    return l.part != r.part ? l.part < r.part : l.begin < r.begin;
+  });
+  std::vector<char> scratch;
+  size_t group_begin = 0;
+  while (group_begin < order.size()) {
+    const RecordLocation& first = locations.at(order.at(group_begin));
+    uint64_t read_end = first.end;
+    size_t group_end = group_begin + 1;
+    while (group_end < order.size()) {
+      const RecordLocation& next = locations.at(order.at(group_end));
+      if (next.part != first.part || next.begin > read_end + coalesce_gap_bytes_
+          || std::max(read_end, next.end) - first.begin > kMaxCoalescedReadBytes) {
+        break;
+      }
+      read_end = std::max(read_end, next.end);
+      group_end += 1;
+    }
+    const fs::RandomAccessFile* file = parts_.at(first.part).file.get();
+    if (group_end == group_begin + 1) {
+      TensorBuffer* buffer = ret.at(order.at(group_begin)).get();
+      file->Read(first.begin, buffer->nbytes(), buffer->mut_data<char>());
+    } else {
+      scratch.resize(read_end - first.begin);
+      file->Read(first.begin, scratch.size(), scratch.data());
+      FOR_RANGE(size_t, i, group_begin, group_end) {
+        const RecordLocation& location = locations.at(order.at(i));
+        TensorBuffer* buffer = ret.at(order.at(i)).get();
+        std::memcpy(buffer->mut_data<char>(), scratch.data() + (location.begin - first.begin),
+                    buffer->nbytes());
+      }
+    }
+    group_begin = group_end;
+  }
+  return ret;
+}
+
+}  // namespace data
+
+}  // namespace oneflow
@@ -0,0 +1,67 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_USER_DATA_INDEXED_OFRECORD_DATASET_H_
+#define ONEFLOW_USER_DATA_INDEXED_OFRECORD_DATASET_H_
+
+#include "oneflow/user/data/dataset.h"
+#include "oneflow/core/framework/op_kernel.h"
+#include "oneflow/core/persistence/file_system.h"
+
+namespace oneflow {
+namespace data {
+
+// The records of all the part files of an OFRecord dataset, addressed through the record indexes
+// of the parts. It is sharded and shuffled as a whole by DistributedTrainingDataset, and BatchAt
+// reads the records of a batch in the order of their offsets, a single read covering the records
+// that are close in the same part.
+class IndexedOFRecordDataset final : public RandomAccessDataset<TensorBuffer> {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(IndexedOFRecordDataset);
+  explicit IndexedOFRecordDataset(user_op::KernelInitContext* ctx);
+  ~IndexedOFRecordDataset() = default;
+
+  LoadTargetShdPtrVec At(int64_t index) const override;
+  LoadTargetShdPtrVec BatchAt(const std::vector<int64_t>& indices) const override;
+  size_t Size() const override { return num_records_; }
+
+ private:
+  struct Part {
+    uint64_t size;
+    // offsets of the int64 size prefix of each record
+    std::vector<uint64_t> offsets;
+    std::unique_ptr<fs::RandomAccessFile> file;
+  };
+  struct RecordLocation {
+    size_t part;
+    // the range of the record data without its size prefix
+    uint64_t begin;
+    uint64_t end;
+  };
+
+  RecordLocation Locate(int64_t index) const;
+
+  std::vector<Part> parts_;
+  // the index of the first record of each part, plus the total
+  std::vector<size_t> part_record_offsets_;
+  size_t num_records_;
+  // records closer than this in a part are read together
+  uint64_t coalesce_gap_bytes_;
+};
+
+}  // namespace data
+}  // namespace oneflow
+
+#endif  // ONEFLOW_USER_DATA_INDEXED_OFRECORD_DATASET_H_
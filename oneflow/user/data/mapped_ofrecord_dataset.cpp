@@ -0,0 +1,105 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/user/data/mapped_ofrecord_dataset.h"
+#include "oneflow/user/data/ofrecord_index.h"
+#include "oneflow/core/common/balanced_splitter.h"
+#include "oneflow/core/common/str_util.h"
+
+namespace oneflow {
+
+namespace data {
+
+MappedOFRecordFile::MappedOFRecordFile(const std::string& path) {
+  data_ = std::make_unique<const MappedBuffer>(path);
+  LoadOrBuildOFRecordIndex(
+      DataFS(), path, data_->size(),
+      [&](uint64_t offset) {
+        int64_t size = -1;
+        std::memcpy(&size, static_cast<const char*>(data_->ptr()) + offset, sizeof(int64_t));
+        return size;
+      },
+      &offsets_);
+}
+
+size_t MappedOFRecordFile::record_size(size_t index) const {
+  int64_t size = -1;
+  std::memcpy(&size, static_cast<const char*>(data_->ptr()) + offsets_.at(index), sizeof(int64_t));
+  return size;
+}
+
+const char* MappedOFRecordFile::record_data(size_t index) const {
+  return static_cast<const char*>(data_->ptr()) + offsets_.at(index) + sizeof(int64_t);
+}
+
+MappedOFRecordDataset::MappedOFRecordDataset(user_op::KernelInitContext* ctx)
+    : current_epoch_(0), num_records_(0), cur_idx_(0) {
+  shuffle_after_epoch_ = ctx->Attr<bool>("shuffle_after_epoch");
+  const int32_t data_part_num = ctx->Attr<int32_t>("data_part_num");
+  const std::string& data_dir = ctx->Attr<std::string>("data_dir");
+  const std::string& part_name_prefix = ctx->Attr<std::string>("part_name_prefix");
+  const int32_t part_name_suffix_length = ctx->Attr<int32_t>("part_name_suffix_length");
+  const int64_t parallel_num = ctx->parallel_ctx().parallel_num();
+  CHECK_LE(parallel_num, data_part_num);
+  BalancedSplitter bs(data_part_num, parallel_num);
+  const Range range = bs.At(ctx->parallel_ctx().parallel_id());
+  file_record_offsets_.push_back(0);
+  for (int64_t i = range.begin(); i < range.end(); ++i) {
+    std::string num = std::to_string(i);
+    int32_t zero_count = std::max(part_name_suffix_length - static_cast<int32_t>(num.length()), 0);
+    files_.emplace_back(std::make_unique<const MappedOFRecordFile>(
+        JoinPath(data_dir, part_name_prefix + std::string(zero_count, '0') + num)));
+    num_records_ += files_.back()->num_records();
+    file_record_offsets_.push_back(num_records_);
+  }
+  CHECK_GT(num_records_, 0);
+  permutation_.resize(num_records_);
+  std::iota(permutation_.begin(), permutation_.end(), 0);
+}
+
+MappedOFRecordDataset::LoadTargetPtrList MappedOFRecordDataset::Next() {
+  if (cur_idx_ == num_records_) {
+    cur_idx_ = 0;
+    if (shuffle_after_epoch_) { ShuffleAfterEpoch(); }
+  }
+  LoadTargetPtrList ret;
+  LoadTargetPtr sample_ptr(new TensorBuffer());
+  At(permutation_.at(cur_idx_), sample_ptr.get());
+  cur_idx_ += 1;
+  ret.push_back(std::move(sample_ptr));
+  return ret;
+}
+
+void MappedOFRecordDataset::At(size_t index, TensorBuffer* buffer) const {
+  CHECK_LT(index, num_records_);
+  const auto it =
+      std::upper_bound(file_record_offsets_.cbegin(), file_record_offsets_.cend(), index);
+  const size_t file_index = std::distance(file_record_offsets_.cbegin(), it) - 1;
+  const MappedOFRecordFile* file = files_.at(file_index).get();
+  const size_t record_index = index - file_record_offsets_.at(file_index);
+  const int64_t size = file->record_size(record_index);
+  buffer->Resize(Shape({size}), DataType::kChar);
+  std::memcpy(buffer->mut_data<char>(), file->record_data(record_index), size);
+}
+
+void MappedOFRecordDataset::ShuffleAfterEpoch() {
+  current_epoch_++;
+  std::mt19937 g(kOneflowDatasetSeed + current_epoch_);
+  std::shuffle(permutation_.begin(), permutation_.end(), g);
+}
+
+}  // namespace data
+
+}  // namespace oneflow
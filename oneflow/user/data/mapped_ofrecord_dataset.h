@@ -0,0 +1,76 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_USER_DATA_MAPPED_OFRECORD_DATASET_H_
+#define ONEFLOW_USER_DATA_MAPPED_OFRECORD_DATASET_H_
+
+#include "oneflow/user/data/dataset.h"
+#include "oneflow/user/data/gpt_dataset.h"
+#include "oneflow/core/framework/op_kernel.h"
+
+namespace oneflow {
+namespace data {
+
+// An OFRecord part file mapped into memory, with the offsets of its records from its index
+class MappedOFRecordFile final {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(MappedOFRecordFile);
+  explicit MappedOFRecordFile(const std::string& path);
+  ~MappedOFRecordFile() = default;
+
+  size_t num_records() const { return offsets_.size(); }
+  size_t record_size(size_t index) const;
+  const char* record_data(size_t index) const;
+
+ private:
+  std::unique_ptr<const MappedBuffer> data_;
+  // offsets of the int64 size prefix of each record
+  std::vector<uint64_t> offsets_;
+};
+
+// Reads the local part files of an OFRecord dataset from memory maps, the records are copied from
+// the mapped pages into the TensorBuffers once. With shuffle_after_epoch, the records of the local
+// parts are shuffled as a whole after each epoch instead of the order of the parts.
+class MappedOFRecordDataset final : public Dataset<TensorBuffer> {
+ public:
+  using LoadTargetPtr = std::shared_ptr<TensorBuffer>;
+  using LoadTargetPtrList = std::vector<LoadTargetPtr>;
+  OF_DISALLOW_COPY_AND_MOVE(MappedOFRecordDataset);
+  explicit MappedOFRecordDataset(user_op::KernelInitContext* ctx);
+  ~MappedOFRecordDataset() = default;
+
+  LoadTargetPtrList Next() override;
+
+  size_t Size() const { return num_records_; }
+  // Copies the record at `index` of the local parts into `buffer`
+  void At(size_t index, TensorBuffer* buffer) const;
+
+ private:
+  void ShuffleAfterEpoch();
+
+  bool shuffle_after_epoch_;
+  int32_t current_epoch_;
+  std::vector<std::unique_ptr<const MappedOFRecordFile>> files_;
+  // the index of the first record of each file in the local parts, plus the total
+  std::vector<size_t> file_record_offsets_;
+  size_t num_records_;
+  std::vector<size_t> permutation_;
+  size_t cur_idx_;
+};
+
+}  // namespace data
+}  // namespace oneflow
+
+#endif  // ONEFLOW_USER_DATA_MAPPED_OFRECORD_DATASET_H_
@@ -0,0 +1,75 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifdef __linux__
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include "oneflow/core/common/process_state.h"
+#include "oneflow/core/common/str_util.h"
+#include "oneflow/user/data/mapped_ofrecord_dataset.h"
+#include "oneflow/user/data/ofrecord_index.h"
+
+namespace oneflow {
+
+namespace data {
+
+namespace {
+
+std::string WriteRecords(const std::string& name, const std::vector<std::string>& records) {
+  std::string current_dir = GetCwd();
+  StringReplace(&current_dir, '\\', '/');
+  const std::string path = JoinPath(current_dir, "/tmp_test_mapped_ofrecord_" + name);
+  std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+  for (const std::string& record : records) {
+    const int64_t size = record.size();
+    stream.write(reinterpret_cast<const char*>(&size), sizeof(size));
+    stream.write(record.data(), size);
+  }
+  return path;
+}
+
+void CheckRecords(const MappedOFRecordFile& file, const std::vector<std::string>& records) {
+  ASSERT_EQ(file.num_records(), records.size());
+  for (size_t i = 0; i < records.size(); ++i) {
+    ASSERT_EQ(std::string(file.record_data(i), file.record_size(i)), records.at(i));
+  }
+}
+
+}  // namespace
+
+TEST(MappedOFRecordFile, build_and_reload_index) {
+  const std::vector<std::string> records{"a", std::string(1000, 'b'), "ccc"};
+  const std::string path = WriteRecords("part", records);
+  const std::string index_path = OFRecordIndexPath(path);
+  std::remove(index_path.c_str());
+  { CheckRecords(MappedOFRecordFile(path), records); }
+  ASSERT_TRUE(std::ifstream(index_path).good());
+  // the saved index is reused
+  { CheckRecords(MappedOFRecordFile(path), records); }
+  // a part rewritten with another size does not use the stale index
+  const std::vector<std::string> new_records{"dd", "e"};
+  WriteRecords("part", new_records);
+  { CheckRecords(MappedOFRecordFile(path), new_records); }
+  std::remove(index_path.c_str());
+  std::remove(path.c_str());
+}
+
+}  // namespace data
+
+}  // namespace oneflow
+
+#endif  // __linux__
@@ -18,9 +18,13 @@ limitations under the License.
 
 #include "oneflow/user/data/data_reader.h"
 #include "oneflow/user/data/ofrecord_dataset.h"
+#include "oneflow/user/data/mapped_ofrecord_dataset.h"
+#include "oneflow/user/data/indexed_ofrecord_dataset.h"
+#include "oneflow/user/data/distributed_training_dataset.h"
 #include "oneflow/user/data/ofrecord_parser.h"
 #include "oneflow/user/data/random_shuffle_dataset.h"
 #include "oneflow/user/data/batch_dataset.h"
+#include "oneflow/core/persistence/posix/posix_file_system.h"
 #include <iostream>
 
 namespace oneflow {
@@ -29,12 +33,28 @@ namespace data {
 class OFRecordDataReader final : public DataReader<TensorBuffer> {
  public:
   OFRecordDataReader(user_op::KernelInitContext* ctx) : DataReader<TensorBuffer>(ctx) {
-    loader_.reset(new OFRecordDataset(ctx));
-    parser_.reset(new OFRecordParser());
-    if (ctx->Attr<bool>("random_shuffle")) {
-      loader_.reset(new RandomShuffleDataset<TensorBuffer>(ctx, std::move(loader_)));
-    }
     int32_t batch_size = ctx->TensorDesc4ArgNameAndIndex("out", 0)->shape().elem_cnt();
+    if (ctx->Attr<bool>("random_shuffle")
+        && ParseBooleanFromEnv("ONEFLOW_OFRECORD_READER_GLOBAL_SHUFFLE", false)) {
+      // the records of all the parts are shuffled and sharded by their indexes, the ranks need the
+      // same seed to get disjoint shards
+      int64_t seed = ctx->Attr<int64_t>("seed");
+      if (seed == -1) { seed = kOneflowDatasetSeed; }
+      std::unique_ptr<RandomAccessDataset<TensorBuffer>> dataset(new IndexedOFRecordDataset(ctx));
+      loader_.reset(new DistributedTrainingDataset<TensorBuffer>(
+          ctx->parallel_ctx().parallel_num(), ctx->parallel_ctx().parallel_id(),
+          /*stride_partition=*/true, /*shuffle=*/true, seed, std::move(dataset), batch_size));
+    } else {
+      if (UseMappedDataset()) {
+        loader_.reset(new MappedOFRecordDataset(ctx));
+      } else {
+        loader_.reset(new OFRecordDataset(ctx));
+      }
+      if (ctx->Attr<bool>("random_shuffle")) {
+        loader_.reset(new RandomShuffleDataset<TensorBuffer>(ctx, std::move(loader_)));
+      }
+    }
+    parser_.reset(new OFRecordParser());
     loader_.reset(new BatchDataset<TensorBuffer>(batch_size, std::move(loader_)));
     StartLoadThread();
   }
@@ -43,6 +63,18 @@ class OFRecordDataReader final : public DataReader<TensorBuffer> {
  protected:
   using DataReader<TensorBuffer>::loader_;
   using DataReader<TensorBuffer>::parser_;
+
+ private:
+  // memory maps need the part files on the local file system
+  static bool UseMappedDataset() {
+    if (!ParseBooleanFromEnv("ONEFLOW_OFRECORD_READER_USE_MMAP", false)) { return false; }
+#if defined(OF_PLATFORM_POSIX) && defined(__linux__)
+    if (dynamic_cast<fs::PosixFileSystem*>(DataFS()) != nullptr) { return true; }
+#endif
+    LOG(WARNING) << "ONEFLOW_OFRECORD_READER_USE_MMAP is ignored, "
+                 << "the data file system is not local";
+    return false;
+  }
 };
 
 }  // namespace data
@@ -17,6 +17,8 @@ limitations under the License.
 #define ONEFLOW_USER_DATA_OFRECORD_IMAGE_CLASSIFICATION_DATASET_H_
 
 #include "oneflow/core/thread/thread_pool.h"
+#include "oneflow/core/thread/thread_affinity.h"
+#include "oneflow/core/common/blocking_counter.h"
 #include "oneflow/core/common/buffer.h"
 #include "oneflow/user/data/dataset.h"
 #include "oneflow/core/common/balanced_splitter.h"
@@ -25,6 +27,7 @@ limitations under the License.
 #include "oneflow/core/persistence/persistent_in_stream.h"
 #include "oneflow/core/job/job_set.pb.h"
 #include "oneflow/user/data/ofrecord_dataset.h"
+#include "oneflow/user/data/ofrecord_wire_format.h"
 #include "oneflow/user/image/image_util.h"
 #include "oneflow/core/job/resource_desc.h"
 #include "oneflow/core/job/global_for.h"
@@ -39,21 +42,31 @@ struct ImageClassificationDataInstance {
   std::shared_ptr<TensorBuffer> image;
 };
 
+// A sample decoded on the thread pool of the process, which the readers of all the local ranks
+// share. Slots are queued in the order of the records, so the samples keep that order.
+struct ImageClassificationDecodeSlot {
+  ImageClassificationDecodeSlot() : done(1) {}
+
+  std::shared_ptr<ImageClassificationDataInstance> instance;
+  BlockingCounter done;
+};
+
 using BaseDataset = Dataset<TensorBuffer>;
 using BaseLoadTargetPtr = BaseDataset::LoadTargetPtr;
 using BaseLoadTargetPtrList = BaseDataset::LoadTargetPtrList;
 
 namespace {
 
-void DecodeImageFromOFRecord(const OFRecord& record, const std::string& feature_name,
-                             const std::string& color_space, TensorBuffer* out) {
-  auto image_feature_it = record.feature().find(feature_name);
-  CHECK(image_feature_it != record.feature().end());
-  const Feature& image_feature = image_feature_it->second;
+void DecodeImageFromOFRecord(const char* record, size_t record_size,
+                             const std::string& feature_name, const std::string& color_space,
+                             TensorBuffer* out) {
+  OFRecordFeatureView image_feature;
+  CHECK(FindOFRecordFeature(record, record_size, feature_name, &image_feature));
   CHECK(image_feature.has_bytes_list());
-  CHECK(image_feature.bytes_list().value_size() == 1);
-  const std::string& src_data = image_feature.bytes_list().value(0);
-  cv::Mat image = cv::imdecode(cv::Mat(1, src_data.size(), CV_8UC1, (void*)(src_data.data())),
+  const char* src_data = nullptr;
+  size_t src_size = 0;
+  image_feature.GetSingleBytes(&src_data, &src_size);
+  cv::Mat image = cv::imdecode(cv::Mat(1, src_size, CV_8UC1, const_cast<char*>(src_data)),
                                cv::IMREAD_COLOR);
   int W = image.cols;
   int H = image.rows;
@@ -73,18 +86,15 @@ void DecodeImageFromOFRecord(const OFRecord& record, const std::string& feature_
   memcpy(out->mut_data<uint8_t>(), image.ptr(), image_shape.elem_cnt());
 }
 
-void DecodeLabelFromFromOFRecord(const OFRecord& record, const std::string& feature_name,
-                                 TensorBuffer* out) {
-  auto label_feature_it = record.feature().find(feature_name);
-  CHECK(label_feature_it != record.feature().end());
-  const Feature& label_feature = label_feature_it->second;
+void DecodeLabelFromFromOFRecord(const char* record, size_t record_size,
+                                 const std::string& feature_name, TensorBuffer* out) {
+  OFRecordFeatureView label_feature;
+  CHECK(FindOFRecordFeature(record, record_size, feature_name, &label_feature));
   out->Resize(Shape({1}), DataType::kInt32);
-  if (label_feature.has_int32_list()) {
-    CHECK_EQ(label_feature.int32_list().value_size(), 1);
-    *out->mut_data<int32_t>() = label_feature.int32_list().value(0);
-  } else if (label_feature.has_int64_list()) {
-    CHECK_EQ(label_feature.int64_list().value_size(), 1);
-    *out->mut_data<int32_t>() = label_feature.int64_list().value(0);
+  if (label_feature.kind_case() == Feature::kInt32List
+      || label_feature.kind_case() == Feature::kInt64List) {
+    CHECK_EQ(label_feature.ValueSize(), 1);
+    label_feature.CopyNumericValues<int32_t>(out->mut_data<int32_t>(), 1);
   } else {
     UNIMPLEMENTED();
   }
@@ -92,6 +102,7 @@ void DecodeLabelFromFromOFRecord(const OFRecord& record, const std::string& feat
 
 void LoadWorker(BaseDataset* record_dataset,
                 std::vector<std::unique_ptr<Buffer<BaseLoadTargetPtr>>>* decode_in_buffers) {
+  BindCurrentThreadToRoleCores(ThreadRole::kData);
   int64_t thread_idx = 0;
   bool shutdown = false;
   while (!shutdown) {
@@ -112,26 +123,57 @@ void LoadWorker(BaseDataset* record_dataset,
 void DecodeWorker(const std::string image_feature_name, const std::string label_feature_name,
                   const std::string color_space, Buffer<BaseLoadTargetPtr>* in_buffer,
                   Buffer<std::shared_ptr<ImageClassificationDataInstance>>* out_buffer) {
+  BindCurrentThreadToRoleCores(ThreadRole::kData);
   while (true) {
     BaseLoadTargetPtr serialized_record;
     auto receive_status = in_buffer->Receive(&serialized_record);
     if (receive_status == kBufferStatusErrorClosed) { break; }
     CHECK(receive_status == kBufferStatusSuccess);
-    OFRecord record;
-    CHECK(record.ParseFromArray(serialized_record->data<char>(),
-                                serialized_record->shape().elem_cnt()));
-    std::shared_ptr<ImageClassificationDataInstance> instance(
-        new ImageClassificationDataInstance());
-    instance->image.reset(new TensorBuffer());
-    DecodeImageFromOFRecord(record, image_feature_name, color_space, instance->image.get());
-    instance->label.reset(new TensorBuffer());
-    DecodeLabelFromFromOFRecord(record, label_feature_name, instance->label.get());
+    std::shared_ptr<ImageClassificationDataInstance> instance = DecodeImageClassificationInstance(
+        *serialized_record, image_feature_name, label_feature_name, color_space);
     auto send_status = out_buffer->Send(instance);
     if (send_status == kBufferStatusErrorClosed) { break; }
     CHECK(send_status == kBufferStatusSuccess);
   }
 }
 
+std::shared_ptr<ImageClassificationDataInstance> DecodeImageClassificationInstance(
+    const TensorBuffer& serialized_record, const std::string& image_feature_name,
+    const std::string& label_feature_name, const std::string& color_space) {
+  // the features are read in place from the serialized record instead of parsing an OFRecord,
+  // which would allocate and copy every feature including the ones not used here
+  const char* record = serialized_record.data<char>();
+  const size_t record_size = serialized_record.shape().elem_cnt();
+  std::shared_ptr<ImageClassificationDataInstance> instance(new ImageClassificationDataInstance());
+  instance->image.reset(new TensorBuffer());
+  DecodeImageFromOFRecord(record, record_size, image_feature_name, color_space,
+                          instance->image.get());
+  instance->label.reset(new TensorBuffer());
+  DecodeLabelFromFromOFRecord(record, record_size, label_feature_name, instance->label.get());
+  return instance;
+}
+
+void SharedPoolLoadWorker(BaseDataset* record_dataset, const std::string image_feature_name,
+                          const std::string label_feature_name, const std::string color_space,
+                          Buffer<std::shared_ptr<ImageClassificationDecodeSlot>>* slots) {
+  BindCurrentThreadToRoleCores(ThreadRole::kData);
+  ThreadPool* thread_pool = Global<ThreadPool>::Get();
+  CHECK_NOTNULL(thread_pool);
+  while (true) {
+    BaseLoadTargetPtrList records = record_dataset->Next();
+    for (const auto& record : records) {
+      std::shared_ptr<ImageClassificationDecodeSlot> slot(new ImageClassificationDecodeSlot());
+      // the slot is queued first, Send blocks while too many samples of this reader are pending
+      if (slots->Send(slot) == kBufferStatusErrorClosed) { return; }
+      thread_pool->AddWork([record, slot, image_feature_name, label_feature_name, color_space]() {
+        slot->instance = DecodeImageClassificationInstance(*record, image_feature_name,
+                                                           label_feature_name, color_space);
+        slot->done.Decrease();
+      });
+    }
+  }
+}
+
 int32_t GetNumLocalDecodeThreads(int32_t num_decode_threads_per_machine,
                                  const ParallelDesc& parallel_desc,
                                  const ParallelContext& parallel_ctx) {
@@ -153,7 +195,10 @@ class OFRecordImageClassificationDataset final : public Dataset<ImageClassificat
   OF_DISALLOW_COPY_AND_MOVE(OFRecordImageClassificationDataset);
   OFRecordImageClassificationDataset(user_op::KernelInitContext* ctx,
                                      std::unique_ptr<BaseDataset>&& base)
-      : base_(std::move(base)), out_thread_idx_(0) {
+      : base_(std::move(base)),
+        use_shared_decode_pool_(
+            ParseBooleanFromEnv("ONEFLOW_DATA_READER_USE_SHARED_DECODE_POOL", false)),
+        out_thread_idx_(0) {
     const std::string& color_space = ctx->Attr<std::string>("color_space");
     const std::string& image_feature_name = ctx->Attr<std::string>("image_feature_name");
     const std::string& label_feature_name = ctx->Attr<std::string>("label_feature_name");
@@ -162,6 +207,13 @@ class OFRecordImageClassificationDataset final : public Dataset<ImageClassificat
     const auto decode_buffer_size_per_thread = ctx->Attr<int32_t>("decode_buffer_size_per_thread");
     const int32_t num_local_decode_threads = GetNumLocalDecodeThreads(
         num_decode_threads_per_machine, ctx->parallel_desc(), ctx->parallel_ctx());
+    if (use_shared_decode_pool_) {
+      decode_slots_.reset(new Buffer<std::shared_ptr<ImageClassificationDecodeSlot>>(
+          num_local_decode_threads * decode_buffer_size_per_thread));
+      load_thread_ = std::thread(&SharedPoolLoadWorker, base_.get(), image_feature_name,
+                                 label_feature_name, color_space, decode_slots_.get());
+      return;
+    }
     decode_in_buffers_.resize(num_local_decode_threads);
     decode_out_buffers_.resize(num_local_decode_threads);
     for (int64_t i = 0; i < num_local_decode_threads; ++i) {
@@ -174,6 +226,7 @@ class OFRecordImageClassificationDataset final : public Dataset<ImageClassificat
     load_thread_ = std::thread(&LoadWorker, base_.get(), &decode_in_buffers_);
   }
   ~OFRecordImageClassificationDataset() override {
+    if (decode_slots_) { decode_slots_->Close(); }
     for (auto& out_buffer : decode_out_buffers_) { out_buffer->Close(); }
     for (auto& in_buffer : decode_in_buffers_) { in_buffer->Close(); }
     load_thread_.join();
@@ -182,6 +235,13 @@ class OFRecordImageClassificationDataset final : public Dataset<ImageClassificat
 
   LoadTargetPtrList Next() override {
     LoadTargetPtrList ret;
+    if (use_shared_decode_pool_) {
+      std::shared_ptr<ImageClassificationDecodeSlot> slot;
+      CHECK_EQ(decode_slots_->Receive(&slot), kBufferStatusSuccess);
+      slot->done.WaitUntilCntEqualZero();
+      ret.push_back(std::move(slot->instance));
+      return ret;
+    }
     LoadTargetPtr sample_ptr;
     size_t thread_idx =
         out_thread_idx_.fetch_add(1, std::memory_order_relaxed) % decode_out_buffers_.size();
@@ -193,10 +253,12 @@ class OFRecordImageClassificationDataset final : public Dataset<ImageClassificat
 
  private:
   std::unique_ptr<BaseDataset> base_;
+  const bool use_shared_decode_pool_;
   std::thread load_thread_;
   std::vector<std::thread> decode_threads_;
   std::vector<std::unique_ptr<Buffer<BaseLoadTargetPtr>>> decode_in_buffers_;
   std::vector<std::unique_ptr<Buffer<LoadTargetPtr>>> decode_out_buffers_;
+  std::unique_ptr<Buffer<std::shared_ptr<ImageClassificationDecodeSlot>>> decode_slots_;
   std::atomic<size_t> out_thread_idx_;
 };
 
@@ -0,0 +1,112 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/user/data/ofrecord_index.h"
+#include "oneflow/core/persistence/posix/posix_file_system.h"
+#include <fstream>
+#ifdef OF_PLATFORM_POSIX
+#include <unistd.h>
+#endif  // OF_PLATFORM_POSIX
+
+namespace oneflow {
+
+namespace data {
+
+namespace {
+
+constexpr char kIndexMagicCode[] = "OFRIDX\x00\x01";
+constexpr size_t kIndexMagicCodeLen = sizeof(kIndexMagicCode) - 1;
+constexpr size_t kIndexHeaderSize = kIndexMagicCodeLen + 2 * sizeof(uint64_t);
+
+}  // namespace
+
+std::string OFRecordIndexPath(const std::string& path) { return path + ".index"; }
+
+bool LoadOFRecordIndex(fs::FileSystem* fs, const std::string& path, uint64_t data_size,
+                       std::vector<uint64_t>* offsets) {
+  const std::string index_path = OFRecordIndexPath(path);
+  if (!fs->FileExists(index_path)) { return false; }
+  const uint64_t index_size = fs->GetFileSize(index_path);
+  if (index_size < kIndexHeaderSize) { return false; }
+  std::unique_ptr<fs::RandomAccessFile> file;
+  fs->NewRandomAccessFile(index_path, &file);
+  char header[kIndexHeaderSize];
+  file->Read(0, kIndexHeaderSize, header);
+  uint64_t index_data_size = 0;
+  uint64_t num_records = 0;
+  std::memcpy(&index_data_size, header + kIndexMagicCodeLen, sizeof(uint64_t));
+  std::memcpy(&num_records, header + kIndexMagicCodeLen + sizeof(uint64_t), sizeof(uint64_t));
+  if (std::memcmp(header, kIndexMagicCode, kIndexMagicCodeLen) != 0 || index_data_size != data_size
+      || index_size != kIndexHeaderSize + num_records * sizeof(uint64_t)) {
+    return false;
+  }
+  offsets->resize(num_records);
+  if (num_records > 0) {
+    file->Read(kIndexHeaderSize, num_records * sizeof(uint64_t),
+               reinterpret_cast<char*>(offsets->data()));
+  }
+  return true;
+}
+
+void SaveOFRecordIndex(fs::FileSystem* fs, const std::string& path, uint64_t data_size,
+                       const std::vector<uint64_t>& offsets) {
+#ifdef OF_PLATFORM_POSIX
+  if (dynamic_cast<fs::PosixFileSystem*>(fs) == nullptr) { return; }
+  const std::string index_path = fs->TranslateName(OFRecordIndexPath(path));
+  // the processes reading the same part write their own temporary file
+  const std::string tmp_path = index_path + ".tmp." + std::to_string(getpid());
+  {
+    std::ofstream stream(tmp_path, std::ios::binary | std::ios::trunc);
+    if (!stream.is_open()) { return; }
+    const uint64_t num_records = offsets.size();
+    stream.write(kIndexMagicCode, kIndexMagicCodeLen);
+    stream.write(reinterpret_cast<const char*>(&data_size), sizeof(data_size));
+    stream.write(reinterpret_cast<const char*>(&num_records), sizeof(num_records));
+    stream.write(reinterpret_cast<const char*>(offsets.data()), num_records * sizeof(uint64_t));
+    if (!stream.good()) {
+      stream.close();
+      std::remove(tmp_path.c_str());
+      return;
+    }
+  }
+  if (std::rename(tmp_path.c_str(), index_path.c_str()) != 0) { std::remove(tmp_path.c_str()); }
+#endif  // OF_PLATFORM_POSIX
+}
+
+void BuildOFRecordIndex(uint64_t data_size, const std::function<int64_t(uint64_t)>& ReadSize,
+                        std::vector<uint64_t>* offsets) {
+  offsets->clear();
+  uint64_t offset = 0;
+  while (offset < data_size) {
+    CHECK_LE(offset + sizeof(int64_t), data_size) << "truncated OFRecord size";
+    offsets->push_back(offset);
+    const int64_t size = ReadSize(offset);
+    CHECK_GT(size, 0);
+    offset += sizeof(int64_t) + size;
+    CHECK_LE(offset, data_size) << "truncated OFRecord";
+  }
+}
+
+void LoadOrBuildOFRecordIndex(fs::FileSystem* fs, const std::string& path, uint64_t data_size,
+                              const std::function<int64_t(uint64_t)>& ReadSize,
+                              std::vector<uint64_t>* offsets) {
+  if (LoadOFRecordIndex(fs, path, data_size, offsets)) { return; }
+  BuildOFRecordIndex(data_size, ReadSize, offsets);
+  SaveOFRecordIndex(fs, path, data_size, *offsets);
+}
+
+}  // namespace data
+
+}  // namespace oneflow
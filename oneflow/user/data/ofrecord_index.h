@@ -0,0 +1,52 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_USER_DATA_OFRECORD_INDEX_H_
+#define ONEFLOW_USER_DATA_OFRECORD_INDEX_H_
+
+#include "oneflow/core/common/util.h"
+#include "oneflow/core/persistence/file_system.h"
+
+namespace oneflow {
+namespace data {
+
+// The index of an OFRecord part file is the offset of the int64 size prefix of each record. It is
+// kept in a sidecar "<part>.index" file, which is only used while the part keeps the size the index
+// was built from.
+std::string OFRecordIndexPath(const std::string& path);
+
+// Reads the index of the part `path` of `data_size` bytes, false when it is missing or stale
+bool LoadOFRecordIndex(fs::FileSystem* fs, const std::string& path, uint64_t data_size,
+                       std::vector<uint64_t>* offsets);
+
+// Writes the index next to the part when it is on a local file system. It is best effort, the
+// dataset directory may be read only and the index is built again then.
+void SaveOFRecordIndex(fs::FileSystem* fs, const std::string& path, uint64_t data_size,
+                       const std::vector<uint64_t>& offsets);
+
+// Builds the index of a part of `data_size` bytes by one scan of the size prefixes, `ReadSize`
+// reads the size prefix at an offset
+void BuildOFRecordIndex(uint64_t data_size, const std::function<int64_t(uint64_t)>& ReadSize,
+                        std::vector<uint64_t>* offsets);
+
+// Loads the index of the part `path` on `fs`, or builds it from the part and saves it
+void LoadOrBuildOFRecordIndex(fs::FileSystem* fs, const std::string& path, uint64_t data_size,
+                              const std::function<int64_t(uint64_t)>& ReadSize,
+                              std::vector<uint64_t>* offsets);
+
+}  // namespace data
+}  // namespace oneflow
+
+#endif  // ONEFLOW_USER_DATA_OFRECORD_INDEX_H_
@@ -33,12 +33,28 @@ class OFRecordParser final : public Parser<TensorBuffer> {
 
   void Parse(std::shared_ptr<LoadTargetPtrList> batch_data,
              user_op::KernelComputeContext* ctx) override {
+    std::shared_ptr<void> prepared;
+    Prepare(*batch_data, &prepared);
+    ParsePrepared(batch_data, prepared, ctx);
+  }
+
+  void Prepare(const LoadTargetPtrList& batch_data, std::shared_ptr<void>* prepared) override {
+    auto records = std::make_shared<std::vector<OFRecord>>(batch_data.size());
+    MultiThreadLoop(batch_data.size(), [&](size_t i) {
+      const TensorBuffer* buffer = batch_data.at(i).get();
+      CHECK(records->at(i).ParseFromArray(buffer->data<char>(), buffer->shape().elem_cnt()));
+    });
+    *prepared = records;
+  }
+
+  void ParsePrepared(std::shared_ptr<LoadTargetPtrList> batch_data,
+                     const std::shared_ptr<void>& prepared,
+                     user_op::KernelComputeContext* ctx) override {
     user_op::Tensor* out_tensor = ctx->Tensor4ArgNameAndIndex("out", 0);
     OFRecord* dptr = out_tensor->mut_dptr<OFRecord>();
-    MultiThreadLoop(batch_data->size(), [&](size_t i) {
-      TensorBuffer* buffer = batch_data->at(i).get();
-      CHECK(dptr[i].ParseFromArray(buffer->data<char>(), buffer->shape().elem_cnt()));
-    });
+    auto* records = static_cast<std::vector<OFRecord>*>(prepared.get());
+    CHECK_EQ(records->size(), batch_data->size());
+    FOR_RANGE(size_t, i, 0, records->size()) { dptr[i].Swap(&records->at(i)); }
     if (batch_data->size() != out_tensor->shape().elem_cnt()) {
       CHECK_EQ(out_tensor->mut_shape()->NumAxes(), 1);
       out_tensor->mut_shape()->Set(0, batch_data->size());
@@ -0,0 +1,317 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/user/data/ofrecord_wire_format.h"
+
+namespace oneflow {
+namespace data {
+
+namespace {
+
+constexpr uint32_t kWireTypeVarint = 0;
+constexpr uint32_t kWireTypeFixed64 = 1;
+constexpr uint32_t kWireTypeLengthDelimited = 2;
+constexpr uint32_t kWireTypeFixed32 = 5;
+
+// The field number of OFRecord.feature, of a map entry's key and value and of XxxList.value
+constexpr uint32_t kFeatureMapFieldNumber = 1;
+constexpr uint32_t kMapEntryKeyFieldNumber = 1;
+constexpr uint32_t kMapEntryValueFieldNumber = 2;
+constexpr uint32_t kListValueFieldNumber = 1;
+
+class WireReader final {
+ public:
+  WireReader(const char* data, size_t size) : cur_(data), end_(data + size) {}
+  ~WireReader() = default;
+
+  bool AtEnd() const { return cur_ == end_; }
+
+  bool ReadVarint(uint64_t* value) {
+    uint64_t result = 0;
+    for (int32_t shift = 0; shift < 64 && cur_ < end_; shift += 7) {
+      const uint8_t byte = static_cast<uint8_t>(*cur_++);
+      result |= static_cast<uint64_t>(byte & 0x7F) << shift;
+      if ((byte & 0x80) == 0) {
+        *value = result;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool ReadTag(uint32_t* field_number, uint32_t* wire_type) {
+    uint64_t tag = 0;
+    if (!ReadVarint(&tag)) { return false; }
+    *field_number = static_cast<uint32_t>(tag >> 3);
+    *wire_type = static_cast<uint32_t>(tag & 0x7);
+    return true;
+  }
+
+  bool ReadLengthDelimited(const char** data, size_t* size) {
+    uint64_t length = 0;
+    if (!ReadVarint(&length) || length > static_cast<uint64_t>(end_ - cur_)) { return false; }
+    *data = cur_;
+    *size = length;
+    cur_ += length;
+    return true;
+  }
+
+  bool ReadFixed(size_t num_bytes, const char** data) {
+    if (num_bytes > static_cast<size_t>(end_ - cur_)) { return false; }
+    *data = cur_;
+    cur_ += num_bytes;
+    return true;
+  }
+
+  bool SkipField(uint32_t wire_type) {
+    uint64_t varint = 0;
+    const char* data = nullptr;
+    size_t size = 0;
+    if (wire_type == kWireTypeVarint) {
+      return ReadVarint(&varint);
+    } else if (wire_type == kWireTypeFixed64) {
+      return ReadFixed(8, &data);
+    } else if (wire_type == kWireTypeLengthDelimited) {
+      return ReadLengthDelimited(&data, &size);
+    } else if (wire_type == kWireTypeFixed32) {
+      return ReadFixed(4, &data);
+    } else {
+      // groups are not used by record.proto
+      return false;
+    }
+  }
+
+ private:
+  const char* cur_;
+  const char* end_;
+};
+
+// Parses one map entry of OFRecord.feature, `value` is the serialized Feature
+bool ReadFeatureMapEntry(const char* data, size_t size, const char** key, size_t* key_size,
+                         const char** value, size_t* value_size) {
+  WireReader reader(data, size);
+  *key = nullptr;
+  *key_size = 0;
+  *value = nullptr;
+  *value_size = 0;
+  while (!reader.AtEnd()) {
+    uint32_t field_number = 0;
+    uint32_t wire_type = 0;
+    if (!reader.ReadTag(&field_number, &wire_type)) { return false; }
+    if (field_number == kMapEntryKeyFieldNumber && wire_type == kWireTypeLengthDelimited) {
+      if (!reader.ReadLengthDelimited(key, key_size)) { return false; }
+    } else if (field_number == kMapEntryValueFieldNumber
+               && wire_type == kWireTypeLengthDelimited) {
+      if (!reader.ReadLengthDelimited(value, value_size)) { return false; }
+    } else if (!reader.SkipField(wire_type)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// The field numbers of the Feature oneof are its KindCase values
+bool ReadFeature(const char* data, size_t size, OFRecordFeatureView* view) {
+  WireReader reader(data, size);
+  *view = OFRecordFeatureView();
+  while (!reader.AtEnd()) {
+    uint32_t field_number = 0;
+    uint32_t wire_type = 0;
+    if (!reader.ReadTag(&field_number, &wire_type)) { return false; }
+    if (field_number >= Feature::kBytesList && field_number <= Feature::kInt64List
+        && wire_type == kWireTypeLengthDelimited) {
+      const char* list = nullptr;
+      size_t list_size = 0;
+      if (!reader.ReadLengthDelimited(&list, &list_size)) { return false; }
+      // the last member of a oneof on the wire wins, as in protobuf
+      *view = OFRecordFeatureView(static_cast<Feature::KindCase>(field_number), list, list_size);
+    } else if (!reader.SkipField(wire_type)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template<typename T>
+T LoadUnaligned(const char* data) {
+  T value;
+  std::memcpy(&value, data, sizeof(T));
+  return value;
+}
+
+// Calls handler(value) for each value of a numeric list until it returns false. Both the packed and
+// the unpacked encodings are accepted, as protobuf does.
+template<typename Handler>
+void ForEachNumericValue(Feature::KindCase kind_case, const char* data, size_t size,
+                         const Handler& handler) {
+  WireReader reader(data, size);
+  const bool is_varint = kind_case == Feature::kInt32List || kind_case == Feature::kInt64List;
+  const size_t fixed_size = kind_case == Feature::kDoubleList ? 8 : 4;
+  const uint32_t unpacked_wire_type =
+      is_varint ? kWireTypeVarint : (fixed_size == 8 ? kWireTypeFixed64 : kWireTypeFixed32);
+  auto HandleOne = [&](WireReader* value_reader) -> bool {
+    if (is_varint) {
+      uint64_t varint = 0;
+      CHECK(value_reader->ReadVarint(&varint));
+      if (kind_case == Feature::kInt32List) {
+        return handler(static_cast<int32_t>(varint));
+      } else {
+        return handler(static_cast<int64_t>(varint));
+      }
+    } else {
+      const char* fixed = nullptr;
+      CHECK(value_reader->ReadFixed(fixed_size, &fixed));
+      if (fixed_size == 8) {
+        return handler(LoadUnaligned<double>(fixed));
+      } else {
+        return handler(LoadUnaligned<float>(fixed));
+      }
+    }
+  };
+  while (!reader.AtEnd()) {
+    uint32_t field_number = 0;
+    uint32_t wire_type = 0;
+    CHECK(reader.ReadTag(&field_number, &wire_type));
+    if (field_number == kListValueFieldNumber && wire_type == kWireTypeLengthDelimited) {
+      const char* packed = nullptr;
+      size_t packed_size = 0;
+      CHECK(reader.ReadLengthDelimited(&packed, &packed_size));
+      WireReader packed_reader(packed, packed_size);
+      while (!packed_reader.AtEnd()) {
+        if (!HandleOne(&packed_reader)) { return; }
+      }
+    } else if (field_number == kListValueFieldNumber && wire_type == unpacked_wire_type) {
+      if (!HandleOne(&reader)) { return; }
+    } else {
+      CHECK(reader.SkipField(wire_type));
+    }
+  }
+}
+
+struct CountValue {
+  template<typename V>
+  bool operator()(V) const {
+    *count += 1;
+    return true;
+  }
+  int64_t* count;
+};
+
+template<typename T>
+struct ConvertValue {
+  template<typename V>
+  bool operator()(V value) const {
+    dst[*count] = static_cast<T>(value);
+    *count += 1;
+    return *count < max_cnt;
+  }
+  T* dst;
+  int64_t max_cnt;
+  int64_t* count;
+};
+
+}  // namespace
+
+int64_t OFRecordFeatureView::ValueSize() const {
+  int64_t count = 0;
+  if (kind_case_ == Feature::kBytesList) {
+    WireReader reader(data_, size_);
+    while (!reader.AtEnd()) {
+      uint32_t field_number = 0;
+      uint32_t wire_type = 0;
+      CHECK(reader.ReadTag(&field_number, &wire_type));
+      if (field_number == kListValueFieldNumber && wire_type == kWireTypeLengthDelimited) {
+        count += 1;
+      }
+      CHECK(reader.SkipField(wire_type));
+    }
+  } else if (kind_case_ != Feature::KIND_NOT_SET) {
+    ForEachNumericValue(kind_case_, data_, size_, CountValue{&count});
+  }
+  return count;
+}
+
+void OFRecordFeatureView::GetSingleBytes(const char** data, size_t* size) const {
+  CHECK(has_bytes_list());
+  WireReader reader(data_, size_);
+  int64_t count = 0;
+  while (!reader.AtEnd()) {
+    uint32_t field_number = 0;
+    uint32_t wire_type = 0;
+    CHECK(reader.ReadTag(&field_number, &wire_type));
+    if (field_number == kListValueFieldNumber && wire_type == kWireTypeLengthDelimited) {
+      CHECK(reader.ReadLengthDelimited(data, size));
+      count += 1;
+    } else {
+      CHECK(reader.SkipField(wire_type));
+    }
+  }
+  CHECK_EQ(count, 1);
+}
+
+template<typename T>
+int64_t OFRecordFeatureView::CopyNumericValues(T* dst, int64_t max_cnt) const {
+  CHECK(kind_case_ == Feature::kFloatList || kind_case_ == Feature::kDoubleList
+        || kind_case_ == Feature::kInt32List || kind_case_ == Feature::kInt64List);
+  int64_t count = 0;
+  if (max_cnt <= 0) { return count; }
+  ForEachNumericValue(kind_case_, data_, size_, ConvertValue<T>{dst, max_cnt, &count});
+  return count;
+}
+
+bool FindOFRecordFeature(const char* data, size_t size, const std::string& name,
+                         OFRecordFeatureView* view) {
+  WireReader reader(data, size);
+  *view = OFRecordFeatureView();
+  while (!reader.AtEnd()) {
+    uint32_t field_number = 0;
+    uint32_t wire_type = 0;
+    if (!reader.ReadTag(&field_number, &wire_type)) { return false; }
+    if (field_number == kFeatureMapFieldNumber && wire_type == kWireTypeLengthDelimited) {
+      const char* entry = nullptr;
+      size_t entry_size = 0;
+      if (!reader.ReadLengthDelimited(&entry, &entry_size)) { return false; }
+      const char* key = nullptr;
+      size_t key_size = 0;
+      const char* value = nullptr;
+      size_t value_size = 0;
+      if (!ReadFeatureMapEntry(entry, entry_size, &key, &key_size, &value, &value_size)) {
+        return false;
+      }
+      // a later entry with the same key replaces the earlier one, as when parsing into a map
+      if (key_size == name.size() && std::memcmp(key, name.data(), key_size) == 0) {
+        if (!ReadFeature(value, value_size, view)) { return false; }
+      }
+    } else if (!reader.SkipField(wire_type)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+#define INSTANTIATE_COPY_NUMERIC_VALUES(T)                                             \
+  template int64_t OFRecordFeatureView::CopyNumericValues<T>(T * dst, int64_t max_cnt) \
+      const;
+INSTANTIATE_COPY_NUMERIC_VALUES(char)
+INSTANTIATE_COPY_NUMERIC_VALUES(float)
+INSTANTIATE_COPY_NUMERIC_VALUES(double)
+INSTANTIATE_COPY_NUMERIC_VALUES(int8_t)
+INSTANTIATE_COPY_NUMERIC_VALUES(int32_t)
+INSTANTIATE_COPY_NUMERIC_VALUES(int64_t)
+INSTANTIATE_COPY_NUMERIC_VALUES(uint8_t)
+#undef INSTANTIATE_COPY_NUMERIC_VALUES
+
+}  // namespace data
+}  // namespace oneflow
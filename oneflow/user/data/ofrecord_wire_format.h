@@ -0,0 +1,61 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_USER_DATA_OFRECORD_WIRE_FORMAT_H_
+#define ONEFLOW_USER_DATA_OFRECORD_WIRE_FORMAT_H_
+
+#include "oneflow/core/common/util.h"
+#include "oneflow/core/record/record.pb.h"
+
+namespace oneflow {
+namespace data {
+
+// A Feature found in a serialized OFRecord. It points into the serialized bytes, which must outlive
+// it, so looking up a feature neither parses the other features nor copies any value.
+class OFRecordFeatureView final {
+ public:
+  OFRecordFeatureView() : kind_case_(Feature::KIND_NOT_SET), data_(nullptr), size_(0) {}
+  OFRecordFeatureView(Feature::KindCase kind_case, const char* data, size_t size)
+      : kind_case_(kind_case), data_(data), size_(size) {}
+  ~OFRecordFeatureView() = default;
+
+  Feature::KindCase kind_case() const { return kind_case_; }
+  bool has_bytes_list() const { return kind_case_ == Feature::kBytesList; }
+
+  // Number of values of the list, whatever its kind
+  int64_t ValueSize() const;
+  // The only value of a bytes list
+  void GetSingleBytes(const char** data, size_t* size) const;
+  // Converts the first min(max_cnt, ValueSize()) values of a numeric list to T and returns how
+  // many were written
+  template<typename T>
+  int64_t CopyNumericValues(T* dst, int64_t max_cnt) const;
+
+ private:
+  Feature::KindCase kind_case_;
+  // the serialized XxxList message of the feature
+  const char* data_;
+  size_t size_;
+};
+
+// Scans a serialized OFRecord for the feature `name` without parsing it into an OFRecord. Returns
+// false if the bytes are malformed, a feature that is absent leaves `view` with KIND_NOT_SET.
+bool FindOFRecordFeature(const char* data, size_t size, const std::string& name,
+                         OFRecordFeatureView* view);
+
+}  // namespace data
+}  // namespace oneflow
+
+#endif  // ONEFLOW_USER_DATA_OFRECORD_WIRE_FORMAT_H_
@@ -0,0 +1,88 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <gtest/gtest.h>
+#include "oneflow/user/data/ofrecord_wire_format.h"
+
+namespace oneflow {
+
+namespace data {
+
+namespace {
+
+std::string SerializeTestRecord() {
+  OFRecord record;
+  (*record.mutable_feature())["image"].mutable_bytes_list()->add_value(std::string("\0\1\2", 3));
+  (*record.mutable_feature())["label"].mutable_int32_list()->add_value(-7);
+  auto* floats = (*record.mutable_feature())["floats"].mutable_float_list();
+  floats->add_value(1.5);
+  floats->add_value(-2);
+  floats->add_value(3);
+  (*record.mutable_feature())["id"].mutable_int64_list()->add_value(int64_t(1) << 40);
+  std::string serialized;
+  CHECK(record.SerializeToString(&serialized));
+  return serialized;
+}
+
+}  // namespace
+
+TEST(OFRecordWireFormat, find_features) {
+  const std::string record = SerializeTestRecord();
+  OFRecordFeatureView view;
+
+  ASSERT_TRUE(FindOFRecordFeature(record.data(), record.size(), "image", &view));
+  ASSERT_TRUE(view.has_bytes_list());
+  ASSERT_EQ(view.ValueSize(), 1);
+  const char* data = nullptr;
+  size_t size = 0;
+  view.GetSingleBytes(&data, &size);
+  ASSERT_EQ(std::string(data, size), std::string("\0\1\2", 3));
+
+  ASSERT_TRUE(FindOFRecordFeature(record.data(), record.size(), "label", &view));
+  ASSERT_EQ(view.kind_case(), Feature::kInt32List);
+  int64_t label = 0;
+  ASSERT_EQ(view.CopyNumericValues<int64_t>(&label, 1), 1);
+  ASSERT_EQ(label, -7);
+
+  ASSERT_TRUE(FindOFRecordFeature(record.data(), record.size(), "floats", &view));
+  ASSERT_EQ(view.ValueSize(), 3);
+  double floats[4] = {0, 0, 0, 0};
+  ASSERT_EQ(view.CopyNumericValues<double>(floats, 4), 3);
+  ASSERT_EQ(floats[0], 1.5);
+  ASSERT_EQ(floats[1], -2);
+  ASSERT_EQ(floats[2], 3);
+  // truncated to max_cnt
+  int32_t first = 0;
+  ASSERT_EQ(view.CopyNumericValues<int32_t>(&first, 1), 1);
+  ASSERT_EQ(first, 1);
+
+  ASSERT_TRUE(FindOFRecordFeature(record.data(), record.size(), "id", &view));
+  int64_t id = 0;
+  ASSERT_EQ(view.CopyNumericValues<int64_t>(&id, 1), 1);
+  ASSERT_EQ(id, int64_t(1) << 40);
+
+  ASSERT_TRUE(FindOFRecordFeature(record.data(), record.size(), "absent", &view));
+  ASSERT_EQ(view.kind_case(), Feature::KIND_NOT_SET);
+}
+
+TEST(OFRecordWireFormat, malformed_record) {
+  const std::string record = SerializeTestRecord();
+  OFRecordFeatureView view;
+  ASSERT_FALSE(FindOFRecordFeature(record.data(), record.size() - 1, "image", &view));
+}
+
+}  // namespace data
+
+}  // namespace oneflow
@@ -17,6 +17,8 @@ limitations under the License.
 #define ONEFLOW_CUSTOMIZED_DATA_ONEREC_DATASET_H_
 
 #include "oneflow/core/common/blocking_counter.h"
+#include "oneflow/core/common/buffer.h"
+#include "oneflow/core/thread/thread_affinity.h"
 #include "oneflow/user/data/dataset.h"
 #include "oneflow/core/common/balanced_splitter.h"
 #include "oneflow/core/common/str_util.h"
@@ -24,6 +26,7 @@ limitations under the License.
 #include "oneflow/core/persistence/persistent_in_stream.h"
 #include "oneflow/core/job/job_set.pb.h"
 
+#include "lz4.h"
 #define XXH_NAMESPACE LZ4_
 #include <xxhash.h>
 
@@ -34,6 +37,10 @@ namespace {
 constexpr int64_t kMaxPayloadSize = std::numeric_limits<int32_t>::max();
 constexpr int64_t kMagicNumber = 0x24434552454E4F5E;  // '^ONEREC$', little endian
 constexpr int32_t kReservedNumber = 0;
+// A frame whose reserved field is kLz4CompressedFlag holds the int64 size of the record followed by
+// the record compressed as one LZ4 block, the digests cover the stored bytes
+constexpr int32_t kLz4CompressedFlag = 1;
+constexpr int32_t kUncompressedSizeFieldSize = 8;
 constexpr int32_t kPayloadAlignmentSize = 8;
 constexpr int32_t kMagicFieldSize = 8;
 constexpr int32_t kReservedFieldSize = 4;
@@ -67,16 +74,65 @@ union OneRecFrameFooterView {
   XXH64_hash_t digest;
 };
 
+// Reads the next frame of `in_stream` into `record`, checks its digests and decompresses it.
+// Returns false at the end of the stream.
+bool ReadOneRecFrame(PersistentInStream* in_stream, TensorBuffer* record) {
+  static_assert(sizeof(OneRecFrameHeader) == kHeaderSize, "");
+  OneRecFrameHeaderView header_view{};
+  static_assert(sizeof(header_view.header) == kHeaderSize, "");
+  const int32_t read_status = in_stream->ReadFully(header_view.raw, kHeaderSize);
+  if (read_status == -1) { return false; }
+  CHECK_EQ(read_status, 0);
+  CHECK_EQ(header_view.header.magic, kMagicNumber);
+  const int32_t flags = header_view.header.reserved;
+  CHECK(flags == kReservedNumber || flags == kLz4CompressedFlag);
+  const int32_t payload_size = header_view.header.payload_size;
+  CHECK_GE(payload_size, 0);
+  CHECK_LE(payload_size, kMaxPayloadSize);
+  XXH64_hash_t const seed = 0;
+  CHECK_EQ(ByteSwap(header_view.header.digest),
+           LZ4_XXH64(header_view.raw, kHeaderSizeWithoutDigest, seed));
+  const int32_t padded_size = RoundUp(payload_size, kPayloadAlignmentSize) - payload_size;
+  record->Resize(Shape({payload_size}), DataType::kChar);
+  char* body = record->mut_data<char>();
+  CHECK_EQ(in_stream->ReadFully(body, payload_size), 0);
+  char padded[kPayloadAlignmentSize];
+  CHECK_EQ(in_stream->ReadFully(padded, padded_size), 0);  // read padded
+  static_assert(sizeof(OneRecFrameFooterView) == kDigestFieldSize, "");
+  OneRecFrameFooterView footer_view{};
+  CHECK_EQ(in_stream->ReadFully(footer_view.raw, kDigestFieldSize), 0);  // read footer
+  CHECK_EQ(ByteSwap(footer_view.digest), LZ4_XXH64(body, payload_size, seed));
+  if (flags == kLz4CompressedFlag) {
+    CHECK_GE(payload_size, kUncompressedSizeFieldSize);
+    int64_t record_size = 0;
+    std::memcpy(&record_size, body, kUncompressedSizeFieldSize);
+    CHECK_GE(record_size, 0);
+    CHECK_LE(record_size, kMaxPayloadSize);
+    TensorBuffer decompressed;
+    decompressed.Resize(Shape({record_size}), DataType::kChar);
+    CHECK_EQ(LZ4_decompress_safe(body + kUncompressedSizeFieldSize,
+                                 decompressed.mut_data<char>(),
+                                 payload_size - kUncompressedSizeFieldSize, record_size),
+             record_size);
+    record->Swap(&decompressed);
+  }
+  return true;
+}
+
 }  // namespace
 
 namespace data {
 
+// With ONEFLOW_ONEREC_READ_AHEAD_FILES=n, the local files are dealt to n threads, each reads its
+// files ahead, checks and decompresses their frames. The batches then take the records of the
+// threads in turn, so the order differs from reading the files one after another.
 class OneRecDataset final : public Dataset<TensorBuffer> {
  public:
   using LoadTargetPtr = std::shared_ptr<TensorBuffer>;
   using LoadTargetPtrList = std::vector<LoadTargetPtr>;
   OF_DISALLOW_COPY_AND_MOVE(OneRecDataset);
-  OneRecDataset(user_op::KernelInitContext* ctx, int32_t batch_size) : batch_size_(batch_size) {
+  OneRecDataset(user_op::KernelInitContext* ctx, int32_t batch_size)
+      : batch_size_(batch_size), next_read_ahead_idx_(0) {
     current_epoch_ = 0;
     shuffle_after_epoch_ = ctx->Attr<bool>("shuffle_after_epoch");
     data_file_paths_ = ctx->Attr<std::vector<std::string>>("files");
@@ -84,56 +140,51 @@ class OneRecDataset final : public Dataset<TensorBuffer> {
     parallel_num_ = ctx->parallel_ctx().parallel_num();
     BalancedSplitter bs(data_file_paths_.size(), parallel_num_);
     range_ = bs.At(parallel_id_);
-    ResetInstream();
-    hash_state_ = LZ4_XXH64_createState();
+    const int64_t num_read_ahead_threads =
+        std::min<int64_t>(ParseIntegerFromEnv("ONEFLOW_ONEREC_READ_AHEAD_FILES", 0), range_.size());
+    if (num_read_ahead_threads > 0) {
+      const int64_t read_ahead_records =
+          ParseIntegerFromEnv("ONEFLOW_ONEREC_READ_AHEAD_RECORDS_PER_FILE", 256);
+      CHECK_GT(read_ahead_records, 0);
+      FOR_RANGE(int64_t, i, 0, num_read_ahead_threads) {
+        read_ahead_buffers_.emplace_back(new Buffer<LoadTargetPtr>(read_ahead_records));
+      }
+      FOR_RANGE(int64_t, i, 0, num_read_ahead_threads) {
+        read_ahead_threads_.emplace_back(&OneRecDataset::ReadAheadLoop, this, i);
+      }
+    } else {
+      ResetInstream();
+    }
   }
 
-  ~OneRecDataset() { CHECK_NE(LZ4_XXH64_freeState(hash_state_), XXH_ERROR); }
+  ~OneRecDataset() {
+    for (auto& buffer : read_ahead_buffers_) { buffer->Close(); }
+    for (auto& thread : read_ahead_threads_) { thread.join(); }
+  }
 
   LoadTargetPtrList Next() override {
     LoadTargetPtrList ret;
     ret.resize(batch_size_);
     for (int32_t i = 0; i < batch_size_; ++i) {
-      ret.at(i).reset(new TensorBuffer());
-      ReadSample(*ret.at(i).get());
+      if (read_ahead_buffers_.empty()) {
+        ret.at(i).reset(new TensorBuffer());
+        ReadSample(*ret.at(i).get());
+      } else {
+        auto& buffer = read_ahead_buffers_.at(next_read_ahead_idx_);
+        next_read_ahead_idx_ = (next_read_ahead_idx_ + 1) % read_ahead_buffers_.size();
+        CHECK_EQ(buffer->Receive(&ret.at(i)), kBufferStatusSuccess);
+      }
     }
     return ret;
   }
 
  private:
   void ReadSample(TensorBuffer& tensor) {
-    static_assert(sizeof(OneRecFrameHeader) == kHeaderSize, "");
-    OneRecFrameHeaderView header_view{};
-    static_assert(sizeof(header_view.header) == kHeaderSize, "");
-    int32_t read_status = in_stream_->ReadFully(header_view.raw, kHeaderSize);
-    if (read_status == -1) {
+    if (!ReadOneRecFrame(in_stream_.get(), &tensor)) {
       ResetInstream();
       current_epoch_++;
-      CHECK_EQ(in_stream_->ReadFully(header_view.raw, kHeaderSize), 0);
-    } else {
-      CHECK_EQ(read_status, 0);
+      CHECK(ReadOneRecFrame(in_stream_.get(), &tensor));
     }
-    CHECK_EQ(header_view.header.magic, kMagicNumber);
-    CHECK_EQ(header_view.header.reserved, kReservedNumber);
-    const int32_t payload_size = header_view.header.payload_size;
-    CHECK_GE(payload_size, 0);
-    CHECK_LE(payload_size, kMaxPayloadSize);
-    XXH64_hash_t const seed = 0;
-    CHECK_NE(LZ4_XXH64_reset(hash_state_, seed), XXH_ERROR);
-    CHECK_NE(XXH64_update(hash_state_, header_view.raw, kHeaderSizeWithoutDigest), XXH_ERROR);
-    CHECK_EQ(ByteSwap(header_view.header.digest), LZ4_XXH64_digest(hash_state_));
-    const int32_t padded_size = RoundUp(payload_size, kPayloadAlignmentSize) - payload_size;
-    tensor.Resize(Shape({payload_size}), DataType::kChar);
-    char* body = tensor.mut_data<char>();
-    CHECK_EQ(in_stream_->ReadFully(body, payload_size), 0);
-    char padded[kPayloadAlignmentSize];
-    CHECK_EQ(in_stream_->ReadFully(padded, padded_size), 0);  // read padded
-    static_assert(sizeof(OneRecFrameFooterView) == kDigestFieldSize, "");
-    OneRecFrameFooterView footer_view{};
-    CHECK_EQ(in_stream_->ReadFully(footer_view.raw, kDigestFieldSize), 0);  // read footer
-    CHECK_NE(XXH64_reset(hash_state_, seed), XXH_ERROR);
-    CHECK_NE(LZ4_XXH64_update(hash_state_, body, payload_size), XXH_ERROR);
-    CHECK_EQ(ByteSwap(footer_view.digest), LZ4_XXH64_digest(hash_state_));
   }
 
   void ResetInstream() {
@@ -141,16 +192,41 @@ class OneRecDataset final : public Dataset<TensorBuffer> {
       std::mt19937 g(kOneflowDatasetSeed + current_epoch_);
       std::shuffle(data_file_paths_.begin(), data_file_paths_.end(), g);
     }
-    std::vector<std::string> file_paths = GetLocalFilePaths();
+    std::vector<std::string> file_paths = GetLocalFilePaths(data_file_paths_);
     in_stream_.reset(new PersistentInStream(DataFS(), file_paths, false, false));
   }
 
-  std::vector<std::string> GetLocalFilePaths() {
+  std::vector<std::string> GetLocalFilePaths(const std::vector<std::string>& data_file_paths) {
     std::vector<std::string> ret;
-    for (int i = range_.begin(); i < range_.end(); ++i) { ret.push_back(data_file_paths_.at(i)); }
+    for (int i = range_.begin(); i < range_.end(); ++i) { ret.push_back(data_file_paths.at(i)); }
     return ret;
   }
 
+  // Reads the local files dealt to the thread `thread_idx` epoch after epoch, all the threads
+  // shuffle the files the same way
+  void ReadAheadLoop(int64_t thread_idx) {
+    BindCurrentThreadToRoleCores(ThreadRole::kData);
+    Buffer<LoadTargetPtr>* buffer = read_ahead_buffers_.at(thread_idx).get();
+    std::vector<std::string> data_file_paths = data_file_paths_;
+    for (int32_t epoch = 0;; ++epoch) {
+      if (shuffle_after_epoch_) {
+        std::mt19937 g(kOneflowDatasetSeed + epoch);
+        std::shuffle(data_file_paths.begin(), data_file_paths.end(), g);
+      }
+      const std::vector<std::string> local_file_paths = GetLocalFilePaths(data_file_paths);
+      std::vector<std::string> file_paths;
+      for (size_t i = thread_idx; i < local_file_paths.size(); i += read_ahead_buffers_.size()) {
+        file_paths.push_back(local_file_paths.at(i));
+      }
+      PersistentInStream in_stream(DataFS(), file_paths, false, false);
+      while (true) {
+        LoadTargetPtr record(new TensorBuffer());
+        if (!ReadOneRecFrame(&in_stream, record.get())) { break; }
+        if (buffer->Send(record) == kBufferStatusErrorClosed) { return; }
+      }
+    }
+  }
+
   int32_t current_epoch_;
   bool shuffle_after_epoch_;
 
@@ -159,8 +235,10 @@ class OneRecDataset final : public Dataset<TensorBuffer> {
   Range range_;
   std::vector<std::string> data_file_paths_;
   std::unique_ptr<PersistentInStream> in_stream_;
-  XXH64_state_t* hash_state_;
   int32_t batch_size_;
+  std::vector<std::unique_ptr<Buffer<LoadTargetPtr>>> read_ahead_buffers_;
+  std::vector<std::thread> read_ahead_threads_;
+  size_t next_read_ahead_idx_;
 };
 
 }  // namespace data
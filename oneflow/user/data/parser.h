@@ -32,6 +32,17 @@ class Parser {
 
   virtual void Parse(std::shared_ptr<LoadTargetPtrList> batch_data,
                      user_op::KernelComputeContext* ctx) = 0;
+
+  // Runs on a worker of the DataReader, before the batch is parsed on the compute thread.
+  // The work that needs no kernel context belongs here, and what it leaves in `prepared` is passed
+  // to ParsePrepared along with the batch.
+  virtual void Prepare(const LoadTargetPtrList& batch_data, std::shared_ptr<void>* prepared) {}
+
+  virtual void ParsePrepared(std::shared_ptr<LoadTargetPtrList> batch_data,
+                             const std::shared_ptr<void>& prepared,
+                             user_op::KernelComputeContext* ctx) {
+    Parse(batch_data, ctx);
+  }
 };
 
 }  // namespace data
@@ -50,6 +50,11 @@ class ArgWhereKernel final : public user_op::OpKernel {
     ArgWhereKernelUtil<device_type, IN_T, OUT_T, NDIM>::ArgWhere(
         ctx->device_ctx(), input->shape(), input->dptr<IN_T>(), tmp_ptr, tmp_size,
         output->mut_dptr<OUT_T>(), output_size->mut_dptr<OUT_T>());
+    if (ctx->Attr<bool>("pad_tail")) {
+      ArgWhereKernelUtil<device_type, IN_T, OUT_T, NDIM>::PadTail(
+          ctx->device_ctx(), output->shape().At(0), output_size->dptr<OUT_T>(),
+          output->mut_dptr<OUT_T>());
+    }
   }
 };
 
@@ -47,6 +47,11 @@ struct ArgWhereKernelUtil<DeviceType::kCPU, IN_T, OUT_T, NDIM> {
     *output_size_ptr = true_cnt;
   }
 
+  static void PadTail(DeviceCtx* ctx, int64_t capacity, const OUT_T* output_size_ptr,
+                      OUT_T* output_ptr) {
+    FOR_RANGE(int64_t, i, *output_size_ptr * NDIM, capacity * NDIM) { output_ptr[i] = 0; }
+  }
+
   static size_t GetWorkspaceBytesSize(DeviceCtx* ctx, int64_t elem_cnt) { return 0; }
 };
 
@@ -63,6 +63,18 @@ __global__ void __launch_bounds__(kBlockSize)
   }
 }
 
+// launched for the full capacity, the rows actually written are only known on the device
+template<typename T, int NDIM>
+__global__ void __launch_bounds__(kBlockSize)
+    CudaPadTail(int64_t capacity, const T* output_size_ptr, T* output_ptr) {
+  const int64_t begin = static_cast<int64_t>(*output_size_ptr) * NDIM;
+  const int64_t step = static_cast<int64_t>(blockDim.x) * gridDim.x;
+  for (int64_t i = begin + blockIdx.x * blockDim.x + threadIdx.x; i < capacity * NDIM;
+       i += step) {
+    output_ptr[i] = 0;
+  }
+}
+
 template<typename T>
 struct IsTrue {
   CUB_RUNTIME_FUNCTION __forceinline__ bool operator()(const T& val) const {
@@ -121,6 +133,13 @@ struct ArgWhereKernelUtil<DeviceType::kGPU, IN_T, OUT_T, NDIM> {
     }
   }
 
+  static void PadTail(DeviceCtx* ctx, int64_t capacity, const OUT_T* output_size_ptr,
+                      OUT_T* output_ptr) {
+    if (capacity == 0) { return; }
+    CudaPadTail<OUT_T, NDIM><<<GetNumBlocks(capacity * NDIM), kBlockSize, 0, ctx->cuda_stream()>>>(
+        capacity, output_size_ptr, output_ptr);
+  }
+
   static size_t GetWorkspaceBytesSize(DeviceCtx* ctx, int64_t elem_cnt) {
     cudaStream_t stream = ctx ? ctx->cuda_stream() : 0;
     size_t workspace = 0;
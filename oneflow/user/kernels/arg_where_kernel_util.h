@@ -26,6 +26,9 @@ struct ArgWhereKernelUtil {
   static void ArgWhere(DeviceCtx* ctx, const ShapeView& input_shape, const IN_T* input_ptr,
                        void* temp_storage, size_t temp_storage_bytes, OUT_T* output_ptr,
                        OUT_T* output_size_ptr);
+  // Zeros the rows [*output_size_ptr, capacity) of output, the count is only read on the device
+  static void PadTail(DeviceCtx* ctx, int64_t capacity, const OUT_T* output_size_ptr,
+                      OUT_T* output_ptr);
   static size_t GetWorkspaceBytesSize(DeviceCtx* ctx, int64_t elem_cnt);
 };
 
@@ -32,42 +32,31 @@ class BroadcastDivGradKernel final : public user_op::OpKernel {
     const user_op::Tensor* y_tensor = ctx->Tensor4ArgNameAndIndex("y", 0);
     const user_op::Tensor* z_tensor = ctx->Tensor4ArgNameAndIndex("z", 0);
     const user_op::Tensor* dz_tensor = ctx->Tensor4ArgNameAndIndex("dz", 0);
-    user_op::Tensor* tmp_buffer = ctx->Tensor4ArgNameAndIndex("tmp_buffer", 0);
     user_op::Tensor* dy_tensor = ctx->Tensor4ArgNameAndIndex("dy", 0);
 
+    // dy = reduce_sum(-dz * z / y) and y is constant along the reduced axes, so
+    // dy = -reduce_sum(dz * z) / y, where the product is reduced without being materialized.
     const int64_t num_axes = dz_tensor->shape().NumAxes();
-    XpuVarNdarray<const T> dz(dz_tensor->shape(), dz_tensor->dptr<T>(), num_axes);
-    XpuVarNdarray<const T> const_tmp(dz.shape(), tmp_buffer->dptr<T>());
-    XpuVarNdarray<T> tmp(dz.shape(), tmp_buffer->mut_dptr<T>());
-
-    NdarrayUtil<device, T>::BroadcastDiv(
-        ctx->device_ctx(), tmp,
-        XpuVarNdarray<const T>(z_tensor->shape(), z_tensor->dptr<T>(), num_axes),
+    XpuVarNdarray<T> dy(dy_tensor->shape(), dy_tensor->mut_dptr<T>(), num_axes);
+    NdarrayUtil<device, T>::ReduceSumBroadcastMul(
+        ctx->device_ctx(), dy,
+        XpuVarNdarray<const T>(dz_tensor->shape(), dz_tensor->dptr<T>(), num_axes),
+        XpuVarNdarray<const T>(z_tensor->shape(), z_tensor->dptr<T>(), num_axes));
+    NdarrayUtil<device, T>::InplaceDiv(
+        ctx->device_ctx(), dy,
         XpuVarNdarray<const T>(y_tensor->shape(), y_tensor->dptr<T>(), num_axes));
-    NdarrayUtil<device, T>::BroadcastMul(ctx->device_ctx(), tmp, dz, const_tmp);
-    NdarrayUtil<device, T>::ReduceSum(
-        ctx->device_ctx(), XpuVarNdarray<T>(dy_tensor->shape(), dy_tensor->mut_dptr<T>(), num_axes),
-        const_tmp, tmp);
-    NdarrayUtil<device, T>::InplaceNegative(
-        ctx->device_ctx(),
-        XpuVarNdarray<T>(dy_tensor->shape(), dy_tensor->mut_dptr<T>(), num_axes));
+    NdarrayUtil<device, T>::InplaceNegative(ctx->device_ctx(), dy);
   };
   bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
 };
 
 }  // namespace
 
-#define REGISTER_BROADCAST_DIV_GRAD_KERNEL(device, dtype_pair)                            \
-  REGISTER_USER_KERNEL("broadcast_div_grad")                                              \
-      .SetCreateFn<BroadcastDivGradKernel<device, OF_PP_PAIR_FIRST(dtype_pair)>>()        \
-      .SetIsMatchedHob((user_op::HobDeviceTag() == device)                                \
-                       & (user_op::HobDataType("y", 0) == OF_PP_PAIR_SECOND(dtype_pair))) \
-      .SetInferTmpSizeFn([](oneflow::user_op::InferContext* ctx) {                        \
-        const user_op::TensorDesc& z = ctx->InputTensorDesc("z", 0);                      \
-        const DataType& data_type = z.data_type();                                        \
-        const int64_t elem_cnt = z.shape().elem_cnt();                                    \
-        return GetCudaAlignedSize(elem_cnt * GetSizeOfDataType(data_type));               \
-      });
+#define REGISTER_BROADCAST_DIV_GRAD_KERNEL(device, dtype_pair)                     \
+  REGISTER_USER_KERNEL("broadcast_div_grad")                                       \
+      .SetCreateFn<BroadcastDivGradKernel<device, OF_PP_PAIR_FIRST(dtype_pair)>>() \
+      .SetIsMatchedHob((user_op::HobDeviceTag() == device)                         \
+                       & (user_op::HobDataType("y", 0) == OF_PP_PAIR_SECOND(dtype_pair)));
 
 OF_PP_SEQ_PRODUCT_FOR_EACH_TUPLE(REGISTER_BROADCAST_DIV_GRAD_KERNEL, DEVICE_TYPE_SEQ,
                                  ARITHMETIC_DATA_TYPE_SEQ)
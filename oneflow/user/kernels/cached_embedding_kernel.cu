@@ -0,0 +1,215 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/framework/framework.h"
+#include "oneflow/core/device/cuda_util.h"
+#include "oneflow/core/cuda/atomic.cuh"
+#include "oneflow/core/embedding/embedding_store.h"
+
+namespace oneflow {
+
+namespace {
+
+__global__ void GatherRowsGpu(int64_t elem_cnt, int64_t embedding_size, const float* rows,
+                              const int32_t* slots, float* out) {
+  CUDA_1D_KERNEL_LOOP_T(int64_t, i, elem_cnt) {
+    out[i] = rows[slots[i / embedding_size] * embedding_size + i % embedding_size];
+  }
+}
+
+__global__ void ScatterRowsGpu(int64_t elem_cnt, int64_t embedding_size, const float* in,
+                               const int32_t* slots, float* rows) {
+  CUDA_1D_KERNEL_LOOP_T(int64_t, i, elem_cnt) {
+    rows[slots[i / embedding_size] * embedding_size + i % embedding_size] = in[i];
+  }
+}
+
+__global__ void SgdUpdateRowsGpu(int64_t elem_cnt, int64_t embedding_size, float learning_rate,
+                                 const int32_t* slots, const float* embedding_diff, float* rows) {
+  CUDA_1D_KERNEL_LOOP_T(int64_t, i, elem_cnt) {
+    cuda::atomic::Add(rows + slots[i / embedding_size] * embedding_size + i % embedding_size,
+                      -learning_rate * embedding_diff[i]);
+  }
+}
+
+template<typename K>
+size_t GetLookupPinnedBufferSize(int64_t num_ids, int64_t embedding_size) {
+  return GetCudaAlignedSize(num_ids * sizeof(K)) + 2 * GetCudaAlignedSize(num_ids * sizeof(int32_t))
+         + GetCudaAlignedSize(num_ids * embedding_size * sizeof(float));
+}
+
+class CachedEmbeddingKernelState final : public user_op::OpKernelState {
+ public:
+  explicit CachedEmbeddingKernelState(embedding::EmbeddingStore* store) : store_(store) {}
+  ~CachedEmbeddingKernelState() override = default;
+
+  embedding::EmbeddingStore* store() const { return store_; }
+
+ private:
+  embedding::EmbeddingStore* store_;
+};
+
+}  // namespace
+
+// Resolves the slots of the ids on host, moves the missing rows between the tiers and reads the
+// rows of out from the device cache. Every step after copying the ids to host is only as large
+// as the misses of the batch.
+template<typename K>
+class CachedEmbeddingLookupKernel final : public user_op::OpKernel {
+ public:
+  CachedEmbeddingLookupKernel() = default;
+  ~CachedEmbeddingLookupKernel() override = default;
+
+  std::shared_ptr<user_op::OpKernelState> CreateOpKernelState(
+      user_op::KernelInitContext* ctx) const override {
+    CHECK_EQ(ctx->parallel_ctx().parallel_num(), 1)
+        << "a cached embedding is only on one device";
+    embedding::EmbeddingOptions options;
+    options.name = ctx->Attr<std::string>("embedding_name");
+    options.path = ctx->Attr<std::string>("path");
+    options.embedding_size = ctx->Attr<int64_t>("embedding_size");
+    options.device_cache_capacity = ctx->Attr<int64_t>("device_cache_capacity");
+    options.host_cache_capacity = ctx->Attr<int64_t>("host_cache_capacity");
+    options.initializer_scale = ctx->Attr<float>("initializer_scale");
+    options.seed = ctx->Attr<int64_t>("seed");
+    int device_id = 0;
+    OF_CUDA_CHECK(cudaGetDevice(&device_id));
+    return std::make_shared<CachedEmbeddingKernelState>(
+        CHECK_JUST(embedding::GetOrCreateEmbeddingStore(options, device_id)));
+  }
+
+ private:
+  void Compute(user_op::KernelComputeContext* ctx, user_op::OpKernelState* state) const override {
+    auto* store = CHECK_NOTNULL(dynamic_cast<CachedEmbeddingKernelState*>(state))->store();
+    const user_op::Tensor* ids = ctx->Tensor4ArgNameAndIndex("ids", 0);
+    user_op::Tensor* out = ctx->Tensor4ArgNameAndIndex("out", 0);
+    user_op::Tensor* slots = ctx->Tensor4ArgNameAndIndex("slots", 0);
+    user_op::Tensor* tmp_buffer = ctx->Tensor4ArgNameAndIndex("tmp_buffer", 0);
+    const int64_t num_ids = ids->shape().elem_cnt();
+    if (num_ids == 0) { return; }
+    const int64_t embedding_size = store->options().embedding_size;
+    cudaStream_t cuda_stream = ctx->device_ctx()->cuda_stream();
+
+    char* pinned = reinterpret_cast<char*>(
+        store->PinnedBuffer(GetLookupPinnedBufferSize<K>(num_ids, embedding_size)));
+    K* pinned_ids = reinterpret_cast<K*>(pinned);
+    int32_t* pinned_move_slots =
+        reinterpret_cast<int32_t*>(pinned + GetCudaAlignedSize(num_ids * sizeof(K)));
+    int32_t* pinned_slots = reinterpret_cast<int32_t*>(
+        reinterpret_cast<char*>(pinned_move_slots) + GetCudaAlignedSize(num_ids * sizeof(int32_t)));
+    float* pinned_rows = reinterpret_cast<float*>(reinterpret_cast<char*>(pinned_slots)
+                                                  + GetCudaAlignedSize(num_ids * sizeof(int32_t)));
+    float* staging_rows = tmp_buffer->mut_dptr<float>();
+    int32_t* move_slots = reinterpret_cast<int32_t*>(
+        tmp_buffer->mut_dptr<char>()
+        + GetCudaAlignedSize(num_ids * embedding_size * sizeof(float)));
+
+    OF_CUDA_CHECK(cudaMemcpyAsync(pinned_ids, ids->dptr<K>(), num_ids * sizeof(K),
+                                  cudaMemcpyDeviceToHost, cuda_stream));
+    OF_CUDA_CHECK(cudaStreamSynchronize(cuda_stream));
+    std::vector<int64_t> host_ids(pinned_ids, pinned_ids + num_ids);
+    embedding::DeviceSlotPlan plan;
+    CHECK_JUST(store->AssignSlots(host_ids.data(), num_ids, &plan));
+
+    const int64_t num_evicted = plan.evict_slots.size();
+    if (num_evicted > 0) {
+      std::copy(plan.evict_slots.begin(), plan.evict_slots.end(), pinned_move_slots);
+      OF_CUDA_CHECK(cudaMemcpyAsync(move_slots, pinned_move_slots, num_evicted * sizeof(int32_t),
+                                    cudaMemcpyHostToDevice, cuda_stream));
+      const int64_t elem_cnt = num_evicted * embedding_size;
+      RUN_CUDA_KERNEL(GatherRowsGpu, ctx->device_ctx(), elem_cnt, elem_cnt, embedding_size,
+                      store->device_rows(), move_slots, staging_rows);
+      OF_CUDA_CHECK(cudaMemcpyAsync(pinned_rows, staging_rows, elem_cnt * sizeof(float),
+                                    cudaMemcpyDeviceToHost, cuda_stream));
+      OF_CUDA_CHECK(cudaStreamSynchronize(cuda_stream));
+      store->host_store()->Put(plan.evict_ids.data(), num_evicted, pinned_rows);
+    }
+    const int64_t num_loaded = plan.load_slots.size();
+    if (num_loaded > 0) {
+      store->host_store()->Get(plan.load_ids.data(), num_loaded, pinned_rows);
+      std::copy(plan.load_slots.begin(), plan.load_slots.end(), pinned_move_slots);
+      const int64_t elem_cnt = num_loaded * embedding_size;
+      OF_CUDA_CHECK(cudaMemcpyAsync(staging_rows, pinned_rows, elem_cnt * sizeof(float),
+                                    cudaMemcpyHostToDevice, cuda_stream));
+      OF_CUDA_CHECK(cudaMemcpyAsync(move_slots, pinned_move_slots, num_loaded * sizeof(int32_t),
+                                    cudaMemcpyHostToDevice, cuda_stream));
+      RUN_CUDA_KERNEL(ScatterRowsGpu, ctx->device_ctx(), elem_cnt, elem_cnt, embedding_size,
+                      staging_rows, move_slots, store->device_rows());
+    }
+    std::copy(plan.slots.begin(), plan.slots.end(), pinned_slots);
+    OF_CUDA_CHECK(cudaMemcpyAsync(slots->mut_dptr<int32_t>(), pinned_slots,
+                                  num_ids * sizeof(int32_t), cudaMemcpyHostToDevice, cuda_stream));
+    const int64_t elem_cnt = out->shape().elem_cnt();
+    RUN_CUDA_KERNEL(GatherRowsGpu, ctx->device_ctx(), elem_cnt, elem_cnt, embedding_size,
+                    store->device_rows(), slots->dptr<int32_t>(), out->mut_dptr<float>());
+    // the pinned buffer is reused by the next lookup
+    OF_CUDA_CHECK(cudaStreamSynchronize(cuda_stream));
+  }
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+};
+
+#define REGISTER_CACHED_EMBEDDING_LOOKUP_KERNEL(ids_type_pair)                                 \
+  REGISTER_USER_KERNEL("cached_embedding_lookup")                                              \
+      .SetCreateFn<CachedEmbeddingLookupKernel<OF_PP_PAIR_FIRST(ids_type_pair)>>()             \
+      .SetIsMatchedHob((user_op::HobDeviceTag() == "gpu")                                      \
+                       & (user_op::HobDataType("ids", 0) == OF_PP_PAIR_SECOND(ids_type_pair))) \
+      .SetInferTmpSizeFn([](user_op::InferContext* ctx) {                                      \
+        const int64_t num_ids = ctx->InputShape("ids", 0).elem_cnt();                          \
+        const int64_t embedding_size = ctx->Attr<int64_t>("embedding_size");                   \
+        return GetCudaAlignedSize(num_ids * embedding_size * sizeof(float))                    \
+               + GetCudaAlignedSize(num_ids * sizeof(int32_t));                                \
+      });
+
+OF_PP_FOR_EACH_TUPLE(REGISTER_CACHED_EMBEDDING_LOOKUP_KERNEL, INDEX_DATA_TYPE_SEQ)
+
+class CachedEmbeddingUpdateKernel final : public user_op::OpKernel {
+ public:
+  CachedEmbeddingUpdateKernel() = default;
+  ~CachedEmbeddingUpdateKernel() override = default;
+
+  std::shared_ptr<user_op::OpKernelState> CreateOpKernelState(
+      user_op::KernelInitContext* ctx) const override {
+    return std::make_shared<CachedEmbeddingKernelState>(
+        CHECK_JUST(embedding::GetEmbeddingStore(ctx->Attr<std::string>("embedding_name"))));
+  }
+
+ private:
+  void Compute(user_op::KernelComputeContext* ctx, user_op::OpKernelState* state) const override {
+    auto* store = CHECK_NOTNULL(dynamic_cast<CachedEmbeddingKernelState*>(state))->store();
+    const user_op::Tensor* slots = ctx->Tensor4ArgNameAndIndex("slots", 0);
+    const user_op::Tensor* embedding_diff = ctx->Tensor4ArgNameAndIndex("embedding_diff", 0);
+    const int64_t num_slots = slots->shape().elem_cnt();
+    if (num_slots == 0) { return; }
+    const int64_t embedding_size = store->options().embedding_size;
+    CHECK_EQ(embedding_diff->shape().elem_cnt(), num_slots * embedding_size);
+    const int64_t elem_cnt = embedding_diff->shape().elem_cnt();
+    RUN_CUDA_KERNEL(SgdUpdateRowsGpu, ctx->device_ctx(), elem_cnt, elem_cnt, embedding_size,
+                    ctx->Attr<float>("learning_rate"), slots->dptr<int32_t>(),
+                    embedding_diff->dptr<float>(), store->device_rows());
+    std::vector<int32_t> host_slots(num_slots);
+    OF_CUDA_CHECK(cudaMemcpyAsync(host_slots.data(), slots->dptr<int32_t>(),
+                                  num_slots * sizeof(int32_t), cudaMemcpyDeviceToHost,
+                                  ctx->device_ctx()->cuda_stream()));
+    OF_CUDA_CHECK(cudaStreamSynchronize(ctx->device_ctx()->cuda_stream()));
+    store->MarkDirty(host_slots.data(), num_slots);
+  }
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return true; }
+};
+
+REGISTER_USER_KERNEL("cached_embedding_update")
+    .SetCreateFn<CachedEmbeddingUpdateKernel>()
+    .SetIsMatchedHob(user_op::HobDeviceTag() == "gpu");
+
+}  // namespace oneflow
@@ -61,6 +61,8 @@ struct CastUtil final {
           OF_PP_SEQ_PRODUCT_FOR_EACH_TUPLE(MAKE_CASE_HANDLER_ENTRY, POD_DATA_TYPE_SEQ, POD_DATA_TYPE_SEQ)
           MAKE_CASE_HANDLER_ENTRY((float, DataType::kFloat), (float16, DataType::kFloat16))
           MAKE_CASE_HANDLER_ENTRY((float16, DataType::kFloat16), (float, DataType::kFloat))
+          MAKE_CASE_HANDLER_ENTRY((float, DataType::kFloat), (bfloat16, DataType::kBFloat16))
+          MAKE_CASE_HANDLER_ENTRY((bfloat16, DataType::kBFloat16), (float, DataType::kFloat))
             // clang-format on
         };
     case_handler.at(key)(ctx, src, dst);
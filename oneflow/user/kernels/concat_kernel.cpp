@@ -15,6 +15,7 @@ limitations under the License.
 */
 #include "oneflow/core/framework/framework.h"
 #include "oneflow/core/kernel/new_kernel_util.h"
+#include "oneflow/core/device/memory_copier.h"
 
 namespace oneflow {
 
@@ -23,7 +24,7 @@ namespace {
 template<DeviceType device_type, typename T>
 class ConcatKernel final : public user_op::OpKernel {
  public:
-  ConcatKernel() = default;
+  ConcatKernel() : memory_copier_(NewDefaultMemoryCopier(device_type)) {}
   ~ConcatKernel() = default;
 
  private:
@@ -55,6 +56,8 @@ class ConcatKernel final : public user_op::OpKernel {
     const int64_t out_cols = out_tensor->shape().Count(axis);
     const int64_t rows = out_tensor->shape().elem_cnt() / out_cols;
     CHECK_GT(rows, 0);
+    std::vector<MemoryCopyNdDesc> descs;
+    std::vector<const void*> src;
     int64_t out_col_offset = 0;
     for (const auto& in_arg_pair : ctx->inputs()) {
       const user_op::Tensor* in_tensor =
@@ -63,16 +66,28 @@ class ConcatKernel final : public user_op::OpKernel {
       const int64_t in_cols = in_tensor->shape().Count(axis);
       CHECK_EQ(in_tensor->shape().elem_cnt(), rows * in_cols);
       if (in_cols > 0) {
-        NewKernelUtil<device_type>::CopyColsRegion(
-            ctx->device_ctx(), rows, in_cols, in_tensor->dptr<T>(), 0, in_cols,
-            out_tensor->mut_dptr<T>(), out_col_offset, out_cols);
+        MemoryCopyNdDesc desc;
+        desc.dst_shape = Shape({rows, out_cols * static_cast<int64_t>(sizeof(T))});
+        desc.src_shape = Shape({rows, in_cols * static_cast<int64_t>(sizeof(T))});
+        desc.dst_pos = NdIndex({0, out_col_offset * static_cast<int64_t>(sizeof(T))});
+        desc.src_pos = NdIndex({0, 0});
+        desc.extent = desc.src_shape;
+        desc.data_type = GetDataType<T>::value;
+        descs.push_back(desc.CreateDimReducedDesc());
+        src.push_back(in_tensor->dptr());
       }
       out_col_offset += in_cols;
     }
     CHECK_EQ(out_col_offset, out_cols);
+    std::vector<void*> dst(descs.size(), out_tensor->mut_dptr());
+    std::vector<const MemoryCopyNdDesc*> desc_ptrs;
+    for (const MemoryCopyNdDesc& desc : descs) { desc_ptrs.push_back(&desc); }
+    memory_copier_->BatchCopy(ctx->device_ctx(), dst, src, desc_ptrs);
   }
 
   bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+
+  std::unique_ptr<MemoryCopier> memory_copier_;
 };
 
 }  // namespace
@@ -21,6 +21,7 @@ limitations under the License.
 #include "oneflow/core/kernel/new_kernel_util.h"
 #include "oneflow/core/job/resource_desc.h"
 #include "oneflow/core/job/global_for.h"
+#include "oneflow/user/kernels/depthwise_conv_kernel_util.h"
 
 namespace oneflow {
 
@@ -75,6 +76,47 @@ struct CudnnConvArgsAndAlgo final {
   OF_DISALLOW_COPY_AND_MOVE(CudnnConvArgsAndAlgo);
 };
 
+bool IsDepthwiseConv2dKernelEnabled() {
+  static const bool enabled = ParseBooleanFromEnv("ONEFLOW_CONV_ENABLE_DEPTHWISE_KERNELS", true);
+  return enabled;
+}
+
+// Returns whether the conv of ctx can run on DepthwiseConv2dKernelUtil instead of cuDNN
+template<typename ContextT>
+bool GetDepthwiseConv2dParams(const ContextT& ctx, const ShapeView& x_shape,
+                              const ShapeView& w_shape, const ShapeView& y_shape,
+                              DepthwiseConv2dParams* params) {
+  if (!IsDepthwiseConv2dKernelEnabled() || x_shape.NumAxes() != 4) { return false; }
+  const bool channels_last = ctx.template Attr<std::string>("data_format") == "channels_last";
+  const int32_t channel_axis = channels_last ? 3 : 1;
+  const int64_t channels = x_shape.At(channel_axis);
+  if (ctx.template Attr<int32_t>("groups") != channels || w_shape.At(0) != channels
+      || y_shape.At(channel_axis) != channels) {
+    return false;
+  }
+  const auto& kernel_size = ctx.template Attr<std::vector<int32_t>>("kernel_size");
+  const auto& strides = ctx.template Attr<std::vector<int32_t>>("strides");
+  const auto& dilation_rate = ctx.template Attr<std::vector<int32_t>>("dilation_rate");
+  const auto& padding_before = ctx.template Attr<std::vector<int32_t>>("padding_before");
+  if (kernel_size.at(0) != kernel_size.at(1) || strides.at(0) != strides.at(1)
+      || dilation_rate.at(0) != 1 || dilation_rate.at(1) != 1) {
+    return false;
+  }
+  const int32_t h_axis = channels_last ? 1 : 2;
+  params->batch_size = x_shape.At(0);
+  params->channels = channels;
+  params->in_height = x_shape.At(h_axis);
+  params->in_width = x_shape.At(h_axis + 1);
+  params->out_height = y_shape.At(h_axis);
+  params->out_width = y_shape.At(h_axis + 1);
+  params->kernel_size = kernel_size.at(0);
+  params->stride = strides.at(0);
+  params->padding_h = padding_before.at(0);
+  params->padding_w = padding_before.at(1);
+  params->channels_last = channels_last;
+  return IsDepthwiseConv2dKernelSupported(*params);
+}
+
 template<typename PerfT>
 size_t InferTmpSizeWithCudnn(const user_op::TensorDesc* x, const user_op::TensorDesc* w,
                              const user_op::TensorDesc* y, const user_op::InferContext& ctx,
@@ -110,6 +152,20 @@ size_t InferTmpSizeWithCudnn(const user_op::TensorDesc* x, const user_op::Tensor
   return workspace_size;
 }
 
+template<typename PerfT>
+size_t InferTmpSizeWithCudnnOrDepthwise(const user_op::TensorDesc* x,
+                                        const user_op::TensorDesc* w,
+                                        const user_op::TensorDesc* y,
+                                        const user_op::InferContext& ctx, bool has_forced_algo,
+                                        int32_t forced_algo) {
+  DepthwiseConv2dParams depthwise_params;
+  if (GetDepthwiseConv2dParams(ctx, ShapeView(x->shape()), ShapeView(w->shape()),
+                               ShapeView(y->shape()), &depthwise_params)) {
+    return 1;
+  }
+  return InferTmpSizeWithCudnn<PerfT>(x, w, y, ctx, has_forced_algo, forced_algo);
+}
+
 // for 1d and 2d
 template<size_t NDims>
 CudnnTensorDesc* GetBiasCudnnTensorDesc(const std::string& data_format, int32_t filters,
@@ -171,6 +227,16 @@ class ConvGpuKernel final : public user_op::OpKernel {
     const user_op::Tensor* weight = ctx->Tensor4ArgNameAndIndex("weight", 0);
     user_op::Tensor* buf = ctx->Tensor4ArgNameAndIndex("tmp_buffer", 0);
     user_op::Tensor* out = ctx->Tensor4ArgNameAndIndex("out", 0);
+    DepthwiseConv2dParams depthwise_params;
+    if (GetDepthwiseConv2dParams(*ctx, in->shape(), weight->shape(), out->shape(),
+                                 &depthwise_params)) {
+      DepthwiseConv2dKernelUtil<T>::Forward(ctx->device_ctx(), depthwise_params, in->dptr<T>(),
+                                            weight->dptr<T>(), out->mut_dptr<T>());
+      AddBias(ctx, CudnnTensorDesc(out->data_type(), out->shape(),
+                                   ctx->Attr<std::string>("data_format")),
+              out);
+      return;
+    }
     const auto& cudnn_conf = Global<ResourceDesc, ForSession>::Get()->resource().cudnn_conf();
     CudnnConvArgsAndAlgo<cudnnConvolutionFwdAlgoPerf_t> args_and_algo(
         in, weight, out, buf, ctx, ctx->device_ctx(), cudnn_conf.has_cudnn_conv_force_fwd_algo(),
@@ -182,14 +248,18 @@ class ConvGpuKernel final : public user_op::OpKernel {
         ctx->device_ctx()->cudnn_handle(), CudnnSPOnePtr<T>(), args.xdesc.Get(), in->dptr(),
         args.wdesc.Get(), weight->dptr(), args.cdesc.Get(), algo_perf.algo, buf->mut_dptr(),
         args.params.max_ws_size, CudnnSPZeroPtr<T>(), args.ydesc.Get(), out->mut_dptr()));
+    AddBias(ctx, args.ydesc, out);
+  }
 
+  void AddBias(user_op::KernelComputeContext* ctx, const CudnnTensorDesc& out_desc,
+               user_op::Tensor* out) const {
     const user_op::Tensor* bias = ctx->Tensor4ArgNameAndIndex("bias", 0);
     if (bias != nullptr) {
       const auto& conv_state = CreateConvCudnnOpKernelState(ctx);
       CHECK_NOTNULL(conv_state.get());
       OF_CUDNN_CHECK(cudnnAddTensor(ctx->device_ctx()->cudnn_handle(), CudnnSPOnePtr<T>(),
                                     conv_state->bias_desc->Get(), bias->dptr<T>(),
-                                    CudnnSPOnePtr<T>(), args.ydesc.Get(), out->mut_dptr<T>()));
+                                    CudnnSPOnePtr<T>(), out_desc.Get(), out->mut_dptr<T>()));
     }
   }
 };
@@ -204,7 +274,7 @@ class ConvGpuKernel final : public user_op::OpKernel {
         const auto& weight = ctx->InputTensorDesc("weight", 0);                                    \
         const auto* out = ctx->OutputTensorDesc("out", 0);                                         \
         const auto& cudnn_conf = Global<ResourceDesc, ForSession>::Get()->resource().cudnn_conf(); \
-        return InferTmpSizeWithCudnn<cudnnConvolutionFwdAlgoPerf_t>(                               \
+        return InferTmpSizeWithCudnnOrDepthwise<cudnnConvolutionFwdAlgoPerf_t>(                    \
             &in, &weight, out, *ctx, cudnn_conf.has_cudnn_conv_force_fwd_algo(),                   \
             cudnn_conf.cudnn_conv_force_fwd_algo());                                               \
       })
@@ -219,6 +289,67 @@ REGISTER_CONV_KERNEL(conv1d, float16, 1);
 REGISTER_CONV_KERNEL(conv2d, float16, 2);
 REGISTER_CONV_KERNEL(conv3d, float16, 3);
 
+// relu(conv2d(in, weight) + bias [+ addend]) with one cudnnConvolutionBiasActivationForward, z is
+// the addend and is scaled by alpha2 = 0 when there is none.
+template<typename T>
+class FusedConv2dBiasAddReluGpuKernel final : public user_op::OpKernel {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(FusedConv2dBiasAddReluGpuKernel);
+  FusedConv2dBiasAddReluGpuKernel() = default;
+  ~FusedConv2dBiasAddReluGpuKernel() = default;
+
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+
+ private:
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    const user_op::Tensor* in = ctx->Tensor4ArgNameAndIndex("in", 0);
+    const user_op::Tensor* weight = ctx->Tensor4ArgNameAndIndex("weight", 0);
+    const user_op::Tensor* bias = ctx->Tensor4ArgNameAndIndex("bias", 0);
+    user_op::Tensor* buf = ctx->Tensor4ArgNameAndIndex("tmp_buffer", 0);
+    user_op::Tensor* out = ctx->Tensor4ArgNameAndIndex("out", 0);
+    const auto& cudnn_conf = Global<ResourceDesc, ForSession>::Get()->resource().cudnn_conf();
+    CudnnConvArgsAndAlgo<cudnnConvolutionFwdAlgoPerf_t> args_and_algo(
+        in, weight, out, buf, ctx, ctx->device_ctx(), cudnn_conf.has_cudnn_conv_force_fwd_algo(),
+        cudnn_conf.cudnn_conv_force_fwd_algo());
+    const CudnnConvArgs& args = args_and_algo.args;
+    const cudnnConvolutionFwdAlgoPerf_t& algo_perf = args_and_algo.algo_perf;
+
+    std::unique_ptr<CudnnTensorDesc> bias_desc(GetBiasCudnnTensorDesc<2>(
+        ctx->Attr<std::string>("data_format"), ctx->Attr<int32_t>("filters"),
+        GetDataType<T>::value));
+    CudnnActivationDesc relu_desc(CUDNN_ACTIVATION_RELU, CUDNN_PROPAGATE_NAN, 0.0);
+    const void* z = out->dptr();
+    const void* alpha2 = CudnnSPZeroPtr<T>();
+    if (ctx->has_input("addend", 0)) {
+      z = ctx->Tensor4ArgNameAndIndex("addend", 0)->dptr();
+      alpha2 = CudnnSPOnePtr<T>();
+    }
+    OF_CUDNN_CHECK(cudnnConvolutionBiasActivationForward(
+        ctx->device_ctx()->cudnn_handle(), CudnnSPOnePtr<T>(), args.xdesc.Get(), in->dptr(),
+        args.wdesc.Get(), weight->dptr(), args.cdesc.Get(), algo_perf.algo, buf->mut_dptr(),
+        args.params.max_ws_size, alpha2, args.ydesc.Get(), z, bias_desc->Get(), bias->dptr(),
+        relu_desc.Get(), args.ydesc.Get(), out->mut_dptr()));
+  }
+};
+
+#define REGISTER_FUSED_CONV2D_BIAS_ADD_RELU_KERNEL(dtype)                                          \
+  REGISTER_USER_KERNEL("fused_conv2d_bias_add_relu")                                               \
+      .SetCreateFn<FusedConv2dBiasAddReluGpuKernel<dtype>>()                                       \
+      .SetIsMatchedHob((user_op::HobDeviceTag() == "gpu")                                          \
+                       & (user_op::HobDataType("in", 0) == GetDataType<dtype>::value))             \
+      .SetInferTmpSizeFn([](user_op::InferContext* ctx) -> size_t {                                \
+        const auto& in = ctx->InputTensorDesc("in", 0);                                            \
+        const auto& weight = ctx->InputTensorDesc("weight", 0);                                    \
+        const auto* out = ctx->OutputTensorDesc("out", 0);                                         \
+        const auto& cudnn_conf = Global<ResourceDesc, ForSession>::Get()->resource().cudnn_conf(); \
+        return InferTmpSizeWithCudnn<cudnnConvolutionFwdAlgoPerf_t>(                               \
+            &in, &weight, out, *ctx, cudnn_conf.has_cudnn_conv_force_fwd_algo(),                   \
+            cudnn_conf.cudnn_conv_force_fwd_algo());                                               \
+      })
+
+REGISTER_FUSED_CONV2D_BIAS_ADD_RELU_KERNEL(float);
+REGISTER_FUSED_CONV2D_BIAS_ADD_RELU_KERNEL(float16);
+
 template<typename T>
 class ConvDataGradGpuKernel final : public user_op::OpKernel {
  public:
@@ -234,8 +365,26 @@ class ConvDataGradGpuKernel final : public user_op::OpKernel {
     const user_op::Tensor* filter = ctx->Tensor4ArgNameAndIndex("filter", 0);
     user_op::Tensor* dx = ctx->Tensor4ArgNameAndIndex("dx", 0);
     user_op::Tensor* buf = ctx->Tensor4ArgNameAndIndex("tmp_buffer", 0);
-    const auto& cudnn_conf = Global<ResourceDesc, ForSession>::Get()->resource().cudnn_conf();
 
+    const bool has_add_to_output = ctx->has_input("_add_to_output", 0);
+    if (has_add_to_output) {
+      const user_op::Tensor* add_to_output = ctx->Tensor4ArgNameAndIndex("_add_to_output", 0);
+      CHECK_EQ(add_to_output->data_type(), dx->data_type());
+      CHECK_EQ(add_to_output->shape(), dx->shape());
+      Memcpy<DeviceType::kGPU>(
+          ctx->device_ctx(), dx->mut_dptr<void>(), add_to_output->dptr<void>(),
+          add_to_output->shape().elem_cnt() * GetSizeOfDataType(add_to_output->data_type()));
+    }
+    DepthwiseConv2dParams depthwise_params;
+    if (GetDepthwiseConv2dParams(*ctx, dx->shape(), filter->shape(), dy->shape(),
+                                 &depthwise_params)) {
+      DepthwiseConv2dKernelUtil<T>::BackwardData(ctx->device_ctx(), depthwise_params,
+                                                 dy->dptr<T>(), filter->dptr<T>(),
+                                                 has_add_to_output, dx->mut_dptr<T>());
+      return;
+    }
+
+    const auto& cudnn_conf = Global<ResourceDesc, ForSession>::Get()->resource().cudnn_conf();
     CudnnConvArgsAndAlgo<cudnnConvolutionBwdDataAlgoPerf_t> args_and_algo(
         dx, filter, dy, buf, ctx, ctx->device_ctx(),
         cudnn_conf.has_cudnn_conv_force_bwd_data_algo(),
@@ -244,18 +393,7 @@ class ConvDataGradGpuKernel final : public user_op::OpKernel {
     const cudnnConvolutionBwdDataAlgoPerf_t& algo_perf = args_and_algo.algo_perf;
 
     const void* alpha = CudnnSPOnePtr<T>();
-    const void* beta;
-    if (ctx->has_input("_add_to_output", 0)) {
-      const user_op::Tensor* add_to_output = ctx->Tensor4ArgNameAndIndex("_add_to_output", 0);
-      CHECK_EQ(add_to_output->data_type(), dx->data_type());
-      CHECK_EQ(add_to_output->shape(), dx->shape());
-      Memcpy<DeviceType::kGPU>(
-          ctx->device_ctx(), dx->mut_dptr<void>(), add_to_output->dptr<void>(),
-          add_to_output->shape().elem_cnt() * GetSizeOfDataType(add_to_output->data_type()));
-      beta = CudnnSPOnePtr<T>();
-    } else {
-      beta = CudnnSPZeroPtr<T>();
-    }
+    const void* beta = has_add_to_output ? CudnnSPOnePtr<T>() : CudnnSPZeroPtr<T>();
 
     OF_CUDNN_CHECK(cudnnConvolutionBackwardData(
         ctx->device_ctx()->cudnn_handle(), alpha, args.wdesc.Get(), filter->dptr(),
@@ -274,7 +412,7 @@ class ConvDataGradGpuKernel final : public user_op::OpKernel {
         const auto& filter = ctx->InputTensorDesc("filter", 0);                                    \
         const auto* dx = ctx->TensorDesc4ArgNameAndIndex("dx", 0);                                 \
         const auto& cudnn_conf = Global<ResourceDesc, ForSession>::Get()->resource().cudnn_conf(); \
-        return InferTmpSizeWithCudnn<cudnnConvolutionBwdDataAlgoPerf_t>(                           \
+        return InferTmpSizeWithCudnnOrDepthwise<cudnnConvolutionBwdDataAlgoPerf_t>(                \
             dx, &filter, &dy, *ctx, cudnn_conf.has_cudnn_conv_force_bwd_data_algo(),               \
             cudnn_conf.cudnn_conv_force_bwd_data_algo());                                          \
       })                                                                                           \
@@ -305,6 +443,14 @@ class ConvFilterGradGpuKernel final : public user_op::OpKernel {
     const user_op::Tensor* x = ctx->Tensor4ArgNameAndIndex("x", 0);
     user_op::Tensor* filter_diff = ctx->Tensor4ArgNameAndIndex("filter_diff", 0);
     user_op::Tensor* buf = ctx->Tensor4ArgNameAndIndex("tmp_buffer", 0);
+    DepthwiseConv2dParams depthwise_params;
+    if (GetDepthwiseConv2dParams(*ctx, x->shape(), filter_diff->shape(), dy->shape(),
+                                 &depthwise_params)) {
+      DepthwiseConv2dKernelUtil<T>::BackwardFilter(ctx->device_ctx(), depthwise_params,
+                                                   x->dptr<T>(), dy->dptr<T>(),
+                                                   filter_diff->mut_dptr<T>());
+      return;
+    }
     const auto& cudnn_conf = Global<ResourceDesc, ForSession>::Get()->resource().cudnn_conf();
 
     CudnnConvArgsAndAlgo<cudnnConvolutionBwdFilterAlgoPerf_t> args_and_algo(
@@ -331,7 +477,7 @@ class ConvFilterGradGpuKernel final : public user_op::OpKernel {
         const auto& x = ctx->InputTensorDesc("x", 0);                                              \
         const auto* filter_diff = ctx->OutputTensorDesc("filter_diff", 0);                         \
         const auto& cudnn_conf = Global<ResourceDesc, ForSession>::Get()->resource().cudnn_conf(); \
-        return InferTmpSizeWithCudnn<cudnnConvolutionBwdFilterAlgoPerf_t>(                         \
+        return InferTmpSizeWithCudnnOrDepthwise<cudnnConvolutionBwdFilterAlgoPerf_t>(              \
             &x, filter_diff, &dy, *ctx, cudnn_conf.has_cudnn_conv_force_bwd_filter_algo(),         \
             cudnn_conf.cudnn_conv_force_bwd_filter_algo());                                        \
       })
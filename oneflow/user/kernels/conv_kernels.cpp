@@ -15,6 +15,7 @@ limitations under the License.
 */
 #include "oneflow/core/framework/framework.h"
 #include "oneflow/user/ops/nn_util.h"
+#include "oneflow/user/kernels/onednn_util.h"
 #include "oneflow/core/kernel/new_kernel_util.h"
 #include "oneflow/core/kernel/kernel_util.h"
 
@@ -457,7 +458,8 @@ class ConvCpuKernel final : public user_op::OpKernel {
       .SetCreateFn<ConvCpuKernel<dtype, ndims>>()                                           \
       .SetIsMatchedHob((user_op::HobDeviceTag() == "cpu")                                   \
                        & (user_op::HobAttr<int32_t>("groups") == 1)                         \
-                       & (user_op::HobDataType("in", 0) == GetDataType<dtype>::value))      \
+                       & (user_op::HobDataType("in", 0) == GetDataType<dtype>::value)       \
+                       & ~HobOneDnnConv())                                                  \
       .SetInferTmpSizeFn([](user_op::InferContext* ctx) -> size_t {                         \
         size_t tmp_buffer_size = 0;                                                         \
         const auto& out_shape = ctx->OutputTensorDesc("out", 0)->shape();                   \
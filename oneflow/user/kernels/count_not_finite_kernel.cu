@@ -16,6 +16,7 @@ limitations under the License.
 #include "oneflow/core/framework/framework.h"
 #include <cub/cub.cuh>
 #include "oneflow/core/kernel/new_kernel_util.h"
+#include "oneflow/core/cuda/reduce.cuh"
 
 namespace oneflow {
 
@@ -37,19 +38,6 @@ __device__ __inline__ int64_t AtomicAdd(int64_t* address, int64_t val) {
       atomicAdd(reinterpret_cast<CuInt64T*>(address), static_cast<CuInt64T>(val)));
 }
 
-template<typename T>
-__global__ void CountNotFiniteGpu(const int64_t n, const T* x, int64_t* y) {
-  typedef cub::BlockReduce<int64_t, kCudaThreadsNumPerBlock> BlockReduce;
-  __shared__ typename BlockReduce::TempStorage cub_reduce_tmp_storage;
-  int64_t thread_count = 0;
-  CUDA_1D_KERNEL_LOOP(i, n) {
-    if (!isfinite(x[i])) { thread_count += 1; }
-  }
-  __syncthreads();
-  int64_t block_count_sum = BlockReduce(cub_reduce_tmp_storage).Reduce(thread_count, cub::Sum());
-  if (threadIdx.x == 0) { AtomicAdd(y, block_count_sum); }
-}
-
 template<typename T, int32_t N>
 __global__ void MultiCountNotFiniteGpu(Param<T, N> param) {
   typedef cub::BlockReduce<int64_t, kCudaThreadsNumPerBlock> BlockReduce;
@@ -72,6 +60,9 @@ int GetCountNotFiniteNumBlocks(const int64_t elem_cnt) {
                   kCountNotFiniteNumBlocks);
 }
 
+// The elems of the tmp buffer of count_not_finite, which holds the partial counts of large inputs.
+constexpr int64_t kCountNotFiniteTmpElemCnt = 1024;
+
 }  // namespace
 
 template<typename T>
@@ -84,21 +75,24 @@ class CountNotFiniteGpuKernel final : public user_op::OpKernel {
   void Compute(user_op::KernelComputeContext* ctx) const override {
     const user_op::Tensor* x = ctx->Tensor4ArgNameAndIndex("x", 0);
     user_op::Tensor* y = ctx->Tensor4ArgNameAndIndex("y", 0);
-    const int64_t elem_cnt = x->shape().elem_cnt();
-    Memset<DeviceType::kGPU>(ctx->device_ctx(), y->mut_dptr<int64_t>(), 0,
-                             y->shape().elem_cnt() * sizeof(int64_t));
-    CountNotFiniteGpu<T>
-        <<<GetCountNotFiniteNumBlocks(elem_cnt), kCudaThreadsNumPerBlock, 0,
-           ctx->device_ctx()->cuda_stream()>>>(elem_cnt, x->dptr<T>(), y->mut_dptr<int64_t>());
+    user_op::Tensor* tmp_buffer = ctx->Tensor4ArgNameAndIndex("tmp_buffer", 0);
+    OF_CUDA_CHECK((cuda::reduce::OuterReduceInner<T, int64_t, int64_t>(
+        ctx->device_ctx()->cuda_stream(), 1, x->shape().elem_cnt(), 1, x->dptr<T>(),
+        y->mut_dptr<int64_t>(), tmp_buffer->mut_dptr(), kCountNotFiniteTmpElemCnt * sizeof(int64_t),
+        cuda::reduce::NotFiniteOp<T, int64_t>(), cuda::reduce::SumOp<int64_t>(), int64_t(0),
+        cuda::reduce::IdentityOp<int64_t>())));
   }
   bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
 };
 
-#define REGISTER_COUNT_NOT_FINITE_GPU_KERNEL(dtype)       \
-  REGISTER_USER_KERNEL("count_not_finite")                \
-      .SetCreateFn<CountNotFiniteGpuKernel<dtype>>()      \
-      .SetIsMatchedHob((user_op::HobDeviceTag() == "gpu") \
-                       & (user_op::HobDataType("x", 0) == GetDataType<dtype>::value));
+#define REGISTER_COUNT_NOT_FINITE_GPU_KERNEL(dtype)                                           \
+  REGISTER_USER_KERNEL("count_not_finite")                                                    \
+      .SetCreateFn<CountNotFiniteGpuKernel<dtype>>()                                          \
+      .SetIsMatchedHob((user_op::HobDeviceTag() == "gpu")                                     \
+                       & (user_op::HobDataType("x", 0) == GetDataType<dtype>::value))         \
+      .SetInferTmpSizeFn([](user_op::InferContext* ctx) {                                     \
+        return kCountNotFiniteTmpElemCnt * sizeof(int64_t);                                   \
+      });
 
 REGISTER_COUNT_NOT_FINITE_GPU_KERNEL(float)
 REGISTER_COUNT_NOT_FINITE_GPU_KERNEL(double)
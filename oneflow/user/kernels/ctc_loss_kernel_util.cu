@@ -19,6 +19,15 @@ namespace oneflow {
 
 namespace {
 
+// the default limit of dynamic shared memory per block
+constexpr size_t kMaxSharedMemBytes = 48 * 1024;
+
+template<typename T>
+size_t GetSharedMemBytes(const int64_t max_target_length) {
+  const int64_t max_num_states = 2 * max_target_length + 1;
+  return max_num_states * (2 * sizeof(T) + sizeof(int));
+}
+
 __device__ __inline__ static int get_target_prime(const int* targets_ptr, int64_t max_target_length,
                                                   int64_t b, int64_t s, int blank) {
   if (s % 2 == 0) {
@@ -29,7 +38,16 @@ __device__ __inline__ static int get_target_prime(const int* targets_ptr, int64_
   }
 }
 
-template<typename T, typename IDX>
+// the recursion of alpha and beta only reads the previous time step, with use_shared_mem the two
+// live rows and the extended target sequence stay in shared memory and the rows are only written
+// to global memory for the backward pass, otherwise every step reads the rows from global memory
+template<typename T>
+__device__ __inline__ T* GetSharedRows() {
+  extern __shared__ __align__(sizeof(double)) unsigned char shared_buf[];
+  return reinterpret_cast<T*>(shared_buf);
+}
+
+template<typename T, typename IDX, bool use_shared_mem>
 __global__ void CtcLossGpu(const T* log_probs_ptr, const int* targets_ptr,
                            const IDX* input_lengths_ptr, const IDX* target_lengths_ptr,
                            T* alpha_ptr, T* loss_ptr, NdIndexOffsetHelper<int64_t, 3> input_helper,
@@ -39,6 +57,9 @@ __global__ void CtcLossGpu(const T* log_probs_ptr, const int* targets_ptr,
   constexpr T neginf = -INFINITY;
   const int32_t bid = blockIdx.x;
   const int32_t tid = threadIdx.x;
+  const int64_t max_num_states = 2 * max_target_length + 1;
+  T* shared_rows = GetSharedRows<T>();
+  int* shared_target_primes = reinterpret_cast<int*>(shared_rows + 2 * max_num_states);
   for (int64_t b = bid; b < batch_size; b += gridDim.x) {
     if (tid == 0) {
       if (input_lengths_ptr[b] > max_input_length) __trap();
@@ -48,67 +69,77 @@ __global__ void CtcLossGpu(const T* log_probs_ptr, const int* targets_ptr,
   for (int64_t b = bid; b < batch_size; b += gridDim.x) {
     IDX input_length = input_lengths_ptr[b];
     IDX target_length = target_lengths_ptr[b];
-
-    for (IDX s = tid; s < 2 * target_length + 1; s += blockDim.x) {
-      alpha_ptr[alpha_helper.NdIndexToOffset(b, 0, s)] = neginf;
+    const IDX num_states = 2 * target_length + 1;
+    auto TargetPrime = [&](IDX s) -> int {
+      return use_shared_mem ? shared_target_primes[s]
+                            : get_target_prime(targets_ptr, max_target_length, b, s, blank);
+    };
+    if (use_shared_mem) {
+      for (IDX s = tid; s < num_states; s += blockDim.x) {
+        shared_target_primes[s] = get_target_prime(targets_ptr, max_target_length, b, s, blank);
+      }
+      __syncthreads();
     }
-    if (tid == 0) {
-      alpha_ptr[alpha_helper.NdIndexToOffset(b, 0, 0)] =
-          log_probs_ptr[input_helper.NdIndexToOffset(0, b, blank)];
-      if (target_length > 0) {
-        int target = get_target_prime(targets_ptr, max_target_length, b, 1, blank);
-        alpha_ptr[alpha_helper.NdIndexToOffset(b, 0, 1)] =
-            log_probs_ptr[input_helper.NdIndexToOffset(0, b, target)];
+
+    T* prev_row = use_shared_mem ? shared_rows : alpha_ptr + alpha_helper.NdIndexToOffset(b, 0, 0);
+    for (IDX s = tid; s < num_states; s += blockDim.x) {
+      T alpha = neginf;
+      if (s == 0) {
+        alpha = log_probs_ptr[input_helper.NdIndexToOffset(0, b, blank)];
+      } else if (s == 1) {
+        alpha = log_probs_ptr[input_helper.NdIndexToOffset(0, b, TargetPrime(1))];
       }
+      prev_row[s] = alpha;
+      if (use_shared_mem) { alpha_ptr[alpha_helper.NdIndexToOffset(b, 0, s)] = alpha; }
     }
     __syncthreads();
     for (IDX t = 1; t < input_length; t++) {
-      for (IDX s = tid; s < 2 * target_length + 1; s += blockDim.x) {
-        int current_target_prime = get_target_prime(targets_ptr, max_target_length, b, s, blank);
-        T la1 = alpha_ptr[alpha_helper.NdIndexToOffset(b, t - 1, s)];
+      T* cur_row = use_shared_mem ? shared_rows + (t % 2) * max_num_states
+                                  : alpha_ptr + alpha_helper.NdIndexToOffset(b, t, 0);
+      for (IDX s = tid; s < num_states; s += blockDim.x) {
+        int current_target_prime = TargetPrime(s);
+        T la1 = prev_row[s];
         T la2, la3, lamax = la1;
         if (s > 0) {
-          la2 = alpha_ptr[alpha_helper.NdIndexToOffset(b, t - 1, s - 1)];
+          la2 = prev_row[s - 1];
           if (la2 > lamax) lamax = la2;
         } else {
           la2 = neginf;
         }
-        if ((s > 1)
-            && (get_target_prime(targets_ptr, max_target_length, b, s - 2, blank)
-                != current_target_prime)) {
-          la3 = alpha_ptr[alpha_helper.NdIndexToOffset(b, t - 1, s - 2)];
+        if ((s > 1) && (TargetPrime(s - 2) != current_target_prime)) {
+          la3 = prev_row[s - 2];
           if (la3 > lamax) lamax = la3;
         } else {
           la3 = neginf;
         }
         if (lamax == neginf) lamax = 0;
 
-        int64_t idx_t_s = alpha_helper.NdIndexToOffset(b, t, s);
-        alpha_ptr[idx_t_s] =
-            log(exp(la1 - lamax) + exp(la2 - lamax) + exp(la3 - lamax)) + lamax
-            + log_probs_ptr[input_helper.NdIndexToOffset(t, b, current_target_prime)];
+        const T alpha = log(exp(la1 - lamax) + exp(la2 - lamax) + exp(la3 - lamax)) + lamax
+                        + log_probs_ptr[input_helper.NdIndexToOffset(t, b, current_target_prime)];
+        cur_row[s] = alpha;
+        if (use_shared_mem) { alpha_ptr[alpha_helper.NdIndexToOffset(b, t, s)] = alpha; }
       }
       __syncthreads();
+      prev_row = cur_row;
     }
     if (tid == 0) {
       if (target_length == 0) {
-        int64_t idx = alpha_helper.NdIndexToOffset(b, input_length - 1, 0);
-        loss_ptr[b] = -alpha_ptr[idx];
+        loss_ptr[b] = -prev_row[0];
       } else {
-        int64_t idx1 = alpha_helper.NdIndexToOffset(b, input_length - 1, target_length * 2);
-        int64_t idx2 = alpha_helper.NdIndexToOffset(b, input_length - 1, target_length * 2 - 1);
-        T l1 = alpha_ptr[idx1];
-        T l2 = alpha_ptr[idx2];
+        T l1 = prev_row[target_length * 2];
+        T l2 = prev_row[target_length * 2 - 1];
         T m = max(l1, l2);
         m = ((m == neginf) ? 0 : m);
         T log_likelihood = log(exp(l1 - m) + exp(l2 - m)) + m;
         loss_ptr[b] = -log_likelihood;
       }
     }
+    // the shared rows are reused by the next instance of this block
+    __syncthreads();
   }
 }
 
-template<typename T, typename IDX>
+template<typename T, typename IDX, bool use_shared_mem>
 __global__ void CtcLossGradGpu(const T* grad_out_ptr, const T* loss_ptr, const T* alpha_ptr,
                                const T* log_probs_ptr, const int* targets_ptr,
                                const IDX* input_lengths_ptr, const IDX* target_lengths_ptr,
@@ -121,10 +152,14 @@ __global__ void CtcLossGradGpu(const T* grad_out_ptr, const T* loss_ptr, const T
   constexpr T neginf = -INFINITY;
   const int32_t bid = blockIdx.x;
   const int32_t tid = threadIdx.x;
+  const int64_t max_num_states = 2 * max_target_length + 1;
+  T* shared_rows = GetSharedRows<T>();
+  int* shared_target_primes = reinterpret_cast<int*>(shared_rows + 2 * max_num_states);
 
   for (int64_t b = bid; b < batch_size; b += gridDim.x) {
     IDX input_length = input_lengths_ptr[b];
     IDX target_length = target_lengths_ptr[b];
+    const IDX num_states = 2 * target_length + 1;
     T nll = loss_ptr[b];
     if (zero_infinity && nll == INFINITY) {
       for (IDX t = tid; t < max_input_length; t += blockDim.x) {
@@ -135,50 +170,63 @@ __global__ void CtcLossGradGpu(const T* grad_out_ptr, const T* loss_ptr, const T
       __syncthreads();
       continue;
     }
+    auto TargetPrime = [&](IDX s) -> int {
+      return use_shared_mem ? shared_target_primes[s]
+                            : get_target_prime(targets_ptr, max_target_length, b, s, blank);
+    };
+    if (use_shared_mem) {
+      for (IDX s = tid; s < num_states; s += blockDim.x) {
+        shared_target_primes[s] = get_target_prime(targets_ptr, max_target_length, b, s, blank);
+      }
+      __syncthreads();
+    }
 
+    T* next_row = nullptr;
     if (input_length > 0) {
-      for (IDX s = tid; s < 2 * target_length + 1; s += blockDim.x) {
-        beta_ptr[beta_helper.NdIndexToOffset(b, input_length - 1, s)] = neginf;
-      }
-      if (tid == 0) {
-        beta_ptr[beta_helper.NdIndexToOffset(b, input_length - 1, 2 * target_length)] =
-            log_probs_ptr[input_helper.NdIndexToOffset(input_length - 1, b, blank)];
-        if (target_length > 0) {
-          int target =
-              get_target_prime(targets_ptr, max_target_length, b, 2 * target_length - 1, blank);
-          beta_ptr[beta_helper.NdIndexToOffset(b, input_length - 1, 2 * target_length - 1)] =
-              log_probs_ptr[input_helper.NdIndexToOffset(input_length - 1, b, target)];
+      next_row = use_shared_mem ? shared_rows + ((input_length - 1) % 2) * max_num_states
+                                : beta_ptr + beta_helper.NdIndexToOffset(b, input_length - 1, 0);
+      for (IDX s = tid; s < num_states; s += blockDim.x) {
+        T beta = neginf;
+        if (s == 2 * target_length) {
+          beta = log_probs_ptr[input_helper.NdIndexToOffset(input_length - 1, b, blank)];
+        } else if (s == 2 * target_length - 1) {
+          beta = log_probs_ptr[input_helper.NdIndexToOffset(input_length - 1, b, TargetPrime(s))];
+        }
+        next_row[s] = beta;
+        if (use_shared_mem) {
+          beta_ptr[beta_helper.NdIndexToOffset(b, input_length - 1, s)] = beta;
         }
       }
       __syncthreads();
     }
     for (IDX t = input_length - 2; t >= 0; t--) {
-      for (IDX s = tid; s < 2 * target_length + 1; s += blockDim.x) {
-        int current_target_prime = get_target_prime(targets_ptr, max_target_length, b, s, blank);
-        T lb1 = beta_ptr[beta_helper.NdIndexToOffset(b, t + 1, s)];
+      T* cur_row = use_shared_mem ? shared_rows + (t % 2) * max_num_states
+                                  : beta_ptr + beta_helper.NdIndexToOffset(b, t, 0);
+      for (IDX s = tid; s < num_states; s += blockDim.x) {
+        int current_target_prime = TargetPrime(s);
+        T lb1 = next_row[s];
         T lb2, lb3, lbmax = lb1;
         if (s < 2 * target_length) {
-          lb2 = beta_ptr[beta_helper.NdIndexToOffset(b, t + 1, s + 1)];
+          lb2 = next_row[s + 1];
           if (lb2 > lbmax) lbmax = lb2;
         } else {
           lb2 = neginf;
         }
-        if ((s < 2 * target_length - 1)
-            && (get_target_prime(targets_ptr, max_target_length, b, s + 2, blank)
-                != current_target_prime)) {
-          lb3 = beta_ptr[beta_helper.NdIndexToOffset(b, t + 1, s + 2)];
+        if ((s < 2 * target_length - 1) && (TargetPrime(s + 2) != current_target_prime)) {
+          lb3 = next_row[s + 2];
           if (lb3 > lbmax) lbmax = lb3;
         } else {
           lb3 = neginf;
         }
         if (lbmax == neginf) lbmax = 0;
 
-        int64_t idx_t_s = beta_helper.NdIndexToOffset(b, t, s);
-        beta_ptr[idx_t_s] =
-            log(exp(lb1 - lbmax) + exp(lb2 - lbmax) + exp(lb3 - lbmax)) + lbmax
-            + log_probs_ptr[input_helper.NdIndexToOffset(t, b, current_target_prime)];
+        const T beta = log(exp(lb1 - lbmax) + exp(lb2 - lbmax) + exp(lb3 - lbmax)) + lbmax
+                       + log_probs_ptr[input_helper.NdIndexToOffset(t, b, current_target_prime)];
+        cur_row[s] = beta;
+        if (use_shared_mem) { beta_ptr[beta_helper.NdIndexToOffset(b, t, s)] = beta; }
       }
       __syncthreads();
+      next_row = cur_row;
     }
     for (IDX t = tid; t < max_input_length; t += blockDim.x) {
       for (IDX c = 0; c < num_labels; c++) {
@@ -191,8 +239,7 @@ __global__ void CtcLossGradGpu(const T* grad_out_ptr, const T* loss_ptr, const T
           alpha_ptr[beta_helper.NdIndexToOffset(b, input_length - 1, 2 * target_length)]
           + beta_ptr[beta_helper.NdIndexToOffset(b, input_length - 1, 2 * target_length)];
       if (target_length > 0) {
-        int target =
-            get_target_prime(targets_ptr, max_target_length, b, 2 * target_length - 1, blank);
+        int target = TargetPrime(2 * target_length - 1);
         grad_ptr[input_helper.NdIndexToOffset(input_length - 1, b, target)] =
             alpha_ptr[beta_helper.NdIndexToOffset(b, input_length - 1, 2 * target_length - 1)]
             + beta_ptr[beta_helper.NdIndexToOffset(b, input_length - 1, 2 * target_length - 1)];
@@ -201,7 +248,7 @@ __global__ void CtcLossGradGpu(const T* grad_out_ptr, const T* loss_ptr, const T
     __syncthreads();
     for (IDX t = tid; t < input_length; t += blockDim.x) {
       for (IDX s = 0; (t < input_length - 1) && (s < 2 * target_length + 1); s += 1) {
-        int current_target_prime = get_target_prime(targets_ptr, max_target_length, b, s, blank);
+        int current_target_prime = TargetPrime(s);
         int64_t idx_t_s = beta_helper.NdIndexToOffset(b, t, s);
         T log_alpha_beta = alpha_ptr[idx_t_s] + beta_ptr[idx_t_s];
         T& lcab = grad_ptr[input_helper.NdIndexToOffset(t, b, current_target_prime)];
@@ -218,6 +265,8 @@ __global__ void CtcLossGradGpu(const T* grad_out_ptr, const T* loss_ptr, const T
         res = (exp(lp) - exp(res + nll - lp)) * grad_out_ptr[b];
       }
     }
+    // the shared target primes are reused by the next instance of this block
+    __syncthreads();
   }
 }
 
@@ -233,9 +282,17 @@ struct CtcLossKernelUtil<DeviceType::kGPU, T, IDX> {
                              const int64_t batch_size, const int64_t max_input_length,
                              const int64_t max_target_length, const int blank) {
     int32_t thread_num = batch_size * kCudaThreadsNumPerBlock;
-    RUN_CUDA_KERNEL((CtcLossGpu<T, IDX>), ctx, thread_num, log_probs_ptr, targets_ptr,
-                    input_lengths_ptr, target_lengths_ptr, alpha_ptr, loss_ptr, input_helper,
-                    alpha_helper, batch_size, max_input_length, max_target_length, blank);
+    const size_t shared_mem_bytes = GetSharedMemBytes<T>(max_target_length);
+    if (shared_mem_bytes <= kMaxSharedMemBytes) {
+      CtcLossGpu<T, IDX, true><<<SMBlocksNum4ThreadsNum(thread_num), kCudaThreadsNumPerBlock,
+                                 shared_mem_bytes, ctx->cuda_stream()>>>(
+          log_probs_ptr, targets_ptr, input_lengths_ptr, target_lengths_ptr, alpha_ptr, loss_ptr,
+          input_helper, alpha_helper, batch_size, max_input_length, max_target_length, blank);
+    } else {
+      RUN_CUDA_KERNEL((CtcLossGpu<T, IDX, false>), ctx, thread_num, log_probs_ptr, targets_ptr,
+                      input_lengths_ptr, target_lengths_ptr, alpha_ptr, loss_ptr, input_helper,
+                      alpha_helper, batch_size, max_input_length, max_target_length, blank);
+    }
   }
 
   static void CtcLossBackward(DeviceCtx* ctx, const T* grad_out_ptr, const T* loss_ptr,
@@ -248,10 +305,19 @@ struct CtcLossKernelUtil<DeviceType::kGPU, T, IDX> {
                               const int64_t max_target_length, const int64_t num_labels,
                               const int blank, const bool zero_infinity) {
     int32_t thread_num = batch_size * kCudaThreadsNumPerBlock;
-    RUN_CUDA_KERNEL((CtcLossGradGpu<T, IDX>), ctx, thread_num, grad_out_ptr, loss_ptr, alpha_ptr,
-                    log_probs_ptr, targets_ptr, input_lengths_ptr, target_lengths_ptr, beta_ptr,
-                    grad_ptr, input_helper, beta_helper, batch_size, max_input_length,
-                    max_target_length, num_labels, blank, zero_infinity);
+    const size_t shared_mem_bytes = GetSharedMemBytes<T>(max_target_length);
+    if (shared_mem_bytes <= kMaxSharedMemBytes) {
+      CtcLossGradGpu<T, IDX, true><<<SMBlocksNum4ThreadsNum(thread_num), kCudaThreadsNumPerBlock,
+                                     shared_mem_bytes, ctx->cuda_stream()>>>(
+          grad_out_ptr, loss_ptr, alpha_ptr, log_probs_ptr, targets_ptr, input_lengths_ptr,
+          target_lengths_ptr, beta_ptr, grad_ptr, input_helper, beta_helper, batch_size,
+          max_input_length, max_target_length, num_labels, blank, zero_infinity);
+    } else {
+      RUN_CUDA_KERNEL((CtcLossGradGpu<T, IDX, false>), ctx, thread_num, grad_out_ptr, loss_ptr,
+                      alpha_ptr, log_probs_ptr, targets_ptr, input_lengths_ptr, target_lengths_ptr,
+                      beta_ptr, grad_ptr, input_helper, beta_helper, batch_size, max_input_length,
+                      max_target_length, num_labels, blank, zero_infinity);
+    }
   }
 };
 
@@ -0,0 +1,284 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/user/kernels/depthwise_conv_kernel_util.h"
+#include <cub/cub.cuh>
+
+namespace oneflow {
+
+namespace {
+
+template<typename T>
+struct DepthwiseConvTypes {
+  using DeviceT = T;
+  using ComputeT = T;
+};
+
+template<>
+struct DepthwiseConvTypes<float16> {
+  using DeviceT = half;
+  using ComputeT = float;
+};
+
+template<bool kChannelsLast>
+__device__ __forceinline__ void DecodeIndex(int32_t index, const int32_t channels,
+                                            const int32_t height, const int32_t width, int32_t* n,
+                                            int32_t* c, int32_t* h, int32_t* w) {
+  if (kChannelsLast) {
+    *c = index % channels;
+    index /= channels;
+    *w = index % width;
+    index /= width;
+    *h = index % height;
+    *n = index / height;
+  } else {
+    *w = index % width;
+    index /= width;
+    *h = index % height;
+    index /= height;
+    *c = index % channels;
+    *n = index / channels;
+  }
+}
+
+template<bool kChannelsLast>
+__device__ __forceinline__ int32_t EncodeIndex(const int32_t n, const int32_t c, const int32_t h,
+                                               const int32_t w, const int32_t channels,
+                                               const int32_t height, const int32_t width) {
+  if (kChannelsLast) {
+    return ((n * height + h) * width + w) * channels + c;
+  } else {
+    return ((n * channels + c) * height + h) * width + w;
+  }
+}
+
+template<typename T, typename ComputeT, int32_t kKernelSize, bool kChannelsLast>
+__global__ void DepthwiseConv2dForwardGpu(const DepthwiseConv2dParams params,
+                                          const int32_t elem_cnt, const T* x, const T* filter,
+                                          T* y) {
+  CUDA_1D_KERNEL_LOOP_T(int32_t, i, elem_cnt) {
+    int32_t n, c, oh, ow;
+    DecodeIndex<kChannelsLast>(i, params.channels, params.out_height, params.out_width, &n, &c,
+                               &oh, &ow);
+    const T* channel_filter = filter + c * kKernelSize * kKernelSize;
+    ComputeT sum = 0;
+#pragma unroll
+    for (int32_t kh = 0; kh < kKernelSize; ++kh) {
+      const int32_t ih = oh * params.stride - params.padding_h + kh;
+      if (ih < 0 || ih >= params.in_height) { continue; }
+#pragma unroll
+      for (int32_t kw = 0; kw < kKernelSize; ++kw) {
+        const int32_t iw = ow * params.stride - params.padding_w + kw;
+        if (iw < 0 || iw >= params.in_width) { continue; }
+        const int32_t x_idx = EncodeIndex<kChannelsLast>(n, c, ih, iw, params.channels,
+                                                         params.in_height, params.in_width);
+        sum += static_cast<ComputeT>(x[x_idx])
+               * static_cast<ComputeT>(channel_filter[kh * kKernelSize + kw]);
+      }
+    }
+    y[i] = static_cast<T>(sum);
+  }
+}
+
+template<typename T, typename ComputeT, int32_t kKernelSize, bool kChannelsLast>
+__global__ void DepthwiseConv2dBackwardDataGpu(const DepthwiseConv2dParams params,
+                                               const int32_t elem_cnt, const T* dy,
+                                               const T* filter, const bool accumulate, T* dx) {
+  CUDA_1D_KERNEL_LOOP_T(int32_t, i, elem_cnt) {
+    int32_t n, c, ih, iw;
+    DecodeIndex<kChannelsLast>(i, params.channels, params.in_height, params.in_width, &n, &c, &ih,
+                               &iw);
+    const T* channel_filter = filter + c * kKernelSize * kKernelSize;
+    ComputeT sum = 0;
+#pragma unroll
+    for (int32_t kh = 0; kh < kKernelSize; ++kh) {
+      const int32_t strided_oh = ih + params.padding_h - kh;
+      if (strided_oh < 0 || strided_oh % params.stride != 0) { continue; }
+      const int32_t oh = strided_oh / params.stride;
+      if (oh >= params.out_height) { continue; }
+#pragma unroll
+      for (int32_t kw = 0; kw < kKernelSize; ++kw) {
+        const int32_t strided_ow = iw + params.padding_w - kw;
+        if (strided_ow < 0 || strided_ow % params.stride != 0) { continue; }
+        const int32_t ow = strided_ow / params.stride;
+        if (ow >= params.out_width) { continue; }
+        const int32_t dy_idx = EncodeIndex<kChannelsLast>(n, c, oh, ow, params.channels,
+                                                          params.out_height, params.out_width);
+        sum += static_cast<ComputeT>(dy[dy_idx])
+               * static_cast<ComputeT>(channel_filter[kh * kKernelSize + kw]);
+      }
+    }
+    if (accumulate) { sum += static_cast<ComputeT>(dx[i]); }
+    dx[i] = static_cast<T>(sum);
+  }
+}
+
+template<typename T, typename ComputeT, int32_t kKernelSize, bool kChannelsLast>
+__global__ void DepthwiseConv2dBackwardFilterGpu(const DepthwiseConv2dParams params, const T* x,
+                                                 const T* dy, T* filter_diff) {
+  typedef cub::BlockReduce<ComputeT, kCudaThreadsNumPerBlock> BlockReduce;
+  __shared__ typename BlockReduce::TempStorage cub_reduce_tmp_storage;
+  constexpr int32_t kFilterSize = kKernelSize * kKernelSize;
+  const int32_t num_filter_elems = params.channels * kFilterSize;
+  const int32_t num_dy_per_channel = params.batch_size * params.out_height * params.out_width;
+  for (int32_t filter_idx = blockIdx.x; filter_idx < num_filter_elems; filter_idx += gridDim.x) {
+    const int32_t c = filter_idx / kFilterSize;
+    const int32_t kh = (filter_idx - c * kFilterSize) / kKernelSize;
+    const int32_t kw = filter_idx - c * kFilterSize - kh * kKernelSize;
+    ComputeT sum = 0;
+    for (int32_t j = threadIdx.x; j < num_dy_per_channel; j += blockDim.x) {
+      const int32_t ow = j % params.out_width;
+      const int32_t oh = (j / params.out_width) % params.out_height;
+      const int32_t n = j / (params.out_width * params.out_height);
+      const int32_t ih = oh * params.stride - params.padding_h + kh;
+      const int32_t iw = ow * params.stride - params.padding_w + kw;
+      if (ih < 0 || ih >= params.in_height || iw < 0 || iw >= params.in_width) { continue; }
+      const int32_t x_idx = EncodeIndex<kChannelsLast>(n, c, ih, iw, params.channels,
+                                                       params.in_height, params.in_width);
+      const int32_t dy_idx = EncodeIndex<kChannelsLast>(n, c, oh, ow, params.channels,
+                                                        params.out_height, params.out_width);
+      sum += static_cast<ComputeT>(x[x_idx]) * static_cast<ComputeT>(dy[dy_idx]);
+    }
+    const ComputeT filter_sum = BlockReduce(cub_reduce_tmp_storage).Sum(sum);
+    if (threadIdx.x == 0) { filter_diff[filter_idx] = static_cast<T>(filter_sum); }
+    __syncthreads();
+  }
+}
+
+// Runs functor.template Launch<kKernelSize, kChannelsLast>() for the shape of params
+template<typename Functor>
+void DispatchDepthwiseConv2d(const DepthwiseConv2dParams& params, const Functor& functor) {
+  CHECK(IsDepthwiseConv2dKernelSupported(params));
+  if (params.kernel_size == 3) {
+    if (params.channels_last) {
+      functor.template Launch<3, true>();
+    } else {
+      functor.template Launch<3, false>();
+    }
+  } else {
+    if (params.channels_last) {
+      functor.template Launch<5, true>();
+    } else {
+      functor.template Launch<5, false>();
+    }
+  }
+}
+
+int32_t InElemCnt(const DepthwiseConv2dParams& params) {
+  const int64_t elem_cnt = static_cast<int64_t>(params.batch_size) * params.channels
+                           * params.in_height * params.in_width;
+  CHECK_LE(elem_cnt, GetMaxVal<int32_t>());
+  return elem_cnt;
+}
+
+int32_t OutElemCnt(const DepthwiseConv2dParams& params) {
+  const int64_t elem_cnt = static_cast<int64_t>(params.batch_size) * params.channels
+                           * params.out_height * params.out_width;
+  CHECK_LE(elem_cnt, GetMaxVal<int32_t>());
+  return elem_cnt;
+}
+
+template<typename T, typename ComputeT>
+struct ForwardFunctor {
+  DeviceCtx* ctx;
+  const DepthwiseConv2dParams& params;
+  const T* x;
+  const T* filter;
+  T* y;
+  template<int32_t kKernelSize, bool kChannelsLast>
+  void Launch() const {
+    const int32_t elem_cnt = OutElemCnt(params);
+    RUN_CUDA_KERNEL((DepthwiseConv2dForwardGpu<T, ComputeT, kKernelSize, kChannelsLast>), ctx,
+                    elem_cnt, params, elem_cnt, x, filter, y);
+  }
+};
+
+template<typename T, typename ComputeT>
+struct BackwardDataFunctor {
+  DeviceCtx* ctx;
+  const DepthwiseConv2dParams& params;
+  const T* dy;
+  const T* filter;
+  bool accumulate;
+  T* dx;
+  template<int32_t kKernelSize, bool kChannelsLast>
+  void Launch() const {
+    const int32_t elem_cnt = InElemCnt(params);
+    RUN_CUDA_KERNEL((DepthwiseConv2dBackwardDataGpu<T, ComputeT, kKernelSize, kChannelsLast>),
+                    ctx, elem_cnt, params, elem_cnt, dy, filter, accumulate, dx);
+  }
+};
+
+template<typename T, typename ComputeT>
+struct BackwardFilterFunctor {
+  DeviceCtx* ctx;
+  const DepthwiseConv2dParams& params;
+  const T* x;
+  const T* dy;
+  T* filter_diff;
+  template<int32_t kKernelSize, bool kChannelsLast>
+  void Launch() const {
+    InElemCnt(params);
+    OutElemCnt(params);
+    const int32_t num_filter_elems = params.channels * kKernelSize * kKernelSize;
+    const int32_t num_blocks = std::min(num_filter_elems, kCudaMaxBlocksNum);
+    DepthwiseConv2dBackwardFilterGpu<T, ComputeT, kKernelSize, kChannelsLast>
+        <<<num_blocks, kCudaThreadsNumPerBlock, 0, ctx->cuda_stream()>>>(params, x, dy,
+                                                                         filter_diff);
+  }
+};
+
+}  // namespace
+
+template<typename T>
+void DepthwiseConv2dKernelUtil<T>::Forward(DeviceCtx* ctx, const DepthwiseConv2dParams& params,
+                                           const T* x, const T* filter, T* y) {
+  using DeviceT = typename DepthwiseConvTypes<T>::DeviceT;
+  using ComputeT = typename DepthwiseConvTypes<T>::ComputeT;
+  DispatchDepthwiseConv2d(
+      params, ForwardFunctor<DeviceT, ComputeT>{ctx, params, reinterpret_cast<const DeviceT*>(x),
+                                                reinterpret_cast<const DeviceT*>(filter),
+                                                reinterpret_cast<DeviceT*>(y)});
+}
+
+template<typename T>
+void DepthwiseConv2dKernelUtil<T>::BackwardData(DeviceCtx* ctx,
+                                                const DepthwiseConv2dParams& params, const T* dy,
+                                                const T* filter, bool accumulate, T* dx) {
+  using DeviceT = typename DepthwiseConvTypes<T>::DeviceT;
+  using ComputeT = typename DepthwiseConvTypes<T>::ComputeT;
+  DispatchDepthwiseConv2d(params, BackwardDataFunctor<DeviceT, ComputeT>{
+                                      ctx, params, reinterpret_cast<const DeviceT*>(dy),
+                                      reinterpret_cast<const DeviceT*>(filter), accumulate,
+                                      reinterpret_cast<DeviceT*>(dx)});
+}
+
+template<typename T>
+void DepthwiseConv2dKernelUtil<T>::BackwardFilter(DeviceCtx* ctx,
+                                                  const DepthwiseConv2dParams& params, const T* x,
+                                                  const T* dy, T* filter_diff) {
+  using DeviceT = typename DepthwiseConvTypes<T>::DeviceT;
+  using ComputeT = typename DepthwiseConvTypes<T>::ComputeT;
+  DispatchDepthwiseConv2d(params, BackwardFilterFunctor<DeviceT, ComputeT>{
+                                      ctx, params, reinterpret_cast<const DeviceT*>(x),
+                                      reinterpret_cast<const DeviceT*>(dy),
+                                      reinterpret_cast<DeviceT*>(filter_diff)});
+}
+
+template struct DepthwiseConv2dKernelUtil<float>;
+template struct DepthwiseConv2dKernelUtil<double>;
+template struct DepthwiseConv2dKernelUtil<float16>;
+
+}  // namespace oneflow
@@ -0,0 +1,61 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_USER_KERNELS_DEPTHWISE_CONV_KERNEL_UTIL_H_
+#define ONEFLOW_USER_KERNELS_DEPTHWISE_CONV_KERNEL_UTIL_H_
+
+#include "oneflow/core/kernel/kernel_util.h"
+
+namespace oneflow {
+
+// A 2d convolution whose every output channel reads exactly one input channel, i.e. groups ==
+// in_channels == out_channels. The filter is laid out as (channels, kernel_size, kernel_size) for
+// both data formats.
+struct DepthwiseConv2dParams {
+  int32_t batch_size;
+  int32_t channels;
+  int32_t in_height;
+  int32_t in_width;
+  int32_t out_height;
+  int32_t out_width;
+  int32_t kernel_size;
+  int32_t stride;
+  int32_t padding_h;
+  int32_t padding_w;
+  bool channels_last;
+};
+
+// cuDNN is slow for depthwise convolutions, these kernels cover the common square filters of
+// MobileNet style networks, see IsDepthwiseConv2dKernelSupported
+template<typename T>
+struct DepthwiseConv2dKernelUtil final {
+  static void Forward(DeviceCtx* ctx, const DepthwiseConv2dParams& params, const T* x,
+                      const T* filter, T* y);
+  // adds to dx instead of overwriting it when accumulate is true
+  static void BackwardData(DeviceCtx* ctx, const DepthwiseConv2dParams& params, const T* dy,
+                           const T* filter, bool accumulate, T* dx);
+  // reduces each filter element in a block of its own, the result does not depend on scheduling
+  static void BackwardFilter(DeviceCtx* ctx, const DepthwiseConv2dParams& params, const T* x,
+                             const T* dy, T* filter_diff);
+};
+
+inline bool IsDepthwiseConv2dKernelSupported(const DepthwiseConv2dParams& params) {
+  return (params.kernel_size == 3 || params.kernel_size == 5)
+         && (params.stride == 1 || params.stride == 2);
+}
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_USER_KERNELS_DEPTHWISE_CONV_KERNEL_UTIL_H_
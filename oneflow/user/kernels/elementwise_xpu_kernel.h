@@ -30,7 +30,9 @@ template<typename FunctorT, typename OutputT, typename InputA>
 struct UnaryElemwiseXpuLauncher<DeviceType::kCPU, FunctorT, OutputT, InputA> final {
   void operator()(DeviceCtx* ctx, int64_t elem_cnt, OutputT* out, const InputA* input_a,
                   FunctorT functor) {
-    FOR_RANGE(int64_t, i, 0, elem_cnt) { out[i] = functor(input_a[i]); }
+    ctx->ParallelFor(elem_cnt, ParallelForGrainSize(1), [&](int64_t begin, int64_t end) {
+      FOR_RANGE(int64_t, i, begin, end) { out[i] = functor(input_a[i]); }
+    });
   }
 };
 
@@ -45,7 +47,9 @@ template<typename FunctorT, typename OutputT, typename InputA, typename InputB>
 struct BinaryElemwiseXpuLauncher<DeviceType::kCPU, FunctorT, OutputT, InputA, InputB> final {
   void operator()(DeviceCtx* ctx, int64_t elem_cnt, OutputT* out, const InputA* input_a,
                   const InputB* input_b, FunctorT functor) {
-    FOR_RANGE(int64_t, i, 0, elem_cnt) { out[i] = functor(input_a[i], input_b[i]); }
+    ctx->ParallelFor(elem_cnt, ParallelForGrainSize(1), [&](int64_t begin, int64_t end) {
+      FOR_RANGE(int64_t, i, begin, end) { out[i] = functor(input_a[i], input_b[i]); }
+    });
   }
 };
 
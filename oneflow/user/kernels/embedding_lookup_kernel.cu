@@ -0,0 +1,202 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/framework/framework.h"
+#include "oneflow/core/device/cuda_util.h"
+#include "oneflow/core/cuda/atomic.cuh"
+#include "oneflow/core/cuda/unique.cuh"
+#include "oneflow/core/kernel/new_kernel_util.h"
+#include "oneflow/core/job/parallel_distribution_util.h"
+
+namespace oneflow {
+
+namespace {
+
+constexpr cuda::unique::Flag kEmbeddingUniqueFlag =
+    cuda::unique::kOutputInverseIndices | cuda::unique::kOutputUnsorted;
+
+// The rows [lower, upper) of the logical weight are on this device.
+class EmbeddingLookupKernelState final : public user_op::OpKernelState {
+ public:
+  EmbeddingLookupKernelState(int64_t lower, int64_t upper, int64_t num_rows)
+      : lower_(lower), upper_(upper), num_rows_(num_rows) {}
+  ~EmbeddingLookupKernelState() override = default;
+
+  int64_t lower() const { return lower_; }
+  int64_t upper() const { return upper_; }
+  int64_t num_rows() const { return num_rows_; }
+
+ private:
+  const int64_t lower_;
+  const int64_t upper_;
+  const int64_t num_rows_;
+};
+
+template<typename K>
+size_t GetUniqueWorkspaceSize(int64_t num_ids) {
+  size_t workspace_size = 0;
+  OF_CUDA_CHECK((cuda::unique::GetWorkspaceSize<K, int32_t>(kEmbeddingUniqueFlag, num_ids,
+                                                            &workspace_size)));
+  return GetCudaAlignedSize(workspace_size);
+}
+
+template<typename K>
+__global__ void PadUniqueIdsGpu(int64_t num_ids, const int32_t* num_unique, K padding_id,
+                                K* unique_ids) {
+  const int32_t begin = *num_unique;
+  CUDA_1D_KERNEL_LOOP_T(int64_t, i, num_ids) {
+    if (i >= begin) { unique_ids[i] = padding_id; }
+  }
+}
+
+template<typename T, typename K>
+__global__ void EmbeddingGatherGpu(int64_t elem_cnt, int64_t embedding_size, const T* weight,
+                                   const K* ids, int64_t lower, int64_t upper, T* out) {
+  CUDA_1D_KERNEL_LOOP_T(int64_t, i, elem_cnt) {
+    const int64_t id = static_cast<int64_t>(ids[i / embedding_size]);
+    assert(id >= 0);
+    if (id >= lower && id < upper) {
+      out[i] = weight[(id - lower) * embedding_size + i % embedding_size];
+    } else {
+      out[i] = GetZeroVal<T>();
+    }
+  }
+}
+
+template<typename T>
+__global__ void EmbeddingUniqueDiffGpu(int64_t elem_cnt, int64_t embedding_size,
+                                       const T* out_diff, const int32_t* inverse_indices,
+                                       T* unique_diff) {
+  CUDA_1D_KERNEL_LOOP_T(int64_t, i, elem_cnt) {
+    const int64_t row = inverse_indices[i / embedding_size];
+    cuda::atomic::Add(unique_diff + row * embedding_size + i % embedding_size, out_diff[i]);
+  }
+}
+
+}  // namespace
+
+template<typename T, typename K>
+class EmbeddingLookupGpuKernel final : public user_op::OpKernel {
+ public:
+  EmbeddingLookupGpuKernel() = default;
+  ~EmbeddingLookupGpuKernel() override = default;
+
+  using DevT = typename DevDType<DeviceType::kGPU, T>::type;
+
+  std::shared_ptr<user_op::OpKernelState> CreateOpKernelState(
+      user_op::KernelInitContext* ctx) const override {
+    const Shape& logical_weight_shape =
+        ctx->LogicalTensorDesc4ArgNameAndIndex("weight", 0)->shape();
+    const int64_t num_rows = logical_weight_shape.At(0);
+    if (ctx->parallel_ctx().parallel_num() == 1) {
+      return std::make_shared<EmbeddingLookupKernelState>(0, num_rows, num_rows);
+    }
+    const cfg::ParallelDistribution& weight_parallel_distribution =
+        ctx->ParallelDistribution4ArgNameAndIndex("weight", 0);
+    const Shape& hierarchy = *ctx->parallel_desc().hierarchy();
+    const TensorSliceView view =
+        GetTensorSliceView4ParallelId(hierarchy, weight_parallel_distribution,
+                                      logical_weight_shape, ctx->parallel_ctx().parallel_id());
+    return std::make_shared<EmbeddingLookupKernelState>(view.At(0).begin(), view.At(0).end(),
+                                                        num_rows);
+  }
+
+ private:
+  void Compute(user_op::KernelComputeContext* ctx, user_op::OpKernelState* state) const override {
+    auto* lookup_state = dynamic_cast<EmbeddingLookupKernelState*>(state);
+    CHECK_NOTNULL(lookup_state);
+    const user_op::Tensor* weight = ctx->Tensor4ArgNameAndIndex("weight", 0);
+    const user_op::Tensor* ids = ctx->Tensor4ArgNameAndIndex("ids", 0);
+    user_op::Tensor* out = ctx->Tensor4ArgNameAndIndex("out", 0);
+    user_op::Tensor* unique_ids = ctx->Tensor4ArgNameAndIndex("unique_ids", 0);
+    user_op::Tensor* inverse_indices = ctx->Tensor4ArgNameAndIndex("inverse_indices", 0);
+    user_op::Tensor* tmp_buffer = ctx->Tensor4ArgNameAndIndex("tmp_buffer", 0);
+    CHECK_EQ(weight->shape().At(0), lookup_state->upper() - lookup_state->lower());
+    const int64_t num_ids = ids->shape().elem_cnt();
+    if (num_ids == 0) { return; }
+    const int64_t embedding_size = weight->shape().At(1);
+    const size_t workspace_size = GetUniqueWorkspaceSize<K>(num_ids);
+    CHECK_GE(tmp_buffer->shape().elem_cnt(), workspace_size + GetCudaAlignedSize(sizeof(int32_t)));
+    int32_t* num_unique =
+        reinterpret_cast<int32_t*>(tmp_buffer->mut_dptr<char>() + workspace_size);
+    cudaStream_t cuda_stream = ctx->device_ctx()->cuda_stream();
+    OF_CUDA_CHECK((cuda::unique::Launch<K, int32_t>(
+        kEmbeddingUniqueFlag, num_ids, ids->dptr<K>(), unique_ids->mut_dptr<K>(), num_unique,
+        inverse_indices->mut_dptr<int32_t>(), nullptr, tmp_buffer->mut_dptr(), workspace_size,
+        cuda_stream)));
+    RUN_CUDA_KERNEL((PadUniqueIdsGpu<K>), ctx->device_ctx(), num_ids, num_ids, num_unique,
+                    static_cast<K>(lookup_state->num_rows()), unique_ids->mut_dptr<K>());
+    const int64_t elem_cnt = out->shape().elem_cnt();
+    RUN_CUDA_KERNEL((EmbeddingGatherGpu<DevT, K>), ctx->device_ctx(), elem_cnt, elem_cnt,
+                    embedding_size, reinterpret_cast<const DevT*>(weight->dptr<T>()),
+                    ids->dptr<K>(), lookup_state->lower(), lookup_state->upper(),
+                    reinterpret_cast<DevT*>(out->mut_dptr<T>()));
+  }
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+};
+
+#define REGISTER_EMBEDDING_LOOKUP_GPU_KERNEL(weight_type, ids_type)                            \
+  REGISTER_USER_KERNEL("embedding_lookup")                                                     \
+      .SetCreateFn<EmbeddingLookupGpuKernel<OF_PP_PAIR_FIRST(weight_type),                     \
+                                            OF_PP_PAIR_FIRST(ids_type)>>()                     \
+      .SetIsMatchedHob((user_op::HobDeviceTag() == "gpu")                                      \
+                       & (user_op::HobDataType("weight", 0) == OF_PP_PAIR_SECOND(weight_type)) \
+                       & (user_op::HobDataType("ids", 0) == OF_PP_PAIR_SECOND(ids_type)))      \
+      .SetInferTmpSizeFn([](user_op::InferContext* ctx) {                                      \
+        const int64_t num_ids = ctx->InputShape("ids", 0).elem_cnt();                          \
+        return GetUniqueWorkspaceSize<OF_PP_PAIR_FIRST(ids_type)>(num_ids)                     \
+               + GetCudaAlignedSize(sizeof(int32_t));                                          \
+      });
+
+OF_PP_SEQ_PRODUCT_FOR_EACH_TUPLE(REGISTER_EMBEDDING_LOOKUP_GPU_KERNEL,
+                                 FLOATING_DATA_TYPE_SEQ FLOAT16_DATA_TYPE_SEQ, INDEX_DATA_TYPE_SEQ)
+
+template<typename T>
+class EmbeddingLookupGradGpuKernel final : public user_op::OpKernel {
+ public:
+  EmbeddingLookupGradGpuKernel() = default;
+  ~EmbeddingLookupGradGpuKernel() override = default;
+
+ private:
+  using DevT = typename DevDType<DeviceType::kGPU, T>::type;
+
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    const user_op::Tensor* out_diff = ctx->Tensor4ArgNameAndIndex("out_diff", 0);
+    const user_op::Tensor* inverse_indices = ctx->Tensor4ArgNameAndIndex("inverse_indices", 0);
+    user_op::Tensor* unique_diff = ctx->Tensor4ArgNameAndIndex("unique_diff", 0);
+    Memset<DeviceType::kGPU>(ctx->device_ctx(), unique_diff->mut_dptr(), 0,
+                             unique_diff->shape().elem_cnt() * sizeof(T));
+    const int64_t elem_cnt = out_diff->shape().elem_cnt();
+    if (elem_cnt == 0) { return; }
+    RUN_CUDA_KERNEL((EmbeddingUniqueDiffGpu<DevT>), ctx->device_ctx(), elem_cnt, elem_cnt,
+                    unique_diff->shape().At(1),
+                    reinterpret_cast<const DevT*>(out_diff->dptr<T>()),
+                    inverse_indices->dptr<int32_t>(),
+                    reinterpret_cast<DevT*>(unique_diff->mut_dptr<T>()));
+  }
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+};
+
+#define REGISTER_EMBEDDING_LOOKUP_GRAD_GPU_KERNEL(dtype)  \
+  REGISTER_USER_KERNEL("embedding_lookup_grad")           \
+      .SetCreateFn<EmbeddingLookupGradGpuKernel<dtype>>() \
+      .SetIsMatchedHob((user_op::HobDeviceTag() == "gpu") \
+                       & (user_op::HobDataType("out_diff", 0) == GetDataType<dtype>::value));
+
+REGISTER_EMBEDDING_LOOKUP_GRAD_GPU_KERNEL(float16)
+REGISTER_EMBEDDING_LOOKUP_GRAD_GPU_KERNEL(float)
+REGISTER_EMBEDDING_LOOKUP_GRAD_GPU_KERNEL(double)
+
+}  // namespace oneflow
@@ -0,0 +1,167 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/framework/framework.h"
+#include "oneflow/core/device/cublas_lt_util.h"
+#include "oneflow/core/cuda/atomic.cuh"
+#include <cub/cub.cuh>
+
+#ifdef WITH_CUBLASLT_FP8
+
+#include <cuda_fp8.h>
+
+namespace oneflow {
+
+namespace {
+
+constexpr float kFp8E4M3Max = 448.0f;
+
+// y = fp8(x * scale) and amax = max(|x|), amax must be zeroed before. The first thread also
+// writes 1 / scale, the factor that dequantizes y in the matmul.
+template<typename T>
+__global__ void QuantizeToFp8Gpu(const int64_t n, const T* x, const float* scale,
+                                 __nv_fp8_e4m3* y, float* amax, float* scale_inv) {
+  typedef cub::BlockReduce<float, kCudaThreadsNumPerBlock> BlockReduce;
+  __shared__ typename BlockReduce::TempStorage cub_reduce_tmp_storage;
+  const float scale_val = *scale;
+  if (blockIdx.x == 0 && threadIdx.x == 0) { *scale_inv = 1.0f / scale_val; }
+  float thread_amax = 0.0f;
+  CUDA_1D_KERNEL_LOOP_T(int64_t, i, n) {
+    const float x_val = static_cast<float>(x[i]);
+    thread_amax = fmaxf(thread_amax, fabsf(x_val));
+    y[i] = __nv_fp8_e4m3(x_val * scale_val);
+  }
+  const float block_amax = BlockReduce(cub_reduce_tmp_storage).Reduce(thread_amax, cub::Max());
+  if (threadIdx.x == 0) { cuda::atomic::Max(amax, block_amax); }
+}
+
+__global__ void Fp8ScaleUpdateGpu(const int64_t history_len, const int32_t margin,
+                                  const float* amax, float* amax_history, float* scale) {
+  float history_amax = *amax;
+  for (int64_t i = history_len - 1; i > 0; --i) {
+    amax_history[i] = amax_history[i - 1];
+    history_amax = fmaxf(history_amax, amax_history[i]);
+  }
+  amax_history[0] = *amax;
+  // keep the last scale until a finite and nonzero amax is seen
+  if (history_amax > 0.0f && isfinite(history_amax)) {
+    *scale = kFp8E4M3Max / history_amax / exp2f(static_cast<float>(margin));
+  }
+}
+
+struct Fp8MatmulTmpBufferLayout {
+  Fp8MatmulTmpBufferLayout(int64_t a_elem_cnt, int64_t b_elem_cnt)
+      : a_fp8_offset(GetCudaAlignedSize(kCublasLtMatmulWorkspaceSize)),
+        b_fp8_offset(a_fp8_offset + GetCudaAlignedSize(a_elem_cnt)),
+        scale_inv_offset(b_fp8_offset + GetCudaAlignedSize(b_elem_cnt)),
+        size(scale_inv_offset + GetCudaAlignedSize(2 * sizeof(float))) {}
+
+  size_t a_fp8_offset;
+  size_t b_fp8_offset;
+  size_t scale_inv_offset;
+  size_t size;
+};
+
+template<typename T>
+void QuantizeToFp8(DeviceCtx* ctx, const user_op::Tensor* x, const user_op::Tensor* scale,
+                   __nv_fp8_e4m3* y, user_op::Tensor* amax, float* scale_inv) {
+  const int64_t n = x->shape().elem_cnt();
+  Memset<DeviceType::kGPU>(ctx, amax->mut_dptr(), 0, sizeof(float));
+  QuantizeToFp8Gpu<T><<<BlocksNum4ThreadsNum(n), kCudaThreadsNumPerBlock, 0, ctx->cuda_stream()>>>(
+      n, x->dptr<T>(), scale->dptr<float>(), y, amax->mut_dptr<float>(), scale_inv);
+}
+
+template<typename T>
+class Fp8MatmulKernel final : public user_op::OpKernel {
+ public:
+  Fp8MatmulKernel() = default;
+  ~Fp8MatmulKernel() override = default;
+
+ private:
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    const user_op::Tensor* a = ctx->Tensor4ArgNameAndIndex("a", 0);
+    const user_op::Tensor* b = ctx->Tensor4ArgNameAndIndex("b", 0);
+    user_op::Tensor* out = ctx->Tensor4ArgNameAndIndex("out", 0);
+    user_op::Tensor* a_amax = ctx->Tensor4ArgNameAndIndex("a_amax", 0);
+    user_op::Tensor* b_amax = ctx->Tensor4ArgNameAndIndex("b_amax", 0);
+    user_op::Tensor* tmp_buffer = ctx->Tensor4ArgNameAndIndex("tmp_buffer", 0);
+    const int64_t m = a->shape().At(0);
+    const int64_t k = a->shape().At(1);
+    const int64_t n = b->shape().At(0);
+    const Fp8MatmulTmpBufferLayout layout(a->shape().elem_cnt(), b->shape().elem_cnt());
+    char* tmp_ptr = tmp_buffer->mut_dptr<char>();
+    auto* a_fp8 = reinterpret_cast<__nv_fp8_e4m3*>(tmp_ptr + layout.a_fp8_offset);
+    auto* b_fp8 = reinterpret_cast<__nv_fp8_e4m3*>(tmp_ptr + layout.b_fp8_offset);
+    auto* scale_inv = reinterpret_cast<float*>(tmp_ptr + layout.scale_inv_offset);
+    QuantizeToFp8<T>(ctx->device_ctx(), a, ctx->Tensor4ArgNameAndIndex("a_scale", 0), a_fp8,
+                     a_amax, scale_inv);
+    QuantizeToFp8<T>(ctx->device_ctx(), b, ctx->Tensor4ArgNameAndIndex("b_scale", 0), b_fp8,
+                     b_amax, scale_inv + 1);
+    if (out->shape().elem_cnt() == 0) { return; }
+    // out^T(n, m) = b(n, k) * a^T(k, m) in column major, the TN layout of the FP8 kernels
+    const CublasLtMatmulParams params =
+        MakeCublasLtFp8MatmulParams(GetDataType<T>::value, n, m, k, k, k, n);
+    CublasLtMatmulPointers ptrs{};
+    ptrs.a = b_fp8;
+    ptrs.b = a_fp8;
+    ptrs.d = out->mut_dptr();
+    ptrs.workspace = tmp_ptr;
+    ptrs.a_scale = scale_inv + 1;
+    ptrs.b_scale = scale_inv;
+    CublasLtMatmul(ctx->device_ctx(), params, ptrs);
+  }
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+};
+
+class Fp8ScaleUpdateKernel final : public user_op::OpKernel {
+ public:
+  Fp8ScaleUpdateKernel() = default;
+  ~Fp8ScaleUpdateKernel() override = default;
+
+ private:
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    const user_op::Tensor* amax = ctx->Tensor4ArgNameAndIndex("amax", 0);
+    user_op::Tensor* amax_history = ctx->Tensor4ArgNameAndIndex("amax_history", 0);
+    user_op::Tensor* scale = ctx->Tensor4ArgNameAndIndex("scale", 0);
+    Fp8ScaleUpdateGpu<<<1, 1, 0, ctx->device_ctx()->cuda_stream()>>>(
+        amax_history->shape().elem_cnt(), ctx->Attr<int32_t>("margin"), amax->dptr<float>(),
+        amax_history->mut_dptr<float>(), scale->mut_dptr<float>());
+  }
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return true; }
+};
+
+}  // namespace
+
+#define REGISTER_FP8_MATMUL_GPU_KERNEL(dtype)                                                \
+  REGISTER_USER_KERNEL("fp8_matmul")                                                         \
+      .SetCreateFn<Fp8MatmulKernel<dtype>>()                                                 \
+      .SetIsMatchedHob((user_op::HobDeviceTag() == "gpu")                                    \
+                       & (user_op::HobDataType("out", 0) == GetDataType<dtype>::value))      \
+      .SetInferTmpSizeFn([](user_op::InferContext* ctx) {                                    \
+        return Fp8MatmulTmpBufferLayout(ctx->InputShape("a", 0).elem_cnt(),                 \
+                                        ctx->InputShape("b", 0).elem_cnt())                 \
+            .size;                                                                           \
+      });
+
+REGISTER_FP8_MATMUL_GPU_KERNEL(float)
+REGISTER_FP8_MATMUL_GPU_KERNEL(half)
+
+REGISTER_USER_KERNEL("fp8_scale_update")
+    .SetCreateFn<Fp8ScaleUpdateKernel>()
+    .SetIsMatchedHob(user_op::HobDeviceTag() == "gpu");
+
+}  // namespace oneflow
+
+#endif  // WITH_CUBLASLT_FP8
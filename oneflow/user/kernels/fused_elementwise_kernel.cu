@@ -0,0 +1,217 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/framework/framework.h"
+#include "oneflow/core/cuda/elementwise.cuh"
+#include "oneflow/core/kernel/cuda_graph_support.h"
+#include "oneflow/user/kernels/fused_elementwise_kernel.h"
+#include "oneflow/user/kernels/math_unary_elementwise_func.h"
+
+namespace oneflow {
+
+namespace {
+
+#define FUSED_ELEMENTWISE_OP_CODE(func_prefix) OF_PP_CAT(kFusedElementwise, func_prefix)
+
+enum FusedElementwiseOpCode : int8_t {
+  kInvalidFusedElementwiseOpCode = 0,
+  kFusedElementwiseRelu,
+  kFusedElementwiseGelu,
+  kFusedElementwiseScalarAdd,
+  kFusedElementwiseScalarMul,
+  kFusedElementwiseAdd,
+  kFusedElementwiseSub,
+  kFusedElementwiseMul,
+  kFusedElementwiseDiv,
+#define MAKE_UNARY_OP_CODE(op_type_name, func_prefix) FUSED_ELEMENTWISE_OP_CODE(func_prefix),
+  OF_PP_FOR_EACH_TUPLE(MAKE_UNARY_OP_CODE, MATH_UNARY_ELEMENTWISE_FUNC_SEQ)
+#undef MAKE_UNARY_OP_CODE
+};
+
+FusedElementwiseOpCode OpCode4OpTypeName(const std::string& op_type_name) {
+  static const HashMap<std::string, FusedElementwiseOpCode> op_type_name2op_code{
+      {"sigmoid", kFusedElementwiseSigmoid},
+      {"relu", kFusedElementwiseRelu},
+      {"gelu", kFusedElementwiseGelu},
+      {"scalar_add", kFusedElementwiseScalarAdd},
+      {"scalar_mul", kFusedElementwiseScalarMul},
+      {"add_n", kFusedElementwiseAdd},
+      {"broadcast_add", kFusedElementwiseAdd},
+      {"broadcast_sub", kFusedElementwiseSub},
+      {"broadcast_mul", kFusedElementwiseMul},
+      {"multiply", kFusedElementwiseMul},
+      {"broadcast_div", kFusedElementwiseDiv},
+#define MAKE_UNARY_OP_CODE_PAIR(op_type_name, func_prefix) \
+  {op_type_name, FUSED_ELEMENTWISE_OP_CODE(func_prefix)},
+      OF_PP_FOR_EACH_TUPLE(MAKE_UNARY_OP_CODE_PAIR, MATH_UNARY_ELEMENTWISE_FUNC_SEQ)
+#undef MAKE_UNARY_OP_CODE_PAIR
+  };
+  const auto it = op_type_name2op_code.find(op_type_name);
+  CHECK(it != op_type_name2op_code.end()) << "fused_elementwise does not support " << op_type_name;
+  return it->second;
+}
+
+template<typename T>
+struct FusedElementwiseProgram {
+  int32_t step_num;
+  FusedElementwiseOpCode op_codes[kFusedElementwiseMaxStepNum];
+  int8_t operand_indices[kFusedElementwiseMaxStepNum];
+  bool chain_operand_is_rhs[kFusedElementwiseMaxStepNum];
+  T scalar_operands[kFusedElementwiseMaxStepNum];
+};
+
+template<typename T>
+OF_DEVICE_FUNC T ApplyFusedElementwiseStep(const FusedElementwiseProgram<T>& program, int32_t i,
+                                           const T x, const T* inputs) {
+  const T operand = inputs[program.operand_indices[i] < 0 ? 0 : program.operand_indices[i]];
+  const T lhs = program.chain_operand_is_rhs[i] ? operand : x;
+  const T rhs = program.chain_operand_is_rhs[i] ? x : operand;
+  switch (program.op_codes[i]) {
+#define MAKE_UNARY_CASE(op_type_name, func_prefix) \
+  case FUSED_ELEMENTWISE_OP_CODE(func_prefix):     \
+    return OF_PP_CAT(func_prefix, Functor)<T>::Forward(x);
+    OF_PP_FOR_EACH_TUPLE(MAKE_UNARY_CASE, MATH_UNARY_ELEMENTWISE_FUNC_SEQ)
+#undef MAKE_UNARY_CASE
+    case kFusedElementwiseRelu: return x > static_cast<T>(0) ? x : static_cast<T>(0);
+    case kFusedElementwiseGelu:
+      return static_cast<T>(0.5) * x * (static_cast<T>(1.0) + erf(static_cast<T>(M_SQRT1_2) * x));
+    case kFusedElementwiseScalarAdd: return x + program.scalar_operands[i];
+    case kFusedElementwiseScalarMul: return x * program.scalar_operands[i];
+    case kFusedElementwiseAdd: return lhs + rhs;
+    case kFusedElementwiseSub: return lhs - rhs;
+    case kFusedElementwiseMul: return lhs * rhs;
+    case kFusedElementwiseDiv: return lhs / rhs;
+    default: return x;
+  }
+}
+
+template<typename T, typename ComputeT>
+struct FusedElementwiseCaster {
+  static OF_DEVICE_FUNC ComputeT ToComputeType(const T x) { return static_cast<ComputeT>(x); }
+  static OF_DEVICE_FUNC T FromComputeType(const ComputeT x) { return static_cast<T>(x); }
+};
+
+template<>
+struct FusedElementwiseCaster<half, float> {
+  static __device__ float ToComputeType(const half x) { return __half2float(x); }
+  static __device__ half FromComputeType(const float x) { return __float2half(x); }
+};
+
+template<typename T, typename ComputeT>
+struct FusedElementwiseFunctor {
+  using Caster = FusedElementwiseCaster<T, ComputeT>;
+  FusedElementwiseProgram<ComputeT> program;
+
+  __device__ T Run(const ComputeT* inputs) const {
+    ComputeT x = inputs[0];
+    for (int32_t i = 0; i < program.step_num; ++i) {
+      x = ApplyFusedElementwiseStep<ComputeT>(program, i, x, inputs);
+    }
+    return Caster::FromComputeType(x);
+  }
+  __device__ T operator()(T in_0) const {
+    const ComputeT inputs[1] = {Caster::ToComputeType(in_0)};
+    return Run(inputs);
+  }
+  __device__ T operator()(T in_0, T in_1) const {
+    const ComputeT inputs[2] = {Caster::ToComputeType(in_0), Caster::ToComputeType(in_1)};
+    return Run(inputs);
+  }
+  __device__ T operator()(T in_0, T in_1, T in_2) const {
+    const ComputeT inputs[3] = {Caster::ToComputeType(in_0), Caster::ToComputeType(in_1),
+                                Caster::ToComputeType(in_2)};
+    return Run(inputs);
+  }
+};
+
+// The program is decoded from the op attrs once per kernel and reused by every launch.
+template<typename ComputeT>
+class FusedElementwiseKernelState final : public user_op::OpKernelState {
+ public:
+  explicit FusedElementwiseKernelState(user_op::KernelInitContext* ctx) {
+    const auto& op_type_names = ctx->Attr<std::vector<std::string>>("op_type_names");
+    const auto& operand_indices = ctx->Attr<std::vector<int32_t>>("operand_indices");
+    const auto& chain_operand_is_rhs = ctx->Attr<std::vector<int32_t>>("chain_operand_is_rhs");
+    const auto& scalar_operands = ctx->Attr<std::vector<float>>("scalar_operands");
+    CHECK_LE(op_type_names.size(), kFusedElementwiseMaxStepNum);
+    program_.step_num = op_type_names.size();
+    FOR_RANGE(int32_t, i, 0, program_.step_num) {
+      program_.op_codes[i] = OpCode4OpTypeName(op_type_names.at(i));
+      program_.operand_indices[i] = static_cast<int8_t>(operand_indices.at(i));
+      program_.chain_operand_is_rhs[i] = chain_operand_is_rhs.at(i) != 0;
+      program_.scalar_operands[i] = static_cast<ComputeT>(scalar_operands.at(i));
+    }
+  }
+  ~FusedElementwiseKernelState() override = default;
+
+  const FusedElementwiseProgram<ComputeT>& program() const { return program_; }
+
+ private:
+  FusedElementwiseProgram<ComputeT> program_;
+};
+
+template<typename T, typename ComputeT>
+class FusedElementwiseGpuKernel final : public user_op::OpKernel, public user_op::CudaGraphSupport {
+ public:
+  FusedElementwiseGpuKernel() = default;
+  ~FusedElementwiseGpuKernel() override = default;
+
+  std::shared_ptr<user_op::OpKernelState> CreateOpKernelState(
+      user_op::KernelInitContext* ctx) const override {
+    return std::make_shared<FusedElementwiseKernelState<ComputeT>>(ctx);
+  }
+
+ private:
+  void Compute(user_op::KernelComputeContext* ctx, user_op::OpKernelState* state) const override {
+    const auto* program_state = dynamic_cast<FusedElementwiseKernelState<ComputeT>*>(state);
+    CHECK_NOTNULL(program_state);
+    FusedElementwiseFunctor<T, ComputeT> functor;
+    functor.program = program_state->program();
+    user_op::Tensor* out = ctx->Tensor4ArgNameAndIndex("out", 0);
+    const int64_t elem_cnt = out->shape().elem_cnt();
+    const int32_t input_size = ctx->user_op_conf().input_size("in");
+    CHECK_LE(input_size, kFusedElementwiseMaxInputNum);
+    const T* in_0 = ctx->Tensor4ArgNameAndIndex("in", 0)->dptr<T>();
+    cudaStream_t stream = ctx->device_ctx()->cuda_stream();
+    if (input_size == 1) {
+      OF_CUDA_CHECK(
+          (cuda::elementwise::Unary(functor, elem_cnt, out->mut_dptr<T>(), in_0, stream)));
+    } else if (input_size == 2) {
+      const T* in_1 = ctx->Tensor4ArgNameAndIndex("in", 1)->dptr<T>();
+      OF_CUDA_CHECK(
+          (cuda::elementwise::Binary(functor, elem_cnt, out->mut_dptr<T>(), in_0, in_1, stream)));
+    } else {
+      const T* in_1 = ctx->Tensor4ArgNameAndIndex("in", 1)->dptr<T>();
+      const T* in_2 = ctx->Tensor4ArgNameAndIndex("in", 2)->dptr<T>();
+      OF_CUDA_CHECK((cuda::elementwise::Ternary(functor, elem_cnt, out->mut_dptr<T>(), in_0, in_1,
+                                                in_2, stream)));
+    }
+  };
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+};
+
+}  // namespace
+
+#define REGISTER_FUSED_ELEMENTWISE_GPU_KERNEL(dtype, compute_type)   \
+  REGISTER_USER_KERNEL("fused_elementwise")                          \
+      .SetCreateFn<FusedElementwiseGpuKernel<dtype, compute_type>>() \
+      .SetIsMatchedHob((user_op::HobDeviceTag() == "gpu")            \
+                       & (user_op::HobDataType("out", 0) == GetDataType<dtype>::value));
+
+REGISTER_FUSED_ELEMENTWISE_GPU_KERNEL(float, float)
+REGISTER_FUSED_ELEMENTWISE_GPU_KERNEL(double, double)
+REGISTER_FUSED_ELEMENTWISE_GPU_KERNEL(half, float)
+
+}  // namespace oneflow
@@ -0,0 +1,30 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_USER_KERNELS_FUSED_ELEMENTWISE_KERNEL_H_
+#define ONEFLOW_USER_KERNELS_FUSED_ELEMENTWISE_KERNEL_H_
+
+#include "oneflow/core/common/util.h"
+
+namespace oneflow {
+
+// The program of a fused_elementwise op is passed to the cuda kernel by value, and the inputs are
+// launched through cuda::elementwise::Unary/Binary/Ternary, so both are bounded.
+constexpr int32_t kFusedElementwiseMaxStepNum = 16;
+constexpr int32_t kFusedElementwiseMaxInputNum = 3;
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_USER_KERNELS_FUSED_ELEMENTWISE_KERNEL_H_
@@ -0,0 +1,186 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/framework/framework.h"
+#include "oneflow/core/device/cublas_lt_util.h"
+#include "oneflow/core/cuda/elementwise.cuh"
+
+#ifdef WITH_CUBLASLT_EPILOGUE
+
+namespace oneflow {
+
+namespace {
+
+// cuBLASLt is column major: a row major (rows, cols) matrix is a column major (cols, rows) one, so
+// out(m, n) = a(m, k) * op(b) is computed as out^T(n, m) = op(b)^T(n, k) * a^T(k, m).
+
+// The GELU epilogues of cuBLASLt use the tanh approximation, the bias epilogue writes aux and the
+// exact gelu is applied to it.
+template<typename T>
+struct GeluFunctor {
+  __device__ T operator()(T x) const {
+    const float x_f = static_cast<float>(x);
+    return static_cast<T>(0.5f * x_f * (1.0f + erff(static_cast<float>(M_SQRT1_2) * x_f)));
+  }
+};
+
+template<typename T>
+struct GeluGradFunctor {
+  __device__ T operator()(T x, T dy) const {
+    const float x_f = static_cast<float>(x);
+    const float coef = static_cast<float>(M_2_SQRTPI * M_SQRT1_2);
+    return static_cast<T>(0.5f
+                          * (1.0f + erff(static_cast<float>(M_SQRT1_2) * x_f)
+                             + x_f * coef * expf(-0.5f * x_f * x_f))
+                          * static_cast<float>(dy));
+  }
+};
+
+template<typename T>
+struct ReluGradFunctor {
+  __device__ T operator()(T y, T dy) const {
+    return static_cast<float>(y) > 0.0f ? dy : static_cast<T>(0.0f);
+  }
+};
+
+template<typename T>
+class FusedMatmulBiasKernel final : public user_op::OpKernel {
+ public:
+  FusedMatmulBiasKernel() = default;
+  ~FusedMatmulBiasKernel() override = default;
+
+ private:
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    const user_op::Tensor* a = ctx->Tensor4ArgNameAndIndex("a", 0);
+    const user_op::Tensor* b = ctx->Tensor4ArgNameAndIndex("b", 0);
+    const user_op::Tensor* bias = ctx->Tensor4ArgNameAndIndex("bias", 0);
+    user_op::Tensor* out = ctx->Tensor4ArgNameAndIndex("out", 0);
+    user_op::Tensor* tmp_buffer = ctx->Tensor4ArgNameAndIndex("tmp_buffer", 0);
+    const bool transpose_b = ctx->Attr<bool>("transpose_b");
+    const std::string& activation = ctx->Attr<std::string>("activation");
+    const int64_t elem_cnt = out->shape().elem_cnt();
+    if (elem_cnt == 0) { return; }
+    const int64_t k = a->shape().At(a->shape().NumAxes() - 1);
+    const int64_t n = out->shape().At(out->shape().NumAxes() - 1);
+    const int64_t m = elem_cnt / n;
+    const bool is_gelu = activation == "gelu";
+    user_op::Tensor* pre_act = is_gelu ? ctx->Tensor4ArgNameAndIndex("aux", 0) : out;
+    const cublasLtEpilogue_t epilogue =
+        activation == "relu" ? CUBLASLT_EPILOGUE_RELU_BIAS : CUBLASLT_EPILOGUE_BIAS;
+    const CublasLtMatmulParams params =
+        MakeCublasLtMatmulParams(GetDataType<T>::value, transpose_b, false, n, m, k,
+                                 transpose_b ? k : n, k, n, epilogue, 0);
+    CublasLtMatmulPointers ptrs{};
+    ptrs.a = b->dptr();
+    ptrs.b = a->dptr();
+    ptrs.d = pre_act->mut_dptr();
+    ptrs.bias = const_cast<void*>(bias->dptr());
+    ptrs.workspace = tmp_buffer->mut_dptr();
+    CublasLtMatmul(ctx->device_ctx(), params, ptrs);
+    if (is_gelu) {
+      OF_CUDA_CHECK(cuda::elementwise::Unary(GeluFunctor<T>(), elem_cnt, out->mut_dptr<T>(),
+                                             pre_act->dptr<T>(),
+                                             ctx->device_ctx()->cuda_stream()));
+    }
+  }
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+};
+
+template<typename T>
+class FusedMatmulBiasGradKernel final : public user_op::OpKernel {
+ public:
+  FusedMatmulBiasGradKernel() = default;
+  ~FusedMatmulBiasGradKernel() override = default;
+
+ private:
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    const user_op::Tensor* dy = ctx->Tensor4ArgNameAndIndex("dy", 0);
+    const user_op::Tensor* a = ctx->Tensor4ArgNameAndIndex("a", 0);
+    user_op::Tensor* b_grad = ctx->Tensor4ArgNameAndIndex("b_grad", 0);
+    user_op::Tensor* bias_grad = ctx->Tensor4ArgNameAndIndex("bias_grad", 0);
+    user_op::Tensor* tmp_buffer = ctx->Tensor4ArgNameAndIndex("tmp_buffer", 0);
+    const bool transpose_b = ctx->Attr<bool>("transpose_b");
+    const std::string& activation = ctx->Attr<std::string>("activation");
+    const int64_t elem_cnt = dy->shape().elem_cnt();
+    const int64_t k = a->shape().At(a->shape().NumAxes() - 1);
+    const int64_t n = dy->shape().At(dy->shape().NumAxes() - 1);
+    const int64_t m = elem_cnt / n;
+    if (m == 0) {
+      Memset<DeviceType::kGPU>(ctx->device_ctx(), b_grad->mut_dptr(), 0,
+                               b_grad->shape().elem_cnt() * sizeof(T));
+      Memset<DeviceType::kGPU>(ctx->device_ctx(), bias_grad->mut_dptr(), 0, n * sizeof(T));
+      return;
+    }
+    const T* pre_grad_ptr = dy->dptr<T>();
+    const cudaStream_t stream = ctx->device_ctx()->cuda_stream();
+    if (activation != "none") {
+      user_op::Tensor* pre_grad = ctx->Tensor4ArgNameAndIndex("pre_grad", 0);
+      if (activation == "relu") {
+        OF_CUDA_CHECK(cuda::elementwise::Binary(
+            ReluGradFunctor<T>(), elem_cnt, pre_grad->mut_dptr<T>(),
+            ctx->Tensor4ArgNameAndIndex("out", 0)->dptr<T>(), dy->dptr<T>(), stream));
+      } else {
+        OF_CUDA_CHECK(cuda::elementwise::Binary(
+            GeluGradFunctor<T>(), elem_cnt, pre_grad->mut_dptr<T>(),
+            ctx->Tensor4ArgNameAndIndex("aux", 0)->dptr<T>(), dy->dptr<T>(), stream));
+      }
+      pre_grad_ptr = pre_grad->dptr<T>();
+    }
+    // b_grad = a^T * pre_grad, or its transpose, with the bias grad reduced from pre_grad by the
+    // epilogue: pre_grad is the column major (n, m) operand A of b_grad^T = pre_grad^T * a, or the
+    // transposed operand B of b_grad = a^T * pre_grad.
+    CublasLtMatmulParams params;
+    CublasLtMatmulPointers ptrs{};
+    if (transpose_b) {
+      params = MakeCublasLtMatmulParams(GetDataType<T>::value, false, true, k, n, m, k, n, k,
+                                        CUBLASLT_EPILOGUE_BGRADB, 0);
+      ptrs.a = a->dptr();
+      ptrs.b = pre_grad_ptr;
+    } else {
+      params = MakeCublasLtMatmulParams(GetDataType<T>::value, false, true, n, k, m, n, k, n,
+                                        CUBLASLT_EPILOGUE_BGRADA, 0);
+      ptrs.a = pre_grad_ptr;
+      ptrs.b = a->dptr();
+    }
+    ptrs.d = b_grad->mut_dptr();
+    ptrs.bias = bias_grad->mut_dptr();
+    ptrs.workspace = tmp_buffer->mut_dptr();
+    CublasLtMatmul(ctx->device_ctx(), params, ptrs);
+  }
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+};
+
+}  // namespace
+
+#define REGISTER_FUSED_MATMUL_BIAS_GPU_KERNEL(dtype)                                     \
+  REGISTER_USER_KERNEL("fused_matmul_bias")                                              \
+      .SetCreateFn<FusedMatmulBiasKernel<dtype>>()                                       \
+      .SetIsMatchedHob((user_op::HobDeviceTag() == "gpu")                                \
+                       & (user_op::HobDataType("out", 0) == GetDataType<dtype>::value))  \
+      .SetInferTmpSizeFn(                                                                \
+          [](user_op::InferContext* ctx) { return kCublasLtMatmulWorkspaceSize; });      \
+  REGISTER_USER_KERNEL("fused_matmul_bias_grad")                                         \
+      .SetCreateFn<FusedMatmulBiasGradKernel<dtype>>()                                   \
+      .SetIsMatchedHob((user_op::HobDeviceTag() == "gpu")                                \
+                       & (user_op::HobDataType("dy", 0) == GetDataType<dtype>::value))   \
+      .SetInferTmpSizeFn(                                                                \
+          [](user_op::InferContext* ctx) { return kCublasLtMatmulWorkspaceSize; });
+
+REGISTER_FUSED_MATMUL_BIAS_GPU_KERNEL(float)
+REGISTER_FUSED_MATMUL_BIAS_GPU_KERNEL(half)
+
+}  // namespace oneflow
+
+#endif  // WITH_CUBLASLT_EPILOGUE
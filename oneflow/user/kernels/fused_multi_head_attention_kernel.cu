@@ -0,0 +1,585 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/framework/framework.h"
+#include "oneflow/core/cuda/softmax.cuh"
+#include "oneflow/core/kernel/new_kernel_util.h"
+#include "oneflow/user/kernels/sequence_pack_kernel_util.h"
+
+namespace oneflow {
+
+namespace {
+
+// The score matrix is never materialized: every warp owns one row of it and walks the other
+// sequence in tiles of kTileRows rows staged in shared memory, keeping an online softmax.
+constexpr int kTileRows = 32;
+constexpr int kWarpsPerBlock = 4;
+constexpr int kMaxGridDimY = 65535;
+
+using cuda::softmax::kWarpSize;
+using cuda::softmax::MaxOp;
+using cuda::softmax::SumOp;
+using cuda::softmax::WarpAllReduce;
+
+struct AttentionParams {
+  int64_t num_heads;
+  int64_t query_len;
+  int64_t key_len;
+  int64_t head_dim;
+  float scale;
+  bool causal;
+  float dropout_rate;
+  float dropout_scale;
+  const int8_t* key_mask;
+  // (batch, num_seqs + 1) offsets of the sequences packed along the query and key axes, queries
+  // only attend to keys of their own sequence. nullptr when every batch is one sequence.
+  const int32_t* cu_seqlens;
+  int64_t num_seqs;
+};
+
+// The range [begin, end) of the sequence holding position i of the batch, which is empty for
+// the positions after the last packed sequence.
+__device__ __forceinline__ void GetSeqRange(const AttentionParams& params, int64_t batch,
+                                            int64_t i, int64_t len, int64_t* begin,
+                                            int64_t* end) {
+  if (params.cu_seqlens == nullptr) {
+    *begin = 0;
+    *end = len;
+    return;
+  }
+  const int32_t* cu_seqlens = params.cu_seqlens + batch * (params.num_seqs + 1);
+  const int64_t seq = user_op::SeqIndex4PackedToken(params.num_seqs, cu_seqlens, i);
+  *begin = cu_seqlens[seq];
+  *end = seq == params.num_seqs ? *begin : cu_seqlens[seq + 1];
+}
+
+// The positions that any of the rows [row_begin, row_end) of a block can attend to.
+__device__ __forceinline__ void GetBlockSeqRange(const AttentionParams& params, int64_t batch,
+                                                 int64_t row_begin, int64_t row_end, int64_t len,
+                                                 int64_t* begin, int64_t* end) {
+  int64_t unused = 0;
+  GetSeqRange(params, batch, row_begin, len, begin, &unused);
+  GetSeqRange(params, batch, min(row_end, len) - 1, len, &unused, end);
+}
+
+__device__ __forceinline__ bool IsMasked(const AttentionParams& params, int64_t batch, int64_t i,
+                                         int64_t j, int64_t seq_begin, int64_t seq_end) {
+  if (j < seq_begin || j >= seq_end) { return true; }
+  if (params.causal && j > i) { return true; }
+  return params.key_mask != nullptr && params.key_mask[batch * params.key_len + j] == 0;
+}
+
+// Counter based, so the backward pass regenerates the forward dropout mask from rng_state, that
+// is (seed, offset), instead of keeping a (query_len, key_len) mask around.
+__device__ __forceinline__ float DropoutScale(const AttentionParams& params, uint64_t seed,
+                                              uint64_t offset, uint64_t idx) {
+  uint64_t x = seed ^ (offset * 0x9E3779B97F4A7C15ULL) ^ (idx * 0xD6E8FEB86659FD93ULL);
+  x ^= x >> 30;
+  x *= 0xBF58476D1CE4E5B9ULL;
+  x ^= x >> 27;
+  x *= 0x94D049BB133111EBULL;
+  x ^= x >> 31;
+  const float uniform = static_cast<float>(x >> 40) * (1.0f / 16777216.0f);
+  return uniform >= params.dropout_rate ? params.dropout_scale : 0.0f;
+}
+
+template<typename T>
+__device__ void LoadTile(const T* src, int64_t row_begin, int64_t num_rows, int64_t head_dim,
+                         float scale, float* tile) {
+  const int tid = threadIdx.y * kWarpSize + threadIdx.x;
+  const int64_t tile_stride = head_dim + 1;
+  for (int64_t idx = tid; idx < kTileRows * head_dim; idx += kWarpSize * kWarpsPerBlock) {
+    const int64_t r = idx / head_dim;
+    const int64_t c = idx - r * head_dim;
+    const int64_t row = row_begin + r;
+    tile[r * tile_stride + c] =
+        row < num_rows ? static_cast<float>(src[row * head_dim + c]) * scale : 0.0f;
+  }
+}
+
+__device__ __forceinline__ float RowDot(const float* row, const float* tile_row,
+                                        int64_t head_dim) {
+  float sum = 0;
+  for (int64_t d = 0; d < head_dim; ++d) { sum += row[d] * tile_row[d]; }
+  return sum;
+}
+
+// grid: (ceil(query_len / kWarpsPerBlock), batch * num_heads), block: (kWarpSize, kWarpsPerBlock)
+template<typename T, int kMaxHeadDim>
+__global__ void FusedMultiHeadAttentionForwardGpu(AttentionParams params, uint64_t seed,
+                                                  uint64_t offset, const T* query, const T* key,
+                                                  const T* value, T* out, float* softmax_lse,
+                                                  int64_t* rng_state) {
+  constexpr int kColsPerLane = kMaxHeadDim / kWarpSize;
+  extern __shared__ float shared_buf[];
+  const int64_t head_dim = params.head_dim;
+  const int64_t tile_stride = head_dim + 1;
+  float* key_tile = shared_buf;
+  float* value_tile = key_tile + kTileRows * tile_stride;
+  const int lane = threadIdx.x;
+  const int64_t bh = blockIdx.y;
+  const int64_t batch = bh / params.num_heads;
+  const int64_t row_begin = blockIdx.x * kWarpsPerBlock;
+  const int64_t i = row_begin + threadIdx.y;
+  const bool valid_row = i < params.query_len;
+  const int64_t row = bh * params.query_len + i;
+  float* query_row = value_tile + kTileRows * tile_stride + threadIdx.y * head_dim;
+  if (valid_row) {
+    for (int64_t d = lane; d < head_dim; d += kWarpSize) {
+      query_row[d] = static_cast<float>(query[row * head_dim + d]) * params.scale;
+    }
+  }
+  if (blockIdx.x == 0 && blockIdx.y == 0 && threadIdx.y == 0 && lane == 0) {
+    rng_state[0] = static_cast<int64_t>(seed);
+    rng_state[1] = static_cast<int64_t>(offset);
+  }
+  const T* key_ptr = key + bh * params.key_len * head_dim;
+  const T* value_ptr = value + bh * params.key_len * head_dim;
+  float acc[kColsPerLane];
+#pragma unroll
+  for (int t = 0; t < kColsPerLane; ++t) { acc[t] = 0; }
+  float row_max = -INFINITY;
+  float row_sum = 0;
+  int64_t seq_begin = 0;
+  int64_t seq_end = 0;
+  if (valid_row) { GetSeqRange(params, batch, i, params.key_len, &seq_begin, &seq_end); }
+  int64_t key_begin = 0;
+  int64_t key_end = 0;
+  GetBlockSeqRange(params, batch, row_begin, row_begin + kWarpsPerBlock, params.key_len,
+                   &key_begin, &key_end);
+  if (params.causal) { key_end = min(key_end, row_begin + kWarpsPerBlock); }
+  for (int64_t tile_begin = key_begin; tile_begin < key_end; tile_begin += kTileRows) {
+    __syncthreads();
+    LoadTile(key_ptr, tile_begin, params.key_len, head_dim, 1.0f, key_tile);
+    LoadTile(value_ptr, tile_begin, params.key_len, head_dim, 1.0f, value_tile);
+    __syncthreads();
+    if (!valid_row) { continue; }
+    const int64_t j = tile_begin + lane;
+    float score = -INFINITY;
+    if (!IsMasked(params, batch, i, j, seq_begin, seq_end)) {
+      score = RowDot(query_row, key_tile + lane * tile_stride, head_dim);
+    }
+    const float new_max = max(row_max, WarpAllReduce<MaxOp, float>(score));
+    if (new_max == -INFINITY) { continue; }
+    const float p = expf(score - new_max);
+    const float correction = expf(row_max - new_max);
+    row_sum = row_sum * correction + WarpAllReduce<SumOp, float>(p);
+    row_max = new_max;
+    float dropped_p = p;
+    if (params.dropout_rate > 0) {
+      dropped_p *= DropoutScale(params, seed, offset, row * params.key_len + j);
+    }
+#pragma unroll
+    for (int t = 0; t < kColsPerLane; ++t) { acc[t] *= correction; }
+    for (int r = 0; r < kTileRows; ++r) {
+      const float p_r = __shfl_sync(0xffffffff, dropped_p, r);
+      const float* value_row = value_tile + r * tile_stride;
+#pragma unroll
+      for (int t = 0; t < kColsPerLane; ++t) {
+        const int64_t col = lane + t * kWarpSize;
+        if (col < head_dim) { acc[t] += p_r * value_row[col]; }
+      }
+    }
+  }
+  if (!valid_row) { return; }
+  const float inv_sum = row_sum > 0 ? 1.0f / row_sum : 0.0f;
+#pragma unroll
+  for (int t = 0; t < kColsPerLane; ++t) {
+    const int64_t col = lane + t * kWarpSize;
+    if (col < head_dim) { out[row * head_dim + col] = static_cast<T>(acc[t] * inv_sum); }
+  }
+  // Fully masked rows get +inf, so that the backward pass recomputes zero probabilities.
+  if (lane == 0) { softmax_lse[row] = row_sum > 0 ? row_max + logf(row_sum) : INFINITY; }
+}
+
+// delta = rowsum(out_grad * out), one warp per row.
+template<typename T>
+__global__ void ComputeOutGradDotOutGpu(int64_t num_rows, int64_t head_dim, const T* out,
+                                        const T* out_grad, float* delta) {
+  for (int64_t row = blockIdx.x * kWarpsPerBlock + threadIdx.y; row < num_rows;
+       row += gridDim.x * kWarpsPerBlock) {
+    float sum = 0;
+    for (int64_t d = threadIdx.x; d < head_dim; d += kWarpSize) {
+      sum += static_cast<float>(out[row * head_dim + d])
+             * static_cast<float>(out_grad[row * head_dim + d]);
+    }
+    sum = WarpAllReduce<SumOp, float>(sum);
+    if (threadIdx.x == 0) { delta[row] = sum; }
+  }
+}
+
+// Same walk as the forward pass, recomputing p = exp(score - lse) for every key tile.
+template<typename T, int kMaxHeadDim>
+__global__ void FusedMultiHeadAttentionQueryGradGpu(AttentionParams params, const T* query,
+                                                    const T* key, const T* value,
+                                                    const T* out_grad, const float* softmax_lse,
+                                                    const float* delta, const int64_t* rng_state,
+                                                    T* query_grad) {
+  constexpr int kColsPerLane = kMaxHeadDim / kWarpSize;
+  extern __shared__ float shared_buf[];
+  const int64_t head_dim = params.head_dim;
+  const int64_t tile_stride = head_dim + 1;
+  float* key_tile = shared_buf;
+  float* value_tile = key_tile + kTileRows * tile_stride;
+  const int lane = threadIdx.x;
+  const int64_t bh = blockIdx.y;
+  const int64_t batch = bh / params.num_heads;
+  const int64_t row_begin = blockIdx.x * kWarpsPerBlock;
+  const int64_t i = row_begin + threadIdx.y;
+  const bool valid_row = i < params.query_len;
+  const int64_t row = bh * params.query_len + i;
+  float* query_row = value_tile + kTileRows * tile_stride + threadIdx.y * head_dim;
+  float* out_grad_row = query_row + kWarpsPerBlock * head_dim;
+  const float lse = valid_row ? softmax_lse[row] : INFINITY;
+  const float row_delta = valid_row ? delta[row] : 0.0f;
+  const bool active = valid_row && lse != INFINITY;
+  if (active) {
+    for (int64_t d = lane; d < head_dim; d += kWarpSize) {
+      query_row[d] = static_cast<float>(query[row * head_dim + d]) * params.scale;
+      out_grad_row[d] = static_cast<float>(out_grad[row * head_dim + d]);
+    }
+  }
+  const uint64_t seed = static_cast<uint64_t>(rng_state[0]);
+  const uint64_t offset = static_cast<uint64_t>(rng_state[1]);
+  const T* key_ptr = key + bh * params.key_len * head_dim;
+  const T* value_ptr = value + bh * params.key_len * head_dim;
+  float acc[kColsPerLane];
+#pragma unroll
+  for (int t = 0; t < kColsPerLane; ++t) { acc[t] = 0; }
+  int64_t seq_begin = 0;
+  int64_t seq_end = 0;
+  if (valid_row) { GetSeqRange(params, batch, i, params.key_len, &seq_begin, &seq_end); }
+  int64_t key_begin = 0;
+  int64_t key_end = 0;
+  GetBlockSeqRange(params, batch, row_begin, row_begin + kWarpsPerBlock, params.key_len,
+                   &key_begin, &key_end);
+  if (params.causal) { key_end = min(key_end, row_begin + kWarpsPerBlock); }
+  for (int64_t tile_begin = key_begin; tile_begin < key_end; tile_begin += kTileRows) {
+    __syncthreads();
+    LoadTile(key_ptr, tile_begin, params.key_len, head_dim, 1.0f, key_tile);
+    LoadTile(value_ptr, tile_begin, params.key_len, head_dim, 1.0f, value_tile);
+    __syncthreads();
+    if (!active) { continue; }
+    const int64_t j = tile_begin + lane;
+    float score_grad = 0;
+    if (!IsMasked(params, batch, i, j, seq_begin, seq_end)) {
+      const float p = expf(RowDot(query_row, key_tile + lane * tile_stride, head_dim) - lse);
+      float p_grad = RowDot(out_grad_row, value_tile + lane * tile_stride, head_dim);
+      if (params.dropout_rate > 0) {
+        p_grad *= DropoutScale(params, seed, offset, row * params.key_len + j);
+      }
+      score_grad = p * (p_grad - row_delta);
+    }
+    for (int r = 0; r < kTileRows; ++r) {
+      const float score_grad_r = __shfl_sync(0xffffffff, score_grad, r);
+      const float* key_row = key_tile + r * tile_stride;
+#pragma unroll
+      for (int t = 0; t < kColsPerLane; ++t) {
+        const int64_t col = lane + t * kWarpSize;
+        if (col < head_dim) { acc[t] += score_grad_r * key_row[col]; }
+      }
+    }
+  }
+  if (!valid_row) { return; }
+#pragma unroll
+  for (int t = 0; t < kColsPerLane; ++t) {
+    const int64_t col = lane + t * kWarpSize;
+    if (col < head_dim) {
+      query_grad[row * head_dim + col] = static_cast<T>(acc[t] * params.scale);
+    }
+  }
+}
+
+// One warp per key row, walking the query tiles. Owning the key row lets key_grad and
+// value_grad be accumulated in registers without atomics.
+template<typename T, int kMaxHeadDim>
+__global__ void FusedMultiHeadAttentionKeyValueGradGpu(
+    AttentionParams params, const T* query, const T* key, const T* value, const T* out_grad,
+    const float* softmax_lse, const float* delta, const int64_t* rng_state, T* key_grad,
+    T* value_grad) {
+  constexpr int kColsPerLane = kMaxHeadDim / kWarpSize;
+  extern __shared__ float shared_buf[];
+  const int64_t head_dim = params.head_dim;
+  const int64_t tile_stride = head_dim + 1;
+  float* query_tile = shared_buf;
+  float* out_grad_tile = query_tile + kTileRows * tile_stride;
+  float* lse_tile = out_grad_tile + kTileRows * tile_stride;
+  float* delta_tile = lse_tile + kTileRows;
+  float* key_row = delta_tile + kTileRows + threadIdx.y * head_dim;
+  float* value_row = key_row + kWarpsPerBlock * head_dim;
+  const int lane = threadIdx.x;
+  const int tid = threadIdx.y * kWarpSize + lane;
+  const int64_t bh = blockIdx.y;
+  const int64_t batch = bh / params.num_heads;
+  const int64_t col_begin = blockIdx.x * kWarpsPerBlock;
+  const int64_t j = col_begin + threadIdx.y;
+  const bool valid_col = j < params.key_len;
+  int64_t seq_begin = 0;
+  int64_t seq_end = 0;
+  if (valid_col) { GetSeqRange(params, batch, j, params.query_len, &seq_begin, &seq_end); }
+  const bool active =
+      valid_col && seq_begin < seq_end
+      && (params.key_mask == nullptr || params.key_mask[batch * params.key_len + j] != 0);
+  const int64_t col = bh * params.key_len + j;
+  if (active) {
+    for (int64_t d = lane; d < head_dim; d += kWarpSize) {
+      key_row[d] = static_cast<float>(key[col * head_dim + d]);
+      value_row[d] = static_cast<float>(value[col * head_dim + d]);
+    }
+  }
+  const uint64_t seed = static_cast<uint64_t>(rng_state[0]);
+  const uint64_t offset = static_cast<uint64_t>(rng_state[1]);
+  const T* query_ptr = query + bh * params.query_len * head_dim;
+  const T* out_grad_ptr = out_grad + bh * params.query_len * head_dim;
+  float key_acc[kColsPerLane];
+  float value_acc[kColsPerLane];
+#pragma unroll
+  for (int t = 0; t < kColsPerLane; ++t) {
+    key_acc[t] = 0;
+    value_acc[t] = 0;
+  }
+  int64_t query_begin = 0;
+  int64_t query_end = 0;
+  GetBlockSeqRange(params, batch, col_begin, col_begin + kWarpsPerBlock, params.query_len,
+                   &query_begin, &query_end);
+  if (params.causal) { query_begin = max(query_begin, col_begin / kTileRows * kTileRows); }
+  for (int64_t tile_begin = query_begin; tile_begin < query_end; tile_begin += kTileRows) {
+    __syncthreads();
+    LoadTile(query_ptr, tile_begin, params.query_len, head_dim, params.scale, query_tile);
+    LoadTile(out_grad_ptr, tile_begin, params.query_len, head_dim, 1.0f, out_grad_tile);
+    if (tid < kTileRows) {
+      const int64_t i = tile_begin + tid;
+      const int64_t row = bh * params.query_len + i;
+      lse_tile[tid] = i < params.query_len ? softmax_lse[row] : INFINITY;
+      delta_tile[tid] = i < params.query_len ? delta[row] : 0.0f;
+    }
+    __syncthreads();
+    if (!active) { continue; }
+    const int64_t i = tile_begin + lane;
+    const float lse = lse_tile[lane];
+    float dropped_p = 0;
+    float score_grad = 0;
+    if (lse != INFINITY && i >= seq_begin && i < seq_end && !(params.causal && j > i)) {
+      const float p = expf(RowDot(query_tile + lane * tile_stride, key_row, head_dim) - lse);
+      const float p_grad = RowDot(out_grad_tile + lane * tile_stride, value_row, head_dim);
+      const float dropout_scale =
+          params.dropout_rate > 0
+              ? DropoutScale(params, seed, offset,
+                             (bh * params.query_len + i) * params.key_len + j)
+              : 1.0f;
+      dropped_p = p * dropout_scale;
+      score_grad = p * (p_grad * dropout_scale - delta_tile[lane]);
+    }
+    for (int r = 0; r < kTileRows; ++r) {
+      const float dropped_p_r = __shfl_sync(0xffffffff, dropped_p, r);
+      const float score_grad_r = __shfl_sync(0xffffffff, score_grad, r);
+      const float* query_tile_row = query_tile + r * tile_stride;
+      const float* out_grad_tile_row = out_grad_tile + r * tile_stride;
+#pragma unroll
+      for (int t = 0; t < kColsPerLane; ++t) {
+        const int64_t c = lane + t * kWarpSize;
+        if (c < head_dim) {
+          value_acc[t] += dropped_p_r * out_grad_tile_row[c];
+          key_acc[t] += score_grad_r * query_tile_row[c];
+        }
+      }
+    }
+  }
+  if (!valid_col) { return; }
+#pragma unroll
+  for (int t = 0; t < kColsPerLane; ++t) {
+    const int64_t c = lane + t * kWarpSize;
+    if (c < head_dim) {
+      // query_tile holds scaled queries, so key_acc is already the gradient of the raw key.
+      key_grad[col * head_dim + c] = static_cast<T>(key_acc[t]);
+      value_grad[col * head_dim + c] = static_cast<T>(value_acc[t]);
+    }
+  }
+}
+
+AttentionParams MakeAttentionParams(user_op::KernelComputeContext* ctx) {
+  const ShapeView& query_shape = ctx->Tensor4ArgNameAndIndex("query", 0)->shape();
+  const ShapeView& key_shape = ctx->Tensor4ArgNameAndIndex("key", 0)->shape();
+  AttentionParams params;
+  params.num_heads = query_shape.At(1);
+  params.query_len = query_shape.At(2);
+  params.key_len = key_shape.At(2);
+  params.head_dim = query_shape.At(3);
+  params.scale = ctx->Attr<float>("scale");
+  params.causal = ctx->Attr<bool>("causal");
+  params.dropout_rate = ctx->Attr<float>("dropout_rate");
+  params.dropout_scale = params.dropout_rate < 1.0f ? 1.0f / (1.0f - params.dropout_rate) : 0.0f;
+  params.key_mask = ctx->has_input("key_mask", 0)
+                        ? ctx->Tensor4ArgNameAndIndex("key_mask", 0)->dptr<int8_t>()
+                        : nullptr;
+  if (ctx->has_input("cu_seqlens", 0)) {
+    const user_op::Tensor* cu_seqlens = ctx->Tensor4ArgNameAndIndex("cu_seqlens", 0);
+    params.cu_seqlens = cu_seqlens->dptr<int32_t>();
+    params.num_seqs = cu_seqlens->shape().At(1) - 1;
+  } else {
+    params.cu_seqlens = nullptr;
+    params.num_seqs = 1;
+  }
+  CHECK_LE(query_shape.At(0) * params.num_heads, kMaxGridDimY);
+  return params;
+}
+
+size_t TileSharedMemSize(int64_t head_dim, int64_t num_tiles, int64_t num_rows_per_warp) {
+  return (num_tiles * kTileRows * (head_dim + 1) + num_rows_per_warp * kWarpsPerBlock * head_dim)
+         * sizeof(float);
+}
+
+dim3 AttentionGrid(int64_t seq_len, const ShapeView& query_shape) {
+  return dim3((seq_len + kWarpsPerBlock - 1) / kWarpsPerBlock,
+              query_shape.At(0) * query_shape.At(1));
+}
+
+#define DISPATCH_MAX_HEAD_DIM(head_dim, launch) \
+  if (head_dim <= 32) {                         \
+    launch(32);                                 \
+  } else if (head_dim <= 64) {                  \
+    launch(64);                                 \
+  } else if (head_dim <= 128) {                 \
+    launch(128);                                \
+  } else {                                      \
+    UNIMPLEMENTED() << "head_dim > 128";        \
+  }
+
+class FusedMultiHeadAttentionKernelState final : public user_op::OpKernelState {
+ public:
+  explicit FusedMultiHeadAttentionKernelState(int64_t seed) : seed_(seed), offset_(0) {}
+  ~FusedMultiHeadAttentionKernelState() override = default;
+
+  uint64_t seed() const { return seed_; }
+  uint64_t NextOffset() { return offset_++; }
+
+ private:
+  uint64_t seed_;
+  uint64_t offset_;
+};
+
+template<typename T>
+class FusedMultiHeadAttentionGpuKernel final : public user_op::OpKernel {
+ public:
+  FusedMultiHeadAttentionGpuKernel() = default;
+  ~FusedMultiHeadAttentionGpuKernel() override = default;
+
+  std::shared_ptr<user_op::OpKernelState> CreateOpKernelState(
+      user_op::KernelInitContext* ctx) const override {
+    return std::make_shared<FusedMultiHeadAttentionKernelState>(ctx->Attr<int64_t>("seed"));
+  }
+
+ private:
+  void Compute(user_op::KernelComputeContext* ctx, user_op::OpKernelState* state) const override {
+    auto* attention_state = dynamic_cast<FusedMultiHeadAttentionKernelState*>(state);
+    CHECK_NOTNULL(attention_state);
+    const user_op::Tensor* query = ctx->Tensor4ArgNameAndIndex("query", 0);
+    const user_op::Tensor* key = ctx->Tensor4ArgNameAndIndex("key", 0);
+    const user_op::Tensor* value = ctx->Tensor4ArgNameAndIndex("value", 0);
+    user_op::Tensor* out = ctx->Tensor4ArgNameAndIndex("out", 0);
+    user_op::Tensor* softmax_lse = ctx->Tensor4ArgNameAndIndex("softmax_lse", 0);
+    user_op::Tensor* rng_state = ctx->Tensor4ArgNameAndIndex("rng_state", 0);
+    const AttentionParams params = MakeAttentionParams(ctx);
+    const uint64_t offset = attention_state->NextOffset();
+    const dim3 grid = AttentionGrid(params.query_len, query->shape());
+    const dim3 block(kWarpSize, kWarpsPerBlock);
+    const size_t smem = TileSharedMemSize(params.head_dim, 2, 1);
+#define LAUNCH_FORWARD(max_head_dim)                                                            \
+  FusedMultiHeadAttentionForwardGpu<T, max_head_dim>                                            \
+      <<<grid, block, smem, ctx->device_ctx()->cuda_stream()>>>(                                \
+          params, attention_state->seed(), offset, query->dptr<T>(), key->dptr<T>(),           \
+          value->dptr<T>(), out->mut_dptr<T>(), softmax_lse->mut_dptr<float>(),                 \
+          rng_state->mut_dptr<int64_t>())
+    DISPATCH_MAX_HEAD_DIM(params.head_dim, LAUNCH_FORWARD);
+#undef LAUNCH_FORWARD
+  }
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+};
+
+template<typename T>
+class FusedMultiHeadAttentionGradGpuKernel final : public user_op::OpKernel {
+ public:
+  FusedMultiHeadAttentionGradGpuKernel() = default;
+  ~FusedMultiHeadAttentionGradGpuKernel() override = default;
+
+ private:
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    const user_op::Tensor* query = ctx->Tensor4ArgNameAndIndex("query", 0);
+    const user_op::Tensor* key = ctx->Tensor4ArgNameAndIndex("key", 0);
+    const user_op::Tensor* value = ctx->Tensor4ArgNameAndIndex("value", 0);
+    const user_op::Tensor* out = ctx->Tensor4ArgNameAndIndex("out", 0);
+    const user_op::Tensor* out_grad = ctx->Tensor4ArgNameAndIndex("out_grad", 0);
+    const user_op::Tensor* softmax_lse = ctx->Tensor4ArgNameAndIndex("softmax_lse", 0);
+    const user_op::Tensor* rng_state = ctx->Tensor4ArgNameAndIndex("rng_state", 0);
+    user_op::Tensor* query_grad = ctx->Tensor4ArgNameAndIndex("query_grad", 0);
+    user_op::Tensor* key_grad = ctx->Tensor4ArgNameAndIndex("key_grad", 0);
+    user_op::Tensor* value_grad = ctx->Tensor4ArgNameAndIndex("value_grad", 0);
+    user_op::Tensor* tmp_buffer = ctx->Tensor4ArgNameAndIndex("tmp_buffer", 0);
+    const AttentionParams params = MakeAttentionParams(ctx);
+    float* delta = tmp_buffer->mut_dptr<float>();
+    const int64_t num_rows = softmax_lse->shape().elem_cnt();
+    const dim3 block(kWarpSize, kWarpsPerBlock);
+    const cudaStream_t cuda_stream = ctx->device_ctx()->cuda_stream();
+    const int64_t num_blocks = std::min<int64_t>(
+        (num_rows + kWarpsPerBlock - 1) / kWarpsPerBlock, kCudaMaxBlocksNum);
+    ComputeOutGradDotOutGpu<T><<<num_blocks, block, 0, cuda_stream>>>(
+        num_rows, params.head_dim, out->dptr<T>(), out_grad->dptr<T>(), delta);
+    const dim3 query_grid = AttentionGrid(params.query_len, query->shape());
+    const dim3 key_grid = AttentionGrid(params.key_len, query->shape());
+    const size_t query_grad_smem = TileSharedMemSize(params.head_dim, 2, 2);
+    const size_t key_value_grad_smem =
+        TileSharedMemSize(params.head_dim, 2, 2) + 2 * kTileRows * sizeof(float);
+#define LAUNCH_BACKWARD(max_head_dim)                                                       \
+  FusedMultiHeadAttentionQueryGradGpu<T, max_head_dim>                                      \
+      <<<query_grid, block, query_grad_smem, cuda_stream>>>(                                \
+          params, query->dptr<T>(), key->dptr<T>(), value->dptr<T>(), out_grad->dptr<T>(), \
+          softmax_lse->dptr<float>(), delta, rng_state->dptr<int64_t>(),                    \
+          query_grad->mut_dptr<T>());                                                       \
+  FusedMultiHeadAttentionKeyValueGradGpu<T, max_head_dim>                                   \
+      <<<key_grid, block, key_value_grad_smem, cuda_stream>>>(                              \
+          params, query->dptr<T>(), key->dptr<T>(), value->dptr<T>(), out_grad->dptr<T>(), \
+          softmax_lse->dptr<float>(), delta, rng_state->dptr<int64_t>(),                    \
+          key_grad->mut_dptr<T>(), value_grad->mut_dptr<T>())
+    DISPATCH_MAX_HEAD_DIM(params.head_dim, LAUNCH_BACKWARD);
+#undef LAUNCH_BACKWARD
+  }
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+};
+
+size_t InferGradTmpBufferSize(user_op::InferContext* ctx) {
+  return ctx->InputShape("softmax_lse", 0).elem_cnt() * sizeof(float);
+}
+
+}  // namespace
+
+#define REGISTER_FUSED_MULTI_HEAD_ATTENTION_GPU_KERNEL(dtype)                \
+  REGISTER_USER_KERNEL("fused_multi_head_attention")                         \
+      .SetCreateFn<FusedMultiHeadAttentionGpuKernel<dtype>>()                \
+      .SetIsMatchedHob((user_op::HobDeviceTag() == DeviceType::kGPU)         \
+                       & (user_op::HobDataType("out", 0) == GetDataType<dtype>::value));
+
+#define REGISTER_FUSED_MULTI_HEAD_ATTENTION_GRAD_GPU_KERNEL(dtype)                            \
+  REGISTER_USER_KERNEL("fused_multi_head_attention_grad")                                     \
+      .SetCreateFn<FusedMultiHeadAttentionGradGpuKernel<dtype>>()                             \
+      .SetIsMatchedHob((user_op::HobDeviceTag() == DeviceType::kGPU)                          \
+                       & (user_op::HobDataType("query_grad", 0) == GetDataType<dtype>::value)) \
+      .SetInferTmpSizeFn(InferGradTmpBufferSize);
+
+REGISTER_FUSED_MULTI_HEAD_ATTENTION_GPU_KERNEL(float)
+REGISTER_FUSED_MULTI_HEAD_ATTENTION_GPU_KERNEL(half)
+REGISTER_FUSED_MULTI_HEAD_ATTENTION_GRAD_GPU_KERNEL(float)
+REGISTER_FUSED_MULTI_HEAD_ATTENTION_GRAD_GPU_KERNEL(half)
+
+}  // namespace oneflow
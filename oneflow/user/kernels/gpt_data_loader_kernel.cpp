@@ -84,22 +84,34 @@ class GPTDataLoader final : public OpKernelState {
   }
   ~GPTDataLoader() = default;
 
+  // cu_seqlens is optional, it receives the document offsets of the samples
   template<typename T>
-  void GetBatch(size_t iter, user_op::Tensor* tokens) const {
+  void GetBatch(size_t iter, user_op::Tensor* tokens, user_op::Tensor* cu_seqlens) const {
     const size_t sample_len = seq_len_ + label_len_;
     CHECK_EQ(tokens->shape().NumAxes(), 2);
     CHECK_EQ(tokens->shape().At(0), batch_size_);
     CHECK_EQ(tokens->shape().At(1), sample_len);
     T* dptr = tokens->mut_dptr<T>();
+    int32_t* cu_seqlens_ptr = nullptr;
+    size_t num_offsets = 0;
+    if (cu_seqlens) {
+      CHECK_EQ(cu_seqlens->shape().NumAxes(), 2);
+      CHECK_EQ(cu_seqlens->shape().At(0), batch_size_);
+      cu_seqlens_ptr = cu_seqlens->mut_dptr<int32_t>();
+      num_offsets = cu_seqlens->shape().At(1);
+    }
     for (size_t i = 0; i < batch_size_; ++i) {
       size_t sample_iter = iter * batch_size_ * num_shards_ + shard_index_ * batch_size_ + i;
       dataset_->GetSample(sample_iter, dptr + i * sample_len);
+      if (cu_seqlens_ptr) {
+        dataset_->GetSampleDocOffsets(sample_iter, cu_seqlens_ptr + i * num_offsets, num_offsets);
+      }
     }
   }
 
   template<typename T>
-  void NextBatch(user_op::Tensor* tokens) {
-    GetBatch<T>(batch_cnt_, tokens);
+  void NextBatch(user_op::Tensor* tokens, user_op::Tensor* cu_seqlens) {
+    GetBatch<T>(batch_cnt_, tokens, cu_seqlens);
     batch_cnt_ += 1;
   }
 
@@ -129,14 +141,15 @@ class GPTDataLoaderKernel final : public OpKernel {
     auto* loader = dynamic_cast<GPTDataLoader*>(state);
     user_op::Tensor* iteration_tensor = ctx->Tensor4ArgNameAndIndex("iteration", 0);
     user_op::Tensor* out_tensor = ctx->Tensor4ArgNameAndIndex("out", 0);
+    user_op::Tensor* cu_seqlens_tensor = ctx->Tensor4ArgNameAndIndex("cu_seqlens", 0);
     if (iteration_tensor) {
       CHECK_EQ(iteration_tensor->shape().elem_cnt(), 1);
       CHECK_EQ(iteration_tensor->data_type(), DataType::kInt64);
       int64_t* iter_ptr = iteration_tensor->mut_dptr<int64_t>();
-      loader->GetBatch<T>(*iter_ptr, out_tensor);
+      loader->GetBatch<T>(*iter_ptr, out_tensor, cu_seqlens_tensor);
       *iter_ptr += 1;
     } else {
-      loader->NextBatch<T>(out_tensor);
+      loader->NextBatch<T>(out_tensor, cu_seqlens_tensor);
     }
   }
   bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
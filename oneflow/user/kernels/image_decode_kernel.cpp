@@ -15,6 +15,8 @@ limitations under the License.
 */
 #include "oneflow/core/framework/framework.h"
 #include "oneflow/core/thread/thread_manager.h"
+#include "oneflow/core/device/cuda_util.h"
+#include "oneflow/core/rpc/include/global_process_ctx.h"
 #include "oneflow/user/image/image_util.h"
 #include <opencv2/opencv.hpp>
 
@@ -58,6 +60,231 @@ void DecodeImage(const TensorBuffer& raw_bytes, TensorBuffer* image_buffer,
   }
 }
 
+#if defined(WITH_CUDA) && CUDA_VERSION >= 10020
+
+int GpuDeviceMalloc(void** p, size_t s) { return (int)cudaMalloc(p, s); }
+
+int GpuDeviceFree(void* p) { return (int)cudaFree(p); }
+
+int GpuPinnedMalloc(void** p, size_t s, unsigned int flags) {
+  return (int)cudaHostAlloc(p, s, flags);
+}
+
+int GpuPinnedFree(void* p) { return (int)cudaFreeHost(p); }
+
+// Decodes the JPEGs of a batch with the nvJPEG batched API, on the hardware JPEG decoder of A100
+// when it takes the image and on the hybrid backend otherwise. Images that nvJPEG cannot parse
+// or that are too small to be worth the transfers are left to the CPU decoder, which runs while
+// the GPU decodes the rest.
+class NvjpegImageDecoder final : public user_op::OpKernelState {
+ public:
+  OF_DISALLOW_COPY_AND_MOVE(NvjpegImageDecoder);
+  NvjpegImageDecoder(int dev, int64_t min_pixels);
+  ~NvjpegImageDecoder() override;
+
+  void Decode(const TensorBuffer* in, TensorBuffer* out, int64_t n, const std::string& color_space,
+              DataType data_type);
+
+ private:
+  struct Image {
+    int64_t index;
+    int width;
+    int height;
+    size_t offset;
+  };
+
+  struct Backend {
+    nvjpegHandle_t handle = nullptr;
+    nvjpegJpegState_t state = nullptr;
+    int batch_size = 0;
+    nvjpegOutputFormat_t format = NVJPEG_OUTPUT_FORMAT_MAX;
+    std::vector<Image> images;
+  };
+
+  void CreateBackend(nvjpegBackend_t backend_type, Backend* backend);
+  void DestroyBackend(Backend* backend);
+  void LaunchBatch(const TensorBuffer* in, nvjpegOutputFormat_t format, int channels,
+                   Backend* backend);
+  void ReserveBuffers(size_t size);
+
+  int dev_;
+  int64_t min_pixels_;
+  cudaStream_t cuda_stream_;
+  nvjpegDevAllocator_t dev_allocator_{};
+  nvjpegPinnedAllocator_t pinned_allocator_{};
+  Backend hybrid_;
+  Backend hardware_;
+  bool use_hardware_acceleration_;
+  nvjpegJpegStream_t jpeg_stream_;
+  unsigned char* device_buffer_;
+  unsigned char* host_buffer_;
+  size_t buffer_size_;
+};
+
+NvjpegImageDecoder::NvjpegImageDecoder(int dev, int64_t min_pixels)
+    : dev_(dev),
+      min_pixels_(min_pixels),
+      use_hardware_acceleration_(false),
+      jpeg_stream_(nullptr),
+      device_buffer_(nullptr),
+      host_buffer_(nullptr),
+      buffer_size_(0) {
+  CudaCurrentDeviceGuard guard(dev_);
+  OF_CUDA_CHECK(cudaStreamCreateWithFlags(&cuda_stream_, cudaStreamNonBlocking));
+  dev_allocator_.dev_malloc = &GpuDeviceMalloc;
+  dev_allocator_.dev_free = &GpuDeviceFree;
+  pinned_allocator_.pinned_malloc = &GpuPinnedMalloc;
+  pinned_allocator_.pinned_free = &GpuPinnedFree;
+  CreateBackend(NVJPEG_BACKEND_DEFAULT, &hybrid_);
+#if NVJPEG_VER_MAJOR >= 11
+  if (nvjpegCreateEx(NVJPEG_BACKEND_HARDWARE, &dev_allocator_, &pinned_allocator_, 0,
+                     &hardware_.handle)
+      == NVJPEG_STATUS_SUCCESS) {
+    OF_NVJPEG_CHECK(nvjpegJpegStateCreate(hardware_.handle, &hardware_.state));
+    OF_NVJPEG_CHECK(nvjpegJpegStreamCreate(hardware_.handle, &jpeg_stream_));
+    use_hardware_acceleration_ = true;
+  }
+#endif
+}
+
+NvjpegImageDecoder::~NvjpegImageDecoder() {
+  CudaCurrentDeviceGuard guard(dev_);
+  OF_CUDA_CHECK(cudaStreamSynchronize(cuda_stream_));
+  DestroyBackend(&hybrid_);
+  if (use_hardware_acceleration_) {
+    OF_NVJPEG_CHECK(nvjpegJpegStreamDestroy(jpeg_stream_));
+    DestroyBackend(&hardware_);
+  }
+  if (device_buffer_ != nullptr) { OF_CUDA_CHECK(cudaFree(device_buffer_)); }
+  if (host_buffer_ != nullptr) { OF_CUDA_CHECK(cudaFreeHost(host_buffer_)); }
+  OF_CUDA_CHECK(cudaStreamDestroy(cuda_stream_));
+}
+
+void NvjpegImageDecoder::CreateBackend(nvjpegBackend_t backend_type, Backend* backend) {
+  OF_NVJPEG_CHECK(
+      nvjpegCreateEx(backend_type, &dev_allocator_, &pinned_allocator_, 0, &backend->handle));
+  OF_NVJPEG_CHECK(nvjpegJpegStateCreate(backend->handle, &backend->state));
+}
+
+void NvjpegImageDecoder::DestroyBackend(Backend* backend) {
+  OF_NVJPEG_CHECK(nvjpegJpegStateDestroy(backend->state));
+  OF_NVJPEG_CHECK(nvjpegDestroy(backend->handle));
+}
+
+void NvjpegImageDecoder::ReserveBuffers(size_t size) {
+  if (size <= buffer_size_) { return; }
+  if (device_buffer_ != nullptr) { OF_CUDA_CHECK(cudaFree(device_buffer_)); }
+  if (host_buffer_ != nullptr) { OF_CUDA_CHECK(cudaFreeHost(host_buffer_)); }
+  OF_CUDA_CHECK(cudaMalloc(&device_buffer_, size));
+  OF_CUDA_CHECK(cudaMallocHost(&host_buffer_, size));
+  buffer_size_ = size;
+}
+
+void NvjpegImageDecoder::LaunchBatch(const TensorBuffer* in, nvjpegOutputFormat_t format,
+                                     int channels, Backend* backend) {
+  const int batch_size = backend->images.size();
+  if (batch_size == 0) { return; }
+  if (backend->batch_size != batch_size || backend->format != format) {
+    OF_NVJPEG_CHECK(nvjpegDecodeBatchedInitialize(backend->handle, backend->state, batch_size, 1,
+                                                  format));
+    backend->batch_size = batch_size;
+    backend->format = format;
+  }
+  std::vector<const unsigned char*> data(batch_size);
+  std::vector<size_t> lengths(batch_size);
+  std::vector<nvjpegImage_t> destinations(batch_size);
+  FOR_RANGE(int, i, 0, batch_size) {
+    const Image& image = backend->images.at(i);
+    data.at(i) = in[image.index].data<unsigned char>();
+    lengths.at(i) = in[image.index].elem_cnt();
+    destinations.at(i) = nvjpegImage_t{};
+    destinations.at(i).channel[0] = device_buffer_ + image.offset;
+    destinations.at(i).pitch[0] = image.width * channels;
+  }
+  OF_NVJPEG_CHECK(nvjpegDecodeBatched(backend->handle, backend->state, data.data(),
+                                      lengths.data(), destinations.data(), cuda_stream_));
+}
+
+void NvjpegImageDecoder::Decode(const TensorBuffer* in, TensorBuffer* out, int64_t n,
+                                const std::string& color_space, DataType data_type) {
+  CudaCurrentDeviceGuard guard(dev_);
+  nvjpegOutputFormat_t format = NVJPEG_OUTPUT_Y;
+  int channels = 1;
+  if (color_space == "BGR") {
+    format = NVJPEG_OUTPUT_BGRI;
+    channels = 3;
+  } else if (color_space == "RGB") {
+    format = NVJPEG_OUTPUT_RGBI;
+    channels = 3;
+  }
+  hybrid_.images.clear();
+  hardware_.images.clear();
+  std::vector<int64_t> cpu_indices;
+  size_t offset = 0;
+  FOR_RANGE(int64_t, i, 0, n) {
+    const unsigned char* data = in[i].data<unsigned char>();
+    const size_t length = in[i].elem_cnt();
+    int num_components = 0;
+    nvjpegChromaSubsampling_t subsampling;
+    int widths[NVJPEG_MAX_COMPONENT];
+    int heights[NVJPEG_MAX_COMPONENT];
+    if (nvjpegGetImageInfo(hybrid_.handle, data, length, &num_components, &subsampling, widths,
+                           heights)
+            != NVJPEG_STATUS_SUCCESS
+        || static_cast<int64_t>(widths[0]) * heights[0] < min_pixels_) {
+      cpu_indices.push_back(i);
+      continue;
+    }
+    Image image{i, widths[0], heights[0], offset};
+    offset += GetCudaAlignedSize(static_cast<size_t>(image.width) * image.height * channels);
+    int is_hardware_acceleration_supported = -1;
+#if NVJPEG_VER_MAJOR >= 11
+    if (use_hardware_acceleration_
+        && nvjpegJpegStreamParse(hardware_.handle, data, length, 0, 0, jpeg_stream_)
+               == NVJPEG_STATUS_SUCCESS) {
+      OF_NVJPEG_CHECK(
+          nvjpegDecodeBatchedSupported(hardware_.handle, jpeg_stream_,
+                                       &is_hardware_acceleration_supported));
+    }
+#endif
+    if (is_hardware_acceleration_supported == 0) {
+      hardware_.images.push_back(image);
+    } else {
+      hybrid_.images.push_back(image);
+    }
+  }
+  ReserveBuffers(offset);
+  LaunchBatch(in, format, channels, &hardware_);
+  LaunchBatch(in, format, channels, &hybrid_);
+  if (offset > 0) {
+    OF_CUDA_CHECK(
+        cudaMemcpyAsync(host_buffer_, device_buffer_, offset, cudaMemcpyDefault, cuda_stream_));
+  }
+  MultiThreadLoop(cpu_indices.size(), [&](size_t i) {
+    DecodeImage(in[cpu_indices.at(i)], out + cpu_indices.at(i), color_space, data_type);
+  });
+  OF_CUDA_CHECK(cudaStreamSynchronize(cuda_stream_));
+  for (const Backend* backend : {&hardware_, &hybrid_}) {
+    MultiThreadLoop(backend->images.size(), [&](size_t i) {
+      const Image& image = backend->images.at(i);
+      TensorBuffer* image_buffer = out + image.index;
+      image_buffer->Resize(Shape({image.height, image.width, channels}), data_type);
+      const unsigned char* src = host_buffer_ + image.offset;
+      const int64_t elem_cnt = image_buffer->elem_cnt();
+      if (data_type == DataType::kUInt8) {
+        memcpy(image_buffer->mut_data<unsigned char>(), src, elem_cnt);
+      } else if (data_type == DataType::kFloat) {
+        float* dst = image_buffer->mut_data<float>();
+        FOR_RANGE(int64_t, j, 0, elem_cnt) { dst[j] = static_cast<float>(src[j]); }
+      } else {
+        UNIMPLEMENTED();
+      }
+    });
+  }
+}
+
+#endif  // defined(WITH_CUDA) && CUDA_VERSION >= 10020
+
 }  // namespace
 
 class ImageDecodeKernel final : public user_op::OpKernel {
@@ -65,8 +292,22 @@ class ImageDecodeKernel final : public user_op::OpKernel {
   ImageDecodeKernel() = default;
   ~ImageDecodeKernel() = default;
 
+  std::shared_ptr<user_op::OpKernelState> CreateOpKernelState(
+      user_op::KernelInitContext* ctx) const override {
+#if defined(WITH_CUDA) && CUDA_VERSION >= 10020
+    int device_count = 0;
+    if (ParseBooleanFromEnv("ONEFLOW_IMAGE_DECODE_USE_NVJPEG", false)
+        && cudaGetDeviceCount(&device_count) == cudaSuccess && device_count > 0) {
+      return std::make_shared<NvjpegImageDecoder>(
+          GlobalProcessCtx::LocalRank() % device_count,
+          ParseIntegerFromEnv("ONEFLOW_IMAGE_DECODE_NVJPEG_MIN_PIXELS", 128 * 128));
+    }
+#endif  // defined(WITH_CUDA) && CUDA_VERSION >= 10020
+    return nullptr;
+  }
+
  private:
-  void Compute(user_op::KernelComputeContext* ctx) const override {
+  void Compute(user_op::KernelComputeContext* ctx, user_op::OpKernelState* state) const override {
     const user_op::Tensor* in_tensor = ctx->Tensor4ArgNameAndIndex("in", 0);
     user_op::Tensor* out_tensor = ctx->Tensor4ArgNameAndIndex("out", 0);
     CHECK_EQ(in_tensor->shape().elem_cnt(), out_tensor->shape().elem_cnt());
@@ -77,6 +318,15 @@ class ImageDecodeKernel final : public user_op::OpKernel {
     const std::string& color_space = ctx->Attr<std::string>("color_space");
     const DataType data_type = ctx->Attr<DataType>("data_type");
 
+#if defined(WITH_CUDA) && CUDA_VERSION >= 10020
+    if (state != nullptr) {
+      auto* decoder = dynamic_cast<NvjpegImageDecoder*>(state);
+      CHECK_NOTNULL(decoder);
+      decoder->Decode(in_img_buf, out_img_buf, in_tensor->shape().elem_cnt(), color_space,
+                      data_type);
+      return;
+    }
+#endif  // defined(WITH_CUDA) && CUDA_VERSION >= 10020
     MultiThreadLoop(in_tensor->shape().elem_cnt(), [&](size_t i) {
       DecodeImage(in_img_buf[i], out_img_buf + i, color_space, data_type);
     });
@@ -404,4 +404,75 @@ REGISTER_USER_KERNEL("image_random_crop")
                      & (user_op::HobDataType("in", 0) == DataType::kTensorBuffer)
                      & (user_op::HobDataType("out", 0) == DataType::kTensorBuffer));
 
+namespace {
+
+class ImageRandomAugmentParamsKernelState final : public user_op::OpKernelState {
+ public:
+  ImageRandomAugmentParamsKernelState(std::shared_ptr<RandomCropKernelState> crop_state,
+                                      int64_t seed)
+      : crop_state_(std::move(crop_state)), jitter_gen_(seed) {}
+  ~ImageRandomAugmentParamsKernelState() override = default;
+
+  RandomCropKernelState* crop_state() { return crop_state_.get(); }
+  std::mt19937* jitter_gen() { return &jitter_gen_; }
+
+ private:
+  std::shared_ptr<RandomCropKernelState> crop_state_;
+  std::mt19937 jitter_gen_;
+};
+
+}  // namespace
+
+class ImageRandomAugmentParamsKernel final : public user_op::OpKernel {
+ public:
+  ImageRandomAugmentParamsKernel() = default;
+  ~ImageRandomAugmentParamsKernel() override = default;
+
+  std::shared_ptr<user_op::OpKernelState> CreateOpKernelState(
+      user_op::KernelInitContext* ctx) const override {
+    const int64_t batch_size = ctx->TensorDesc4ArgNameAndIndex("in", 0)->shape().elem_cnt();
+    return std::make_shared<ImageRandomAugmentParamsKernelState>(
+        CreateRandomCropKernelState(ctx, batch_size), GetOpKernelRandomSeed(ctx));
+  }
+
+ private:
+  void Compute(user_op::KernelComputeContext* ctx, user_op::OpKernelState* state) const override {
+    auto* params_state = dynamic_cast<ImageRandomAugmentParamsKernelState*>(state);
+    CHECK_NOTNULL(params_state);
+    const user_op::Tensor* in_blob = ctx->Tensor4ArgNameAndIndex("in", 0);
+    user_op::Tensor* crop_window_blob = ctx->Tensor4ArgNameAndIndex("crop_window", 0);
+    user_op::Tensor* color_jitter_blob = ctx->Tensor4ArgNameAndIndex("color_jitter", 0);
+    const int64_t record_num = in_blob->shape().elem_cnt();
+    CHECK_GT(record_num, 0);
+    const TensorBuffer* in_buffers = in_blob->dptr<TensorBuffer>();
+    int32_t* crop_window_ptr = crop_window_blob->mut_dptr<int32_t>();
+    float* color_jitter_ptr = color_jitter_blob->mut_dptr<float>();
+    const float brightness = ctx->Attr<float>("brightness");
+    const float contrast = ctx->Attr<float>("contrast");
+    std::uniform_real_distribution<float> brightness_dis(std::max(0.0f, 1.0f - brightness),
+                                                         1.0f + brightness);
+    std::uniform_real_distribution<float> contrast_dis(std::max(0.0f, 1.0f - contrast),
+                                                       1.0f + contrast);
+    FOR_RANGE(int64_t, i, 0, record_num) {
+      const Shape& image_shape = in_buffers[i].shape();
+      CHECK_EQ(image_shape.NumAxes(), 3);
+      CropWindow window;
+      params_state->crop_state()->GetGenerator(i)->GenerateCropWindow(
+          {image_shape.At(0), image_shape.At(1)}, &window);
+      crop_window_ptr[i * 4 + 0] = window.anchor.At(0);
+      crop_window_ptr[i * 4 + 1] = window.anchor.At(1);
+      crop_window_ptr[i * 4 + 2] = window.shape.At(0);
+      crop_window_ptr[i * 4 + 3] = window.shape.At(1);
+      color_jitter_ptr[i * 2 + 0] = brightness_dis(*params_state->jitter_gen());
+      color_jitter_ptr[i * 2 + 1] = contrast_dis(*params_state->jitter_gen());
+    }
+  }
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+};
+
+REGISTER_USER_KERNEL("image_random_augment_params")
+    .SetCreateFn<ImageRandomAugmentParamsKernel>()
+    .SetIsMatchedHob((user_op::HobDeviceTag() == DeviceType::kCPU)
+                     & (user_op::HobDataType("in", 0) == DataType::kTensorBuffer));
+
 }  // namespace oneflow
@@ -126,6 +126,69 @@ __global__ void CropMirrorNormalizeGpuImpl(int32_t elem_cnt, const uint8_t* in_d
   }
 }
 
+__device__ __forceinline__ float BilinearSample(const uint8_t* in_dptr,
+                                                const NdIndexOffsetHelper<int32_t, 4>& in_helper,
+                                                int32_t n, int32_t c, const int32_t* window,
+                                                float y, float x) {
+  const int32_t y0 = static_cast<int32_t>(y);
+  const int32_t x0 = static_cast<int32_t>(x);
+  const int32_t y1 = min(y0 + 1, window[2] - 1);
+  const int32_t x1 = min(x0 + 1, window[3] - 1);
+  const float dy = y - y0;
+  const float dx = x - x0;
+  const auto Pixel = [&](int32_t h, int32_t w) -> float {
+    return in_dptr[in_helper.NdIndexToOffset(n, window[0] + h, window[1] + w, c)];
+  };
+  return (1.0f - dy) * ((1.0f - dx) * Pixel(y0, x0) + dx * Pixel(y0, x1))
+         + dy * ((1.0f - dx) * Pixel(y1, x0) + dx * Pixel(y1, x1));
+}
+
+// Crops the window of each image, resizes it bilinearly to the output size, mirrors it, applies
+// the brightness and contrast factors and normalizes it, in a single pass over the output.
+template<TensorLayout layout, typename T>
+__global__ void CropResizeMirrorNormalizeGpuImpl(
+    int32_t elem_cnt, const uint8_t* in_dptr, const int32_t* crop_window_dptr,
+    const int8_t* mirror_dptr, const float* color_jitter_dptr, T* out_dptr,
+    const NdIndexOffsetHelper<int32_t, 4> in_helper,
+    const NdIndexOffsetHelper<int32_t, 4> out_helper, int32_t out_H, int32_t out_W,
+    const NormalizeVal mean, const NormalizeVal inv_std) {
+  CUDA_1D_KERNEL_LOOP(out_offset, elem_cnt) {
+    int32_t out_idx[4];
+    out_helper.OffsetToNdIndex(out_offset, out_idx);
+    const int32_t n = out_idx[0];
+    const int32_t c = layout == TensorLayout::kNCHW ? out_idx[1] : out_idx[3];
+    const int32_t h = layout == TensorLayout::kNCHW ? out_idx[2] : out_idx[1];
+    int32_t w = layout == TensorLayout::kNCHW ? out_idx[3] : out_idx[2];
+    if (mirror_dptr && mirror_dptr[n]) { w = out_W - 1 - w; }
+    const int32_t* window = crop_window_dptr + n * 4;
+    // pixel centers are aligned the same way as cv::resize with INTER_LINEAR
+    const float y = fminf(fmaxf((h + 0.5f) * window[2] / out_H - 0.5f, 0.0f), window[2] - 1);
+    const float x = fminf(fmaxf((w + 0.5f) * window[3] / out_W - 0.5f, 0.0f), window[3] - 1);
+    float val = BilinearSample(in_dptr, in_helper, n, c, window, y, x);
+    if (color_jitter_dptr) {
+      const float brightness = color_jitter_dptr[n * 2];
+      const float contrast = color_jitter_dptr[n * 2 + 1];
+      val = fminf(fmaxf(((val - 128.0f) * contrast + 128.0f) * brightness, 0.0f), 255.0f);
+    }
+    float mean_val;
+    float inv_std_val;
+    if (c == 0) {
+      mean_val = mean.val[0];
+      inv_std_val = inv_std.val[0];
+    } else if (c == 1) {
+      mean_val = mean.val[1];
+      inv_std_val = inv_std.val[1];
+    } else if (c == 2) {
+      mean_val = mean.val[2];
+      inv_std_val = inv_std.val[2];
+    } else {
+      // undefined behavior
+      assert(false);
+    }
+    out_dptr[out_offset] = static_cast<T>((val - mean_val) * inv_std_val);
+  }
+}
+
 }  // namespace
 
 class CropMirrorNormalizeGpuKernel final : public user_op::OpKernel {
@@ -209,4 +272,72 @@ REGISTER_USER_KERNEL("crop_mirror_normalize_from_uint8")
                      & (user_op::HobDataType("in", 0) == DataType::kUInt8)
                      & (user_op::HobDataType("out", 0) == DataType::kFloat));
 
+template<typename T>
+class CropResizeMirrorNormalizeGpuKernel final : public user_op::OpKernel {
+ public:
+  CropResizeMirrorNormalizeGpuKernel() = default;
+  ~CropResizeMirrorNormalizeGpuKernel() override = default;
+
+  std::shared_ptr<user_op::OpKernelState> CreateOpKernelState(
+      user_op::KernelInitContext* ctx) const override {
+    return std::make_shared<NormalizeAttr>(ctx);
+  }
+
+ private:
+  using DevT = typename DevDType<DeviceType::kGPU, T>::type;
+
+  void Compute(user_op::KernelComputeContext* ctx, user_op::OpKernelState* state) const override {
+    auto* normalize_attr = dynamic_cast<NormalizeAttr*>(state);
+    const user_op::Tensor* in_blob = ctx->Tensor4ArgNameAndIndex("in", 0);
+    const user_op::Tensor* crop_window_blob = ctx->Tensor4ArgNameAndIndex("crop_window", 0);
+    user_op::Tensor* out_blob = ctx->Tensor4ArgNameAndIndex("out", 0);
+    const int8_t* mirror_dptr = nullptr;
+    user_op::Tensor* mirror_blob = ctx->Tensor4ArgNameAndIndex("mirror", 0);
+    if (mirror_blob) { mirror_dptr = mirror_blob->dptr<int8_t>(); }
+    const float* color_jitter_dptr = nullptr;
+    user_op::Tensor* color_jitter_blob = ctx->Tensor4ArgNameAndIndex("color_jitter", 0);
+    if (color_jitter_blob) { color_jitter_dptr = color_jitter_blob->dptr<float>(); }
+    const ShapeView& in_shape = in_blob->shape();
+    const ShapeView& out_shape = out_blob->shape();
+    CHECK_LE(in_shape.elem_cnt(), GetMaxVal<int32_t>());
+    const int32_t elem_cnt = out_shape.elem_cnt();
+    const NdIndexOffsetHelper<int32_t, 4> in_helper(in_shape.At(0), in_shape.At(1), in_shape.At(2),
+                                                    in_shape.At(3));
+    const NdIndexOffsetHelper<int32_t, 4> out_helper(out_shape.At(0), out_shape.At(1),
+                                                     out_shape.At(2), out_shape.At(3));
+    const int32_t out_H = ctx->Attr<int64_t>("target_h");
+    const int32_t out_W = ctx->Attr<int64_t>("target_w");
+    DevT* out_dptr = reinterpret_cast<DevT*>(out_blob->mut_dptr<T>());
+    const std::string& output_layout = ctx->Attr<std::string>("output_layout");
+    if (output_layout == "NCHW") {
+      CropResizeMirrorNormalizeGpuImpl<TensorLayout::kNCHW, DevT>
+          <<<BlocksNum4ThreadsNum(elem_cnt), kCudaThreadsNumPerBlock, 0,
+             ctx->device_ctx()->cuda_stream()>>>(
+              elem_cnt, in_blob->dptr<uint8_t>(), crop_window_blob->dptr<int32_t>(), mirror_dptr,
+              color_jitter_dptr, out_dptr, in_helper, out_helper, out_H, out_W,
+              normalize_attr->mean(), normalize_attr->inv_std());
+    } else if (output_layout == "NHWC") {
+      CropResizeMirrorNormalizeGpuImpl<TensorLayout::kNHWC, DevT>
+          <<<BlocksNum4ThreadsNum(elem_cnt), kCudaThreadsNumPerBlock, 0,
+             ctx->device_ctx()->cuda_stream()>>>(
+              elem_cnt, in_blob->dptr<uint8_t>(), crop_window_blob->dptr<int32_t>(), mirror_dptr,
+              color_jitter_dptr, out_dptr, in_helper, out_helper, out_H, out_W,
+              normalize_attr->mean(), normalize_attr->inv_std());
+    } else {
+      UNIMPLEMENTED();
+    }
+  }
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+};
+
+#define REGISTER_CROP_RESIZE_MIRROR_NORMALIZE_GPU_KERNEL(dtype)              \
+  REGISTER_USER_KERNEL("crop_resize_mirror_normalize_from_uint8")            \
+      .SetCreateFn<CropResizeMirrorNormalizeGpuKernel<dtype>>()              \
+      .SetIsMatchedHob((user_op::HobDeviceTag() == "gpu")                    \
+                       & (user_op::HobDataType("in", 0) == DataType::kUInt8) \
+                       & (user_op::HobDataType("out", 0) == GetDataType<dtype>::value));
+
+REGISTER_CROP_RESIZE_MIRROR_NORMALIZE_GPU_KERNEL(float)
+REGISTER_CROP_RESIZE_MIRROR_NORMALIZE_GPU_KERNEL(float16)
+
 }  // namespace oneflow
@@ -18,6 +18,7 @@ limitations under the License.
 #include "oneflow/core/framework/framework.h"
 #include "oneflow/core/ndarray/ndarray_util.h"
 #include "oneflow/core/cuda/atomic.cuh"
+#include "oneflow/core/cuda/layer_norm.cuh"
 #include <cub/cub.cuh>
 
 namespace oneflow {
@@ -144,151 +145,157 @@ void InstanceScaleCenter<float16>(DeviceCtx* ctx, const int64_t batch_size,
   }
 }
 
-constexpr int64_t kLayerNormForwardGpuBlockSize = 256;
-
-template<typename T>
-struct LayerNormUtil {
-  using ComputeType = T;
-  __device__ static ComputeType ToComputeType(T v) { return v; }
-  __device__ static T FromComputeType(ComputeType v) { return v; }
-};
-
-template<>
-struct LayerNormUtil<half> {
-  using ComputeType = float;
-  __device__ static ComputeType ToComputeType(half v) { return __half2float(v); }
-  __device__ static half FromComputeType(ComputeType v) { return __float2half(v); }
-};
-
-template<typename T>
-int GetForwardDynamicSharedMemorySize(const int norm_size) {
-  return norm_size * sizeof(typename LayerNormUtil<T>::ComputeType);
-}
-
-int GetLayerNormForwardBlockSize() { return kLayerNormForwardGpuBlockSize; }
-
-int GetLayerNormForwardNumBlocks(const int num_instances) {
-  return std::min(static_cast<int>(num_instances), kCudaMaxBlocksNum);
-}
-
-template<typename T, typename ComputeType>
-__global__ void LayerNormForwardImpl(const int num_instances, const int norm_size,
-                                     const double epsilon, const T* x, const T* gamma,
-                                     const T* beta, ComputeType* mean, ComputeType* inv_variance,
-                                     T* normalized, T* y) {
-  using LU = LayerNormUtil<T>;
-  extern __shared__ __align__(sizeof(double)) unsigned char fw_shared_buf[];
-  auto* compute_buf = reinterpret_cast<ComputeType*>(fw_shared_buf);
-  __shared__ ComputeType row_mean_shared;
-  __shared__ ComputeType row_inv_var_shared;
-  typedef cub::BlockReduce<ComputeType, kLayerNormForwardGpuBlockSize> BlockReduce;
-  __shared__ typename BlockReduce::TempStorage cub_mean_reduce_tmp_storage;
-  __shared__ typename BlockReduce::TempStorage cub_variance_reduce_tmp_storage;
-  ComputeType inv_norm_size = static_cast<ComputeType>(1.0) / static_cast<ComputeType>(norm_size);
-  for (int row = blockIdx.x; row < num_instances; row += gridDim.x) {
-    const int row_offset = row * norm_size;
-    const T* x_row = x + row_offset;
-    ComputeType thread_sum = 0;
-    ComputeType thread_square_sum = 0;
-    const int tid = threadIdx.x;
-    for (int col = tid; col < norm_size; col += blockDim.x) {
-      const ComputeType val = LU::ToComputeType(x_row[col]);
-      compute_buf[col] = val;
-      thread_sum += val;
-      thread_square_sum += val * val;
+template<typename SRC, typename DST, bool do_scale, bool do_center>
+struct AffineStore {
+  AffineStore(DST* normalized, DST* y, int64_t row_size, const DST* gamma, const DST* beta)
+      : normalized(normalized), y(y), row_size(row_size), gamma(gamma), beta(beta) {}
+  template<int N>
+  __device__ void store(const SRC* src, int64_t row, int64_t col) {
+    cuda::layer_norm::Pack<DST, N> normalized_pack;
+    cuda::layer_norm::Pack<DST, N> y_pack;
+    cuda::layer_norm::Pack<DST, N> gamma_pack;
+    cuda::layer_norm::Pack<DST, N> beta_pack;
+    const int64_t offset = row * row_size + col;
+    if (do_scale) {
+      gamma_pack.storage =
+          *reinterpret_cast<const cuda::layer_norm::PackType<DST, N>*>(gamma + col);
     }
-    __syncthreads();
-    ComputeType block_sum = BlockReduce(cub_mean_reduce_tmp_storage).Reduce(thread_sum, cub::Sum());
-    ComputeType block_square_sum =
-        BlockReduce(cub_variance_reduce_tmp_storage).Reduce(thread_square_sum, cub::Sum());
-    if (tid == 0) {
-      ComputeType row_mean = block_sum * inv_norm_size;
-      row_mean_shared = row_mean;
-      mean[row] = row_mean;
-      ComputeType row_variance =
-          max(block_square_sum * inv_norm_size - row_mean * row_mean, static_cast<ComputeType>(0));
-      ComputeType row_inv_var = rsqrt(row_variance + static_cast<ComputeType>(epsilon));
-      row_inv_var_shared = row_inv_var;
-      inv_variance[row] = row_inv_var;
+    if (do_center) {
+      beta_pack.storage = *reinterpret_cast<const cuda::layer_norm::PackType<DST, N>*>(beta + col);
     }
-    __syncthreads();
-    ComputeType mean = row_mean_shared;
-    ComputeType inv_var = row_inv_var_shared;
-    for (int col = threadIdx.x; col < norm_size; col += blockDim.x) {
-      int offset = row_offset + col;
-      ComputeType val = compute_buf[col];
-      val = (val - mean) * inv_var;
-      if (gamma != nullptr || beta != nullptr) {
-        int elem_id = col;
-        if (gamma != nullptr) {
-          normalized[offset] = LU::FromComputeType(val);
-          val *= LU::ToComputeType(gamma[elem_id]);
-        }
-        if (beta != nullptr) { val += LU::ToComputeType(beta[elem_id]); }
+#pragma unroll
+    for (int i = 0; i < N; ++i) {
+      SRC val = src[i];
+      if (do_scale) {
+        normalized_pack.elem[i] = static_cast<DST>(val);
+        val *= static_cast<SRC>(gamma_pack.elem[i]);
       }
-      y[offset] = LU::FromComputeType(val);
+      if (do_center) { val += static_cast<SRC>(beta_pack.elem[i]); }
+      y_pack.elem[i] = static_cast<DST>(val);
+    }
+    if (do_scale) {
+      *reinterpret_cast<cuda::layer_norm::PackType<DST, N>*>(normalized + offset) =
+          normalized_pack.storage;
+    }
+    *reinterpret_cast<cuda::layer_norm::PackType<DST, N>*>(y + offset) = y_pack.storage;
+  }
+  DST* normalized;
+  DST* y;
+  int64_t row_size;
+  const DST* gamma;
+  const DST* beta;
+};
+
+// dx = add_to_output + normalization grad, add_to_output may alias dx.
+template<typename SRC, typename DST>
+struct AddToOutputStore {
+  AddToOutputStore(DST* dx, const DST* add_to_output, int64_t row_size)
+      : dx(dx), add_to_output(add_to_output), row_size(row_size) {}
+  template<int N>
+  __device__ void store(const SRC* src, int64_t row, int64_t col) {
+    cuda::layer_norm::Pack<DST, N> add_to_output_pack;
+    cuda::layer_norm::Pack<DST, N> dx_pack;
+    const int64_t offset = row * row_size + col;
+    add_to_output_pack.storage =
+        *reinterpret_cast<const cuda::layer_norm::PackType<DST, N>*>(add_to_output + offset);
+#pragma unroll
+    for (int i = 0; i < N; ++i) {
+      dx_pack.elem[i] = static_cast<DST>(src[i] + static_cast<SRC>(add_to_output_pack.elem[i]));
     }
+    *reinterpret_cast<cuda::layer_norm::PackType<DST, N>*>(dx + offset) = dx_pack.storage;
   }
+  DST* dx;
+  const DST* add_to_output;
+  int64_t row_size;
+};
+
+template<typename T, bool do_scale, bool do_center>
+void DispatchLayerNormForwardAffine(DeviceCtx* ctx, const int64_t num_instances,
+                                    const int64_t norm_size, const double epsilon, const T* x_ptr,
+                                    const T* gamma_ptr, const T* beta_ptr, T* normalized_ptr,
+                                    T* y_ptr, user_op::Tensor* mean,
+                                    user_op::Tensor* inv_variance) {
+  using ComputeType = typename cuda::layer_norm::DefaultComputeType<T>::type;
+  cuda::layer_norm::DirectLoad<T, ComputeType> load(x_ptr, norm_size);
+  AffineStore<ComputeType, T, do_scale, do_center> store(normalized_ptr, y_ptr, norm_size,
+                                                         gamma_ptr, beta_ptr);
+  cuda::layer_norm::DispatchLayerNorm<decltype(load), decltype(store), ComputeType>(
+      ctx->cuda_stream(), load, store, num_instances, norm_size, epsilon,
+      mean->mut_dptr<ComputeType>(), inv_variance->mut_dptr<ComputeType>());
 }
 
 template<typename T>
-void LayerNormForwardGpu(DeviceCtx* ctx, const int num_instances, const int norm_size,
+void LayerNormForwardGpu(DeviceCtx* ctx, const int64_t num_instances, const int64_t norm_size,
                          const double epsilon, const T* x_ptr, const T* gamma_ptr,
                          const T* beta_ptr, T* normalized_ptr, T* y_ptr, user_op::Tensor* mean,
                          user_op::Tensor* inv_variance) {
-  LayerNormForwardImpl<T, typename LayerNormUtil<T>::ComputeType>
-      <<<GetLayerNormForwardNumBlocks(num_instances), GetLayerNormForwardBlockSize(),
-         GetForwardDynamicSharedMemorySize<T>(norm_size), ctx->cuda_stream()>>>(
-          num_instances, norm_size, epsilon, x_ptr, gamma_ptr, beta_ptr,
-          mean->mut_dptr<typename LayerNormUtil<T>::ComputeType>(),
-          inv_variance->mut_dptr<typename LayerNormUtil<T>::ComputeType>(), normalized_ptr, y_ptr);
+  if (gamma_ptr != nullptr && beta_ptr != nullptr) {
+    DispatchLayerNormForwardAffine<T, true, true>(ctx, num_instances, norm_size, epsilon, x_ptr,
+                                                  gamma_ptr, beta_ptr, normalized_ptr, y_ptr,
+                                                  mean, inv_variance);
+  } else if (gamma_ptr != nullptr) {
+    DispatchLayerNormForwardAffine<T, true, false>(ctx, num_instances, norm_size, epsilon, x_ptr,
+                                                   gamma_ptr, nullptr, normalized_ptr, y_ptr,
+                                                   mean, inv_variance);
+  } else if (beta_ptr != nullptr) {
+    DispatchLayerNormForwardAffine<T, false, true>(ctx, num_instances, norm_size, epsilon, x_ptr,
+                                                   nullptr, beta_ptr, normalized_ptr, y_ptr,
+                                                   mean, inv_variance);
+  } else {
+    DispatchLayerNormForwardAffine<T, false, false>(ctx, num_instances, norm_size, epsilon,
+                                                    x_ptr, nullptr, nullptr, normalized_ptr,
+                                                    y_ptr, mean, inv_variance);
+  }
 }
 
 template<>
-void LayerNormForwardGpu<float16>(DeviceCtx* ctx, const int num_instances, const int norm_size,
-                                  const double epsilon, const float16* x_ptr,
-                                  const float16* gamma_ptr, const float16* beta_ptr,
-                                  float16* normalized_ptr, float16* y_ptr, user_op::Tensor* mean,
+void LayerNormForwardGpu<float16>(DeviceCtx* ctx, const int64_t num_instances,
+                                  const int64_t norm_size, const double epsilon,
+                                  const float16* x_ptr, const float16* gamma_ptr,
+                                  const float16* beta_ptr, float16* normalized_ptr,
+                                  float16* y_ptr, user_op::Tensor* mean,
                                   user_op::Tensor* inv_variance) {
-  LayerNormForwardImpl<half, typename LayerNormUtil<half>::ComputeType>
-      <<<GetLayerNormForwardNumBlocks(num_instances), GetLayerNormForwardBlockSize(),
-         GetForwardDynamicSharedMemorySize<half>(norm_size), ctx->cuda_stream()>>>(
-          num_instances, norm_size, epsilon, reinterpret_cast<const half*>(x_ptr),
-          reinterpret_cast<const half*>(gamma_ptr), reinterpret_cast<const half*>(beta_ptr),
-          mean->mut_dptr<typename LayerNormUtil<half>::ComputeType>(),
-          inv_variance->mut_dptr<typename LayerNormUtil<half>::ComputeType>(),
-          reinterpret_cast<half*>(normalized_ptr), reinterpret_cast<half*>(y_ptr));
+  LayerNormForwardGpu<half>(ctx, num_instances, norm_size, epsilon,
+                            reinterpret_cast<const half*>(x_ptr),
+                            reinterpret_cast<const half*>(gamma_ptr),
+                            reinterpret_cast<const half*>(beta_ptr),
+                            reinterpret_cast<half*>(normalized_ptr), reinterpret_cast<half*>(y_ptr),
+                            mean, inv_variance);
 }
 
-int GetForwardFusedKernelMinNormSize() { return 64; }
-
 template<typename T>
-int GetForwardFusedKernelMaxActiveBlocks(const int32_t norm_size) {
-  int max_active_blocks;
-  OF_CUDA_CHECK(cudaOccupancyMaxActiveBlocksPerMultiprocessor(
-      &max_active_blocks, LayerNormForwardImpl<T, typename LayerNormUtil<T>::ComputeType>,
-      GetLayerNormForwardBlockSize(), GetForwardDynamicSharedMemorySize<T>(norm_size)));
-  return max_active_blocks;
+void LayerNormBackwardGpu(DeviceCtx* ctx, const int64_t num_instances, const int64_t norm_size,
+                          const T* dy_ptr, const T* x_ptr, const user_op::Tensor* mean,
+                          const user_op::Tensor* inv_variance, const T* add_to_output_ptr,
+                          T* dx_ptr) {
+  using ComputeType = typename cuda::layer_norm::DefaultComputeType<T>::type;
+  cuda::layer_norm::DirectLoad<T, ComputeType> load_x(x_ptr, norm_size);
+  cuda::layer_norm::DirectLoad<T, ComputeType> load_dy(dy_ptr, norm_size);
+  if (add_to_output_ptr != nullptr) {
+    AddToOutputStore<ComputeType, T> store(dx_ptr, add_to_output_ptr, norm_size);
+    cuda::layer_norm::DispatchLayerNormGrad<decltype(load_x), decltype(load_dy), decltype(store),
+                                            ComputeType>(
+        ctx->cuda_stream(), load_x, load_dy, store, mean->dptr<ComputeType>(),
+        inv_variance->dptr<ComputeType>(), num_instances, norm_size);
+  } else {
+    cuda::layer_norm::DirectStore<ComputeType, T> store(dx_ptr, norm_size);
+    cuda::layer_norm::DispatchLayerNormGrad<decltype(load_x), decltype(load_dy), decltype(store),
+                                            ComputeType>(
+        ctx->cuda_stream(), load_x, load_dy, store, mean->dptr<ComputeType>(),
+        inv_variance->dptr<ComputeType>(), num_instances, norm_size);
+  }
 }
 
 template<>
-int GetForwardFusedKernelMaxActiveBlocks<float16>(const int32_t norm_size) {
-  int max_active_blocks;
-  OF_CUDA_CHECK(cudaOccupancyMaxActiveBlocksPerMultiprocessor(
-      &max_active_blocks, LayerNormForwardImpl<half, typename LayerNormUtil<half>::ComputeType>,
-      GetLayerNormForwardBlockSize(), GetForwardDynamicSharedMemorySize<half>(norm_size)));
-  return max_active_blocks;
-}
-
-template<typename T>
-bool IsForwardFusedKernelSupported(const int32_t norm_size, const int32_t instance_size) {
-  if (norm_size >= GetForwardFusedKernelMinNormSize() && norm_size % 32 == 0
-      && GetForwardFusedKernelMaxActiveBlocks<T>(norm_size) > 0
-      && (instance_size == 0 || norm_size == instance_size)) {
-    return true;
-  } else {
-    return false;
-  }
+void LayerNormBackwardGpu<float16>(DeviceCtx* ctx, const int64_t num_instances,
+                                   const int64_t norm_size, const float16* dy_ptr,
+                                   const float16* x_ptr, const user_op::Tensor* mean,
+                                   const user_op::Tensor* inv_variance,
+                                   const float16* add_to_output_ptr, float16* dx_ptr) {
+  LayerNormBackwardGpu<half>(ctx, num_instances, norm_size, reinterpret_cast<const half*>(dy_ptr),
+                             reinterpret_cast<const half*>(x_ptr), mean, inv_variance,
+                             reinterpret_cast<const half*>(add_to_output_ptr),
+                             reinterpret_cast<half*>(dx_ptr));
 }
 
 constexpr int64_t kLayerNormParamGradGpuBlockSize = 512;
@@ -414,7 +421,9 @@ class LayerNormGpuKernel final : public user_op::OpKernel {
       }
       CHECK_EQ(y->shape().elem_cnt() % instance_size, 0);
     }
-    if (IsForwardFusedKernelSupported<T>(norm_size, instance_size)) {
+    // The one-pass kernels apply gamma and beta per column of a row, rows whose params only cover
+    // part of the row (begin_params_axis > begin_norm_axis) go through cudnn.
+    if (instance_size == 0 || instance_size == norm_size) {
       LayerNormForwardGpu<T>(ctx->device_ctx(), num_instances, norm_size, epsilon, x->dptr<T>(),
                              gamma_ptr, beta_ptr, normalized->mut_dptr<T>(), y->mut_dptr<T>(), mean,
                              inv_variance);
@@ -463,7 +472,7 @@ REGISTER_LAYER_NORM_GPU_KERNEL(float, float)
 REGISTER_LAYER_NORM_GPU_KERNEL(double, double)
 REGISTER_LAYER_NORM_GPU_KERNEL(float16, float)
 
-template<typename T, typename BNParamT>
+template<typename T>
 class LayerNormGradGpuKernel final : public user_op::OpKernel {
  public:
   LayerNormGradGpuKernel() = default;
@@ -477,53 +486,26 @@ class LayerNormGradGpuKernel final : public user_op::OpKernel {
     const user_op::Tensor* mean = ctx->Tensor4ArgNameAndIndex("mean", 0);
     const user_op::Tensor* inv_variance = ctx->Tensor4ArgNameAndIndex("inv_variance", 0);
     user_op::Tensor* dx = ctx->Tensor4ArgNameAndIndex("dx", 0);
-    user_op::Tensor* tmp_buffer = ctx->Tensor4ArgNameAndIndex("tmp_buffer", 0);
-    const size_t aligned_buffer_size =
-        GetCudaAlignedSize(mean->shape().elem_cnt() * GetSizeOfDataType(mean->data_type()));
-    char* cudnn_bn_scale_ones_dptr = tmp_buffer->mut_dptr<char>();
-    char* cudnn_bn_scale_diff_buf_dptr = cudnn_bn_scale_ones_dptr + aligned_buffer_size;
-    char* cudnn_bn_bias_diff_buf_dptr = cudnn_bn_scale_ones_dptr + aligned_buffer_size;
-    NewKernelUtil<DeviceType::kGPU>::Fill(ctx->device_ctx(), mean->shape().elem_cnt(),
-                                          static_cast<BNParamT>(1),
-                                          reinterpret_cast<BNParamT*>(cudnn_bn_scale_ones_dptr));
-    const void* sp_alpha = CudnnSPOnePtr<T>();
-    const void* sp_beta;
+    const int64_t num_instances = mean->shape().elem_cnt();
+    const int64_t norm_size = x->shape().elem_cnt() / num_instances;
+    const T* add_to_output_ptr = nullptr;
     if (ctx->has_input("_add_to_output", 0)) {
       const user_op::Tensor* add_to_output = ctx->Tensor4ArgNameAndIndex("_add_to_output", 0);
       CHECK_EQ(add_to_output->data_type(), dx->data_type());
       CHECK_EQ(add_to_output->shape(), dx->shape());
-      Memcpy<DeviceType::kGPU>(
-          ctx->device_ctx(), dx->mut_dptr<void>(), add_to_output->dptr<void>(),
-          add_to_output->shape().elem_cnt() * GetSizeOfDataType(add_to_output->data_type()));
-      sp_beta = CudnnSPOnePtr<T>();
-    } else {
-      sp_beta = CudnnSPZeroPtr<T>();
+      add_to_output_ptr = add_to_output->dptr<T>();
     }
-    const double epsilon = ctx->Attr<double>("epsilon");
-    CHECK_GE(epsilon, CUDNN_BN_MIN_EPSILON);
-    LayerNormCudnnBnCtx bn_ctx(x->shape(), mean->shape(), x->data_type());
-    OF_CUDNN_CHECK(cudnnBatchNormalizationBackward(
-        ctx->device_ctx()->cudnn_handle(), bn_ctx.mode(), sp_alpha, sp_beta, CudnnSPOnePtr<T>(),
-        CudnnSPZeroPtr<T>(), bn_ctx.data_tensor_desc(), x->dptr<T>(), bn_ctx.data_tensor_desc(),
-        dy->dptr<T>(), bn_ctx.data_tensor_desc(), dx->mut_dptr<T>(), bn_ctx.param_tensor_desc(),
-        reinterpret_cast<const BNParamT*>(cudnn_bn_scale_ones_dptr),
-        reinterpret_cast<BNParamT*>(cudnn_bn_scale_diff_buf_dptr),
-        reinterpret_cast<BNParamT*>(cudnn_bn_bias_diff_buf_dptr), epsilon, mean->dptr(),
-        inv_variance->dptr()));
+    LayerNormBackwardGpu<T>(ctx->device_ctx(), num_instances, norm_size, dy->dptr<T>(),
+                            x->dptr<T>(), mean, inv_variance, add_to_output_ptr,
+                            dx->mut_dptr<T>());
   };
 };
 
-#define REGISTER_LAYER_NORM_GRAD_GPU_KERNEL(dtype, bn_param_dtype)                              \
+#define REGISTER_LAYER_NORM_GRAD_GPU_KERNEL(dtype)                                              \
   REGISTER_USER_KERNEL("layer_norm_grad")                                                       \
-      .SetCreateFn<LayerNormGradGpuKernel<dtype, bn_param_dtype>>()                             \
+      .SetCreateFn<LayerNormGradGpuKernel<dtype>>()                                             \
       .SetIsMatchedHob((user_op::HobDeviceTag() == "gpu")                                       \
                        & (user_op::HobDataType("dy", 0) == GetDataType<dtype>::value))          \
-      .SetInferTmpSizeFn([](oneflow::user_op::InferContext* ctx) {                              \
-        const user_op::TensorDesc& mean = ctx->InputTensorDesc("mean", 0);                      \
-        const DataType& data_type = mean.data_type();                                           \
-        const int64_t elem_cnt = mean.shape().elem_cnt();                                       \
-        return GetCudaAlignedSize(elem_cnt * GetSizeOfDataType(data_type)) * 3;                 \
-      })                                                                                        \
       .SetInplaceProposalFn([](const user_op::InferContext& ctx,                                \
                                user_op::AddInplaceArgPair AddInplaceArgPairFn) -> Maybe<void> { \
         if (ctx.has_input("_add_to_output", 0)) {                                               \
@@ -532,9 +514,9 @@ class LayerNormGradGpuKernel final : public user_op::OpKernel {
         return Maybe<void>::Ok();                                                               \
       });
 
-REGISTER_LAYER_NORM_GRAD_GPU_KERNEL(float, float)
-REGISTER_LAYER_NORM_GRAD_GPU_KERNEL(double, double)
-REGISTER_LAYER_NORM_GRAD_GPU_KERNEL(float16, float)
+REGISTER_LAYER_NORM_GRAD_GPU_KERNEL(float)
+REGISTER_LAYER_NORM_GRAD_GPU_KERNEL(double)
+REGISTER_LAYER_NORM_GRAD_GPU_KERNEL(float16)
 
 template<typename T>
 class LayerNormParamGradGpuKernel final : public user_op::OpKernel {
@@ -112,7 +112,8 @@ class MathBinaryElementwiseYGradGpuKernel final : public user_op::OpKernel {
           MathBinaryElementwiseGpuKernel<OF_PP_CAT(OF_PP_PAIR_SECOND(math_type_pair), Functor), \
                                          OF_PP_PAIR_FIRST(data_type_pair)>>()                   \
       .SetIsMatchedHob((user_op::HobDeviceTag() == "gpu")                                       \
-                       & (user_op::HobDataType("x", 0) == OF_PP_PAIR_SECOND(data_type_pair)));  \
+                       & (user_op::HobDataType("x", 0) == OF_PP_PAIR_SECOND(data_type_pair)))   \
+      .SetInferFlopsFn(user_op::FlopsInferFnUtil::OutputElemCnt);                               \
                                                                                                 \
   REGISTER_USER_KERNEL((std::string("") + OF_PP_PAIR_FIRST(math_type_pair) + "_x_grad"))        \
       .SetCreateFn<MathBinaryElementwiseXGradGpuKernel<                                         \
@@ -15,9 +15,57 @@ limitations under the License.
 */
 #include "oneflow/core/framework/framework.h"
 #include "oneflow/user/kernels/math_unary_elementwise_func.h"
+#include "oneflow/core/common/eigen_util.h"
 
 namespace oneflow {
 
+namespace {
+
+template<typename T>
+using EigenVectorMap = Eigen::Map<Eigen::Array<T, Eigen::Dynamic, 1>>;
+
+template<typename T>
+using ConstEigenVectorMap = Eigen::Map<const Eigen::Array<T, Eigen::Dynamic, 1>>;
+
+// Eigen evaluates these functors with the packet math of the ISA the host code is built for
+// (SSE/AVX/AVX-512 or NEON), including its vectorized approximations of exp, log, tanh and
+// logistic, so they need not be vectorized by the compiler from the scalar functors.
+template<template<typename> class UnaryFunctor, typename T>
+struct EigenUnaryFunctor {
+  static const bool value = false;
+  static void Forward(const ConstEigenVectorMap<T>& x, EigenVectorMap<T>* y) { UNIMPLEMENTED(); }
+  static void Backward(const ConstEigenVectorMap<T>& x, const ConstEigenVectorMap<T>& dy,
+                       EigenVectorMap<T>* dx) {
+    UNIMPLEMENTED();
+  }
+};
+
+#define SPECIALIZE_EIGEN_UNARY_FUNCTOR(functor, forward_expr, backward_expr)                  \
+  template<typename T>                                                                        \
+  struct EigenUnaryFunctor<functor, T> {                                                      \
+    static const bool value = true;                                                           \
+    static void Forward(const ConstEigenVectorMap<T>& x, EigenVectorMap<T>* y) {              \
+      *y = forward_expr;                                                                      \
+    }                                                                                         \
+    static void Backward(const ConstEigenVectorMap<T>& x, const ConstEigenVectorMap<T>& dy,   \
+                         EigenVectorMap<T>* dx) {                                             \
+      *dx = backward_expr;                                                                    \
+    }                                                                                         \
+  };
+
+SPECIALIZE_EIGEN_UNARY_FUNCTOR(ExpFunctor, x.exp(), dy * x.exp())
+SPECIALIZE_EIGEN_UNARY_FUNCTOR(LogFunctor, x.log(), dy / x)
+SPECIALIZE_EIGEN_UNARY_FUNCTOR(SqrtFunctor, x.sqrt(), dy * T(0.5) / x.sqrt())
+SPECIALIZE_EIGEN_UNARY_FUNCTOR(RsqrtFunctor, x.rsqrt(), dy * T(-0.5) * x.rsqrt() / x)
+SPECIALIZE_EIGEN_UNARY_FUNCTOR(SquareFunctor, x.square(), dy * T(2) * x)
+SPECIALIZE_EIGEN_UNARY_FUNCTOR(ReciprocalFunctor, x.inverse(), -dy * x.square().inverse())
+SPECIALIZE_EIGEN_UNARY_FUNCTOR(TanhFunctor, x.tanh(), dy * (T(1) - x.tanh().square()))
+SPECIALIZE_EIGEN_UNARY_FUNCTOR(SigmoidFunctor, x.logistic(),
+                               dy * x.logistic() * (T(1) - x.logistic()))
+#undef SPECIALIZE_EIGEN_UNARY_FUNCTOR
+
+}  // namespace
+
 template<template<typename> class UnaryFunctor, typename T>
 class MathUnaryElementwiseCpuKernel final : public user_op::OpKernel {
  public:
@@ -32,7 +80,15 @@ class MathUnaryElementwiseCpuKernel final : public user_op::OpKernel {
     T* y = tensor_y->mut_dptr<T>();
     int64_t n = tensor_x->shape().elem_cnt();
     CHECK_LE(n, GetMaxVal<int32_t>() / 2);
-    for (int32_t i = 0; i < n; ++i) { y[i] = UnaryFunctor<T>::Forward(x[i]); }
+    ctx->device_ctx()->ParallelFor(n, ParallelForGrainSize(1), [&](int64_t begin, int64_t end) {
+      if (EigenUnaryFunctor<UnaryFunctor, T>::value) {
+        EigenVectorMap<T> y_vec(y + begin, end - begin);
+        EigenUnaryFunctor<UnaryFunctor, T>::Forward(
+            ConstEigenVectorMap<T>(x + begin, end - begin), &y_vec);
+      } else {
+        for (int32_t i = begin; i < end; ++i) { y[i] = UnaryFunctor<T>::Forward(x[i]); }
+      }
+    });
   }
   bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
 };
@@ -54,7 +110,16 @@ class MathUnaryElementwiseGradCpuKernel final : public user_op::OpKernel {
     T* dx = tensor_dx->mut_dptr<T>();
     int64_t n = tensor_x->shape().elem_cnt();
     CHECK_LE(n, GetMaxVal<int32_t>() / 2);
-    for (int32_t i = 0; i < n; ++i) { dx[i] = UnaryFunctor<T>::Backward(x[i], dy[i]); }
+    ctx->device_ctx()->ParallelFor(n, ParallelForGrainSize(1), [&](int64_t begin, int64_t end) {
+      if (EigenUnaryFunctor<UnaryFunctor, T>::value) {
+        EigenVectorMap<T> dx_vec(dx + begin, end - begin);
+        EigenUnaryFunctor<UnaryFunctor, T>::Backward(
+            ConstEigenVectorMap<T>(x + begin, end - begin),
+            ConstEigenVectorMap<T>(dy + begin, end - begin), &dx_vec);
+      } else {
+        for (int32_t i = begin; i < end; ++i) { dx[i] = UnaryFunctor<T>::Backward(x[i], dy[i]); }
+      }
+    });
   }
   bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
 };
@@ -66,7 +131,8 @@ class MathUnaryElementwiseGradCpuKernel final : public user_op::OpKernel {
                                         OF_PP_PAIR_FIRST(data_type_pair)>>()                       \
       .SetIsMatchedHob((user_op::HobDeviceTag() == "cpu")                                          \
                        & (user_op::HobDataType("x", 0) == OF_PP_PAIR_SECOND(data_type_pair))       \
-                       & (user_op::HobDataType("y", 0) == OF_PP_PAIR_SECOND(data_type_pair)));     \
+                       & (user_op::HobDataType("y", 0) == OF_PP_PAIR_SECOND(data_type_pair)))      \
+      .SetInferFlopsFn(user_op::FlopsInferFnUtil::OutputElemCnt);                                  \
                                                                                                    \
   REGISTER_USER_KERNEL((std::string("") + OF_PP_PAIR_FIRST(math_type_pair) + "_grad"))             \
       .SetCreateFn<                                                                                \
@@ -14,6 +14,8 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #include "oneflow/core/framework/framework.h"
+#include "oneflow/core/kernel/cuda_graph_support.h"
+#include "oneflow/core/cuda/elementwise.cuh"
 #include "oneflow/user/kernels/math_unary_elementwise_func.h"
 
 namespace oneflow {
@@ -21,19 +23,20 @@ namespace oneflow {
 namespace {
 
 template<template<typename> class UnaryFunctor, typename T>
-__global__ void MathUnaryElementwiseForwardGpu(const int n, const T* x, T* y) {
-  CUDA_1D_KERNEL_LOOP(i, n) { y[i] = UnaryFunctor<T>::Forward(x[i]); }
-}
+struct MathUnaryElementwiseForwardFunctor {
+  __device__ T operator()(T x) const { return UnaryFunctor<T>::Forward(x); }
+};
 
 template<template<typename> class UnaryFunctor, typename T>
-__global__ void MathUnaryElementwiseBackwardGpu(const int n, const T* x, const T* dy, T* dx) {
-  CUDA_1D_KERNEL_LOOP(i, n) { dx[i] = UnaryFunctor<T>::Backward(x[i], dy[i]); }
-}
+struct MathUnaryElementwiseBackwardFunctor {
+  __device__ T operator()(T x, T dy) const { return UnaryFunctor<T>::Backward(x, dy); }
+};
 
 }  // namespace
 
 template<template<typename> class UnaryFunctor, typename T>
-class MathUnaryElementwiseGpuKernel final : public user_op::OpKernel {
+class MathUnaryElementwiseGpuKernel final : public user_op::OpKernel,
+                                            public user_op::CudaGraphSupport {
  public:
   MathUnaryElementwiseGpuKernel() = default;
   ~MathUnaryElementwiseGpuKernel() = default;
@@ -45,17 +48,17 @@ class MathUnaryElementwiseGpuKernel final : public user_op::OpKernel {
     const T* x = tensor_x->dptr<T>();
     T* y = tensor_y->mut_dptr<T>();
     int64_t n = tensor_x->shape().elem_cnt();
-    CHECK_LE(n, GetMaxVal<int32_t>() / 2);
     if (n == 0) { return; }
-    MathUnaryElementwiseForwardGpu<UnaryFunctor, T>
-        <<<BlocksNum4ThreadsNum(n), kCudaThreadsNumPerBlock, 0, ctx->device_ctx()->cuda_stream()>>>(
-            n, x, y);
+    OF_CUDA_CHECK(cuda::elementwise::Unary(
+        MathUnaryElementwiseForwardFunctor<UnaryFunctor, T>(), n, y, x,
+        ctx->device_ctx()->cuda_stream()));
   }
   bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
 };
 
 template<template<typename> class UnaryFunctor, typename T>
-class MathUnaryElementwiseGradGpuKernel final : public user_op::OpKernel {
+class MathUnaryElementwiseGradGpuKernel final : public user_op::OpKernel,
+                                                public user_op::CudaGraphSupport {
  public:
   MathUnaryElementwiseGradGpuKernel() = default;
   ~MathUnaryElementwiseGradGpuKernel() = default;
@@ -70,11 +73,10 @@ class MathUnaryElementwiseGradGpuKernel final : public user_op::OpKernel {
     const T* dy = tensor_dy->dptr<T>();
     T* dx = tensor_dx->mut_dptr<T>();
     int64_t n = tensor_x->shape().elem_cnt();
-    CHECK_LE(n, GetMaxVal<int32_t>() / 2);
     if (n == 0) { return; }
-    MathUnaryElementwiseBackwardGpu<UnaryFunctor, T>
-        <<<BlocksNum4ThreadsNum(n), kCudaThreadsNumPerBlock, 0, ctx->device_ctx()->cuda_stream()>>>(
-            n, x, dy, dx);
+    OF_CUDA_CHECK(cuda::elementwise::Binary(
+        MathUnaryElementwiseBackwardFunctor<UnaryFunctor, T>(), n, dx, x, dy,
+        ctx->device_ctx()->cuda_stream()));
   }
   bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
 };
@@ -86,7 +88,8 @@ class MathUnaryElementwiseGradGpuKernel final : public user_op::OpKernel {
                                         OF_PP_PAIR_FIRST(data_type_pair)>>()                       \
       .SetIsMatchedHob((user_op::HobDeviceTag() == "gpu")                                          \
                        & (user_op::HobDataType("x", 0) == OF_PP_PAIR_SECOND(data_type_pair))       \
-                       & (user_op::HobDataType("y", 0) == OF_PP_PAIR_SECOND(data_type_pair)));     \
+                       & (user_op::HobDataType("y", 0) == OF_PP_PAIR_SECOND(data_type_pair)))      \
+      .SetInferFlopsFn(user_op::FlopsInferFnUtil::OutputElemCnt);                                  \
                                                                                                    \
   REGISTER_USER_KERNEL((std::string("") + OF_PP_PAIR_FIRST(math_type_pair) + "_grad"))             \
       .SetCreateFn<                                                                                \
@@ -99,7 +102,8 @@ OF_PP_SEQ_PRODUCT_FOR_EACH_TUPLE(REGISTER_MATH_UNARY_ELEMENTWISE_GPU_KERNEL_AND_
                                  MATH_UNARY_ELEMENTWISE_FUNC_SEQ, FLOATING_DATA_TYPE_SEQ)
 
 template<template<typename> class UnaryFunctor>
-class MathUnaryElementwiseGpuHalfKernel final : public user_op::OpKernel {
+class MathUnaryElementwiseGpuHalfKernel final : public user_op::OpKernel,
+                                                public user_op::CudaGraphSupport {
  public:
   MathUnaryElementwiseGpuHalfKernel() = default;
   ~MathUnaryElementwiseGpuHalfKernel() = default;
@@ -111,17 +115,17 @@ class MathUnaryElementwiseGpuHalfKernel final : public user_op::OpKernel {
     const half* x = reinterpret_cast<const half*>(tensor_x->dptr<float16>());
     half* y = reinterpret_cast<half*>(tensor_y->mut_dptr<float16>());
     int64_t n = tensor_x->shape().elem_cnt();
-    CHECK_LE(n, GetMaxVal<int32_t>() / 2);
     if (n == 0) { return; }
-    MathUnaryElementwiseForwardGpu<UnaryFunctor, half>
-        <<<BlocksNum4ThreadsNum(n), kCudaThreadsNumPerBlock, 0, ctx->device_ctx()->cuda_stream()>>>(
-            n, x, y);
+    OF_CUDA_CHECK(cuda::elementwise::Unary(
+        MathUnaryElementwiseForwardFunctor<UnaryFunctor, half>(), n, y, x,
+        ctx->device_ctx()->cuda_stream()));
   }
   bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
 };
 
 template<template<typename> class UnaryFunctor>
-class MathUnaryElementwiseGradGpuHalfKernel final : public user_op::OpKernel {
+class MathUnaryElementwiseGradGpuHalfKernel final : public user_op::OpKernel,
+                                                    public user_op::CudaGraphSupport {
  public:
   MathUnaryElementwiseGradGpuHalfKernel() = default;
   ~MathUnaryElementwiseGradGpuHalfKernel() = default;
@@ -136,11 +140,10 @@ class MathUnaryElementwiseGradGpuHalfKernel final : public user_op::OpKernel {
     const half* dy = reinterpret_cast<const half*>(tensor_dy->dptr<float16>());
     half* dx = reinterpret_cast<half*>(tensor_dx->mut_dptr<float16>());
     int64_t n = tensor_x->shape().elem_cnt();
-    CHECK_LE(n, GetMaxVal<int32_t>() / 2);
     if (n == 0) { return; }
-    MathUnaryElementwiseBackwardGpu<UnaryFunctor, half>
-        <<<BlocksNum4ThreadsNum(n), kCudaThreadsNumPerBlock, 0, ctx->device_ctx()->cuda_stream()>>>(
-            n, x, dy, dx);
+    OF_CUDA_CHECK(cuda::elementwise::Binary(
+        MathUnaryElementwiseBackwardFunctor<UnaryFunctor, half>(), n, dx, x, dy,
+        ctx->device_ctx()->cuda_stream()));
   }
   bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
 };
@@ -30,6 +30,15 @@ std::tuple<int32_t, int32_t, int32_t> CalcMNK(const ShapeView& a_shape, const Sh
   return std::make_tuple(m, n, k);
 }
 
+// a multiply and an add per element of out and per element of the reduced axis of a
+int64_t MatmulFlops(user_op::InferContext* ctx) {
+  const Shape& a_shape = ctx->InputShape("a", 0);
+  const int64_t num_axes = a_shape.NumAxes();
+  const int64_t k =
+      ctx->Attr<bool>("transpose_a") ? a_shape.At(num_axes - 2) : a_shape.At(num_axes - 1);
+  return 2 * ctx->Shape4ArgNameAndIndex("out", 0)->elem_cnt() * k;
+}
+
 }  // namespace
 
 template<DeviceType device_type, typename T>
@@ -74,6 +83,7 @@ class MatmulFloatingKernel final : public user_op::OpKernel {
       .SetCreateFn<MatmulFloatingKernel<device, dtype>>()                                       \
       .SetIsMatchedHob((user_op::HobDeviceTag() == device)                                      \
                        & (user_op::HobDataType("a", 0) == GetDataType<dtype>::value))           \
+      .SetInferFlopsFn(MatmulFlops)                                                             \
       .SetInplaceProposalFn([](const user_op::InferContext& ctx,                                \
                                user_op::AddInplaceArgPair AddInplaceArgPairFn) -> Maybe<void> { \
         if (ctx.has_input("_add_to_output", 0)) {                                               \
@@ -132,6 +142,7 @@ REGISTER_USER_KERNEL("matmul")
     .SetCreateFn<MatmulGpuHalfKernel>()
     .SetIsMatchedHob((user_op::HobDeviceTag() == "gpu")
                      & (user_op::HobDataType("a", 0) == DataType::kFloat16))
+    .SetInferFlopsFn(MatmulFlops)
     .SetInplaceProposalFn([](const user_op::InferContext& ctx,
                              user_op::AddInplaceArgPair AddInplaceArgPairFn) -> Maybe<void> {
       if (ctx.has_input("_add_to_output", 0)) {
@@ -186,6 +197,7 @@ class BatchMatmulFloatingKernel final : public user_op::OpKernel {
       .SetCreateFn<BatchMatmulFloatingKernel<device, dtype>>()                                  \
       .SetIsMatchedHob((user_op::HobDeviceTag() == device)                                      \
                        & (user_op::HobDataType("a", 0) == GetDataType<dtype>::value))           \
+      .SetInferFlopsFn(MatmulFlops)                                                             \
       .SetInplaceProposalFn([](const user_op::InferContext& ctx,                                \
                                user_op::AddInplaceArgPair AddInplaceArgPairFn) -> Maybe<void> { \
         if (ctx.has_input("_add_to_output", 0)) {                                               \
@@ -243,6 +255,7 @@ REGISTER_USER_KERNEL("batch_matmul")
     .SetCreateFn<BatchMatmulGpuHalfKernel>()
     .SetIsMatchedHob((user_op::HobDeviceTag() == "gpu")
                      & (user_op::HobDataType("a", 0) == DataType::kFloat16))
+    .SetInferFlopsFn(MatmulFlops)
     .SetInplaceProposalFn([](const user_op::InferContext& ctx,
                              user_op::AddInplaceArgPair AddInplaceArgPairFn) -> Maybe<void> {
       if (ctx.has_input("_add_to_output", 0)) {
@@ -343,6 +356,7 @@ class BroadcastMatmulGradBKernel final : public user_op::OpKernel {
       .SetCreateFn<BroadcastMatmulKernel<device, dtype>>()                                      \
       .SetIsMatchedHob((user_op::HobDeviceTag() == device)                                      \
                        & (user_op::HobDataType("a", 0) == GetDataType<dtype>::value))           \
+      .SetInferFlopsFn(MatmulFlops)                                                             \
       .SetInplaceProposalFn([](const user_op::InferContext& ctx,                                \
                                user_op::AddInplaceArgPair AddInplaceArgPairFn) -> Maybe<void> { \
         if (ctx.has_input("_add_to_output", 0)) {                                               \
@@ -246,6 +246,17 @@ void AdamBiasCorrectionLearningRateKernelUtil<DeviceType::kCPU>::AdamBiasCorrect
   *out = *learning_rate * sqrt(1 - beta2_power) / (1 - beta1_power);
 }
 
+template<typename T>
+struct ClipByGlobalNormScaleKernelUtil<DeviceType::kCPU, T> {
+  static void ClipByGlobalNormScale(DeviceCtx* ctx, float clip_norm, const T* square_sum,
+                                    T* scale) {
+    *scale = clip_norm / std::max<T>(std::sqrt(*square_sum), clip_norm);
+  }
+};
+
+template struct ClipByGlobalNormScaleKernelUtil<DeviceType::kCPU, float>;
+template struct ClipByGlobalNormScaleKernelUtil<DeviceType::kCPU, double>;
+
 template<typename T, typename G>
 struct RmsPropUpdateKernelUtil<DeviceType::kCPU, T, G> {
   static void Update(DeviceCtx* ctx, int64_t n, T scale, float l1, float l2, bool centered,
@@ -322,4 +333,77 @@ void LarsUpdateKernelUtil<DeviceType::kCPU, T, G>::Update(
 template struct LarsUpdateKernelUtil<DeviceType::kCPU, float, float>;
 template struct LarsUpdateKernelUtil<DeviceType::kCPU, double, double>;
 
+template<typename T, typename G>
+struct MultiTensorSGDUpdateKernelUtil<DeviceType::kCPU, T, G> {
+  static void Update(DeviceCtx* ctx, T scale, float l1, float l2, float weight_decay,
+                     float learning_rate_val, const TensorTupleParams<2>& params);
+};
+
+template<typename T, typename G>
+void MultiTensorSGDUpdateKernelUtil<DeviceType::kCPU, T, G>::Update(
+    DeviceCtx* ctx, T scale, float l1, float l2, float weight_decay, float learning_rate_val,
+    const TensorTupleParams<2>& params) {
+  FOR_RANGE(int32_t, t, 0, params.num_tensors) {
+    T* model = static_cast<T*>(params.ptr[0][t]);
+    const G* model_diff = static_cast<const G*>(params.ptr[1][t]);
+    FOR_RANGE(int64_t, i, 0, params.sizes[t]) {
+      SGDUpdateFunctor<T, G>()(model_diff + i, model + i, scale, l1, l2, weight_decay,
+                               learning_rate_val);
+    }
+  }
+}
+
+template struct MultiTensorSGDUpdateKernelUtil<DeviceType::kCPU, float, float>;
+template struct MultiTensorSGDUpdateKernelUtil<DeviceType::kCPU, double, double>;
+
+template<typename T, typename G>
+struct MultiTensorMomentumUpdateKernelUtil<DeviceType::kCPU, T, G> {
+  static void Update(DeviceCtx* ctx, T scale, float l1, float l2, float beta, float weight_decay,
+                     float learning_rate_val, const TensorTupleParams<3>& params);
+};
+
+template<typename T, typename G>
+void MultiTensorMomentumUpdateKernelUtil<DeviceType::kCPU, T, G>::Update(
+    DeviceCtx* ctx, T scale, float l1, float l2, float beta, float weight_decay,
+    float learning_rate_val, const TensorTupleParams<3>& params) {
+  FOR_RANGE(int32_t, t, 0, params.num_tensors) {
+    T* model = static_cast<T*>(params.ptr[0][t]);
+    const G* model_diff = static_cast<const G*>(params.ptr[1][t]);
+    T* momentum = static_cast<T*>(params.ptr[2][t]);
+    FOR_RANGE(int64_t, i, 0, params.sizes[t]) {
+      MomentumUpdateFunctor<T, G>()(model_diff + i, model + i, momentum + i, scale, l1, l2, beta,
+                                    weight_decay, learning_rate_val);
+    }
+  }
+}
+
+template struct MultiTensorMomentumUpdateKernelUtil<DeviceType::kCPU, float, float>;
+template struct MultiTensorMomentumUpdateKernelUtil<DeviceType::kCPU, double, double>;
+
+template<typename T, typename G>
+struct MultiTensorAdamUpdateKernelUtil<DeviceType::kCPU, T, G> {
+  static void Update(DeviceCtx* ctx, T scale, float l1, float l2, float beta1, float beta2,
+                     float epsilon, float weight_decay, float learning_rate_val,
+                     const TensorTupleParams<4>& params);
+};
+
+template<typename T, typename G>
+void MultiTensorAdamUpdateKernelUtil<DeviceType::kCPU, T, G>::Update(
+    DeviceCtx* ctx, T scale, float l1, float l2, float beta1, float beta2, float epsilon,
+    float weight_decay, float learning_rate_val, const TensorTupleParams<4>& params) {
+  FOR_RANGE(int32_t, t, 0, params.num_tensors) {
+    T* model = static_cast<T*>(params.ptr[0][t]);
+    const G* model_diff = static_cast<const G*>(params.ptr[1][t]);
+    T* m = static_cast<T*>(params.ptr[2][t]);
+    T* v = static_cast<T*>(params.ptr[3][t]);
+    FOR_RANGE(int64_t, i, 0, params.sizes[t]) {
+      AdamUpdateFunctor<T, G>()(model_diff + i, model + i, m + i, v + i, scale, l1, l2, beta1,
+                                beta2, epsilon, weight_decay, learning_rate_val);
+    }
+  }
+}
+
+template struct MultiTensorAdamUpdateKernelUtil<DeviceType::kCPU, float, float>;
+template struct MultiTensorAdamUpdateKernelUtil<DeviceType::kCPU, double, double>;
+
 }  // namespace oneflow
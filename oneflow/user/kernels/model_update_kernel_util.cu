@@ -445,6 +445,27 @@ void AdamBiasCorrectionLearningRateKernelUtil<DeviceType::kGPU>::AdamBiasCorrect
 
 namespace {
 
+template<typename T>
+__global__ void ClipByGlobalNormScaleGpu(float clip_norm, const T* square_sum, T* scale) {
+  const T norm = sqrt(*square_sum);
+  *scale = clip_norm / (norm > clip_norm ? norm : static_cast<T>(clip_norm));
+}
+
+}  // namespace
+
+template<typename T>
+struct ClipByGlobalNormScaleKernelUtil<DeviceType::kGPU, T> {
+  static void ClipByGlobalNormScale(DeviceCtx* ctx, float clip_norm, const T* square_sum,
+                                    T* scale) {
+    ClipByGlobalNormScaleGpu<T><<<1, 1, 0, ctx->cuda_stream()>>>(clip_norm, square_sum, scale);
+  }
+};
+
+template struct ClipByGlobalNormScaleKernelUtil<DeviceType::kGPU, float>;
+template struct ClipByGlobalNormScaleKernelUtil<DeviceType::kGPU, double>;
+
+namespace {
+
 template<typename T, typename G, bool centered>
 __global__ void RmsPropUpdateGpu(int64_t n, T scale, float l1, float l2, T* mean_square,
                                  T* mean_gradient, float epsilon, float weight_decay,
@@ -614,4 +635,161 @@ template struct LarsUpdateKernelUtil<DeviceType::kGPU, float, float>;
 template struct LarsUpdateKernelUtil<DeviceType::kGPU, double, double>;
 template struct LarsUpdateKernelUtil<DeviceType::kGPU, float, float16>;
 
+namespace {
+
+template<int N>
+int32_t MultiTensorBlocksNum(const TensorTupleParams<N>& params) {
+  int64_t max_size = 0;
+  FOR_RANGE(int32_t, t, 0, params.num_tensors) { max_size = std::max(max_size, params.sizes[t]); }
+  return BlocksNum4ThreadsNum(max_size);
+}
+
+// blockIdx.y selects the tensor, the blocks along x stride over its elements.
+template<typename T, typename G>
+__global__ void MultiTensorSGDUpdateGpu(T scale, float l1, float l2, float weight_decay,
+                                        float learning_rate_val, TensorTupleParams<2> params) {
+  const int32_t t = blockIdx.y;
+  T* model = static_cast<T*>(params.ptr[0][t]);
+  const G* model_diff = static_cast<const G*>(params.ptr[1][t]);
+  CUDA_1D_KERNEL_LOOP_T(int64_t, i, params.sizes[t]) {
+    SGDUpdateFunctor<T, G>()(model_diff + i, model + i, scale, l1, l2, weight_decay,
+                             learning_rate_val);
+  }
+}
+
+template<typename T, typename G>
+__global__ void MultiTensorMomentumUpdateGpu(T scale, float l1, float l2, float beta,
+                                             float weight_decay, float learning_rate_val,
+                                             TensorTupleParams<3> params) {
+  const int32_t t = blockIdx.y;
+  T* model = static_cast<T*>(params.ptr[0][t]);
+  const G* model_diff = static_cast<const G*>(params.ptr[1][t]);
+  T* momentum = static_cast<T*>(params.ptr[2][t]);
+  CUDA_1D_KERNEL_LOOP_T(int64_t, i, params.sizes[t]) {
+    MomentumUpdateFunctor<T, G>()(model_diff + i, model + i, momentum + i, scale, l1, l2, beta,
+                                  weight_decay, learning_rate_val);
+  }
+}
+
+template<typename T, typename G>
+__global__ void MultiTensorAdamUpdateGpu(T scale, float l1, float l2, float beta1, float beta2,
+                                         float epsilon, float weight_decay,
+                                         float learning_rate_val, TensorTupleParams<4> params) {
+  const int32_t t = blockIdx.y;
+  T* model = static_cast<T*>(params.ptr[0][t]);
+  const G* model_diff = static_cast<const G*>(params.ptr[1][t]);
+  T* m = static_cast<T*>(params.ptr[2][t]);
+  T* v = static_cast<T*>(params.ptr[3][t]);
+  CUDA_1D_KERNEL_LOOP_T(int64_t, i, params.sizes[t]) {
+    AdamUpdateFunctor<T, G>()(model_diff + i, model + i, m + i, v + i, scale, l1, l2, beta1, beta2,
+                              epsilon, weight_decay, learning_rate_val);
+  }
+}
+
+}  // namespace
+
+template<typename T, typename G>
+struct MultiTensorSGDUpdateKernelUtil<DeviceType::kGPU, T, G> {
+  static void Update(DeviceCtx* ctx, T scale, float l1, float l2, float weight_decay,
+                     float learning_rate_val, const TensorTupleParams<2>& params);
+};
+
+template<typename T, typename G>
+void MultiTensorSGDUpdateKernelUtil<DeviceType::kGPU, T, G>::Update(
+    DeviceCtx* ctx, T scale, float l1, float l2, float weight_decay, float learning_rate_val,
+    const TensorTupleParams<2>& params) {
+  if (params.num_tensors == 0) { return; }
+  const dim3 grid(MultiTensorBlocksNum(params), params.num_tensors);
+  MultiTensorSGDUpdateGpu<T, G><<<grid, kCudaThreadsNumPerBlock, 0, ctx->cuda_stream()>>>(
+      scale, l1, l2, weight_decay, learning_rate_val, params);
+}
+
+template<typename T>
+struct MultiTensorSGDUpdateKernelUtil<DeviceType::kGPU, T, float16> {
+  static void Update(DeviceCtx* ctx, T scale, float l1, float l2, float weight_decay,
+                     float learning_rate_val, const TensorTupleParams<2>& params);
+};
+
+template<typename T>
+void MultiTensorSGDUpdateKernelUtil<DeviceType::kGPU, T, float16>::Update(
+    DeviceCtx* ctx, T scale, float l1, float l2, float weight_decay, float learning_rate_val,
+    const TensorTupleParams<2>& params) {
+  MultiTensorSGDUpdateKernelUtil<DeviceType::kGPU, T, half>::Update(
+      ctx, scale, l1, l2, weight_decay, learning_rate_val, params);
+}
+
+template struct MultiTensorSGDUpdateKernelUtil<DeviceType::kGPU, double, double>;
+template struct MultiTensorSGDUpdateKernelUtil<DeviceType::kGPU, float, float>;
+template struct MultiTensorSGDUpdateKernelUtil<DeviceType::kGPU, float, float16>;
+
+template<typename T, typename G>
+struct MultiTensorMomentumUpdateKernelUtil<DeviceType::kGPU, T, G> {
+  static void Update(DeviceCtx* ctx, T scale, float l1, float l2, float beta, float weight_decay,
+                     float learning_rate_val, const TensorTupleParams<3>& params);
+};
+
+template<typename T, typename G>
+void MultiTensorMomentumUpdateKernelUtil<DeviceType::kGPU, T, G>::Update(
+    DeviceCtx* ctx, T scale, float l1, float l2, float beta, float weight_decay,
+    float learning_rate_val, const TensorTupleParams<3>& params) {
+  if (params.num_tensors == 0) { return; }
+  const dim3 grid(MultiTensorBlocksNum(params), params.num_tensors);
+  MultiTensorMomentumUpdateGpu<T, G><<<grid, kCudaThreadsNumPerBlock, 0, ctx->cuda_stream()>>>(
+      scale, l1, l2, beta, weight_decay, learning_rate_val, params);
+}
+
+template<typename T>
+struct MultiTensorMomentumUpdateKernelUtil<DeviceType::kGPU, T, float16> {
+  static void Update(DeviceCtx* ctx, T scale, float l1, float l2, float beta, float weight_decay,
+                     float learning_rate_val, const TensorTupleParams<3>& params);
+};
+
+template<typename T>
+void MultiTensorMomentumUpdateKernelUtil<DeviceType::kGPU, T, float16>::Update(
+    DeviceCtx* ctx, T scale, float l1, float l2, float beta, float weight_decay,
+    float learning_rate_val, const TensorTupleParams<3>& params) {
+  MultiTensorMomentumUpdateKernelUtil<DeviceType::kGPU, T, half>::Update(
+      ctx, scale, l1, l2, beta, weight_decay, learning_rate_val, params);
+}
+
+template struct MultiTensorMomentumUpdateKernelUtil<DeviceType::kGPU, double, double>;
+template struct MultiTensorMomentumUpdateKernelUtil<DeviceType::kGPU, float, float>;
+template struct MultiTensorMomentumUpdateKernelUtil<DeviceType::kGPU, float, float16>;
+
+template<typename T, typename G>
+struct MultiTensorAdamUpdateKernelUtil<DeviceType::kGPU, T, G> {
+  static void Update(DeviceCtx* ctx, T scale, float l1, float l2, float beta1, float beta2,
+                     float epsilon, float weight_decay, float learning_rate_val,
+                     const TensorTupleParams<4>& params);
+};
+
+template<typename T, typename G>
+void MultiTensorAdamUpdateKernelUtil<DeviceType::kGPU, T, G>::Update(
+    DeviceCtx* ctx, T scale, float l1, float l2, float beta1, float beta2, float epsilon,
+    float weight_decay, float learning_rate_val, const TensorTupleParams<4>& params) {
+  if (params.num_tensors == 0) { return; }
+  const dim3 grid(MultiTensorBlocksNum(params), params.num_tensors);
+  MultiTensorAdamUpdateGpu<T, G><<<grid, kCudaThreadsNumPerBlock, 0, ctx->cuda_stream()>>>(
+      scale, l1, l2, beta1, beta2, epsilon, weight_decay, learning_rate_val, params);
+}
+
+template<typename T>
+struct MultiTensorAdamUpdateKernelUtil<DeviceType::kGPU, T, float16> {
+  static void Update(DeviceCtx* ctx, T scale, float l1, float l2, float beta1, float beta2,
+                     float epsilon, float weight_decay, float learning_rate_val,
+                     const TensorTupleParams<4>& params);
+};
+
+template<typename T>
+void MultiTensorAdamUpdateKernelUtil<DeviceType::kGPU, T, float16>::Update(
+    DeviceCtx* ctx, T scale, float l1, float l2, float beta1, float beta2, float epsilon,
+    float weight_decay, float learning_rate_val, const TensorTupleParams<4>& params) {
+  MultiTensorAdamUpdateKernelUtil<DeviceType::kGPU, T, half>::Update(
+      ctx, scale, l1, l2, beta1, beta2, epsilon, weight_decay, learning_rate_val, params);
+}
+
+template struct MultiTensorAdamUpdateKernelUtil<DeviceType::kGPU, double, double>;
+template struct MultiTensorAdamUpdateKernelUtil<DeviceType::kGPU, float, float>;
+template struct MultiTensorAdamUpdateKernelUtil<DeviceType::kGPU, float, float16>;
+
 }  // namespace oneflow
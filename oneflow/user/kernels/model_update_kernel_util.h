@@ -181,6 +181,14 @@ struct AdamBiasCorrectionLearningRateKernelUtil {
                                              float* out);
 };
 
+// scale = clip_norm / max(sqrt(square_sum), clip_norm), it is consumed by the update kernels as
+// scale_by_tensor so the clipped gradient is never materialized
+template<DeviceType device_type, typename T>
+struct ClipByGlobalNormScaleKernelUtil {
+  static void ClipByGlobalNormScale(DeviceCtx* ctx, float clip_norm, const T* square_sum,
+                                    T* scale);
+};
+
 template<typename T, typename G, bool centered>
 struct RmsPropUpdateFunctor {
   OF_DEVICE_FUNC
@@ -234,6 +242,36 @@ struct LarsUpdateKernelUtil {
                      const G* model_diff, T* model, T* momentum, T* data_tmp, T* model_diff_tmp);
 };
 
+// Addresses and sizes of at most kMaxTensors tensors, passed by value to a single launch. The
+// capacity is chosen so that the struct stays under the 4KB limit of cuda kernel parameters.
+// ptr[0] holds the models, ptr[1] the model diffs and the rest the optimizer states.
+template<int N>
+struct TensorTupleParams {
+  static constexpr int kMaxTensors = 3584 / ((N + 1) * sizeof(void*));
+  void* ptr[N][kMaxTensors];
+  int64_t sizes[kMaxTensors];
+  int32_t num_tensors;
+};
+
+template<DeviceType device_type, typename T, typename G>
+struct MultiTensorSGDUpdateKernelUtil {
+  static void Update(DeviceCtx* ctx, T scale, float l1, float l2, float weight_decay,
+                     float learning_rate_val, const TensorTupleParams<2>& params);
+};
+
+template<DeviceType device_type, typename T, typename G>
+struct MultiTensorMomentumUpdateKernelUtil {
+  static void Update(DeviceCtx* ctx, T scale, float l1, float l2, float beta, float weight_decay,
+                     float learning_rate_val, const TensorTupleParams<3>& params);
+};
+
+template<DeviceType device_type, typename T, typename G>
+struct MultiTensorAdamUpdateKernelUtil {
+  static void Update(DeviceCtx* ctx, T scale, float l1, float l2, float beta1, float beta2,
+                     float epsilon, float weight_decay, float learning_rate_val,
+                     const TensorTupleParams<4>& params);
+};
+
 #endif
 
 }  // namespace oneflow
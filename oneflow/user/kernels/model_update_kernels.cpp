@@ -660,6 +660,35 @@ REGISTER_ADAM_BIAS_CORRECTION_LEARNING_RATE_KERNEL(DeviceType::kCPU)
 REGISTER_ADAM_BIAS_CORRECTION_LEARNING_RATE_KERNEL(DeviceType::kGPU)
 #endif  // WITH_CUDA
 
+template<DeviceType device_type, typename T>
+class ClipByGlobalNormScaleKernel final : public user_op::OpKernel {
+ public:
+  ClipByGlobalNormScaleKernel() = default;
+  ~ClipByGlobalNormScaleKernel() override = default;
+
+ private:
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    const user_op::Tensor* square_sum = ctx->Tensor4ArgNameAndIndex("square_sum", 0);
+    user_op::Tensor* scale = ctx->Tensor4ArgNameAndIndex("scale", 0);
+    ClipByGlobalNormScaleKernelUtil<device_type, T>::ClipByGlobalNormScale(
+        ctx->device_ctx(), ctx->Attr<float>("clip_norm"), square_sum->dptr<T>(),
+        scale->mut_dptr<T>());
+  }
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return true; }
+};
+
+#define REGISTER_CLIP_BY_GLOBAL_NORM_SCALE_KERNEL(device, dtype) \
+  REGISTER_USER_KERNEL("clip_by_global_norm_scale")              \
+      .SetCreateFn<ClipByGlobalNormScaleKernel<device, dtype>>() \
+      .SetIsMatchedHob((user_op::HobDeviceTag() == device)       \
+                       & (user_op::HobDataType("scale", 0) == GetDataType<dtype>::value));
+REGISTER_CLIP_BY_GLOBAL_NORM_SCALE_KERNEL(DeviceType::kCPU, float)
+REGISTER_CLIP_BY_GLOBAL_NORM_SCALE_KERNEL(DeviceType::kCPU, double)
+#ifdef WITH_CUDA
+REGISTER_CLIP_BY_GLOBAL_NORM_SCALE_KERNEL(DeviceType::kGPU, float)
+REGISTER_CLIP_BY_GLOBAL_NORM_SCALE_KERNEL(DeviceType::kGPU, double)
+#endif  // WITH_CUDA
+
 template<DeviceType device_type, typename T, typename G>
 class RmsPropUpdateKernel final : public user_op::OpKernel {
  public:
@@ -829,6 +858,145 @@ REGISTER_LARS_UPDATE_KERNEL(DeviceType::kGPU, float, float);
 REGISTER_LARS_UPDATE_KERNEL(DeviceType::kGPU, double, double);
 #endif  // WITH_CUDA
 
+// Launches `update` once per kMaxTensors tensors of the arg lists named by `arg_names`.
+template<int N, typename UpdateFn>
+void MultiTensorUpdate(user_op::KernelComputeContext* ctx,
+                       const std::array<std::string, N>& arg_names, const UpdateFn& update) {
+  const int32_t num_tensors = ctx->input_size(arg_names.at(0));
+  TensorTupleParams<N> params{};
+  params.num_tensors = 0;
+  FOR_RANGE(int32_t, t, 0, num_tensors) {
+    const user_op::Tensor* model = ctx->Tensor4ArgNameAndIndex(arg_names.at(0), t);
+    FOR_RANGE(int32_t, k, 0, N) {
+      user_op::Tensor* tensor = ctx->Tensor4ArgNameAndIndex(arg_names.at(k), t);
+      CHECK_EQ(tensor->shape().elem_cnt(), model->shape().elem_cnt());
+      params.ptr[k][params.num_tensors] = tensor->mut_dptr();
+    }
+    params.sizes[params.num_tensors] = model->shape().elem_cnt();
+    params.num_tensors += 1;
+    if (params.num_tensors == TensorTupleParams<N>::kMaxTensors || t == num_tensors - 1) {
+      update(params);
+      params.num_tensors = 0;
+    }
+  }
+}
+
+template<DeviceType device_type, typename T, typename G>
+class MultiTensorSGDUpdateKernel final : public user_op::OpKernel {
+ public:
+  MultiTensorSGDUpdateKernel() = default;
+  ~MultiTensorSGDUpdateKernel() override = default;
+
+ private:
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    const auto scale = static_cast<T>(ctx->Attr<double>("scale"));
+    const auto l1 = ctx->Attr<float>("l1");
+    const auto l2 = ctx->Attr<float>("l2");
+    const auto weight_decay = ctx->Attr<float>("weight_decay");
+    const float learning_rate_val = ctx->Attr<float>("learning_rate_val");
+    MultiTensorUpdate<2>(ctx, {"model", "model_diff"}, [&](const TensorTupleParams<2>& params) {
+      MultiTensorSGDUpdateKernelUtil<device_type, T, G>::Update(
+          ctx->device_ctx(), scale, l1, l2, weight_decay, learning_rate_val, params);
+    });
+  }
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return true; }
+};
+
+#define REGISTER_MULTI_TENSOR_SGD_UPDATE_KERNEL(device, dtype, gtype)                    \
+  REGISTER_USER_KERNEL("multi_tensor_sgd_update")                                        \
+      .SetCreateFn<MultiTensorSGDUpdateKernel<device, dtype, gtype>>()                   \
+      .SetIsMatchedHob((user_op::HobDeviceTag() == device)                               \
+                       & (user_op::HobDataType("model", 0) == GetDataType<dtype>::value) \
+                       & (user_op::HobDataType("model_diff", 0) == GetDataType<gtype>::value));
+
+REGISTER_MULTI_TENSOR_SGD_UPDATE_KERNEL(DeviceType::kCPU, float, float);
+REGISTER_MULTI_TENSOR_SGD_UPDATE_KERNEL(DeviceType::kCPU, double, double);
+#ifdef WITH_CUDA
+REGISTER_MULTI_TENSOR_SGD_UPDATE_KERNEL(DeviceType::kGPU, float, float16);
+REGISTER_MULTI_TENSOR_SGD_UPDATE_KERNEL(DeviceType::kGPU, float, float);
+REGISTER_MULTI_TENSOR_SGD_UPDATE_KERNEL(DeviceType::kGPU, double, double);
+#endif  // WITH_CUDA
+
+template<DeviceType device_type, typename T, typename G>
+class MultiTensorMomentumUpdateKernel final : public user_op::OpKernel {
+ public:
+  MultiTensorMomentumUpdateKernel() = default;
+  ~MultiTensorMomentumUpdateKernel() override = default;
+
+ private:
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    const auto scale = static_cast<T>(ctx->Attr<double>("scale"));
+    const auto l1 = ctx->Attr<float>("l1");
+    const auto l2 = ctx->Attr<float>("l2");
+    const auto beta = ctx->Attr<float>("beta");
+    const auto weight_decay = ctx->Attr<float>("weight_decay");
+    const float learning_rate_val = ctx->Attr<float>("learning_rate_val");
+    MultiTensorUpdate<3>(ctx, {"model", "model_diff", "momentum"},
+                         [&](const TensorTupleParams<3>& params) {
+                           MultiTensorMomentumUpdateKernelUtil<device_type, T, G>::Update(
+                               ctx->device_ctx(), scale, l1, l2, beta, weight_decay,
+                               learning_rate_val, params);
+                         });
+  }
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return true; }
+};
+
+#define REGISTER_MULTI_TENSOR_MOMENTUM_UPDATE_KERNEL(device, dtype, gtype)               \
+  REGISTER_USER_KERNEL("multi_tensor_momentum_update")                                   \
+      .SetCreateFn<MultiTensorMomentumUpdateKernel<device, dtype, gtype>>()              \
+      .SetIsMatchedHob((user_op::HobDeviceTag() == device)                               \
+                       & (user_op::HobDataType("model", 0) == GetDataType<dtype>::value) \
+                       & (user_op::HobDataType("model_diff", 0) == GetDataType<gtype>::value));
+
+REGISTER_MULTI_TENSOR_MOMENTUM_UPDATE_KERNEL(DeviceType::kCPU, float, float);
+REGISTER_MULTI_TENSOR_MOMENTUM_UPDATE_KERNEL(DeviceType::kCPU, double, double);
+#ifdef WITH_CUDA
+REGISTER_MULTI_TENSOR_MOMENTUM_UPDATE_KERNEL(DeviceType::kGPU, float, float16);
+REGISTER_MULTI_TENSOR_MOMENTUM_UPDATE_KERNEL(DeviceType::kGPU, float, float);
+REGISTER_MULTI_TENSOR_MOMENTUM_UPDATE_KERNEL(DeviceType::kGPU, double, double);
+#endif  // WITH_CUDA
+
+template<DeviceType device_type, typename T, typename G>
+class MultiTensorAdamUpdateKernel final : public user_op::OpKernel {
+ public:
+  MultiTensorAdamUpdateKernel() = default;
+  ~MultiTensorAdamUpdateKernel() override = default;
+
+ private:
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    const auto scale = static_cast<T>(ctx->Attr<double>("scale"));
+    const auto l1 = ctx->Attr<float>("l1");
+    const auto l2 = ctx->Attr<float>("l2");
+    const auto beta1 = ctx->Attr<float>("beta1");
+    const auto beta2 = ctx->Attr<float>("beta2");
+    const auto epsilon = ctx->Attr<float>("epsilon");
+    const auto weight_decay = ctx->Attr<float>("weight_decay");
+    const float learning_rate_val = ctx->Attr<float>("learning_rate_val");
+    MultiTensorUpdate<4>(ctx, {"model", "model_diff", "m", "v"},
+                         [&](const TensorTupleParams<4>& params) {
+                           MultiTensorAdamUpdateKernelUtil<device_type, T, G>::Update(
+                               ctx->device_ctx(), scale, l1, l2, beta1, beta2, epsilon,
+                               weight_decay, learning_rate_val, params);
+                         });
+  }
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return true; }
+};
+
+#define REGISTER_MULTI_TENSOR_ADAM_UPDATE_KERNEL(device, dtype, gtype)                   \
+  REGISTER_USER_KERNEL("multi_tensor_adam_update")                                       \
+      .SetCreateFn<MultiTensorAdamUpdateKernel<device, dtype, gtype>>()                  \
+      .SetIsMatchedHob((user_op::HobDeviceTag() == device)                               \
+                       & (user_op::HobDataType("model", 0) == GetDataType<dtype>::value) \
+                       & (user_op::HobDataType("model_diff", 0) == GetDataType<gtype>::value));
+
+REGISTER_MULTI_TENSOR_ADAM_UPDATE_KERNEL(DeviceType::kCPU, float, float);
+REGISTER_MULTI_TENSOR_ADAM_UPDATE_KERNEL(DeviceType::kCPU, double, double);
+#ifdef WITH_CUDA
+REGISTER_MULTI_TENSOR_ADAM_UPDATE_KERNEL(DeviceType::kGPU, float, float16);
+REGISTER_MULTI_TENSOR_ADAM_UPDATE_KERNEL(DeviceType::kGPU, float, float);
+REGISTER_MULTI_TENSOR_ADAM_UPDATE_KERNEL(DeviceType::kGPU, double, double);
+#endif  // WITH_CUDA
+
 }  // namespace
 
 }  // namespace oneflow
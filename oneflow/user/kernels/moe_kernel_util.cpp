@@ -0,0 +1,115 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/user/kernels/moe_kernel_util.h"
+
+namespace oneflow {
+
+template<typename T>
+struct MoeKernelUtil<DeviceType::kCPU, T> {
+  static void Gating(DeviceCtx* ctx, int64_t num_tokens, int64_t num_experts, int64_t k,
+                     const T* logits, int32_t* expert_ids, int32_t* positions, T* gates) {
+    FOR_RANGE(int64_t, t, 0, num_tokens) {
+      const T* token_logits = logits + t * num_experts;
+      int32_t* token_expert_ids = expert_ids + t * k;
+      T* token_gates = gates + t * k;
+      // the k largest logits, the lower expert id first on ties
+      FOR_RANGE(int64_t, j, 0, k) {
+        int32_t best = -1;
+        FOR_RANGE(int32_t, e, 0, num_experts) {
+          if (std::find(token_expert_ids, token_expert_ids + j, e) != token_expert_ids + j) {
+            continue;
+          }
+          if (best == -1 || token_logits[e] > token_logits[best]) { best = e; }
+        }
+        token_expert_ids[j] = best;
+      }
+      const T max_logit = token_logits[token_expert_ids[0]];
+      T sum = GetZeroVal<T>();
+      FOR_RANGE(int64_t, j, 0, k) {
+        token_gates[j] = std::exp(token_logits[token_expert_ids[j]] - max_logit);
+        sum += token_gates[j];
+      }
+      FOR_RANGE(int64_t, j, 0, k) { token_gates[j] /= sum; }
+    }
+    std::vector<int32_t> expert_cnt(num_experts, 0);
+    FOR_RANGE(int64_t, j, 0, k) {
+      FOR_RANGE(int64_t, t, 0, num_tokens) {
+        positions[t * k + j] = expert_cnt[expert_ids[t * k + j]]++;
+      }
+    }
+  }
+
+  static void GatingGrad(DeviceCtx* ctx, int64_t num_tokens, int64_t num_experts, int64_t k,
+                         const T* gates, const int32_t* expert_ids, const T* gates_diff,
+                         T* logits_diff) {
+    std::fill(logits_diff, logits_diff + num_tokens * num_experts, GetZeroVal<T>());
+    FOR_RANGE(int64_t, t, 0, num_tokens) {
+      T dot = GetZeroVal<T>();
+      FOR_RANGE(int64_t, j, 0, k) { dot += gates[t * k + j] * gates_diff[t * k + j]; }
+      FOR_RANGE(int64_t, j, 0, k) {
+        logits_diff[t * num_experts + expert_ids[t * k + j]] =
+            gates[t * k + j] * (gates_diff[t * k + j] - dot);
+      }
+    }
+  }
+
+  static void Dispatch(DeviceCtx* ctx, int64_t num_tokens, int64_t k, int64_t num_experts,
+                       int64_t capacity, int64_t hidden_size, const T* x,
+                       const int32_t* expert_ids, const int32_t* positions, const T* gates,
+                       T* out) {
+    std::fill(out, out + num_experts * capacity * hidden_size, GetZeroVal<T>());
+    FOR_RANGE(int64_t, i, 0, num_tokens * k) {
+      if (positions[i] >= capacity) { continue; }
+      const T* src = x + (i / k) * hidden_size;
+      T* dst = out + (expert_ids[i] * capacity + positions[i]) * hidden_size;
+      const T scale = gates == nullptr ? GetOneVal<T>() : gates[i];
+      FOR_RANGE(int64_t, h, 0, hidden_size) { dst[h] = src[h] * scale; }
+    }
+  }
+
+  static void Combine(DeviceCtx* ctx, int64_t num_tokens, int64_t k, int64_t num_experts,
+                      int64_t capacity, int64_t hidden_size, const T* expert_x,
+                      const int32_t* expert_ids, const int32_t* positions, const T* gates,
+                      T* out) {
+    std::fill(out, out + num_tokens * hidden_size, GetZeroVal<T>());
+    FOR_RANGE(int64_t, i, 0, num_tokens * k) {
+      if (positions[i] >= capacity) { continue; }
+      const T* src = expert_x + (expert_ids[i] * capacity + positions[i]) * hidden_size;
+      T* dst = out + (i / k) * hidden_size;
+      const T scale = gates == nullptr ? GetOneVal<T>() : gates[i];
+      FOR_RANGE(int64_t, h, 0, hidden_size) { dst[h] += src[h] * scale; }
+    }
+  }
+
+  static void GatesGrad(DeviceCtx* ctx, int64_t num_tokens, int64_t k, int64_t num_experts,
+                        int64_t capacity, int64_t hidden_size, const T* x, const T* expert_x,
+                        const int32_t* expert_ids, const int32_t* positions, T* gates_diff) {
+    FOR_RANGE(int64_t, i, 0, num_tokens * k) {
+      T dot = GetZeroVal<T>();
+      if (positions[i] < capacity) {
+        const T* token = x + (i / k) * hidden_size;
+        const T* slot = expert_x + (expert_ids[i] * capacity + positions[i]) * hidden_size;
+        FOR_RANGE(int64_t, h, 0, hidden_size) { dot += token[h] * slot[h]; }
+      }
+      gates_diff[i] = dot;
+    }
+  }
+};
+
+OF_PP_SEQ_PRODUCT_FOR_EACH_TUPLE(INSTANTIATE_MOE_KERNEL_UTIL, (DeviceType::kCPU),
+                                 FLOATING_DATA_TYPE_SEQ);
+
+}  // namespace oneflow
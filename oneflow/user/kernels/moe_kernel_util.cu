@@ -0,0 +1,204 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <cub/cub.cuh>
+#include "oneflow/user/kernels/moe_kernel_util.h"
+#include "oneflow/core/kernel/new_kernel_util.h"
+
+namespace oneflow {
+
+namespace {
+
+constexpr int32_t kPositionBlockSize = 1024;
+
+// one thread per token
+template<typename T>
+__global__ void SelectExpertsGpu(int64_t num_tokens, int64_t num_experts, int64_t k,
+                                 const T* logits, int32_t* expert_ids, T* gates) {
+  CUDA_1D_KERNEL_LOOP_T(int64_t, t, num_tokens) {
+    const T* token_logits = logits + t * num_experts;
+    int32_t* token_expert_ids = expert_ids + t * k;
+    T* token_gates = gates + t * k;
+    // the k largest logits, the lower expert id first on ties
+    for (int64_t j = 0; j < k; ++j) {
+      int32_t best = -1;
+      for (int32_t e = 0; e < num_experts; ++e) {
+        bool selected = false;
+        for (int64_t i = 0; i < j; ++i) { selected |= (token_expert_ids[i] == e); }
+        if (selected) { continue; }
+        if (best == -1 || token_logits[e] > token_logits[best]) { best = e; }
+      }
+      token_expert_ids[j] = best;
+    }
+    const T max_logit = token_logits[token_expert_ids[0]];
+    T sum = 0;
+    for (int64_t j = 0; j < k; ++j) {
+      token_gates[j] = exp(token_logits[token_expert_ids[j]] - max_logit);
+      sum += token_gates[j];
+    }
+    for (int64_t j = 0; j < k; ++j) { token_gates[j] /= sum; }
+  }
+}
+
+// One block per expert scans the choices in the order of (j, t) and numbers the ones of its
+// expert, so the positions do not depend on the scheduling.
+__global__ void AssignPositionsGpu(int64_t num_tokens, int64_t k, const int32_t* expert_ids,
+                                   int32_t* positions) {
+  using BlockScan = cub::BlockScan<int32_t, kPositionBlockSize>;
+  __shared__ typename BlockScan::TempStorage temp_storage;
+  const int32_t expert_id = blockIdx.x;
+  const int64_t num_choices = num_tokens * k;
+  int32_t offset = 0;
+  for (int64_t begin = 0; begin < num_choices; begin += kPositionBlockSize) {
+    const int64_t n = begin + threadIdx.x;
+    const int64_t i = n < num_choices ? (n % num_tokens) * k + n / num_tokens : -1;
+    const int32_t is_expert = (i >= 0 && expert_ids[i] == expert_id) ? 1 : 0;
+    int32_t position = 0;
+    int32_t block_cnt = 0;
+    BlockScan(temp_storage).ExclusiveSum(is_expert, position, block_cnt);
+    if (is_expert) { positions[i] = offset + position; }
+    offset += block_cnt;
+    __syncthreads();
+  }
+}
+
+template<typename T>
+__global__ void GatingGradGpu(int64_t num_tokens, int64_t num_experts, int64_t k, const T* gates,
+                              const int32_t* expert_ids, const T* gates_diff, T* logits_diff) {
+  CUDA_1D_KERNEL_LOOP_T(int64_t, t, num_tokens) {
+    T dot = 0;
+    for (int64_t j = 0; j < k; ++j) { dot += gates[t * k + j] * gates_diff[t * k + j]; }
+    for (int64_t j = 0; j < k; ++j) {
+      logits_diff[t * num_experts + expert_ids[t * k + j]] =
+          gates[t * k + j] * (gates_diff[t * k + j] - dot);
+    }
+  }
+}
+
+template<typename T>
+__global__ void DispatchGpu(int64_t elem_cnt, int64_t k, int64_t capacity, int64_t hidden_size,
+                            const T* x, const int32_t* expert_ids, const int32_t* positions,
+                            const T* gates, T* out) {
+  CUDA_1D_KERNEL_LOOP_T(int64_t, n, elem_cnt) {
+    const int64_t i = n / hidden_size;
+    const int64_t h = n - i * hidden_size;
+    const int32_t position = positions[i];
+    if (position >= capacity) { continue; }
+    const T value = x[(i / k) * hidden_size + h];
+    out[(expert_ids[i] * capacity + position) * hidden_size + h] =
+        gates == nullptr ? value : value * gates[i];
+  }
+}
+
+template<typename T>
+__global__ void CombineGpu(int64_t elem_cnt, int64_t k, int64_t capacity, int64_t hidden_size,
+                           const T* expert_x, const int32_t* expert_ids, const int32_t* positions,
+                           const T* gates, T* out) {
+  CUDA_1D_KERNEL_LOOP_T(int64_t, n, elem_cnt) {
+    const int64_t t = n / hidden_size;
+    const int64_t h = n - t * hidden_size;
+    T sum = 0;
+    for (int64_t i = t * k; i < (t + 1) * k; ++i) {
+      const int32_t position = positions[i];
+      if (position >= capacity) { continue; }
+      const T value = expert_x[(expert_ids[i] * capacity + position) * hidden_size + h];
+      sum += gates == nullptr ? value : value * gates[i];
+    }
+    out[n] = sum;
+  }
+}
+
+// one warp per choice
+template<typename T>
+__global__ void GatesGradGpu(int64_t num_choices, int64_t k, int64_t capacity,
+                             int64_t hidden_size, const T* x, const T* expert_x,
+                             const int32_t* expert_ids, const int32_t* positions, T* gates_diff) {
+  const int32_t lane_id = threadIdx.x % kCudaWarpSize;
+  const int64_t warp_id = (blockIdx.x * static_cast<int64_t>(blockDim.x) + threadIdx.x)
+                          / kCudaWarpSize;
+  const int64_t num_warps = gridDim.x * static_cast<int64_t>(blockDim.x) / kCudaWarpSize;
+  for (int64_t i = warp_id; i < num_choices; i += num_warps) {
+    const int32_t position = positions[i];
+    T dot = 0;
+    if (position < capacity) {
+      const T* token = x + (i / k) * hidden_size;
+      const T* slot = expert_x + (expert_ids[i] * capacity + position) * hidden_size;
+      for (int64_t h = lane_id; h < hidden_size; h += kCudaWarpSize) { dot += token[h] * slot[h]; }
+    }
+    for (int32_t mask = kCudaWarpSize / 2; mask > 0; mask /= 2) {
+      dot += __shfl_xor_sync(0xffffffff, dot, mask);
+    }
+    if (lane_id == 0) { gates_diff[i] = dot; }
+  }
+}
+
+}  // namespace
+
+template<typename T>
+struct MoeKernelUtil<DeviceType::kGPU, T> {
+  static void Gating(DeviceCtx* ctx, int64_t num_tokens, int64_t num_experts, int64_t k,
+                     const T* logits, int32_t* expert_ids, int32_t* positions, T* gates) {
+    if (num_tokens == 0) { return; }
+    RUN_CUDA_KERNEL((SelectExpertsGpu<T>), ctx, num_tokens, num_tokens, num_experts, k, logits,
+                    expert_ids, gates);
+    AssignPositionsGpu<<<num_experts, kPositionBlockSize, 0, ctx->cuda_stream()>>>(
+        num_tokens, k, expert_ids, positions);
+  }
+
+  static void GatingGrad(DeviceCtx* ctx, int64_t num_tokens, int64_t num_experts, int64_t k,
+                         const T* gates, const int32_t* expert_ids, const T* gates_diff,
+                         T* logits_diff) {
+    Memset<DeviceType::kGPU>(ctx, logits_diff, 0, num_tokens * num_experts * sizeof(T));
+    if (num_tokens == 0) { return; }
+    RUN_CUDA_KERNEL((GatingGradGpu<T>), ctx, num_tokens, num_tokens, num_experts, k, gates,
+                    expert_ids, gates_diff, logits_diff);
+  }
+
+  static void Dispatch(DeviceCtx* ctx, int64_t num_tokens, int64_t k, int64_t num_experts,
+                       int64_t capacity, int64_t hidden_size, const T* x,
+                       const int32_t* expert_ids, const int32_t* positions, const T* gates,
+                       T* out) {
+    Memset<DeviceType::kGPU>(ctx, out, 0, num_experts * capacity * hidden_size * sizeof(T));
+    const int64_t elem_cnt = num_tokens * k * hidden_size;
+    if (elem_cnt == 0) { return; }
+    RUN_CUDA_KERNEL((DispatchGpu<T>), ctx, elem_cnt, elem_cnt, k, capacity, hidden_size, x,
+                    expert_ids, positions, gates, out);
+  }
+
+  static void Combine(DeviceCtx* ctx, int64_t num_tokens, int64_t k, int64_t num_experts,
+                      int64_t capacity, int64_t hidden_size, const T* expert_x,
+                      const int32_t* expert_ids, const int32_t* positions, const T* gates,
+                      T* out) {
+    const int64_t elem_cnt = num_tokens * hidden_size;
+    if (elem_cnt == 0) { return; }
+    RUN_CUDA_KERNEL((CombineGpu<T>), ctx, elem_cnt, elem_cnt, k, capacity, hidden_size, expert_x,
+                    expert_ids, positions, gates, out);
+  }
+
+  static void GatesGrad(DeviceCtx* ctx, int64_t num_tokens, int64_t k, int64_t num_experts,
+                        int64_t capacity, int64_t hidden_size, const T* x, const T* expert_x,
+                        const int32_t* expert_ids, const int32_t* positions, T* gates_diff) {
+    const int64_t num_choices = num_tokens * k;
+    if (num_choices == 0) { return; }
+    const int64_t thread_num = num_choices * kCudaWarpSize;
+    RUN_CUDA_KERNEL((GatesGradGpu<T>), ctx, thread_num, num_choices, k, capacity, hidden_size, x,
+                    expert_x, expert_ids, positions, gates_diff);
+  }
+};
+
+OF_PP_SEQ_PRODUCT_FOR_EACH_TUPLE(INSTANTIATE_MOE_KERNEL_UTIL, (DeviceType::kGPU),
+                                 FLOATING_DATA_TYPE_SEQ);
+
+}  // namespace oneflow
@@ -0,0 +1,51 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_USER_KERNELS_MOE_KERNEL_UTIL_H_
+#define ONEFLOW_USER_KERNELS_MOE_KERNEL_UTIL_H_
+
+#include "oneflow/core/kernel/kernel_util.h"
+
+namespace oneflow {
+
+// See moe_ops.cpp for the routing. Routing tensors are (num_tokens, k), expert tensors
+// (num_experts, capacity, hidden_size) and token tensors (num_tokens, hidden_size). A slot with
+// a position not less than capacity is dropped, gates may be nullptr for all ones.
+template<DeviceType device_type, typename T>
+struct MoeKernelUtil {
+  static void Gating(DeviceCtx* ctx, int64_t num_tokens, int64_t num_experts, int64_t k,
+                     const T* logits, int32_t* expert_ids, int32_t* positions, T* gates);
+  static void GatingGrad(DeviceCtx* ctx, int64_t num_tokens, int64_t num_experts, int64_t k,
+                         const T* gates, const int32_t* expert_ids, const T* gates_diff,
+                         T* logits_diff);
+  static void Dispatch(DeviceCtx* ctx, int64_t num_tokens, int64_t k, int64_t num_experts,
+                       int64_t capacity, int64_t hidden_size, const T* x,
+                       const int32_t* expert_ids, const int32_t* positions, const T* gates,
+                       T* out);
+  static void Combine(DeviceCtx* ctx, int64_t num_tokens, int64_t k, int64_t num_experts,
+                      int64_t capacity, int64_t hidden_size, const T* expert_x,
+                      const int32_t* expert_ids, const int32_t* positions, const T* gates,
+                      T* out);
+  static void GatesGrad(DeviceCtx* ctx, int64_t num_tokens, int64_t k, int64_t num_experts,
+                        int64_t capacity, int64_t hidden_size, const T* x, const T* expert_x,
+                        const int32_t* expert_ids, const int32_t* positions, T* gates_diff);
+};
+
+#define INSTANTIATE_MOE_KERNEL_UTIL(device_type, data_type_pair) \
+  template struct MoeKernelUtil<device_type, OF_PP_PAIR_FIRST(data_type_pair)>;
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_USER_KERNELS_MOE_KERNEL_UTIL_H_
@@ -0,0 +1,161 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/framework/framework.h"
+#include "oneflow/user/kernels/moe_kernel_util.h"
+
+namespace oneflow {
+
+namespace {
+
+template<typename T>
+const T* GatesDptrOrNull(user_op::KernelComputeContext* ctx) {
+  if (!ctx->has_input("gates", 0)) { return nullptr; }
+  return ctx->Tensor4ArgNameAndIndex("gates", 0)->dptr<T>();
+}
+
+}  // namespace
+
+template<DeviceType device_type, typename T>
+class MoeGatingKernel final : public user_op::OpKernel {
+ public:
+  MoeGatingKernel() = default;
+  ~MoeGatingKernel() override = default;
+
+ private:
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    const user_op::Tensor* logits = ctx->Tensor4ArgNameAndIndex("logits", 0);
+    user_op::Tensor* expert_ids = ctx->Tensor4ArgNameAndIndex("expert_ids", 0);
+    user_op::Tensor* positions = ctx->Tensor4ArgNameAndIndex("positions", 0);
+    user_op::Tensor* gates = ctx->Tensor4ArgNameAndIndex("gates", 0);
+    MoeKernelUtil<device_type, T>::Gating(
+        ctx->device_ctx(), logits->shape().At(0), logits->shape().At(1), expert_ids->shape().At(1),
+        logits->dptr<T>(), expert_ids->mut_dptr<int32_t>(), positions->mut_dptr<int32_t>(),
+        gates->mut_dptr<T>());
+  }
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+};
+
+template<DeviceType device_type, typename T>
+class MoeGatingGradKernel final : public user_op::OpKernel {
+ public:
+  MoeGatingGradKernel() = default;
+  ~MoeGatingGradKernel() override = default;
+
+ private:
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    const user_op::Tensor* gates = ctx->Tensor4ArgNameAndIndex("gates", 0);
+    const user_op::Tensor* expert_ids = ctx->Tensor4ArgNameAndIndex("expert_ids", 0);
+    const user_op::Tensor* gates_diff = ctx->Tensor4ArgNameAndIndex("gates_diff", 0);
+    user_op::Tensor* logits_diff = ctx->Tensor4ArgNameAndIndex("logits_diff", 0);
+    MoeKernelUtil<device_type, T>::GatingGrad(
+        ctx->device_ctx(), logits_diff->shape().At(0), logits_diff->shape().At(1),
+        gates->shape().At(1), gates->dptr<T>(), expert_ids->dptr<int32_t>(),
+        gates_diff->dptr<T>(), logits_diff->mut_dptr<T>());
+  }
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+};
+
+// The capacity is taken from the physical shape of the expert tensor, with the tokens split across
+// devices that is the part of the capacity axis filled by the tokens of this device.
+template<DeviceType device_type, typename T>
+class MoeDispatchKernel final : public user_op::OpKernel {
+ public:
+  MoeDispatchKernel() = default;
+  ~MoeDispatchKernel() override = default;
+
+ private:
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    const user_op::Tensor* x = ctx->Tensor4ArgNameAndIndex("x", 0);
+    const user_op::Tensor* expert_ids = ctx->Tensor4ArgNameAndIndex("expert_ids", 0);
+    const user_op::Tensor* positions = ctx->Tensor4ArgNameAndIndex("positions", 0);
+    user_op::Tensor* out = ctx->Tensor4ArgNameAndIndex("out", 0);
+    MoeKernelUtil<device_type, T>::Dispatch(
+        ctx->device_ctx(), x->shape().At(0), expert_ids->shape().At(1), out->shape().At(0),
+        out->shape().At(1), out->shape().At(2), x->dptr<T>(), expert_ids->dptr<int32_t>(),
+        positions->dptr<int32_t>(), GatesDptrOrNull<T>(ctx), out->mut_dptr<T>());
+  }
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+};
+
+template<DeviceType device_type, typename T>
+class MoeCombineKernel final : public user_op::OpKernel {
+ public:
+  MoeCombineKernel() = default;
+  ~MoeCombineKernel() override = default;
+
+ private:
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    const user_op::Tensor* expert_x = ctx->Tensor4ArgNameAndIndex("expert_x", 0);
+    const user_op::Tensor* expert_ids = ctx->Tensor4ArgNameAndIndex("expert_ids", 0);
+    const user_op::Tensor* positions = ctx->Tensor4ArgNameAndIndex("positions", 0);
+    user_op::Tensor* out = ctx->Tensor4ArgNameAndIndex("out", 0);
+    MoeKernelUtil<device_type, T>::Combine(
+        ctx->device_ctx(), out->shape().At(0), expert_ids->shape().At(1), expert_x->shape().At(0),
+        expert_x->shape().At(1), expert_x->shape().At(2), expert_x->dptr<T>(),
+        expert_ids->dptr<int32_t>(), positions->dptr<int32_t>(), GatesDptrOrNull<T>(ctx),
+        out->mut_dptr<T>());
+  }
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+};
+
+template<DeviceType device_type, typename T>
+class MoeGatesGradKernel final : public user_op::OpKernel {
+ public:
+  MoeGatesGradKernel() = default;
+  ~MoeGatesGradKernel() override = default;
+
+ private:
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    const user_op::Tensor* x = ctx->Tensor4ArgNameAndIndex("x", 0);
+    const user_op::Tensor* expert_x = ctx->Tensor4ArgNameAndIndex("expert_x", 0);
+    const user_op::Tensor* expert_ids = ctx->Tensor4ArgNameAndIndex("expert_ids", 0);
+    const user_op::Tensor* positions = ctx->Tensor4ArgNameAndIndex("positions", 0);
+    user_op::Tensor* gates_diff = ctx->Tensor4ArgNameAndIndex("gates_diff", 0);
+    MoeKernelUtil<device_type, T>::GatesGrad(
+        ctx->device_ctx(), x->shape().At(0), expert_ids->shape().At(1), expert_x->shape().At(0),
+        expert_x->shape().At(1), expert_x->shape().At(2), x->dptr<T>(), expert_x->dptr<T>(),
+        expert_ids->dptr<int32_t>(), positions->dptr<int32_t>(), gates_diff->mut_dptr<T>());
+  }
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+};
+
+#define REGISTER_MOE_KERNELS(device, dtype_pair)                                                  \
+  REGISTER_USER_KERNEL("moe_gating")                                                              \
+      .SetCreateFn<MoeGatingKernel<device, OF_PP_PAIR_FIRST(dtype_pair)>>()                       \
+      .SetIsMatchedHob((user_op::HobDeviceTag() == device)                                        \
+                       & (user_op::HobDataType("logits", 0) == OF_PP_PAIR_SECOND(dtype_pair)));   \
+  REGISTER_USER_KERNEL("moe_gating_grad")                                                         \
+      .SetCreateFn<MoeGatingGradKernel<device, OF_PP_PAIR_FIRST(dtype_pair)>>()                   \
+      .SetIsMatchedHob((user_op::HobDeviceTag() == device)                                        \
+                       & (user_op::HobDataType("gates", 0) == OF_PP_PAIR_SECOND(dtype_pair)));    \
+  REGISTER_USER_KERNEL("moe_dispatch")                                                            \
+      .SetCreateFn<MoeDispatchKernel<device, OF_PP_PAIR_FIRST(dtype_pair)>>()                     \
+      .SetIsMatchedHob((user_op::HobDeviceTag() == device)                                        \
+                       & (user_op::HobDataType("x", 0) == OF_PP_PAIR_SECOND(dtype_pair)));        \
+  REGISTER_USER_KERNEL("moe_combine")                                                             \
+      .SetCreateFn<MoeCombineKernel<device, OF_PP_PAIR_FIRST(dtype_pair)>>()                      \
+      .SetIsMatchedHob((user_op::HobDeviceTag() == device)                                        \
+                       & (user_op::HobDataType("expert_x", 0) == OF_PP_PAIR_SECOND(dtype_pair))); \
+  REGISTER_USER_KERNEL("moe_gates_grad")                                                          \
+      .SetCreateFn<MoeGatesGradKernel<device, OF_PP_PAIR_FIRST(dtype_pair)>>()                    \
+      .SetIsMatchedHob((user_op::HobDeviceTag() == device)                                        \
+                       & (user_op::HobDataType("x", 0) == OF_PP_PAIR_SECOND(dtype_pair)));
+
+OF_PP_SEQ_PRODUCT_FOR_EACH_TUPLE(REGISTER_MOE_KERNELS, DEVICE_TYPE_SEQ, FLOATING_DATA_TYPE_SEQ)
+
+#undef REGISTER_MOE_KERNELS
+
+}  // namespace oneflow
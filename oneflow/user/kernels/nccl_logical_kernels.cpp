@@ -329,6 +329,87 @@ class NcclLogicalS2SKernel final : public user_op::OpKernel {
   bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
 };
 
+class NcclLogicalMatmulAllReduceState final : public user_op::OpKernelState {
+ public:
+  NcclLogicalMatmulAllReduceState(user_op::KernelInitContext* ctx, int64_t chunk_num)
+      : comm_state_(ctx), chunk_events_(chunk_num) {
+    OF_CUDA_CHECK(cudaGetDevice(&dev_));
+    OF_CUDA_CHECK(cudaStreamCreateWithFlags(&comm_stream_, cudaStreamNonBlocking));
+    for (cudaEvent_t& event : chunk_events_) {
+      OF_CUDA_CHECK(cudaEventCreateWithFlags(&event, cudaEventDisableTiming));
+    }
+    OF_CUDA_CHECK(cudaEventCreateWithFlags(&comm_done_event_, cudaEventDisableTiming));
+  }
+  ~NcclLogicalMatmulAllReduceState() override {
+    CudaCurrentDeviceGuard guard(dev_);
+    OF_CUDA_CHECK(cudaStreamSynchronize(comm_stream_));
+    for (cudaEvent_t event : chunk_events_) { OF_CUDA_CHECK(cudaEventDestroy(event)); }
+    OF_CUDA_CHECK(cudaEventDestroy(comm_done_event_));
+    OF_CUDA_CHECK(cudaStreamDestroy(comm_stream_));
+  }
+
+  ncclComm_t comm() { return comm_state_.comm(); }
+  cudaStream_t comm_stream() const { return comm_stream_; }
+  cudaEvent_t chunk_event(int64_t i) const { return chunk_events_.at(i); }
+  cudaEvent_t comm_done_event() const { return comm_done_event_; }
+
+ private:
+  NcclLogicalKernelCommState comm_state_;
+  int dev_;
+  cudaStream_t comm_stream_;
+  std::vector<cudaEvent_t> chunk_events_;
+  cudaEvent_t comm_done_event_;
+};
+
+template<typename T>
+class NcclLogicalMatmulAllReduceKernel final : public user_op::OpKernel {
+ public:
+  NcclLogicalMatmulAllReduceKernel() = default;
+  ~NcclLogicalMatmulAllReduceKernel() override = default;
+
+  std::shared_ptr<user_op::OpKernelState> CreateOpKernelState(
+      user_op::KernelInitContext* ctx) const override {
+    return std::make_shared<NcclLogicalMatmulAllReduceState>(ctx,
+                                                             ctx->Attr<int64_t>("chunk_num"));
+  }
+
+ private:
+  void Compute(user_op::KernelComputeContext* ctx, user_op::OpKernelState* state) const override {
+    auto* matmul_state = dynamic_cast<NcclLogicalMatmulAllReduceState*>(state);
+    CHECK(matmul_state != nullptr);
+    const user_op::Tensor* a = ctx->Tensor4ArgNameAndIndex("a", 0);
+    const user_op::Tensor* b = ctx->Tensor4ArgNameAndIndex("b", 0);
+    user_op::Tensor* out = ctx->Tensor4ArgNameAndIndex("out", 0);
+    const CBLAS_TRANSPOSE trans_b = ctx->Attr<bool>("transpose_b") ? CblasTrans : CblasNoTrans;
+    const double alpha = ctx->Attr<double>("alpha");
+    const int64_t chunk_num = ctx->Attr<int64_t>("chunk_num");
+    const int64_t m = out->shape().At(0);
+    const int64_t n = out->shape().At(1);
+    const int64_t k = a->shape().At(1);
+    const int64_t chunk_rows = RoundUp(m, chunk_num) / chunk_num;
+    const cudaStream_t compute_stream = ctx->device_ctx()->cuda_stream();
+    const cudaStream_t comm_stream = matmul_state->comm_stream();
+    // rows of a and out are contiguous, so each chunk of rows is an independent GEMM whose result
+    // can be all-reduced on the comm stream while the compute stream moves on to the next chunk
+    FOR_RANGE(int64_t, i, 0, chunk_num) {
+      const int64_t row_begin = i * chunk_rows;
+      const int64_t rows = std::min(chunk_rows, m - row_begin);
+      if (rows <= 0) { break; }
+      T* out_ptr = out->mut_dptr<T>() + row_begin * n;
+      NewKernelUtil<DeviceType::kGPU>::OFGemm(ctx->device_ctx(), CblasNoTrans, trans_b, rows, n,
+                                              k, alpha, a->dptr<T>() + row_begin * k,
+                                              b->dptr<T>(), 0.0, out_ptr);
+      OF_CUDA_CHECK(cudaEventRecord(matmul_state->chunk_event(i), compute_stream));
+      OF_CUDA_CHECK(cudaStreamWaitEvent(comm_stream, matmul_state->chunk_event(i), 0));
+      OF_NCCL_CHECK(ncclAllReduce(out_ptr, out_ptr, rows * n, GetNcclDataType(out->data_type()),
+                                  ncclRedOp_t::ncclSum, matmul_state->comm(), comm_stream));
+    }
+    OF_CUDA_CHECK(cudaEventRecord(matmul_state->comm_done_event(), comm_stream));
+    OF_CUDA_CHECK(cudaStreamWaitEvent(compute_stream, matmul_state->comm_done_event(), 0));
+  };
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+};
+
 size_t InferS2SKernelTmpBufferSize(user_op::InferContext* ctx) {
   size_t ret = 0;
   const user_op::TensorDesc& in_tensor = ctx->InputTensorDesc("in", 0);
@@ -386,6 +467,17 @@ REGISTER_S2S_KERNEL(float)
 REGISTER_S2S_KERNEL(double)
 REGISTER_S2S_KERNEL(float16)
 
+#define REGISTER_MATMUL_ALL_REDUCE_KERNEL(dtype)                                     \
+  REGISTER_USER_KERNEL("_nccl_logical_matmul_all_reduce")                            \
+      .SetCreateFn<NcclLogicalMatmulAllReduceKernel<dtype>>()                        \
+      .SetIsMatchedHob((user_op::HobDeviceTag() == "gpu")                            \
+                       & (user_op::HobDataType("a", 0) == GetDataType<dtype>::value) \
+                       & (user_op::HobDataType("out", 0) == GetDataType<dtype>::value));
+
+REGISTER_MATMUL_ALL_REDUCE_KERNEL(float)
+REGISTER_MATMUL_ALL_REDUCE_KERNEL(double)
+REGISTER_MATMUL_ALL_REDUCE_KERNEL(float16)
+
 }  // namespace oneflow
 
 #endif  // WITH_CUDA && NCCL_VERSION_CODE > 2700
@@ -348,6 +348,23 @@ void ReluBackward<float16>(DeviceCtx* device_ctx, int64_t n, const int32_t* mask
                      reinterpret_cast<half*>(addend_diff));
 }
 
+// The native channels-last kernels below replace the cuDNN ones in training when enabled.
+bool IsNativeChannelsLastBnEnabled(const user_op::KernelRegContext& ctx) {
+  static const bool is_enabled =
+      ParseBooleanFromEnv("ONEFLOW_ENABLE_NATIVE_CHANNELS_LAST_BN", false);
+  if (!is_enabled) { return false; }
+  const user_op::TensorDesc* x = ctx.TensorDesc4ArgNameAndIndex("x", 0);
+  if (x->data_type() != DataType::kFloat && x->data_type() != DataType::kFloat16) {
+    return false;
+  }
+  const int64_t num_axes = x->shape().NumAxes();
+  return num_axes >= 2 && ctx.Attr<int32_t>("axis") == num_axes - 1;
+}
+
+hob::HobContextGetter<user_op::KernelRegContext, bool> HobNativeChannelsLastBn() {
+  return user_op::HobCtxGetter<bool>("native_channels_last_bn", IsNativeChannelsLastBnEnabled);
+}
+
 template<typename T>
 class NormalizationTrainKernel final : public user_op::OpKernel {
  public:
@@ -457,7 +474,8 @@ class NormalizationTrainKernel final : public user_op::OpKernel {
       .SetCreateFn<NormalizationTrainKernel<dtype>>()                                           \
       .SetIsMatchedHob((user_op::HobDeviceTag() == "gpu")                                       \
                        & (user_op::HobDataType("y", 0) == GetDataType<dtype>::value)            \
-                       & (user_op::HobAttr<bool>("training") == true))                          \
+                       & (user_op::HobAttr<bool>("training") == true)                           \
+                       & (HobNativeChannelsLastBn() == false))                                  \
       .SetInferTmpSizeFn(InferTrainTmpSize)                                                     \
       .SetInplaceProposalFn([](const user_op::InferContext& ctx,                                \
                                user_op::AddInplaceArgPair AddInplaceArgPairFn) -> Maybe<void> { \
@@ -471,11 +489,12 @@ REGISTER_BN_TRAIN_KERNEL(float16)
 REGISTER_BN_TRAIN_KERNEL(float)
 REGISTER_BN_TRAIN_KERNEL(double)
 
-#define REGISTER_BN_ADD_RELU_KERNEL(dtype)                                            \
-  REGISTER_USER_KERNEL("normalization_add_relu")                                      \
-      .SetCreateFn<NormalizationTrainKernel<dtype>>()                                 \
-      .SetIsMatchedHob((user_op::HobDeviceTag() == "gpu")                             \
-                       & (user_op::HobDataType("y", 0) == GetDataType<dtype>::value)) \
+#define REGISTER_BN_ADD_RELU_KERNEL(dtype)                                           \
+  REGISTER_USER_KERNEL("normalization_add_relu")                                     \
+      .SetCreateFn<NormalizationTrainKernel<dtype>>()                                \
+      .SetIsMatchedHob((user_op::HobDeviceTag() == "gpu")                            \
+                       & (user_op::HobDataType("y", 0) == GetDataType<dtype>::value) \
+                       & (HobNativeChannelsLastBn() == false))                       \
       .SetInferTmpSizeFn(InferTrainTmpSize);
 
 REGISTER_BN_ADD_RELU_KERNEL(float16)
@@ -592,28 +611,468 @@ class NormalizationGradUserKernel final : public user_op::OpKernel {
   bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
 };
 
-#define REGISTER_BN_GRAD_KERNEL(dtype)                                                 \
-  REGISTER_USER_KERNEL("normalization_grad")                                           \
-      .SetCreateFn<NormalizationGradUserKernel<dtype>>()                               \
-      .SetIsMatchedHob((user_op::HobDeviceTag() == "gpu")                              \
-                       & (user_op::HobDataType("dx", 0) == GetDataType<dtype>::value)) \
+#define REGISTER_BN_GRAD_KERNEL(dtype)                                                \
+  REGISTER_USER_KERNEL("normalization_grad")                                          \
+      .SetCreateFn<NormalizationGradUserKernel<dtype>>()                              \
+      .SetIsMatchedHob((user_op::HobDeviceTag() == "gpu")                             \
+                       & (user_op::HobDataType("dx", 0) == GetDataType<dtype>::value) \
+                       & (HobNativeChannelsLastBn() == false))                        \
       .SetInferTmpSizeFn(InferGradTmpSize);
 
 REGISTER_BN_GRAD_KERNEL(float16)
 REGISTER_BN_GRAD_KERNEL(float)
 REGISTER_BN_GRAD_KERNEL(double)
 
-#define REGISTER_BN_ADD_RELU_GRAD_KERNEL(dtype)                                        \
-  REGISTER_USER_KERNEL("normalization_add_relu_grad")                                  \
-      .SetCreateFn<NormalizationGradUserKernel<dtype>>()                               \
-      .SetIsMatchedHob((user_op::HobDeviceTag() == "gpu")                              \
-                       & (user_op::HobDataType("dx", 0) == GetDataType<dtype>::value)) \
+#define REGISTER_BN_ADD_RELU_GRAD_KERNEL(dtype)                                       \
+  REGISTER_USER_KERNEL("normalization_add_relu_grad")                                 \
+      .SetCreateFn<NormalizationGradUserKernel<dtype>>()                              \
+      .SetIsMatchedHob((user_op::HobDeviceTag() == "gpu")                             \
+                       & (user_op::HobDataType("dx", 0) == GetDataType<dtype>::value) \
+                       & (HobNativeChannelsLastBn() == false))                        \
       .SetInferTmpSizeFn(InferGradTmpSize);
 
 REGISTER_BN_ADD_RELU_GRAD_KERNEL(float16)
 REGISTER_BN_ADD_RELU_GRAD_KERNEL(float)
 REGISTER_BN_ADD_RELU_GRAD_KERNEL(double)
 
+// Native channels-last batch norm for training. cuDNN batch norm is much slower on NHWC than on
+// NCHW, so when the env ONEFLOW_ENABLE_NATIVE_CHANNELS_LAST_BN is set these kernels view x as
+// (rows, channels) with the channel axis last and let each warp walk 32 consecutive channels, so
+// that every load is coalesced. The statistics are computed by Welford's algorithm per row chunk
+// and merged in a fixed order, which keeps them deterministic.
+
+constexpr int32_t kBnChannelsPerBlock = 32;
+constexpr int32_t kBnRowsPerBlock = 8;
+constexpr int64_t kBnMinRowsPerChunk = 64;
+constexpr int64_t kBnMaxNumRowChunks = 128;
+
+struct WelfordStat {
+  float mean;
+  float m2;
+  int64_t count;
+};
+
+__device__ void WelfordUpdate(WelfordStat* stat, float val) {
+  stat->count += 1;
+  const float delta = val - stat->mean;
+  stat->mean += delta / static_cast<float>(stat->count);
+  stat->m2 += delta * (val - stat->mean);
+}
+
+__device__ void WelfordCombine(WelfordStat* stat, const WelfordStat& other) {
+  if (other.count == 0) { return; }
+  const int64_t count = stat->count + other.count;
+  const float delta = other.mean - stat->mean;
+  const float other_ratio = static_cast<float>(other.count) / static_cast<float>(count);
+  stat->mean += delta * other_ratio;
+  stat->m2 += other.m2 + delta * delta * static_cast<float>(stat->count) * other_ratio;
+  stat->count = count;
+}
+
+// Splits the rows into chunks until there are about four blocks per SM.
+int64_t GetBnRowsPerChunk(int64_t rows, int64_t channels) {
+  int dev;
+  OF_CUDA_CHECK(cudaGetDevice(&dev));
+  int num_sms;
+  OF_CUDA_CHECK(cudaDeviceGetAttribute(&num_sms, cudaDevAttrMultiProcessorCount, dev));
+  const int64_t num_channel_blocks = (channels + kBnChannelsPerBlock - 1) / kBnChannelsPerBlock;
+  int64_t num_chunks = (num_sms * 4 + num_channel_blocks - 1) / num_channel_blocks;
+  num_chunks = std::min(num_chunks, (rows + kBnMinRowsPerChunk - 1) / kBnMinRowsPerChunk);
+  num_chunks = std::max<int64_t>(std::min(num_chunks, kBnMaxNumRowChunks), 1);
+  return (rows + num_chunks - 1) / num_chunks;
+}
+
+dim3 GetBnReduceGridSize(int64_t rows, int64_t channels, int64_t rows_per_chunk) {
+  return dim3((channels + kBnChannelsPerBlock - 1) / kBnChannelsPerBlock,
+              (rows + rows_per_chunk - 1) / rows_per_chunk);
+}
+
+size_t GetBnPartialSize(int64_t channels, size_t elem_size) {
+  return GetCudaAlignedSize(kBnMaxNumRowChunks * channels * elem_size);
+}
+
+size_t GetBnParamSize(int64_t channels) { return GetCudaAlignedSize(channels * sizeof(float)); }
+
+size_t InferChannelsLastTrainTmpSize(user_op::InferContext* ctx) {
+  const auto& x = ctx->InputTensorDesc("x", 0);
+  const int64_t channels = x.shape().At(ctx->Attr<int32_t>("axis"));
+  return 2 * GetBnPartialSize(channels, sizeof(float))
+         + GetBnPartialSize(channels, sizeof(int64_t)) + 2 * GetBnParamSize(channels);
+}
+
+size_t InferChannelsLastGradTmpSize(user_op::InferContext* ctx) {
+  const auto& x = ctx->InputTensorDesc("x", 0);
+  const int64_t channels = x.shape().At(ctx->Attr<int32_t>("axis"));
+  return 2 * GetBnPartialSize(channels, sizeof(float)) + 3 * GetBnParamSize(channels);
+}
+
+// One block reduces kBnRowsPerBlock x kBnChannelsPerBlock tiles of a row chunk, blockIdx.y is the
+// chunk and blockIdx.x the channel group.
+template<typename T>
+__global__ void ChannelsLastWelfordGpu(int64_t rows, int64_t channels, int64_t rows_per_chunk,
+                                       const T* x, float* partial_mean, float* partial_m2,
+                                       int64_t* partial_count) {
+  __shared__ WelfordStat stats[kBnRowsPerBlock][kBnChannelsPerBlock];
+  const int64_t c = blockIdx.x * kBnChannelsPerBlock + threadIdx.x;
+  const int64_t row_begin = blockIdx.y * rows_per_chunk;
+  const int64_t row_end = row_begin + rows_per_chunk < rows ? row_begin + rows_per_chunk : rows;
+  WelfordStat stat{0, 0, 0};
+  if (c < channels) {
+    for (int64_t r = row_begin + threadIdx.y; r < row_end; r += kBnRowsPerBlock) {
+      WelfordUpdate(&stat, static_cast<float>(x[r * channels + c]));
+    }
+  }
+  stats[threadIdx.y][threadIdx.x] = stat;
+  __syncthreads();
+  if (threadIdx.y == 0 && c < channels) {
+    for (int32_t i = 1; i < kBnRowsPerBlock; ++i) { WelfordCombine(&stat, stats[i][threadIdx.x]); }
+    const int64_t offset = blockIdx.y * channels + c;
+    partial_mean[offset] = stat.mean;
+    partial_m2[offset] = stat.m2;
+    partial_count[offset] = stat.count;
+  }
+}
+
+// Merges the chunks of every channel, updates the moving statistics and folds gamma and beta into
+// the scale and shift that the normalize pass applies.
+__global__ void ChannelsLastBnStatsGpu(int64_t channels, int64_t num_chunks,
+                                       const float* partial_mean, const float* partial_m2,
+                                       const int64_t* partial_count, const float* gamma,
+                                       const float* beta, float epsilon, float momentum,
+                                       float* moving_mean, float* moving_variance, float* mean,
+                                       float* inv_variance, float* scale, float* shift) {
+  CUDA_1D_KERNEL_LOOP_T(int64_t, c, channels) {
+    WelfordStat stat{partial_mean[c], partial_m2[c], partial_count[c]};
+    for (int64_t i = 1; i < num_chunks; ++i) {
+      const int64_t offset = i * channels + c;
+      WelfordCombine(&stat, WelfordStat{partial_mean[offset], partial_m2[offset],
+                                        partial_count[offset]});
+    }
+    const float count = static_cast<float>(stat.count);
+    const float variance = stat.m2 / count;
+    const float unbiased_variance = stat.count > 1 ? stat.m2 / (count - 1) : variance;
+    const float inv_std = rsqrtf(variance + epsilon);
+    mean[c] = stat.mean;
+    inv_variance[c] = inv_std;
+    moving_mean[c] = moving_mean[c] * momentum + stat.mean * (1 - momentum);
+    moving_variance[c] = moving_variance[c] * momentum + unbiased_variance * (1 - momentum);
+    scale[c] = gamma[c] * inv_std;
+    shift[c] = beta[c] - stat.mean * scale[c];
+  }
+}
+
+// The relu mask has the same layout as ReluGpu, bit (i % 32) of mask[i / 32] is element i.
+template<typename T, bool has_addend, bool fuse_relu>
+__global__ void ChannelsLastBnNormalizeGpu(int64_t n, int64_t channels, const T* x,
+                                           const float* scale, const float* shift, const T* addend,
+                                           T* y, int32_t* mask) {
+  const int32_t lane_id = threadIdx.x % kCudaWarpSize;
+  CUDA_1D_KERNEL_LOOP_T(int64_t, i, n) {
+    const int64_t c = i % channels;
+    float val = static_cast<float>(x[i]) * scale[c] + shift[c];
+    if (has_addend) { val += static_cast<float>(addend[i]); }
+    if (fuse_relu) {
+      const bool is_positive = (val > 0);
+      int32_t warp_mask = __ballot_sync(__activemask(), static_cast<int>(is_positive));
+      if (lane_id == 0) { mask[i / kCudaWarpSize] = warp_mask; }
+      val = is_positive ? val : 0;
+    }
+    y[i] = static_cast<T>(val);
+  }
+}
+
+template<typename T, bool has_mask>
+__device__ float ChannelsLastBnGradDy(int64_t i, const T* dy, const int32_t* mask) {
+  if (has_mask && !(mask[i / kCudaWarpSize] & (1 << (i % kCudaWarpSize)))) { return 0; }
+  return static_cast<float>(dy[i]);
+}
+
+template<typename T, bool has_mask>
+__global__ void ChannelsLastBnGradReduceGpu(int64_t rows, int64_t channels, int64_t rows_per_chunk,
+                                            const T* x, const T* dy, const int32_t* mask,
+                                            const float* mean, const float* inv_variance,
+                                            float* partial_sum_dy, float* partial_sum_dy_x_hat) {
+  __shared__ float sum_dy_tile[kBnRowsPerBlock][kBnChannelsPerBlock];
+  __shared__ float sum_dy_x_hat_tile[kBnRowsPerBlock][kBnChannelsPerBlock];
+  const int64_t c = blockIdx.x * kBnChannelsPerBlock + threadIdx.x;
+  const int64_t row_begin = blockIdx.y * rows_per_chunk;
+  const int64_t row_end = row_begin + rows_per_chunk < rows ? row_begin + rows_per_chunk : rows;
+  float sum_dy = 0;
+  float sum_dy_x_hat = 0;
+  if (c < channels) {
+    const float mean_val = mean[c];
+    const float inv_std = inv_variance[c];
+    for (int64_t r = row_begin + threadIdx.y; r < row_end; r += kBnRowsPerBlock) {
+      const int64_t i = r * channels + c;
+      const float dy_val = ChannelsLastBnGradDy<T, has_mask>(i, dy, mask);
+      sum_dy += dy_val;
+      sum_dy_x_hat += dy_val * (static_cast<float>(x[i]) - mean_val) * inv_std;
+    }
+  }
+  sum_dy_tile[threadIdx.y][threadIdx.x] = sum_dy;
+  sum_dy_x_hat_tile[threadIdx.y][threadIdx.x] = sum_dy_x_hat;
+  __syncthreads();
+  if (threadIdx.y == 0 && c < channels) {
+    for (int32_t k = 1; k < kBnRowsPerBlock; ++k) {
+      sum_dy += sum_dy_tile[k][threadIdx.x];
+      sum_dy_x_hat += sum_dy_x_hat_tile[k][threadIdx.x];
+    }
+    partial_sum_dy[blockIdx.y * channels + c] = sum_dy;
+    partial_sum_dy_x_hat[blockIdx.y * channels + c] = sum_dy_x_hat;
+  }
+}
+
+__global__ void ChannelsLastBnGradStatsGpu(int64_t rows, int64_t channels, int64_t num_chunks,
+                                           const float* partial_sum_dy,
+                                           const float* partial_sum_dy_x_hat, const float* gamma,
+                                           const float* inv_variance, float* gamma_diff,
+                                           float* beta_diff, float* dx_scale, float* mean_dy,
+                                           float* mean_dy_x_hat) {
+  CUDA_1D_KERNEL_LOOP_T(int64_t, c, channels) {
+    float sum_dy = 0;
+    float sum_dy_x_hat = 0;
+    for (int64_t i = 0; i < num_chunks; ++i) {
+      sum_dy += partial_sum_dy[i * channels + c];
+      sum_dy_x_hat += partial_sum_dy_x_hat[i * channels + c];
+    }
+    beta_diff[c] = sum_dy;
+    gamma_diff[c] = sum_dy_x_hat;
+    dx_scale[c] = gamma[c] * inv_variance[c];
+    mean_dy[c] = sum_dy / static_cast<float>(rows);
+    mean_dy_x_hat[c] = sum_dy_x_hat / static_cast<float>(rows);
+  }
+}
+
+// dx = gamma * inv_std * (dy - mean(dy) - x_hat * mean(dy * x_hat))
+template<typename T, bool has_mask>
+__global__ void ChannelsLastBnGradInputGpu(int64_t n, int64_t channels, const T* x, const T* dy,
+                                           const int32_t* mask, const float* mean,
+                                           const float* inv_variance, const float* dx_scale,
+                                           const float* mean_dy, const float* mean_dy_x_hat,
+                                           T* dx, T* addend_diff) {
+  CUDA_1D_KERNEL_LOOP_T(int64_t, i, n) {
+    const int64_t c = i % channels;
+    const float dy_val = ChannelsLastBnGradDy<T, has_mask>(i, dy, mask);
+    const float x_hat = (static_cast<float>(x[i]) - mean[c]) * inv_variance[c];
+    dx[i] = static_cast<T>(dx_scale[c] * (dy_val - mean_dy[c] - x_hat * mean_dy_x_hat[c]));
+    if (addend_diff != nullptr) { addend_diff[i] = static_cast<T>(dy_val); }
+  }
+}
+
+template<typename T, bool has_addend, bool fuse_relu>
+void LaunchChannelsLastBnNormalize(DeviceCtx* device_ctx, int64_t n, int64_t channels, const T* x,
+                                   const float* scale, const float* shift, const T* addend, T* y,
+                                   int32_t* mask) {
+  ChannelsLastBnNormalizeGpu<T, has_addend, fuse_relu>
+      <<<BlocksNum4ThreadsNum(n), kCudaThreadsNumPerBlock, 0, device_ctx->cuda_stream()>>>(
+          n, channels, x, scale, shift, addend, y, mask);
+}
+
+template<typename T, bool has_mask>
+void LaunchChannelsLastBnGrad(DeviceCtx* device_ctx, int64_t rows, int64_t channels, const T* x,
+                              const T* dy, const int32_t* mask, const float* mean,
+                              const float* inv_variance, const float* gamma, float* gamma_diff,
+                              float* beta_diff, T* dx, T* addend_diff, char* tmp_ptr) {
+  const int64_t rows_per_chunk = GetBnRowsPerChunk(rows, channels);
+  const dim3 grid_size = GetBnReduceGridSize(rows, channels, rows_per_chunk);
+  float* partial_sum_dy = reinterpret_cast<float*>(tmp_ptr);
+  tmp_ptr += GetBnPartialSize(channels, sizeof(float));
+  float* partial_sum_dy_x_hat = reinterpret_cast<float*>(tmp_ptr);
+  tmp_ptr += GetBnPartialSize(channels, sizeof(float));
+  float* dx_scale = reinterpret_cast<float*>(tmp_ptr);
+  float* mean_dy = reinterpret_cast<float*>(tmp_ptr + GetBnParamSize(channels));
+  float* mean_dy_x_hat = reinterpret_cast<float*>(tmp_ptr + 2 * GetBnParamSize(channels));
+  ChannelsLastBnGradReduceGpu<T, has_mask>
+      <<<grid_size, dim3(kBnChannelsPerBlock, kBnRowsPerBlock), 0, device_ctx->cuda_stream()>>>(
+          rows, channels, rows_per_chunk, x, dy, mask, mean, inv_variance, partial_sum_dy,
+          partial_sum_dy_x_hat);
+  ChannelsLastBnGradStatsGpu<<<BlocksNum4ThreadsNum(channels), kCudaThreadsNumPerBlock, 0,
+                               device_ctx->cuda_stream()>>>(
+      rows, channels, grid_size.y, partial_sum_dy, partial_sum_dy_x_hat, gamma, inv_variance,
+      gamma_diff, beta_diff, dx_scale, mean_dy, mean_dy_x_hat);
+  const int64_t n = rows * channels;
+  ChannelsLastBnGradInputGpu<T, has_mask>
+      <<<BlocksNum4ThreadsNum(n), kCudaThreadsNumPerBlock, 0, device_ctx->cuda_stream()>>>(
+          n, channels, x, dy, mask, mean, inv_variance, dx_scale, mean_dy, mean_dy_x_hat, dx,
+          addend_diff);
+}
+
+template<typename T>
+class ChannelsLastNormalizationTrainKernel final : public user_op::OpKernel {
+ public:
+  ChannelsLastNormalizationTrainKernel() = default;
+  ~ChannelsLastNormalizationTrainKernel() override = default;
+
+ private:
+  using DevT = typename DevDType<DeviceType::kGPU, T>::type;
+
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    if (ctx->op_type_name() == "normalization") { CHECK(ctx->Attr<bool>("training")); }
+    const auto* x = ctx->Tensor4ArgNameAndIndex("x", 0);
+    auto* y = ctx->Tensor4ArgNameAndIndex("y", 0);
+    const auto* gamma = ctx->Tensor4ArgNameAndIndex("gamma", 0);
+    const auto* beta = ctx->Tensor4ArgNameAndIndex("beta", 0);
+    auto* moving_mean = ctx->Tensor4ArgNameAndIndex("moving_mean", 0);
+    auto* moving_variance = ctx->Tensor4ArgNameAndIndex("moving_variance", 0);
+    auto* mean = ctx->Tensor4ArgNameAndIndex("mean", 0);
+    auto* inv_variance = ctx->Tensor4ArgNameAndIndex("inv_variance", 0);
+    auto* tmp_buffer = ctx->Tensor4ArgNameAndIndex("tmp_buffer", 0);
+    const auto axis = ctx->Attr<int32_t>("axis");
+    const auto epsilon = ctx->Attr<float>("epsilon");
+    const auto momentum = ctx->Attr<float>("momentum");
+
+    CHECK_EQ(x->shape(), y->shape());
+    CHECK_EQ(axis, x->shape().NumAxes() - 1);
+    const int64_t channels = x->shape().At(axis);
+    const int64_t n = x->shape().elem_cnt();
+    const int64_t rows = n / channels;
+    CHECK_EQ(gamma->shape().elem_cnt(), channels);
+    CHECK_EQ(mean->shape().elem_cnt(), channels);
+
+    char* tmp_ptr = tmp_buffer->mut_dptr<char>();
+    float* partial_mean = reinterpret_cast<float*>(tmp_ptr);
+    tmp_ptr += GetBnPartialSize(channels, sizeof(float));
+    float* partial_m2 = reinterpret_cast<float*>(tmp_ptr);
+    tmp_ptr += GetBnPartialSize(channels, sizeof(float));
+    int64_t* partial_count = reinterpret_cast<int64_t*>(tmp_ptr);
+    tmp_ptr += GetBnPartialSize(channels, sizeof(int64_t));
+    float* scale = reinterpret_cast<float*>(tmp_ptr);
+    float* shift = reinterpret_cast<float*>(tmp_ptr + GetBnParamSize(channels));
+
+    const auto* x_ptr = reinterpret_cast<const DevT*>(x->dptr<T>());
+    auto* y_ptr = reinterpret_cast<DevT*>(y->mut_dptr<T>());
+    const int64_t rows_per_chunk = GetBnRowsPerChunk(rows, channels);
+    const dim3 grid_size = GetBnReduceGridSize(rows, channels, rows_per_chunk);
+    ChannelsLastWelfordGpu<DevT><<<grid_size, dim3(kBnChannelsPerBlock, kBnRowsPerBlock), 0,
+                                         ctx->device_ctx()->cuda_stream()>>>(
+        rows, channels, rows_per_chunk, x_ptr, partial_mean, partial_m2, partial_count);
+    ChannelsLastBnStatsGpu<<<BlocksNum4ThreadsNum(channels), kCudaThreadsNumPerBlock, 0,
+                             ctx->device_ctx()->cuda_stream()>>>(
+        channels, grid_size.y, partial_mean, partial_m2, partial_count, gamma->dptr<float>(),
+        beta->dptr<float>(), epsilon, momentum, moving_mean->mut_dptr<float>(),
+        moving_variance->mut_dptr<float>(), mean->mut_dptr<float>(),
+        inv_variance->mut_dptr<float>(), scale, shift);
+
+    if (ctx->op_type_name() == "normalization_add_relu") {
+      auto* mask = ctx->Tensor4ArgNameAndIndex("reserve_space", 0)->mut_dptr<int32_t>();
+      if (ctx->has_input("addend", 0)) {
+        const auto* addend = ctx->Tensor4ArgNameAndIndex("addend", 0);
+        LaunchChannelsLastBnNormalize<DevT, true, true>(
+            ctx->device_ctx(), n, channels, x_ptr, scale, shift,
+            reinterpret_cast<const DevT*>(addend->dptr<T>()), y_ptr, mask);
+      } else {
+        LaunchChannelsLastBnNormalize<DevT, false, true>(
+            ctx->device_ctx(), n, channels, x_ptr, scale, shift, nullptr, y_ptr, mask);
+      }
+    } else if (ctx->has_input("_add_to_output", 0)) {
+      const auto* add_to_output = ctx->Tensor4ArgNameAndIndex("_add_to_output", 0);
+      CHECK_EQ(add_to_output->shape(), y->shape());
+      LaunchChannelsLastBnNormalize<DevT, true, false>(
+          ctx->device_ctx(), n, channels, x_ptr, scale, shift,
+          reinterpret_cast<const DevT*>(add_to_output->dptr<T>()), y_ptr, nullptr);
+    } else {
+      LaunchChannelsLastBnNormalize<DevT, false, false>(
+          ctx->device_ctx(), n, channels, x_ptr, scale, shift, nullptr, y_ptr, nullptr);
+    }
+  }
+
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+};
+
+template<typename T>
+class ChannelsLastNormalizationGradKernel final : public user_op::OpKernel {
+ public:
+  ChannelsLastNormalizationGradKernel() = default;
+  ~ChannelsLastNormalizationGradKernel() override = default;
+
+ private:
+  using DevT = typename DevDType<DeviceType::kGPU, T>::type;
+
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    const auto* x = ctx->Tensor4ArgNameAndIndex("x", 0);
+    auto* dx = ctx->Tensor4ArgNameAndIndex("dx", 0);
+    const auto* dy = ctx->Tensor4ArgNameAndIndex("dy", 0);
+    const auto* gamma = ctx->Tensor4ArgNameAndIndex("gamma", 0);
+    auto* gamma_diff = ctx->Tensor4ArgNameAndIndex("gamma_diff", 0);
+    auto* beta_diff = ctx->Tensor4ArgNameAndIndex("beta_diff", 0);
+    const auto* mean = ctx->Tensor4ArgNameAndIndex("mean", 0);
+    const auto* inv_variance = ctx->Tensor4ArgNameAndIndex("inv_variance", 0);
+    auto* tmp_buffer = ctx->Tensor4ArgNameAndIndex("tmp_buffer", 0);
+    const auto axis = ctx->Attr<int32_t>("axis");
+
+    CHECK_EQ(dy->shape(), x->shape());
+    CHECK_EQ(dx->shape(), x->shape());
+    CHECK_EQ(axis, x->shape().NumAxes() - 1);
+    const int64_t channels = x->shape().At(axis);
+    const int64_t rows = x->shape().elem_cnt() / channels;
+    CHECK_EQ(gamma->shape().elem_cnt(), channels);
+
+    const auto* x_ptr = reinterpret_cast<const DevT*>(x->dptr<T>());
+    const auto* dy_ptr = reinterpret_cast<const DevT*>(dy->dptr<T>());
+    auto* dx_ptr = reinterpret_cast<DevT*>(dx->mut_dptr<T>());
+    if (ctx->op_type_name() == "normalization_grad") {
+      LaunchChannelsLastBnGrad<DevT, false>(
+          ctx->device_ctx(), rows, channels, x_ptr, dy_ptr, nullptr, mean->dptr<float>(),
+          inv_variance->dptr<float>(), gamma->dptr<float>(), gamma_diff->mut_dptr<float>(),
+          beta_diff->mut_dptr<float>(), dx_ptr, nullptr, tmp_buffer->mut_dptr<char>());
+    } else if (ctx->op_type_name() == "normalization_add_relu_grad") {
+      const auto* mask = ctx->Tensor4ArgNameAndIndex("reserve_space", 0);
+      DevT* addend_diff_ptr = nullptr;
+      if (ctx->has_output("addend_diff", 0)) {
+        addend_diff_ptr = reinterpret_cast<DevT*>(
+            ctx->Tensor4ArgNameAndIndex("addend_diff", 0)->mut_dptr<T>());
+      }
+      LaunchChannelsLastBnGrad<DevT, true>(
+          ctx->device_ctx(), rows, channels, x_ptr, dy_ptr, mask->dptr<int32_t>(),
+          mean->dptr<float>(), inv_variance->dptr<float>(), gamma->dptr<float>(),
+          gamma_diff->mut_dptr<float>(), beta_diff->mut_dptr<float>(), dx_ptr, addend_diff_ptr,
+          tmp_buffer->mut_dptr<char>());
+    } else {
+      UNIMPLEMENTED();
+    }
+  }
+
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+};
+
+#define REGISTER_CHANNELS_LAST_BN_TRAIN_KERNEL(dtype)                                           \
+  REGISTER_USER_KERNEL("normalization")                                                         \
+      .SetCreateFn<ChannelsLastNormalizationTrainKernel<dtype>>()                               \
+      .SetIsMatchedHob((user_op::HobDeviceTag() == "gpu")                                       \
+                       & (user_op::HobDataType("y", 0) == GetDataType<dtype>::value)            \
+                       & (user_op::HobAttr<bool>("training") == true)                           \
+                       & (HobNativeChannelsLastBn() == true))                                   \
+      .SetInferTmpSizeFn(InferChannelsLastTrainTmpSize)                                         \
+      .SetInplaceProposalFn([](const user_op::InferContext& ctx,                                \
+                               user_op::AddInplaceArgPair AddInplaceArgPairFn) -> Maybe<void> { \
+        if (ctx.has_input("_add_to_output", 0)) {                                               \
+          OF_RETURN_IF_ERROR(AddInplaceArgPairFn("y", 0, "_add_to_output", 0, true));           \
+        }                                                                                       \
+        return Maybe<void>::Ok();                                                               \
+      });                                                                                       \
+  REGISTER_USER_KERNEL("normalization_add_relu")                                                \
+      .SetCreateFn<ChannelsLastNormalizationTrainKernel<dtype>>()                               \
+      .SetIsMatchedHob((user_op::HobDeviceTag() == "gpu")                                       \
+                       & (user_op::HobDataType("y", 0) == GetDataType<dtype>::value)            \
+                       & (HobNativeChannelsLastBn() == true))                                   \
+      .SetInferTmpSizeFn(InferChannelsLastTrainTmpSize);
+
+REGISTER_CHANNELS_LAST_BN_TRAIN_KERNEL(float16)
+REGISTER_CHANNELS_LAST_BN_TRAIN_KERNEL(float)
+
+#define REGISTER_CHANNELS_LAST_BN_GRAD_KERNEL(op_type_name, dtype)                    \
+  REGISTER_USER_KERNEL(op_type_name)                                                  \
+      .SetCreateFn<ChannelsLastNormalizationGradKernel<dtype>>()                      \
+      .SetIsMatchedHob((user_op::HobDeviceTag() == "gpu")                             \
+                       & (user_op::HobDataType("dx", 0) == GetDataType<dtype>::value) \
+                       & (HobNativeChannelsLastBn() == true))                         \
+      .SetInferTmpSizeFn(InferChannelsLastGradTmpSize);
+
+REGISTER_CHANNELS_LAST_BN_GRAD_KERNEL("normalization_grad", float16)
+REGISTER_CHANNELS_LAST_BN_GRAD_KERNEL("normalization_grad", float)
+REGISTER_CHANNELS_LAST_BN_GRAD_KERNEL("normalization_add_relu_grad", float16)
+REGISTER_CHANNELS_LAST_BN_GRAD_KERNEL("normalization_add_relu_grad", float)
+
 #if (CUDNN_VERSION >= 7401)
 
 size_t InferFusedNormalizationAddReluTmpSize(user_op::InferContext* ctx) {
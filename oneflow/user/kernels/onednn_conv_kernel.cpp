@@ -0,0 +1,188 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/user/kernels/onednn_util.h"
+
+#ifdef WITH_ONEDNN
+
+namespace oneflow {
+
+namespace {
+
+dnnl::memory::format_tag OneDnnDataFormatTag(int64_t num_axes) {
+  switch (num_axes) {
+    case 3: return dnnl::memory::format_tag::ncw;
+    case 4: return dnnl::memory::format_tag::nchw;
+    case 5: return dnnl::memory::format_tag::ncdhw;
+    default: UNIMPLEMENTED(); return dnnl::memory::format_tag::undef;
+  }
+}
+
+dnnl::memory::format_tag OneDnnWeightFormatTag(int64_t num_axes) {
+  switch (num_axes) {
+    case 3: return dnnl::memory::format_tag::oiw;
+    case 4: return dnnl::memory::format_tag::oihw;
+    case 5: return dnnl::memory::format_tag::oidhw;
+    default: UNIMPLEMENTED(); return dnnl::memory::format_tag::undef;
+  }
+}
+
+// Holds the convolution primitive built for the current input shape, and the weight reordered to
+// the blocked layout the primitive prefers.
+class OneDnnConvKernelState final : public user_op::OpKernelState {
+ public:
+  OneDnnConvKernelState() : stream_(OneDnnCpuEngine()), cached_weight_dptr_(nullptr) {}
+  ~OneDnnConvKernelState() override = default;
+
+  bool IsBuiltFor(const ShapeView& in_shape) const {
+    return primitive_ && Shape(in_shape.ptr(), in_shape.NumAxes()) == in_shape_;
+  }
+
+  void Build(user_op::KernelComputeContext* ctx, const ShapeView& in_shape,
+             const ShapeView& weight_shape, const ShapeView& out_shape, bool has_bias) {
+    const int64_t num_spatial_dims = in_shape.NumAxes() - 2;
+    const auto& strides = ctx->Attr<std::vector<int32_t>>("strides");
+    const auto& dilation_rate = ctx->Attr<std::vector<int32_t>>("dilation_rate");
+    const auto& padding_before = ctx->Attr<std::vector<int32_t>>("padding_before");
+    dnnl::memory::dims dnnl_strides;
+    dnnl::memory::dims dnnl_dilates;
+    dnnl::memory::dims padding_l;
+    dnnl::memory::dims padding_r;
+    FOR_RANGE(int64_t, i, 0, num_spatial_dims) {
+      const int64_t kernel_extent = (weight_shape.At(2 + i) - 1) * dilation_rate.at(i) + 1;
+      dnnl_strides.push_back(strides.at(i));
+      // oneDNN counts the dilation from 0
+      dnnl_dilates.push_back(dilation_rate.at(i) - 1);
+      padding_l.push_back(padding_before.at(i));
+      // the padding after the input is implied by the output size
+      padding_r.push_back(std::max<int64_t>(
+          (out_shape.At(2 + i) - 1) * strides.at(i) + kernel_extent - in_shape.At(2 + i)
+              - padding_before.at(i),
+          0));
+    }
+    const int64_t num_axes = in_shape.NumAxes();
+    const auto f32 = dnnl::memory::data_type::f32;
+    src_md_ = dnnl::memory::desc(OneDnnDims(in_shape), f32, OneDnnDataFormatTag(num_axes));
+    dst_md_ = dnnl::memory::desc(OneDnnDims(out_shape), f32, OneDnnDataFormatTag(num_axes));
+    user_weight_md_ =
+        dnnl::memory::desc(OneDnnDims(weight_shape), f32, OneDnnWeightFormatTag(num_axes));
+    const dnnl::memory::desc any_weight_md(OneDnnDims(weight_shape), f32,
+                                           dnnl::memory::format_tag::any);
+    const dnnl::prop_kind prop_kind = ctx->job_desc().IsTrain()
+                                          ? dnnl::prop_kind::forward_training
+                                          : dnnl::prop_kind::forward_inference;
+    if (has_bias) {
+      bias_md_ = dnnl::memory::desc({weight_shape.At(0)}, f32, dnnl::memory::format_tag::x);
+      pd_ = dnnl::convolution_forward::primitive_desc(
+          dnnl::convolution_forward::desc(prop_kind, dnnl::algorithm::convolution_direct, src_md_,
+                                          any_weight_md, bias_md_, dst_md_, dnnl_strides,
+                                          dnnl_dilates, padding_l, padding_r),
+          OneDnnCpuEngine());
+    } else {
+      pd_ = dnnl::convolution_forward::primitive_desc(
+          dnnl::convolution_forward::desc(prop_kind, dnnl::algorithm::convolution_direct, src_md_,
+                                          any_weight_md, dst_md_, dnnl_strides, dnnl_dilates,
+                                          padding_l, padding_r),
+          OneDnnCpuEngine());
+    }
+    primitive_ = dnnl::convolution_forward(pd_);
+    in_shape_ = Shape(in_shape.ptr(), in_shape.NumAxes());
+    cached_weight_dptr_ = nullptr;
+  }
+
+  void Run(const user_op::Tensor* in, const user_op::Tensor* weight, const user_op::Tensor* bias,
+           user_op::Tensor* out, bool weight_is_constant) {
+    const auto& engine = OneDnnCpuEngine();
+    dnnl::memory src_mem(src_md_, engine, const_cast<float*>(in->dptr<float>()));
+    dnnl::memory dst_mem(dst_md_, engine, out->mut_dptr<float>());
+    dnnl::memory user_weight_mem(user_weight_md_, engine,
+                                 const_cast<float*>(weight->dptr<float>()));
+    dnnl::memory weight_mem = user_weight_mem;
+    if (pd_.weights_desc() != user_weight_md_) {
+      // the weight of a job that does not train is reordered once and then reused
+      if (!weight_is_constant || cached_weight_dptr_ != weight->dptr<float>()) {
+        if (!reordered_weight_mem_) {
+          reordered_weight_mem_ = dnnl::memory(pd_.weights_desc(), engine);
+        }
+        dnnl::reorder(user_weight_mem, reordered_weight_mem_)
+            .execute(stream_, user_weight_mem, reordered_weight_mem_);
+        cached_weight_dptr_ = weight->dptr<float>();
+      }
+      weight_mem = reordered_weight_mem_;
+    }
+    std::unordered_map<int, dnnl::memory> args{
+        {DNNL_ARG_SRC, src_mem}, {DNNL_ARG_WEIGHTS, weight_mem}, {DNNL_ARG_DST, dst_mem}};
+    if (bias != nullptr) {
+      args.emplace(DNNL_ARG_BIAS,
+                   dnnl::memory(bias_md_, engine, const_cast<float*>(bias->dptr<float>())));
+    }
+    primitive_.execute(stream_, args);
+    stream_.wait();
+  }
+
+ private:
+  dnnl::stream stream_;
+  Shape in_shape_;
+  dnnl::memory::desc src_md_;
+  dnnl::memory::desc dst_md_;
+  dnnl::memory::desc user_weight_md_;
+  dnnl::memory::desc bias_md_;
+  dnnl::convolution_forward::primitive_desc pd_;
+  dnnl::convolution_forward primitive_;
+  dnnl::memory reordered_weight_mem_;
+  const float* cached_weight_dptr_;
+};
+
+class OneDnnConvCpuKernel final : public user_op::OpKernel {
+ public:
+  OneDnnConvCpuKernel() = default;
+  ~OneDnnConvCpuKernel() override = default;
+
+  std::shared_ptr<user_op::OpKernelState> CreateOpKernelState(
+      user_op::KernelInitContext* ctx) const override {
+    return std::make_shared<OneDnnConvKernelState>();
+  }
+
+ private:
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+
+  void Compute(user_op::KernelComputeContext* ctx, user_op::OpKernelState* state) const override {
+    auto* conv_state = dynamic_cast<OneDnnConvKernelState*>(state);
+    CHECK_NOTNULL(conv_state);
+    const user_op::Tensor* in = ctx->Tensor4ArgNameAndIndex("in", 0);
+    const user_op::Tensor* weight = ctx->Tensor4ArgNameAndIndex("weight", 0);
+    const user_op::Tensor* bias = ctx->Tensor4ArgNameAndIndex("bias", 0);
+    user_op::Tensor* out = ctx->Tensor4ArgNameAndIndex("out", 0);
+    if (!conv_state->IsBuiltFor(in->shape())) {
+      conv_state->Build(ctx, in->shape(), weight->shape(), out->shape(), bias != nullptr);
+    }
+    conv_state->Run(in, weight, bias, out, !ctx->job_desc().IsTrain());
+  }
+};
+
+#define REGISTER_ONEDNN_CONV_KERNEL(op_name) \
+  REGISTER_USER_KERNEL(#op_name)             \
+      .SetCreateFn<OneDnnConvCpuKernel>() \
+      .SetIsMatchedHob(HobOneDnnConv());
+
+REGISTER_ONEDNN_CONV_KERNEL(conv1d);
+REGISTER_ONEDNN_CONV_KERNEL(conv2d);
+REGISTER_ONEDNN_CONV_KERNEL(conv3d);
+
+}  // namespace
+
+}  // namespace oneflow
+
+#endif  // WITH_ONEDNN
@@ -0,0 +1,53 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_USER_KERNELS_ONEDNN_UTIL_H_
+#define ONEFLOW_USER_KERNELS_ONEDNN_UTIL_H_
+
+#include "oneflow/core/framework/framework.h"
+#ifdef WITH_ONEDNN
+#include <dnnl.hpp>
+#endif  // WITH_ONEDNN
+
+namespace oneflow {
+
+#ifdef WITH_ONEDNN
+
+inline const dnnl::engine& OneDnnCpuEngine() {
+  static dnnl::engine engine(dnnl::engine::kind::cpu, 0);
+  return engine;
+}
+
+inline dnnl::memory::dims OneDnnDims(const ShapeView& shape) {
+  return dnnl::memory::dims(shape.ptr(), shape.ptr() + shape.NumAxes());
+}
+
+#endif  // WITH_ONEDNN
+
+// Matches the convolutions the oneDNN CPU kernel runs, the im2col CPU kernel must not match them
+inline hob::BoolFunctorPtr<user_op::KernelRegContext> HobOneDnnConv() {
+#ifdef WITH_ONEDNN
+  return (user_op::HobDeviceTag() == "cpu")
+         & (user_op::HobDataType("in", 0) == DataType::kFloat)
+         & (user_op::HobAttr<int32_t>("groups") == 1)
+         & (user_op::HobAttr<std::string>("data_format") == std::string("channels_first"));
+#else
+  return user_op::HobFalse();
+#endif  // WITH_ONEDNN
+}
+
+}  // namespace oneflow
+
+#endif  // ONEFLOW_USER_KERNELS_ONEDNN_UTIL_H_
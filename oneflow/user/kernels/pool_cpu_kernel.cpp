@@ -63,19 +63,23 @@ struct PoolCpuKernelUtil {
                              ConstEigenArrayMap<T>& out_diff_arr, EigenArrayMap<T>& in_diff_arr)>
       CLastProcessGrad;
 
-  static void CFirstForward(const Params3D& params_3d, const user_op::Tensor* in_blob,
-                            user_op::Tensor* out_blob, const ForwardInitialize& initialize,
-                            const CFirstProcess& process, const CFirstFinalize& finalize) {
+  static void CFirstForward(DeviceCtx* device_ctx, const Params3D& params_3d,
+                            const user_op::Tensor* in_blob, user_op::Tensor* out_blob,
+                            const ForwardInitialize& initialize, const CFirstProcess& process,
+                            const CFirstFinalize& finalize) {
     const Shape& in = params_3d.GetXShape5D();
     const Shape& out = params_3d.GetYShape5D();
     const std::vector<int32_t>& pool_size = params_3d.pool_size_3d();
     const std::vector<int32_t>& strides = params_3d.strides_3d();
     const std::vector<int32_t>& padding_before = params_3d.padding_before_3d();
 
-    const T* input = in_blob->dptr<T>();
-    T* output = out_blob->mut_dptr<T>();
-    FOR_RANGE(int64_t, n, 0, in.At(0)) {
-      FOR_RANGE(int64_t, c, 0, in.At(1)) {
+    // the (n, c) planes are independent
+    const int64_t plane_num = in.At(0) * in.At(1);
+    const int64_t plane_cost = out.Count(2) * pool_size.at(0) * pool_size.at(1) * pool_size.at(2);
+    auto ForEachPlane = [&](int64_t begin, int64_t end) {
+      FOR_RANGE(int64_t, plane, begin, end) {
+        const T* input = in_blob->dptr<T>() + plane * in.Count(2);
+        T* output = out_blob->mut_dptr<T>() + plane * out.Count(2);
         FOR_RANGE(int64_t, pd, 0, out.At(2)) {
           int64_t dstart = pd * strides.at(0) - padding_before.at(0);
           int64_t dend = std::min(dstart + pool_size.at(0), in.At(2));
@@ -104,28 +108,31 @@ struct PoolCpuKernelUtil {
             }
           }
         }
-        input += in.Count(2);
-        output += out.Count(2);
       }
-    }
+    };
+    device_ctx->ParallelFor(plane_num, ParallelForGrainSize(plane_cost), ForEachPlane);
   }
 
-  static void CFirstBackward(const Params3D& params_3d, const user_op::Tensor* out_diff_blob,
-                             const user_op::Tensor* out_blob, const user_op::Tensor* in_blob,
-                             user_op::Tensor* in_diff_blob, const CFirstProcessGrad& process) {
+  static void CFirstBackward(DeviceCtx* device_ctx, const Params3D& params_3d,
+                             const user_op::Tensor* out_diff_blob, const user_op::Tensor* out_blob,
+                             const user_op::Tensor* in_blob, user_op::Tensor* in_diff_blob,
+                             const CFirstProcessGrad& process) {
     const Shape& in = params_3d.GetXShape5D();
     const Shape& out = params_3d.GetYShape5D();
     const std::vector<int32_t>& pool_size = params_3d.pool_size_3d();
     const std::vector<int32_t>& strides = params_3d.strides_3d();
     const std::vector<int32_t>& padding_before = params_3d.padding_before_3d();
 
-    const T* output_diff = out_diff_blob->dptr<T>();
-    const T* output = out_blob->dptr<T>();
-    const T* input = in_blob->dptr<T>();
-    std::memset(in_diff_blob->mut_dptr<T>(), T(0), in.elem_cnt() * sizeof(T));
-    T* input_diff = in_diff_blob->mut_dptr<T>();
-    FOR_RANGE(int64_t, n, 0, in.At(0)) {
-      FOR_RANGE(int64_t, c, 0, in.At(1)) {
+    // the (n, c) planes are independent, each zeroes and accumulates its own part of in_diff
+    const int64_t plane_num = in.At(0) * in.At(1);
+    const int64_t plane_cost = out.Count(2) * pool_size.at(0) * pool_size.at(1) * pool_size.at(2);
+    auto ForEachPlane = [&](int64_t begin, int64_t end) {
+      FOR_RANGE(int64_t, plane, begin, end) {
+        const T* output_diff = out_diff_blob->dptr<T>() + plane * out.Count(2);
+        const T* output = out_blob->dptr<T>() + plane * out.Count(2);
+        const T* input = in_blob->dptr<T>() + plane * in.Count(2);
+        T* input_diff = in_diff_blob->mut_dptr<T>() + plane * in.Count(2);
+        std::memset(input_diff, T(0), in.Count(2) * sizeof(T));
         FOR_RANGE(int64_t, pd, 0, out.At(2)) {
           int64_t dstart = pd * strides.at(0) - padding_before.at(0);
           int64_t dend = std::min(dstart + pool_size.at(0), in.At(2));
@@ -153,13 +160,9 @@ struct PoolCpuKernelUtil {
             }
           }
         }
-        // offset
-        input += in.Count(2);
-        input_diff += in.Count(2);
-        output += out.Count(2);
-        output_diff += out.Count(2);
       }
-    }
+    };
+    device_ctx->ParallelFor(plane_num, ParallelForGrainSize(plane_cost), ForEachPlane);
   }
 
   static void CLastForward(const Params3D& params_3d, const user_op::Tensor* in_blob,
@@ -256,7 +259,8 @@ struct PoolCpuKernelUtil {
     const std::string& data_format = ctx->Attr<std::string>("data_format");
     if (data_format == "channels_first") {
       CFirstForward(
-          pool_state->GetParams3D(), x, y, GetZeroVal<T>, [](const T& lhs, T& rhs) { rhs += lhs; },
+          ctx->device_ctx(), pool_state->GetParams3D(), x, y, GetZeroVal<T>,
+          [](const T& lhs, T& rhs) { rhs += lhs; },
           [](const int64_t size, T& out) { out /= size; });
     } else if (data_format == "channels_last") {
       CLastForward(
@@ -279,7 +283,7 @@ struct PoolCpuKernelUtil {
     CHECK_NOTNULL(pool_state);
     const std::string& data_format = ctx->Attr<std::string>("data_format");
     if (data_format == "channels_first") {
-      CFirstBackward(pool_state->GetParams3D(), dy, y, x, dx,
+      CFirstBackward(ctx->device_ctx(), pool_state->GetParams3D(), dy, y, x, dx,
                      [](const T& in, const T& out, const T& out_diff, const int64_t size,
                         T& in_diff) { in_diff += (out_diff / static_cast<T>(size)); });
     } else if (data_format == "channels_last") {
@@ -301,7 +305,7 @@ struct PoolCpuKernelUtil {
     const std::string& data_format = ctx->Attr<std::string>("data_format");
     if (data_format == "channels_first") {
       CFirstForward(
-          pool_state->GetParams3D(), x, y, GetMinVal<T>,
+          ctx->device_ctx(), pool_state->GetParams3D(), x, y, GetMinVal<T>,
           [](const T& lhs, T& rhs) {
             if (lhs > rhs) { rhs = lhs; }
           },
@@ -328,7 +332,7 @@ struct PoolCpuKernelUtil {
     const std::string& data_format = ctx->Attr<std::string>("data_format");
     if (data_format == "channels_first") {
       CFirstBackward(
-          pool_state->GetParams3D(), dy, y, x, dx,
+          ctx->device_ctx(), pool_state->GetParams3D(), dy, y, x, dx,
           [](const T& in, const T& out, const T& out_diff, const int64_t size, T& in_diff) {
             if (in == out) { in_diff += out_diff; }
           });
@@ -0,0 +1,107 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/framework/framework.h"
+
+#include <cfenv>
+
+namespace oneflow {
+
+namespace {
+
+class CpuQuantizeInt8Kernel final : public user_op::OpKernel {
+ public:
+  CpuQuantizeInt8Kernel() = default;
+  ~CpuQuantizeInt8Kernel() = default;
+
+ private:
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    const user_op::Tensor* in = ctx->Tensor4ArgNameAndIndex("in", 0);
+    const user_op::Tensor* scale = ctx->Tensor4ArgNameAndIndex("scale", 0);
+    user_op::Tensor* out = ctx->Tensor4ArgNameAndIndex("out", 0);
+    const int64_t elem_cnt = in->shape().elem_cnt();
+    if (elem_cnt == 0) { return; }
+    const int64_t panel_size = in->shape().Count(1);
+    const int64_t scale_size = scale->shape().elem_cnt();
+    const float* in_ptr = in->dptr<float>();
+    const float* scale_ptr = scale->dptr<float>();
+    int8_t* out_ptr = out->mut_dptr<int8_t>();
+    auto origin_round_mode = std::fegetround();
+    std::fesetround(FE_TONEAREST);
+    FOR_RANGE(int64_t, i, 0, elem_cnt) {
+      const float s = scale_ptr[std::min(scale_size - 1, i / panel_size)];
+      float q = std::nearbyint(in_ptr[i] / s);
+      q = q > 127.f ? 127.f : q;
+      q = q < -128.f ? -128.f : q;
+      out_ptr[i] = static_cast<int8_t>(q);
+    }
+    std::fesetround(origin_round_mode);
+  }
+
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+};
+
+class CpuQuantizedMatmulKernel final : public user_op::OpKernel {
+ public:
+  CpuQuantizedMatmulKernel() = default;
+  ~CpuQuantizedMatmulKernel() = default;
+
+ private:
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    const user_op::Tensor* a = ctx->Tensor4ArgNameAndIndex("a", 0);
+    const user_op::Tensor* b = ctx->Tensor4ArgNameAndIndex("b", 0);
+    const user_op::Tensor* a_scale = ctx->Tensor4ArgNameAndIndex("a_scale", 0);
+    const user_op::Tensor* b_scale = ctx->Tensor4ArgNameAndIndex("b_scale", 0);
+    const user_op::Tensor* bias = ctx->Tensor4ArgNameAndIndex("bias", 0);
+    user_op::Tensor* out = ctx->Tensor4ArgNameAndIndex("out", 0);
+    const int64_t m = out->shape().At(0);
+    const int64_t n = out->shape().At(1);
+    const int64_t k = a->shape().At(1);
+    const int64_t b_scale_size = b_scale->shape().elem_cnt();
+    const float alpha = static_cast<float>(ctx->Attr<double>("alpha")) * a_scale->dptr<float>()[0];
+    const int8_t* a_ptr = a->dptr<int8_t>();
+    const int8_t* b_ptr = b->dptr<int8_t>();
+    const float* b_scale_ptr = b_scale->dptr<float>();
+    const float* bias_ptr = bias == nullptr ? nullptr : bias->dptr<float>();
+    float* out_ptr = out->mut_dptr<float>();
+    FOR_RANGE(int64_t, i, 0, m) {
+      const int8_t* a_row = a_ptr + i * k;
+      FOR_RANGE(int64_t, j, 0, n) {
+        const int8_t* b_row = b_ptr + j * k;
+        int32_t acc = 0;
+        FOR_RANGE(int64_t, l, 0, k) {
+          acc += static_cast<int32_t>(a_row[l]) * static_cast<int32_t>(b_row[l]);
+        }
+        float y = static_cast<float>(acc) * alpha * b_scale_ptr[std::min(b_scale_size - 1, j)];
+        if (bias_ptr != nullptr) { y += bias_ptr[j]; }
+        out_ptr[i * n + j] = y;
+      }
+    }
+  }
+
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+};
+
+}  // namespace
+
+REGISTER_USER_KERNEL("quantize_int8")
+    .SetCreateFn<CpuQuantizeInt8Kernel>()
+    .SetIsMatchedHob(user_op::HobDeviceTag() == DeviceType::kCPU);
+
+REGISTER_USER_KERNEL("quantized_matmul")
+    .SetCreateFn<CpuQuantizedMatmulKernel>()
+    .SetIsMatchedHob(user_op::HobDeviceTag() == DeviceType::kCPU);
+
+}  // namespace oneflow
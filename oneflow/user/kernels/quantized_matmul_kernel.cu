@@ -0,0 +1,126 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/device/cuda_util.h"
+#include "oneflow/core/framework/framework.h"
+
+namespace oneflow {
+
+namespace {
+
+__global__ void QuantizeInt8Gpu(const int64_t elem_cnt, const int64_t panel_size,
+                                const int64_t scale_size, const float* in, const float* scale,
+                                int8_t* out) {
+  CUDA_1D_KERNEL_LOOP_T(int64_t, i, elem_cnt) {
+    const float s = scale[min(scale_size - 1, i / panel_size)];
+    float q = nearbyintf(in[i] / s);
+    q = q > 127.f ? 127.f : q;
+    q = q < -128.f ? -128.f : q;
+    out[i] = static_cast<int8_t>(q);
+  }
+}
+
+__global__ void DequantizeInt32Gpu(const int64_t elem_cnt, const int64_t n, const float alpha,
+                                   const int32_t* acc, const float* a_scale, const float* b_scale,
+                                   const int64_t b_scale_size, const float* bias, float* out) {
+  const float a_alpha = alpha * a_scale[0];
+  CUDA_1D_KERNEL_LOOP_T(int64_t, i, elem_cnt) {
+    const int64_t j = i % n;
+    float y = static_cast<float>(acc[i]) * a_alpha * b_scale[min(b_scale_size - 1, j)];
+    if (bias != nullptr) { y += bias[j]; }
+    out[i] = y;
+  }
+}
+
+class GpuQuantizeInt8Kernel final : public user_op::OpKernel {
+ public:
+  GpuQuantizeInt8Kernel() = default;
+  ~GpuQuantizeInt8Kernel() = default;
+
+ private:
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    const user_op::Tensor* in = ctx->Tensor4ArgNameAndIndex("in", 0);
+    const user_op::Tensor* scale = ctx->Tensor4ArgNameAndIndex("scale", 0);
+    user_op::Tensor* out = ctx->Tensor4ArgNameAndIndex("out", 0);
+    const int64_t elem_cnt = in->shape().elem_cnt();
+    if (elem_cnt == 0) { return; }
+    RUN_CUDA_KERNEL(QuantizeInt8Gpu, ctx->device_ctx(), elem_cnt, elem_cnt, in->shape().Count(1),
+                    scale->shape().elem_cnt(), in->dptr<float>(), scale->dptr<float>(),
+                    out->mut_dptr<int8_t>());
+  }
+
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+};
+
+// The int8 gemm accumulates into int32 in tmp_buffer and a second kernel dequantizes it. cublas is
+// column major, out^T(n, m) = b(n, k) * a^T(k, m) is computed with b transposed and a as is, both
+// with k as leading dimension. cublas requires k and n to be multiples of 4 for int8 inputs.
+class GpuQuantizedMatmulKernel final : public user_op::OpKernel {
+ public:
+  GpuQuantizedMatmulKernel() = default;
+  ~GpuQuantizedMatmulKernel() = default;
+
+ private:
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    const user_op::Tensor* a = ctx->Tensor4ArgNameAndIndex("a", 0);
+    const user_op::Tensor* b = ctx->Tensor4ArgNameAndIndex("b", 0);
+    const user_op::Tensor* a_scale = ctx->Tensor4ArgNameAndIndex("a_scale", 0);
+    const user_op::Tensor* b_scale = ctx->Tensor4ArgNameAndIndex("b_scale", 0);
+    const user_op::Tensor* bias = ctx->Tensor4ArgNameAndIndex("bias", 0);
+    user_op::Tensor* out = ctx->Tensor4ArgNameAndIndex("out", 0);
+    user_op::Tensor* tmp_buffer = ctx->Tensor4ArgNameAndIndex("tmp_buffer", 0);
+    const int64_t elem_cnt = out->shape().elem_cnt();
+    if (elem_cnt == 0) { return; }
+    const int m = out->shape().At(0);
+    const int n = out->shape().At(1);
+    const int k = a->shape().At(1);
+    CHECK_EQ(k % 4, 0);
+    CHECK_EQ(n % 4, 0);
+    int32_t* acc = tmp_buffer->mut_dptr<int32_t>();
+    const int32_t alpha = 1;
+    const int32_t beta = 0;
+#if CUDA_VERSION >= 11000
+    const cublasComputeType_t compute_type = CUBLAS_COMPUTE_32I;
+#else
+    const cudaDataType_t compute_type = CUDA_R_32I;
+#endif
+    OF_CUBLAS_CHECK(cublasGemmEx(ctx->device_ctx()->cublas_pmh_handle(), CUBLAS_OP_T, CUBLAS_OP_N,
+                                 n, m, k, &alpha, b->dptr(), CUDA_R_8I, k, a->dptr(), CUDA_R_8I, k,
+                                 &beta, acc, CUDA_R_32I, n, compute_type, CUBLAS_GEMM_DEFAULT));
+    RUN_CUDA_KERNEL(DequantizeInt32Gpu, ctx->device_ctx(), elem_cnt, elem_cnt, n,
+                    static_cast<float>(ctx->Attr<double>("alpha")), acc, a_scale->dptr<float>(),
+                    b_scale->dptr<float>(), b_scale->shape().elem_cnt(),
+                    bias == nullptr ? nullptr : bias->dptr<float>(), out->mut_dptr<float>());
+  }
+
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+};
+
+}  // namespace
+
+REGISTER_USER_KERNEL("quantize_int8")
+    .SetCreateFn<GpuQuantizeInt8Kernel>()
+    .SetIsMatchedHob(user_op::HobDeviceTag() == DeviceType::kGPU);
+
+REGISTER_USER_KERNEL("quantized_matmul")
+    .SetCreateFn<GpuQuantizedMatmulKernel>()
+    .SetIsMatchedHob(user_op::HobDeviceTag() == DeviceType::kGPU)
+    .SetInferTmpSizeFn([](user_op::InferContext* ctx) {
+      const int64_t m = ctx->InputShape("a", 0).At(0);
+      const int64_t n = ctx->InputShape("b", 0).At(0);
+      return GetCudaAlignedSize(m * n * sizeof(int32_t));
+    });
+
+}  // namespace oneflow
@@ -20,6 +20,12 @@ namespace oneflow {
 
 std::shared_ptr<RandomCropKernelState> CreateRandomCropKernelState(
     user_op::KernelInitContext* ctx) {
+  const user_op::TensorDesc* out_tensor_desc = ctx->TensorDesc4ArgNameAndIndex("out", 0);
+  return CreateRandomCropKernelState(ctx, out_tensor_desc->shape().elem_cnt());
+}
+
+std::shared_ptr<RandomCropKernelState> CreateRandomCropKernelState(user_op::KernelInitContext* ctx,
+                                                                   int32_t size) {
   int32_t num_attempts = ctx->Attr<int32_t>("num_attempts");
   CHECK(num_attempts >= 1);
   const std::vector<float>& random_aspect_ratio =
@@ -28,9 +34,8 @@ std::shared_ptr<RandomCropKernelState> CreateRandomCropKernelState(
         && random_aspect_ratio.at(0) <= random_aspect_ratio.at(1));
   const std::vector<float>& random_area = ctx->Attr<std::vector<float>>("random_area");
   CHECK(random_area.size() == 2 && 0 < random_area.at(0) && random_area.at(0) <= random_area.at(1));
-  const user_op::TensorDesc* out_tensor_desc = ctx->TensorDesc4ArgNameAndIndex("out", 0);
   return std::shared_ptr<RandomCropKernelState>(
-      new RandomCropKernelState(out_tensor_desc->shape().elem_cnt(), GetOpKernelRandomSeed(ctx),
+      new RandomCropKernelState(size, GetOpKernelRandomSeed(ctx),
                                 {random_aspect_ratio.at(0), random_aspect_ratio.at(1)},
                                 {random_area.at(0), random_area.at(1)}, num_attempts));
 }
@@ -44,6 +44,10 @@ class RandomCropKernelState final : public user_op::OpKernelState {
 
 std::shared_ptr<RandomCropKernelState> CreateRandomCropKernelState(user_op::KernelInitContext* ctx);
 
+// Same as above, with one generator for each of the `size` images instead of each element of "out"
+std::shared_ptr<RandomCropKernelState> CreateRandomCropKernelState(user_op::KernelInitContext* ctx,
+                                                                   int32_t size);
+
 }  // namespace oneflow
 
 #endif  // ONEFLOW_USER_KERNELS_RANDOM_CROP_KERNEL_STATE_H_
@@ -28,37 +28,48 @@ union Pack {
   int8_t b_value[sizeof(PackType)];
 };
 
-__device__ int8_t GenMask(curandState* state, const float rate) {
-  return curand_uniform(state) >= rate;
-}
+static_assert(sizeof(PackType) % 4 == 0, "");
 
-__global__ void GenerateGpu(curandState* state, const int64_t n, const float rate, int8_t* mask) {
+__global__ void GenerateGpu(one::PhiloxCudaState philox_state, const int64_t n, const float rate,
+                            int8_t* mask) {
   const int id = blockIdx.x * blockDim.x + threadIdx.x;
-  curandState localState = state[id];
+  curandStatePhilox4_32_10_t state;
+  curand_init(philox_state.seed, id, philox_state.offset, &state);
   PackType* pack_mask = reinterpret_cast<PackType*>(mask);
   Pack pack;
   CUDA_1D_KERNEL_LOOP(i, n / sizeof(PackType)) {
 #pragma unroll
-    for (int j = 0; j < sizeof(PackType); ++j) { pack.b_value[j] = GenMask(&localState, rate); }
+    for (int j = 0; j < sizeof(PackType); j += 4) {
+      const float4 rand = curand_uniform4(&state);
+      pack.b_value[j] = rand.x >= rate;
+      pack.b_value[j + 1] = rand.y >= rate;
+      pack.b_value[j + 2] = rand.z >= rate;
+      pack.b_value[j + 3] = rand.w >= rate;
+    }
     pack_mask[i] = pack.p_value;
   }
   const int32_t rem_cnt = n % sizeof(PackType);
   const int32_t rem_offset = n - rem_cnt;
-  if (id < rem_cnt) { mask[id + rem_offset] = GenMask(&localState, rate); }
-  state[id] = localState;
+  if (id < rem_cnt) { mask[id + rem_offset] = curand_uniform(&state) >= rate; }
 }
 
 }  // namespace
 
 void RandomMaskGenerator<DeviceType::kGPU>::Generate(DeviceCtx* device_ctx, const int64_t n,
                                                      const float rate, int8_t* mask) {
+  if (n == 0) { return; }
   int32_t block_num = generator_->max_block_num();
   int32_t thread_num = generator_->max_thread_num();
-  auto* curand_states = generator_->curand_states();
   const int32_t elem_cnt_per_block = thread_num * sizeof(PackType) * kMinPackPerThread;
   const int32_t block_num_final =
       std::min(static_cast<int32_t>((n + elem_cnt_per_block - 1) / elem_cnt_per_block), block_num);
-  GenerateGpu<<<block_num_final, thread_num, 0, device_ctx->cuda_stream()>>>(curand_states, n, rate,
+  const int64_t pack_num = n / sizeof(PackType);
+  const int64_t thread_cnt = static_cast<int64_t>(block_num_final) * thread_num;
+  const int64_t pack_num_per_thread = (pack_num + thread_cnt - 1) / thread_cnt;
+  // every pack draws sizeof(PackType) values, the tail element draws one more
+  const uint64_t increment = pack_num_per_thread * sizeof(PackType) + 4;
+  const one::PhiloxCudaState philox_state = generator_->NextPhiloxState(increment);
+  GenerateGpu<<<block_num_final, thread_num, 0, device_ctx->cuda_stream()>>>(philox_state, n, rate,
                                                                              mask);
 }
 
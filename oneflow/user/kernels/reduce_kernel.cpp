@@ -61,6 +61,7 @@ class ReduceKernel final : public user_op::OpKernel {
       .SetCreateFn<ReduceKernel<binary_func, device, dtype>>()                                    \
       .SetIsMatchedHob((user_op::HobDeviceTag() == device)                                        \
                        & (user_op::HobDataType("output_tensor", 0) == GetDataType<dtype>::value)) \
+      .SetInferFlopsFn(user_op::FlopsInferFnUtil::InputElemCnt)                                   \
       .SetInferTmpSizeFn([](user_op::InferContext* ctx) {                                         \
         const Shape& in_shape = ctx->InputShape("input_tensor", 0);                               \
         return in_shape.elem_cnt() * sizeof(dtype);                                               \
@@ -178,6 +179,7 @@ REGISTER_USER_KERNEL("reduce_sum")
     .SetCreateWithCtxFn<ReduceSumHalfKernel>()
     .SetIsMatchedHob((user_op::HobDeviceTag() == "gpu")
                      & (user_op::HobDataType("output_tensor", 0) == GetDataType<float16>::value))
+    .SetInferFlopsFn(user_op::FlopsInferFnUtil::InputElemCnt)
     .SetInferTmpSizeFn([](user_op::InferContext* ctx) {
       const Shape& in_shape = ctx->InputTensorDesc("input_tensor", 0).shape();
       const Shape& out_shape = ctx->OutputTensorDesc("output_tensor", 0)->shape();
@@ -0,0 +1,295 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/framework/framework.h"
+#include "oneflow/core/cuda/atomic.cuh"
+#include "oneflow/core/cuda/layer_norm.cuh"
+
+namespace oneflow {
+
+namespace {
+
+// Loads x + residual and writes the sum to add_out on the way, so that the residual add costs no
+// extra pass. The uncached block kernel loads a row twice, which rewrites the same values.
+template<typename SRC, typename DST>
+struct ResidualAddLoad {
+  ResidualAddLoad(const SRC* x, const SRC* residual, SRC* add_out, int64_t row_size)
+      : x(x), residual(residual), add_out(add_out), row_size(row_size) {}
+  template<int N>
+  __device__ void load(DST* dst, int64_t row, int64_t col) const {
+    cuda::layer_norm::Pack<SRC, N> x_pack;
+    cuda::layer_norm::Pack<SRC, N> residual_pack;
+    cuda::layer_norm::Pack<SRC, N> add_out_pack;
+    const int64_t offset = row * row_size + col;
+    x_pack.storage = *reinterpret_cast<const cuda::layer_norm::PackType<SRC, N>*>(x + offset);
+    residual_pack.storage =
+        *reinterpret_cast<const cuda::layer_norm::PackType<SRC, N>*>(residual + offset);
+#pragma unroll
+    for (int i = 0; i < N; ++i) {
+      const DST sum = static_cast<DST>(x_pack.elem[i]) + static_cast<DST>(residual_pack.elem[i]);
+      add_out_pack.elem[i] = static_cast<SRC>(sum);
+      dst[i] = sum;
+    }
+    *reinterpret_cast<cuda::layer_norm::PackType<SRC, N>*>(add_out + offset) =
+        add_out_pack.storage;
+  }
+  const SRC* x;
+  const SRC* residual;
+  SRC* add_out;
+  int64_t row_size;
+};
+
+template<typename SRC, typename DST, bool do_scale>
+struct ScaleStore {
+  ScaleStore(DST* y, const DST* weight, int64_t row_size)
+      : y(y), weight(weight), row_size(row_size) {}
+  template<int N>
+  __device__ void store(const SRC* src, int64_t row, int64_t col) {
+    cuda::layer_norm::Pack<DST, N> y_pack;
+    cuda::layer_norm::Pack<DST, N> weight_pack;
+    const int64_t offset = row * row_size + col;
+    if (do_scale) {
+      weight_pack.storage =
+          *reinterpret_cast<const cuda::layer_norm::PackType<DST, N>*>(weight + col);
+    }
+#pragma unroll
+    for (int i = 0; i < N; ++i) {
+      SRC val = src[i];
+      if (do_scale) { val *= static_cast<SRC>(weight_pack.elem[i]); }
+      y_pack.elem[i] = static_cast<DST>(val);
+    }
+    *reinterpret_cast<cuda::layer_norm::PackType<DST, N>*>(y + offset) = y_pack.storage;
+  }
+  DST* y;
+  const DST* weight;
+  int64_t row_size;
+};
+
+// Folds the weight into dy, the grad kernels then only see the grad of the normalized row.
+template<typename SRC, typename DST, bool do_scale>
+struct ScaleLoad {
+  ScaleLoad(const SRC* dy, const SRC* weight, int64_t row_size)
+      : dy(dy), weight(weight), row_size(row_size) {}
+  template<int N>
+  __device__ void load(DST* dst, int64_t row, int64_t col) const {
+    cuda::layer_norm::Pack<SRC, N> dy_pack;
+    cuda::layer_norm::Pack<SRC, N> weight_pack;
+    const int64_t offset = row * row_size + col;
+    dy_pack.storage = *reinterpret_cast<const cuda::layer_norm::PackType<SRC, N>*>(dy + offset);
+    if (do_scale) {
+      weight_pack.storage =
+          *reinterpret_cast<const cuda::layer_norm::PackType<SRC, N>*>(weight + col);
+    }
+#pragma unroll
+    for (int i = 0; i < N; ++i) {
+      dst[i] = static_cast<DST>(dy_pack.elem[i]);
+      if (do_scale) { dst[i] *= static_cast<DST>(weight_pack.elem[i]); }
+    }
+  }
+  const SRC* dy;
+  const SRC* weight;
+  int64_t row_size;
+};
+
+template<typename T, typename ComputeType, bool do_scale>
+void DispatchRmsNormForward(DeviceCtx* ctx, const int64_t rows, const int64_t cols,
+                            const double epsilon, const T* x, const T* residual, const T* weight,
+                            T* add_out, T* y, ComputeType* inv_rms) {
+  ScaleStore<ComputeType, T, do_scale> store(y, weight, cols);
+  if (residual != nullptr) {
+    ResidualAddLoad<T, ComputeType> load(x, residual, add_out, cols);
+    cuda::layer_norm::DispatchRmsNorm<decltype(load), decltype(store), ComputeType>(
+        ctx->cuda_stream(), load, store, rows, cols, epsilon, inv_rms);
+  } else {
+    cuda::layer_norm::DirectLoad<T, ComputeType> load(x, cols);
+    cuda::layer_norm::DispatchRmsNorm<decltype(load), decltype(store), ComputeType>(
+        ctx->cuda_stream(), load, store, rows, cols, epsilon, inv_rms);
+  }
+}
+
+template<typename T, typename ComputeType, bool do_scale>
+void DispatchRmsNormBackward(DeviceCtx* ctx, const int64_t rows, const int64_t cols, const T* dy,
+                             const T* x, const T* weight, const ComputeType* inv_rms, T* dx) {
+  cuda::layer_norm::DirectLoad<T, ComputeType> load_x(x, cols);
+  ScaleLoad<T, ComputeType, do_scale> load_dy(dy, weight, cols);
+  cuda::layer_norm::DirectStore<ComputeType, T> store(dx, cols);
+  cuda::layer_norm::DispatchRmsNormGrad<decltype(load_x), decltype(load_dy), decltype(store),
+                                        ComputeType>(ctx->cuda_stream(), load_x, load_dy, store,
+                                                     inv_rms, rows, cols);
+}
+
+constexpr int kParamGradTileCols = 32;
+constexpr int kParamGradTileRows = 8;
+constexpr int kParamGradMaxGridRows = 256;
+
+// weight_grad[col] = sum over rows of dy * x * inv_rms. Each block reduces a strip of 32 columns
+// over a slice of rows in shared memory, slices are summed with atomics.
+template<typename T, typename ComputeType>
+__global__ void RmsNormParamGradImpl(const int64_t rows, const int64_t cols, const T* dy,
+                                     const T* x, const ComputeType* inv_rms,
+                                     ComputeType* weight_grad) {
+  __shared__ ComputeType partial[kParamGradTileRows][kParamGradTileCols + 1];
+  const int64_t col = static_cast<int64_t>(blockIdx.x) * kParamGradTileCols + threadIdx.x;
+  ComputeType sum = 0;
+  if (col < cols) {
+    for (int64_t row = static_cast<int64_t>(blockIdx.y) * kParamGradTileRows + threadIdx.y;
+         row < rows; row += static_cast<int64_t>(gridDim.y) * kParamGradTileRows) {
+      const int64_t offset = row * cols + col;
+      sum += static_cast<ComputeType>(dy[offset]) * static_cast<ComputeType>(x[offset])
+             * inv_rms[row];
+    }
+  }
+  partial[threadIdx.y][threadIdx.x] = sum;
+  __syncthreads();
+  if (threadIdx.y == 0 && col < cols) {
+#pragma unroll
+    for (int i = 1; i < kParamGradTileRows; ++i) { sum += partial[i][threadIdx.x]; }
+    cuda::atomic::Add(weight_grad + col, sum);
+  }
+}
+
+template<typename T, typename ComputeType>
+__global__ void CastParamGrad(const int64_t n, const ComputeType* src, T* dst) {
+  CUDA_1D_KERNEL_LOOP_T(int64_t, i, n) { dst[i] = static_cast<T>(src[i]); }
+}
+
+template<typename T>
+class RmsNormGpuKernel final : public user_op::OpKernel {
+ public:
+  RmsNormGpuKernel() = default;
+  ~RmsNormGpuKernel() override = default;
+
+ private:
+  using ComputeType = typename cuda::layer_norm::DefaultComputeType<T>::type;
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    const user_op::Tensor* x = ctx->Tensor4ArgNameAndIndex("x", 0);
+    user_op::Tensor* y = ctx->Tensor4ArgNameAndIndex("y", 0);
+    user_op::Tensor* inv_rms = ctx->Tensor4ArgNameAndIndex("inv_rms", 0);
+    const double epsilon = ctx->Attr<double>("epsilon");
+    const int64_t rows = inv_rms->shape().elem_cnt();
+    const int64_t cols = x->shape().elem_cnt() / rows;
+    const T* weight_ptr = nullptr;
+    if (ctx->has_input("weight", 0)) {
+      weight_ptr = ctx->Tensor4ArgNameAndIndex("weight", 0)->dptr<T>();
+    }
+    const T* residual_ptr = nullptr;
+    T* add_out_ptr = nullptr;
+    if (ctx->has_input("residual", 0)) {
+      residual_ptr = ctx->Tensor4ArgNameAndIndex("residual", 0)->dptr<T>();
+      add_out_ptr = ctx->Tensor4ArgNameAndIndex("add_out", 0)->mut_dptr<T>();
+    }
+    if (weight_ptr != nullptr) {
+      DispatchRmsNormForward<T, ComputeType, true>(
+          ctx->device_ctx(), rows, cols, epsilon, x->dptr<T>(), residual_ptr, weight_ptr,
+          add_out_ptr, y->mut_dptr<T>(), inv_rms->mut_dptr<ComputeType>());
+    } else {
+      DispatchRmsNormForward<T, ComputeType, false>(
+          ctx->device_ctx(), rows, cols, epsilon, x->dptr<T>(), residual_ptr, nullptr,
+          add_out_ptr, y->mut_dptr<T>(), inv_rms->mut_dptr<ComputeType>());
+    }
+  };
+};
+
+template<typename T>
+class RmsNormGradGpuKernel final : public user_op::OpKernel {
+ public:
+  RmsNormGradGpuKernel() = default;
+  ~RmsNormGradGpuKernel() override = default;
+
+ private:
+  using ComputeType = typename cuda::layer_norm::DefaultComputeType<T>::type;
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    const user_op::Tensor* dy = ctx->Tensor4ArgNameAndIndex("dy", 0);
+    const user_op::Tensor* x = ctx->Tensor4ArgNameAndIndex("x", 0);
+    const user_op::Tensor* inv_rms = ctx->Tensor4ArgNameAndIndex("inv_rms", 0);
+    user_op::Tensor* dx = ctx->Tensor4ArgNameAndIndex("dx", 0);
+    const int64_t rows = inv_rms->shape().elem_cnt();
+    const int64_t cols = x->shape().elem_cnt() / rows;
+    if (ctx->has_input("weight", 0)) {
+      DispatchRmsNormBackward<T, ComputeType, true>(
+          ctx->device_ctx(), rows, cols, dy->dptr<T>(), x->dptr<T>(),
+          ctx->Tensor4ArgNameAndIndex("weight", 0)->dptr<T>(), inv_rms->dptr<ComputeType>(),
+          dx->mut_dptr<T>());
+    } else {
+      DispatchRmsNormBackward<T, ComputeType, false>(ctx->device_ctx(), rows, cols, dy->dptr<T>(),
+                                                     x->dptr<T>(), nullptr,
+                                                     inv_rms->dptr<ComputeType>(),
+                                                     dx->mut_dptr<T>());
+    }
+  };
+};
+
+template<typename T>
+class RmsNormParamGradGpuKernel final : public user_op::OpKernel {
+ public:
+  RmsNormParamGradGpuKernel() = default;
+  ~RmsNormParamGradGpuKernel() override = default;
+
+ private:
+  using ComputeType = typename cuda::layer_norm::DefaultComputeType<T>::type;
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    const user_op::Tensor* dy = ctx->Tensor4ArgNameAndIndex("dy", 0);
+    const user_op::Tensor* x = ctx->Tensor4ArgNameAndIndex("x", 0);
+    const user_op::Tensor* inv_rms = ctx->Tensor4ArgNameAndIndex("inv_rms", 0);
+    user_op::Tensor* weight_grad = ctx->Tensor4ArgNameAndIndex("weight_grad", 0);
+    user_op::Tensor* tmp_buffer = ctx->Tensor4ArgNameAndIndex("tmp_buffer", 0);
+    const int64_t rows = inv_rms->shape().elem_cnt();
+    const int64_t cols = weight_grad->shape().elem_cnt();
+    ComputeType* tmp_weight_grad = tmp_buffer->mut_dptr<ComputeType>();
+    OF_CUDA_CHECK(cudaMemsetAsync(tmp_weight_grad, 0, cols * sizeof(ComputeType),
+                                  ctx->device_ctx()->cuda_stream()));
+    const dim3 block_dim(kParamGradTileCols, kParamGradTileRows);
+    const dim3 grid_dim(
+        (cols + kParamGradTileCols - 1) / kParamGradTileCols,
+        std::min<int64_t>((rows + kParamGradTileRows - 1) / kParamGradTileRows,
+                          kParamGradMaxGridRows));
+    RmsNormParamGradImpl<T, ComputeType>
+        <<<grid_dim, block_dim, 0, ctx->device_ctx()->cuda_stream()>>>(
+            rows, cols, dy->dptr<T>(), x->dptr<T>(), inv_rms->dptr<ComputeType>(),
+            tmp_weight_grad);
+    RUN_CUDA_KERNEL((CastParamGrad<T, ComputeType>), ctx->device_ctx(), cols, cols,
+                    tmp_weight_grad, weight_grad->mut_dptr<T>());
+  };
+};
+
+#define REGISTER_RMS_NORM_GPU_KERNEL(dtype)                                                 \
+  REGISTER_USER_KERNEL("rms_norm")                                                          \
+      .SetCreateFn<RmsNormGpuKernel<dtype>>()                                               \
+      .SetIsMatchedHob((user_op::HobDeviceTag() == "gpu")                                   \
+                       & (user_op::HobDataType("x", 0) == GetDataType<dtype>::value));      \
+  REGISTER_USER_KERNEL("rms_norm_grad")                                                     \
+      .SetCreateFn<RmsNormGradGpuKernel<dtype>>()                                           \
+      .SetIsMatchedHob((user_op::HobDeviceTag() == "gpu")                                   \
+                       & (user_op::HobDataType("dy", 0) == GetDataType<dtype>::value));     \
+  REGISTER_USER_KERNEL("rms_norm_param_grad")                                               \
+      .SetCreateFn<RmsNormParamGradGpuKernel<dtype>>()                                      \
+      .SetIsMatchedHob((user_op::HobDeviceTag() == "gpu")                                   \
+                       & (user_op::HobDataType("dy", 0) == GetDataType<dtype>::value))      \
+      .SetInferTmpSizeFn([](user_op::InferContext* ctx) {                                   \
+        using ComputeType = cuda::layer_norm::DefaultComputeType<dtype>::type;              \
+        return GetCudaAlignedSize(ctx->OutputShape("weight_grad", 0)->elem_cnt()            \
+                                  * sizeof(ComputeType));                                   \
+      });
+
+REGISTER_RMS_NORM_GPU_KERNEL(float)
+REGISTER_RMS_NORM_GPU_KERNEL(double)
+REGISTER_RMS_NORM_GPU_KERNEL(half)
+
+}  // namespace
+
+}  // namespace oneflow
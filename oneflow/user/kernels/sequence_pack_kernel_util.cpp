@@ -0,0 +1,52 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/framework/framework.h"
+#include "oneflow/user/kernels/sequence_pack_kernel_util.h"
+
+namespace oneflow {
+
+namespace user_op {
+
+template<typename T>
+struct SequencePackFunctor<DeviceType::kCPU, T> final {
+  static void Pack(DeviceCtx* ctx, int64_t batch_size, int64_t max_seq_len, int64_t inner_size,
+                   const int32_t* cu_seqlens, const T* in, T* out) {
+    DoPackSequence<T>(batch_size, max_seq_len, inner_size, cu_seqlens, in, out);
+  }
+  static void Unpack(DeviceCtx* ctx, int64_t batch_size, int64_t max_seq_len, int64_t inner_size,
+                     const int32_t* cu_seqlens, const T* in, T* out) {
+    DoUnpackSequence<T>(batch_size, max_seq_len, inner_size, cu_seqlens, in, out);
+  }
+};
+
+template<>
+struct CuSeqlensFunctor<DeviceType::kCPU> final {
+  static void FromSeqLens(DeviceCtx* ctx, int64_t batch_size, int64_t max_seq_len,
+                          const int32_t* seq_lens, int32_t* cu_seqlens) {
+    cu_seqlens[0] = 0;
+    FOR_RANGE(int64_t, i, 0, batch_size) {
+      CHECK_GE(seq_lens[i], 0);
+      CHECK_LE(seq_lens[i], max_seq_len);
+      cu_seqlens[i + 1] = cu_seqlens[i] + seq_lens[i];
+    }
+  }
+};
+
+OF_PP_SEQ_PRODUCT_FOR_EACH_TUPLE(INSTANTIATE_SEQUENCE_PACK_FUNCTOR, (DeviceType::kCPU),
+                                 SEQUENCE_PACK_DATA_TYPE_CPU_SEQ);
+
+}  // namespace user_op
+}  // namespace oneflow
@@ -0,0 +1,99 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifdef WITH_CUDA
+#include "oneflow/core/framework/framework.h"
+#include "oneflow/user/kernels/sequence_pack_kernel_util.h"
+#include <assert.h>
+
+namespace oneflow {
+
+namespace user_op {
+
+namespace {
+
+template<typename T>
+__global__ void PackSequenceGpu(int64_t batch_size, int64_t max_seq_len, int64_t inner_size,
+                                const int32_t* cu_seqlens, const T* in, T* out) {
+  DoPackSequence<T>(batch_size, max_seq_len, inner_size, cu_seqlens, in, out);
+}
+
+template<typename T>
+__global__ void UnpackSequenceGpu(int64_t batch_size, int64_t max_seq_len, int64_t inner_size,
+                                  const int32_t* cu_seqlens, const T* in, T* out) {
+  DoUnpackSequence<T>(batch_size, max_seq_len, inner_size, cu_seqlens, in, out);
+}
+
+// A batch holds at most a few thousand sequences, so a single thread scans them.
+__global__ void CuSeqlensFromSeqLensGpu(int64_t batch_size, int64_t max_seq_len,
+                                        const int32_t* seq_lens, int32_t* cu_seqlens) {
+  if (blockIdx.x != 0 || threadIdx.x != 0) { return; }
+  cu_seqlens[0] = 0;
+  for (int64_t i = 0; i < batch_size; ++i) {
+    assert(seq_lens[i] >= 0 && seq_lens[i] <= max_seq_len);
+    cu_seqlens[i + 1] = cu_seqlens[i] + seq_lens[i];
+  }
+}
+
+}  // namespace
+
+template<typename T>
+struct SequencePackFunctor<DeviceType::kGPU, T> final {
+  static void Pack(DeviceCtx* ctx, int64_t batch_size, int64_t max_seq_len, int64_t inner_size,
+                   const int32_t* cu_seqlens, const T* in, T* out) {
+    const int64_t elem_cnt = batch_size * max_seq_len * inner_size;
+    RUN_CUDA_KERNEL((PackSequenceGpu<T>), ctx, elem_cnt, batch_size, max_seq_len, inner_size,
+                    cu_seqlens, in, out);
+  }
+  static void Unpack(DeviceCtx* ctx, int64_t batch_size, int64_t max_seq_len, int64_t inner_size,
+                     const int32_t* cu_seqlens, const T* in, T* out) {
+    const int64_t elem_cnt = batch_size * max_seq_len * inner_size;
+    RUN_CUDA_KERNEL((UnpackSequenceGpu<T>), ctx, elem_cnt, batch_size, max_seq_len, inner_size,
+                    cu_seqlens, in, out);
+  }
+};
+
+template<>
+struct SequencePackFunctor<DeviceType::kGPU, float16> final {
+  static void Pack(DeviceCtx* ctx, int64_t batch_size, int64_t max_seq_len, int64_t inner_size,
+                   const int32_t* cu_seqlens, const float16* in, float16* out) {
+    SequencePackFunctor<DeviceType::kGPU, half>::Pack(ctx, batch_size, max_seq_len, inner_size,
+                                                      cu_seqlens, reinterpret_cast<const half*>(in),
+                                                      reinterpret_cast<half*>(out));
+  }
+  static void Unpack(DeviceCtx* ctx, int64_t batch_size, int64_t max_seq_len, int64_t inner_size,
+                     const int32_t* cu_seqlens, const float16* in, float16* out) {
+    SequencePackFunctor<DeviceType::kGPU, half>::Unpack(
+        ctx, batch_size, max_seq_len, inner_size, cu_seqlens, reinterpret_cast<const half*>(in),
+        reinterpret_cast<half*>(out));
+  }
+};
+
+template<>
+struct CuSeqlensFunctor<DeviceType::kGPU> final {
+  static void FromSeqLens(DeviceCtx* ctx, int64_t batch_size, int64_t max_seq_len,
+                          const int32_t* seq_lens, int32_t* cu_seqlens) {
+    CuSeqlensFromSeqLensGpu<<<1, 1, 0, ctx->cuda_stream()>>>(batch_size, max_seq_len, seq_lens,
+                                                            cu_seqlens);
+  }
+};
+
+OF_PP_SEQ_PRODUCT_FOR_EACH_TUPLE(INSTANTIATE_SEQUENCE_PACK_FUNCTOR, (DeviceType::kGPU),
+                                 SEQUENCE_PACK_DATA_TYPE_GPU_SEQ);
+
+}  // namespace user_op
+}  // namespace oneflow
+
+#endif  // WITH_CUDA
@@ -0,0 +1,105 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_USER_KERNELS_SEQUENCE_PACK_KERNEL_UTIL_H_
+#define ONEFLOW_USER_KERNELS_SEQUENCE_PACK_KERNEL_UTIL_H_
+#include "oneflow/core/ndarray/xpu_util.h"
+
+namespace oneflow {
+
+#define SEQUENCE_PACK_DATA_TYPE_CPU_SEQ ARITHMETIC_DATA_TYPE_SEQ
+
+#define SEQUENCE_PACK_DATA_TYPE_GPU_SEQ \
+  SEQUENCE_PACK_DATA_TYPE_CPU_SEQ       \
+  FLOAT16_DATA_TYPE_SEQ
+
+namespace user_op {
+
+// A packed batch concatenates the valid tokens of its sequences, cu_seqlens of batch_size + 1
+// entries holding the offset of every sequence in the packed tokens. The packed tensor keeps the
+// static size batch_size * max_seq_len, the tokens after cu_seqlens[batch_size] are zero.
+template<DeviceType device_type, typename T>
+struct SequencePackFunctor final {
+  // (batch_size, max_seq_len, inner_size) -> (batch_size * max_seq_len, inner_size)
+  static void Pack(DeviceCtx* ctx, int64_t batch_size, int64_t max_seq_len, int64_t inner_size,
+                   const int32_t* cu_seqlens, const T* in, T* out);
+  // (batch_size * max_seq_len, inner_size) -> (batch_size, max_seq_len, inner_size)
+  static void Unpack(DeviceCtx* ctx, int64_t batch_size, int64_t max_seq_len, int64_t inner_size,
+                     const int32_t* cu_seqlens, const T* in, T* out);
+};
+
+template<DeviceType device_type>
+struct CuSeqlensFunctor final {
+  static void FromSeqLens(DeviceCtx* ctx, int64_t batch_size, int64_t max_seq_len,
+                          const int32_t* seq_lens, int32_t* cu_seqlens);
+};
+
+// The sequence holding a packed token, batch_size for the zero tail.
+OF_DEVICE_FUNC int64_t SeqIndex4PackedToken(int64_t batch_size, const int32_t* cu_seqlens,
+                                            int64_t token) {
+  if (token >= cu_seqlens[batch_size]) { return batch_size; }
+  int64_t lo = 0;
+  int64_t hi = batch_size;
+  while (hi - lo > 1) {
+    const int64_t mid = (lo + hi) / 2;
+    if (cu_seqlens[mid] <= token) {
+      lo = mid;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+template<typename T>
+OF_DEVICE_FUNC void DoPackSequence(int64_t batch_size, int64_t max_seq_len, int64_t inner_size,
+                                   const int32_t* cu_seqlens, const T* in, T* out) {
+  const int64_t elem_cnt = batch_size * max_seq_len * inner_size;
+  XPU_1D_KERNEL_LOOP(i, elem_cnt) {
+    const int64_t token = i / inner_size;
+    const int64_t seq = SeqIndex4PackedToken(batch_size, cu_seqlens, token);
+    if (seq == batch_size) {
+      out[i] = static_cast<T>(0);
+    } else {
+      const int64_t pos = token - cu_seqlens[seq];
+      out[i] = in[(seq * max_seq_len + pos) * inner_size + i - token * inner_size];
+    }
+  }
+}
+
+template<typename T>
+OF_DEVICE_FUNC void DoUnpackSequence(int64_t batch_size, int64_t max_seq_len, int64_t inner_size,
+                                     const int32_t* cu_seqlens, const T* in, T* out) {
+  const int64_t elem_cnt = batch_size * max_seq_len * inner_size;
+  XPU_1D_KERNEL_LOOP(i, elem_cnt) {
+    const int64_t seq_pos = i / inner_size;
+    const int64_t seq = seq_pos / max_seq_len;
+    const int64_t pos = seq_pos - seq * max_seq_len;
+    const int64_t seq_begin = cu_seqlens[seq];
+    if (seq_begin + pos < cu_seqlens[seq + 1]) {
+      out[i] = in[(seq_begin + pos) * inner_size + i - seq_pos * inner_size];
+    } else {
+      out[i] = static_cast<T>(0);
+    }
+  }
+}
+
+#define INSTANTIATE_SEQUENCE_PACK_FUNCTOR(device_type_v, dtype_pair) \
+  template struct SequencePackFunctor<device_type_v, OF_PP_PAIR_FIRST(dtype_pair)>;
+
+}  // namespace user_op
+}  // namespace oneflow
+
+#endif  // ONEFLOW_USER_KERNELS_SEQUENCE_PACK_KERNEL_UTIL_H_
@@ -0,0 +1,106 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/framework/framework.h"
+#include "oneflow/user/kernels/sequence_pack_kernel_util.h"
+
+namespace oneflow {
+
+namespace user_op {
+
+template<DeviceType device_type, typename T>
+class PackSequenceKernel final : public user_op::OpKernel {
+ public:
+  PackSequenceKernel() = default;
+  ~PackSequenceKernel() override = default;
+
+ private:
+  void Compute(KernelComputeContext* ctx) const override {
+    const Tensor* in = ctx->Tensor4ArgNameAndIndex("in", 0);
+    const Tensor* seq_lens = ctx->Tensor4ArgNameAndIndex("seq_lens", 0);
+    Tensor* out = ctx->Tensor4ArgNameAndIndex("out", 0);
+    Tensor* cu_seqlens = ctx->Tensor4ArgNameAndIndex("cu_seqlens", 0);
+    const int64_t batch_size = in->shape().At(0);
+    const int64_t max_seq_len = in->shape().At(1);
+    const int64_t inner_size = in->shape().Count(2);
+    CuSeqlensFunctor<device_type>::FromSeqLens(ctx->device_ctx(), batch_size, max_seq_len,
+                                               seq_lens->dptr<int32_t>(),
+                                               cu_seqlens->mut_dptr<int32_t>());
+    SequencePackFunctor<device_type, T>::Pack(ctx->device_ctx(), batch_size, max_seq_len,
+                                              inner_size, cu_seqlens->dptr<int32_t>(),
+                                              in->dptr<T>(), out->mut_dptr<T>());
+  }
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+};
+
+template<DeviceType device_type, typename T>
+class UnpackSequenceKernel final : public user_op::OpKernel {
+ public:
+  UnpackSequenceKernel() = default;
+  ~UnpackSequenceKernel() override = default;
+
+ private:
+  void Compute(KernelComputeContext* ctx) const override {
+    const Tensor* in = ctx->Tensor4ArgNameAndIndex("in", 0);
+    const Tensor* cu_seqlens = ctx->Tensor4ArgNameAndIndex("cu_seqlens", 0);
+    Tensor* out = ctx->Tensor4ArgNameAndIndex("out", 0);
+    SequencePackFunctor<device_type, T>::Unpack(
+        ctx->device_ctx(), out->shape().At(0), out->shape().At(1), out->shape().Count(2),
+        cu_seqlens->dptr<int32_t>(), in->dptr<T>(), out->mut_dptr<T>());
+  }
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+};
+
+template<DeviceType device_type, typename T>
+class UnpackSequenceGradKernel final : public user_op::OpKernel {
+ public:
+  UnpackSequenceGradKernel() = default;
+  ~UnpackSequenceGradKernel() override = default;
+
+ private:
+  void Compute(KernelComputeContext* ctx) const override {
+    const Tensor* dy = ctx->Tensor4ArgNameAndIndex("dy", 0);
+    const Tensor* cu_seqlens = ctx->Tensor4ArgNameAndIndex("cu_seqlens", 0);
+    Tensor* dx = ctx->Tensor4ArgNameAndIndex("dx", 0);
+    SequencePackFunctor<device_type, T>::Pack(
+        ctx->device_ctx(), dy->shape().At(0), dy->shape().At(1), dy->shape().Count(2),
+        cu_seqlens->dptr<int32_t>(), dy->dptr<T>(), dx->mut_dptr<T>());
+  }
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+};
+
+#define REGISTER_SEQUENCE_PACK_KERNELS(device, dtype_pair)                                  \
+  REGISTER_USER_KERNEL("pack_sequence")                                                     \
+      .SetCreateFn<PackSequenceKernel<device, OF_PP_PAIR_FIRST(dtype_pair)>>()              \
+      .SetIsMatchedHob((user_op::HobDeviceTag() == device)                                  \
+                       & (user_op::HobDataType("in", 0) == OF_PP_PAIR_SECOND(dtype_pair))); \
+  REGISTER_USER_KERNEL("unpack_sequence")                                                   \
+      .SetCreateFn<UnpackSequenceKernel<device, OF_PP_PAIR_FIRST(dtype_pair)>>()            \
+      .SetIsMatchedHob((user_op::HobDeviceTag() == device)                                  \
+                       & (user_op::HobDataType("in", 0) == OF_PP_PAIR_SECOND(dtype_pair))); \
+  REGISTER_USER_KERNEL("unpack_sequence_grad")                                              \
+      .SetCreateFn<UnpackSequenceGradKernel<device, OF_PP_PAIR_FIRST(dtype_pair)>>()        \
+      .SetIsMatchedHob((user_op::HobDeviceTag() == device)                                  \
+                       & (user_op::HobDataType("dy", 0) == OF_PP_PAIR_SECOND(dtype_pair)));
+
+OF_PP_SEQ_PRODUCT_FOR_EACH_TUPLE(REGISTER_SEQUENCE_PACK_KERNELS, (DeviceType::kCPU),
+                                 SEQUENCE_PACK_DATA_TYPE_CPU_SEQ)
+#ifdef WITH_CUDA
+OF_PP_SEQ_PRODUCT_FOR_EACH_TUPLE(REGISTER_SEQUENCE_PACK_KERNELS, (DeviceType::kGPU),
+                                 SEQUENCE_PACK_DATA_TYPE_GPU_SEQ)
+#endif  // WITH_CUDA
+
+}  // namespace user_op
+}  // namespace oneflow
@@ -14,7 +14,6 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #include "oneflow/user/kernels/softmax_kernel_util.h"
-#include "oneflow/core/ndarray/ndarray_util.h"
 
 namespace oneflow {
 
@@ -49,58 +48,43 @@ struct SoftmaxKernelUtil<DeviceType::kCPU, T> {
 
   static void ComputeProb(DeviceCtx* ctx, const int64_t n, const int64_t w, const T* in, T* prob,
                           void* temp_storage, const size_t temp_storage_bytes) {
-    auto Val = NdarrayUtil<DeviceType::kCPU, T>::GetValNdarrayBuilder();
-    auto Var = NdarrayUtil<DeviceType::kCPU, T>::GetVarNdarrayBuilder();
     const size_t min_temp_storage_bytes =
         SoftmaxKernelUtil<DeviceType::kCPU, T>::GetComputeProbTempStorageSizeInBytes(n, w);
     CHECK_GE(temp_storage_bytes, min_temp_storage_bytes);
-    const size_t reduce_temp_storage_bytes = GetReduceTempStorageSize<T>(n, w);
-    T* reduce_storage = reinterpret_cast<T*>(temp_storage);
-    auto reduce_storage_var =
-        Var({static_cast<int64_t>(reduce_temp_storage_bytes / sizeof(T))}, reduce_storage);
-    T* tmp = reinterpret_cast<T*>(reinterpret_cast<unsigned char*>(temp_storage)
-                                  + reduce_temp_storage_bytes);
-    // max | tmp[i] = Max_j(in[i][j])
-    NdarrayUtil<DeviceType::kCPU, T>::ReduceMax(ctx, Var({n, 1}, tmp), Val({n, w}, in),
-                                                reduce_storage_var);
-    // sub | prob[i][j] = in[i][j] - tmp[i]
-    NdarrayUtil<DeviceType::kCPU, T>::BroadcastSub(ctx, Var({n, w}, prob), Val({n, w}, in),
-                                                   Val({n, 1}, tmp));
-    // exp | prob[i][j] = exp(prob[i][j])
-    NdarrayUtil<DeviceType::kCPU, T>::InplaceExp(ctx, Var({n, w}, prob));
-    // sum | tmp[i] = Sum_j(prob[i][j])
-    NdarrayUtil<DeviceType::kCPU, T>::ReduceSum(ctx, Var({n, 1}, tmp), Val({n, w}, prob),
-                                                reduce_storage_var);
-    // div | prob[i][j] /= tmp[i]
-    NdarrayUtil<DeviceType::kCPU, T>::InplaceBroadcastDiv(ctx, Var({n, w}, prob), Val({n, 1}, tmp));
+    // the rows are independent, so each row runs max, sub, exp, sum and div in one pass of the loop
+    ctx->ParallelFor(n, ParallelForGrainSize(4 * w), [&](int64_t begin, int64_t end) {
+      FOR_RANGE(int64_t, i, begin, end) {
+        const T* row_in = in + i * w;
+        T* row_prob = prob + i * w;
+        T max = row_in[0];
+        FOR_RANGE(int64_t, j, 1, w) { max = std::max(max, row_in[j]); }
+        T sum = 0;
+        FOR_RANGE(int64_t, j, 0, w) {
+          row_prob[j] = std::exp(row_in[j] - max);
+          sum += row_prob[j];
+        }
+        FOR_RANGE(int64_t, j, 0, w) { row_prob[j] /= sum; }
+      }
+    });
   }
 
   static void ComputeDiff(DeviceCtx* ctx, const int64_t n, const int64_t w, const T* dy,
                           const T* out, T* dx, void* temp_storage,
                           const size_t temp_storage_bytes) {
-    auto Val = NdarrayUtil<DeviceType::kCPU, T>::GetValNdarrayBuilder();
-    auto Var = NdarrayUtil<DeviceType::kCPU, T>::GetVarNdarrayBuilder();
     const size_t min_temp_storage_bytes =
         SoftmaxKernelUtil<DeviceType::kCPU, T>::GetComputeProbTempStorageSizeInBytes(n, w);
     CHECK_GE(temp_storage_bytes, min_temp_storage_bytes);
-    const size_t reduce_temp_storage_bytes = GetReduceTempStorageSize<T>(n, w);
-    T* reduce_storage = reinterpret_cast<T*>(temp_storage);
-    auto reduce_storage_var =
-        Var({static_cast<int64_t>(reduce_temp_storage_bytes / sizeof(T))}, reduce_storage);
-    T* sum_vec = reinterpret_cast<T*>(reinterpret_cast<unsigned char*>(temp_storage)
-                                      + reduce_temp_storage_bytes);
-    // it's safe to use dx as tmp
-    // dot product | get dot product sum_vec[i] from out[i] * dy[i]
-    T* tmp = dx;
-    NdarrayUtil<DeviceType::kCPU, T>::Mul(ctx, Var({n * w}, tmp), Val({n * w}, out),
-                                          Val({n * w}, dy));
-    NdarrayUtil<DeviceType::kCPU, T>::ReduceSum(ctx, Var({n, 1}, sum_vec), Val({n, w}, tmp),
-                                                reduce_storage_var);
-    // sub | dx[i][j] = dy[i][j] - sum_vec[i]
-    NdarrayUtil<DeviceType::kCPU, T>::BroadcastSub(ctx, Var({n, w}, dx), Val({n, w}, dy),
-                                                   Val({n, 1}, sum_vec));
-    // elementwise multiplication | dx[i][j] *= out[i][j]
-    NdarrayUtil<DeviceType::kCPU, T>::InplaceMul(ctx, Var({n * w}, dx), Val({n * w}, out));
+    // dx[i][j] = (dy[i][j] - Sum_k(out[i][k] * dy[i][k])) * out[i][j]
+    ctx->ParallelFor(n, ParallelForGrainSize(3 * w), [&](int64_t begin, int64_t end) {
+      FOR_RANGE(int64_t, i, begin, end) {
+        const T* row_dy = dy + i * w;
+        const T* row_out = out + i * w;
+        T* row_dx = dx + i * w;
+        T dot = 0;
+        FOR_RANGE(int64_t, j, 0, w) { dot += row_out[j] * row_dy[j]; }
+        FOR_RANGE(int64_t, j, 0, w) { row_dx[j] = (row_dy[j] - dot) * row_out[j]; }
+      }
+    });
   }
 };
 
@@ -17,6 +17,7 @@ limitations under the License.
 #include "oneflow/core/common/balanced_splitter.h"
 #include "oneflow/user/kernels/sparse_cross_entropy_kernel_util.h"
 #include "oneflow/user/kernels/softmax_kernel_util.h"
+#include "oneflow/user/kernels/sparse_softmax_cross_entropy_kernel_util.h"
 #include "oneflow/core/job/parallel_distribution_util.h"
 
 namespace oneflow {
@@ -38,6 +39,31 @@ class SparseSoftmaxCrossEntropyOpKernelState final : public user_op::OpKernelSta
   const int64_t upper_;
 };
 
+std::shared_ptr<user_op::OpKernelState> CreateSparseSoftmaxCrossEntropyOpKernelState(
+    user_op::KernelInitContext* ctx, const std::string& arg_name) {
+  if (ctx->parallel_ctx().parallel_num() > 1) {
+    const cfg::ParallelDistribution& parallel_distribution =
+        ctx->ParallelDistribution4ArgNameAndIndex(arg_name, 0);
+    const Shape& hierarchy = *ctx->parallel_desc().hierarchy();
+    const TensorDesc* logical_desc = ctx->LogicalTensorDesc4ArgNameAndIndex(arg_name, 0);
+    const int64_t class_axis = logical_desc->shape().NumAxes() - 1;
+    TensorSliceView view = GetTensorSliceView4ParallelId(
+        hierarchy, parallel_distribution, logical_desc->shape(), ctx->parallel_ctx().parallel_id());
+    return std::make_shared<SparseSoftmaxCrossEntropyOpKernelState>(view.At(class_axis).begin(),
+                                                                    view.At(class_axis).end());
+  } else {
+    return std::shared_ptr<OpKernelState>(nullptr);
+  }
+}
+
+int64_t GetLowerBound(const int64_t num_classes, user_op::OpKernelState* state) {
+  if (state == nullptr) { return 0; }
+  auto* kernel_state = dynamic_cast<SparseSoftmaxCrossEntropyOpKernelState*>(state);
+  CHECK_NOTNULL(kernel_state);
+  CHECK_EQ(num_classes, kernel_state->upper() - kernel_state->lower());
+  return kernel_state->lower();
+}
+
 }  // namespace
 
 template<DeviceType device_type, typename T, typename K>
@@ -95,6 +121,11 @@ class SparseSoftmaxCrossEntropyMsKernel final : public user_op::OpKernel {
         const int64_t num_instances = prediction_shape.Count(0, prediction_shape.NumAxes() - 1); \
         return SoftmaxKernelUtil<device_type_v, OF_PP_PAIR_FIRST(dtype_pair)>::                  \
             GetComputeProbTempStorageSizeInBytes(num_instances, num_classes);                    \
+      })                                                                                         \
+      .SetInplaceProposalFn([](const user_op::InferContext&,                                     \
+                               user_op::AddInplaceArgPair AddInplaceArgPairFn) -> Maybe<void> {  \
+        OF_RETURN_IF_ERROR(AddInplaceArgPairFn("prob", 0, "prediction", 0, true));               \
+        return Maybe<void>::Ok();                                                                \
       });
 
 OF_PP_SEQ_PRODUCT_FOR_EACH_TUPLE(REGISTER_SPARSE_SOFTMAX_CROSS_ENTROPY_KERNEL,
@@ -115,6 +146,98 @@ OF_PP_SEQ_PRODUCT_FOR_EACH_TUPLE(REGISTER_SPARSE_SOFTMAX_CROSS_ENTROPY_KERNEL,
                                  FLOATING_DATA_TYPE_SEQ FLOAT16_DATA_TYPE_SEQ, INDEX_DATA_TYPE_SEQ)
 #endif
 
+template<DeviceType device_type, typename T>
+class SparseSoftmaxCrossEntropyMsDeviceStageKernel final : public user_op::OpKernel {
+ public:
+  SparseSoftmaxCrossEntropyMsDeviceStageKernel() = default;
+  ~SparseSoftmaxCrossEntropyMsDeviceStageKernel() = default;
+
+ private:
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    using StatType = typename SoftmaxStatType<T>::type;
+    const user_op::Tensor* prediction = ctx->Tensor4ArgNameAndIndex("prediction", 0);
+    user_op::Tensor* stat = ctx->Tensor4ArgNameAndIndex("stat", 0);
+    const int64_t num_instances = stat->shape().elem_cnt() / 2;
+    CHECK_EQ(prediction->shape().elem_cnt() % num_instances, 0);
+    const int64_t num_classes = prediction->shape().elem_cnt() / num_instances;
+    SparseSoftmaxCrossEntropyMsDeviceStageUtil<device_type, T>::ComputeStat(
+        ctx->device_ctx(), num_instances, num_classes, prediction->dptr<T>(),
+        stat->mut_dptr<StatType>());
+  }
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+};
+
+#define REGISTER_SPARSE_SOFTMAX_CROSS_ENTROPY_MS_DEVICE_STAGE_KERNEL(device_type_v, dtype_pair)  \
+  REGISTER_USER_KERNEL("sparse_softmax_cross_entropy_ms_device_stage")                           \
+      .SetCreateFn<SparseSoftmaxCrossEntropyMsDeviceStageKernel<device_type_v,                   \
+                                                                OF_PP_PAIR_FIRST(dtype_pair)>>() \
+      .SetIsMatchedHob((user_op::HobDeviceTag() == device_type_v)                                \
+                       & (user_op::HobDataType("prediction", 0) == OF_PP_PAIR_SECOND(dtype_pair)));
+
+OF_PP_SEQ_PRODUCT_FOR_EACH_TUPLE(REGISTER_SPARSE_SOFTMAX_CROSS_ENTROPY_MS_DEVICE_STAGE_KERNEL,
+                                 OF_PP_MAKE_TUPLE_SEQ(DeviceType::kCPU), FLOATING_DATA_TYPE_SEQ)
+#ifdef WITH_CUDA
+OF_PP_SEQ_PRODUCT_FOR_EACH_TUPLE(REGISTER_SPARSE_SOFTMAX_CROSS_ENTROPY_MS_DEVICE_STAGE_KERNEL,
+                                 OF_PP_MAKE_TUPLE_SEQ(DeviceType::kGPU),
+                                 FLOATING_DATA_TYPE_SEQ FLOAT16_DATA_TYPE_SEQ)
+#endif
+
+template<DeviceType device_type, typename T, typename K>
+class SparseSoftmaxCrossEntropyMsGlobalStageKernel final : public user_op::OpKernel {
+ public:
+  SparseSoftmaxCrossEntropyMsGlobalStageKernel() = default;
+  ~SparseSoftmaxCrossEntropyMsGlobalStageKernel() = default;
+  std::shared_ptr<user_op::OpKernelState> CreateOpKernelState(
+      user_op::KernelInitContext* ctx) const override {
+    return CreateSparseSoftmaxCrossEntropyOpKernelState(ctx, "prediction");
+  }
+
+ private:
+  void Compute(user_op::KernelComputeContext* ctx, user_op::OpKernelState* state) const override {
+    using StatType = typename SoftmaxStatType<T>::type;
+    const user_op::Tensor* prediction = ctx->Tensor4ArgNameAndIndex("prediction", 0);
+    const user_op::Tensor* stat = ctx->Tensor4ArgNameAndIndex("stat", 0);
+    const user_op::Tensor* label = ctx->Tensor4ArgNameAndIndex("label", 0);
+    user_op::Tensor* prob = ctx->Tensor4ArgNameAndIndex("prob", 0);
+    user_op::Tensor* out = ctx->Tensor4ArgNameAndIndex("out", 0);
+    const int64_t num_instances = label->shape().elem_cnt();
+    CHECK_EQ(prediction->shape().elem_cnt() % num_instances, 0);
+    const int64_t num_classes = prediction->shape().elem_cnt() / num_instances;
+    CHECK_EQ(stat->shape().elem_cnt() % (2 * num_instances), 0);
+    const int64_t num_stats = stat->shape().elem_cnt() / (2 * num_instances);
+    const int64_t depth = ctx->Attr<int64_t>("depth");
+    const int64_t lower_bound = GetLowerBound(num_classes, state);
+    SparseSoftmaxCrossEntropyMsGlobalStageUtil<device_type, T, K>::ComputeProbAndEntropy(
+        ctx->device_ctx(), num_instances, num_classes, num_stats, depth, lower_bound,
+        prediction->dptr<T>(), stat->dptr<StatType>(), label->dptr<K>(), prob->mut_dptr<T>(),
+        out->mut_dptr<T>());
+  }
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+};
+
+#define REGISTER_SPARSE_SOFTMAX_CROSS_ENTROPY_MS_GLOBAL_STAGE_KERNEL(device_type_v, dtype_pair, \
+                                                                     ltype_pair)                \
+  REGISTER_USER_KERNEL("sparse_softmax_cross_entropy_ms_global_stage")                          \
+      .SetCreateFn<SparseSoftmaxCrossEntropyMsGlobalStageKernel<                                \
+          device_type_v, OF_PP_PAIR_FIRST(dtype_pair), OF_PP_PAIR_FIRST(ltype_pair)>>()         \
+      .SetIsMatchedHob((user_op::HobDeviceTag() == device_type_v)                               \
+                       & (user_op::HobDataType("label", 0) == OF_PP_PAIR_SECOND(ltype_pair))    \
+                       & (user_op::HobDataType("out", 0) == OF_PP_PAIR_SECOND(dtype_pair)))     \
+      .SetInplaceProposalFn([](const user_op::InferContext&,                                    \
+                               user_op::AddInplaceArgPair AddInplaceArgPairFn) -> Maybe<void> { \
+        OF_RETURN_IF_ERROR(AddInplaceArgPairFn("prob", 0, "prediction", 0, true));              \
+        return Maybe<void>::Ok();                                                               \
+      });
+
+OF_PP_SEQ_PRODUCT_FOR_EACH_TUPLE(REGISTER_SPARSE_SOFTMAX_CROSS_ENTROPY_MS_GLOBAL_STAGE_KERNEL,
+                                 OF_PP_MAKE_TUPLE_SEQ(DeviceType::kCPU), FLOATING_DATA_TYPE_SEQ,
+                                 INDEX_DATA_TYPE_SEQ)
+#ifdef WITH_CUDA
+OF_PP_SEQ_PRODUCT_FOR_EACH_TUPLE(REGISTER_SPARSE_SOFTMAX_CROSS_ENTROPY_MS_GLOBAL_STAGE_KERNEL,
+                                 OF_PP_MAKE_TUPLE_SEQ(DeviceType::kGPU),
+                                 FLOATING_DATA_TYPE_SEQ FLOAT16_DATA_TYPE_SEQ, INDEX_DATA_TYPE_SEQ)
+#endif
+
 template<DeviceType device_type, typename T, typename K>
 class SparseSoftmaxCrossEntropyGradKernel final : public user_op::OpKernel {
  public:
@@ -146,20 +269,7 @@ class SparseSoftmaxCrossEntropyMsGradKernel final : public user_op::OpKernel {
   ~SparseSoftmaxCrossEntropyMsGradKernel() = default;
   std::shared_ptr<user_op::OpKernelState> CreateOpKernelState(
       user_op::KernelInitContext* ctx) const override {
-    if (ctx->parallel_ctx().parallel_num() > 1) {
-      const cfg::ParallelDistribution& parallel_distribution =
-          ctx->ParallelDistribution4ArgNameAndIndex("prob", 0);
-      const Shape& hierarchy = *ctx->parallel_desc().hierarchy();
-      const TensorDesc* prob_logical_desc = ctx->LogicalTensorDesc4ArgNameAndIndex("prob", 0);
-      const int64_t class_axis = prob_logical_desc->shape().NumAxes() - 1;
-      TensorSliceView view = GetTensorSliceView4ParallelId(hierarchy, parallel_distribution,
-                                                           prob_logical_desc->shape(),
-                                                           ctx->parallel_ctx().parallel_id());
-      return std::make_shared<SparseSoftmaxCrossEntropyOpKernelState>(view.At(class_axis).begin(),
-                                                                      view.At(class_axis).end());
-    } else {
-      return std::shared_ptr<OpKernelState>(nullptr);
-    }
+    return CreateSparseSoftmaxCrossEntropyOpKernelState(ctx, "prob");
   }
 
  private:
@@ -172,13 +282,7 @@ class SparseSoftmaxCrossEntropyMsGradKernel final : public user_op::OpKernel {
     CHECK_EQ(prob->shape().elem_cnt() % num_instances, 0);
     const int64_t num_classes = prob->shape().elem_cnt() / num_instances;
     const int64_t depth = ctx->Attr<int64_t>("depth");
-    int64_t lower_bound = 0;
-    if (state != nullptr) {
-      auto* kernel_state = dynamic_cast<SparseSoftmaxCrossEntropyOpKernelState*>(state);
-      CHECK_NOTNULL(kernel_state);
-      CHECK_EQ(num_classes, kernel_state->upper() - kernel_state->lower());
-      lower_bound = kernel_state->lower();
-    }
+    const int64_t lower_bound = GetLowerBound(num_classes, state);
     SparseCrossEntropyKernelUtil<device_type, T, K>::ComputeDiffWithSoftmax(
         ctx->device_ctx(), prediction_diff->shape().elem_cnt(), num_classes, depth, lower_bound,
         prob->dptr<T>(), label->dptr<K>(), dy->dptr<T>(), prediction_diff->mut_dptr<T>());
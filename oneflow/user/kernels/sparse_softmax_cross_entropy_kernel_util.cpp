@@ -0,0 +1,91 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/user/kernels/sparse_softmax_cross_entropy_kernel_util.h"
+
+namespace oneflow {
+namespace user_op {
+
+template<typename T>
+struct SparseSoftmaxCrossEntropyMsDeviceStageUtil<DeviceType::kCPU, T> {
+  static void ComputeStat(DeviceCtx* ctx, const int64_t num_instances, const int64_t num_classes,
+                          const T* x, T* stat) {
+    const int64_t grain_size = ParallelForGrainSize(2 * num_classes);
+    ctx->ParallelFor(num_instances, grain_size, [&](int64_t begin, int64_t end) {
+      FOR_RANGE(int64_t, i, begin, end) {
+        const T* row_x = x + i * num_classes;
+        T max = row_x[0];
+        FOR_RANGE(int64_t, j, 1, num_classes) { max = std::max(max, row_x[j]); }
+        T sum = 0;
+        FOR_RANGE(int64_t, j, 0, num_classes) { sum += std::exp(row_x[j] - max); }
+        stat[i * 2] = max;
+        stat[i * 2 + 1] = sum;
+      }
+    });
+  }
+};
+
+template<typename T, typename K>
+struct SparseSoftmaxCrossEntropyMsGlobalStageUtil<DeviceType::kCPU, T, K> {
+  static void ComputeProbAndEntropy(DeviceCtx* ctx, const int64_t num_instances,
+                                    const int64_t num_classes, const int64_t num_stats,
+                                    const int64_t depth, const int64_t lower_bound, const T* x,
+                                    const T* stat, const K* labels, T* prob, T* y) {
+    FOR_RANGE(int64_t, i, 0, num_instances) {
+      CHECK_GE(labels[i], 0);
+      CHECK_LT(labels[i], depth);
+    }
+    const int64_t grain_size = ParallelForGrainSize(2 * num_classes);
+    ctx->ParallelFor(num_instances, grain_size, [&](int64_t begin, int64_t end) {
+      FOR_RANGE(int64_t, i, begin, end) {
+        const T* row_stat = stat + i * num_stats * 2;
+        T max = row_stat[0];
+        FOR_RANGE(int64_t, s, 1, num_stats) { max = std::max(max, row_stat[s * 2]); }
+        T sum = 0;
+        FOR_RANGE(int64_t, s, 0, num_stats) {
+          sum += row_stat[s * 2 + 1] * std::exp(row_stat[s * 2] - max);
+        }
+        const T* row_x = x + i * num_classes;
+        T* row_prob = prob + i * num_classes;
+        // the label logit is read before the row is overwritten when prob aliases x
+        const K label = labels[i] - lower_bound;
+        if (label >= 0 && label < num_classes) {
+          y[i] = max + std::log(sum) - row_x[label];
+        } else {
+          y[i] = 0;
+        }
+        FOR_RANGE(int64_t, j, 0, num_classes) { row_prob[j] = std::exp(row_x[j] - max) / sum; }
+      }
+    });
+  }
+};
+
+#define INSTANTIATE_SPARSE_SOFTMAX_CROSS_ENTROPY_MS_DEVICE_STAGE_UTIL_CPU(data_type_pair) \
+  template struct SparseSoftmaxCrossEntropyMsDeviceStageUtil<                             \
+      DeviceType::kCPU, OF_PP_PAIR_FIRST(data_type_pair)>;
+OF_PP_FOR_EACH_TUPLE(INSTANTIATE_SPARSE_SOFTMAX_CROSS_ENTROPY_MS_DEVICE_STAGE_UTIL_CPU,
+                     FLOATING_DATA_TYPE_SEQ);
+#undef INSTANTIATE_SPARSE_SOFTMAX_CROSS_ENTROPY_MS_DEVICE_STAGE_UTIL_CPU
+
+#define INSTANTIATE_SPARSE_SOFTMAX_CROSS_ENTROPY_MS_GLOBAL_STAGE_UTIL_CPU(data_type_pair,  \
+                                                                          index_type_pair) \
+  template struct SparseSoftmaxCrossEntropyMsGlobalStageUtil<                              \
+      DeviceType::kCPU, OF_PP_PAIR_FIRST(data_type_pair), OF_PP_PAIR_FIRST(index_type_pair)>;
+OF_PP_SEQ_PRODUCT_FOR_EACH_TUPLE(INSTANTIATE_SPARSE_SOFTMAX_CROSS_ENTROPY_MS_GLOBAL_STAGE_UTIL_CPU,
+                                 FLOATING_DATA_TYPE_SEQ, INDEX_DATA_TYPE_SEQ);
+#undef INSTANTIATE_SPARSE_SOFTMAX_CROSS_ENTROPY_MS_GLOBAL_STAGE_UTIL_CPU
+
+}  // namespace user_op
+}  // namespace oneflow
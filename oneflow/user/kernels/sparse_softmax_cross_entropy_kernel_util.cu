@@ -0,0 +1,144 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/user/kernels/sparse_softmax_cross_entropy_kernel_util.h"
+#include "oneflow/core/cuda/softmax.cuh"
+
+namespace oneflow {
+namespace user_op {
+
+namespace {
+
+constexpr int kStatBlockSize = 1024;
+constexpr int kStatWaves = 32;
+
+template<typename T>
+struct DeviceDataType {
+  using type = T;
+};
+
+template<>
+struct DeviceDataType<float16> {
+  using type = half;
+};
+
+template<typename T, typename ComputeType, int block_size>
+__global__ void ComputeStatGpu(const int64_t num_instances, const int64_t num_classes, const T* x,
+                               ComputeType* stat) {
+  using namespace cuda::softmax;
+  for (int64_t row = blockIdx.x; row < num_instances; row += gridDim.x) {
+    const T* row_x = x + row * num_classes;
+    ComputeType thread_max = -Inf<ComputeType>();
+    for (int64_t col = threadIdx.x; col < num_classes; col += block_size) {
+      thread_max = max(thread_max, static_cast<ComputeType>(row_x[col]));
+    }
+    const ComputeType row_max = BlockAllReduce<MaxOp, ComputeType, block_size>(thread_max);
+    ComputeType thread_sum = 0;
+    for (int64_t col = threadIdx.x; col < num_classes; col += block_size) {
+      thread_sum += Exp(static_cast<ComputeType>(row_x[col]) - row_max);
+    }
+    const ComputeType row_sum = BlockAllReduce<SumOp, ComputeType, block_size>(thread_sum);
+    if (threadIdx.x == 0) {
+      stat[row * 2] = row_max;
+      stat[row * 2 + 1] = row_sum;
+    }
+  }
+}
+
+template<typename T, typename ComputeType, typename K, int block_size>
+__global__ void ComputeProbAndEntropyGpu(const int64_t num_instances, const int64_t num_classes,
+                                         const int64_t num_stats, const int64_t depth,
+                                         const int64_t lower_bound, const T* x,
+                                         const ComputeType* stat, const K* labels, T* prob, T* y) {
+  using namespace cuda::softmax;
+  for (int64_t row = blockIdx.x; row < num_instances; row += gridDim.x) {
+    const ComputeType* row_stat = stat + row * num_stats * 2;
+    ComputeType row_max = row_stat[0];
+    for (int64_t s = 1; s < num_stats; ++s) { row_max = max(row_max, row_stat[s * 2]); }
+    ComputeType row_sum = 0;
+    for (int64_t s = 0; s < num_stats; ++s) {
+      row_sum += row_stat[s * 2 + 1] * Exp(row_stat[s * 2] - row_max);
+    }
+    const T* row_x = x + row * num_classes;
+    T* row_prob = prob + row * num_classes;
+    if (threadIdx.x == 0) {
+      assert(labels[row] >= 0);
+      assert(labels[row] < depth);
+      const K label = labels[row] - lower_bound;
+      ComputeType loss = 0;
+      if (label >= 0 && label < num_classes) {
+        loss = row_max + log(row_sum) - static_cast<ComputeType>(row_x[label]);
+      }
+      y[row] = static_cast<T>(loss);
+    }
+    // the label logit must be read before the row is overwritten when prob aliases x
+    __syncthreads();
+    for (int64_t col = threadIdx.x; col < num_classes; col += block_size) {
+      row_prob[col] =
+          static_cast<T>(Div(Exp(static_cast<ComputeType>(row_x[col]) - row_max), row_sum));
+    }
+  }
+}
+
+}  // namespace
+
+template<typename T>
+struct SparseSoftmaxCrossEntropyMsDeviceStageUtil<DeviceType::kGPU, T> {
+  using StatType = typename SoftmaxStatType<T>::type;
+  static void ComputeStat(DeviceCtx* ctx, const int64_t num_instances, const int64_t num_classes,
+                          const T* x, StatType* stat) {
+    using DeviceT = typename DeviceDataType<T>::type;
+    const int grid_dim_x = cuda::softmax::GetNumBlocks(kStatBlockSize, num_instances, kStatWaves);
+    ComputeStatGpu<DeviceT, StatType, kStatBlockSize>
+        <<<grid_dim_x, kStatBlockSize, 0, ctx->cuda_stream()>>>(
+            num_instances, num_classes, reinterpret_cast<const DeviceT*>(x), stat);
+  }
+};
+
+template<typename T, typename K>
+struct SparseSoftmaxCrossEntropyMsGlobalStageUtil<DeviceType::kGPU, T, K> {
+  using StatType = typename SoftmaxStatType<T>::type;
+  static void ComputeProbAndEntropy(DeviceCtx* ctx, const int64_t num_instances,
+                                    const int64_t num_classes, const int64_t num_stats,
+                                    const int64_t depth, const int64_t lower_bound, const T* x,
+                                    const StatType* stat, const K* labels, T* prob, T* y) {
+    using DeviceT = typename DeviceDataType<T>::type;
+    const int grid_dim_x = cuda::softmax::GetNumBlocks(kStatBlockSize, num_instances, kStatWaves);
+    ComputeProbAndEntropyGpu<DeviceT, StatType, K, kStatBlockSize>
+        <<<grid_dim_x, kStatBlockSize, 0, ctx->cuda_stream()>>>(
+            num_instances, num_classes, num_stats, depth, lower_bound,
+            reinterpret_cast<const DeviceT*>(x), stat, labels, reinterpret_cast<DeviceT*>(prob),
+            reinterpret_cast<DeviceT*>(y));
+  }
+};
+
+#define INSTANTIATE_SPARSE_SOFTMAX_CROSS_ENTROPY_MS_DEVICE_STAGE_UTIL_GPU(data_type_pair) \
+  template struct SparseSoftmaxCrossEntropyMsDeviceStageUtil<DeviceType::kGPU,            \
+                                                             OF_PP_PAIR_FIRST(data_type_pair)>;
+OF_PP_FOR_EACH_TUPLE(INSTANTIATE_SPARSE_SOFTMAX_CROSS_ENTROPY_MS_DEVICE_STAGE_UTIL_GPU,
+                     FLOATING_DATA_TYPE_SEQ FLOAT16_DATA_TYPE_SEQ);
+#undef INSTANTIATE_SPARSE_SOFTMAX_CROSS_ENTROPY_MS_DEVICE_STAGE_UTIL_GPU
+
+#define INSTANTIATE_SPARSE_SOFTMAX_CROSS_ENTROPY_MS_GLOBAL_STAGE_UTIL_GPU(data_type_pair,  \
+                                                                          index_type_pair) \
+  template struct SparseSoftmaxCrossEntropyMsGlobalStageUtil<                              \
+      DeviceType::kGPU, OF_PP_PAIR_FIRST(data_type_pair), OF_PP_PAIR_FIRST(index_type_pair)>;
+OF_PP_SEQ_PRODUCT_FOR_EACH_TUPLE(INSTANTIATE_SPARSE_SOFTMAX_CROSS_ENTROPY_MS_GLOBAL_STAGE_UTIL_GPU,
+                                 FLOATING_DATA_TYPE_SEQ FLOAT16_DATA_TYPE_SEQ,
+                                 INDEX_DATA_TYPE_SEQ);
+#undef INSTANTIATE_SPARSE_SOFTMAX_CROSS_ENTROPY_MS_GLOBAL_STAGE_UTIL_GPU
+
+}  // namespace user_op
+}  // namespace oneflow
@@ -0,0 +1,59 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef ONEFLOW_USER_KERNELS_SPARSE_SOFTMAX_CROSS_ENTROPY_KERNEL_UTIL_H_
+#define ONEFLOW_USER_KERNELS_SPARSE_SOFTMAX_CROSS_ENTROPY_KERNEL_UTIL_H_
+
+#include "oneflow/core/kernel/kernel_util.h"
+
+namespace oneflow {
+namespace user_op {
+
+// the per device softmax statistics are kept in float for half prediction, the sum of exp over a
+// large vocabulary shard does not fit in half
+template<typename T>
+struct SoftmaxStatType {
+  using type = T;
+};
+
+template<>
+struct SoftmaxStatType<float16> {
+  using type = float;
+};
+
+template<DeviceType device_type, typename T>
+struct SparseSoftmaxCrossEntropyMsDeviceStageUtil {
+  using StatType = typename SoftmaxStatType<T>::type;
+  // stat[i * 2] = max_j(x[i][j]), stat[i * 2 + 1] = sum_j(exp(x[i][j] - stat[i * 2]))
+  static void ComputeStat(DeviceCtx* ctx, const int64_t num_instances, const int64_t num_classes,
+                          const T* x, StatType* stat);
+};
+
+template<DeviceType device_type, typename T, typename K>
+struct SparseSoftmaxCrossEntropyMsGlobalStageUtil {
+  using StatType = typename SoftmaxStatType<T>::type;
+  // merges the num_stats (max, sum) pairs of each instance, then writes the softmax of the local
+  // class slice into prob and the loss of the labels falling in [lower_bound, lower_bound +
+  // num_classes) into y, x and prob may be the same buffer
+  static void ComputeProbAndEntropy(DeviceCtx* ctx, const int64_t num_instances,
+                                    const int64_t num_classes, const int64_t num_stats,
+                                    const int64_t depth, const int64_t lower_bound, const T* x,
+                                    const StatType* stat, const K* labels, T* prob, T* y);
+};
+
+}  // namespace user_op
+}  // namespace oneflow
+
+#endif  // ONEFLOW_USER_KERNELS_SPARSE_SOFTMAX_CROSS_ENTROPY_KERNEL_UTIL_H_
@@ -15,6 +15,7 @@ limitations under the License.
 */
 #include "oneflow/core/framework/framework.h"
 #include "oneflow/core/kernel/new_kernel_util.h"
+#include "oneflow/core/device/memory_copier.h"
 
 namespace oneflow {
 
@@ -23,7 +24,7 @@ namespace {
 template<DeviceType device_type, typename T>
 class SplitLikeKernel final : public user_op::OpKernel {
  public:
-  SplitLikeKernel() = default;
+  SplitLikeKernel() : memory_copier_(NewDefaultMemoryCopier(device_type)) {}
   ~SplitLikeKernel() override = default;
 
  private:
@@ -65,6 +66,8 @@ class SplitLikeKernel final : public user_op::OpKernel {
     const int64_t in_cols = in_tensor->shape().Count(axis);
     const int64_t rows = in_tensor->shape().elem_cnt() / in_cols;
     CHECK_GT(rows, 0);
+    std::vector<MemoryCopyNdDesc> descs;
+    std::vector<void*> dst;
     int64_t in_col_offset = 0;
     for (const auto& out_arg_pair : ctx->outputs()) {
       user_op::Tensor* out_tensor =
@@ -72,16 +75,28 @@ class SplitLikeKernel final : public user_op::OpKernel {
       const int64_t out_cols = out_tensor->shape().Count(axis);
       CHECK_EQ(out_tensor->shape().elem_cnt(), rows * out_cols);
       if (out_cols > 0) {
-        NewKernelUtil<device_type>::CopyColsRegion(ctx->device_ctx(), rows, out_cols,
-                                                   in_tensor->dptr<T>(), in_col_offset, in_cols,
-                                                   out_tensor->mut_dptr<T>(), 0, out_cols);
+        MemoryCopyNdDesc desc;
+        desc.dst_shape = Shape({rows, out_cols * static_cast<int64_t>(sizeof(T))});
+        desc.src_shape = Shape({rows, in_cols * static_cast<int64_t>(sizeof(T))});
+        desc.dst_pos = NdIndex({0, 0});
+        desc.src_pos = NdIndex({0, in_col_offset * static_cast<int64_t>(sizeof(T))});
+        desc.extent = desc.dst_shape;
+        desc.data_type = GetDataType<T>::value;
+        descs.push_back(desc.CreateDimReducedDesc());
+        dst.push_back(out_tensor->mut_dptr());
       }
       in_col_offset += out_cols;
     }
     CHECK_EQ(in_col_offset, in_cols);
+    std::vector<const void*> src(descs.size(), in_tensor->dptr());
+    std::vector<const MemoryCopyNdDesc*> desc_ptrs;
+    for (const MemoryCopyNdDesc& desc : descs) { desc_ptrs.push_back(&desc); }
+    memory_copier_->BatchCopy(ctx->device_ctx(), dst, src, desc_ptrs);
   }
 
   bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+
+  std::unique_ptr<MemoryCopier> memory_copier_;
 };
 
 }  // namespace
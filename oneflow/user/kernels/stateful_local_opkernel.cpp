@@ -409,6 +409,8 @@ Maybe<const user_op::OpKernel*> StatefulLocalOpKernel::ChooseOpKernel(
   op_kernel_map_.emplace(kernel_reg_val, std::shared_ptr<const user_op::OpKernel>(kernel));
 
   infer_tmp_size_fn_map_.emplace(kernel, &kernel_reg_val->infer_tmp_size_fn);
+  infer_flops_fn_map_.emplace(kernel, &kernel_reg_val->infer_flops_fn);
+  inplace_proposal_fn_map_.emplace(kernel, &kernel_reg_val->inplace_proposal_fn);
 
   return kernel;
 }
@@ -437,10 +439,33 @@ const user_op::InferTmpSizeFn& StatefulLocalOpKernel::GetInferTmpSizeFn(
   return *infer_tmp_size_fn_map_.at(op_kernel);
 }
 
+const user_op::InferFlopsFn& StatefulLocalOpKernel::GetInferFlopsFn(
+    const user_op::OpKernel* op_kernel) const {
+  return *infer_flops_fn_map_.at(op_kernel);
+}
+
+const user_op::InplaceProposalFn& StatefulLocalOpKernel::GetInplaceProposalFn(
+    const user_op::OpKernel* op_kernel) const {
+  return *inplace_proposal_fn_map_.at(op_kernel);
+}
+
 vm::EagerBlobObject* StatefulLocalOpKernel::mut_temp_blob_object() {
   return tmp_blob_object_.get();
 }
 
+CudaGraphKernelLauncher* StatefulLocalOpKernel::mut_cuda_graph_launcher(
+    const user_op::OpKernel* op_kernel) {
+  auto it = op_kernel2cuda_graph_launcher_.find(op_kernel);
+  if (it == op_kernel2cuda_graph_launcher_.end()) {
+    std::unique_ptr<CudaGraphKernelLauncher> launcher;
+    if (device_->type() == "cuda" && CudaGraphKernelLauncher::IsEnabled(op_kernel)) {
+      launcher.reset(new CudaGraphKernelLauncher());
+    }
+    it = op_kernel2cuda_graph_launcher_.emplace(op_kernel, std::move(launcher)).first;
+  }
+  return it->second.get();
+}
+
 user_op::TensorDescInferFn StatefulLocalOpKernel::TensorDescInferFn() const {
   return tensor_desc_infer_fn_;
 }
@@ -18,6 +18,7 @@ limitations under the License.
 
 #include "oneflow/core/eager/eager_blob_object.h"
 #include "oneflow/core/kernel/kernel.h"
+#include "oneflow/core/kernel/cuda_graph_support.h"
 #include "oneflow/core/framework/op_kernel.h"
 #include "oneflow/core/framework/device.h"
 #include "oneflow/core/framework/user_op_kernel_registry.h"
@@ -395,10 +396,17 @@ class StatefulLocalOpKernel final {
 
   bool need_check_mem_case() const { return need_check_mem_case_; }
 
+  // nullptr if `op_kernel' is not launched through CUDA graphs on this device
+  CudaGraphKernelLauncher* mut_cuda_graph_launcher(const user_op::OpKernel* op_kernel);
+
   Maybe<const user_op::OpKernel*> ChooseOpKernel(const EagerBlobObjectListPtr& inputs,
                                                  const EagerBlobObjectListPtr& outputs);
 
   const user_op::InferTmpSizeFn& GetInferTmpSizeFn(const user_op::OpKernel* op_kernel) const;
+  const user_op::InferFlopsFn& GetInferFlopsFn(const user_op::OpKernel* op_kernel) const;
+
+  // empty if the kernel declares no output that may share the memory of an input
+  const user_op::InplaceProposalFn& GetInplaceProposalFn(const user_op::OpKernel* op_kernel) const;
 
   std::shared_ptr<OperatorConf> op_conf_;
   std::unique_ptr<ComposedAttrMap> composed_attrs_for_scheduler_thread_;
@@ -418,7 +426,11 @@ class StatefulLocalOpKernel final {
   HashMap<const user_op::OpKernelRegistryResult*, std::shared_ptr<const user_op::OpKernel>>
       op_kernel_map_;
   HashMap<const user_op::OpKernel*, std::shared_ptr<user_op::OpKernelState>> op_kernel_state_map_;
+  HashMap<const user_op::OpKernel*, std::unique_ptr<CudaGraphKernelLauncher>>
+      op_kernel2cuda_graph_launcher_;
   HashMap<const user_op::OpKernel*, const user_op::InferTmpSizeFn*> infer_tmp_size_fn_map_;
+  HashMap<const user_op::OpKernel*, const user_op::InferFlopsFn*> infer_flops_fn_map_;
+  HashMap<const user_op::OpKernel*, const user_op::InplaceProposalFn*> inplace_proposal_fn_map_;
   std::unique_ptr<vm::EagerBlobObject> tmp_blob_object_;
   std::vector<int64_t> input_tuple_indexes4const_ibns_;
   std::vector<int64_t> input_tuple_indexes4mut_ibns_;
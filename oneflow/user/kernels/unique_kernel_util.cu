@@ -20,9 +20,11 @@ namespace oneflow {
 
 namespace {
 
-constexpr cuda::unique::Flag kUniqueFlag = cuda::unique::kOutputInverseIndices;
-constexpr cuda::unique::Flag kUniqueWithCountsFlag =
-    cuda::unique::kOutputInverseIndices | cuda::unique::kOutputCounts;
+constexpr cuda::unique::Flag kUniqueFlag =
+    cuda::unique::kOutputInverseIndices | cuda::unique::kOutputUnsorted;
+constexpr cuda::unique::Flag kUniqueWithCountsFlag = cuda::unique::kOutputInverseIndices
+                                                     | cuda::unique::kOutputCounts
+                                                     | cuda::unique::kOutputUnsorted;
 
 }  // namespace
 
@@ -16,6 +16,8 @@ limitations under the License.
 #include "oneflow/core/framework/framework.h"
 #include "oneflow/user/kernels/unsorted_segment_sum_kernel_util.h"
 #include "oneflow/core/job/parallel_distribution_util.h"
+#include "oneflow/core/job/resource_desc.h"
+#include "oneflow/core/job/global_for.h"
 
 namespace oneflow {
 
@@ -74,6 +76,18 @@ std::shared_ptr<user_op::OpKernelState> CreateUnsortedSegmentSumOpKernelState(
   }
 }
 
+bool IsDeterministicKernelsEnabled() {
+  return Global<ResourceDesc, ForSession>::Get()->enable_deterministic_kernels();
+}
+
+template<DeviceType device_type, typename T, typename K, typename U>
+size_t InferDeterministicTmpBufferSize(user_op::InferContext* ctx) {
+  if (!IsDeterministicKernelsEnabled()) { return 0; }
+  const int64_t num_segment_ids = ctx->InputShape("segment_ids", 0).elem_cnt();
+  return UnsortedSegmentSumKernelUtil<device_type, T, K, U>::GetDeterministicTmpBufferSize(
+      num_segment_ids);
+}
+
 }  // namespace
 
 template<DeviceType device_type, typename T, typename K>
@@ -107,7 +121,14 @@ class UnsortedSegmentSumKernel final : public user_op::OpKernel {
       offset = sum_state->lower();
     }
 
-    if (num_segment_ids != 0) {
+    if (num_segment_ids == 0) { return; }
+    if (IsDeterministicKernelsEnabled()) {
+      user_op::Tensor* tmp_buffer = ctx->Tensor4ArgNameAndIndex("tmp_buffer", 0);
+      UnsortedSegmentSumKernelUtil<device_type, T, K, T>::DeterministicUnsortedSegmentSum(
+          ctx->device_ctx(), segment_ids->dptr<K>(), data->dptr<T>(), num_segment_ids, num_segments,
+          outer_dim_size, inner_dim_size, offset, out->mut_dptr<T>(),
+          tmp_buffer == nullptr ? nullptr : tmp_buffer->mut_dptr());
+    } else {
       UnsortedSegmentSumKernelUtil<device_type, T, K, T>::UnsortedSegmentSum(
           ctx->device_ctx(), segment_ids->dptr<K>(), data->dptr<T>(), num_segment_ids, num_segments,
           outer_dim_size, inner_dim_size, offset, out->mut_dptr<T>());
@@ -123,7 +144,10 @@ class UnsortedSegmentSumKernel final : public user_op::OpKernel {
       .SetIsMatchedHob(                                                                       \
           (user_op::HobDeviceTag() == device)                                                 \
           & (user_op::HobDataType("segment_ids", 0) == OF_PP_PAIR_SECOND(segment_ids_type))   \
-          & (user_op::HobDataType("out", 0) == OF_PP_PAIR_SECOND(out_type)));
+          & (user_op::HobDataType("out", 0) == OF_PP_PAIR_SECOND(out_type)))                  \
+      .SetInferTmpSizeFn(InferDeterministicTmpBufferSize<device, OF_PP_PAIR_FIRST(out_type),  \
+                                                         OF_PP_PAIR_FIRST(segment_ids_type),  \
+                                                         OF_PP_PAIR_FIRST(out_type)>);
 
 #define REGISTER_UNSORTED_SEGMENT_SUM_KERNEL_CASE(device_type, out_type, segment_ids_type) \
   REGISTER_UNSORTED_SEGMENT_SUM_KERNEL(device_type, out_type, segment_ids_type,            \
@@ -172,9 +196,19 @@ class UnsortedSegmentSumHalfKernel final : public user_op::OpKernel {
       offset = sum_state->lower();
     }
 
-    UnsortedSegmentSumKernelUtil<DeviceType::kGPU, float, K, float16>::UnsortedSegmentSum(
-        ctx->device_ctx(), segment_ids->dptr<K>(), data->dptr<float16>(), num_segment_ids,
-        num_segments, outer_dim_size, inner_dim_size, offset, tmp_buf->mut_dptr<float>());
+    if (IsDeterministicKernelsEnabled()) {
+      const size_t sum_buf_size = GetCudaAlignedSize(out->shape().elem_cnt() * sizeof(float));
+      UnsortedSegmentSumKernelUtil<DeviceType::kGPU, float, K, float16>::
+          DeterministicUnsortedSegmentSum(ctx->device_ctx(), segment_ids->dptr<K>(),
+                                          data->dptr<float16>(), num_segment_ids, num_segments,
+                                          outer_dim_size, inner_dim_size, offset,
+                                          tmp_buf->mut_dptr<float>(),
+                                          tmp_buf->mut_dptr<char>() + sum_buf_size);
+    } else {
+      UnsortedSegmentSumKernelUtil<DeviceType::kGPU, float, K, float16>::UnsortedSegmentSum(
+          ctx->device_ctx(), segment_ids->dptr<K>(), data->dptr<float16>(), num_segment_ids,
+          num_segments, outer_dim_size, inner_dim_size, offset, tmp_buf->mut_dptr<float>());
+    }
 
     CopyElemOnGpu<float, float16>(ctx->device_ctx(), tmp_buf->dptr<float>(),
                                   out->mut_dptr<float16>(), out->shape().elem_cnt());
@@ -191,7 +225,10 @@ class UnsortedSegmentSumHalfKernel final : public user_op::OpKernel {
           & (user_op::HobDataType("out", 0) == OF_PP_PAIR_SECOND(out_type)))                    \
       .SetInferTmpSizeFn([](user_op::InferContext* ctx) {                                       \
         const Shape* out_shape = ctx->OutputShape("out", 0);                                    \
-        return GetCudaAlignedSize(out_shape->elem_cnt() * sizeof(float));                       \
+        return GetCudaAlignedSize(out_shape->elem_cnt() * sizeof(float))                        \
+               + InferDeterministicTmpBufferSize<DeviceType::kGPU, float,                       \
+                                                 OF_PP_PAIR_FIRST(segment_ids_type), float16>(  \
+                   ctx);                                                                        \
       });
 
 #define REGISTER_UNSORTED_SEGMENT_SUM_HALF_KERNEL_CASE(out_type, segment_ids_type) \
@@ -23,6 +23,15 @@ struct UnsortedSegmentSumKernelUtil<DeviceType::kCPU, T, K, T> final {
                                  int64_t num_segment_ids, int64_t num_segments,
                                  int64_t outer_dim_size, int64_t inner_dim_size,
                                  int64_t segment_id_offset, T* out);
+  static size_t GetDeterministicTmpBufferSize(int64_t num_segment_ids) { return 0; }
+  // the CPU sum is always deterministic
+  static void DeterministicUnsortedSegmentSum(DeviceCtx* ctx, const K* segment_ids, const T* data,
+                                              int64_t num_segment_ids, int64_t num_segments,
+                                              int64_t outer_dim_size, int64_t inner_dim_size,
+                                              int64_t segment_id_offset, T* out, void* tmp_buffer) {
+    UnsortedSegmentSum(ctx, segment_ids, data, num_segment_ids, num_segments, outer_dim_size,
+                       inner_dim_size, segment_id_offset, out);
+  }
 };
 
 template<typename T, typename K>
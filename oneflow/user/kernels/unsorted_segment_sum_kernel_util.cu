@@ -16,6 +16,7 @@ limitations under the License.
 #include "oneflow/core/common/nd_index_offset_helper.h"
 #include "oneflow/user/kernels/unsorted_segment_sum_kernel_util.h"
 #include "oneflow/core/cuda/atomic.cuh"
+#include "oneflow/core/cuda/unique.cuh"
 #include "oneflow/core/kernel/kernel.h"
 #include <assert.h>
 
@@ -91,12 +92,45 @@ __global__ void UnsortedSegmentRowSumGpu(const IDX data_elem_cnt,
   }
 }
 
+// One warp per row of data, which reads its segment id once and adds the contiguous row into the
+// row of its segment.
+template<typename T, typename K, typename IDX, typename U>
+__global__ void UnsortedSegmentRowWarpSumGpu(const IDX num_rows, const IDX num_segment_ids,
+                                             const IDX inner_dim_size, const U* data,
+                                             const K* segment_ids, const IDX num_segments,
+                                             const IDX segment_id_offset, T* out) {
+  const IDX global_warp_id = (blockIdx.x * blockDim.x + threadIdx.x) / kCudaWarpSize;
+  const IDX num_warps = gridDim.x * blockDim.x / kCudaWarpSize;
+  const IDX lane_id = threadIdx.x % kCudaWarpSize;
+  for (IDX row = global_warp_id; row < num_rows; row += num_warps) {
+    const IDX outer_idx = row / num_segment_ids;
+    const IDX segment_id_idx = row - outer_idx * num_segment_ids;
+    const K origin_idx = segment_ids[segment_id_idx];
+    assert(origin_idx >= 0);
+    const IDX idx = origin_idx - segment_id_offset;
+    if (idx < 0 || idx >= num_segments) { continue; }
+    const U* data_row = data + row * inner_dim_size;
+    T* out_row = out + (outer_idx * num_segments + idx) * inner_dim_size;
+    for (IDX i = lane_id; i < inner_dim_size; i += kCudaWarpSize) {
+      const U val = data_row[i];
+      if (val != static_cast<U>(0)) { cuda::atomic::Add(out_row + i, static_cast<T>(val)); }
+    }
+  }
+}
+
 template<typename T, typename K, typename IDX, typename U>
 void UnsortedSegmentSumUtil(DeviceCtx* ctx, const K* segment_ids, const U* data,
                             IDX num_segment_ids, IDX num_segments, IDX outer_dim_size,
                             IDX inner_dim_size, IDX segment_id_offset, T* out) {
   const IDX data_elem_cnt = num_segment_ids * outer_dim_size * inner_dim_size;
-  if (inner_dim_size == 1) {
+  if (inner_dim_size >= kCudaWarpSize) {
+    const IDX num_rows = outer_dim_size * num_segment_ids;
+    UnsortedSegmentRowWarpSumGpu<T, K, IDX, U>
+        <<<BlocksNum4Warps(num_rows), kCudaThreadsNumPerBlock, 0, ctx->cuda_stream()>>>(
+            num_rows, num_segment_ids, inner_dim_size, data, segment_ids, num_segments,
+            segment_id_offset, out);
+
+  } else if (inner_dim_size == 1) {
     NdIndexOffsetHelper<IDX, 2> in_helper(outer_dim_size, num_segment_ids);
     NdIndexOffsetHelper<IDX, 2> out_helper(outer_dim_size, num_segments);
     UnsortedSegmentColSumGpu<T, K, IDX, U>
@@ -122,6 +156,73 @@ void UnsortedSegmentSumUtil(DeviceCtx* ctx, const K* segment_ids, const U* data,
   }
 }
 
+// One thread per (outer, position of the first of a run of equal sorted ids, inner) sums the run
+// in the order of the original positions, the stable sort keeps them ascending within a run.
+template<typename T, typename K, typename IDX, typename U>
+__global__ void SortedSegmentSumGpu(const IDX data_elem_cnt,
+                                    const NdIndexOffsetHelper<IDX, 3> in_helper,
+                                    const NdIndexOffsetHelper<IDX, 3> out_helper, const U* data,
+                                    const K* sorted_segment_ids, const int32_t* sorted_indices,
+                                    const IDX num_segment_ids, const IDX num_segments,
+                                    const IDX segment_id_offset, T* out) {
+  CUDA_1D_KERNEL_LOOP_T(IDX, i, data_elem_cnt) {
+    IDX outer_idx, pos, inner_idx;
+    in_helper.OffsetToNdIndex(i, outer_idx, pos, inner_idx);
+    const K origin_idx = sorted_segment_ids[pos];
+    if (pos > 0 && sorted_segment_ids[pos - 1] == origin_idx) { continue; }
+    assert(origin_idx >= 0);
+    const IDX idx = origin_idx - segment_id_offset;
+    if (idx < 0 || idx >= num_segments) { continue; }
+    T sum = 0;
+    for (IDX j = pos; j < num_segment_ids && sorted_segment_ids[j] == origin_idx; ++j) {
+      const IDX offset = in_helper.NdIndexToOffset(outer_idx, sorted_indices[j], inner_idx);
+      sum += static_cast<T>(data[offset]);
+    }
+    out[out_helper.NdIndexToOffset(outer_idx, idx, inner_idx)] = sum;
+  }
+}
+
+template<typename K>
+size_t GetSortSegmentIdsWorkspaceSize(int64_t num_segment_ids) {
+  size_t sort_ws = 0;
+  OF_CUDA_CHECK((cuda::unique::DoSort<K, int32_t>(num_segment_ids, nullptr, nullptr, nullptr,
+                                                  nullptr, &sort_ws, 0)));
+  return sort_ws;
+}
+
+template<typename K>
+size_t GetDeterministicSegmentSumTmpBufferSize(int64_t num_segment_ids) {
+  return GetCudaAlignedSize(num_segment_ids * sizeof(K))
+         + GetCudaAlignedSize(num_segment_ids * sizeof(int32_t))
+         + GetCudaAlignedSize(GetSortSegmentIdsWorkspaceSize<K>(num_segment_ids));
+}
+
+template<typename T, typename K, typename IDX, typename U>
+void DeterministicUnsortedSegmentSumUtil(DeviceCtx* ctx, const K* segment_ids, const U* data,
+                                         IDX num_segment_ids, IDX num_segments,
+                                         IDX outer_dim_size, IDX inner_dim_size,
+                                         IDX segment_id_offset, T* out, void* tmp_buffer) {
+  CHECK_LE(num_segment_ids, GetMaxVal<int32_t>());
+  const size_t sorted_ids_size = GetCudaAlignedSize(num_segment_ids * sizeof(K));
+  const size_t sorted_indices_size = GetCudaAlignedSize(num_segment_ids * sizeof(int32_t));
+  K* sorted_segment_ids = reinterpret_cast<K*>(tmp_buffer);
+  int32_t* sorted_indices =
+      reinterpret_cast<int32_t*>(reinterpret_cast<char*>(tmp_buffer) + sorted_ids_size);
+  void* sort_workspace =
+      reinterpret_cast<char*>(tmp_buffer) + sorted_ids_size + sorted_indices_size;
+  size_t sort_ws = GetSortSegmentIdsWorkspaceSize<K>(num_segment_ids);
+  OF_CUDA_CHECK((cuda::unique::DoSort<K, int32_t>(num_segment_ids, segment_ids,
+                                                  sorted_segment_ids, sorted_indices,
+                                                  sort_workspace, &sort_ws, ctx->cuda_stream())));
+  const IDX data_elem_cnt = num_segment_ids * outer_dim_size * inner_dim_size;
+  NdIndexOffsetHelper<IDX, 3> in_helper(outer_dim_size, num_segment_ids, inner_dim_size);
+  NdIndexOffsetHelper<IDX, 3> out_helper(outer_dim_size, num_segments, inner_dim_size);
+  SortedSegmentSumGpu<T, K, IDX, U>
+      <<<BlocksNum4ThreadsNum(data_elem_cnt), kCudaThreadsNumPerBlock, 0, ctx->cuda_stream()>>>(
+          data_elem_cnt, in_helper, out_helper, data, sorted_segment_ids, sorted_indices,
+          num_segment_ids, num_segments, segment_id_offset, out);
+}
+
 }  // namespace
 
 template<typename T, typename K, typename U>
@@ -143,6 +244,27 @@ struct UnsortedSegmentSumKernelUtil<DeviceType::kGPU, T, K, U> final {
                                                segment_id_offset, out);
     }
   }
+
+  static size_t GetDeterministicTmpBufferSize(int64_t num_segment_ids) {
+    return GetDeterministicSegmentSumTmpBufferSize<K>(num_segment_ids);
+  }
+
+  static void DeterministicUnsortedSegmentSum(DeviceCtx* ctx, const K* segment_ids, const U* data,
+                                              int64_t num_segment_ids, int64_t num_segments,
+                                              int64_t outer_dim_size, int64_t inner_dim_size,
+                                              int64_t segment_id_offset, T* out, void* tmp_buffer) {
+    const int64_t data_elem_cnt = num_segment_ids * outer_dim_size * inner_dim_size;
+    const int64_t out_elem_cnt = outer_dim_size * num_segments * inner_dim_size;
+    if (std::max(data_elem_cnt, out_elem_cnt) < GetMaxVal<int32_t>() / 2) {
+      DeterministicUnsortedSegmentSumUtil<T, K, int32_t, U>(
+          ctx, segment_ids, data, num_segment_ids, num_segments, outer_dim_size, inner_dim_size,
+          segment_id_offset, out, tmp_buffer);
+    } else {
+      DeterministicUnsortedSegmentSumUtil<T, K, int64_t, U>(
+          ctx, segment_ids, data, num_segment_ids, num_segments, outer_dim_size, inner_dim_size,
+          segment_id_offset, out, tmp_buffer);
+    }
+  }
 };
 
 template<typename K>
@@ -155,6 +277,21 @@ struct UnsortedSegmentSumKernelUtil<DeviceType::kGPU, float, K, float16> final {
         ctx, segment_ids, reinterpret_cast<const half*>(data), num_segment_ids, num_segments,
         outer_dim_size, inner_dim_size, segment_id_offset, out);
   }
+
+  static size_t GetDeterministicTmpBufferSize(int64_t num_segment_ids) {
+    return GetDeterministicSegmentSumTmpBufferSize<K>(num_segment_ids);
+  }
+
+  static void DeterministicUnsortedSegmentSum(DeviceCtx* ctx, const K* segment_ids,
+                                              const float16* data, int64_t num_segment_ids,
+                                              int64_t num_segments, int64_t outer_dim_size,
+                                              int64_t inner_dim_size, int64_t segment_id_offset,
+                                              float* out, void* tmp_buffer) {
+    UnsortedSegmentSumKernelUtil<DeviceType::kGPU, float, K, half>::
+        DeterministicUnsortedSegmentSum(ctx, segment_ids, reinterpret_cast<const half*>(data),
+                                        num_segment_ids, num_segments, outer_dim_size,
+                                        inner_dim_size, segment_id_offset, out, tmp_buffer);
+  }
 };
 
 #define INITIATE_UNSORTED_SEGMENT_SUM_KERNEL_UTIL_GPU(in_type_pair, index_type_pair)             \
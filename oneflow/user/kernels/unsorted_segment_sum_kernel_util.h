@@ -26,6 +26,14 @@ struct UnsortedSegmentSumKernelUtil final {
                                  int64_t num_segment_ids, int64_t num_segments,
                                  int64_t outer_dim_size, int64_t inner_dim_size,
                                  int64_t segment_id_offset, T* out);
+  // Sums the data of each segment in the order of its positions, so that the result does not
+  // depend on how threads are scheduled. The GPU implementation stable sorts the segment ids in
+  // `tmp_buffer' instead of adding with atomics.
+  static size_t GetDeterministicTmpBufferSize(int64_t num_segment_ids);
+  static void DeterministicUnsortedSegmentSum(DeviceCtx* ctx, const K* segment_ids, const U* data,
+                                              int64_t num_segment_ids, int64_t num_segments,
+                                              int64_t outer_dim_size, int64_t inner_dim_size,
+                                              int64_t segment_id_offset, T* out, void* tmp_buffer);
 };
 
 #define UNSORTED_SEGMENT_SUM_DATA_TYPE_SEQ \
@@ -23,27 +23,29 @@ namespace oneflow {
 namespace {
 
 template<typename T>
-static void UpsampleBilinear2DForward(const int64_t elem_cnt, const T* in_dptr,
+static void UpsampleBilinear2DForward(DeviceCtx* ctx, const int64_t elem_cnt, const T* in_dptr,
                                       NdIndexOffsetHelper<int64_t, 4> in_helper,
                                       NdIndexOffsetHelper<int64_t, 4> out_helper,
                                       const int64_t in_height, const int64_t in_width,
                                       const T scale_h, const T scale_w, const bool align_corners,
                                       T* out_dptr) {
-  for (int64_t index = 0; index < elem_cnt; ++index) {
-    int64_t n, c, h, w;
-    out_helper.OffsetToNdIndex(index, n, c, h, w);
-    BilinearParam<T> params;
-    GetBilinearParam(align_corners, h, w, in_height, in_width, scale_h, scale_w, &params);
-    const int64_t top_offset = in_helper.NdIndexToOffset(n, c, params.top_h_index, 0);
-    const int64_t bottom_offset = in_helper.NdIndexToOffset(n, c, params.bottom_h_index, 0);
-    const T top_left = in_dptr[top_offset + params.left_w_index];
-    const T top_right = in_dptr[top_offset + params.right_w_index];
-    const T bottom_left = in_dptr[bottom_offset + params.left_w_index];
-    const T bottom_right = in_dptr[bottom_offset + params.right_w_index];
-    const T top = top_left + (top_right - top_left) * params.w_lerp;
-    const T bottom = bottom_left + (bottom_right - bottom_left) * params.w_lerp;
-    out_dptr[index] = top + (bottom - top) * params.h_lerp;
-  }
+  ctx->ParallelFor(elem_cnt, ParallelForGrainSize(8), [&](int64_t begin, int64_t end) {
+    for (int64_t index = begin; index < end; ++index) {
+      int64_t n, c, h, w;
+      out_helper.OffsetToNdIndex(index, n, c, h, w);
+      BilinearParam<T> params;
+      GetBilinearParam(align_corners, h, w, in_height, in_width, scale_h, scale_w, &params);
+      const int64_t top_offset = in_helper.NdIndexToOffset(n, c, params.top_h_index, 0);
+      const int64_t bottom_offset = in_helper.NdIndexToOffset(n, c, params.bottom_h_index, 0);
+      const T top_left = in_dptr[top_offset + params.left_w_index];
+      const T top_right = in_dptr[top_offset + params.right_w_index];
+      const T bottom_left = in_dptr[bottom_offset + params.left_w_index];
+      const T bottom_right = in_dptr[bottom_offset + params.right_w_index];
+      const T top = top_left + (top_right - top_left) * params.w_lerp;
+      const T bottom = bottom_left + (bottom_right - bottom_left) * params.w_lerp;
+      out_dptr[index] = top + (bottom - top) * params.h_lerp;
+    }
+  });
 }
 
 template<typename T>
@@ -106,9 +108,9 @@ class UpsampleBilinear2DCPUKernel final : public user_op::OpKernel {
     } else {
       const T scale_height = GetAreaPixelScale(in_height, out_height, align_corners, height_scale);
       const T scale_width = GetAreaPixelScale(in_width, out_width, align_corners, width_scale);
-      UpsampleBilinear2DForward<T>(elem_cnt, x_tensor->dptr<T>(), in_helper, out_helper, in_height,
-                                   in_width, scale_height, scale_width, align_corners,
-                                   y_tensor->mut_dptr<T>());
+      UpsampleBilinear2DForward<T>(ctx->device_ctx(), elem_cnt, x_tensor->dptr<T>(), in_helper,
+                                   out_helper, in_height, in_width, scale_height, scale_width,
+                                   align_corners, y_tensor->mut_dptr<T>());
     }
   }
   bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
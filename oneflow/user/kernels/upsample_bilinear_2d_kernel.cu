@@ -16,7 +16,6 @@ limitations under the License.
 #include "oneflow/core/framework/framework.h"
 #include "oneflow/core/kernel/new_kernel_util.h"
 #include "oneflow/core/common/nd_index_offset_helper.h"
-#include "oneflow/core/cuda/atomic.cuh"
 #include "oneflow/user/kernels/upsample_kernel.h"
 
 namespace oneflow {
@@ -47,33 +46,49 @@ __global__ void UpsampleBilinear2DForward(const int64_t elem_cnt, const T* in_dp
   }
 }
 
+// the backward pass is separable: the width pass gathers dy into tmp of shape (n, c, dy_h, dx_w),
+// the height pass gathers tmp into dx, each element is written once so no atomics are needed
 template<typename T>
-__global__ void UpsampleBilinearBackward(const int64_t elem_cnt, const T* dy_dptr,
-                                         NdIndexOffsetHelper<int64_t, 4> dy_helper,
-                                         NdIndexOffsetHelper<int64_t, 4> dx_helper,
-                                         const int64_t dx_height, const int64_t dx_width,
-                                         const T scale_h, const T scale_w, const bool align_corners,
-                                         T* dx_dptr) {
+__global__ void UpsampleBilinearBackwardWidth(const int64_t elem_cnt, const T* dy_dptr,
+                                              NdIndexOffsetHelper<int64_t, 2> tmp_helper,
+                                              const int64_t dy_width, const int64_t dx_width,
+                                              const T scale_w, const bool align_corners,
+                                              T* tmp_dptr) {
   CUDA_1D_KERNEL_LOOP(index, elem_cnt) {
-    int64_t n, c, h, w;
-    dy_helper.OffsetToNdIndex(index, n, c, h, w);
-    BilinearParam<T> params;
-    GetBilinearParam(align_corners, h, w, dx_height, dx_width, scale_h, scale_w, &params);
-    const int64_t top_offset = dx_helper.NdIndexToOffset(n, c, params.top_h_index, 0);
-    const int64_t bottom_offset = dx_helper.NdIndexToOffset(n, c, params.bottom_h_index, 0);
-    const T dy = dy_dptr[index];
-    const T dbottom = params.h_lerp * dy;
-    T* dx_dptr_bottom_offset = dx_dptr + bottom_offset;
-    cuda::atomic::Add(dx_dptr_bottom_offset + params.left_w_index,
-                      static_cast<T>((1 - params.w_lerp) * dbottom));
-    cuda::atomic::Add(dx_dptr_bottom_offset + params.right_w_index,
-                      static_cast<T>(params.w_lerp * dbottom));
-    const T dtop = dy - dbottom;
-    T* dx_dptr_top_offset = dx_dptr + top_offset;
-    cuda::atomic::Add(dx_dptr_top_offset + params.left_w_index,
-                      static_cast<T>((1 - params.w_lerp) * dtop));
-    cuda::atomic::Add(dx_dptr_top_offset + params.right_w_index,
-                      static_cast<T>(params.w_lerp * dtop));
+    int64_t nch, w;
+    tmp_helper.OffsetToNdIndex(index, nch, w);
+    const T* dy_row = dy_dptr + nch * dy_width;
+    int64_t begin;
+    int64_t end;
+    GetLinearOutputRange(w, scale_w, dx_width, dy_width, &begin, &end);
+    T sum = 0;
+    for (int64_t out_w = begin; out_w < end; ++out_w) {
+      const T weight = GetLinearBackwardWeight(align_corners, w, out_w, dx_width, scale_w);
+      if (weight != 0) { sum += weight * dy_row[out_w]; }
+    }
+    tmp_dptr[index] = sum;
+  }
+}
+
+template<typename T>
+__global__ void UpsampleBilinearBackwardHeight(const int64_t elem_cnt, const T* tmp_dptr,
+                                               NdIndexOffsetHelper<int64_t, 3> dx_helper,
+                                               const int64_t dy_height, const int64_t dx_height,
+                                               const int64_t dx_width, const T scale_h,
+                                               const bool align_corners, T* dx_dptr) {
+  CUDA_1D_KERNEL_LOOP(index, elem_cnt) {
+    int64_t nc, h, w;
+    dx_helper.OffsetToNdIndex(index, nc, h, w);
+    const T* tmp_col = tmp_dptr + nc * dy_height * dx_width + w;
+    int64_t begin;
+    int64_t end;
+    GetLinearOutputRange(h, scale_h, dx_height, dy_height, &begin, &end);
+    T sum = 0;
+    for (int64_t out_h = begin; out_h < end; ++out_h) {
+      const T weight = GetLinearBackwardWeight(align_corners, h, out_h, dx_height, scale_h);
+      if (weight != 0) { sum += weight * tmp_col[out_h * dx_width]; }
+    }
+    dx_dptr[index] = sum;
   }
 }
 
@@ -126,17 +141,12 @@ class UpsampleBilinear2DGradGPUKernel final : public user_op::OpKernel {
  private:
   void Compute(user_op::KernelComputeContext* ctx) const override {
     user_op::Tensor* dx_tensor = ctx->Tensor4ArgNameAndIndex("dx", 0);
-    Memset<DeviceType::kGPU>(ctx->device_ctx(), dx_tensor->mut_dptr<T>(), 0,
-                             dx_tensor->shape().elem_cnt() * sizeof(T));
     const user_op::Tensor* dy_tensor = ctx->Tensor4ArgNameAndIndex("dy", 0);
+    user_op::Tensor* tmp_buffer = ctx->Tensor4ArgNameAndIndex("tmp_buffer", 0);
     const float height_scale = ctx->Attr<float>("height_scale");
     const float width_scale = ctx->Attr<float>("width_scale");
     const bool align_corners = ctx->Attr<bool>("align_corners");
-    const int64_t elem_cnt = dy_tensor->shape().elem_cnt();
-    NdIndexOffsetHelper<int64_t, 4> dy_helper(dy_tensor->shape().At(0), dy_tensor->shape().At(1),
-                                              dy_tensor->shape().At(2), dy_tensor->shape().At(3));
-    NdIndexOffsetHelper<int64_t, 4> dx_helper(dx_tensor->shape().At(0), dx_tensor->shape().At(1),
-                                              dx_tensor->shape().At(2), dx_tensor->shape().At(3));
+    const int64_t num_planes = dx_tensor->shape().At(0) * dx_tensor->shape().At(1);
 
     const int64_t in_height = dx_tensor->shape().At(2);
     const int64_t in_width = dx_tensor->shape().At(3);
@@ -149,9 +159,17 @@ class UpsampleBilinear2DGradGPUKernel final : public user_op::OpKernel {
     } else {
       const T scale_height = GetAreaPixelScale(in_height, out_height, align_corners, height_scale);
       const T scale_width = GetAreaPixelScale(in_width, out_width, align_corners, width_scale);
-      RUN_CUDA_KERNEL((UpsampleBilinearBackward<T>), ctx->device_ctx(), elem_cnt, elem_cnt,
-                      dy_tensor->dptr<T>(), dy_helper, dx_helper, in_height, in_width, scale_height,
-                      scale_width, align_corners, dx_tensor->mut_dptr<T>());
+      T* tmp_dptr = tmp_buffer->mut_dptr<T>();
+      NdIndexOffsetHelper<int64_t, 2> tmp_helper(num_planes * out_height, in_width);
+      const int64_t tmp_elem_cnt = num_planes * out_height * in_width;
+      RUN_CUDA_KERNEL((UpsampleBilinearBackwardWidth<T>), ctx->device_ctx(), tmp_elem_cnt,
+                      tmp_elem_cnt, dy_tensor->dptr<T>(), tmp_helper, out_width, in_width,
+                      scale_width, align_corners, tmp_dptr);
+      NdIndexOffsetHelper<int64_t, 3> dx_helper(num_planes, in_height, in_width);
+      const int64_t dx_elem_cnt = dx_tensor->shape().elem_cnt();
+      RUN_CUDA_KERNEL((UpsampleBilinearBackwardHeight<T>), ctx->device_ctx(), dx_elem_cnt,
+                      dx_elem_cnt, tmp_dptr, dx_helper, out_height, in_height, in_width,
+                      scale_height, align_corners, dx_tensor->mut_dptr<T>());
     }
   }
   bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
@@ -165,7 +183,12 @@ class UpsampleBilinear2DGradGPUKernel final : public user_op::OpKernel {
   REGISTER_USER_KERNEL("upsample_bilinear_2d_grad")                                    \
       .SetCreateFn<UpsampleBilinear2DGradGPUKernel<dtype>>()                           \
       .SetIsMatchedHob((user_op::HobDeviceTag() == "gpu")                              \
-                       & (user_op::HobDataType("dx", 0) == GetDataType<dtype>::value));
+                       & (user_op::HobDataType("dx", 0) == GetDataType<dtype>::value)) \
+      .SetInferTmpSizeFn([](user_op::InferContext* ctx) {                              \
+        const Shape& dy_shape = ctx->InputShape("dy", 0);                              \
+        const Shape& x_shape = ctx->InputShape("x", 0);                                \
+        return dy_shape.Count(0, 3) * x_shape.At(3) * sizeof(dtype);                   \
+      });
 
 REGISTER_UPSAMPLE_BILINEAR_2D_GPU_KERNEL(float)
 REGISTER_UPSAMPLE_BILINEAR_2D_GPU_KERNEL(double)
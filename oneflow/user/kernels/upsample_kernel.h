@@ -68,36 +68,87 @@ struct BilinearParam {
   T h_lerp;
 };
 
+template<typename T>
+OF_DEVICE_FUNC void GetLinearParam(const bool align_corners, const int64_t out_idx,
+                                   const int64_t in_size, const T scale, int64_t* in_idx0,
+                                   int64_t* in_idx1, T* lerp) {
+  T src;
+  if (align_corners) {
+    src = scale * static_cast<T>(out_idx);
+  } else {
+    src = (static_cast<T>(out_idx) + 0.5f) * scale - 0.5f;
+    src = src < 0 ? 0 : src;
+  }
+  const int64_t idx = src;
+  *in_idx0 = idx;
+  *in_idx1 = idx + ((idx < in_size - 1) ? 1 : 0);
+  *lerp = src - idx;
+}
+
 template<typename T>
 OF_DEVICE_FUNC void GetBilinearParam(const bool align_corners, const int64_t h, const int64_t w,
                                      const int64_t in_height, const int64_t in_width,
                                      const T scale_h, const T scale_w, BilinearParam<T>* params) {
-  T h1r;
-  if (align_corners) {
-    h1r = scale_h * static_cast<T>(h);
+  GetLinearParam(align_corners, h, in_height, scale_h, &params->top_h_index,
+                 &params->bottom_h_index, &params->h_lerp);
+  GetLinearParam(align_corners, w, in_width, scale_w, &params->left_w_index,
+                 &params->right_w_index, &params->w_lerp);
+}
+
+// The backward kernels gather instead of scattering with atomics: the output indices whose forward
+// pass reads input index in_idx form a contiguous range, which is bounded from the scale and then
+// narrowed with the same index computation as the forward pass.
+OF_DEVICE_FUNC static void ClampOutputRange(const int64_t in_idx, const int64_t in_size,
+                                            const int64_t out_size, int64_t* begin, int64_t* end) {
+  // the forward pass clamps the source index, so the first and the last input index also collect
+  // every output index mapped beyond the borders
+  if (in_idx == 0 || *begin < 0) { *begin = 0; }
+  if (in_idx == in_size - 1 || *end > out_size) { *end = out_size; }
+  if (*begin > *end) { *begin = *end; }
+}
+
+OF_DEVICE_FUNC static void GetNearestOutputRange(const int64_t in_idx, const float scale,
+                                                 const int64_t in_size, const int64_t out_size,
+                                                 int64_t* begin, int64_t* end) {
+  if (scale > 0) {
+    *begin = static_cast<int64_t>(in_idx / scale) - 2;
+    *end = static_cast<int64_t>((in_idx + 1) / scale) + 2;
   } else {
-    h1r = (static_cast<T>(h) + 0.5f) * scale_h - 0.5f;
-    h1r = h1r < 0 ? 0 : h1r;
+    *begin = 0;
+    *end = out_size;
   }
-  const int64_t h1 = h1r;
-  const int64_t h1p = (h1 < in_height - 1) ? 1 : 0;
+  ClampOutputRange(in_idx, in_size, out_size, begin, end);
+  while (*begin < *end && GetNearestInputIndex(*begin, scale, in_size) < in_idx) { ++*begin; }
+  while (*end > *begin && GetNearestInputIndex(*end - 1, scale, in_size) > in_idx) { --*end; }
+}
 
-  T w1r;
-  if (align_corners) {
-    w1r = scale_w * static_cast<T>(w);
+template<typename T>
+OF_DEVICE_FUNC void GetLinearOutputRange(const int64_t in_idx, const T scale,
+                                         const int64_t in_size, const int64_t out_size,
+                                         int64_t* begin, int64_t* end) {
+  // an output index reads in_idx when its first source index is in_idx - 1 or in_idx
+  if (scale > 0) {
+    *begin = static_cast<int64_t>((in_idx - 1) / scale) - 2;
+    *end = static_cast<int64_t>((in_idx + 2) / scale) + 2;
   } else {
-    w1r = (static_cast<T>(w) + 0.5f) * scale_w - 0.5f;
-    w1r = w1r < 0 ? 0 : w1r;
+    *begin = 0;
+    *end = out_size;
   }
-  const int64_t w1 = w1r;
-  const int64_t w1p = (w1 < in_width - 1) ? 1 : 0;
-
-  params->top_h_index = h1;
-  params->bottom_h_index = h1 + h1p;
-  params->h_lerp = h1r - h1;
-  params->left_w_index = w1;
-  params->right_w_index = w1 + w1p;
-  params->w_lerp = w1r - w1;
+  ClampOutputRange(in_idx, in_size, out_size, begin, end);
+}
+
+template<typename T>
+OF_DEVICE_FUNC T GetLinearBackwardWeight(const bool align_corners, const int64_t in_idx,
+                                         const int64_t out_idx, const int64_t in_size,
+                                         const T scale) {
+  int64_t in_idx0;
+  int64_t in_idx1;
+  T lerp;
+  GetLinearParam(align_corners, out_idx, in_size, scale, &in_idx0, &in_idx1, &lerp);
+  T weight = 0;
+  if (in_idx0 == in_idx) { weight += 1 - lerp; }
+  if (in_idx1 == in_idx) { weight += lerp; }
+  return weight;
 }
 
 template<typename T>
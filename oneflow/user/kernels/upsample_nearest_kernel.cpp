@@ -23,17 +23,19 @@ namespace oneflow {
 namespace {
 
 template<typename T>
-static void UpsampleNearest1DForward(const int64_t elem_cnt, const T* in_dptr,
+static void UpsampleNearest1DForward(DeviceCtx* ctx, const int64_t elem_cnt, const T* in_dptr,
                                      NdIndexOffsetHelper<int64_t, 3> in_helper,
                                      NdIndexOffsetHelper<int64_t, 3> out_helper,
                                      const int64_t in_height, const float scale_factor,
                                      T* out_dptr) {
-  for (int64_t index = 0; index < elem_cnt; ++index) {
-    int64_t n, c, h;
-    out_helper.OffsetToNdIndex(index, n, c, h);
-    const int64_t in_h = GetNearestInputIndex(h, scale_factor, in_height);
-    out_dptr[index] = in_dptr[in_helper.NdIndexToOffset(n, c, in_h)];
-  }
+  ctx->ParallelFor(elem_cnt, ParallelForGrainSize(8), [&](int64_t begin, int64_t end) {
+    for (int64_t index = begin; index < end; ++index) {
+      int64_t n, c, h;
+      out_helper.OffsetToNdIndex(index, n, c, h);
+      const int64_t in_h = GetNearestInputIndex(h, scale_factor, in_height);
+      out_dptr[index] = in_dptr[in_helper.NdIndexToOffset(n, c, in_h)];
+    }
+  });
 }
 
 template<typename T>
@@ -51,18 +53,20 @@ static void UpsampleNearest1DBackward(const int64_t elem_cnt, const T* dy_dptr,
 }
 
 template<typename T>
-static void UpsampleNearest2DForward(const int64_t elem_cnt, const T* in_dptr,
+static void UpsampleNearest2DForward(DeviceCtx* ctx, const int64_t elem_cnt, const T* in_dptr,
                                      NdIndexOffsetHelper<int64_t, 4> in_helper,
                                      NdIndexOffsetHelper<int64_t, 4> out_helper,
                                      const int64_t in_height, const int64_t in_width,
                                      const float scale_h, const float scale_w, T* out_dptr) {
-  for (int64_t index = 0; index < elem_cnt; ++index) {
-    int64_t n, c, h, w;
-    out_helper.OffsetToNdIndex(index, n, c, h, w);
-    const int64_t in_h = GetNearestInputIndex(h, scale_h, in_height);
-    const int64_t in_w = GetNearestInputIndex(w, scale_w, in_width);
-    out_dptr[index] = in_dptr[in_helper.NdIndexToOffset(n, c, in_h, in_w)];
-  }
+  ctx->ParallelFor(elem_cnt, ParallelForGrainSize(8), [&](int64_t begin, int64_t end) {
+    for (int64_t index = begin; index < end; ++index) {
+      int64_t n, c, h, w;
+      out_helper.OffsetToNdIndex(index, n, c, h, w);
+      const int64_t in_h = GetNearestInputIndex(h, scale_h, in_height);
+      const int64_t in_w = GetNearestInputIndex(w, scale_w, in_width);
+      out_dptr[index] = in_dptr[in_helper.NdIndexToOffset(n, c, in_h, in_w)];
+    }
+  });
 }
 
 template<typename T>
@@ -81,20 +85,22 @@ static void UpsampleNearest2DBackward(const int64_t elem_cnt, const T* dy_dptr,
 }
 
 template<typename T>
-static void UpsampleNearest3DForward(const int64_t elem_cnt, const T* in_dptr,
+static void UpsampleNearest3DForward(DeviceCtx* ctx, const int64_t elem_cnt, const T* in_dptr,
                                      NdIndexOffsetHelper<int64_t, 5> in_helper,
                                      NdIndexOffsetHelper<int64_t, 5> out_helper,
                                      const int64_t in_depth, const int64_t in_height,
                                      const int64_t in_width, const float scale_d,
                                      const float scale_h, const float scale_w, T* out_dptr) {
-  for (int64_t index = 0; index < elem_cnt; ++index) {
-    int64_t n, c, d, h, w;
-    out_helper.OffsetToNdIndex(index, n, c, d, h, w);
-    const int64_t in_h = GetNearestInputIndex(h, scale_h, in_height);
-    const int64_t in_w = GetNearestInputIndex(w, scale_w, in_width);
-    const int64_t in_d = GetNearestInputIndex(d, scale_d, in_depth);
-    out_dptr[index] = in_dptr[in_helper.NdIndexToOffset(n, c, in_d, in_h, in_w)];
-  }
+  ctx->ParallelFor(elem_cnt, ParallelForGrainSize(8), [&](int64_t begin, int64_t end) {
+    for (int64_t index = begin; index < end; ++index) {
+      int64_t n, c, d, h, w;
+      out_helper.OffsetToNdIndex(index, n, c, d, h, w);
+      const int64_t in_h = GetNearestInputIndex(h, scale_h, in_height);
+      const int64_t in_w = GetNearestInputIndex(w, scale_w, in_width);
+      const int64_t in_d = GetNearestInputIndex(d, scale_d, in_depth);
+      out_dptr[index] = in_dptr[in_helper.NdIndexToOffset(n, c, in_d, in_h, in_w)];
+    }
+  });
 }
 
 template<typename T>
@@ -142,8 +148,8 @@ class UpsampleNearest1DCPUKernel final : public user_op::OpKernel {
                                                 x_tensor->shape().At(2));
       NdIndexOffsetHelper<int64_t, 3> out_helper(y_tensor->shape().At(0), y_tensor->shape().At(1),
                                                  y_tensor->shape().At(2));
-      UpsampleNearest1DForward<T>(elem_cnt, x_tensor->dptr<T>(), in_helper, out_helper,
-                                  x_tensor->shape().At(2), 1.f / height_scale,
+      UpsampleNearest1DForward<T>(ctx->device_ctx(), elem_cnt, x_tensor->dptr<T>(), in_helper,
+                                  out_helper, x_tensor->shape().At(2), 1.f / height_scale,
                                   y_tensor->mut_dptr<T>());
     }
   }
@@ -230,8 +236,8 @@ class UpsampleNearest2DCPUKernel final : public user_op::OpKernel {
                                                 x_tensor->shape().At(2), x_tensor->shape().At(3));
       NdIndexOffsetHelper<int64_t, 4> out_helper(y_tensor->shape().At(0), y_tensor->shape().At(1),
                                                  y_tensor->shape().At(2), y_tensor->shape().At(3));
-      UpsampleNearest2DForward<T>(elem_cnt, x_tensor->dptr<T>(), in_helper, out_helper,
-                                  x_tensor->shape().At(2), x_tensor->shape().At(3),
+      UpsampleNearest2DForward<T>(ctx->device_ctx(), elem_cnt, x_tensor->dptr<T>(), in_helper,
+                                  out_helper, x_tensor->shape().At(2), x_tensor->shape().At(3),
                                   1.f / height_scale, 1.f / width_scale, y_tensor->mut_dptr<T>());
     }
   }
@@ -313,10 +319,10 @@ class UpsampleNearest3DCPUKernel final : public user_op::OpKernel {
     NdIndexOffsetHelper<int64_t, 5> out_helper(y_blob->shape().At(0), y_blob->shape().At(1),
                                                y_blob->shape().At(2), y_blob->shape().At(3),
                                                y_blob->shape().At(4));
-    UpsampleNearest3DForward<T>(elem_cnt, x_blob->dptr<T>(), in_helper, out_helper,
-                                x_blob->shape().At(2), x_blob->shape().At(3), x_blob->shape().At(4),
-                                1.f / depth_scale, 1.f / height_scale, 1.f / width_scale,
-                                y_blob->mut_dptr<T>());
+    UpsampleNearest3DForward<T>(ctx->device_ctx(), elem_cnt, x_blob->dptr<T>(), in_helper,
+                                out_helper, x_blob->shape().At(2), x_blob->shape().At(3),
+                                x_blob->shape().At(4), 1.f / depth_scale, 1.f / height_scale,
+                                1.f / width_scale, y_blob->mut_dptr<T>());
   }
   bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
 };
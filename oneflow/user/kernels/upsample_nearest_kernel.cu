@@ -51,33 +51,57 @@ __global__ void UpsampleNearest1DBackward(const int64_t elem_cnt, const T* dy_dp
   }
 }
 
-template<typename T>
-__global__ void UpsampleNearest2DForward(const int64_t elem_cnt, const T* in_dptr,
-                                         NdIndexOffsetHelper<int64_t, 4> in_helper,
-                                         NdIndexOffsetHelper<int64_t, 4> out_helper,
-                                         const int64_t in_height, const int64_t in_width,
+template<typename T, typename IDX>
+__global__ void UpsampleNearest2DForward(const IDX elem_cnt, const T* in_dptr,
+                                         NdIndexOffsetHelper<IDX, 4> in_helper,
+                                         NdIndexOffsetHelper<IDX, 4> out_helper,
+                                         const IDX in_height, const IDX in_width,
                                          const float scale_h, const float scale_w, T* out_dptr) {
-  CUDA_1D_KERNEL_LOOP(index, elem_cnt) {
-    int64_t n, c, h, w;
+  CUDA_1D_KERNEL_LOOP_T(IDX, index, elem_cnt) {
+    IDX n, c, h, w;
     out_helper.OffsetToNdIndex(index, n, c, h, w);
-    const int64_t in_h = GetNearestInputIndex(h, scale_h, in_height);
-    const int64_t in_w = GetNearestInputIndex(w, scale_w, in_width);
+    const IDX in_h = GetNearestInputIndex(h, scale_h, in_height);
+    const IDX in_w = GetNearestInputIndex(w, scale_w, in_width);
     out_dptr[index] = in_dptr[in_helper.NdIndexToOffset(n, c, in_h, in_w)];
   }
 }
 
+template<typename T, typename IDX>
+void LaunchUpsampleNearest2DForward(DeviceCtx* ctx, const user_op::Tensor* x_tensor,
+                                    const float height_scale, const float width_scale,
+                                    user_op::Tensor* y_tensor) {
+  const ShapeView& x_shape = x_tensor->shape();
+  const ShapeView& y_shape = y_tensor->shape();
+  const IDX elem_cnt = y_shape.elem_cnt();
+  NdIndexOffsetHelper<IDX, 4> in_helper(x_shape.At(0), x_shape.At(1), x_shape.At(2),
+                                        x_shape.At(3));
+  NdIndexOffsetHelper<IDX, 4> out_helper(y_shape.At(0), y_shape.At(1), y_shape.At(2),
+                                         y_shape.At(3));
+  RUN_CUDA_KERNEL((UpsampleNearest2DForward<T, IDX>), ctx, elem_cnt, elem_cnt, x_tensor->dptr<T>(),
+                  in_helper, out_helper, static_cast<IDX>(x_shape.At(2)),
+                  static_cast<IDX>(x_shape.At(3)), 1.f / height_scale, 1.f / width_scale,
+                  y_tensor->mut_dptr<T>());
+}
+
 template<typename T>
 __global__ void UpsampleNearest2DBackward(const int64_t elem_cnt, const T* dy_dptr,
-                                          NdIndexOffsetHelper<int64_t, 4> dy_helper,
-                                          NdIndexOffsetHelper<int64_t, 4> dx_helper,
+                                          NdIndexOffsetHelper<int64_t, 3> dx_helper,
+                                          const int64_t dy_height, const int64_t dy_width,
                                           const int64_t dx_height, const int64_t dx_width,
                                           const float scale_h, const float scale_w, T* dx_dptr) {
   CUDA_1D_KERNEL_LOOP(index, elem_cnt) {
-    int64_t n, c, h, w;
-    dy_helper.OffsetToNdIndex(index, n, c, h, w);
-    const int64_t dx_h = GetNearestInputIndex(h, scale_h, dx_height);
-    const int64_t dx_w = GetNearestInputIndex(w, scale_w, dx_width);
-    cuda::atomic::Add(dx_dptr + dx_helper.NdIndexToOffset(n, c, dx_h, dx_w), dy_dptr[index]);
+    int64_t nc, h, w;
+    dx_helper.OffsetToNdIndex(index, nc, h, w);
+    int64_t h_begin, h_end, w_begin, w_end;
+    GetNearestOutputRange(h, scale_h, dx_height, dy_height, &h_begin, &h_end);
+    GetNearestOutputRange(w, scale_w, dx_width, dy_width, &w_begin, &w_end);
+    const T* dy_plane = dy_dptr + nc * dy_height * dy_width;
+    T sum = 0;
+    for (int64_t dy_h = h_begin; dy_h < h_end; ++dy_h) {
+      const T* dy_row = dy_plane + dy_h * dy_width;
+      for (int64_t dy_w = w_begin; dy_w < w_end; ++dy_w) { sum += dy_row[dy_w]; }
+    }
+    dx_dptr[index] = sum;
   }
 }
 
@@ -219,14 +243,13 @@ class UpsampleNearest2DGPUKernel final : public user_op::OpKernel {
           ctx->device_ctx(), y_tensor->mut_dptr<void>(), x_tensor->dptr<void>(),
           x_tensor->shape().elem_cnt() * GetSizeOfDataType(x_tensor->data_type()));
     } else {
-      NdIndexOffsetHelper<int64_t, 4> in_helper(x_tensor->shape().At(0), x_tensor->shape().At(1),
-                                                x_tensor->shape().At(2), x_tensor->shape().At(3));
-      NdIndexOffsetHelper<int64_t, 4> out_helper(y_tensor->shape().At(0), y_tensor->shape().At(1),
-                                                 y_tensor->shape().At(2), y_tensor->shape().At(3));
-      RUN_CUDA_KERNEL((UpsampleNearest2DForward<T>), ctx->device_ctx(), elem_cnt, elem_cnt,
-                      x_tensor->dptr<T>(), in_helper, out_helper, x_tensor->shape().At(2),
-                      x_tensor->shape().At(3), 1.f / height_scale, 1.f / width_scale,
-                      y_tensor->mut_dptr<T>());
+      if (std::max(elem_cnt, x_tensor->shape().elem_cnt()) < GetMaxVal<int32_t>() / 2) {
+        LaunchUpsampleNearest2DForward<T, int32_t>(ctx->device_ctx(), x_tensor, height_scale,
+                                                   width_scale, y_tensor);
+      } else {
+        LaunchUpsampleNearest2DForward<T, int64_t>(ctx->device_ctx(), x_tensor, height_scale,
+                                                   width_scale, y_tensor);
+      }
     }
   }
   bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
@@ -241,13 +264,10 @@ class UpsampleNearest2DGradGPUKernel final : public user_op::OpKernel {
  private:
   void Compute(user_op::KernelComputeContext* ctx) const override {
     user_op::Tensor* dx_tensor = ctx->Tensor4ArgNameAndIndex("dx", 0);
-
-    Memset<DeviceType::kGPU>(ctx->device_ctx(), dx_tensor->mut_dptr<T>(), 0,
-                             dx_tensor->shape().elem_cnt() * sizeof(T));
     const user_op::Tensor* dy_tensor = ctx->Tensor4ArgNameAndIndex("dy", 0);
     const float height_scale = ctx->Attr<float>("height_scale");
     const float width_scale = ctx->Attr<float>("width_scale");
-    const int64_t elem_cnt = dy_tensor->shape().elem_cnt();
+    const int64_t elem_cnt = dx_tensor->shape().elem_cnt();
     const int64_t in_height = dx_tensor->shape().At(2);
     const int64_t in_width = dx_tensor->shape().At(3);
     const int64_t out_height = dy_tensor->shape().At(2);
@@ -257,14 +277,11 @@ class UpsampleNearest2DGradGPUKernel final : public user_op::OpKernel {
           ctx->device_ctx(), dx_tensor->mut_dptr<void>(), dy_tensor->dptr<void>(),
           dy_tensor->shape().elem_cnt() * GetSizeOfDataType(dy_tensor->data_type()));
     } else {
-      NdIndexOffsetHelper<int64_t, 4> dy_helper(dy_tensor->shape().At(0), dy_tensor->shape().At(1),
-                                                dy_tensor->shape().At(2), dy_tensor->shape().At(3));
-      NdIndexOffsetHelper<int64_t, 4> dx_helper(dx_tensor->shape().At(0), dx_tensor->shape().At(1),
-                                                dx_tensor->shape().At(2), dx_tensor->shape().At(3));
+      NdIndexOffsetHelper<int64_t, 3> dx_helper(dx_tensor->shape().Count(0, 2), in_height,
+                                                in_width);
       RUN_CUDA_KERNEL((UpsampleNearest2DBackward<T>), ctx->device_ctx(), elem_cnt, elem_cnt,
-                      dy_tensor->dptr<T>(), dy_helper, dx_helper, dx_tensor->shape().At(2),
-                      dx_tensor->shape().At(3), 1.f / height_scale, 1.f / width_scale,
-                      dx_tensor->mut_dptr<T>());
+                      dy_tensor->dptr<T>(), dx_helper, out_height, out_width, in_height,
+                      in_width, 1.f / height_scale, 1.f / width_scale, dx_tensor->mut_dptr<T>());
     }
   }
   bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
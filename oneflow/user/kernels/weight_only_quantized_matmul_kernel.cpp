@@ -0,0 +1,84 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/framework/framework.h"
+
+namespace oneflow {
+
+namespace {
+
+template<typename T>
+class CpuWeightOnlyQuantizedMatmulKernel final : public user_op::OpKernel {
+ public:
+  CpuWeightOnlyQuantizedMatmulKernel() = default;
+  ~CpuWeightOnlyQuantizedMatmulKernel() = default;
+
+ private:
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    const user_op::Tensor* x = ctx->Tensor4ArgNameAndIndex("x", 0);
+    const user_op::Tensor* weight = ctx->Tensor4ArgNameAndIndex("weight", 0);
+    const user_op::Tensor* scale = ctx->Tensor4ArgNameAndIndex("scale", 0);
+    const user_op::Tensor* bias = ctx->Tensor4ArgNameAndIndex("bias", 0);
+    user_op::Tensor* out = ctx->Tensor4ArgNameAndIndex("out", 0);
+    const int32_t bits = ctx->Attr<int32_t>("bits");
+    const int64_t group_size = ctx->Attr<int64_t>("group_size");
+    const int64_t k = x->shape().At(x->shape().NumAxes() - 1);
+    const int64_t m = x->shape().elem_cnt() / k;
+    const int64_t n = weight->shape().At(0);
+    const int64_t weight_row_size = weight->shape().At(1);
+    const int64_t num_groups = k / group_size;
+    const T* x_ptr = x->dptr<T>();
+    const int8_t* weight_ptr = weight->dptr<int8_t>();
+    const float* scale_ptr = scale->dptr<float>();
+    const T* bias_ptr = bias == nullptr ? nullptr : bias->dptr<T>();
+    T* out_ptr = out->mut_dptr<T>();
+    std::vector<T> dequantized_row(k);
+    FOR_RANGE(int64_t, j, 0, n) {
+      const int8_t* weight_row = weight_ptr + j * weight_row_size;
+      FOR_RANGE(int64_t, l, 0, k) {
+        int8_t q = 0;
+        if (bits == 8) {
+          q = weight_row[l];
+        } else {
+          const int8_t packed = weight_row[l / 2];
+          // Shifts of the signed byte sign extend the nibble.
+          q = (l % 2 == 0) ? static_cast<int8_t>(packed << 4) >> 4 : packed >> 4;
+        }
+        dequantized_row[l] = static_cast<T>(q) * scale_ptr[j * num_groups + l / group_size];
+      }
+      FOR_RANGE(int64_t, i, 0, m) {
+        const T* x_row = x_ptr + i * k;
+        T sum = bias_ptr == nullptr ? 0 : bias_ptr[j];
+        FOR_RANGE(int64_t, l, 0, k) { sum += x_row[l] * dequantized_row[l]; }
+        out_ptr[i * n + j] = sum;
+      }
+    }
+  }
+
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+};
+
+}  // namespace
+
+#define REGISTER_WEIGHT_ONLY_QUANTIZED_MATMUL_CPU_KERNEL(dtype)     \
+  REGISTER_USER_KERNEL("weight_only_quantized_matmul")              \
+      .SetCreateFn<CpuWeightOnlyQuantizedMatmulKernel<dtype>>()     \
+      .SetIsMatchedHob((user_op::HobDeviceTag() == DeviceType::kCPU) \
+                       & (user_op::HobDataType("x", 0) == GetDataType<dtype>::value));
+
+REGISTER_WEIGHT_ONLY_QUANTIZED_MATMUL_CPU_KERNEL(float)
+REGISTER_WEIGHT_ONLY_QUANTIZED_MATMUL_CPU_KERNEL(double)
+
+}  // namespace oneflow
@@ -0,0 +1,193 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/device/cuda_util.h"
+#include "oneflow/core/framework/framework.h"
+#include "oneflow/core/kernel/new_kernel_util.h"
+
+namespace oneflow {
+
+namespace {
+
+// Up to kMaxGemvRows rows of x, as in decoding, the weight is dequantized in registers by a GEMV
+// kernel reading it once per kGemvRowsPerTile rows. More rows dequantize it into tmp_buffer for
+// cublas, where the bandwidth of the weight is no longer the bound.
+constexpr int64_t kMaxGemvRows = 16;
+constexpr int kGemvRowsPerTile = 8;
+constexpr int kGemvWarpsPerBlock = 4;
+
+// Element e of a 4 byte pack of 32 / bits elements is in its bits [e * bits, (e + 1) * bits), the
+// shifts of the signed int sign extend it.
+template<int bits>
+__device__ __forceinline__ float UnpackElem(uint32_t pack, int e) {
+  return static_cast<float>(static_cast<int32_t>(pack << (32 - bits * (e + 1))) >> (32 - bits));
+}
+
+// One warp per column j of out, its lanes read consecutive 4 byte packs of row j of the weight.
+template<typename T, int bits>
+__global__ void WeightOnlyQuantizedGemv(const int64_t m, const int64_t n, const int64_t k,
+                                        const int64_t group_size, const T* x,
+                                        const uint32_t* weight, const float* scale, const T* bias,
+                                        T* out) {
+  constexpr int kElemsPerPack = 32 / bits;
+  const int lane = threadIdx.x % kCudaWarpSize;
+  const int64_t j = blockIdx.x * kGemvWarpsPerBlock + threadIdx.x / kCudaWarpSize;
+  if (j >= n) { return; }
+  const int64_t row_begin = blockIdx.y * kGemvRowsPerTile;
+  const int64_t rows = min(static_cast<int64_t>(kGemvRowsPerTile), m - row_begin);
+  const int64_t num_packs = k / kElemsPerPack;
+  const uint32_t* weight_row = weight + j * num_packs;
+  const float* scale_row = scale + j * (k / group_size);
+  const T* x_tile = x + row_begin * k;
+  float acc[kGemvRowsPerTile];
+#pragma unroll
+  for (int r = 0; r < kGemvRowsPerTile; ++r) { acc[r] = 0; }
+  for (int64_t p = lane; p < num_packs; p += kCudaWarpSize) {
+    const uint32_t pack = weight_row[p];
+    const int64_t l = p * kElemsPerPack;
+    const float s = scale_row[l / group_size];
+    float w[kElemsPerPack];
+#pragma unroll
+    for (int e = 0; e < kElemsPerPack; ++e) { w[e] = UnpackElem<bits>(pack, e) * s; }
+#pragma unroll
+    for (int r = 0; r < kGemvRowsPerTile; ++r) {
+      if (r < rows) {
+        const T* x_ptr = x_tile + r * k + l;
+#pragma unroll
+        for (int e = 0; e < kElemsPerPack; ++e) { acc[r] += static_cast<float>(x_ptr[e]) * w[e]; }
+      }
+    }
+  }
+#pragma unroll
+  for (int r = 0; r < kGemvRowsPerTile; ++r) {
+    for (int mask = kCudaWarpSize / 2; mask > 0; mask /= 2) {
+      acc[r] += __shfl_xor_sync(0xffffffff, acc[r], mask);
+    }
+  }
+  if (lane == 0) {
+    const float b = bias == nullptr ? 0.0f : static_cast<float>(bias[j]);
+    for (int r = 0; r < rows; ++r) { out[(row_begin + r) * n + j] = static_cast<T>(acc[r] + b); }
+  }
+}
+
+template<typename T, int bits>
+__global__ void DequantizeWeight(const int64_t elem_cnt, const int64_t k, const int64_t group_size,
+                                 const uint32_t* weight, const float* scale, T* out) {
+  constexpr int kElemsPerPack = 32 / bits;
+  CUDA_1D_KERNEL_LOOP_T(int64_t, i, elem_cnt) {
+    const int64_t j = i / k;
+    const int64_t l = i - j * k;
+    out[i] = static_cast<T>(UnpackElem<bits>(weight[i / kElemsPerPack], i % kElemsPerPack)
+                            * scale[j * (k / group_size) + l / group_size]);
+  }
+}
+
+template<typename T>
+__global__ void BroadcastBias(const int64_t elem_cnt, const int64_t n, const T* bias, T* out) {
+  CUDA_1D_KERNEL_LOOP_T(int64_t, i, elem_cnt) { out[i] = bias[i % n]; }
+}
+
+void Gemm(DeviceCtx* ctx, int m, int n, int k, double beta, const float* x, const float* weight,
+          float* out) {
+  NewKernelUtil<DeviceType::kGPU>::OFGemm(ctx, CblasNoTrans, CblasTrans, m, n, k, 1.0, x, weight,
+                                          beta, out);
+}
+
+void Gemm(DeviceCtx* ctx, int m, int n, int k, double beta, const half* x, const half* weight,
+          half* out) {
+  NewKernelUtil<DeviceType::kGPU>::OFGemm(ctx, CblasNoTrans, CblasTrans, m, n, k, 1.0,
+                                          reinterpret_cast<const float16*>(x),
+                                          reinterpret_cast<const float16*>(weight), beta,
+                                          reinterpret_cast<float16*>(out));
+}
+
+template<typename T, int bits>
+void LaunchWeightOnlyQuantizedMatmul(DeviceCtx* ctx, int64_t m, int64_t n, int64_t k,
+                                     int64_t group_size, const T* x, const int8_t* weight,
+                                     const float* scale, const T* bias, T* out, T* tmp) {
+  const uint32_t* weight_packs = reinterpret_cast<const uint32_t*>(weight);
+  if (m <= kMaxGemvRows) {
+    const dim3 grid((n + kGemvWarpsPerBlock - 1) / kGemvWarpsPerBlock,
+                    (m + kGemvRowsPerTile - 1) / kGemvRowsPerTile);
+    WeightOnlyQuantizedGemv<T, bits>
+        <<<grid, kGemvWarpsPerBlock * kCudaWarpSize, 0, ctx->cuda_stream()>>>(
+            m, n, k, group_size, x, weight_packs, scale, bias, out);
+    return;
+  }
+  CHECK_NOTNULL(tmp);
+  RUN_CUDA_KERNEL((DequantizeWeight<T, bits>), ctx, n * k, n * k, k, group_size, weight_packs,
+                  scale, tmp);
+  if (bias != nullptr) { RUN_CUDA_KERNEL((BroadcastBias<T>), ctx, m * n, m * n, n, bias, out); }
+  Gemm(ctx, m, n, k, bias == nullptr ? 0.0 : 1.0, x, tmp, out);
+}
+
+template<typename T>
+class GpuWeightOnlyQuantizedMatmulKernel final : public user_op::OpKernel {
+ public:
+  GpuWeightOnlyQuantizedMatmulKernel() = default;
+  ~GpuWeightOnlyQuantizedMatmulKernel() = default;
+
+ private:
+  void Compute(user_op::KernelComputeContext* ctx) const override {
+    const user_op::Tensor* x = ctx->Tensor4ArgNameAndIndex("x", 0);
+    const user_op::Tensor* weight = ctx->Tensor4ArgNameAndIndex("weight", 0);
+    const user_op::Tensor* scale = ctx->Tensor4ArgNameAndIndex("scale", 0);
+    const user_op::Tensor* bias = ctx->Tensor4ArgNameAndIndex("bias", 0);
+    user_op::Tensor* out = ctx->Tensor4ArgNameAndIndex("out", 0);
+    user_op::Tensor* tmp_buffer = ctx->Tensor4ArgNameAndIndex("tmp_buffer", 0);
+    const int64_t elem_cnt = out->shape().elem_cnt();
+    if (elem_cnt == 0) { return; }
+    const int64_t k = x->shape().At(x->shape().NumAxes() - 1);
+    const int64_t m = x->shape().elem_cnt() / k;
+    const int64_t n = weight->shape().At(0);
+    const int64_t group_size = ctx->Attr<int64_t>("group_size");
+    const T* bias_ptr = bias == nullptr ? nullptr : bias->dptr<T>();
+    T* tmp_ptr = tmp_buffer == nullptr ? nullptr : tmp_buffer->mut_dptr<T>();
+    if (ctx->Attr<int32_t>("bits") == 8) {
+      LaunchWeightOnlyQuantizedMatmul<T, 8>(ctx->device_ctx(), m, n, k, group_size, x->dptr<T>(),
+                                            weight->dptr<int8_t>(), scale->dptr<float>(),
+                                            bias_ptr, out->mut_dptr<T>(), tmp_ptr);
+    } else {
+      LaunchWeightOnlyQuantizedMatmul<T, 4>(ctx->device_ctx(), m, n, k, group_size, x->dptr<T>(),
+                                            weight->dptr<int8_t>(), scale->dptr<float>(),
+                                            bias_ptr, out->mut_dptr<T>(), tmp_ptr);
+    }
+  }
+
+  bool AlwaysComputeWhenAllOutputsEmpty() const override { return false; }
+};
+
+// The dequantized weight is only needed by more rows than the GEMV kernel takes.
+template<typename T>
+size_t InferTmpSize(user_op::InferContext* ctx) {
+  const Shape& x_shape = ctx->InputShape("x", 0);
+  const int64_t k = x_shape.At(x_shape.NumAxes() - 1);
+  if (x_shape.elem_cnt() / k <= kMaxGemvRows) { return 0; }
+  return GetCudaAlignedSize(ctx->InputShape("weight", 0).At(0) * k * sizeof(T));
+}
+
+}  // namespace
+
+#define REGISTER_WEIGHT_ONLY_QUANTIZED_MATMUL_GPU_KERNEL(dtype)                     \
+  REGISTER_USER_KERNEL("weight_only_quantized_matmul")                              \
+      .SetCreateFn<GpuWeightOnlyQuantizedMatmulKernel<dtype>>()                     \
+      .SetIsMatchedHob((user_op::HobDeviceTag() == DeviceType::kGPU)                \
+                       & (user_op::HobDataType("x", 0) == GetDataType<dtype>::value)) \
+      .SetInferTmpSizeFn(InferTmpSize<dtype>);
+
+REGISTER_WEIGHT_ONLY_QUANTIZED_MATMUL_GPU_KERNEL(float)
+REGISTER_WEIGHT_ONLY_QUANTIZED_MATMUL_GPU_KERNEL(half)
+
+}  // namespace oneflow
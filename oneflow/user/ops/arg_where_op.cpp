@@ -36,6 +36,9 @@ REGISTER_NO_GRAD_USER_OP("argwhere")
     .Output("output")
     .Output("output_size")
     .Attr<DataType>("dtype", DataType::kInt32)
+    // rows of output past output_size are set to 0, so output can be consumed at its full
+    // capacity together with output_size, without syncing output_size to the host
+    .Attr<bool>("pad_tail", false)
     .SetTensorDescInferFn(InferTensorDesc)
     .SetDataTypeInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
       const DataType dtype = ctx->Attr<DataType>("dtype");
@@ -45,6 +45,16 @@ Maybe<void> GetSbpSignatures(user_op::SbpContext* ctx) {
       ctx->NewBuilder().Split(ctx->inputs(), axis).Build();
     }
   }
+  // every rank assigns its own part of a partial sum ref, e.g. a per-rank residual
+  if (ctx->user_op_conf().has_input("condition", 0)) {
+    ctx->NewBuilder()
+        .PartialSum(user_op::OpArg("ref", 0))
+        .PartialSum(user_op::OpArg("value", 0))
+        .Broadcast(user_op::OpArg("condition", 0))
+        .Build();
+  } else {
+    ctx->NewBuilder().PartialSum(ctx->inputs()).Build();
+  }
   return Maybe<void>::Ok();
 }
 
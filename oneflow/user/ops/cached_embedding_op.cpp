@@ -0,0 +1,77 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/framework/framework.h"
+
+namespace oneflow {
+
+// out = table[ids] of the embedding table `embedding_name`, whose rows are not a variable but
+// live in a device cache, a host cache and a file under `path`. slots are the rows of the device
+// cache the ids are read from, cached_embedding_update applies the grad of out to them.
+REGISTER_NO_GRAD_USER_OP("cached_embedding_lookup")
+    .Input("ids")
+    .Output("out")
+    .Output("slots")
+    .Attr<std::string>("embedding_name")
+    .Attr<std::string>("path")
+    .Attr<int64_t>("embedding_size")
+    .Attr<int64_t>("device_cache_capacity")
+    .Attr<int64_t>("host_cache_capacity")
+    .Attr<float>("initializer_scale", 0.05)
+    .Attr<int64_t>("seed", 0)
+    .SetTensorDescInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      const Shape& ids_shape = ctx->InputShape("ids", 0);
+      const int64_t embedding_size = ctx->Attr<int64_t>("embedding_size");
+      CHECK_GT_OR_RETURN(embedding_size, 0);
+      CHECK_GT_OR_RETURN(ctx->Attr<int64_t>("device_cache_capacity"), 0);
+      CHECK_GT_OR_RETURN(ctx->Attr<int64_t>("host_cache_capacity"), 0);
+      CHECK_OR_RETURN(!ctx->Attr<std::string>("path").empty());
+      DimVector out_dim_vec = ids_shape.dim_vec();
+      out_dim_vec.push_back(embedding_size);
+      *ctx->OutputShape("out", 0) = Shape(out_dim_vec);
+      *ctx->OutputShape("slots", 0) = ids_shape;
+      return Maybe<void>::Ok();
+    })
+    .SetDataTypeInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      CHECK_OR_RETURN(IsIndexDataType(ctx->InputDType("ids", 0)));
+      *ctx->OutputDType("out", 0) = DataType::kFloat;
+      *ctx->OutputDType("slots", 0) = DataType::kInt32;
+      return Maybe<void>::Ok();
+    })
+    .SetGetSbpFn(user_op::GetSbpFnUtil::DefaultBroadcastToBroadcast);
+
+// table[slots] -= learning_rate * embedding_diff on the device cache of `embedding_name`, it has
+// to run before the next lookup of the embedding may evict the slots.
+REGISTER_NO_GRAD_USER_OP("cached_embedding_update")
+    .Input("slots")
+    .Input("embedding_diff")
+    .Attr<std::string>("embedding_name")
+    .Attr<float>("learning_rate")
+    .SetTensorDescInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      const Shape& slots_shape = ctx->InputShape("slots", 0);
+      const Shape& embedding_diff_shape = ctx->InputShape("embedding_diff", 0);
+      CHECK_EQ_OR_RETURN(embedding_diff_shape.NumAxes(), slots_shape.NumAxes() + 1);
+      CHECK_EQ_OR_RETURN(embedding_diff_shape.Count(0, slots_shape.NumAxes()),
+                         slots_shape.elem_cnt());
+      return Maybe<void>::Ok();
+    })
+    .SetDataTypeInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      CHECK_EQ_OR_RETURN(ctx->InputDType("slots", 0), DataType::kInt32);
+      CHECK_EQ_OR_RETURN(ctx->InputDType("embedding_diff", 0), DataType::kFloat);
+      return Maybe<void>::Ok();
+    })
+    .SetGetSbpFn(user_op::GetSbpFnUtil::DefaultBroadcastToBroadcast);
+
+}  // namespace oneflow
@@ -159,7 +159,9 @@ Maybe<void> CheckAttr(const user_op::UserOpDefWrapper& def,
   }
 }
 
-Maybe<void> GenerateBackwardOpConf4Conv(const user_op::UserOpWrapper& op, user_op::AddOpFn AddOp) {
+// dy is the grad of the output of the conv, which may be followed by other ops in a fused op
+Maybe<void> GenerateBackwardOpConf4ConvWithDy(const user_op::UserOpWrapper& op,
+                                              const std::string& dy, user_op::AddOpFn AddOp) {
   const auto& padding_before = op.attr<std::vector<int32_t>>("padding_before");
   std::string data_format = op.attr<std::string>("data_format");
   std::vector<int32_t> kernel_size = op.attr<std::vector<int32_t>>("kernel_size");
@@ -176,7 +178,7 @@ Maybe<void> GenerateBackwardOpConf4Conv(const user_op::UserOpWrapper& op, user_o
       auto bias_grad_op =
           user_op::UserOpConfWrapperBuilder("System-AutoGrad-" + op.op_name() + "-BiasGrad")
               .Op("conv_bias_grad")
-              .Input("dy", op.GetGradTensorWithOpOutput("out", 0))
+              .Input("dy", dy)
               .Output("bias_diff")
               .Attr<std::string>("data_format", data_format)
               .Attr<int32_t>("num_spatial_dims", ndims)
@@ -190,7 +192,7 @@ Maybe<void> GenerateBackwardOpConf4Conv(const user_op::UserOpWrapper& op, user_o
     auto filter_grad_op =
         user_op::UserOpConfWrapperBuilder("System-AutoGrad-" + op.op_name() + "-FilterGrad")
             .Op("conv_filter_grad")
-            .Input("dy", op.GetGradTensorWithOpOutput("out", 0))
+            .Input("dy", dy)
             .Input("x", op.input("in", 0))
             .Output("filter_diff")
             .Attr<int32_t>("num_spatial_dims", ndims)
@@ -209,7 +211,7 @@ Maybe<void> GenerateBackwardOpConf4Conv(const user_op::UserOpWrapper& op, user_o
     auto data_grad_op =
         user_op::UserOpConfWrapperBuilder("System-AutoGrad-" + op.op_name() + "-DataGrad")
             .Op("conv_data_grad")
-            .Input("dy", op.GetGradTensorWithOpOutput("out", 0))
+            .Input("dy", dy)
             .Input("filter", op.input("weight", 0))
             .Input("x_like", op.input("in", 0))
             .Output("dx")
@@ -227,6 +229,10 @@ Maybe<void> GenerateBackwardOpConf4Conv(const user_op::UserOpWrapper& op, user_o
   return Maybe<void>::Ok();
 }
 
+Maybe<void> GenerateBackwardOpConf4Conv(const user_op::UserOpWrapper& op, user_op::AddOpFn AddOp) {
+  return GenerateBackwardOpConf4ConvWithDy(op, op.GetGradTensorWithOpOutput("out", 0), AddOp);
+}
+
 }  // namespace
 
 REGISTER_USER_OP("conv1d")
@@ -296,6 +302,67 @@ REGISTER_USER_OP_GRAD("conv1d").SetGenBackwardOpConfFn(GenerateBackwardOpConf4Co
 REGISTER_USER_OP_GRAD("conv2d").SetGenBackwardOpConfFn(GenerateBackwardOpConf4Conv);
 REGISTER_USER_OP_GRAD("conv3d").SetGenBackwardOpConfFn(GenerateBackwardOpConf4Conv);
 
+// relu(conv2d(in, weight) + bias [+ addend]), which FuseConvBiasAddReluPass makes of conv2d ->
+// bias_add -> [add ->] relu so that cuDNN computes it in one pass over the output
+REGISTER_USER_OP("fused_conv2d_bias_add_relu")
+    .Input("in")
+    .Input("weight")
+    .Input("bias")
+    .OptionalInput("addend")
+    .Output("out")
+    .Attr<int32_t>("filters")
+    .Attr<std::vector<int32_t>>("padding_before")
+    .Attr<std::string>("data_format")
+    .Attr<std::vector<int32_t>>("kernel_size")
+    .Attr<std::vector<int32_t>>("strides")
+    .Attr<std::vector<int32_t>>("dilation_rate")
+    .Attr<int32_t>("groups", 1)
+    .SetCheckAttrFn(CheckAttr<2>)
+    .SetTensorDescInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      JUST(InferTensorDesc4Conv<2>(ctx));
+      if (ctx->has_input("addend", 0)) {
+        CHECK_EQ_OR_RETURN(ctx->InputShape("addend", 0), ctx->OutputShape("out", 0));
+      }
+      return Maybe<void>::Ok();
+    })
+    .SetGetSbpFn([](user_op::SbpContext* ctx) -> Maybe<void> {
+      std::vector<user_op::OpArg> split_args{{"in", 0}, {"out", 0}};
+      if (ctx->user_op_conf().has_input("addend", 0)) { split_args.emplace_back("addend", 0); }
+      ctx->NewBuilder()
+          .Split(split_args, 0)
+          .Broadcast(user_op::OpArg("weight", 0))
+          .Broadcast(user_op::OpArg("bias", 0))
+          .Build();
+      return Maybe<void>::Ok();
+    })
+    .SetDataTypeInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      const DataType data_type = ctx->InputDType("in", 0);
+      CHECK_EQ_OR_RETURN(ctx->InputDType("bias", 0), data_type);
+      if (ctx->has_input("addend", 0)) {
+        CHECK_EQ_OR_RETURN(ctx->InputDType("addend", 0), data_type);
+      }
+      *ctx->OutputDType("out", 0) = data_type;
+      return Maybe<void>::Ok();
+    });
+
+REGISTER_USER_OP_GRAD("fused_conv2d_bias_add_relu")
+    .SetGenBackwardOpConfFn([](const user_op::UserOpWrapper& op,
+                               user_op::AddOpFn AddOp) -> Maybe<void> {
+      auto relu_grad_op =
+          user_op::UserOpConfWrapperBuilder("System-AutoGrad-" + op.op_name() + "-ReluGrad")
+              .Op("relu_grad")
+              .Input("y", op.output("out", 0))
+              .Input("dy", op.GetGradTensorWithOpOutput("out", 0))
+              .Output("dx")
+              .Build();
+      AddOp(relu_grad_op);
+      const std::string& pre_relu_grad = relu_grad_op.output("dx", 0);
+      if (op.user_op_conf().has_input("addend", 0) && op.NeedGenGradTensor4OpInput("addend", 0)) {
+        op.BindGradTensorWithOpInput(pre_relu_grad, "addend", 0);
+      }
+      return GenerateBackwardOpConf4ConvWithDy(op, pre_relu_grad, AddOp);
+    });
+
 REGISTER_USER_OP("conv_data_grad")
     .Input("dy")
     .Input("filter")
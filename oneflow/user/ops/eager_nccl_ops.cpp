@@ -14,9 +14,24 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #include "oneflow/core/framework/framework.h"
+#include "oneflow/core/framework/device.h"
 
 namespace oneflow {
 
+namespace {
+
+// Launching all-reduce on the comm stream lets eager gradient buckets overlap with backward.
+Maybe<Symbol<Device>> InferCommOpDevice(user_op::DeviceInferContext* ctx) {
+  const Symbol<Device>& in_device = ctx->InputTensorDevice4ArgNameAndIndex("in", 0);
+  *ctx->OutputTensorDevice4ArgNameAndIndex("out", 0) = in_device;
+  if (JUST(in_device->of_type()) == "gpu") {
+    return Device::New("cuda_comm", in_device->device_id());
+  }
+  return in_device;
+}
+
+}  // namespace
+
 REGISTER_NO_GRAD_USER_OP("eager_nccl_all_reduce")
     .Input("in")
     .Output("out")
@@ -25,6 +40,7 @@ REGISTER_NO_GRAD_USER_OP("eager_nccl_all_reduce")
       *ctx->OutputShape("out", 0) = ctx->InputShape("in", 0);
       return Maybe<void>::Ok();
     })
+    .SetDeviceInferFn(&InferCommOpDevice)
     .SetGetSbpFn([](user_op::SbpContext* ctx) -> Maybe<void> {
       ctx->NewBuilder()
           .PartialSum(user_op::OpArg("in", 0))
@@ -0,0 +1,170 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/framework/framework.h"
+
+namespace oneflow {
+
+// out = weight[ids] with weight of shape (num_rows, embedding_size). The ids are deduplicated by
+// the lookup: unique_ids holds every distinct id once, followed by num_rows as padding to the
+// number of ids, and inverse_indices maps each id to its position in unique_ids. The grad sums
+// the rows of out_diff into the unique ids, so the weight grad and the sparse optimizers only
+// touch one row per distinct id.
+REGISTER_USER_OP("embedding_lookup")
+    .Input("weight")
+    .Input("ids")
+    .Output("out")
+    .Output("unique_ids")
+    .Output("inverse_indices")
+    .SetTensorDescInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      const Shape& weight_shape = ctx->InputShape("weight", 0);
+      const Shape& ids_shape = ctx->InputShape("ids", 0);
+      CHECK_EQ_OR_RETURN(weight_shape.NumAxes(), 2);
+      CHECK_GT_OR_RETURN(ids_shape.NumAxes(), 0);
+      DimVector out_dim_vec = ids_shape.dim_vec();
+      out_dim_vec.push_back(weight_shape.At(1));
+      *ctx->OutputShape("out", 0) = Shape(out_dim_vec);
+      *ctx->OutputShape("unique_ids", 0) = Shape({ids_shape.elem_cnt()});
+      *ctx->OutputShape("inverse_indices", 0) = ids_shape;
+      return Maybe<void>::Ok();
+    })
+    .SetInputArgModifyFn([](user_op::GetInputArgModifier GetInputArgModifierFn,
+                            const user_op::UserOpConfWrapper&) -> Maybe<void> {
+      user_op::InputArgModifier* ids_modifier = GetInputArgModifierFn("ids", 0);
+      CHECK_OR_RETURN(ids_modifier != nullptr);
+      ids_modifier->set_requires_grad(false);
+      return Maybe<void>::Ok();
+    })
+    .SetDataTypeInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      const DataType ids_data_type = ctx->InputDType("ids", 0);
+      CHECK_OR_RETURN(IsIndexDataType(ids_data_type));
+      *ctx->OutputDType("out", 0) = ctx->InputDType("weight", 0);
+      *ctx->OutputDType("unique_ids", 0) = ids_data_type;
+      *ctx->OutputDType("inverse_indices", 0) = DataType::kInt32;
+      return Maybe<void>::Ok();
+    })
+    .SetGetSbpFn([](user_op::SbpContext* ctx) -> Maybe<void> {
+      const int64_t ids_num_axes =
+          ctx->LogicalTensorDesc4InputArgNameAndIndex("ids", 0).shape().NumAxes();
+      // every device deduplicates its own ids, unique_ids is the concat of theirs
+      FOR_RANGE(int64_t, i, 0, ids_num_axes) {
+        ctx->NewBuilder()
+            .Split(user_op::OpArg("ids", 0), i)
+            .Broadcast(user_op::OpArg("weight", 0))
+            .Split(user_op::OpArg("out", 0), i)
+            .Split(user_op::OpArg("unique_ids", 0), 0)
+            .Split(user_op::OpArg("inverse_indices", 0), i)
+            .Build();
+      }
+      // model parallel, every device looks up the rows it holds and zeros the others
+      ctx->NewBuilder()
+          .Broadcast(user_op::OpArg("ids", 0))
+          .Split(user_op::OpArg("weight", 0), 0)
+          .PartialSum(user_op::OpArg("out", 0))
+          .Broadcast(user_op::OpArg("unique_ids", 0))
+          .Broadcast(user_op::OpArg("inverse_indices", 0))
+          .Build();
+      ctx->NewBuilder()
+          .Broadcast(user_op::OpArg("ids", 0))
+          .Split(user_op::OpArg("weight", 0), 1)
+          .Split(user_op::OpArg("out", 0), ids_num_axes)
+          .Broadcast(user_op::OpArg("unique_ids", 0))
+          .Broadcast(user_op::OpArg("inverse_indices", 0))
+          .Build();
+      return Maybe<void>::Ok();
+    });
+
+// unique_diff has a row per element of unique_ids, that of an id is the sum of the rows of
+// out_diff looked up by it and the rows of the padding are zeros.
+REGISTER_USER_OP("embedding_lookup_grad")
+    .Input("out_diff")
+    .Input("unique_ids")
+    .Input("inverse_indices")
+    .Output("unique_diff")
+    .SetTensorDescInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      const Shape& out_diff_shape = ctx->InputShape("out_diff", 0);
+      const Shape& inverse_indices_shape = ctx->InputShape("inverse_indices", 0);
+      CHECK_EQ_OR_RETURN(out_diff_shape.NumAxes(), inverse_indices_shape.NumAxes() + 1);
+      CHECK_EQ_OR_RETURN(out_diff_shape.Count(0, inverse_indices_shape.NumAxes()),
+                         inverse_indices_shape.elem_cnt());
+      const int64_t num_unique_ids = ctx->InputShape("unique_ids", 0).elem_cnt();
+      CHECK_EQ_OR_RETURN(num_unique_ids, inverse_indices_shape.elem_cnt());
+      *ctx->OutputShape("unique_diff", 0) =
+          Shape({num_unique_ids, out_diff_shape.At(out_diff_shape.NumAxes() - 1)});
+      return Maybe<void>::Ok();
+    })
+    .SetDataTypeInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      CHECK_OR_RETURN(IsIndexDataType(ctx->InputDType("unique_ids", 0)));
+      CHECK_EQ_OR_RETURN(ctx->InputDType("inverse_indices", 0), DataType::kInt32);
+      *ctx->OutputDType("unique_diff", 0) = ctx->InputDType("out_diff", 0);
+      return Maybe<void>::Ok();
+    })
+    .SetGetSbpFn([](user_op::SbpContext* ctx) -> Maybe<void> {
+      const int64_t ids_num_axes =
+          ctx->LogicalTensorDesc4InputArgNameAndIndex("inverse_indices", 0).shape().NumAxes();
+      FOR_RANGE(int64_t, i, 0, ids_num_axes) {
+        ctx->NewBuilder()
+            .Split(user_op::OpArg("out_diff", 0), i)
+            .Split(user_op::OpArg("unique_ids", 0), 0)
+            .Split(user_op::OpArg("inverse_indices", 0), i)
+            .Split(user_op::OpArg("unique_diff", 0), 0)
+            .Build();
+      }
+      ctx->NewBuilder()
+          .PartialSum(user_op::OpArg("out_diff", 0))
+          .Broadcast(user_op::OpArg("unique_ids", 0))
+          .Broadcast(user_op::OpArg("inverse_indices", 0))
+          .PartialSum(user_op::OpArg("unique_diff", 0))
+          .Build();
+      ctx->NewBuilder()
+          .Split(user_op::OpArg("out_diff", 0), ids_num_axes)
+          .Broadcast(user_op::OpArg("unique_ids", 0))
+          .Broadcast(user_op::OpArg("inverse_indices", 0))
+          .Split(user_op::OpArg("unique_diff", 0), 1)
+          .Build();
+      return Maybe<void>::Ok();
+    });
+
+// The weight grad scatters unique_diff by unique_ids, which IndexedSlicesOptimizerRewritePass
+// turns into a sparse update of the rows of the unique ids. The padding ids are num_rows, out of
+// range of every row slice, so both skip them.
+REGISTER_USER_OP_GRAD("embedding_lookup")
+    .SetGenBackwardOpConfFn([](const user_op::UserOpWrapper& op,
+                               user_op::AddOpFn AddOp) -> Maybe<void> {
+      if (!op.NeedGenGradTensor4OpInput("weight", 0)) { return Maybe<void>::Ok(); }
+      user_op::UserOpConfWrapperBuilder unique_grad_builder(op.op_name() + "_unique_grad");
+      user_op::UserOpConfWrapper unique_grad_op =
+          unique_grad_builder.Op("embedding_lookup_grad")
+              .Input("out_diff", op.GetGradTensorWithOpOutput("out", 0))
+              .Input("unique_ids", op.output("unique_ids", 0))
+              .Input("inverse_indices", op.output("inverse_indices", 0))
+              .Output("unique_diff")
+              .Build();
+      AddOp(unique_grad_op);
+      user_op::UserOpConfWrapperBuilder weight_grad_builder(op.op_name() + "_grad");
+      user_op::UserOpConfWrapper weight_grad_op =
+          weight_grad_builder.Op("unsorted_segment_sum_like")
+              .Input("data", unique_grad_op.output("unique_diff", 0))
+              .Input("segment_ids", op.output("unique_ids", 0))
+              .Input("like", op.input("weight", 0))
+              .Output("out")
+              .Attr<int64_t>("axis", 0)
+              .Build();
+      op.BindGradTensorWithOpInput(weight_grad_op.output("out", 0), "weight", 0);
+      AddOp(weight_grad_op);
+      return Maybe<void>::Ok();
+    });
+
+}  // namespace oneflow
@@ -0,0 +1,158 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/framework/framework.h"
+
+namespace oneflow {
+
+namespace {
+
+bool IsScalarTensor(const user_op::TensorDesc& desc) {
+  return desc.shape().NumAxes() == 1 && desc.shape().At(0) == 1;
+}
+
+Maybe<void> Fp8ScaleUpdateInputArgModifyFn(
+    const user_op::GetInputArgModifier& GetInputArgModifierFn,
+    const user_op::UserOpConfWrapper& conf) {
+  user_op::InputArgModifier* amax_history = GetInputArgModifierFn("amax_history", 0);
+  CHECK_OR_RETURN(amax_history != nullptr);
+  amax_history->set_is_mutable(true);
+  user_op::InputArgModifier* scale = GetInputArgModifierFn("scale", 0);
+  CHECK_OR_RETURN(scale != nullptr);
+  scale->set_is_mutable(true);
+  return Maybe<void>::Ok();
+}
+
+}  // namespace
+
+// out(m, n) = a(m, k) * b(n, k)^T with a and b quantized to E4M3 by a_scale and b_scale. a_amax
+// and b_amax are the largest absolute values of a and b, for the scales of the next steps. When a
+// or b is split, its amax is a partial sum of the local amaxes: an upper bound of the amax that
+// only costs some precision of the scale derived from it.
+REGISTER_USER_OP("fp8_matmul")
+    .Input("a")
+    .Input("b")
+    .Input("a_scale")
+    .Input("b_scale")
+    .Output("out")
+    .Output("a_amax")
+    .Output("b_amax")
+    .SetTensorDescInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      const Shape& a_shape = ctx->InputShape("a", 0);
+      const Shape& b_shape = ctx->InputShape("b", 0);
+      CHECK_EQ_OR_RETURN(a_shape.NumAxes(), 2);
+      CHECK_EQ_OR_RETURN(b_shape.NumAxes(), 2);
+      CHECK_EQ_OR_RETURN(a_shape.At(1), b_shape.At(1));
+      CHECK_OR_RETURN(IsScalarTensor(ctx->InputTensorDesc("a_scale", 0)));
+      CHECK_OR_RETURN(IsScalarTensor(ctx->InputTensorDesc("b_scale", 0)));
+      *ctx->OutputShape("out", 0) = Shape({a_shape.At(0), b_shape.At(0)});
+      *ctx->OutputIsDynamic("out", 0) = ctx->InputIsDynamic("a", 0);
+      *ctx->OutputShape("a_amax", 0) = Shape({1});
+      *ctx->OutputShape("b_amax", 0) = Shape({1});
+      return Maybe<void>::Ok();
+    })
+    .SetDataTypeInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      const DataType data_type = ctx->InputDType("a", 0);
+      CHECK_EQ_OR_RETURN(ctx->InputDType("b", 0), data_type);
+      CHECK_EQ_OR_RETURN(ctx->InputDType("a_scale", 0), DataType::kFloat);
+      CHECK_EQ_OR_RETURN(ctx->InputDType("b_scale", 0), DataType::kFloat);
+      *ctx->OutputDType("out", 0) = data_type;
+      *ctx->OutputDType("a_amax", 0) = DataType::kFloat;
+      *ctx->OutputDType("b_amax", 0) = DataType::kFloat;
+      return Maybe<void>::Ok();
+    })
+    .SetGetSbpFn([](user_op::SbpContext* ctx) -> Maybe<void> {
+      ctx->NewBuilder()
+          .Split(user_op::OpArg("a", 0), 0)
+          .Broadcast(user_op::OpArg("b", 0))
+          .Broadcast(user_op::OpArg("a_scale", 0))
+          .Broadcast(user_op::OpArg("b_scale", 0))
+          .Split(user_op::OpArg("out", 0), 0)
+          .PartialSum(user_op::OpArg("a_amax", 0))
+          .Broadcast(user_op::OpArg("b_amax", 0))
+          .Build();
+      ctx->NewBuilder()
+          .Broadcast(user_op::OpArg("a", 0))
+          .Split(user_op::OpArg("b", 0), 0)
+          .Broadcast(user_op::OpArg("a_scale", 0))
+          .Broadcast(user_op::OpArg("b_scale", 0))
+          .Split(user_op::OpArg("out", 0), 1)
+          .Broadcast(user_op::OpArg("a_amax", 0))
+          .PartialSum(user_op::OpArg("b_amax", 0))
+          .Build();
+      return Maybe<void>::Ok();
+    });
+
+// The delayed scaling of one FP8 operand: amax is pushed into amax_history, the oldest entry is
+// dropped, and scale becomes fp8_max / max(amax_history) / 2^margin.
+REGISTER_USER_OP("fp8_scale_update")
+    .Input("amax")
+    .Input("amax_history")
+    .Input("scale")
+    .Attr<int32_t>("margin", 0)
+    .SetTensorDescInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      CHECK_OR_RETURN(IsScalarTensor(ctx->InputTensorDesc("amax", 0)));
+      CHECK_OR_RETURN(IsScalarTensor(ctx->InputTensorDesc("scale", 0)));
+      const Shape& amax_history_shape = ctx->InputShape("amax_history", 0);
+      CHECK_EQ_OR_RETURN(amax_history_shape.NumAxes(), 1);
+      CHECK_GT_OR_RETURN(amax_history_shape.At(0), 0);
+      return Maybe<void>::Ok();
+    })
+    .SetInputArgModifyFn(Fp8ScaleUpdateInputArgModifyFn)
+    .SetDataTypeInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      CHECK_EQ_OR_RETURN(ctx->InputDType("amax", 0), DataType::kFloat);
+      CHECK_EQ_OR_RETURN(ctx->InputDType("amax_history", 0), DataType::kFloat);
+      CHECK_EQ_OR_RETURN(ctx->InputDType("scale", 0), DataType::kFloat);
+      return Maybe<void>::Ok();
+    })
+    .SetGetSbpFn(user_op::GetSbpFnUtil::DefaultBroadcastToBroadcast);
+
+// The operands are quantized in the forward only, the grads are float matmuls.
+REGISTER_USER_OP_GRAD("fp8_matmul")
+    .SetGenBackwardOpConfFn([](const user_op::UserOpWrapper& op,
+                               user_op::AddOpFn AddOp) -> Maybe<void> {
+      const std::string& dy = op.GetGradTensorWithOpOutput("out", 0);
+      if (op.NeedGenGradTensor4OpInput("a", 0)) {
+        user_op::UserOpConfWrapper grad_a_op =
+            user_op::UserOpConfWrapperBuilder(op.op_name() + "_grad_a")
+                .Op("matmul")
+                .Input("a", dy)
+                .Input("b", op.input("b", 0))
+                .Output("out")
+                .Attr<bool>("transpose_a", false)
+                .Attr<bool>("transpose_b", false)
+                .Attr<double>("alpha", 1.0)
+                .Build();
+        op.BindGradTensorWithOpInput(grad_a_op.output("out", 0), "a", 0);
+        AddOp(grad_a_op);
+      }
+      if (op.NeedGenGradTensor4OpInput("b", 0)) {
+        user_op::UserOpConfWrapper grad_b_op =
+            user_op::UserOpConfWrapperBuilder(op.op_name() + "_grad_b")
+                .Op("matmul")
+                .Input("a", dy)
+                .Input("b", op.input("a", 0))
+                .Output("out")
+                .Attr<bool>("transpose_a", true)
+                .Attr<bool>("transpose_b", false)
+                .Attr<double>("alpha", 1.0)
+                .Build();
+        op.BindGradTensorWithOpInput(grad_b_op.output("out", 0), "b", 0);
+        AddOp(grad_b_op);
+      }
+      return Maybe<void>::Ok();
+    });
+
+}  // namespace oneflow
@@ -0,0 +1,66 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/framework/framework.h"
+
+namespace oneflow {
+
+REGISTER_USER_OP("fused_elementwise")
+    .InputWithMinimum("in", 1)
+    .Output("out")
+    .Attr<std::vector<std::string>>("op_type_names")
+    .Attr<std::vector<int32_t>>("operand_indices")
+    .Attr<std::vector<int32_t>>("chain_operand_is_rhs")
+    .Attr<std::vector<float>>("scalar_operands")
+    .SetTensorDescInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      const auto& in_0 = ctx->InputTensorDesc("in", 0);
+      for (const auto& pair : ctx->inputs()) {
+        CHECK_EQ_OR_RETURN(ctx->InputTensorDesc(pair.first, pair.second).shape(), in_0.shape());
+      }
+      const auto& op_type_names = ctx->Attr<std::vector<std::string>>("op_type_names");
+      CHECK_OR_RETURN(!op_type_names.empty());
+      CHECK_EQ_OR_RETURN(ctx->Attr<std::vector<int32_t>>("operand_indices").size(),
+                         op_type_names.size());
+      CHECK_EQ_OR_RETURN(ctx->Attr<std::vector<int32_t>>("chain_operand_is_rhs").size(),
+                         op_type_names.size());
+      CHECK_EQ_OR_RETURN(ctx->Attr<std::vector<float>>("scalar_operands").size(),
+                         op_type_names.size());
+      for (int32_t operand_index : ctx->Attr<std::vector<int32_t>>("operand_indices")) {
+        CHECK_LT_OR_RETURN(operand_index, ctx->input_size("in"));
+      }
+      auto* out = ctx->OutputTensorDesc("out", 0);
+      *out->mut_shape() = in_0.shape();
+      *out->mut_is_dynamic() = in_0.is_dynamic();
+      return Maybe<void>::Ok();
+    })
+    .SetGetSbpFn([](user_op::SbpContext* ctx) {
+      int64_t num_axes = ctx->LogicalTensorDesc4InputArgNameAndIndex("in", 0).shape().NumAxes();
+      for (int64_t i = 0; i < num_axes; ++i) {
+        ctx->NewBuilder().Split(ctx->inputs(), i).Split(user_op::OpArg("out", 0), i).Build();
+      }
+      ctx->NewBuilder().Broadcast(ctx->inputs()).Broadcast(user_op::OpArg("out", 0)).Build();
+      return Maybe<void>::Ok();
+    })
+    .SetDataTypeInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      const auto& in_0 = ctx->InputTensorDesc("in", 0);
+      for (const auto& pair : ctx->inputs()) {
+        CHECK_EQ_OR_RETURN(ctx->InputTensorDesc(pair.first, pair.second).data_type(),
+                           in_0.data_type());
+      }
+      *ctx->OutputDType("out", 0) = in_0.data_type();
+      return Maybe<void>::Ok();
+    });
+
+}  // namespace oneflow
@@ -0,0 +1,220 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/framework/framework.h"
+
+namespace oneflow {
+
+namespace {
+
+// out = activation(a * b + bias) with a of shape (..., k) and b of shape (k, n), or (n, k) if
+// transpose_b. aux holds a * b + bias for the activations whose grad needs it, which is gelu.
+Maybe<void> CheckActivation(const std::string& activation) {
+  CHECK_OR_RETURN(activation == "none" || activation == "relu" || activation == "gelu")
+      << "unsupported activation " << activation;
+  return Maybe<void>::Ok();
+}
+
+bool ActivationNeedsAux(const std::string& activation) { return activation == "gelu"; }
+
+Maybe<Shape> InferMatmulOutShape(const Shape& a_shape, const Shape& b_shape,
+                                 const bool transpose_b) {
+  CHECK_GE_OR_RETURN(a_shape.NumAxes(), 2);
+  CHECK_EQ_OR_RETURN(b_shape.NumAxes(), 2);
+  const int64_t k = a_shape.At(a_shape.NumAxes() - 1);
+  CHECK_EQ_OR_RETURN(transpose_b ? b_shape.At(1) : b_shape.At(0), k);
+  Shape out_shape = a_shape;
+  out_shape.Set(out_shape.NumAxes() - 1, transpose_b ? b_shape.At(0) : b_shape.At(1));
+  return out_shape;
+}
+
+}  // namespace
+
+REGISTER_USER_OP("fused_matmul_bias")
+    .Input("a")
+    .Input("b")
+    .Input("bias")
+    .Output("out")
+    .OptionalOutput("aux")
+    .Attr<bool>("transpose_b", false)
+    .Attr<std::string>("activation", "none")
+    .SetTensorDescInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      const std::string& activation = ctx->Attr<std::string>("activation");
+      JUST(CheckActivation(activation));
+      const Shape& a_shape = ctx->InputShape("a", 0);
+      const Shape out_shape = *JUST(InferMatmulOutShape(a_shape, ctx->InputShape("b", 0),
+                                                        ctx->Attr<bool>("transpose_b")));
+      CHECK_EQ_OR_RETURN(ctx->InputShape("bias", 0),
+                         Shape({out_shape.At(out_shape.NumAxes() - 1)}));
+      CHECK_EQ_OR_RETURN(ctx->has_output("aux", 0), ActivationNeedsAux(activation));
+      *ctx->OutputShape("out", 0) = out_shape;
+      *ctx->OutputIsDynamic("out", 0) = ctx->InputIsDynamic("a", 0);
+      if (ctx->has_output("aux", 0)) {
+        *ctx->OutputShape("aux", 0) = out_shape;
+        *ctx->OutputIsDynamic("aux", 0) = ctx->InputIsDynamic("a", 0);
+      }
+      return Maybe<void>::Ok();
+    })
+    .SetDataTypeInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      const DataType data_type = ctx->InputDType("a", 0);
+      CHECK_EQ_OR_RETURN(ctx->InputDType("b", 0), data_type);
+      CHECK_EQ_OR_RETURN(ctx->InputDType("bias", 0), data_type);
+      *ctx->OutputDType("out", 0) = data_type;
+      if (ctx->has_output("aux", 0)) { *ctx->OutputDType("aux", 0) = data_type; }
+      return Maybe<void>::Ok();
+    })
+    .SetGetSbpFn([](user_op::SbpContext* ctx) -> Maybe<void> {
+      const int64_t num_axes =
+          ctx->LogicalTensorDesc4InputArgNameAndIndex("a", 0).shape().NumAxes();
+      const bool transpose_b = ctx->Attr<bool>("transpose_b");
+      for (int64_t i = 0; i < num_axes - 1; ++i) {
+        ctx->NewBuilder()
+            .Split(user_op::OpArg("a", 0), i)
+            .Broadcast(user_op::OpArg("b", 0))
+            .Broadcast(user_op::OpArg("bias", 0))
+            .Split(ctx->outputs(), i)
+            .Build();
+      }
+      // Splitting k would need the bias to be added once after the partial sums.
+      ctx->NewBuilder()
+          .Broadcast(user_op::OpArg("a", 0))
+          .Split(user_op::OpArg("b", 0), transpose_b ? 0 : 1)
+          .Split(user_op::OpArg("bias", 0), 0)
+          .Split(ctx->outputs(), num_axes - 1)
+          .Build();
+      return Maybe<void>::Ok();
+    });
+
+// Everything of the grad but the grad of a: pre_grad is the grad of a * b + bias and is absent
+// when there is no activation, b_grad and bias_grad are computed from it by one matmul. relu takes
+// its grad from out and gelu from aux.
+REGISTER_USER_OP("fused_matmul_bias_grad")
+    .Input("dy")
+    .Input("a")
+    .OptionalInput("out")
+    .OptionalInput("aux")
+    .OptionalOutput("pre_grad")
+    .Output("b_grad")
+    .Output("bias_grad")
+    .Attr<bool>("transpose_b", false)
+    .Attr<std::string>("activation", "none")
+    .SetTensorDescInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      const std::string& activation = ctx->Attr<std::string>("activation");
+      JUST(CheckActivation(activation));
+      const Shape& dy_shape = ctx->InputShape("dy", 0);
+      const Shape& a_shape = ctx->InputShape("a", 0);
+      CHECK_EQ_OR_RETURN(dy_shape.NumAxes(), a_shape.NumAxes());
+      CHECK_EQ_OR_RETURN(dy_shape.Count(0, dy_shape.NumAxes() - 1),
+                         a_shape.Count(0, a_shape.NumAxes() - 1));
+      CHECK_EQ_OR_RETURN(ctx->has_input("out", 0), activation == "relu");
+      CHECK_EQ_OR_RETURN(ctx->has_input("aux", 0), ActivationNeedsAux(activation));
+      CHECK_EQ_OR_RETURN(ctx->has_output("pre_grad", 0), activation != "none");
+      if (ctx->has_input("out", 0)) { CHECK_EQ_OR_RETURN(ctx->InputShape("out", 0), dy_shape); }
+      if (ctx->has_input("aux", 0)) { CHECK_EQ_OR_RETURN(ctx->InputShape("aux", 0), dy_shape); }
+      const int64_t n = dy_shape.At(dy_shape.NumAxes() - 1);
+      const int64_t k = a_shape.At(a_shape.NumAxes() - 1);
+      if (ctx->has_output("pre_grad", 0)) { *ctx->OutputShape("pre_grad", 0) = dy_shape; }
+      *ctx->OutputShape("b_grad", 0) =
+          ctx->Attr<bool>("transpose_b") ? Shape({n, k}) : Shape({k, n});
+      *ctx->OutputShape("bias_grad", 0) = Shape({n});
+      return Maybe<void>::Ok();
+    })
+    .SetDataTypeInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      const DataType data_type = ctx->InputDType("dy", 0);
+      CHECK_EQ_OR_RETURN(ctx->InputDType("a", 0), data_type);
+      if (ctx->has_input("out", 0)) { CHECK_EQ_OR_RETURN(ctx->InputDType("out", 0), data_type); }
+      if (ctx->has_input("aux", 0)) { CHECK_EQ_OR_RETURN(ctx->InputDType("aux", 0), data_type); }
+      if (ctx->has_output("pre_grad", 0)) { *ctx->OutputDType("pre_grad", 0) = data_type; }
+      *ctx->OutputDType("b_grad", 0) = data_type;
+      *ctx->OutputDType("bias_grad", 0) = data_type;
+      return Maybe<void>::Ok();
+    })
+    .SetGetSbpFn([](user_op::SbpContext* ctx) -> Maybe<void> {
+      const int64_t num_axes =
+          ctx->LogicalTensorDesc4InputArgNameAndIndex("dy", 0).shape().NumAxes();
+      const bool transpose_b = ctx->Attr<bool>("transpose_b");
+      std::vector<user_op::OpArg> pre_grad_args;
+      if (ctx->user_op_conf().has_output("pre_grad", 0)) {
+        pre_grad_args.push_back({"pre_grad", 0});
+      }
+      for (int64_t i = 0; i < num_axes - 1; ++i) {
+        ctx->NewBuilder()
+            .Split(ctx->inputs(), i)
+            .Split(pre_grad_args, i)
+            .PartialSum(user_op::OpArg("b_grad", 0))
+            .PartialSum(user_op::OpArg("bias_grad", 0))
+            .Build();
+      }
+      std::vector<user_op::OpArg> n_split_args{{"dy", 0}};
+      if (ctx->user_op_conf().has_input("out", 0)) { n_split_args.push_back({"out", 0}); }
+      if (ctx->user_op_conf().has_input("aux", 0)) { n_split_args.push_back({"aux", 0}); }
+      ctx->NewBuilder()
+          .Split(n_split_args, num_axes - 1)
+          .Broadcast(user_op::OpArg("a", 0))
+          .Split(pre_grad_args, num_axes - 1)
+          .Split(user_op::OpArg("b_grad", 0), transpose_b ? 0 : 1)
+          .Split(user_op::OpArg("bias_grad", 0), 0)
+          .Build();
+      return Maybe<void>::Ok();
+    });
+
+REGISTER_USER_OP_GRAD("fused_matmul_bias")
+    .SetGenBackwardOpConfFn([](const user_op::UserOpWrapper& op,
+                               user_op::AddOpFn AddOp) -> Maybe<void> {
+      const bool transpose_b = op.attr<bool>("transpose_b");
+      const std::string& activation = op.attr<std::string>("activation");
+      std::string pre_grad = op.GetGradTensorWithOpOutput("out", 0);
+      if (op.NeedGenGradTensor4OpInput("b", 0) || op.NeedGenGradTensor4OpInput("bias", 0)
+          || (activation != "none" && op.NeedGenGradTensor4OpInput("a", 0))) {
+        user_op::UserOpConfWrapperBuilder builder(op.op_name() + "_param_grad");
+        builder.Op("fused_matmul_bias_grad")
+            .Input("dy", op.GetGradTensorWithOpOutput("out", 0))
+            .Input("a", op.input("a", 0))
+            .Output("b_grad")
+            .Output("bias_grad")
+            .Attr("transpose_b", transpose_b)
+            .Attr("activation", activation);
+        if (activation == "relu") { builder.Input("out", op.output("out", 0)); }
+        if (ActivationNeedsAux(activation)) { builder.Input("aux", op.output("aux", 0)); }
+        if (activation != "none") { builder.Output("pre_grad"); }
+        user_op::UserOpConfWrapper grad_op = builder.Build();
+        if (op.NeedGenGradTensor4OpInput("b", 0)) {
+          op.BindGradTensorWithOpInput(grad_op.output("b_grad", 0), "b", 0);
+        }
+        if (op.NeedGenGradTensor4OpInput("bias", 0)) {
+          op.BindGradTensorWithOpInput(grad_op.output("bias_grad", 0), "bias", 0);
+        }
+        if (activation != "none") { pre_grad = grad_op.output("pre_grad", 0); }
+        AddOp(grad_op);
+      }
+      if (op.NeedGenGradTensor4OpInput("a", 0)) {
+        const bool is_2d = op.TensorDesc4ArgNameAndIndex("a", 0).shape().NumAxes() == 2;
+        user_op::UserOpConfWrapper grad_a_op =
+            user_op::UserOpConfWrapperBuilder(op.op_name() + "_grad_a")
+                .Op(is_2d ? "matmul" : "broadcast_matmul")
+                .Input("a", pre_grad)
+                .Input("b", op.input("b", 0))
+                .Output("out")
+                .Attr<bool>("transpose_a", false)
+                .Attr<bool>("transpose_b", !transpose_b)
+                .Attr<double>("alpha", 1.0)
+                .Build();
+        op.BindGradTensorWithOpInput(grad_a_op.output("out", 0), "a", 0);
+        AddOp(grad_a_op);
+      }
+      return Maybe<void>::Ok();
+    });
+
+}  // namespace oneflow
@@ -0,0 +1,247 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/framework/framework.h"
+
+namespace oneflow {
+
+namespace {
+
+// query: (batch, num_heads, query_len, head_dim), key and value: (batch, num_heads, key_len,
+// head_dim), key_mask: (batch, key_len) with 0 for padding keys. cu_seqlens: (batch,
+// num_seqs + 1) offsets of sequences packed along query_len == key_len, tokens only attend within
+// their sequence and the tokens after the last one are padding. rng_state holds the dropout
+// (seed, offset) of the forward launch, so that the grad op regenerates the same mask.
+Maybe<void> CheckAttentionInputShapes(user_op::InferContext* ctx) {
+  const Shape& query_shape = ctx->InputShape("query", 0);
+  const Shape& key_shape = ctx->InputShape("key", 0);
+  const Shape& value_shape = ctx->InputShape("value", 0);
+  CHECK_EQ_OR_RETURN(query_shape.NumAxes(), 4);
+  CHECK_EQ_OR_RETURN(key_shape.NumAxes(), 4);
+  CHECK_EQ_OR_RETURN(key_shape, value_shape);
+  CHECK_EQ_OR_RETURN(query_shape.At(0), key_shape.At(0));
+  CHECK_EQ_OR_RETURN(query_shape.At(1), key_shape.At(1));
+  CHECK_EQ_OR_RETURN(query_shape.At(3), key_shape.At(3));
+  if (ctx->has_input("key_mask", 0)) {
+    const Shape& key_mask_shape = ctx->InputShape("key_mask", 0);
+    CHECK_EQ_OR_RETURN(key_mask_shape, Shape({key_shape.At(0), key_shape.At(2)}));
+  }
+  if (ctx->has_input("cu_seqlens", 0)) {
+    const Shape& cu_seqlens_shape = ctx->InputShape("cu_seqlens", 0);
+    CHECK_EQ_OR_RETURN(query_shape.At(2), key_shape.At(2));
+    CHECK_EQ_OR_RETURN(cu_seqlens_shape.NumAxes(), 2);
+    CHECK_EQ_OR_RETURN(cu_seqlens_shape.At(0), query_shape.At(0));
+    CHECK_GE_OR_RETURN(cu_seqlens_shape.At(1), 2);
+  }
+  return Maybe<void>::Ok();
+}
+
+Maybe<void> CheckAttentionInputDataTypes(user_op::InferContext* ctx) {
+  const DataType data_type = ctx->InputDType("query", 0);
+  CHECK_EQ_OR_RETURN(ctx->InputDType("key", 0), data_type);
+  CHECK_EQ_OR_RETURN(ctx->InputDType("value", 0), data_type);
+  if (ctx->has_input("key_mask", 0)) {
+    CHECK_EQ_OR_RETURN(ctx->InputDType("key_mask", 0), DataType::kInt8);
+  }
+  if (ctx->has_input("cu_seqlens", 0)) {
+    CHECK_EQ_OR_RETURN(ctx->InputDType("cu_seqlens", 0), DataType::kInt32);
+  }
+  return Maybe<void>::Ok();
+}
+
+// The optional per batch inputs, split with the batch and broadcast across heads.
+std::vector<user_op::OpArg> BatchArgs(user_op::SbpContext* ctx) {
+  std::vector<user_op::OpArg> batch_args;
+  for (const char* arg_name : {"key_mask", "cu_seqlens"}) {
+    if (ctx->user_op_conf().has_input(arg_name, 0)) { batch_args.emplace_back(arg_name, 0); }
+  }
+  return batch_args;
+}
+
+REGISTER_USER_OP("fused_multi_head_attention")
+    .Input("query")
+    .Input("key")
+    .Input("value")
+    .OptionalInput("key_mask")
+    .OptionalInput("cu_seqlens")
+    .Output("out")
+    .Output("softmax_lse")
+    .Output("rng_state")
+    .Attr<bool>("causal", false)
+    .Attr<float>("scale", 1.0)
+    .Attr<float>("dropout_rate", 0.0)
+    .Attr<int64_t>("seed", 0)
+    .SetTensorDescInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      JUST(CheckAttentionInputShapes(ctx));
+      const Shape& query_shape = ctx->InputShape("query", 0);
+      *ctx->OutputShape("out", 0) = query_shape;
+      *ctx->OutputShape("softmax_lse", 0) =
+          Shape({query_shape.At(0), query_shape.At(1), query_shape.At(2)});
+      *ctx->OutputShape("rng_state", 0) = Shape({2});
+      return Maybe<void>::Ok();
+    })
+    .SetDataTypeInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      JUST(CheckAttentionInputDataTypes(ctx));
+      *ctx->OutputDType("out", 0) = ctx->InputDType("query", 0);
+      *ctx->OutputDType("softmax_lse", 0) = DataType::kFloat;
+      *ctx->OutputDType("rng_state", 0) = DataType::kInt64;
+      return Maybe<void>::Ok();
+    })
+    .SetInputArgModifyFn([](user_op::GetInputArgModifier GetInputArgModifierFn,
+                            const user_op::UserOpConfWrapper& conf) -> Maybe<void> {
+      if (conf.has_input("key_mask", 0)) {
+        user_op::InputArgModifier* key_mask_modifier = GetInputArgModifierFn("key_mask", 0);
+        CHECK_OR_RETURN(key_mask_modifier != nullptr);
+        key_mask_modifier->set_requires_grad(false);
+      }
+      if (conf.has_input("cu_seqlens", 0)) {
+        user_op::InputArgModifier* cu_seqlens_modifier = GetInputArgModifierFn("cu_seqlens", 0);
+        CHECK_OR_RETURN(cu_seqlens_modifier != nullptr);
+        cu_seqlens_modifier->set_requires_grad(false);
+      }
+      return Maybe<void>::Ok();
+    })
+    .SetGetSbpFn([](user_op::SbpContext* ctx) -> Maybe<void> {
+      const std::vector<user_op::OpArg> batch_args = BatchArgs(ctx);
+      ctx->NewBuilder()
+          .Split(user_op::OpArg("query", 0), 0)
+          .Split(user_op::OpArg("key", 0), 0)
+          .Split(user_op::OpArg("value", 0), 0)
+          .Split(batch_args, 0)
+          .Split(user_op::OpArg("out", 0), 0)
+          .Split(user_op::OpArg("softmax_lse", 0), 0)
+          .Broadcast(user_op::OpArg("rng_state", 0))
+          .Build();
+      ctx->NewBuilder()
+          .Split(user_op::OpArg("query", 0), 1)
+          .Split(user_op::OpArg("key", 0), 1)
+          .Split(user_op::OpArg("value", 0), 1)
+          .Broadcast(batch_args)
+          .Split(user_op::OpArg("out", 0), 1)
+          .Split(user_op::OpArg("softmax_lse", 0), 1)
+          .Broadcast(user_op::OpArg("rng_state", 0))
+          .Build();
+      return Maybe<void>::Ok();
+    });
+
+REGISTER_USER_OP("fused_multi_head_attention_grad")
+    .Input("query")
+    .Input("key")
+    .Input("value")
+    .OptionalInput("key_mask")
+    .OptionalInput("cu_seqlens")
+    .Input("out")
+    .Input("out_grad")
+    .Input("softmax_lse")
+    .Input("rng_state")
+    .Output("query_grad")
+    .Output("key_grad")
+    .Output("value_grad")
+    .Attr<bool>("causal", false)
+    .Attr<float>("scale", 1.0)
+    .Attr<float>("dropout_rate", 0.0)
+    .SetTensorDescInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      JUST(CheckAttentionInputShapes(ctx));
+      const Shape& query_shape = ctx->InputShape("query", 0);
+      CHECK_EQ_OR_RETURN(ctx->InputShape("out", 0), query_shape);
+      CHECK_EQ_OR_RETURN(ctx->InputShape("out_grad", 0), query_shape);
+      *ctx->OutputShape("query_grad", 0) = query_shape;
+      *ctx->OutputShape("key_grad", 0) = ctx->InputShape("key", 0);
+      *ctx->OutputShape("value_grad", 0) = ctx->InputShape("value", 0);
+      return Maybe<void>::Ok();
+    })
+    .SetDataTypeInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      JUST(CheckAttentionInputDataTypes(ctx));
+      const DataType data_type = ctx->InputDType("query", 0);
+      CHECK_EQ_OR_RETURN(ctx->InputDType("out", 0), data_type);
+      CHECK_EQ_OR_RETURN(ctx->InputDType("out_grad", 0), data_type);
+      CHECK_EQ_OR_RETURN(ctx->InputDType("softmax_lse", 0), DataType::kFloat);
+      CHECK_EQ_OR_RETURN(ctx->InputDType("rng_state", 0), DataType::kInt64);
+      *ctx->OutputDType("query_grad", 0) = data_type;
+      *ctx->OutputDType("key_grad", 0) = data_type;
+      *ctx->OutputDType("value_grad", 0) = data_type;
+      return Maybe<void>::Ok();
+    })
+    .SetGetSbpFn([](user_op::SbpContext* ctx) -> Maybe<void> {
+      const std::vector<user_op::OpArg> batch_args = BatchArgs(ctx);
+      ctx->NewBuilder()
+          .Split(user_op::OpArg("query", 0), 0)
+          .Split(user_op::OpArg("key", 0), 0)
+          .Split(user_op::OpArg("value", 0), 0)
+          .Split(batch_args, 0)
+          .Split(user_op::OpArg("out", 0), 0)
+          .Split(user_op::OpArg("out_grad", 0), 0)
+          .Split(user_op::OpArg("softmax_lse", 0), 0)
+          .Broadcast(user_op::OpArg("rng_state", 0))
+          .Split(ctx->outputs(), 0)
+          .Build();
+      ctx->NewBuilder()
+          .Split(user_op::OpArg("query", 0), 1)
+          .Split(user_op::OpArg("key", 0), 1)
+          .Split(user_op::OpArg("value", 0), 1)
+          .Broadcast(batch_args)
+          .Split(user_op::OpArg("out", 0), 1)
+          .Split(user_op::OpArg("out_grad", 0), 1)
+          .Split(user_op::OpArg("softmax_lse", 0), 1)
+          .Broadcast(user_op::OpArg("rng_state", 0))
+          .Split(ctx->outputs(), 1)
+          .Build();
+      return Maybe<void>::Ok();
+    });
+
+REGISTER_USER_OP_GRAD("fused_multi_head_attention")
+    .SetGenBackwardOpConfFn([](const user_op::UserOpWrapper& op,
+                               user_op::AddOpFn AddOp) -> Maybe<void> {
+      if (op.NeedGenGradTensor4OpInput("query", 0) || op.NeedGenGradTensor4OpInput("key", 0)
+          || op.NeedGenGradTensor4OpInput("value", 0)) {
+        user_op::UserOpConfWrapperBuilder builder(op.op_name() + "_grad");
+        builder.Op("fused_multi_head_attention_grad")
+            .Input("query", op.input("query", 0))
+            .Input("key", op.input("key", 0))
+            .Input("value", op.input("value", 0))
+            .Input("out", op.output("out", 0))
+            .Input("out_grad", op.GetGradTensorWithOpOutput("out", 0))
+            .Input("softmax_lse", op.output("softmax_lse", 0))
+            .Input("rng_state", op.output("rng_state", 0))
+            .Output("query_grad")
+            .Output("key_grad")
+            .Output("value_grad")
+            .Attr("causal", op.attr<bool>("causal"))
+            .Attr("scale", op.attr<float>("scale"))
+            .Attr("dropout_rate", op.attr<float>("dropout_rate"));
+        if (op.user_op_conf().has_input("key_mask", 0)) {
+          builder.Input("key_mask", op.input("key_mask", 0));
+        }
+        if (op.user_op_conf().has_input("cu_seqlens", 0)) {
+          builder.Input("cu_seqlens", op.input("cu_seqlens", 0));
+        }
+        user_op::UserOpConfWrapper grad_op = builder.Build();
+        if (op.NeedGenGradTensor4OpInput("query", 0)) {
+          op.BindGradTensorWithOpInput(grad_op.output("query_grad", 0), "query", 0);
+        }
+        if (op.NeedGenGradTensor4OpInput("key", 0)) {
+          op.BindGradTensorWithOpInput(grad_op.output("key_grad", 0), "key", 0);
+        }
+        if (op.NeedGenGradTensor4OpInput("value", 0)) {
+          op.BindGradTensorWithOpInput(grad_op.output("value_grad", 0), "value", 0);
+        }
+        AddOp(grad_op);
+      }
+      return Maybe<void>::Ok();
+    });
+
+}  // namespace
+
+}  // namespace oneflow
@@ -22,6 +22,7 @@ namespace oneflow {
 REGISTER_NO_GRAD_CPU_ONLY_USER_OP("megatron_gpt_mmap_data_loader")
     .OptionalInput("iteration")
     .Output("out")
+    .OptionalOutput("cu_seqlens")
     .Attr<std::string>("data_file_prefix")
     .Attr<int64_t>("seq_length")
     .Attr<int64_t>("label_length", 1)
@@ -38,11 +39,19 @@ REGISTER_NO_GRAD_CPU_ONLY_USER_OP("megatron_gpt_mmap_data_loader")
       int64_t sample_len = ctx->Attr<int64_t>("seq_length") + ctx->Attr<int64_t>("label_length");
       user_op::TensorDesc* out_desc = ctx->OutputTensorDesc("out", 0);
       *out_desc->mut_shape() = Shape({batch_size, sample_len});
+      // the document offsets of each sample, a sample holds at most seq_length documents
+      if (ctx->has_output("cu_seqlens", 0)) {
+        *ctx->OutputShape("cu_seqlens", 0) =
+            Shape({batch_size, ctx->Attr<int64_t>("seq_length") + 1});
+      }
       return Maybe<void>::Ok();
     })
     .SetDataTypeInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
       user_op::TensorDesc* out_desc = ctx->OutputTensorDesc("out", 0);
       *out_desc->mut_data_type() = ctx->Attr<DataType>("dtype");
+      if (ctx->has_output("cu_seqlens", 0)) {
+        *ctx->OutputDType("cu_seqlens", 0) = DataType::kInt32;
+      }
       return Maybe<void>::Ok();
     })
     .SetParallelDistributionInferFn([](user_op::InferParallelDistributionFnContext* ctx)
@@ -79,6 +88,9 @@ REGISTER_NO_GRAD_CPU_ONLY_USER_OP("megatron_gpt_mmap_data_loader")
           }
         }
       }
+      if (ctx->user_op_conf().has_output("cu_seqlens", 0)) {
+        *ctx->ParallelDistribution4ArgNameAndIndex("cu_seqlens", 0) = *output_dist;
+      }
       return Maybe<void>::Ok();
     })
     .SetInputArgModifyFn([](const user_op::GetInputArgModifier& GetInputArgModifierFn,
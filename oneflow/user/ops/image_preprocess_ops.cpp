@@ -215,4 +215,106 @@ REGISTER_NO_GRAD_CPU_ONLY_USER_OP("image_random_crop")
       return Maybe<void>::Ok();
     });
 
+REGISTER_NO_GRAD_CPU_ONLY_USER_OP("image_random_augment_params")
+    .Input("in")
+    .Output("crop_window")
+    .Output("color_jitter")
+    .Attr<int32_t>("num_attempts", 10)
+    .Attr<int64_t>("seed", -1)
+    .Attr<bool>("has_seed", false)
+    .Attr<std::vector<float>>("random_area", {0.08, 1.0})
+    .Attr<std::vector<float>>("random_aspect_ratio", {0.75, 1.333333})
+    .Attr<float>("brightness", 0.0)
+    .Attr<float>("contrast", 0.0)
+    .SetTensorDescInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      const user_op::TensorDesc& in_tensor = ctx->InputTensorDesc("in", 0);
+      CHECK_OR_RETURN(in_tensor.shape().NumAxes() == 1 && in_tensor.shape().At(0) >= 1);
+      CHECK_GE_OR_RETURN(ctx->Attr<float>("brightness"), 0);
+      CHECK_GE_OR_RETURN(ctx->Attr<float>("contrast"), 0);
+      const int64_t N = in_tensor.shape().At(0);
+      // {y, x, h, w} of the crop window of each image
+      *ctx->OutputShape("crop_window", 0) = Shape({N, 4});
+      // {brightness, contrast} factors of each image
+      *ctx->OutputShape("color_jitter", 0) = Shape({N, 2});
+      return Maybe<void>::Ok();
+    })
+    .SetGetSbpFn([](user_op::SbpContext* ctx) -> Maybe<void> {
+      ctx->NewBuilder().Split(ctx->inputs(), 0).Split(ctx->outputs(), 0).Build();
+      return Maybe<void>::Ok();
+    })
+    .SetInputArgModifyFn([](user_op::GetInputArgModifier GetInputArgModifierFn,
+                            const user_op::UserOpConfWrapper&) -> Maybe<void> {
+      user_op::InputArgModifier* in_modifier = GetInputArgModifierFn("in", 0);
+      CHECK_NOTNULL_OR_RETURN(in_modifier);
+      in_modifier->set_requires_grad(false);
+      return Maybe<void>::Ok();
+    })
+    .SetDataTypeInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      const user_op::TensorDesc& in_tensor = ctx->InputTensorDesc("in", 0);
+      CHECK_OR_RETURN(in_tensor.data_type() == DataType::kTensorBuffer);
+      *ctx->OutputDType("crop_window", 0) = DataType::kInt32;
+      *ctx->OutputDType("color_jitter", 0) = DataType::kFloat;
+      return Maybe<void>::Ok();
+    });
+
+REGISTER_NO_GRAD_USER_OP("crop_resize_mirror_normalize_from_uint8")
+    .Input("in")
+    .Input("crop_window")
+    .OptionalInput("mirror")
+    .OptionalInput("color_jitter")
+    .Output("out")
+    .Attr<std::string>("color_space", "BGR")
+    .Attr<std::string>("output_layout", "NCHW")
+    .Attr<std::vector<float>>("mean", {0.0})
+    .Attr<std::vector<float>>("std", {1.0})
+    .Attr<int64_t>("target_h")
+    .Attr<int64_t>("target_w")
+    .Attr<DataType>("output_dtype", DataType::kFloat)
+    .SetTensorDescInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      const user_op::TensorDesc& in_tensor = ctx->InputTensorDesc("in", 0);
+      CHECK_EQ_OR_RETURN(in_tensor.shape().NumAxes(), 4);  // {N, H, W, C}
+      const int64_t N = in_tensor.shape().At(0);
+      const int64_t C = ImageUtil::IsColor(ctx->Attr<std::string>("color_space")) ? 3 : 1;
+      CHECK_EQ_OR_RETURN(in_tensor.shape().At(3), C);
+      CHECK_EQ_OR_RETURN(ctx->InputShape("crop_window", 0), Shape({N, 4}));
+      if (ctx->has_input("mirror", 0)) {
+        CHECK_EQ_OR_RETURN(ctx->InputShape("mirror", 0), Shape({N}));
+      }
+      if (ctx->has_input("color_jitter", 0)) {
+        CHECK_EQ_OR_RETURN(ctx->InputShape("color_jitter", 0), Shape({N, 2}));
+      }
+      const int64_t H = ctx->Attr<int64_t>("target_h");
+      const int64_t W = ctx->Attr<int64_t>("target_w");
+      CHECK_GT_OR_RETURN(H, 0);
+      CHECK_GT_OR_RETURN(W, 0);
+      const std::string& output_layout = ctx->Attr<std::string>("output_layout");
+      if (output_layout == "NCHW") {
+        *ctx->OutputShape("out", 0) = Shape({N, C, H, W});
+      } else if (output_layout == "NHWC") {
+        *ctx->OutputShape("out", 0) = Shape({N, H, W, C});
+      } else {
+        return Error::CheckFailedError()
+               << "output_layout: " << output_layout << " is not supported";
+      }
+      return Maybe<void>::Ok();
+    })
+    .SetGetSbpFn([](user_op::SbpContext* ctx) -> Maybe<void> {
+      ctx->NewBuilder().Split(ctx->inputs(), 0).Split(ctx->outputs(), 0).Build();
+      return Maybe<void>::Ok();
+    })
+    .SetDataTypeInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      CHECK_EQ_OR_RETURN(ctx->InputDType("in", 0), DataType::kUInt8);
+      CHECK_EQ_OR_RETURN(ctx->InputDType("crop_window", 0), DataType::kInt32);
+      if (ctx->has_input("mirror", 0)) {
+        CHECK_EQ_OR_RETURN(ctx->InputDType("mirror", 0), DataType::kInt8);
+      }
+      if (ctx->has_input("color_jitter", 0)) {
+        CHECK_EQ_OR_RETURN(ctx->InputDType("color_jitter", 0), DataType::kFloat);
+      }
+      const DataType output_dtype = ctx->Attr<DataType>("output_dtype");
+      CHECK_OR_RETURN(output_dtype == DataType::kFloat || output_dtype == DataType::kFloat16);
+      *ctx->OutputDType("out", 0) = output_dtype;
+      return Maybe<void>::Ok();
+    });
+
 }  // namespace oneflow
@@ -397,6 +397,49 @@ Maybe<void> InferLarsUpdateDataType(user_op::InferContext* ctx) {
   }
   return Maybe<void>::Ok();
 }
+Maybe<void> InferMultiTensorUpdateTensorDesc(user_op::InferContext* ctx,
+                                             const std::vector<std::string>& state_names) {
+  const int32_t num_tensors = ctx->input_size("model");
+  CHECK_EQ_OR_RETURN(ctx->input_size("model_diff"), num_tensors);
+  for (const auto& name : state_names) { CHECK_EQ_OR_RETURN(ctx->input_size(name), num_tensors); }
+  FOR_RANGE(int32_t, i, 0, num_tensors) {
+    const user_op::TensorDesc& model = ctx->InputTensorDesc("model", i);
+    const user_op::TensorDesc& model_diff = ctx->InputTensorDesc("model_diff", i);
+    CHECK_EQ_OR_RETURN(model_diff.shape(), model.shape());
+    for (const auto& name : state_names) {
+      JUST(CheckShapeLike(&ctx->InputTensorDesc(name, i), &model));
+    }
+  }
+  return Maybe<void>::Ok();
+}
+Maybe<void> InferMultiTensorUpdateDataType(user_op::InferContext* ctx,
+                                           const std::vector<std::string>& state_names) {
+  const user_op::TensorDesc& model_0 = ctx->InputTensorDesc("model", 0);
+  const user_op::TensorDesc& model_diff_0 = ctx->InputTensorDesc("model_diff", 0);
+  FOR_RANGE(int32_t, i, 0, ctx->input_size("model")) {
+    const user_op::TensorDesc& model = ctx->InputTensorDesc("model", i);
+    JUST(CheckDataTypeLike(&model, &model_0));
+    JUST(CheckDataTypeLike(&ctx->InputTensorDesc("model_diff", i), &model_diff_0));
+    for (const auto& name : state_names) {
+      JUST(CheckDataTypeLike(&ctx->InputTensorDesc(name, i), &model));
+    }
+  }
+  return Maybe<void>::Ok();
+}
+Maybe<void> MultiTensorUpdateInputArgModifyFn(
+    const user_op::GetInputArgModifier& GetInputArgModifierFn,
+    const user_op::UserOpConfWrapper& conf, const std::vector<std::string>& mutable_names) {
+  for (const auto& name : mutable_names) {
+    FOR_RANGE(int32_t, i, 0, conf.input_size(name)) {
+      JUST(SetInputArgModifierMutable(GetInputArgModifierFn, name, i));
+    }
+  }
+  return Maybe<void>::Ok();
+}
+Maybe<void> GetMultiTensorUpdateSbp(user_op::SbpContext* ctx) {
+  ctx->NewBuilder().Broadcast(ctx->inputs()).Build();
+  return Maybe<void>::Ok();
+}
 REGISTER_NO_GRAD_USER_OP("sgd_update")
     .Input("model")
     .Input("model_diff")
@@ -449,6 +492,9 @@ REGISTER_NO_GRAD_USER_OP("indexed_slices_sgd_update")
             .Split(user_op::OpArg("model", 0), i)
             .Build();
       }
+      // a replicated model is updated from the gathered (indices, values) of all ranks, which
+      // for sparse grads moves far less than all-reducing the dense one
+      ctx->NewBuilder().Broadcast(ctx->inputs()).Build();
       return Maybe<void>::Ok();
     })
     .SetInputArgModifyFn(IndexedSlicesSgdInputArgModifyFn)
@@ -513,6 +559,7 @@ REGISTER_NO_GRAD_USER_OP("indexed_slices_momentum_update")
             .Split(user_op::OpArg("momentum", 0), i)
             .Build();
       }
+      ctx->NewBuilder().Broadcast(ctx->inputs()).Build();
       return Maybe<void>::Ok();
     })
     .SetInputArgModifyFn(IndexedSlicesMomentumInputArgModifyFn)
@@ -551,6 +598,74 @@ REGISTER_NO_GRAD_USER_OP("adam_update")
     .SetInputArgModifyFn(AdamInputArgModifyFn)
     .SetDataTypeInferFn(InferAdamUpdateDataType);
 
+REGISTER_NO_GRAD_USER_OP("multi_tensor_sgd_update")
+    .InputWithMinimum("model", 1)
+    .InputWithMinimum("model_diff", 1)
+    .Attr<float>("learning_rate_val", 0.0)
+    .Attr<double>("scale", 1.0)
+    .Attr<float>("l1", 0.0)
+    .Attr<float>("l2", 0.0)
+    .Attr<float>("weight_decay", 0.0)
+    .SetTensorDescInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      return InferMultiTensorUpdateTensorDesc(ctx, {});
+    })
+    .SetGetSbpFn(GetMultiTensorUpdateSbp)
+    .SetInputArgModifyFn([](const user_op::GetInputArgModifier& GetInputArgModifierFn,
+                            const user_op::UserOpConfWrapper& conf) -> Maybe<void> {
+      return MultiTensorUpdateInputArgModifyFn(GetInputArgModifierFn, conf, {"model"});
+    })
+    .SetDataTypeInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      return InferMultiTensorUpdateDataType(ctx, {});
+    });
+
+REGISTER_NO_GRAD_USER_OP("multi_tensor_momentum_update")
+    .InputWithMinimum("model", 1)
+    .InputWithMinimum("model_diff", 1)
+    .InputWithMinimum("momentum", 1)
+    .Attr<float>("learning_rate_val", 0.0)
+    .Attr<double>("scale", 1.0)
+    .Attr<float>("l1", 0.0)
+    .Attr<float>("l2", 0.0)
+    .Attr<float>("beta", 0.9)
+    .Attr<float>("weight_decay", 0.0)
+    .SetTensorDescInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      return InferMultiTensorUpdateTensorDesc(ctx, {"momentum"});
+    })
+    .SetGetSbpFn(GetMultiTensorUpdateSbp)
+    .SetInputArgModifyFn([](const user_op::GetInputArgModifier& GetInputArgModifierFn,
+                            const user_op::UserOpConfWrapper& conf) -> Maybe<void> {
+      return MultiTensorUpdateInputArgModifyFn(GetInputArgModifierFn, conf,
+                                               {"model", "momentum"});
+    })
+    .SetDataTypeInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      return InferMultiTensorUpdateDataType(ctx, {"momentum"});
+    });
+
+REGISTER_NO_GRAD_USER_OP("multi_tensor_adam_update")
+    .InputWithMinimum("model", 1)
+    .InputWithMinimum("model_diff", 1)
+    .InputWithMinimum("m", 1)
+    .InputWithMinimum("v", 1)
+    .Attr<float>("learning_rate_val", 0.0)
+    .Attr<double>("scale", 1.0)
+    .Attr<float>("l1", 0.0)
+    .Attr<float>("l2", 0.0)
+    .Attr<float>("beta1", 0.9)
+    .Attr<float>("beta2", 0.999)
+    .Attr<float>("epsilon", 1e-8)
+    .Attr<float>("weight_decay", 0.0)
+    .SetTensorDescInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      return InferMultiTensorUpdateTensorDesc(ctx, {"m", "v"});
+    })
+    .SetGetSbpFn(GetMultiTensorUpdateSbp)
+    .SetInputArgModifyFn([](const user_op::GetInputArgModifier& GetInputArgModifierFn,
+                            const user_op::UserOpConfWrapper& conf) -> Maybe<void> {
+      return MultiTensorUpdateInputArgModifyFn(GetInputArgModifierFn, conf, {"model", "m", "v"});
+    })
+    .SetDataTypeInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      return InferMultiTensorUpdateDataType(ctx, {"m", "v"});
+    });
+
 REGISTER_NO_GRAD_USER_OP("indexed_slices_adam_update")
     .Input("model")
     .Input("model_diff_indices")
@@ -587,6 +702,7 @@ REGISTER_NO_GRAD_USER_OP("indexed_slices_adam_update")
             .Split(user_op::OpArg("v", 0), i)
             .Build();
       }
+      ctx->NewBuilder().Broadcast(ctx->inputs()).Build();
       return Maybe<void>::Ok();
     })
     .SetInputArgModifyFn(AdamInputArgModifyFn)
@@ -632,6 +748,23 @@ REGISTER_NO_GRAD_USER_OP("adam_bias_correction_learning_rate")
     })
     .SetGetSbpFn(user_op::GetSbpFnUtil::DefaultBroadcastToBroadcast);
 
+REGISTER_NO_GRAD_USER_OP("clip_by_global_norm_scale")
+    .Input("square_sum")
+    .Output("scale")
+    .Attr<float>("clip_norm")
+    .SetTensorDescInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      const user_op::TensorDesc& square_sum = ctx->InputTensorDesc("square_sum", 0);
+      CHECK_EQ_OR_RETURN(square_sum.shape().elem_cnt(), 1);
+      *ctx->OutputShape("scale", 0) = square_sum.shape();
+      *ctx->OutputIsDynamic("scale", 0) = square_sum.is_dynamic();
+      return Maybe<void>::Ok();
+    })
+    .SetDataTypeInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      *ctx->OutputDType("scale", 0) = ctx->InputDType("square_sum", 0);
+      return Maybe<void>::Ok();
+    })
+    .SetGetSbpFn(user_op::GetSbpFnUtil::DefaultBroadcastToBroadcast);
+
 // every bn has sbp broadcast signature
 
 REGISTER_NO_GRAD_USER_OP("rmsprop_update")
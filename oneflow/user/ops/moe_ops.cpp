@@ -0,0 +1,357 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/framework/framework.h"
+
+namespace oneflow {
+
+// Token routing of a mixture of experts layer:
+//
+//   expert_ids, positions, gates = moe_gating(logits)
+//   expert_x = moe_dispatch(x, expert_ids, positions)           # (num_experts, capacity, hidden)
+//   expert_y = experts(expert_x)
+//   y = moe_combine(expert_y, expert_ids, positions, gates)     # (num_tokens, hidden)
+//
+// Token t is routed to the experts expert_ids[t, :] and lands in the slot positions[t, j] of
+// expert expert_ids[t, j]. Slots are handed out per expert in the order of (j, t), so the first
+// choices of all tokens are served before any second choice. A token whose position is not less
+// than the capacity of the dispatched tensor is dropped by that expert, dispatch does not copy it
+// and combine adds nothing for it.
+//
+// With the tokens split across devices, every device routes its own tokens and fills its own
+// part of the capacity axis, so the dispatched tensor is split on axis 1. Boxing it to split on
+// axis 0 (the experts) is the all-to-all between the expert shards, and the way back is the
+// all-to-all that brings the expert outputs to the devices of their tokens.
+
+namespace {
+
+Maybe<void> CheckRouting(user_op::InferContext* ctx, int64_t num_tokens) {
+  const Shape& expert_ids_shape = ctx->InputShape("expert_ids", 0);
+  CHECK_EQ_OR_RETURN(expert_ids_shape.NumAxes(), 2);
+  CHECK_EQ_OR_RETURN(expert_ids_shape.At(0), num_tokens);
+  CHECK_EQ_OR_RETURN(ctx->InputShape("positions", 0), expert_ids_shape);
+  if (ctx->has_input("gates", 0)) {
+    CHECK_EQ_OR_RETURN(ctx->InputShape("gates", 0), expert_ids_shape);
+  }
+  return Maybe<void>::Ok();
+}
+
+Maybe<void> CheckRoutingDataType(user_op::InferContext* ctx, DataType data_type) {
+  CHECK_EQ_OR_RETURN(ctx->InputDType("expert_ids", 0), DataType::kInt32);
+  CHECK_EQ_OR_RETURN(ctx->InputDType("positions", 0), DataType::kInt32);
+  if (ctx->has_input("gates", 0)) { CHECK_EQ_OR_RETURN(ctx->InputDType("gates", 0), data_type); }
+  return Maybe<void>::Ok();
+}
+
+std::vector<user_op::OpArg> RoutingArgs(const user_op::UserOpConfWrapper& conf) {
+  std::vector<user_op::OpArg> args{user_op::OpArg("expert_ids", 0),
+                                   user_op::OpArg("positions", 0)};
+  if (conf.has_input("gates", 0)) { args.emplace_back("gates", 0); }
+  return args;
+}
+
+}  // namespace
+
+REGISTER_USER_OP("moe_gating")
+    .Input("logits")
+    .Output("expert_ids")
+    .Output("positions")
+    .Output("gates")
+    .Attr<int32_t>("k")
+    .SetTensorDescInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      const Shape& logits_shape = ctx->InputShape("logits", 0);
+      CHECK_EQ_OR_RETURN(logits_shape.NumAxes(), 2);
+      const int32_t k = ctx->Attr<int32_t>("k");
+      CHECK_GT_OR_RETURN(k, 0);
+      CHECK_LE_OR_RETURN(k, logits_shape.At(1));
+      const Shape routing_shape({logits_shape.At(0), k});
+      *ctx->OutputShape("expert_ids", 0) = routing_shape;
+      *ctx->OutputShape("positions", 0) = routing_shape;
+      *ctx->OutputShape("gates", 0) = routing_shape;
+      return Maybe<void>::Ok();
+    })
+    .SetDataTypeInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      *ctx->OutputDType("expert_ids", 0) = DataType::kInt32;
+      *ctx->OutputDType("positions", 0) = DataType::kInt32;
+      *ctx->OutputDType("gates", 0) = ctx->InputDType("logits", 0);
+      return Maybe<void>::Ok();
+    })
+    .SetGetSbpFn([](user_op::SbpContext* ctx) -> Maybe<void> {
+      // every device hands out the slots of its own tokens
+      ctx->NewBuilder().Split(ctx->inputs(), 0).Split(ctx->outputs(), 0).Build();
+      return Maybe<void>::Ok();
+    });
+
+// gates are the softmax over the k selected logits of every token
+REGISTER_USER_OP("moe_gating_grad")
+    .Input("gates")
+    .Input("expert_ids")
+    .Input("gates_diff")
+    .Output("logits_diff")
+    .Attr<int64_t>("num_experts")
+    .SetTensorDescInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      const Shape& gates_shape = ctx->InputShape("gates", 0);
+      CHECK_EQ_OR_RETURN(gates_shape.NumAxes(), 2);
+      CHECK_EQ_OR_RETURN(ctx->InputShape("expert_ids", 0), gates_shape);
+      CHECK_EQ_OR_RETURN(ctx->InputShape("gates_diff", 0), gates_shape);
+      *ctx->OutputShape("logits_diff", 0) =
+          Shape({gates_shape.At(0), ctx->Attr<int64_t>("num_experts")});
+      return Maybe<void>::Ok();
+    })
+    .SetDataTypeInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      CHECK_EQ_OR_RETURN(ctx->InputDType("expert_ids", 0), DataType::kInt32);
+      CHECK_EQ_OR_RETURN(ctx->InputDType("gates_diff", 0), ctx->InputDType("gates", 0));
+      *ctx->OutputDType("logits_diff", 0) = ctx->InputDType("gates", 0);
+      return Maybe<void>::Ok();
+    })
+    .SetGetSbpFn([](user_op::SbpContext* ctx) -> Maybe<void> {
+      ctx->NewBuilder().Split(ctx->inputs(), 0).Split(ctx->outputs(), 0).Build();
+      return Maybe<void>::Ok();
+    });
+
+// out[expert_ids[t, j], positions[t, j]] = x[t] * gates[t, j], gates default to ones
+REGISTER_USER_OP("moe_dispatch")
+    .Input("x")
+    .Input("expert_ids")
+    .Input("positions")
+    .OptionalInput("gates")
+    .Output("out")
+    .Attr<int64_t>("num_experts")
+    .Attr<int64_t>("capacity")
+    .SetTensorDescInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      const Shape& x_shape = ctx->InputShape("x", 0);
+      CHECK_EQ_OR_RETURN(x_shape.NumAxes(), 2);
+      JUST(CheckRouting(ctx, x_shape.At(0)));
+      const int64_t num_experts = ctx->Attr<int64_t>("num_experts");
+      const int64_t capacity = ctx->Attr<int64_t>("capacity");
+      CHECK_GT_OR_RETURN(num_experts, 0);
+      CHECK_GE_OR_RETURN(capacity, 0);
+      *ctx->OutputShape("out", 0) = Shape({num_experts, capacity, x_shape.At(1)});
+      return Maybe<void>::Ok();
+    })
+    .SetInputArgModifyFn([](user_op::GetInputArgModifier GetInputArgModifierFn,
+                            const user_op::UserOpConfWrapper&) -> Maybe<void> {
+      for (const char* arg_name : {"expert_ids", "positions"}) {
+        user_op::InputArgModifier* modifier = GetInputArgModifierFn(arg_name, 0);
+        CHECK_OR_RETURN(modifier != nullptr);
+        modifier->set_requires_grad(false);
+      }
+      return Maybe<void>::Ok();
+    })
+    .SetDataTypeInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      JUST(CheckRoutingDataType(ctx, ctx->InputDType("x", 0)));
+      *ctx->OutputDType("out", 0) = ctx->InputDType("x", 0);
+      return Maybe<void>::Ok();
+    })
+    .SetGetSbpFn([](user_op::SbpContext* ctx) -> Maybe<void> {
+      const std::vector<user_op::OpArg> routing_args = RoutingArgs(ctx->user_op_conf());
+      // expert parallel, the tokens of every device fill its part of the capacity axis
+      ctx->NewBuilder()
+          .Split(user_op::OpArg("x", 0), 0)
+          .Split(routing_args, 0)
+          .Split(user_op::OpArg("out", 0), 1)
+          .Build();
+      ctx->NewBuilder()
+          .Split(user_op::OpArg("x", 0), 1)
+          .Broadcast(routing_args)
+          .Split(user_op::OpArg("out", 0), 2)
+          .Build();
+      ctx->NewBuilder()
+          .PartialSum(user_op::OpArg("x", 0))
+          .Broadcast(routing_args)
+          .PartialSum(user_op::OpArg("out", 0))
+          .Build();
+      return Maybe<void>::Ok();
+    });
+
+// out[t] = sum_j expert_x[expert_ids[t, j], positions[t, j]] * gates[t, j], gates default to ones
+REGISTER_USER_OP("moe_combine")
+    .Input("expert_x")
+    .Input("expert_ids")
+    .Input("positions")
+    .OptionalInput("gates")
+    .Output("out")
+    .SetTensorDescInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      const Shape& expert_x_shape = ctx->InputShape("expert_x", 0);
+      CHECK_EQ_OR_RETURN(expert_x_shape.NumAxes(), 3);
+      const int64_t num_tokens = ctx->InputShape("expert_ids", 0).At(0);
+      JUST(CheckRouting(ctx, num_tokens));
+      *ctx->OutputShape("out", 0) = Shape({num_tokens, expert_x_shape.At(2)});
+      return Maybe<void>::Ok();
+    })
+    .SetInputArgModifyFn([](user_op::GetInputArgModifier GetInputArgModifierFn,
+                            const user_op::UserOpConfWrapper&) -> Maybe<void> {
+      for (const char* arg_name : {"expert_ids", "positions"}) {
+        user_op::InputArgModifier* modifier = GetInputArgModifierFn(arg_name, 0);
+        CHECK_OR_RETURN(modifier != nullptr);
+        modifier->set_requires_grad(false);
+      }
+      return Maybe<void>::Ok();
+    })
+    .SetDataTypeInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      JUST(CheckRoutingDataType(ctx, ctx->InputDType("expert_x", 0)));
+      *ctx->OutputDType("out", 0) = ctx->InputDType("expert_x", 0);
+      return Maybe<void>::Ok();
+    })
+    .SetGetSbpFn([](user_op::SbpContext* ctx) -> Maybe<void> {
+      const std::vector<user_op::OpArg> routing_args = RoutingArgs(ctx->user_op_conf());
+      ctx->NewBuilder()
+          .Split(user_op::OpArg("expert_x", 0), 1)
+          .Split(routing_args, 0)
+          .Split(user_op::OpArg("out", 0), 0)
+          .Build();
+      ctx->NewBuilder()
+          .Split(user_op::OpArg("expert_x", 0), 2)
+          .Broadcast(routing_args)
+          .Split(user_op::OpArg("out", 0), 1)
+          .Build();
+      ctx->NewBuilder()
+          .PartialSum(user_op::OpArg("expert_x", 0))
+          .Broadcast(routing_args)
+          .PartialSum(user_op::OpArg("out", 0))
+          .Build();
+      return Maybe<void>::Ok();
+    });
+
+// gates_diff[t, j] = dot(x[t], expert_x[expert_ids[t, j], positions[t, j]]), the grad of the gates
+// of both moe_dispatch (x its input and expert_x its out grad) and moe_combine (x its out grad and
+// expert_x its input)
+REGISTER_USER_OP("moe_gates_grad")
+    .Input("x")
+    .Input("expert_x")
+    .Input("expert_ids")
+    .Input("positions")
+    .Output("gates_diff")
+    .SetTensorDescInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      const Shape& x_shape = ctx->InputShape("x", 0);
+      const Shape& expert_x_shape = ctx->InputShape("expert_x", 0);
+      CHECK_EQ_OR_RETURN(x_shape.NumAxes(), 2);
+      CHECK_EQ_OR_RETURN(expert_x_shape.NumAxes(), 3);
+      CHECK_EQ_OR_RETURN(expert_x_shape.At(2), x_shape.At(1));
+      JUST(CheckRouting(ctx, x_shape.At(0)));
+      *ctx->OutputShape("gates_diff", 0) = ctx->InputShape("expert_ids", 0);
+      return Maybe<void>::Ok();
+    })
+    .SetDataTypeInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      CHECK_EQ_OR_RETURN(ctx->InputDType("expert_x", 0), ctx->InputDType("x", 0));
+      JUST(CheckRoutingDataType(ctx, ctx->InputDType("x", 0)));
+      *ctx->OutputDType("gates_diff", 0) = ctx->InputDType("x", 0);
+      return Maybe<void>::Ok();
+    })
+    .SetGetSbpFn([](user_op::SbpContext* ctx) -> Maybe<void> {
+      const std::vector<user_op::OpArg> routing_args = RoutingArgs(ctx->user_op_conf());
+      ctx->NewBuilder()
+          .Split(user_op::OpArg("x", 0), 0)
+          .Split(user_op::OpArg("expert_x", 0), 1)
+          .Split(routing_args, 0)
+          .Split(user_op::OpArg("gates_diff", 0), 0)
+          .Build();
+      ctx->NewBuilder()
+          .Split(user_op::OpArg("x", 0), 1)
+          .Split(user_op::OpArg("expert_x", 0), 2)
+          .Broadcast(routing_args)
+          .PartialSum(user_op::OpArg("gates_diff", 0))
+          .Build();
+      return Maybe<void>::Ok();
+    });
+
+REGISTER_USER_OP_GRAD("moe_gating")
+    .SetGenBackwardOpConfFn([](const user_op::UserOpWrapper& op,
+                               user_op::AddOpFn AddOp) -> Maybe<void> {
+      if (!op.NeedGenGradTensor4OpInput("logits", 0)) { return Maybe<void>::Ok(); }
+      if (!op.HasGradTensor4OpOutput("gates", 0)) { return Maybe<void>::Ok(); }
+      user_op::UserOpConfWrapperBuilder builder(op.op_name() + "_grad");
+      user_op::UserOpConfWrapper grad_op =
+          builder.Op("moe_gating_grad")
+              .Input("gates", op.output("gates", 0))
+              .Input("expert_ids", op.output("expert_ids", 0))
+              .Input("gates_diff", op.GetGradTensorWithOpOutput("gates", 0))
+              .Output("logits_diff")
+              .Attr<int64_t>("num_experts",
+                             op.TensorDesc4ArgNameAndIndex("logits", 0).shape().At(1))
+              .Build();
+      op.BindGradTensorWithOpInput(grad_op.output("logits_diff", 0), "logits", 0);
+      AddOp(grad_op);
+      return Maybe<void>::Ok();
+    });
+
+REGISTER_USER_OP_GRAD("moe_dispatch")
+    .SetGenBackwardOpConfFn([](const user_op::UserOpWrapper& op,
+                               user_op::AddOpFn AddOp) -> Maybe<void> {
+      const bool has_gates = op.input_size("gates") > 0;
+      if (op.NeedGenGradTensor4OpInput("x", 0)) {
+        user_op::UserOpConfWrapperBuilder builder(op.op_name() + "_x_grad");
+        builder.Op("moe_combine")
+            .Input("expert_x", op.GetGradTensorWithOpOutput("out", 0))
+            .Input("expert_ids", op.input("expert_ids", 0))
+            .Input("positions", op.input("positions", 0))
+            .Output("out");
+        if (has_gates) { builder.Input("gates", op.input("gates", 0)); }
+        user_op::UserOpConfWrapper grad_op = builder.Build();
+        op.BindGradTensorWithOpInput(grad_op.output("out", 0), "x", 0);
+        AddOp(grad_op);
+      }
+      if (has_gates && op.NeedGenGradTensor4OpInput("gates", 0)) {
+        user_op::UserOpConfWrapperBuilder builder(op.op_name() + "_gates_grad");
+        user_op::UserOpConfWrapper grad_op =
+            builder.Op("moe_gates_grad")
+                .Input("x", op.input("x", 0))
+                .Input("expert_x", op.GetGradTensorWithOpOutput("out", 0))
+                .Input("expert_ids", op.input("expert_ids", 0))
+                .Input("positions", op.input("positions", 0))
+                .Output("gates_diff")
+                .Build();
+        op.BindGradTensorWithOpInput(grad_op.output("gates_diff", 0), "gates", 0);
+        AddOp(grad_op);
+      }
+      return Maybe<void>::Ok();
+    });
+
+REGISTER_USER_OP_GRAD("moe_combine")
+    .SetGenBackwardOpConfFn([](const user_op::UserOpWrapper& op,
+                               user_op::AddOpFn AddOp) -> Maybe<void> {
+      const bool has_gates = op.input_size("gates") > 0;
+      if (op.NeedGenGradTensor4OpInput("expert_x", 0)) {
+        const Shape& expert_x_shape = op.TensorDesc4ArgNameAndIndex("expert_x", 0).shape();
+        user_op::UserOpConfWrapperBuilder builder(op.op_name() + "_expert_x_grad");
+        builder.Op("moe_dispatch")
+            .Input("x", op.GetGradTensorWithOpOutput("out", 0))
+            .Input("expert_ids", op.input("expert_ids", 0))
+            .Input("positions", op.input("positions", 0))
+            .Output("out")
+            .Attr<int64_t>("num_experts", expert_x_shape.At(0))
+            .Attr<int64_t>("capacity", expert_x_shape.At(1));
+        if (has_gates) { builder.Input("gates", op.input("gates", 0)); }
+        user_op::UserOpConfWrapper grad_op = builder.Build();
+        op.BindGradTensorWithOpInput(grad_op.output("out", 0), "expert_x", 0);
+        AddOp(grad_op);
+      }
+      if (has_gates && op.NeedGenGradTensor4OpInput("gates", 0)) {
+        user_op::UserOpConfWrapperBuilder builder(op.op_name() + "_gates_grad");
+        user_op::UserOpConfWrapper grad_op =
+            builder.Op("moe_gates_grad")
+                .Input("x", op.GetGradTensorWithOpOutput("out", 0))
+                .Input("expert_x", op.input("expert_x", 0))
+                .Input("expert_ids", op.input("expert_ids", 0))
+                .Input("positions", op.input("positions", 0))
+                .Output("gates_diff")
+                .Build();
+        op.BindGradTensorWithOpInput(grad_op.output("gates_diff", 0), "gates", 0);
+        AddOp(grad_op);
+      }
+      return Maybe<void>::Ok();
+    });
+
+}  // namespace oneflow
@@ -223,4 +223,49 @@ REGISTER_NO_GRAD_USER_OP("_nccl_logical_s2s")
     })
     .SetGetSbpFn(user_op::GetSbpFnUtil::DefaultBroadcastToBroadcast);
 
+// matmul whose partial-sum result is all-reduced in row chunks, so that the all-reduce of one
+// chunk overlaps the GEMM of the next. Only created by InsertNcclLogicalOpPass.
+REGISTER_NO_GRAD_USER_OP("_nccl_logical_matmul_all_reduce")
+    .Input("a")
+    .Input("b")
+    .Output("out")
+    .Attr<bool>("transpose_b", false)
+    .Attr<double>("alpha", 1.0)
+    .Attr<int64_t>("chunk_num", 1)
+    .SetLogicalTensorDescInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      const user_op::TensorDesc& a = ctx->InputTensorDesc("a", 0);
+      const user_op::TensorDesc& b = ctx->InputTensorDesc("b", 0);
+      CHECK_EQ_OR_RETURN(a.shape().NumAxes(), 2);
+      CHECK_EQ_OR_RETURN(b.shape().NumAxes(), 2);
+      const bool transpose_b = ctx->Attr<bool>("transpose_b");
+      const int64_t k = a.shape().At(1);
+      CHECK_EQ_OR_RETURN(transpose_b ? b.shape().At(1) : b.shape().At(0), k);
+      const int64_t n = transpose_b ? b.shape().At(0) : b.shape().At(1);
+      CHECK_GE_OR_RETURN(ctx->Attr<int64_t>("chunk_num"), 1);
+      *ctx->OutputShape("out", 0) = Shape({a.shape().At(0), n});
+      *ctx->OutputIsDynamic("out", 0) = false;
+      return Maybe<void>::Ok();
+    })
+    .SetDataTypeInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      CHECK_EQ_OR_RETURN(ctx->InputDType("b", 0), ctx->InputDType("a", 0));
+      *ctx->OutputDType("out", 0) = ctx->InputDType("a", 0);
+      return Maybe<void>::Ok();
+    })
+    .SetParallelDistributionInferFn(
+        [](user_op::InferParallelDistributionFnContext* ctx) -> Maybe<void> {
+          const Shape& parallel_hierarchy = ctx->parallel_hierarchy();
+          CHECK_EQ_OR_RETURN(parallel_hierarchy.NumAxes(), 1);
+          // keep the splits of the matmul this op replaces, the output is reduced to broadcast
+          for (const std::string& ibn : {"a", "b"}) {
+            *ctx->ParallelDistribution4ArgNameAndIndex(ibn, 0) =
+                ctx->ParallelDistributionHint4InputArgNameAndIndex(ibn, 0);
+          }
+          cfg::ParallelDistribution* out_distribution =
+              ctx->ParallelDistribution4ArgNameAndIndex("out", 0);
+          out_distribution->clear_sbp_parallel();
+          out_distribution->add_sbp_parallel()->mutable_broadcast_parallel();
+          return Maybe<void>::Ok();
+        })
+    .SetGetSbpFn(user_op::GetSbpFnUtil::DefaultBroadcastToBroadcast);
+
 }  // namespace oneflow
@@ -0,0 +1,123 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/framework/framework.h"
+
+namespace oneflow {
+
+// Symmetric int8 quantization of the "google" formula, the same rounding as fake_quantization:
+// out = clamp(round(in / scale), -128, 127). scale has one element or one per slice of axis 0.
+REGISTER_NO_GRAD_USER_OP("quantize_int8")
+    .Input("in")
+    .Input("scale")
+    .Output("out")
+    .SetTensorDescInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      const Shape& in_shape = ctx->InputShape("in", 0);
+      const int64_t scale_cnt = ctx->InputShape("scale", 0).elem_cnt();
+      CHECK_OR_RETURN(scale_cnt == 1 || (in_shape.NumAxes() > 0 && scale_cnt == in_shape.At(0)))
+          << "scale of " << scale_cnt << " elements for input of shape " << in_shape.ToString();
+      *ctx->OutputShape("out", 0) = in_shape;
+      *ctx->OutputIsDynamic("out", 0) = ctx->InputIsDynamic("in", 0);
+      return Maybe<void>::Ok();
+    })
+    .SetDataTypeInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      CHECK_EQ_OR_RETURN(ctx->InputDType("in", 0), DataType::kFloat);
+      CHECK_EQ_OR_RETURN(ctx->InputDType("scale", 0), DataType::kFloat);
+      *ctx->OutputDType("out", 0) = DataType::kInt8;
+      return Maybe<void>::Ok();
+    })
+    .SetGetSbpFn([](user_op::SbpContext* ctx) -> Maybe<void> {
+      const Shape& in_shape = ctx->LogicalTensorDesc4InputArgNameAndIndex("in", 0).shape();
+      const bool per_channel =
+          ctx->LogicalTensorDesc4InputArgNameAndIndex("scale", 0).shape().elem_cnt() > 1;
+      FOR_RANGE(int64_t, i, 0, in_shape.NumAxes()) {
+        if (per_channel && i == 0) {
+          ctx->NewBuilder().Split(ctx->inputs(), 0).Split(ctx->outputs(), 0).Build();
+        } else {
+          ctx->NewBuilder()
+              .Split(user_op::OpArg("in", 0), i)
+              .Broadcast(user_op::OpArg("scale", 0))
+              .Split(ctx->outputs(), i)
+              .Build();
+        }
+      }
+      return Maybe<void>::Ok();
+    });
+
+// out = alpha * a_scale * b_scale * (a * b^T) [+ bias] with int8 a of shape (m, k) and int8 b of
+// shape (n, k), accumulated in int32 and dequantized to float by the epilogue. a_scale has one
+// element, b_scale one or n.
+REGISTER_NO_GRAD_USER_OP("quantized_matmul")
+    .Input("a")
+    .Input("b")
+    .Input("a_scale")
+    .Input("b_scale")
+    .OptionalInput("bias")
+    .Output("out")
+    .Attr<double>("alpha", 1.0)
+    .SetTensorDescInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      const Shape& a_shape = ctx->InputShape("a", 0);
+      const Shape& b_shape = ctx->InputShape("b", 0);
+      CHECK_EQ_OR_RETURN(a_shape.NumAxes(), 2);
+      CHECK_EQ_OR_RETURN(b_shape.NumAxes(), 2);
+      CHECK_EQ_OR_RETURN(a_shape.At(1), b_shape.At(1));
+      const int64_t n = b_shape.At(0);
+      CHECK_EQ_OR_RETURN(ctx->InputShape("a_scale", 0).elem_cnt(), 1);
+      const int64_t b_scale_cnt = ctx->InputShape("b_scale", 0).elem_cnt();
+      CHECK_OR_RETURN(b_scale_cnt == 1 || b_scale_cnt == n);
+      if (ctx->has_input("bias", 0)) { CHECK_EQ_OR_RETURN(ctx->InputShape("bias", 0), Shape({n})); }
+      *ctx->OutputShape("out", 0) = Shape({a_shape.At(0), n});
+      *ctx->OutputIsDynamic("out", 0) = ctx->InputIsDynamic("a", 0);
+      return Maybe<void>::Ok();
+    })
+    .SetDataTypeInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      CHECK_EQ_OR_RETURN(ctx->InputDType("a", 0), DataType::kInt8);
+      CHECK_EQ_OR_RETURN(ctx->InputDType("b", 0), DataType::kInt8);
+      CHECK_EQ_OR_RETURN(ctx->InputDType("a_scale", 0), DataType::kFloat);
+      CHECK_EQ_OR_RETURN(ctx->InputDType("b_scale", 0), DataType::kFloat);
+      if (ctx->has_input("bias", 0)) {
+        CHECK_EQ_OR_RETURN(ctx->InputDType("bias", 0), DataType::kFloat);
+      }
+      *ctx->OutputDType("out", 0) = DataType::kFloat;
+      return Maybe<void>::Ok();
+    })
+    .SetGetSbpFn([](user_op::SbpContext* ctx) -> Maybe<void> {
+      std::vector<user_op::OpArg> weight_args{{"b", 0}, {"b_scale", 0}};
+      std::vector<user_op::OpArg> n_split_args{{"b", 0}};
+      std::vector<user_op::OpArg> n_broadcast_args{{"a", 0}, {"a_scale", 0}};
+      if (ctx->LogicalTensorDesc4InputArgNameAndIndex("b_scale", 0).shape().elem_cnt() > 1) {
+        n_split_args.emplace_back("b_scale", 0);
+      } else {
+        n_broadcast_args.emplace_back("b_scale", 0);
+      }
+      if (ctx->user_op_conf().has_input("bias", 0)) {
+        weight_args.emplace_back("bias", 0);
+        n_split_args.emplace_back("bias", 0);
+      }
+      ctx->NewBuilder()
+          .Split(user_op::OpArg("a", 0), 0)
+          .Broadcast(user_op::OpArg("a_scale", 0))
+          .Broadcast(weight_args)
+          .Split(ctx->outputs(), 0)
+          .Build();
+      ctx->NewBuilder()
+          .Broadcast(n_broadcast_args)
+          .Split(n_split_args, 0)
+          .Split(ctx->outputs(), 1)
+          .Build();
+      return Maybe<void>::Ok();
+    });
+
+}  // namespace oneflow
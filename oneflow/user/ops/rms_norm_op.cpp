@@ -0,0 +1,245 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/framework/framework.h"
+
+namespace oneflow {
+
+namespace {
+
+Maybe<int64_t> GetBeginNormAxis(const Shape& x_shape, int64_t begin_norm_axis) {
+  if (begin_norm_axis < 0) { begin_norm_axis += x_shape.NumAxes(); }
+  CHECK_GE_OR_RETURN(begin_norm_axis, 0);
+  CHECK_LT_OR_RETURN(begin_norm_axis, x_shape.NumAxes());
+  return begin_norm_axis;
+}
+
+Shape InferInvRmsShape(const Shape& x_shape, const int64_t begin_norm_axis) {
+  return Shape(DimVector(x_shape.dim_vec().cbegin(), x_shape.dim_vec().cbegin() + begin_norm_axis));
+}
+
+Shape InferWeightShape(const Shape& x_shape, const int64_t begin_norm_axis) {
+  return Shape(DimVector(x_shape.dim_vec().cbegin() + begin_norm_axis, x_shape.dim_vec().cend()));
+}
+
+DataType InferInvRmsDataType(const DataType x_data_type) {
+  return x_data_type == DataType::kFloat16 ? DataType::kFloat : x_data_type;
+}
+
+std::vector<user_op::OpArg> OpArgsIfHasInput(const user_op::UserOpConfWrapper& conf,
+                                             const std::string& arg_name) {
+  if (conf.has_input(arg_name, 0)) { return {{arg_name, 0}}; }
+  return {};
+}
+
+}  // namespace
+
+// y = x / sqrt(mean(x^2) + epsilon) * weight over the axes from begin_norm_axis. With residual,
+// x + residual is normalized instead and also written to add_out, which is the residual stream
+// fed to the next block.
+REGISTER_USER_OP("rms_norm")
+    .Input("x")
+    .OptionalInput("weight")
+    .OptionalInput("residual")
+    .Output("y")
+    .Output("inv_rms")
+    .OptionalOutput("add_out")
+    .Attr<int64_t>("begin_norm_axis")
+    .Attr<double>("epsilon")
+    .SetTensorDescInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      const user_op::TensorDesc& x = ctx->InputTensorDesc("x", 0);
+      const int64_t begin_norm_axis =
+          JUST(GetBeginNormAxis(x.shape(), ctx->Attr<int64_t>("begin_norm_axis")));
+      if (ctx->has_input("weight", 0)) {
+        CHECK_EQ_OR_RETURN(ctx->InputShape("weight", 0),
+                           InferWeightShape(x.shape(), begin_norm_axis));
+      }
+      CHECK_EQ_OR_RETURN(ctx->has_input("residual", 0), ctx->has_output("add_out", 0));
+      if (ctx->has_input("residual", 0)) {
+        CHECK_EQ_OR_RETURN(ctx->InputShape("residual", 0), x.shape());
+        *ctx->OutputShape("add_out", 0) = x.shape();
+        *ctx->OutputIsDynamic("add_out", 0) = x.is_dynamic();
+      }
+      *ctx->OutputShape("y", 0) = x.shape();
+      *ctx->OutputIsDynamic("y", 0) = x.is_dynamic();
+      *ctx->OutputShape("inv_rms", 0) = InferInvRmsShape(x.shape(), begin_norm_axis);
+      return Maybe<void>::Ok();
+    })
+    .SetDataTypeInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      const DataType data_type = ctx->InputDType("x", 0);
+      if (ctx->has_input("weight", 0)) {
+        CHECK_EQ_OR_RETURN(ctx->InputDType("weight", 0), data_type);
+      }
+      if (ctx->has_input("residual", 0)) {
+        CHECK_EQ_OR_RETURN(ctx->InputDType("residual", 0), data_type);
+        *ctx->OutputDType("add_out", 0) = data_type;
+      }
+      *ctx->OutputDType("y", 0) = data_type;
+      *ctx->OutputDType("inv_rms", 0) = InferInvRmsDataType(data_type);
+      return Maybe<void>::Ok();
+    })
+    .SetGetSbpFn([](user_op::SbpContext* ctx) -> Maybe<void> {
+      const Shape& x_shape = ctx->LogicalTensorDesc4InputArgNameAndIndex("x", 0).shape();
+      const int64_t begin_norm_axis =
+          JUST(GetBeginNormAxis(x_shape, ctx->Attr<int64_t>("begin_norm_axis")));
+      for (int64_t i = 0; i < begin_norm_axis; ++i) {
+        ctx->NewBuilder()
+            .Split(user_op::OpArg("x", 0), i)
+            .Split(OpArgsIfHasInput(ctx->user_op_conf(), "residual"), i)
+            .Broadcast(OpArgsIfHasInput(ctx->user_op_conf(), "weight"))
+            .Split(ctx->outputs(), i)
+            .Build();
+      }
+      return Maybe<void>::Ok();
+    });
+
+REGISTER_USER_OP("rms_norm_grad")
+    .Input("dy")
+    .Input("x")
+    .Input("inv_rms")
+    .OptionalInput("weight")
+    .Output("dx")
+    .Attr<int64_t>("begin_norm_axis")
+    .SetTensorDescInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      const user_op::TensorDesc& x = ctx->InputTensorDesc("x", 0);
+      const int64_t begin_norm_axis =
+          JUST(GetBeginNormAxis(x.shape(), ctx->Attr<int64_t>("begin_norm_axis")));
+      CHECK_EQ_OR_RETURN(ctx->InputShape("dy", 0), x.shape());
+      CHECK_EQ_OR_RETURN(ctx->InputShape("inv_rms", 0),
+                         InferInvRmsShape(x.shape(), begin_norm_axis));
+      if (ctx->has_input("weight", 0)) {
+        CHECK_EQ_OR_RETURN(ctx->InputShape("weight", 0),
+                           InferWeightShape(x.shape(), begin_norm_axis));
+      }
+      *ctx->OutputShape("dx", 0) = x.shape();
+      *ctx->OutputIsDynamic("dx", 0) = x.is_dynamic();
+      return Maybe<void>::Ok();
+    })
+    .SetDataTypeInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      const DataType data_type = ctx->InputDType("x", 0);
+      CHECK_EQ_OR_RETURN(ctx->InputDType("dy", 0), data_type);
+      CHECK_EQ_OR_RETURN(ctx->InputDType("inv_rms", 0), InferInvRmsDataType(data_type));
+      if (ctx->has_input("weight", 0)) {
+        CHECK_EQ_OR_RETURN(ctx->InputDType("weight", 0), data_type);
+      }
+      *ctx->OutputDType("dx", 0) = data_type;
+      return Maybe<void>::Ok();
+    })
+    .SetGetSbpFn([](user_op::SbpContext* ctx) -> Maybe<void> {
+      const Shape& x_shape = ctx->LogicalTensorDesc4InputArgNameAndIndex("x", 0).shape();
+      const int64_t begin_norm_axis =
+          JUST(GetBeginNormAxis(x_shape, ctx->Attr<int64_t>("begin_norm_axis")));
+      for (int64_t i = 0; i < begin_norm_axis; ++i) {
+        ctx->NewBuilder()
+            .Split(user_op::OpArg("dy", 0), i)
+            .Split(user_op::OpArg("x", 0), i)
+            .Split(user_op::OpArg("inv_rms", 0), i)
+            .Broadcast(OpArgsIfHasInput(ctx->user_op_conf(), "weight"))
+            .Split(ctx->outputs(), i)
+            .Build();
+      }
+      return Maybe<void>::Ok();
+    });
+
+REGISTER_USER_OP("rms_norm_param_grad")
+    .Input("dy")
+    .Input("x")
+    .Input("inv_rms")
+    .Output("weight_grad")
+    .Attr<int64_t>("begin_norm_axis")
+    .SetTensorDescInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      const user_op::TensorDesc& x = ctx->InputTensorDesc("x", 0);
+      const int64_t begin_norm_axis =
+          JUST(GetBeginNormAxis(x.shape(), ctx->Attr<int64_t>("begin_norm_axis")));
+      CHECK_EQ_OR_RETURN(ctx->InputShape("dy", 0), x.shape());
+      CHECK_EQ_OR_RETURN(ctx->InputShape("inv_rms", 0),
+                         InferInvRmsShape(x.shape(), begin_norm_axis));
+      *ctx->OutputShape("weight_grad", 0) = InferWeightShape(x.shape(), begin_norm_axis);
+      return Maybe<void>::Ok();
+    })
+    .SetDataTypeInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      const DataType data_type = ctx->InputDType("x", 0);
+      CHECK_EQ_OR_RETURN(ctx->InputDType("dy", 0), data_type);
+      CHECK_EQ_OR_RETURN(ctx->InputDType("inv_rms", 0), InferInvRmsDataType(data_type));
+      *ctx->OutputDType("weight_grad", 0) = data_type;
+      return Maybe<void>::Ok();
+    })
+    .SetGetSbpFn([](user_op::SbpContext* ctx) -> Maybe<void> {
+      const Shape& x_shape = ctx->LogicalTensorDesc4InputArgNameAndIndex("x", 0).shape();
+      const int64_t begin_norm_axis =
+          JUST(GetBeginNormAxis(x_shape, ctx->Attr<int64_t>("begin_norm_axis")));
+      for (int64_t i = 0; i < begin_norm_axis; ++i) {
+        ctx->NewBuilder()
+            .Split(ctx->inputs(), i)
+            .PartialSum(user_op::OpArg("weight_grad", 0))
+            .Build();
+      }
+      return Maybe<void>::Ok();
+    });
+
+REGISTER_USER_OP_GRAD("rms_norm")
+    .SetGenBackwardOpConfFn([](const user_op::UserOpWrapper& op,
+                               user_op::AddOpFn AddOp) -> Maybe<void> {
+      const bool has_weight = op.user_op_conf().has_input("weight", 0);
+      const bool has_residual = op.user_op_conf().has_input("residual", 0);
+      const int64_t begin_norm_axis = op.attr<int64_t>("begin_norm_axis");
+      // The normalized tensor is x + residual when a residual is fused in.
+      const std::string normalized_input =
+          has_residual ? op.output("add_out", 0) : op.input("x", 0);
+      if (has_weight && op.NeedGenGradTensor4OpInput("weight", 0)) {
+        user_op::UserOpConfWrapper param_grad_op =
+            user_op::UserOpConfWrapperBuilder(op.op_name() + "_param_grad")
+                .Op("rms_norm_param_grad")
+                .Input("dy", op.GetGradTensorWithOpOutput("y", 0))
+                .Input("x", normalized_input)
+                .Input("inv_rms", op.output("inv_rms", 0))
+                .Output("weight_grad")
+                .Attr("begin_norm_axis", begin_norm_axis)
+                .Build();
+        op.BindGradTensorWithOpInput(param_grad_op.output("weight_grad", 0), "weight", 0);
+        AddOp(param_grad_op);
+      }
+      const bool need_x_grad = op.NeedGenGradTensor4OpInput("x", 0);
+      const bool need_residual_grad = has_residual && op.NeedGenGradTensor4OpInput("residual", 0);
+      if (need_x_grad || need_residual_grad) {
+        user_op::UserOpConfWrapperBuilder builder(op.op_name() + "_grad");
+        builder.Op("rms_norm_grad")
+            .Input("dy", op.GetGradTensorWithOpOutput("y", 0))
+            .Input("x", normalized_input)
+            .Input("inv_rms", op.output("inv_rms", 0))
+            .Output("dx")
+            .Attr("begin_norm_axis", begin_norm_axis);
+        if (has_weight) { builder.Input("weight", op.input("weight", 0)); }
+        user_op::UserOpConfWrapper grad_op = builder.Build();
+        AddOp(grad_op);
+        std::string dx = grad_op.output("dx", 0);
+        if (has_residual && op.HasGradTensor4OpOutput("add_out", 0)) {
+          user_op::UserOpConfWrapper add_op =
+              user_op::UserOpConfWrapperBuilder(op.op_name() + "_add_out_grad")
+                  .Op("add_n")
+                  .Input("in", dx)
+                  .Input("in", op.GetGradTensorWithOpOutput("add_out", 0))
+                  .Output("out")
+                  .Build();
+          AddOp(add_op);
+          dx = add_op.output("out", 0);
+        }
+        if (need_x_grad) { op.BindGradTensorWithOpInput(dx, "x", 0); }
+        if (need_residual_grad) { op.BindGradTensorWithOpInput(dx, "residual", 0); }
+      }
+      return Maybe<void>::Ok();
+    });
+
+}  // namespace oneflow
@@ -0,0 +1,183 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/framework/framework.h"
+
+namespace oneflow {
+
+namespace {
+
+Maybe<void> CheckCuSeqlensShape(user_op::InferContext* ctx, int64_t batch_size) {
+  CHECK_EQ_OR_RETURN(ctx->InputShape("cu_seqlens", 0), Shape({1, batch_size + 1}));
+  return Maybe<void>::Ok();
+}
+
+}  // namespace
+
+// in: (batch_size, max_seq_len, ...) padded, seq_lens: (batch_size,) -> out:
+// (batch_size * max_seq_len, ...) with the valid tokens first, cu_seqlens: (1, batch_size + 1)
+REGISTER_USER_OP("pack_sequence")
+    .Input("in")
+    .Input("seq_lens")
+    .Output("out")
+    .Output("cu_seqlens")
+    .SetTensorDescInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      const Shape& in_shape = ctx->InputShape("in", 0);
+      CHECK_GE_OR_RETURN(in_shape.NumAxes(), 2);
+      const int64_t batch_size = in_shape.At(0);
+      CHECK_EQ_OR_RETURN(ctx->InputShape("seq_lens", 0), Shape({batch_size}));
+      DimVector out_dim_vec = {batch_size * in_shape.At(1)};
+      FOR_RANGE(int64_t, i, 2, in_shape.NumAxes()) { out_dim_vec.push_back(in_shape.At(i)); }
+      *ctx->OutputShape("out", 0) = Shape(out_dim_vec);
+      *ctx->OutputShape("cu_seqlens", 0) = Shape({1, batch_size + 1});
+      return Maybe<void>::Ok();
+    })
+    .SetDataTypeInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      CHECK_EQ_OR_RETURN(ctx->InputDType("seq_lens", 0), DataType::kInt32);
+      *ctx->OutputDType("out", 0) = ctx->InputDType("in", 0);
+      *ctx->OutputDType("cu_seqlens", 0) = DataType::kInt32;
+      return Maybe<void>::Ok();
+    })
+    .SetInputArgModifyFn([](user_op::GetInputArgModifier GetInputArgModifierFn,
+                            const user_op::UserOpConfWrapper&) -> Maybe<void> {
+      user_op::InputArgModifier* seq_lens_modifier = GetInputArgModifierFn("seq_lens", 0);
+      CHECK_OR_RETURN(seq_lens_modifier != nullptr);
+      seq_lens_modifier->set_requires_grad(false);
+      return Maybe<void>::Ok();
+    })
+    .SetGetSbpFn([](user_op::SbpContext* ctx) -> Maybe<void> {
+      // packing mixes the tokens of the whole batch, so only the feature axes can be split
+      const Shape& in_shape = ctx->LogicalTensorDesc4InputArgNameAndIndex("in", 0).shape();
+      FOR_RANGE(int64_t, i, 2, in_shape.NumAxes()) {
+        ctx->NewBuilder()
+            .Split(user_op::OpArg("in", 0), i)
+            .Broadcast(user_op::OpArg("seq_lens", 0))
+            .Split(user_op::OpArg("out", 0), i - 1)
+            .Broadcast(user_op::OpArg("cu_seqlens", 0))
+            .Build();
+      }
+      return Maybe<void>::Ok();
+    });
+
+// in: (batch_size * max_seq_len, ...) packed -> out: (batch_size, max_seq_len, ...) zero padded
+REGISTER_USER_OP("unpack_sequence")
+    .Input("in")
+    .Input("cu_seqlens")
+    .Output("out")
+    .Attr<int64_t>("max_seq_len")
+    .SetTensorDescInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      const Shape& in_shape = ctx->InputShape("in", 0);
+      CHECK_GE_OR_RETURN(in_shape.NumAxes(), 1);
+      const int64_t max_seq_len = ctx->Attr<int64_t>("max_seq_len");
+      CHECK_GT_OR_RETURN(max_seq_len, 0);
+      CHECK_EQ_OR_RETURN(in_shape.At(0) % max_seq_len, 0);
+      const int64_t batch_size = in_shape.At(0) / max_seq_len;
+      JUST(CheckCuSeqlensShape(ctx, batch_size));
+      DimVector out_dim_vec = {batch_size, max_seq_len};
+      FOR_RANGE(int64_t, i, 1, in_shape.NumAxes()) { out_dim_vec.push_back(in_shape.At(i)); }
+      *ctx->OutputShape("out", 0) = Shape(out_dim_vec);
+      return Maybe<void>::Ok();
+    })
+    .SetDataTypeInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      CHECK_EQ_OR_RETURN(ctx->InputDType("cu_seqlens", 0), DataType::kInt32);
+      *ctx->OutputDType("out", 0) = ctx->InputDType("in", 0);
+      return Maybe<void>::Ok();
+    })
+    .SetInputArgModifyFn([](user_op::GetInputArgModifier GetInputArgModifierFn,
+                            const user_op::UserOpConfWrapper&) -> Maybe<void> {
+      user_op::InputArgModifier* cu_seqlens_modifier = GetInputArgModifierFn("cu_seqlens", 0);
+      CHECK_OR_RETURN(cu_seqlens_modifier != nullptr);
+      cu_seqlens_modifier->set_requires_grad(false);
+      return Maybe<void>::Ok();
+    })
+    .SetGetSbpFn([](user_op::SbpContext* ctx) -> Maybe<void> {
+      const Shape& in_shape = ctx->LogicalTensorDesc4InputArgNameAndIndex("in", 0).shape();
+      FOR_RANGE(int64_t, i, 1, in_shape.NumAxes()) {
+        ctx->NewBuilder()
+            .Split(user_op::OpArg("in", 0), i)
+            .Broadcast(user_op::OpArg("cu_seqlens", 0))
+            .Split(user_op::OpArg("out", 0), i + 1)
+            .Build();
+      }
+      return Maybe<void>::Ok();
+    });
+
+// The gradient of unpack_sequence, packing dy by the given cu_seqlens.
+REGISTER_USER_OP("unpack_sequence_grad")
+    .Input("dy")
+    .Input("cu_seqlens")
+    .Output("dx")
+    .SetTensorDescInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      const Shape& dy_shape = ctx->InputShape("dy", 0);
+      CHECK_GE_OR_RETURN(dy_shape.NumAxes(), 2);
+      JUST(CheckCuSeqlensShape(ctx, dy_shape.At(0)));
+      DimVector dx_dim_vec = {dy_shape.At(0) * dy_shape.At(1)};
+      FOR_RANGE(int64_t, i, 2, dy_shape.NumAxes()) { dx_dim_vec.push_back(dy_shape.At(i)); }
+      *ctx->OutputShape("dx", 0) = Shape(dx_dim_vec);
+      return Maybe<void>::Ok();
+    })
+    .SetDataTypeInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      CHECK_EQ_OR_RETURN(ctx->InputDType("cu_seqlens", 0), DataType::kInt32);
+      *ctx->OutputDType("dx", 0) = ctx->InputDType("dy", 0);
+      return Maybe<void>::Ok();
+    })
+    .SetGetSbpFn([](user_op::SbpContext* ctx) -> Maybe<void> {
+      const Shape& dy_shape = ctx->LogicalTensorDesc4InputArgNameAndIndex("dy", 0).shape();
+      FOR_RANGE(int64_t, i, 2, dy_shape.NumAxes()) {
+        ctx->NewBuilder()
+            .Split(user_op::OpArg("dy", 0), i)
+            .Broadcast(user_op::OpArg("cu_seqlens", 0))
+            .Split(user_op::OpArg("dx", 0), i - 1)
+            .Build();
+      }
+      return Maybe<void>::Ok();
+    });
+
+REGISTER_USER_OP_GRAD("pack_sequence")
+    .SetBackwardOpConfGenFn([](user_op::BackwardOpConfContext* ctx) -> Maybe<void> {
+      const std::string op_grad_name = ctx->FwOp().op_name() + "_grad";
+      ctx->DefineOp(op_grad_name, [&ctx](user_op::BackwardOpBuilder& builder) {
+        return builder.OpTypeName("unpack_sequence")
+            .InputBind("in", ctx->FwOp().output_grad("out", 0))
+            .InputBind("cu_seqlens", ctx->FwOp().output("cu_seqlens", 0))
+            .Output("out")
+            .Attr("max_seq_len", ctx->FwOp().arg_tensor_desc("in", 0).shape().At(1))
+            .Build();
+      });
+      ctx->FwOp().InputGradBind(user_op::OpArg("in", 0),
+                                [&ctx, &op_grad_name]() -> const std::string& {
+                                  return ctx->GetOp(op_grad_name).output("out", 0);
+                                });
+      return Maybe<void>::Ok();
+    });
+
+REGISTER_USER_OP_GRAD("unpack_sequence")
+    .SetBackwardOpConfGenFn([](user_op::BackwardOpConfContext* ctx) -> Maybe<void> {
+      const std::string op_grad_name = ctx->FwOp().op_name() + "_grad";
+      ctx->DefineOp(op_grad_name, [&ctx](user_op::BackwardOpBuilder& builder) {
+        return builder.OpTypeName("unpack_sequence_grad")
+            .InputBind("dy", ctx->FwOp().output_grad("out", 0))
+            .InputBind("cu_seqlens", ctx->FwOp().input("cu_seqlens", 0))
+            .Output("dx")
+            .Build();
+      });
+      ctx->FwOp().InputGradBind(user_op::OpArg("in", 0),
+                                [&ctx, &op_grad_name]() -> const std::string& {
+                                  return ctx->GetOp(op_grad_name).output("dx", 0);
+                                });
+      return Maybe<void>::Ok();
+    });
+
+}  // namespace oneflow
@@ -128,6 +128,97 @@ Maybe<void> AddGradMsSignature(user_op::SbpContext* ctx) {
   return Maybe<void>::Ok();
 }
 
+DataType StatDataType4PredictionDataType(DataType prediction_data_type) {
+  return prediction_data_type == DataType::kFloat16 ? DataType::kFloat : prediction_data_type;
+}
+
+Maybe<void> InferMsDeviceStageLogicalTensorDescFn(user_op::InferContext* ctx) {
+  const user_op::TensorDesc& prediction_desc = ctx->InputTensorDesc("prediction", 0);
+  CHECK_GE_OR_RETURN(prediction_desc.shape().NumAxes(), 2);
+  const int64_t class_axis = prediction_desc.shape().NumAxes() - 1;
+  const ParallelDesc& parallel_desc = ctx->parallel_desc();
+  const cfg::ParallelDistribution& prediction_parallel_distribution =
+      ctx->ParallelDistribution4ArgNameAndIndex("prediction", 0);
+  // each device contributes one (max, sum) pair, so the logical class axis holds 2 values per
+  // class split
+  int64_t num_stats = 1;
+  for (int64_t i = 0; i < parallel_desc.hierarchy()->NumAxes(); ++i) {
+    const auto& sbp = prediction_parallel_distribution.sbp_parallel(i);
+    if (sbp.has_split_parallel() && sbp.split_parallel().axis() == class_axis) {
+      num_stats *= parallel_desc.hierarchy()->At(i);
+    }
+  }
+  DimVector dim_vec = prediction_desc.shape().dim_vec();
+  dim_vec.at(class_axis) = 2 * num_stats;
+  *ctx->OutputShape("stat", 0) = Shape(dim_vec);
+  *ctx->OutputIsDynamic("stat", 0) = prediction_desc.is_dynamic();
+  return Maybe<void>::Ok();
+}
+
+Maybe<void> InferMsDeviceStagePhysicalTensorDescFn(user_op::InferContext* ctx) {
+  const user_op::TensorDesc& prediction_desc = ctx->InputTensorDesc("prediction", 0);
+  CHECK_GE_OR_RETURN(prediction_desc.shape().NumAxes(), 2);
+  DimVector dim_vec = prediction_desc.shape().dim_vec();
+  dim_vec.back() = 2;
+  *ctx->OutputShape("stat", 0) = Shape(dim_vec);
+  *ctx->OutputIsDynamic("stat", 0) = prediction_desc.is_dynamic();
+  return Maybe<void>::Ok();
+}
+
+Maybe<void> InferMsDeviceStageDataType(user_op::InferContext* ctx) {
+  *ctx->OutputDType("stat", 0) = StatDataType4PredictionDataType(ctx->InputDType("prediction", 0));
+  return Maybe<void>::Ok();
+}
+
+Maybe<void> GetMsDeviceStageSbpFn(user_op::SbpContext* ctx) {
+  const user_op::TensorDesc& prediction =
+      ctx->LogicalTensorDesc4InputArgNameAndIndex("prediction", 0);
+  FOR_RANGE(int64_t, i, 0, prediction.shape().NumAxes()) {
+    ctx->NewBuilder()
+        .Split(user_op::OpArg("prediction", 0), i)
+        .Split(user_op::OpArg("stat", 0), i)
+        .Build();
+  }
+  return Maybe<void>::Ok();
+}
+
+Maybe<void> InferMsGlobalStageTensorDescFn(user_op::InferContext* ctx) {
+  const user_op::TensorDesc& prediction_desc = ctx->InputTensorDesc("prediction", 0);
+  const user_op::TensorDesc& stat_desc = ctx->InputTensorDesc("stat", 0);
+  CHECK_EQ_OR_RETURN(stat_desc.shape().NumAxes(), prediction_desc.shape().NumAxes());
+  FOR_RANGE(int64_t, i, 0, stat_desc.shape().NumAxes() - 1) {
+    CHECK_EQ_OR_RETURN(stat_desc.shape().At(i), prediction_desc.shape().At(i));
+  }
+  CHECK_EQ_OR_RETURN(stat_desc.shape().dim_vec().back() % 2, 0);
+  return InferTensorDescFn(ctx);
+}
+
+Maybe<void> InferMsGlobalStageDataType(user_op::InferContext* ctx) {
+  CHECK_EQ_OR_RETURN(ctx->InputDType("stat", 0),
+                     StatDataType4PredictionDataType(ctx->InputDType("prediction", 0)));
+  return InferDataType(ctx);
+}
+
+Maybe<void> GetMsGlobalStageSbpFn(user_op::SbpContext* ctx) {
+  const user_op::TensorDesc& prediction =
+      ctx->LogicalTensorDesc4InputArgNameAndIndex("prediction", 0);
+  ctx->NewBuilder()
+      .Split(user_op::OpArg("prediction", 0), 0)
+      .Split(user_op::OpArg("stat", 0), 0)
+      .Split(user_op::OpArg("label", 0), 0)
+      .Split(user_op::OpArg("prob", 0), 0)
+      .Split(user_op::OpArg("out", 0), 0)
+      .Build();
+  ctx->NewBuilder()
+      .Split(user_op::OpArg("prediction", 0), prediction.shape().NumAxes() - 1)
+      .Broadcast(user_op::OpArg("stat", 0))
+      .Broadcast(user_op::OpArg("label", 0))
+      .Split(user_op::OpArg("prob", 0), prediction.shape().NumAxes() - 1)
+      .PartialSum(user_op::OpArg("out", 0))
+      .Build();
+  return Maybe<void>::Ok();
+}
+
 template<Maybe<void> (*GetSbpSignature)(user_op::SbpContext*)>
 Maybe<void> GetSbpFn(user_op::SbpContext* ctx) {
   JUST(GetSbpSignature(ctx));
@@ -190,6 +281,28 @@ REGISTER_SPAESE_SOFTMAX_CROSS_ENTROPY_GRAD_USER_OP("sparse_softmax_cross_entropy
 REGISTER_SPAESE_SOFTMAX_CROSS_ENTROPY_GRAD_USER_OP("sparse_softmax_cross_entropy_ms_grad",
                                                    AddGradMsSignature);
 
+// sparse_softmax_cross_entropy_ms is split into the two ops below by
+// SplitSparseSoftmaxCrossEntropyOpPass after the backward pass has been generated, so they have
+// no grad of their own
+REGISTER_USER_OP("sparse_softmax_cross_entropy_ms_device_stage")
+    .Input("prediction")
+    .Output("stat")
+    .SetLogicalTensorDescInferFn(InferMsDeviceStageLogicalTensorDescFn)
+    .SetPhysicalTensorDescInferFn(InferMsDeviceStagePhysicalTensorDescFn)
+    .SetGetSbpFn(GetMsDeviceStageSbpFn)
+    .SetDataTypeInferFn(InferMsDeviceStageDataType);
+
+REGISTER_USER_OP("sparse_softmax_cross_entropy_ms_global_stage")
+    .Input("prediction")
+    .Input("stat")
+    .Input("label")
+    .Output("prob")
+    .Output("out")
+    .Attr<int64_t>("depth")
+    .SetTensorDescInferFn(InferMsGlobalStageTensorDescFn)
+    .SetGetSbpFn(GetMsGlobalStageSbpFn)
+    .SetDataTypeInferFn(InferMsGlobalStageDataType);
+
 REGISTER_USER_OP_GRAD("sparse_softmax_cross_entropy")
     .SetGenBackwardOpConfFn([](const user_op::UserOpWrapper& op,
                                user_op::AddOpFn AddOp) -> Maybe<void> {
@@ -0,0 +1,83 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/core/framework/framework.h"
+
+namespace oneflow {
+
+// out = x * dequantize(weight)^T [+ bias] with x of shape (..., k) and a quantized weight of
+// shape (n, k). bits is 8 for one int8 per element, or 4 for two elements per int8 with the even
+// element in the low nibble, then weight has shape (n, k / 2). The dequantized weight is
+// weight[j][l] * scale[j][l / group_size], scale has shape (n, k / group_size).
+REGISTER_NO_GRAD_USER_OP("weight_only_quantized_matmul")
+    .Input("x")
+    .Input("weight")
+    .Input("scale")
+    .OptionalInput("bias")
+    .Output("out")
+    .Attr<int32_t>("bits", 8)
+    .Attr<int64_t>("group_size")
+    .SetTensorDescInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      const Shape& x_shape = ctx->InputShape("x", 0);
+      const Shape& weight_shape = ctx->InputShape("weight", 0);
+      const int32_t bits = ctx->Attr<int32_t>("bits");
+      const int64_t group_size = ctx->Attr<int64_t>("group_size");
+      CHECK_OR_RETURN(bits == 8 || bits == 4) << "bits " << bits << " is neither 8 nor 4";
+      CHECK_GE_OR_RETURN(x_shape.NumAxes(), 2);
+      CHECK_EQ_OR_RETURN(weight_shape.NumAxes(), 2);
+      const int64_t k = x_shape.At(x_shape.NumAxes() - 1);
+      const int64_t n = weight_shape.At(0);
+      CHECK_EQ_OR_RETURN(weight_shape.At(1) * (8 / bits), k);
+      // A group never straddles the 4 bytes the GPU kernel loads at a time.
+      CHECK_GT_OR_RETURN(group_size, 0);
+      CHECK_EQ_OR_RETURN(group_size % 8, 0);
+      CHECK_EQ_OR_RETURN(k % group_size, 0);
+      CHECK_EQ_OR_RETURN(ctx->InputShape("scale", 0), Shape({n, k / group_size}));
+      if (ctx->has_input("bias", 0)) { CHECK_EQ_OR_RETURN(ctx->InputShape("bias", 0), Shape({n})); }
+      Shape out_shape = x_shape;
+      out_shape.Set(out_shape.NumAxes() - 1, n);
+      *ctx->OutputShape("out", 0) = out_shape;
+      *ctx->OutputIsDynamic("out", 0) = ctx->InputIsDynamic("x", 0);
+      return Maybe<void>::Ok();
+    })
+    .SetDataTypeInferFn([](user_op::InferContext* ctx) -> Maybe<void> {
+      const DataType data_type = ctx->InputDType("x", 0);
+      CHECK_EQ_OR_RETURN(ctx->InputDType("weight", 0), DataType::kInt8);
+      CHECK_EQ_OR_RETURN(ctx->InputDType("scale", 0), DataType::kFloat);
+      if (ctx->has_input("bias", 0)) { CHECK_EQ_OR_RETURN(ctx->InputDType("bias", 0), data_type); }
+      *ctx->OutputDType("out", 0) = data_type;
+      return Maybe<void>::Ok();
+    })
+    .SetGetSbpFn([](user_op::SbpContext* ctx) -> Maybe<void> {
+      const int64_t num_axes =
+          ctx->LogicalTensorDesc4InputArgNameAndIndex("x", 0).shape().NumAxes();
+      std::vector<user_op::OpArg> weight_args{{"weight", 0}, {"scale", 0}};
+      if (ctx->user_op_conf().has_input("bias", 0)) { weight_args.emplace_back("bias", 0); }
+      for (int64_t i = 0; i < num_axes - 1; ++i) {
+        ctx->NewBuilder()
+            .Split(user_op::OpArg("x", 0), i)
+            .Broadcast(weight_args)
+            .Split(ctx->outputs(), i)
+            .Build();
+      }
+      ctx->NewBuilder()
+          .Broadcast(user_op::OpArg("x", 0))
+          .Split(weight_args, 0)
+          .Split(ctx->outputs(), num_axes - 1)
+          .Build();
+      return Maybe<void>::Ok();
+    });
+
+}  // namespace oneflow
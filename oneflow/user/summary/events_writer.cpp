@@ -26,15 +26,41 @@ EventsWriter::EventsWriter() : is_inited_(false) {}
 EventsWriter::~EventsWriter() { Close(); }
 
 Maybe<void> EventsWriter::Init(const std::string& logdir) {
+  // the writer thread must not touch the file while it is switched
+  if (writer_thread_.joinable()) { Flush(); }
   file_system_ = std::make_unique<fs::PosixFileSystem>();
   log_dir_ = logdir + "/event";
   file_system_->RecursivelyCreateDirIfNotExist(log_dir_);
   JUST(TryToInit());
   is_inited_ = true;
   last_flush_time_ = CurrentMircoTime();
+  if (ParseBooleanFromEnv("ONEFLOW_SUMMARY_ASYNC_WRITE", true) && !writer_thread_.joinable()) {
+    pending_events_.reset(new MpscRingChannel<PendingEvent>(1024));
+    writer_thread_ = std::thread([this]() { WriterLoop(); });
+  }
   return Maybe<void>::Ok();
 }
 
+void EventsWriter::WriterLoop() {
+  std::vector<PendingEvent> batch;
+  while (pending_events_->ReceiveMany(&batch) == kChannelStatusSuccess) {
+    for (const PendingEvent& pending_event : batch) {
+      if (pending_event.event) {
+        AppendEvent(*pending_event.event);
+      } else if (pending_event.make_event) {
+        std::unique_ptr<Event> event = pending_event.make_event();
+        AppendEvent(*event);
+      } else {
+        FileFlush();
+        pending_event.flushed->Decrease();
+      }
+    }
+    batch.clear();
+    FileFlush();
+    last_flush_time_ = CurrentMircoTime();
+  }
+}
+
 Maybe<void> EventsWriter::TryToInit() {
   if (!filename_.empty()) {
     if (!file_system_->FileExists(filename_)) {
@@ -56,12 +82,17 @@ Maybe<void> EventsWriter::TryToInit() {
     event.set_wall_time(current_time);
     event.set_file_version(FILE_VERSION);
     WriteEvent(event);
-    Flush();
   }
   return Maybe<void>::Ok();
 }
 
 void EventsWriter::AppendQueue(std::unique_ptr<Event> event) {
+  if (writer_thread_.joinable()) {
+    PendingEvent pending_event;
+    pending_event.event.reset(event.release());
+    CHECK_EQ(pending_events_->Send(pending_event), kChannelStatusSuccess);
+    return;
+  }
   queue_mutex.lock();
   event_queue_.emplace_back(std::move(event));
   queue_mutex.unlock();
@@ -70,7 +101,24 @@ void EventsWriter::AppendQueue(std::unique_ptr<Event> event) {
   }
 }
 
+void EventsWriter::AppendQueue(const std::function<std::unique_ptr<Event>()>& make_event) {
+  if (writer_thread_.joinable()) {
+    PendingEvent pending_event;
+    pending_event.make_event = make_event;
+    CHECK_EQ(pending_events_->Send(pending_event), kChannelStatusSuccess);
+  } else {
+    AppendQueue(make_event());
+  }
+}
+
 void EventsWriter::Flush() {
+  if (writer_thread_.joinable()) {
+    PendingEvent pending_event;
+    pending_event.flushed.reset(new BlockingCounter(1));
+    CHECK_EQ(pending_events_->Send(pending_event), kChannelStatusSuccess);
+    pending_event.flushed->WaitUntilCntEqualZero();
+    return;
+  }
   queue_mutex.lock();
   for (const std::unique_ptr<Event>& e : event_queue_) { WriteEvent(*e); }
   event_queue_.clear();
@@ -80,6 +128,11 @@ void EventsWriter::Flush() {
 }
 
 void EventsWriter::WriteEvent(const Event& event) {
+  AppendEvent(event);
+  FileFlush();
+}
+
+void EventsWriter::AppendEvent(const Event& event) {
   std::string event_str;
   event.AppendToString(&event_str);
   if (!TryToInit().IsOk()) {
@@ -98,7 +151,6 @@ void EventsWriter::WriteEvent(const Event& event) {
   writable_file_->Append(head, sizeof(head));
   writable_file_->Append(event_str.data(), event_str.size());
   writable_file_->Append(tail, sizeof(tail));
-  FileFlush();
 }
 
 void EventsWriter::FileFlush() {
@@ -108,6 +160,11 @@ void EventsWriter::FileFlush() {
 
 void EventsWriter::Close() {
   if (!is_inited_) { return; }
+  if (writer_thread_.joinable()) {
+    // the writer thread drains the channel before it exits
+    pending_events_->Close();
+    writer_thread_.join();
+  }
   queue_mutex.unlock();
   Flush();
   if (writable_file_ != nullptr) {
@@ -18,6 +18,8 @@ limitations under the License.
 
 #include "oneflow/core/persistence/posix/posix_file_system.h"
 #include "oneflow/core/common/util.h"
+#include "oneflow/core/common/blocking_counter.h"
+#include "oneflow/core/common/mpsc_ring_channel.h"
 #include "oneflow/user/summary/crc32c.h"
 #include "oneflow/core/summary/event.pb.h"
 
@@ -45,10 +47,24 @@ class EventsWriter {
   void Close();
 
   void AppendQueue(std::unique_ptr<Event> event);
+  // `make_event' runs on the writer thread if ONEFLOW_SUMMARY_ASYNC_WRITE is on (the default), so
+  // that the kernels only pay for copying their inputs
+  void AppendQueue(const std::function<std::unique_ptr<Event>()>& make_event);
   void FileFlush();
 
  private:
+  // an event to write, one to make and write, or a flush request if both are empty
+  struct PendingEvent {
+    std::shared_ptr<const Event> event;
+    std::function<std::unique_ptr<Event>()> make_event;
+    std::shared_ptr<BlockingCounter> flushed;
+  };
+
   Maybe<void> TryToInit();
+  void AppendEvent(const Event& event);
+  // Writes the events in batches and flushes the file once a batch is written
+  void WriterLoop();
+
   inline static void EncodeHead(char* head, size_t size);
   inline static void EncodeTail(char* tail, const char* data, size_t size);
 
@@ -60,6 +76,8 @@ class EventsWriter {
   uint64_t last_flush_time_;
   std::vector<std::unique_ptr<Event>> event_queue_;
   std::mutex queue_mutex;
+  std::unique_ptr<MpscRingChannel<PendingEvent>> pending_events_;
+  std::thread writer_thread_;
   OF_DISALLOW_COPY(EventsWriter);
 };
 
@@ -35,6 +35,13 @@ DEFINE_int32(clustering_maximum_nodes, EnvToInt(FLAGS_clustering_maximum_nodes,
              "Maxium nodes of a cluster after clustering.");
 DEFINE_bool(strict_clustering, EnvToBool(FLAGS_strict_clustering, true),
             "Option to clustering with strict dependencies analysis.");
+DEFINE_double(clustering_minimum_interior_bytes_ratio,
+              EnvToDouble(FLAGS_clustering_minimum_interior_bytes_ratio, 0.0),
+              "Minimum ratio of the bytes of blobs inside of a cluster to the bytes of all its "
+              "blobs, the cluster is not compiled below it.");
+DEFINE_int64(clustering_strict_merge_bytes, EnvToInt64(FLAGS_clustering_strict_merge_bytes, -1),
+             "Merge nodes connected by blobs of at least these bytes despite strict clustering, "
+             "negative to disable.");
 
 // DEFINE_string(engine, EnvToString(FLAGS_engine, "XLA"),
 //               "Which third party engine to be used. XLA and TENSORRT are "
@@ -46,6 +53,12 @@ DEFINE_bool(tensorrt_fp16, EnvToBool(FLAGS_tensorrt_fp16, false),
             "Enable fp16 precision for TENSORRT engine.");
 DEFINE_bool(tensorrt_int8, EnvToBool(FLAGS_tensorrt_int8, false),
             "Enable int8 precision for TENSORRT engine.");
+DEFINE_int32(tensorrt_min_batch_size, EnvToInt(FLAGS_tensorrt_min_batch_size, 0),
+             "Build TENSORRT engines taking batch sizes from it to max_batch_size, 0 to build "
+             "one engine per input shape.");
+DEFINE_int32(tensorrt_opt_batch_size, EnvToInt(FLAGS_tensorrt_opt_batch_size, 0),
+             "Batch size TENSORRT engines taking a range of batch sizes are tuned for, 0 for "
+             "max_batch_size.");
 
 DEFINE_string(int8_calibration, EnvToString(FLAGS_int8_calibration, ""),
               "TensorRT int8 calibration table directory. "
@@ -68,11 +81,18 @@ static std::unordered_map<std::string, std::string> user_op_type_name2string_map
     {"tanh_grad", "TanhGrad"},
     {"gelu", "Gelu"},
     {"gelu_grad", "GeluGrad"},
+    {"fused_bias_add_gelu", "FusedBiasAddGelu"},
+    {"fused_bias_add_gelu_grad", "FusedBiasAddGeluGrad"},
+    {"fused_bias_add_mask_scale", "FusedBiasAddMaskScale"},
+    {"dropout", "Dropout"},
+    {"dropout_grad", "DropoutGrad"},
+    {"random_mask_like", "RandomMaskLike"},
     {"sigmoid", "Sigmoid"},
     {"relu", "Relu"},
     {"normalization", "Normalization"},
     {"bias_add", "BiasAdd"},
     {"broadcast_add", "BcastAdd"},
+    {"broadcast_sub", "BcastSub"},
     {"broadcast_mul", "BcastMul"},
     {"broadcast_div", "BcastDiv"},
     {"broadcast_min", "BcastMin"},
@@ -82,6 +102,7 @@ static std::unordered_map<std::string, std::string> user_op_type_name2string_map
     {"multiply", "Multiply"},
     {"add_n", "Add"},
     {"matmul", "MatMul"},
+    {"batch_matmul", "BatchMatMul"},
     {"max_pool_2d", "MaxPooling2D"},
     {"avg_pool_2d", "AveragePooling2D"},
     {"reduce_sum", "ReduceSum"},
@@ -90,10 +111,17 @@ static std::unordered_map<std::string, std::string> user_op_type_name2string_map
     {"reshape_like", "ReshapeLike"},
     {"softmax", "Softmax"},
     {"softmax_grad", "SoftmaxGrad"},
+    {"tril", "Tril"},
+    {"fused_scale_tril", "FusedScaleTril"},
+    {"fused_tril_scale_softmax_mask_scale", "FusedTrilScaleSoftmaxMaskScale"},
+    {"fused_tril_scale_softmax_mask_scale_grad", "FusedTrilScaleSoftmaxMaskScaleGrad"},
     {"top_k", "TopK"},
     {"transpose", "Transpose"},
     {"gather", "Gather"},
+    {"slice", "Slice"},
     {"batch_gather", "BatchGather"},
+    {"unsorted_segment_sum", "UnsortedSegmentSum"},
+    {"unsorted_segment_sum_like", "UnsortedSegmentSumLike"},
     {"layer_norm", "LayerNorm"},
     {"layer_norm_param_grad", "LayerNormParamGrad"},
     {"layer_norm_grad", "LayerNormGrad"},
@@ -210,6 +238,8 @@ XrtPassOptions CreateDefaultXrtPassOptions(bool train_phase) {
   options.minimum_nodes = FLAGS_clustering_minimum_nodes;
   options.maximum_nodes = FLAGS_clustering_maximum_nodes;
   options.strict_clustering = FLAGS_strict_clustering;
+  options.minimum_interior_bytes_ratio = FLAGS_clustering_minimum_interior_bytes_ratio;
+  options.strict_clustering_merge_bytes = FLAGS_clustering_strict_merge_bytes;
 
   options.train_phase = train_phase;
   // TODO(hjchen2)
@@ -37,6 +37,12 @@ const cfg::SbpParallel& BlobSbpPolicy(const OpNode* op_node, const std::string&
   return op_node->SbpParallel4Lbi(lbi);
 }
 
+int64_t BlobBytes(const OpNode* op_node, const std::string& name) {
+  CHECK_NOTNULL(op_node);
+  const BlobDesc& blob_desc = op_node->LogicalBlobDesc4Lbi(BlobNameToId(name));
+  return blob_desc.shape().elem_cnt() * GetSizeOfDataType(blob_desc.data_type());
+}
+
 GraphBuilder::GraphBuilder(const OpGraph* op_graph) : graph_(std::make_shared<XrtGraph>()) {
   op_graph->TopoForEachNode([&](const OpNode* op_node) {
     const Operator* op = &op_node->op();
@@ -131,6 +137,8 @@ void GraphBuilder::SetupGraphEdges() {
     sbp_policy.push_back(BlobSbpPolicy(src, name));
     sbp_policy.push_back(BlobSbpPolicy(dst, name));
     edge->Attr("sbp_policy", sbp_policy);
+    // Set bytes of the logical blob
+    edge->Attr<int64_t>("blob_bytes", BlobBytes(src, name));
   }
 }
 
@@ -31,13 +31,16 @@ size_t SignatureHash::operator()(const Signature& signature) const {
 }
 
 Signature ComputeSignature(const std::string& name, const int device_ordinal,
-                           const std::vector<Parameter>& entry_params) {
+                           const std::vector<Parameter>& entry_params, bool dynamic_batch) {
   Signature signature;
   signature.builder_name = name;
   signature.device_ordinal = device_ordinal;
   signature.entry_shapes.resize(entry_params.size());
   for (int i = 0; i < entry_params.size(); ++i) {
     signature.entry_shapes[i] = entry_params[i].shape();
+    if (dynamic_batch && signature.entry_shapes[i].NumAxes() > 0) {
+      signature.entry_shapes[i].Set(0, -1);
+    }
   }
   return std::move(signature);
 }
@@ -47,7 +50,10 @@ Executable* CompilationCache::GetRecord(const Signature& signature) const {
   // std::shared_lock<std::shared_mutex> lock(mutex_);
   std::lock_guard<std::mutex> lock(mutex_);
   const auto& it = records_.find(signature);
-  if (it != records_.end()) { record = it->second.get(); }
+  if (it != records_.end()) {
+    record = it->second.executable.get();
+    lru_signatures_.splice(lru_signatures_.begin(), lru_signatures_, it->second.lru_it);
+  }
   return record;
 }
 
@@ -55,12 +61,27 @@ void CompilationCache::Record(const Signature& signature,
                               const std::shared_ptr<Executable>& result) {
   // std::unique_lock<std::shared_mutex> lock(mutex_);
   std::lock_guard<std::mutex> lock(mutex_);
-  records_.emplace(signature, result);
+  const auto& it = records_.find(signature);
+  if (it != records_.end()) {
+    it->second.executable = result;
+    lru_signatures_.splice(lru_signatures_.begin(), lru_signatures_, it->second.lru_it);
+    return;
+  }
+  lru_signatures_.push_front(signature);
+  records_.emplace(signature, Entry{result, lru_signatures_.begin()});
+  while (capacity_ > 0 && records_.size() > capacity_) {
+    VLOG(2) << "Release the least recently used executable of "
+            << lru_signatures_.back().builder_name;
+    records_.erase(lru_signatures_.back());
+    lru_signatures_.pop_back();
+  }
 }
 
 void CompilationCache::Release() {
-  util::Map<Signature, std::shared_ptr<Executable>, SignatureHash> empty_records;
+  std::lock_guard<std::mutex> lock(mutex_);
+  util::Map<Signature, Entry, SignatureHash> empty_records;
   records_.swap(empty_records);
+  lru_signatures_.clear();
 }
 
 }  // namespace xrt
@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef ONEFLOW_XRT_COMPILATION_CACHE_H_
 #define ONEFLOW_XRT_COMPILATION_CACHE_H_
 
+#include <list>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -46,11 +47,18 @@ struct SignatureHash {
   size_t operator()(const Signature& signature) const;
 };
 
+// If `dynamic_batch`, the executable takes any batch size and the first dimension of the entry
+// shapes is left out of the signature.
 Signature ComputeSignature(const std::string& name, const int device_ordinal,
-                           const std::vector<xrt::Parameter>& entry_params);
+                           const std::vector<xrt::Parameter>& entry_params,
+                           bool dynamic_batch = false);
 
+// Executables of the recently used signatures. Beyond `capacity` records, 0 for no limit, the
+// least recently used one is released.
 class CompilationCache {
  public:
+  explicit CompilationCache(size_t capacity = 0) : capacity_(capacity) {}
+
   Executable* GetRecord(const Signature& signature) const;
 
   void Record(const Signature& signature, const std::shared_ptr<Executable>& result);
@@ -58,9 +66,17 @@ class CompilationCache {
   void Release();
 
  private:
+  struct Entry {
+    std::shared_ptr<Executable> executable;
+    std::list<Signature>::iterator lru_it;
+  };
+
   // static std::shared_mutex mutex_;
   mutable std::mutex mutex_;
-  util::Map<Signature, std::shared_ptr<Executable>, SignatureHash> records_;
+  size_t capacity_;
+  // The most recently used first.
+  mutable std::list<Signature> lru_signatures_;
+  util::Map<Signature, Entry, SignatureHash> records_;
 };
 
 }  // namespace xrt
@@ -38,6 +38,11 @@ struct ExecutableRunOptions {
   int64_t host_memory_limit = -1;
   int64_t device_memory_limit = -1;
 
+  // Temporary buffer planned by OneFlow for the executable. The engine falls back to its own
+  // memory if it is null or not large enough.
+  void* workspace = nullptr;
+  int64_t workspace_bytes = 0;
+
   // Random seed.
   int64_t random_seed = -1;
 
@@ -52,6 +57,15 @@ struct ExecutableRunOptions {
 
   std::string tensorrt_int8_calibration = "";
 
+  // TensorRT optimization profile of the first dimension of the inputs, the engine takes batch
+  // sizes in [tensorrt_min_batch_size, max_batch_size] if tensorrt_min_batch_size > 0.
+  int32_t tensorrt_min_batch_size = 0;
+  int32_t tensorrt_opt_batch_size = 0;
+
+  // Path prefix to load the serialized TensorRT engine from, or to save it to once built. It is
+  // empty to always build the engine.
+  std::string tensorrt_engine_cache_prefix = "";
+
   // Feed the return parameters to reuse it's storage while running
   // the executable.
   std::vector<Parameter> return_params;
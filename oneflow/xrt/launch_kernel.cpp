@@ -14,6 +14,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 */
 #include "oneflow/xrt/launch_kernel.h"
+#include <sstream>
 #include "oneflow/xrt/api.h"
 #include "oneflow/xrt/compilation_cache.h"
 #include "oneflow/xrt/executable.h"
@@ -27,10 +28,16 @@ DEFINE_int64(max_workspace_bytes, EnvToInt64(FLAGS_max_workspace_bytes, -1),
 // TENSORRT executable setup.
 DEFINE_int32(max_batch_size, EnvToInt(FLAGS_max_batch_size, 1),
              "Maximum batch size for builder of TENSORRT engine.");
+DEFINE_int32(xrt_compilation_cache_capacity, EnvToInt(FLAGS_xrt_compilation_cache_capacity, 16),
+             "Maximum executables kept per launch op, 0 for no limit.");
+DEFINE_string(xrt_compilation_cache_dir, EnvToString(FLAGS_xrt_compilation_cache_dir, ""),
+              "Directory to save built TENSORRT engines to and reuse them from.");
 
 DECLARE_bool(tensorrt_fp16);
 DECLARE_bool(tensorrt_int8);
 DECLARE_string(int8_calibration);
+DECLARE_int32(tensorrt_min_batch_size);
+DECLARE_int32(tensorrt_opt_batch_size);
 
 namespace oneflow {
 namespace xrt {
@@ -38,6 +45,34 @@ static Parameter BuildParameter(const Blob& blob, const std::string& name) {
   const auto& desc = blob.blob_desc();
   return Parameter(name, const_cast<void*>(blob.dptr<void>()), desc.shape(), desc.data_type());
 }
+
+static bool IsTensorRtDynamicBatch(const XrtEngine& engine) {
+  return engine == XrtEngine::TENSORRT && FLAGS_tensorrt_min_batch_size > 0;
+}
+
+// The file of a TensorRT engine is named by what it is built from: the function of the launch op,
+// the entry shapes and the precision and batch options.
+static std::string TensorRtEngineCachePrefix(size_t function_hash, const Signature& signature) {
+  std::ostringstream key;
+  key << function_hash;
+  for (const auto& shape : signature.entry_shapes) { key << shape.ToString(); }
+  key << FLAGS_tensorrt_fp16 << FLAGS_tensorrt_int8 << FLAGS_int8_calibration
+      << FLAGS_max_batch_size << FLAGS_tensorrt_min_batch_size << FLAGS_tensorrt_opt_batch_size;
+  std::ostringstream prefix;
+  prefix << FLAGS_xrt_compilation_cache_dir << "/" << signature.builder_name << "-" << std::hex
+         << std::hash<std::string>()(key.str());
+  return prefix.str();
+}
+
+// Returns the seed of the first random op of the function, or -1 if it has no random op.
+static int64_t FunctionRandomSeed(const XrtLaunchOpConf::Function& function) {
+  for (const auto& node : function.node()) {
+    if (node.has_user_conf() && node.user_conf().op_type_name() == "random_mask_like") {
+      return node.user_conf().attr().at("seed").at_int64();
+    }
+  }
+  return -1;
+}
 }  // namespace xrt
 
 template<DeviceType device_type>
@@ -60,11 +95,14 @@ xrt::Executable* XrtLaunchKernel<device_type>::BuildExecutable(
     const std::vector<xrt::Parameter>& entry_params,
     const std::vector<xrt::Parameter>& return_params,
     const std::vector<xrt::InputOutputAlias>& aliases, const int device_ordinal) const {
-  if (!compilation_cache_) { compilation_cache_.reset(new xrt::CompilationCache); }
+  if (!compilation_cache_) {
+    compilation_cache_.reset(new xrt::CompilationCache(FLAGS_xrt_compilation_cache_capacity));
+  }
 
   xrt::Executable* executable = nullptr;
-  xrt::Signature signature =
-      xrt::ComputeSignature(this->op_conf().name(), device_ordinal, entry_params);
+  const auto& engine = xrt::StringToXrtEngine(this->op_conf().xrt_launch_conf().engine());
+  xrt::Signature signature = xrt::ComputeSignature(
+      this->op_conf().name(), device_ordinal, entry_params, xrt::IsTensorRtDynamicBatch(engine));
   bool force_compile = false;
   if (!force_compile) { executable = compilation_cache_->GetRecord(signature); }
 
@@ -178,6 +216,11 @@ void XrtLaunchKernel<device_type>::ForwardDataContent(
   xrt::ExecutableRunOptions run_options;
   run_options.device_ordinal = device_ordinal;
   run_options.return_params = return_params;
+  if (!this->op_attribute().tmp_bns().empty()) {
+    Blob* workspace = BnInOp2Blob("workspace");
+    run_options.workspace = workspace->mut_dptr();
+    run_options.workspace_bytes = workspace->ByteSizeOfBlobBody();
+  }
   bool block_until_done = true;
   if (device_type == DeviceType::kGPU) {
 #ifdef WITH_CUDA
@@ -194,6 +237,27 @@ void XrtLaunchKernel<device_type>::ForwardDataContent(
     run_options.tensorrt_fp16 = FLAGS_tensorrt_fp16;
     run_options.tensorrt_int8 = FLAGS_tensorrt_int8;
     run_options.tensorrt_int8_calibration = FLAGS_int8_calibration;
+    run_options.tensorrt_min_batch_size = FLAGS_tensorrt_min_batch_size;
+    run_options.tensorrt_opt_batch_size = FLAGS_tensorrt_opt_batch_size;
+    if (!FLAGS_xrt_compilation_cache_dir.empty()) {
+      if (function_hash_ == 0) {
+        function_hash_ = std::hash<std::string>()(
+            this->op_conf().xrt_launch_conf().function().SerializeAsString());
+      }
+      const auto& signature =
+          xrt::ComputeSignature(this->op_conf().name(), device_ordinal, entry_params,
+                                xrt::IsTensorRtDynamicBatch(executable->engine()));
+      run_options.tensorrt_engine_cache_prefix =
+          xrt::TensorRtEngineCachePrefix(function_hash_, signature);
+    }
+  }
+  if (executable->engine() == xrt::XrtEngine::XLA) {
+    // Seed the random ops of the executable deterministically, and differently for each run.
+    if (num_runs_ == 0) {
+      random_seed_ = xrt::FunctionRandomSeed(this->op_conf().xrt_launch_conf().function());
+    }
+    if (random_seed_ >= 0) { run_options.random_seed = random_seed_ + num_runs_; }
+    ++num_runs_;
   }
   bool status = executable->Run(entry_params, run_options, block_until_done);
   CHECK(status) << "Executable is running failed.";
@@ -70,6 +70,11 @@ class XrtLaunchKernel : public KernelIf<device_type> {
  private:
   mutable BlobDescGetter<device_type> desc_getter_;
   mutable std::shared_ptr<xrt::CompilationCache> compilation_cache_;
+  // Hash of the function, the key of the TensorRT engines saved to disk.
+  mutable size_t function_hash_ = 0;
+  // Seed of the random ops of the function and the times it has run, which seed XLA executables.
+  mutable int64_t random_seed_ = -1;
+  mutable int64_t num_runs_ = 0;
 };
 
 }  // namespace oneflow
@@ -17,11 +17,16 @@ limitations under the License.
 #include "oneflow/core/job/sbp_signature_builder.h"
 #include "oneflow/xrt/api.h"
 #include "oneflow/xrt/launch_op.h"
+#include "oneflow/xrt/utility/env.h"
 #include "oneflow/xrt/utility/stl.h"
 
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_split.h"
 
+DEFINE_int64(xrt_launch_workspace_bytes, EnvToInt64(FLAGS_xrt_launch_workspace_bytes, 0),
+             "Temporary buffer bytes planned for each launch op, executables needing more "
+             "allocate from their own memory pool. 0 to plan none.");
+
 namespace oneflow {
 
 Maybe<void> XrtLaunchOp::InitFromOpConf() {
@@ -38,6 +43,18 @@ Maybe<void> XrtLaunchOp::InitFromOpConf() {
     EnrollInputBn(absl::StrCat("in_", i))->set_is_mutable(mutability);
   }
   if (outputs_num > 0) { EnrollRepeatedOutputBn("out"); }
+  if (FLAGS_xrt_launch_workspace_bytes > 0) { EnrollTmpBn("workspace"); }
+  return Maybe<void>::Ok();
+}
+
+Maybe<void> XrtLaunchOp::InferInternalBlobDescs(
+    const std::function<BlobDesc*(const std::string&)>& GetBlobDesc4BnInOp,
+    const ParallelContext* parallel_ctx, const JobDesc* job_desc) const {
+  if (FLAGS_xrt_launch_workspace_bytes > 0) {
+    BlobDesc* workspace = GetBlobDesc4BnInOp("workspace");
+    workspace->set_data_type(DataType::kChar);
+    workspace->mut_shape() = Shape({FLAGS_xrt_launch_workspace_bytes});
+  }
   return Maybe<void>::Ok();
 }
 
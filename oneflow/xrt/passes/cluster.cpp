@@ -129,13 +129,22 @@ class ClusterMergeNode : public ClusterNode {
   std::vector<EdgeSnapshot> snapshot_edges_;
 };
 
+int64_t ClusterNode::BoundaryBytes() const {
+  int64_t bytes = 0;
+  for (const ClusterEdge* edge : in_edges_) { bytes += edge->blob_bytes(); }
+  for (const ClusterEdge* edge : out_edges_) { bytes += edge->blob_bytes(); }
+  return bytes;
+}
+
 void ClusterNode::Merge(ClusterNode& other) {
+  interior_bytes_ += other.interior_bytes_;
   for (ClusterEdge* edge : other.in_edges()) {
     if (edge->start() != this) {
       edge->SetEndNode(this);
       AddInEdge(edge);
     } else {
       EraseOutEdge(edge);
+      interior_bytes_ += edge->blob_bytes();
     }
   }
   for (ClusterEdge* edge : other.out_edges()) {
@@ -144,6 +153,7 @@ void ClusterNode::Merge(ClusterNode& other) {
       AddOutEdge(edge);
     } else {
       EraseInEdge(edge);
+      interior_bytes_ += edge->blob_bytes();
     }
   }
 
@@ -181,6 +191,10 @@ void SetupClusterEdge(ClusterEdge* cluster_edge, const XrtEdge* xrt_edge) {
   const auto& time_shape = xrt_edge->Attr<std::vector<Shape>>("time_shape");
   cluster_edge->set_start_time_shape(time_shape[0]);
   cluster_edge->set_end_time_shape(time_shape[1]);
+
+  if (xrt_edge->HasAttr("blob_bytes")) {
+    cluster_edge->set_blob_bytes(xrt_edge->Attr<int64_t>("blob_bytes"));
+  }
 }
 
 bool IsNodeDirectChildren(const ClusterNode* parent, const ClusterNode* children) {
@@ -190,6 +204,14 @@ bool IsNodeDirectChildren(const ClusterNode* parent, const ClusterNode* children
   return false;
 }
 
+int64_t BytesBetween(const ClusterNode* parent, const ClusterNode* children) {
+  int64_t bytes = 0;
+  for (const ClusterEdge* edge : parent->out_edges()) {
+    if (edge->end() == children) { bytes += edge->blob_bytes(); }
+  }
+  return bytes;
+}
+
 bool IsSatisfyBackend(const ClusterEdge* edge) {
   return edge->start()->device() == edge->end()->device();
 }
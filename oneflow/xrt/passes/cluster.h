@@ -55,6 +55,8 @@ class ClusterEdge {
   Shape end_time_shape() const { return time_shape_[1]; }
   void set_start_time_shape(const Shape& shape) { time_shape_[0] = shape; }
   void set_end_time_shape(const Shape& shape) { time_shape_[1] = shape; }
+  int64_t blob_bytes() const { return is_control_edge_ ? 0 : blob_bytes_; }
+  void set_blob_bytes(int64_t blob_bytes) { blob_bytes_ = blob_bytes; }
 
  protected:
   ClusterNode* start_;
@@ -65,6 +67,7 @@ class ClusterEdge {
   Shape time_shape_[2];
   bool is_control_edge_ = false;
   bool is_fusion_disabled_ = false;
+  int64_t blob_bytes_ = 0;
 };
 
 class ClusterNode {
@@ -121,6 +124,11 @@ class ClusterNode {
   virtual XrtDevice device() const { return xrt_node_->device(); }
 
   size_t size() const { return folded_nodes_.size(); }
+
+  // Bytes of the blobs produced and consumed inside of the cluster, which the engine does not
+  // need to write to memory, and of the blobs it reads and writes across its boundary.
+  int64_t interior_bytes() const { return interior_bytes_; }
+  int64_t BoundaryBytes() const;
   const util::Set<ClusterNode*>& folded_nodes() const { return folded_nodes_; }
   util::Set<ClusterNode*>& folded_nodes() { return folded_nodes_; }
 
@@ -128,6 +136,7 @@ class ClusterNode {
   const XrtNode* xrt_node_;
   int64_t cluster_id_ = -1;
   XrtEngine engine_ = XrtEngine::DEFAULT;
+  int64_t interior_bytes_ = 0;
 
   util::Set<ClusterNode*> folded_nodes_;
   util::Set<ClusterEdge*> in_edges_;
@@ -152,6 +161,9 @@ void SetupClusterEdge(ClusterEdge* cluster_edge, const XrtEdge* xrt_edge);
 
 bool IsNodeDirectChildren(const ClusterNode* parent, const ClusterNode* children);
 
+// Bytes of the blobs from `parent` to `children`.
+int64_t BytesBetween(const ClusterNode* parent, const ClusterNode* children);
+
 bool IsSatisfyBackend(const ClusterEdge* edge);
 bool IsSatisfySbpPolicy(const ClusterEdge* edge);
 bool IsSatisfyTimeShape(const ClusterEdge* edge);
@@ -37,6 +37,7 @@ class MarkClusterIdPass : public XrtPass {
   void RemoveInvalidClusterNodes(const ClusteringOptions& options);
 
   void FinalizeClusterEngine(const ClusteringOptions& options, const XrtEngine& engine);
+  bool IsWorthCompiling(const ClusterNode* node, const ClusteringOptions& options) const;
 
   // Rerank cluster id start by 0.
   void RerankClusterIds();
@@ -126,7 +127,10 @@ void MarkClusterIdPass::ClusteringSubgraphs(const ClusteringOptions& options,
 
 bool MarkClusterIdPass::TryToFuseWithParent(ClusterNode* children, ClusterNode* parent,
                                             const ClusteringOptions& options) {
-  if (options.strict_clustering) {
+  const bool large_boundary = options.strict_clustering_merge_bytes >= 0
+                              && BytesBetween(parent, children)
+                                     >= options.strict_clustering_merge_bytes;
+  if (options.strict_clustering && !large_boundary) {
     // for (const ClusterEdge *edge : children->in_edges()) {
     //   if (edge->start() != parent && !edge->start()->IsReachable(*parent)) {
     //     return false;
@@ -167,13 +171,28 @@ void MarkClusterIdPass::DumpClusterInfoToGraph(XrtGraph* graph) {
   }
 }
 
+bool MarkClusterIdPass::IsWorthCompiling(const ClusterNode* node,
+                                         const ClusteringOptions& options) const {
+  if (options.minimum_interior_bytes_ratio <= 0) { return true; }
+  const int64_t interior_bytes = node->interior_bytes();
+  const int64_t total_bytes = interior_bytes + node->BoundaryBytes();
+  if (total_bytes == 0) { return true; }
+  const double ratio = static_cast<double>(interior_bytes) / total_bytes;
+  if (ratio < options.minimum_interior_bytes_ratio) {
+    VLOG(2) << "Give up cluster of " << node->size() << " nodes including " << node->name()
+            << ", interior bytes " << interior_bytes << " of " << total_bytes;
+    return false;
+  }
+  return true;
+}
+
 void MarkClusterIdPass::FinalizeClusterEngine(const ClusteringOptions& options,
                                               const XrtEngine& engine) {
   const int min_nodes = options.minimum_nodes;
   const int max_nodes = options.maximum_nodes;
   for (ClusterNode* node : root_nodes_) {
     if (node->IsCompiled(engine, options.train_phase) && node->size() >= min_nodes
-        && node->size() <= max_nodes) {
+        && node->size() <= max_nodes && IsWorthCompiling(node, options)) {
       node->set_engine(engine);
     }
   }
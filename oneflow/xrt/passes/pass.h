@@ -41,6 +41,16 @@ struct ClusteringOptions {
   // Option to clustering with strict dependencies analysis.
   bool strict_clustering = true;
 
+  // A cluster is given up if the bytes of the blobs inside of it, which are no longer written to
+  // and read from memory, are less than this ratio of the bytes of all its blobs. Small clusters
+  // between large tensors save few memory traffic but add the boundaries of the engine.
+  double minimum_interior_bytes_ratio = 0.0;
+
+  // Merge a node into its parent despite `strict_clustering` if the blobs between them reach
+  // this many bytes, since materializing them costs more than the delayed execution. Negative to
+  // disable.
+  int64_t strict_clustering_merge_bytes = -1;
+
   // Maximum iteration count for iteratively clustering. You can set it -1 means
   // that it will always iteratively merge nodes as much as possible until no
   // nodes can be merged.
@@ -0,0 +1,46 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/xrt/tensorrt/ops/op_context.h"
+#include "oneflow/xrt/tensorrt/ops/op_kernel.h"
+
+namespace oneflow {
+namespace xrt {
+namespace tensorrt {
+
+class GatherOp : public TrtOpKernel {
+ public:
+  void Compile(TrtOpContext* ctx) override {
+    CHECK_EQ(ctx->InputType("indices_0"), DataType::kInt32)
+        << "TensorRT gather only supports int32 indices.";
+    int64_t axis = ctx->Attr<int64_t>("axis");
+    int num_axes = ctx->InputShape("in_0").NumAxes();
+    if (axis < 0) { axis += num_axes; }
+    CHECK_GE(axis, 0);
+    CHECK_LT(axis, num_axes);
+
+    nvinfer1::ITensor* in = ctx->Input("in_0");
+    nvinfer1::ITensor* indices = ctx->Input("indices_0");
+    auto* layer = ctx->builder()->addGather(*in, *indices, axis);
+    layer->setName(ctx->op_name().c_str());
+    ctx->SetOutput("out_0", layer->getOutput(0));
+  }
+};
+
+REGISTER_TRT_OP_KERNEL(Gather, GatherOp).EnableTrainPhase().Finalize();
+
+}  // namespace tensorrt
+}  // namespace xrt
+}  // namespace oneflow
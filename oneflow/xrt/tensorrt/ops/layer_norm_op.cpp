@@ -0,0 +1,100 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/xrt/tensorrt/ops/op_context.h"
+#include "oneflow/xrt/tensorrt/ops/op_kernel.h"
+
+#include "oneflow/xrt/api.h"
+#include "oneflow/xrt/tensorrt/trt_helpers.h"
+
+namespace oneflow {
+namespace xrt {
+namespace tensorrt {
+
+// Composes layer norm of native layers, so that the whole subgraph can be fused and run in half
+// precision or int8 by the builder instead of falling back to the oneflow kernel.
+class LayerNormOp : public TrtOpKernel {
+ public:
+  void Compile(TrtOpContext* ctx) override {
+    CHECK_EQ(ctx->InputType("x_0"), DataType::kFloat)
+        << "TensorRT layer norm only supports float input.";
+    Shape in_shape = ctx->InputShape("x_0");
+    int num_axes = in_shape.NumAxes();
+    int64_t begin_norm_axis = ctx->Attr<int64_t>("begin_norm_axis");
+    int64_t begin_params_axis = ctx->Attr<int64_t>("begin_params_axis");
+    if (begin_norm_axis < 0) { begin_norm_axis += num_axes; }
+    if (begin_params_axis < 0) { begin_params_axis += num_axes; }
+    CHECK_GE(begin_norm_axis, 1);
+    CHECK_LT(begin_norm_axis, num_axes);
+
+    uint32_t reduce_axes = 0;
+    for (int i = begin_norm_axis; i < num_axes; ++i) { reduce_axes |= (1U << i); }
+
+    TrtBuilder* builder = ctx->builder();
+    nvinfer1::ITensor* in = ctx->Input("x_0");
+    auto* mean = builder->addReduce(*in, nvinfer1::ReduceOperation::kAVG, reduce_axes, true);
+    auto* centered = builder->addElementWise(*in, *mean->getOutput(0),
+                                             nvinfer1::ElementWiseOperation::kSUB);
+    auto* square = builder->addElementWise(*centered->getOutput(0), *centered->getOutput(0),
+                                           nvinfer1::ElementWiseOperation::kPROD);
+    auto* variance = builder->addReduce(*square->getOutput(0), nvinfer1::ReduceOperation::kAVG,
+                                        reduce_axes, true);
+    nvinfer1::ITensor* epsilon =
+        helpers::Scalar(ctx, static_cast<float>(ctx->Attr<double>("epsilon")), num_axes);
+    auto* biased_variance = builder->addElementWise(*variance->getOutput(0), *epsilon,
+                                                    nvinfer1::ElementWiseOperation::kSUM);
+    auto* stddev = builder->addUnary(*biased_variance->getOutput(0),
+                                     nvinfer1::UnaryOperation::kSQRT);
+    auto* normalized = builder->addElementWise(*centered->getOutput(0), *stddev->getOutput(0),
+                                               nvinfer1::ElementWiseOperation::kDIV);
+    normalized->setName(ctx->op_name().c_str());
+    nvinfer1::ITensor* out = normalized->getOutput(0);
+    if (ctx->HasOutput("normalized_0")) { ctx->SetOutput("normalized_0", out); }
+
+    std::vector<int64_t> param_dims(num_axes, 1);
+    for (int i = begin_params_axis; i < num_axes; ++i) { param_dims[i] = in_shape.At(i); }
+    if (ctx->Attr<bool>("scale") && ctx->HasInput("gamma_0")) {
+      nvinfer1::ITensor* gamma = helpers::Reshape(ctx, ctx->Weight("gamma_0"), AsShape(param_dims));
+      out = builder->addElementWise(*out, *gamma, nvinfer1::ElementWiseOperation::kPROD)
+                ->getOutput(0);
+    }
+    if (ctx->Attr<bool>("center") && ctx->HasInput("beta_0")) {
+      nvinfer1::ITensor* beta = helpers::Reshape(ctx, ctx->Weight("beta_0"), AsShape(param_dims));
+      out = builder->addElementWise(*out, *beta, nvinfer1::ElementWiseOperation::kSUM)
+                ->getOutput(0);
+    }
+    ctx->SetOutput("y_0", out);
+
+    // Mean and inv variance are shaped as the leading axes of the input.
+    Shape param_shape(DimVector(in_shape.dim_vec().begin(),
+                                in_shape.dim_vec().begin() + begin_norm_axis));
+    if (ctx->HasOutput("mean_0")) {
+      ctx->SetOutput("mean_0", helpers::Reshape(ctx, mean->getOutput(0), param_shape));
+    }
+    if (ctx->HasOutput("inv_variance_0")) {
+      nvinfer1::ITensor* one = helpers::Scalar(ctx, 1.f, num_axes);
+      auto* inv_variance = builder->addElementWise(*one, *stddev->getOutput(0),
+                                                   nvinfer1::ElementWiseOperation::kDIV);
+      ctx->SetOutput("inv_variance_0",
+                     helpers::Reshape(ctx, inv_variance->getOutput(0), param_shape));
+    }
+  }
+};
+
+REGISTER_TRT_OP_KERNEL(LayerNorm, LayerNormOp).EnableTrainPhase().Finalize();
+
+}  // namespace tensorrt
+}  // namespace xrt
+}  // namespace oneflow
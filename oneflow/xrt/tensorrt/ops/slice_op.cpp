@@ -0,0 +1,69 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include <algorithm>
+
+#include "oneflow/xrt/tensorrt/ops/op_context.h"
+#include "oneflow/xrt/tensorrt/ops/op_kernel.h"
+
+#include "oneflow/xrt/tensorrt/trt_helpers.h"
+
+namespace oneflow {
+namespace xrt {
+namespace tensorrt {
+
+class SliceOp : public TrtOpKernel {
+ public:
+  void Compile(TrtOpContext* ctx) override {
+    Shape in_shape = ctx->SoleInputShape();
+    const auto& start_vec = ctx->Attr<std::vector<int64_t>>("start");
+    const auto& stop_vec = ctx->Attr<std::vector<int64_t>>("stop");
+    const auto& step_vec = ctx->Attr<std::vector<int64_t>>("step");
+    int num_axes = in_shape.NumAxes();
+    CHECK_EQ(start_vec.size(), num_axes);
+    CHECK_EQ(stop_vec.size(), num_axes);
+    CHECK_EQ(step_vec.size(), num_axes);
+
+    nvinfer1::Dims start, size, stride;
+    start.nbDims = size.nbDims = stride.nbDims = num_axes;
+    for (int i = 0; i < num_axes; ++i) {
+      int64_t dim_size = in_shape.At(i);
+      int64_t step = step_vec[i];
+      CHECK_GT(step, 0) << "TensorRT slice only supports positive step.";
+      int64_t begin = start_vec[i] < 0 ? start_vec[i] + dim_size : start_vec[i];
+      int64_t end = stop_vec[i] < 0 ? stop_vec[i] + dim_size : stop_vec[i];
+      begin = std::min(std::max<int64_t>(begin, 0), dim_size);
+      end = std::min(std::max<int64_t>(end, 0), dim_size);
+      CHECK_LT(begin, end);
+      start.d[i] = begin;
+      size.d[i] = (end - begin - 1) / step + 1;
+      stride.d[i] = step;
+    }
+
+    nvinfer1::ITensor* in = ctx->SoleInput();
+    auto* layer = ctx->builder()->addSlice(*in, start, size, stride);
+    layer->setName(ctx->op_name().c_str());
+    // Slicing a 1-d tensor to a single element yields a scalar.
+    nvinfer1::ITensor* out = layer->getOutput(0);
+    if (num_axes == 1 && size.d[0] == 1) { out = helpers::Reshape(ctx, out, Shape(DimVector())); }
+    ctx->SetSoleOutput(out);
+  }
+};
+
+REGISTER_TRT_OP_KERNEL(Slice, SliceOp).EnableTrainPhase().Finalize();
+
+}  // namespace tensorrt
+}  // namespace xrt
+}  // namespace oneflow
@@ -16,8 +16,12 @@ limitations under the License.
 #ifdef WITH_CUDA
 #include "cuda_runtime.h"
 #endif
+#include <gflags/gflags.h>
+#include <cstring>
 #include "oneflow/xrt/tensorrt/trt_builder.h"
 
+DECLARE_int32(tensorrt_min_batch_size);
+
 namespace oneflow {
 namespace xrt {
 namespace tensorrt {
@@ -33,7 +37,10 @@ nvinfer1::ITensor* TrtBuilder::GetTensor(int64_t handle) {
     const char* name = param.name().c_str();
     // Convert data type and shape.
     TrtShape shape(param.shape(), param.data_type());
-    tensor = network_->addInput(name, shape.data_type(), shape.shape());
+    nvinfer1::Dims dims = shape.shape();
+    // The batch size is left to the optimization profile of the engine.
+    if (FLAGS_tensorrt_min_batch_size > 0 && dims.nbDims > 0) { dims.d[0] = -1; }
+    tensor = network_->addInput(name, shape.data_type(), dims);
     tensors_[handle] = tensor;
     value_kinds_[handle] = TrtValueKind::kTensor;
   }
@@ -92,6 +99,21 @@ int64_t TrtBuilder::AddWeight(nvinfer1::Weights& weight) {
   return handle;
 }
 
+nvinfer1::Weights TrtBuilder::AddHostWeight(const std::vector<float>& values) {
+  size_t num_bytes = values.size() * sizeof(float);
+  auto host_data = std::make_shared<std::vector<uint8_t>>(num_bytes);
+  std::memcpy(host_data->data(), values.data(), num_bytes);
+  std::string name = builder_name_ + "-host_weight-" + std::to_string(host_weights_.size());
+  CHECK_EQ(host_weights_.count(name), 0);
+  host_weights_[name] = host_data;
+
+  nvinfer1::Weights weight;
+  weight.type = nvinfer1::DataType::kFLOAT;
+  weight.values = host_data->data();
+  weight.count = values.size();
+  return weight;
+}
+
 nv::unique_ptr<nvinfer1::ICudaEngine> TrtBuilder::BuildCudaEngine() {
   auto build_config = nv::unique_ptr<nvinfer1::IBuilderConfig>(builder_->createBuilderConfig());
   return nv::unique_ptr<nvinfer1::ICudaEngine>(
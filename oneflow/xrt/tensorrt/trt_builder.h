@@ -127,6 +127,10 @@ class TrtBuilder {
   // Returns handle for the added weight.
   int64_t AddWeight(nvinfer1::Weights& weight);
 
+  // Returns float weights whose host memory is owned by the builder, which is used by the
+  // constants created while compiling operators.
+  nvinfer1::Weights AddHostWeight(const std::vector<float>& values);
+
   nv::unique_ptr<nvinfer1::IBuilder> ReleaseBuilder() { return std::move(builder_); }
 
   nv::unique_ptr<nvinfer1::INetworkDefinition> ReleaseNetwork() { return std::move(network_); }
@@ -15,8 +15,13 @@ limitations under the License.
 */
 #include "oneflow/xrt/tensorrt/trt_executable.h"
 #include "oneflow/xrt/tensorrt/trt_int8_calibrator.h"
+#include "oneflow/xrt/tensorrt/trt_logger.h"
+#include "oneflow/xrt/tensorrt/trt_shape.h"
 #include "oneflow/xrt/platform.h"
 
+#include <unistd.h>
+#include <cstdio>
+#include <fstream>
 #include <iostream>
 #include <sstream>
 #include "cuda_runtime.h"
@@ -72,8 +77,55 @@ nvinfer1::ICudaEngine* TrtExecutable::CreateExecutableEngine(
 
   int32_t max_batch_size = std::max(run_options.max_batch_size, batch_size);
   builder_->setMaxBatchSize(max_batch_size);
+  if (run_options.tensorrt_min_batch_size > 0) {
+    const int32_t min_batch_size = run_options.tensorrt_min_batch_size;
+    const int32_t opt_batch_size = run_options.tensorrt_opt_batch_size > 0
+                                       ? run_options.tensorrt_opt_batch_size
+                                       : max_batch_size;
+    CHECK_LE(min_batch_size, opt_batch_size);
+    CHECK_LE(opt_batch_size, max_batch_size);
+    nvinfer1::IOptimizationProfile* profile = builder_->createOptimizationProfile();
+    for (int i = 0; i < network_->getNbInputs(); ++i) {
+      nvinfer1::ITensor* input = network_->getInput(i);
+      nvinfer1::Dims dims = input->getDimensions();
+      if (dims.nbDims == 0) { continue; }
+      dims.d[0] = min_batch_size;
+      profile->setDimensions(input->getName(), nvinfer1::OptProfileSelector::kMIN, dims);
+      dims.d[0] = opt_batch_size;
+      profile->setDimensions(input->getName(), nvinfer1::OptProfileSelector::kOPT, dims);
+      dims.d[0] = max_batch_size;
+      profile->setDimensions(input->getName(), nvinfer1::OptProfileSelector::kMAX, dims);
+    }
+    build_config->addOptimizationProfile(profile);
+  }
+#if NV_TENSORRT_MAJOR >= 8
+  // The tactic timings are kept beside the cached engines, and rebuilding the engines whose
+  // shapes or precisions changed skips the kernels which have been timed.
+  const std::string& cache_prefix = run_options.tensorrt_engine_cache_prefix;
+  nv::unique_ptr<nvinfer1::ITimingCache> timing_cache;
+  if (!cache_prefix.empty()) {
+    std::string data;
+    std::ifstream infile(EngineCacheFile(cache_prefix, ".timing_cache"),
+                         std::ios::in | std::ios::binary);
+    if (infile.good()) {
+      std::stringstream buffer;
+      buffer << infile.rdbuf();
+      data = buffer.str();
+    }
+    timing_cache.reset(build_config->createTimingCache(data.data(), data.size()));
+    build_config->setTimingCache(*timing_cache, false /*ignore mismatch*/);
+  }
+#endif
   // builder_->setGpuAllocator();
-  return builder_->buildEngineWithConfig(*network_, *build_config);
+  nvinfer1::ICudaEngine* engine = builder_->buildEngineWithConfig(*network_, *build_config);
+#if NV_TENSORRT_MAJOR >= 8
+  if (engine && timing_cache) {
+    auto serialized =
+        nv::unique_ptr<nvinfer1::IHostMemory>(build_config->getTimingCache()->serialize());
+    SaveCacheFile(EngineCacheFile(cache_prefix, ".timing_cache"), serialized.get());
+  }
+#endif
+  return engine;
 }
 
 bool TrtExecutable::ExecuteEngine(int batch_size, void** buffers, void* stream,
@@ -91,6 +143,19 @@ bool TrtExecutable::ExecuteEngine(int batch_size, void** buffers, void* stream,
   return status;
 }
 
+void TrtExecutable::SetupExecutionContext(const ExecutableRunOptions& run_options) {
+  if (!execution_context_) {
+    use_planned_workspace_ =
+        run_options.workspace && engine_->getDeviceMemorySize() <= run_options.workspace_bytes;
+    if (use_planned_workspace_) {
+      execution_context_.reset(engine_->createExecutionContextWithoutDeviceMemory());
+    } else {
+      execution_context_.reset(engine_->createExecutionContext());
+    }
+  }
+  if (use_planned_workspace_) { execution_context_->setDeviceMemory(run_options.workspace); }
+}
+
 std::string TrtExecutable::LoadCalibrationTable(  // NOLINT
     const std::string& calibration_path) {
   std::string calib_restore_path(absl::StrCat(calibration_path, "/", this->name()));
@@ -102,6 +167,55 @@ std::string TrtExecutable::LoadCalibrationTable(  // NOLINT
   return std::move(buffer.str());
 }
 
+std::string TrtExecutable::EngineCacheFile(const std::string& prefix,
+                                           const std::string& extension) const {
+  cudaDeviceProp prop;
+  CHECK_EQ(cudaSuccess,
+           cudaGetDeviceProperties(&prop, platform::GetDeviceId(XrtDevice::GPU_CUDA)));
+  return absl::StrCat(prefix, "-sm", prop.major, prop.minor, "-trt", getInferLibVersion(),
+                      extension);
+}
+
+bool TrtExecutable::LoadEngine(const std::string& prefix) {
+  const std::string path = EngineCacheFile(prefix);
+  std::ifstream infile(path, std::ios::in | std::ios::binary);
+  if (!infile.good()) { return false; }
+  std::stringstream buffer;
+  buffer << infile.rdbuf();
+  const std::string data = buffer.str();
+  static nv::Logger logger;
+  if (!runtime_) { runtime_.reset(nvinfer1::createInferRuntime(logger)); }
+  engine_.reset(runtime_->deserializeCudaEngine(data.data(), data.size(), nullptr));
+  if (!engine_) {
+    LOG(WARNING) << "Failed to deserialize TensorRT engine " << path << ", rebuild it.";
+    return false;
+  }
+  VLOG(2) << "Load TensorRT engine " << path;
+  return true;
+}
+
+void TrtExecutable::SaveEngine(const std::string& prefix) const {
+  auto serialized = nv::unique_ptr<nvinfer1::IHostMemory>(engine_->serialize());
+  SaveCacheFile(EngineCacheFile(prefix), serialized.get());
+}
+
+void TrtExecutable::SaveCacheFile(const std::string& path,
+                                  const nvinfer1::IHostMemory* serialized) const {
+  // Written to a temporary file first, a process running the same engine never reads a partial
+  // one.
+  const std::string tmp_path = absl::StrCat(path, ".tmp", getpid());
+  {
+    std::ofstream outfile(tmp_path, std::ios::out | std::ios::binary);
+    if (!outfile.good()) {
+      LOG(WARNING) << "Could not save TensorRT cache to " << path;
+      return;
+    }
+    outfile.write(reinterpret_cast<const char*>(serialized->data()), serialized->size());
+  }
+  CHECK_EQ(std::rename(tmp_path.c_str(), path.c_str()), 0);
+  VLOG(2) << "Save TensorRT cache " << path;
+}
+
 bool TrtExecutable::Run(const std::vector<Parameter>& inputs,
                         const ExecutableRunOptions& run_options,  // NOLINT
                         bool block_until_done) {
@@ -114,9 +228,15 @@ bool TrtExecutable::Run(const std::vector<Parameter>& inputs,
     calibrator_.reset(new TRTInt8Calibrator(calibration_data));
   }
   if (!execution_context_ && !engine_) {
-    engine_.reset(CreateExecutableEngine(run_options, 1 /*batch size*/,  // NOLINT
-                                         calibrator_.get()));
-    CHECK(engine_) << "Cannot create TensorRT executable engine.";
+    // The engines calibrating int8 are not kept.
+    const bool use_engine_cache = !run_options.tensorrt_engine_cache_prefix.empty()
+                                  && !(run_options.tensorrt_int8 && !calibrator_);
+    if (!use_engine_cache || !LoadEngine(run_options.tensorrt_engine_cache_prefix)) {
+      engine_.reset(CreateExecutableEngine(run_options, 1 /*batch size*/,  // NOLINT
+                                           calibrator_.get()));
+      CHECK(engine_) << "Cannot create TensorRT executable engine.";
+      if (use_engine_cache) { SaveEngine(run_options.tensorrt_engine_cache_prefix); }
+    }
   }
 
   // All return params are the results of the executable.
@@ -142,14 +262,19 @@ bool TrtExecutable::Run(const std::vector<Parameter>& inputs,
   }
   // TODO(hjchen2): Check batch size is same for all binding parameters.
   const int batch_size = binding_params[0]->shape().At(0);
-  if (batch_size > engine_->getMaxBatchSize()) {
+  const bool dynamic_batch = run_options.tensorrt_min_batch_size > 0;
+  if (dynamic_batch) {
+    CHECK_GE(batch_size, run_options.tensorrt_min_batch_size);
+    CHECK_LE(batch_size, std::max(run_options.max_batch_size, 1))
+        << "Batch size " << batch_size << " is out of the optimization profile of the engine";
+  } else if (batch_size > engine_->getMaxBatchSize()) {
     LOG(WARNING) << "Rebuild engine since the maximum batch size "  // NOLINT
                  << engine_->getMaxBatchSize()                      // NOLINT
                  << " is less than the input batch size " << batch_size;
     engine_.reset(CreateExecutableEngine(run_options, batch_size,  // NOLINT
                                          calibrator_.get()));
     CHECK(engine_) << "Failed to create engine with batch size " << batch_size;
-    execution_context_.reset(engine_->createExecutionContext());
+    execution_context_.reset();
   }
 
   if (run_options.tensorrt_int8 && !calibrator_) {
@@ -177,11 +302,20 @@ bool TrtExecutable::Run(const std::vector<Parameter>& inputs,
       calibrator_ = res->calibrator_;
       // engine_ = std::move(res->engine_);
       execution_context_.reset(res->engine_->createExecutionContext());
+      use_planned_workspace_ = false;
     } else {
       res->calibrator_->setBatch(binding_params);
     }
   }
 
+  SetupExecutionContext(run_options);
+  if (dynamic_batch) {
+    for (int i = 0; i < num_bindings; ++i) {
+      if (!engine_->bindingIsInput(i)) { continue; }
+      CHECK(execution_context_->setBindingDimensions(
+          i, ShapeToXrtDims(binding_params[i]->shape())));
+    }
+  }
   return ExecuteEngine(batch_size, buffers.data(), run_options.stream,  // NOLINT
                        block_until_done);
 }
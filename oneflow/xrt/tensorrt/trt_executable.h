@@ -60,13 +60,29 @@ class TrtExecutable : public Executable {
 
   bool ExecuteEngine(const int batch_size, void** buffers, void* stream, bool block_until_done);
 
+  // Creates the execution context if it does not exist, whose activation memory is the planned
+  // workspace of `run_options` if it is large enough.
+  void SetupExecutionContext(const ExecutableRunOptions& run_options);
+
   std::string LoadCalibrationTable(const std::string& calibration_path);
 
+  // The engine file of `prefix` is also named by the GPU architecture and the TensorRT version,
+  // the engines of others do not run. The timing cache is named alike with its own extension.
+  std::string EngineCacheFile(const std::string& prefix,
+                              const std::string& extension = ".engine") const;
+  bool LoadEngine(const std::string& prefix);
+  void SaveEngine(const std::string& prefix) const;
+  void SaveCacheFile(const std::string& path, const nvinfer1::IHostMemory* serialized) const;
+
  private:
+  // Deserialized engines are destroyed before their runtime.
+  nv::unique_ptr<nvinfer1::IRuntime> runtime_;
   nv::unique_ptr<nvinfer1::ICudaEngine> engine_;
   nv::unique_ptr<nvinfer1::IBuilder> builder_;
   nv::unique_ptr<nvinfer1::INetworkDefinition> network_;
   nv::unique_ptr<nvinfer1::IExecutionContext> execution_context_;
+  // Whether the execution context runs on the planned workspace instead of its own memory.
+  bool use_planned_workspace_ = false;
 
   std::shared_ptr<TRTInt8Calibrator> calibrator_;
 
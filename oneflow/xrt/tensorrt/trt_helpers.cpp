@@ -69,6 +69,11 @@ nvinfer1::ITensor* Transpose(TrtOpContext* ctx, nvinfer1::Weights in, const Shap
   return layer->getOutput(0);
 }
 
+nvinfer1::ITensor* Scalar(TrtOpContext* ctx, float value, int num_axes) {
+  nvinfer1::Weights weight = ctx->builder()->AddHostWeight({value});
+  return Reshape(ctx, weight, Shape(DimVector(num_axes, 1)));
+}
+
 }  // namespace helpers
 
 }  // namespace tensorrt
@@ -36,6 +36,9 @@ nvinfer1::ITensor* Reshape(TrtOpContext* ctx, nvinfer1::Weights in,  // NOLINT
 nvinfer1::ITensor* Transpose(TrtOpContext* ctx, nvinfer1::ITensor* in,
                              const std::vector<int>& permute);
 
+// Returns a float constant which can be broadcasted to tensors with `num_axes` axes.
+nvinfer1::ITensor* Scalar(TrtOpContext* ctx, float value, int num_axes);
+
 nvinfer1::ITensor* Transpose(TrtOpContext* ctx, nvinfer1::Weights in, const Shape& shape,
                              const std::vector<int>& permute);
 
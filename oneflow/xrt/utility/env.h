@@ -31,4 +31,6 @@ limitations under the License.
 
 #define EnvToInt64(envname, dflt) (!getenv(#envname) ? (dflt) : strtoll(getenv(#envname), NULL, 10))
 
+#define EnvToDouble(envname, dflt) (!getenv(#envname) ? (dflt) : strtod(getenv(#envname), NULL))
+
 #endif  // ONEFLOW_XRT_UTILITY_ENV_H_
@@ -38,24 +38,35 @@ class TanhGradOp : public XlaOpKernel {
 };
 REGISTER_XLA_OP_KERNEL(TanhGrad, TanhGradOp).Finalize();
 
+xla::XlaOp GeluGrad(const xla::XlaOp& x, const xla::XlaOp& dy) {
+  xla::XlaOp dot_5 = xla::ScalarLike(x, 0.5f);
+  xla::XlaOp inv_sqrt2 = xla::ScalarLike(x, std::sqrt(0.5f));
+  xla::XlaOp one = xla::ScalarLike(x, 1.f);
+
+  xla::XlaOp coef = xla::ScalarLike(x, std::sqrt(2.f / std::acos(-1.f)));
+  // coef = 1 + erf(sqrt(0.5) * x) + x * coef * exp(-0.5 * x * x)
+  coef = one + xla::Erf(inv_sqrt2 * x) + (x * coef * xla::Exp(xla::Neg(dot_5) * x * x));
+  return dot_5 * coef * dy;
+}
+
 class GeluGradOp : public XlaOpKernel {
  public:
   void Compile(XlaOpContext* ctx) override {
-    xla::XlaOp x = ctx->Input("x_0");
-    xla::XlaOp dy = ctx->Input("dy_0");
-    xla::XlaOp dot_5 = xla::ScalarLike(x, 0.5f);
-    xla::XlaOp inv_sqrt2 = xla::ScalarLike(x, std::sqrt(0.5f));
-    xla::XlaOp one = xla::ScalarLike(x, 1.f);
-
-    xla::XlaOp coef = xla::ScalarLike(x, std::sqrt(2.f / std::acos(-1.f)));
-    // coef = 1 + erf(sqrt(0.5) * x) + x * coef * exp(-0.5 * x * x)
-    coef = one + xla::Erf(inv_sqrt2 * x) + (x * coef * xla::Exp(xla::Neg(dot_5) * x * x));
-
-    ctx->SetOutput("dx_0", dot_5 * coef * dy);
+    ctx->SetOutput("dx_0", GeluGrad(ctx->Input("x_0"), ctx->Input("dy_0")));
   }
 };
 REGISTER_XLA_OP_KERNEL(GeluGrad, GeluGradOp).Finalize();
 
+class FusedBiasAddGeluGradOp : public XlaOpKernel {
+ public:
+  void Compile(XlaOpContext* ctx) override {
+    int axis = ctx->Attr<int32_t>("axis");
+    xla::XlaOp x = xla::Add(ctx->Input("a_0"), ctx->Input("b_0"), {axis});
+    ctx->SetOutput("dx_0", GeluGrad(x, ctx->Input("dy_0")));
+  }
+};
+REGISTER_XLA_OP_KERNEL(FusedBiasAddGeluGrad, FusedBiasAddGeluGradOp).Finalize();
+
 }  // namespace mola
 }  // namespace xrt
 }  // namespace oneflow
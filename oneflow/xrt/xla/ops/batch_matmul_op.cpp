@@ -15,6 +15,7 @@ limitations under the License.
 */
 #include "oneflow/xrt/xla/ops/op_context.h"
 #include "oneflow/xrt/xla/ops/op_kernel.h"
+#include "tensorflow/compiler/xla/client/lib/constants.h"
 #include "tensorflow/compiler/xla/client/lib/matrix.h"
 #include "tensorflow/compiler/xla/client/xla_builder.h"
 
@@ -55,6 +56,8 @@ class BatchMatMulOp : public XlaOpKernel {
     // ctx->SetOutput("out", xla::BatchDot(lhs, rhs));
 
     xla::XlaOp out = xla::BatchDot(a, transpose_a, b, transpose_b);
+    double alpha = ctx->Attr<double>("alpha");
+    if (alpha != 1.0) { out = xla::Mul(out, xla::ScalarLike(out, alpha)); }
     if (ctx->HasInput("_add_to_output_0")) { out = xla::Add(out, ctx->Input("_add_to_output_0")); }
     ctx->SetOutput("out_0", out);
   }
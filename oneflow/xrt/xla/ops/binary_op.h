@@ -29,6 +29,7 @@ namespace op {
   };
 
 OFXLA_DECLARE_BINARY_OP(Add);
+OFXLA_DECLARE_BINARY_OP(Sub);
 OFXLA_DECLARE_BINARY_OP(Mul);
 OFXLA_DECLARE_BINARY_OP(Div);
 OFXLA_DECLARE_BINARY_OP(Min);
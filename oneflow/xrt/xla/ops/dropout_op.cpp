@@ -0,0 +1,89 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/xrt/xla/ops/op_context.h"
+#include "oneflow/xrt/xla/ops/op_kernel.h"
+#include "tensorflow/compiler/xla/client/lib/constants.h"
+#include "tensorflow/compiler/xla/client/xla_builder.h"
+
+#include "oneflow/xrt/xla/xla_data_type.h"
+#include "oneflow/xrt/xla/xla_helpers.h"
+#include "oneflow/xrt/xla/xla_shape.h"
+
+namespace oneflow {
+namespace xrt {
+namespace mola {
+
+// Returns in * mask * scale
+xla::XlaOp MaskAndScale(XlaOpContext* ctx, const xla::XlaOp& in, const DataType& data_type) {
+  xla::PrimitiveType type = DataTypeToPrimitiveType(data_type);
+  xla::XlaOp mask = xla::ConvertElementType(ctx->Input("mask_0"), type);
+  xla::XlaOp scale = FloatLiteral(ctx->builder(), data_type, ctx->Attr<float>("scale"));
+  return xla::Mul(xla::Mul(in, mask), scale);
+}
+
+class DropoutOp : public XlaOpKernel {
+ public:
+  void Compile(XlaOpContext* ctx) override {
+    xla::XlaOp out = MaskAndScale(ctx, ctx->Input("in_0"), ctx->InputType("in_0"));
+    if (ctx->HasInput("_add_to_output_0")) { out = xla::Add(out, ctx->Input("_add_to_output_0")); }
+    ctx->SetOutput("out_0", out);
+  }
+};
+
+class DropoutGradOp : public XlaOpKernel {
+ public:
+  void Compile(XlaOpContext* ctx) override {
+    ctx->SetOutput("dx_0", MaskAndScale(ctx, ctx->Input("dy_0"), ctx->InputType("dy_0")));
+  }
+};
+
+class FusedBiasAddMaskScaleOp : public XlaOpKernel {
+ public:
+  void Compile(XlaOpContext* ctx) override {
+    int axis = ctx->Attr<int32_t>("axis");
+    xla::XlaOp in = xla::Add(ctx->Input("a_0"), ctx->Input("b_0"), {axis});
+    xla::XlaOp out = MaskAndScale(ctx, in, ctx->InputType("a_0"));
+    if (ctx->HasInput("_add_to_output_0")) { out = xla::Add(out, ctx->Input("_add_to_output_0")); }
+    ctx->SetOutput("out_0", out);
+  }
+};
+
+// The mask is drawn from the random number generator of the XLA executable, which is seeded
+// for each run by the launch kernel from the `seed` attribute, so it does not reproduce the
+// bits of the native kernel but is deterministic for a given seed.
+class RandomMaskLikeOp : public XlaOpKernel {
+ public:
+  void Compile(XlaOpContext* ctx) override {
+    xla::XlaBuilder* builder = ctx->builder();
+    Shape like_shape = ctx->InputShape("like_0");
+    float rate = ctx->Attr<float>("rate");
+    xla::XlaOp random =
+        xla::RngUniform(xla::ConstantR0<float>(builder, 0.f), xla::ConstantR0<float>(builder, 1.f),
+                        OfShapeToXlaShape(like_shape, DataType::kFloat));
+    // mask = random > rate
+    xla::XlaOp mask = xla::Gt(random, xla::ConstantR0<float>(builder, rate));
+    ctx->SetOutput("out_0", xla::ConvertElementType(mask, xla::S8));
+  }
+};
+
+REGISTER_XLA_OP_KERNEL(Dropout, DropoutOp).Finalize();
+REGISTER_XLA_OP_KERNEL(DropoutGrad, DropoutGradOp).Finalize();
+REGISTER_XLA_OP_KERNEL(FusedBiasAddMaskScale, FusedBiasAddMaskScaleOp).Finalize();
+REGISTER_XLA_OP_KERNEL(RandomMaskLike, RandomMaskLikeOp).Finalize();
+
+}  // namespace mola
+}  // namespace xrt
+}  // namespace oneflow
@@ -162,8 +162,45 @@ class BatchGatherOp : public GatherOp {
   }
 };
 
+// The gradient of gather, which accumulates `data` into the rows `segment_ids` of `axis` of
+// the output. The segment axis is moved to the front so that the scatter only indexes the
+// leading dimension.
+class UnsortedSegmentSumOp : public XlaOpKernel {
+ public:
+  void Compile(XlaOpContext* ctx) override {
+    Shape data_shape = ctx->InputShape("data_0");
+    Shape indices_shape = ctx->InputShape("segment_ids_0");
+    Shape out_shape = ctx->OutputShape("out_0");
+    DataType data_type = ctx->InputType("data_0");
+    int64_t axis = ctx->Attr<int64_t>("axis");
+    int64_t num_indices_axes = indices_shape.NumAxes();
+
+    std::vector<long long> data_permute, out_permute, out_inverse_permute;
+    for (int64_t i = 0; i < num_indices_axes; ++i) { data_permute.push_back(axis + i); }
+    for (int64_t i = 0; i < data_shape.NumAxes(); ++i) {
+      if (i < axis || i >= axis + num_indices_axes) { data_permute.push_back(i); }
+    }
+    out_permute.push_back(axis);
+    for (int64_t i = 0; i < out_shape.NumAxes(); ++i) {
+      if (i != axis) { out_permute.push_back(i); }
+    }
+    out_inverse_permute.resize(out_permute.size());
+    for (int64_t i = 0; i < out_permute.size(); ++i) { out_inverse_permute[out_permute[i]] = i; }
+
+    xla::XlaBuilder* builder = ctx->builder();
+    xla::XlaOp data = xla::Transpose(ctx->Input("data_0"), data_permute);
+    xla::XlaOp buffer = xla::Transpose(Zeros(builder, out_shape, data_type), out_permute);
+    xla::XlaOp out = GenericGatherGrad(
+        buffer, data, ctx->Input("segment_ids_0"), /*indices_are_vectors=*/false,
+        [](xla::XlaOp x, xla::XlaOp y, xla::XlaBuilder*) { return xla::Add(x, y); }, builder);
+    ctx->SetOutput("out_0", xla::Transpose(out, out_inverse_permute));
+  }
+};
+
 REGISTER_XLA_OP_KERNEL(Gather, GatherOp).Finalize();
 REGISTER_XLA_OP_KERNEL(BatchGather, BatchGatherOp).Finalize();
+REGISTER_XLA_OP_KERNEL(UnsortedSegmentSum, UnsortedSegmentSumOp).Finalize();
+REGISTER_XLA_OP_KERNEL(UnsortedSegmentSumLike, UnsortedSegmentSumOp).Finalize();
 
 }  // namespace mola
 }  // namespace xrt
@@ -15,6 +15,7 @@ limitations under the License.
 */
 #include "oneflow/xrt/xla/ops/op_context.h"
 #include "oneflow/xrt/xla/ops/op_kernel.h"
+#include "tensorflow/compiler/xla/client/lib/constants.h"
 #include "tensorflow/compiler/xla/client/xla_builder.h"
 
 namespace oneflow {
@@ -44,6 +45,8 @@ class MatMulOp : public XlaOpKernel {
     auto lhs = transpose_a ? xla::Transpose(a, {1, 0}) : a;
     auto rhs = transpose_b ? xla::Transpose(b, {1, 0}) : b;
     xla::XlaOp out = xla::Dot(lhs, rhs);
+    double alpha = ctx->Attr<double>("alpha");
+    if (alpha != 1.0) { out = xla::Mul(out, xla::ScalarLike(out, alpha)); }
     if (ctx->HasInput("_add_to_output_0")) { out = xla::Add(out, ctx->Input("_add_to_output_0")); }
     ctx->SetOutput("out_0", out);
   }
@@ -0,0 +1,145 @@
+/*
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "oneflow/xrt/xla/ops/op_context.h"
+#include "oneflow/xrt/xla/ops/op_kernel.h"
+#include "tensorflow/compiler/xla/client/lib/constants.h"
+#include "tensorflow/compiler/xla/client/xla_builder.h"
+
+#include "oneflow/xrt/xla/xla_data_type.h"
+#include "oneflow/xrt/xla/xla_helpers.h"
+#include "oneflow/xrt/xla/xla_shape.h"
+
+namespace oneflow {
+namespace xrt {
+namespace mola {
+
+// Keeps the elements of the lower triangle of the last two dimensions, which are
+// `col <= row + diagonal`, and replaces the others with `fill`.
+xla::XlaOp LowerTriangle(xla::XlaBuilder* builder, const xla::XlaOp& x, const Shape& shape,
+                         int64_t diagonal, const xla::XlaOp& fill) {
+  int axes = shape.NumAxes();
+  CHECK_GE(axes, 2);
+  xla::Shape iota_shape = OfShapeToXlaShape(shape, xla::S32);
+  xla::XlaOp rows = xla::Iota(builder, iota_shape, axes - 2);
+  xla::XlaOp cols = xla::Iota(builder, iota_shape, axes - 1);
+  xla::XlaOp keep = xla::Le(cols, xla::Add(rows, xla::ConstantR0<int32_t>(builder, diagonal)));
+  return xla::Select(keep, x, xla::Broadcast(fill, xla::AsInt64Slice(iota_shape.dimensions())));
+}
+
+xla::XlaOp TrilFillValue(XlaOpContext* ctx, const DataType& data_type) {
+  if (ctx->Attr<bool>("is_floating_fill_value")) {
+    return FloatLiteral(ctx->builder(), data_type, ctx->Attr<double>("floating_fill_value"));
+  }
+  return IntegerLiteral(ctx->builder(), data_type, ctx->Attr<int64_t>("integer_fill_value"));
+}
+
+class TrilOp : public XlaOpKernel {
+ public:
+  void Compile(XlaOpContext* ctx) override {
+    DataType data_type = ctx->InputType("in_0");
+    xla::XlaOp in = ctx->Input("in_0");
+    if (HasScale()) {
+      xla::XlaOp scale =
+          ctx->Attr<bool>("is_floating_scale_value")
+              ? FloatLiteral(ctx->builder(), data_type, ctx->Attr<double>("floating_scale_value"))
+              : IntegerLiteral(ctx->builder(), data_type,
+                               ctx->Attr<int64_t>("integer_scale_value"));
+      in = xla::Mul(in, scale);
+    }
+    ctx->SetOutput("out_0", LowerTriangle(ctx->builder(), in, ctx->InputShape("in_0"),
+                                          ctx->Attr<int64_t>("diagonal"),
+                                          TrilFillValue(ctx, data_type)));
+  }
+
+  virtual bool HasScale() const { return false; }
+};
+
+class FusedScaleTrilOp : public TrilOp {
+ public:
+  bool HasScale() const override { return true; }
+};
+
+// Softmax along the last dimension.
+xla::XlaOp LastDimSoftmax(xla::XlaBuilder* builder, const xla::XlaOp& x, int axes,
+                          const DataType& data_type) {
+  int axis = axes - 1;
+  std::vector<long long> batch_dims(axis);
+  for (int i = 0; i < axis; ++i) { batch_dims[i] = i; }
+  xla::XlaOp max = xla::Reduce(x, MinValue(builder, data_type), CreateMaxFunc(data_type), {axis});
+  xla::XlaOp y = xla::Exp(xla::Sub(x, max, batch_dims));
+  xla::XlaOp sum = xla::Reduce(y, Zero(builder, data_type), CreateAddFunc(data_type), {axis});
+  return xla::Div(y, sum, batch_dims);
+}
+
+// softmax_y = softmax(tril(x * tril_scale, fill = tril_fill_value))
+// y = softmax_y * mask * mask_scale
+class FusedTrilScaleSoftmaxMaskScaleOp : public XlaOpKernel {
+ public:
+  void Compile(XlaOpContext* ctx) override {
+    xla::XlaBuilder* builder = ctx->builder();
+    Shape shape = ctx->InputShape("x_0");
+    DataType data_type = ctx->InputType("x_0");
+    xla::XlaOp x = xla::Mul(ctx->Input("x_0"),
+                            FloatLiteral(builder, data_type, ctx->Attr<float>("tril_scale_value")));
+    x = LowerTriangle(builder, x, shape, ctx->Attr<int64_t>("diagonal"),
+                      FloatLiteral(builder, data_type, ctx->Attr<float>("tril_fill_value")));
+    xla::XlaOp softmax_y = LastDimSoftmax(builder, x, shape.NumAxes(), data_type);
+
+    xla::XlaOp mask =
+        xla::ConvertElementType(ctx->Input("mask_0"), DataTypeToPrimitiveType(data_type));
+    xla::XlaOp mask_scale = FloatLiteral(builder, data_type, ctx->Attr<float>("mask_scale_value"));
+    ctx->SetOutput("softmax_y_0", softmax_y);
+    ctx->SetOutput("y_0", xla::Mul(xla::Mul(softmax_y, mask), mask_scale));
+  }
+};
+
+// dsoftmax = dy * mask * mask_scale
+// dx = tril(softmax_y * (dsoftmax - sum(dsoftmax * softmax_y)), fill = 0) * tril_scale
+class FusedTrilScaleSoftmaxMaskScaleGradOp : public XlaOpKernel {
+ public:
+  void Compile(XlaOpContext* ctx) override {
+    xla::XlaBuilder* builder = ctx->builder();
+    Shape shape = ctx->InputShape("dy_0");
+    DataType data_type = ctx->InputType("dy_0");
+    int axis = shape.NumAxes() - 1;
+    std::vector<long long> batch_dims(axis);
+    for (int i = 0; i < axis; ++i) { batch_dims[i] = i; }
+
+    xla::XlaOp softmax_y = ctx->Input("softmax_y_0");
+    xla::XlaOp mask =
+        xla::ConvertElementType(ctx->Input("mask_0"), DataTypeToPrimitiveType(data_type));
+    xla::XlaOp mask_scale = FloatLiteral(builder, data_type, ctx->Attr<float>("mask_scale_value"));
+    xla::XlaOp dsoftmax = xla::Mul(xla::Mul(ctx->Input("dy_0"), mask), mask_scale);
+
+    xla::XlaOp sum = xla::Reduce(xla::Mul(dsoftmax, softmax_y), Zero(builder, data_type),
+                                 CreateAddFunc(data_type), {axis});
+    xla::XlaOp dx = xla::Mul(softmax_y, xla::Sub(dsoftmax, sum, batch_dims));
+    dx = xla::Mul(dx, FloatLiteral(builder, data_type, ctx->Attr<float>("tril_scale_value")));
+    ctx->SetOutput("dx_0", LowerTriangle(builder, dx, shape, ctx->Attr<int64_t>("diagonal"),
+                                         Zero(builder, data_type)));
+  }
+};
+
+REGISTER_XLA_OP_KERNEL(Tril, TrilOp).Finalize();
+REGISTER_XLA_OP_KERNEL(FusedScaleTril, FusedScaleTrilOp).Finalize();
+REGISTER_XLA_OP_KERNEL(FusedTrilScaleSoftmaxMaskScale, FusedTrilScaleSoftmaxMaskScaleOp)
+    .Finalize();
+REGISTER_XLA_OP_KERNEL(FusedTrilScaleSoftmaxMaskScaleGrad, FusedTrilScaleSoftmaxMaskScaleGradOp)
+    .Finalize();
+
+}  // namespace mola
+}  // namespace xrt
+}  // namespace oneflow
@@ -48,6 +48,16 @@ REGISTER_XLA_OP_KERNEL(Tanh, ApplyUnaryOp<op::Tanh>).Finalize();
 REGISTER_XLA_OP_KERNEL(Gelu, ApplyUnaryOp<Gelu>).Finalize();
 REGISTER_XLA_OP_KERNEL(Rsqrt, ApplyUnaryOp<op::Rsqrt>).Finalize();
 
+class FusedBiasAddGeluOp : public XlaOpKernel {
+ public:
+  void Compile(XlaOpContext* ctx) override {
+    int axis = ctx->Attr<int32_t>("axis");
+    ctx->SetOutput("out_0", Gelu()(xla::Add(ctx->Input("a_0"), ctx->Input("b_0"), {axis})));
+  }
+};
+
+REGISTER_XLA_OP_KERNEL(FusedBiasAddGelu, FusedBiasAddGeluOp).Finalize();
+
 struct Identity {
   xla::XlaOp operator()(const xla::XlaOp& x) { return x; }
 };
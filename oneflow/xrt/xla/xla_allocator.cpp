@@ -47,7 +47,12 @@ xla::StatusOr<se::OwningDeviceMemory> XlaAllocator::Allocate(int device_ordinal,
   } else {
     void* data = nullptr;
     if (size != 0) {
-      data = allocator_->AllocateRaw(allocate_offset_, size);
+      if (planned_workspace_) {
+        CHECK_LE(allocate_offset_ + size, planned_workspace_bytes_);
+        data = planned_workspace_ + allocate_offset_;
+      } else {
+        data = allocator_->AllocateRaw(allocate_offset_, size);
+      }
       allocate_offset_ += Align(64 /*alignment*/, size);
     }
     memory_base = se::DeviceMemoryBase(data, size);
@@ -74,6 +79,11 @@ void XlaAllocator::ReserveWorkspace(size_t workspace_bytes) {
   allocator_->Reserve(workspace_bytes);
 }
 
+void XlaAllocator::UsePlannedWorkspace(void* workspace, int64_t workspace_bytes) {
+  planned_workspace_ = reinterpret_cast<char*>(workspace);
+  planned_workspace_bytes_ = workspace_bytes;
+}
+
 void XlaAllocator::PopulateDeviceMemory(const std::vector<se::DeviceMemoryBase>& device_buffers,
                                         const std::vector<int64_t>& allocation_indices) {
   int64_t max_populated_index = 0;
@@ -50,6 +50,9 @@ class XlaAllocator : public se::DeviceMemoryAllocator {
 
   void PopulateDeviceMemory(const std::vector<se::DeviceMemoryBase>& device_buffers,
                             const std::vector<int64_t>& allocation_indices);
+
+  // Allocates the temporary buffers from `workspace` instead of the shared memory pool.
+  void UsePlannedWorkspace(void* workspace, int64_t workspace_bytes);
   stream_executor::port::StatusOr<stream_executor::Stream*> GetStream(int device_ordinal) override {
     UNIMPLEMENTED();
   };
@@ -65,6 +68,9 @@ class XlaAllocator : public se::DeviceMemoryAllocator {
     se::DeviceMemoryBase memory;
   };
   std::vector<AllocationBuffer> populated_buffers_;
+
+  char* planned_workspace_ = nullptr;
+  int64_t planned_workspace_bytes_ = 0;
 };
 
 }  // namespace mola
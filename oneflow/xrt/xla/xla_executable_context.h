@@ -69,6 +69,13 @@ class XlaExecutableRunContext {
   // capacity >= size. Otherwise it should wait for all launched kernels
   // to finish, then resize the memory buffer thread-safety.
   void ReserveWorkspace(size_t size) { allocator_->ReserveWorkspace(size); }
+  // Allocate temporary buffers from the workspace planned by OneFlow if it has `size` bytes,
+  // returns false if there is no such workspace.
+  bool UsePlannedWorkspace(size_t size) {
+    if (!run_options_.workspace || run_options_.workspace_bytes < size) { return false; }
+    allocator_->UsePlannedWorkspace(run_options_.workspace, run_options_.workspace_bytes);
+    return true;
+  }
   // Increase kernel launched count on the allocator.
   void LockWorkspace() { allocator_->LockWorkspace(); }
   // Decrease kernel launched count on the allocator.
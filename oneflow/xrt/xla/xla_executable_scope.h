@@ -43,6 +43,8 @@ class XlaExecutableRunScope {
 
  private:
   void* launch_stream_ = nullptr;
+  // Whether the workspace of the shared memory pool is in use.
+  bool lock_workspace_ = false;
   XlaExecutableRunContext& run_context_;
 };
 
@@ -60,8 +62,11 @@ XlaExecutableRunScope::XlaExecutableRunScope(xla::LocalExecutable* executable,
 #endif  // WITH_CUDA
 
   size_t workspace_size = xla::CalcWorkspaceByteSize(executable);
-  run_context_.ReserveWorkspace(workspace_size);
-  run_context_.LockWorkspace();
+  if (!run_context_.UsePlannedWorkspace(workspace_size)) {
+    run_context_.ReserveWorkspace(workspace_size);
+    run_context_.LockWorkspace();
+    lock_workspace_ = true;
+  }
 }
 
 XlaExecutableRunScope::~XlaExecutableRunScope() {
@@ -70,7 +75,7 @@ XlaExecutableRunScope::~XlaExecutableRunScope() {
     xla::SwapGpuStreamHandle(run_context_.stream(), &launch_stream_);
   }
 #endif  // WITH_CUDA
-  run_context_.UnlockWorkspace();
+  if (lock_workspace_) { run_context_.UnlockWorkspace(); }
 }
 
 }  // namespace mola
@@ -27,6 +27,7 @@ locals()["dtype"] = oneflow._oneflow_internal.dtype
 locals()["char"] = oneflow._oneflow_internal.char
 locals()["float16"] = oneflow._oneflow_internal.float16
 locals()["half"] = oneflow._oneflow_internal.float16
+locals()["bfloat16"] = oneflow._oneflow_internal.bfloat16
 locals()["float32"] = oneflow._oneflow_internal.float32
 locals()["float"] = oneflow._oneflow_internal.float
 locals()["double"] = oneflow._oneflow_internal.double
@@ -359,4 +360,4 @@ from oneflow.ops.initializer_util import (
 )
 from oneflow.nn.modules.scatter import *
 
-from . import autograd, distributed, linalg, optim, saved_model, sbp
+from . import autograd, cuda, distributed, linalg, optim, saved_model, sbp
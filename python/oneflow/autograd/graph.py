@@ -0,0 +1,90 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+from typing import Callable
+
+import oneflow as flow
+from oneflow.framework.tensor import Tensor
+
+
+class saved_tensors_hooks(object):
+    r"""Context manager that sets a pair of pack / unpack hooks for the tensors saved for backward.
+
+    Within the context, `pack_hook` is called on every tensor an op saves for backward and its
+    result is kept instead. `unpack_hook` is called on that result when backward needs the tensor
+    and must return a tensor with the same content. Both hooks must return tensors.
+
+    Args:
+        pack_hook (Callable[[Tensor], Tensor]): packs a saved tensor.
+        unpack_hook (Callable[[Tensor], Tensor]): restores a packed tensor.
+
+    For example:
+
+    .. code-block:: python
+
+        >>> import oneflow as flow
+        >>> x = flow.ones(2, 3, requires_grad=True)
+        >>> with flow.autograd.graph.saved_tensors_hooks(lambda t: t * 1, lambda t: t):
+        ...     y = x * x
+        >>> y.sum().backward()
+        >>> x.grad
+        tensor([[2., 2., 2.],
+                [2., 2., 2.]], dtype=oneflow.float32)
+
+    """
+
+    def __init__(
+        self,
+        pack_hook: Callable[[Tensor], Tensor] = None,
+        unpack_hook: Callable[[Tensor], Tensor] = None,
+    ):
+        self._hooks = None
+        if pack_hook is not None or unpack_hook is not None:
+            assert pack_hook is not None and unpack_hook is not None
+            self._hooks = flow._oneflow_internal.autograd.SavedTensorHooks(
+                pack_hook, unpack_hook
+            )
+
+    def __enter__(self):
+        self._hooks.enter()
+
+    def __exit__(self, *args):
+        self._hooks.exit()
+
+
+class save_on_cpu(saved_tensors_hooks):
+    r"""Context manager under which the tensors saved for backward are kept in host memory
+    and copied back to their devices when backward needs them.
+    """
+
+    def __init__(self):
+        super().__init__()
+        self._hooks = flow._oneflow_internal.autograd.save_on_cpu_hooks()
+
+
+class save_in_half(saved_tensors_hooks):
+    r"""Context manager under which the float tensors of cuda saved for backward are kept in
+    float16. The gradients are then approximate.
+    """
+
+    def __init__(self):
+        super().__init__()
+        self._hooks = flow._oneflow_internal.autograd.save_in_half_hooks()
+
+
+if __name__ == "__main__":
+    import doctest
+
+    doctest.testmod(raise_on_error=True)
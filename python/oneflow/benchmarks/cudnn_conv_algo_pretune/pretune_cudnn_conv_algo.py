@@ -0,0 +1,98 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+import argparse
+import json
+import os
+
+# Fills a cudnn conv algo cache file ahead of deployment, e.g.
+#   python3 pretune_cudnn_conv_algo.py --shapes shapes.json --cache_file conv_algo.cache
+# then run the real jobs with ONEFLOW_CUDNN_CONV_ALGO_CACHE_FILE=conv_algo.cache. shapes.json is
+# a list of 2d convs like
+#   [{"input": [8, 64, 224, 224], "out_channels": 64, "kernel_size": [3, 3], "stride": 1,
+#     "padding": 1, "dilation": 1, "groups": 1, "dtype": "float16"}]
+# An entry is only reused with the same GPU model, cuDNN version, workspace limit and
+# determinism, so pass the --cudnn_buf_limit_mbyte and --deterministic of the real jobs.
+
+
+def make_conv_job(flow, index, conv, args):
+    func_config = flow.FunctionConfig()
+    func_config.default_data_type(flow.float)
+    func_config.cudnn_conv_heuristic_search_algo(False)
+    func_config.cudnn_buf_limit_mbyte(args.cudnn_buf_limit_mbyte)
+    func_config.cudnn_conv_use_deterministic_algo_only(args.deterministic)
+    if conv.get("dtype", "float32") == "float16":
+        func_config.enable_auto_mixed_precision(True)
+    input_shape = tuple(conv["input"])
+    kernel_size = conv.get("kernel_size", [3, 3])
+    groups = conv.get("groups", 1)
+    padding = conv.get("padding", 0)
+    weight_shape = (conv["out_channels"], input_shape[1] // groups) + tuple(kernel_size)
+
+    def conv_job():
+        with flow.scope.placement("gpu", "0:0"):
+            x = flow.get_variable(
+                "pretune_conv_{}_x".format(index),
+                shape=input_shape,
+                dtype=flow.float,
+                initializer=flow.random_uniform_initializer(),
+                trainable=True,
+            )
+            weight = flow.get_variable(
+                "pretune_conv_{}_weight".format(index),
+                shape=weight_shape,
+                dtype=flow.float,
+                initializer=flow.random_uniform_initializer(),
+            )
+            loss = flow.nn.conv2d(
+                x,
+                weight,
+                strides=conv.get("stride", 1),
+                padding=((0, 0), (0, 0), (padding, padding), (padding, padding)),
+                dilations=conv.get("dilation", 1),
+                groups=groups,
+            )
+            flow.optimizer.SGD(
+                flow.optimizer.PiecewiseConstantScheduler([], [0.0]), momentum=0
+            ).minimize(loss)
+            return loss
+
+    conv_job.__name__ = "pretune_conv_{}".format(index)
+    return flow.global_function(type="train", function_config=func_config)(conv_job)
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--shapes", type=str, required=True)
+    parser.add_argument("--cache_file", type=str, required=True)
+    parser.add_argument("--cudnn_buf_limit_mbyte", type=int, default=1024)
+    parser.add_argument("--deterministic", action="store_true")
+    args = parser.parse_args()
+    # the cache reads the variable when oneflow sets up its env
+    os.environ["ONEFLOW_CUDNN_CONV_ALGO_CACHE_FILE"] = os.path.abspath(args.cache_file)
+    from oneflow.compatible import single_client as flow
+
+    with open(args.shapes) as f:
+        convs = json.load(f)
+    jobs = [make_conv_job(flow, i, conv, args) for (i, conv) in enumerate(convs)]
+    # The searches happen when the jobs are compiled and once more when the kernels first run
+    # with the workspace the compile time search settled on.
+    for (conv, job) in zip(convs, jobs):
+        job().get()
+        print("tuned", json.dumps(conv))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,90 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+import argparse
+import os
+import time
+
+# Measures the host dispatch time of one eager op call on small tensors, e.g.
+#   python3 eager_op_overhead_benchmark.py --device cuda
+# Run it again with --disable_infer_cache to compare against the uncached dispatch path,
+# with --requires_grad to include autograd graph building, and with --breakdown to print
+# the host time per stage (python binding, functor, dispatch, infer, instructions builder and
+# vm scheduling) of every case.
+
+
+def print_breakdown(table, iters):
+    print(
+        "{:>32} {:>10} {:>16} {:>16}".format(
+            "stage", "calls", "total us per op", "self us per op"
+        )
+    )
+    for row in table:
+        print(
+            "{:>32} {:>10} {:>16.2f} {:>16.2f}".format(
+                row["stage"],
+                row["call_cnt"],
+                row["total_us"] / iters,
+                row["self_us"] / iters,
+            )
+        )
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--device", type=str, default="cpu")
+    parser.add_argument("--iters", type=int, default=10000)
+    parser.add_argument("--warmup_iters", type=int, default=100)
+    parser.add_argument("--disable_infer_cache", action="store_true")
+    parser.add_argument("--requires_grad", action="store_true")
+    parser.add_argument("--breakdown", action="store_true")
+    args = parser.parse_args()
+    if args.disable_infer_cache:
+        os.environ["ONEFLOW_EAGER_ENABLE_LOCAL_TENSOR_INFER_CACHE"] = "0"
+    import oneflow as flow
+    import oneflow.profiler
+
+    x = flow.ones(2, 3, device=args.device, requires_grad=args.requires_grad)
+    y = flow.ones(2, 3, device=args.device, requires_grad=args.requires_grad)
+    cases = [
+        ("relu", lambda: flow.relu(x)),
+        ("add", lambda: flow.add(x, y)),
+        ("mul", lambda: flow.mul(x, y)),
+        ("matmul", lambda: flow.matmul(x, y.transpose(0, 1))),
+        ("sum", lambda: flow.sum(x, dim=1)),
+        ("reshape", lambda: x.reshape(3, 2)),
+    ]
+    print("{:>10} {:>16}".format("op", "us per call"))
+    for (name, fn) in cases:
+        for _ in range(args.warmup_iters):
+            fn()
+        fn().numpy()
+        if args.breakdown:
+            flow.profiler.reset_host_stage_timing()
+            flow.profiler.enable_host_stage_timing()
+        start = time.perf_counter()
+        for _ in range(args.iters):
+            fn()
+        host_time = time.perf_counter() - start
+        # kernels run asynchronously, wait for them before the next case
+        fn().numpy()
+        print("{:>10} {:>16.2f}".format(name, host_time * 1e6 / args.iters))
+        if args.breakdown:
+            flow.profiler.disable_host_stage_timing()
+            print_breakdown(flow.profiler.get_host_stage_timing_table(), args.iters)
+
+
+if __name__ == "__main__":
+    main()
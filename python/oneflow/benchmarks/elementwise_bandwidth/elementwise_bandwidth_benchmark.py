@@ -0,0 +1,73 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+import argparse
+import time
+
+# Measures the memory bandwidth achieved by elementwise kernels on large tensors, e.g.
+#   python3 elementwise_bandwidth_benchmark.py --elem_cnt 67108864 --peak_gbps 900
+# Bandwidth counts every input read and every output written once.
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--elem_cnt", type=int, default=64 * 1024 * 1024)
+    parser.add_argument("--iters", type=int, default=100)
+    parser.add_argument("--warmup_iters", type=int, default=10)
+    parser.add_argument(
+        "--peak_gbps", type=float, default=None, help="peak bandwidth of the device"
+    )
+    args = parser.parse_args()
+    import oneflow as flow
+
+    n = args.elem_cnt
+    x = flow.ones(n, dtype=flow.float32, device="cuda")
+    y = flow.ones(n, dtype=flow.float32, device="cuda")
+    x_half = flow.ones(n, dtype=flow.float16, device="cuda")
+    cond = flow.ones(n, dtype=flow.int8, device="cuda")
+    # (name, fn, bytes moved per element)
+    cases = [
+        ("relu", lambda: flow.relu(x), 4 + 4),
+        ("exp", lambda: flow.exp(x), 4 + 4),
+        ("scalar_mul", lambda: x * 2.0, 4 + 4),
+        ("add", lambda: flow.add(x, y), 4 + 4 + 4),
+        ("where", lambda: flow.where(cond, x, y), 1 + 4 + 4 + 4),
+        ("cast_f2h", lambda: flow.cast(x, flow.float16), 4 + 2),
+        ("cast_h2f", lambda: flow.cast(x_half, flow.float32), 2 + 4),
+        ("exp_half", lambda: flow.exp(x_half), 2 + 2),
+    ]
+    header = "{:>12} {:>12} {:>12}".format("op", "us per call", "GB/s")
+    if args.peak_gbps is not None:
+        header += " {:>10}".format("% of peak")
+    print(header)
+    for (name, fn, bytes_per_elem) in cases:
+        for _ in range(args.warmup_iters):
+            out = fn()
+        # kernels run asynchronously, wait for them before and after the timed loop
+        out.sum().numpy()
+        start = time.perf_counter()
+        for _ in range(args.iters):
+            out = fn()
+        out.sum().numpy()
+        seconds = (time.perf_counter() - start) / args.iters
+        gbps = n * bytes_per_elem / seconds / 1e9
+        line = "{:>12} {:>12.2f} {:>12.2f}".format(name, seconds * 1e6, gbps)
+        if args.peak_gbps is not None:
+            line += " {:>10.1f}".format(gbps * 100 / args.peak_gbps)
+        print(line)
+
+
+if __name__ == "__main__":
+    main()
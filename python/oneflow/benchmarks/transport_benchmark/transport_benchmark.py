@@ -0,0 +1,43 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+import argparse
+
+import oneflow as flow
+
+# Measures the latency and bandwidth of the eager rpc Transport between rank 0 and rank 1, e.g.
+#   python3 -m oneflow.distributed.launch --nproc_per_node 2 transport_benchmark.py
+# The chunk size and the number of in-flight chunks can be tuned with
+# ONEFLOW_TRANSPORT_CHUNK_SIZE and ONEFLOW_TRANSPORT_MAX_IN_FLIGHT_CHUNKS.
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--min_size", type=int, default=4 * 1024)
+    parser.add_argument("--max_size", type=int, default=1024 * 1024 * 1024)
+    parser.add_argument("--iters", type=int, default=10)
+    args = parser.parse_args()
+    results = flow._oneflow_internal.benchmark_transport(
+        args.min_size, args.max_size, args.iters
+    )
+    if flow.distributed.get_rank() != 0:
+        return
+    print("{:>12} {:>14} {:>16}".format("size(B)", "latency(us)", "bandwidth(GB/s)"))
+    for (size, latency, bandwidth) in results:
+        print("{:>12} {:>14.2f} {:>16.3f}".format(size, latency, bandwidth))
+
+
+if __name__ == "__main__":
+    main()
@@ -28,9 +28,15 @@ from oneflow.compatible.single_client.framework.config_util import (
 from oneflow.compatible.single_client.framework.config_util import (
     api_disable_group_boxing_by_dst_parallel as disable_group_boxing_by_dst_parallel,
 )
+from oneflow.compatible.single_client.framework.config_util import (
+    api_nccl_matmul_all_reduce_chunk_num as nccl_matmul_all_reduce_chunk_num,
+)
 from oneflow.compatible.single_client.framework.config_util import (
     api_enable_debug_mode as enable_debug_mode,
 )
+from oneflow.compatible.single_client.framework.config_util import (
+    api_enable_deterministic_kernels as enable_deterministic_kernels,
+)
 from oneflow.compatible.single_client.framework.config_util import (
     api_enable_legacy_model_io as enable_legacy_model_io,
 )
@@ -19,6 +19,9 @@ from oneflow.compatible.single_client.framework.config_util import (
 from oneflow.compatible.single_client.framework.config_util import (
     api_nccl_enable_all_to_all as nccl_enable_all_to_all,
 )
+from oneflow.compatible.single_client.framework.config_util import (
+    api_nccl_enable_hierarchical_all_reduce as nccl_enable_hierarchical_all_reduce,
+)
 from oneflow.compatible.single_client.framework.config_util import (
     api_nccl_enable_mixed_fusion as nccl_enable_mixed_fusion,
 )
@@ -368,6 +368,23 @@ def enable_tensor_float_32_compute(val=True):
     sess.config_proto.resource.enable_tensor_float_32_compute = val
 
 
+def api_enable_deterministic_kernels(val: bool = True) -> None:
+    """Whether or not to sum with deterministic implementations in the GPU kernels that
+    otherwise use atomic adds. Kernels without a deterministic implementation keep atomic adds.
+
+    Args:
+        val (bool, optional): True or False. Defaults to True.
+    """
+    return enable_if.unique([enable_deterministic_kernels, do_nothing])(val=val)
+
+
+@enable_if.condition(hob.in_normal_mode & ~hob.session_initialized)
+def enable_deterministic_kernels(val=True):
+    sess = session_ctx.GetDefaultSession()
+    assert type(val) is bool
+    sess.config_proto.resource.enable_deterministic_kernels = val
+
+
 def api_enable_mem_chain_merge(val: bool = True) -> None:
     """Whether or not to enable MemChain merge.
 
@@ -416,6 +433,22 @@ def disable_group_boxing_by_dst_parallel(val=False):
     sess.config_proto.resource.disable_group_boxing_by_dst_parallel = val
 
 
+def api_nccl_matmul_all_reduce_chunk_num(val: int = 0) -> None:
+    """Split matmuls all-reduced by nccl into row chunks so the all-reduce overlaps the matmul, needs nccl_use_compute_stream.
+
+    Args:
+        val (int, optional): number of chunks, 0 keeps matmul and all-reduce apart. Defaults to 0.
+    """
+    return enable_if.unique([nccl_matmul_all_reduce_chunk_num, do_nothing])(val=val)
+
+
+@enable_if.condition(hob.in_normal_mode & ~hob.session_initialized)
+def nccl_matmul_all_reduce_chunk_num(val=0):
+    sess = session_ctx.GetDefaultSession()
+    assert type(val) is int
+    sess.config_proto.resource.nccl_matmul_all_reduce_chunk_num = val
+
+
 def api_nccl_num_streams(val: int) -> None:
     """Set up the number of nccl parallel streams while use boxing
 
@@ -594,6 +627,23 @@ def nccl_enable_mixed_fusion(val):
     sess.config_proto.resource.collective_boxing_conf.nccl_enable_mixed_fusion = val
 
 
+def api_nccl_enable_hierarchical_all_reduce(val: bool) -> None:
+    """Whether or not split multi-node nccl all-reduce into intra-node reduce-scatter,
+    inter-node all-reduce and intra-node all-gather
+
+    Args:
+        val (bool): True or False
+    """
+    return enable_if.unique([nccl_enable_hierarchical_all_reduce, do_nothing])(val)
+
+
+@enable_if.condition(hob.in_normal_mode & ~hob.session_initialized)
+def nccl_enable_hierarchical_all_reduce(val):
+    sess = session_ctx.GetDefaultSession()
+    assert type(val) is bool
+    sess.config_proto.resource.collective_boxing_conf.nccl_enable_hierarchical_all_reduce = val
+
+
 @enable_if.condition(hob.in_normal_mode & hob.session_initialized)
 def do_nothing(*args, **kwargs):
     print("Nothing happened because the session is running")
@@ -470,6 +470,19 @@ def set_enable_fuse_cast_scale(func_desc, value=True):
     func_desc.job_config_proto.set_enable_fuse_cast_scale(value)
 
 
+@oneflow_function_config("enable_fuse_conv_bias_add_relu")
+def set_enable_fuse_conv_bias_add_relu(func_desc, value=True):
+    """Whether enable fusing conv2d, bias_add, an optional add and relu.
+            If enabled, run them as one cuDNN convolution that adds the bias and the
+            addend and applies relu.
+
+    Args:
+        func_desc ([type]): [description]
+        value ([type]): [description]
+    """
+    func_desc.job_config_proto.set_enable_fuse_conv_bias_add_relu(value)
+
+
 @oneflow_function_config("cudnn_conv_use_deterministic_algo_only")
 def set_cudnn_conv_use_deterministic_algo_only(func_desc, value):
     """Set value to cudnn conv_use_deterministic_only algorithm
@@ -1315,6 +1315,7 @@ def argwhere(
     condition: oneflow._oneflow_internal.BlobDesc,
     dtype: Optional[flow.dtype] = None,
     name: Optional[str] = None,
+    sync_size: bool = True,
 ) -> oneflow._oneflow_internal.BlobDesc:
     """This operator finds the indices of input Blob `condition` elements that are non-zero. It returns a List.
     Each element in the output is a coordinate that points to a non-zero element in the condition.
@@ -1323,6 +1324,11 @@ def argwhere(
         condition (oneflow._oneflow_internal.BlobDesc): The input Blob.
         dtype (Optional[flow.dtype], optional): The data type of output. Defaults to None.
         name (Optional[str], optional): The name for the operation. Defaults to None.
+        sync_size (bool, optional): If False, the number of indices stays on the device and the
+            Blob pair (indices, size) is returned. indices keeps the capacity of one row per
+            element of `condition` and its rows past size are 0, so it can be consumed without a
+            host sync in the middle of the job. Pass both to :func:`sync_dynamic_resize` where
+            the exact size is needed. Defaults to True.
 
     Returns:
         oneflow._oneflow_internal.BlobDesc: The result Blob. Its type is `ListNumpy`.
@@ -1360,11 +1366,14 @@ def argwhere(
         .Op("argwhere")
         .Input("input", [condition])
         .Attr("dtype", dtype)
+        .Attr("pad_tail", not sync_size)
         .Output("output")
         .Output("output_size")
         .Build()
     )
     (output, output_size) = op.InferAndTryRun().RemoteBlobList()
+    if not sync_size:
+        return (output, output_size)
     return sync_dynamic_resize(output, output_size)
 
 
@@ -2299,8 +2299,14 @@ def gpt_data_loader(
     split_index: Optional[int] = None,
     parallel_distribution: Optional[Sequence[str]] = None,
     start_from_saved_progress: bool = False,
+    with_doc_offsets: bool = False,
     name: Optional[str] = None,
 ) -> oneflow._oneflow_internal.BlobDesc:
+    """Reads (batch_size, seq_length + 1) tokens from a megatron indexed dataset. Documents are
+    packed back to back in the samples, with with_doc_offsets=True the loader also returns the
+    (batch_size, seq_length + 1) int32 start offsets of the documents in each sample, padded with
+    seq_length, which can be passed to fused_multi_head_attention as cu_seqlens.
+    """
     if name is None:
         name = (
             "gpt_data_loader"
@@ -2365,9 +2371,11 @@ def gpt_data_loader(
     op_builder = flow.user_op_builder(name).Op("megatron_gpt_mmap_data_loader")
     if start_from_saved_progress:
         op_builder.Input("iteration", [iteration])
+    op_builder.Output("out")
+    if with_doc_offsets:
+        op_builder.Output("cu_seqlens")
     op = (
-        op_builder.Output("out")
-        .Attr("data_file_prefix", data_file_prefix)
+        op_builder.Attr("data_file_prefix", data_file_prefix)
         .Attr("seq_length", seq_length)
         .Attr("label_length", label_length)
         .Attr("num_samples", num_samples)
@@ -2380,4 +2388,6 @@ def gpt_data_loader(
         .Attr("parallel_distribution", parallel_distribution)
         .Build()
     )
+    if with_doc_offsets:
+        return tuple(op.InferAndTryRun().RemoteBlobList())
     return op.InferAndTryRun().SoleOutputBlob()
@@ -0,0 +1,79 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+
+import unittest
+from collections import OrderedDict
+
+import numpy as np
+from test_util import GenArgList
+
+import oneflow.compatible.single_client.unittest
+from oneflow.compatible import single_client as flow
+from oneflow.compatible.single_client import typing as oft
+
+
+def make_conv_bias_add_relu_job(enable_fuse, x_shape, w_shape, out_shape, has_addend):
+    flow.clear_default_session()
+    func_config = flow.FunctionConfig()
+    func_config.default_data_type(flow.float)
+    func_config.enable_fuse_conv_bias_add_relu(enable_fuse)
+
+    @flow.global_function(type="predict", function_config=func_config)
+    def ConvBiasAddReluJob(
+        x: oft.Numpy.Placeholder(x_shape),
+        w: oft.Numpy.Placeholder(w_shape),
+        bias: oft.Numpy.Placeholder((w_shape[0],)),
+        addend: oft.Numpy.Placeholder(out_shape),
+    ):
+        with flow.scope.placement("gpu", "0:0"):
+            out = flow.nn.conv2d(x, w, strides=1, padding="SAME", data_format="NCHW")
+            out = flow.nn.bias_add(out, bias, data_format="NCHW")
+            if has_addend:
+                out = out + addend
+            return flow.nn.relu(out)
+
+    return ConvBiasAddReluJob
+
+
+def compare_fused_with_unfused(test_case, x_shape, filters, has_addend):
+    w_shape = (filters, x_shape[1], 3, 3)
+    out_shape = (x_shape[0], filters, x_shape[2], x_shape[3])
+    x = np.random.uniform(-1, 1, x_shape).astype(np.float32)
+    w = np.random.uniform(-1, 1, w_shape).astype(np.float32)
+    bias = np.random.uniform(-1, 1, (filters,)).astype(np.float32)
+    addend = np.random.uniform(-1, 1, out_shape).astype(np.float32)
+    outs = []
+    for enable_fuse in [False, True]:
+        job = make_conv_bias_add_relu_job(
+            enable_fuse, x_shape, w_shape, out_shape, has_addend
+        )
+        outs.append(job(x, w, bias, addend).get().numpy())
+    test_case.assertTrue(np.allclose(outs[0], outs[1], rtol=1e-4, atol=1e-4))
+
+
+@flow.unittest.skip_unless_1n1d()
+class TestFuseConvBiasAddRelu(flow.unittest.TestCase):
+    def test_fuse_conv_bias_add_relu(test_case):
+        arg_dict = OrderedDict()
+        arg_dict["x_shape"] = [(2, 8, 10, 10), (1, 3, 7, 9)]
+        arg_dict["filters"] = [16]
+        arg_dict["has_addend"] = [True, False]
+        for arg in GenArgList(arg_dict):
+            compare_fused_with_unfused(test_case, *arg)
+
+
+if __name__ == "__main__":
+    unittest.main()
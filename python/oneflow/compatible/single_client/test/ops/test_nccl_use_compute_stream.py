@@ -111,6 +111,33 @@ def _test_partial_sum_to_broadcast(test_case):
     test_case.assertTrue(np.allclose(np.sum(x, axis=0), y))
 
 
+def _test_matmul_all_reduce_in_chunks(test_case, chunk_num):
+    flow.clear_default_session()
+    flow.config.gpu_device_num(2)
+    flow.config.nccl_use_compute_stream(True)
+    flow.config.disable_group_boxing_by_dst_parallel(True)
+    flow.config.nccl_matmul_all_reduce_chunk_num(chunk_num)
+    func_config = flow.FunctionConfig()
+    func_config.default_data_type(flow.float)
+    func_config.default_logical_view(flow.scope.consistent_view())
+
+    @flow.global_function(function_config=func_config)
+    def matmul_all_reduce_job(
+        a: oft.Numpy.Placeholder((90, 64)), b: oft.Numpy.Placeholder((64, 48))
+    ):
+        with flow.scope.placement("gpu", "0:0-1"):
+            a = flow.identity(a.with_distribute(flow.distribute.split(1)))
+            b = flow.identity(b.with_distribute(flow.distribute.split(0)))
+            out = flow.matmul(a, b)
+            dst = flow.identity(out.with_distribute(flow.distribute.broadcast()))
+        return dst
+
+    a = np.random.rand(90, 64).astype(np.float32)
+    b = np.random.rand(64, 48).astype(np.float32)
+    y = matmul_all_reduce_job(a, b).get().numpy()
+    test_case.assertTrue(np.allclose(np.matmul(a, b), y, rtol=1e-4, atol=1e-4))
+
+
 @flow.unittest.skip_unless_1n2d()
 class TestNcclUseComputeStream(flow.unittest.TestCase):
     def test_split_to_split_all_to_all(test_case):
@@ -138,6 +165,12 @@ class TestNcclUseComputeStream(flow.unittest.TestCase):
     def test_partial_sum_to_broadcast(test_case):
         _test_partial_sum_to_broadcast(test_case)
 
+    def test_matmul_all_reduce_in_chunks(test_case):
+        arg_dict = OrderedDict()
+        arg_dict["chunk_num"] = [1, 4, 7]
+        for arg in GenArgList(arg_dict):
+            _test_matmul_all_reduce_in_chunks(test_case, *arg)
+
 
 if __name__ == "__main__":
     unittest.main()
@@ -19,10 +19,19 @@ from oneflow.framework.config_util import (
     api_compute_thread_pool_size as compute_thread_pool_size,
 )
 from oneflow.framework.config_util import api_cpu_device_num as cpu_device_num
+from oneflow.framework.config_util import (
+    api_cpu_intra_op_thread_num as cpu_intra_op_thread_num,
+)
 from oneflow.framework.config_util import (
     api_disable_group_boxing_by_dst_parallel as disable_group_boxing_by_dst_parallel,
 )
+from oneflow.framework.config_util import (
+    api_nccl_matmul_all_reduce_chunk_num as nccl_matmul_all_reduce_chunk_num,
+)
 from oneflow.framework.config_util import api_enable_debug_mode as enable_debug_mode
+from oneflow.framework.config_util import (
+    api_enable_deterministic_kernels as enable_deterministic_kernels,
+)
 from oneflow.framework.config_util import (
     api_enable_legacy_model_io as enable_legacy_model_io,
 )
@@ -64,4 +73,7 @@ from oneflow.framework.config_util import (
 from oneflow.framework.config_util import (
     api_thread_enable_local_message_queue as thread_enable_local_message_queue,
 )
+from oneflow.framework.config_util import (
+    api_thread_enable_priority_dispatch as thread_enable_priority_dispatch,
+)
 from oneflow.framework.config_util import api_use_rdma as use_rdma
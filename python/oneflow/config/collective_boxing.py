@@ -17,6 +17,9 @@ from oneflow.framework.config_util import api_enable_fusion as enable_fusion
 from oneflow.framework.config_util import (
     api_nccl_enable_all_to_all as nccl_enable_all_to_all,
 )
+from oneflow.framework.config_util import (
+    api_nccl_enable_hierarchical_all_reduce as nccl_enable_hierarchical_all_reduce,
+)
 from oneflow.framework.config_util import (
     api_nccl_enable_mixed_fusion as nccl_enable_mixed_fusion,
 )
@@ -0,0 +1,58 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+import oneflow._oneflow_internal
+
+_stats_keys = [
+    "reserved_bytes",
+    "allocated_bytes",
+    "peak_allocated_bytes",
+    "largest_free_piece_bytes",
+    "block_num",
+    "allocate_num",
+    "deallocate_num",
+    "extend_num",
+    "extend_failure_num",
+    "gc_num",
+    "gc_freed_bytes",
+    "bin_free_piece_num",
+    "allocation_size_histogram",
+]
+
+
+def memory_stats(device_id=0):
+    """Returns a dict of the eager cuda allocator statistics of the device.
+
+    All values are zero if no eager cuda memory has been allocated on the device.
+    """
+    stats = oneflow._oneflow_internal.vm.GetCudaAllocatorStats(device_id)
+    return {key: getattr(stats, key) for key in _stats_keys}
+
+
+def memory_allocated(device_id=0):
+    return memory_stats(device_id)["allocated_bytes"]
+
+
+def memory_reserved(device_id=0):
+    return memory_stats(device_id)["reserved_bytes"]
+
+
+def max_memory_allocated(device_id=0):
+    return memory_stats(device_id)["peak_allocated_bytes"]
+
+
+def reset_peak_memory_stats(device_id=0):
+    """Restarts the peak tracking of `max_memory_allocated` from the current allocated bytes."""
+    oneflow._oneflow_internal.vm.ResetCudaAllocatorPeakStats(device_id)
@@ -18,4 +18,5 @@ from oneflow.framework.distribute import (
     get_rank,
     get_world_size,
     is_multi_client,
+    prewarm_nccl_comms,
 )
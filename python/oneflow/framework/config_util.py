@@ -168,6 +168,23 @@ def compute_thread_pool_size(val):
     sess.config_proto.resource.compute_thread_pool_size = val
 
 
+def api_cpu_intra_op_thread_num(val: int) -> None:
+    """Set up the number of compute thread pool threads a CPU kernel may use to run its loops
+
+    Args:
+        val (int): number of threads, 1 runs CPU kernels serially
+    """
+    return enable_if.unique([cpu_intra_op_thread_num, do_nothing])(val)
+
+
+@enable_if.condition(hob.in_normal_mode & ~hob.session_initialized)
+def cpu_intra_op_thread_num(val):
+    sess = session_ctx.GetDefaultSession()
+    assert type(val) is int
+    assert val > 0
+    sess.config_proto.resource.cpu_intra_op_thread_num = val
+
+
 def api_reserved_host_mem_mbyte(val: int) -> None:
     """Set up the memory size of reserved host
 
@@ -216,6 +233,23 @@ def thread_enable_local_message_queue(val):
     sess.config_proto.resource.thread_enable_local_message_queue = val
 
 
+def api_thread_enable_priority_dispatch(val: bool) -> None:
+    """Whether or not dispatch the actor messages of each thread by the priorities of the actors,
+    the actors on longer paths to the end of the job and those feeding communication first.
+
+    Args:
+        val (bool):  True or False
+    """
+    return enable_if.unique([thread_enable_priority_dispatch, do_nothing])(val)
+
+
+@enable_if.condition(hob.in_normal_mode & ~hob.session_initialized)
+def thread_enable_priority_dispatch(val):
+    sess = session_ctx.GetDefaultSession()
+    assert type(val) is bool
+    sess.config_proto.resource.thread_enable_priority_dispatch = val
+
+
 def api_enable_debug_mode(val: bool) -> None:
     """Whether use debug mode or not.
 
@@ -334,6 +368,23 @@ def enable_tensor_float_32_compute(val=True):
     sess.config_proto.resource.enable_tensor_float_32_compute = val
 
 
+def api_enable_deterministic_kernels(val: bool = True) -> None:
+    """Whether or not to sum with deterministic implementations in the GPU kernels that
+    otherwise use atomic adds. Kernels without a deterministic implementation keep atomic adds.
+
+    Args:
+        val (bool, optional): True or False. Defaults to True.
+    """
+    return enable_if.unique([enable_deterministic_kernels, do_nothing])(val=val)
+
+
+@enable_if.condition(hob.in_normal_mode & ~hob.session_initialized)
+def enable_deterministic_kernels(val=True):
+    sess = session_ctx.GetDefaultSession()
+    assert type(val) is bool
+    sess.config_proto.resource.enable_deterministic_kernels = val
+
+
 def api_enable_mem_chain_merge(val: bool = True) -> None:
     """Whether or not to enable MemChain merge.
 
@@ -382,6 +433,22 @@ def disable_group_boxing_by_dst_parallel(val=False):
     sess.config_proto.resource.disable_group_boxing_by_dst_parallel = val
 
 
+def api_nccl_matmul_all_reduce_chunk_num(val: int = 0) -> None:
+    """Split matmuls all-reduced by nccl into row chunks so the all-reduce overlaps the matmul, needs nccl_use_compute_stream.
+
+    Args:
+        val (int, optional): number of chunks, 0 keeps matmul and all-reduce apart. Defaults to 0.
+    """
+    return enable_if.unique([nccl_matmul_all_reduce_chunk_num, do_nothing])(val=val)
+
+
+@enable_if.condition(hob.in_normal_mode & ~hob.session_initialized)
+def nccl_matmul_all_reduce_chunk_num(val=0):
+    sess = session_ctx.GetDefaultSession()
+    assert type(val) is int
+    sess.config_proto.resource.nccl_matmul_all_reduce_chunk_num = val
+
+
 def api_nccl_num_streams(val: int) -> None:
     """Set up the number of nccl parallel streams while use boxing
 
@@ -560,6 +627,23 @@ def nccl_enable_mixed_fusion(val):
     sess.config_proto.resource.collective_boxing_conf.nccl_enable_mixed_fusion = val
 
 
+def api_nccl_enable_hierarchical_all_reduce(val: bool) -> None:
+    """Whether or not split multi-node nccl all-reduce into intra-node reduce-scatter,
+    inter-node all-reduce and intra-node all-gather
+
+    Args:
+        val (bool): True or False
+    """
+    return enable_if.unique([nccl_enable_hierarchical_all_reduce, do_nothing])(val)
+
+
+@enable_if.condition(hob.in_normal_mode & ~hob.session_initialized)
+def nccl_enable_hierarchical_all_reduce(val):
+    sess = session_ctx.GetDefaultSession()
+    assert type(val) is bool
+    sess.config_proto.resource.collective_boxing_conf.nccl_enable_hierarchical_all_reduce = val
+
+
 @enable_if.condition(hob.in_normal_mode & hob.session_initialized)
 def do_nothing(*args, **kwargs):
     print("Nothing happened because the session is running")
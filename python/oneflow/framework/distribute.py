@@ -205,6 +205,20 @@ def is_multi_client():
     return oneflow._oneflow_internal.IsMultiClient()
 
 
+def prewarm_nccl_comms(placement) -> None:
+    """Creates the nccl communicators used by collectives on `placement` ahead of time.
+
+    Communicators are otherwise created lazily by the first collective, which makes the first
+    iteration slow. All ranks of `placement` must call this function.
+
+    Args:
+        placement (oneflow.placement): A cuda placement. For a 2D hierarchy the communicators
+            of the groups along both axes are created as well.
+
+    """
+    oneflow._oneflow_internal.PrewarmNcclComms(placement)
+
+
 def split_sbp(axis: int) -> oneflow._oneflow_internal.sbp.sbp:
     """Generate a split scheme in which op will be splitted at `axis`.
 
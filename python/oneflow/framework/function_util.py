@@ -347,10 +347,37 @@ def policy_time_line(func_desc):
     return "use_time_line_algo"
 
 
+@oneflow_function_config("static_mem_alloc_policy_white_list.policy_best_fit_offset")
+def policy_best_fit_offset(func_desc):
+    """A static memory allocation policy called: best_fit_offset
+
+    Args:
+        func_desc ([type]): [description]
+
+    Returns:
+        [type]: [description]
+    """
+    return "use_best_fit_offset_algo"
+
+
+@oneflow_function_config("static_mem_alloc_best_fit_offset_search_time_limit_ms")
+def set_static_mem_alloc_best_fit_offset_search_time_limit_ms(func_desc, value):
+    """Set the time limit of the branch and bound search on top of best_fit_offset policy, 0 disables it
+
+    Args:
+        func_desc ([type]): [description]
+        value ([type]): [description]
+    """
+    func_desc.job_config_proto.mutable_memory_allocation_algorithm_conf().set_best_fit_offset_algo_search_time_limit_ms(
+        value
+    )
+
+
 @oneflow_function_config("static_mem_alloc_algo_white_list.show")
 def show_static_mem_alloc_algo_white_list(func_desc):
     """Show configuration of  static memory allocation policy,
-          including: "use_mem_size_first_algo", "use_mutual_exclusion_first_algo", "use_time_line_algo"
+          including: "use_mem_size_first_algo", "use_mutual_exclusion_first_algo", "use_time_line_algo",
+          "use_best_fit_offset_algo"
 
     Args:
         func_desc ([type]): [description]
@@ -362,6 +389,7 @@ def show_static_mem_alloc_algo_white_list(func_desc):
         "use_mem_size_first_algo",
         "use_mutual_exclusion_first_algo",
         "use_time_line_algo",
+        "use_best_fit_offset_algo",
     ]
 
 
@@ -466,6 +494,183 @@ def set_enable_fuse_cast_scale(func_desc, value=True):
     func_desc.job_config_proto.set_enable_fuse_cast_scale(value)
 
 
+@oneflow_function_config("enable_fuse_elementwise_ops")
+def set_enable_fuse_elementwise_ops(func_desc, value=True):
+    """Whether enable fuse_elementwise_ops.
+            If enabled, try to fuse chains of elementwise ops into one fused_elementwise op to improve performance.
+
+    Args:
+        func_desc ([type]): [description]
+        value ([type]): [description]
+    """
+    func_desc.job_config_proto.set_enable_fuse_elementwise_ops(value)
+
+
+@oneflow_function_config("enable_constant_folding")
+def set_enable_constant_folding(func_desc, value=True):
+    """Whether enable constant folding of predict jobs.
+            If enabled, fold the ops computing compile time constants into constant ops,
+            merge common subexpressions and remove the ops whose outputs are never consumed.
+
+    Args:
+        func_desc ([type]): [description]
+        value ([type]): [description]
+    """
+    func_desc.job_config_proto.set_enable_constant_folding(value)
+
+
+@oneflow_function_config("enable_fuse_matmul_bias_add_activation")
+def set_enable_fuse_matmul_bias_add_activation(func_desc, value=True):
+    """Whether enable fusing matmul, bias_add and an optional relu or gelu.
+            If enabled, run them as one cuBLASLt matmul whose epilogue adds the bias
+            and applies relu. Needs CUDA 11.4 or later.
+
+    Args:
+        func_desc ([type]): [description]
+        value ([type]): [description]
+    """
+    func_desc.job_config_proto.set_enable_fuse_matmul_bias_add_activation(value)
+
+
+@oneflow_function_config("enable_fuse_conv_bias_add_relu")
+def set_enable_fuse_conv_bias_add_relu(func_desc, value=True):
+    """Whether enable fusing conv2d, bias_add, an optional add and relu.
+            If enabled, run them as one cuDNN convolution that adds the bias and the
+            addend and applies relu.
+
+    Args:
+        func_desc ([type]): [description]
+        value ([type]): [description]
+    """
+    func_desc.job_config_proto.set_enable_fuse_conv_bias_add_relu(value)
+
+
+@oneflow_function_config("enable_fp8_matmul")
+def set_enable_fp8_matmul(func_desc, value=True):
+    """Whether enable running matmuls on FP8 operands.
+            If enabled, the 2D GPU matmuls whose weight is stored as (n, k) quantize both
+            operands to E4M3 with scales derived from their recent amax. Needs CUDA 11.8
+            and a GPU of compute capability 8.9 or later.
+
+    Args:
+        func_desc ([type]): [description]
+        value ([type]): [description]
+    """
+    func_desc.job_config_proto.set_enable_fp8_matmul(value)
+
+
+@oneflow_function_config("fp8_amax_history_len")
+def set_fp8_amax_history_len(func_desc, value):
+    """Set the number of steps whose amax decides the FP8 scale of a matmul operand.
+
+    Args:
+        func_desc ([type]): [description]
+        value ([type]): [description]
+    """
+    func_desc.job_config_proto.set_fp8_amax_history_len(value)
+
+
+@oneflow_function_config("fp8_scale_margin")
+def set_fp8_scale_margin(func_desc, value):
+    """Set the margin of the FP8 scales, they are divided by 2^margin.
+
+    Args:
+        func_desc ([type]): [description]
+        value ([type]): [description]
+    """
+    func_desc.job_config_proto.set_fp8_scale_margin(value)
+
+
+@oneflow_function_config("enable_channels_last_layout")
+def set_enable_channels_last_layout(func_desc, value=True):
+    """Whether enable running conv2d, pooling and batch norm in channels-last layout.
+            If enabled, the chains of these ops and the elementwise ops between them are
+            rewritten to NHWC, with transposes where a tensor enters or leaves such a chain.
+
+    Args:
+        func_desc ([type]): [description]
+        value ([type]): [description]
+    """
+    func_desc.job_config_proto.set_enable_channels_last_layout(value)
+
+
+@oneflow_function_config("enable_sequence_parallel")
+def set_enable_sequence_parallel(func_desc, value=True):
+    """Whether enable running the layer norm and dropout ops of tensor parallel layers split along the sequence.
+            If enabled, these ops take their input split along the sequence axis instead of
+            broadcast, the all-reduces around them become reduce-scatter and all-gather.
+
+    Args:
+        func_desc ([type]): [description]
+        value ([type]): [description]
+    """
+    func_desc.job_config_proto.set_enable_sequence_parallel(value)
+
+
+@oneflow_function_config("sequence_parallel_axis")
+def set_sequence_parallel_axis(func_desc, value):
+    """Set the axis the sequence parallel ops are split along.
+
+    Args:
+        func_desc ([type]): [description]
+        value ([type]): [description]
+    """
+    func_desc.job_config_proto.set_sequence_parallel_axis(value)
+
+
+@oneflow_function_config("data_prefetch_buffer_size")
+def set_data_prefetch_buffer_size(func_desc, value):
+    """Set the number of batches of the host data kept on the GPUs that consume it.
+            The copy of the next batch then overlaps the compute of the current one.
+            0 disables it.
+
+    Args:
+        func_desc ([type]): [description]
+        value ([type]): [description]
+    """
+    func_desc.job_config_proto.set_data_prefetch_buffer_size(value)
+
+
+@oneflow_function_config("num_branch_compute_streams")
+def set_num_branch_compute_streams(func_desc, value):
+    """Set the number of compute streams the independent branches of the GPU ops,
+            e.g. the towers of a multi-tower model, are spread over. 0 or 1 disables it.
+
+    Args:
+        func_desc ([type]): [description]
+        value ([type]): [description]
+    """
+    func_desc.job_config_proto.set_num_branch_compute_streams(value)
+
+
+@oneflow_function_config("enable_concurrent_execution")
+def set_enable_concurrent_execution(func_desc, value=True):
+    """Whether a predict job runs concurrently with the other concurrent jobs.
+            Concurrent jobs sharing variables only read them, so each gets its own memory
+            and GPU compute stream and they run at the same time, e.g. several copies of
+            one model serving small batches on one GPU.
+
+    Args:
+        func_desc ([type]): [description]
+        value ([type]): [description]
+    """
+    func_desc.job_config_proto.set_enable_concurrent_execution(value)
+
+
+@oneflow_function_config("mem_sharing_group")
+def set_mem_sharing_group(func_desc, value):
+    """Jobs of the same memory sharing group never run at the same time and share one
+            activation memory chunk per device, sized to the largest of them. E.g. put a
+            training job and its periodic eval job in one group so that the eval job costs
+            no extra device memory.
+
+    Args:
+        func_desc ([type]): [description]
+        value (str): the name of the group
+    """
+    func_desc.job_config_proto.set_mem_sharing_group(value)
+
+
 @oneflow_function_config("cudnn_conv_use_deterministic_algo_only")
 def set_cudnn_conv_use_deterministic_algo_only(func_desc, value):
     """Set value to cudnn conv_use_deterministic_only algorithm
@@ -506,6 +711,18 @@ def set_enable_inplace_in_reduce_struct(func_desc, value=True):
     )
 
 
+@oneflow_function_config("enable_actor_chain_merging")
+def set_enable_actor_chain_merging(func_desc, value=True):
+    """Whether run a chain of ops on the same stream, each the sole consumer of the previous
+        one, in one actor, which saves the messages between their actors
+
+    Args:
+        func_desc ([type]): [description]
+        value (bool, optional): [description]. Defaults to True.
+    """
+    func_desc.job_config_proto.set_enable_actor_chain_merging(value)
+
+
 @oneflow_function_config("enable_nccl")
 def set_enable_nccl(func_desc, value=True):
     print(
@@ -585,7 +802,7 @@ def set_optimizer_placement_optimization_mode(func_desc, mode):
         func_desc ([type]): [description]
         mode (str): [description].
     """
-    assert mode in ["non_distributed", "distributed_split"]
+    assert mode in ["non_distributed", "distributed_split", "zero"]
     func_desc.job_config_proto.set_optimizer_placement_optimization_mode(mode)
 
 
@@ -627,6 +844,94 @@ def set_prune_parallel_cast_ops(func_desc, value=True):
     func_desc.job_config_proto.set_prune_parallel_cast_ops(value)
 
 
+@oneflow_function_config("enable_auto_parallel")
+def set_enable_auto_parallel(func_desc, value=True):
+    """If true, then job will search sbp signatures of ops by a cost model instead of keeping the greedily inferred ones.
+
+    Args:
+        func_desc ([type]): [description]
+        value (bool, optional): [description]. Defaults to True.
+    """
+    func_desc.job_config_proto.set_enable_auto_parallel(value)
+
+
+@oneflow_function_config("auto_parallel.device_memory_bandwidth_gbyte_per_sec")
+def set_auto_parallel_device_memory_bandwidth(func_desc, value: float):
+    func_desc.job_config_proto.mutable_auto_parallel_conf().set_device_memory_bandwidth_gbyte_per_sec(
+        value
+    )
+
+
+@oneflow_function_config("auto_parallel.intra_node_bandwidth_gbyte_per_sec")
+def set_auto_parallel_intra_node_bandwidth(func_desc, value: float):
+    func_desc.job_config_proto.mutable_auto_parallel_conf().set_intra_node_bandwidth_gbyte_per_sec(
+        value
+    )
+
+
+@oneflow_function_config("auto_parallel.inter_node_bandwidth_gbyte_per_sec")
+def set_auto_parallel_inter_node_bandwidth(func_desc, value: float):
+    func_desc.job_config_proto.mutable_auto_parallel_conf().set_inter_node_bandwidth_gbyte_per_sec(
+        value
+    )
+
+
+@oneflow_function_config("auto_parallel.boxing_latency_us")
+def set_auto_parallel_boxing_latency_us(func_desc, value: float):
+    func_desc.job_config_proto.mutable_auto_parallel_conf().set_boxing_latency_us(value)
+
+
+@oneflow_function_config("auto_parallel.max_iterations")
+def set_auto_parallel_max_iterations(func_desc, value: int):
+    func_desc.job_config_proto.mutable_auto_parallel_conf().set_max_iterations(value)
+
+
+@oneflow_function_config("auto_parallel.max_candidates_per_op")
+def set_auto_parallel_max_candidates_per_op(func_desc, value: int):
+    func_desc.job_config_proto.mutable_auto_parallel_conf().set_max_candidates_per_op(value)
+
+
+@oneflow_function_config("auto_checkpointing_memory_budget_mbyte")
+def set_auto_checkpointing_memory_budget_mbyte(func_desc, value):
+    """Recompute forward activations in backward automatically until the estimated peak memory of each device fits the budget, e.g. 16384mb. 0 disables it.
+
+    Args:
+        func_desc ([type]): [description]
+        value ([type]): [description]
+    """
+    func_desc.job_config_proto.set_auto_checkpointing_memory_budget_mbyte(value)
+
+
+@oneflow_function_config("enable_activation_offloading")
+def set_enable_activation_offloading(func_desc, value=True):
+    """If true, then forward activations waiting long for backward are offloaded to host memory and prefetched back before use.
+
+    Args:
+        func_desc ([type]): [description]
+        value (bool, optional): [description]. Defaults to True.
+    """
+    func_desc.job_config_proto.set_enable_activation_offloading(value)
+
+
+@oneflow_function_config("activation_offloading.min_blob_byte_size")
+def set_activation_offloading_min_blob_byte_size(func_desc, value: int):
+    func_desc.job_config_proto.mutable_activation_offloading_conf().set_min_blob_byte_size(
+        value
+    )
+
+
+@oneflow_function_config("activation_offloading.min_lifetime_op_num")
+def set_activation_offloading_min_lifetime_op_num(func_desc, value: int):
+    func_desc.job_config_proto.mutable_activation_offloading_conf().set_min_lifetime_op_num(
+        value
+    )
+
+
+@oneflow_function_config("activation_offloading.prefetch_op_num")
+def set_activation_offloading_prefetch_op_num(func_desc, value: int):
+    func_desc.job_config_proto.mutable_activation_offloading_conf().set_prefetch_op_num(value)
+
+
 @oneflow_function_config("prune_cast_to_static_shape_ops")
 def set_prune_cast_to_static_shape_ops(func_desc, value=True):
     """Whether or not set prune_cast to static shape opretions
@@ -709,6 +1014,18 @@ def set_enable_quantization_aware_training(func_desc, value=True):
     func_desc.job_config_proto.set_enable_quantization_aware_training(value)
 
 
+@oneflow_function_config("enable_int8_inference")
+def set_enable_int8_inference(func_desc, value=True):
+    """If true, the matmuls of a predict job fake quantized by quantization aware
+            training run on int8 with the scales of the fake quantizations
+
+    Args:
+        func_desc ([type]): [description]
+        value (bool, optional): [description]. Defaults to True.
+    """
+    func_desc.job_config_proto.set_enable_int8_inference(value)
+
+
 @oneflow_function_config("qat.per_channel_weight_quantization")
 def set_qat_per_channel(func_desc, value=True):
     func_desc.job_config_proto.mutable_qat_config().set_per_channel_weight_quantization(
@@ -749,6 +1066,22 @@ def set_enable_auto_mixed_precision(func_desc, value=True):
     func_desc.job_config_proto.set_enable_auto_mixed_precision(value)
 
 
+@oneflow_function_config("auto_mixed_precision_data_type")
+def set_auto_mixed_precision_data_type(func_desc, value):
+    """Set the low precision data type used by auto mixed precision, flow.float16 or flow.bfloat16.
+    bfloat16 keeps the exponent range of float32, so it can be trained without loss scaling.
+
+    Args:
+        func_desc ([type]): job function
+        value ([type]): data type. e.g. flow.bfloat16
+    """
+    func_desc.job_config_proto.set_auto_mixed_precision_data_type(
+        data_type_cfg.DataType(
+            oneflow._oneflow_internal.deprecated.GetProtoDtype4OfDtype(value)
+        )
+    )
+
+
 @oneflow_function_config("enable_keep_header_only")
 def set_enable_keep_header_only(func_desc, value=True):
     """deprecated api.
@@ -875,6 +1208,18 @@ def set_num_gradient_accumulation_steps(func_desc, value):
     func_desc.job_config_proto.set_num_gradient_accumulation_steps(value)
 
 
+@oneflow_function_config("train.pipeline_schedule")
+def set_pipeline_schedule(func_desc, value):
+    """Set the pipeline schedule of pipeline parallel jobs
+
+    Args:
+        func_desc ([type]): [description]
+        value (str): "gpipe" or "1f1b".
+    """
+    assert value in ["gpipe", "1f1b"]
+    func_desc.job_config_proto.set_pipeline_schedule(value)
+
+
 @oneflow_function_config("default_placement_scope")
 def set_default_placement(func_desc, value):
     """Set the default placement for job
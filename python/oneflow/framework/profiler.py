@@ -30,3 +30,116 @@ def ProfilerStart():
 
 def ProfilerStop():
     oneflow._oneflow_internal.profiler.ProfilerStop()
+
+
+def EnableHostTracing():
+    oneflow._oneflow_internal.profiler.EnableHostTracing()
+
+
+def DisableHostTracing():
+    oneflow._oneflow_internal.profiler.DisableHostTracing()
+
+
+def IsHostTracingEnabled():
+    return oneflow._oneflow_internal.profiler.IsHostTracingEnabled()
+
+
+def DumpHostTrace(path):
+    """Write the host ranges traced so far to `path` as chrome trace json.
+
+    The file can be opened by chrome://tracing or Perfetto UI.
+    """
+    oneflow._oneflow_internal.profiler.DumpHostTrace(path)
+
+
+def ClearHostTrace():
+    oneflow._oneflow_internal.profiler.ClearHostTrace()
+
+
+def EnableKernelTiming():
+    oneflow._oneflow_internal.profiler.EnableKernelTiming()
+
+
+def DisableKernelTiming():
+    oneflow._oneflow_internal.profiler.DisableKernelTiming()
+
+
+def IsKernelTimingEnabled():
+    return oneflow._oneflow_internal.profiler.IsKernelTimingEnabled()
+
+
+def GetKernelTimingTable():
+    """Return the cuda kernel timings collected so far, one dict per op, sorted by total time.
+
+    Each dict has the keys op_type_name, op_name, call_cnt, total_ms, mean_ms, p99_ms,
+    total_bytes and total_flops. total_flops is 0 for kernels that do not declare their
+    flops. Only kernels that have finished on their streams are counted.
+    """
+    return oneflow._oneflow_internal.profiler.GetKernelTimingTable()
+
+
+def GetKernelRooflineTable(peak_gbps, peak_gflops):
+    """Return the kernel timings annotated against a roofline of the given device peaks.
+
+    Each dict of GetKernelTimingTable gets the keys gbps and gflops achieved, intensity in
+    flops per byte, bound_gflops the roofline allows at that intensity and efficiency of the
+    kernel against its bound. Kernels without declared flops are measured against the
+    bandwidth alone. The table is sorted by the time lost to the roofline, so the first rows
+    are the kernels worth optimizing.
+    """
+    table = []
+    for item in GetKernelTimingTable():
+        seconds = item["total_ms"] / 1000.0
+        if seconds <= 0:
+            continue
+        gbps = item["total_bytes"] / seconds / 1e9
+        gflops = item["total_flops"] / seconds / 1e9
+        if item["total_flops"] > 0 and item["total_bytes"] > 0:
+            intensity = item["total_flops"] / item["total_bytes"]
+            bound_gflops = min(peak_gflops, intensity * peak_gbps)
+            efficiency = gflops / bound_gflops
+        else:
+            intensity = 0.0
+            bound_gflops = 0.0
+            efficiency = gbps / peak_gbps
+        item["gbps"] = gbps
+        item["gflops"] = gflops
+        item["intensity"] = intensity
+        item["bound_gflops"] = bound_gflops
+        item["efficiency"] = efficiency
+        table.append(item)
+    table.sort(
+        key=lambda item: item["total_ms"] * (1 - min(item["efficiency"], 1.0)),
+        reverse=True,
+    )
+    return table
+
+
+def ResetKernelTiming():
+    oneflow._oneflow_internal.profiler.ResetKernelTiming()
+
+
+def EnableHostStageTiming():
+    oneflow._oneflow_internal.profiler.EnableHostStageTiming()
+
+
+def DisableHostStageTiming():
+    oneflow._oneflow_internal.profiler.DisableHostStageTiming()
+
+
+def IsHostStageTimingEnabled():
+    return oneflow._oneflow_internal.profiler.IsHostStageTimingEnabled()
+
+
+def GetHostStageTimingTable():
+    """Return the host time of the eager op call path, one dict per stage, summed over threads.
+
+    The stages are python_binding, functor, dispatch, infer, instructions_builder and
+    vm_schedule. Each dict has the keys stage, call_cnt, total_us, self_us and mean_us, where
+    total_us includes the nested stages and self_us does not.
+    """
+    return oneflow._oneflow_internal.profiler.GetHostStageTimingTable()
+
+
+def ResetHostStageTiming():
+    oneflow._oneflow_internal.profiler.ResetHostStageTiming()
@@ -46,6 +46,21 @@ def _tensor_numpy(eager_local_tensor):
     return ndarray
 
 
+def _tensor_numpy_async(eager_local_tensor):
+    """Starts copying the tensor to host memory and returns a TensorFetchFuture at once.
+
+    `future.done()` polls without blocking, `future.wait()` blocks until the copy is
+    complete and `future.numpy()` waits and returns the copy as a numpy.ndarray.
+    """
+    assert (
+        eager_local_tensor.is_local
+    ), "only local tensors can be fetched asynchronously"
+    assert (
+        eager_local_tensor.dtype != flow.tensor_buffer
+    ), "tensor_buffer can not be fetched asynchronously"
+    return flow._oneflow_internal.async_fetch_tensor(eager_local_tensor)
+
+
 def _size(self, idx=None):
     if idx is None:
         return self.shape
@@ -317,6 +332,7 @@ def RegisterMethods():
     Tensor.tolist = lambda self: self.numpy().tolist()
     Tensor.ndim = property(_ndim)
     Tensor.numpy = _tensor_numpy
+    Tensor.numpy_async = _tensor_numpy_async
     Tensor.size = _size
     Tensor.dim = _ndim
     Tensor.ndimension = _ndim
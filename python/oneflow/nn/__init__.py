@@ -42,6 +42,7 @@ from oneflow.nn.modules.adaptive_pool import (
     AdaptiveAvgPool3d,
 )
 from oneflow.nn.modules.batchnorm import BatchNorm1d, BatchNorm2d, BatchNorm3d
+from oneflow.nn.modules.cached_embedding import CachedEmbedding
 from oneflow.nn.modules.container import (
     ModuleDict,
     ModuleList,
@@ -59,6 +60,7 @@ from oneflow.nn.modules.dataset import (
     OfrecordRawDecoder,
     OfrecordReader,
     OFRecordBytesDecoder,
+    RandomResizedCropMirrorNormalize,
 )
 from oneflow.nn.modules.deconv import ConvTranspose2d
 from oneflow.nn.modules.dropout import Dropout
@@ -81,7 +83,7 @@ from oneflow.nn.modules.loss import (
     NLLLoss,
     SmoothL1Loss,
 )
-from oneflow.nn.modules.normalization import GroupNorm, LayerNorm
+from oneflow.nn.modules.normalization import GroupNorm, LayerNorm, RMSNorm
 from oneflow.nn.modules.padding import (
     ConstantPad1d,
     ConstantPad2d,
@@ -107,5 +109,6 @@ from oneflow.nn.modules.upsampling import (
 from oneflow.nn.modules.zeropad2d import ZeroPad2d
 from oneflow.nn.parameter import Parameter
 from oneflow.nn import utils
+from oneflow.nn import parallel
 
 from . import functional
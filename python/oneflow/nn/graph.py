@@ -45,6 +45,11 @@ class Graph(object):
         self._variables_conf = OrderedDict()
         self._is_compiled = False
         self._job_proto = None
+        # Compiled runtimes are cached per input signature (shapes and dtypes of
+        # the inputs), they share the parameter and buffer tensors of the graph.
+        self._base_name = self._name
+        self._signature = None
+        self._signature2compiled = OrderedDict()
 
     @property
     def name(self):
@@ -175,6 +180,8 @@ class Graph(object):
 
             self._outputs = convert_to_tensor_tuple(eager_outputs)
             self._eager_outputs = eager_outputs
+            self._outputs_buffer = [(self._outputs, self._eager_outputs)]
+            self._outputs_buffer_idx = 0
 
             # Register input/output/variable to _c_nn_graph
             self._c_nn_graph.register_input_op_names(lazy_arg_op_names)
@@ -191,19 +198,91 @@ class Graph(object):
         self._is_compiled = True
         return eager_outputs
 
+    def _new_outputs(self):
+        outputs = [oneflow.F.zeros_like(out) for out in self._outputs]
+        if self._eager_outputs is None:
+            eager_outputs = None
+        elif isinstance(self._eager_outputs, tuple):
+            eager_outputs = tuple(outputs)
+        else:
+            eager_outputs = outputs[0]
+        return (convert_to_tensor_tuple(outputs), eager_outputs)
+
+    def _next_outputs(self):
+        # Each launch writes into the next set of output tensors in a ring, so the
+        # outputs returned by a step stay valid while the following steps are in flight.
+        idx = self._outputs_buffer_idx
+        self._outputs_buffer_idx = (idx + 1) % self.config._outputs_buffer_size
+        if idx == len(self._outputs_buffer):
+            self._outputs_buffer.append(self._new_outputs())
+        return self._outputs_buffer[idx]
+
     def _launch(self, *args):
         # oneflow._oneflow_internal.eager.multi_client.Sync() NOTE(chengcheng): Need Sync?
+        outputs, eager_outputs = self._next_outputs()
         oneflow._oneflow_internal.nn.graph.RunLazyNNGraph(
             convert_to_tensor_tuple(args),
-            self._outputs,
+            outputs,
             self._variables,
             self._c_nn_graph,
         )
-        return self._eager_outputs
+        return eager_outputs
+
+    def _input_signature(self, args):
+        return tuple((tuple(arg.shape), arg.dtype, arg.is_consistent) for arg in args)
+
+    def _reset_block_scopes(self):
+        for _, b in self._blocks.items():
+            for m in b.modules():
+                m._prev_scope = None
+                m._scope = None
+        for state_block in self._state():
+            state_block._prev_scope = None
+            state_block._scope = None
+            state_block._lazy_origin = None
+
+    def _switch_signature(self, signature, *args):
+        self._signature2compiled[self._signature] = (
+            self._name,
+            self._c_nn_graph,
+            self._outputs,
+            self._eager_outputs,
+            self._outputs_buffer,
+            self._outputs_buffer_idx,
+            self._job_proto,
+        )
+        self._signature = signature
+        if signature in self._signature2compiled:
+            (
+                self._name,
+                self._c_nn_graph,
+                self._outputs,
+                self._eager_outputs,
+                self._outputs_buffer,
+                self._outputs_buffer_idx,
+                self._job_proto,
+            ) = self._signature2compiled[signature]
+            return
+        assert len(self._optimizers_conf) == 0, (
+            "nn.Graph "
+            + self._base_name
+            + " with optimizers can not be recompiled for new input shapes, because"
+            + " each compiled job would own a separate copy of the optimizer states."
+        )
+        self._name = self._base_name + "_" + str(len(self._signature2compiled))
+        self.config.proto.set_job_name(self._name)
+        self._c_nn_graph = oneflow._oneflow_internal.nn.graph.CNNGraph(self._name)
+        self._reset_block_scopes()
+        self._is_compiled = False
+        self._compile(*args)
 
     def __call__(self, *args):
+        signature = self._input_signature(args)
         if not self._is_compiled:
+            self._signature = signature
             self._compile(*args)
+        elif signature != self._signature:
+            self._switch_signature(signature, *args)
         return self._launch(*args)
 
     def _add_block(self, name: str, module: Module = None) -> None:
@@ -272,6 +351,7 @@ class GraphConfig(FunctionConfig):
     def __init__(self):
         super().__init__()
         self._train(False)
+        self._outputs_buffer_size = 2
 
     @property
     def proto(self):
@@ -285,6 +365,21 @@ class GraphConfig(FunctionConfig):
             return False
         raise NotImplementedError
 
+    def set_outputs_buffer_size(self, value: int = 2):
+        r"""Set the number of output tensor sets that graph launches rotate through.
+
+        A graph call returns as soon as its step is submitted and the returned
+        tensors are only synchronized when they are read. With a buffer of size n,
+        the outputs of a step are not overwritten until n more steps are launched,
+        so up to n steps can be in flight while Python holds on to earlier results.
+
+        Args:
+            value (int): the number of output tensor sets, at least 1. Default to 2.
+        """
+        assert type(value) is int
+        assert value >= 1
+        self._outputs_buffer_size = value
+
     def _train(self, mode: bool = True):
         if mode:
             self.proto.mutable_train_conf()
@@ -0,0 +1,127 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+import numpy as np
+
+import oneflow as flow
+from oneflow.nn.module import Module
+
+
+class CachedEmbedding(Module):
+    """An embedding table that does not have to fit in GPU memory.
+
+    The rows live in three tiers: the hot rows in a cache of
+    ``device_cache_capacity`` rows on the GPU, the rows evicted from it in an LRU cache
+    of ``host_cache_capacity`` rows in host memory, and all the rows in a file under
+    ``path``. A row that has never been trained is initialized uniformly in
+    ``[-initializer_scale, initializer_scale]``.
+
+    The table is not a parameter. The rows are trained by :meth:`apply_gradients`
+    after the backward, with SGD on the rows in the GPU cache, before the next lookup.
+    The rows are persisted by :meth:`save` and restored by :meth:`load`.
+
+    Args:
+        name (str): the name of the table, shared by the modules that look it up
+        embedding_dim (int): the size of each row
+        path (str): the directory of the file with all the rows
+        device_cache_capacity (int): the rows on the GPU, at least the distinct ids of
+            a batch
+        host_cache_capacity (int): the rows in host memory
+        initializer_scale (float): the scale of the initial rows. Default: 0.05
+        seed (int): the seed of the initial rows. Default: 0
+
+    For example:
+
+    .. code-block:: python
+
+        >>> import oneflow as flow
+        >>> m = flow.nn.CachedEmbedding("user", 16, "/tmp/user_embedding", 1024, 4096) # doctest: +SKIP
+        >>> ids = flow.Tensor([[1, 2], [2, 9]], dtype=flow.int64, device="cuda") # doctest: +SKIP
+        >>> y = m(ids) # doctest: +SKIP
+        >>> y.sum().backward() # doctest: +SKIP
+        >>> m.apply_gradients(0.1) # doctest: +SKIP
+
+    """
+
+    def __init__(
+        self,
+        name: str,
+        embedding_dim: int,
+        path: str,
+        device_cache_capacity: int,
+        host_cache_capacity: int,
+        initializer_scale: float = 0.05,
+        seed: int = 0,
+    ):
+        super().__init__()
+        self.name = name
+        self.embedding_dim = embedding_dim
+        self.path = path
+        self.device_cache_capacity = device_cache_capacity
+        self.host_cache_capacity = host_cache_capacity
+        self.initializer_scale = initializer_scale
+        self.seed = seed
+        self._lookups = []
+
+    def forward(self, ids):
+        (out, slots) = flow.F.cached_embedding_lookup(
+            ids,
+            name=self.name,
+            path=self.path,
+            embedding_size=self.embedding_dim,
+            device_cache_capacity=self.device_cache_capacity,
+            host_cache_capacity=self.host_cache_capacity,
+            initializer_scale=self.initializer_scale,
+            seed=self.seed,
+        )
+        if self.training:
+            out.requires_grad = True
+            self._lookups.append((out, slots))
+        return out
+
+    def apply_gradients(self, learning_rate: float):
+        """Applies the grads of the lookups since the last call to their rows."""
+        for (out, slots) in self._lookups:
+            if out.grad is not None:
+                flow.F.cached_embedding_update(
+                    slots, out.grad, name=self.name, learning_rate=learning_rate
+                )
+        self._lookups = []
+
+    def prefetch(self, ids):
+        """Reads the rows of the ids of a coming batch into the host cache."""
+        ids = ids.numpy() if isinstance(ids, flow.Tensor) else np.asarray(ids)
+        flow._oneflow_internal.embedding.Prefetch(
+            self.name, ids.astype(np.int64).reshape(-1).tolist()
+        )
+
+    def save(self, path: str):
+        flow._oneflow_internal.eager.multi_client.Sync()
+        flow._oneflow_internal.embedding.Save(self.name, path)
+
+    def load(self, path: str):
+        flow._oneflow_internal.eager.multi_client.Sync()
+        flow._oneflow_internal.embedding.Load(self.name, path)
+
+    def extra_repr(self) -> str:
+        return "name={}, embedding_dim={}, path={}".format(
+            self.name, self.embedding_dim, self.path
+        )
+
+
+if __name__ == "__main__":
+    import doctest
+
+    doctest.testmod(raise_on_error=True)
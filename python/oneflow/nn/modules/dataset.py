@@ -180,6 +180,102 @@ class CropMirrorNormalize(Module):
         return res
 
 
+class RandomResizedCropMirrorNormalize(Module):
+    """Augments a batch of decoded images of any sizes on the GPU in one pass.
+
+    The crop windows and the color jitter factors of the images are drawn on the host
+    from the shapes of the images. The images, padded to the size of the largest one,
+    are copied to the GPU once and go through a single kernel that crops, resizes
+    bilinearly to ``size``, mirrors, applies the brightness and contrast factors,
+    normalizes and writes ``output_layout``.
+
+    Args:
+        size (Sequence[int]): the height and width of the output images
+        max_size (Sequence[int]): the largest height and width of the input images
+        brightness (float): the brightness factors are drawn from
+            ``[max(0, 1 - brightness), 1 + brightness]``. Default: 0
+        contrast (float): the contrast factors are drawn from
+            ``[max(0, 1 - contrast), 1 + contrast]``, around the gray level 128.
+            Default: 0
+        output_dtype (flow.dtype): ``flow.float`` or ``flow.float16``
+    """
+
+    def __init__(
+        self,
+        size: Sequence[int],
+        max_size: Sequence[int],
+        color_space: str = "BGR",
+        output_layout: str = "NCHW",
+        mean: Sequence[float] = [0.0],
+        std: Sequence[float] = [1.0],
+        output_dtype: flow.dtype = flow.float,
+        brightness: float = 0.0,
+        contrast: float = 0.0,
+        num_attempts: int = 10,
+        random_seed: Optional[int] = None,
+        random_area: Sequence[float] = [0.08, 1.0],
+        random_aspect_ratio: Sequence[float] = [0.75, 1.333333],
+    ):
+        super().__init__()
+        (seed, has_seed) = mirrored_gen_random_seed(random_seed)
+        self._params_op = (
+            flow.builtin_op("image_random_augment_params")
+            .Input("in")
+            .Output("crop_window")
+            .Output("color_jitter")
+            .Attr("num_attempts", num_attempts)
+            .Attr("seed", seed)
+            .Attr("has_seed", has_seed)
+            .Attr("random_area", random_area)
+            .Attr("random_aspect_ratio", random_aspect_ratio)
+            .Attr("brightness", brightness)
+            .Attr("contrast", contrast)
+            .Build()
+        )
+        self._ops = []
+        for with_mirror in [False, True]:
+            builder = (
+                flow.builtin_op("crop_resize_mirror_normalize_from_uint8")
+                .Input("in")
+                .Input("crop_window")
+            )
+            if with_mirror:
+                builder = builder.Input("mirror")
+            self._ops.append(
+                builder.Input("color_jitter")
+                .Output("out")
+                .Attr("color_space", color_space)
+                .Attr("output_layout", output_layout)
+                .Attr("mean", mean)
+                .Attr("std", std)
+                .Attr("target_h", size[0])
+                .Attr("target_w", size[1])
+                .Attr("output_dtype", output_dtype)
+                .Build()
+            )
+        channels = 1 if color_space == "GRAY" else 3
+        self._align_op = (
+            flow.builtin_op("image_batch_align")
+            .Input("in")
+            .Output("out")
+            .Attr("shape", [max_size[0], max_size[1], channels])
+            .Attr("data_type", flow.uint8)
+            .Attr("alignment", 1)
+            .Attr("dynamic_out", True)
+            .Build()
+        )
+
+    def forward(self, images, mirror=None):
+        (crop_window, color_jitter) = self._params_op(images)
+        aligned_images = self._align_op(images)[0]
+        device = flow.device("cuda")
+        inputs = [aligned_images.to(device), crop_window.to(device)]
+        if mirror is not None:
+            inputs.append(mirror.to(device))
+        inputs.append(color_jitter.to(device))
+        return self._ops[1 if mirror is not None else 0](*inputs)[0]
+
+
 class OFRecordImageDecoderRandomCrop(Module):
     def __init__(
         self,
@@ -318,6 +318,106 @@ class LayerNorm(Module):
         )
 
 
+class RMSNorm(Module):
+    """Applies Root Mean Square Layer Normalization over a mini-batch of inputs as
+    described in the paper `Root Mean Square Layer Normalization <https://arxiv.org/abs/1910.07467>`__
+
+    .. math::
+        y = \\frac{x}{\\sqrt{\\mathrm{E}[x^2] + \\epsilon}} * \\gamma
+
+    The root mean square is calculated over the last certain number dimensions
+    which have to be of the shape specified by :attr:`normalized_shape`.
+
+    When ``residual`` is passed to :meth:`forward`, ``x + residual`` is normalized
+    instead, and the sum is returned along with the output so that it can be fed
+    to the next block as the residual. The add is fused into the normalization
+    kernel on cuda.
+
+    Args:
+        normalized_shape (int or list or oneflow.Size): the trailing shape of the input
+            to be normalized.
+        eps: a value added to the denominator for numerical stability. Default: 1e-5
+        elementwise_affine: a boolean value that when set to ``True``, this module
+            has learnable per-element weights initialized to ones. Default: ``True``.
+
+    Shape:
+        - Input: :math:`(N, *)`
+        - Output: :math:`(N, *)` (same shape as input)
+
+    For example:
+
+    .. code-block:: python
+
+        >>> import oneflow as flow
+
+        >>> x = flow.Tensor(2, 3, 4)
+        >>> m = flow.nn.RMSNorm(4)
+        >>> y = m(x)
+        >>> y.shape
+        flow.Size([2, 3, 4])
+
+    """
+
+    __constants__ = ["normalized_shape", "eps", "elementwise_affine"]
+    normalized_shape: Tuple[int, ...]
+    eps: float
+    elementwise_affine: bool
+
+    def __init__(
+        self,
+        normalized_shape: _shape_t,
+        eps: float = 1e-05,
+        elementwise_affine: bool = True,
+    ) -> None:
+        super().__init__()
+        if isinstance(normalized_shape, int):
+            normalized_shape = (normalized_shape,)
+        self.normalized_shape = tuple(normalized_shape)
+        self.eps = eps
+        self.elementwise_affine = elementwise_affine
+        if self.elementwise_affine:
+            self.weight = flow.nn.Parameter(flow.Tensor(*self.normalized_shape))
+        else:
+            self.register_parameter("weight", None)
+        self.reset_parameters()
+
+    def reset_parameters(self) -> None:
+        if self.elementwise_affine:
+            init.ones_(self.weight)
+
+    def forward(self, x, residual=None):
+        assert len(x.shape) > len(
+            self.normalized_shape
+        ), "Input tensor dim must greater than normalized dim!"
+        begin_norm_axis = len(x.shape) - len(self.normalized_shape)
+        if x.device == flow.device("cpu"):
+            if residual is not None:
+                x = x + residual
+            reduce_axis = list(range(begin_norm_axis, len(x.shape)))
+            mean_square = (x * x).mean(dim=reduce_axis, keepdim=True)
+            y = x * (mean_square + self.eps).rsqrt()
+            if self.weight is not None:
+                y = y * self.weight
+            return y if residual is None else (y, x)
+        if residual is not None:
+            return tuple(
+                flow.F.fused_add_rms_norm(
+                    x,
+                    residual,
+                    begin_norm_axis=begin_norm_axis,
+                    epsilon=self.eps,
+                    weight=self.weight,
+                )
+            )
+        return flow.F.rms_norm(
+            x, begin_norm_axis=begin_norm_axis, epsilon=self.eps, weight=self.weight
+        )
+
+    def extra_repr(self) -> str:
+        return "{normalized_shape}, eps={eps}, elementwise_affine={elementwise_affine}".format(
+            **self.__dict__
+        )
+
 if __name__ == "__main__":
     import doctest
 
@@ -99,6 +99,9 @@ class Embedding(Module):
                 self.weight[self.padding_idx].fill_(0)
 
     def forward(self, indices):
+        if self.weight.is_cuda:
+            # deduplicates the indices so that the backward only touches their rows
+            return flow.F.embedding_lookup(self.weight, indices)
         res = flow.F.gather(self.weight, indices, axis=0)
         return res
 
@@ -130,9 +130,24 @@ class Adam(Optimizer):
                     "beta2": param_group["betas"][1],
                     "epsilon": param_group["eps"],
                 }
-                for param in param_group.parameters:
-                    if param.grad is None:
+                params = [p for p in param_group.parameters if p.grad is not None]
+                if all(not p.is_consistent for p in params):
+                    if len(params) == 0:
                         continue
+                    flow.F.multi_tensor_adam_update(
+                        params,
+                        [p.grad for p in params],
+                        [self._state[p]["exp_avg"] for p in params],
+                        [self._state[p]["exp_avg_sq"] for p in params],
+                        learning_rate=kwargs["learning_rate_val"],
+                        scale=kwargs["scale"],
+                        l2=kwargs["l2"],
+                        beta1=kwargs["beta1"],
+                        beta2=kwargs["beta2"],
+                        epsilon=kwargs["epsilon"],
+                    )
+                    continue
+                for param in params:
                     m_tensor = self._state[param]["exp_avg"]
                     v_tensor = self._state[param]["exp_avg_sq"]
                     self._op(param, param.grad, m_tensor, v_tensor, **kwargs)
@@ -108,9 +108,30 @@ class SGD(Optimizer):
                 lr = param_group["lr"]
                 scale = param_group["scale"]
                 l2 = param_group["weight_decay"]
-                for param in param_group.parameters:
-                    if param.grad is None:
+                params = [p for p in param_group.parameters if p.grad is not None]
+                if all(not p.is_consistent for p in params):
+                    if len(params) == 0:
                         continue
+                    if param_group["momentum"] == 0.0:
+                        flow.F.multi_tensor_sgd_update(
+                            params,
+                            [p.grad for p in params],
+                            learning_rate=lr,
+                            scale=scale,
+                            l2=l2,
+                        )
+                    else:
+                        flow.F.multi_tensor_momentum_update(
+                            params,
+                            [p.grad for p in params],
+                            [self._state[p]["momentum_buf"] for p in params],
+                            learning_rate=lr,
+                            beta=param_group["momentum"],
+                            scale=scale,
+                            l2=l2,
+                        )
+                    continue
+                for param in params:
                     if param_group["momentum"] == 0.0:
                         self._sgd(
                             param, param.grad, learning_rate_val=lr, l2=l2, scale=scale
@@ -0,0 +1,151 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+from typing import List
+
+import numpy as np
+import oneflow as flow
+
+from oneflow.framework.dtype import convert_oneflow_dtype_to_numpy_dtype
+from oneflow.framework.tensor import Tensor
+from oneflow.nn.module import Module
+
+
+def _all_ranks_parallel_conf() -> str:
+    node_size = flow._oneflow_internal.GetNodeSize()
+    device_num_per_node = flow.distributed.get_world_size() // node_size
+    return 'device_tag: "gpu", device_name: "0-{}:0-{}"'.format(
+        node_size - 1, device_num_per_node - 1
+    )
+
+
+class _GradBucket(object):
+    def __init__(self, params: List[Tensor]):
+        self.params = params
+        self.numels = [p.numel() for p in params]
+        self.ready_param_num = 0
+
+    def is_ready(self):
+        return self.ready_param_num == len(self.params)
+
+
+class DistributedDataParallel(Module):
+    r"""Averages the gradients of the wrapped `module` over all ranks in eager mode.
+
+    Parameters are assigned to buckets of at most `bucket_size_mb` megabytes in the reverse order
+    of `module.parameters()`, which is roughly the order their gradients are produced in. As soon as
+    the gradients of all parameters in a bucket are accumulated, the bucket is flattened and
+    all-reduced on the cuda comm stream, so communication overlaps with the rest of backward.
+
+    :meth:`sync_grads` must be called after backward and before the optimizer step. It launches
+    the buckets whose parameters did not all receive a gradient and resets the reducer for the next
+    iteration. The all-reduced gradients are ordered before the optimizer step by the virtual
+    machine, so no device synchronization is needed.
+
+    Args:
+        module (Module): the local module, whose parameters are on the cuda device of this rank.
+        bucket_size_mb (float): the upper bound of the size of a bucket. Default: 25.0
+
+    For example:
+
+    .. code-block:: python
+
+        >>> import oneflow as flow
+        >>> m = flow.nn.Linear(4, 4).to("cuda")  # doctest: +SKIP
+        >>> ddp_m = flow.nn.parallel.DistributedDataParallel(m)  # doctest: +SKIP
+        >>> ddp_m(flow.ones(2, 4, device="cuda")).sum().backward()  # doctest: +SKIP
+        >>> ddp_m.sync_grads()  # doctest: +SKIP
+
+    """
+
+    def __init__(self, module: Module, bucket_size_mb: float = 25.0):
+        super().__init__()
+        self.module = module
+        self.world_size = flow.distributed.get_world_size()
+        self._bucket_size_bytes = int(bucket_size_mb * 1024 * 1024)
+        self._all_reduce_op = None
+        if self.world_size > 1:
+            self._all_reduce_op = (
+                flow.builtin_op("eager_nccl_all_reduce")
+                .Input("in")
+                .Output("out")
+                .Attr("parallel_conf", _all_ranks_parallel_conf())
+                .Build()
+            )
+        params = [p for p in module.parameters() if p.requires_grad]
+        self._buckets = self._make_buckets(list(reversed(params)))
+        self._launched_buckets = set()
+        for bucket in self._buckets:
+            for param in bucket.params:
+                param._register_post_grad_accumulation_hook(
+                    self._make_post_acc_grad_hook(bucket)
+                )
+
+    def _make_buckets(self, params: List[Tensor]) -> List[_GradBucket]:
+        buckets = []
+        cur_params = []
+        cur_bytes = 0
+        for param in params:
+            np_dtype = np.dtype(convert_oneflow_dtype_to_numpy_dtype(param.dtype))
+            param_bytes = param.numel() * np_dtype.itemsize
+            # a bucket only holds one dtype and one device so that it can be flattened
+            if len(cur_params) > 0 and (
+                cur_bytes + param_bytes > self._bucket_size_bytes
+                or param.dtype != cur_params[0].dtype
+                or param.device != cur_params[0].device
+            ):
+                buckets.append(_GradBucket(cur_params))
+                cur_params = []
+                cur_bytes = 0
+            cur_params.append(param)
+            cur_bytes += param_bytes
+        if len(cur_params) > 0:
+            buckets.append(_GradBucket(cur_params))
+        return buckets
+
+    def _make_post_acc_grad_hook(self, bucket: _GradBucket):
+        def hook(grad):
+            bucket.ready_param_num += 1
+            if bucket.is_ready():
+                self._launch_bucket(bucket)
+
+        return hook
+
+    def _launch_bucket(self, bucket: _GradBucket):
+        if id(bucket) in self._launched_buckets:
+            return
+        self._launched_buckets.add(id(bucket))
+        params = [p for p in bucket.params if p.grad is not None]
+        if self._all_reduce_op is None or len(params) == 0:
+            return
+        flat_grad = flow.cat([p.grad.reshape(-1) for p in params], dim=0)
+        flat_grad = self._all_reduce_op(flat_grad)[0] / self.world_size
+        offset = 0
+        for param in params:
+            numel = param.numel()
+            grad = flow.F.slice(
+                flat_grad, start=[offset], stop=[offset + numel], step=[1]
+            )
+            param.grad = grad.reshape(param.shape)
+            offset += numel
+
+    def sync_grads(self):
+        for bucket in self._buckets:
+            self._launch_bucket(bucket)
+            bucket.ready_param_num = 0
+        self._launched_buckets.clear()
+
+    def forward(self, *args, **kwargs):
+        return self.module(*args, **kwargs)
@@ -13,7 +13,23 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License.
 """
+from oneflow.framework.profiler import ClearHostTrace as clear_host_trace
+from oneflow.framework.profiler import DisableHostTracing as disable_host_tracing
+from oneflow.framework.profiler import DumpHostTrace as dump_host_trace
+from oneflow.framework.profiler import DisableKernelTiming as disable_kernel_timing
+from oneflow.framework.profiler import EnableHostTracing as enable_host_tracing
+from oneflow.framework.profiler import EnableKernelTiming as enable_kernel_timing
+from oneflow.framework.profiler import GetKernelRooflineTable as get_kernel_roofline_table
+from oneflow.framework.profiler import GetKernelTimingTable as get_kernel_timing_table
+from oneflow.framework.profiler import IsHostTracingEnabled as is_host_tracing_enabled
+from oneflow.framework.profiler import IsKernelTimingEnabled as is_kernel_timing_enabled
 from oneflow.framework.profiler import ProfilerStart as profiler_start
 from oneflow.framework.profiler import ProfilerStop as profiler_stop
 from oneflow.framework.profiler import RangePop as range_pop
 from oneflow.framework.profiler import RangePush as range_push
+from oneflow.framework.profiler import ResetKernelTiming as reset_kernel_timing
+from oneflow.framework.profiler import DisableHostStageTiming as disable_host_stage_timing
+from oneflow.framework.profiler import EnableHostStageTiming as enable_host_stage_timing
+from oneflow.framework.profiler import GetHostStageTimingTable as get_host_stage_timing_table
+from oneflow.framework.profiler import IsHostStageTimingEnabled as is_host_stage_timing_enabled
+from oneflow.framework.profiler import ResetHostStageTiming as reset_host_stage_timing
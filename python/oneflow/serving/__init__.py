@@ -19,3 +19,4 @@ from oneflow.serving.inference_session import (
     ModelVersionPolicy,
     SessionOption,
 )
+from oneflow.serving.weight_only_quantization import quantize_saved_model_weights
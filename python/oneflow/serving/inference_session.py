@@ -60,6 +60,11 @@ def _find_model_latest_version(saved_model_dir):
     return version_dirs[0]
 
 
+def _shape_bucket_name(name, bucket_id):
+    # the same as ShapeBucketUtil::ShapeBucketJobName and ShapeBucketOpName
+    return "{}-Bucket{}".format(name, bucket_id)
+
+
 def _need_check_device_tag(op_conf):
     if op_conf.HasField("return_conf"):
         return False
@@ -144,6 +149,8 @@ class InferenceSession(object):
         self.inferface_name2info_ = {}
         self.output_name2future_ = {}
         self.job_futures_ = []
+        self.job_name2shape_buckets_ = {}
+        self.serving_ = False
         self.status_ = None
         self._init_event_loop()
         self.init()
@@ -168,6 +175,9 @@ class InferenceSession(object):
         self.status_ = self.SessionStatus.OPEN
 
     def close(self):
+        if self.serving_:
+            oneflow._oneflow_internal.StopInferenceServers()
+            self.serving_ = False
         self.event_loop_.run_until_complete(self.wait_for_all_jobs_finished())
         self.event_loop_.close()
         if self.status_ == self.SessionStatus.RUNNING:
@@ -224,6 +234,25 @@ class InferenceSession(object):
             mut_shape = mut_input_def.mutable_blob_conf().mutable_shape()
             mut_shape.mutable_dim()[0] = batch_size
 
+    def set_job_shape_buckets(self, job_name, buckets):
+        """Compile a copy of the job with static input shapes per bucket, `run` pads
+        the inputs to the smallest bucket holding them and returns the outputs of
+        that bucket. buckets is a list of dicts from input name to shape.
+        """
+        self._check_status(self.SessionStatus.OPEN)
+        job_conf = self._get_job_conf(job_name)
+        for bucket in buckets:
+            bucket_cfg = job_conf.mutable_shape_bucket().Add()
+            for (input_name, shape) in bucket.items():
+                shape_cfg = shape_proto_cfg.ShapeProto()
+                for dim in shape:
+                    shape_cfg.add_dim(dim)
+                bucket_cfg.mutable_input_op_name2shape()[input_name].CopyFrom(shape_cfg)
+        self.job_name2shape_buckets_[job_name] = [
+            {name: tuple(shape) for (name, shape) in bucket.items()}
+            for bucket in buckets
+        ]
+
     def _get_job_conf(self, job_name):
         if job_name in self.job_name2job_conf_:
             return self.job_name2job_conf_[job_name]
@@ -406,12 +435,85 @@ class InferenceSession(object):
 
     async def async_run(self, job_name, **kwargs):
         self._check_status(self.SessionStatus.RUNNING)
-        self._run_push_jobs(**kwargs)
-        job_inst = job_instance_util.MakeUserJobInstance(job_name)
+        bucket_id = None
+        run_job_name = job_name
+        if job_name in self.job_name2shape_buckets_:
+            (bucket_id, kwargs) = self._pad_to_shape_bucket(job_name, kwargs)
+            run_job_name = _shape_bucket_name(job_name, bucket_id)
+        self._run_push_jobs(bucket_id, **kwargs)
+        job_inst = job_instance_util.MakeUserJobInstance(run_job_name)
         self._run_job(job_inst)
-        output_futures = tuple(self._run_pull_jobs(job_name).values())
+        output_futures = tuple(self._run_pull_jobs(job_name, bucket_id).values())
         return await asyncio.gather(*output_futures)
 
+    def _pad_to_shape_bucket(self, job_name, kwargs):
+        selected_bucket_id = None
+        selected_elem_cnt = None
+        for (bucket_id, bucket) in enumerate(self.job_name2shape_buckets_[job_name]):
+            fits = True
+            elem_cnt = 0
+            for (input_name, shape) in bucket.items():
+                input_shape = np.shape(kwargs[input_name])
+                if len(input_shape) != len(shape) or any(
+                    dim > bucket_dim for (dim, bucket_dim) in zip(input_shape, shape)
+                ):
+                    fits = False
+                    break
+                elem_cnt += int(np.prod(shape))
+            if fits and (selected_elem_cnt is None or elem_cnt < selected_elem_cnt):
+                selected_bucket_id = bucket_id
+                selected_elem_cnt = elem_cnt
+        if selected_bucket_id is None:
+            raise ValueError("no shape bucket of job {} holds the inputs".format(job_name))
+        padded_kwargs = {}
+        for (input_name, value) in kwargs.items():
+            bucket = self.job_name2shape_buckets_[job_name][selected_bucket_id]
+            if input_name in bucket:
+                pad_width = [
+                    (0, bucket_dim - dim)
+                    for (dim, bucket_dim) in zip(value.shape, bucket[input_name])
+                ]
+                value = np.pad(value, pad_width, mode="constant")
+            padded_kwargs[_shape_bucket_name(input_name, selected_bucket_id)] = value
+        return (selected_bucket_id, padded_kwargs)
+
+    def _is_shape_bucket_op(self, op_name):
+        for (job_name, buckets) in self.job_name2shape_buckets_.items():
+            for bucket_id in range(len(buckets)):
+                suffix = _shape_bucket_name("", bucket_id)
+                if op_name.endswith(suffix):
+                    return True
+        return False
+
+    def _interface_items(self, op_name2job_name, bucket_id):
+        # the interface ops of the bucket jobs are only used by the bucket runs
+        for (op_name, job_name) in op_name2job_name.items():
+            if bucket_id is None:
+                if not self._is_shape_bucket_op(op_name):
+                    yield (op_name, job_name)
+            elif op_name.endswith(_shape_bucket_name("", bucket_id)):
+                yield (op_name, job_name)
+
+    def start_server(
+        self, job_name, max_batch_size, batch_timeout_us=1000, grpc_address=None
+    ):
+        """Serve job_name by the C++ inference server, which batches concurrent
+        requests on axis 0. Requests are sent through gRPC when grpc_address is set,
+        or through `serve`. Don't mix with `run` on the same session."""
+        self._check_status(self.SessionStatus.RUNNING)
+        self.event_loop_.run_until_complete(self.wait_for_all_jobs_finished())
+        oneflow._oneflow_internal.StartInferenceServer(
+            job_name, max_batch_size, batch_timeout_us
+        )
+        if grpc_address is not None:
+            oneflow._oneflow_internal.StartInferenceGrpcServer(grpc_address)
+        self.serving_ = True
+
+    def serve(self, serialized_request):
+        """Infer a serialized InferRequest, blocks until its batch finishes and
+        returns the serialized InferResponse. Thread safe."""
+        return oneflow._oneflow_internal.InferenceServerInfer(serialized_request)
+
     def _run_job(self, job_inst):
         future = self.event_loop_.create_future()
 
@@ -422,11 +524,10 @@ class InferenceSession(object):
         oneflow._oneflow_internal.LaunchJob(job_inst)
         self.job_futures_.append(future)
 
-    def _run_push_jobs(self, **kwargs):
-        for (
-            input_name,
-            push_job_name,
-        ) in self.inter_user_job_info_.input_or_var_op_name2push_job_name.items():
+    def _run_push_jobs(self, bucket_id=None, **kwargs):
+        for (input_name, push_job_name) in self._interface_items(
+            self.inter_user_job_info_.input_or_var_op_name2push_job_name, bucket_id
+        ):
             if input_name not in kwargs:
                 raise ValueError('input "{}" is absent'.format(input_name))
             input_numpy = kwargs[input_name]
@@ -438,14 +539,17 @@ class InferenceSession(object):
             )
             self._run_job(push_job_inst)
 
-    def _run_pull_jobs(self, user_job_name):
+    def _run_pull_jobs(self, user_job_name, bucket_id=None):
         output_futures = {}
-        for (
-            output_name,
-            pull_job_name,
-        ) in self.inter_user_job_info_.output_or_var_op_name2pull_job_name.items():
+        for (output_name, pull_job_name) in self._interface_items(
+            self.inter_user_job_info_.output_or_var_op_name2pull_job_name, bucket_id
+        ):
             future = self.event_loop_.create_future()
-            pull_fn = self._make_pull_job_cb(output_name, user_job_name, future)
+            user_output_name = output_name
+            if bucket_id is not None:
+                suffix = _shape_bucket_name("", bucket_id)
+                user_output_name = output_name[: -len(suffix)]
+            pull_fn = self._make_pull_job_cb(user_output_name, user_job_name, future)
             pull_job_inst = job_instance_util.MakePullJobInstance(
                 pull_job_name, output_name, pull_fn
             )
@@ -0,0 +1,226 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+import os
+import shutil
+
+import numpy as np
+from google.protobuf import text_format
+
+import oneflow.core.common.data_type_pb2 as data_type_pb
+import oneflow.core.framework.variable_meta_info_pb2 as variable_meta_info_pb
+import oneflow.core.serving.saved_model_pb2 as saved_model_pb
+
+_WEIGHT_SUFFIX = "-weight_only_quant"
+_SCALE_SUFFIX = "-weight_only_quant_scale"
+_MATMUL_OP_TYPES = ("matmul", "broadcast_matmul")
+
+
+def quantize_saved_model_weights(
+    saved_model_dir,
+    model_version,
+    output_version,
+    bits=8,
+    group_size=128,
+    saved_model_meta_file_basename="saved_model",
+):
+    """Write a copy of a version of a saved model whose float matmul weights are
+    quantized to int8 or packed int4 with one scale per group of `group_size`
+    elements along k, the matmuls reading them become weight_only_quantized_matmul.
+
+    Args:
+        saved_model_dir (str): the directory of the saved model
+        model_version (int): the version to convert
+        output_version (int): the version to write, it must not exist yet
+        bits (int, optional): 8 or 4. Defaults to 8.
+        group_size (int, optional): elements of k sharing a scale, a multiple of 8.
+            Defaults to 128.
+
+    Returns:
+        list: names of the quantized variables
+    """
+    if bits not in (8, 4):
+        raise ValueError("bits must be 8 or 4, but got {}".format(bits))
+    if group_size <= 0 or group_size % 8 != 0:
+        raise ValueError("group_size must be a positive multiple of 8")
+    src_path = os.path.join(saved_model_dir, str(model_version))
+    dst_path = os.path.join(saved_model_dir, str(output_version))
+    if os.path.exists(dst_path):
+        raise ValueError(
+            "version {} already exists in {}".format(output_version, saved_model_dir)
+        )
+    saved_model_proto = saved_model_pb.SavedModel()
+    meta_file_basename = saved_model_meta_file_basename
+    with open(os.path.join(src_path, meta_file_basename + ".pb"), "rb") as f:
+        saved_model_proto.ParseFromString(f.read())
+    src_checkpoint = os.path.join(src_path, saved_model_proto.checkpoint_dir)
+    dst_checkpoint = os.path.join(dst_path, saved_model_proto.checkpoint_dir)
+    os.makedirs(dst_checkpoint)
+
+    quantized = {}
+    kept_vars = set()
+    for (_, graph_def) in saved_model_proto.graphs.items():
+        var_confs = {
+            op_conf.name: op_conf
+            for op_conf in graph_def.op_list
+            if op_conf.HasField("variable_conf")
+        }
+        consumer_cnt = {}
+        for op_conf in graph_def.op_list:
+            for lbn in _InputLbns(op_conf):
+                consumer_cnt[lbn] = consumer_cnt.get(lbn, 0) + 1
+        new_var_confs = []
+        for op_conf in graph_def.op_list:
+            var_name = _QuantizableWeight(op_conf, var_confs)
+            if var_name is None:
+                continue
+            var_conf = var_confs[var_name]
+            transpose_b = op_conf.user_conf.attr["transpose_b"].at_bool
+            k = var_conf.variable_conf.shape.dim[1 if transpose_b else 0]
+            if k % group_size != 0:
+                continue
+            if var_name not in quantized:
+                weight = _ReadVariable(src_checkpoint, var_name)
+                quantized[var_name] = _QuantizeWeight(
+                    weight if transpose_b else weight.T, bits, group_size
+                )
+                (q, scale) = quantized[var_name]
+                _WriteVariable(dst_checkpoint, var_name + _WEIGHT_SUFFIX, q)
+                _WriteVariable(dst_checkpoint, var_name + _SCALE_SUFFIX, scale)
+                new_var_confs.append(_VariableConf(var_conf, _WEIGHT_SUFFIX, q))
+                new_var_confs.append(_VariableConf(var_conf, _SCALE_SUFFIX, scale))
+            _ToWeightOnlyQuantizedMatmul(
+                op_conf, var_name, var_conf.variable_conf.out, bits, group_size
+            )
+            consumer_cnt[var_name + "/" + var_conf.variable_conf.out] -= 1
+        unused_vars = [
+            name
+            for (name, var_conf) in var_confs.items()
+            if name in quantized
+            and consumer_cnt[name + "/" + var_conf.variable_conf.out] == 0
+        ]
+        op_list = [
+            op_conf for op_conf in graph_def.op_list if op_conf.name not in unused_vars
+        ]
+        kept_vars.update(op_conf.name for op_conf in op_list)
+        del graph_def.op_list[:]
+        graph_def.op_list.extend(op_list + new_var_confs)
+
+    for var_name in os.listdir(src_checkpoint):
+        src_var_path = os.path.join(src_checkpoint, var_name)
+        if not os.path.isdir(src_var_path):
+            continue
+        if var_name in quantized and var_name not in kept_vars:
+            continue
+        shutil.copytree(src_var_path, os.path.join(dst_checkpoint, var_name))
+    with open(os.path.join(dst_checkpoint, "snapshot_done"), "w"):
+        pass
+    saved_model_proto.version = output_version
+    with open(os.path.join(dst_path, meta_file_basename + ".pb"), "wb") as f:
+        f.write(saved_model_proto.SerializeToString())
+    with open(os.path.join(dst_path, meta_file_basename + ".prototxt"), "wt") as f:
+        f.write(text_format.MessageToString(saved_model_proto))
+    return sorted(quantized.keys())
+
+
+def _InputLbns(op_conf):
+    if not op_conf.HasField("user_conf"):
+        return []
+    return [
+        lbn for (_, lbns) in op_conf.user_conf.input.items() for lbn in lbns.s
+    ]
+
+
+def _QuantizableWeight(op_conf, var_confs):
+    if not op_conf.HasField("user_conf"):
+        return None
+    user_conf = op_conf.user_conf
+    if user_conf.op_type_name not in _MATMUL_OP_TYPES:
+        return None
+    if "_add_to_output" in user_conf.input or user_conf.attr["transpose_a"].at_bool:
+        return None
+    if user_conf.attr["alpha"].at_double != 1.0:
+        return None
+    var_name = user_conf.input["b"].s[0].split("/")[0]
+    if var_name not in var_confs:
+        return None
+    var_conf = var_confs[var_name].variable_conf
+    if len(var_conf.shape.dim) != 2 or var_conf.data_type != data_type_pb.kFloat:
+        return None
+    return var_name
+
+
+def _QuantizeWeight(weight, bits, group_size):
+    (n, k) = weight.shape
+    max_q = 2 ** (bits - 1) - 1
+    groups = weight.reshape(n, k // group_size, group_size)
+    scale = np.abs(groups).max(axis=2) / max_q
+    scale[scale == 0] = 1
+    q = np.clip(np.rint(groups / scale[:, :, None]), -max_q - 1, max_q)
+    q = q.astype(np.int8).reshape(n, k)
+    if bits == 4:
+        q = ((q[:, 1::2] << 4) | (q[:, 0::2] & 0xF)).astype(np.int8)
+    return (q, scale.astype(np.float32))
+
+
+def _ReadVariable(checkpoint, var_name):
+    meta_info = variable_meta_info_pb.VariableMetaInfo()
+    with open(os.path.join(checkpoint, var_name, "meta")) as f:
+        text_format.Parse(f.read(), meta_info)
+    value = np.fromfile(os.path.join(checkpoint, var_name, "out"), dtype=np.float32)
+    return value.reshape(tuple(meta_info.shape.dim))
+
+
+def _WriteVariable(checkpoint, var_name, value):
+    var_dir = os.path.join(checkpoint, var_name)
+    os.makedirs(var_dir)
+    value.tofile(os.path.join(var_dir, "out"))
+    meta_info = variable_meta_info_pb.VariableMetaInfo()
+    meta_info.shape.dim[:] = value.shape
+    meta_info.data_type = (
+        data_type_pb.kInt8 if value.dtype == np.int8 else data_type_pb.kFloat
+    )
+    with open(os.path.join(var_dir, "meta"), "w") as f:
+        f.write(text_format.MessageToString(meta_info))
+
+
+def _VariableConf(var_op_conf, suffix, value):
+    op_conf = type(var_op_conf)()
+    op_conf.CopyFrom(var_op_conf)
+    op_conf.name = var_op_conf.name + suffix
+    variable_conf = op_conf.variable_conf
+    variable_conf.shape.dim[:] = value.shape
+    variable_conf.trainable = False
+    del variable_conf.parallel_distribution[:]
+    if value.dtype == np.int8:
+        variable_conf.data_type = data_type_pb.kInt8
+        variable_conf.initializer.constant_int_conf.value = 0
+    else:
+        variable_conf.data_type = data_type_pb.kFloat
+        variable_conf.initializer.constant_conf.value = 1
+    return op_conf
+
+
+def _ToWeightOnlyQuantizedMatmul(op_conf, var_name, out, bits, group_size):
+    user_conf = op_conf.user_conf
+    x = user_conf.input["a"].s[0]
+    user_conf.op_type_name = "weight_only_quantized_matmul"
+    user_conf.input.clear()
+    user_conf.input["x"].s.append(x)
+    user_conf.input["weight"].s.append(var_name + _WEIGHT_SUFFIX + "/" + out)
+    user_conf.input["scale"].s.append(var_name + _SCALE_SUFFIX + "/" + out)
+    user_conf.attr.clear()
+    user_conf.attr["bits"].at_int32 = bits
+    user_conf.attr["group_size"].at_int64 = group_size
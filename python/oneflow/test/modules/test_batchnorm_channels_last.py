@@ -0,0 +1,107 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+
+import os
+import unittest
+from collections import OrderedDict
+
+import numpy as np
+from test_util import GenArgList
+
+os.environ["ONEFLOW_ENABLE_NATIVE_CHANNELS_LAST_BN"] = "1"
+
+import oneflow as flow
+import oneflow.unittest
+
+
+def _np_batchnorm_channels_last(x, gamma, beta, dy, epsilon):
+    axes = tuple(range(x.ndim - 1))
+    mean = x.mean(axis=axes)
+    var = x.var(axis=axes)
+    inv_std = 1.0 / np.sqrt(var + epsilon)
+    x_hat = (x - mean) * inv_std
+    y = x_hat * gamma + beta
+    count = x.size / x.shape[-1]
+    dbeta = dy.sum(axis=axes)
+    dgamma = (dy * x_hat).sum(axis=axes)
+    dx = gamma * inv_std * (dy - dbeta / count - x_hat * dgamma / count)
+    unbiased_var = var * count / (count - 1)
+    return (y, dx, dgamma, dbeta, mean, unbiased_var)
+
+
+def _test_batchnorm_channels_last(test_case, shape, device):
+    epsilon = 1e-5
+    momentum = 0.9
+    channels = shape[-1]
+    x = np.random.randn(*shape).astype(np.float32)
+    gamma = np.random.randn(channels).astype(np.float32)
+    beta = np.random.randn(channels).astype(np.float32)
+    dy = np.random.randn(*shape).astype(np.float32)
+    (y, dx, dgamma, dbeta, mean, unbiased_var) = _np_batchnorm_channels_last(
+        x, gamma, beta, dy, epsilon
+    )
+    of_x = flow.Tensor(x, device=flow.device(device), requires_grad=True)
+    of_gamma = flow.Tensor(gamma, device=flow.device(device), requires_grad=True)
+    of_beta = flow.Tensor(beta, device=flow.device(device), requires_grad=True)
+    moving_mean = flow.Tensor(
+        np.zeros(channels, np.float32), device=flow.device(device)
+    )
+    moving_variance = flow.Tensor(
+        np.ones(channels, np.float32), device=flow.device(device)
+    )
+    of_y = flow.F.normalization(
+        of_x,
+        moving_mean,
+        moving_variance,
+        of_gamma,
+        of_beta,
+        axis=len(shape) - 1,
+        epsilon=epsilon,
+        momentum=momentum,
+        is_training=True,
+    )
+    (of_y * flow.Tensor(dy, device=flow.device(device))).sum().backward()
+    test_case.assertTrue(np.allclose(of_y.numpy(), y, rtol=1e-4, atol=1e-4))
+    test_case.assertTrue(np.allclose(of_x.grad.numpy(), dx, rtol=1e-3, atol=1e-3))
+    test_case.assertTrue(
+        np.allclose(of_gamma.grad.numpy(), dgamma, rtol=1e-3, atol=1e-3)
+    )
+    test_case.assertTrue(np.allclose(of_beta.grad.numpy(), dbeta, rtol=1e-3, atol=1e-3))
+    test_case.assertTrue(
+        np.allclose(moving_mean.numpy(), (1 - momentum) * mean, rtol=1e-4, atol=1e-4)
+    )
+    test_case.assertTrue(
+        np.allclose(
+            moving_variance.numpy(),
+            momentum + (1 - momentum) * unbiased_var,
+            rtol=1e-4,
+            atol=1e-4,
+        )
+    )
+
+
+@flow.unittest.skip_unless_1n1d()
+class TestBatchNormChannelsLast(flow.unittest.TestCase):
+    def test_batchnorm_channels_last(test_case):
+        arg_dict = OrderedDict()
+        arg_dict["shape"] = [(2, 4, 5, 8), (4, 7, 7, 70), (64, 3, 3, 33)]
+        arg_dict["device"] = ["cuda"]
+        for arg in GenArgList(arg_dict):
+            _test_batchnorm_channels_last(test_case, *arg)
+
+
+if __name__ == "__main__":
+    unittest.main()
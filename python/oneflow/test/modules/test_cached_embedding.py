@@ -0,0 +1,74 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+
+import shutil
+import tempfile
+import unittest
+
+import numpy as np
+
+import oneflow as flow
+import oneflow.unittest
+
+
+def _test_cached_embedding_sgd(test_case, tmp_dir):
+    (embedding_dim, num_ids, learning_rate) = (8, 200, 0.5)
+    # the caches hold fewer rows than there are ids, so rows go through all the tiers
+    m = flow.nn.CachedEmbedding(
+        "test_sgd", embedding_dim, tmp_dir + "/table", 32, 64, initializer_scale=0.1
+    )
+    rows = {}
+    for step in range(10):
+        ids = np.random.randint(0, num_ids, size=(4, 6)).astype(np.int64)
+        m.prefetch(np.random.randint(0, num_ids, size=(4, 6)))
+        of_out = m(flow.Tensor(ids, dtype=flow.int64, device=flow.device("cuda")))
+        out = of_out.numpy()
+        for (i, id) in enumerate(ids.reshape(-1)):
+            if id in rows:
+                test_case.assertTrue(
+                    np.allclose(out.reshape(-1, embedding_dim)[i], rows[id], 1e-5, 1e-5)
+                )
+            else:
+                rows[id] = out.reshape(-1, embedding_dim)[i].copy()
+                test_case.assertTrue(np.all(np.abs(rows[id]) <= 0.1))
+        out_grad = np.random.randn(*ids.shape, embedding_dim).astype(np.float32)
+        (of_out * flow.Tensor(out_grad, device=flow.device("cuda"))).sum().backward()
+        m.apply_gradients(learning_rate)
+        for (id, grad) in zip(ids.reshape(-1), out_grad.reshape(-1, embedding_dim)):
+            rows[id] -= learning_rate * grad
+    m.save(tmp_dir + "/snapshot")
+    m.load(tmp_dir + "/snapshot")
+    m.eval()
+    all_ids = np.array(sorted(rows.keys()), dtype=np.int64)
+    for begin in range(0, len(all_ids), 24):
+        ids = all_ids[begin : begin + 24]
+        out = m(flow.Tensor(ids, dtype=flow.int64, device=flow.device("cuda"))).numpy()
+        expected = np.stack([rows[id] for id in ids])
+        test_case.assertTrue(np.allclose(out, expected, 1e-4, 1e-4))
+
+
+@flow.unittest.skip_unless_1n1d()
+class TestCachedEmbedding(flow.unittest.TestCase):
+    def test_cached_embedding_sgd(test_case):
+        tmp_dir = tempfile.mkdtemp()
+        try:
+            _test_cached_embedding_sgd(test_case, tmp_dir)
+        finally:
+            shutil.rmtree(tmp_dir)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,56 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+import os
+import unittest
+
+import numpy as np
+
+import oneflow as flow
+import oneflow.unittest
+
+
+
+@unittest.skipIf(os.getenv("ONEFLOW_TEST_CPU_ONLY"), "only test cpu cases")
+class TestDistributedDataParallel(flow.unittest.TestCase):
+    @flow.unittest.skip_unless_1n2d()
+    def test_ddp_averages_grads(test_case):
+        rank = flow.distributed.get_rank()
+        device = f"cuda:{flow.distributed.get_local_rank()}"
+        m = flow.nn.Linear(3, 2, bias=True).to(device)
+        flow.nn.init.ones_(m.weight)
+        flow.nn.init.zeros_(m.bias)
+        # a tiny bucket size puts the weight and the bias in different buckets
+        ddp_m = flow.nn.parallel.DistributedDataParallel(m, bucket_size_mb=1e-5)
+        test_case.assertEqual(len(ddp_m._buckets), 2)
+        x = flow.Tensor(np.full((1, 3), rank + 1, dtype=np.float32)).to(device)
+        ddp_m(x).sum().backward()
+        ddp_m.sync_grads()
+        test_case.assertTrue(
+            np.allclose(m.weight.grad.numpy(), np.full((2, 3), 1.5, dtype=np.float32))
+        )
+        test_case.assertTrue(np.allclose(m.bias.grad.numpy(), np.ones(2)))
+
+    def test_post_grad_accumulation_hook(test_case):
+        x = flow.Tensor(np.ones((2, 3), dtype=np.float32), requires_grad=True)
+        grads = []
+        x._register_post_grad_accumulation_hook(lambda grad: grads.append(grad.numpy()))
+        (x * 2).sum().backward()
+        test_case.assertEqual(len(grads), 1)
+        test_case.assertTrue(np.allclose(grads[0], np.full((2, 3), 2.0)))
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,92 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+
+import math
+import unittest
+from collections import OrderedDict
+
+import numpy as np
+from test_util import GenArgList
+
+import oneflow as flow
+import oneflow.unittest
+
+
+def _np_gelu(x):
+    return 0.5 * x * (1.0 + np.vectorize(math.erf)(x / np.sqrt(2.0)))
+
+
+def _np_gelu_grad(x):
+    return 0.5 * (1.0 + np.vectorize(math.erf)(x / np.sqrt(2.0))) + x * np.exp(
+        -0.5 * x * x
+    ) / np.sqrt(2.0 * np.pi)
+
+
+def _np_fused_matmul_bias(a, b, bias, dy, transpose_b, activation):
+    b_mat = b.T if transpose_b else b
+    pre_act = np.matmul(a, b_mat) + bias
+    if activation == "relu":
+        out = np.maximum(pre_act, 0)
+        pre_grad = dy * (pre_act > 0)
+    elif activation == "gelu":
+        out = _np_gelu(pre_act)
+        pre_grad = dy * _np_gelu_grad(pre_act)
+    else:
+        out = pre_act
+        pre_grad = dy
+    da = np.matmul(pre_grad, b_mat.T)
+    pre_grad_2d = pre_grad.reshape(-1, pre_grad.shape[-1])
+    db = np.matmul(a.reshape(-1, a.shape[-1]).T, pre_grad_2d)
+    dbias = pre_grad_2d.sum(axis=0)
+    return (out, da, db.T if transpose_b else db, dbias)
+
+
+def _test_fused_matmul_bias(test_case, a_shape, n, transpose_b, activation, device):
+    k = a_shape[-1]
+    a = np.random.randn(*a_shape).astype(np.float32)
+    b = np.random.randn(*((n, k) if transpose_b else (k, n))).astype(np.float32)
+    bias = np.random.randn(n).astype(np.float32)
+    dy = np.random.randn(*a_shape[:-1], n).astype(np.float32)
+    (out, da, db, dbias) = _np_fused_matmul_bias(a, b, bias, dy, transpose_b, activation)
+    (of_a, of_b, of_bias) = [
+        flow.Tensor(x, device=flow.device(device), requires_grad=True)
+        for x in (a, b, bias)
+    ]
+    of_out = flow.F.fused_matmul_bias(
+        of_a, of_b, of_bias, transpose_b=transpose_b, activation=activation
+    )
+    (of_out * flow.Tensor(dy, device=flow.device(device))).sum().backward()
+    test_case.assertTrue(np.allclose(of_out.numpy(), out, rtol=1e-3, atol=1e-3))
+    test_case.assertTrue(np.allclose(of_a.grad.numpy(), da, rtol=1e-3, atol=1e-3))
+    test_case.assertTrue(np.allclose(of_b.grad.numpy(), db, rtol=1e-3, atol=1e-3))
+    test_case.assertTrue(np.allclose(of_bias.grad.numpy(), dbias, rtol=1e-3, atol=1e-3))
+
+
+@flow.unittest.skip_unless_1n1d()
+class TestFusedMatmulBias(flow.unittest.TestCase):
+    def test_fused_matmul_bias(test_case):
+        arg_dict = OrderedDict()
+        arg_dict["a_shape"] = [(16, 32), (2, 7, 24)]
+        arg_dict["n"] = [8, 20]
+        arg_dict["transpose_b"] = [False, True]
+        arg_dict["activation"] = ["none", "relu", "gelu"]
+        arg_dict["device"] = ["cuda"]
+        for arg in GenArgList(arg_dict):
+            _test_fused_matmul_bias(test_case, *arg)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,173 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+
+import unittest
+from collections import OrderedDict
+
+import numpy as np
+from test_util import GenArgList
+
+import oneflow as flow
+import oneflow.unittest
+
+
+def _np_seq_ids(cu_seqlens, seq_len):
+    seq_ids = np.full((cu_seqlens.shape[0], seq_len), -1)
+    for (b, offsets) in enumerate(cu_seqlens):
+        for s in range(len(offsets) - 1):
+            seq_ids[b, offsets[s] : offsets[s + 1]] = s
+    return seq_ids
+
+
+def _np_attention(q, k, v, dout, key_mask, causal, scale, cu_seqlens=None):
+    (query_len, key_len) = (q.shape[2], k.shape[2])
+    score = np.matmul(q, k.transpose(0, 1, 3, 2)) * scale
+    mask = np.ones((q.shape[0], 1, query_len, key_len), dtype=bool)
+    if key_mask is not None:
+        mask = mask & (key_mask[:, None, None, :] != 0)
+    if causal:
+        mask = mask & np.tril(np.ones((query_len, key_len), dtype=bool))
+    if cu_seqlens is not None:
+        seq_ids = _np_seq_ids(cu_seqlens, key_len)
+        mask = mask & (seq_ids[:, None, :, None] == seq_ids[:, None, None, :])
+        mask = mask & (seq_ids[:, None, None, :] >= 0)
+    score = np.where(mask, score, -np.inf)
+    row_max = score.max(axis=-1, keepdims=True)
+    p = np.exp(score - np.where(np.isinf(row_max), 0, row_max))
+    p = p / np.maximum(p.sum(axis=-1, keepdims=True), 1e-30)
+    out = np.matmul(p, v)
+    dv = np.matmul(p.transpose(0, 1, 3, 2), dout)
+    dp = np.matmul(dout, v.transpose(0, 1, 3, 2))
+    ds = p * (dp - (dp * p).sum(axis=-1, keepdims=True))
+    dq = np.matmul(ds, k) * scale
+    dk = np.matmul(ds.transpose(0, 1, 3, 2), q) * scale
+    return (out, dq, dk, dv)
+
+
+def _test_fused_multi_head_attention(test_case, shape, causal, with_key_mask, device):
+    (batch, num_heads, seq_len, head_dim) = shape
+    scale = 1.0 / np.sqrt(head_dim)
+    (q, k, v, dout) = [np.random.randn(*shape).astype(np.float32) for _ in range(4)]
+    key_mask = None
+    if with_key_mask:
+        key_mask = np.ones((batch, seq_len), dtype=np.int8)
+        key_mask[:, seq_len // 2 :] = 0
+    (out, dq, dk, dv) = _np_attention(q, k, v, dout, key_mask, causal, scale)
+    (query, key, value) = [
+        flow.Tensor(x, device=flow.device(device), requires_grad=True)
+        for x in (q, k, v)
+    ]
+    of_key_mask = None
+    if with_key_mask:
+        of_key_mask = flow.Tensor(
+            key_mask, device=flow.device(device), dtype=flow.int8
+        )
+    of_out = flow.F.fused_multi_head_attention(
+        query, key, value, scale=scale, key_mask=of_key_mask, causal=causal
+    )
+    (of_out * flow.Tensor(dout, device=flow.device(device))).sum().backward()
+    test_case.assertTrue(np.allclose(of_out.numpy(), out, rtol=1e-3, atol=1e-3))
+    test_case.assertTrue(np.allclose(query.grad.numpy(), dq, rtol=1e-3, atol=1e-3))
+    test_case.assertTrue(np.allclose(key.grad.numpy(), dk, rtol=1e-3, atol=1e-3))
+    test_case.assertTrue(np.allclose(value.grad.numpy(), dv, rtol=1e-3, atol=1e-3))
+
+
+def _test_fused_multi_head_attention_cu_seqlens(test_case, shape, causal, device):
+    (batch, num_heads, seq_len, head_dim) = shape
+    scale = 1.0 / np.sqrt(head_dim)
+    (q, k, v, dout) = [np.random.randn(*shape).astype(np.float32) for _ in range(4)]
+    # three sequences per sample and a padding tail
+    cu_seqlens = np.array(
+        [[0, seq_len // 4, seq_len // 2, seq_len - 3] for _ in range(batch)],
+        dtype=np.int32,
+    )
+    (out, dq, dk, dv) = _np_attention(
+        q, k, v, dout, None, causal, scale, cu_seqlens=cu_seqlens
+    )
+    (query, key, value) = [
+        flow.Tensor(x, device=flow.device(device), requires_grad=True)
+        for x in (q, k, v)
+    ]
+    of_out = flow.F.fused_multi_head_attention(
+        query,
+        key,
+        value,
+        scale=scale,
+        causal=causal,
+        cu_seqlens=flow.Tensor(
+            cu_seqlens, device=flow.device(device), dtype=flow.int32
+        ),
+    )
+    (of_out * flow.Tensor(dout, device=flow.device(device))).sum().backward()
+    test_case.assertTrue(np.allclose(of_out.numpy(), out, rtol=1e-3, atol=1e-3))
+    test_case.assertTrue(np.allclose(query.grad.numpy(), dq, rtol=1e-3, atol=1e-3))
+    test_case.assertTrue(np.allclose(key.grad.numpy(), dk, rtol=1e-3, atol=1e-3))
+    test_case.assertTrue(np.allclose(value.grad.numpy(), dv, rtol=1e-3, atol=1e-3))
+
+
+def _test_pack_sequence(test_case, device):
+    x = np.random.randn(3, 5, 4).astype(np.float32)
+    seq_lens = np.array([2, 5, 1], dtype=np.int32)
+    of_x = flow.Tensor(x, device=flow.device(device), requires_grad=True)
+    (packed, cu_seqlens) = flow.F.pack_sequence(
+        of_x, flow.Tensor(seq_lens, device=flow.device(device), dtype=flow.int32)
+    )
+    np_packed = np.zeros((15, 4), dtype=np.float32)
+    np_packed[:8] = np.concatenate([x[b, :n] for (b, n) in enumerate(seq_lens)])
+    test_case.assertTrue(np.allclose(packed.numpy(), np_packed))
+    test_case.assertTrue(np.array_equal(cu_seqlens.numpy(), [[0, 2, 7, 8]]))
+    unpacked = flow.F.unpack_sequence(packed, cu_seqlens, max_seq_len=5)
+    np_mask = np.arange(5)[None, :, None] < seq_lens[:, None, None]
+    test_case.assertTrue(np.allclose(unpacked.numpy(), x * np_mask))
+    unpacked.sum().backward()
+    test_case.assertTrue(np.allclose(of_x.grad.numpy(), np.ones_like(x) * np_mask))
+
+
+def _test_fused_multi_head_attention_dropout_p1(test_case, shape, device):
+    x = flow.Tensor(np.random.randn(*shape), device=flow.device(device))
+    out = flow.F.fused_multi_head_attention(x, x, x, scale=1.0, dropout_rate=1.0)
+    test_case.assertTrue(np.allclose(out.numpy(), np.zeros(shape)))
+
+
+@flow.unittest.skip_unless_1n1d()
+class TestFusedMultiHeadAttention(flow.unittest.TestCase):
+    def test_fused_multi_head_attention(test_case):
+        arg_dict = OrderedDict()
+        arg_dict["shape"] = [(2, 3, 37, 16), (1, 2, 70, 64), (1, 1, 33, 128)]
+        arg_dict["causal"] = [False, True]
+        arg_dict["with_key_mask"] = [False, True]
+        arg_dict["device"] = ["cuda"]
+        for arg in GenArgList(arg_dict):
+            _test_fused_multi_head_attention(test_case, *arg)
+
+    def test_fused_multi_head_attention_cu_seqlens(test_case):
+        arg_dict = OrderedDict()
+        arg_dict["shape"] = [(2, 3, 37, 16), (1, 2, 70, 64)]
+        arg_dict["causal"] = [False, True]
+        arg_dict["device"] = ["cuda"]
+        for arg in GenArgList(arg_dict):
+            _test_fused_multi_head_attention_cu_seqlens(test_case, *arg)
+
+    def test_pack_sequence(test_case):
+        for device in ["cpu", "cuda"]:
+            _test_pack_sequence(test_case, device)
+
+    def test_fused_multi_head_attention_dropout_p1(test_case):
+        _test_fused_multi_head_attention_dropout_p1(test_case, (2, 2, 40, 32), "cuda")
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -14,6 +14,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 """
 
+import os
 import unittest
 
 import cv2
@@ -57,6 +58,37 @@ class TestImageDecode(flow.unittest.TestCase):
             test_case.assertTrue(len(cv2_decoded_image.shape) == 3)
             test_case.assertTrue(np.allclose(of_decoded_image, cv2_decoded_image))
 
+    @unittest.skipIf(os.getenv("ONEFLOW_TEST_CPU_ONLY"), "only test cpu cases")
+    def test_image_decode_nvjpeg(test_case):
+        images = [
+            "/dataset/mscoco_2017/val2017/000000000139.jpg",
+            "/dataset/mscoco_2017/val2017/000000000632.jpg",
+        ]
+        images_bytes = []
+        for im in images:
+            with open(im, "rb") as imf:
+                images_bytes.append(imf.read())
+        static_shape = (len(images_bytes), max([len(bys) for bys in images_bytes]))
+        images_np_arr_static = np.zeros(static_shape, dtype=np.int8)
+        for (idx, bys) in enumerate(images_bytes):
+            images_np_arr_static[idx, : len(bys)] = np.frombuffer(bys, dtype=np.int8)
+        os.environ["ONEFLOW_IMAGE_DECODE_USE_NVJPEG"] = "1"
+        try:
+            image_decoder = flow.nn.image.decode(color_space="RGB")
+            input = flow.Tensor(
+                images_np_arr_static, dtype=flow.int8, device=flow.device("cpu")
+            )
+            images_buffer = flow.tensor_to_tensor_buffer(input, instance_dims=1)
+            of_decoded_images = image_decoder(images_buffer).numpy()
+        finally:
+            del os.environ["ONEFLOW_IMAGE_DECODE_USE_NVJPEG"]
+        for (of_decoded_image, image) in zip(of_decoded_images, images):
+            cv2_decoded_image = cv2.cvtColor(cv2.imread(image), cv2.COLOR_BGR2RGB)
+            test_case.assertEqual(of_decoded_image.shape, cv2_decoded_image.shape)
+            # the IDCT and upsampling of nvJPEG round differently from libjpeg
+            diff = np.abs(of_decoded_image.astype(np.float32) - cv2_decoded_image)
+            test_case.assertTrue(diff.mean() < 2)
+
 
 if __name__ == "__main__":
     unittest.main()
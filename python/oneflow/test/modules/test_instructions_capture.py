@@ -0,0 +1,66 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+import unittest
+from collections import OrderedDict
+
+import numpy as np
+from test_util import GenArgList
+
+import oneflow
+import oneflow as flow
+import oneflow.unittest
+
+
+def _test_instructions_capture_impl(test_case, device, shape):
+    x = flow.Tensor(np.random.rand(*shape), device=flow.device(device))
+    y = flow.Tensor(np.random.rand(*shape), device=flow.device(device))
+    capture = oneflow._oneflow_internal.InstructionsCapture([x, y])
+    capture.begin_capture()
+    z = flow.relu(x + y)
+    capture.end_capture()
+    test_case.assertTrue(capture.is_captured)
+    test_case.assertTrue(capture.instruction_size > 0)
+    test_case.assertTrue(np.allclose(z.numpy(), np.maximum(x.numpy() + y.numpy(), 0)))
+    x.zeros_()
+    test_case.assertTrue(capture.try_replay())
+    test_case.assertTrue(np.allclose(z.numpy(), np.maximum(y.numpy(), 0), 0.0001, 0.0001))
+
+
+def _test_instructions_capture_with_callback(test_case, device):
+    x = flow.Tensor(np.random.rand(2, 3), device=flow.device(device))
+    capture = oneflow._oneflow_internal.InstructionsCapture([x])
+    capture.begin_capture()
+    with test_case.assertRaises(Exception):
+        (x * 2).numpy()
+    test_case.assertFalse(capture.is_captured)
+
+
+@flow.unittest.skip_unless_1n1d()
+class TestInstructionsCapture(flow.unittest.TestCase):
+    def test_instructions_capture(test_case):
+        arg_dict = OrderedDict()
+        arg_dict["device"] = ["cpu", "cuda"]
+        arg_dict["shape"] = [[2, 3], [1, 10]]
+        for arg in GenArgList(arg_dict):
+            _test_instructions_capture_impl(test_case, *arg)
+
+    def test_instructions_capture_with_callback(test_case):
+        for device in ["cpu", "cuda"]:
+            _test_instructions_capture_with_callback(test_case, device)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,108 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+
+import unittest
+from collections import OrderedDict
+
+import numpy as np
+from test_util import GenArgList
+
+import oneflow as flow
+import oneflow.unittest
+
+
+def _np_moe_gating(logits, k):
+    (num_tokens, num_experts) = logits.shape
+    # stable sort on the negated logits keeps the lower expert id first on ties
+    expert_ids = np.argsort(-logits, axis=1, kind="stable")[:, :k].astype(np.int32)
+    selected = np.take_along_axis(logits, expert_ids, axis=1)
+    gates = np.exp(selected - selected[:, :1])
+    gates /= gates.sum(axis=1, keepdims=True)
+    positions = np.zeros_like(expert_ids)
+    expert_cnt = np.zeros(num_experts, dtype=np.int32)
+    for j in range(k):
+        for t in range(num_tokens):
+            positions[t, j] = expert_cnt[expert_ids[t, j]]
+            expert_cnt[expert_ids[t, j]] += 1
+    return (expert_ids, positions, gates)
+
+
+def _test_moe(test_case, device, num_tokens, num_experts, k, capacity):
+    hidden_size = 8
+    logits = np.random.randn(num_tokens, num_experts).astype(np.float32)
+    x = np.random.randn(num_tokens, hidden_size).astype(np.float32)
+    scale = np.random.randn(num_experts, 1, hidden_size).astype(np.float32)
+    out_grad = np.random.randn(num_tokens, hidden_size).astype(np.float32)
+    (expert_ids, positions, gates) = _np_moe_gating(logits, k)
+
+    of_logits = flow.Tensor(logits, device=flow.device(device), requires_grad=True)
+    of_x = flow.Tensor(x, device=flow.device(device), requires_grad=True)
+    (of_expert_ids, of_positions, of_gates) = flow.F.moe_gating(of_logits, k=k)
+    test_case.assertTrue(np.array_equal(of_expert_ids.numpy(), expert_ids))
+    test_case.assertTrue(np.array_equal(of_positions.numpy(), positions))
+    test_case.assertTrue(np.allclose(of_gates.numpy(), gates, 1e-05, 1e-05))
+
+    of_expert_x = flow.F.moe_dispatch(
+        of_x,
+        of_expert_ids,
+        of_positions,
+        num_experts=num_experts,
+        capacity=capacity,
+    )
+    expert_x = np.zeros((num_experts, capacity, hidden_size), dtype=np.float32)
+    kept = positions < capacity
+    for (t, j) in zip(*np.nonzero(kept)):
+        expert_x[expert_ids[t, j], positions[t, j]] = x[t]
+    test_case.assertTrue(np.allclose(of_expert_x.numpy(), expert_x, 1e-05, 1e-05))
+
+    of_expert_y = of_expert_x * flow.Tensor(scale, device=flow.device(device))
+    of_out = flow.F.moe_combine(of_expert_y, of_expert_ids, of_positions, of_gates)
+    expert_y = expert_x * scale
+    out = np.zeros_like(x)
+    for (t, j) in zip(*np.nonzero(kept)):
+        out[t] += gates[t, j] * expert_y[expert_ids[t, j], positions[t, j]]
+    test_case.assertTrue(np.allclose(of_out.numpy(), out, 1e-05, 1e-05))
+
+    (of_out * flow.Tensor(out_grad, device=flow.device(device))).sum().backward()
+    x_grad = np.zeros_like(x)
+    gates_grad = np.zeros_like(gates)
+    for (t, j) in zip(*np.nonzero(kept)):
+        e = expert_ids[t, j]
+        x_grad[t] += gates[t, j] * out_grad[t] * scale[e, 0]
+        gates_grad[t, j] = np.dot(out_grad[t], expert_y[e, positions[t, j]])
+    logits_grad = np.zeros_like(logits)
+    dot = (gates * gates_grad).sum(axis=1, keepdims=True)
+    np.put_along_axis(logits_grad, expert_ids, gates * (gates_grad - dot), axis=1)
+    test_case.assertTrue(np.allclose(of_x.grad.numpy(), x_grad, 1e-04, 1e-04))
+    test_case.assertTrue(np.allclose(of_logits.grad.numpy(), logits_grad, 1e-04, 1e-04))
+
+
+@flow.unittest.skip_unless_1n1d()
+class TestMoe(flow.unittest.TestCase):
+    def test_moe(test_case):
+        arg_dict = OrderedDict()
+        arg_dict["device"] = ["cpu", "cuda"]
+        arg_dict["num_tokens"] = [1, 37, 256]
+        arg_dict["num_experts"] = [4, 16]
+        arg_dict["k"] = [1, 2]
+        # the small capacity drops some of the tokens
+        arg_dict["capacity"] = [4, 64]
+        for arg in GenArgList(arg_dict):
+            _test_moe(test_case, *arg)
+
+
+if __name__ == "__main__":
+    unittest.main()
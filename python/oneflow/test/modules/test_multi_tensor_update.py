@@ -0,0 +1,93 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+
+import unittest
+from collections import OrderedDict
+
+import numpy as np
+from test_util import GenArgDict
+
+import oneflow as flow
+import oneflow.unittest
+
+
+def _random_tensors(shapes, device):
+    return [
+        flow.Tensor(np.random.uniform(size=shape), device=flow.device(device))
+        for shape in shapes
+    ]
+
+
+def _test_multi_tensor_sgd_update(test_case, device, num_tensors):
+    shapes = [(i % 7 + 1, i % 5 + 2) for i in range(num_tensors)]
+    models = _random_tensors(shapes, device)
+    grads = _random_tensors(shapes, device)
+    expected = [
+        m.numpy() - 0.1 * (g.numpy() * 0.5 + 0.01 * m.numpy())
+        for (m, g) in zip(models, grads)
+    ]
+    flow.F.multi_tensor_sgd_update(
+        models, grads, learning_rate=0.1, scale=0.5, l2=0.01
+    )
+    for (m, e) in zip(models, expected):
+        test_case.assertTrue(np.allclose(m.numpy(), e, rtol=1e-4, atol=1e-4))
+
+
+def _test_multi_tensor_adam_update(test_case, device, num_tensors):
+    shapes = [(i % 3 + 1, i % 4 + 1) for i in range(num_tensors)]
+    models = _random_tensors(shapes, device)
+    grads = _random_tensors(shapes, device)
+    ms = _random_tensors(shapes, device)
+    vs = _random_tensors(shapes, device)
+    (beta1, beta2, epsilon, lr) = (0.9, 0.999, 1e-8, 0.01)
+    expected = []
+    for (m, g, m_t, v_t) in zip(models, grads, ms, vs):
+        next_m = beta1 * m_t.numpy() + (1 - beta1) * g.numpy()
+        next_v = beta2 * v_t.numpy() + (1 - beta2) * g.numpy() * g.numpy()
+        expected.append(m.numpy() - lr * next_m / (np.sqrt(next_v) + epsilon))
+    flow.F.multi_tensor_adam_update(
+        models,
+        grads,
+        ms,
+        vs,
+        learning_rate=lr,
+        beta1=beta1,
+        beta2=beta2,
+        epsilon=epsilon,
+    )
+    for (m, e) in zip(models, expected):
+        test_case.assertTrue(np.allclose(m.numpy(), e, rtol=1e-4, atol=1e-4))
+
+
+@flow.unittest.skip_unless_1n1d()
+class TestMultiTensorUpdate(flow.unittest.TestCase):
+    def test_multi_tensor_sgd_update(test_case):
+        arg_dict = OrderedDict()
+        arg_dict["device"] = ["cpu", "cuda"]
+        arg_dict["num_tensors"] = [1, 300]
+        for arg in GenArgDict(arg_dict):
+            _test_multi_tensor_sgd_update(test_case, **arg)
+
+    def test_multi_tensor_adam_update(test_case):
+        arg_dict = OrderedDict()
+        arg_dict["device"] = ["cpu", "cuda"]
+        arg_dict["num_tensors"] = [1, 300]
+        for arg in GenArgDict(arg_dict):
+            _test_multi_tensor_adam_update(test_case, **arg)
+
+
+if __name__ == "__main__":
+    unittest.main()
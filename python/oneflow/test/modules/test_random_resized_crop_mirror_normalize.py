@@ -0,0 +1,93 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+
+import unittest
+
+import cv2
+import numpy as np
+
+import oneflow as flow
+import oneflow.unittest
+
+
+def _images_to_tensor_buffer(images):
+    input = flow.Tensor(np.stack(images), dtype=flow.uint8, device=flow.device("cpu"))
+    return flow.tensor_to_tensor_buffer(input, instance_dims=3)
+
+
+def _test_resize_mirror_normalize(test_case, output_layout):
+    images = [
+        np.random.randint(0, 256, size=(40, 40, 3)).astype(np.uint8) for _ in range(4)
+    ]
+    mirror = np.array([0, 1, 1, 0], dtype=np.int8)
+    (mean, std) = ([123.68, 116.779, 103.939], [58.393, 57.12, 57.375])
+    # the whole of each square image is the only window of this area and aspect ratio
+    augment = flow.nn.RandomResizedCropMirrorNormalize(
+        (16, 24),
+        (40, 40),
+        output_layout=output_layout,
+        mean=mean,
+        std=std,
+        random_area=[1.0, 1.0],
+        random_aspect_ratio=[1.0, 1.0],
+    )
+    of_out = augment(
+        _images_to_tensor_buffer(images), flow.Tensor(mirror, dtype=flow.int8)
+    ).numpy()
+    for (i, image) in enumerate(images):
+        expected = cv2.resize(
+            image.astype(np.float32), (24, 16), interpolation=cv2.INTER_LINEAR
+        )
+        if mirror[i]:
+            expected = expected[:, ::-1, :]
+        expected = (expected - np.array(mean)) / np.array(std)
+        if output_layout == "NCHW":
+            expected = expected.transpose(2, 0, 1)
+        test_case.assertTrue(np.allclose(of_out[i], expected, 1e-3, 1e-3))
+
+
+def _test_random_crop_color_jitter(test_case):
+    images = [
+        np.random.randint(0, 256, size=(48, 64, 3)).astype(np.uint8) for _ in range(8)
+    ]
+    augment = flow.nn.RandomResizedCropMirrorNormalize(
+        (32, 32),
+        (48, 64),
+        output_layout="NHWC",
+        output_dtype=flow.float16,
+        brightness=0.4,
+        contrast=0.4,
+        random_seed=1,
+    )
+    of_out = augment(_images_to_tensor_buffer(images))
+    test_case.assertEqual(of_out.dtype, flow.float16)
+    test_case.assertEqual(of_out.shape, flow.Size([8, 32, 32, 3]))
+    out = of_out.numpy().astype(np.float32)
+    test_case.assertTrue(np.all(out >= 0) and np.all(out <= 255))
+
+
+@flow.unittest.skip_unless_1n1d()
+class TestRandomResizedCropMirrorNormalize(flow.unittest.TestCase):
+    def test_resize_mirror_normalize(test_case):
+        for output_layout in ["NCHW", "NHWC"]:
+            _test_resize_mirror_normalize(test_case, output_layout)
+
+    def test_random_crop_color_jitter(test_case):
+        _test_random_crop_color_jitter(test_case)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,84 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+
+import unittest
+from collections import OrderedDict
+
+import numpy as np
+from test_util import GenArgList
+
+import oneflow as flow
+import oneflow.unittest
+
+
+def _np_rms_norm(x, weight, dy, eps):
+    cols = x.shape[-1]
+    inv_rms = 1.0 / np.sqrt((x * x).mean(axis=-1, keepdims=True) + eps)
+    x_hat = x * inv_rms
+    y = x_hat * weight
+    dx_hat = dy * weight
+    dx = inv_rms * (dx_hat - x_hat * (dx_hat * x_hat).sum(axis=-1, keepdims=True) / cols)
+    dweight = (dy * x_hat).reshape(-1, cols).sum(axis=0)
+    return (y, dx, dweight)
+
+
+def _test_rms_norm(test_case, shape, with_residual, device):
+    eps = 1e-5
+    x = np.random.randn(*shape).astype(np.float32)
+    residual = np.random.randn(*shape).astype(np.float32)
+    weight = np.random.randn(shape[-1]).astype(np.float32)
+    dy = np.random.randn(*shape).astype(np.float32)
+    normalized_input = x + residual if with_residual else x
+    (y, dx, dweight) = _np_rms_norm(normalized_input, weight, dy, eps)
+    m = flow.nn.RMSNorm(shape[-1], eps=eps)
+    m.weight = flow.nn.Parameter(flow.Tensor(weight), requires_grad=True)
+    m.to(flow.device(device))
+    of_x = flow.Tensor(x, device=flow.device(device), requires_grad=True)
+    if with_residual:
+        of_residual = flow.Tensor(
+            residual, device=flow.device(device), requires_grad=True
+        )
+        (of_y, of_add_out) = m(of_x, of_residual)
+        test_case.assertTrue(
+            np.allclose(of_add_out.numpy(), normalized_input, rtol=1e-5, atol=1e-5)
+        )
+    else:
+        of_y = m(of_x)
+    (of_y * flow.Tensor(dy, device=flow.device(device))).sum().backward()
+    test_case.assertTrue(np.allclose(of_y.numpy(), y, rtol=1e-4, atol=1e-4))
+    test_case.assertTrue(np.allclose(of_x.grad.numpy(), dx, rtol=1e-4, atol=1e-4))
+    test_case.assertTrue(
+        np.allclose(m.weight.grad.numpy(), dweight, rtol=1e-3, atol=1e-3)
+    )
+    if with_residual:
+        test_case.assertTrue(
+            np.allclose(of_residual.grad.numpy(), dx, rtol=1e-4, atol=1e-4)
+        )
+
+
+@flow.unittest.skip_unless_1n1d()
+class TestRMSNorm(flow.unittest.TestCase):
+    def test_rms_norm(test_case):
+        arg_dict = OrderedDict()
+        arg_dict["shape"] = [(4, 37), (2, 3, 256), (8, 1536), (3, 4099)]
+        arg_dict["with_residual"] = [False, True]
+        arg_dict["device"] = ["cpu", "cuda"]
+        for arg in GenArgList(arg_dict):
+            _test_rms_norm(test_case, *arg)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -0,0 +1,71 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+import unittest
+from collections import OrderedDict
+
+import numpy as np
+from test_util import GenArgList
+
+import oneflow as flow
+import oneflow.unittest
+
+
+def _test_saved_tensors_hooks(test_case, device):
+    np_x = np.random.rand(2, 3).astype(np.float32)
+    x = flow.Tensor(np_x, device=flow.device(device), requires_grad=True)
+    packed = []
+    unpacked = []
+
+    def pack_hook(tensor):
+        packed.append(tensor.shape)
+        return tensor.to("cpu")
+
+    def unpack_hook(tensor):
+        unpacked.append(tensor.shape)
+        return tensor.to(device)
+
+    with flow.autograd.graph.saved_tensors_hooks(pack_hook, unpack_hook):
+        y = x * x
+    test_case.assertEqual(len(packed), 2)
+    y.sum().backward()
+    test_case.assertEqual(len(unpacked), 2)
+    test_case.assertTrue(np.allclose(x.grad.numpy(), np_x * 2, 1e-4, 1e-4))
+
+
+def _test_save_on_cpu(test_case, device):
+    np_x = np.random.rand(2, 3).astype(np.float32)
+    np_y = np.random.rand(3).astype(np.float32)
+    x = flow.Tensor(np_x, device=flow.device(device), requires_grad=True)
+    y = flow.Tensor(np_y, device=flow.device(device), requires_grad=True)
+    with flow.autograd.graph.save_on_cpu():
+        z = flow.mul(x, y).reshape(3, 2)
+    z.sum().backward()
+    test_case.assertTrue(np.allclose(x.grad.numpy(), np.tile(np_y, (2, 1)), 1e-4, 1e-4))
+    test_case.assertTrue(np.allclose(y.grad.numpy(), np_x.sum(0), 1e-4, 1e-4))
+
+
+@flow.unittest.skip_unless_1n1d()
+class TestSavedTensorsHooks(flow.unittest.TestCase):
+    def test_saved_tensors_hooks(test_case):
+        arg_dict = OrderedDict()
+        arg_dict["case"] = [_test_saved_tensors_hooks, _test_save_on_cpu]
+        arg_dict["device"] = ["cpu", "cuda"]
+        for arg in GenArgList(arg_dict):
+            arg[0](test_case, *arg[1:])
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -86,6 +86,22 @@ def _test_embedding_impl(test_case, device):
     )
 
 
+def _test_embedding_lookup(test_case, shape, device):
+    (num_embeddings, embedding_dim) = (37, 16)
+    weight = np.random.randn(num_embeddings, embedding_dim).astype(np.float32)
+    # few distinct ids, so most of them repeat
+    ids = np.random.randint(0, 7, size=shape).astype(np.int64) * 5
+    out_grad = np.random.randn(*shape, embedding_dim).astype(np.float32)
+    of_weight = flow.Tensor(weight, device=flow.device(device), requires_grad=True)
+    of_ids = flow.Tensor(ids, dtype=flow.int64, device=flow.device(device))
+    of_out = flow.F.embedding_lookup(of_weight, of_ids)
+    test_case.assertTrue(np.allclose(of_out.numpy(), weight[ids], 1e-05, 1e-05))
+    (of_out * flow.Tensor(out_grad, device=flow.device(device))).sum().backward()
+    weight_grad = np.zeros_like(weight)
+    np.add.at(weight_grad, ids.reshape(-1), out_grad.reshape(-1, embedding_dim))
+    test_case.assertTrue(np.allclose(of_weight.grad.numpy(), weight_grad, 1e-04, 1e-04))
+
+
 @flow.unittest.skip_unless_1n1d()
 class TestEmbedding(flow.unittest.TestCase):
     def test_embedding(test_case):
@@ -94,6 +110,13 @@ class TestEmbedding(flow.unittest.TestCase):
         for arg in GenArgList(arg_dict):
             _test_embedding_impl(test_case, *arg)
 
+    def test_embedding_lookup(test_case):
+        arg_dict = OrderedDict()
+        arg_dict["shape"] = [(1,), (3, 50), (2, 3, 128)]
+        arg_dict["device"] = ["cuda"]
+        for arg in GenArgList(arg_dict):
+            _test_embedding_lookup(test_case, *arg)
+
 
 if __name__ == "__main__":
     unittest.main()
@@ -75,6 +75,21 @@ def _test_sub_impl(test_case, shape, device):
     test_case.assertTrue(np.allclose(y.grad.numpy(), np_grad_y, 1e-05, 1e-05))
 
 
+def _test_sub_broadcast(test_case, x_shape, y_shape, device):
+    x = np.random.randn(*x_shape)
+    y = np.random.randn(*y_shape)
+    of_out = flow.sub(
+        flow.Tensor(x, device=flow.device(device)),
+        flow.Tensor(y, device=flow.device(device)),
+    )
+    test_case.assertTrue(np.allclose(of_out.numpy(), x - y, 1e-05, 1e-05))
+    of_out = flow.sub(
+        flow.Tensor(y, device=flow.device(device)),
+        flow.Tensor(x, device=flow.device(device)),
+    )
+    test_case.assertTrue(np.allclose(of_out.numpy(), y - x, 1e-05, 1e-05))
+
+
 @flow.unittest.skip_unless_1n1d()
 class TestSubModule(flow.unittest.TestCase):
     def test_sub(test_case):
@@ -84,6 +99,22 @@ class TestSubModule(flow.unittest.TestCase):
         for arg in GenArgList(arg_dict):
             _test_sub_impl(test_case, *arg)
 
+    def test_sub_broadcast(test_case):
+        # scalar, row, column and middle axis broadcasts, with sizes that are not a whole
+        # number of packs
+        shape_pairs = [
+            ((3, 5, 7), (1, 1, 1)),
+            ((6, 16), (1, 16)),
+            ((7, 9), (1, 9)),
+            ((6, 16), (6, 1)),
+            ((2, 3, 4, 5), (1, 3, 1, 1)),
+            ((2, 3, 5), (2, 1, 5)),
+            ((4, 1), (1, 6)),
+        ]
+        for device in ["cpu", "cuda"]:
+            for (x_shape, y_shape) in shape_pairs:
+                _test_sub_broadcast(test_case, x_shape, y_shape, device)
+
     def test_sub_against_pytorch(test_case):
         arg_dict = OrderedDict()
         arg_dict["test_type"] = [test_flow_against_pytorch, test_tensor_against_pytorch]
@@ -61,6 +61,27 @@ def _test_sum_impl(test_case, device):
     test_case.assertTrue(np.allclose(input.grad.numpy(), np_grad, 1e-05, 1e-05))
 
 
+def _test_sum_layouts(test_case, device):
+    # rows, columns, the middle axis, a long column that is split into chunks and axes that are
+    # not adjacent
+    for (shape, axis) in [
+        ((37, 1500), 1),
+        ((1500, 37), 0),
+        ((6, 7, 8), 1),
+        ((5000, 3), 0),
+        ((3, 4, 5, 6), (0, 2)),
+        ((2, 3, 4, 5, 6), (1, 3, 4)),
+    ]:
+        np_input = np.random.randn(*shape).astype(np.float32)
+        input = flow.Tensor(np_input, device=flow.device(device))
+        of_out = flow.sum(input, dim=axis)
+        np_out = np.sum(np_input, axis=axis)
+        test_case.assertTrue(np.allclose(of_out.numpy(), np_out, 1e-04, 1e-04))
+        of_out = flow.max(input, dim=axis)
+        np_out = np.max(np_input, axis=axis)
+        test_case.assertTrue(np.allclose(of_out.numpy(), np_out, 1e-05, 1e-05))
+
+
 @flow.unittest.skip_unless_1n1d()
 class TestSumModule(flow.unittest.TestCase):
     def test_sum(test_case):
@@ -69,6 +90,12 @@ class TestSumModule(flow.unittest.TestCase):
         for arg in GenArgList(arg_dict):
             _test_sum_impl(test_case, *arg)
 
+    def test_sum_layouts(test_case):
+        arg_dict = OrderedDict()
+        arg_dict["device"] = ["cpu", "cuda"]
+        for arg in GenArgList(arg_dict):
+            _test_sum_layouts(test_case, *arg)
+
     @autotest()
     def test_sum_against_pytorch(test_case):
         device = random_device()
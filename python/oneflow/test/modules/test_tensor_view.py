@@ -0,0 +1,73 @@
+"""
+Copyright 2020 The OneFlow Authors. All rights reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+"""
+import os
+import unittest
+from collections import OrderedDict
+
+os.environ["ONEFLOW_EAGER_ENABLE_TENSOR_VIEW"] = "1"
+
+import numpy as np
+from test_util import GenArgList
+
+import oneflow as flow
+import oneflow.unittest
+
+
+def _test_reshape_view(test_case, device):
+    np_x = np.random.rand(2, 3, 4).astype(np.float32)
+    x = flow.Tensor(np_x, device=flow.device(device), requires_grad=True)
+    y = x.reshape(6, 4).flatten().unsqueeze(0).squeeze(0)
+    test_case.assertTrue(np.allclose(y.numpy(), np_x.flatten(), 1e-4, 1e-4))
+    (y * y).sum().backward()
+    test_case.assertTrue(np.allclose(x.grad.numpy(), np_x * 2, 1e-4, 1e-4))
+
+
+def _test_slice_view(test_case, device):
+    np_x = np.random.rand(4, 3, 5).astype(np.float32)
+    x = flow.Tensor(np_x, device=flow.device(device))
+    full = [None, None, None]
+    contiguous = flow.slice(x, slice_tup_list=[[1, 3, 1], full, full])
+    test_case.assertTrue(np.allclose(contiguous.numpy(), np_x[1:3], 1e-4, 1e-4))
+    row = flow.slice(x, slice_tup_list=[[2, 3, 1], [1, 2, 1], full])
+    test_case.assertTrue(np.allclose(row.numpy(), np_x[2:3, 1:2], 1e-4, 1e-4))
+    strided = flow.slice(x, slice_tup_list=[[None, None, 2], full, [1, 4, 1]])
+    test_case.assertTrue(np.allclose(strided.numpy(), np_x[::2, :, 1:4], 1e-4, 1e-4))
+
+
+def _test_view_outlives_base(test_case, device):
+    np_x = np.random.rand(3, 4).astype(np.float32)
+    x = flow.Tensor(np_x, device=flow.device(device))
+    y = flow.slice(x, slice_tup_list=[[1, 2, 1], [None, None, None]]).reshape(4)
+    del x
+    test_case.assertTrue(np.allclose(y.numpy(), np_x[1], 1e-4, 1e-4))
+
+
+@flow.unittest.skip_unless_1n1d()
+class TestTensorView(flow.unittest.TestCase):
+    def test_tensor_view(test_case):
+        arg_dict = OrderedDict()
+        arg_dict["case"] = [
+            _test_reshape_view,
+            _test_slice_view,
+            _test_view_outlives_base,
+        ]
+        arg_dict["device"] = ["cpu", "cuda"]
+        for arg in GenArgList(arg_dict):
+            arg[0](test_case, *arg[1:])
+
+
+if __name__ == "__main__":
+    unittest.main()
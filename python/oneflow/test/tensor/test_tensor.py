@@ -55,6 +55,16 @@ class TestTensor(flow.unittest.TestCase):
         test_case.assertTrue(np.array_equal(tensor.numpy(), np_arr))
         test_case.assertEqual(np.int32, tensor.numpy().dtype)
 
+    def test_numpy_async(test_case):
+        for device in ["cpu", "cuda"]:
+            np_arr = np.random.rand(3, 4).astype(np.float32)
+            tensor = flow.Tensor(np_arr, device=flow.device(device)) * 2
+            future = tensor.numpy_async()
+            future.wait()
+            test_case.assertTrue(future.done())
+            test_case.assertTrue(np.allclose(future.numpy(), np_arr * 2))
+            test_case.assertEqual(np.float32, future.numpy().dtype)
+
     def test_construct_from_numpy_or_list(test_case):
         shape = (2, 3, 4, 5)
         np_arr = np.random.rand(*shape).astype(np.float32)
@@ -506,7 +506,7 @@ class FunctionalGenerator:
             schema_fmt += "std::vector<ArgumentDef> {0}Schema::argument_def = {{{1}}};\n".format(
                 signature._name, ", ".join(argument_def)
             )
-            module_fmt += '  m.def("{0}", &functional::PyFunction<functional::{1}Schema>);\n'.format(
+            module_fmt += '  functional::AddPyFunction<functional::{1}Schema>(m, "{0}");\n'.format(
                 name, signature._name
             )
 